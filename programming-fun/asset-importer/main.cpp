@@ -0,0 +1,508 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_id.h"
+#include "asset_pack.h"
+#include "block_compression.h"
+#include "ktx2.h"
+#include "mip_chain.h"
+#include "qoi_strips.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stb_image.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    struct Options
+    {
+        bool            bc3         = true;
+        bool            etc2        = true;
+        bool            mipmaps     = true;
+        bool            qoi         = false;
+        bool            pack        = true;
+        PackCompression compression = PackCompression::None;
+        unsigned        jobs        = 0; // 0 for one a hardware thread
+        fs::path        source;
+        fs::path        output;
+    };
+
+    // What the database knows about a source from its last successful import
+    struct Record
+    {
+        std::uintmax_t        size          = 0;
+        std::int64_t          write_time    = 0; // the file clock's ticks, only to skip the hash when neither changed
+        std::uint64_t         source_hash   = 0;
+        std::uint64_t         settings_hash = 0;
+        std::vector<fs::path> outputs; // file names, in the source's directory under the output one
+    };
+
+    using Database = std::map<std::string, Record>; // by the source's path relative to the source directory, '/' separated
+
+    struct Job
+    {
+        std::string name;
+        fs::path    path;
+        Record      record;       // from the database, or blank for a new source
+        bool        known = false;
+    };
+
+    struct Result
+    {
+        enum class Outcome
+        {
+            Unchanged,
+            Imported,
+            Failed
+        };
+
+        Outcome     outcome = Outcome::Failed;
+        Record      record;
+        std::string log;
+    };
+
+    // bump when an importer's output changes for the same source and settings, so everything re-imports
+    constexpr std::string_view IMPORTER_VERSION = "1";
+
+    void print_usage()
+    {
+        std::cout << "usage: asset-importer [--jobs N] [--format bc3|etc2|all] [--no-mips] [--qoi] [--compress fast|dense] [--no-pack] <assets directory> <output directory>\n"
+                     "Imports every file under the assets directory into the output directory and packs it to <output directory>/assets.pak.\n"
+                     "PNGs get <name>.bc3.ktx2 and/or <name>.etc2.ktx2 with their mips, as texture-converter writes them, and <name>.qois with --qoi;\n"
+                     "every other file is copied as it is. <output directory>.import keeps each source's hash and the settings it was imported\n"
+                     "with, so a run only imports what changed, across N threads, one a hardware thread by default, and drops the outputs of\n"
+                     "sources that are gone. The pack is rewritten only when something did change or it is missing.\n";
+    }
+
+    bool parse_compression(std::string_view text, PackCompression& out_compression)
+    {
+        if (text == "fast")
+            out_compression = PackCompression::Fast;
+        else if (text == "dense")
+            out_compression = PackCompression::Dense;
+        else
+            return false;
+        return true;
+    }
+
+    bool parse_arguments(int argc, char* argv[], Options& options)
+    {
+        std::vector<fs::path> directories;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+            if (argument == "--no-mips")
+            {
+                options.mipmaps = false;
+            }
+            else if (argument == "--qoi")
+            {
+                options.qoi = true;
+            }
+            else if (argument == "--no-pack")
+            {
+                options.pack = false;
+            }
+            else if (argument == "--jobs" && i + 1 < argc)
+            {
+                const std::string_view count = argv[++i];
+                const auto [end, error]      = std::from_chars(count.data(), count.data() + count.size(), options.jobs);
+                if (error != std::errc{} || end != count.data() + count.size() || options.jobs == 0)
+                    return false;
+            }
+            else if (argument == "--format" && i + 1 < argc)
+            {
+                const std::string_view format = argv[++i];
+                options.bc3                   = format == "bc3" || format == "all";
+                options.etc2                  = format == "etc2" || format == "all";
+                if (!options.bc3 && !options.etc2)
+                    return false;
+            }
+            else if (argument == "--compress" && i + 1 < argc)
+            {
+                if (!parse_compression(argv[++i], options.compression))
+                    return false;
+            }
+            else if (argument.starts_with("--"))
+            {
+                return false;
+            }
+            else
+            {
+                directories.emplace_back(argument);
+            }
+        }
+        if (directories.size() != 2)
+            return false;
+        options.source = directories[0];
+        options.output = directories[1];
+        return true;
+    }
+
+    // the settings a source's outputs depend on, so changing one only re-imports the files it touches
+    std::uint64_t settings_hash(const fs::path& source, const Options& options)
+    {
+        std::string settings{ IMPORTER_VERSION };
+        if (source.extension() == ".png")
+        {
+            settings += options.bc3 ? " bc3" : "";
+            settings += options.etc2 ? " etc2" : "";
+            settings += options.mipmaps ? " mips" : "";
+            settings += options.qoi ? " qoi" : "";
+        }
+        return asset_name_hash(settings);
+    }
+
+    fs::path database_path(const Options& options)
+    {
+        fs::path database = options.output;
+        if (!database.has_filename())
+            database = database.parent_path();
+        database += ".import";
+        return database;
+    }
+
+    // name size write_time source_hash settings_hash output_count output..., a line each, the paths quoted
+    Database load_database(const fs::path& filename)
+    {
+        Database      database;
+        std::ifstream input{ filename };
+        std::string   line;
+        while (std::getline(input, line))
+        {
+            std::istringstream fields{ line };
+            std::string        name;
+            Record             record;
+            std::size_t        count = 0;
+            if (!(fields >> std::quoted(name) >> record.size >> record.write_time >> std::hex >> record.source_hash >> record.settings_hash >> std::dec >> count))
+                continue;
+            for (std::string output; count > 0 && fields >> std::quoted(output); --count)
+                record.outputs.emplace_back(output);
+            if (count == 0)
+                database.emplace(std::move(name), std::move(record));
+        }
+        return database;
+    }
+
+    bool save_database(const fs::path& filename, const Database& database)
+    {
+        std::ofstream out{ filename, std::ios::trunc };
+        for (const auto& [name, record] : database)
+        {
+            out << std::quoted(name) << ' ' << record.size << ' ' << record.write_time << ' ' << std::hex << record.source_hash << ' ' << record.settings_hash << std::dec << ' '
+                << record.outputs.size();
+            for (const auto& output : record.outputs)
+                out << ' ' << std::quoted(output.generic_string());
+            out << '\n';
+        }
+        if (!out)
+        {
+            std::cerr << "Failed to write " << filename << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    bool read_file(const fs::path& filename, std::vector<unsigned char>& out_bytes)
+    {
+        std::ifstream input{ filename, std::ios::binary | std::ios::ate };
+        if (!input)
+            return false;
+        out_bytes.resize(static_cast<std::size_t>(input.tellg()));
+        input.seekg(0);
+        return static_cast<bool>(input.read(reinterpret_cast<char*>(out_bytes.data()), static_cast<std::streamsize>(out_bytes.size())));
+    }
+
+    bool write_file(const fs::path& filename, const std::vector<unsigned char>& bytes)
+    {
+        std::ofstream out{ filename, std::ios::binary | std::ios::trunc };
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(out);
+    }
+
+    using Encoder = std::vector<unsigned char> (*)(const unsigned char*, int, int);
+
+    bool write_variant(const fs::path& output, std::uint32_t vk_format, Encoder encode, const unsigned char* pixels, int width, int height, const std::vector<std::vector<unsigned char>>& mips)
+    {
+        ktx2::Image image;
+        image.vk_format = vk_format;
+        image.width     = width;
+        image.height    = height;
+
+        int level_width  = width;
+        int level_height = height;
+        for (std::size_t level = 0; level <= mips.size(); ++level)
+        {
+            const auto blocks = encode(level == 0 ? pixels : mips[level - 1].data(), level_width, level_height);
+            image.levels.push_back(ktx2::Level{ level_width, level_height, image.data.size(), blocks.size() });
+            image.data.insert(image.data.end(), blocks.begin(), blocks.end());
+            level_width  = std::max(1, level_width / 2);
+            level_height = std::max(1, level_height / 2);
+        }
+        return ktx2::Save(output, image);
+    }
+
+    // the PNG itself, for the platforms without either format, and its compressed variants next to it
+    bool import_png(const fs::path& source, const std::vector<unsigned char>& bytes, const fs::path& output, const Options& options, Result& result, std::ostringstream& log)
+    {
+        int            width  = 0;
+        int            height = 0;
+        unsigned char* pixels = stbi_load_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, nullptr, 4);
+        if (pixels == nullptr)
+        {
+            log << "Failed to load " << source << ": " << stbi_failure_reason() << '\n';
+            return false;
+        }
+
+        const auto mips    = options.mipmaps ? build_mip_chain(pixels, width, height) : std::vector<std::vector<unsigned char>>{};
+        const auto variant = [&output](const char* suffix)
+        {
+            auto path = output;
+            path.replace_extension(std::string{ "." } + suffix + ".ktx2");
+            return path;
+        };
+        struct Written
+        {
+            fs::path path;
+            bool     ok;
+        };
+        std::vector<Written> written;
+        if (options.bc3)
+        {
+            const auto path = variant("bc3");
+            written.push_back(Written{ path, write_variant(path, ktx2::FORMAT_BC3_UNORM, block_compression::EncodeBC3, pixels, width, height, mips) });
+        }
+        if (options.etc2)
+        {
+            const auto path = variant("etc2");
+            written.push_back(Written{ path, write_variant(path, ktx2::FORMAT_ETC2_R8G8B8A8_UNORM, block_compression::EncodeETC2, pixels, width, height, mips) });
+        }
+        if (options.qoi)
+        {
+            auto path = output;
+            path.replace_extension(".qois");
+            written.push_back(Written{ path, qoi_strips::Write(path, pixels, width, height) });
+        }
+        stbi_image_free(pixels);
+
+        bool ok = true;
+        for (const auto& [path, written_ok] : written)
+        {
+            if (!written_ok)
+            {
+                log << "Failed to write " << path << '\n';
+                ok = false;
+            }
+            result.record.outputs.push_back(path.filename());
+        }
+        log << "  " << width << " x " << height << ", " << mips.size() + 1 << " levels\n";
+        return ok;
+    }
+
+    void import(const Job& job, const Options& options, Result& result)
+    {
+        std::ostringstream         log;
+        std::vector<unsigned char> bytes;
+        std::error_code            error;
+        result.record            = job.record;
+        result.record.size       = fs::file_size(job.path, error);
+        result.record.write_time = static_cast<std::int64_t>(fs::last_write_time(job.path, error).time_since_epoch().count());
+        if (error || !read_file(job.path, bytes))
+        {
+            result.log = "Failed to read " + job.path.string() + '\n';
+            return;
+        }
+        result.record.source_hash   = asset_name_hash(std::string_view{ reinterpret_cast<const char*>(bytes.data()), bytes.size() });
+        result.record.settings_hash = settings_hash(job.path, options);
+
+        // touched but the same bytes, like after a checkout: keep the outputs when they are all still there
+        const fs::path relative = fs::path{ job.name };
+        const fs::path folder   = (options.output / relative).parent_path();
+        if (job.known && job.record.source_hash == result.record.source_hash && job.record.settings_hash == result.record.settings_hash &&
+            std::all_of(job.record.outputs.begin(), job.record.outputs.end(), [&](const fs::path& output) { return fs::exists(folder / output.filename(), error); }))
+        {
+            result.outcome = Result::Outcome::Unchanged;
+            return;
+        }
+
+        fs::create_directories(folder, error);
+        const fs::path output = options.output / relative;
+        result.record.outputs.clear();
+        result.record.outputs.push_back(relative.filename());
+        log << job.name << '\n';
+        bool ok = !error && write_file(output, bytes);
+        if (!ok)
+            log << "Failed to write " << output << '\n';
+        if (ok && job.path.extension() == ".png")
+            ok = import_png(job.path, bytes, output, options, result, log);
+        result.outcome = ok ? Result::Outcome::Imported : Result::Outcome::Failed;
+        result.log     = log.str();
+    }
+
+    // texture-converter's outputs next to a PNG are what importing it writes, so they come from the PNG instead
+    bool is_png_output(const fs::path& path)
+    {
+        const auto extension = path.extension();
+        if (extension != ".ktx2" && extension != ".qois")
+            return false;
+        auto png = extension == ".ktx2" ? path.parent_path() / path.stem().stem() : path;
+        png.replace_extension(".png");
+        std::error_code error;
+        return fs::exists(png, error);
+    }
+
+    bool same_stamp(const Record& record, const fs::path& path)
+    {
+        std::error_code error;
+        const auto      size       = fs::file_size(path, error);
+        const auto      write_time = static_cast<std::int64_t>(fs::last_write_time(path, error).time_since_epoch().count());
+        return !error && size == record.size && write_time == record.write_time;
+    }
+
+    void remove_output(const Options& options, const std::string& name, const fs::path& output)
+    {
+        std::error_code error;
+        fs::remove((options.output / fs::path{ name }).parent_path() / output, error);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse_arguments(argc, argv, options) || !fs::is_directory(options.source))
+    {
+        print_usage();
+        return 1;
+    }
+    std::error_code error;
+    fs::create_directories(options.output, error);
+    if (error)
+    {
+        std::cerr << "Failed to make " << options.output << ": " << error.message() << '\n';
+        return 1;
+    }
+
+    const auto     start         = std::chrono::steady_clock::now();
+    const fs::path database_file = database_path(options);
+    Database       database      = load_database(database_file);
+
+    // the sources whose size or time changed, or that the settings they were imported with no longer match, get a job
+    std::vector<Job> jobs;
+    std::size_t      sources = 0;
+    Database         current;
+    for (const auto& item : fs::recursive_directory_iterator{ options.source, error })
+    {
+        if (!item.is_regular_file() || item.path().extension() == ".pak" || is_png_output(item.path()))
+            continue;
+        ++sources;
+        Job job;
+        job.name = item.path().lexically_relative(options.source).generic_string();
+        job.path = item.path();
+        if (const auto found = database.find(job.name); found != database.end())
+        {
+            job.record = found->second;
+            job.known  = true;
+            if (same_stamp(job.record, job.path) && job.record.settings_hash == settings_hash(job.path, options))
+            {
+                current.emplace(job.name, std::move(job.record));
+                continue;
+            }
+        }
+        jobs.push_back(std::move(job));
+    }
+    if (error)
+    {
+        std::cerr << "Failed to list " << options.source << ": " << error.message() << '\n';
+        return 1;
+    }
+
+    // any thread takes the next job when it is done with one, so a few big textures don't hold up the rest
+    std::vector<Result>      results(jobs.size());
+    std::atomic<std::size_t> next{ 0 };
+    const unsigned           thread_count = static_cast<unsigned>(std::min<std::size_t>(options.jobs != 0 ? options.jobs : std::max(1u, std::thread::hardware_concurrency()), jobs.size()));
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back(
+                [&]
+                {
+                    for (std::size_t k = next++; k < jobs.size(); k = next++)
+                        import(jobs[k], options, results[k]);
+                });
+        }
+    }
+
+    int failures = 0;
+    int imported = 0;
+    for (std::size_t k = 0; k < jobs.size(); ++k)
+    {
+        switch (results[k].outcome)
+        {
+            case Result::Outcome::Imported:
+                std::cout << results[k].log;
+                ++imported;
+                // outputs the new settings no longer write, like a format that was dropped
+                for (const auto& old_output : jobs[k].record.outputs)
+                {
+                    if (std::find(results[k].record.outputs.begin(), results[k].record.outputs.end(), old_output) == results[k].record.outputs.end())
+                        remove_output(options, jobs[k].name, old_output);
+                }
+                [[fallthrough]];
+            case Result::Outcome::Unchanged: current.emplace(jobs[k].name, std::move(results[k].record)); break;
+            // left out of the database so the next run tries again
+            case Result::Outcome::Failed:
+                std::cerr << results[k].log;
+                ++failures;
+                break;
+        }
+    }
+
+    int removed = 0;
+    for (const auto& [name, record] : database)
+    {
+        if (!current.contains(name) && !fs::exists(options.source / fs::path{ name }, error))
+        {
+            for (const auto& output : record.outputs)
+                remove_output(options, name, output);
+            ++removed;
+        }
+    }
+    if (!save_database(database_file, current))
+        return 1;
+
+    const std::chrono::duration<double, std::milli> import_elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << sources << " sources: " << imported << " imported, " << sources - static_cast<std::size_t>(imported + failures) << " up to date, " << failures << " failed, " << removed
+              << " removed, on " << thread_count << " threads in " << import_elapsed.count() << " ms\n";
+    if (failures > 0)
+        return 1;
+
+    const fs::path pack = options.output / AssetPack::DEFAULT_FILENAME;
+    if (!options.pack || (imported == 0 && removed == 0 && fs::exists(pack, error)))
+        return 0;
+    std::size_t count = 0;
+    if (!write_asset_pack(options.output, pack, count, options.compression))
+        return 1;
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << pack.string() << ": " << count << " files, " << fs::file_size(pack) / 1024 << " KB in " << elapsed.count() << " ms\n";
+    return 0;
+}
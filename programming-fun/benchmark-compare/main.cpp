@@ -0,0 +1,526 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    struct Options
+    {
+        double                tolerance_pct = 5.0;  // allowed growth before a significant change counts as a regression
+        double                alpha         = 0.01; // significance level of every test
+        std::vector<fs::path> baseline;
+        std::vector<fs::path> candidate;
+    };
+
+    // One side's reports flattened: "load_ms", "frame_ms.p95", "frame_ms_samples", "peak_bytes.Textures". Every number
+    // appends to its key, so an array is all its elements and a side of several files has one scalar per run and
+    // every run's samples pooled.
+    using Values = std::map<std::string, std::vector<double>>;
+
+    enum class Verdict
+    {
+        Same,
+        Better,
+        Worse,
+        Unknown // not enough runs to say
+    };
+
+    struct Row
+    {
+        std::string name;
+        double      baseline  = 0.0;
+        double      candidate = 0.0;
+        std::string test; // what decided the verdict
+        Verdict     verdict = Verdict::Same;
+    };
+
+    void print_usage()
+    {
+        std::cout << "usage: benchmark-compare [--tolerance percent] [--alpha p] <baseline.json>... -- <candidate.json>...\n"
+                     "       benchmark-compare [--tolerance percent] [--alpha p] <baseline.json> <candidate.json>\n"
+                     "Compares the JSON reports programming-fun --benchmark writes. Frame, CPU and GPU times are compared\n"
+                     "sample by sample with a two sided Mann-Whitney U test on the medians; load time and peak memory, one\n"
+                     "number a run, by the 95% confidence interval of the difference in means, which needs two or more runs\n"
+                     "a side. A change counts when it is significant at --alpha (0.01) and past --tolerance (5%) of the\n"
+                     "baseline. The exit code is 2 when anything regressed, 1 when a report can't be read.\n";
+    }
+
+    const char* find_option(int argc, char* argv[], std::string_view name)
+    {
+        for (int i = 1; i + 1 < argc; ++i)
+        {
+            if (argv[i] == name)
+                return argv[i + 1];
+        }
+        return nullptr;
+    }
+
+    bool parse_number(const char* text, double& out_value)
+    {
+        const auto end          = text + std::strlen(text);
+        const auto [ptr, error] = std::from_chars(text, end, out_value);
+        return error == std::errc{} && ptr == end;
+    }
+
+    // The JSON BenchmarkRun::WriteReport writes, and any other JSON whose strings have no escapes
+    class JsonReader
+    {
+    public:
+        explicit JsonReader(std::string_view json_text) : text{ json_text }
+        {
+        }
+
+        bool Read(Values& out_values)
+        {
+            return value({}, out_values) && (skipSpace(), position == text.size());
+        }
+
+    private:
+        void skipSpace()
+        {
+            while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+                ++position;
+        }
+
+        bool consume(char expected)
+        {
+            skipSpace();
+            if (position >= text.size() || text[position] != expected)
+                return false;
+            ++position;
+            return true;
+        }
+
+        bool string(std::string& out_text)
+        {
+            if (!consume('"'))
+                return false;
+            const std::size_t end = text.find('"', position);
+            if (end == std::string_view::npos)
+                return false;
+            out_text = text.substr(position, end - position);
+            position = end + 1;
+            return true;
+        }
+
+        bool literal(std::string_view word)
+        {
+            if (text.substr(position, word.size()) != word)
+                return false;
+            position += word.size();
+            return true;
+        }
+
+        bool value(const std::string& path, Values& out_values)
+        {
+            skipSpace();
+            if (position >= text.size())
+                return false;
+            const char next = text[position];
+            if (next == '{')
+            {
+                ++position;
+                if (consume('}'))
+                    return true;
+                do
+                {
+                    std::string key;
+                    if (!string(key) || !consume(':') || !value(path.empty() ? key : path + '.' + key, out_values))
+                        return false;
+                } while (consume(','));
+                return consume('}');
+            }
+            if (next == '[')
+            {
+                ++position;
+                out_values[path];
+                if (consume(']'))
+                    return true;
+                do
+                {
+                    if (!value(path, out_values))
+                        return false;
+                } while (consume(','));
+                return consume(']');
+            }
+            if (next == '"')
+            {
+                std::string ignored;
+                return string(ignored);
+            }
+            if (literal("true"))
+            {
+                out_values[path].push_back(1.0);
+                return true;
+            }
+            if (literal("false"))
+            {
+                out_values[path].push_back(0.0);
+                return true;
+            }
+            if (literal("null"))
+            {
+                out_values[path];
+                return true;
+            }
+            double     number       = 0.0;
+            const auto [ptr, error] = std::from_chars(text.data() + position, text.data() + text.size(), number);
+            if (error != std::errc{})
+                return false;
+            position = static_cast<std::size_t>(ptr - text.data());
+            out_values[path].push_back(number);
+            return true;
+        }
+
+    private:
+        std::string_view text;
+        std::size_t      position = 0;
+    };
+
+    bool read_side(const std::vector<fs::path>& files, Values& out_values)
+    {
+        for (const fs::path& file : files)
+        {
+            std::ifstream in{ file, std::ios::binary };
+            if (!in)
+            {
+                std::cerr << "Failed to open " << file << '\n';
+                return false;
+            }
+            std::ostringstream contents;
+            contents << in.rdbuf();
+            const std::string json = contents.str();
+            if (!JsonReader{ json }.Read(out_values))
+            {
+                std::cerr << file << " isn't a benchmark report\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double mean_of(const std::vector<double>& values)
+    {
+        return values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+    }
+
+    double median_of(std::vector<double> values)
+    {
+        if (values.empty())
+            return 0.0;
+        const auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+        std::nth_element(values.begin(), middle, values.end());
+        if (values.size() % 2 == 1)
+            return *middle;
+        return (*middle + *std::max_element(values.begin(), middle)) / 2.0;
+    }
+
+    double variance_of(const std::vector<double>& values)
+    {
+        if (values.size() < 2)
+            return 0.0;
+        const double mean = mean_of(values);
+        double       sum  = 0.0;
+        for (const double value : values)
+            sum += (value - mean) * (value - mean);
+        return sum / static_cast<double>(values.size() - 1);
+    }
+
+    // Two sided, by the normal approximation with the tie correction; fine from a dozen samples a side,
+    // and frame samples come in the hundreds
+    double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b)
+    {
+        struct Ranked
+        {
+            double value = 0.0;
+            bool   in_a  = false;
+        };
+        std::vector<Ranked> all;
+        all.reserve(a.size() + b.size());
+        for (const double value : a)
+            all.push_back({ value, true });
+        for (const double value : b)
+            all.push_back({ value, false });
+        std::sort(all.begin(), all.end(), [](const Ranked& x, const Ranked& y) { return x.value < y.value; });
+
+        // ties share the mean of the ranks they span
+        double rank_sum_a = 0.0;
+        double tie_term   = 0.0;
+        for (std::size_t i = 0; i < all.size();)
+        {
+            std::size_t j = i;
+            while (j < all.size() && all[j].value == all[i].value)
+                ++j;
+            const double rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+            for (std::size_t k = i; k < j; ++k)
+            {
+                if (all[k].in_a)
+                    rank_sum_a += rank;
+            }
+            const double tied = static_cast<double>(j - i);
+            tie_term += tied * tied * tied - tied;
+            i = j;
+        }
+        const double n_a      = static_cast<double>(a.size());
+        const double n_b      = static_cast<double>(b.size());
+        const double n        = n_a + n_b;
+        const double u        = rank_sum_a - n_a * (n_a + 1.0) / 2.0;
+        const double variance = n_a * n_b / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0)));
+        if (variance <= 0.0)
+            return 1.0;
+        const double z = std::max(0.0, std::abs(u - n_a * n_b / 2.0) - 0.5) / std::sqrt(variance);
+        return std::erfc(z / std::sqrt(2.0));
+    }
+
+    // Student's t at 97.5%, for a 95% interval
+    double t_quantile(double degrees_of_freedom)
+    {
+        static constexpr double TABLE[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+                                            2.120,  2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+        const auto              df      = static_cast<std::size_t>(std::max(1.0, std::floor(degrees_of_freedom)));
+        if (df <= std::size(TABLE))
+            return TABLE[df - 1];
+        return 1.96 + 2.5 / static_cast<double>(df); // within 0.002 of the exact value from 30 on
+    }
+
+    Verdict judge(bool significant, double change_pct, double tolerance_pct)
+    {
+        if (!significant || std::abs(change_pct) <= tolerance_pct)
+            return Verdict::Same;
+        return change_pct > 0.0 ? Verdict::Worse : Verdict::Better;
+    }
+
+    double change_pct(double baseline, double candidate)
+    {
+        return baseline != 0.0 ? (candidate - baseline) / baseline * 100.0 : 0.0;
+    }
+
+    std::string format_p(double p)
+    {
+        std::ostringstream out;
+        if (p < 0.0001)
+            out << "p < 0.0001";
+        else
+            out << "p = " << std::setprecision(2) << p;
+        return out.str();
+    }
+
+    // per frame samples: medians compared, the rank test deciding whether the difference is real
+    void compare_samples(const std::string& name, const Values& baseline, const Values& candidate, const Options& options, std::vector<Row>& rows)
+    {
+        const auto a = baseline.find(name + "_samples");
+        const auto b = candidate.find(name + "_samples");
+        if (a == baseline.end() || b == candidate.end() || a->second.empty() || b->second.empty())
+            return;
+        const double p = mann_whitney_p(a->second, b->second);
+        Row          row;
+        row.name      = name + " median";
+        row.baseline  = median_of(a->second);
+        row.candidate = median_of(b->second);
+        row.test      = "Mann-Whitney " + format_p(p);
+        row.verdict   = judge(p < options.alpha, change_pct(row.baseline, row.candidate), options.tolerance_pct);
+        rows.push_back(row);
+    }
+
+    // one number a run: Welch's interval on the difference in means
+    void compare_runs(const std::string& name, const std::vector<double>& a, const std::vector<double>& b, const Options& options, std::vector<Row>& rows)
+    {
+        if (a.empty() || b.empty())
+            return;
+        Row row;
+        row.name      = name;
+        row.baseline  = mean_of(a);
+        row.candidate = mean_of(b);
+        if (a.size() < 2 || b.size() < 2)
+        {
+            row.test    = "one run, no interval";
+            row.verdict = std::abs(change_pct(row.baseline, row.candidate)) > options.tolerance_pct ? Verdict::Unknown : Verdict::Same;
+            rows.push_back(row);
+            return;
+        }
+        const double se_a  = variance_of(a) / static_cast<double>(a.size());
+        const double se_b  = variance_of(b) / static_cast<double>(b.size());
+        const double se    = std::sqrt(se_a + se_b);
+        const double df    = se > 0.0 ? (se_a + se_b) * (se_a + se_b) / (se_a * se_a / static_cast<double>(a.size() - 1) + se_b * se_b / static_cast<double>(b.size() - 1)) : 1.0;
+        const double half  = t_quantile(df) * se;
+        const double delta = row.candidate - row.baseline;
+        std::ostringstream test;
+        test << "95% CI " << std::showpos << std::fixed << std::setprecision(2) << change_pct(row.baseline, row.baseline + delta - half) << "% to "
+             << change_pct(row.baseline, row.baseline + delta + half) << '%';
+        row.test = test.str();
+        // the whole interval past the tolerance, so a noisy run can't fail the gate by itself
+        const double tolerance = std::abs(row.baseline) * options.tolerance_pct / 100.0;
+        if (delta - half > tolerance)
+            row.verdict = Verdict::Worse;
+        else if (delta + half < -tolerance)
+            row.verdict = Verdict::Better;
+        rows.push_back(row);
+    }
+
+    // what makes two runs comparable at all; a mismatch is reported, not failed
+    void check_settings(const Values& baseline, const Values& candidate)
+    {
+        for (const char* key : { "sprites", "markers", "frames", "warmup_frames", "render_thread" })
+        {
+            const auto a = baseline.find(key);
+            const auto b = candidate.find(key);
+            if (a == baseline.end() || b == candidate.end() || a->second.empty() || b->second.empty())
+                continue;
+            const auto [a_min, a_max] = std::minmax_element(a->second.begin(), a->second.end());
+            const auto [b_min, b_max] = std::minmax_element(b->second.begin(), b->second.end());
+            if (*a_min != *a_max || *b_min != *b_max || *a_min != *b_min)
+                std::cout << "warning: the runs differ in " << key << ", so the comparison may not mean much\n";
+        }
+    }
+
+    const char* verdict_name(Verdict verdict)
+    {
+        switch (verdict)
+        {
+            case Verdict::Same: return "same";
+            case Verdict::Better: return "better";
+            case Verdict::Worse: return "REGRESSED";
+            case Verdict::Unknown: return "check";
+        }
+        return "";
+    }
+
+    void print_table(const std::vector<Row>& rows)
+    {
+        std::cout << std::left << std::setw(28) << "metric" << std::right << std::setw(14) << "baseline" << std::setw(14) << "candidate" << std::setw(10) << "change"
+                  << "  " << std::left << std::setw(30) << "test" << "verdict\n";
+        for (const Row& row : rows)
+        {
+            std::ostringstream change;
+            change << std::showpos << std::fixed << std::setprecision(1) << change_pct(row.baseline, row.candidate) << '%';
+            std::cout << std::left << std::setw(28) << row.name << std::right << std::fixed << std::setprecision(3) << std::setw(14) << row.baseline << std::setw(14) << row.candidate
+                      << std::setw(10) << change.str() << "  " << std::left << std::setw(30) << row.test << verdict_name(row.verdict) << '\n';
+        }
+    }
+
+    // files before "--" are the baseline and after it the candidate; two files and no "--" are one of each
+    bool parse_files(int argc, char* argv[], Options& options)
+    {
+        std::vector<fs::path> files;
+        bool                  has_separator = false;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+            if (argument == "--tolerance" || argument == "--alpha")
+            {
+                ++i;
+                continue;
+            }
+            if (argument == "--")
+            {
+                if (has_separator)
+                    return false;
+                has_separator    = true;
+                options.baseline = std::move(files);
+                files.clear();
+                continue;
+            }
+            files.emplace_back(argument);
+        }
+        if (has_separator)
+        {
+            options.candidate = std::move(files);
+        }
+        else if (files.size() == 2)
+        {
+            options.baseline  = { files[0] };
+            options.candidate = { files[1] };
+        }
+        return !options.baseline.empty() && !options.candidate.empty();
+    }
+}
+
+int main(int argc, char* argv[])
+try
+{
+    if (argc < 2 || std::string_view{ argv[1] } == "--help")
+    {
+        print_usage();
+        return argc < 2 ? 1 : 0;
+    }
+    Options options;
+    if (const char* tolerance = find_option(argc, argv, "--tolerance"); tolerance != nullptr && (!parse_number(tolerance, options.tolerance_pct) || options.tolerance_pct < 0.0))
+    {
+        print_usage();
+        return 1;
+    }
+    if (const char* alpha = find_option(argc, argv, "--alpha"); alpha != nullptr && (!parse_number(alpha, options.alpha) || options.alpha <= 0.0 || options.alpha >= 1.0))
+    {
+        print_usage();
+        return 1;
+    }
+    if (!parse_files(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    Values baseline;
+    Values candidate;
+    if (!read_side(options.baseline, baseline) || !read_side(options.candidate, candidate))
+        return 1;
+    std::cout << options.baseline.size() << " baseline run(s) against " << options.candidate.size() << " candidate run(s), tolerance " << options.tolerance_pct << "%, alpha "
+              << options.alpha << '\n';
+    check_settings(baseline, candidate);
+
+    std::vector<Row> rows;
+    for (const char* series : { "frame_ms", "cpu_ms", "gpu_ms" })
+        compare_samples(series, baseline, candidate, options, rows);
+    if (!baseline.contains("frame_ms_samples") || !candidate.contains("frame_ms_samples"))
+        std::cout << "warning: a report has no per frame samples (written before they were), so frame times aren't compared\n";
+    const std::vector<double> none;
+    const auto                runs_of = [&none](const Values& values, const std::string& key) -> const std::vector<double>&
+    {
+        const auto found = values.find(key);
+        return found != values.end() ? found->second : none;
+    };
+    compare_runs("load_ms", runs_of(baseline, "load_ms"), runs_of(candidate, "load_ms"), options, rows);
+    for (const auto& [key, values] : baseline)
+    {
+        if (key.starts_with("peak_bytes."))
+            compare_runs(key, values, runs_of(candidate, key), options, rows);
+    }
+    print_table(rows);
+
+    const auto regressions = std::count_if(rows.begin(), rows.end(), [](const Row& row) { return row.verdict == Verdict::Worse; });
+    if (std::any_of(rows.begin(), rows.end(), [](const Row& row) { return row.verdict == Verdict::Unknown; }))
+        std::cout << "\"check\": changed past the tolerance, but with one run a side there is no telling it from noise\n";
+    if (regressions > 0)
+    {
+        std::cout << regressions << " regression(s)\n";
+        return 2;
+    }
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cerr << e.what() << '\n';
+    return -1;
+}
@@ -0,0 +1,514 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_paths.h"
+#include "audio_kernels.h"
+#include "qoi_strips.h"
+#include "sound_loader.h"
+
+#include <GL/glew.h>
+#include <SDL.h>
+#include <al.h>
+#include <alc.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stb_image.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#define STB_VORBIS_HEADER_ONLY
+#include <stb_vorbis.c>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    struct Options
+    {
+        int      runs          = 20;
+        double   tolerance_pct = 10.0; // allowed warm median growth against --baseline
+        fs::path csv;
+        fs::path baseline;
+    };
+
+    // The first run of a case is reported on its own: that one pays for first touches (allocator growth,
+    // driver setup, OS file cache); the remaining runs are the steady state and what baselines compare
+    struct Result
+    {
+        std::string case_name;
+        std::string asset;
+        std::size_t bytes   = 0;
+        double      cold_ms = 0.0;
+        double      min_ms  = 0.0;
+        double      median  = 0.0;
+        double      mean    = 0.0;
+        double      max_ms  = 0.0;
+        int         runs    = 0;
+    };
+
+    void print_usage()
+    {
+        std::cout << "usage: load-benchmark [--assets <dir>] [--runs N] [--csv out.csv] [--baseline old.csv] [--tolerance percent]\n"
+                     "Times the pieces Demo::Setup pays for: PNG decode, texture upload, WAV and OGG decode, alBufferData.\n"
+                     "The audio_kernels rows run once per instruction set this CPU has, the scalar row being the reference.\n"
+                     "Every image and sound under the asset root is measured, plus synthetic sizes for the uploads.\n"
+                     "With --baseline, warm medians are compared per row and the exit code is 2 when one regressed past the tolerance.\n";
+    }
+
+    const char* find_option(int argc, char* argv[], std::string_view name)
+    {
+        for (int i = 1; i + 1 < argc; ++i)
+        {
+            if (argv[i] == name)
+                return argv[i + 1];
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    bool parse_number(const char* text, T& out_value)
+    {
+        const auto end          = text + std::strlen(text);
+        const auto [ptr, error] = std::from_chars(text, end, out_value);
+        return error == std::errc{} && ptr == end;
+    }
+
+    bool read_file(const fs::path& filename, std::vector<unsigned char>& out_bytes)
+    {
+        std::ifstream input{ filename, std::ios::binary | std::ios::ate };
+        if (!input)
+            return false;
+        out_bytes.resize(static_cast<std::size_t>(input.tellg()));
+        input.seekg(0);
+        return static_cast<bool>(input.read(reinterpret_cast<char*>(out_bytes.data()), static_cast<std::streamsize>(out_bytes.size())));
+    }
+
+    Result measure(std::string case_name, std::string asset, std::size_t bytes, int runs, const std::function<bool()>& body)
+    {
+        using milliseconds = std::chrono::duration<double, std::milli>;
+        Result result{ std::move(case_name), std::move(asset), bytes };
+
+        std::vector<double> samples;
+        samples.reserve(static_cast<std::size_t>(runs));
+        for (int i = 0; i <= runs; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            if (!body())
+            {
+                std::cerr << result.case_name << " failed for " << result.asset << '\n';
+                return result;
+            }
+            const double ms = milliseconds{ std::chrono::steady_clock::now() - start }.count();
+            if (i == 0)
+                result.cold_ms = ms;
+            else
+                samples.push_back(ms);
+        }
+        std::sort(samples.begin(), samples.end());
+        double total = 0.0;
+        for (const double ms : samples)
+            total += ms;
+        result.runs   = runs;
+        result.min_ms = samples.front();
+        result.median = samples[samples.size() / 2];
+        result.mean   = total / static_cast<double>(samples.size());
+        result.max_ms = samples.back();
+        return result;
+    }
+
+    std::vector<fs::path> files_with_extension(const fs::path& root, std::string_view extension)
+    {
+        std::vector<fs::path> files;
+        std::error_code       error;
+        for (const auto& item : fs::recursive_directory_iterator{ root, error })
+        {
+            if (item.is_regular_file() && item.path().extension() == extension)
+                files.push_back(item.path());
+        }
+        // stable row order so reports diff line by line
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::string relative_name(const fs::path& path)
+    {
+        return path.lexically_relative(get_base_path()).generic_string();
+    }
+
+    void benchmark_images(int runs, std::vector<Result>& results)
+    {
+        for (const fs::path& path : files_with_extension(get_base_path(), ".png"))
+        {
+            std::vector<unsigned char> bytes;
+            if (!read_file(path, bytes))
+                continue;
+            const std::string name = relative_name(path);
+            const std::string file = path.string();
+            results.push_back(measure("stbi_load", name, bytes.size(), runs,
+                                      [&file]
+                                      {
+                                          int            width = 0, height = 0;
+                                          unsigned char* pixels = stbi_load(file.c_str(), &width, &height, nullptr, 4);
+                                          stbi_image_free(pixels);
+                                          return pixels != nullptr;
+                                      }));
+            results.push_back(measure("stbi_load_from_memory", name, bytes.size(), runs,
+                                      [&bytes]
+                                      {
+                                          int            width = 0, height = 0;
+                                          unsigned char* pixels = stbi_load_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, nullptr, 4);
+                                          stbi_image_free(pixels);
+                                          return pixels != nullptr;
+                                      }));
+
+            // the same pixels as the game's .qois, decoded on one thread and then a strip per thread
+            int            width = 0, height = 0;
+            unsigned char* pixels = stbi_load_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, nullptr, 4);
+            if (pixels == nullptr)
+                continue;
+            const std::vector<unsigned char> strips = qoi_strips::Encode(pixels, width, height);
+            stbi_image_free(pixels);
+            results.push_back(measure("qoi_strips::Decode", name, strips.size(), runs,
+                                      [&strips]
+                                      {
+                                          std::vector<unsigned char> out;
+                                          int                        out_width = 0, out_height = 0;
+                                          return qoi_strips::Decode(strips, out, out_width, out_height);
+                                      }));
+            const qoi_strips::StripRunner run_threads = [](std::size_t count, const std::function<void(std::size_t, std::size_t)>& body)
+            {
+                std::vector<std::thread> threads;
+                for (std::size_t strip = 1; strip < count; ++strip)
+                    threads.emplace_back(body, strip, strip + 1);
+                body(0, std::min<std::size_t>(count, 1));
+                for (std::thread& thread : threads)
+                    thread.join();
+            };
+            results.push_back(measure("qoi_strips::Decode parallel", name, strips.size(), runs,
+                                      [&strips, &run_threads]
+                                      {
+                                          std::vector<unsigned char> out;
+                                          int                        out_width = 0, out_height = 0;
+                                          return qoi_strips::Decode(strips, out, out_width, out_height, run_threads);
+                                      }));
+        }
+    }
+
+    void benchmark_uploads(int runs, std::vector<Result>& results)
+    {
+        // glFinish makes the time cover the copy out of our memory, not just queuing it
+        for (const int size : { 128, 256, 512, 1024, 2048 })
+        {
+            const std::vector<unsigned char> pixels(static_cast<std::size_t>(size) * static_cast<std::size_t>(size) * 4, 0x7F);
+            results.push_back(measure("glTexImage2D", std::to_string(size) + "x" + std::to_string(size) + " rgba8", pixels.size(), runs,
+                                      [&pixels, size]
+                                      {
+                                          GLuint texture = 0;
+                                          glGenTextures(1, &texture);
+                                          glBindTexture(GL_TEXTURE_2D, texture);
+                                          glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+                                          glFinish();
+                                          glDeleteTextures(1, &texture);
+                                          return glGetError() == GL_NO_ERROR;
+                                      }));
+        }
+    }
+
+    void benchmark_sounds(int runs, std::vector<Result>& results)
+    {
+        std::vector<std::pair<std::string, DecodedSound>> decoded;
+        for (const fs::path& path : files_with_extension(get_base_path(), ".wav"))
+        {
+            std::vector<unsigned char> bytes;
+            if (!read_file(path, bytes))
+                continue;
+            const std::string name = relative_name(path);
+            const std::string file = path.string();
+            results.push_back(measure("SDL_LoadWAV", name, bytes.size(), runs,
+                                      [&file]
+                                      {
+                                          SDL_AudioSpec spec{};
+                                          Uint8*        buffer = nullptr;
+                                          Uint32        length = 0;
+                                          if (SDL_LoadWAV(file.c_str(), &spec, &buffer, &length) == nullptr)
+                                              return false;
+                                          SDL_FreeWAV(buffer);
+                                          return true;
+                                      }));
+            results.push_back(measure("DecodeWav", name, bytes.size(), runs,
+                                      [&bytes]
+                                      {
+                                          DecodedSound sound;
+                                          return DecodeWav(bytes, sound);
+                                      }));
+            if (DecodedSound sound; DecodeWav(bytes, sound))
+                decoded.emplace_back(name, std::move(sound));
+        }
+        for (const fs::path& path : files_with_extension(get_base_path(), ".ogg"))
+        {
+            std::vector<unsigned char> bytes;
+            if (!read_file(path, bytes))
+                continue;
+            const std::string name = relative_name(path);
+            const std::string file = path.string();
+            results.push_back(measure("stb_vorbis_decode_filename", name, bytes.size(), runs,
+                                      [&file]
+                                      {
+                                          int    channels = 0, rate = 0;
+                                          short* samples  = nullptr;
+                                          if (stb_vorbis_decode_filename(file.c_str(), &channels, &rate, &samples) < 0)
+                                              return false;
+                                          std::free(samples);
+                                          return true;
+                                      }));
+            results.push_back(measure("DecodeOgg", name, bytes.size(), runs,
+                                      [&bytes]
+                                      {
+                                          DecodedSound sound;
+                                          return DecodeOgg(bytes, sound);
+                                      }));
+            if (DecodedSound sound; DecodeOgg(bytes, sound))
+                decoded.emplace_back(name, std::move(sound));
+        }
+
+        // synthetic 16 bit stereo at 44.1 kHz, for sizes the assets don't cover
+        for (const int seconds : { 1, 10, 60 })
+        {
+            DecodedSound sound;
+            sound.channels  = 2;
+            sound.frequency = 44'100;
+            sound.samples.assign(static_cast<std::size_t>(seconds) * 44'100 * 2 * sizeof(std::int16_t), 0);
+            decoded.emplace_back(std::to_string(seconds) + " s stereo s16", std::move(sound));
+        }
+        for (const auto& [name, sound] : decoded)
+        {
+            results.push_back(measure("alBufferData", name, sound.samples.size(), runs,
+                                      [&sound = sound]
+                                      {
+                                          ALuint buffer = 0;
+                                          alGenBuffers(1, &buffer);
+                                          const bool uploaded = UploadSound(sound, buffer);
+                                          alDeleteBuffers(1, &buffer);
+                                          return uploaded;
+                                      }));
+        }
+    }
+
+    void benchmark_kernels(int runs, std::vector<Result>& results)
+    {
+        using audio_kernels::Level;
+
+        // 10 s of 44.1 kHz stereo, a long music track's worth
+        constexpr std::size_t FRAMES  = 441'000;
+        constexpr std::size_t SAMPLES = FRAMES * 2;
+
+        std::vector<std::int16_t> s16(SAMPLES);
+        std::vector<float>        f32(SAMPLES);
+        std::vector<float>        left(FRAMES);
+        std::vector<float>        right(FRAMES);
+        std::vector<float>        resampled;
+        for (std::size_t i = 0; i < SAMPLES; ++i)
+            s16[i] = static_cast<std::int16_t>(static_cast<int>((i * 7919) % 65'536) - 32'768);
+        audio_kernels::S16ToF32(s16.data(), f32.data(), SAMPLES);
+
+        const Level best = audio_kernels::ActiveLevel();
+
+        const std::pair<const char*, std::function<bool()>> cases[] = {
+            { "S16ToF32",
+              [&]
+              {
+                  audio_kernels::S16ToF32(s16.data(), f32.data(), SAMPLES);
+                  return true;
+              } },
+            { "F32ToS16",
+              [&]
+              {
+                  audio_kernels::F32ToS16(f32.data(), s16.data(), SAMPLES);
+                  return true;
+              } },
+            { "ApplyGain",
+              [&]
+              {
+                  audio_kernels::ApplyGain(f32.data(), SAMPLES, 1.0f);
+                  return true;
+              } },
+            { "Deinterleave",
+              [&]
+              {
+                  float* const planes[] = { left.data(), right.data() };
+                  audio_kernels::Deinterleave(f32.data(), 2, FRAMES, planes);
+                  return true;
+              } },
+            { "Interleave",
+              [&]
+              {
+                  const float* const planes[] = { left.data(), right.data() };
+                  audio_kernels::Interleave(planes, 2, FRAMES, f32.data());
+                  return true;
+              } },
+            { "Resampler 44100->48000",
+              [&]
+              {
+                  audio_kernels::Resampler resampler{ 44'100, 48'000 };
+                  resampled.clear();
+                  resampler.Process(left, resampled);
+                  resampler.Flush(resampled);
+                  return !resampled.empty();
+              } },
+        };
+        for (const auto& [name, body] : cases)
+        {
+            for (const Level level : { Level::Scalar, Level::Sse2, Level::Avx2, Level::Neon, Level::Wasm })
+            {
+                if (!audio_kernels::SetLevel(level))
+                    continue;
+                results.push_back(measure(name, std::string{ audio_kernels::LevelName(level) } + " 10 s stereo", SAMPLES * sizeof(float), runs, body));
+            }
+        }
+        audio_kernels::SetLevel(best);
+    }
+
+    std::string row_key(const Result& result)
+    {
+        return result.case_name + '|' + result.asset;
+    }
+
+    bool write_csv(const fs::path& filename, const std::vector<Result>& results)
+    {
+        std::ofstream out{ filename };
+        if (!out)
+        {
+            std::cerr << "Failed to write " << filename << '\n';
+            return false;
+        }
+        out << "case,asset,bytes,runs,cold_ms,min_ms,median_ms,mean_ms,max_ms\n";
+        for (const Result& r : results)
+            out << r.case_name << ',' << r.asset << ',' << r.bytes << ',' << r.runs << ',' << r.cold_ms << ',' << r.min_ms << ',' << r.median << ',' << r.mean << ',' << r.max_ms << '\n';
+        return static_cast<bool>(out);
+    }
+
+    // case|asset -> warm median from an earlier write_csv
+    std::map<std::string, double> read_baseline(const fs::path& filename)
+    {
+        std::map<std::string, double> medians;
+        std::ifstream                 input{ filename };
+        std::string                   line;
+        std::getline(input, line); // header
+        while (std::getline(input, line))
+        {
+            std::vector<std::string> fields;
+            std::stringstream        stream{ line };
+            for (std::string field; std::getline(stream, field, ',');)
+                fields.push_back(field);
+            if (double median = 0.0; fields.size() == 9 && parse_number(fields[6].c_str(), median))
+                medians[fields[0] + '|' + fields[1]] = median;
+        }
+        return medians;
+    }
+}
+
+int main(int argc, char* argv[])
+try
+{
+    if (find_option(argc, argv, "--help") != nullptr || (argc > 1 && std::string_view{ argv[1] } == "--help"))
+    {
+        print_usage();
+        return 0;
+    }
+    Options options;
+    if (const char* runs = find_option(argc, argv, "--runs"); runs != nullptr && (!parse_number(runs, options.runs) || options.runs <= 0))
+    {
+        print_usage();
+        return 1;
+    }
+    if (const char* tolerance = find_option(argc, argv, "--tolerance"); tolerance != nullptr && !parse_number(tolerance, options.tolerance_pct))
+    {
+        print_usage();
+        return 1;
+    }
+    if (const char* csv = find_option(argc, argv, "--csv"); csv != nullptr)
+        options.csv = csv;
+    if (const char* baseline = find_option(argc, argv, "--baseline"); baseline != nullptr)
+        options.baseline = baseline;
+    resolve_asset_root(argc, argv);
+
+    // a hidden window is the portable way to get a GL context; nothing is ever shown
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
+    {
+        std::cerr << "Failed to init SDL: " << SDL_GetError() << '\n';
+        return 1;
+    }
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_Window*   window     = SDL_CreateWindow("load-benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    SDL_GLContext gl_context = window != nullptr ? SDL_GL_CreateContext(window) : nullptr;
+    if (gl_context == nullptr || glewInit() != GLEW_OK)
+    {
+        std::cerr << "Failed to create a GL context: " << SDL_GetError() << '\n';
+        return 1;
+    }
+    ALCdevice*  al_device  = alcOpenDevice(nullptr);
+    ALCcontext* al_context = al_device != nullptr ? alcCreateContext(al_device, nullptr) : nullptr;
+    if (al_context == nullptr || !alcMakeContextCurrent(al_context))
+    {
+        std::cerr << "Failed to open an OpenAL device\n";
+        return 1;
+    }
+    DetectAudioFormats();
+
+    std::vector<Result> results;
+    benchmark_images(options.runs, results);
+    benchmark_uploads(options.runs, results);
+    benchmark_sounds(options.runs, results);
+    benchmark_kernels(options.runs, results);
+
+    const std::map<std::string, double> baseline = options.baseline.empty() ? std::map<std::string, double>{} : read_baseline(options.baseline);
+    bool                                regressed = false;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::left << std::setw(28) << "case" << std::setw(28) << "asset" << std::right << std::setw(12) << "KB" << std::setw(10) << "cold ms" << std::setw(10) << "median"
+              << std::setw(10) << "min" << std::setw(10) << "max" << (baseline.empty() ? "" : "  vs baseline") << '\n';
+    for (const Result& r : results)
+    {
+        std::cout << std::left << std::setw(28) << r.case_name << std::setw(28) << r.asset << std::right << std::setw(12) << static_cast<double>(r.bytes) / 1024.0 << std::setw(10)
+                  << r.cold_ms << std::setw(10) << r.median << std::setw(10) << r.min_ms << std::setw(10) << r.max_ms;
+        if (const auto it = baseline.find(row_key(r)); it != baseline.end() && it->second > 0.0)
+        {
+            const double change_pct = (r.median / it->second - 1.0) * 100.0;
+            const bool   worse      = change_pct > options.tolerance_pct;
+            regressed               = regressed || worse;
+            std::cout << "  " << std::showpos << std::setprecision(1) << change_pct << '%' << std::noshowpos << std::setprecision(3) << (worse ? " REGRESSED" : "");
+        }
+        std::cout << '\n';
+    }
+    if (!options.csv.empty() && write_csv(options.csv, results))
+        std::cout << "wrote " << options.csv << '\n';
+
+    alcMakeContextCurrent(nullptr);
+    alcDestroyContext(al_context);
+    alcCloseDevice(al_device);
+    SDL_GL_DeleteContext(gl_context);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return regressed ? 2 : 0;
+}
+catch (const std::exception& e)
+{
+    std::cerr << e.what() << '\n';
+    return -1;
+}
@@ -0,0 +1,588 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "allocation_counter.h"
+
+#include "imgui_panels.h"
+#include "logger.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <imgui.h>
+#include <new>
+#include <string>
+#include <vector>
+
+#if ALLOCATION_COUNTING && defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <Windows.h>
+// after Windows.h, which it needs
+#    include <DbgHelp.h>
+#    define ALLOCATION_STACKS 1
+#elif ALLOCATION_COUNTING && (defined(__linux__) || defined(__APPLE__))
+#    include <execinfo.h>
+#    define ALLOCATION_STACKS 1
+#else
+#    define ALLOCATION_STACKS 0
+#endif
+
+#if ALLOCATION_COUNTING
+namespace
+{
+    using allocation_counter::Action;
+    using allocation_counter::FrameCounts;
+    using allocation_counter::MAX_STACK;
+    using allocation_counter::MAX_THREADS;
+
+    enum NameState : int
+    {
+        Unnamed,
+        Naming,
+        Named
+    };
+
+    struct ThreadSlot
+    {
+        std::atomic<std::uint64_t> allocations{ 0 };
+        std::atomic<std::uint64_t> bytes{ 0 };
+        std::atomic<int>           name_state{ Unnamed };
+        char                       name[32] = {};
+        // the main thread's, as of the last EndFrame
+        FrameCounts seen;
+        FrameCounts last;
+    };
+
+    struct Capture
+    {
+        std::array<void*, MAX_STACK> frames{};
+        int                          depth = 0;
+        std::size_t                  bytes = 0;
+        int                          slot  = 0;
+    };
+
+    // operator new runs before main, so none of this may wait on a constructor
+    constinit std::array<ThreadSlot, MAX_THREADS> gSlots;
+    constinit std::atomic<int>                    gSlotCount{ 0 };
+    constinit std::atomic<bool>                   gSteady{ false };
+    constinit std::atomic<Action>                 gAction{ Action::Log };
+    // the first allocation of a steady stretch takes it, to break on or to capture
+    constinit std::atomic<bool> gArmed{ false };
+    constinit std::atomic<bool> gCaptured{ false };
+    constinit Capture           gCapture; // written by the allocation that took gArmed, read once gCaptured
+    thread_local ThreadSlot*    tSlot      = nullptr;
+    thread_local bool           tCapturing = false; // backtrace can allocate
+
+    // main thread
+    int                      gSettled          = 0; // frames in a row with nothing loading
+    FrameCounts              gLast;
+    std::uint64_t            gSteadyFrames     = 0;
+    std::uint64_t            gAllocatingFrames = 0; // of gSteadyFrames
+    std::vector<std::string> gStack;                // the last capture, resolved
+    char                     gStackThread[40] = {};
+    std::size_t              gStackBytes      = 0;
+
+    int slot_index(const ThreadSlot& slot) noexcept
+    {
+        return static_cast<int>(&slot - gSlots.data());
+    }
+
+    ThreadSlot& this_slot() noexcept
+    {
+        if (tSlot == nullptr)
+        {
+            const int index = gSlotCount.fetch_add(1, std::memory_order_relaxed);
+            tSlot           = &gSlots[static_cast<std::size_t>(std::min(index, MAX_THREADS - 1))];
+        }
+        return *tSlot;
+    }
+
+    int slots_in_use() noexcept
+    {
+        return std::min(gSlotCount.load(std::memory_order_relaxed), MAX_THREADS);
+    }
+
+    const char* slot_name(int index, char (&buffer)[40]) noexcept
+    {
+        const ThreadSlot& slot = gSlots[static_cast<std::size_t>(index)];
+        if (slot.name_state.load(std::memory_order_acquire) == Named)
+            return slot.name;
+        std::snprintf(buffer, sizeof(buffer), "thread %d", index);
+        return buffer;
+    }
+
+    void capture(const ThreadSlot& slot, std::size_t bytes) noexcept
+    {
+#if ALLOCATION_STACKS
+        tCapturing = true;
+#    if defined(_WIN32)
+        gCapture.depth = CaptureStackBackTrace(0, MAX_STACK, gCapture.frames.data(), nullptr);
+#    else
+        gCapture.depth = backtrace(gCapture.frames.data(), MAX_STACK);
+#    endif
+        gCapture.bytes = bytes;
+        gCapture.slot  = slot_index(slot);
+        tCapturing     = false;
+        gCaptured.store(true, std::memory_order_release);
+#else
+        (void)slot;
+        (void)bytes;
+#endif
+    }
+
+    void on_steady_allocation(const ThreadSlot& slot, std::size_t bytes) noexcept
+    {
+        const Action action = gAction.load(std::memory_order_relaxed);
+        if (action != Action::Break && action != Action::Capture)
+            return;
+        if (!gArmed.exchange(false, std::memory_order_acquire))
+            return;
+        if (action == Action::Break)
+            SDL_TriggerBreakpoint();
+        else
+            capture(slot, bytes);
+    }
+
+    void count(std::size_t bytes) noexcept
+    {
+        ThreadSlot& slot = this_slot();
+        slot.allocations.fetch_add(1, std::memory_order_relaxed);
+        slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (gSteady.load(std::memory_order_relaxed) && !tCapturing) [[unlikely]]
+            on_steady_allocation(slot, bytes);
+    }
+
+    // symbols are looked up here on the main thread, never inside the allocation
+    void resolve_capture()
+    {
+        gStack.clear();
+        char buffer[40];
+        SDL_strlcpy(gStackThread, slot_name(gCapture.slot, buffer), sizeof(gStackThread));
+        gStackBytes = gCapture.bytes;
+#if ALLOCATION_STACKS && defined(_WIN32)
+        const HANDLE      process     = GetCurrentProcess();
+        static const bool has_symbols = SymInitialize(process, nullptr, TRUE) != FALSE;
+        alignas(SYMBOL_INFO) char storage[sizeof(SYMBOL_INFO) + 256];
+        auto*                     symbol = reinterpret_cast<SYMBOL_INFO*>(storage);
+        symbol->SizeOfStruct             = sizeof(SYMBOL_INFO);
+        symbol->MaxNameLen               = 255;
+        for (int i = 0; i < gCapture.depth; ++i)
+        {
+            const auto      address = reinterpret_cast<DWORD64>(gCapture.frames[static_cast<std::size_t>(i)]);
+            char            text[512];
+            DWORD           column = 0;
+            IMAGEHLP_LINE64 line{};
+            line.SizeOfStruct = sizeof(line);
+            if (!has_symbols || !SymFromAddr(process, address, nullptr, symbol))
+                std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(address));
+            else if (SymGetLineFromAddr64(process, address, &column, &line))
+                std::snprintf(text, sizeof(text), "%s  %s:%lu", symbol->Name, line.FileName, line.LineNumber);
+            else
+                std::snprintf(text, sizeof(text), "%s", symbol->Name);
+            gStack.emplace_back(text);
+        }
+#elif ALLOCATION_STACKS
+        char** symbols = backtrace_symbols(gCapture.frames.data(), gCapture.depth);
+        for (int i = 0; i < gCapture.depth; ++i)
+        {
+            if (symbols != nullptr)
+            {
+                gStack.emplace_back(symbols[i]);
+                continue;
+            }
+            char text[32];
+            std::snprintf(text, sizeof(text), "%p", gCapture.frames[static_cast<std::size_t>(i)]);
+            gStack.emplace_back(text);
+        }
+        std::free(symbols);
+#endif
+    }
+
+    // false when the action asks for nothing, so settling carries on
+    bool report(const FrameCounts& frame)
+    {
+        const Action action = gAction.load(std::memory_order_relaxed);
+        if (action == Action::Off)
+            return false;
+        int busiest = 0;
+        for (int i = 1; i < slots_in_use(); ++i)
+        {
+            if (gSlots[static_cast<std::size_t>(i)].last.allocations > gSlots[static_cast<std::size_t>(busiest)].last.allocations)
+                busiest = i;
+        }
+        char buffer[40];
+        if (action != Action::Break)
+            LOG_WARN("Allocation counter: a steady frame made ", frame.allocations, " allocations, ", frame.bytes, " bytes, the most on ", slot_name(busiest, buffer));
+        if (action == Action::Capture && gCaptured.exchange(false, std::memory_order_acquire))
+            resolve_capture();
+        return true;
+    }
+
+    void* allocate(std::size_t bytes)
+    {
+        count(bytes);
+        for (;;)
+        {
+            if (void* block = std::malloc(bytes == 0 ? 1 : bytes); block != nullptr)
+                return block;
+            const std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr)
+                throw std::bad_alloc{};
+            handler();
+        }
+    }
+
+    void* allocate_aligned(std::size_t bytes, std::align_val_t alignment)
+    {
+        count(bytes);
+        const auto align = static_cast<std::size_t>(alignment);
+        for (;;)
+        {
+#    if defined(_WIN32)
+            void* block = _aligned_malloc(bytes == 0 ? 1 : bytes, align);
+#    else
+            // aligned_alloc wants a whole number of alignments
+            void* block = std::aligned_alloc(align, (std::max<std::size_t>(bytes, 1) + align - 1) / align * align);
+#    endif
+            if (block != nullptr)
+                return block;
+            const std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr)
+                throw std::bad_alloc{};
+            handler();
+        }
+    }
+
+    void release_aligned(void* block) noexcept
+    {
+#    if defined(_WIN32)
+        _aligned_free(block);
+#    else
+        std::free(block);
+#    endif
+    }
+
+    SDL_malloc_func  gSdlMalloc  = nullptr;
+    SDL_calloc_func  gSdlCalloc  = nullptr;
+    SDL_realloc_func gSdlRealloc = nullptr;
+    SDL_free_func    gSdlFree    = nullptr;
+
+    void* SDLCALL sdl_malloc(size_t bytes)
+    {
+        count(bytes);
+        return gSdlMalloc(bytes);
+    }
+
+    void* SDLCALL sdl_calloc(size_t elements, size_t size)
+    {
+        count(elements * size);
+        return gSdlCalloc(elements, size);
+    }
+
+    // a realloc counts as an allocation of its new size
+    void* SDLCALL sdl_realloc(void* block, size_t bytes)
+    {
+        count(bytes);
+        return gSdlRealloc(block, bytes);
+    }
+
+    void SDLCALL sdl_free(void* block)
+    {
+        gSdlFree(block);
+    }
+}
+
+void* operator new(std::size_t bytes)
+{
+    return allocate(bytes);
+}
+
+void* operator new[](std::size_t bytes)
+{
+    return allocate(bytes);
+}
+
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return allocate(bytes);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept
+{
+    return operator new(bytes, std::nothrow);
+}
+
+void* operator new(std::size_t bytes, std::align_val_t alignment)
+{
+    return allocate_aligned(bytes, alignment);
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t alignment)
+{
+    return allocate_aligned(bytes, alignment);
+}
+
+void* operator new(std::size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return allocate_aligned(bytes, alignment);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return operator new(bytes, alignment, std::nothrow);
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept
+{
+    release_aligned(block);
+}
+
+void operator delete[](void* block, std::align_val_t) noexcept
+{
+    release_aligned(block);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept
+{
+    release_aligned(block);
+}
+
+void operator delete[](void* block, std::size_t, std::align_val_t) noexcept
+{
+    release_aligned(block);
+}
+
+void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    release_aligned(block);
+}
+
+void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    release_aligned(block);
+}
+#endif
+
+namespace allocation_counter
+{
+    void InstallSdlHooks()
+    {
+#if ALLOCATION_COUNTING
+        if (gSdlMalloc != nullptr)
+            return;
+        SDL_GetOriginalMemoryFunctions(&gSdlMalloc, &gSdlCalloc, &gSdlRealloc, &gSdlFree);
+        if (SDL_SetMemoryFunctions(sdl_malloc, sdl_calloc, sdl_realloc, sdl_free) != 0)
+            LOG_WARN("Allocation counter: SDL's allocations won't be counted: ", SDL_GetError());
+#endif
+    }
+
+    void Count(std::size_t bytes) noexcept
+    {
+#if ALLOCATION_COUNTING
+        count(bytes);
+#else
+        (void)bytes;
+#endif
+    }
+
+    void NameThread(const char* name) noexcept
+    {
+#if ALLOCATION_COUNTING
+        ThreadSlot& slot     = this_slot();
+        int         expected = Unnamed;
+        if (!slot.name_state.compare_exchange_strong(expected, Naming, std::memory_order_relaxed))
+            return;
+        SDL_strlcpy(slot.name, name, sizeof(slot.name));
+        slot.name_state.store(Named, std::memory_order_release);
+#else
+        (void)name;
+#endif
+    }
+
+    void EndFrame(bool loading)
+    {
+#if ALLOCATION_COUNTING
+        FrameCounts frame;
+        for (int i = 0; i < slots_in_use(); ++i)
+        {
+            ThreadSlot&       slot = gSlots[static_cast<std::size_t>(i)];
+            const FrameCounts now{ slot.allocations.load(std::memory_order_relaxed), slot.bytes.load(std::memory_order_relaxed) };
+            slot.last.allocations = now.allocations - slot.seen.allocations;
+            slot.last.bytes       = now.bytes - slot.seen.bytes;
+            slot.seen             = now;
+            frame.allocations += slot.last.allocations;
+            frame.bytes += slot.last.bytes;
+        }
+        gLast = frame;
+
+        bool reported = false;
+        if (gSteady.load(std::memory_order_relaxed))
+        {
+            ++gSteadyFrames;
+            if (frame.allocations > 0)
+            {
+                ++gAllocatingFrames;
+                reported = report(frame);
+            }
+        }
+        gSettled          = loading || reported ? 0 : gSettled + 1;
+        const bool steady = gSettled >= SETTLE_FRAMES;
+        if (steady && !gSteady.load(std::memory_order_relaxed))
+            gArmed.store(true, std::memory_order_release);
+        gSteady.store(steady, std::memory_order_relaxed);
+#else
+        (void)loading;
+#endif
+    }
+
+    FrameCounts LastFrame() noexcept
+    {
+#if ALLOCATION_COUNTING
+        return gLast;
+#else
+        return {};
+#endif
+    }
+
+    bool IsSteady() noexcept
+    {
+#if ALLOCATION_COUNTING
+        return gSteady.load(std::memory_order_relaxed);
+#else
+        return false;
+#endif
+    }
+
+    bool IsEnabled() noexcept
+    {
+        return ALLOCATION_COUNTING != 0;
+    }
+
+    void SetAction(Action action) noexcept
+    {
+#if ALLOCATION_COUNTING
+        gAction.store(action, std::memory_order_relaxed);
+#else
+        (void)action;
+#endif
+    }
+
+    Action GetAction() noexcept
+    {
+#if ALLOCATION_COUNTING
+        return gAction.load(std::memory_order_relaxed);
+#else
+        return Action::Off;
+#endif
+    }
+
+    void DrawImGui()
+    {
+        if (!imgui_panels::Begin("Allocations", 4.0f))
+        {
+            imgui_panels::End();
+            return;
+        }
+#if ALLOCATION_COUNTING
+        ImGui::Text("last frame: %llu allocations, %.1f KB", static_cast<unsigned long long>(gLast.allocations), static_cast<double>(gLast.bytes) / 1024.0);
+        if (IsSteady())
+            ImGui::Text("steady for %llu frames, %llu of them allocated", static_cast<unsigned long long>(gSteadyFrames), static_cast<unsigned long long>(gAllocatingFrames));
+        else
+            ImGui::Text("settling: %d of %d frames with nothing loading", gSettled, SETTLE_FRAMES);
+
+        constexpr const char* ACTION_NAMES[] = { "nothing", "log it", "break", "capture the stack" };
+        int                   action         = static_cast<int>(GetAction());
+        if (ImGui::Combo("on a steady allocation", &action, ACTION_NAMES, IM_ARRAYSIZE(ACTION_NAMES)))
+            SetAction(static_cast<Action>(action));
+        if (!ALLOCATION_STACKS && GetAction() == Action::Capture)
+            ImGui::TextDisabled("%s", "no call stacks on this platform");
+
+        if (ImGui::BeginTable("allocation threads", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("thread");
+            ImGui::TableSetupColumn("last frame");
+            ImGui::TableSetupColumn("KB");
+            ImGui::TableSetupColumn("all");
+            ImGui::TableHeadersRow();
+            for (int i = 0; i < slots_in_use(); ++i)
+            {
+                const ThreadSlot& slot = gSlots[static_cast<std::size_t>(i)];
+                char              buffer[40];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(slot_name(i, buffer));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(slot.last.allocations));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", static_cast<double>(slot.last.bytes) / 1024.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(slot.seen.allocations));
+            }
+            ImGui::EndTable();
+        }
+
+        if (!gStack.empty())
+        {
+            ImGui::SeparatorText("last captured");
+            ImGui::Text("%zu bytes on %s, from the allocating call out:", gStackBytes, gStackThread);
+            for (const std::string& frame : gStack)
+                ImGui::TextUnformatted(frame.c_str());
+        }
+#else
+        ImGui::Text("%s", "Allocation counting compiled out (ALLOCATION_COUNTING=0)");
+#endif
+        imgui_panels::End();
+    }
+}
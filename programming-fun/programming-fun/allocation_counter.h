@@ -0,0 +1,75 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Replaces the global operator new and delete to count every allocation, by thread; Debug builds count, the
+// others don't unless the project defines ALLOCATION_COUNTING=1
+#if !defined(ALLOCATION_COUNTING)
+#    if defined(NDEBUG)
+#        define ALLOCATION_COUNTING 0
+#    else
+#        define ALLOCATION_COUNTING 1
+#    endif
+#endif
+
+/**
+ * How many heap allocations each frame makes, and which thread made them, to hold the game to none once it
+ * has settled.
+ *
+ * The replaced operator new counts C++ allocations; SDL's and ImGui's heaps are counted through their
+ * allocator hooks, so InstallSdlHooks has to come first thing in main, before SDL allocates anything. C
+ * libraries and the GL driver calling malloc directly aren't seen. Each thread counts into its own slot with
+ * no lock, and EndFrame turns the slots into the last frame's numbers, so another thread's count is whatever
+ * it made between two of the main thread's frames.
+ *
+ * A frame is steady once nothing has been loading for SETTLE_FRAMES frames in a row. What an allocation in a
+ * steady frame does is the Action: nothing, a warning in the log, a breakpoint right there in the allocating
+ * call, or its call stack kept for DrawImGui. Reporting one starts the settling over, so the report's own
+ * allocations aren't blamed on the frame after it.
+ */
+namespace allocation_counter
+{
+    constexpr int MAX_THREADS   = 64; // threads past this share the last slot
+    constexpr int SETTLE_FRAMES = 120;
+    constexpr int MAX_STACK     = 32;
+
+    enum class Action : std::uint8_t
+    {
+        Off,
+        Log,
+        Break,
+        Capture
+    };
+
+    struct FrameCounts
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes       = 0;
+    };
+
+    // Call before SDL_Init; a no-op without ALLOCATION_COUNTING
+    void InstallSdlHooks();
+    // Counts an allocation made outside operator new, like ImGui's allocator hook
+    void Count(std::size_t bytes) noexcept;
+    // Labels the calling thread's slot; profiler::SetThreadName passes its names on
+    void NameThread(const char* name) noexcept;
+
+    // Main thread, once a frame at its end; `loading` holds steady state off
+    void EndFrame(bool loading);
+
+    FrameCounts LastFrame() noexcept;
+    bool        IsSteady() noexcept;
+    bool        IsEnabled() noexcept;
+    void        SetAction(Action action) noexcept;
+    Action      GetAction() noexcept;
+
+    void DrawImGui();
+}
@@ -0,0 +1,249 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "animated_sprite_renderer.h"
+
+#include "gl_backend.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "memory_tracker.h"
+#include "vertex_layout.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace
+{
+    // the tables' rows are TABLE_WIDTH texels, which the shader's index & 1023, index >> 10 assumes
+    constexpr const char* ANIMATED_VERTEX_SHADER = R"(
+layout(location = 0) in vec2  aPosition;
+layout(location = 1) in vec2  aSize;
+layout(location = 2) in vec4  aColor;
+layout(location = 3) in uint  aClip;
+layout(location = 4) in float aStartTime;
+layout(location = 5) in float aSpeed;
+
+uniform mat4            uProjection;
+uniform vec4            uUVRect; // the sheet in the texture
+uniform float           uTime;
+uniform highp sampler2D uClips;  // first frame, frame count, length, loops
+uniform highp sampler2D uFrames; // uv rect, then end time, per frame
+
+out vec2 vTexCoord;
+out vec4 vColor;
+
+ivec2 at(int index)
+{
+    return ivec2(index & 1023, index >> 10);
+}
+
+void main()
+{
+    // triangle strip corners (0,0) (1,0) (0,1) (1,1)
+    vec2  corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec4  clip   = texelFetch(uClips, at(int(aClip)), 0);
+    int   first  = int(clip.x);
+    int   count  = int(clip.y);
+    float t      = (uTime - aStartTime) * aSpeed;
+    t            = clip.w > 0.5 ? t - clip.z * floor(t / max(clip.z, 1e-6)) : clamp(t, 0.0, clip.z);
+    int   frame  = max(count - 1, 0);
+    for (int i = 0; i < count - 1; ++i)
+    {
+        if (t < texelFetch(uFrames, at((first + i) * 2 + 1), 0).x)
+        {
+            frame = i;
+            break;
+        }
+    }
+    vec4 rect   = texelFetch(uFrames, at((first + frame) * 2), 0);
+    vec2 uv     = mix(rect.xy, rect.zw, corner);
+    vTexCoord   = mix(uUVRect.xy, uUVRect.zw, uv);
+    // a clip with no frames, or past the clips there are, covers nothing
+    vColor      = count > 0 ? aColor : vec4(0.0);
+    vec2 world  = aPosition + (corner - 0.5) * aSize * (count > 0 ? 1.0 : 0.0);
+    gl_Position = uProjection * vec4(world, 0.0, 1.0);
+}
+)";
+
+    constexpr const char* ANIMATED_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+in vec4 vColor;
+
+uniform sampler2D uTexture;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture(uTexture, vTexCoord) * vColor;
+}
+)";
+
+    constexpr GLsizei TABLE_WIDTH = 1024;
+
+    constexpr auto ANIMATED_LAYOUT = vertex_layout::PerInstance(vertex_layout::Make<AnimatedSprite>(
+        VertexAttribute{ 0, attribute_format::Float2, offsetof(AnimatedSprite, position) }, VertexAttribute{ 1, attribute_format::Float2, offsetof(AnimatedSprite, size) },
+        VertexAttribute{ 2, attribute_format::UByte4Norm, offsetof(AnimatedSprite, color) }, VertexAttribute{ 3, attribute_format::UInt1, offsetof(AnimatedSprite, clip) },
+        VertexAttribute{ 4, attribute_format::Float1, offsetof(AnimatedSprite, start_time) }, VertexAttribute{ 5, attribute_format::Float1, offsetof(AnimatedSprite, speed) }));
+
+    GLuint make_table_texture()
+    {
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        gl_state::BindTexture(texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        return texture;
+    }
+
+    // pads `texels` to whole rows and uploads them; returns the bytes the texture holds
+    std::size_t upload_table(GLuint texture, std::vector<glm::vec4>& texels)
+    {
+        const auto rows = static_cast<GLsizei>(std::max<std::size_t>((texels.size() + TABLE_WIDTH - 1) / TABLE_WIDTH, 1));
+        texels.resize(static_cast<std::size_t>(rows) * TABLE_WIDTH);
+        gl_state::BindTexture(texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, TABLE_WIDTH, rows, 0, GL_RGBA, GL_FLOAT, texels.data());
+        gl_stats::CountUpload(texels.size() * sizeof(glm::vec4));
+        return texels.size() * sizeof(glm::vec4);
+    }
+}
+
+void AnimatedSpriteRenderer::Setup()
+{
+    program.Request(ANIMATED_VERTEX_SHADER, ANIMATED_FRAGMENT_SHADER);
+
+    glGenVertexArrays(1, &vertex_array);
+    glGenBuffers(1, &sprite_buffer);
+    gl_state::BindVertexArray(vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, sprite_buffer);
+    vertex_layout::Enable(ANIMATED_LAYOUT);
+    vertex_layout::Bind(ANIMATED_LAYOUT);
+
+    gl_state::ActiveTexture(0);
+    clip_texture  = make_table_texture();
+    frame_texture = make_table_texture();
+}
+
+void AnimatedSpriteRenderer::Shutdown()
+{
+    if (sprite_buffer != 0)
+        glDeleteBuffers(1, &sprite_buffer);
+    gl_state::DeleteVertexArray(vertex_array);
+    gl_state::DeleteTexture(clip_texture);
+    gl_state::DeleteTexture(frame_texture);
+    program.Reset();
+    memory_tracker::Free(MemoryCategory::Geometry, sprite_bytes);
+    memory_tracker::Free(MemoryCategory::Textures, table_bytes);
+    sprite_buffer       = 0;
+    vertex_array        = 0;
+    clip_texture        = 0;
+    frame_texture       = 0;
+    sprite_count        = 0;
+    sprite_bytes        = 0;
+    table_bytes         = 0;
+    pending_upload      = 0;
+    projection_location = -1;
+    uv_rect_location    = -1;
+    time_location       = -1;
+    clip_texels.clear();
+    frame_texels.clear();
+}
+
+SpriteClipId AnimatedSpriteRenderer::AddClip(std::span<const SpriteClipFrame> frames, bool loops)
+{
+    // uploads pad the tables, so they are trimmed back to what the clips use first
+    const auto clip  = static_cast<SpriteClipId>(stats.clips);
+    const auto first = static_cast<float>(stats.frames);
+    clip_texels.resize(static_cast<std::size_t>(stats.clips));
+    frame_texels.resize(static_cast<std::size_t>(stats.frames) * 2);
+    float length = 0.0f;
+    for (const SpriteClipFrame& frame : frames)
+    {
+        length += std::max(frame.seconds, 0.0f);
+        frame_texels.push_back(frame.uv_rect);
+        frame_texels.push_back(glm::vec4{ length, 0.0f, 0.0f, 0.0f });
+    }
+    clip_texels.push_back(glm::vec4{ first, static_cast<float>(frames.size()), length, loops ? 1.0f : 0.0f });
+    stats.clips     += 1;
+    stats.frames    += static_cast<int>(frames.size());
+    are_clips_dirty = true;
+    return clip;
+}
+
+void AnimatedSpriteRenderer::SetSprites(std::span<const AnimatedSprite> sprites)
+{
+    memory_tracker::Free(MemoryCategory::Geometry, sprite_bytes);
+    sprite_bytes = sprites.size_bytes();
+    sprite_count = static_cast<int>(sprites.size());
+    gl_backend::Get().buffer_data(sprite_buffer, static_cast<GLsizeiptr>(sprite_bytes), sprites.data(), GL_STATIC_DRAW);
+    memory_tracker::Allocate(MemoryCategory::Geometry, sprite_bytes);
+    gl_stats::CountUpload(sprite_bytes);
+    pending_upload += sprite_bytes;
+}
+
+void AnimatedSpriteRenderer::Draw(const glm::mat4& projection, GLuint texture, const glm::vec4& uv_rect, float time)
+{
+    // the clip counts live in the stats, so only what's per frame starts over
+    stats.sprites     = sprite_count;
+    stats.draw_calls  = 0;
+    stats.upload_size = static_cast<int>(pending_upload);
+    stats.pending     = false;
+    pending_upload    = 0;
+    if (sprite_count == 0 || texture == 0)
+        return;
+    if (!program.IsReady())
+    {
+        if (!program.Poll())
+        {
+            stats.pending = true;
+            return;
+        }
+        projection_location = glGetUniformLocation(program.Id(), "uProjection");
+        uv_rect_location    = glGetUniformLocation(program.Id(), "uUVRect");
+        time_location       = glGetUniformLocation(program.Id(), "uTime");
+        gl_state::UseProgram(program.Id());
+        glUniform1i(glGetUniformLocation(program.Id(), "uTexture"), 0);
+        glUniform1i(glGetUniformLocation(program.Id(), "uClips"), 1);
+        glUniform1i(glGetUniformLocation(program.Id(), "uFrames"), 2);
+    }
+    if (are_clips_dirty)
+        uploadClips();
+
+    gl_state::SetEnabled(GL_BLEND, true);
+    gl_state::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::ActiveTexture(1);
+    gl_state::BindTexture(clip_texture);
+    gl_state::ActiveTexture(2);
+    gl_state::BindTexture(frame_texture);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(texture);
+    gl_state::UseProgram(program.Id());
+    glUniformMatrix4fv(projection_location, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform4fv(uv_rect_location, 1, glm::value_ptr(uv_rect));
+    glUniform1f(time_location, time);
+    gl_state::BindVertexArray(vertex_array);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, sprite_count);
+    gl_stats::CountDraw(2 * static_cast<long long>(sprite_count)); // one quad per instance
+    stats.draw_calls = 1;
+}
+
+const AnimatedSpriteRenderer::Stats& AnimatedSpriteRenderer::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+void AnimatedSpriteRenderer::uploadClips()
+{
+    memory_tracker::Free(MemoryCategory::Textures, table_bytes);
+    gl_state::ActiveTexture(0);
+    table_bytes = upload_table(clip_texture, clip_texels) + upload_table(frame_texture, frame_texels);
+    memory_tracker::Allocate(MemoryCategory::Textures, table_bytes);
+    stats.upload_size += static_cast<int>(table_bytes);
+    are_clips_dirty = false;
+}
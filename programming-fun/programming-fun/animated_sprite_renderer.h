@@ -0,0 +1,98 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "shader.h"
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+// One frame of a clip: where it is in the sheet, [0, 1] across the sheet's uv rect, and how long it shows
+struct SpriteClipFrame
+{
+    glm::vec4 uv_rect{ 0.0f, 0.0f, 1.0f, 1.0f }; // u0, v0, u1, v1
+    float     seconds = 0.1f;
+};
+
+using SpriteClipId = std::uint32_t;
+
+// 32 bytes, what the GPU gets as is
+struct AnimatedSprite
+{
+    glm::vec2     position{ 0.0f }; // center
+    glm::vec2     size{ 0.0f };
+    std::uint32_t color      = 0xFFFFFFFFu; // RGBA8, R in the low byte
+    SpriteClipId  clip       = 0;
+    float         start_time = 0.0f; // on Draw's clock, when the clip's first frame shows
+    float         speed      = 1.0f; // clip seconds per second, negative plays it backwards
+};
+
+/**
+ * Sprites that play clips of a sprite sheet with no CPU work per frame, however many there are.
+ *
+ * The clips go into two float textures once: a texel per clip with its first frame, frame count, length
+ * and whether it loops, and two per frame with the frame's uv rect and the clip time it ends at. The
+ * sprites are uploaded by SetSprites and then stay put in a static buffer, each carrying only its clip,
+ * start time and speed. Draw sets the time uniform and issues one instanced draw; the vertex shader turns
+ * the time into the clip's time, finds the frame by walking the clip's end times, so clips are meant to be
+ * tens of frames, and maps its rect into the sheet's uv rect. The textures are fetched by index, which
+ * ES 3.0 and WebGL2 have, so every platform takes the same path.
+ */
+class AnimatedSpriteRenderer
+{
+public:
+    struct Stats
+    {
+        int  sprites     = 0;
+        int  clips       = 0;
+        int  frames      = 0;
+        int  draw_calls  = 0;
+        int  upload_size = 0;     // bytes sent this frame, 0 unless the clips or the sprites changed
+        bool pending     = false; // the program is still compiling, so nothing was drawn
+    };
+
+    void Setup();
+    void Shutdown();
+
+    // Any time before the Draw that uses it; a clip without frames shows nothing
+    SpriteClipId AddClip(std::span<const SpriteClipFrame> frames, bool loops = true);
+    // Replaces every sprite; the one upload they cost
+    void SetSprites(std::span<const AnimatedSprite> sprites);
+    // The sprites from the last SetSprites, at `time` on the clock their start times are on
+    void Draw(const glm::mat4& projection, GLuint texture, const glm::vec4& uv_rect, float time);
+
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    // the clip tables to their textures when AddClip changed them
+    void uploadClips();
+
+private:
+    ShaderProgram program;
+    GLint         projection_location = -1;
+    GLint         uv_rect_location    = -1;
+    GLint         time_location       = -1;
+    GLuint        vertex_array        = 0;
+    GLuint        sprite_buffer       = 0;
+    GLuint        clip_texture        = 0;
+    GLuint        frame_texture       = 0;
+    int           sprite_count        = 0;
+    std::size_t   sprite_bytes        = 0; // what the buffer holds, for the memory tracker
+    std::size_t   table_bytes         = 0; // both textures
+    std::size_t   pending_upload      = 0; // bytes SetSprites sent since the last Draw
+    bool          are_clips_dirty     = false;
+
+    std::vector<glm::vec4> clip_texels;  // first frame, frame count, length, loops
+    std::vector<glm::vec4> frame_texels; // uv rect, then end time
+    Stats                  stats;
+};
@@ -0,0 +1,287 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "app_config.h"
+
+#include "logger.h"
+#include "sound_cache.h"
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    template <typename T>
+    bool parse_number(std::string_view text, T& out_value)
+    {
+        T value{};
+        if (const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value); error != std::errc{} || end != text.data() + text.size())
+            return false;
+        out_value = value;
+        return true;
+    }
+
+    bool parse_switch(std::string_view text, bool& out_value)
+    {
+        if (text == "on")
+            out_value = true;
+        else if (text == "off")
+            out_value = false;
+        else
+            return false;
+        return true;
+    }
+
+    std::string format_switch(bool value)
+    {
+        return value ? "on" : "off";
+    }
+
+    std::string format_number(double value)
+    {
+        std::ostringstream text;
+        text << value;
+        return text.str();
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        constexpr std::string_view SPACE = " \t\r";
+        const std::size_t          begin = text.find_first_not_of(SPACE);
+        if (begin == std::string_view::npos)
+            return {};
+        return text.substr(begin, text.find_last_not_of(SPACE) - begin + 1);
+    }
+
+    bool parse_tier(std::string_view text, QualityTier& out_tier)
+    {
+        constexpr std::array TIERS{ QualityTier::Auto, QualityTier::Low, QualityTier::Medium, QualityTier::High };
+        for (const QualityTier tier : TIERS)
+        {
+            if (text == app_config::TierName(tier))
+            {
+                out_tier = tier;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // clang-format off
+    constexpr std::array KEYS{
+        app_config::Key{ "quality", "auto, low, medium or high", false,
+            [](std::string_view value, AppConfig& config) { return parse_tier(value, config.quality); },
+            [](const AppConfig& config) { return std::string{ app_config::TierName(config.quality) }; } },
+        app_config::Key{ "gpu", "performance, battery-saver or system", false,
+            [](std::string_view value, AppConfig& config) { return gpu_preference::Parse(value, config.gpu); },
+            [](const AppConfig& config) { return std::string{ gpu_preference::Name(config.gpu) }; } },
+        app_config::Key{ "window", "width x height, e.g. 1280x720", false,
+            [](std::string_view value, AppConfig& config)
+            {
+                const std::size_t x = value.find('x');
+                glm::ivec2        size{ 0 };
+                if (x == std::string_view::npos || !parse_number(value.substr(0, x), size.x) || !parse_number(value.substr(x + 1), size.y) || size.x <= 0 || size.y <= 0)
+                    return false;
+                config.window_size = size;
+                return true;
+            },
+            [](const AppConfig& config) { return std::to_string(config.window_size.x) + "x" + std::to_string(config.window_size.y); } },
+        app_config::Key{ "pacing", "vsync, adaptive, half, uncapped or a frame rate", true,
+            [](std::string_view value, AppConfig& config) { return FramePacer::Parse(value, config.pacing); },
+            [](const AppConfig& config) { return FramePacer::Format(config.pacing); } },
+        app_config::Key{ "frames-in-flight", "1 to 3, fewer for lower input latency", true,
+            [](std::string_view value, AppConfig& config)
+            { return parse_number(value, config.pacing.frames_in_flight) && config.pacing.frames_in_flight >= 1 && config.pacing.frames_in_flight <= PacingSettings::MAX_FRAMES_IN_FLIGHT; },
+            [](const AppConfig& config) { return std::to_string(config.pacing.frames_in_flight); } },
+        app_config::Key{ "render-scale", "dynamic or a percentage of the window", true,
+            [](std::string_view value, AppConfig& config) { return DynamicResolution::Parse(value, config.resolution); },
+            [](const AppConfig& config) { return DynamicResolution::Format(config.resolution); } },
+        app_config::Key{ "scene-density", "scene pixels per window point, 0 for the display's own", true,
+            [](std::string_view value, AppConfig& config) { return parse_number(value, config.resolution.scene_density) && config.resolution.scene_density >= 0.0f; },
+            [](const AppConfig& config) { return format_number(static_cast<double>(config.resolution.scene_density)); } },
+        app_config::Key{ "aa", "off, fxaa, msaa2, msaa4, msaa8, or msaaN+fxaa", true,
+            [](std::string_view value, AppConfig& config) { return RenderTarget::Parse(value, config.anti_aliasing); },
+            [](const AppConfig& config) { return RenderTarget::Format(config.anti_aliasing); } },
+        app_config::Key{ "post", "off, or bloom, tonemap and grade joined by '+'", true,
+            [](std::string_view value, AppConfig& config) { return PostProcess::Parse(value, config.post); },
+            [](const AppConfig& config) { return PostProcess::Format(config.post); } },
+        app_config::Key{ "viewports", "on or off", true,
+            [](std::string_view value, AppConfig& config) { return parse_switch(value, config.viewports.enabled); },
+            [](const AppConfig& config) { return format_switch(config.viewports.enabled); } },
+        app_config::Key{ "reactive", "on or off", true,
+            [](std::string_view value, AppConfig& config) { return parse_switch(value, config.reactive); },
+            [](const AppConfig& config) { return format_switch(config.reactive); } },
+        app_config::Key{ "ui-damage", "on or off", true,
+            [](std::string_view value, AppConfig& config) { return parse_switch(value, config.ui_damage); },
+            [](const AppConfig& config) { return format_switch(config.ui_damage); } },
+        app_config::Key{ "workers", "a thread count, 0 for one per core", false,
+            [](std::string_view value, AppConfig& config) { return parse_number(value, config.worker_threads) && config.worker_threads >= 0; },
+            [](const AppConfig& config) { return std::to_string(config.worker_threads); } },
+        app_config::Key{ "pin-workers", "on or off", false,
+            [](std::string_view value, AppConfig& config) { return parse_switch(value, config.pin_workers); },
+            [](const AppConfig& config) { return format_switch(config.pin_workers); } },
+        app_config::Key{ "loads-in-flight", "a count, 0 for the default", true,
+            [](std::string_view value, AppConfig& config) { return parse_number(value, config.loads_in_flight) && config.loads_in_flight >= 0; },
+            [](const AppConfig& config) { return std::to_string(config.loads_in_flight); } },
+        app_config::Key{ "upload-kb", "kilobytes uploaded per frame", true,
+            [](std::string_view value, AppConfig& config) { return parse_number(value, config.upload_kb) && config.upload_kb > 0; },
+            [](const AppConfig& config) { return std::to_string(config.upload_kb); } },
+        app_config::Key{ "upload-ms", "milliseconds of uploads per frame", true,
+            [](std::string_view value, AppConfig& config) { return parse_number(value, config.upload_ms) && config.upload_ms > 0.0; },
+            [](const AppConfig& config) { return format_number(config.upload_ms); } },
+        app_config::Key{ "hitch-ms", "milliseconds a frame may take before a trace of it is written, 0 for never", true,
+            [](std::string_view value, AppConfig& config) { return parse_number(value, config.hitch_ms) && config.hitch_ms >= 0.0; },
+            [](const AppConfig& config) { return format_number(config.hitch_ms); } },
+        app_config::Key{ "telemetry", "off, or host:port of a telemetry-aggregator to stream frame metrics to", false,
+            [](std::string_view value, AppConfig& config)
+            {
+                config.telemetry = value;
+                return !value.empty();
+            },
+            [](const AppConfig& config) { return config.telemetry; } },
+        app_config::Key{ "telemetry-hz", "telemetry datagrams per second, 1 to 60", false,
+            [](std::string_view value, AppConfig& config) { return parse_number(value, config.telemetry_hz) && config.telemetry_hz >= 1 && config.telemetry_hz <= 60; },
+            [](const AppConfig& config) { return std::to_string(config.telemetry_hz); } },
+        app_config::Key{ "audio", "eager, lazy or prewarm", false,
+            [](std::string_view value, AppConfig& config) { return AudioDevice::Parse(value, config.audio); },
+            [](const AppConfig& config) { return AudioDevice::Format(config.audio); } },
+        app_config::Key{ "audio-mix", "default, or frequency=, refresh=, period=, mono=, stereo= separated by commas", true,
+            [](std::string_view value, AppConfig& config) { return AudioDevice::ParseMix(value, config.audio.mix); },
+            [](const AppConfig& config) { return AudioDevice::FormatMix(config.audio.mix); } },
+        app_config::Key{ "sound-storage", "pcm, adpcm or vorbis", false,
+            [](std::string_view value, AppConfig& config) { return SoundCache::Parse(value, config.audio.sound_storage); },
+            [](const AppConfig& config) { return SoundCache::Format(config.audio.sound_storage); } },
+        app_config::Key{ "audio-backend", "openal, or mixer for the software mixer on SDL audio", false,
+            [](std::string_view value, AppConfig& config) { return AudioDevice::ParseBackend(value, config.audio.backend); },
+            [](const AppConfig& config) { return AudioDevice::FormatBackend(config.audio.backend); } },
+    };
+    // clang-format on
+    static_assert(KEYS.size() <= 32, "AppConfig::given has a bit per key");
+}
+
+namespace app_config
+{
+    std::span<const Key> Keys() noexcept
+    {
+        return KEYS;
+    }
+
+    const Key* Find(std::string_view name) noexcept
+    {
+        for (const Key& key : KEYS)
+        {
+            if (key.name == name)
+                return &key;
+        }
+        return nullptr;
+    }
+
+    bool Set(const Key& key, std::string_view value, AppConfig& config)
+    {
+        if (!key.set(value, config))
+            return false;
+        config.given |= 1u << static_cast<unsigned>(&key - KEYS.data());
+        return true;
+    }
+
+    bool IsGiven(const AppConfig& config, std::string_view name) noexcept
+    {
+        const Key* key = Find(name);
+        return key != nullptr && (config.given & (1u << static_cast<unsigned>(key - KEYS.data()))) != 0;
+    }
+
+    const char* TierName(QualityTier tier) noexcept
+    {
+        switch (tier)
+        {
+            case QualityTier::Auto: return "auto";
+            case QualityTier::Low: return "low";
+            case QualityTier::Medium: return "medium";
+            case QualityTier::High: return "high";
+        }
+        return "auto";
+    }
+
+    void ApplyTier(QualityTier tier, AppConfig& config)
+    {
+        AppConfig defaults;
+        switch (tier)
+        {
+            case QualityTier::Auto:
+            case QualityTier::High: break;
+            case QualityTier::Medium:
+                defaults.anti_aliasing = AntiAliasSettings{ .msaa_samples = 2, .fxaa = false };
+                defaults.upload_kb     = defaults.upload_kb / 2;
+                break;
+            case QualityTier::Low:
+                // integrated parts: fewer pixels and no multisampling, with the scale following the GPU timer
+                defaults.resolution    = ResolutionSettings{ .scale = 0.75f, .dynamic = true };
+                defaults.anti_aliasing = AntiAliasSettings{ .msaa_samples = 1, .fxaa = true };
+                defaults.upload_kb     = defaults.upload_kb / 4;
+                defaults.upload_ms     = defaults.upload_ms / 2.0;
+                break;
+        }
+        if (!IsGiven(config, "render-scale"))
+        {
+            config.resolution.scale   = defaults.resolution.scale;
+            config.resolution.dynamic = defaults.resolution.dynamic;
+        }
+        if (!IsGiven(config, "aa"))
+            config.anti_aliasing = defaults.anti_aliasing;
+        if (!IsGiven(config, "upload-kb"))
+            config.upload_kb = defaults.upload_kb;
+        if (!IsGiven(config, "upload-ms"))
+            config.upload_ms = defaults.upload_ms;
+    }
+
+    bool Load(const std::filesystem::path& filename, AppConfig& config)
+    {
+        std::ifstream file{ filename };
+        if (!file)
+            return false;
+        std::string line;
+        for (int number = 1; std::getline(file, line); ++number)
+        {
+            std::string_view text = line;
+            text                  = trim(text.substr(0, text.find('#')));
+            if (text.empty())
+                continue;
+            const std::size_t equals = text.find('=');
+            if (equals == std::string_view::npos)
+            {
+                LOG_WARN(filename, ":", number, ": expected name = value");
+                continue;
+            }
+            const std::string_view name  = trim(text.substr(0, equals));
+            const std::string_view value = trim(text.substr(equals + 1));
+            const Key*             key   = Find(name);
+            if (key == nullptr)
+                LOG_WARN(filename, ":", number, ": unknown setting ", name);
+            else if (!Set(*key, value, config))
+                LOG_WARN(filename, ":", number, ": expected ", key->expected, " for ", name, ", not ", value);
+        }
+        return true;
+    }
+
+    bool Save(const std::filesystem::path& filename, const AppConfig& config)
+    {
+        std::ofstream file{ filename };
+        file << "# any of these can also be given on the command line as --name value, which wins over this file\n";
+        for (const Key& key : KEYS)
+            file << std::left << std::setw(16) << key.name << "= " << key.get(config) << (key.is_live ? "" : "  # next start") << '\n';
+        if (!file)
+        {
+            LOG_ERROR("Failed to write settings ", filename);
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "audio_device.h"
+#include "dynamic_resolution.h"
+#include "frame_pacer.h"
+#include "gpu_preference.h"
+#include "imgui_viewports.h"
+#include "post_process.h"
+#include "render_target.h"
+#include "upload_budget.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <glm/vec2.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Defaults for a class of machine; Auto picks one from hardware_probe at startup
+enum class QualityTier
+{
+    Auto,
+    Low,
+    Medium,
+    High // the defaults of AppConfig itself
+};
+
+// The knobs worth tuning per machine; everything else stays a constant next to the code it tunes
+struct AppConfig
+{
+    QualityTier        quality = QualityTier::Auto;
+    GpuPreference      gpu     = GpuPreference::Performance;
+    glm::ivec2         window_size{ 640, 480 };
+    PacingSettings     pacing;
+    ResolutionSettings resolution;
+    AntiAliasSettings  anti_aliasing;
+    PostSettings       post;
+    ViewportSettings   viewports;
+    AudioSettings      audio;
+    bool               reactive        = false;
+    bool               ui_damage       = false; // redraw only what the UI changed while the scene holds still
+    int                worker_threads  = 0; // 0 for one per core but the main thread's
+    bool               pin_workers     = false; // each worker on its own physical core, where the topology is known
+    int                loads_in_flight = 0; // 0 for the scheduler's default
+    int                upload_kb       = static_cast<int>(UploadBudget::DEFAULT_BYTES / 1024);
+    double             upload_ms       = UploadBudget::DEFAULT_MS;
+    double             hitch_ms        = 100.0; // a frame slower than this writes a trace, 0 for never
+    std::string        telemetry       = "off"; // or the aggregator's host:port
+    int                telemetry_hz    = 4;
+    std::uint32_t      given           = 0; // a bit per app_config::Keys() entry the file or the command line set
+
+    bool operator==(const AppConfig&) const = default;
+};
+
+/**
+ * Reads and writes an AppConfig as text, one "name = value" per line, '#' starting a comment.
+ *
+ * Every name is also a command line option, "--name value", with the same syntax as the file: the file is
+ * read first and the command line wins. Values use the existing parsers (FramePacer::Parse and the like), so
+ * a setting reads the same wherever it is written. Keys marked live apply to a running Application through
+ * its setters and ImGui editors; the rest take effect on the next start. Unknown names and bad values in the
+ * file are logged and skipped so a file from another version still loads.
+ */
+namespace app_config
+{
+    inline constexpr const char* DEFAULT_FILENAME = "settings.cfg";
+
+    struct Key
+    {
+        std::string_view name;
+        std::string_view expected; // for messages about a bad value
+        bool             is_live = false;
+        bool (*set)(std::string_view value, AppConfig& config);
+        std::string (*get)(const AppConfig& config);
+    };
+
+    std::span<const Key> Keys() noexcept;
+    const Key*           Find(std::string_view name) noexcept;
+    // key.set, and remembers the key as given so a quality tier leaves it alone
+    bool Set(const Key& key, std::string_view value, AppConfig& config);
+    bool IsGiven(const AppConfig& config, std::string_view name) noexcept;
+
+    const char* TierName(QualityTier tier) noexcept;
+    // The tier's render scale, anti-aliasing and upload budget, for each of those not given
+    void ApplyTier(QualityTier tier, AppConfig& config);
+
+    // False when there is no such file; anything else wrong in it is logged and skipped
+    bool Load(const std::filesystem::path& filename, AppConfig& config);
+    bool Save(const std::filesystem::path& filename, const AppConfig& config);
+}
@@ -0,0 +1,423 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_browser.h"
+
+#include "asset_pack.h"
+#include "asset_paths.h"
+#include "decode_scratch.h"
+#include "decoded_cache.h"
+#include "gl_backend.h"
+#include "gl_state.h"
+#include "imgui_renderer.h"
+#include "memory_tracker.h"
+#include "mip_chain.h"
+#include "upload_budget.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <stb_image.h>
+#include <string>
+#include <utility>
+
+namespace
+{
+    constexpr int         ATLAS_SIZE  = AssetBrowser::THUMBNAIL_SIZE * AssetBrowser::ATLAS_SIDE;
+    constexpr std::size_t ATLAS_BYTES = static_cast<std::size_t>(ATLAS_SIZE) * ATLAS_SIZE * 4;
+
+    // what stb_image decodes and what SoundCache loads; anything else under the root isn't listed
+    bool kind_of(const std::filesystem::path& path, AssetKind& out_kind)
+    {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" || extension == ".tga")
+        {
+            out_kind = AssetKind::Texture;
+            return true;
+        }
+        if (extension == ".wav" || extension == ".ogg")
+        {
+            out_kind = AssetKind::Sound;
+            return true;
+        }
+        return false;
+    }
+
+    std::span<const unsigned char> read_bytes(const std::filesystem::path& filename, const AssetPack* pack, std::vector<unsigned char>& storage)
+    {
+        if (pack != nullptr)
+        {
+            if (const auto bytes = pack->ReadFile(filename, storage); !bytes.empty())
+                return bytes;
+        }
+        std::ifstream file{ filename, std::ios::binary | std::ios::ate };
+        if (!file)
+            return {};
+        storage.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(storage.data()), static_cast<std::streamsize>(storage.size())))
+            storage.clear();
+        return storage;
+    }
+
+    std::string format_bytes(std::size_t bytes)
+    {
+        char text[32];
+        if (bytes >= 1024 * 1024)
+            std::snprintf(text, sizeof(text), "%.1f MB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+        else
+            std::snprintf(text, sizeof(text), "%.1f KB", static_cast<double>(bytes) / 1024.0);
+        return text;
+    }
+}
+
+struct AssetBrowser::Shared
+{
+    struct Result
+    {
+        std::uint32_t              generation = 0;
+        int                        item       = -1;
+        std::vector<unsigned char> pixels; // empty when the image couldn't be decoded
+        int                        width         = 0;
+        int                        height        = 0;
+        int                        source_width  = 0;
+        int                        source_height = 0;
+        bool                       was_cached    = false;
+    };
+
+    std::mutex          mutex;
+    std::vector<Item>   scanned;
+    bool                has_scan = false;
+    std::vector<Result> finished;
+};
+
+void AssetBrowser::Setup(LoadScheduler& load_scheduler, const AssetPack* asset_pack)
+{
+    scheduler = &load_scheduler;
+    pack      = asset_pack;
+    shared    = std::make_shared<Shared>();
+    cells.assign(ATLAS_CELLS, Cell{});
+}
+
+void AssetBrowser::Shutdown()
+{
+    if (atlas != 0)
+    {
+        gl_state::DeleteTexture(atlas);
+        memory_tracker::Free(MemoryCategory::Textures, ATLAS_BYTES);
+        atlas = 0;
+    }
+    // jobs still running finish into `shared`, which they keep alive, and nobody looks
+    shared.reset();
+    items.clear();
+    filtered.clear();
+    cells.clear();
+    scheduler = nullptr;
+}
+
+void AssetBrowser::Refresh(const std::filesystem::path& root)
+{
+    if (scheduler == nullptr || is_scanning)
+        return;
+    is_scanning = true;
+    has_scanned = true;
+    scheduler->Submit(LoadPriority::Background,
+                      [root, results = shared]()
+                      {
+                          std::vector<Item> found;
+                          std::error_code   error;
+                          for (auto it = std::filesystem::recursive_directory_iterator{ root, error }; !error && it != std::filesystem::recursive_directory_iterator{}; it.increment(error))
+                          {
+                              Item item;
+                              if (!it->is_regular_file(error) || !kind_of(it->path(), item.kind))
+                                  continue;
+                              item.path       = it->path();
+                              item.file       = AssetRegistry::FileId(item.path);
+                              item.file_bytes = it->file_size(error);
+                              found.push_back(std::move(item));
+                          }
+                          std::sort(found.begin(), found.end(), [](const Item& a, const Item& b) { return a.file < b.file; });
+                          std::lock_guard lock{ results->mutex };
+                          results->scanned  = std::move(found);
+                          results->has_scan = true;
+                      });
+}
+
+void AssetBrowser::Update(UploadBudget& budget)
+{
+    if (shared == nullptr)
+        return;
+    std::vector<Shared::Result> finished;
+    {
+        std::lock_guard lock{ shared->mutex };
+        if (shared->has_scan)
+        {
+            items            = std::move(shared->scanned);
+            shared->has_scan = false;
+            is_scanning      = false;
+            ++generation;
+            // every cell belonged to the old list
+            for (Cell& cell : cells)
+                cell = Cell{};
+            stats.pending = 0;
+            rebuildFilter();
+        }
+        // results that don't fit this frame's budget wait there for the next Update
+        std::size_t take = 0;
+        while (take < shared->finished.size() && (take == 0 || budget.HasRoom()))
+        {
+            budget.Spend(shared->finished[take].pixels.size());
+            ++take;
+        }
+        for (std::size_t i = take; i < shared->finished.size(); ++i)
+            budget.Defer(shared->finished[i].pixels.size());
+        finished.assign(std::make_move_iterator(shared->finished.begin()), std::make_move_iterator(shared->finished.begin() + static_cast<std::ptrdiff_t>(take)));
+        shared->finished.erase(shared->finished.begin(), shared->finished.begin() + static_cast<std::ptrdiff_t>(take));
+    }
+
+    const UploadBudget::Timer timer{ budget };
+    for (Shared::Result& result : finished)
+    {
+        if (result.generation != generation)
+            continue;
+        --stats.pending;
+        Item& item = items[static_cast<std::size_t>(result.item)];
+        if (result.pixels.empty())
+        {
+            item.thumbnail = Thumbnail::Failed;
+            continue;
+        }
+        if (atlas == 0)
+            createAtlas();
+        const int cell_index = takeCell();
+        if (cell_index < 0)
+        {
+            // every cell is on screen; the row asks again next time it is drawn
+            item.thumbnail = Thumbnail::None;
+            continue;
+        }
+        Cell& cell     = cells[static_cast<std::size_t>(cell_index)];
+        cell.item      = result.item;
+        cell.width     = result.width;
+        cell.height    = result.height;
+        cell.last_used = frame;
+        item.cell      = cell_index;
+        item.thumbnail = Thumbnail::Resident;
+        item.width     = result.source_width;
+        item.height    = result.source_height;
+        if (result.was_cached)
+            ++stats.warm;
+        else
+            ++stats.cold;
+        gl_backend::Get().texture_sub_image_2d(atlas, 0, (cell_index % ATLAS_SIDE) * THUMBNAIL_SIZE, (cell_index / ATLAS_SIDE) * THUMBNAIL_SIZE, result.width, result.height, GL_RGBA,
+                                               GL_UNSIGNED_BYTE, result.pixels.data());
+    }
+}
+
+void AssetBrowser::DrawImGui(const AssetRegistry& registry, bool* open)
+{
+    ++frame;
+    if (open != nullptr && !*open)
+        return;
+    if (!has_scanned)
+        Refresh(get_base_path());
+    if (!ImGui::Begin("Asset Browser", open))
+    {
+        ImGui::End();
+        return;
+    }
+    if (ImGui::Button("refresh"))
+        Refresh(get_base_path());
+    ImGui::SameLine();
+    ImGui::Text("%d textures, %d sounds%s", stats.textures, stats.items - stats.textures, is_scanning ? ", scanning..." : "");
+    bool is_filter_changed = filter.Draw("filter", 240.0f);
+    ImGui::SameLine();
+    int kind = kind_filter + 1;
+    if (ImGui::Combo("kind", &kind, "all\0textures\0sounds\0"))
+    {
+        kind_filter       = kind - 1;
+        is_filter_changed = true;
+    }
+    if (is_filter_changed)
+        rebuildFilter();
+    const Stats current = GetStats();
+    ImGui::Text("thumbnails: %d of %d cells, %d pending, %llu evicted, %llu from the decoded cache, %llu decoded", current.resident, ATLAS_CELLS, current.pending,
+                static_cast<unsigned long long>(current.evictions), static_cast<unsigned long long>(current.warm), static_cast<unsigned long long>(current.cold));
+
+    const float row_height = static_cast<float>(THUMBNAIL_SIZE) + ImGui::GetStyle().CellPadding.y * 2.0f;
+    if (ImGui::BeginTable("asset browser", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_BordersInnerV))
+    {
+        ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, static_cast<float>(THUMBNAIL_SIZE));
+        ImGui::TableSetupColumn("file");
+        ImGui::TableSetupColumn("on disk");
+        ImGui::TableSetupColumn("loaded");
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableHeadersRow();
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(filtered.size()), row_height);
+        while (clipper.Step())
+        {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+            {
+                const int index = filtered[static_cast<std::size_t>(row)];
+                Item&     item  = items[static_cast<std::size_t>(index)];
+                ImGui::TableNextRow(ImGuiTableRowFlags_None, row_height);
+                ImGui::TableNextColumn();
+                if (item.kind == AssetKind::Sound)
+                {
+                    ImGui::TextDisabled("sound");
+                }
+                else if (item.thumbnail == Thumbnail::Resident)
+                {
+                    Cell&        cell = cells[static_cast<std::size_t>(item.cell)];
+                    const ImVec2 uv0{ static_cast<float>((item.cell % ATLAS_SIDE) * THUMBNAIL_SIZE) / ATLAS_SIZE, static_cast<float>((item.cell / ATLAS_SIDE) * THUMBNAIL_SIZE) / ATLAS_SIZE };
+                    const ImVec2 uv1{ uv0.x + static_cast<float>(cell.width) / ATLAS_SIZE, uv0.y + static_cast<float>(cell.height) / ATLAS_SIZE };
+                    cell.last_used = frame;
+                    ImGui::Image(imgui_texture_id(atlas), ImVec2(static_cast<float>(cell.width), static_cast<float>(cell.height)), uv0, uv1);
+                }
+                else if (item.thumbnail == Thumbnail::Failed)
+                {
+                    ImGui::TextDisabled("failed");
+                }
+                else
+                {
+                    if (item.thumbnail == Thumbnail::None)
+                        requestThumbnail(index);
+                    ImGui::TextDisabled("...");
+                }
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(item.file.c_str());
+                if (item.width > 0)
+                    ImGui::TextDisabled("%d x %d", item.width, item.height);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(format_bytes(static_cast<std::size_t>(item.file_bytes)).c_str());
+                ImGui::TableNextColumn();
+                if (const AssetHandle handle = registry.FindFile(item.kind, item.file); handle.IsValid())
+                    ImGui::Text("%s, %s", AssetRegistry::StateName(registry.State(handle)), format_bytes(registry.Get(handle)->bytes).c_str());
+                else
+                    ImGui::TextDisabled("not loaded");
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+AssetBrowser::Stats AssetBrowser::GetStats() const noexcept
+{
+    Stats current    = stats;
+    current.resident = static_cast<int>(std::count_if(cells.begin(), cells.end(), [](const Cell& cell) { return cell.item >= 0; }));
+    return current;
+}
+
+void AssetBrowser::requestThumbnail(int item)
+{
+    if (scheduler == nullptr || stats.pending >= MAX_PENDING)
+        return;
+    Item& requested     = items[static_cast<std::size_t>(item)];
+    requested.thumbnail = Thumbnail::Pending;
+    ++stats.pending;
+    scheduler->Submit(LoadPriority::Visible,
+                      [path = requested.path, item, list = generation, pack = pack, results = shared]()
+                      {
+                          Shared::Result result;
+                          result.generation = list;
+                          result.item       = item;
+                          std::vector<unsigned char>           storage;
+                          const std::span<const unsigned char> source = read_bytes(path, pack, storage);
+                          // the source dimensions ride along in params 2 and 3, so this is a variant of its own rather than the loader's max_dimension one
+                          const std::uint64_t  key = !source.empty() && decoded_cache::IsEnabled() ? decoded_cache::Key(source, "thumbnail<=" + std::to_string(THUMBNAIL_SIZE)) : 0;
+                          decoded_cache::Entry cached;
+                          if (key != 0 && cached.Open(key) && cached.SectionCount() == 1 && cached.Param(0) > 0 && cached.Param(1) > 0 &&
+                              cached.Section(0).size() == static_cast<std::size_t>(cached.Param(0)) * static_cast<std::size_t>(cached.Param(1)) * 4)
+                          {
+                              result.pixels.assign(cached.Section(0).begin(), cached.Section(0).end());
+                              result.width         = cached.Param(0);
+                              result.height        = cached.Param(1);
+                              result.source_width  = cached.Param(2);
+                              result.source_height = cached.Param(3);
+                              result.was_cached    = true;
+                          }
+                          else if (!source.empty())
+                          {
+                              const Uint64                begin = SDL_GetPerformanceCounter();
+                              const decode_scratch::Scope scratch;
+                              int                         width  = 0;
+                              int                         height = 0;
+                              if (unsigned char* pixels = stbi_load_from_memory(source.data(), static_cast<int>(source.size()), &width, &height, NULL, 4); pixels != nullptr)
+                              {
+                                  result.pixels        = shrink_rgba_to_fit(pixels, width, height, THUMBNAIL_SIZE, result.width, result.height);
+                                  result.source_width  = width;
+                                  result.source_height = height;
+                                  stbi_image_free(pixels);
+                                  const double cold_ms = static_cast<double>(SDL_GetPerformanceCounter() - begin) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+                                  if (key != 0)
+                                      decoded_cache::Store(key, { result.width, result.height, width, height }, std::array{ std::span<const unsigned char>{ result.pixels } }, cold_ms);
+                              }
+                          }
+                          std::lock_guard lock{ results->mutex };
+                          results->finished.push_back(std::move(result));
+                      });
+}
+
+void AssetBrowser::createAtlas()
+{
+    const gl_backend::Functions& gl = gl_backend::Get();
+    atlas                           = gl.create_texture_2d();
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, ATLAS_SIZE, ATLAS_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl.texture_parameter_i(atlas, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl.texture_parameter_i(atlas, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    gl.texture_parameter_i(atlas, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl.texture_parameter_i(atlas, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl.texture_parameter_i(atlas, GL_TEXTURE_MAX_LEVEL, 0);
+    memory_tracker::Allocate(MemoryCategory::Textures, ATLAS_BYTES);
+}
+
+int AssetBrowser::takeCell()
+{
+    int oldest = -1;
+    for (int i = 0; i < ATLAS_CELLS; ++i)
+    {
+        const Cell& cell = cells[static_cast<std::size_t>(i)];
+        if (cell.item < 0)
+            return i;
+        if (cell.last_used < frame && (oldest < 0 || cell.last_used < cells[static_cast<std::size_t>(oldest)].last_used))
+            oldest = i;
+    }
+    if (oldest >= 0)
+    {
+        Item& evicted     = items[static_cast<std::size_t>(cells[static_cast<std::size_t>(oldest)].item)];
+        evicted.cell      = -1;
+        evicted.thumbnail = Thumbnail::None;
+        ++stats.evictions;
+    }
+    return oldest;
+}
+
+void AssetBrowser::rebuildFilter()
+{
+    filtered.clear();
+    stats.items    = static_cast<int>(items.size());
+    stats.textures = 0;
+    for (int i = 0; i < static_cast<int>(items.size()); ++i)
+    {
+        const Item& item = items[static_cast<std::size_t>(i)];
+        stats.textures += item.kind == AssetKind::Texture ? 1 : 0;
+        if (kind_filter >= 0 && item.kind != static_cast<AssetKind>(kind_filter))
+            continue;
+        if (filter.PassFilter(item.file.c_str()))
+            filtered.push_back(i);
+    }
+}
@@ -0,0 +1,129 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "asset_registry.h"
+#include "load_scheduler.h"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <imgui.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class AssetPack;
+class UploadBudget;
+
+/**
+ * A window listing every texture and sound under the asset root, with thumbnails of the images.
+ *
+ * The folder is scanned on a worker. The list is drawn through an ImGuiListClipper, so only the rows in view are
+ * submitted, and only those rows ask for a thumbnail: a job on the LoadScheduler reads the file, decodes it and
+ * shrinks it to THUMBNAIL_SIZE, or maps the small image from the decoded cache when an earlier run made it, and
+ * Update copies it into a cell of one atlas texture, made when the first one arrives. The atlas has ATLAS_CELLS cells; once they're all taken, the
+ * cell of the thumbnail least recently drawn goes to the new one, and the row it left asks again if it scrolls
+ * back into view. At most MAX_PENDING thumbnails are on their way at once, so flinging the scrollbar over ten
+ * thousand rows queues a handful. Loads of an asset show its state and size from the registry next to it.
+ * Only loose files are listed, a packed build's pack is read for their bytes. Main thread, which must have GL.
+ */
+class AssetBrowser
+{
+public:
+    static constexpr int THUMBNAIL_SIZE = 64;
+    static constexpr int ATLAS_SIDE     = 16; // cells along each side of the atlas
+    static constexpr int ATLAS_CELLS    = ATLAS_SIDE * ATLAS_SIDE;
+    static constexpr int MAX_PENDING    = 16;
+
+    struct Stats
+    {
+        int           items     = 0;
+        int           textures  = 0;
+        int           resident  = 0; // thumbnails in the atlas
+        int           pending   = 0;
+        std::uint64_t evictions = 0;
+        std::uint64_t warm      = 0; // thumbnails the decoded cache had
+        std::uint64_t cold      = 0;
+    };
+
+    AssetBrowser() = default;
+
+    AssetBrowser(const AssetBrowser&)                = delete;
+    AssetBrowser& operator=(const AssetBrowser&)     = delete;
+    AssetBrowser(AssetBrowser&&) noexcept            = delete;
+    AssetBrowser& operator=(AssetBrowser&&) noexcept = delete;
+
+    // The pack, when there is one, has to outlive the scheduler's workers
+    void Setup(LoadScheduler& scheduler, const AssetPack* pack);
+    void Shutdown();
+
+    // Scans `root` again on a worker; the old list stays up until the new one is in
+    void Refresh(const std::filesystem::path& root);
+    // Takes in the scan and the thumbnails that finished, uploading what fits in `budget`
+    void Update(UploadBudget& budget);
+    // The window, while `open`; the first time it is shown it scans get_base_path()
+    void DrawImGui(const AssetRegistry& registry, bool* open);
+
+    Stats GetStats() const noexcept;
+
+private:
+    enum class Thumbnail : std::uint8_t
+    {
+        None,
+        Pending,
+        Resident,
+        Failed
+    };
+
+    struct Item
+    {
+        std::filesystem::path path;
+        std::string           file; // AssetRegistry::FileId
+        AssetKind             kind       = AssetKind::Texture;
+        std::uintmax_t        file_bytes = 0;
+        int                   width      = 0; // the image's, once its thumbnail has been made
+        int                   height     = 0;
+        int                   cell       = -1;
+        Thumbnail             thumbnail  = Thumbnail::None;
+    };
+
+    struct Cell
+    {
+        int           item      = -1;
+        int           width     = 0; // of the thumbnail in it, at most THUMBNAIL_SIZE
+        int           height    = 0;
+        std::uint64_t last_used = 0; // frame it was last drawn
+    };
+
+    struct Shared;
+
+    void requestThumbnail(int item);
+    // on the first thumbnail, so a browser never opened costs no VRAM
+    void createAtlas();
+    // a free cell, or the least recently drawn one that wasn't drawn this frame; -1 when all of them were
+    int  takeCell();
+    void rebuildFilter();
+
+private:
+    LoadScheduler*          scheduler = nullptr;
+    const AssetPack*        pack      = nullptr;
+    std::shared_ptr<Shared> shared; // what the workers hand back; they hold it, never `this`
+    std::vector<Item>       items;
+    std::vector<int>        filtered; // indices of the items the filter lets through
+    std::vector<Cell>       cells;
+    GLuint                  atlas       = 0;
+    std::uint32_t           generation  = 0; // of `items`; results for an older list are dropped
+    std::uint64_t           frame       = 0;
+    bool                    is_scanning = false;
+    bool                    has_scanned = false;
+    ImGuiTextFilter         filter;
+    int                     kind_filter = -1; // an AssetKind, or -1 for both
+    Stats                   stats;
+};
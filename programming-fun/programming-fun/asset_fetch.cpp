@@ -0,0 +1,229 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_fetch.h"
+
+#include "asset_paths.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <fstream>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__EMSCRIPTEN__)
+#    include <cstring>
+#    include <emscripten/fetch.h>
+#endif
+
+struct AssetFetcher::Request
+{
+    std::vector<std::filesystem::path> candidates;
+    std::size_t                        next     = 0;
+    LoadPriority                       priority = LoadPriority::Visible;
+    Done                               done;
+};
+
+struct AssetFetcher::State
+{
+    enum class File : std::uint8_t
+    {
+        Fetching,
+        Present,
+        Missing
+    };
+
+    std::string url_root;
+    int         max_in_flight = DEFAULT_MAX_IN_FLIGHT;
+    bool        is_closed     = false; // the fetcher is gone, downloads still landing call nobody
+    Stats       stats;
+
+    std::unordered_map<std::string, File>                                  files;   // by the path the loaders read
+    std::unordered_map<std::string, std::vector<std::shared_ptr<Request>>> waiting; // on a file being fetched
+    std::array<std::deque<std::shared_ptr<Request>>, LoadScheduler::PRIORITY_COUNT> queued; // for a slot
+};
+
+namespace
+{
+#if defined(__EMSCRIPTEN__)
+    // the fetch's userData; owned by the callback
+    struct Download
+    {
+        std::function<void(bool, std::uint64_t)> finish;
+        std::string                               file;
+    };
+
+    bool write_file(const std::string& file, const char* data, std::uint64_t size)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path{ file }.parent_path(), error);
+        std::ofstream out{ file, std::ios::binary };
+        return static_cast<bool>(out.write(data, static_cast<std::streamsize>(size)));
+    }
+
+    void on_fetched(emscripten_fetch_t* fetch)
+    {
+        const std::unique_ptr<Download> download{ static_cast<Download*>(fetch->userData) };
+        const bool                      ok    = fetch->status == 200 && write_file(download->file, fetch->data, fetch->numBytes);
+        const std::uint64_t             bytes = ok ? fetch->numBytes : 0;
+        if (fetch->status == 200 && !ok)
+            LOG_ERROR("Failed to write fetched ", download->file);
+        emscripten_fetch_close(fetch);
+        download->finish(ok, bytes);
+    }
+#endif
+}
+
+AssetFetcher::AssetFetcher(std::string url_root, int max_in_flight) : state{ std::make_shared<State>() }
+{
+    state->url_root      = std::move(url_root);
+    state->max_in_flight = std::max(max_in_flight, 1);
+}
+
+AssetFetcher::~AssetFetcher()
+{
+    state->is_closed = true;
+    state->waiting.clear();
+    for (auto& queue : state->queued)
+        queue.clear();
+}
+
+void AssetFetcher::Fetch(std::vector<std::filesystem::path> candidates, LoadPriority priority, Done done)
+{
+    auto request        = std::make_shared<Request>();
+    request->candidates = std::move(candidates);
+    request->priority   = priority;
+    request->done       = std::move(done);
+    advance(state, request);
+}
+
+bool AssetFetcher::Promote(const std::filesystem::path& first, LoadPriority priority)
+{
+    const auto target = static_cast<std::size_t>(priority);
+    for (std::size_t i = target + 1; i < state->queued.size(); ++i)
+    {
+        auto&      queue = state->queued[i];
+        const auto found = std::find_if(queue.begin(), queue.end(), [&first](const std::shared_ptr<Request>& request) { return request->candidates.front() == first; });
+        if (found == queue.end())
+            continue;
+        (*found)->priority = priority;
+        state->queued[target].push_back(std::move(*found));
+        queue.erase(found);
+        return true;
+    }
+    return false;
+}
+
+AssetFetcher::Stats AssetFetcher::GetStats() const
+{
+    Stats stats  = state->stats;
+    stats.queued = 0;
+    for (const auto& queue : state->queued)
+        stats.queued += static_cast<int>(queue.size());
+    return stats;
+}
+
+void AssetFetcher::advance(const std::shared_ptr<State>& state, const std::shared_ptr<Request>& request)
+{
+    for (; request->next < request->candidates.size(); ++request->next)
+    {
+        const std::string file  = request->candidates[request->next].string();
+        auto              known = state->files.find(file);
+        if (known == state->files.end())
+        {
+            // preloaded, or fetched by an earlier run into a filesystem that kept it
+            std::error_code error;
+            if (std::filesystem::is_regular_file(file, error))
+                known = state->files.emplace(file, State::File::Present).first;
+        }
+        if (known == state->files.end())
+        {
+            if (state->stats.in_flight >= state->max_in_flight)
+            {
+                state->queued[static_cast<std::size_t>(request->priority)].push_back(request);
+                return;
+            }
+            // waiting first, since a fetch can complete before start returns
+            state->waiting[file].push_back(request);
+            start(state, file);
+            return;
+        }
+        if (known->second == State::File::Present)
+        {
+            request->done(true);
+            return;
+        }
+        if (known->second == State::File::Fetching)
+        {
+            state->waiting[file].push_back(request);
+            return;
+        }
+    }
+    request->done(false);
+}
+
+void AssetFetcher::start(const std::shared_ptr<State>& state, const std::string& file)
+{
+    state->files[file] = State::File::Fetching;
+    ++state->stats.in_flight;
+#if defined(__EMSCRIPTEN__)
+    const std::string relative = std::filesystem::path{ file }.lexically_relative(get_base_path()).generic_string();
+    const std::string url      = state->url_root + '/' + relative;
+
+    emscripten_fetch_attr_t attr;
+    emscripten_fetch_attr_init(&attr);
+    std::strcpy(attr.requestMethod, "GET");
+    // IndexedDB first, the network when it doesn't have the URL yet
+    attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY | EMSCRIPTEN_FETCH_PERSIST_FILE;
+    attr.onsuccess  = on_fetched;
+    attr.onerror    = on_fetched;
+    attr.userData   = new Download{ [state, file](bool fetched, std::uint64_t bytes) { complete(state, file, fetched, bytes); }, file };
+    emscripten_fetch(&attr, url.c_str());
+#else
+    // nothing to download from; advance already found the file wasn't there
+    complete(state, file, false, 0);
+#endif
+}
+
+void AssetFetcher::complete(const std::shared_ptr<State>& state, const std::string& file, bool fetched, std::uint64_t bytes)
+{
+    --state->stats.in_flight;
+    if (state->is_closed)
+        return;
+    state->files[file] = fetched ? State::File::Present : State::File::Missing;
+    if (fetched)
+    {
+        ++state->stats.downloaded;
+        state->stats.bytes += bytes;
+    }
+    else
+    {
+        ++state->stats.missing;
+    }
+
+    std::vector<std::shared_ptr<Request>> resumed;
+    if (const auto found = state->waiting.find(file); found != state->waiting.end())
+    {
+        resumed = std::move(found->second);
+        state->waiting.erase(found);
+    }
+    for (const auto& request : resumed)
+        advance(state, request);
+
+    // the slot this one had goes to the most urgent request waiting for one
+    while (state->stats.in_flight < state->max_in_flight)
+    {
+        const auto queue = std::find_if(state->queued.begin(), state->queued.end(), [](const auto& requests) { return !requests.empty(); });
+        if (queue == state->queued.end())
+            break;
+        const std::shared_ptr<Request> next = std::move(queue->front());
+        queue->pop_front();
+        advance(state, next);
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "load_scheduler.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Downloads assets on demand for the web build, into the same paths under the asset root the loaders read.
+ *
+ * A --preload-file of the assets folder makes the page download every asset before main runs. Instead the
+ * LoadScheduler hands a load's files to Fetch and only lets it on a worker once they are here, so the first
+ * frame shows while the textures and sounds it asked for are still arriving. Fetches wait in one queue per
+ * LoadPriority and only `max_in_flight` are with the browser at once, the most urgent and then the oldest first.
+ * On the Emscripten build each file is an emscripten_fetch of <url_root>/<relative path> persisted to IndexedDB,
+ * so a second visit reads it from there instead of the network, and the bytes are written into MEMFS where the
+ * loaders' ifstreams find them. Deploy the assets under a new url_root when they change, IndexedDB keeps the URL's
+ * old copy otherwise. Files read outside the loaders (the label font, the streamed music, the virtual texture's
+ * tiles) still have to be there at startup, so the web build preloads just those.
+ * Elsewhere nothing is downloaded: a file is there or it is missing.
+ *
+ * Main thread only; the browser calls back from its event loop on the main thread too.
+ */
+class AssetFetcher
+{
+public:
+    // true when one of the candidates is on disk now, false when none of them exists
+    using Done = std::function<void(bool fetched)>;
+
+    static constexpr int DEFAULT_MAX_IN_FLIGHT = 6; // what browsers run at once per host over HTTP/1.1
+
+    struct Stats
+    {
+        int           queued     = 0;
+        int           in_flight  = 0;
+        std::uint64_t downloaded = 0;
+        std::uint64_t missing    = 0; // 404s, which alternatives like a KTX2 variant are expected to get
+        std::uint64_t bytes      = 0;
+    };
+
+    explicit AssetFetcher(std::string url_root = "assets", int max_in_flight = DEFAULT_MAX_IN_FLIGHT);
+    ~AssetFetcher();
+
+    AssetFetcher(const AssetFetcher&)                = delete;
+    AssetFetcher& operator=(const AssetFetcher&)     = delete;
+    AssetFetcher(AssetFetcher&&) noexcept            = delete;
+    AssetFetcher& operator=(AssetFetcher&&) noexcept = delete;
+
+    // Calls `done` once the first of `candidates` that exists is on disk, best first; right away when one already is
+    void Fetch(std::vector<std::filesystem::path> candidates, LoadPriority priority, Done done);
+    // Moves a fetch that is still waiting for a slot up to `priority`; `first` is its first candidate
+    bool  Promote(const std::filesystem::path& first, LoadPriority priority);
+    Stats GetStats() const;
+
+private:
+    struct State;
+    struct Request;
+
+    // on to the request's next candidate that isn't known to be missing, fetching it if nobody is
+    static void advance(const std::shared_ptr<State>& state, const std::shared_ptr<Request>& request);
+    static void start(const std::shared_ptr<State>& state, const std::string& file);
+    static void complete(const std::shared_ptr<State>& state, const std::string& file, bool fetched, std::uint64_t bytes);
+
+private:
+    std::shared_ptr<State> state;
+};
@@ -0,0 +1,48 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_id.h"
+
+#include "asset_paths.h"
+#include "asset_registry.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+    struct NameTable
+    {
+        std::mutex                                     mutex;
+        std::unordered_map<std::uint64_t, std::string> names; // nodes don't move, so views into them stay good
+    };
+
+    NameTable table;
+}
+
+AssetId AssetId::FromPath(const std::filesystem::path& filename)
+{
+    std::string         file = AssetRegistry::FileId(filename);
+    const std::uint64_t hash = asset_name_hash(file);
+    std::lock_guard     lock{ table.mutex };
+    const auto [entry, added] = table.names.try_emplace(hash, std::move(file));
+    return AssetId{ entry->second };
+}
+
+std::string_view AssetId::NameOf(std::uint64_t hash)
+{
+    std::lock_guard lock{ table.mutex };
+    const auto      found = table.names.find(hash);
+    return found == table.names.end() ? std::string_view{} : std::string_view{ found->second };
+}
+
+std::filesystem::path AssetId::Path() const
+{
+    // absolute names, of files outside the asset root, replace the base instead of joining it
+    return get_base_path() / std::filesystem::path{ name };
+}
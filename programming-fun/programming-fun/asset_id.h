@@ -0,0 +1,84 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+// FNV-1a over the generic relative name ("images/duck.png"); the pack sorts its table by this
+constexpr std::uint64_t asset_name_hash(std::string_view name) noexcept
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const char c : name)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * An asset named by the asset_name_hash of its path relative to the asset root, '/' separated.
+ *
+ * A literal, "audio/quack.wav"_asset, is hashed by the compiler, so looking it up is a 64-bit compare with
+ * no path to build and no string to hash. The name rides along as a view for messages and for opening the
+ * file on a miss; a literal's lives forever, and FromPath keeps the ones it makes in a string table, which
+ * NameOf also answers from when all that's left is the hash. Two ids are the same asset when their hashes
+ * are, which AssetRegistry and AssetPack make sure of by refusing names that collide.
+ */
+class AssetId
+{
+public:
+    AssetId() = default;
+
+    constexpr explicit AssetId(std::string_view relative_name) noexcept : hash{ asset_name_hash(relative_name) }, name{ relative_name }
+    {
+    }
+
+    // Paths under the asset root become relative, like AssetRegistry::FileId; the name goes in the string table
+    static AssetId          FromPath(const std::filesystem::path& filename);
+    // The name the string table has for `hash`, empty for one only a literal has used
+    static std::string_view NameOf(std::uint64_t hash);
+
+    constexpr std::uint64_t Hash() const noexcept
+    {
+        return hash;
+    }
+
+    constexpr std::string_view Name() const noexcept
+    {
+        return name;
+    }
+
+    constexpr bool IsValid() const noexcept
+    {
+        return !name.empty();
+    }
+
+    // The file on disk, built when it's needed rather than each lookup
+    std::filesystem::path Path() const;
+
+    friend constexpr bool operator==(const AssetId& a, const AssetId& b) noexcept
+    {
+        return a.hash == b.hash;
+    }
+
+private:
+    std::uint64_t    hash = 0;
+    std::string_view name;
+};
+
+namespace asset_literals
+{
+    consteval AssetId operator""_asset(const char* text, std::size_t length)
+    {
+        return AssetId{ std::string_view{ text, length } };
+    }
+}
@@ -0,0 +1,388 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_pack.h"
+
+#include "lz4_block.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    constexpr char          MAGIC[4]    = { 'P', 'F', 'P', 'K' };
+    constexpr std::uint32_t VERSION     = 2;
+    constexpr std::size_t   HEADER_SIZE = 32;
+    constexpr std::size_t   ENTRY_SIZE  = 48;
+    constexpr std::size_t   ALIGNMENT   = 16;
+    constexpr std::uint32_t STORED      = 0;
+    constexpr std::uint32_t LZ4_BLOCKS  = 1;
+
+    // u64 hash, u64 offset, u64 size, u64 raw size, u32 name offset, u32 name length, u32 codec, u32 0;
+    // little-endian throughout
+    template <typename T>
+    T read_at(std::span<const unsigned char> bytes, std::size_t offset)
+    {
+        T value{};
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void append(std::vector<unsigned char>& bytes, T value)
+    {
+        const auto* raw = reinterpret_cast<const unsigned char*>(&value);
+        bytes.insert(bytes.end(), raw, raw + sizeof(T));
+    }
+
+    std::size_t align_up(std::size_t value) noexcept
+    {
+        return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    std::size_t block_count(std::uint64_t raw_size) noexcept
+    {
+        return static_cast<std::size_t>((raw_size + AssetPack::BLOCK_BYTES - 1) / AssetPack::BLOCK_BYTES);
+    }
+
+    // the frame Read decodes; empty when it wouldn't save enough to give up reading the file in place
+    std::vector<unsigned char> compress_blocks(std::span<const unsigned char> bytes, lz4::Level level)
+    {
+        const std::size_t          count = block_count(bytes.size());
+        std::vector<unsigned char> frame;
+        append(frame, static_cast<std::uint32_t>(AssetPack::BLOCK_BYTES));
+        append(frame, static_cast<std::uint32_t>(count));
+        frame.resize(frame.size() + count * sizeof(std::uint32_t));
+        std::vector<unsigned char> block;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto raw = bytes.subspan(i * AssetPack::BLOCK_BYTES, std::min(AssetPack::BLOCK_BYTES, bytes.size() - i * AssetPack::BLOCK_BYTES));
+            lz4::Compress(raw, block, level);
+            // a block that didn't shrink is stored as it is, which its size says
+            const auto stored = block.size() < raw.size() ? std::span<const unsigned char>{ block } : raw;
+            const auto size   = static_cast<std::uint32_t>(stored.size());
+            std::memcpy(frame.data() + 8 + i * sizeof(std::uint32_t), &size, sizeof(size));
+            frame.insert(frame.end(), stored.begin(), stored.end());
+        }
+        if (frame.size() > bytes.size() - bytes.size() / 8)
+            frame.clear();
+        return frame;
+    }
+}
+
+bool AssetPack::Open(const std::filesystem::path& filename)
+{
+    Close();
+    if (!file.Open(filename))
+        return false;
+
+    const auto bytes = file.Bytes();
+    if (bytes.size() < HEADER_SIZE || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0 || read_at<std::uint32_t>(bytes, 4) != VERSION)
+    {
+        std::cerr << "Not an asset pack (or an old version): " << filename << '\n';
+        Close();
+        return false;
+    }
+
+    const auto count        = read_at<std::uint32_t>(bytes, 8);
+    const auto toc_offset   = static_cast<std::size_t>(read_at<std::uint64_t>(bytes, 16));
+    const auto names_offset = static_cast<std::size_t>(read_at<std::uint64_t>(bytes, 24));
+    if (toc_offset + ENTRY_SIZE * count > bytes.size() || names_offset > bytes.size())
+    {
+        std::cerr << "Corrupt asset pack table: " << filename << '\n';
+        Close();
+        return false;
+    }
+
+    entries.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::size_t at          = toc_offset + ENTRY_SIZE * i;
+        const auto        name_offset = names_offset + read_at<std::uint32_t>(bytes, at + 32);
+        const auto        name_length = read_at<std::uint32_t>(bytes, at + 36);
+        const auto        codec       = read_at<std::uint32_t>(bytes, at + 40);
+        Entry&            entry       = entries[i];
+
+        entry.hash          = read_at<std::uint64_t>(bytes, at);
+        entry.offset        = read_at<std::uint64_t>(bytes, at + 8);
+        entry.size          = read_at<std::uint64_t>(bytes, at + 16);
+        entry.raw_size      = read_at<std::uint64_t>(bytes, at + 24);
+        entry.is_compressed = codec == LZ4_BLOCKS;
+        // the block table has to fit; the blocks themselves are checked as they are read
+        const std::uint64_t table = 8 + block_count(entry.raw_size) * sizeof(std::uint32_t);
+        if (entry.offset + entry.size > bytes.size() || name_offset + name_length > bytes.size() || (codec != STORED && codec != LZ4_BLOCKS) ||
+            (codec == STORED && entry.size != entry.raw_size) || (entry.is_compressed && entry.size < table))
+        {
+            std::cerr << "Corrupt asset pack entry " << i << ": " << filename << '\n';
+            Close();
+            return false;
+        }
+        entry.name = std::string_view{ reinterpret_cast<const char*>(bytes.data() + name_offset), name_length };
+    }
+    root = filename.parent_path();
+    reads.store(0, std::memory_order_relaxed);
+    read_bytes.store(0, std::memory_order_relaxed);
+    decompress_ns.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void AssetPack::Close()
+{
+    entries.clear();
+    root.clear();
+    file.Close();
+}
+
+bool AssetPack::IsOpen() const noexcept
+{
+    return file.IsOpen();
+}
+
+std::size_t AssetPack::EntryCount() const noexcept
+{
+    return entries.size();
+}
+
+std::span<const unsigned char> AssetPack::Read(std::string_view name, std::vector<unsigned char>& storage) const
+{
+    return read(find(name), storage);
+}
+
+std::span<const unsigned char> AssetPack::Read(AssetId id, std::vector<unsigned char>& storage) const
+{
+    return read(find(id), storage);
+}
+
+std::span<const unsigned char> AssetPack::ReadFile(const std::filesystem::path& filename, std::vector<unsigned char>& storage) const
+{
+    if (entries.empty())
+        return {};
+    const auto relative = filename.is_absolute() ? filename.lexically_relative(root) : filename;
+    return Read(relative.generic_string(), storage);
+}
+
+bool AssetPack::Prefetch(const std::filesystem::path& filename) const
+{
+    if (entries.empty())
+        return false;
+    const auto   relative = filename.is_absolute() ? filename.lexically_relative(root) : filename;
+    const Entry* entry    = find(relative.generic_string());
+    if (entry != nullptr)
+        file.Prefetch(file.Bytes().subspan(static_cast<std::size_t>(entry->offset), static_cast<std::size_t>(entry->size)));
+    return entry != nullptr;
+}
+
+void AssetPack::SetParallelFor(ParallelFor function)
+{
+    parallel_for = std::move(function);
+}
+
+AssetPack::Stats AssetPack::GetStats() const
+{
+    Stats stats;
+    for (const Entry& entry : entries)
+    {
+        if (!entry.is_compressed)
+            continue;
+        ++stats.compressed;
+        stats.packed_bytes += entry.size;
+        stats.unpacked_bytes += entry.raw_size;
+    }
+    stats.reads         = reads.load(std::memory_order_relaxed);
+    stats.read_bytes    = read_bytes.load(std::memory_order_relaxed);
+    stats.decompress_ms = static_cast<double>(decompress_ns.load(std::memory_order_relaxed)) / 1'000'000.0;
+    return stats;
+}
+
+const AssetPack::Entry* AssetPack::find(std::string_view name) const noexcept
+{
+    const std::uint64_t hash = asset_name_hash(name);
+    auto                it   = std::lower_bound(entries.begin(), entries.end(), hash, [](const Entry& entry, std::uint64_t value) { return entry.hash < value; });
+    for (; it != entries.end() && it->hash == hash; ++it)
+    {
+        if (it->name == name)
+            return &*it;
+    }
+    return nullptr;
+}
+
+const AssetPack::Entry* AssetPack::find(AssetId id) const noexcept
+{
+    const auto it = std::lower_bound(entries.begin(), entries.end(), id.Hash(), [](const Entry& entry, std::uint64_t value) { return entry.hash < value; });
+    if (it == entries.end() || it->hash != id.Hash())
+        return nullptr;
+    return &*it;
+}
+
+std::span<const unsigned char> AssetPack::read(const Entry* entry, std::vector<unsigned char>& storage) const
+{
+    if (entry == nullptr)
+        return {};
+    const auto stored = file.Bytes().subspan(static_cast<std::size_t>(entry->offset), static_cast<std::size_t>(entry->size));
+    if (!entry->is_compressed)
+        return stored;
+
+    const auto        start = std::chrono::steady_clock::now();
+    const std::size_t count = block_count(entry->raw_size);
+    if (read_at<std::uint32_t>(stored, 0) != BLOCK_BYTES || read_at<std::uint32_t>(stored, 4) != count)
+    {
+        std::cerr << "Corrupt asset pack blocks: " << entry->name << '\n';
+        return {};
+    }
+    // where each block starts, from the sizes; the last has to end where the entry does
+    std::vector<std::size_t> starts(count + 1);
+    starts[0] = 8 + count * sizeof(std::uint32_t);
+    for (std::size_t i = 0; i < count; ++i)
+        starts[i + 1] = starts[i] + read_at<std::uint32_t>(stored, 8 + i * sizeof(std::uint32_t));
+    if (starts[count] != stored.size())
+    {
+        std::cerr << "Corrupt asset pack blocks: " << entry->name << '\n';
+        return {};
+    }
+
+    storage.resize(static_cast<std::size_t>(entry->raw_size));
+    std::atomic<bool> failed{ false };
+    const auto        decode = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const auto block = stored.subspan(starts[i], starts[i + 1] - starts[i]);
+            const auto out   = std::span<unsigned char>{ storage }.subspan(i * BLOCK_BYTES, std::min(BLOCK_BYTES, storage.size() - i * BLOCK_BYTES));
+            if (block.size() == out.size())
+                std::memcpy(out.data(), block.data(), out.size());
+            else if (!lz4::Decompress(block, out))
+                failed.store(true, std::memory_order_relaxed);
+        }
+    };
+    // one block per range: each is a few hundred microseconds, worth a worker of its own
+    if (parallel_for && count > 1)
+        parallel_for(count, 1, decode);
+    else
+        decode(0, count);
+    if (failed.load(std::memory_order_relaxed))
+    {
+        std::cerr << "Corrupt asset pack blocks: " << entry->name << '\n';
+        storage.clear();
+        return {};
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    reads.fetch_add(1, std::memory_order_relaxed);
+    read_bytes.fetch_add(storage.size(), std::memory_order_relaxed);
+    decompress_ns.fetch_add(static_cast<std::uint64_t>(elapsed.count()), std::memory_order_relaxed);
+    return storage;
+}
+
+bool write_asset_pack(const std::filesystem::path& source_folder, const std::filesystem::path& output, std::size_t& out_file_count, PackCompression compression)
+{
+    namespace fs = std::filesystem;
+    std::vector<fs::path> files;
+    std::error_code       error;
+    for (const auto& item : fs::recursive_directory_iterator{ source_folder, error })
+    {
+        if (item.is_regular_file() && item.path().extension() != ".pak")
+            files.push_back(item.path());
+    }
+    if (error)
+    {
+        std::cerr << "Failed to list " << source_folder << ": " << error.message() << '\n';
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+
+    struct Pending
+    {
+        std::uint64_t hash;
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint64_t raw_size;
+        std::uint32_t name_offset;
+        std::uint32_t name_length;
+        std::uint32_t codec;
+    };
+
+    std::vector<unsigned char> blob(HEADER_SIZE, 0);
+    std::vector<Pending>       table;
+    std::string                names;
+    for (const auto& path : files)
+    {
+        std::ifstream input{ path, std::ios::binary | std::ios::ate };
+        if (!input)
+        {
+            std::cerr << "Failed to read " << path << '\n';
+            return false;
+        }
+        const auto raw_size = static_cast<std::size_t>(input.tellg());
+        const auto offset   = align_up(blob.size());
+        blob.resize(offset + raw_size);
+        input.seekg(0);
+        input.read(reinterpret_cast<char*>(blob.data() + offset), static_cast<std::streamsize>(raw_size));
+
+        // compressed over the file's own bytes, when that saves enough
+        std::size_t   size  = raw_size;
+        std::uint32_t codec = STORED;
+        if (compression != PackCompression::None && raw_size > 0)
+        {
+            const auto frame = compress_blocks(std::span<const unsigned char>{ blob }.subspan(offset), compression == PackCompression::Dense ? lz4::Level::Dense : lz4::Level::Fast);
+            if (!frame.empty())
+            {
+                std::memcpy(blob.data() + offset, frame.data(), frame.size());
+                blob.resize(offset + frame.size());
+                size  = frame.size();
+                codec = LZ4_BLOCKS;
+            }
+        }
+
+        const std::string name = path.lexically_relative(source_folder).generic_string();
+        table.push_back(Pending{ asset_name_hash(name), offset, size, raw_size, static_cast<std::uint32_t>(names.size()), static_cast<std::uint32_t>(name.size()), codec });
+        names += name;
+    }
+    std::sort(table.begin(), table.end(), [](const Pending& a, const Pending& b) { return a.hash < b.hash; });
+    // AssetId lookups go by the hash alone, so two names that share one can't both be in a pack
+    if (const auto same = std::adjacent_find(table.begin(), table.end(), [](const Pending& a, const Pending& b) { return a.hash == b.hash; }); same != table.end())
+    {
+        const std::string_view first{ names.data() + same->name_offset, same->name_length };
+        const std::string_view second{ names.data() + (same + 1)->name_offset, (same + 1)->name_length };
+        std::cerr << "Asset names " << first << " and " << second << " hash the same; rename one\n";
+        return false;
+    }
+
+    const std::size_t toc_offset = align_up(blob.size());
+    blob.resize(toc_offset);
+    for (const Pending& entry : table)
+    {
+        append(blob, entry.hash);
+        append(blob, entry.offset);
+        append(blob, entry.size);
+        append(blob, entry.raw_size);
+        append(blob, entry.name_offset);
+        append(blob, entry.name_length);
+        append(blob, entry.codec);
+        append(blob, std::uint32_t{ 0 });
+    }
+    const std::size_t names_offset = blob.size();
+    blob.insert(blob.end(), names.begin(), names.end());
+
+    std::memcpy(blob.data(), MAGIC, sizeof(MAGIC));
+    const std::uint32_t header_words[3] = { VERSION, static_cast<std::uint32_t>(table.size()), 0 };
+    const std::uint64_t offsets[2]      = { toc_offset, names_offset };
+    std::memcpy(blob.data() + 4, header_words, sizeof(header_words));
+    std::memcpy(blob.data() + 16, offsets, sizeof(offsets));
+
+    std::ofstream out{ output, std::ios::binary };
+    if (!out || !out.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size())))
+    {
+        std::cerr << "Failed to write " << output << '\n';
+        return false;
+    }
+    out_file_count = table.size();
+    return true;
+}
@@ -0,0 +1,117 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "asset_id.h"
+#include "mapped_file.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// How asset-packer stores each file
+enum class PackCompression : std::uint8_t
+{
+    None,  // as it is, read in place from the mapping
+    Fast,  // LZ4 blocks, lz4::Level::Fast
+    Dense  // LZ4 blocks, lz4::Level::Dense: slower to pack, smaller on slow storage, as fast to read
+};
+
+/**
+ * A memory-mapped archive of the assets folder (see asset-packer).
+ *
+ * Layout: 32 byte header, 16 byte aligned blobs, a table of contents sorted by name hash, then the names.
+ * Opening maps the file and reads the table; blobs are only paged in when a loader touches them.
+ * A blob the packer compressed is a frame of independent LZ4 blocks of BLOCK_BYTES each: u32 block size,
+ * u32 block count, the u32 stored size of every block, then the blocks. A block that didn't shrink is stored
+ * as it is, and a file is only compressed at all when that saves an eighth, so PNGs, OGGs and KTX2s are still
+ * read in place. Read hands out a view into the mapping for a file stored as it is, and decompresses any other
+ * into the caller's storage, a big one's blocks spread over the ParallelFor given to SetParallelFor.
+ * Views are valid until Close(). Lookups and Read are safe to call from any thread.
+ */
+class AssetPack
+{
+public:
+    static constexpr std::string_view DEFAULT_FILENAME = "assets.pak";
+    static constexpr std::size_t      BLOCK_BYTES      = 256 * 1024;
+
+    // WorkerPool::ParallelFor's shape: `body` over [0, count) in ranges of about `grain`
+    using ParallelFor = std::function<void(std::size_t count, std::size_t grain, const std::function<void(std::size_t begin, std::size_t end)>& body)>;
+
+    struct Stats
+    {
+        int           compressed     = 0; // entries stored as LZ4 blocks
+        std::uint64_t packed_bytes   = 0; // what those take in the pack
+        std::uint64_t unpacked_bytes = 0; // and once decompressed
+        std::uint64_t reads          = 0; // decompressions since Open
+        std::uint64_t read_bytes     = 0; // that they produced
+        double        decompress_ms  = 0.0;
+    };
+
+    AssetPack() = default;
+
+    AssetPack(const AssetPack&)                = delete;
+    AssetPack& operator=(const AssetPack&)     = delete;
+    AssetPack(AssetPack&&) noexcept            = delete;
+    AssetPack& operator=(AssetPack&&) noexcept = delete;
+
+    // `filename` sits in the asset root; names in the pack are relative to that folder
+    bool Open(const std::filesystem::path& filename);
+    void Close();
+
+    bool        IsOpen() const noexcept;
+    std::size_t EntryCount() const noexcept;
+
+    // The file's bytes: in the mapping, or decompressed into `storage`. Empty when the pack doesn't have it, or
+    // its blocks are corrupt (which is logged)
+    std::span<const unsigned char> Read(std::string_view name, std::vector<unsigned char>& storage) const;
+    // By hash alone; the packer refuses names that collide
+    std::span<const unsigned char> Read(AssetId id, std::vector<unsigned char>& storage) const;
+    // Accepts paths under the asset root, e.g. get_base_path() / "images" / "duck.png"
+    std::span<const unsigned char> ReadFile(const std::filesystem::path& filename, std::vector<unsigned char>& storage) const;
+    // Starts paging the file in ahead of the loader that will read it; false when the pack doesn't have it
+    bool                           Prefetch(const std::filesystem::path& filename) const;
+
+    // Set before the loaders start; without one a compressed file's blocks decode one after another
+    void  SetParallelFor(ParallelFor parallel_for);
+    Stats GetStats() const;
+
+private:
+    struct Entry
+    {
+        std::uint64_t    hash          = 0;
+        std::uint64_t    offset        = 0;
+        std::uint64_t    size          = 0; // in the pack
+        std::uint64_t    raw_size      = 0; // of the file
+        bool             is_compressed = false;
+        std::string_view name;
+    };
+
+    const Entry*                   find(std::string_view name) const noexcept;
+    const Entry*                   find(AssetId id) const noexcept;
+    std::span<const unsigned char> read(const Entry* entry, std::vector<unsigned char>& storage) const;
+
+private:
+    MappedFile            file;
+    std::filesystem::path root;
+    std::vector<Entry>    entries;
+    ParallelFor           parallel_for;
+
+    mutable std::atomic<std::uint64_t> reads{ 0 };
+    mutable std::atomic<std::uint64_t> read_bytes{ 0 };
+    mutable std::atomic<std::uint64_t> decompress_ns{ 0 };
+};
+
+// Packs every file under `source_folder` except existing packs, compressing the ones that shrink enough when
+// asked to. Returns false (and logs) on I/O errors.
+bool write_asset_pack(const std::filesystem::path& source_folder, const std::filesystem::path& output, std::size_t& out_file_count,
+                      PackCompression compression = PackCompression::None);
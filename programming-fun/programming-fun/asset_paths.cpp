@@ -0,0 +1,144 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_paths.h"
+
+#include "error.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    constexpr const char* ASSETS_ENVIRONMENT_VARIABLE = "PROGRAMMING_FUN_ASSETS";
+
+    std::optional<fs::path> gAssetRoot;
+
+    bool is_directory(const fs::path& path, int& stat_count)
+    {
+        ++stat_count;
+        std::error_code error;
+        return fs::is_directory(path, error);
+    }
+
+    // Makes the start absolute once and then walks up lexically, so each level costs a single stat
+    std::optional<fs::path> find_assets_above(const fs::path& starting_directory, std::vector<fs::path>& visited, int& stat_count)
+    {
+        std::error_code error;
+        fs::path        directory = fs::absolute(starting_directory, error).lexically_normal();
+        if (error)
+            return std::nullopt;
+        if (!directory.has_filename())
+            directory = directory.parent_path(); // SDL_GetBasePath ends with a separator
+        while (true)
+        {
+            if (std::find(visited.begin(), visited.end(), directory) != visited.end())
+                return std::nullopt; // the rest of this chain was already searched from another start
+            visited.push_back(directory);
+            if (const auto candidate = directory / "assets"; is_directory(candidate, stat_count))
+                return candidate;
+            if (!directory.has_relative_path())
+                return std::nullopt;
+            directory = directory.parent_path();
+        }
+    }
+
+    std::optional<fs::path> command_line_override(int argc, const char* const argv[])
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+            if (argument == "--assets" && i + 1 < argc)
+                return fs::path{ argv[i + 1] };
+            if (argument.starts_with("--assets="))
+                return fs::path{ argument.substr(9) };
+        }
+        return std::nullopt;
+    }
+
+    fs::path executable_directory()
+    {
+        char* base_path = SDL_GetBasePath();
+        if (base_path == nullptr)
+            return {};
+        fs::path result{ base_path };
+        SDL_free(base_path);
+        return result;
+    }
+
+    fs::path resolve(int argc, const char* const argv[], const char*& out_source, int& stat_count)
+    {
+        std::optional<fs::path> overridden = command_line_override(argc, argv);
+        out_source                         = "--assets";
+        if (!overridden)
+        {
+#if defined(_MSC_VER)
+#    pragma warning(suppress : 4996) // getenv is fine here, nothing else touches the environment
+#endif
+            if (const char* value = std::getenv(ASSETS_ENVIRONMENT_VARIABLE); value != nullptr && *value != '\0')
+            {
+                overridden = fs::path{ value };
+                out_source = ASSETS_ENVIRONMENT_VARIABLE;
+            }
+        }
+        if (overridden)
+        {
+            if (!is_directory(*overridden, stat_count))
+                throw_error_message("Asset folder from ", out_source, " is not a directory: ", *overridden);
+            std::error_code error;
+            return fs::absolute(*overridden, error);
+        }
+
+        // Deployed builds keep assets beside the exe, so that is checked before any walking
+        std::vector<fs::path> visited;
+        if (const auto exe_directory = executable_directory(); !exe_directory.empty())
+        {
+            out_source = "executable directory";
+            if (auto found = find_assets_above(exe_directory, visited, stat_count))
+                return *found;
+        }
+        out_source = "working directory";
+        std::error_code error;
+        if (auto found = find_assets_above(fs::current_path(error), visited, stat_count))
+            return *found;
+#if defined(__EMSCRIPTEN__)
+        // nothing preloaded: an empty folder in MEMFS that the AssetFetcher downloads into
+        out_source = "fetched on demand";
+        fs::create_directories("/assets", error);
+        return fs::path{ "/assets" };
+#else
+        throw_error_message("Failed to find assets folder in parent folders; pass --assets <dir> or set ", ASSETS_ENVIRONMENT_VARIABLE);
+#endif
+    }
+}
+
+void resolve_asset_root(int argc, const char* const argv[])
+{
+    if (gAssetRoot)
+        return;
+    const auto  start      = std::chrono::steady_clock::now();
+    const char* source     = "";
+    int         stat_count = 0;
+    gAssetRoot             = resolve(argc, argv, source, stat_count);
+    const auto elapsed     = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Assets: " << gAssetRoot->string() << " (from " << source << ", " << stat_count << " directory checks, " << elapsed << " ms)\n";
+}
+
+const std::filesystem::path& get_base_path()
+{
+    if (!gAssetRoot)
+        resolve_asset_root(0, nullptr);
+    return *gAssetRoot;
+}
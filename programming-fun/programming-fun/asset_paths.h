@@ -0,0 +1,24 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <filesystem>
+
+/**
+ * Finds the assets folder once per run.
+ *
+ * Order: `--assets <dir>` on the command line, then the PROGRAMMING_FUN_ASSETS environment variable,
+ * then `assets` next to the executable, then the executable's parents, then the working directory and its parents.
+ * An override that is not a directory is an error rather than silently falling back.
+ * Throws std::runtime_error when nothing is found, except on the web build, which then downloads into an empty /assets.
+ * Logs where the folder came from and how long the search took.
+ */
+void resolve_asset_root(int argc, const char* const argv[]);
+
+// The resolved root; resolves with no command line on first use if resolve_asset_root was never called
+const std::filesystem::path& get_base_path();
@@ -0,0 +1,225 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_registry.h"
+
+#include "asset_pack.h"
+#include "asset_paths.h"
+#include "error.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <imgui.h>
+#include <span>
+
+namespace
+{
+    std::size_t kind_index(AssetKind kind) noexcept
+    {
+        return static_cast<std::size_t>(kind);
+    }
+
+    std::string format_kilobytes(std::size_t bytes)
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.1f KB", static_cast<double>(bytes) / 1024.0);
+        return text;
+    }
+}
+
+std::string AssetRegistry::FileId(const std::filesystem::path& filename)
+{
+    const auto relative = filename.is_absolute() ? filename.lexically_relative(get_base_path()) : filename.lexically_normal();
+    return relative.empty() ? filename.generic_string() : relative.generic_string();
+}
+
+AssetHandle AssetRegistry::Find(AssetKind kind, std::string_view id) const
+{
+    const auto& table = by_id[kind_index(kind)];
+    const auto  found = table.find(asset_name_hash(id));
+    if (found == table.end() || slots.Get(found->second)->entry.id != id)
+        return {};
+    return found->second;
+}
+
+AssetHandle AssetRegistry::Find(AssetKind kind, AssetId id) const
+{
+    const auto& table = by_id[kind_index(kind)];
+    const auto  found = table.find(id.Hash());
+    return found == table.end() ? AssetHandle{} : found->second;
+}
+
+AssetHandle AssetRegistry::FindFile(AssetKind kind, std::string_view file) const
+{
+    const std::span<const Slot> entries = slots.Items();
+    for (std::size_t index = 0; index < entries.size(); ++index)
+    {
+        if (entries[index].entry.kind == kind && entries[index].entry.file == file)
+            return slots.HandleAt(index);
+    }
+    return {};
+}
+
+AssetHandle AssetRegistry::Add(AssetKind kind, std::string id, std::string file, const std::shared_ptr<const std::atomic<AssetState>>& state)
+{
+    const std::uint64_t hash  = asset_name_hash(id);
+    auto&               table = by_id[kind_index(kind)];
+    if (const auto found = table.find(hash); found != table.end())
+        throw_error_message("Asset ", id, " is already registered, or its id hashes the same as ", slots.Get(found->second)->entry.id);
+    if (slots.IsFull())
+        throw_error_message("Asset registry is full, can't register ", id);
+
+    const AssetHandle handle = slots.Insert(Slot{ Entry{ kind, std::move(id), std::move(file), state, 0, ++clock }, hash });
+    table.emplace(hash, handle);
+    ++stats[kind_index(kind)].entries;
+    return handle;
+}
+
+void AssetRegistry::Remove(AssetHandle handle)
+{
+    const Slot* slot = slots.Get(handle);
+    if (slot == nullptr)
+        return;
+    KindStats& kind = stats[kind_index(slot->entry.kind)];
+    kind.bytes -= slot->entry.bytes;
+    --kind.entries;
+    by_id[kind_index(slot->entry.kind)].erase(slot->hash);
+    slots.Erase(handle);
+}
+
+void AssetRegistry::Evict(AssetHandle handle)
+{
+    const Slot* slot = slots.Get(handle);
+    if (slot == nullptr)
+        return;
+    ++stats[kind_index(slot->entry.kind)].evictions;
+    Remove(handle);
+}
+
+const AssetRegistry::Entry* AssetRegistry::Get(AssetHandle handle) const noexcept
+{
+    const Slot* slot = slots.Get(handle);
+    return slot == nullptr ? nullptr : &slot->entry;
+}
+
+AssetState AssetRegistry::State(AssetHandle handle) const noexcept
+{
+    const Slot* slot = slots.Get(handle);
+    if (slot == nullptr)
+        return AssetState::Failed;
+    const std::shared_ptr<const std::atomic<AssetState>> state = slot->entry.state.lock();
+    return state == nullptr ? AssetState::Failed : state->load(std::memory_order_acquire);
+}
+
+long AssetRegistry::References(AssetHandle handle) const noexcept
+{
+    const Slot* slot = slots.Get(handle);
+    return slot == nullptr ? 0 : slot->entry.state.use_count();
+}
+
+void AssetRegistry::SetBytes(AssetHandle handle, std::size_t bytes) noexcept
+{
+    Slot* slot = slots.Get(handle);
+    if (slot == nullptr)
+        return;
+    KindStats& kind   = stats[kind_index(slot->entry.kind)];
+    kind.bytes        = kind.bytes - slot->entry.bytes + bytes;
+    slot->entry.bytes = bytes;
+}
+
+void AssetRegistry::Touch(AssetHandle handle) noexcept
+{
+    if (Slot* slot = slots.Get(handle); slot != nullptr)
+        slot->entry.last_used = ++clock;
+}
+
+std::size_t AssetRegistry::Bytes(AssetKind kind) const noexcept
+{
+    return stats[kind_index(kind)].bytes;
+}
+
+std::vector<AssetHandle> AssetRegistry::Unreferenced(AssetKind kind, long owner_references) const
+{
+    std::vector<AssetHandle> result;
+    for (const auto& [hash, handle] : by_id[kind_index(kind)])
+    {
+        const AssetState state = State(handle);
+        // anything still loading belongs to a job, which holds a reference of its own anyway
+        if ((state == AssetState::Resident || state == AssetState::Failed) && References(handle) <= owner_references)
+            result.push_back(handle);
+    }
+    std::sort(result.begin(), result.end(), [this](AssetHandle a, AssetHandle b) { return slots.Get(a)->entry.last_used < slots.Get(b)->entry.last_used; });
+    return result;
+}
+
+const AssetRegistry::KindStats& AssetRegistry::GetStats(AssetKind kind) const noexcept
+{
+    return stats[kind_index(kind)];
+}
+
+void AssetRegistry::DrawImGui() const
+{
+    ImGui::Begin("Assets");
+    for (std::size_t i = 0; i < KIND_COUNT; ++i)
+    {
+        const KindStats& kind = stats[i];
+        ImGui::Text("%s: %zu, %s, %llu evicted", KindName(static_cast<AssetKind>(i)), kind.entries, format_kilobytes(kind.bytes).c_str(), static_cast<unsigned long long>(kind.evictions));
+    }
+    if (ImGui::BeginTable("assets", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_ScrollY, ImVec2{ 0.0f, 240.0f }))
+    {
+        ImGui::TableSetupColumn("id");
+        ImGui::TableSetupColumn("kind");
+        ImGui::TableSetupColumn("state");
+        ImGui::TableSetupColumn("refs");
+        ImGui::TableSetupColumn("size");
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableHeadersRow();
+        const std::span<const Slot> entries = slots.Items();
+        for (std::size_t index = 0; index < entries.size(); ++index)
+        {
+            const Slot&       slot   = entries[index];
+            const AssetHandle handle = slots.HandleAt(index);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(slot.entry.id.c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(KindName(slot.entry.kind));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(StateName(State(handle)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%ld", References(handle));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(format_kilobytes(slot.entry.bytes).c_str());
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+const char* AssetRegistry::KindName(AssetKind kind) noexcept
+{
+    switch (kind)
+    {
+        case AssetKind::Texture: return "texture";
+        case AssetKind::Sound: return "sound";
+        case AssetKind::Count: break;
+    }
+    return "?";
+}
+
+const char* AssetRegistry::StateName(AssetState state) noexcept
+{
+    switch (state)
+    {
+        case AssetState::Queued: return "queued";
+        case AssetState::Decoding: return "decoding";
+        case AssetState::Uploading: return "uploading";
+        case AssetState::Resident: return "resident";
+        case AssetState::Failed: return "failed";
+    }
+    return "?";
+}
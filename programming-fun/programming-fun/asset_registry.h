@@ -0,0 +1,123 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "asset_id.h"
+#include "object_pool.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class AssetKind : std::uint8_t
+{
+    Texture,
+    Sound,
+    Count
+};
+
+// Where a load is; a loader's worker moves it to Decoding, everything after that happens on the main thread
+enum class AssetState : std::uint8_t
+{
+    Queued,
+    Decoding,
+    Uploading,
+    Resident,
+    Failed
+};
+
+struct AssetHandleTag;
+
+// A slot and the generation it was issued in, so a handle to an unloaded asset stops resolving instead of naming whatever reused the slot
+using AssetHandle = PoolHandle<AssetHandleTag>;
+
+/**
+ * Every asset the loaders know about, by kind and id, whatever state its load is in.
+ *
+ * TextureLoader and SoundCache share one: they look an id up before starting a load, so asking twice
+ * gets the first request's asset, and add an entry when they do start one. The entry watches the asset's
+ * own state through a weak pointer, so the loaders keep publishing it to the threads that poll it and the
+ * registry never holds an asset alive. References are the owners of the asset's shared_ptr, the loader's
+ * own included; the ones at no more than that are what Unreferenced offers up when a loader goes over its
+ * budget, least recently touched first. Ids have to be unique per kind, so two loaders of the same kind
+ * sharing a registry must not load the same file. Entries live packed in an ObjectPool, so the walks over all
+ * of them touch nothing but live ones. Main thread.
+ */
+class AssetRegistry
+{
+public:
+    struct Entry
+    {
+        AssetKind                                    kind = AssetKind::Texture;
+        std::string                                  id;   // the file, plus whatever else tells two loads of it apart
+        std::string                                  file; // FileId of what was loaded, for reloads
+        std::weak_ptr<const std::atomic<AssetState>> state;
+        std::size_t                                  bytes     = 0;
+        std::uint64_t                                last_used = 0; // registry clock at the last Touch
+    };
+
+    struct KindStats
+    {
+        std::size_t   entries   = 0;
+        std::size_t   bytes     = 0;
+        std::uint64_t evictions = 0;
+    };
+
+    // Relative to the asset root with '/' separators, the name an AssetPack uses; other paths stay as they are
+    static std::string FileId(const std::filesystem::path& filename);
+
+    // The live entry for `id`, an invalid handle when there is none
+    AssetHandle Find(AssetKind kind, std::string_view id) const;
+    // By hash alone, for ids that are plain FileIds; Add refuses ids whose hashes collide
+    AssetHandle Find(AssetKind kind, AssetId id) const;
+    // The first live entry loaded from `file`, a FileId, whatever its options; a walk over every entry
+    AssetHandle FindFile(AssetKind kind, std::string_view file) const;
+    // `state` is the asset's own, e.g. std::shared_ptr{ asset, &asset->state }; the entry starts as the newest used
+    AssetHandle Add(AssetKind kind, std::string id, std::string file, const std::shared_ptr<const std::atomic<AssetState>>& state);
+    void        Remove(AssetHandle handle);
+    // Removes the entry too, counted as unloaded to free memory
+    void         Evict(AssetHandle handle);
+    const Entry* Get(AssetHandle handle) const noexcept;
+    AssetState   State(AssetHandle handle) const noexcept;
+    long         References(AssetHandle handle) const noexcept;
+    void         SetBytes(AssetHandle handle, std::size_t bytes) noexcept;
+    void         Touch(AssetHandle handle) noexcept;
+
+    std::size_t Bytes(AssetKind kind) const noexcept;
+    // Resident or failed entries of `kind` with at most `owner_references` references, least recently touched first
+    std::vector<AssetHandle> Unreferenced(AssetKind kind, long owner_references) const;
+    const KindStats&         GetStats(AssetKind kind) const noexcept;
+
+    void DrawImGui() const;
+
+    static const char* KindName(AssetKind kind) noexcept;
+    static const char* StateName(AssetState state) noexcept;
+
+private:
+    static constexpr std::size_t KIND_COUNT = static_cast<std::size_t>(AssetKind::Count);
+
+    struct Slot
+    {
+        Entry         entry;
+        std::uint64_t hash = 0;
+    };
+
+private:
+    ObjectPool<Slot, AssetHandleTag>  slots;
+    std::array<KindStats, KIND_COUNT> stats{};
+    std::uint64_t                     clock = 0;
+
+    std::array<std::unordered_map<std::uint64_t, AssetHandle>, KIND_COUNT> by_id{}; // asset_name_hash of the id to its entry
+};
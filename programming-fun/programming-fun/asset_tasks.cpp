@@ -0,0 +1,172 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_tasks.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <iterator>
+
+CancelToken::CancelToken() : cancelled{ std::make_shared<std::atomic<bool>>(false) }
+{
+}
+
+void CancelToken::Cancel() noexcept
+{
+    cancelled->store(true);
+}
+
+bool CancelToken::IsCancelled() const noexcept
+{
+    return cancelled->load();
+}
+
+void AssetTask::Cancel() noexcept
+{
+    if (state != nullptr)
+        state->token.Cancel();
+}
+
+bool AssetTask::IsDone() const noexcept
+{
+    return state != nullptr && state->is_done;
+}
+
+bool AssetTask::WasCancelled() const noexcept
+{
+    return state != nullptr && state->was_cancelled;
+}
+
+CancelToken AssetTask::Token() const
+{
+    return state != nullptr ? state->token : CancelToken{};
+}
+
+void AssetTask::ThrowIfFailed() const
+{
+    if (state != nullptr && state->error != nullptr)
+        std::rethrow_exception(state->error);
+}
+
+const TextureHandle& AssetTasks::TextureLoad::Handle() const noexcept
+{
+    return texture;
+}
+
+bool AssetTasks::TextureLoad::await_ready() const noexcept
+{
+    // always through await_suspend, which sees the coroutine's token
+    return false;
+}
+
+bool AssetTasks::TextureLoad::await_suspend(AssetTask::Handle coroutine)
+{
+    const TextureHandle waited = texture;
+    return tasks->suspend(coroutine, [waited] { return waited->IsResident() || waited->HasFailed(); });
+}
+
+TextureHandle AssetTasks::TextureLoad::await_resume() const noexcept
+{
+    return texture;
+}
+
+bool AssetTasks::Condition::await_ready() const noexcept
+{
+    return false;
+}
+
+bool AssetTasks::Condition::await_suspend(AssetTask::Handle coroutine)
+{
+    return tasks->suspend(coroutine, std::move(is_ready));
+}
+
+void AssetTasks::Condition::await_resume() const noexcept
+{
+}
+
+AssetTasks::AssetTasks(LoadScheduler& load_scheduler, TextureLoader& texture_loader) : scheduler{ load_scheduler }, textures{ texture_loader }
+{
+}
+
+AssetTasks::~AssetTasks()
+{
+    Shutdown();
+}
+
+AssetTasks::TextureLoad AssetTasks::LoadTexture(const std::filesystem::path& filename, const TextureOptions& options, TextureAtlas* atlas, LoadPriority priority)
+{
+    return TextureLoad{ *this, textures.Request(filename, options, atlas, priority) };
+}
+
+AssetTasks::TextureLoad AssetTasks::LoadTexture(const std::filesystem::path& filename, const TextureOptions& options, TextureArray& array, LoadPriority priority)
+{
+    return TextureLoad{ *this, textures.Request(filename, options, array, priority) };
+}
+
+AssetTasks::Condition AssetTasks::Until(std::function<bool()> is_ready)
+{
+    return Condition{ *this, std::move(is_ready) };
+}
+
+void AssetTasks::Update()
+{
+    PROFILE_ZONE("AssetTasks::Update");
+    // resuming can wait again, which adds to `waiting`, so what's due comes out of it first
+    due.clear();
+    const auto still_waiting = std::stable_partition(
+        waiting.begin(), waiting.end(), [](const Waiting& entry) { return !entry.coroutine.promise().state->token.IsCancelled() && !entry.is_ready(); });
+    std::move(still_waiting, waiting.end(), std::back_inserter(due));
+    waiting.erase(still_waiting, waiting.end());
+    for (Waiting& entry : due)
+    {
+        if (entry.coroutine.promise().state->token.IsCancelled())
+        {
+            destroy(entry);
+            continue;
+        }
+        ++stats.resumed;
+        entry.coroutine.resume();
+    }
+    due.clear();
+    stats.waiting = static_cast<int>(waiting.size());
+}
+
+void AssetTasks::Shutdown()
+{
+    // the frames' locals go with them, so the handles they held are released before the loaders shut down
+    std::vector<Waiting> remaining;
+    remaining.swap(waiting);
+    for (Waiting& entry : remaining)
+        destroy(entry);
+    stats.waiting = 0;
+}
+
+AssetTasks::Stats AssetTasks::GetStats() const noexcept
+{
+    return stats;
+}
+
+bool AssetTasks::suspend(AssetTask::Handle coroutine, std::function<bool()> is_ready, LoadScheduler::Ticket ticket)
+{
+    if (!coroutine.promise().state->token.IsCancelled() && is_ready())
+        return false;
+    waiting.push_back(Waiting{ coroutine, std::move(is_ready), ticket });
+    stats.waiting = static_cast<int>(waiting.size());
+    return true;
+}
+
+void AssetTasks::destroy(Waiting& entry)
+{
+    if (entry.ticket != 0)
+        scheduler.Cancel(entry.ticket);
+    const std::shared_ptr<AssetTask::State> state = entry.coroutine.promise().state;
+    state->was_cancelled                          = true;
+    state->is_done                                = true;
+    entry.coroutine.destroy();
+    ++stats.cancelled;
+}
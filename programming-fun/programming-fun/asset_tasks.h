@@ -0,0 +1,277 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "load_scheduler.h"
+#include "texture_loader.h"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class TextureArray;
+class TextureAtlas;
+
+// Shared by copies; cancelling any of them cancels the task it came from
+class CancelToken
+{
+public:
+    CancelToken();
+
+    void Cancel() noexcept;
+    bool IsCancelled() const noexcept;
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+/**
+ * What a coroutine that co_awaits AssetTasks' loads returns.
+ *
+ * The coroutine runs as soon as it's called, up to its first wait, and from then on is resumed by
+ * AssetTasks::Update on the main thread; the object returned is only a view of it, so dropping it doesn't
+ * stop the coroutine. A cancelled coroutine never resumes again: its frame, locals and all, is destroyed at
+ * the next Update instead. An exception that escapes the coroutine ends it, and ThrowIfFailed rethrows it.
+ */
+class AssetTask
+{
+public:
+    struct State
+    {
+        CancelToken        token;
+        bool               is_done       = false;
+        bool               was_cancelled = false;
+        std::exception_ptr error;
+    };
+
+    struct promise_type
+    {
+        std::shared_ptr<State> state = std::make_shared<State>();
+
+        AssetTask get_return_object()
+        {
+            return AssetTask{ state };
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+            state->is_done = true;
+        }
+
+        void unhandled_exception() noexcept
+        {
+            state->error   = std::current_exception();
+            state->is_done = true;
+        }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    AssetTask() = default;
+
+    void        Cancel() noexcept;
+    // Done, cancelled or failed; false for a default constructed task
+    bool        IsDone() const noexcept;
+    bool        WasCancelled() const noexcept;
+    CancelToken Token() const;
+    void        ThrowIfFailed() const;
+
+private:
+    explicit AssetTask(std::shared_ptr<State> task_state) : state{ std::move(task_state) }
+    {
+    }
+
+private:
+    std::shared_ptr<State> state;
+};
+
+/**
+ * Loads written as coroutines instead of callbacks:
+ *
+ *     AssetTask Demo::Load(AssetTasks& tasks)
+ *     {
+ *         TextureHandle duck = co_await tasks.LoadTexture("images/duck.png");
+ *         ...
+ *     }
+ *
+ * LoadTexture asks the TextureLoader right away, so every load made before the first co_await is in flight
+ * at once; awaiting it then waits for the texture to be Resident or Failed, which the caller checks. OnWorker
+ * runs a function through the LoadScheduler at a priority and gives back what it returned; Until waits for
+ * any condition the main thread can check. Whatever a coroutine waits on, it is resumed by Update on the
+ * main thread, so the code after a co_await can touch GL and everything else the main thread owns.
+ *
+ * A coroutine whose CancelToken is cancelled is destroyed at the next Update rather than resumed, taking its
+ * OnWorker job off the scheduler if it hasn't started; Shutdown destroys every coroutine still waiting. A job
+ * that did start runs to the end, so OnWorker's function must own what it touches, not point into the frame.
+ */
+class AssetTasks
+{
+public:
+    struct Stats
+    {
+        int           waiting   = 0;
+        std::uint64_t resumed   = 0;
+        std::uint64_t cancelled = 0;
+    };
+
+    // Resumes the coroutine with the texture once it's Resident or Failed
+    class TextureLoad
+    {
+    public:
+        // Right away, to poll while it loads
+        const TextureHandle& Handle() const noexcept;
+
+        bool          await_ready() const noexcept;
+        bool          await_suspend(AssetTask::Handle coroutine);
+        TextureHandle await_resume() const noexcept;
+
+    private:
+        friend class AssetTasks;
+        TextureLoad(AssetTasks& owner, TextureHandle handle) : tasks{ &owner }, texture{ std::move(handle) }
+        {
+        }
+
+    private:
+        AssetTasks*   tasks = nullptr;
+        TextureHandle texture;
+    };
+
+    // Resumes the coroutine once `is_ready` says so
+    class Condition
+    {
+    public:
+        bool await_ready() const noexcept;
+        bool await_suspend(AssetTask::Handle coroutine);
+        void await_resume() const noexcept;
+
+    private:
+        friend class AssetTasks;
+        Condition(AssetTasks& owner, std::function<bool()> ready) : tasks{ &owner }, is_ready{ std::move(ready) }
+        {
+        }
+
+    private:
+        AssetTasks*           tasks = nullptr;
+        std::function<bool()> is_ready;
+    };
+
+    // Resumes the coroutine with what the job returned
+    template <typename Result>
+    class WorkerResult
+    {
+    public:
+        struct Slot
+        {
+            std::atomic<bool>                                                       is_done{ false };
+            std::conditional_t<std::is_void_v<Result>, bool, std::optional<Result>> value{};
+        };
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(AssetTask::Handle coroutine)
+        {
+            const std::shared_ptr<Slot> waited = slot;
+            return tasks->suspend(coroutine, [waited] { return waited->is_done.load(std::memory_order_acquire); }, ticket);
+        }
+
+        Result await_resume()
+        {
+            if constexpr (!std::is_void_v<Result>)
+                return std::move(*slot->value);
+        }
+
+    private:
+        friend class AssetTasks;
+        WorkerResult(AssetTasks& owner, std::shared_ptr<Slot> result, LoadScheduler::Ticket job) : tasks{ &owner }, slot{ std::move(result) }, ticket{ job }
+        {
+        }
+
+    private:
+        AssetTasks*           tasks = nullptr;
+        std::shared_ptr<Slot> slot;
+        LoadScheduler::Ticket ticket = 0;
+    };
+
+    AssetTasks(LoadScheduler& scheduler, TextureLoader& textures);
+    ~AssetTasks();
+
+    AssetTasks(const AssetTasks&)                = delete;
+    AssetTasks& operator=(const AssetTasks&)     = delete;
+    AssetTasks(AssetTasks&&) noexcept            = delete;
+    AssetTasks& operator=(AssetTasks&&) noexcept = delete;
+
+    TextureLoad LoadTexture(const std::filesystem::path& filename, const TextureOptions& options = {}, TextureAtlas* atlas = nullptr, LoadPriority priority = LoadPriority::Visible);
+    TextureLoad LoadTexture(const std::filesystem::path& filename, const TextureOptions& options, TextureArray& array, LoadPriority priority = LoadPriority::Visible);
+    Condition   Until(std::function<bool()> is_ready);
+
+    // Queued now, so it runs while the coroutine goes on to other loads
+    template <typename Work>
+    auto OnWorker(Work work, LoadPriority priority = LoadPriority::Background)
+    {
+        using Result                       = std::invoke_result_t<Work&>;
+        using Slot                         = typename WorkerResult<Result>::Slot;
+        const std::shared_ptr<Slot> slot   = std::make_shared<Slot>();
+        const LoadScheduler::Ticket ticket = scheduler.Submit(
+            priority,
+            [slot, job = std::move(work)]() mutable
+            {
+                if constexpr (std::is_void_v<Result>)
+                    job();
+                else
+                    slot->value.emplace(job());
+                slot->is_done.store(true, std::memory_order_release);
+            });
+        return WorkerResult<Result>{ *this, slot, ticket };
+    }
+
+    // Once a frame on the main thread, after the loaders' Updates
+    void  Update();
+    // Destroys every coroutine still waiting, before the loaders shut down
+    void  Shutdown();
+    Stats GetStats() const noexcept;
+
+private:
+    struct Waiting
+    {
+        AssetTask::Handle     coroutine;
+        std::function<bool()> is_ready;
+        LoadScheduler::Ticket ticket = 0; // an OnWorker job to drop if the coroutine is cancelled
+    };
+
+    // false to carry on without suspending, when it's ready already
+    bool suspend(AssetTask::Handle coroutine, std::function<bool()> is_ready, LoadScheduler::Ticket ticket = 0);
+    void destroy(Waiting& entry);
+
+private:
+    LoadScheduler&       scheduler;
+    TextureLoader&       textures;
+    std::vector<Waiting> waiting;
+    std::vector<Waiting> due; // this Update's, kept for the capacity
+    Stats                stats;
+};
@@ -0,0 +1,228 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "asset_watcher.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <Windows.h>
+#elif defined(__linux__) && !defined(__EMSCRIPTEN__)
+#    define ASSET_WATCHER_INOTIFY 1
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#    include <unordered_map>
+#endif
+
+struct AssetWatcher::Platform
+{
+#if defined(_WIN32)
+    static constexpr DWORD FILTER = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+    HANDLE     directory = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped{};
+    bool       reading = false; // a read is queued, and owns the buffer until it completes
+    // 64 KB is as much as the call takes for a network share; more changes than fit overflow and are lost
+    alignas(DWORD) std::array<std::byte, 64 * 1024> buffer{};
+
+    bool issue()
+    {
+        reading = ReadDirectoryChangesW(directory, buffer.data(), static_cast<DWORD>(buffer.size()), TRUE, FILTER, nullptr, &overlapped, nullptr) != FALSE;
+        return reading;
+    }
+#elif defined(ASSET_WATCHER_INOTIFY)
+    static constexpr std::uint32_t MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    int                                            descriptor = -1;
+    std::unordered_map<int, std::filesystem::path> directories; // by watch descriptor
+    alignas(inotify_event) std::array<char, 16 * 1024> buffer{};
+
+    // inotify isn't recursive, so every directory gets its own watch, the new ones as they appear
+    void watchTree(const std::filesystem::path& top)
+    {
+        watch(top);
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator{ top, error }; !error && it != std::filesystem::recursive_directory_iterator{}; it.increment(error))
+        {
+            if (it->is_directory(error))
+                watch(it->path());
+        }
+    }
+
+    void watch(const std::filesystem::path& folder)
+    {
+        if (const int handle = inotify_add_watch(descriptor, folder.c_str(), MASK); handle >= 0)
+            directories[handle] = folder;
+    }
+#endif
+};
+
+AssetWatcher::AssetWatcher() : platform{ std::make_unique<Platform>() }
+{
+}
+
+AssetWatcher::~AssetWatcher()
+{
+    Stop();
+}
+
+bool AssetWatcher::Start(const std::filesystem::path& folder)
+{
+    Stop();
+#if defined(_WIN32)
+    platform->directory = CreateFileW(folder.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                      FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (platform->directory == INVALID_HANDLE_VALUE)
+        return false;
+    platform->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (platform->overlapped.hEvent == nullptr || !platform->issue())
+    {
+        Stop();
+        return false;
+    }
+#elif defined(ASSET_WATCHER_INOTIFY)
+    platform->descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (platform->descriptor < 0)
+        return false;
+    platform->watchTree(folder);
+    if (platform->directories.empty())
+    {
+        Stop();
+        return false;
+    }
+#else
+    (void)folder;
+    return false;
+#endif
+    root = folder;
+    return true;
+}
+
+void AssetWatcher::Stop()
+{
+#if defined(_WIN32)
+    if (platform->reading)
+    {
+        // the read has to be done with the buffer before it can go
+        CancelIoEx(platform->directory, &platform->overlapped);
+        DWORD bytes = 0;
+        GetOverlappedResult(platform->directory, &platform->overlapped, &bytes, TRUE);
+    }
+    if (platform->directory != INVALID_HANDLE_VALUE)
+        CloseHandle(platform->directory);
+    if (platform->overlapped.hEvent != nullptr)
+        CloseHandle(platform->overlapped.hEvent);
+    platform->directory  = INVALID_HANDLE_VALUE;
+    platform->overlapped = OVERLAPPED{};
+    platform->reading    = false;
+#elif defined(ASSET_WATCHER_INOTIFY)
+    if (platform->descriptor >= 0)
+        ::close(platform->descriptor);
+    platform->descriptor = -1;
+    platform->directories.clear();
+#endif
+    root.clear();
+    pending.clear();
+}
+
+bool AssetWatcher::IsWatching() const noexcept
+{
+    return !root.empty();
+}
+
+const std::filesystem::path& AssetWatcher::Root() const noexcept
+{
+    return root;
+}
+
+void AssetWatcher::Poll(std::vector<std::filesystem::path>& out_changed)
+{
+    if (!IsWatching())
+        return;
+    readEvents();
+
+    const Uint64 now    = SDL_GetPerformanceCounter();
+    const auto   settle = static_cast<Uint64>(SETTLE_MS * static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0);
+    const auto   quiet  = [now, settle](const Pending& entry) { return now - entry.last_event >= settle; };
+    for (const Pending& entry : pending)
+    {
+        // directories and files deleted again before they settled report nothing
+        std::error_code error;
+        if (quiet(entry) && std::filesystem::is_regular_file(entry.path, error))
+            out_changed.push_back(entry.path);
+    }
+    pending.erase(std::remove_if(pending.begin(), pending.end(), quiet), pending.end());
+}
+
+void AssetWatcher::readEvents()
+{
+#if defined(_WIN32)
+    if (WaitForSingleObject(platform->overlapped.hEvent, 0) != WAIT_OBJECT_0)
+        return;
+    platform->reading = false;
+    DWORD bytes       = 0;
+    // 0 bytes is an overflow: the changes are lost, and the next save reports again
+    if (GetOverlappedResult(platform->directory, &platform->overlapped, &bytes, FALSE) && bytes > 0)
+    {
+        std::size_t offset = 0;
+        for (;;)
+        {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(platform->buffer.data() + offset);
+            if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+                touched(root / std::wstring{ info->FileName, info->FileNameLength / sizeof(WCHAR) });
+            if (info->NextEntryOffset == 0)
+                break;
+            offset += info->NextEntryOffset;
+        }
+    }
+    if (!platform->issue())
+        Stop();
+#elif defined(ASSET_WATCHER_INOTIFY)
+    for (;;)
+    {
+        // non-blocking: -1 with EAGAIN once the queue is empty
+        const ssize_t length = ::read(platform->descriptor, platform->buffer.data(), platform->buffer.size());
+        if (length <= 0)
+            break;
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(platform->buffer.data() + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            const auto folder = platform->directories.find(event->wd);
+            if (folder == platform->directories.end())
+                continue;
+            if ((event->mask & IN_IGNORED) != 0)
+            {
+                platform->directories.erase(folder);
+                continue;
+            }
+            if (event->len == 0)
+                continue;
+            const std::filesystem::path path = folder->second / event->name;
+            if ((event->mask & IN_ISDIR) != 0)
+                platform->watchTree(path);
+            else if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) != 0)
+                touched(path);
+        }
+    }
+#endif
+}
+
+void AssetWatcher::touched(const std::filesystem::path& path)
+{
+    const Uint64                now    = SDL_GetPerformanceCounter();
+    const std::filesystem::path normal = path.lexically_normal();
+    const auto                  found  = std::find_if(pending.begin(), pending.end(), [&normal](const Pending& entry) { return entry.path == normal; });
+    if (found != pending.end())
+        found->last_event = now;
+    else
+        pending.push_back(Pending{ normal, now });
+}
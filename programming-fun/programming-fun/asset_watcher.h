@@ -0,0 +1,62 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <SDL.h>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+/**
+ * Reports the files under a folder that were written while the app runs, so their assets can be reloaded.
+ *
+ * ReadDirectoryChangesW over the whole tree on Windows, inotify with a watch per directory on Linux, and
+ * nothing on Emscripten or elsewhere, where Start is false. Nothing here blocks: Poll takes whatever the OS
+ * queued since the last call. Editors save in several writes, or write a temporary file and rename it over
+ * the old one, so a path is only reported once it has been quiet for SETTLE_MS. Main thread.
+ */
+class AssetWatcher
+{
+public:
+    static constexpr double SETTLE_MS = 150.0;
+
+    AssetWatcher();
+    ~AssetWatcher();
+
+    AssetWatcher(const AssetWatcher&)                = delete;
+    AssetWatcher& operator=(const AssetWatcher&)     = delete;
+    AssetWatcher(AssetWatcher&&) noexcept            = delete;
+    AssetWatcher& operator=(AssetWatcher&&) noexcept = delete;
+
+    // False where watching isn't supported or `root` can't be watched
+    bool Start(const std::filesystem::path& root);
+    void Stop();
+
+    bool                         IsWatching() const noexcept;
+    const std::filesystem::path& Root() const noexcept;
+
+    // Appends the files that settled since the last call, as absolute paths under Root
+    void Poll(std::vector<std::filesystem::path>& out_changed);
+
+private:
+    struct Platform;
+
+    struct Pending
+    {
+        std::filesystem::path path;
+        Uint64                last_event = 0; // SDL_GetPerformanceCounter
+    };
+
+    void readEvents();
+    void touched(const std::filesystem::path& path);
+
+private:
+    std::unique_ptr<Platform> platform;
+    std::filesystem::path     root;
+    std::vector<Pending>      pending;
+};
@@ -0,0 +1,665 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "async_file_reader.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <Windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#    include <cerrno>
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#        include <atomic>
+#        include <linux/io_uring.h>
+#        include <sys/mman.h>
+#        include <sys/syscall.h>
+#        include <sys/uio.h>
+#        define ASYNC_FILE_READER_IO_URING 1
+#    endif
+#endif
+
+#if !defined(ASYNC_FILE_READER_IO_URING)
+#    define ASYNC_FILE_READER_IO_URING 0
+#endif
+
+namespace
+{
+#if !defined(__EMSCRIPTEN__)
+#    if defined(_WIN32)
+    using FileHandle = HANDLE;
+#    else
+    using FileHandle = int;
+#    endif
+
+    // one read of a piece of a file, alive until the kernel is done with it
+    struct Chunk
+    {
+#    if defined(_WIN32)
+        OVERLAPPED overlapped{}; // first, so the OVERLAPPED* a completion carries is the chunk's address
+#    elif ASYNC_FILE_READER_IO_URING
+        iovec target{}; // what the readv fills
+#    endif
+        std::size_t    file = 0; // the slot of the file it is a piece of
+        FileHandle     handle{};
+        unsigned char* data   = nullptr;
+        std::uint64_t  offset = 0;
+        std::uint32_t  size   = 0;
+    };
+
+    struct Finished
+    {
+        Chunk* chunk = nullptr;
+        bool   ok    = false; // every byte asked for arrived
+    };
+
+    // false when it isn't a regular file that can be read
+    bool open_file(const std::filesystem::path& filename, FileHandle& out_handle, std::uint64_t& out_size)
+    {
+#    if defined(_WIN32)
+        HANDLE handle = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(handle, &size))
+        {
+            CloseHandle(handle);
+            return false;
+        }
+        out_handle = handle;
+        out_size   = static_cast<std::uint64_t>(size.QuadPart);
+#    else
+        const int descriptor = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0)
+            return false;
+        struct stat info{};
+        if (fstat(descriptor, &info) != 0 || !S_ISREG(info.st_mode))
+        {
+            ::close(descriptor);
+            return false;
+        }
+        out_handle = descriptor;
+        out_size   = static_cast<std::uint64_t>(info.st_size);
+#    endif
+        return true;
+    }
+
+    void close_file(FileHandle handle)
+    {
+#    if defined(_WIN32)
+        CloseHandle(handle);
+#    else
+        ::close(handle);
+#    endif
+    }
+
+    // the kernel's side: chunks go in, finished ones come back; the blocking reads when Open fails
+    class IoQueue
+    {
+    public:
+        IoQueue() = default;
+        ~IoQueue()
+        {
+            Close();
+        }
+
+        IoQueue(const IoQueue&)                = delete;
+        IoQueue& operator=(const IoQueue&)     = delete;
+        IoQueue(IoQueue&&) noexcept            = delete;
+        IoQueue& operator=(IoQueue&&) noexcept = delete;
+
+        bool Open([[maybe_unused]] unsigned depth)
+        {
+#    if defined(_WIN32)
+            port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+            return port != nullptr;
+#    elif ASYNC_FILE_READER_IO_URING
+            io_uring_params params{};
+            const long      descriptor = syscall(__NR_io_uring_setup, depth, &params);
+            if (descriptor < 0)
+                return false;
+            ring             = static_cast<int>(descriptor);
+            sq_bytes         = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_bytes         = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            sqe_bytes        = params.sq_entries * sizeof(io_uring_sqe);
+            const bool share = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (share)
+                sq_bytes = cq_bytes = std::max(sq_bytes, cq_bytes);
+            sq_map  = map(sq_bytes, IORING_OFF_SQ_RING);
+            cq_map  = share ? sq_map : map(cq_bytes, IORING_OFF_CQ_RING);
+            sqe_map = map(sqe_bytes, IORING_OFF_SQES);
+            if (sq_map == nullptr || cq_map == nullptr || sqe_map == nullptr)
+            {
+                Close();
+                return false;
+            }
+            sq_tail  = at<unsigned>(sq_map, params.sq_off.tail);
+            sq_mask  = *at<unsigned>(sq_map, params.sq_off.ring_mask);
+            sq_array = at<unsigned>(sq_map, params.sq_off.array);
+            cq_head  = at<unsigned>(cq_map, params.cq_off.head);
+            cq_tail  = at<unsigned>(cq_map, params.cq_off.tail);
+            cq_mask  = *at<unsigned>(cq_map, params.cq_off.ring_mask);
+            cqes     = at<io_uring_cqe>(cq_map, params.cq_off.cqes);
+            sqes     = static_cast<io_uring_sqe*>(sqe_map);
+            return true;
+#    else
+            return false;
+#    endif
+        }
+
+        void Close()
+        {
+#    if defined(_WIN32)
+            if (port != nullptr)
+                CloseHandle(port);
+            port = nullptr;
+#    elif ASYNC_FILE_READER_IO_URING
+            if (sqe_map != nullptr)
+                munmap(sqe_map, sqe_bytes);
+            if (cq_map != nullptr && cq_map != sq_map)
+                munmap(cq_map, cq_bytes);
+            if (sq_map != nullptr)
+                munmap(sq_map, sq_bytes);
+            if (ring >= 0)
+                ::close(ring);
+            sq_map = cq_map = sqe_map = nullptr;
+            ring                      = -1;
+#    endif
+        }
+
+        AsyncFileReader::Backend Kind() const noexcept
+        {
+#    if defined(_WIN32)
+            return port != nullptr ? AsyncFileReader::Backend::Iocp : AsyncFileReader::Backend::Blocking;
+#    elif ASYNC_FILE_READER_IO_URING
+            return ring >= 0 ? AsyncFileReader::Backend::IoUring : AsyncFileReader::Backend::Blocking;
+#    else
+            return AsyncFileReader::Backend::Blocking;
+#    endif
+        }
+
+        // a newly opened file's completions come here; false when they can't
+        bool Attach([[maybe_unused]] FileHandle handle)
+        {
+#    if defined(_WIN32)
+            return port == nullptr || CreateIoCompletionPort(handle, port, 0, 0) != nullptr;
+#    else
+            return true;
+#    endif
+        }
+
+        void Add(Chunk& chunk)
+        {
+#    if defined(_WIN32)
+            chunk.overlapped            = OVERLAPPED{};
+            chunk.overlapped.Offset     = static_cast<DWORD>(chunk.offset);
+            chunk.overlapped.OffsetHigh = static_cast<DWORD>(chunk.offset >> 32);
+            // there is no batch to submit: the read starts here, and a refusal finishes it at the next wait
+            if (port != nullptr && !ReadFile(chunk.handle, chunk.data, chunk.size, nullptr, &chunk.overlapped) && GetLastError() != ERROR_IO_PENDING)
+                refused.push_back(&chunk);
+            else if (port == nullptr)
+                added.push_back(&chunk);
+#    elif ASYNC_FILE_READER_IO_URING
+            if (ring < 0)
+            {
+                added.push_back(&chunk);
+                return;
+            }
+            // only this thread moves the tail; the kernel sees the entry once the new tail is published
+            const unsigned tail  = *sq_tail;
+            const unsigned index = tail & sq_mask;
+            io_uring_sqe&  entry = sqes[index];
+            chunk.target         = iovec{ chunk.data, chunk.size };
+            entry                = io_uring_sqe{};
+            entry.opcode         = IORING_OP_READV;
+            entry.fd             = chunk.handle;
+            entry.addr           = reinterpret_cast<std::uint64_t>(&chunk.target);
+            entry.len            = 1;
+            entry.off            = chunk.offset;
+            entry.user_data      = reinterpret_cast<std::uint64_t>(&chunk);
+            sq_array[index]      = index;
+            std::atomic_ref<unsigned>{ *sq_tail }.store(tail + 1, std::memory_order_release);
+            ++unsubmitted;
+#    else
+            added.push_back(&chunk);
+#    endif
+        }
+
+        // hands the kernel everything added since the last call and waits until at least one chunk is done
+        void SubmitAndWait(std::vector<Finished>& out_finished)
+        {
+            out_finished.clear();
+            if (Kind() == AsyncFileReader::Backend::Blocking)
+            {
+                for (Chunk* chunk : added)
+                    out_finished.push_back(Finished{ chunk, read_now(*chunk) });
+                added.clear();
+                return;
+            }
+#    if defined(_WIN32)
+            for (Chunk* chunk : refused)
+                out_finished.push_back(Finished{ chunk, false });
+            refused.clear();
+            if (!out_finished.empty())
+                return;
+            OVERLAPPED_ENTRY entries[64];
+            ULONG            removed = 0;
+            if (!GetQueuedCompletionStatusEx(port, entries, static_cast<ULONG>(std::size(entries)), &removed, INFINITE, FALSE))
+                return;
+            for (ULONG i = 0; i < removed; ++i)
+            {
+                auto* chunk = reinterpret_cast<Chunk*>(entries[i].lpOverlapped);
+                out_finished.push_back(Finished{ chunk, chunk->overlapped.Internal == 0 && entries[i].dwNumberOfBytesTransferred == chunk->size });
+            }
+#    elif ASYNC_FILE_READER_IO_URING
+            for (;;)
+            {
+                unsigned       head = *cq_head;
+                const unsigned tail = std::atomic_ref<unsigned>{ *cq_tail }.load(std::memory_order_acquire);
+                for (; head != tail; ++head)
+                {
+                    const io_uring_cqe& entry = cqes[head & cq_mask];
+                    auto*               chunk = reinterpret_cast<Chunk*>(entry.user_data);
+                    out_finished.push_back(Finished{ chunk, entry.res == static_cast<int>(chunk->size) });
+                }
+                std::atomic_ref<unsigned>{ *cq_head }.store(head, std::memory_order_release);
+                if (!out_finished.empty() && unsubmitted == 0)
+                    return;
+                // one call submits the batch and, when nothing has finished yet, sleeps until something does
+                const long submitted = syscall(__NR_io_uring_enter, ring, unsubmitted, out_finished.empty() ? 1u : 0u, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (submitted >= 0)
+                    unsubmitted -= static_cast<unsigned>(submitted);
+                else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                    return;
+            }
+#    endif
+        }
+
+    private:
+        static bool read_now(Chunk& chunk)
+        {
+#    if defined(_WIN32)
+            // the handle is overlapped, so even the blocking read names its offset and waits for itself
+            DWORD read = 0;
+            return (ReadFile(chunk.handle, chunk.data, chunk.size, nullptr, &chunk.overlapped) || GetLastError() == ERROR_IO_PENDING) &&
+                   GetOverlappedResult(chunk.handle, &chunk.overlapped, &read, TRUE) && read == chunk.size;
+#    else
+            std::uint32_t done = 0;
+            while (done < chunk.size)
+            {
+                const ssize_t read = pread(chunk.handle, chunk.data + done, chunk.size - done, static_cast<off_t>(chunk.offset + done));
+                if (read < 0 && errno == EINTR)
+                    continue;
+                if (read <= 0)
+                    return false;
+                done += static_cast<std::uint32_t>(read);
+            }
+            return true;
+#    endif
+        }
+
+#    if ASYNC_FILE_READER_IO_URING
+        void* map(std::size_t bytes, std::uint64_t offset) const
+        {
+            void* address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, static_cast<off_t>(offset));
+            return address != MAP_FAILED ? address : nullptr;
+        }
+
+        template <typename T>
+        static T* at(void* map, std::uint32_t offset)
+        {
+            return reinterpret_cast<T*>(static_cast<unsigned char*>(map) + offset);
+        }
+#    endif
+
+    private:
+        std::vector<Chunk*> added; // waiting for the blocking reads
+#    if defined(_WIN32)
+        HANDLE              port = nullptr;
+        std::vector<Chunk*> refused; // ReadFile failed outright, no completion is coming
+#    elif ASYNC_FILE_READER_IO_URING
+        int           ring        = -1;
+        unsigned      unsubmitted = 0; // entries past the kernel's head
+        void*         sq_map      = nullptr;
+        void*         cq_map      = nullptr;
+        void*         sqe_map     = nullptr;
+        std::size_t   sq_bytes    = 0;
+        std::size_t   cq_bytes    = 0;
+        std::size_t   sqe_bytes   = 0;
+        unsigned*     sq_tail     = nullptr;
+        unsigned*     sq_array    = nullptr;
+        unsigned      sq_mask     = 0;
+        io_uring_sqe* sqes        = nullptr;
+        unsigned*     cq_head     = nullptr;
+        unsigned*     cq_tail     = nullptr;
+        unsigned      cq_mask     = 0;
+        io_uring_cqe* cqes        = nullptr;
+#    endif
+    };
+#endif
+}
+
+AsyncFileReader::AsyncFileReader(std::size_t max_read_ahead_bytes, int max_queue_depth)
+    : read_ahead_bytes{ std::max<std::size_t>(max_read_ahead_bytes, CHUNK_BYTES) }, queue_depth{ std::max(max_queue_depth, 1) }
+{
+#if !defined(__EMSCRIPTEN__)
+    thread = std::thread{ [this] { threadLoop(); } };
+#endif
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    {
+        std::lock_guard lock{ mutex };
+        is_stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable())
+        thread.join();
+}
+
+void AsyncFileReader::Read(std::vector<std::filesystem::path> candidates, [[maybe_unused]] LoadPriority priority, Done done)
+{
+#if defined(__EMSCRIPTEN__)
+    for (const auto& candidate : candidates)
+    {
+        std::ifstream file{ candidate, std::ios::binary | std::ios::ate };
+        if (!file)
+            continue;
+        std::vector<unsigned char> bytes(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        const bool is_read = static_cast<bool>(file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())));
+        {
+            std::lock_guard lock{ mutex };
+            if (is_read)
+                hold(candidate, std::move(bytes));
+            else
+                ++stats.failed;
+        }
+        done(is_read ? candidate : std::filesystem::path{});
+        return;
+    }
+    {
+        std::lock_guard lock{ mutex };
+        ++stats.missing;
+    }
+    done({});
+#else
+    {
+        std::lock_guard lock{ mutex };
+        queued[static_cast<std::size_t>(priority)].push_back(Request{ std::move(candidates), priority, std::move(done) });
+    }
+    wake.notify_one();
+#endif
+}
+
+bool AsyncFileReader::Promote(const std::filesystem::path& first, LoadPriority priority)
+{
+    std::lock_guard lock{ mutex };
+    const auto      target = static_cast<std::size_t>(priority);
+    for (std::size_t i = target + 1; i < queued.size(); ++i)
+    {
+        auto&      queue = queued[i];
+        const auto found = std::find_if(queue.begin(), queue.end(), [&first](const Request& request) { return request.candidates.front() == first; });
+        if (found == queue.end())
+            continue;
+        found->priority = priority;
+        queued[target].push_back(std::move(*found));
+        queue.erase(found);
+        return true;
+    }
+    return false;
+}
+
+bool AsyncFileReader::Take(const std::filesystem::path& filename, std::vector<unsigned char>& out_bytes)
+{
+    {
+        std::lock_guard lock{ mutex };
+        const auto      found = held.find(filename.string());
+        if (found == held.end())
+            return false;
+        out_bytes = std::move(found->second);
+        stats.held -= out_bytes.size();
+        held.erase(found);
+    }
+    // room for the next read-ahead
+    wake.notify_one();
+    return true;
+}
+
+void AsyncFileReader::Discard(const std::filesystem::path& filename)
+{
+    std::vector<unsigned char> dropped; // freed outside the lock
+    {
+        std::lock_guard lock{ mutex };
+        const auto      found = held.find(filename.string());
+        if (found == held.end())
+            return;
+        dropped = std::move(found->second);
+        stats.held -= dropped.size();
+        ++stats.discarded;
+        held.erase(found);
+    }
+    wake.notify_one();
+}
+
+AsyncFileReader::Stats AsyncFileReader::GetStats() const
+{
+    std::lock_guard lock{ mutex };
+    Stats           copy = stats;
+    for (const auto& queue : queued)
+        copy.queued += static_cast<int>(queue.size());
+    return copy;
+}
+
+const char* AsyncFileReader::BackendName(Backend backend) noexcept
+{
+    switch (backend)
+    {
+        case Backend::Blocking: return "blocking reads";
+        case Backend::IoUring: return "io_uring";
+        case Backend::Iocp: return "IOCP";
+    }
+    return "?";
+}
+
+void AsyncFileReader::hold(const std::filesystem::path& filename, std::vector<unsigned char> bytes)
+{
+    // an earlier read of the same file still waiting is the one its job will take
+    auto [entry, is_new] = held.try_emplace(filename.string());
+    if (!is_new)
+    {
+        ++stats.discarded;
+        return;
+    }
+    stats.held += bytes.size();
+    stats.bytes += bytes.size();
+    ++stats.read;
+    entry->second = std::move(bytes);
+}
+
+#if !defined(__EMSCRIPTEN__)
+void AsyncFileReader::threadLoop()
+{
+    profiler::SetThreadName("file reader");
+
+    // a file open on the thread, in a slot its chunks point back to
+    struct File
+    {
+        Request                    request;
+        std::filesystem::path      path;
+        FileHandle                 handle{};
+        std::vector<unsigned char> bytes;
+        std::size_t                next      = 0; // the first byte no chunk has asked for yet
+        int                        in_flight = 0;
+        bool                       is_open   = false;
+        bool                       failed    = false;
+    };
+
+    IoQueue io;
+    io.Open(static_cast<unsigned>(queue_depth));
+    {
+        std::lock_guard lock{ mutex };
+        stats.backend = io.Kind();
+    }
+    std::vector<File>        files(static_cast<std::size_t>(queue_depth));
+    std::vector<Chunk>       chunks(static_cast<std::size_t>(queue_depth));
+    std::vector<std::size_t> free_chunks(chunks.size());
+    for (std::size_t i = 0; i < free_chunks.size(); ++i)
+        free_chunks[i] = i;
+    std::vector<Finished> finished;
+    std::vector<Request>  taken;
+    int                   open_files = 0;
+
+    // the file's bytes go to whoever asked, or its job reads the file itself
+    const auto close = [this, &open_files](File& file)
+    {
+        close_file(file.handle);
+        file.is_open = false;
+        --open_files;
+        const bool ok = !file.failed;
+        {
+            std::lock_guard lock{ mutex };
+            reading_bytes -= file.bytes.size();
+            --stats.reading;
+            if (ok)
+                hold(file.path, std::move(file.bytes));
+            else
+                ++stats.failed;
+        }
+        file.bytes = {};
+        Request request = std::move(file.request);
+        request.done(ok ? file.path : std::filesystem::path{});
+    };
+
+    for (;;)
+    {
+        std::array<std::deque<Request>, LoadScheduler::PRIORITY_COUNT> dropped; // the scheduler's captures, released outside the lock
+        bool                                                           is_closing = false;
+        {
+            std::unique_lock lock{ mutex };
+            const auto       has_room   = [this, &open_files, &taken] { return open_files + static_cast<int>(taken.size()) < queue_depth && stats.held + reading_bytes < read_ahead_bytes; };
+            const auto       has_queued = [this] { return std::any_of(queued.begin(), queued.end(), [](const std::deque<Request>& queue) { return !queue.empty(); }); };
+            // with reads in flight it is the kernel that wakes this thread, and new requests wait for that
+            if (open_files == 0)
+                wake.wait(lock, [&] { return is_stopping || (has_queued() && has_room()); });
+            is_closing = is_stopping;
+            if (is_closing)
+            {
+                dropped.swap(queued);
+                if (open_files == 0)
+                    break;
+            }
+            while (!is_closing && has_queued() && has_room())
+            {
+                auto& queue = *std::find_if(queued.begin(), queued.end(), [](const std::deque<Request>& requests) { return !requests.empty(); });
+                taken.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+
+        for (Request& request : taken)
+        {
+            FileHandle    handle{};
+            std::uint64_t size  = 0;
+            auto          found = request.candidates.begin();
+            for (; found != request.candidates.end(); ++found)
+            {
+                if (!open_file(*found, handle, size))
+                    continue;
+                if (io.Attach(handle))
+                    break;
+                close_file(handle);
+            }
+            if (found == request.candidates.end())
+            {
+                {
+                    std::lock_guard lock{ mutex };
+                    ++stats.missing;
+                }
+                request.done({});
+                continue;
+            }
+            File& file   = *std::find_if(files.begin(), files.end(), [](const File& slot) { return !slot.is_open; });
+            file.path    = *found;
+            file.request = std::move(request);
+            file.handle  = handle;
+            file.next    = 0;
+            file.is_open = true;
+            file.failed  = false;
+            file.bytes.resize(static_cast<std::size_t>(size));
+            ++open_files;
+            {
+                std::lock_guard lock{ mutex };
+                reading_bytes += file.bytes.size();
+                ++stats.reading;
+            }
+            if (file.bytes.empty())
+                close(file);
+        }
+        taken.clear();
+
+        // the free chunks go to the open files in slot order, a whole small file each or the next pieces of a big one
+        for (std::size_t slot = 0; slot < files.size() && !free_chunks.empty(); ++slot)
+        {
+            File& file = files[slot];
+            while (file.is_open && !file.failed && !is_closing && file.next < file.bytes.size() && !free_chunks.empty())
+            {
+                Chunk& chunk = chunks[free_chunks.back()];
+                free_chunks.pop_back();
+                chunk.file   = slot;
+                chunk.handle = file.handle;
+                chunk.data   = file.bytes.data() + file.next;
+                chunk.offset = file.next;
+                chunk.size   = static_cast<std::uint32_t>(std::min(file.bytes.size() - file.next, CHUNK_BYTES));
+                file.next += chunk.size;
+                ++file.in_flight;
+                io.Add(chunk);
+            }
+        }
+        if (free_chunks.size() == chunks.size())
+        {
+            // stopping: the files that have nothing in flight are done
+            for (File& file : files)
+            {
+                if (file.is_open)
+                {
+                    file.failed = true;
+                    close(file);
+                }
+            }
+            continue;
+        }
+
+        io.SubmitAndWait(finished);
+        {
+            std::lock_guard lock{ mutex };
+            ++stats.batches;
+            stats.chunks += finished.size();
+        }
+        for (const Finished& result : finished)
+        {
+            File& file = files[result.chunk->file];
+            free_chunks.push_back(static_cast<std::size_t>(result.chunk - chunks.data()));
+            --file.in_flight;
+            file.failed = file.failed || !result.ok;
+            if (file.in_flight == 0 && (file.failed || file.next == file.bytes.size()))
+                close(file);
+        }
+    }
+}
+#endif
@@ -0,0 +1,123 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "load_scheduler.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Reads the loaders' loose files into memory ahead of their decodes, on a thread of its own.
+ *
+ * A decode that opens its own file holds a worker for as long as the disk takes, and reads one file after
+ * another. Instead the LoadScheduler hands a load's files to Read and only lets the job on a worker once the
+ * first of them that exists is in memory; the job then Takes the bytes where it would have read the file.
+ * The I/O thread takes whatever requests queued up since it last looked, the most urgent and then the oldest
+ * first, splits each file into CHUNK_BYTES reads and keeps up to `queue_depth` of them in flight, so the many
+ * small files of a scene and the pieces of a big one overlap on the disk:
+ *  - Linux: the batch goes into an io_uring's submission queue and to the kernel in one io_uring_enter, which
+ *    also waits for the first completion.
+ *  - Windows: every chunk is an overlapped ReadFile on a handle tied to an I/O completion port, and the thread
+ *    reaps them a batch at a time with GetQueuedCompletionStatusEx.
+ *  - Elsewhere, or where io_uring is refused (old kernels, sandboxes), the thread reads each chunk in turn,
+ *    which still keeps the workers off the disk. The Emscripten build reads inline: MEMFS is memory already.
+ * Read-ahead pauses once `read_ahead_bytes` are read or being read for jobs that haven't taken them yet.
+ * Pack entries don't come through here, the pack is a mapping; see AssetPack::Prefetch.
+ *
+ * Read, Promote and GetStats are for the main thread, Take and Discard for the jobs; `done` is called on the
+ * I/O thread. Queued reads are dropped unanswered when the reader goes, so it has to outlive the scheduler.
+ */
+class AsyncFileReader
+{
+public:
+    // The first candidate that exists, now in memory; empty when none could be read and the job is on its own
+    using Done = std::function<void(const std::filesystem::path& read)>;
+
+    enum class Backend : std::uint8_t
+    {
+        Blocking,
+        IoUring,
+        Iocp
+    };
+
+    static constexpr std::size_t CHUNK_BYTES              = 256 * 1024;
+    static constexpr int         DEFAULT_QUEUE_DEPTH      = 32; // chunks in flight
+    static constexpr std::size_t DEFAULT_READ_AHEAD_BYTES = 64 * 1024 * 1024;
+
+    struct Stats
+    {
+        Backend       backend   = Backend::Blocking;
+        int           queued    = 0;
+        int           reading   = 0; // files
+        std::size_t   held      = 0; // bytes read and not taken yet
+        std::uint64_t read      = 0; // files
+        std::uint64_t missing   = 0; // requests none of whose candidates exist
+        std::uint64_t failed    = 0; // files that opened but didn't read, which their jobs read themselves
+        std::uint64_t discarded = 0; // files read and never taken
+        std::uint64_t bytes     = 0;
+        std::uint64_t chunks    = 0;
+        std::uint64_t batches   = 0; // trips to the kernel that submitted or waited
+    };
+
+    explicit AsyncFileReader(std::size_t read_ahead_bytes = DEFAULT_READ_AHEAD_BYTES, int queue_depth = DEFAULT_QUEUE_DEPTH);
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&)                = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&)     = delete;
+    AsyncFileReader(AsyncFileReader&&) noexcept            = delete;
+    AsyncFileReader& operator=(AsyncFileReader&&) noexcept = delete;
+
+    // Reads the first of `candidates` that exists, best first, and calls `done` once it is in memory
+    void Read(std::vector<std::filesystem::path> candidates, LoadPriority priority, Done done);
+    // Moves a read that hasn't started up to `priority`; `first` is its first candidate
+    bool Promote(const std::filesystem::path& first, LoadPriority priority);
+    // Moves what Read left for `filename` into `out_bytes`; false when there is nothing, and the caller reads the file itself
+    bool Take(const std::filesystem::path& filename, std::vector<unsigned char>& out_bytes);
+    // Drops what Read left for `filename`, for a job that ended up not wanting it
+    void  Discard(const std::filesystem::path& filename);
+    Stats GetStats() const;
+
+    static const char* BackendName(Backend backend) noexcept;
+
+private:
+    struct Request
+    {
+        std::vector<std::filesystem::path> candidates;
+        LoadPriority                       priority = LoadPriority::Visible;
+        Done                               done;
+    };
+
+    void threadLoop();
+    // keeps a finished read for its job to Take; called with the lock held
+    void hold(const std::filesystem::path& filename, std::vector<unsigned char> bytes);
+
+private:
+    mutable std::mutex      mutex;
+    std::condition_variable wake;
+    std::thread             thread;
+    bool                    is_stopping      = false;
+    std::size_t             read_ahead_bytes = DEFAULT_READ_AHEAD_BYTES;
+    int                     queue_depth      = DEFAULT_QUEUE_DEPTH;
+    std::size_t             reading_bytes    = 0; // of the files the thread has open
+    Stats                   stats;
+
+    std::array<std::deque<Request>, LoadScheduler::PRIORITY_COUNT> queued;
+    std::unordered_map<std::string, std::vector<unsigned char>>    held; // by the path the loaders read
+};
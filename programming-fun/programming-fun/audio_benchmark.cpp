@@ -0,0 +1,287 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "audio_benchmark.h"
+
+#include "asset_id.h"
+#include "audio_device.h"
+#include "audio_effects.h"
+#include "audio_stream.h"
+#include "audio_thread.h"
+#include "logger.h"
+#include "software_mixer.h"
+#include "sound_loader.h"
+#include "spatial_audio.h"
+#include "voice_pool.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <ostream>
+#include <thread>
+
+namespace
+{
+    using namespace asset_literals;
+
+    constexpr auto  UPDATE_PERIOD = std::chrono::milliseconds{ 16 };
+    constexpr float SCATTER       = 40.0f; // emitters land within this of the listener
+    constexpr float HEARING       = 50.0f; // and fall silent from here on
+
+    struct Sounds
+    {
+        DecodedSound wav; // mono, so it can be an emitter too
+        DecodedSound ogg;
+        ALuint       wav_buffer = 0;
+        ALuint       ogg_buffer = 0;
+    };
+
+    // quieter the more overlap at this rate, so a step that keeps up still sounds like quacking rather than clipping
+    float one_shot_gain(int per_second) noexcept
+    {
+        return 0.5f / std::sqrt(std::max(1.0f, static_cast<float>(per_second) * 0.5f));
+    }
+
+    double seconds_since(Uint64 begin) noexcept
+    {
+        return static_cast<double>(SDL_GetPerformanceCounter() - begin) / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    std::uint64_t underruns_of(const AudioStream* music) noexcept
+    {
+        return music != nullptr ? music->GetStats().underruns : 0;
+    }
+
+    /**
+     * The step's real time in UPDATE_PERIOD ticks, like frames: `play(i)` for each one-shot due, false when it was
+     * refused, then `flush(delta_seconds)` for what the frame sends after them, both timed as the requests' cost;
+     * `sample()` after that, untimed. Returns the step's seconds.
+     */
+    template <typename Play, typename Flush, typename Sample>
+    double drive(audio_benchmark::Step& step, double seconds, Play&& play, Flush&& flush, Sample&& sample)
+    {
+        const Uint64 begin      = SDL_GetPerformanceCounter();
+        Uint64       last       = begin;
+        Uint64       play_ticks = 0;
+        double       owed       = 0.0;
+        while (seconds_since(begin) < seconds)
+        {
+            std::this_thread::sleep_for(UPDATE_PERIOD);
+            const Uint64 now     = SDL_GetPerformanceCounter();
+            const double elapsed = static_cast<double>(now - last) / static_cast<double>(SDL_GetPerformanceFrequency());
+            last                 = now;
+            owed += elapsed * step.per_second;
+            const int due = static_cast<int>(owed);
+            owed -= due;
+
+            const Uint64 sent = SDL_GetPerformanceCounter();
+            for (int i = 0; i < due; ++i)
+            {
+                if (!play(step.requests + i))
+                    ++step.dropped;
+            }
+            flush(static_cast<float>(elapsed));
+            play_ticks += SDL_GetPerformanceCounter() - sent;
+            step.requests += due;
+            sample();
+        }
+        if (step.requests > 0)
+            step.play_us = static_cast<double>(play_ticks) * 1'000'000.0 / static_cast<double>(SDL_GetPerformanceFrequency()) / step.requests;
+        return seconds_since(begin);
+    }
+
+    // both OpenAL backends, on fresh voices and a fresh AudioThread
+    audio_benchmark::Step run_openal(audio_benchmark::Backend backend, int per_second, double seconds, const Sounds& sounds, AudioStreamer& streamer, const AudioStream* music)
+    {
+        VoicePool    voices;
+        AudioEffects effects; // never set up, so everything plays dry
+        SpatialAudio spatial;
+        AudioThread  audio_thread;
+        voices.Setup();
+        spatial.Setup();
+        audio_thread.Start(voices, effects, spatial);
+        audio_thread.SetListener(glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 0.0f, -1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+
+        audio_benchmark::Step step;
+        step.backend    = backend;
+        step.per_second = per_second;
+        const float         gain             = one_shot_gain(per_second);
+        const std::uint64_t underruns_before = underruns_of(music);
+        std::uint32_t       seed             = 1;
+        const auto          play             = [&](int i)
+        {
+            if (backend == audio_benchmark::Backend::VoicePool)
+            {
+                VoiceParams params;
+                params.gain = gain;
+                return audio_thread.Play(i % 2 == 0 ? sounds.wav_buffer : sounds.ogg_buffer, params).IsValid();
+            }
+            seed                  = seed * 1664525u + 1013904223u;
+            const float   angle   = static_cast<float>(seed >> 8) / static_cast<float>(1u << 24) * 6.2831853f;
+            const float   reach   = static_cast<float>(seed & 0xffu) / 255.0f * SCATTER;
+            EmitterParams emitter;
+            emitter.gain         = gain;
+            emitter.max_distance = HEARING;
+            emitter.looping      = false;
+            return audio_thread.AddEmitter(sounds.wav_buffer, glm::vec3{ std::cos(angle) * reach, 0.0f, std::sin(angle) * reach }, emitter).IsValid();
+        };
+        const auto flush  = [&](float) { audio_thread.Flush(); };
+        const auto sample = [&]
+        {
+            streamer.Update();
+            const AudioThread::Stats stats = audio_thread.GetStats();
+            step.voices_peak               = std::max(step.voices_peak, stats.voices_in_use);
+            step.virtual_peak              = std::max(step.virtual_peak, stats.spatial.virtualized);
+            step.steals_peak               = std::max(step.steals_peak, stats.steals_per_second);
+        };
+        const double took = drive(step, seconds, play, flush, sample);
+
+        step.audio_load = audio_thread.GetStats().busy_ms / (took * 1000.0);
+        step.underruns  = underruns_of(music) - underruns_before;
+        audio_thread.Stop();
+        spatial.Shutdown(voices);
+        voices.Shutdown();
+        return step;
+    }
+
+    // false when no SDL audio device opens for it
+    bool run_mixer(int per_second, double seconds, const Sounds& sounds, AudioStreamer& streamer, const AudioStream* music, audio_benchmark::Step& out_step)
+    {
+        SoftwareMixer mixer{ SoftwareMixer::DEFAULT_FREQUENCY, SoftwareMixer::MAX_VOICES };
+        if (!mixer.Open())
+            return false;
+        const SoftwareMixer::BufferId buffers[] = { mixer.AddBuffer(sounds.wav), mixer.AddBuffer(sounds.ogg) };
+
+        audio_benchmark::Step step;
+        step.backend    = audio_benchmark::Backend::Mixer;
+        step.per_second = per_second;
+        VoiceParams params;
+        params.gain                          = one_shot_gain(per_second);
+        const std::uint64_t underruns_before = underruns_of(music);
+        const auto          play             = [&](int i) { return mixer.Play(buffers[i % 2], params).IsValid(); };
+        const auto          flush            = [&](float delta_seconds) { mixer.Update(delta_seconds); };
+        const auto          sample           = [&]
+        {
+            streamer.Update();
+            const SoftwareMixer::Stats stats = mixer.GetStats();
+            step.voices_peak                 = std::max(step.voices_peak, stats.voices_in_use);
+            step.steals_peak                 = std::max(step.steals_peak, stats.steals_per_second);
+        };
+        const double took = drive(step, seconds, play, flush, sample);
+
+        const SoftwareMixer::Stats stats = mixer.GetStats();
+        step.audio_load    = stats.busy_ms / (took * 1000.0);
+        step.late_callback = stats.late;
+        step.underruns     = underruns_of(music) - underruns_before;
+        mixer.Close();
+        out_step = step;
+        return true;
+    }
+}
+
+namespace audio_benchmark
+{
+    Result Run(WorkerPool& workers, std::span<const int> rates, double step_seconds)
+    {
+        Result result;
+        result.step_seconds = step_seconds;
+        // the device first, so the sounds decode into formats its context takes
+        AudioDevice device;
+        device.Open(workers);
+        result.has_openal = device.Wait();
+
+        Sounds            sounds;
+        constexpr AssetId wav_id = "audio/duck-quacking-loudly-three-times.wav"_asset;
+        constexpr AssetId ogg_id = "audio/duck_vocalizations.ogg"_asset;
+        if (!DecodeSoundFile(wav_id.Path(), sounds.wav) || !DecodeSoundFile(ogg_id.Path(), sounds.ogg))
+        {
+            LOG_WARN("Audio benchmark: can't decode the duck sounds: ", sounds.wav.error, sounds.ogg.error);
+            device.Close();
+            return result;
+        }
+
+        AudioStreamer                streamer;
+        std::shared_ptr<AudioStream> music;
+        if (result.has_openal)
+        {
+            alGenBuffers(1, &sounds.wav_buffer);
+            alGenBuffers(1, &sounds.ogg_buffer);
+            UploadSound(sounds.wav, sounds.wav_buffer);
+            UploadSound(sounds.ogg, sounds.ogg_buffer);
+            music = streamer.Open(ogg_id.Path());
+            if (music != nullptr)
+            {
+                music->SetLooping(true);
+                music->SetGain(0.25f);
+                music->Play();
+            }
+            for (const Backend backend : { Backend::VoicePool, Backend::VirtualVoices })
+            {
+                if (backend == Backend::VirtualVoices && sounds.wav.channels != 1)
+                    continue;
+                for (const int per_second : rates)
+                    result.steps.push_back(run_openal(backend, per_second, step_seconds, sounds, streamer, music.get()));
+            }
+        }
+
+        result.has_mixer = true;
+        for (const int per_second : rates)
+        {
+            Step step;
+            if (!run_mixer(per_second, step_seconds, sounds, streamer, music.get(), step))
+            {
+                result.has_mixer = false;
+                break;
+            }
+            result.steps.push_back(step);
+        }
+
+        if (music != nullptr)
+            streamer.Close(music);
+        music.reset();
+        streamer.Shutdown();
+        if (sounds.wav_buffer != 0)
+            alDeleteBuffers(1, &sounds.wav_buffer);
+        if (sounds.ogg_buffer != 0)
+            alDeleteBuffers(1, &sounds.ogg_buffer);
+        device.Close();
+        return result;
+    }
+
+    void Print(std::ostream& out, const Result& result)
+    {
+        out << "Audio one-shots, " << result.step_seconds << " s a rate, the duck WAV and OGG\n";
+        if (!result.has_openal)
+            out << "  OpenAL: no device\n";
+        if (!result.has_mixer)
+            out << "  mixer: no SDL audio device\n";
+        for (const Step& step : result.steps)
+        {
+            out << "  " << BackendName(step.backend) << " at " << step.per_second << "/s: " << step.play_us << " us a request, " << step.audio_load * 100.0 << "% audio thread, "
+                << step.voices_peak << " voices";
+            if (step.backend == Backend::VirtualVoices)
+                out << " + " << step.virtual_peak << " virtual";
+            out << ", " << step.steals_peak << " steals/s, " << step.dropped << " of " << step.requests << " dropped, " << step.underruns << " underruns";
+            if (step.backend == Backend::Mixer)
+                out << ", " << step.late_callback << " late callbacks";
+            out << '\n';
+        }
+    }
+
+    const char* BackendName(Backend backend) noexcept
+    {
+        switch (backend)
+        {
+            case Backend::VoicePool: return "voice pool";
+            case Backend::VirtualVoices: return "virtual voices";
+            case Backend::Mixer: return "software mixer";
+        }
+        return "?";
+    }
+}
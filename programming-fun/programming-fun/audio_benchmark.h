@@ -0,0 +1,71 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+class WorkerPool;
+
+/**
+ * How many one-shots each audio path keeps up with, for picking AudioSettings::backend per platform.
+ *
+ * Every backend gets the same escalating rates of one-shots, STEP_SECONDS of real time at each, from the main
+ * thread at about 60 updates a second the way the game sends them:
+ *  - VoicePool: the duck WAV and the duck OGG (decoded whole) in turn, through AudioThread onto OpenAL sources
+ *  - VirtualVoices: the WAV as one-shot SpatialAudio emitters scattered round the listener, the loudest voiced
+ *  - Mixer: both sounds in turn on a SoftwareMixer and its own SDL device
+ * Each step starts from fresh voices, so what the last one left playing doesn't count against the next. It
+ * reports what a request costs the main thread, the sends included, and how busy the thread doing the work
+ * was: AudioThread's drains for the first two, the mixer's callbacks for the last. OpenAL's own mixing thread
+ * is out of sight; what it can't keep up with shows as underruns of the duck OGG streaming underneath as music
+ * the whole run. A mixer callback that took longer than the audio it made counts as late. Runs with
+ * "--benchmark-audio" before any window opens; without an OpenAL device only the mixer is timed.
+ */
+namespace audio_benchmark
+{
+    constexpr double STEP_SECONDS    = 2.0;
+    constexpr int    DEFAULT_RATES[] = { 100, 300, 1'000, 3'000, 10'000 }; // one-shots a second
+
+    enum class Backend : std::uint8_t
+    {
+        VoicePool,
+        VirtualVoices,
+        Mixer
+    };
+
+    struct Step
+    {
+        Backend       backend       = Backend::VoicePool;
+        int           per_second    = 0;
+        int           requests      = 0;   // made over the step
+        int           dropped       = 0;   // refused: a full queue, or nothing quieter to steal
+        double        play_us       = 0.0; // main thread, a request
+        double        audio_load    = 0.0; // the working thread's busy time over the step's, 1 is all of it
+        int           voices_peak   = 0;   // real voices playing at once
+        int           virtual_peak  = 0;   // emitters alive without a voice
+        int           steals_peak   = 0;   // a second
+        std::uint64_t underruns     = 0;   // of the music stream
+        std::uint64_t late_callback = 0;   // mixer callbacks past their period
+    };
+
+    struct Result
+    {
+        bool              has_openal   = false;
+        bool              has_mixer    = false;
+        double            step_seconds = 0.0;
+        std::vector<Step> steps;
+    };
+
+    // Opens the audio device on `workers` and closes it again before returning
+    Result      Run(WorkerPool& workers, std::span<const int> rates = DEFAULT_RATES, double step_seconds = STEP_SECONDS);
+    void        Print(std::ostream& out, const Result& result);
+    const char* BackendName(Backend backend) noexcept;
+}
@@ -0,0 +1,485 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "audio_device.h"
+
+#include "logger.h"
+#include "profiler.h"
+#include "sound_loader.h"
+#include "startup_trace.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <imgui.h>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    // from OpenAL Soft's alext.h, which external/include doesn't carry
+    constexpr ALCenum DEVICE_LATENCY_SOFT = 0x1600;
+    constexpr ALCenum CONNECTED           = 0x313; // ALC_EXT_disconnect
+    using ResetDeviceFn                   = ALCboolean(ALC_APIENTRY*)(ALCdevice* device, const ALCint* attributes);
+    using GetInteger64Fn                  = void(ALC_APIENTRY*)(ALCdevice* device, ALCenum name, ALCsizei size, std::int64_t* values);
+    using ReopenDeviceFn                  = ALCboolean(ALC_APIENTRY*)(ALCdevice* device, const ALCchar* name, const ALCint* attributes);
+    using PauseDeviceFn                   = void(ALC_APIENTRY*)(ALCdevice* device);
+
+    // with no output at all every attempt fails, so they are spaced out
+    constexpr auto REOPEN_RETRY = std::chrono::seconds{ 1 };
+
+    // OpenAL Soft's own default, to turn a period into a refresh when no frequency was asked for
+    constexpr int DEFAULT_FREQUENCY = 48'000;
+
+    std::vector<ALCint> make_attributes(const AudioMixSettings& mix)
+    {
+        std::vector<ALCint> attributes;
+        const auto          add = [&attributes](ALCint name, int value)
+        {
+            if (value <= 0)
+                return;
+            attributes.push_back(name);
+            attributes.push_back(value);
+        };
+        const int frequency = mix.frequency > 0 ? mix.frequency : DEFAULT_FREQUENCY;
+        add(ALC_FREQUENCY, mix.frequency);
+        add(ALC_REFRESH, mix.period_frames > 0 ? std::max(1, frequency / mix.period_frames) : mix.refresh);
+        add(ALC_MONO_SOURCES, mix.mono_sources);
+        add(ALC_STEREO_SOURCES, mix.stereo_sources);
+        attributes.push_back(0);
+        return attributes;
+    }
+
+    /**
+     * OpenAL32.dll is delay-loaded (see the vcxproj), so the loader no longer maps it, runs its DllMain and lets the
+     * router enumerate its drivers before main. This maps it on the worker opening the device instead, and turns a
+     * missing DLL into a failed open rather than the delay-load exception the first AL call would raise. It stays
+     * loaded for good: the delay-load thunks point into it from then on.
+     */
+    bool load_openal()
+    {
+#ifdef _WIN32
+        static const bool is_loaded = []
+        {
+            const startup_trace::Scope trace{ "Load OpenAL32.dll" };
+            return SDL_LoadObject("OpenAL32.dll") != nullptr;
+        }();
+        return is_loaded;
+#else
+        return true;
+#endif
+    }
+
+    bool parse_count(std::string_view text, int& out_value)
+    {
+        int value = 0;
+        if (const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value); error != std::errc{} || end != text.data() + text.size() || value < 0)
+            return false;
+        out_value = value;
+        return true;
+    }
+}
+
+AudioDevice::~AudioDevice()
+{
+    Close();
+}
+
+void AudioDevice::Open(WorkerPool& new_workers, const AudioMixSettings& mix)
+{
+    if (workers != nullptr)
+        return;
+    workers   = &new_workers;
+    requested = mix;
+    workers->Submit(
+        [this]
+        {
+            if (!load_openal())
+            {
+                LOG_WARN("Failed to load OpenAL: ", SDL_GetError());
+                return;
+            }
+            const startup_trace::Scope trace{ "alcOpenDevice" };
+            device = alcOpenDevice(nullptr);
+        },
+        &opened);
+}
+
+bool AudioDevice::Poll()
+{
+    if (context != nullptr)
+        return true;
+    if (workers == nullptr || failed || !opened.IsDone())
+        return false;
+    return makeCurrent();
+}
+
+bool AudioDevice::Wait()
+{
+    if (context != nullptr)
+        return true;
+    if (workers == nullptr || failed)
+        return false;
+    {
+        const startup_trace::Scope trace{ "Wait for audio device" };
+        workers->Wait(opened);
+    }
+    return makeCurrent();
+}
+
+void AudioDevice::Close()
+{
+    // the jobs use `device`, so they have to be finished before anything here goes away
+    if (workers != nullptr)
+    {
+        workers->Wait(opened);
+        workers->Wait(reopened);
+    }
+    if (context != nullptr)
+    {
+        alcMakeContextCurrent(nullptr);
+        alcDestroyContext(context);
+    }
+    if (device != nullptr)
+        alcCloseDevice(device);
+    workers   = nullptr;
+    device    = nullptr;
+    context   = nullptr;
+    info      = {};
+    failed    = false;
+    lost      = false;
+    reopening = false;
+    paused    = false;
+}
+
+bool AudioDevice::IsRequested() const noexcept
+{
+    return workers != nullptr;
+}
+
+bool AudioDevice::IsCurrent() const noexcept
+{
+    return context != nullptr;
+}
+
+bool AudioDevice::HasFailed() const noexcept
+{
+    return failed;
+}
+
+bool AudioDevice::Reconfigure(const AudioMixSettings& mix)
+{
+    requested = mix;
+    if (context == nullptr)
+        return true;
+    if (!CanReconfigure())
+    {
+        LOG_WARN("alcResetDeviceSOFT is unavailable, the new audio settings wait for the next start");
+        return false;
+    }
+    const auto reset = reinterpret_cast<ResetDeviceFn>(alcGetProcAddress(device, "alcResetDeviceSOFT"));
+    if (reset == nullptr || reset(device, make_attributes(requested).data()) != ALC_TRUE)
+    {
+        LOG_ERROR("Failed to reset the audio device: ", alcGetString(device, alcGetError(device)));
+        return false;
+    }
+    readInfo();
+    return true;
+}
+
+bool AudioDevice::CanReconfigure() const noexcept
+{
+    return context != nullptr && alcIsExtensionPresent(device, "ALC_SOFT_HRTF") == ALC_TRUE;
+}
+
+const AudioDeviceInfo& AudioDevice::Info() const noexcept
+{
+    return info;
+}
+
+double AudioDevice::OutputLatencyMs() const
+{
+    if (context == nullptr || alcIsExtensionPresent(device, "ALC_SOFT_device_clock") != ALC_TRUE)
+        return -1.0;
+    const auto get_integer64 = reinterpret_cast<GetInteger64Fn>(alcGetProcAddress(device, "alcGetInteger64vSOFT"));
+    if (get_integer64 == nullptr)
+        return -1.0;
+    std::int64_t nanoseconds = -1;
+    get_integer64(device, DEVICE_LATENCY_SOFT, 1, &nanoseconds);
+    return nanoseconds < 0 ? -1.0 : static_cast<double>(nanoseconds) / 1'000'000.0;
+}
+
+bool AudioDevice::IsConnected() const
+{
+    if (context == nullptr || alcIsExtensionPresent(device, "ALC_EXT_disconnect") != ALC_TRUE)
+        return true;
+    ALCint connected = ALC_TRUE;
+    alcGetIntegerv(device, CONNECTED, 1, &connected);
+    return connected != ALC_FALSE;
+}
+
+void AudioDevice::Update()
+{
+    if (context == nullptr)
+        return;
+    if (reopening)
+    {
+        if (!reopened.IsDone())
+            return;
+        reopening = false;
+        if (reopen_succeeded.load())
+        {
+            lost = false;
+            ++reconnects;
+            readInfo();
+            std::cout << "Audio device reopened: " << alcGetString(device, ALC_DEVICE_SPECIFIER) << '\n';
+            return;
+        }
+        next_reopen = std::chrono::steady_clock::now() + REOPEN_RETRY;
+        return;
+    }
+    if (!lost)
+    {
+        if (IsConnected())
+            return;
+        lost = true;
+        if (alcIsExtensionPresent(device, "ALC_SOFT_reopen_device") != ALC_TRUE)
+        {
+            LOG_WARN("The audio device was disconnected and alcReopenDeviceSOFT is unavailable, sound is off until the next start");
+            return;
+        }
+        LOG_WARN("The audio device was disconnected, reopening the default one");
+        next_reopen = {};
+    }
+    if (std::chrono::steady_clock::now() >= next_reopen && alcIsExtensionPresent(device, "ALC_SOFT_reopen_device") == ALC_TRUE)
+        startReopen();
+}
+
+bool AudioDevice::IsLost() const noexcept
+{
+    return lost;
+}
+
+bool AudioDevice::IsReopening() const noexcept
+{
+    return reopening;
+}
+
+int AudioDevice::ReconnectCount() const noexcept
+{
+    return reconnects;
+}
+
+bool AudioDevice::SetPaused(bool pause)
+{
+    if (context == nullptr || alcIsExtensionPresent(device, "ALC_SOFT_pause_device") != ALC_TRUE)
+        return false;
+    if (pause == paused)
+        return true;
+    const auto toggle = reinterpret_cast<PauseDeviceFn>(alcGetProcAddress(device, pause ? "alcDevicePauseSOFT" : "alcDeviceResumeSOFT"));
+    if (toggle == nullptr)
+        return false;
+    toggle(device);
+    paused = pause;
+    return true;
+}
+
+bool AudioDevice::IsPaused() const noexcept
+{
+    return paused;
+}
+
+bool AudioDevice::DrawImGui(AudioMixSettings& mix) const
+{
+    static constexpr int         FREQUENCIES[]     = { 0, 22'050, 32'000, 44'100, 48'000, 96'000 };
+    static constexpr const char* FREQUENCY_NAMES[] = { "driver's choice", "22050 Hz", "32000 Hz", "44100 Hz", "48000 Hz", "96000 Hz" };
+
+    if (context == nullptr)
+    {
+        ImGui::Text("audio device: %s", failed ? "none" : "not open yet");
+    }
+    else
+    {
+        const double period_ms = info.refresh > 0 ? 1000.0 / info.refresh : 0.0;
+        ImGui::Text("audio: %d Hz, %d updates/s (%.1f ms periods), %d mono + %d stereo sources", info.frequency, info.refresh, period_ms, info.mono_sources, info.stereo_sources);
+        if (const double latency = OutputLatencyMs(); latency >= 0.0)
+            ImGui::Text("output latency = %.1f ms", latency);
+    }
+
+    const auto frequency = std::find(std::begin(FREQUENCIES), std::end(FREQUENCIES), mix.frequency);
+    int        selected  = frequency == std::end(FREQUENCIES) ? 0 : static_cast<int>(frequency - std::begin(FREQUENCIES));
+    if (ImGui::Combo("mix frequency", &selected, FREQUENCY_NAMES, IM_ARRAYSIZE(FREQUENCY_NAMES)))
+        mix.frequency = FREQUENCIES[selected];
+    ImGui::SliderInt("period frames (0 = refresh)", &mix.period_frames, 0, 4096, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+    ImGui::BeginDisabled(mix.period_frames > 0);
+    ImGui::SliderInt("refresh hz (0 = driver)", &mix.refresh, 0, 1000, "%d", ImGuiSliderFlags_AlwaysClamp);
+    ImGui::EndDisabled();
+    ImGui::SliderInt("mono sources (0 = driver)", &mix.mono_sources, 0, 1024, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderInt("stereo sources (0 = driver)", &mix.stereo_sources, 0, 64, "%d", ImGuiSliderFlags_AlwaysClamp);
+
+    ImGui::BeginDisabled(mix == requested);
+    const bool apply = ImGui::Button(context == nullptr || CanReconfigure() ? "apply audio settings" : "apply on next start");
+    ImGui::EndDisabled();
+    return apply;
+}
+
+bool AudioDevice::Parse(std::string_view text, AudioSettings& out_settings)
+{
+    if (text == "eager")
+        out_settings.startup = AudioStartup::Eager;
+    else if (text == "lazy")
+        out_settings.startup = AudioStartup::Lazy;
+    else if (text == "prewarm")
+        out_settings.startup = AudioStartup::Prewarm;
+    else
+        return false;
+    return true;
+}
+
+bool AudioDevice::ParseMix(std::string_view text, AudioMixSettings& out_mix)
+{
+    AudioMixSettings mix;
+    if (text == "default")
+    {
+        out_mix = mix;
+        return true;
+    }
+    while (!text.empty())
+    {
+        const std::size_t      comma = text.find(',');
+        const std::string_view item  = text.substr(0, comma);
+        text                         = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+        const std::size_t equals = item.find('=');
+        if (equals == std::string_view::npos)
+            return false;
+        const std::string_view name  = item.substr(0, equals);
+        const std::string_view value = item.substr(equals + 1);
+        int*                   field = nullptr;
+        if (name == "frequency")
+            field = &mix.frequency;
+        else if (name == "refresh")
+            field = &mix.refresh;
+        else if (name == "period")
+            field = &mix.period_frames;
+        else if (name == "mono")
+            field = &mix.mono_sources;
+        else if (name == "stereo")
+            field = &mix.stereo_sources;
+        if (field == nullptr || !parse_count(value, *field))
+            return false;
+    }
+    out_mix = mix;
+    return true;
+}
+
+bool AudioDevice::ParseBackend(std::string_view text, AudioBackend& out_backend)
+{
+    if (text == "openal")
+        out_backend = AudioBackend::OpenAL;
+    else if (text == "mixer")
+        out_backend = AudioBackend::Mixer;
+    else
+        return false;
+    return true;
+}
+
+std::string AudioDevice::Format(const AudioSettings& settings)
+{
+    switch (settings.startup)
+    {
+        case AudioStartup::Eager: return "eager";
+        case AudioStartup::Lazy: return "lazy";
+        case AudioStartup::Prewarm: return "prewarm";
+    }
+    return "eager";
+}
+
+std::string AudioDevice::FormatBackend(AudioBackend backend)
+{
+    return backend == AudioBackend::Mixer ? "mixer" : "openal";
+}
+
+std::string AudioDevice::FormatMix(const AudioMixSettings& mix)
+{
+    std::string text;
+    const auto  add = [&text](const char* name, int value)
+    {
+        if (value == 0)
+            return;
+        text += (text.empty() ? "" : ",") + std::string{ name } + "=" + std::to_string(value);
+    };
+    add("frequency", mix.frequency);
+    add("refresh", mix.refresh);
+    add("period", mix.period_frames);
+    add("mono", mix.mono_sources);
+    add("stereo", mix.stereo_sources);
+    return text.empty() ? "default" : text;
+}
+
+bool AudioDevice::makeCurrent()
+{
+    const startup_trace::Scope trace{ "alcCreateContext" };
+    if (device == nullptr)
+    {
+        LOG_WARN("Failed to open an audio device, running without sound");
+        failed = true;
+        return false;
+    }
+    ALCcontext* created = alcCreateContext(device, make_attributes(requested).data());
+    if (created != nullptr && alcMakeContextCurrent(created) == ALC_TRUE)
+    {
+        context = created;
+        DetectAudioFormats();
+        readInfo();
+        return true;
+    }
+    if (created != nullptr)
+        alcDestroyContext(created);
+    LOG_WARN("Failed to create an OpenAL context, running without sound");
+    failed = true;
+    return false;
+}
+
+void AudioDevice::startReopen()
+{
+    const auto reopen = reinterpret_cast<ReopenDeviceFn>(alcGetProcAddress(device, "alcReopenDeviceSOFT"));
+    if (reopen == nullptr)
+        return;
+    reopening = true;
+    // the mixer keeps running on the old backend until the new one is up, so nothing on this thread waits
+    workers->Submit(
+        [this, reopen, attributes = make_attributes(requested)]
+        {
+            PROFILE_TRACE_ZONE("alcReopenDeviceSOFT");
+            reopen_succeeded.store(reopen(device, nullptr, attributes.data()) == ALC_TRUE);
+        },
+        &reopened);
+}
+
+void AudioDevice::readInfo()
+{
+    ALCint size = 0;
+    alcGetIntegerv(device, ALC_ATTRIBUTES_SIZE, 1, &size);
+    if (size <= 0)
+        return;
+    std::vector<ALCint> attributes(static_cast<std::size_t>(size));
+    alcGetIntegerv(device, ALC_ALL_ATTRIBUTES, size, attributes.data());
+    info = {};
+    for (std::size_t i = 0; i + 1 < attributes.size() && attributes[i] != 0; i += 2)
+    {
+        switch (attributes[i])
+        {
+            case ALC_FREQUENCY: info.frequency = attributes[i + 1]; break;
+            case ALC_REFRESH: info.refresh = attributes[i + 1]; break;
+            case ALC_MONO_SOURCES: info.mono_sources = attributes[i + 1]; break;
+            case ALC_STEREO_SOURCES: info.stereo_sources = attributes[i + 1]; break;
+            default: break;
+        }
+    }
+}
@@ -0,0 +1,163 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "sound_cache.h"
+#include "worker_pool.h"
+
+#include <alc.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+enum class AudioStartup
+{
+    Eager,  // open the device and decode the sounds during startup
+    Lazy,   // nothing until something asks to play
+    Prewarm // like Lazy, but start in the background once the first frame is up
+};
+
+// What mixes the grain stress: OpenAL's sources through AudioThread, or SoftwareMixer on an SDL device of its own
+enum class AudioBackend
+{
+    OpenAL,
+    Mixer
+};
+
+// Context attributes; 0 leaves each one to the driver, which often picks 20+ ms worth of mixing
+struct AudioMixSettings
+{
+    int frequency      = 0; // ALC_FREQUENCY, Hz
+    int refresh        = 0; // ALC_REFRESH, mixer updates per second
+    int period_frames  = 0; // OpenAL Soft mixes a period of frequency / refresh frames; when set, this picks the refresh
+    int mono_sources   = 0; // ALC_MONO_SOURCES
+    int stereo_sources = 0; // ALC_STEREO_SOURCES
+
+    bool operator==(const AudioMixSettings&) const = default;
+};
+
+struct AudioSettings
+{
+    AudioStartup     startup = AudioStartup::Eager;
+    AudioMixSettings mix;
+    SoundStorage     sound_storage = SoundStorage::Pcm; // for the app's sound cache
+    AudioBackend     backend       = AudioBackend::OpenAL;
+
+    bool operator==(const AudioSettings&) const = default;
+};
+
+// What the driver actually gave us, read back from ALC_ALL_ATTRIBUTES
+struct AudioDeviceInfo
+{
+    int frequency      = 0;
+    int refresh        = 0;
+    int mono_sources   = 0;
+    int stereo_sources = 0;
+};
+
+/**
+ * The OpenAL device and its context.
+ *
+ * alcOpenDevice can take hundreds of milliseconds on some Windows audio stacks and touches nothing
+ * else, so Open only queues it on a worker. Poll picks the result up without blocking and Wait blocks
+ * for it; whichever sees it first creates the context and makes it current, on the main thread.
+ * On Windows the OpenAL DLL is delay-loaded and that same job maps it, so a session that never asks
+ * for audio never loads it. Nothing that calls AL should run before IsCurrent; before Open, the call
+ * would load the DLL on its own thread.
+ *
+ * A device that goes away, a headset unplugged say, is reopened the same way: Update notices through
+ * ALC_EXT_disconnect and queues alcReopenDeviceSOFT (ALC_SOFT_reopen_device) on a worker, which moves the
+ * same ALCdevice to whatever the default output is now. The context and every buffer, source and effect
+ * slot survive that; sources the disconnect stopped stay stopped, so their owners restart what should
+ * still be playing. Without the extension a lost device stays silent until the next start.
+ */
+class AudioDevice
+{
+public:
+    AudioDevice() = default;
+    ~AudioDevice();
+
+    AudioDevice(const AudioDevice&)                = delete;
+    AudioDevice& operator=(const AudioDevice&)     = delete;
+    AudioDevice(AudioDevice&&) noexcept            = delete;
+    AudioDevice& operator=(AudioDevice&&) noexcept = delete;
+
+    // Starts opening the default device on `workers`, which must outlive this; later calls do nothing
+    void Open(WorkerPool& workers, const AudioMixSettings& mix = {});
+    // True once the context is current; never blocks
+    bool Poll();
+    // Like Poll, but blocks until the open finished
+    bool Wait();
+    void Close();
+
+    bool IsRequested() const noexcept;
+    bool IsCurrent() const noexcept;
+    // Opened and found no usable device
+    bool HasFailed() const noexcept;
+
+    /**
+     * Applies new context attributes. A live context is kept, sources and buffers included, through
+     * OpenAL Soft's alcResetDeviceSOFT; without that extension they wait for the next Open.
+     */
+    bool Reconfigure(const AudioMixSettings& mix);
+    bool CanReconfigure() const noexcept;
+    const AudioDeviceInfo& Info() const noexcept;
+    // Mixer to speaker, as the driver reports it (ALC_SOFT_device_clock); negative when it can't say
+    double OutputLatencyMs() const;
+    // False once the device is gone, unplugged say (ALC_EXT_disconnect); true while it can't tell
+    bool   IsConnected() const;
+
+    // Once a frame: notices a lost device and picks up the reopen when a worker has finished it; never blocks
+    void Update();
+    // Disconnected and not reopened yet; nothing plays meanwhile
+    bool IsLost() const noexcept;
+    bool IsReopening() const noexcept;
+    int  ReconnectCount() const noexcept;
+
+    // Stops the mixer, sources and all, and starts it again where it was (ALC_SOFT_pause_device); on the web
+    // that suspends the page's AudioContext. False when the device can't, and it keeps playing
+    bool SetPaused(bool pause);
+    bool IsPaused() const noexcept;
+
+    // Edits `mix` and shows what the device runs at; true when the edits should be applied
+    bool DrawImGui(AudioMixSettings& mix) const;
+
+    // "eager", "lazy" or "prewarm"
+    static bool Parse(std::string_view text, AudioSettings& out_settings);
+    // "default", or any of frequency=, refresh=, period=, mono=, stereo= separated by commas
+    static bool ParseMix(std::string_view text, AudioMixSettings& out_mix);
+    // "openal" or "mixer"
+    static bool ParseBackend(std::string_view text, AudioBackend& out_backend);
+    // What Parse, ParseMix and ParseBackend read back
+    static std::string Format(const AudioSettings& settings);
+    static std::string FormatMix(const AudioMixSettings& mix);
+    static std::string FormatBackend(AudioBackend backend);
+
+private:
+    bool makeCurrent();
+    void readInfo();
+    void startReopen();
+
+private:
+    WorkerPool*      workers = nullptr;
+    JobCounter       opened;
+    ALCdevice*       device  = nullptr; // written by the open job, read once `opened` is done
+    ALCcontext*      context = nullptr;
+    AudioMixSettings requested;
+    AudioDeviceInfo  info;
+    bool             failed  = false;
+
+    JobCounter                            reopened;
+    std::atomic<bool>                     reopen_succeeded{ false }; // written by the reopen job
+    std::chrono::steady_clock::time_point next_reopen;
+    bool                                  lost       = false;
+    bool                                  reopening  = false;
+    int                                   reconnects = 0;
+    bool                                  paused     = false;
+};
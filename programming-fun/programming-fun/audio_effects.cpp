@@ -0,0 +1,234 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "audio_effects.h"
+
+#include "voice_pool.h"
+
+#include <algorithm>
+#include <alc.h>
+#include <efx.h>
+#include <iostream>
+
+namespace
+{
+    // ALC_EXT_EFX has no import library entries, so everything comes through alGetProcAddress
+    struct EfxFunctions
+    {
+        LPALGENEFFECTS                 gen_effects    = nullptr;
+        LPALDELETEEFFECTS              delete_effects = nullptr;
+        LPALEFFECTI                    effect_i       = nullptr;
+        LPALEFFECTF                    effect_f       = nullptr;
+        LPALEFFECTFV                   effect_fv      = nullptr;
+        LPALGENAUXILIARYEFFECTSLOTS    gen_slots      = nullptr;
+        LPALDELETEAUXILIARYEFFECTSLOTS delete_slots   = nullptr;
+        LPALAUXILIARYEFFECTSLOTI       slot_i         = nullptr;
+    };
+
+    EfxFunctions efx;
+
+    template <typename Function>
+    bool load_function(Function& out_function, const char* name)
+    {
+        out_function = reinterpret_cast<Function>(alGetProcAddress(name));
+        return out_function != nullptr;
+    }
+
+    bool load_functions()
+    {
+        return load_function(efx.gen_effects, "alGenEffects") && load_function(efx.delete_effects, "alDeleteEffects") && load_function(efx.effect_i, "alEffecti") &&
+               load_function(efx.effect_f, "alEffectf") && load_function(efx.effect_fv, "alEffectfv") && load_function(efx.gen_slots, "alGenAuxiliaryEffectSlots") &&
+               load_function(efx.delete_slots, "alDeleteAuxiliaryEffectSlots") && load_function(efx.slot_i, "alAuxiliaryEffectSloti");
+    }
+
+    // the order efx-presets.h lists them in, as OpenAL Soft's reverb example loads them
+    void set_eax_reverb(ALuint effect, const EFXEAXREVERBPROPERTIES& reverb)
+    {
+        efx.effect_f(effect, AL_EAXREVERB_DENSITY, reverb.flDensity);
+        efx.effect_f(effect, AL_EAXREVERB_DIFFUSION, reverb.flDiffusion);
+        efx.effect_f(effect, AL_EAXREVERB_GAIN, reverb.flGain);
+        efx.effect_f(effect, AL_EAXREVERB_GAINHF, reverb.flGainHF);
+        efx.effect_f(effect, AL_EAXREVERB_GAINLF, reverb.flGainLF);
+        efx.effect_f(effect, AL_EAXREVERB_DECAY_TIME, reverb.flDecayTime);
+        efx.effect_f(effect, AL_EAXREVERB_DECAY_HFRATIO, reverb.flDecayHFRatio);
+        efx.effect_f(effect, AL_EAXREVERB_DECAY_LFRATIO, reverb.flDecayLFRatio);
+        efx.effect_f(effect, AL_EAXREVERB_REFLECTIONS_GAIN, reverb.flReflectionsGain);
+        efx.effect_f(effect, AL_EAXREVERB_REFLECTIONS_DELAY, reverb.flReflectionsDelay);
+        efx.effect_fv(effect, AL_EAXREVERB_REFLECTIONS_PAN, reverb.flReflectionsPan);
+        efx.effect_f(effect, AL_EAXREVERB_LATE_REVERB_GAIN, reverb.flLateReverbGain);
+        efx.effect_f(effect, AL_EAXREVERB_LATE_REVERB_DELAY, reverb.flLateReverbDelay);
+        efx.effect_fv(effect, AL_EAXREVERB_LATE_REVERB_PAN, reverb.flLateReverbPan);
+        efx.effect_f(effect, AL_EAXREVERB_ECHO_TIME, reverb.flEchoTime);
+        efx.effect_f(effect, AL_EAXREVERB_ECHO_DEPTH, reverb.flEchoDepth);
+        efx.effect_f(effect, AL_EAXREVERB_MODULATION_TIME, reverb.flModulationTime);
+        efx.effect_f(effect, AL_EAXREVERB_MODULATION_DEPTH, reverb.flModulationDepth);
+        efx.effect_f(effect, AL_EAXREVERB_AIR_ABSORPTION_GAINHF, reverb.flAirAbsorptionGainHF);
+        efx.effect_f(effect, AL_EAXREVERB_HFREFERENCE, reverb.flHFReference);
+        efx.effect_f(effect, AL_EAXREVERB_LFREFERENCE, reverb.flLFReference);
+        efx.effect_f(effect, AL_EAXREVERB_ROOM_ROLLOFF_FACTOR, reverb.flRoomRolloffFactor);
+        efx.effect_i(effect, AL_EAXREVERB_DECAY_HFLIMIT, reverb.iDecayHFLimit);
+    }
+
+    // the standard reverb has no LF, pan, echo or modulation controls and drops them
+    void set_standard_reverb(ALuint effect, const EFXEAXREVERBPROPERTIES& reverb)
+    {
+        efx.effect_f(effect, AL_REVERB_DENSITY, reverb.flDensity);
+        efx.effect_f(effect, AL_REVERB_DIFFUSION, reverb.flDiffusion);
+        efx.effect_f(effect, AL_REVERB_GAIN, reverb.flGain);
+        efx.effect_f(effect, AL_REVERB_GAINHF, reverb.flGainHF);
+        efx.effect_f(effect, AL_REVERB_DECAY_TIME, reverb.flDecayTime);
+        efx.effect_f(effect, AL_REVERB_DECAY_HFRATIO, reverb.flDecayHFRatio);
+        efx.effect_f(effect, AL_REVERB_REFLECTIONS_GAIN, reverb.flReflectionsGain);
+        efx.effect_f(effect, AL_REVERB_REFLECTIONS_DELAY, reverb.flReflectionsDelay);
+        efx.effect_f(effect, AL_REVERB_LATE_REVERB_GAIN, reverb.flLateReverbGain);
+        efx.effect_f(effect, AL_REVERB_LATE_REVERB_DELAY, reverb.flLateReverbDelay);
+        efx.effect_f(effect, AL_REVERB_AIR_ABSORPTION_GAINHF, reverb.flAirAbsorptionGainHF);
+        efx.effect_f(effect, AL_REVERB_ROOM_ROLLOFF_FACTOR, reverb.flRoomRolloffFactor);
+        efx.effect_i(effect, AL_REVERB_DECAY_HFLIMIT, reverb.iDecayHFLimit);
+    }
+}
+
+AudioEffects::~AudioEffects()
+{
+    Shutdown();
+}
+
+void AudioEffects::Setup(int max_slots)
+{
+    Shutdown();
+    ALCcontext* context = alcGetCurrentContext();
+    ALCdevice*  device  = context != nullptr ? alcGetContextsDevice(context) : nullptr;
+    ALCint      sends   = 0;
+    if (device != nullptr && alcIsExtensionPresent(device, ALC_EXT_EFX_NAME) == ALC_TRUE)
+        alcGetIntegerv(device, ALC_MAX_AUXILIARY_SENDS, 1, &sends);
+    if (sends < 1 || !load_functions())
+    {
+        std::cout << "Audio effects: no EFX, reverb zones play dry\n";
+        return;
+    }
+
+    // like the voices, stop at the first slot the implementation refuses
+    alGetError();
+    max_slots = std::clamp(max_slots, 1, MAX_SLOTS);
+    slots.reserve(static_cast<std::size_t>(max_slots));
+    for (int i = 0; i < max_slots; ++i)
+    {
+        Slot slot;
+        efx.gen_slots(1, &slot.slot);
+        if (alGetError() != AL_NO_ERROR)
+            break;
+        efx.gen_effects(1, &slot.effect);
+        if (alGetError() != AL_NO_ERROR)
+        {
+            efx.delete_slots(1, &slot.slot);
+            break;
+        }
+        slots.push_back(slot);
+    }
+    if (slots.empty())
+    {
+        std::cout << "Audio effects: no effect slots, reverb zones play dry\n";
+        return;
+    }
+    efx.effect_i(slots.front().effect, AL_EFFECT_TYPE, AL_EFFECT_EAXREVERB);
+    eax_reverb = alGetError() == AL_NO_ERROR;
+    for (const Slot& slot : slots)
+        efx.effect_i(slot.effect, AL_EFFECT_TYPE, eax_reverb ? AL_EFFECT_EAXREVERB : AL_EFFECT_REVERB);
+    stats       = {};
+    stats.slots = static_cast<int>(slots.size());
+    std::cout << "Audio effects: " << slots.size() << " reverb slot(s)" << (eax_reverb ? "" : " without EAX reverb") << '\n';
+}
+
+void AudioEffects::Shutdown()
+{
+    for (const Slot& slot : slots)
+    {
+        efx.slot_i(slot.slot, AL_EFFECTSLOT_EFFECT, AL_EFFECT_NULL);
+        efx.delete_slots(1, &slot.slot);
+        efx.delete_effects(1, &slot.effect);
+    }
+    slots.clear();
+    stats.slots       = 0;
+    stats.bound_slots = 0;
+    eax_reverb        = false;
+}
+
+bool AudioEffects::IsAvailable() const noexcept
+{
+    return !slots.empty();
+}
+
+int AudioEffects::AddZone(std::string name, const EFXEAXREVERBPROPERTIES& reverb)
+{
+    zones.push_back(Zone{ std::move(name), reverb });
+    return static_cast<int>(zones.size()) - 1;
+}
+
+int AudioEffects::ZoneCount() const noexcept
+{
+    return static_cast<int>(zones.size());
+}
+
+const std::string& AudioEffects::ZoneName(int zone) const
+{
+    return zones.at(static_cast<std::size_t>(zone)).name;
+}
+
+ALuint AudioEffects::SlotFor(int zone, const VoicePool& voices)
+{
+    if (zone < 0 || zone >= ZoneCount() || slots.empty())
+        return 0;
+    Slot* chosen = nullptr;
+    for (Slot& slot : slots)
+    {
+        if (slot.zone == zone)
+        {
+            chosen = &slot;
+            break;
+        }
+    }
+    if (chosen == nullptr)
+    {
+        // unbound slots were never used, so they go first
+        for (Slot& slot : slots)
+        {
+            if (voices.SendsTo(slot.slot) > 0)
+                continue;
+            if (chosen == nullptr || slot.last_used < chosen->last_used)
+                chosen = &slot;
+        }
+        if (chosen == nullptr)
+        {
+            ++stats.dry_fallbacks;
+            return 0;
+        }
+        load(*chosen, zone);
+    }
+    chosen->last_used = ++use_clock;
+    return chosen->slot;
+}
+
+const AudioEffects::Stats& AudioEffects::GetStats() const noexcept
+{
+    return stats;
+}
+
+void AudioEffects::load(Slot& slot, int zone)
+{
+    const EFXEAXREVERBPROPERTIES& reverb = zones[static_cast<std::size_t>(zone)].reverb;
+    if (eax_reverb)
+        set_eax_reverb(slot.effect, reverb);
+    else
+        set_standard_reverb(slot.effect, reverb);
+    // the slot copies the effect when it's attached, so new parameters only count once it's attached again
+    efx.slot_i(slot.slot, AL_EFFECTSLOT_EFFECT, static_cast<ALint>(slot.effect));
+    if (slot.zone < 0)
+        ++stats.bound_slots;
+    else
+        ++stats.rebinds;
+    slot.zone = zone;
+}
@@ -0,0 +1,87 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <al.h>
+#include <cstdint>
+#include <efx-presets.h>
+#include <string>
+#include <vector>
+
+class VoicePool;
+
+/**
+ * Reverb zones on a fixed set of auxiliary effect slots (ALC_EXT_EFX).
+ *
+ * Setup creates every slot and its reverb effect once; nothing EFX is created or deleted after that.
+ * A zone is a named efx-presets.h reverb and zones may outnumber slots: SlotFor loads a zone into a
+ * slot when a voice first needs it, reusing the slot that already holds it, else an unbound one, else
+ * the one used longest ago that no voice sends to. With every slot busy the voice plays dry.
+ * Without the extension every zone plays dry. All calls belong to the thread that owns the AL context.
+ */
+class AudioEffects
+{
+public:
+    static constexpr int MAX_SLOTS = 4;
+
+    struct Stats
+    {
+        int           slots         = 0;
+        int           bound_slots   = 0; // holding some zone's reverb
+        std::uint64_t rebinds       = 0; // a slot loaded with another zone's parameters
+        std::uint64_t dry_fallbacks = 0; // asked for a zone while every slot was busy
+    };
+
+    AudioEffects() = default;
+    ~AudioEffects();
+
+    AudioEffects(const AudioEffects&)                = delete;
+    AudioEffects& operator=(const AudioEffects&)     = delete;
+    AudioEffects(AudioEffects&&) noexcept            = delete;
+    AudioEffects& operator=(AudioEffects&&) noexcept = delete;
+
+    // Needs a current AL context; the device may give fewer than `max_slots`
+    void Setup(int max_slots = MAX_SLOTS);
+    // Delete the voices' sources (VoicePool::Shutdown) first, they may still send here
+    void Shutdown();
+    bool IsAvailable() const noexcept;
+
+    // Returns the zone's id; works before Setup and without EFX
+    int                AddZone(std::string name, const EFXEAXREVERBPROPERTIES& reverb);
+    int                ZoneCount() const noexcept;
+    const std::string& ZoneName(int zone) const;
+
+    // The slot for VoiceParams::effect_slot; 0, dry, for no zone or when `voices` sends to every slot
+    ALuint SlotFor(int zone, const VoicePool& voices);
+
+    const Stats& GetStats() const noexcept;
+
+private:
+    struct Zone
+    {
+        std::string            name;
+        EFXEAXREVERBPROPERTIES reverb;
+    };
+
+    struct Slot
+    {
+        ALuint        slot      = 0;
+        ALuint        effect    = 0;
+        int           zone      = -1;
+        std::uint64_t last_used = 0;
+    };
+
+    void load(Slot& slot, int zone);
+
+private:
+    std::vector<Zone> zones;
+    std::vector<Slot> slots;
+    std::uint64_t     use_clock  = 0;
+    bool              eax_reverb = false; // AL_EFFECT_EAXREVERB, else the standard reverb's subset
+    Stats             stats;
+};
@@ -0,0 +1,799 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "audio_kernels.h"
+
+#include "error.h"
+
+#include <SDL_cpuinfo.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    define AUDIO_KERNELS_X86 1
+#    include <immintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#    define AUDIO_KERNELS_NEON 1
+#    include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#    define AUDIO_KERNELS_WASM 1
+#    include <wasm_simd128.h>
+#endif
+
+// MSVC takes any intrinsic in any function; GCC and Clang want the function marked for its instruction set
+#if defined(AUDIO_KERNELS_X86) && defined(__GNUC__)
+#    define AUDIO_KERNELS_TARGET(isa) __attribute__((target(isa)))
+#else
+#    define AUDIO_KERNELS_TARGET(isa)
+#endif
+
+namespace
+{
+    using audio_kernels::Level;
+
+    constexpr float S16_TO_F32 = 1.0f / 32768.0f;
+    constexpr float F32_TO_S16 = 32768.0f;
+    constexpr float S16_MIN    = -32768.0f;
+    constexpr float S16_MAX    = 32767.0f;
+
+    struct Kernels
+    {
+        Level level;
+        void (*s16_to_f32)(const std::int16_t* in, float* out, std::size_t count);
+        void (*f32_to_s16)(const float* in, std::int16_t* out, std::size_t count);
+        void (*apply_gain)(float* samples, std::size_t count, float gain);
+        void (*mix_gain)(const float* in, float* out, std::size_t count, float gain);
+        void (*interleave2)(const float* left, const float* right, std::size_t frames, float* out);
+        void (*deinterleave2)(const float* in, std::size_t frames, float* left, float* right);
+        float (*dot)(const float* a, const float* b, std::size_t count);
+        void (*complex_mac)(const float* a_re, const float* a_im, const float* b_re, const float* b_im, float* out_re, float* out_im, std::size_t count);
+    };
+
+    // the references, and the tails the vector versions leave over
+    namespace scalar
+    {
+        void s16_to_f32(const std::int16_t* in, float* out, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                out[i] = static_cast<float>(in[i]) * S16_TO_F32;
+        }
+
+        void f32_to_s16(const float* in, std::int16_t* out, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                out[i] = static_cast<std::int16_t>(std::lrint(std::clamp(in[i] * F32_TO_S16, S16_MIN, S16_MAX)));
+        }
+
+        void apply_gain(float* samples, std::size_t count, float gain)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                samples[i] *= gain;
+        }
+
+        void mix_gain(const float* in, float* out, std::size_t count, float gain)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                out[i] += in[i] * gain;
+        }
+
+        void interleave2(const float* left, const float* right, std::size_t frames, float* out)
+        {
+            for (std::size_t i = 0; i < frames; ++i)
+            {
+                out[i * 2 + 0] = left[i];
+                out[i * 2 + 1] = right[i];
+            }
+        }
+
+        void deinterleave2(const float* in, std::size_t frames, float* left, float* right)
+        {
+            for (std::size_t i = 0; i < frames; ++i)
+            {
+                left[i]  = in[i * 2 + 0];
+                right[i] = in[i * 2 + 1];
+            }
+        }
+
+        float dot(const float* a, const float* b, std::size_t count)
+        {
+            float sum = 0.0f;
+            for (std::size_t i = 0; i < count; ++i)
+                sum += a[i] * b[i];
+            return sum;
+        }
+
+        void complex_mac(const float* a_re, const float* a_im, const float* b_re, const float* b_im, float* out_re, float* out_im, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out_re[i] += a_re[i] * b_re[i] - a_im[i] * b_im[i];
+                out_im[i] += a_re[i] * b_im[i] + a_im[i] * b_re[i];
+            }
+        }
+
+        constexpr Kernels KERNELS{ Level::Scalar, s16_to_f32, f32_to_s16, apply_gain, mix_gain, interleave2, deinterleave2, dot, complex_mac };
+    }
+
+#if defined(AUDIO_KERNELS_X86)
+    namespace sse2
+    {
+        AUDIO_KERNELS_TARGET("sse2") float horizontal_sum(__m128 v)
+        {
+            const __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+            return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1))));
+        }
+
+        AUDIO_KERNELS_TARGET("sse2") void s16_to_f32(const std::int16_t* in, float* out, std::size_t count)
+        {
+            const __m128 scale = _mm_set1_ps(S16_TO_F32);
+            std::size_t  i     = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                // each 16 bit sample lands in the top half of a 32 bit lane, the arithmetic shift brings it down signed
+                const __m128i low  = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+                const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+                _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+            }
+            scalar::s16_to_f32(in + i, out + i, count - i);
+        }
+
+        AUDIO_KERNELS_TARGET("sse2") void f32_to_s16(const float* in, std::int16_t* out, std::size_t count)
+        {
+            const __m128 scale  = _mm_set1_ps(F32_TO_S16);
+            const __m128 lowest = _mm_set1_ps(S16_MIN);
+            const __m128 high   = _mm_set1_ps(S16_MAX);
+            std::size_t  i      = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                // clamped before converting: out of range converts to 0x80000000, which would saturate the wrong way
+                const __m128  a = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), high), lowest);
+                const __m128  b = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), high), lowest);
+                const __m128i s = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), s);
+            }
+            scalar::f32_to_s16(in + i, out + i, count - i);
+        }
+
+        AUDIO_KERNELS_TARGET("sse2") void apply_gain(float* samples, std::size_t count, float gain)
+        {
+            const __m128 scale = _mm_set1_ps(gain);
+            std::size_t  i     = 0;
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), scale));
+            scalar::apply_gain(samples + i, count - i, gain);
+        }
+
+        AUDIO_KERNELS_TARGET("sse2") void mix_gain(const float* in, float* out, std::size_t count, float gain)
+        {
+            const __m128 scale = _mm_set1_ps(gain);
+            std::size_t  i     = 0;
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), scale)));
+            scalar::mix_gain(in + i, out + i, count - i, gain);
+        }
+
+        AUDIO_KERNELS_TARGET("sse2") void interleave2(const float* left, const float* right, std::size_t frames, float* out)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= frames; i += 4)
+            {
+                const __m128 l = _mm_loadu_ps(left + i);
+                const __m128 r = _mm_loadu_ps(right + i);
+                _mm_storeu_ps(out + i * 2, _mm_unpacklo_ps(l, r));
+                _mm_storeu_ps(out + i * 2 + 4, _mm_unpackhi_ps(l, r));
+            }
+            scalar::interleave2(left + i, right + i, frames - i, out + i * 2);
+        }
+
+        AUDIO_KERNELS_TARGET("sse2") void deinterleave2(const float* in, std::size_t frames, float* left, float* right)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= frames; i += 4)
+            {
+                const __m128 a = _mm_loadu_ps(in + i * 2);
+                const __m128 b = _mm_loadu_ps(in + i * 2 + 4);
+                _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+            scalar::deinterleave2(in + i * 2, frames - i, left + i, right + i);
+        }
+
+        AUDIO_KERNELS_TARGET("sse2") float dot(const float* a, const float* b, std::size_t count)
+        {
+            __m128      sum = _mm_setzero_ps();
+            std::size_t i   = 0;
+            for (; i + 4 <= count; i += 4)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            return horizontal_sum(sum) + scalar::dot(a + i, b + i, count - i);
+        }
+
+        AUDIO_KERNELS_TARGET("sse2") void complex_mac(const float* a_re, const float* a_im, const float* b_re, const float* b_im, float* out_re, float* out_im, std::size_t count)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 ar = _mm_loadu_ps(a_re + i);
+                const __m128 ai = _mm_loadu_ps(a_im + i);
+                const __m128 br = _mm_loadu_ps(b_re + i);
+                const __m128 bi = _mm_loadu_ps(b_im + i);
+                _mm_storeu_ps(out_re + i, _mm_add_ps(_mm_loadu_ps(out_re + i), _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi))));
+                _mm_storeu_ps(out_im + i, _mm_add_ps(_mm_loadu_ps(out_im + i), _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br))));
+            }
+            scalar::complex_mac(a_re + i, a_im + i, b_re + i, b_im + i, out_re + i, out_im + i, count - i);
+        }
+
+        constexpr Kernels KERNELS{ Level::Sse2, s16_to_f32, f32_to_s16, apply_gain, mix_gain, interleave2, deinterleave2, dot, complex_mac };
+    }
+
+    namespace avx2
+    {
+        AUDIO_KERNELS_TARGET("avx2") void s16_to_f32(const std::int16_t* in, float* out, std::size_t count)
+        {
+            const __m256 scale = _mm256_set1_ps(S16_TO_F32);
+            std::size_t  i     = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m256i low  = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+                const __m256i high = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8)));
+                _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(low), scale));
+                _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(high), scale));
+            }
+            sse2::s16_to_f32(in + i, out + i, count - i);
+        }
+
+        AUDIO_KERNELS_TARGET("avx2") void f32_to_s16(const float* in, std::int16_t* out, std::size_t count)
+        {
+            const __m256 scale  = _mm256_set1_ps(F32_TO_S16);
+            const __m256 lowest = _mm256_set1_ps(S16_MIN);
+            const __m256 high   = _mm256_set1_ps(S16_MAX);
+            std::size_t  i      = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m256  a = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), high), lowest);
+                const __m256  b = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale), high), lowest);
+                const __m256i s = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+                // the pack works per 128 bit lane, leaving the quarters as a0 b0 a1 b1
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(s, _MM_SHUFFLE(3, 1, 2, 0)));
+            }
+            sse2::f32_to_s16(in + i, out + i, count - i);
+        }
+
+        AUDIO_KERNELS_TARGET("avx2") void apply_gain(float* samples, std::size_t count, float gain)
+        {
+            const __m256 scale = _mm256_set1_ps(gain);
+            std::size_t  i     = 0;
+            for (; i + 8 <= count; i += 8)
+                _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), scale));
+            sse2::apply_gain(samples + i, count - i, gain);
+        }
+
+        AUDIO_KERNELS_TARGET("avx2") void mix_gain(const float* in, float* out, std::size_t count, float gain)
+        {
+            const __m256 scale = _mm256_set1_ps(gain);
+            std::size_t  i     = 0;
+            for (; i + 8 <= count; i += 8)
+                _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(_mm256_loadu_ps(in + i), scale)));
+            sse2::mix_gain(in + i, out + i, count - i, gain);
+        }
+
+        AUDIO_KERNELS_TARGET("avx2") void interleave2(const float* left, const float* right, std::size_t frames, float* out)
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= frames; i += 8)
+            {
+                const __m256 l  = _mm256_loadu_ps(left + i);
+                const __m256 r  = _mm256_loadu_ps(right + i);
+                const __m256 lo = _mm256_unpacklo_ps(l, r); // l0 r0 l1 r1 | l4 r4 l5 r5
+                const __m256 hi = _mm256_unpackhi_ps(l, r); // l2 r2 l3 r3 | l6 r6 l7 r7
+                _mm256_storeu_ps(out + i * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+                _mm256_storeu_ps(out + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+            }
+            sse2::interleave2(left + i, right + i, frames - i, out + i * 2);
+        }
+
+        // swaps the middle pairs of floats
+        AUDIO_KERNELS_TARGET("avx2") __m256 swap_middle_pairs(__m256 v)
+        {
+            return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+
+        AUDIO_KERNELS_TARGET("avx2") void deinterleave2(const float* in, std::size_t frames, float* left, float* right)
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= frames; i += 8)
+            {
+                const __m256 a = _mm256_loadu_ps(in + i * 2);
+                const __m256 b = _mm256_loadu_ps(in + i * 2 + 8);
+                // the shuffles work per lane and give l0 l1 l4 l5 l2 l3 l6 l7
+                _mm256_storeu_ps(left + i, swap_middle_pairs(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+                _mm256_storeu_ps(right + i, swap_middle_pairs(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+            }
+            sse2::deinterleave2(in + i * 2, frames - i, left + i, right + i);
+        }
+
+        AUDIO_KERNELS_TARGET("avx2") float dot(const float* a, const float* b, std::size_t count)
+        {
+            __m256      sum = _mm256_setzero_ps();
+            std::size_t i   = 0;
+            for (; i + 8 <= count; i += 8)
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            const __m128 halves = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+            return sse2::horizontal_sum(halves) + sse2::dot(a + i, b + i, count - i);
+        }
+
+        // no FMA: SDL_HasAVX2 doesn't promise it, and the other levels round the same way without it
+        AUDIO_KERNELS_TARGET("avx2") void complex_mac(const float* a_re, const float* a_im, const float* b_re, const float* b_im, float* out_re, float* out_im, std::size_t count)
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256 ar = _mm256_loadu_ps(a_re + i);
+                const __m256 ai = _mm256_loadu_ps(a_im + i);
+                const __m256 br = _mm256_loadu_ps(b_re + i);
+                const __m256 bi = _mm256_loadu_ps(b_im + i);
+                _mm256_storeu_ps(out_re + i, _mm256_add_ps(_mm256_loadu_ps(out_re + i), _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi))));
+                _mm256_storeu_ps(out_im + i, _mm256_add_ps(_mm256_loadu_ps(out_im + i), _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br))));
+            }
+            sse2::complex_mac(a_re + i, a_im + i, b_re + i, b_im + i, out_re + i, out_im + i, count - i);
+        }
+
+        constexpr Kernels KERNELS{ Level::Avx2, s16_to_f32, f32_to_s16, apply_gain, mix_gain, interleave2, deinterleave2, dot, complex_mac };
+    }
+#endif
+
+#if defined(AUDIO_KERNELS_NEON)
+    namespace neon
+    {
+        void s16_to_f32(const std::int16_t* in, float* out, std::size_t count)
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const int16x8_t samples = vld1q_s16(in + i);
+                vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), S16_TO_F32));
+                vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), S16_TO_F32));
+            }
+            scalar::s16_to_f32(in + i, out + i, count - i);
+        }
+
+        void f32_to_s16(const float* in, std::int16_t* out, std::size_t count)
+        {
+            const float32x4_t lowest = vdupq_n_f32(S16_MIN);
+            const float32x4_t high   = vdupq_n_f32(S16_MAX);
+            std::size_t       i      = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const float32x4_t a = vmaxq_f32(vminq_f32(vmulq_n_f32(vld1q_f32(in + i), F32_TO_S16), high), lowest);
+                const float32x4_t b = vmaxq_f32(vminq_f32(vmulq_n_f32(vld1q_f32(in + i + 4), F32_TO_S16), high), lowest);
+                vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+            }
+            scalar::f32_to_s16(in + i, out + i, count - i);
+        }
+
+        void apply_gain(float* samples, std::size_t count, float gain)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+                vst1q_f32(samples + i, vmulq_n_f32(vld1q_f32(samples + i), gain));
+            scalar::apply_gain(samples + i, count - i, gain);
+        }
+
+        void mix_gain(const float* in, float* out, std::size_t count, float gain)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+                vst1q_f32(out + i, vmlaq_n_f32(vld1q_f32(out + i), vld1q_f32(in + i), gain));
+            scalar::mix_gain(in + i, out + i, count - i, gain);
+        }
+
+        void interleave2(const float* left, const float* right, std::size_t frames, float* out)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= frames; i += 4)
+                vst2q_f32(out + i * 2, float32x4x2_t{ { vld1q_f32(left + i), vld1q_f32(right + i) } });
+            scalar::interleave2(left + i, right + i, frames - i, out + i * 2);
+        }
+
+        void deinterleave2(const float* in, std::size_t frames, float* left, float* right)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= frames; i += 4)
+            {
+                const float32x4x2_t pair = vld2q_f32(in + i * 2);
+                vst1q_f32(left + i, pair.val[0]);
+                vst1q_f32(right + i, pair.val[1]);
+            }
+            scalar::deinterleave2(in + i * 2, frames - i, left + i, right + i);
+        }
+
+        float dot(const float* a, const float* b, std::size_t count)
+        {
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            std::size_t i   = 0;
+            for (; i + 4 <= count; i += 4)
+                sum = vmlaq_f32(sum, vld1q_f32(a + i), vld1q_f32(b + i));
+            return vaddvq_f32(sum) + scalar::dot(a + i, b + i, count - i);
+        }
+
+        void complex_mac(const float* a_re, const float* a_im, const float* b_re, const float* b_im, float* out_re, float* out_im, std::size_t count)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const float32x4_t ar = vld1q_f32(a_re + i);
+                const float32x4_t ai = vld1q_f32(a_im + i);
+                const float32x4_t br = vld1q_f32(b_re + i);
+                const float32x4_t bi = vld1q_f32(b_im + i);
+                vst1q_f32(out_re + i, vmlsq_f32(vmlaq_f32(vld1q_f32(out_re + i), ar, br), ai, bi));
+                vst1q_f32(out_im + i, vmlaq_f32(vmlaq_f32(vld1q_f32(out_im + i), ar, bi), ai, br));
+            }
+            scalar::complex_mac(a_re + i, a_im + i, b_re + i, b_im + i, out_re + i, out_im + i, count - i);
+        }
+
+        constexpr Kernels KERNELS{ Level::Neon, s16_to_f32, f32_to_s16, apply_gain, mix_gain, interleave2, deinterleave2, dot, complex_mac };
+    }
+#endif
+
+#if defined(AUDIO_KERNELS_WASM)
+    namespace wasm
+    {
+        void s16_to_f32(const std::int16_t* in, float* out, std::size_t count)
+        {
+            const v128_t scale = wasm_f32x4_splat(S16_TO_F32);
+            std::size_t  i     = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const v128_t samples = wasm_v128_load(in + i);
+                wasm_v128_store(out + i, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(wasm_i32x4_extend_low_i16x8(samples)), scale));
+                wasm_v128_store(out + i + 4, wasm_f32x4_mul(wasm_f32x4_convert_i32x4(wasm_i32x4_extend_high_i16x8(samples)), scale));
+            }
+            scalar::s16_to_f32(in + i, out + i, count - i);
+        }
+
+        void f32_to_s16(const float* in, std::int16_t* out, std::size_t count)
+        {
+            const v128_t scale  = wasm_f32x4_splat(F32_TO_S16);
+            const v128_t lowest = wasm_f32x4_splat(S16_MIN);
+            const v128_t high   = wasm_f32x4_splat(S16_MAX);
+            std::size_t  i      = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                // wasm only truncates, so round first
+                const v128_t a = wasm_f32x4_nearest(wasm_f32x4_max(wasm_f32x4_min(wasm_f32x4_mul(wasm_v128_load(in + i), scale), high), lowest));
+                const v128_t b = wasm_f32x4_nearest(wasm_f32x4_max(wasm_f32x4_min(wasm_f32x4_mul(wasm_v128_load(in + i + 4), scale), high), lowest));
+                wasm_v128_store(out + i, wasm_i16x8_narrow_i32x4(wasm_i32x4_trunc_sat_f32x4(a), wasm_i32x4_trunc_sat_f32x4(b)));
+            }
+            scalar::f32_to_s16(in + i, out + i, count - i);
+        }
+
+        void apply_gain(float* samples, std::size_t count, float gain)
+        {
+            const v128_t scale = wasm_f32x4_splat(gain);
+            std::size_t  i     = 0;
+            for (; i + 4 <= count; i += 4)
+                wasm_v128_store(samples + i, wasm_f32x4_mul(wasm_v128_load(samples + i), scale));
+            scalar::apply_gain(samples + i, count - i, gain);
+        }
+
+        void mix_gain(const float* in, float* out, std::size_t count, float gain)
+        {
+            const v128_t scale = wasm_f32x4_splat(gain);
+            std::size_t  i     = 0;
+            for (; i + 4 <= count; i += 4)
+                wasm_v128_store(out + i, wasm_f32x4_add(wasm_v128_load(out + i), wasm_f32x4_mul(wasm_v128_load(in + i), scale)));
+            scalar::mix_gain(in + i, out + i, count - i, gain);
+        }
+
+        void interleave2(const float* left, const float* right, std::size_t frames, float* out)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= frames; i += 4)
+            {
+                const v128_t l = wasm_v128_load(left + i);
+                const v128_t r = wasm_v128_load(right + i);
+                wasm_v128_store(out + i * 2, wasm_i32x4_shuffle(l, r, 0, 4, 1, 5));
+                wasm_v128_store(out + i * 2 + 4, wasm_i32x4_shuffle(l, r, 2, 6, 3, 7));
+            }
+            scalar::interleave2(left + i, right + i, frames - i, out + i * 2);
+        }
+
+        void deinterleave2(const float* in, std::size_t frames, float* left, float* right)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= frames; i += 4)
+            {
+                const v128_t a = wasm_v128_load(in + i * 2);
+                const v128_t b = wasm_v128_load(in + i * 2 + 4);
+                wasm_v128_store(left + i, wasm_i32x4_shuffle(a, b, 0, 2, 4, 6));
+                wasm_v128_store(right + i, wasm_i32x4_shuffle(a, b, 1, 3, 5, 7));
+            }
+            scalar::deinterleave2(in + i * 2, frames - i, left + i, right + i);
+        }
+
+        float dot(const float* a, const float* b, std::size_t count)
+        {
+            v128_t      sum = wasm_f32x4_splat(0.0f);
+            std::size_t i   = 0;
+            for (; i + 4 <= count; i += 4)
+                sum = wasm_f32x4_add(sum, wasm_f32x4_mul(wasm_v128_load(a + i), wasm_v128_load(b + i)));
+            const float total = wasm_f32x4_extract_lane(sum, 0) + wasm_f32x4_extract_lane(sum, 1) + wasm_f32x4_extract_lane(sum, 2) + wasm_f32x4_extract_lane(sum, 3);
+            return total + scalar::dot(a + i, b + i, count - i);
+        }
+
+        void complex_mac(const float* a_re, const float* a_im, const float* b_re, const float* b_im, float* out_re, float* out_im, std::size_t count)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const v128_t ar = wasm_v128_load(a_re + i);
+                const v128_t ai = wasm_v128_load(a_im + i);
+                const v128_t br = wasm_v128_load(b_re + i);
+                const v128_t bi = wasm_v128_load(b_im + i);
+                wasm_v128_store(out_re + i, wasm_f32x4_add(wasm_v128_load(out_re + i), wasm_f32x4_sub(wasm_f32x4_mul(ar, br), wasm_f32x4_mul(ai, bi))));
+                wasm_v128_store(out_im + i, wasm_f32x4_add(wasm_v128_load(out_im + i), wasm_f32x4_add(wasm_f32x4_mul(ar, bi), wasm_f32x4_mul(ai, br))));
+            }
+            scalar::complex_mac(a_re + i, a_im + i, b_re + i, b_im + i, out_re + i, out_im + i, count - i);
+        }
+
+        constexpr Kernels KERNELS{ Level::Wasm, s16_to_f32, f32_to_s16, apply_gain, mix_gain, interleave2, deinterleave2, dot, complex_mac };
+    }
+#endif
+
+    // null when the build has no such kernels
+    const Kernels* compiled_kernels(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Scalar: return &scalar::KERNELS;
+#if defined(AUDIO_KERNELS_X86)
+            case Level::Sse2: return &sse2::KERNELS;
+            case Level::Avx2: return &avx2::KERNELS;
+#endif
+#if defined(AUDIO_KERNELS_NEON)
+            case Level::Neon: return &neon::KERNELS;
+#endif
+#if defined(AUDIO_KERNELS_WASM)
+            case Level::Wasm: return &wasm::KERNELS;
+#endif
+            default: return nullptr;
+        }
+    }
+
+    bool cpu_runs(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Sse2: return SDL_HasSSE2() == SDL_TRUE;
+            case Level::Avx2: return SDL_HasAVX2() == SDL_TRUE;
+            case Level::Neon: return SDL_HasNEON() == SDL_TRUE;
+            // a browser without SIMD refuses the whole module, so getting here means it has it
+            default: return true;
+        }
+    }
+
+    const Kernels& best_kernels() noexcept
+    {
+        for (const Level level : { Level::Avx2, Level::Sse2, Level::Neon, Level::Wasm })
+        {
+            if (audio_kernels::IsAvailable(level))
+                return *compiled_kernels(level);
+        }
+        return scalar::KERNELS;
+    }
+
+    // picking twice on a race is harmless, both threads land on the same table
+    std::atomic<const Kernels*> active{ nullptr };
+
+    const Kernels& kernels() noexcept
+    {
+        const Kernels* current = active.load(std::memory_order_acquire);
+        if (current == nullptr)
+        {
+            current = &best_kernels();
+            active.store(current, std::memory_order_release);
+        }
+        return *current;
+    }
+
+    double sinc(double x)
+    {
+        return x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+    }
+
+    // Blackman, over t in [-1, 1]
+    double window(double t)
+    {
+        if (t <= -1.0 || t >= 1.0)
+            return 0.0;
+        return 0.42 + 0.5 * std::cos(std::numbers::pi * t) + 0.08 * std::cos(2.0 * std::numbers::pi * t);
+    }
+}
+
+namespace audio_kernels
+{
+    bool IsAvailable(Level level) noexcept
+    {
+        return compiled_kernels(level) != nullptr && cpu_runs(level);
+    }
+
+    Level ActiveLevel() noexcept
+    {
+        return kernels().level;
+    }
+
+    bool SetLevel(Level level) noexcept
+    {
+        if (!IsAvailable(level))
+            return false;
+        active.store(compiled_kernels(level), std::memory_order_release);
+        return true;
+    }
+
+    const char* LevelName(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Scalar: return "scalar";
+            case Level::Sse2: return "sse2";
+            case Level::Avx2: return "avx2";
+            case Level::Neon: return "neon";
+            case Level::Wasm: return "wasm simd";
+        }
+        return "unknown";
+    }
+
+    void S16ToF32(const std::int16_t* in, float* out, std::size_t count) noexcept
+    {
+        kernels().s16_to_f32(in, out, count);
+    }
+
+    void F32ToS16(const float* in, std::int16_t* out, std::size_t count) noexcept
+    {
+        kernels().f32_to_s16(in, out, count);
+    }
+
+    void ApplyGain(float* samples, std::size_t count, float gain) noexcept
+    {
+        kernels().apply_gain(samples, count, gain);
+    }
+
+    void MixGain(const float* in, float* out, std::size_t count, float gain) noexcept
+    {
+        kernels().mix_gain(in, out, count, gain);
+    }
+
+    void Interleave(const float* const* planes, int channels, std::size_t frames, float* out) noexcept
+    {
+        if (channels == 1)
+        {
+            std::copy_n(planes[0], frames, out);
+            return;
+        }
+        if (channels == 2)
+        {
+            kernels().interleave2(planes[0], planes[1], frames, out);
+            return;
+        }
+        const std::size_t stride = static_cast<std::size_t>(channels);
+        for (std::size_t c = 0; c < stride; ++c)
+        {
+            for (std::size_t i = 0; i < frames; ++i)
+                out[i * stride + c] = planes[c][i];
+        }
+    }
+
+    void Deinterleave(const float* in, int channels, std::size_t frames, float* const* planes) noexcept
+    {
+        if (channels == 1)
+        {
+            std::copy_n(in, frames, planes[0]);
+            return;
+        }
+        if (channels == 2)
+        {
+            kernels().deinterleave2(in, frames, planes[0], planes[1]);
+            return;
+        }
+        const std::size_t stride = static_cast<std::size_t>(channels);
+        for (std::size_t c = 0; c < stride; ++c)
+        {
+            for (std::size_t i = 0; i < frames; ++i)
+                planes[c][i] = in[i * stride + c];
+        }
+    }
+
+    float Dot(const float* a, const float* b, std::size_t count) noexcept
+    {
+        return kernels().dot(a, b, count);
+    }
+
+    void ComplexMultiplyAdd(const float* a_re, const float* a_im, const float* b_re, const float* b_im, float* out_re, float* out_im, std::size_t count) noexcept
+    {
+        kernels().complex_mac(a_re, a_im, b_re, b_im, out_re, out_im, count);
+    }
+
+    Resampler::Resampler(int new_in_rate, int new_out_rate) : in_rate{ new_in_rate }, out_rate{ new_out_rate }
+    {
+        if (in_rate <= 0 || out_rate <= 0)
+            throw_error_message("Resampler needs positive rates, got ", in_rate, " -> ", out_rate);
+        const int divisor = std::gcd(in_rate, out_rate);
+        in_step           = static_cast<std::uint64_t>(in_rate / divisor);
+        out_step          = static_cast<std::uint64_t>(out_rate / divisor);
+        phases            = static_cast<int>(std::min<std::uint64_t>(out_step, MAX_PHASES));
+
+        // the filter's zero crossings follow the lower of the two Nyquists
+        const double cutoff = std::min(1.0, static_cast<double>(out_rate) / static_cast<double>(in_rate));
+        coefficients.resize(static_cast<std::size_t>(phases) * TAPS);
+        for (int phase = 0; phase < phases; ++phase)
+        {
+            float* row     = coefficients.data() + static_cast<std::size_t>(phase) * TAPS;
+            double row_sum = 0.0;
+            double weight[TAPS];
+            for (int k = 0; k < TAPS; ++k)
+            {
+                // tap k reads input floor(t) + k - (TAPS / 2 - 1), t being the output's position
+                const double distance = static_cast<double>(k - (TAPS / 2 - 1)) - static_cast<double>(phase) / phases;
+                weight[k]             = cutoff * sinc(cutoff * distance) * window(distance / (TAPS / 2));
+                row_sum += weight[k];
+            }
+            // unity gain at DC for every phase, or the fraction would show up as a ripple
+            for (int k = 0; k < TAPS; ++k)
+                row[k] = static_cast<float>(weight[k] / row_sum);
+        }
+        Reset();
+    }
+
+    void Resampler::Process(std::span<const float> in, std::vector<float>& out)
+    {
+        constexpr std::size_t BEHIND = TAPS / 2 - 1;
+        constexpr std::size_t AHEAD  = TAPS / 2;
+
+        history.insert(history.end(), in.begin(), in.end());
+        const Kernels& k = kernels();
+        for (std::uint64_t index = position / out_step; index + AHEAD < history.size(); index = position / out_step)
+        {
+            const std::uint64_t fraction = position % out_step;
+            const std::size_t   phase    = static_cast<std::size_t>(phases == static_cast<int>(out_step) ? fraction : fraction * static_cast<std::uint64_t>(phases) / out_step);
+            out.push_back(k.dot(history.data() + (index - BEHIND), coefficients.data() + phase * TAPS, TAPS));
+            position += in_step;
+        }
+
+        // keep from the first sample the next output reads
+        const std::size_t drop = std::min<std::size_t>(static_cast<std::size_t>(position / out_step) - BEHIND, history.size());
+        history.erase(history.begin(), history.begin() + static_cast<std::ptrdiff_t>(drop));
+        position -= static_cast<std::uint64_t>(drop) * out_step;
+    }
+
+    void Resampler::Flush(std::vector<float>& out)
+    {
+        const float silence[TAPS / 2] = {};
+        Process(silence, out);
+        Reset();
+    }
+
+    void Resampler::Reset()
+    {
+        // zeros before the first input, so the first output's window has something to read
+        history.assign(TAPS / 2 - 1, 0.0f);
+        position = static_cast<std::uint64_t>(TAPS / 2 - 1) * out_step;
+    }
+
+    int Resampler::InRate() const noexcept
+    {
+        return in_rate;
+    }
+
+    int Resampler::OutRate() const noexcept
+    {
+        return out_rate;
+    }
+}
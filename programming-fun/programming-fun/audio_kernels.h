@@ -0,0 +1,93 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * Sample loops for the audio pipeline: s16 <-> f32, planar <-> interleaved, gain, mixing, the dot products
+ * behind Resampler and the spectrum multiply-adds behind Convolver.
+ *
+ * Each kernel has a scalar version and, where the build targets them, SSE2 and AVX2 (x86), NEON (ARM)
+ * or wasm SIMD (Emscripten with -msimd128) versions. The first call picks the best one this CPU runs,
+ * asking SDL_HasSSE2 / SDL_HasAVX2 / SDL_HasNEON; SetLevel swaps them for benchmarks. All of them give the
+ * same results up to float rounding, so which one ran never shows up in the output.
+ */
+namespace audio_kernels
+{
+    enum class Level
+    {
+        Scalar,
+        Sse2,
+        Avx2,
+        Neon,
+        Wasm
+    };
+
+    // Whether this build has `level` and the CPU can run it
+    bool        IsAvailable(Level level) noexcept;
+    Level       ActiveLevel() noexcept;
+    // For benchmarks; false, and nothing changes, when `level` isn't available
+    bool        SetLevel(Level level) noexcept;
+    const char* LevelName(Level level) noexcept;
+
+    // Scales by 1 / 32768
+    void S16ToF32(const std::int16_t* in, float* out, std::size_t count) noexcept;
+    // Scales by 32768, rounds to nearest and saturates, so 1.0 becomes 32767
+    void F32ToS16(const float* in, std::int16_t* out, std::size_t count) noexcept;
+    void ApplyGain(float* samples, std::size_t count, float gain) noexcept;
+    // out[i] += in[i] * gain, the mixer's inner loop
+    void MixGain(const float* in, float* out, std::size_t count, float gain) noexcept;
+    // `planes` holds `channels` pointers to `frames` samples each; mono and stereo have kernels, wider layouts loop
+    void Interleave(const float* const* planes, int channels, std::size_t frames, float* out) noexcept;
+    void Deinterleave(const float* in, int channels, std::size_t frames, float* const* planes) noexcept;
+    // The sum of a[i] * b[i]
+    float Dot(const float* a, const float* b, std::size_t count) noexcept;
+    // out[i] += a[i] * b[i] over complex numbers kept as separate real and imaginary arrays, Convolver's inner loop
+    void ComplexMultiplyAdd(const float* a_re, const float* a_im, const float* b_re, const float* b_im, float* out_re, float* out_im, std::size_t count) noexcept;
+
+    /**
+     * Windowed-sinc polyphase resampling of one planar channel, say a 44.1 kHz asset for a 48 kHz mix.
+     *
+     * The rates reduce to out/in = L/M and output n reads the input at n * M / L, through the filter phase
+     * for that fraction. Up to MAX_PHASES phases every fraction gets its own; past that the nearest lower one
+     * is used. Downsampling lowers the cutoff to the output's Nyquist. Process streams: the input the filter
+     * still needs carries over to the next call, and output n lines up with input n * M / L with no delay,
+     * which means the last TAPS / 2 input samples wait for more input (or Flush).
+     */
+    class Resampler
+    {
+    public:
+        static constexpr int TAPS       = 16;
+        static constexpr int MAX_PHASES = 512;
+
+        Resampler(int in_rate, int out_rate);
+
+        // Appends to `out` every output sample the input so far completes
+        void Process(std::span<const float> in, std::vector<float>& out);
+        // Feeds silence for the samples Process held back, then resets
+        void Flush(std::vector<float>& out);
+        void Reset();
+
+        int InRate() const noexcept;
+        int OutRate() const noexcept;
+
+    private:
+        int                in_rate;
+        int                out_rate;
+        std::uint64_t      in_step;         // M
+        std::uint64_t      out_step;        // L
+        int                phases;
+        std::vector<float> coefficients;    // phases rows of TAPS
+        std::vector<float> history;         // input from the oldest sample any pending output reads
+        std::uint64_t      position = 0;    // the next output's input position, in 1 / L samples from history[0]
+    };
+}
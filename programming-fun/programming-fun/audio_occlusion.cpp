@@ -0,0 +1,74 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "audio_occlusion.h"
+
+#include "profiler.h"
+#include "sprite_grid.h"
+#include "worker_pool.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <cmath>
+
+std::span<const std::uint32_t> AudioOcclusion::Update(const SpriteGrid& grid, glm::vec2 listener, std::span<const OcclusionSource> sources, WorkerPool& workers)
+{
+    PROFILE_ZONE("AudioOcclusion::Update");
+    const Uint64 started = SDL_GetPerformanceCounter();
+    // new sources start clear until their turn comes
+    occlusion.resize(sources.size(), 0.0f);
+    if (cursor >= sources.size())
+        cursor = 0;
+    traced.clear();
+    const std::size_t share = (sources.size() + SPREAD_FRAMES - 1) / SPREAD_FRAMES;
+    for (std::size_t k = 0; k < share; ++k)
+    {
+        traced.push_back(static_cast<std::uint32_t>(cursor));
+        cursor = cursor + 1 == sources.size() ? 0 : cursor + 1;
+    }
+    tested.assign(traced.size(), 0);
+    hits.assign(traced.size(), 0);
+
+    workers.ParallelFor("Occlusion Rays", traced.size(), RAYS_PER_JOB,
+                        [&](std::size_t begin, std::size_t end)
+                        {
+                            for (std::size_t k = begin; k < end; ++k)
+                            {
+                                const OcclusionSource& source = sources[traced[k]];
+                                int                    count  = 0;
+                                tested[k]                     = grid.QuerySegment(listener, source.position,
+                                                                                  [&count, &source](std::uint32_t id)
+                                                                                  {
+                                                                                      if (id != source.own_sprite)
+                                                                                          ++count;
+                                                                                  });
+                                hits[k]                       = count;
+                                occlusion[traced[k]]          = 1.0f - std::pow(1.0f - OCCLUDER_SHARE, static_cast<float>(std::min(count, MAX_OCCLUDERS)));
+                            }
+                        });
+
+    stats.rays     = static_cast<int>(traced.size());
+    stats.tested   = 0;
+    stats.occluded = 0;
+    for (std::size_t k = 0; k < traced.size(); ++k)
+    {
+        stats.tested += tested[k];
+        stats.occluded += hits[k] > 0 ? 1 : 0;
+    }
+    stats.trace_ms = profiler::ToMilliseconds(SDL_GetPerformanceCounter() - started);
+    return traced;
+}
+
+float AudioOcclusion::Occlusion(std::size_t source) const noexcept
+{
+    return source < occlusion.size() ? occlusion[source] : 0.0f;
+}
+
+const AudioOcclusion::Stats& AudioOcclusion::GetStats() const noexcept
+{
+    return stats;
+}
@@ -0,0 +1,69 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <span>
+#include <vector>
+
+class SpriteGrid;
+class WorkerPool;
+
+// An emitter as the occlusion rays see it, in the grid's coordinates
+struct OcclusionSource
+{
+    static constexpr std::uint32_t NO_SPRITE = 0xFFFFFFFFu;
+
+    glm::vec2     position{ 0.0f };
+    std::uint32_t own_sprite = NO_SPRITE; // the grid id of the sprite making the sound, which doesn't occlude it
+};
+
+/**
+ * How much of each emitter the sprites between it and the listener hide, for the audio thread's low-pass.
+ *
+ * Update traces a ray from the listener to a share of the sources, one in SPREAD_FRAMES of them each call
+ * taking turns, so an emitter is traced every SPREAD_FRAMES Updates and the cost stays flat however often
+ * it is called. The rays go to the workers RAYS_PER_JOB at a time and walk the grid with
+ * SpriteGrid::QuerySegment; every sprite in the way takes OCCLUDER_SHARE of what is left, up to
+ * MAX_OCCLUDERS of them. Update hands back which sources it traced, so only their new values need sending.
+ * The steps between traces, and the smoothing that hides them, are SpatialAudio's. Main thread, with nothing
+ * changing the grid during Update.
+ */
+class AudioOcclusion
+{
+public:
+    static constexpr int         SPREAD_FRAMES  = 4;
+    static constexpr std::size_t RAYS_PER_JOB   = 64;
+    static constexpr float       OCCLUDER_SHARE = 0.3f;
+    static constexpr int         MAX_OCCLUDERS  = 6;
+
+    struct Stats
+    {
+        int    rays     = 0; // traced by the last Update
+        int    tested   = 0; // sprites their grid walks tested
+        int    occluded = 0; // of those rays, the ones something was in the way of
+        double trace_ms = 0.0;
+    };
+
+    // Sources are matched by index from one call to the next, so keep their order; added ones start clear
+    std::span<const std::uint32_t> Update(const SpriteGrid& grid, glm::vec2 listener, std::span<const OcclusionSource> sources, WorkerPool& workers);
+
+    // 0 clear to 1 as hidden as it gets, as of the source's latest trace
+    float        Occlusion(std::size_t source) const noexcept;
+    const Stats& GetStats() const noexcept;
+
+private:
+    std::vector<float>         occlusion; // by source
+    std::vector<std::uint32_t> traced;    // this Update's sources
+    std::vector<int>           tested;    // by ray, so the jobs don't share a counter
+    std::vector<int>           hits;      // by ray
+    std::size_t                cursor = 0;
+    Stats                      stats;
+};
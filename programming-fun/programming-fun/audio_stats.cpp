@@ -0,0 +1,70 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "audio_stats.h"
+
+#include "audio_device.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <imgui.h>
+
+namespace
+{
+    constexpr ImVec4 WARNING_COLOR{ 1.0f, 0.8f, 0.2f, 1.0f };
+    constexpr ImVec4 ERROR_COLOR{ 1.0f, 0.35f, 0.3f, 1.0f };
+}
+
+void AudioStats::Update(const AudioDevice& device, const AudioThread& audio_thread, const SoundCache* sounds, const AudioStreamer& streamer)
+{
+    PROFILE_ZONE("AudioStats::Update");
+    streamer.GetStats(streams);
+    has_cache = sounds != nullptr;
+    if (has_cache)
+        cache = sounds->GetStats();
+    thread_stats      = audio_thread.GetStats();
+    voices_peak       = std::max(voices_peak, thread_stats.voices_in_use);
+    output_latency_ms = device.OutputLatencyMs();
+    device_lost       = device.IsLost();
+    reopening         = device.IsReopening();
+    reconnects        = device.ReconnectCount();
+}
+
+void AudioStats::DrawImGui() const
+{
+    if (device_lost)
+        ImGui::TextColored(ERROR_COLOR, "%s", reopening ? "audio device disconnected, reopening..." : "audio device disconnected");
+    if (output_latency_ms >= 0.0 && !device_lost)
+        ImGui::Text("device latency = %.1f ms", output_latency_ms);
+    if (reconnects > 0)
+        ImGui::Text("device reopened %d time(s)", reconnects);
+
+    // a full pool steals, so occupancy near capacity is where one-shots start cutting each other off
+    const bool pool_full = thread_stats.voice_capacity > 0 && thread_stats.voices_in_use >= thread_stats.voice_capacity;
+    ImGui::TextColored(pool_full ? WARNING_COLOR : ImGui::GetStyleColorVec4(ImGuiCol_Text), "voices = %d / %d (peak %d), steals = %d/s", thread_stats.voices_in_use, thread_stats.voice_capacity,
+                       voices_peak, thread_stats.steals_per_second);
+    ImGui::TextColored(thread_stats.dropped > 0 ? WARNING_COLOR : ImGui::GetStyleColorVec4(ImGuiCol_Text), "audio thread: %.2f ms per drain, %llu commands, %llu dropped", thread_stats.drain_ms,
+                       static_cast<unsigned long long>(thread_stats.commands), static_cast<unsigned long long>(thread_stats.dropped));
+
+    for (std::size_t i = 0; i < streams.size(); ++i)
+    {
+        const AudioStream::Stats& stream = streams[i];
+        // one buffer left when the streamer got round to it is one service period from a gap
+        const bool starving = stream.low_water <= 1 && stream.queued_buffers > 0;
+        ImGui::TextColored(stream.underruns > 0 ? ERROR_COLOR : starving ? WARNING_COLOR : ImGui::GetStyleColorVec4(ImGuiCol_Text),
+                           "stream %zu: %d / %d buffers queued (%.0f ms, low water %d), %llu underruns", i, stream.queued_buffers, AudioStream::BUFFER_COUNT, stream.queued_ms,
+                           stream.low_water, static_cast<unsigned long long>(stream.underruns));
+    }
+
+    if (has_cache && cache.decodes > 0)
+    {
+        ImGui::Text("decode latency = %.1f ms last, %.1f mean, %.1f max (worker %.1f ms mean) over %llu", cache.last_latency_ms, cache.MeanLatencyMs(), cache.max_latency_ms,
+                    cache.MeanWorkerMs(), static_cast<unsigned long long>(cache.decodes));
+    }
+    if (has_cache && cache.decodes_on_play > 0)
+        ImGui::Text("last decode on play = %.2f ms", cache.last_play_decode_ms);
+}
@@ -0,0 +1,42 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "audio_stream.h"
+#include "audio_thread.h"
+#include "sound_cache.h"
+
+#include <vector>
+
+class AudioDevice;
+
+/**
+ * What the audio side is doing, gathered once a frame for the "Audio Test" window.
+ *
+ * Streams report their queue depth and underruns, the audio thread the voice pool's occupancy and how long
+ * its drains take, the sound cache how long a sound takes from Acquire to playable, and the device its
+ * output latency (ALC_SOFT_device_clock) and whether it is lost or being reopened.
+ */
+class AudioStats
+{
+public:
+    // After SoundCache::Update; `sounds` may be null
+    void Update(const AudioDevice& device, const AudioThread& audio_thread, const SoundCache* sounds, const AudioStreamer& streamer);
+    void DrawImGui() const;
+
+private:
+    std::vector<AudioStream::Stats> streams;
+    SoundCache::Stats               cache;
+    AudioThread::Stats              thread_stats;
+    bool                            has_cache         = false;
+    int                             voices_peak       = 0;
+    double                          output_latency_ms = -1.0;
+    bool                            device_lost       = false;
+    bool                            reopening         = false;
+    int                             reconnects        = 0;
+};
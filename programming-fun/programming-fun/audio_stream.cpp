@@ -0,0 +1,424 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "audio_stream.h"
+
+#include "memory_tracker.h"
+#include "profiler.h"
+#include "scheduling.h"
+#include "sound_loader.h"
+
+#include <algorithm>
+#include <chrono>
+#define STB_VORBIS_HEADER_ONLY
+#include <stb_vorbis.c>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#    define AUDIO_STREAMER_THREADED 0
+#else
+#    define AUDIO_STREAMER_THREADED 1
+#endif
+
+AudioStream::~AudioStream()
+{
+    close();
+}
+
+bool AudioStream::open(const std::filesystem::path& ogg_path)
+{
+    // mapped, so the seek index and the decoder read the same bytes without a copy
+    if (!mapping.Open(ogg_path))
+        return false;
+    return open(mapping.Bytes());
+}
+
+bool AudioStream::open(std::span<const unsigned char> ogg_bytes)
+{
+    int error = 0;
+    vorbis    = stb_vorbis_open_memory(ogg_bytes.data(), static_cast<int>(ogg_bytes.size()), &error, nullptr);
+    return setup(ogg_bytes);
+}
+
+bool AudioStream::setup(std::span<const unsigned char> ogg_bytes)
+{
+    if (vorbis == nullptr)
+        return false;
+
+    // music streams mix anything past stereo down, stb_vorbis does it while decoding
+    const stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+    channels                   = std::min(info.channels, 2);
+    sample_rate                = static_cast<int>(info.sample_rate);
+    format                     = FindOpenALFormat(SampleType::Signed16, channels);
+    length_frames              = stb_vorbis_stream_length_in_samples(vorbis);
+    scratch.resize(static_cast<std::size_t>(FRAMES_PER_BUFFER * channels));
+    seek_index.Build(ogg_bytes, sample_rate);
+
+    alGenSources(1, &source);
+    alGenBuffers(BUFFER_COUNT, buffers);
+    memory_tracker::Allocate(MemoryCategory::Audio, queuedBytes());
+    return true;
+}
+
+void AudioStream::close()
+{
+    std::lock_guard lock{ mutex };
+    if (vorbis == nullptr)
+        return;
+    alSourceStop(source);
+    alSourcei(source, AL_BUFFER, 0);
+    alDeleteSources(1, &source);
+    alDeleteBuffers(BUFFER_COUNT, buffers);
+    memory_tracker::Free(MemoryCategory::Audio, queuedBytes());
+    stb_vorbis_close(vorbis);
+    vorbis = nullptr;
+    seek_index.Clear();
+    mapping.Close();
+    is_playing.store(false);
+}
+
+void AudioStream::Play()
+{
+    PlayFrom(0);
+}
+
+void AudioStream::PlayFrom(std::uint32_t frame, std::uint32_t delay_frames)
+{
+    std::lock_guard lock{ mutex };
+    if (vorbis == nullptr || !prime(frame, delay_frames))
+        return;
+    alSourcePlay(source);
+    is_playing.store(true);
+}
+
+bool AudioStream::Prime(std::uint32_t frame, std::uint32_t delay_frames)
+{
+    std::lock_guard lock{ mutex };
+    return vorbis != nullptr && prime(frame, delay_frames);
+}
+
+void AudioStream::Start()
+{
+    std::lock_guard lock{ mutex };
+    if (vorbis == nullptr || queued_buffers.load() == 0)
+        return;
+    alSourcePlay(source);
+    is_playing.store(true);
+}
+
+void AudioStream::Stop()
+{
+    std::lock_guard lock{ mutex };
+    if (vorbis == nullptr)
+        return;
+    alSourceStop(source);
+    alSourcei(source, AL_BUFFER, 0);
+    queued_buffers.store(0);
+    is_playing.store(false);
+}
+
+void AudioStream::SetGain(float gain)
+{
+    std::lock_guard lock{ mutex };
+    if (vorbis != nullptr)
+        alSourcef(source, AL_GAIN, gain);
+}
+
+void AudioStream::SetLooping(bool loop) noexcept
+{
+    is_looping.store(loop);
+}
+
+void AudioStream::SetLoopPoints(std::uint32_t new_loop_start, std::uint32_t new_loop_end)
+{
+    std::lock_guard lock{ mutex };
+    loop_start = new_loop_start;
+    loop_end   = new_loop_end > new_loop_start ? new_loop_end : 0;
+}
+
+bool AudioStream::IsPlaying() const noexcept
+{
+    return is_playing.load();
+}
+
+ALuint AudioStream::Source() const noexcept
+{
+    return source;
+}
+
+int AudioStream::Channels() const noexcept
+{
+    return channels;
+}
+
+int AudioStream::SampleRate() const noexcept
+{
+    return sample_rate;
+}
+
+std::uint32_t AudioStream::LengthFrames() const noexcept
+{
+    return length_frames;
+}
+
+std::int64_t AudioStream::PlayedFrames() const noexcept
+{
+    // AL_SAMPLE_OFFSET is into what's still queued, so it restarts as each buffer is unqueued
+    ALint offset = 0;
+    alGetSourcei(source, AL_SAMPLE_OFFSET, &offset);
+    return unqueued_frames.load() + offset;
+}
+
+std::size_t AudioStream::SeekIndexPages() const noexcept
+{
+    std::lock_guard lock{ mutex };
+    return seek_index.PageCount();
+}
+
+AudioStream::Stats AudioStream::GetStats() const noexcept
+{
+    Stats result;
+    result.queued_buffers = queued_buffers.load();
+    result.low_water      = low_water.load();
+    result.underruns      = underruns.load();
+    // the last buffer before the end can be short, close enough for a gauge
+    result.queued_ms      = sample_rate > 0 ? 1000.0 * result.queued_buffers * FRAMES_PER_BUFFER / sample_rate : 0.0;
+    return result;
+}
+
+void AudioStream::service()
+{
+    std::lock_guard lock{ mutex };
+    if (vorbis == nullptr || !is_playing.load())
+        return;
+
+    ALint queued    = 0;
+    ALint processed = 0;
+    alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+    alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+    // what was left to play while we were away; 0 means the source starved, unless the track is just ending
+    if (!reached_end)
+        low_water.store(std::min(low_water.load(), static_cast<int>(queued - processed)));
+    while (processed-- > 0)
+    {
+        ALuint buffer = 0;
+        ALint  bytes  = 0;
+        alSourceUnqueueBuffers(source, 1, &buffer);
+        alGetBufferi(buffer, AL_SIZE, &bytes);
+        unqueued_frames.fetch_add(bytes / (channels * static_cast<ALint>(sizeof(short))));
+        if (!reached_end && fillBuffer(buffer))
+            alSourceQueueBuffers(source, 1, &buffer);
+    }
+
+    ALint state = AL_STOPPED;
+    alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+    alGetSourcei(source, AL_SOURCE_STATE, &state);
+    queued_buffers.store(queued);
+    if (state != AL_PLAYING)
+    {
+        if (queued > 0)
+        {
+            // the queue ran dry before we refilled it, pick up where we are
+            alSourcePlay(source);
+            underruns.fetch_add(1);
+        }
+        else
+        {
+            is_playing.store(false);
+        }
+    }
+}
+
+bool AudioStream::fillBuffer(ALuint buffer)
+{
+    int filled = 0;
+    if (lead_in > 0)
+    {
+        filled = static_cast<int>(std::min<std::uint32_t>(lead_in, FRAMES_PER_BUFFER));
+        std::fill_n(scratch.begin(), filled * channels, short{ 0 });
+        lead_in -= static_cast<std::uint32_t>(filled);
+    }
+    // a loop wraps inside the fill, so the buffer before the jump isn't cut short; `wrapped` stops an empty loop spinning
+    const bool looping = is_looping.load();
+    bool       wrapped = false;
+    while (filled < FRAMES_PER_BUFFER)
+    {
+        int want = FRAMES_PER_BUFFER - filled;
+        if (looping && loop_end > decode_position)
+            want = static_cast<int>(std::min<std::uint32_t>(static_cast<std::uint32_t>(want), loop_end - decode_position));
+        const int frames = stb_vorbis_get_samples_short_interleaved(vorbis, channels, scratch.data() + filled * channels, want * channels);
+        filled += frames;
+        decode_position += static_cast<std::uint32_t>(frames);
+        if (frames > 0)
+            wrapped = false;
+        const bool at_end = frames == 0 || (looping && loop_end > 0 && decode_position >= loop_end);
+        if (!at_end)
+            continue;
+        if (!looping || wrapped || !seek(loop_start))
+            break;
+        wrapped = true;
+    }
+    if (filled == 0)
+    {
+        reached_end = true;
+        return false;
+    }
+    alBufferData(buffer, format, scratch.data(), filled * channels * static_cast<int>(sizeof(short)), sample_rate);
+    return true;
+}
+
+bool AudioStream::prime(std::uint32_t frame, std::uint32_t delay_frames)
+{
+    // restart from `frame` with a freshly filled queue
+    alSourceStop(source);
+    alSourcei(source, AL_BUFFER, 0);
+    queued_buffers.store(0);
+    is_playing.store(false);
+    if (!seek(frame))
+        return false;
+    reached_end = false;
+    lead_in     = delay_frames;
+    unqueued_frames.store(static_cast<std::int64_t>(frame) - delay_frames);
+
+    int queued = 0;
+    while (queued < BUFFER_COUNT && fillBuffer(buffers[queued]))
+        ++queued;
+    if (queued == 0)
+        return false;
+    alSourceQueueBuffers(source, queued, buffers);
+    queued_buffers.store(queued);
+    low_water.store(queued);
+    return true;
+}
+
+bool AudioStream::seek(std::uint32_t frame)
+{
+    const bool found = frame == 0 ? stb_vorbis_seek_start(vorbis) != 0 : seek_index.Seek(vorbis, frame);
+    if (found)
+        decode_position = frame;
+    return found;
+}
+
+std::size_t AudioStream::queuedBytes() const noexcept
+{
+    return static_cast<std::size_t>(BUFFER_COUNT) * FRAMES_PER_BUFFER * static_cast<std::size_t>(channels) * sizeof(short);
+}
+
+AudioStreamer::AudioStreamer()
+{
+#if AUDIO_STREAMER_THREADED
+    thread = std::thread{ [this] { threadLoop(); } };
+#endif
+}
+
+AudioStreamer::~AudioStreamer()
+{
+    Shutdown();
+}
+
+std::shared_ptr<AudioStream> AudioStreamer::Open(const std::filesystem::path& ogg_path)
+{
+    std::shared_ptr<AudioStream> stream{ new AudioStream{} };
+    if (!stream->open(ogg_path))
+        return nullptr;
+    std::lock_guard lock{ mutex };
+    streams.push_back(stream);
+    return stream;
+}
+
+std::shared_ptr<AudioStream> AudioStreamer::Open(std::span<const unsigned char> ogg_bytes)
+{
+    std::shared_ptr<AudioStream> stream{ new AudioStream{} };
+    if (!stream->open(ogg_bytes))
+        return nullptr;
+    std::lock_guard lock{ mutex };
+    streams.push_back(stream);
+    return stream;
+}
+
+void AudioStreamer::Close(const std::shared_ptr<AudioStream>& stream)
+{
+    if (stream == nullptr)
+        return;
+    {
+        std::lock_guard lock{ mutex };
+        std::erase(streams, stream);
+    }
+    stream->close();
+}
+
+void AudioStreamer::Update()
+{
+#if !AUDIO_STREAMER_THREADED
+    serviceAll();
+#endif
+}
+
+void AudioStreamer::Shutdown()
+{
+    {
+        std::lock_guard lock{ mutex };
+        is_stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable())
+        thread.join();
+
+    std::lock_guard lock{ mutex };
+    for (auto& stream : streams)
+        stream->close();
+    streams.clear();
+}
+
+void AudioStreamer::SetBackground(bool background)
+{
+    std::lock_guard lock{ mutex };
+    is_background = background;
+}
+
+void AudioStreamer::SetSuspended(bool suspended)
+{
+    std::lock_guard lock{ mutex };
+    is_suspended = suspended;
+}
+
+void AudioStreamer::GetStats(std::vector<AudioStream::Stats>& out_stats) const
+{
+    std::lock_guard lock{ mutex };
+    out_stats.clear();
+    for (const auto& stream : streams)
+        out_stats.push_back(stream->GetStats());
+}
+
+void AudioStreamer::threadLoop()
+{
+    // a buffer holds ~90 ms at 44.1 kHz so a 10 ms period leaves lots of slack before the queue drains;
+    // the whole ring is ~370 ms, so even the background period refills with time to spare
+    constexpr auto SERVICE_PERIOD            = std::chrono::milliseconds{ 10 };
+    constexpr auto BACKGROUND_SERVICE_PERIOD = std::chrono::milliseconds{ 60 };
+    profiler::SetThreadName("audio stream");
+    scheduling::SetThreadRole(scheduling::ThreadRole::Audio);
+    std::unique_lock lock{ mutex };
+    while (!is_stopping)
+    {
+        if (!is_suspended)
+        {
+            PROFILE_TRACE_ZONE("Stream Service");
+            for (auto& stream : streams)
+                stream->service();
+        }
+        wake.wait_for(lock, is_background ? BACKGROUND_SERVICE_PERIOD : SERVICE_PERIOD, [this] { return is_stopping; });
+    }
+}
+
+void AudioStreamer::serviceAll()
+{
+    std::lock_guard lock{ mutex };
+    if (is_suspended)
+        return;
+    for (auto& stream : streams)
+        stream->service();
+}
@@ -0,0 +1,165 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "mapped_file.h"
+#include "vorbis_seek_index.h"
+
+#include <al.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+struct stb_vorbis;
+
+/**
+ * An OGG file played through a small ring of queued OpenAL buffers.
+ *
+ * Only BUFFER_COUNT * FRAMES_PER_BUFFER frames of PCM exist at any time, no matter how long the track is.
+ * Refilling is done by the AudioStreamer that opened the stream. A file is mapped and decoded from memory,
+ * with a VorbisSeekIndex built (or loaded from the decoded_cache) at open, so every seek is to the exact
+ * frame without searching the file: PlayFrom starts anywhere in the track, after a lead-in of silence counted
+ * in frames when the start has to land on a beat, and a loop runs from its end point back to its start
+ * point within the same buffer fill, so the loop is gapless and an intro plays once before it.
+ */
+class AudioStream
+{
+public:
+    static constexpr int BUFFER_COUNT      = 4;
+    static constexpr int FRAMES_PER_BUFFER = 4096;
+
+    struct Stats
+    {
+        int           queued_buffers = 0; // after the last refill
+        int           low_water      = 0; // fewest buffers still queued when the streamer came round, since Play
+        std::uint64_t underruns      = 0; // times the queue ran dry and the source stopped, since the stream opened
+        double        queued_ms      = 0.0;
+    };
+
+    ~AudioStream();
+
+    AudioStream(const AudioStream&)                = delete;
+    AudioStream& operator=(const AudioStream&)     = delete;
+    AudioStream(AudioStream&&) noexcept            = delete;
+    AudioStream& operator=(AudioStream&&) noexcept = delete;
+
+    void Play();
+    // From `frame` of the track, `delay_frames` of silence after the source starts
+    void PlayFrom(std::uint32_t frame, std::uint32_t delay_frames = 0);
+    // PlayFrom's decoding without starting the source, so Start later costs no decode; false at the end of the track
+    bool Prime(std::uint32_t frame, std::uint32_t delay_frames = 0);
+    // A primed queue
+    void Start();
+    void Stop();
+    void SetGain(float gain);
+    void SetLooping(bool loop) noexcept;
+    // In frames; `loop_end` 0 for the end of the track. Only used while looping.
+    void SetLoopPoints(std::uint32_t loop_start, std::uint32_t loop_end);
+    bool IsPlaying() const noexcept;
+
+    ALuint        Source() const noexcept;
+    int           Channels() const noexcept;
+    int           SampleRate() const noexcept;
+    std::uint32_t LengthFrames() const noexcept;
+    // Where the source is, counted on from PlayFrom's `frame` (and carrying on past a loop); readable from any thread
+    std::int64_t  PlayedFrames() const noexcept;
+    // Pages in the seek index, 0 when seeks search the file
+    std::size_t   SeekIndexPages() const noexcept;
+    // Readable from any thread
+    Stats         GetStats() const noexcept;
+
+private:
+    friend class AudioStreamer;
+    AudioStream() = default;
+
+    bool open(const std::filesystem::path& ogg_path);
+    bool open(std::span<const unsigned char> ogg_bytes);
+    bool setup(std::span<const unsigned char> ogg_bytes);
+    void close();
+    void service();
+    bool fillBuffer(ALuint buffer);
+    bool seek(std::uint32_t frame);
+    bool prime(std::uint32_t frame, std::uint32_t delay_frames);
+    // what the ring holds once every buffer is full
+    std::size_t queuedBytes() const noexcept;
+
+private:
+    mutable std::mutex mutex;
+    MappedFile         mapping; // when opened from a path
+    VorbisSeekIndex    seek_index;
+    stb_vorbis*        vorbis                = nullptr;
+    ALuint             source                = 0;
+    ALuint             buffers[BUFFER_COUNT] = { 0 };
+    ALenum             format                = AL_NONE;
+    int                channels              = 0;
+    int                sample_rate           = 0;
+    std::vector<short> scratch;
+    std::atomic<bool>  is_playing{ false };
+    std::atomic<bool>  is_looping{ false };
+    bool               reached_end     = false;
+    std::uint32_t      decode_position = 0; // the next frame stb_vorbis hands out
+    std::uint32_t      loop_start      = 0;
+    std::uint32_t      loop_end        = 0;
+    std::uint32_t      lead_in         = 0; // silence still to queue ahead of the track
+    std::uint32_t      length_frames   = 0;
+
+    std::atomic<int>           queued_buffers{ 0 };
+    std::atomic<int>           low_water{ 0 };
+    std::atomic<std::uint64_t> underruns{ 0 };
+    std::atomic<std::int64_t>  unqueued_frames{ 0 }; // of buffers the source finished, from PlayFrom's `frame` less the lead-in
+};
+
+/**
+ * Owns the thread that keeps every open AudioStream's queue topped up.
+ *
+ * Without pthreads (plain Emscripten builds) Update must be called once per frame instead.
+ * In the background the thread wakes less often; the queues hold enough audio that playback is unaffected.
+ */
+class AudioStreamer
+{
+public:
+    AudioStreamer();
+    ~AudioStreamer();
+
+    AudioStreamer(const AudioStreamer&)                = delete;
+    AudioStreamer& operator=(const AudioStreamer&)     = delete;
+    AudioStreamer(AudioStreamer&&) noexcept            = delete;
+    AudioStreamer& operator=(AudioStreamer&&) noexcept = delete;
+
+    std::shared_ptr<AudioStream> Open(const std::filesystem::path& ogg_path);
+    // Decodes straight out of `ogg_bytes` (e.g. an AssetPack view), which must outlive the stream
+    std::shared_ptr<AudioStream> Open(std::span<const unsigned char> ogg_bytes);
+    void                         Close(const std::shared_ptr<AudioStream>& stream);
+    void                         Update();
+    void                         Shutdown();
+    // Lengthens the refill period while nothing is on screen
+    void SetBackground(bool background);
+    // Leaves every queue as it is, for a lost device; sources the loss stopped restart on the first refill after
+    void SetSuspended(bool suspended);
+    // Every open stream's stats, in the order they were opened
+    void GetStats(std::vector<AudioStream::Stats>& out_stats) const;
+
+private:
+    void threadLoop();
+    void serviceAll();
+
+private:
+    mutable std::mutex                        mutex;
+    std::condition_variable                   wake;
+    std::vector<std::shared_ptr<AudioStream>> streams;
+    std::thread                               thread;
+    bool                                      is_stopping   = false;
+    bool                                      is_background = false;
+    bool                                      is_suspended  = false;
+};
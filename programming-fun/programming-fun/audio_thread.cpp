@@ -0,0 +1,337 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "audio_thread.h"
+
+#include "perf_counters.h"
+#include "profiler.h"
+#include "scheduling.h"
+
+#include <SDL.h>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#    define AUDIO_THREAD_THREADED 0
+#else
+#    define AUDIO_THREAD_THREADED 1
+#endif
+
+AudioThread::AudioThread() : queue{ std::make_unique<Queue>() }
+{
+}
+
+AudioThread::~AudioThread()
+{
+    Stop();
+}
+
+void AudioThread::Start(VoicePool& new_voices, AudioEffects& new_effects, SpatialAudio& new_spatial)
+{
+    Stop();
+    voices     = &new_voices;
+    effects    = &new_effects;
+    spatial    = &new_spatial;
+    last_drain = std::chrono::steady_clock::now();
+    {
+        std::lock_guard lock{ mutex };
+        stats            = {};
+        has_start_report = false;
+        is_flushed       = false;
+        is_stopping      = false;
+    }
+    is_running = true;
+#if AUDIO_THREAD_THREADED
+    thread = std::thread{ [this] { threadLoop(); } };
+#endif
+}
+
+void AudioThread::Stop()
+{
+    if (!is_running)
+        return;
+    {
+        std::lock_guard lock{ mutex };
+        is_stopping = true;
+    }
+    changed.notify_all();
+    if (thread.joinable())
+        thread.join();
+    // the thread is gone, so this one may touch the pool now
+    drain();
+    voice_tickets.clear();
+    emitter_tickets.clear();
+    watched_ticket = SoundTicket{};
+    watched_voice  = VoiceId{};
+    voices         = nullptr;
+    effects        = nullptr;
+    spatial        = nullptr;
+    is_running     = false;
+}
+
+bool AudioThread::IsRunning() const noexcept
+{
+    return is_running;
+}
+
+SoundTicket AudioThread::Play(ALuint buffer, const VoiceParams& params, int reverb_zone, bool report_start)
+{
+    AudioCommand command;
+    command.type         = AudioCommandType::Play;
+    command.buffer       = buffer;
+    command.voice        = params;
+    command.reverb_zone  = reverb_zone;
+    command.report_start = report_start;
+    return push(command);
+}
+
+void AudioThread::StopSound(SoundTicket sound)
+{
+    AudioCommand command;
+    command.type   = AudioCommandType::Stop;
+    command.ticket = sound;
+    push(command);
+}
+
+void AudioThread::SetGain(SoundTicket sound, float gain)
+{
+    AudioCommand command;
+    command.type   = AudioCommandType::SetGain;
+    command.ticket = sound;
+    command.gain   = gain;
+    push(command);
+}
+
+void AudioThread::SetPosition(SoundTicket sound, const glm::vec3& position)
+{
+    AudioCommand command;
+    command.type     = AudioCommandType::SetPosition;
+    command.ticket   = sound;
+    command.position = position;
+    push(command);
+}
+
+SoundTicket AudioThread::AddEmitter(ALuint buffer, const glm::vec3& position, const EmitterParams& params)
+{
+    AudioCommand command;
+    command.type     = AudioCommandType::AddEmitter;
+    command.buffer   = buffer;
+    command.emitter  = params;
+    command.position = position;
+    return push(command);
+}
+
+void AudioThread::RemoveEmitter(SoundTicket emitter)
+{
+    AudioCommand command;
+    command.type   = AudioCommandType::RemoveEmitter;
+    command.ticket = emitter;
+    push(command);
+}
+
+void AudioThread::MoveEmitter(SoundTicket emitter, const glm::vec3& position)
+{
+    AudioCommand command;
+    command.type     = AudioCommandType::MoveEmitter;
+    command.ticket   = emitter;
+    command.position = position;
+    push(command);
+}
+
+void AudioThread::OccludeEmitter(SoundTicket emitter, float occlusion)
+{
+    AudioCommand command;
+    command.type   = AudioCommandType::OccludeEmitter;
+    command.ticket = emitter;
+    command.gain   = occlusion;
+    push(command);
+}
+
+void AudioThread::SetListener(const glm::vec3& position, const glm::vec3& forward, const glm::vec3& up)
+{
+    AudioCommand command;
+    command.type     = AudioCommandType::SetListener;
+    command.position = position;
+    command.forward  = forward;
+    command.up       = up;
+    push(command);
+}
+
+void AudioThread::Flush()
+{
+    if (!is_running)
+        return;
+#if AUDIO_THREAD_THREADED
+    {
+        std::lock_guard lock{ mutex };
+        is_flushed = true;
+    }
+    changed.notify_one();
+#else
+    drain();
+#endif
+}
+
+bool AudioThread::TakeStartReport(StartReport& out_report)
+{
+    std::lock_guard lock{ mutex };
+    if (!has_start_report)
+        return false;
+    out_report       = start_report;
+    has_start_report = false;
+    return true;
+}
+
+AudioThread::Stats AudioThread::GetStats() const
+{
+    Stats result;
+    {
+        std::lock_guard lock{ mutex };
+        result = stats;
+    }
+    result.dropped = dropped;
+    return result;
+}
+
+SoundTicket AudioThread::push(AudioCommand& command)
+{
+    // Play and AddEmitter name what they start; the others carry the ticket they act on
+    if (command.type == AudioCommandType::Play || command.type == AudioCommandType::AddEmitter)
+    {
+        if (++next_ticket == 0)
+            next_ticket = 1;
+        command.ticket = SoundTicket{ next_ticket };
+    }
+    if (!queue->TryPush(command))
+    {
+        ++dropped;
+        return SoundTicket{};
+    }
+    return command.ticket;
+}
+
+void AudioThread::threadLoop()
+{
+    profiler::SetThreadName("audio");
+    scheduling::SetThreadRole(scheduling::ThreadRole::Audio);
+    std::unique_lock lock{ mutex };
+    while (!is_stopping)
+    {
+        // a frame's commands, or a reclaim tick while the producer is idle or hidden
+        changed.wait_for(lock, IDLE_PERIOD, [this] { return is_flushed || is_stopping; });
+        is_flushed = false;
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void AudioThread::drain()
+{
+    PROFILE_TRACE_ZONE("Audio Commands");
+    static const perf_counters::Handle commands      = perf_counters::Register("audio commands", perf_counters::Kind::Counter);
+    static const perf_counters::Handle voices_active = perf_counters::Register("voices active", perf_counters::Kind::Gauge, perf_counters::InHud | perf_counters::InTelemetry);
+
+    const auto  begin         = std::chrono::steady_clock::now();
+    const float delta_seconds = std::chrono::duration<float>(begin - last_drain).count();
+    last_drain                = begin;
+
+    AudioCommand        command;
+    const std::uint64_t applied_before = applied;
+    while (queue->TryPop(command))
+    {
+        apply(command);
+        ++applied;
+    }
+    perf_counters::Add(commands, static_cast<long long>(applied - applied_before));
+    voices->Update(delta_seconds);
+    spatial->Update(*voices, delta_seconds);
+    watchStart();
+    std::erase_if(voice_tickets, [this](const auto& entry) { return !voices->IsCurrent(entry.second); });
+    if (spatial->GetStats().finished > 0)
+        std::erase_if(emitter_tickets, [this](const auto& entry) { return !spatial->IsAlive(entry.second); });
+
+    std::lock_guard lock{ mutex };
+    stats.voices_in_use     = voices->VoicesInUse();
+    stats.voice_capacity    = voices->Capacity();
+    stats.steals_per_second = voices->StealsPerSecond();
+    stats.active_sends      = voices->ActiveSends();
+    stats.effects           = effects->GetStats();
+    stats.spatial           = spatial->GetStats();
+    stats.commands          = applied;
+    stats.drain_ms          = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    stats.busy_ms += stats.drain_ms;
+    perf_counters::Set(voices_active, stats.voices_in_use);
+}
+
+void AudioThread::apply(const AudioCommand& command)
+{
+    const auto voice   = voice_tickets.find(command.ticket.value);
+    const auto emitter = emitter_tickets.find(command.ticket.value);
+    switch (command.type)
+    {
+        case AudioCommandType::Play:
+        {
+            VoiceParams params   = command.voice;
+            params.effect_slot   = effects->SlotFor(command.reverb_zone, *voices);
+            const VoiceId played = voices->Play(command.buffer, params);
+            if (played.IsValid())
+                voice_tickets[command.ticket.value] = played;
+            if (command.report_start)
+            {
+                watched_ticket = command.ticket;
+                watched_voice  = played;
+            }
+            break;
+        }
+        case AudioCommandType::Stop:
+            if (voice != voice_tickets.end())
+            {
+                voices->Stop(voice->second);
+                voice_tickets.erase(voice);
+            }
+            break;
+        case AudioCommandType::SetGain:
+            if (voice != voice_tickets.end())
+                voices->SetGain(voice->second, command.gain);
+            break;
+        case AudioCommandType::SetPosition:
+            if (voice != voice_tickets.end())
+                voices->Place(voice->second, command.position);
+            break;
+        case AudioCommandType::AddEmitter: emitter_tickets[command.ticket.value] = spatial->Add(command.buffer, command.position, command.emitter); break;
+        case AudioCommandType::RemoveEmitter:
+            if (emitter != emitter_tickets.end())
+            {
+                spatial->Remove(emitter->second, *voices);
+                emitter_tickets.erase(emitter);
+            }
+            break;
+        case AudioCommandType::MoveEmitter:
+            if (emitter != emitter_tickets.end())
+                spatial->SetPosition(emitter->second, command.position);
+            break;
+        case AudioCommandType::OccludeEmitter:
+            if (emitter != emitter_tickets.end())
+                spatial->SetOcclusion(emitter->second, command.gain);
+            break;
+        case AudioCommandType::SetListener: spatial->SetListener(command.position, command.forward, command.up); break;
+    }
+}
+
+void AudioThread::watchStart()
+{
+    if (!watched_ticket.IsValid())
+        return;
+    // an invalid voice, a dropped play, reports at once so the producer stops waiting
+    const float played = watched_voice.IsValid() ? voices->PlaybackSeconds(watched_voice) : -1.0f;
+    if (played == 0.0f)
+        return;
+    std::lock_guard lock{ mutex };
+    start_report     = StartReport{ watched_ticket, SDL_GetPerformanceCounter(), played };
+    has_start_report = true;
+    watched_ticket   = SoundTicket{};
+    watched_voice    = VoiceId{};
+}
@@ -0,0 +1,171 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "audio_effects.h"
+#include "spatial_audio.h"
+#include "spsc_queue.h"
+#include "voice_pool.h"
+
+#include <al.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Names a playback or an emitter on the producer's side; the audio thread keeps what it maps to
+struct SoundTicket
+{
+    std::uint32_t value = 0; // 0 is never issued
+
+    bool IsValid() const noexcept
+    {
+        return value != 0;
+    }
+};
+
+enum class AudioCommandType
+{
+    Play,
+    Stop,
+    SetGain,
+    SetPosition,
+    AddEmitter,
+    RemoveEmitter,
+    MoveEmitter,
+    OccludeEmitter,
+    SetListener
+};
+
+// Plain data, copied through the queue; each type reads only the fields it names
+struct AudioCommand
+{
+    AudioCommandType type = AudioCommandType::Play;
+    SoundTicket      ticket;
+    ALuint           buffer       = 0;     // Play, AddEmitter
+    VoiceParams      voice;                // Play; the slot comes from `reverb_zone`
+    EmitterParams    emitter;              // AddEmitter
+    int              reverb_zone  = -1;    // Play, an AudioEffects zone
+    float            gain         = 1.0f;  // SetGain, and OccludeEmitter's occlusion
+    bool             report_start = false; // Play, see TakeStartReport
+    glm::vec3        position{ 0.0f };     // SetPosition, AddEmitter, MoveEmitter, SetListener
+    glm::vec3        forward{ 0.0f, 0.0f, -1.0f };
+    glm::vec3        up{ 0.0f, 1.0f, 0.0f };
+};
+
+/**
+ * The thread that makes the voice, effect and spatial AL calls, fed through a lock-free command queue.
+ *
+ * Start hands a set up VoicePool, AudioEffects and SpatialAudio over; until Stop only this thread calls
+ * them. Gameplay and UI code on one producer thread (the main thread) push commands, each a copy into an
+ * SpscQueue, and Flush once a frame wakes the thread to drain them all, update the voices and the spatial
+ * batch, and publish a Stats snapshot. With nothing flushed it still wakes every IDLE_PERIOD to reclaim
+ * finished voices. A producer never waits on AL: a push only fails, dropping the command, when the queue
+ * is full. SoundCache uploads stay on the thread that owns the cache. Without pthreads (plain Emscripten
+ * builds) there is no thread and Flush drains inline.
+ */
+class AudioThread
+{
+public:
+    static constexpr std::size_t QUEUE_CAPACITY = 8192; // room for a move per emitter each frame, thousands of them
+    static constexpr auto        IDLE_PERIOD    = std::chrono::milliseconds{ 20 };
+
+    struct Stats
+    {
+        int                 voices_in_use     = 0;
+        int                 voice_capacity    = 0;
+        int                 steals_per_second = 0;
+        int                 active_sends      = 0;
+        AudioEffects::Stats effects;
+        SpatialAudio::Stats spatial;
+        std::uint64_t       commands = 0;   // applied since Start
+        std::uint64_t       dropped  = 0;   // pushed into a full queue
+        double              drain_ms = 0.0; // the last drain, commands and updates
+        double              busy_ms  = 0.0; // every drain since Start, for the thread's load over a stretch of time
+    };
+
+    // When the mixer first moved a playback pushed with `report_start`
+    struct StartReport
+    {
+        SoundTicket   ticket;
+        std::uint64_t observed       = 0;    // SDL_GetPerformanceCounter as the audio thread saw it
+        float         played_seconds = 0.0f; // how far in it was by then; negative if it never started
+    };
+
+    AudioThread();
+    ~AudioThread();
+
+    AudioThread(const AudioThread&)                = delete;
+    AudioThread& operator=(const AudioThread&)     = delete;
+    AudioThread(AudioThread&&) noexcept            = delete;
+    AudioThread& operator=(AudioThread&&) noexcept = delete;
+
+    // All three set up and outliving the thread; the caller must leave them alone until Stop
+    void Start(VoicePool& voices, AudioEffects& effects, SpatialAudio& spatial);
+    // Applies what is still queued and joins; the three are the caller's again
+    void Stop();
+    bool IsRunning() const noexcept;
+
+    // Producer side; an invalid ticket when the queue was full
+    SoundTicket Play(ALuint buffer, const VoiceParams& params = {}, int reverb_zone = -1, bool report_start = false);
+    void        StopSound(SoundTicket sound);
+    void        SetGain(SoundTicket sound, float gain);
+    void        SetPosition(SoundTicket sound, const glm::vec3& position);
+    SoundTicket AddEmitter(ALuint buffer, const glm::vec3& position, const EmitterParams& params = {});
+    void        RemoveEmitter(SoundTicket emitter);
+    void        MoveEmitter(SoundTicket emitter, const glm::vec3& position);
+    // 0 clear to 1 fully occluded, see SpatialAudio::SetOcclusion
+    void        OccludeEmitter(SoundTicket emitter, float occlusion);
+    void        SetListener(const glm::vec3& position, const glm::vec3& forward, const glm::vec3& up);
+    // Once a frame, after the frame's commands
+    void        Flush();
+
+    // The latest report, once; false when there is none new
+    bool  TakeStartReport(StartReport& out_report);
+    Stats GetStats() const;
+
+private:
+    using Queue = SpscQueue<AudioCommand, QUEUE_CAPACITY>;
+
+    SoundTicket push(AudioCommand& command);
+    void        threadLoop();
+    void        drain();
+    void        apply(const AudioCommand& command);
+    void        watchStart();
+
+private:
+    std::unique_ptr<Queue> queue;           // on the heap, it's over a megabyte
+    std::uint32_t          next_ticket = 0; // producer side
+    std::uint64_t          dropped     = 0; // producer side
+
+    // the audio thread's, between Start and Stop
+    VoicePool*                                   voices  = nullptr;
+    AudioEffects*                                effects = nullptr;
+    SpatialAudio*                                spatial = nullptr;
+    std::unordered_map<std::uint32_t, VoiceId>   voice_tickets;
+    std::unordered_map<std::uint32_t, EmitterId> emitter_tickets;
+    SoundTicket                                  watched_ticket;
+    VoiceId                                      watched_voice;
+    std::chrono::steady_clock::time_point        last_drain;
+    std::uint64_t                                applied = 0;
+
+    std::thread             thread;
+    mutable std::mutex      mutex;
+    std::condition_variable changed;
+    Stats                   stats;
+    StartReport             start_report;
+    bool                    has_start_report = false;
+    bool                    is_flushed       = false;
+    bool                    is_stopping      = false;
+    bool                    is_running       = false;
+};
@@ -0,0 +1,132 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "batch_render.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+bool BatchRender::Open(const BatchSettings& new_settings)
+{
+    settings = new_settings;
+    jobs.clear();
+    std::ifstream list{ settings.list };
+    if (!list)
+    {
+        std::cerr << "Failed to open the batch list " << settings.list << '\n';
+        return false;
+    }
+    std::string line;
+    while (std::getline(list, line))
+    {
+        std::istringstream fields{ line };
+        std::string        scene;
+        std::string        image;
+        if (!(fields >> scene) || scene.starts_with('#'))
+            continue;
+        // without a name the scene's own, so a list of thumbnails needs no second column
+        if (!(fields >> image))
+            image = std::filesystem::path{ scene }.stem().string() + ".png";
+        jobs.push_back(Job{ scene, settings.output / image });
+    }
+    if (jobs.empty())
+    {
+        std::cerr << "No scenes in the batch list " << settings.list << '\n';
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(settings.output, error);
+    if (error)
+    {
+        std::cerr << "Failed to make the batch output directory " << settings.output << ": " << error.message() << '\n';
+        return false;
+    }
+    current = 0;
+    step    = Step::Load;
+    settled = 0;
+    skipped = 0;
+    return true;
+}
+
+BatchRender::Step BatchRender::Advance(bool loading, bool can_capture, bool writing, double since_start_ms)
+{
+    if (start_ms < 0.0)
+        start_ms = since_start_ms;
+    switch (step)
+    {
+        case Step::Load:
+            // the frame the scene loads in; its assets count as pending from the next one on
+            step = Step::Wait;
+            return Step::Load;
+        case Step::Wait:
+            if (loading)
+                return step;
+            step    = Step::Draw;
+            settled = 0;
+            [[fallthrough]];
+        case Step::Draw:
+            if (settled < settings.settle_frames)
+            {
+                ++settled;
+                return step;
+            }
+            // every slot still waits on the GPU or the workers; one more frame of the same scene costs less than a stall
+            if (!can_capture)
+                return step;
+            return step = Step::Capture;
+        case Step::Capture:
+            if (++current < jobs.size())
+            {
+                step = Step::Wait;
+                return Step::Load;
+            }
+            step = Step::Finish;
+            [[fallthrough]];
+        case Step::Finish:
+            if (writing)
+                return step;
+            finish_ms = since_start_ms;
+            step      = Step::Done;
+            return step;
+        case Step::Done: break;
+    }
+    return step;
+}
+
+void BatchRender::Skip()
+{
+    ++skipped;
+    step = ++current < jobs.size() ? Step::Load : Step::Finish;
+}
+
+const BatchRender::Job& BatchRender::Current() const
+{
+    return jobs[current < jobs.size() ? current : jobs.size() - 1];
+}
+
+const BatchSettings& BatchRender::Settings() const noexcept
+{
+    return settings;
+}
+
+std::size_t BatchRender::JobCount() const noexcept
+{
+    return jobs.size();
+}
+
+void BatchRender::Print(std::ostream& out) const
+{
+    const std::size_t images  = jobs.size() - static_cast<std::size_t>(skipped);
+    const double      seconds = (finish_ms - start_ms) / 1000.0;
+    out << "Batch: " << images << " images in " << settings.output << ", " << skipped << " scenes skipped, " << seconds << " s";
+    if (seconds > 0.0)
+        out << ", " << static_cast<double>(images) / seconds << " images/s";
+    out << '\n';
+}
@@ -0,0 +1,76 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <iosfwd>
+#include <vector>
+
+struct BatchSettings
+{
+    std::filesystem::path list;                    // one scene file a line, optionally followed by the image's file name
+    std::filesystem::path output        = "batch"; // the directory the images go to, made when missing
+    int                   settle_frames = 1;       // drawn once a scene's loads have landed and before the captured one
+};
+
+/**
+ * A queue of scenes rendered to PNGs as fast as the GPU and the workers go, for thumbnails and report images.
+ *
+ * Like BenchmarkRun, the caller does the scripting on a hidden window with uncapped pacing and feeds this one
+ * frame at a time. Advance says what the frame does: load the next scene, wait for its assets, draw it, or
+ * capture it. A capture reads the offscreen scene target into FrameCapture's ring of pixel pack buffers, so
+ * the next scene loads and draws while the GPU copies and the workers encode the previous ones. Captures are
+ * never dropped: while every slot is taken Advance keeps the frame drawing without one. Finishing waits until
+ * the last image is written.
+ */
+class BatchRender
+{
+public:
+    enum class Step
+    {
+        Load,    // the Current scene, this frame
+        Wait,    // for its assets
+        Draw,    // settling, or waiting for a free capture slot
+        Capture, // this frame, to Current().image
+        Finish,  // every image captured; waiting for the last encodes
+        Done
+    };
+
+    struct Job
+    {
+        std::filesystem::path scene;
+        std::filesystem::path image; // under the output directory
+    };
+
+    // Reads the list and makes the output directory; false, printed, when either fails or the list is empty
+    bool Open(const BatchSettings& new_settings);
+
+    // Once a frame, before recording it. `loading` while any asset is pending, `can_capture` while a capture
+    // slot is free, `writing` while captures are still being read back or encoded; `since_start_ms` for the report
+    Step Advance(bool loading, bool can_capture, bool writing, double since_start_ms);
+    // The caller couldn't load the Current scene; it is skipped and counted
+    void Skip();
+
+    const Job&           Current() const;
+    const BatchSettings& Settings() const noexcept;
+    std::size_t          JobCount() const noexcept;
+
+    // images, skipped scenes, seconds and images per second
+    void Print(std::ostream& out) const;
+
+private:
+    BatchSettings    settings;
+    std::vector<Job> jobs;
+    std::size_t      current   = 0;
+    Step             step      = Step::Load;
+    int              settled   = 0;
+    int              skipped   = 0;
+    double           start_ms  = -1.0; // the first Advance
+    double           finish_ms = 0.0;
+};
@@ -0,0 +1,197 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "benchmark.h"
+
+#include "logger.h"
+#include "memory_tracker.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+namespace
+{
+    struct Summary
+    {
+        double mean = 0.0;
+        double min  = 0.0;
+        double p50  = 0.0;
+        double p95  = 0.0;
+        double p99  = 0.0;
+        double max  = 0.0;
+    };
+
+    // nearest rank on a sorted copy; a thousand doubles sort in no time
+    Summary summarize(std::vector<double> samples)
+    {
+        Summary summary;
+        if (samples.empty())
+            return summary;
+        std::sort(samples.begin(), samples.end());
+        const auto rank = [&samples](double percentile)
+        {
+            const auto index = static_cast<std::size_t>(percentile / 100.0 * static_cast<double>(samples.size()) + 0.5);
+            return samples[std::clamp<std::size_t>(index, 1, samples.size()) - 1];
+        };
+        summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+        summary.min  = samples.front();
+        summary.p50  = rank(50.0);
+        summary.p95  = rank(95.0);
+        summary.p99  = rank(99.0);
+        summary.max  = samples.back();
+        return summary;
+    }
+
+    void write_json_summary(std::ostream& out, const char* name, const std::vector<double>& samples)
+    {
+        out << "  \"" << name << "\": ";
+        if (samples.empty())
+        {
+            out << "null,\n";
+            return;
+        }
+        const Summary s = summarize(samples);
+        out << "{ \"samples\": " << samples.size() << ", \"mean\": " << s.mean << ", \"min\": " << s.min << ", \"p50\": " << s.p50 << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99
+            << ", \"max\": " << s.max << " },\n";
+    }
+
+    // every sample in recording order, for benchmark-compare's rank tests
+    void write_json_samples(std::ostream& out, const char* name, const std::vector<double>& samples)
+    {
+        out << "  \"" << name << "_samples\": [";
+        for (std::size_t i = 0; i < samples.size(); ++i)
+            out << (i == 0 ? " " : ", ") << samples[i];
+        out << " ],\n";
+    }
+
+    void write_csv_summary(std::ostream& out, const char* name, const std::vector<double>& samples)
+    {
+        if (samples.empty())
+            return;
+        const Summary s = summarize(samples);
+        out << name << "_mean," << s.mean << '\n';
+        out << name << "_min," << s.min << '\n';
+        out << name << "_p50," << s.p50 << '\n';
+        out << name << "_p95," << s.p95 << '\n';
+        out << name << "_p99," << s.p99 << '\n';
+        out << name << "_max," << s.max << '\n';
+    }
+}
+
+BenchmarkRun::BenchmarkRun(const BenchmarkSettings& new_settings) : settings{ new_settings }
+{
+    frame_ms.reserve(static_cast<std::size_t>(settings.frames));
+    cpu_ms.reserve(static_cast<std::size_t>(settings.frames));
+    gpu_ms.reserve(static_cast<std::size_t>(settings.frames));
+}
+
+BenchmarkRun::Phase BenchmarkRun::Advance(bool loading, double since_start_ms)
+{
+    switch (phase)
+    {
+        case Phase::Loading:
+            if (!loading)
+            {
+                load_ms = since_start_ms;
+                phase   = Phase::Warmup;
+            }
+            break;
+        case Phase::Warmup:
+            if (++warmup_frames > settings.warmup_frames)
+                phase = Phase::Measuring;
+            break;
+        case Phase::Measuring:
+        case Phase::Done: break;
+    }
+    return phase;
+}
+
+void BenchmarkRun::Record(double new_frame_ms, double new_cpu_ms, double new_gpu_ms)
+{
+    if (phase != Phase::Measuring)
+        return;
+    frame_ms.push_back(new_frame_ms);
+    cpu_ms.push_back(new_cpu_ms);
+    if (new_gpu_ms >= 0.0)
+        gpu_ms.push_back(new_gpu_ms);
+    if (static_cast<int>(frame_ms.size()) >= settings.frames)
+        phase = Phase::Done;
+}
+
+BenchmarkRun::Phase BenchmarkRun::GetPhase() const noexcept
+{
+    return phase;
+}
+
+const BenchmarkSettings& BenchmarkRun::Settings() const noexcept
+{
+    return settings;
+}
+
+bool BenchmarkRun::WriteReport(bool render_thread) const
+{
+    std::ofstream out{ settings.report };
+    if (!out)
+    {
+        LOG_ERROR("Failed to write benchmark report ", settings.report);
+        return false;
+    }
+    constexpr auto CATEGORY_COUNT = static_cast<std::size_t>(MemoryCategory::Count);
+    if (settings.report.extension() == ".csv")
+    {
+        out << "metric,value\n";
+        out << "frames," << frame_ms.size() << '\n';
+        out << "sprites," << settings.sprites << '\n';
+        out << "markers," << settings.markers << '\n';
+        out << "render_thread," << (render_thread ? 1 : 0) << '\n';
+        out << "load_ms," << load_ms << '\n';
+        write_csv_summary(out, "frame_ms", frame_ms);
+        write_csv_summary(out, "cpu_ms", cpu_ms);
+        write_csv_summary(out, "gpu_ms", gpu_ms);
+        for (std::size_t i = 0; i < CATEGORY_COUNT; ++i)
+        {
+            const auto category = static_cast<MemoryCategory>(i);
+            out << "peak_bytes_" << memory_tracker::CategoryName(category) << ',' << memory_tracker::GetStats(category).peak_bytes << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    out << "{\n";
+    out << "  \"frames\": " << frame_ms.size() << ",\n";
+    out << "  \"warmup_frames\": " << settings.warmup_frames << ",\n";
+    out << "  \"sprites\": " << settings.sprites << ",\n";
+    out << "  \"markers\": " << settings.markers << ",\n";
+    out << "  \"render_thread\": " << (render_thread ? "true" : "false") << ",\n";
+    out << "  \"load_ms\": " << load_ms << ",\n";
+    write_json_summary(out, "frame_ms", frame_ms);
+    write_json_summary(out, "cpu_ms", cpu_ms);
+    write_json_summary(out, "gpu_ms", gpu_ms);
+    write_json_samples(out, "frame_ms", frame_ms);
+    write_json_samples(out, "cpu_ms", cpu_ms);
+    write_json_samples(out, "gpu_ms", gpu_ms);
+    out << "  \"peak_bytes\": {";
+    for (std::size_t i = 0; i < CATEGORY_COUNT; ++i)
+    {
+        const auto category = static_cast<MemoryCategory>(i);
+        out << (i == 0 ? " " : ", ") << '"' << memory_tracker::CategoryName(category) << "\": " << memory_tracker::GetStats(category).peak_bytes;
+    }
+    out << " }\n}\n";
+    return static_cast<bool>(out);
+}
+
+bool BenchmarkRun::ParseCount(const char* text, int& out_count)
+{
+    int        value = 0;
+    const auto end   = text + std::strlen(text);
+    if (const auto [ptr, error] = std::from_chars(text, end, value); error != std::errc{} || ptr != end || value <= 0)
+        return false;
+    out_count = value;
+    return true;
+}
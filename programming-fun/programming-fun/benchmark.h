@@ -0,0 +1,65 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+struct BenchmarkSettings
+{
+    int                   frames        = 1000; // measured
+    int                   warmup_frames = 120;  // run after loading and before measuring
+    int                   sprites       = 20'000;
+    int                   markers       = 5'000;
+    std::filesystem::path report        = "benchmark.json"; // a ".csv" extension writes CSV instead
+};
+
+/**
+ * One scripted run of the frame loop: wait for loads, warm up, then record a fixed number of frames.
+ *
+ * The caller feeds it one frame at a time and does the scripting (scene load, fixed time step,
+ * uncapped pacing); this only tracks the phase and the samples and writes the report: percentiles
+ * of whole frame, CPU and GPU times, how long loading took, and the memory tracker's peaks.
+ * GPU samples exist only where the GPU timer runs, i.e. not with the render thread.
+ */
+class BenchmarkRun
+{
+public:
+    enum class Phase
+    {
+        Loading,
+        Warmup,
+        Measuring,
+        Done
+    };
+
+    explicit BenchmarkRun(const BenchmarkSettings& settings);
+
+    // Call once per frame before recording it; `loading` while any asset is still pending
+    Phase Advance(bool loading, double since_start_ms);
+    // `gpu_ms` < 0 when no new GPU result arrived this frame
+    void  Record(double frame_ms, double cpu_ms, double gpu_ms);
+
+    Phase                    GetPhase() const noexcept;
+    const BenchmarkSettings& Settings() const noexcept;
+
+    // JSON or CSV by the report's extension; false (and logged) if it can't be written
+    bool WriteReport(bool render_thread) const;
+
+    // "--benchmark-frames N" style values; false when `text` isn't a positive count
+    static bool ParseCount(const char* text, int& out_count);
+
+private:
+    BenchmarkSettings   settings;
+    Phase               phase         = Phase::Loading;
+    double              load_ms       = 0.0;
+    int                 warmup_frames = 0;
+    std::vector<double> frame_ms;
+    std::vector<double> cpu_ms;
+    std::vector<double> gpu_ms;
+};
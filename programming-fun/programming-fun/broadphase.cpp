@@ -0,0 +1,143 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "broadphase.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    // shifts per box past which sorting from scratch is cheaper than carrying on
+    constexpr std::size_t SHIFT_BUDGET = 8;
+
+    double ms_since(Uint64 started) noexcept
+    {
+        return static_cast<double>(SDL_GetPerformanceCounter() - started) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+}
+
+void SweepAndPrune::Update(std::span<const Aabb2> boxes, std::pmr::vector<OverlapPair>& pairs)
+{
+    pairs.clear();
+    // about as many as last time, so the arena isn't left holding every size the vector grew through
+    pairs.reserve(static_cast<std::size_t>(stats.pairs) + static_cast<std::size_t>(stats.pairs) / 4);
+    stats          = Stats{};
+    stats.boxes    = static_cast<int>(boxes.size());
+    Uint64 started = SDL_GetPerformanceCounter();
+    // with no order to start from, the insertion sort would only use up its budget
+    const bool is_fresh = ids.empty();
+    load(boxes);
+    if (is_fresh || !insertionSort())
+        fullSort();
+    // the rest of the columns follow the order min_x settled in
+    const std::size_t count = ids.size();
+    max_x.resize(count);
+    min_y.resize(count);
+    max_y.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Aabb2& box = boxes[ids[i]];
+        max_x[i]         = box.max.x;
+        min_y[i]         = box.min.y;
+        max_y[i]         = box.max.y;
+    }
+    stats.sort_ms = ms_since(started);
+
+    started = SDL_GetPerformanceCounter();
+    hits.resize(count);
+    for (std::size_t i = 0; i + 1 < count; ++i)
+    {
+        const Aabb2       box{ glm::vec2{ min_x[i], min_y[i] }, glm::vec2{ max_x[i], max_y[i] } };
+        const std::size_t next  = i + 1;
+        std::size_t       swept = 0;
+        const std::size_t found = math_kernels::SweepOverlaps(min_x.data() + next, min_y.data() + next, max_y.data() + next, count - next, box, hits.data(), swept);
+        stats.swept += static_cast<std::int64_t>(swept);
+        for (std::size_t k = 0; k < found; ++k)
+        {
+            const std::uint32_t other = ids[next + hits[k]];
+            pairs.push_back(OverlapPair{ std::min(ids[i], other), std::max(ids[i], other) });
+        }
+    }
+    stats.pairs    = static_cast<int>(pairs.size());
+    stats.sweep_ms = ms_since(started);
+}
+
+void SweepAndPrune::Reset() noexcept
+{
+    ids.clear();
+    min_x.clear();
+}
+
+SweepAndPrune::Stats SweepAndPrune::GetStats() const noexcept
+{
+    return stats;
+}
+
+void SweepAndPrune::load(std::span<const Aabb2> boxes)
+{
+    const auto count = static_cast<std::uint32_t>(boxes.size());
+    if (ids.size() != count)
+    {
+        const auto known = static_cast<std::uint32_t>(std::min<std::size_t>(ids.size(), count));
+        std::erase_if(ids, [count](std::uint32_t id) { return id >= count; });
+        for (std::uint32_t id = known; id < count; ++id)
+            ids.push_back(id);
+    }
+    min_x.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+        min_x[i] = boxes[ids[i]].min.x;
+}
+
+bool SweepAndPrune::insertionSort()
+{
+    const std::size_t count  = ids.size();
+    const std::size_t budget = count * SHIFT_BUDGET;
+    std::size_t       shifts = 0;
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        const float key = min_x[i];
+        if (min_x[i - 1] <= key)
+            continue;
+        const std::uint32_t id = ids[i];
+        std::size_t         j  = i;
+        for (; j > 0 && min_x[j - 1] > key; --j)
+        {
+            min_x[j] = min_x[j - 1];
+            ids[j]   = ids[j - 1];
+        }
+        min_x[j] = key;
+        ids[j]   = id;
+        shifts += i - j;
+        if (shifts > budget)
+        {
+            stats.shifts = static_cast<int>(shifts);
+            return false;
+        }
+    }
+    stats.shifts = static_cast<int>(shifts);
+    return true;
+}
+
+void SweepAndPrune::fullSort()
+{
+    // stable, so equal edges keep the order they had, as the insertion sort would
+    std::vector<std::uint32_t> order(ids.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) { return min_x[a] < min_x[b]; });
+    std::vector<std::uint32_t> sorted_ids(ids.size());
+    std::vector<float>         sorted_min_x(ids.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        sorted_ids[i]   = ids[order[i]];
+        sorted_min_x[i] = min_x[order[i]];
+    }
+    ids            = std::move(sorted_ids);
+    min_x          = std::move(sorted_min_x);
+    stats.resorted = true;
+}
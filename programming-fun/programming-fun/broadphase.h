@@ -0,0 +1,76 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "math_kernels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+// Two boxes that overlap, by their index in what was passed to Update; `first` is the smaller
+struct OverlapPair
+{
+    std::uint32_t first  = 0;
+    std::uint32_t second = 0;
+};
+
+/**
+ * Every pair among many moving boxes that overlaps, by sort and sweep on x.
+ *
+ * The boxes are kept as columns sorted by their left edge, min_x and the rest each in its own array. Update
+ * reloads the bounds in the order the previous Update left and fixes that order with an insertion sort:
+ * things that moved a little since the last frame only trade places with a few neighbours, so it costs close
+ * to one pass instead of a sort's n log n. When it has shifted boxes more than a few places each on average,
+ * say after a teleport or many new boxes at once, it gives up and sorts from scratch.
+ *
+ * The sweep then takes each box against those after it until one starts past its right edge; their x spans
+ * overlap by construction, and math_kernels::SweepOverlaps tests the y spans four boxes at a time. The pairs
+ * go into whatever vector the caller passes, normally one on the frame's arena, so a frame's worth costs no
+ * heap. Box indices are the ids: index i should stay the same thing between Updates for the order to help.
+ * One thread at a time.
+ */
+class SweepAndPrune
+{
+public:
+    struct Stats
+    {
+        int          boxes    = 0;
+        int          pairs    = 0;
+        int          shifts   = 0;     // places the insertion sort moved boxes by
+        bool         resorted = false; // sorted from scratch rather than fixed up
+        std::int64_t swept    = 0;     // boxes tested against another
+        double       sort_ms  = 0.0;
+        double       sweep_ms = 0.0;
+    };
+
+    // Replaces what `pairs` held with every overlapping pair among `boxes`
+    void  Update(std::span<const Aabb2> boxes, std::pmr::vector<OverlapPair>& pairs);
+    // Forgets the order, so the next Update sorts from scratch
+    void  Reset() noexcept;
+    Stats GetStats() const noexcept;
+
+private:
+    // ids kept in the last order, those past `boxes` dropped and the new ones after; min_x from `boxes`
+    void load(std::span<const Aabb2> boxes);
+    // false, with the order still valid but unsorted, once it has shifted past its budget
+    bool insertionSort();
+    void fullSort();
+
+private:
+    // sorted by min_x, all the same length
+    std::vector<std::uint32_t> ids;
+    std::vector<float>         min_x;
+    std::vector<float>         max_x;
+    std::vector<float>         min_y;
+    std::vector<float>         max_y;
+    std::vector<std::uint32_t> hits; // SweepOverlaps' output for one box
+    Stats                      stats;
+};
@@ -0,0 +1,159 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "broadphase_benchmark.h"
+
+#include "broadphase.h"
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <random>
+
+namespace
+{
+    constexpr float STEP_SECONDS = 1.0f / 60.0f;
+    // world per box, so 10k and 100k are equally crowded; a box is 6 to 16 pixels across
+    constexpr float AREA_PER_BOX = 400.0f;
+
+    struct Mover
+    {
+        glm::vec2 position{ 0.0f };
+        glm::vec2 velocity{ 0.0f };
+        glm::vec2 half_extent{ 0.0f };
+    };
+
+    // the same start for every run
+    std::vector<Mover> make_movers(std::size_t count, const glm::vec2& world)
+    {
+        std::mt19937                          random{ 2024 };
+        std::uniform_real_distribution<float> along_x{ 0.0f, world.x };
+        std::uniform_real_distribution<float> along_y{ 0.0f, world.y };
+        std::uniform_real_distribution<float> speed{ -200.0f, 200.0f };
+        std::uniform_real_distribution<float> half_extent{ 3.0f, 8.0f };
+        std::vector<Mover>                    movers(count);
+        for (Mover& mover : movers)
+        {
+            mover.position    = glm::vec2{ along_x(random), along_y(random) };
+            mover.velocity    = glm::vec2{ speed(random), speed(random) };
+            mover.half_extent = glm::vec2{ half_extent(random), half_extent(random) };
+        }
+        return movers;
+    }
+
+    // the ducks' step, turning around at the world's edges
+    void step(std::vector<Mover>& movers, std::vector<Aabb2>& boxes, const glm::vec2& world)
+    {
+        for (std::size_t i = 0; i < movers.size(); ++i)
+        {
+            Mover& mover = movers[i];
+            mover.position += mover.velocity * STEP_SECONDS;
+            if (mover.position.x < 0.0f || mover.position.x > world.x)
+                mover.velocity.x = -mover.velocity.x;
+            if (mover.position.y < 0.0f || mover.position.y > world.y)
+                mover.velocity.y = -mover.velocity.y;
+            boxes[i] = Aabb2{ mover.position - mover.half_extent, mover.position + mover.half_extent };
+        }
+    }
+
+    // adds up the same whatever order the pairs come in
+    std::uint64_t hash_pairs(const std::pmr::vector<OverlapPair>& pairs)
+    {
+        std::uint64_t sum = 0;
+        for (const OverlapPair& pair : pairs)
+        {
+            std::uint64_t key = (static_cast<std::uint64_t>(pair.first) << 32 | pair.second) * 0x9E3779B97F4A7C15ull;
+            sum += key ^ (key >> 29);
+        }
+        return sum;
+    }
+
+    broadphase_benchmark::RunResult run(math_kernels::Level level, bool from_scratch, std::size_t count, int steps)
+    {
+        using clock = std::chrono::steady_clock;
+        broadphase_benchmark::RunResult result;
+        result.level        = level;
+        result.from_scratch = from_scratch;
+
+        const glm::vec2    world  = glm::vec2{ 16.0f, 9.0f } * std::sqrt(static_cast<float>(count) * AREA_PER_BOX / 144.0f);
+        std::vector<Mover> movers = make_movers(count, world);
+        std::vector<Aabb2> boxes(count);
+        SweepAndPrune      broadphase;
+        FrameArena         arena;
+        double             total = 0.0;
+        for (int i = 0; i < steps; ++i)
+        {
+            step(movers, boxes, world);
+            arena.Reset();
+            std::pmr::vector<OverlapPair> pairs{ &arena };
+            if (from_scratch)
+                broadphase.Reset();
+
+            const auto begin = clock::now();
+            broadphase.Update(boxes, pairs);
+            const double ms = std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+
+            const SweepAndPrune::Stats stats = broadphase.GetStats();
+            result.best_ms                   = i == 0 ? ms : std::min(result.best_ms, ms);
+            total += ms;
+            result.mean_sort_ms += stats.sort_ms;
+            result.mean_sweep_ms += stats.sweep_ms;
+            result.mean_shifts += stats.shifts;
+            result.mean_pairs += stats.pairs;
+            result.pair_hash += hash_pairs(pairs);
+        }
+        result.mean_ms = total / steps;
+        result.mean_sort_ms /= steps;
+        result.mean_sweep_ms /= steps;
+        result.mean_shifts /= steps;
+        result.mean_pairs /= steps;
+        return result;
+    }
+}
+
+namespace broadphase_benchmark
+{
+    Result Run(int box_count, int steps)
+    {
+        Result result;
+        result.boxes = std::max(box_count, 1);
+        result.steps = std::max(steps, 1);
+
+        const auto                count    = static_cast<std::size_t>(result.boxes);
+        const math_kernels::Level previous = math_kernels::ActiveLevel();
+        for (const math_kernels::Level level : { math_kernels::Level::Scalar, math_kernels::Level::Sse2, math_kernels::Level::Neon, math_kernels::Level::Wasm })
+        {
+            if (math_kernels::SetLevel(level))
+                result.runs.push_back(run(level, false, count, result.steps));
+        }
+        // what the insertion sort saves, at the level the game runs with
+        math_kernels::SetLevel(previous);
+        result.runs.push_back(run(previous, true, count, result.steps));
+
+        for (RunResult& run_result : result.runs)
+            run_result.matches = run_result.pair_hash == result.runs.front().pair_hash;
+        return result;
+    }
+
+    void Print(std::ostream& out, const Result& result)
+    {
+        out << "Sweep and prune, " << result.boxes << " boxes, " << result.steps << " steps\n";
+        for (const RunResult& run_result : result.runs)
+        {
+            out << "  " << math_kernels::LevelName(run_result.level) << (run_result.from_scratch ? ", sorted from scratch" : ", insertion sort") << ": best "
+                << run_result.best_ms << " ms, mean " << run_result.mean_ms << " ms (sort " << run_result.mean_sort_ms << ", sweep " << run_result.mean_sweep_ms
+                << "), " << run_result.mean_pairs << " pairs, " << run_result.mean_shifts << " shifts" << (run_result.matches ? "" : "  MISMATCH") << '\n';
+        }
+    }
+
+    bool Passed(const Result& result) noexcept
+    {
+        return std::all_of(result.runs.begin(), result.runs.end(), [](const RunResult& run_result) { return run_result.matches; });
+    }
+}
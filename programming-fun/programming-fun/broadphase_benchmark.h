@@ -0,0 +1,49 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "math_kernels.h"
+
+#include <iosfwd>
+#include <vector>
+
+/**
+ * SweepAndPrune over boxes moving like the stress ducks, stepped the same way for every run: kept sorted
+ * by the insertion sort at each math_kernels level this build and CPU have, then sorted from scratch every
+ * step for comparison. Pairs go into a FrameArena reset each step, like a frame's. Run with
+ * "--benchmark-broadphase" for 10k and 100k boxes, or "--benchmark-broadphase-count N" for one count, before
+ * any window opens; it fails when a run finds other pairs than the scalar one.
+ */
+namespace broadphase_benchmark
+{
+    struct RunResult
+    {
+        math_kernels::Level level         = math_kernels::Level::Scalar;
+        bool                from_scratch  = false; // sorted from scratch every step
+        double              best_ms       = 0.0;   // per step, sort and sweep
+        double              mean_ms       = 0.0;
+        double              mean_sort_ms  = 0.0;
+        double              mean_sweep_ms = 0.0;
+        double              mean_shifts   = 0.0; // by the insertion sort
+        double              mean_pairs    = 0.0;
+        std::uint64_t       pair_hash     = 0; // of every step's pairs, in any order
+        bool                matches       = false;
+    };
+
+    struct Result
+    {
+        int                    boxes = 0;
+        int                    steps = 0;
+        std::vector<RunResult> runs; // the scalar one first
+    };
+
+    Result Run(int box_count, int steps = 120);
+    void   Print(std::ostream& out, const Result& result);
+    // every run found the scalar one's pairs
+    bool   Passed(const Result& result) noexcept;
+}
@@ -0,0 +1,255 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "convolver.h"
+
+#include "audio_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+namespace
+{
+    constexpr std::size_t HALF = Convolver::BLOCK_FRAMES;     // the complex FFT's size
+    constexpr std::size_t SIZE = 2 * Convolver::BLOCK_FRAMES; // the real FFT's
+
+    // A real FFT of SIZE runs as a complex one of HALF over the even samples as real parts and the odd ones as
+    // imaginary, then untangles the two with these twiddles
+    struct FftTables
+    {
+        std::vector<float>         cos_half; // e^(-2 pi i j / HALF), j < HALF / 2
+        std::vector<float>         sin_half;
+        std::vector<std::uint16_t> reversed; // bit reversal over HALF
+        std::vector<float>         cos_size; // e^(-2 pi i k / SIZE), k <= HALF
+        std::vector<float>         sin_size;
+    };
+
+    // made by the first Convolver, on the thread that made it, so the audio thread only reads them
+    const FftTables& tables()
+    {
+        static const FftTables made = []
+        {
+            FftTables   t;
+            std::size_t bits = 0;
+            while ((std::size_t{ 1 } << bits) < HALF)
+                ++bits;
+            for (std::size_t j = 0; j < HALF / 2; ++j)
+            {
+                const double angle = 2.0 * std::numbers::pi * static_cast<double>(j) / static_cast<double>(HALF);
+                t.cos_half.push_back(static_cast<float>(std::cos(angle)));
+                t.sin_half.push_back(static_cast<float>(std::sin(angle)));
+            }
+            for (std::size_t i = 0; i < HALF; ++i)
+            {
+                std::size_t reversed = 0;
+                for (std::size_t b = 0; b < bits; ++b)
+                    reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+                t.reversed.push_back(static_cast<std::uint16_t>(reversed));
+            }
+            for (std::size_t k = 0; k <= HALF; ++k)
+            {
+                const double angle = 2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(SIZE);
+                t.cos_size.push_back(static_cast<float>(std::cos(angle)));
+                t.sin_size.push_back(static_cast<float>(std::sin(angle)));
+            }
+            return t;
+        }();
+        return made;
+    }
+
+    // In place radix 2, unscaled; `sign` -1 forward, +1 inverse
+    void complex_fft(float* re, float* im, float sign) noexcept
+    {
+        const FftTables& t = tables();
+        for (std::size_t i = 0; i < HALF; ++i)
+        {
+            const std::size_t j = t.reversed[i];
+            if (i < j)
+            {
+                std::swap(re[i], re[j]);
+                std::swap(im[i], im[j]);
+            }
+        }
+        for (std::size_t length = 2; length <= HALF; length *= 2)
+        {
+            const std::size_t half = length / 2;
+            const std::size_t step = HALF / length;
+            for (std::size_t start = 0; start < HALF; start += length)
+            {
+                for (std::size_t j = 0; j < half; ++j)
+                {
+                    const float       wr = t.cos_half[j * step];
+                    const float       wi = sign * t.sin_half[j * step];
+                    const std::size_t a  = start + j;
+                    const std::size_t b  = a + half;
+                    const float       vr = re[b] * wr - im[b] * wi;
+                    const float       vi = re[b] * wi + im[b] * wr;
+                    re[b]                = re[a] - vr;
+                    im[b]                = im[a] - vi;
+                    re[a] += vr;
+                    im[a] += vi;
+                }
+            }
+        }
+    }
+
+    // SIZE samples to bins 0 through HALF
+    void real_fft(const float* in, float* out_re, float* out_im, float* scratch_re, float* scratch_im) noexcept
+    {
+        const FftTables& t = tables();
+        for (std::size_t n = 0; n < HALF; ++n)
+        {
+            scratch_re[n] = in[2 * n];
+            scratch_im[n] = in[2 * n + 1];
+        }
+        complex_fft(scratch_re, scratch_im, -1.0f);
+        for (std::size_t k = 0; k <= HALF; ++k)
+        {
+            // the even samples' spectrum, and the odd ones' times -i
+            const std::size_t a      = k % HALF;
+            const std::size_t b      = (HALF - k) % HALF;
+            const float       even_r = 0.5f * (scratch_re[a] + scratch_re[b]);
+            const float       even_i = 0.5f * (scratch_im[a] - scratch_im[b]);
+            const float       odd_r  = 0.5f * (scratch_im[a] + scratch_im[b]);
+            const float       odd_i  = -0.5f * (scratch_re[a] - scratch_re[b]);
+            const float       wr     = t.cos_size[k];
+            const float       wi     = -t.sin_size[k];
+            out_re[k]                = even_r + wr * odd_r - wi * odd_i;
+            out_im[k]                = even_i + wr * odd_i + wi * odd_r;
+        }
+    }
+
+    // Bins 0 through HALF to SIZE samples, HALF times too loud
+    void inverse_real_fft(const float* in_re, const float* in_im, float* out, float* scratch_re, float* scratch_im) noexcept
+    {
+        const FftTables& t = tables();
+        for (std::size_t k = 0; k < HALF; ++k)
+        {
+            const float even_r = 0.5f * (in_re[k] + in_re[HALF - k]);
+            const float even_i = 0.5f * (in_im[k] - in_im[HALF - k]);
+            const float diff_r = 0.5f * (in_re[k] - in_re[HALF - k]);
+            const float diff_i = 0.5f * (in_im[k] + in_im[HALF - k]);
+            const float odd_r  = diff_r * t.cos_size[k] - diff_i * t.sin_size[k];
+            const float odd_i  = diff_r * t.sin_size[k] + diff_i * t.cos_size[k];
+            scratch_re[k]      = even_r - odd_i;
+            scratch_im[k]      = even_i + odd_r;
+        }
+        complex_fft(scratch_re, scratch_im, 1.0f);
+        for (std::size_t n = 0; n < HALF; ++n)
+        {
+            out[2 * n]     = scratch_re[n];
+            out[2 * n + 1] = scratch_im[n];
+        }
+    }
+}
+
+Convolver::Convolver(std::span<const float> left, std::span<const float> right) : channels{ right.empty() ? 1u : 2u }
+{
+    const std::size_t length = std::max(left.size(), right.size());
+    const std::size_t needed = std::max<std::size_t>((length + BLOCK_FRAMES - 1) / BLOCK_FRAMES, 1);
+    partitions               = std::min<std::size_t>(needed, MAX_PARTITIONS);
+    truncated                = needed > partitions;
+
+    filter_re.assign(channels * partitions * BINS, 0.0f);
+    filter_im.assign(filter_re.size(), 0.0f);
+    delay_re.assign(partitions * BINS, 0.0f);
+    delay_im.assign(delay_re.size(), 0.0f);
+    window.assign(SIZE, 0.0f);
+    output.assign(channels * BLOCK_FRAMES, 0.0f);
+    sum_re.assign(channels * BINS, 0.0f);
+    sum_im.assign(channels * BINS, 0.0f);
+    scratch_re.assign(HALF, 0.0f);
+    scratch_im.assign(HALF, 0.0f);
+    scratch.assign(SIZE, 0.0f);
+
+    // each partition zero padded to the FFT's size, so overlap-save's wrap around stays in the half it drops;
+    // the inverse FFT's scale goes in here, once
+    const float scale = 1.0f / static_cast<float>(HALF);
+    for (std::size_t channel = 0; channel < channels; ++channel)
+    {
+        const std::span<const float> response = channel == 0 ? left : right;
+        for (std::size_t p = 0; p < partitions; ++p)
+        {
+            std::fill(scratch.begin(), scratch.end(), 0.0f);
+            const std::size_t begin = std::min(p * BLOCK_FRAMES, response.size());
+            const std::size_t end   = std::min(begin + BLOCK_FRAMES, response.size());
+            std::transform(response.begin() + static_cast<std::ptrdiff_t>(begin), response.begin() + static_cast<std::ptrdiff_t>(end), scratch.begin(),
+                           [scale](float sample) { return sample * scale; });
+            const std::size_t at = (channel * partitions + p) * BINS;
+            real_fft(scratch.data(), filter_re.data() + at, filter_im.data() + at, scratch_re.data(), scratch_im.data());
+        }
+    }
+}
+
+void Convolver::Process(const float* in_left, const float* in_right, float* out_left, float* out_right, int frames, float wet) noexcept
+{
+    const float* output_right = output.data() + (channels == 2 ? BLOCK_FRAMES : 0);
+    for (int done = 0; done < frames;)
+    {
+        const int count = std::min(frames - done, BLOCK_FRAMES - filled);
+        // the input is read before the output is added, for callers passing the same planes
+        float* incoming = window.data() + BLOCK_FRAMES + filled;
+        for (int i = 0; i < count; ++i)
+            incoming[i] = 0.5f * (in_left[done + i] + in_right[done + i]);
+        audio_kernels::MixGain(output.data() + filled, out_left + done, static_cast<std::size_t>(count), wet);
+        audio_kernels::MixGain(output_right + filled, out_right + done, static_cast<std::size_t>(count), wet);
+        filled += count;
+        done += count;
+        if (filled == BLOCK_FRAMES)
+        {
+            processBlock();
+            filled = 0;
+        }
+    }
+}
+
+void Convolver::Reset() noexcept
+{
+    std::fill(delay_re.begin(), delay_re.end(), 0.0f);
+    std::fill(delay_im.begin(), delay_im.end(), 0.0f);
+    std::fill(window.begin(), window.end(), 0.0f);
+    std::fill(output.begin(), output.end(), 0.0f);
+    filled = 0;
+}
+
+int Convolver::Partitions() const noexcept
+{
+    return static_cast<int>(partitions);
+}
+
+bool Convolver::IsTruncated() const noexcept
+{
+    return truncated;
+}
+
+void Convolver::processBlock() noexcept
+{
+    newest = (newest + 1) % partitions;
+    real_fft(window.data(), delay_re.data() + newest * BINS, delay_im.data() + newest * BINS, scratch_re.data(), scratch_im.data());
+    std::copy(window.begin() + BLOCK_FRAMES, window.end(), window.begin());
+
+    // partition p meets the input from p blocks ago; both channels' partitions read that input while it's in cache
+    std::fill(sum_re.begin(), sum_re.end(), 0.0f);
+    std::fill(sum_im.begin(), sum_im.end(), 0.0f);
+    for (std::size_t p = 0, slot = newest; p < partitions; ++p, slot = slot == 0 ? partitions - 1 : slot - 1)
+    {
+        for (std::size_t channel = 0; channel < channels; ++channel)
+        {
+            const std::size_t filter = (channel * partitions + p) * BINS;
+            audio_kernels::ComplexMultiplyAdd(delay_re.data() + slot * BINS, delay_im.data() + slot * BINS, filter_re.data() + filter, filter_im.data() + filter,
+                                              sum_re.data() + channel * BINS, sum_im.data() + channel * BINS, BINS);
+        }
+    }
+    // overlap-save: the first half wrapped around, the second is this block's output
+    for (std::size_t channel = 0; channel < channels; ++channel)
+    {
+        inverse_real_fft(sum_re.data() + channel * BINS, sum_im.data() + channel * BINS, scratch.data(), scratch_re.data(), scratch_im.data());
+        std::copy(scratch.begin() + BLOCK_FRAMES, scratch.end(), output.begin() + static_cast<std::ptrdiff_t>(channel * BLOCK_FRAMES));
+    }
+}
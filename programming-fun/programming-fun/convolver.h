@@ -0,0 +1,67 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+/**
+ * Convolution reverb with a measured impulse response: uniformly partitioned overlap-save FFT convolution.
+ *
+ * The response is cut into partitions of BLOCK_FRAMES, each transformed once when the Convolver is made. Every
+ * block of input is transformed once into a frequency domain delay line, and a block of output is the sum over the
+ * partitions of each one's spectrum times the input's from that many blocks before (audio_kernels'
+ * ComplexMultiplyAdd), transformed back. So a block costs one forward FFT, one inverse per output channel and
+ * a multiply-add of BLOCK_FRAMES + 1 bins per partition and channel, where direct convolution would cost the
+ * response's length per sample; MAX_PARTITIONS caps that cost, longer responses are cut. The output is
+ * BLOCK_FRAMES behind the input whatever the caller's block size, and Process allocates nothing.
+ *
+ * The input's two channels are summed to one, a stereo response giving a stereo tail from it. Making one
+ * is the expensive part and belongs on the thread that owns the mixer; Process belongs to the audio thread.
+ */
+class Convolver
+{
+public:
+    static constexpr int BLOCK_FRAMES   = 128;  // the latency, 2.7 ms at 48 kHz
+    static constexpr int MAX_PARTITIONS = 1536; // 4 s at 48 kHz
+
+    // The response at the rate Process runs at; `right` empty for a mono one
+    Convolver(std::span<const float> left, std::span<const float> right);
+
+    // Adds `wet` times the input convolved with the response into the outputs, which may be the inputs
+    void Process(const float* in_left, const float* in_right, float* out_left, float* out_right, int frames, float wet) noexcept;
+    // Silences the tail, for picking up again after a pause
+    void Reset() noexcept;
+
+    int  Partitions() const noexcept;
+    bool IsTruncated() const noexcept; // the response was longer than MAX_PARTITIONS blocks
+
+private:
+    static constexpr std::size_t BINS = BLOCK_FRAMES + 1; // of a 2 * BLOCK_FRAMES real FFT
+
+    void processBlock() noexcept;
+
+private:
+    std::size_t        partitions = 0;
+    std::size_t        channels   = 1;
+    bool               truncated  = false;
+    std::vector<float> filter_re; // channels * partitions spectra of BINS, scaled for the inverse FFT
+    std::vector<float> filter_im;
+    std::vector<float> delay_re; // partitions input spectra, a ring
+    std::vector<float> delay_im;
+    std::size_t        newest = 0; // the ring's latest spectrum
+    std::vector<float> window;     // the last block of input and the one filling, 2 * BLOCK_FRAMES
+    std::vector<float> output;     // channels blocks, played out while the next input block fills
+    std::vector<float> sum_re;     // each channel's output spectrum
+    std::vector<float> sum_im;
+    std::vector<float> scratch_re; // the half size complex FFT the real ones run through
+    std::vector<float> scratch_im;
+    std::vector<float> scratch;    // an inverse FFT's 2 * BLOCK_FRAMES, before the half overlap-save keeps
+    int                filled = 0; // of the block filling, and of the output block played
+};
@@ -0,0 +1,148 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "debug_draw.h"
+
+#if DEBUG_DRAW_ENABLED
+#    include <algorithm>
+#    include <cmath>
+#    include <memory>
+#    include <mutex>
+#    include <numbers>
+
+namespace
+{
+    struct ThreadBuffer
+    {
+        std::mutex               mutex;
+        std::vector<DebugVertex> lines;
+        std::vector<DebugVertex> triangles;
+    };
+
+    // never freed: a thread can end with shapes the next Collect still has to take
+    struct Registry
+    {
+        std::mutex                                 mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    };
+
+    Registry& registry()
+    {
+        static Registry* const instance = new Registry{};
+        return *instance;
+    }
+
+    ThreadBuffer* register_thread()
+    {
+        Registry&              all = registry();
+        const std::scoped_lock lock{ all.mutex };
+        all.buffers.push_back(std::make_unique<ThreadBuffer>());
+        return all.buffers.back().get();
+    }
+
+    ThreadBuffer& this_thread_buffer()
+    {
+        thread_local ThreadBuffer* const buffer = register_thread();
+        return *buffer;
+    }
+
+    // emit(from, to) for each of the `segments` edges around the circle
+    template <typename Emit>
+    void for_circle(const glm::vec2& center, float radius, int segments, Emit&& emit)
+    {
+        segments        = std::clamp(segments, 3, 256);
+        const float arc = 2.0f * std::numbers::pi_v<float> / static_cast<float>(segments);
+        glm::vec2   previous{ center.x + radius, center.y };
+        for (int i = 1; i <= segments; ++i)
+        {
+            const float     angle = arc * static_cast<float>(i);
+            const glm::vec2 next{ center.x + radius * std::cos(angle), center.y + radius * std::sin(angle) };
+            emit(previous, next);
+            previous = next;
+        }
+    }
+}
+
+namespace debug_draw
+{
+    void Line(const glm::vec2& from, const glm::vec2& to, std::uint32_t color)
+    {
+        ThreadBuffer&          buffer = this_thread_buffer();
+        const std::scoped_lock lock{ buffer.mutex };
+        buffer.lines.push_back(DebugVertex{ from, color });
+        buffer.lines.push_back(DebugVertex{ to, color });
+    }
+
+    void Box(const glm::vec2& min, const glm::vec2& max, std::uint32_t color)
+    {
+        const glm::vec2        corners[4] = { min, glm::vec2{ max.x, min.y }, max, glm::vec2{ min.x, max.y } };
+        ThreadBuffer&          buffer     = this_thread_buffer();
+        const std::scoped_lock lock{ buffer.mutex };
+        for (int i = 0; i < 4; ++i)
+        {
+            buffer.lines.push_back(DebugVertex{ corners[i], color });
+            buffer.lines.push_back(DebugVertex{ corners[(i + 1) % 4], color });
+        }
+    }
+
+    void FilledBox(const glm::vec2& min, const glm::vec2& max, std::uint32_t color)
+    {
+        const DebugVertex      a{ min, color };
+        const DebugVertex      b{ glm::vec2{ max.x, min.y }, color };
+        const DebugVertex      c{ max, color };
+        const DebugVertex      d{ glm::vec2{ min.x, max.y }, color };
+        ThreadBuffer&          buffer = this_thread_buffer();
+        const std::scoped_lock lock{ buffer.mutex };
+        buffer.triangles.insert(buffer.triangles.end(), { a, b, c, a, c, d });
+    }
+
+    void Circle(const glm::vec2& center, float radius, std::uint32_t color, int segments)
+    {
+        ThreadBuffer&          buffer = this_thread_buffer();
+        const std::scoped_lock lock{ buffer.mutex };
+        for_circle(center, radius, segments,
+                   [&](const glm::vec2& from, const glm::vec2& to)
+                   {
+                       buffer.lines.push_back(DebugVertex{ from, color });
+                       buffer.lines.push_back(DebugVertex{ to, color });
+                   });
+    }
+
+    void FilledCircle(const glm::vec2& center, float radius, std::uint32_t color, int segments)
+    {
+        ThreadBuffer&          buffer = this_thread_buffer();
+        const std::scoped_lock lock{ buffer.mutex };
+        for_circle(center, radius, segments,
+                   [&](const glm::vec2& from, const glm::vec2& to) { buffer.triangles.insert(buffer.triangles.end(), { DebugVertex{ center, color }, DebugVertex{ from, color }, DebugVertex{ to, color } }); });
+    }
+
+    void Cross(const glm::vec2& center, float half_size, std::uint32_t color)
+    {
+        ThreadBuffer&          buffer = this_thread_buffer();
+        const std::scoped_lock lock{ buffer.mutex };
+        buffer.lines.push_back(DebugVertex{ center - glm::vec2{ half_size, 0.0f }, color });
+        buffer.lines.push_back(DebugVertex{ center + glm::vec2{ half_size, 0.0f }, color });
+        buffer.lines.push_back(DebugVertex{ center - glm::vec2{ 0.0f, half_size }, color });
+        buffer.lines.push_back(DebugVertex{ center + glm::vec2{ 0.0f, half_size }, color });
+    }
+
+    void Collect(Lists& out)
+    {
+        // in registration order, so one thread's shapes stay together and in the order it drew them
+        Registry&              all = registry();
+        const std::scoped_lock lock{ all.mutex };
+        for (const std::unique_ptr<ThreadBuffer>& buffer : all.buffers)
+        {
+            const std::scoped_lock buffer_lock{ buffer->mutex };
+            out.lines.insert(out.lines.end(), buffer->lines.begin(), buffer->lines.end());
+            out.triangles.insert(out.triangles.end(), buffer->triangles.begin(), buffer->triangles.end());
+            buffer->lines.clear();
+            buffer->triangles.clear();
+        }
+    }
+}
+#endif
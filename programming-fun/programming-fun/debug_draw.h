@@ -0,0 +1,93 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <memory_resource>
+#include <vector>
+
+// Define DEBUG_DRAW_ENABLED=0 to compile every call away; release builds do by default
+#if !defined(DEBUG_DRAW_ENABLED)
+#    if defined(NDEBUG)
+#        define DEBUG_DRAW_ENABLED 0
+#    else
+#        define DEBUG_DRAW_ENABLED 1
+#    endif
+#endif
+
+// 12 bytes, in the space the scene's projection takes
+struct DebugVertex
+{
+    glm::vec2     position{ 0.0f };
+    std::uint32_t color = 0xFFFFFFFFu; // RGBA8, R in the low byte
+};
+
+/**
+ * Lines and shapes for looking at what the code is doing: bounds, grids, paths, drawn over the scene.
+ *
+ * Any thread can draw at any time, ParallelFor jobs included: each thread appends to its own buffers,
+ * behind a lock only Collect ever contends for. The main thread collects every thread's shapes into the
+ * frame's lists once a frame, and DebugDrawRenderer draws the lines and the filled shapes with one draw each.
+ * Shapes last for the frame that collects them, so a system that wants one shown draws it every frame.
+ * Positions are in the scene's space, the one its sprites and meshes are in. With DEBUG_DRAW_ENABLED 0 every
+ * function is an empty inline and Collect leaves the lists empty, so calls can stay where they are.
+ */
+namespace debug_draw
+{
+    struct Lists
+    {
+        explicit Lists(std::pmr::memory_resource* arena) : lines{ arena }, triangles{ arena }
+        {
+        }
+
+        std::pmr::vector<DebugVertex> lines;     // pairs
+        std::pmr::vector<DebugVertex> triangles; // triples
+    };
+
+#if DEBUG_DRAW_ENABLED
+    void Line(const glm::vec2& from, const glm::vec2& to, std::uint32_t color);
+    void Box(const glm::vec2& min, const glm::vec2& max, std::uint32_t color);
+    void FilledBox(const glm::vec2& min, const glm::vec2& max, std::uint32_t color);
+    // `segments` is clamped to [3, 256]
+    void Circle(const glm::vec2& center, float radius, std::uint32_t color, int segments = 24);
+    void FilledCircle(const glm::vec2& center, float radius, std::uint32_t color, int segments = 24);
+    void Cross(const glm::vec2& center, float half_size, std::uint32_t color);
+
+    // Main thread, once a frame: moves what every thread drew since the last Collect onto `out`
+    void Collect(Lists& out);
+#else
+    inline void Line(const glm::vec2&, const glm::vec2&, std::uint32_t)
+    {
+    }
+
+    inline void Box(const glm::vec2&, const glm::vec2&, std::uint32_t)
+    {
+    }
+
+    inline void FilledBox(const glm::vec2&, const glm::vec2&, std::uint32_t)
+    {
+    }
+
+    inline void Circle(const glm::vec2&, float, std::uint32_t, int = 24)
+    {
+    }
+
+    inline void FilledCircle(const glm::vec2&, float, std::uint32_t, int = 24)
+    {
+    }
+
+    inline void Cross(const glm::vec2&, float, std::uint32_t)
+    {
+    }
+
+    inline void Collect(Lists&)
+    {
+    }
+#endif
+}
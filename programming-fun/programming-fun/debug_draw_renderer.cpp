@@ -0,0 +1,129 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "debug_draw_renderer.h"
+
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "vertex_layout.h"
+
+#include <cstddef>
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace
+{
+    constexpr const char* DEBUG_VERTEX_SHADER = R"(
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec4 aColor;
+
+uniform mat4 uProjection;
+
+out vec4 vColor;
+
+void main()
+{
+    vColor      = aColor;
+    gl_Position = uProjection * vec4(aPosition, 0.0, 1.0);
+}
+)";
+
+    constexpr const char* DEBUG_FRAGMENT_SHADER = R"(
+in vec4 vColor;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = vColor;
+}
+)";
+
+    // per region; grows to the largest frame seen
+    constexpr std::size_t INITIAL_STREAM_BYTES = 4096 * sizeof(DebugVertex);
+
+    constexpr auto DEBUG_LAYOUT = vertex_layout::Make<DebugVertex>(VertexAttribute{ 0, attribute_format::Float2, offsetof(DebugVertex, position) },
+                                                                   VertexAttribute{ 1, attribute_format::UByte4Norm, offsetof(DebugVertex, color) });
+}
+
+void DebugDrawRenderer::Setup()
+{
+    program.Request(DEBUG_VERTEX_SHADER, DEBUG_FRAGMENT_SHADER);
+
+    glGenVertexArrays(1, &vertex_array);
+    gl_state::BindVertexArray(vertex_array);
+    vertex_stream.Setup(GL_ARRAY_BUFFER, INITIAL_STREAM_BYTES);
+    vertex_layout::Enable(DEBUG_LAYOUT);
+}
+
+void DebugDrawRenderer::Shutdown()
+{
+    vertex_stream.Shutdown();
+    gl_state::DeleteVertexArray(vertex_array);
+    program.Reset();
+    vertex_array        = 0;
+    projection_location = -1;
+}
+
+void DebugDrawRenderer::Draw(const glm::mat4& projection, std::span<const DebugVertex> lines, std::span<const DebugVertex> triangles)
+{
+    stats = Stats{};
+    if (lines.empty() && triangles.empty())
+        return;
+    if (!program.IsReady())
+    {
+        if (!program.Poll())
+        {
+            stats.pending = true;
+            return;
+        }
+        projection_location = glGetUniformLocation(program.Id(), "uProjection");
+    }
+
+    // both in one mapping, the triangles first since they draw first; the lines go over them
+    const auto  bytes       = triangles.size_bytes() + lines.size_bytes();
+    std::size_t base_offset = 0;
+    auto*       mapped      = vertex_stream.Map(bytes, base_offset);
+    if (mapped == nullptr)
+        return;
+    if (!triangles.empty())
+        std::memcpy(mapped, triangles.data(), triangles.size_bytes());
+    if (!lines.empty())
+        std::memcpy(mapped + triangles.size_bytes(), lines.data(), lines.size_bytes());
+    vertex_stream.Unmap();
+    gl_stats::CountUpload(bytes);
+
+    gl_state::SetEnabled(GL_BLEND, true);
+    gl_state::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::UseProgram(program.Id());
+    glUniformMatrix4fv(projection_location, 1, GL_FALSE, glm::value_ptr(projection));
+    gl_state::BindVertexArray(vertex_array);
+    vertex_layout::Bind(DEBUG_LAYOUT, base_offset);
+
+    if (!triangles.empty())
+    {
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(triangles.size()));
+        gl_stats::CountDraw(static_cast<long long>(triangles.size() / 3));
+        ++stats.draw_calls;
+    }
+    if (!lines.empty())
+    {
+        glDrawArrays(GL_LINES, static_cast<GLint>(triangles.size()), static_cast<GLsizei>(lines.size()));
+        gl_stats::CountDraw(static_cast<long long>(lines.size() / 2));
+        ++stats.draw_calls;
+    }
+    vertex_stream.EndFrame();
+
+    stats.lines       = static_cast<int>(lines.size() / 2);
+    stats.triangles   = static_cast<int>(triangles.size() / 3);
+    stats.buffer_size = static_cast<int>(vertex_stream.GetStats().region_bytes * StreamBuffer::REGION_COUNT);
+}
+
+const DebugDrawRenderer::Stats& DebugDrawRenderer::LastFrameStats() const noexcept
+{
+    return stats;
+}
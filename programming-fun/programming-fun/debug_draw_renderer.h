@@ -0,0 +1,48 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "debug_draw.h"
+#include "shader.h"
+#include "stream_buffer.h"
+
+#include <GL/glew.h>
+#include <glm/mat4x4.hpp>
+#include <span>
+
+/**
+ * Draws the debug_draw lists collected for a frame: both go into one StreamBuffer, then the filled
+ * shapes are one glDrawArrays of triangles and the lines one of lines over them. Kept apart from
+ * debug_draw so the code that only records shapes doesn't need GL.
+ */
+class DebugDrawRenderer
+{
+public:
+    struct Stats
+    {
+        int  lines       = 0;
+        int  triangles   = 0;
+        int  draw_calls  = 0;
+        int  buffer_size = 0;
+        bool pending     = false; // the program is still compiling, so nothing was drawn
+    };
+
+    void Setup();
+    void Shutdown();
+
+    void Draw(const glm::mat4& projection, std::span<const DebugVertex> lines, std::span<const DebugVertex> triangles);
+
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    ShaderProgram program;
+    GLint         projection_location = -1;
+    GLuint        vertex_array        = 0;
+    StreamBuffer  vertex_stream;
+    Stats         stats;
+};
@@ -0,0 +1,219 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "decode_scratch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+    constexpr std::size_t ALIGNMENT = 16;
+    constexpr std::size_t NO_BLOCK  = static_cast<std::size_t>(-1);
+
+    std::atomic<std::size_t> gReservedBytes{ 0 };
+    std::atomic<std::size_t> gLastPeakBytes{ 0 };
+    std::atomic<std::size_t> gLargestPeakBytes{ 0 };
+
+    std::size_t align_up(std::size_t bytes) noexcept
+    {
+        return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    struct ThreadArena
+    {
+        std::unique_ptr<std::byte[]> block;
+        std::size_t                  capacity    = 0;
+        std::size_t                  offset      = 0;
+        std::size_t                  last_block  = NO_BLOCK; // offset of the newest allocation while it is still live
+        std::size_t                  spill_bytes = 0;        // malloc'd while a scope was open and not yet freed
+        std::size_t                  peak        = 0;
+        int                          depth       = 0;
+
+        ThreadArena() = default;
+
+        ThreadArena(const ThreadArena&)                = delete;
+        ThreadArena& operator=(const ThreadArena&)     = delete;
+        ThreadArena(ThreadArena&&) noexcept            = delete;
+        ThreadArena& operator=(ThreadArena&&) noexcept = delete;
+
+        ~ThreadArena()
+        {
+            gReservedBytes.fetch_sub(capacity, std::memory_order_relaxed);
+        }
+
+        std::size_t InUse() const noexcept
+        {
+            return offset + spill_bytes;
+        }
+
+        bool Owns(const void* pointer) const noexcept
+        {
+            const auto* byte = static_cast<const std::byte*>(pointer);
+            return block != nullptr && byte >= block.get() && byte < block.get() + capacity;
+        }
+
+        void Resize(std::size_t new_capacity)
+        {
+            block.reset();
+            gReservedBytes.fetch_sub(capacity, std::memory_order_relaxed);
+            block    = std::make_unique_for_overwrite<std::byte[]>(new_capacity);
+            capacity = new_capacity;
+            gReservedBytes.fetch_add(capacity, std::memory_order_relaxed);
+        }
+    };
+
+    // everything outside the arena carries its size in front, so Free can keep spill_bytes honest
+    struct SpillHeader
+    {
+        alignas(ALIGNMENT) std::size_t bytes;
+    };
+
+    thread_local ThreadArena gArena;
+
+    void* spill(std::size_t bytes) noexcept
+    {
+        auto* header = static_cast<SpillHeader*>(std::malloc(sizeof(SpillHeader) + bytes));
+        if (header == nullptr)
+            return nullptr;
+        header->bytes = bytes;
+        if (gArena.depth > 0)
+        {
+            gArena.spill_bytes += bytes;
+            gArena.peak = std::max(gArena.peak, gArena.InUse());
+        }
+        return header + 1;
+    }
+
+    SpillHeader* header_of(void* pointer) noexcept
+    {
+        return static_cast<SpillHeader*>(pointer) - 1;
+    }
+}
+
+namespace decode_scratch
+{
+    Scope::Scope() noexcept
+    {
+        ThreadArena& arena = gArena;
+        if (arena.depth++ == 0 && arena.block == nullptr)
+            arena.Resize(INITIAL_CAPACITY);
+        start_bytes = arena.InUse();
+        outer_peak  = arena.peak;
+        arena.peak  = start_bytes;
+    }
+
+    Scope::~Scope()
+    {
+        ThreadArena&      arena = gArena;
+        const std::size_t peak  = arena.peak;
+        arena.peak              = std::max(outer_peak, peak);
+        if (--arena.depth > 0)
+            return;
+
+        const std::size_t used = peak - start_bytes;
+        gLastPeakBytes.store(used, std::memory_order_relaxed);
+        std::size_t largest = gLargestPeakBytes.load(std::memory_order_relaxed);
+        while (used > largest && !gLargestPeakBytes.compare_exchange_weak(largest, used, std::memory_order_relaxed))
+        {
+        }
+        arena.offset     = 0;
+        arena.last_block = NO_BLOCK;
+        arena.peak       = 0;
+        // anything still spilled belongs to the caller now
+        arena.spill_bytes = 0;
+        if (peak > arena.capacity)
+            arena.Resize(std::bit_ceil(peak));
+    }
+
+    std::size_t Scope::PeakBytes() const noexcept
+    {
+        return gArena.peak - start_bytes;
+    }
+
+    void* Allocate(std::size_t bytes) noexcept
+    {
+        ThreadArena& arena = gArena;
+        if (arena.depth == 0)
+            return spill(bytes);
+        const std::size_t size = align_up(std::max<std::size_t>(bytes, 1));
+        if (size > arena.capacity - arena.offset)
+            return spill(bytes);
+        void* pointer    = arena.block.get() + arena.offset;
+        arena.last_block = arena.offset;
+        arena.offset += size;
+        arena.peak = std::max(arena.peak, arena.InUse());
+        return pointer;
+    }
+
+    void* Reallocate(void* pointer, std::size_t old_bytes, std::size_t new_bytes) noexcept
+    {
+        if (pointer == nullptr)
+            return Allocate(new_bytes);
+        ThreadArena& arena = gArena;
+        if (arena.Owns(pointer))
+        {
+            const auto at = static_cast<std::size_t>(static_cast<std::byte*>(pointer) - arena.block.get());
+            if (at == arena.last_block && align_up(new_bytes) <= arena.capacity - at)
+            {
+                // the newest block just moves the bump pointer
+                arena.offset = at + align_up(std::max<std::size_t>(new_bytes, 1));
+                arena.peak   = std::max(arena.peak, arena.InUse());
+                return pointer;
+            }
+        }
+        else if (arena.depth == 0)
+        {
+            auto* header = static_cast<SpillHeader*>(std::realloc(header_of(pointer), sizeof(SpillHeader) + new_bytes));
+            if (header == nullptr)
+                return nullptr;
+            header->bytes = new_bytes;
+            return header + 1;
+        }
+        void* moved = Allocate(new_bytes);
+        if (moved == nullptr)
+            return nullptr;
+        std::memcpy(moved, pointer, std::min(old_bytes, new_bytes));
+        Free(pointer);
+        return moved;
+    }
+
+    void Free(void* pointer) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+        ThreadArena& arena = gArena;
+        if (arena.Owns(pointer))
+        {
+            // only the newest block can be given back early; the rest waits for the scope to end
+            const auto at = static_cast<std::size_t>(static_cast<std::byte*>(pointer) - arena.block.get());
+            if (at == arena.last_block)
+            {
+                arena.offset     = at;
+                arena.last_block = NO_BLOCK;
+            }
+            return;
+        }
+        SpillHeader* header = header_of(pointer);
+        if (arena.depth > 0)
+            arena.spill_bytes -= std::min(arena.spill_bytes, header->bytes);
+        std::free(header);
+    }
+
+    Stats GetStats() noexcept
+    {
+        Stats stats;
+        stats.reserved_bytes     = gReservedBytes.load(std::memory_order_relaxed);
+        stats.last_peak_bytes    = gLastPeakBytes.load(std::memory_order_relaxed);
+        stats.largest_peak_bytes = gLargestPeakBytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Per-thread scratch memory for the stb decoders.
+ *
+ * stb_image's STBI_MALLOC family is routed here (see stb_implementation.cpp) and DecodeOgg hands
+ * stb_vorbis a stb_vorbis_alloc block from the same place. Inside a Scope allocations bump a pointer through
+ * the thread's arena, freeing the newest block pops it and reallocating it grows it in place; when the
+ * outermost Scope ends the arena rewinds. A decode that outgrows the arena spills to malloc and the next
+ * Scope starts with an arena big enough for it, so a worker settles on one block sized for its largest asset.
+ * Outside a Scope everything goes to malloc. Arena blocks are only valid until their Scope ends, so copy results out first.
+ */
+namespace decode_scratch
+{
+    constexpr std::size_t INITIAL_CAPACITY = 256 * 1024;
+
+    struct Stats
+    {
+        std::size_t reserved_bytes     = 0; // arenas held across every thread
+        std::size_t last_peak_bytes    = 0; // the most recent outermost Scope
+        std::size_t largest_peak_bytes = 0;
+    };
+
+    class [[nodiscard]] Scope
+    {
+    public:
+        Scope() noexcept;
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        // Most scratch held at once since this scope began, spills included
+        std::size_t PeakBytes() const noexcept;
+
+    private:
+        std::size_t start_bytes = 0;
+        std::size_t outer_peak  = 0;
+    };
+
+    void* Allocate(std::size_t bytes) noexcept;
+    void* Reallocate(void* pointer, std::size_t old_bytes, std::size_t new_bytes) noexcept;
+    void  Free(void* pointer) noexcept;
+
+    Stats GetStats() noexcept;
+}
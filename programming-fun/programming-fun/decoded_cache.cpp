@@ -0,0 +1,270 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "decoded_cache.h"
+
+#include "asset_paths.h"
+#include "logger.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <system_error>
+
+namespace
+{
+    // magic, version, key, cold decode in microseconds, params, section count; then a size per section, then the sections 16 byte aligned
+    constexpr char          CACHE_MAGIC[4] = { 'P', 'F', 'D', 'C' };
+    constexpr std::uint32_t CACHE_VERSION  = 1;
+    constexpr std::size_t   HEADER_SIZE    = 28 + 4 * decoded_cache::Entry::PARAM_COUNT;
+    constexpr std::size_t   ALIGNMENT      = 16;
+
+    struct DecodedCache
+    {
+        std::filesystem::path      directory;
+        bool                       is_configured = false; // SetDirectory was called
+        bool                       is_enabled    = false;
+        std::once_flag             checked;
+        std::atomic<std::uint32_t> temporaries{ 0 }; // numbers the files written aside
+        std::mutex                 stats_mutex;
+        decoded_cache::Stats       stats;
+    };
+
+    DecodedCache cache;
+
+    constexpr std::uint64_t fnv1a(std::uint64_t hash, std::span<const unsigned char> bytes) noexcept
+    {
+        for (const unsigned char c : bytes)
+        {
+            hash ^= c;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    std::size_t aligned(std::size_t offset) noexcept
+    {
+        return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    std::filesystem::path file_for(std::uint64_t key)
+    {
+        char name[24] = {};
+        for (int i = 0; i < 16; ++i)
+            name[i] = "0123456789abcdef"[(key >> (60 - 4 * i)) & 0xf];
+        std::memcpy(name + 16, ".bin", 4);
+        return cache.directory / name;
+    }
+
+    template <typename T>
+    void write_at(std::vector<unsigned char>& bytes, std::size_t offset, T value) noexcept
+    {
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+
+    template <typename T>
+    T read_at(std::span<const unsigned char> bytes, std::size_t offset) noexcept
+    {
+        T value{};
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    void check_directory()
+    {
+#if !defined(__EMSCRIPTEN__)
+        if (!cache.is_configured)
+            cache.directory = get_base_path().parent_path() / "decoded_cache";
+        if (cache.directory.empty())
+            return;
+        std::error_code error;
+        std::filesystem::create_directories(cache.directory, error);
+        if (error)
+        {
+            LOG_WARN("Decoded cache: off, can't make ", cache.directory, ": ", error.message());
+            return;
+        }
+        cache.is_enabled = true;
+        std::cout << "Decoded cache: " << cache.directory << '\n';
+#endif
+    }
+
+    void count_rejected()
+    {
+        std::lock_guard lock{ cache.stats_mutex };
+        ++cache.stats.rejected;
+    }
+}
+
+namespace decoded_cache
+{
+    void SetDirectory(std::filesystem::path directory)
+    {
+        cache.directory     = std::move(directory);
+        cache.is_configured = true;
+    }
+
+    bool IsEnabled()
+    {
+        std::call_once(cache.checked, check_directory);
+        return cache.is_enabled;
+    }
+
+    Stats GetStats()
+    {
+        std::lock_guard lock{ cache.stats_mutex };
+        return cache.stats;
+    }
+
+    void Print(std::ostream& out)
+    {
+        const Stats stats = GetStats();
+        out << "Decoded cache: " << stats.warm_loads << " warm loads in " << stats.warm_ms << " ms (" << stats.warm_as_cold_ms << " ms cold), " << stats.cold_loads
+            << " cold in " << stats.cold_ms << " ms, " << stats.written << " written, " << stats.rejected << " rejected\n";
+    }
+
+    std::uint64_t Key(std::span<const unsigned char> source, std::string_view variant) noexcept
+    {
+        // the NUL keeps the variant from reading as more of the file
+        constexpr unsigned char separator[1] = { 0 };
+        const std::uint64_t     hash         = fnv1a(fnv1a(0xcbf29ce484222325ull, source), separator);
+        return fnv1a(hash, std::span{ reinterpret_cast<const unsigned char*>(variant.data()), variant.size() });
+    }
+
+    bool Entry::Open(std::uint64_t key)
+    {
+        Close();
+        if (!IsEnabled() || !file.Open(file_for(key)))
+            return false;
+        const std::span<const unsigned char> bytes = file.Bytes();
+
+        bool valid = bytes.size() >= HEADER_SIZE && std::memcmp(bytes.data(), CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 && read_at<std::uint32_t>(bytes, 4) == CACHE_VERSION &&
+                     read_at<std::uint64_t>(bytes, 8) == key;
+
+        const std::size_t count  = valid ? read_at<std::uint32_t>(bytes, HEADER_SIZE - 4) : 0;
+        std::size_t       offset = aligned(HEADER_SIZE + count * 8);
+        valid                    = valid && offset <= bytes.size();
+        for (std::size_t i = 0; valid && i < count; ++i)
+        {
+            const auto size = read_at<std::uint64_t>(bytes, HEADER_SIZE + i * 8);
+            valid           = size <= bytes.size() && offset <= bytes.size() - size;
+            if (valid)
+                sections.push_back(bytes.subspan(offset, static_cast<std::size_t>(size)));
+            offset = aligned(offset + static_cast<std::size_t>(size));
+        }
+        if (!valid)
+        {
+            Close();
+            count_rejected();
+            return false;
+        }
+        cold_ms = static_cast<double>(read_at<std::uint64_t>(bytes, 16)) / 1000.0;
+        for (std::size_t i = 0; i < PARAM_COUNT; ++i)
+            params[i] = read_at<std::int32_t>(bytes, 24 + 4 * i);
+        return true;
+    }
+
+    void Entry::Close()
+    {
+        file.Close();
+        params  = {};
+        cold_ms = 0.0;
+        sections.clear();
+    }
+
+    bool Entry::IsOpen() const noexcept
+    {
+        return file.IsOpen();
+    }
+
+    std::int32_t Entry::Param(std::size_t index) const noexcept
+    {
+        return params[index];
+    }
+
+    std::size_t Entry::SectionCount() const noexcept
+    {
+        return sections.size();
+    }
+
+    std::span<const unsigned char> Entry::Section(std::size_t index) const noexcept
+    {
+        return index < sections.size() ? sections[index] : std::span<const unsigned char>{};
+    }
+
+    double Entry::ColdMs() const noexcept
+    {
+        return cold_ms;
+    }
+
+    void Store(std::uint64_t key, const std::array<std::int32_t, Entry::PARAM_COUNT>& params, std::span<const std::span<const unsigned char>> sections, double cold_ms)
+    {
+        if (!IsEnabled())
+            return;
+        const std::size_t table = HEADER_SIZE + sections.size() * 8;
+        std::size_t       size  = aligned(table);
+        for (const auto& section : sections)
+            size = aligned(size + section.size());
+        std::vector<unsigned char> bytes(size);
+        std::memcpy(bytes.data(), CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        write_at<std::uint32_t>(bytes, 4, CACHE_VERSION);
+        write_at<std::uint64_t>(bytes, 8, key);
+        write_at<std::uint64_t>(bytes, 16, static_cast<std::uint64_t>(cold_ms * 1000.0));
+        for (std::size_t i = 0; i < Entry::PARAM_COUNT; ++i)
+            write_at<std::int32_t>(bytes, 24 + 4 * i, params[i]);
+        write_at<std::uint32_t>(bytes, HEADER_SIZE - 4, static_cast<std::uint32_t>(sections.size()));
+        std::size_t offset = aligned(table);
+        for (std::size_t i = 0; i < sections.size(); ++i)
+        {
+            write_at<std::uint64_t>(bytes, HEADER_SIZE + i * 8, static_cast<std::uint64_t>(sections[i].size()));
+            if (!sections[i].empty())
+                std::memcpy(bytes.data() + offset, sections[i].data(), sections[i].size());
+            offset = aligned(offset + sections[i].size());
+        }
+
+        // two workers can store the same key, so each writes its own temporary
+        const std::filesystem::path filename  = file_for(key);
+        std::filesystem::path       temporary = filename;
+        temporary += "." + std::to_string(cache.temporaries.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+        {
+            std::ofstream out{ temporary, std::ios::binary };
+            if (!out || !out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+            {
+                LOG_WARN("Decoded cache: can't write ", temporary);
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, filename, error);
+        if (error)
+        {
+            // Windows won't rename over a file another thread has mapped; that one is as good
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+        std::lock_guard lock{ cache.stats_mutex };
+        ++cache.stats.written;
+    }
+
+    void CountWarm(double ms, double cold_ms)
+    {
+        std::lock_guard lock{ cache.stats_mutex };
+        ++cache.stats.warm_loads;
+        cache.stats.warm_ms += ms;
+        cache.stats.warm_as_cold_ms += cold_ms;
+    }
+
+    void CountCold(double ms)
+    {
+        std::lock_guard lock{ cache.stats_mutex };
+        ++cache.stats.cold_loads;
+        cache.stats.cold_ms += ms;
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "mapped_file.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <span>
+#include <string_view>
+#include <vector>
+
+/**
+ * Decoded assets kept between runs, so a launch after the first skips stb_image and stb_vorbis.
+ *
+ * An entry is named by an FNV-1a hash of the source file's bytes and a variant string for the loader
+ * options that change the result, so an edited file or other options simply miss. It holds whatever
+ * the loader would have uploaded, as a few int parameters and byte sections (RGBA8 levels with the mips
+ * built on the worker, PCM and IMA4 blocks), and is mapped rather than read: textures upload straight
+ * from the mapping. Each entry also records how long the cold decode took, so a warm start can say what it
+ * saved. Files that don't check out are decoded again and overwritten. Off under Emscripten, whose file
+ * system doesn't outlive the page. Entry::Open and Store are safe from any thread; SetDirectory goes first.
+ */
+namespace decoded_cache
+{
+    struct Stats
+    {
+        int    warm_loads      = 0;   // entries loaded instead of decoding
+        int    cold_loads      = 0;   // decoded from the source file
+        int    written         = 0;
+        int    rejected        = 0;   // files for another version or key, or cut short
+        double warm_ms         = 0.0; // on the workers, mapping and checking included
+        double cold_ms         = 0.0; // decoding, and whatever the loader builds from it
+        double warm_as_cold_ms = 0.0; // what the warm loads took to decode when they were cached
+    };
+
+    // Before the first load; an empty path turns the cache off. Defaults to "decoded_cache" next to the assets folder.
+    void SetDirectory(std::filesystem::path directory);
+
+    bool  IsEnabled();
+    Stats GetStats();
+    // One line: warm loads and their time next to what the same loads took cold, then this run's cold decodes
+    void Print(std::ostream& out);
+
+    std::uint64_t Key(std::span<const unsigned char> source, std::string_view variant) noexcept;
+
+    /**
+     * One cached decode, mapped. Sections point into the mapping and live as long as the entry.
+     */
+    class Entry
+    {
+    public:
+        static constexpr std::size_t PARAM_COUNT = 4;
+
+        // False on a miss, or a file that doesn't check out
+        bool Open(std::uint64_t key);
+        void Close();
+
+        bool                           IsOpen() const noexcept;
+        std::int32_t                   Param(std::size_t index) const noexcept;
+        std::size_t                    SectionCount() const noexcept;
+        std::span<const unsigned char> Section(std::size_t index) const noexcept;
+        // What decoding took when the entry was written
+        double ColdMs() const noexcept;
+
+    private:
+        MappedFile                                  file;
+        std::array<std::int32_t, PARAM_COUNT>       params{};
+        std::vector<std::span<const unsigned char>> sections;
+        double                                      cold_ms = 0.0;
+    };
+
+    // Written aside and renamed over, so another thread or instance never maps half a file
+    void Store(std::uint64_t key, const std::array<std::int32_t, Entry::PARAM_COUNT>& params, std::span<const std::span<const unsigned char>> sections, double cold_ms);
+
+    // The loaders' timings, for the stats
+    void CountWarm(double ms, double cold_ms);
+    void CountCold(double ms);
+}
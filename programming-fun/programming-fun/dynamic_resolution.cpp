@@ -0,0 +1,124 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "dynamic_resolution.h"
+
+#include "gpu_profiler.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <glm/common.hpp>
+#include <imgui.h>
+
+namespace
+{
+    constexpr double SMOOTHING = 0.2;
+    // results already in flight when the scale changed still describe the old resolution
+    constexpr int SETTLE_FRAMES = profiler::GPU_QUERY_LATENCY + 2;
+
+    float snap(float value, float min_scale) noexcept
+    {
+        return std::clamp(std::round(value / DynamicResolution::SCALE_GRANULARITY) * DynamicResolution::SCALE_GRANULARITY, min_scale, 1.0f);
+    }
+}
+
+float DynamicResolution::Update(const ResolutionSettings& settings, double gpu_ms)
+{
+    const float min_scale = std::clamp(settings.min_scale, ResolutionSettings::MIN_SCALE, 1.0f);
+    if (!settings.dynamic)
+    {
+        scale       = std::clamp(settings.scale, min_scale, 1.0f);
+        was_dynamic = false;
+        return scale;
+    }
+    if (!was_dynamic)
+    {
+        // start from the fixed scale and let the first measurements come in
+        was_dynamic = true;
+        smoothed_ms = 0.0;
+        cooldown    = SETTLE_FRAMES;
+    }
+    if (gpu_ms < 0.0)
+        return scale;
+
+    smoothed_ms = smoothed_ms == 0.0 ? gpu_ms : smoothed_ms + (gpu_ms - smoothed_ms) * SMOOTHING;
+    if (cooldown > 0)
+    {
+        --cooldown;
+        return scale;
+    }
+
+    const double target = std::max(1.0, static_cast<double>(settings.target_ms));
+    if (smoothed_ms <= target && smoothed_ms >= target * HEADROOM)
+        return scale;
+    // aim for the middle of the band either way
+    const double aim     = target * (1.0 + HEADROOM) * 0.5;
+    const auto   ratio   = static_cast<float>(std::sqrt(aim / std::max(smoothed_ms, 0.01)));
+    const float  desired = std::clamp(scale * ratio, scale - MAX_STEP, scale + MAX_STEP);
+    float        next    = snap(desired, min_scale);
+    // outside the band is always worth at least one notch, or a small error would never be corrected
+    if (next == scale)
+        next = snap(scale + (ratio < 1.0f ? -SCALE_GRANULARITY : SCALE_GRANULARITY), min_scale);
+    if (next != scale)
+    {
+        scale    = next;
+        cooldown = SETTLE_FRAMES;
+    }
+    return scale;
+}
+
+float DynamicResolution::Scale() const noexcept
+{
+    return scale;
+}
+
+glm::ivec2 DynamicResolution::SceneBase(glm::ivec2 drawable_size, glm::ivec2 window_size, float scene_density) noexcept
+{
+    if (scene_density <= 0.0f)
+        return drawable_size;
+    return glm::min(drawable_size, glm::ivec2{ glm::vec2{ window_size } * scene_density + 0.5f });
+}
+
+bool DynamicResolution::DrawImGui(ResolutionSettings& settings)
+{
+    bool changed = ImGui::SliderFloat("scene density (0 native)", &settings.scene_density, 0.0f, 4.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+    changed      = ImGui::Checkbox("dynamic resolution", &settings.dynamic) || changed;
+    if (settings.dynamic)
+    {
+        changed = ImGui::SliderFloat("target gpu ms", &settings.target_ms, 1.0f, 50.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp) || changed;
+        changed = ImGui::SliderFloat("min scale", &settings.min_scale, ResolutionSettings::MIN_SCALE, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp) || changed;
+    }
+    else
+    {
+        changed = ImGui::SliderFloat("render scale", &settings.scale, settings.min_scale, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp) || changed;
+    }
+    return changed;
+}
+
+bool DynamicResolution::Parse(std::string_view text, ResolutionSettings& out_settings)
+{
+    if (text == "dynamic")
+    {
+        out_settings.dynamic = true;
+        return true;
+    }
+    int percent = 0;
+    if (const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), percent); error != std::errc{} || end != text.data() + text.size() || percent <= 0 || percent > 100)
+        return false;
+    out_settings.dynamic   = false;
+    out_settings.scale     = static_cast<float>(percent) / 100.0f;
+    out_settings.min_scale = std::min(out_settings.min_scale, out_settings.scale);
+    return true;
+}
+
+std::string DynamicResolution::Format(const ResolutionSettings& settings)
+{
+    if (settings.dynamic)
+        return "dynamic";
+    return std::to_string(std::clamp(static_cast<int>(std::lround(settings.scale * 100.0f)), 1, 100));
+}
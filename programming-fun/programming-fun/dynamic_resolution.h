@@ -0,0 +1,65 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <string>
+#include <string_view>
+
+struct ResolutionSettings
+{
+    static constexpr float MIN_SCALE = 0.25f;
+
+    float scale         = 1.0f;  // of SceneBase, per axis; the starting point when dynamic
+    bool  dynamic       = false; // follow the GPU timer instead of `scale`
+    float target_ms     = 12.0f; // GPU frame time dynamic mode tries to stay under
+    float min_scale     = 0.5f;
+    float scene_density = 1.0f; // scene pixels per window point at most, 0 for every drawable pixel
+
+    bool operator==(const ResolutionSettings&) const = default;
+};
+
+/**
+ * Picks the render scale for the next frame.
+ *
+ * Fixed mode just clamps the setting. Dynamic mode smooths the GPU frame time and, since cost follows
+ * the pixel count, moves the scale by sqrt(target / measured), limited to MAX_STEP per change and
+ * snapped to SCALE_GRANULARITY so the render target is not reallocated every frame. It waits out the
+ * GPU query latency after each change before trusting the timer again, and only scales back up once
+ * there is HEADROOM below the target, which keeps it from oscillating around the edge.
+ */
+class DynamicResolution
+{
+public:
+    static constexpr float SCALE_GRANULARITY = 1.0f / 32.0f;
+    static constexpr float MAX_STEP          = 0.1f;
+    static constexpr float HEADROOM          = 0.85f;
+
+    // `gpu_ms` < 0 when no GPU timing is available: dynamic mode then holds its current scale
+    float Update(const ResolutionSettings& settings, double gpu_ms);
+    float Scale() const noexcept;
+
+    // What the scale applies to: the drawable, in pixels, capped at `scene_density` per window point. On a
+    // high-DPI display the UI draws at every pixel while the scene, at the default of 1, costs what it did
+    // on a display without the extra pixels, and is upscaled when presented
+    static glm::ivec2 SceneBase(glm::ivec2 drawable_size, glm::ivec2 window_size, float scene_density) noexcept;
+
+    // Controls for the caller's current window; returns true when something changed
+    static bool DrawImGui(ResolutionSettings& settings);
+
+    // "dynamic" or a percentage of the window size, e.g. "75"
+    static bool Parse(std::string_view text, ResolutionSettings& out_settings);
+    // What Parse reads back; the dynamic mode's target and floor are not part of it
+    static std::string Format(const ResolutionSettings& settings);
+
+private:
+    float  scale       = 1.0f;
+    double smoothed_ms = 0.0;
+    int    cooldown    = 0;
+    bool   was_dynamic = false;
+};
@@ -0,0 +1,110 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "entity_benchmark.h"
+
+#include "entity_store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr float STEP_SECONDS = 1.0f / 60.0f;
+    const glm::vec2 BOUNDS{ 1280.0f, 720.0f }; // not constexpr, glm's aligned types aren't
+
+    // what an object per sprite would look like; 32 bytes, of which a step touches 24
+    struct Duck
+    {
+        glm::vec2     position{ 0.0f };
+        glm::vec2     previous_position{ 0.0f };
+        glm::vec2     velocity{ 0.0f };
+        std::uint16_t sprite = 0;
+        std::uint32_t color  = 0xFFFFFFFFu;
+    };
+
+    // the same step as EntityStore::Integrate, written the way a loop over objects would be
+    void integrate(std::vector<Duck>& ducks, float step_seconds, const glm::vec2& bounds)
+    {
+        for (Duck& duck : ducks)
+        {
+            duck.previous_position = duck.position;
+            duck.position += duck.velocity * step_seconds;
+            if (duck.position.x < 0.0f || duck.position.x > bounds.x)
+                duck.velocity.x = -duck.velocity.x;
+            if (duck.position.y < 0.0f || duck.position.y > bounds.y)
+                duck.velocity.y = -duck.velocity.y;
+        }
+    }
+
+    template <typename Step>
+    void time_steps(int steps, double& best_ms, double& mean_ms, Step&& step)
+    {
+        using clock  = std::chrono::steady_clock;
+        double total = 0.0;
+        best_ms      = 0.0;
+        for (int i = 0; i < steps; ++i)
+        {
+            const auto begin = clock::now();
+            step();
+            const double ms = std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+            best_ms         = i == 0 ? ms : std::min(best_ms, ms);
+            total += ms;
+        }
+        mean_ms = steps > 0 ? total / steps : 0.0;
+    }
+}
+
+namespace entity_benchmark
+{
+    Result Run(int entity_count, int steps)
+    {
+        Result result;
+        result.entities = std::max(entity_count, 0);
+        result.steps    = std::max(steps, 1);
+
+        // identical starting states, from the same seed
+        std::mt19937                          random{ 2024 };
+        std::uniform_real_distribution<float> along_x{ 0.0f, BOUNDS.x };
+        std::uniform_real_distribution<float> along_y{ 0.0f, BOUNDS.y };
+        std::uniform_real_distribution<float> speed{ -200.0f, 200.0f };
+        std::vector<Duck>                     ducks(static_cast<std::size_t>(result.entities));
+        EntityStore                           store;
+        store.Reserve(ducks.size());
+        for (std::size_t i = 0; i < ducks.size(); ++i)
+        {
+            Duck& duck             = ducks[i];
+            duck.position          = glm::vec2{ along_x(random), along_y(random) };
+            duck.previous_position = duck.position;
+            duck.velocity          = glm::vec2{ speed(random), speed(random) };
+            duck.sprite            = static_cast<std::uint16_t>(i % 4);
+            store.Create(duck.position, duck.velocity, duck.sprite);
+        }
+
+        time_steps(result.steps, result.aos_best_ms, result.aos_mean_ms, [&ducks] { integrate(ducks, STEP_SECONDS, BOUNDS); });
+        time_steps(result.steps, result.soa_best_ms, result.soa_mean_ms, [&store] { store.Integrate(0, store.Size(), STEP_SECONDS, BOUNDS); });
+
+        for (const Duck& duck : ducks)
+            result.checksum += static_cast<double>(duck.position.x + duck.position.y);
+        for (const glm::vec2& position : store.Positions())
+            result.checksum += static_cast<double>(position.x + position.y);
+        return result;
+    }
+
+    void Print(std::ostream& out, const Result& result)
+    {
+        out << "Entity layouts, " << result.entities << " entities, " << result.steps << " steps\n";
+        out << "  array of structs: best " << result.aos_best_ms << " ms, mean " << result.aos_mean_ms << " ms\n";
+        out << "  struct of arrays: best " << result.soa_best_ms << " ms, mean " << result.soa_mean_ms << " ms\n";
+        if (result.soa_best_ms > 0.0)
+            out << "  speedup " << result.aos_best_ms / result.soa_best_ms << "x (checksum " << result.checksum << ")\n";
+    }
+}
@@ -0,0 +1,33 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <iosfwd>
+
+/**
+ * The stress ducks' fixed step timed two ways on the same entities: an array of structs, the way one
+ * `struct Duck` per sprite would hold them, against EntityStore's structure of arrays. Single threaded
+ * and without drawing, so the numbers are the memory layout and nothing else. Run with
+ * "--benchmark-entities [count]" before any window opens.
+ */
+namespace entity_benchmark
+{
+    struct Result
+    {
+        int    entities    = 0;
+        int    steps       = 0;
+        double aos_best_ms = 0.0; // per step
+        double aos_mean_ms = 0.0;
+        double soa_best_ms = 0.0;
+        double soa_mean_ms = 0.0;
+        double checksum    = 0.0; // of both runs' positions, printed so neither loop can be optimized away
+    };
+
+    Result Run(int entity_count = 1'000'000, int steps = 200);
+    void   Print(std::ostream& out, const Result& result);
+}
@@ -0,0 +1,299 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "entity_store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+EntityHandle EntityStore::Create(const glm::vec2& position, const glm::vec2& velocity, std::uint16_t sprite, std::uint32_t color)
+{
+    std::uint32_t slot = free_slot;
+    if (slot == EntityHandle::INVALID)
+    {
+        slot = static_cast<std::uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    else
+    {
+        free_slot = slots[slot].index;
+    }
+    slots[slot].index = static_cast<std::uint32_t>(positions.size());
+    positions.push_back(position);
+    previous_positions.push_back(position);
+    velocities.push_back(velocity);
+    sprites.push_back(sprite);
+    colors.push_back(color);
+    dense_slots.push_back(slot);
+    touchAll();
+    return EntityHandle{ slot, slots[slot].generation };
+}
+
+bool EntityStore::Destroy(EntityHandle handle)
+{
+    if (!Contains(handle))
+        return false;
+    Slot&               slot = slots[handle.slot];
+    const std::uint32_t hole = slot.index;
+    const std::size_t   last = positions.size() - 1;
+    if (hole != last)
+    {
+        positions[hole]                = positions[last];
+        previous_positions[hole]       = previous_positions[last];
+        velocities[hole]               = velocities[last];
+        sprites[hole]                  = sprites[last];
+        colors[hole]                   = colors[last];
+        dense_slots[hole]              = dense_slots[last];
+        slots[dense_slots[hole]].index = hole;
+    }
+    positions.pop_back();
+    previous_positions.pop_back();
+    velocities.pop_back();
+    sprites.pop_back();
+    colors.pop_back();
+    dense_slots.pop_back();
+
+    ++slot.generation;
+    slot.index = free_slot;
+    free_slot  = handle.slot;
+    touchAll();
+    return true;
+}
+
+void EntityStore::Truncate(std::size_t count)
+{
+    while (positions.size() > count)
+        Destroy(HandleAt(positions.size() - 1));
+}
+
+void EntityStore::Reserve(std::size_t count)
+{
+    positions.reserve(count);
+    previous_positions.reserve(count);
+    velocities.reserve(count);
+    sprites.reserve(count);
+    colors.reserve(count);
+    dense_slots.reserve(count);
+}
+
+void EntityStore::Clear()
+{
+    Truncate(0);
+}
+
+void EntityStore::Assign(std::span<const glm::vec2> new_positions, std::span<const glm::vec2> new_velocities, std::span<const std::uint16_t> new_sprites,
+                         std::span<const std::uint32_t> new_colors)
+{
+    assert(new_velocities.size() == new_positions.size() && new_sprites.size() == new_positions.size());
+    assert(new_colors.empty() || new_colors.size() == new_positions.size());
+    Clear();
+    // trivially copyable columns, so each assign is one memcpy
+    positions.assign(new_positions.begin(), new_positions.end());
+    previous_positions.assign(new_positions.begin(), new_positions.end());
+    velocities.assign(new_velocities.begin(), new_velocities.end());
+    sprites.assign(new_sprites.begin(), new_sprites.end());
+    if (new_colors.empty())
+        colors.assign(new_positions.size(), 0xFFFFFFFFu);
+    else
+        colors.assign(new_colors.begin(), new_colors.end());
+    // the slots Clear freed first, then new ones
+    dense_slots.resize(positions.size());
+    for (std::uint32_t index = 0; index < dense_slots.size(); ++index)
+    {
+        std::uint32_t slot = free_slot;
+        if (slot == EntityHandle::INVALID)
+        {
+            slot = static_cast<std::uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        else
+        {
+            free_slot = slots[slot].index;
+        }
+        slots[slot].index  = index;
+        dense_slots[index] = slot;
+    }
+    touchAll();
+}
+
+bool EntityStore::Contains(EntityHandle handle) const noexcept
+{
+    return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation && slots[handle.slot].index < dense_slots.size() &&
+           dense_slots[slots[handle.slot].index] == handle.slot;
+}
+
+std::size_t EntityStore::IndexOf(EntityHandle handle) const noexcept
+{
+    return Contains(handle) ? slots[handle.slot].index : Size();
+}
+
+EntityHandle EntityStore::HandleAt(std::size_t index) const noexcept
+{
+    if (index >= dense_slots.size())
+        return EntityHandle{};
+    const std::uint32_t slot = dense_slots[index];
+    return EntityHandle{ slot, slots[slot].generation };
+}
+
+std::size_t EntityStore::Size() const noexcept
+{
+    return positions.size();
+}
+
+bool EntityStore::IsEmpty() const noexcept
+{
+    return positions.empty();
+}
+
+void EntityStore::Integrate(std::size_t begin, std::size_t end, float step_seconds, const glm::vec2& bounds) noexcept
+{
+    end = std::min(end, positions.size());
+    if (begin >= end)
+        return;
+    // one pass over raw pointers with selects instead of branches, simple enough to vectorize
+    glm::vec2* const position = positions.data();
+    glm::vec2* const velocity = velocities.data();
+    glm::vec2* const previous = previous_positions.data();
+    for (const Column column : { POSITIONS, PREVIOUS_POSITIONS, VELOCITIES })
+        std::atomic_ref<std::uint64_t>(versions[column]).store(epoch, std::memory_order_relaxed);
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        previous[i]          = position[i];
+        const glm::vec2 next = position[i] + velocity[i] * step_seconds;
+        position[i]          = next;
+        velocity[i].x        = (next.x < 0.0f || next.x > bounds.x) ? -velocity[i].x : velocity[i].x;
+        velocity[i].y        = (next.y < 0.0f || next.y > bounds.y) ? -velocity[i].y : velocity[i].y;
+    }
+}
+
+std::span<glm::vec2> EntityStore::Positions() noexcept
+{
+    touch(POSITIONS);
+    return positions;
+}
+
+std::span<const glm::vec2> EntityStore::Positions() const noexcept
+{
+    return positions;
+}
+
+std::span<glm::vec2> EntityStore::PreviousPositions() noexcept
+{
+    touch(PREVIOUS_POSITIONS);
+    return previous_positions;
+}
+
+std::span<const glm::vec2> EntityStore::PreviousPositions() const noexcept
+{
+    return previous_positions;
+}
+
+std::span<glm::vec2> EntityStore::Velocities() noexcept
+{
+    touch(VELOCITIES);
+    return velocities;
+}
+
+std::span<const glm::vec2> EntityStore::Velocities() const noexcept
+{
+    return velocities;
+}
+
+std::span<const std::uint16_t> EntityStore::Sprites() const noexcept
+{
+    return sprites;
+}
+
+std::span<const std::uint32_t> EntityStore::Colors() const noexcept
+{
+    return colors;
+}
+
+std::size_t EntityStore::Save(Snapshot& snapshot)
+{
+    // a snapshot some other store saved into has nothing of this one's
+    if (snapshot.source != this)
+    {
+        snapshot.source = this;
+        snapshot.versions.fill(0);
+    }
+    std::size_t copied = 0;
+    const auto  save   = [&]<typename T>(Column column, const std::vector<T>& from, std::vector<T>& to)
+    {
+        if (snapshot.versions[column] == versions[column])
+            return;
+        to.assign(from.begin(), from.end());
+        snapshot.versions[column] = versions[column];
+        copied += from.size() * sizeof(T);
+    };
+    save(POSITIONS, positions, snapshot.positions);
+    save(PREVIOUS_POSITIONS, previous_positions, snapshot.previous_positions);
+    save(VELOCITIES, velocities, snapshot.velocities);
+    save(SPRITES, sprites, snapshot.sprites);
+    save(COLORS, colors, snapshot.colors);
+    if (snapshot.versions[HANDLES] != versions[HANDLES])
+    {
+        snapshot.dense_slots.assign(dense_slots.begin(), dense_slots.end());
+        snapshot.slots.assign(slots.begin(), slots.end());
+        snapshot.free_slot         = free_slot;
+        snapshot.versions[HANDLES] = versions[HANDLES];
+        copied += dense_slots.size() * sizeof(std::uint32_t) + slots.size() * sizeof(Slot);
+    }
+    // anything written from here on is newer than what the snapshot holds
+    ++epoch;
+    return copied;
+}
+
+std::size_t EntityStore::Restore(const Snapshot& snapshot)
+{
+    assert(snapshot.source == this);
+    if (snapshot.source != this)
+        return 0;
+    std::size_t copied  = 0;
+    const auto  restore = [&]<typename T>(Column column, const std::vector<T>& from, std::vector<T>& to)
+    {
+        if (snapshot.versions[column] == versions[column])
+            return;
+        // assign keeps the capacity, so a rollback within what the store has held allocates nothing
+        to.assign(from.begin(), from.end());
+        copied += from.size() * sizeof(T);
+    };
+    restore(POSITIONS, snapshot.positions, positions);
+    restore(PREVIOUS_POSITIONS, snapshot.previous_positions, previous_positions);
+    restore(VELOCITIES, snapshot.velocities, velocities);
+    restore(SPRITES, snapshot.sprites, sprites);
+    restore(COLORS, snapshot.colors, colors);
+    restore(HANDLES, snapshot.dense_slots, dense_slots);
+    restore(HANDLES, snapshot.slots, slots);
+    free_slot = snapshot.free_slot;
+    // the columns are as they were at the snapshot's versions again; the epoch stays ahead of both
+    versions = snapshot.versions;
+    ++epoch;
+    return copied;
+}
+
+void EntityStore::touch(Column column) noexcept
+{
+    versions[column] = epoch;
+}
+
+void EntityStore::touchAll() noexcept
+{
+    versions.fill(epoch);
+}
+
+std::size_t EntityStore::Snapshot::Size() const noexcept
+{
+    return positions.size();
+}
+
+std::size_t EntityStore::Snapshot::Bytes() const noexcept
+{
+    return (positions.size() + previous_positions.size() + velocities.size()) * sizeof(glm::vec2) + sprites.size() * sizeof(std::uint16_t) +
+           (colors.size() + dense_slots.size()) * sizeof(std::uint32_t) + slots.size() * sizeof(Slot);
+}
@@ -0,0 +1,155 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <span>
+#include <vector>
+
+// A reference to an entity that outlives other entities coming and going; stale once its entity is destroyed
+struct EntityHandle
+{
+    static constexpr std::uint32_t INVALID = 0xFFFFFFFFu;
+
+    std::uint32_t slot       = INVALID;
+    std::uint32_t generation = 0;
+
+    bool IsValid() const noexcept
+    {
+        return slot != INVALID;
+    }
+
+    bool operator==(const EntityHandle&) const noexcept = default;
+};
+
+/**
+ * Moving sprites as a structure of arrays: position, previous position, velocity, sprite id and color each
+ * in a dense array of their own, with no holes, so an update over one field walks contiguous memory and
+ * the compiler can vectorize it.
+ *
+ * Handles go through a sparse set: each one names a slot that holds the entity's dense index and a
+ * generation, bumped when the entity is destroyed so old handles stop matching. Destroy moves the last
+ * entity into the hole to keep the arrays packed, which changes that one's dense index but never its
+ * handle; Truncate removes from the end and moves nobody, so callers keyed by dense index keep working.
+ *
+ * Each column carries the version it was last written at: whatever changes a column, or hands out a span that
+ * could, stamps it with the current epoch, and Save starts a new one. A Snapshot remembers the version of each
+ * column it holds, so Save and Restore copy only the columns that differ between the two, which for a step that
+ * only moves the ducks leaves out the sprites, colors and handles.
+ */
+class EntityStore
+{
+public:
+    // A copy of the columns to roll back to
+    class Snapshot;
+
+    EntityHandle Create(const glm::vec2& position, const glm::vec2& velocity, std::uint16_t sprite = 0, std::uint32_t color = 0xFFFFFFFFu);
+    // false when the handle was already stale
+    bool Destroy(EntityHandle handle);
+    // Destroys every entity from dense index `count` on
+    void Truncate(std::size_t count);
+    void Reserve(std::size_t count);
+    void Clear();
+    // Replaces every entity with these columns, copied whole; entity i gets dense index i and every earlier handle
+    // goes stale. The spans share a length; `colors` may be empty for all white.
+    void Assign(std::span<const glm::vec2> positions, std::span<const glm::vec2> velocities, std::span<const std::uint16_t> sprites,
+                std::span<const std::uint32_t> colors);
+
+    bool         Contains(EntityHandle handle) const noexcept;
+    // Size() for a stale handle
+    std::size_t  IndexOf(EntityHandle handle) const noexcept;
+    EntityHandle HandleAt(std::size_t index) const noexcept;
+    std::size_t  Size() const noexcept;
+    bool         IsEmpty() const noexcept;
+
+    // One fixed step over dense [begin, end): remembers the previous positions, moves, and turns
+    // around whatever left [0, bounds]; disjoint ranges can run on different threads
+    void Integrate(std::size_t begin, std::size_t end, float step_seconds, const glm::vec2& bounds) noexcept;
+
+    std::span<glm::vec2>           Positions() noexcept;
+    std::span<const glm::vec2>     Positions() const noexcept;
+    std::span<glm::vec2>           PreviousPositions() noexcept;
+    std::span<const glm::vec2>     PreviousPositions() const noexcept;
+    std::span<glm::vec2>           Velocities() noexcept;
+    std::span<const glm::vec2>     Velocities() const noexcept;
+    std::span<const std::uint16_t> Sprites() const noexcept;
+    std::span<const std::uint32_t> Colors() const noexcept;
+
+    // Copies the columns that changed since `snapshot` last held them; the bytes copied
+    std::size_t Save(Snapshot& snapshot);
+    // Puts back the columns that differ from `snapshot`, which this store saved; the bytes copied. Handles go back
+    // to what they were, so ones made since are stale and ones destroyed since are valid again
+    std::size_t Restore(const Snapshot& snapshot);
+
+private:
+    struct Slot
+    {
+        std::uint32_t index      = 0; // dense, or the next free slot once destroyed
+        std::uint32_t generation = 0;
+    };
+
+    enum Column
+    {
+        POSITIONS,
+        PREVIOUS_POSITIONS,
+        VELOCITIES,
+        SPRITES,
+        COLORS,
+        HANDLES, // dense_slots, slots and free_slot
+        COLUMN_COUNT
+    };
+
+    void touch(Column column) noexcept;
+    void touchAll() noexcept;
+
+private:
+    // dense, all the same length
+    std::vector<glm::vec2>     positions;
+    std::vector<glm::vec2>     previous_positions; // as of the step before, for interpolation
+    std::vector<glm::vec2>     velocities;
+    std::vector<std::uint16_t> sprites; // whatever the owner draws them with
+    std::vector<std::uint32_t> colors;  // RGBA8, like SpriteInstance
+    std::vector<std::uint32_t> dense_slots;
+    // sparse
+    std::vector<Slot> slots;
+    std::uint32_t     free_slot = EntityHandle::INVALID;
+    // Integrate's threads stamp them alongside each other, through atomic_ref
+    alignas(std::atomic_ref<std::uint64_t>::required_alignment) std::array<std::uint64_t, COLUMN_COUNT> versions{};
+    std::uint64_t epoch = 1; // what a write stamps now
+};
+
+/**
+ * The store's columns as of a Save, with the sparse set, in buffers that keep their capacity: saving into the same
+ * snapshot again allocates nothing once it has held as many entities, so a ring of them is a pool. Valid for the
+ * store that saved it.
+ */
+class EntityStore::Snapshot
+{
+public:
+    std::size_t Size() const noexcept;
+    // what the columns hold, not their capacity
+    std::size_t Bytes() const noexcept;
+
+private:
+    friend class EntityStore;
+
+    const EntityStore*                      source = nullptr; // the store that saved into it last
+    std::array<std::uint64_t, COLUMN_COUNT> versions{};       // as of that Save
+    std::vector<glm::vec2>                  positions;
+    std::vector<glm::vec2>                  previous_positions;
+    std::vector<glm::vec2>                  velocities;
+    std::vector<std::uint16_t>              sprites;
+    std::vector<std::uint32_t>              colors;
+    std::vector<std::uint32_t>              dense_slots;
+    std::vector<Slot>                       slots;
+    std::uint32_t                           free_slot = EntityHandle::INVALID;
+};
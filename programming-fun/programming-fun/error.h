@@ -0,0 +1,22 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "logger.h"
+
+#include <sstream>
+#include <stdexcept>
+
+template <typename... Messages>
+[[noreturn]] void throw_error_message(Messages&&... more_messages)
+{
+    std::ostringstream sout;
+    (sout << ... << more_messages);
+    LOG_ERROR(sout.str());
+    throw std::runtime_error{ sout.str() };
+}
@@ -0,0 +1,60 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "fixed_timestep.h"
+
+#include <algorithm>
+#include <cmath>
+
+FixedTimestep::FixedTimestep(double step, int steps) noexcept : step_seconds{ std::max(step, 1e-4) }, max_steps{ std::max(steps, 1) }
+{
+}
+
+int FixedTimestep::Advance(double frame_seconds) noexcept
+{
+    accumulator += std::max(frame_seconds, 0.0);
+    last_steps = 0;
+    while (accumulator >= step_seconds && last_steps < max_steps)
+    {
+        accumulator -= step_seconds;
+        ++last_steps;
+    }
+    // keep less than one step so the clamp actually sheds the backlog
+    if (accumulator >= step_seconds)
+    {
+        const double excess = accumulator - std::fmod(accumulator, step_seconds);
+        dropped += excess;
+        accumulator -= excess;
+    }
+    return last_steps;
+}
+
+float FixedTimestep::Alpha() const noexcept
+{
+    return static_cast<float>(accumulator / step_seconds);
+}
+
+double FixedTimestep::StepSeconds() const noexcept
+{
+    return step_seconds;
+}
+
+void FixedTimestep::SetStepSeconds(double step) noexcept
+{
+    step_seconds = std::max(step, 1e-4);
+    accumulator  = std::min(accumulator, step_seconds * 0.999);
+}
+
+int FixedTimestep::LastStepCount() const noexcept
+{
+    return last_steps;
+}
+
+double FixedTimestep::DroppedSeconds() const noexcept
+{
+    return dropped;
+}
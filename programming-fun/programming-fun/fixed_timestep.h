@@ -0,0 +1,40 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+/**
+ * Accumulator that turns variable frame times into a whole number of fixed simulation steps.
+ *
+ * Advance returns how many steps to run this frame, at most `max_steps`; time beyond that is dropped
+ * so a slow frame cannot snowball into ever more steps (the spiral of death). Alpha is how far the
+ * leftover time reaches into the next step, for blending the last two simulation states when drawing.
+ */
+class FixedTimestep
+{
+public:
+    static constexpr double DEFAULT_STEP_SECONDS = 1.0 / 60.0;
+    static constexpr int    DEFAULT_MAX_STEPS    = 5;
+
+    explicit FixedTimestep(double step_seconds = DEFAULT_STEP_SECONDS, int max_steps = DEFAULT_MAX_STEPS) noexcept;
+
+    int Advance(double frame_seconds) noexcept;
+
+    float  Alpha() const noexcept;
+    double StepSeconds() const noexcept;
+    void   SetStepSeconds(double step_seconds) noexcept;
+
+    int    LastStepCount() const noexcept;
+    double DroppedSeconds() const noexcept; // total time thrown away by the clamp
+
+private:
+    double step_seconds = DEFAULT_STEP_SECONDS;
+    int    max_steps    = DEFAULT_MAX_STEPS;
+    double accumulator  = 0.0;
+    double dropped      = 0.0;
+    int    last_steps   = 0;
+};
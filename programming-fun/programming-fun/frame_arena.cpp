@@ -0,0 +1,108 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+FrameArena::FrameArena(std::size_t initial_capacity) : block{ std::make_unique_for_overwrite<std::byte[]>(initial_capacity) }, capacity{ initial_capacity }
+{
+}
+
+void FrameArena::Reset()
+{
+    high_water = std::max(high_water, offset + overflow_bytes);
+    if (!overflow.empty())
+    {
+        // one block for everything this frame needed, rounded up so a slowly growing frame doesn't regrow every time
+        capacity = std::bit_ceil(capacity + overflow_bytes);
+        block    = std::make_unique_for_overwrite<std::byte[]>(capacity);
+        overflow.clear();
+        overflow_bytes = 0;
+    }
+    offset = 0;
+}
+
+std::size_t FrameArena::BytesUsed() const noexcept
+{
+    return offset + overflow_bytes;
+}
+
+std::size_t FrameArena::HighWater() const noexcept
+{
+    return std::max(high_water, offset + overflow_bytes);
+}
+
+std::size_t FrameArena::Capacity() const noexcept
+{
+    return capacity;
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    const auto        base    = reinterpret_cast<std::uintptr_t>(block.get());
+    const std::size_t aligned = ((base + offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1)) - base;
+    if (aligned + bytes <= capacity)
+    {
+        offset = aligned + bytes;
+        return block.get() + aligned;
+    }
+
+    // new[] of std::byte only promises fundamental alignment, so over-allocate for the rest
+    overflow.push_back(std::make_unique_for_overwrite<std::byte[]>(bytes + alignment));
+    overflow_bytes += bytes + alignment;
+    void*       pointer = overflow.back().get();
+    std::size_t space   = bytes + alignment;
+    return std::align(alignment, bytes, pointer, space);
+}
+
+void FrameArena::do_deallocate(void*, std::size_t, std::size_t)
+{
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+FrameArena& FrameArenas::BeginFrame()
+{
+    current = (current + 1) % FRAMES_IN_FLIGHT;
+    arenas[static_cast<std::size_t>(current)].Reset();
+    return arenas[static_cast<std::size_t>(current)];
+}
+
+FrameArena& FrameArenas::Current() noexcept
+{
+    return arenas[static_cast<std::size_t>(current)];
+}
+
+std::size_t FrameArenas::BytesUsed() const noexcept
+{
+    std::size_t total = 0;
+    for (const FrameArena& arena : arenas)
+        total += arena.BytesUsed();
+    return total;
+}
+
+std::size_t FrameArenas::HighWater() const noexcept
+{
+    std::size_t highest = 0;
+    for (const FrameArena& arena : arenas)
+        highest = std::max(highest, arena.HighWater());
+    return highest;
+}
+
+std::size_t FrameArenas::Capacity() const noexcept
+{
+    std::size_t total = 0;
+    for (const FrameArena& arena : arenas)
+        total += arena.Capacity();
+    return total;
+}
@@ -0,0 +1,75 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * Bump allocator for data that lives for one frame, usable by std::pmr containers.
+ *
+ * Allocation is a pointer bump; deallocate does nothing and Reset frees everything at once.
+ * When a frame outgrows the block it spills into extra blocks from the heap, and the next Reset
+ * replaces them with one block big enough for the whole frame, so steady state never touches the heap.
+ */
+class FrameArena final : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1024 * 1024;
+
+    explicit FrameArena(std::size_t capacity = DEFAULT_CAPACITY);
+
+    FrameArena(const FrameArena&)                = delete;
+    FrameArena& operator=(const FrameArena&)     = delete;
+    FrameArena(FrameArena&&) noexcept            = delete;
+    FrameArena& operator=(FrameArena&&) noexcept = delete;
+
+    void Reset();
+
+    std::size_t BytesUsed() const noexcept;
+    std::size_t HighWater() const noexcept; // most bytes any single frame has used
+    std::size_t Capacity() const noexcept;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void  do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    std::unique_ptr<std::byte[]>              block;
+    std::size_t                               capacity = 0;
+    std::size_t                               offset   = 0;
+    std::vector<std::unique_ptr<std::byte[]>> overflow;
+    std::size_t                               overflow_bytes = 0;
+    std::size_t                               high_water     = 0;
+};
+
+/**
+ * One FrameArena per frame in flight, so frame N can be built while N-1 and N-2 are still being rendered.
+ *
+ * BeginFrame moves to the next arena and resets it; the caller guarantees whatever used it three frames ago is done.
+ */
+class FrameArenas
+{
+public:
+    static constexpr int FRAMES_IN_FLIGHT = 3;
+
+    FrameArena& BeginFrame();
+    FrameArena& Current() noexcept;
+
+    std::size_t BytesUsed() const noexcept; // across every arena
+    std::size_t HighWater() const noexcept;
+    std::size_t Capacity() const noexcept;
+
+private:
+    std::array<FrameArena, FRAMES_IN_FLIGHT> arenas;
+    int                                      current = 0;
+};
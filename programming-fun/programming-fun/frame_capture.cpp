@@ -0,0 +1,184 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "frame_capture.h"
+
+#include "logger.h"
+#include "png_writer.h"
+#include "profiler.h"
+#include "worker_pool.h"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    std::size_t frame_bytes(glm::ivec2 size) noexcept
+    {
+        return static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y) * 4;
+    }
+}
+
+FrameCapture::~FrameCapture()
+{
+    Shutdown();
+}
+
+void FrameCapture::Setup(WorkerPool& worker_pool)
+{
+    workers = &worker_pool;
+    for (Slot& slot : slots)
+    {
+        if (slot.buffer == 0)
+            glGenBuffers(1, &slot.buffer);
+    }
+}
+
+void FrameCapture::Shutdown()
+{
+    if (workers == nullptr)
+        return;
+    // the last frames of a sequence are still in flight when the window closes; they are worth the wait
+    for (; pending > 0; --pending, oldest = (oldest + 1) % SLOTS)
+    {
+        Slot& slot = slots[static_cast<std::size_t>(oldest)];
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+        collect(slot);
+    }
+    while (encoding.load(std::memory_order_acquire) > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+    for (Slot& slot : slots)
+    {
+        if (slot.buffer != 0)
+            glDeleteBuffers(1, &slot.buffer);
+        slot = Slot{};
+    }
+    oldest  = 0;
+    workers = nullptr;
+}
+
+bool FrameCapture::Read(glm::ivec2 size, std::filesystem::path filename, GLuint framebuffer)
+{
+    if (workers == nullptr || size.x <= 0 || size.y <= 0)
+        return false;
+    if (pending == SLOTS)
+    {
+        ++stats.dropped;
+        return false;
+    }
+    Slot&             slot  = slots[static_cast<std::size_t>((oldest + pending) % SLOTS)];
+    const std::size_t bytes = frame_bytes(size);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (bytes > slot.capacity)
+    {
+        // only ever grows, a sequence at one window size reuses the same storage
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+        slot.capacity = bytes;
+    }
+    // into the buffer, so this returns once the copy is queued rather than done
+    glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence    = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.size     = size;
+    slot.filename = std::move(filename);
+    ++pending;
+    ++stats.read;
+    return true;
+}
+
+void FrameCapture::Update()
+{
+    while (pending > 0 && encoding.load(std::memory_order_relaxed) < MAX_ENCODING)
+    {
+        Slot&        slot   = slots[static_cast<std::size_t>(oldest)];
+        const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        collect(slot);
+        oldest = (oldest + 1) % SLOTS;
+        --pending;
+    }
+}
+
+void FrameCapture::WaitForSlot()
+{
+    if (pending < SLOTS)
+        return;
+    Slot& slot = slots[static_cast<std::size_t>(oldest)];
+    glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+    collect(slot);
+    oldest = (oldest + 1) % SLOTS;
+    --pending;
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const noexcept
+{
+    Stats current     = stats;
+    current.written   = written.load(std::memory_order_relaxed);
+    current.failed    = failed.load(std::memory_order_relaxed);
+    current.in_flight = pending;
+    current.encoding  = encoding.load(std::memory_order_relaxed);
+    return current;
+}
+
+void FrameCapture::collect(Slot& slot)
+{
+    PROFILE_ZONE("Frame Capture Map");
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    const std::size_t bytes  = frame_bytes(slot.size);
+    auto              pixels = std::make_unique_for_overwrite<unsigned char[]>(bytes);
+    bool              is_ok  = true;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+#if defined(IS_WEBGL2)
+    // WebGL2 can't map a buffer; getBufferSubData is its non-blocking read once the fence has signalled
+    glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), pixels.get());
+#else
+    if (const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_READ_BIT); mapped != nullptr)
+    {
+        std::memcpy(pixels.get(), mapped, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+    {
+        is_ok = false;
+    }
+#endif
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!is_ok)
+    {
+        LOG_ERROR("Failed to map the frame capture of ", slot.filename);
+        failed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // a background job, not a counted one, so a Wait on the main thread never picks up an encode
+    encoding.fetch_add(1, std::memory_order_relaxed);
+    workers->Submit(
+        [this, pixels = std::shared_ptr<unsigned char[]>{ std::move(pixels) }, size = slot.size, filename = slot.filename]
+        {
+            PROFILE_ZONE("Frame Capture Encode");
+            // GL's rows go bottom-up, so start at the last one and step back
+            const std::ptrdiff_t stride = static_cast<std::ptrdiff_t>(size.x) * 4;
+            if (png_writer::Write(filename, pixels.get() + stride * (size.y - 1), size.x, size.y, -stride))
+            {
+                written.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                LOG_ERROR("Failed to write the frame capture ", filename);
+                failed.fetch_add(1, std::memory_order_relaxed);
+            }
+            encoding.fetch_sub(1, std::memory_order_release);
+        });
+}
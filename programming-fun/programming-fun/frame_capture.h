@@ -0,0 +1,90 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glm/vec2.hpp>
+
+class WorkerPool;
+
+/**
+ * Screenshots and short frame sequences written as PNGs without stalling the frame that took them.
+ *
+ * glReadPixels into client memory waits for the GPU to finish the frame. Read instead has the driver copy the
+ * backbuffer into one of SLOTS pixel pack buffers and fences it; Update maps a slot only once its fence has
+ * signalled, a few frames later, copies the pixels out and hands them to a worker that flips the rows and encodes
+ * the PNG (png_writer). A frame that finds every slot waiting is dropped rather than waited for, and slots stop
+ * being collected while MAX_ENCODING frames are still with the workers, so a sequence at full frame rate costs
+ * the GPU copy and one memcpy a frame and degrades to gaps when the disk or the workers can't keep up.
+ * The stats count those gaps. GL thread only, apart from the encodes.
+ */
+class FrameCapture
+{
+public:
+    static constexpr int SLOTS        = 4;
+    static constexpr int MAX_ENCODING = 8;
+
+    struct Stats
+    {
+        std::uint64_t read      = 0; // readbacks issued
+        std::uint64_t written   = 0;
+        std::uint64_t dropped   = 0; // frames that found every slot taken
+        std::uint64_t failed    = 0; // couldn't be mapped or written
+        int           in_flight = 0; // readbacks the GPU hasn't finished or Update hasn't collected
+        int           encoding  = 0;
+    };
+
+    FrameCapture() = default;
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&)                = delete;
+    FrameCapture& operator=(const FrameCapture&)     = delete;
+    FrameCapture(FrameCapture&&) noexcept            = delete;
+    FrameCapture& operator=(FrameCapture&&) noexcept = delete;
+
+    void Setup(WorkerPool& workers);
+    // Collects what is still in flight, waiting for the GPU and the workers, then frees the buffers
+    void Shutdown();
+
+    // Queues a copy of the bottom-left `size` of `framebuffer`, the backbuffer by default, to be written to `filename`;
+    // false when it was dropped
+    bool  Read(glm::ivec2 size, std::filesystem::path filename, GLuint framebuffer = 0);
+    // Collects the oldest readback, waiting for the GPU, when every slot holds one; for captures that can't be dropped
+    void  WaitForSlot();
+    // Once a frame: hands the slots whose copy is done to the workers, oldest first
+    void  Update();
+    Stats GetStats() const noexcept;
+
+private:
+    struct Slot
+    {
+        GLuint                buffer   = 0;
+        std::size_t           capacity = 0;
+        GLsync                fence    = nullptr;
+        glm::ivec2            size{ 0 };
+        std::filesystem::path filename;
+    };
+
+    // maps the slot's buffer, copies it out and submits the encode; the slot is free again afterwards
+    void collect(Slot& slot);
+
+private:
+    WorkerPool*                workers = nullptr;
+    std::array<Slot, SLOTS>    slots;
+    int                        oldest  = 0; // the slot Update collects next
+    int                        pending = 0; // slots from `oldest` on that hold a readback
+    Stats                      stats;
+    std::atomic<int>           encoding{ 0 };
+    std::atomic<std::uint64_t> written{ 0 };
+    std::atomic<std::uint64_t> failed{ 0 };
+};
@@ -0,0 +1,255 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "frame_pacer.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <charconv>
+#include <imgui.h>
+#include <iostream>
+
+#if defined(__EMSCRIPTEN__)
+#    include <emscripten.h>
+#endif
+
+namespace
+{
+    constexpr int MIN_TARGET_FPS = 10;
+    constexpr int MAX_TARGET_FPS = 1000;
+    // a fence this late means a lost device or a hidden window; stop waiting rather than hang the loop
+    constexpr GLuint64 FENCE_TIMEOUT_NS = 1'000'000'000;
+
+    double ticks_to_ms(Uint64 ticks)
+    {
+        return static_cast<double>(ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    // the display the current window is on, assuming 60 Hz when it won't say
+    double refresh_period_ms()
+    {
+        SDL_DisplayMode mode{};
+        SDL_Window*     window = SDL_GL_GetCurrentWindow();
+        if (window == nullptr || SDL_GetCurrentDisplayMode(std::max(SDL_GetWindowDisplayIndex(window), 0), &mode) != 0 || mode.refresh_rate <= 0)
+            return 1000.0 / 60.0;
+        return 1000.0 / static_cast<double>(mode.refresh_rate);
+    }
+}
+
+void FramePacer::Apply(const PacingSettings& settings)
+{
+    PacingSettings clamped   = settings;
+    clamped.target_fps       = std::clamp(settings.target_fps, MIN_TARGET_FPS, MAX_TARGET_FPS);
+    clamped.frames_in_flight = std::clamp(settings.frames_in_flight, 1, PacingSettings::MAX_FRAMES_IN_FLIGHT);
+    if (is_applied && clamped == current)
+        return;
+    const bool swap_changed = !is_applied || clamped.mode != current.mode;
+#if defined(__EMSCRIPTEN__)
+    // the browser's timer carries the target rate too
+    is_timing_due = is_timing_due || swap_changed || clamped.target_fps != current.target_fps;
+#endif
+    current       = clamped;
+    is_applied    = true;
+    next_deadline = 0;
+#if !defined(__EMSCRIPTEN__)
+    if (swap_changed)
+        applySwapInterval();
+#endif
+}
+
+void FramePacer::WaitForNextFrame()
+{
+#if !defined(__EMSCRIPTEN__)
+    if (current.mode != PacingMode::TargetFps)
+        return;
+
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 period    = frequency / static_cast<Uint64>(current.target_fps);
+    Uint64       now       = SDL_GetPerformanceCounter();
+    if (next_deadline == 0 || now > next_deadline + period)
+    {
+        next_deadline = now + period;
+        return;
+    }
+
+    const double remaining_ms = (next_deadline > now) ? static_cast<double>(next_deadline - now) * 1000.0 / static_cast<double>(frequency) : 0.0;
+    if (remaining_ms > SPIN_MARGIN_MS)
+        SDL_Delay(static_cast<Uint32>(remaining_ms - SPIN_MARGIN_MS));
+    while ((now = SDL_GetPerformanceCounter()) < next_deadline)
+    {
+        // spin; SDL_Delay(0) would hand the rest of the slice to whoever asks
+    }
+    next_deadline += period;
+#else
+    if (is_timing_due)
+        applyBrowserTiming();
+#endif
+}
+
+void FramePacer::EndFrame(Uint64 input_ticks)
+{
+#if !defined(__EMSCRIPTEN__)
+    const Uint64 begin = SDL_GetPerformanceCounter();
+    // those already done give their estimate without a wait
+    while (count > 0)
+    {
+        const GLenum status = glClientWaitSync(in_flight[static_cast<std::size_t>(oldest)].fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        finishOldest(begin);
+    }
+    InFlight& frame   = in_flight[static_cast<std::size_t>((oldest + count) % PacingSettings::MAX_FRAMES_IN_FLIGHT)];
+    frame.fence       = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame.input_ticks = input_ticks;
+    ++count;
+    while (count >= current.frames_in_flight)
+    {
+        // flushed, or a fence still sitting in the command buffer never signals
+        const GLenum status = glClientWaitSync(in_flight[static_cast<std::size_t>(oldest)].fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        finishOldest(status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED ? SDL_GetPerformanceCounter() : 0);
+    }
+    stats.frames_in_flight = count;
+    stats.wait_ms          = ticks_to_ms(SDL_GetPerformanceCounter() - begin);
+#else
+    (void)input_ticks;
+#endif
+}
+
+FramePacer::Stats FramePacer::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+void FramePacer::Shutdown()
+{
+    for (; count > 0; --count)
+    {
+        glDeleteSync(in_flight[static_cast<std::size_t>(oldest)].fence);
+        in_flight[static_cast<std::size_t>(oldest)] = InFlight{};
+        oldest = (oldest + 1) % PacingSettings::MAX_FRAMES_IN_FLIGHT;
+    }
+    stats = Stats{};
+}
+
+bool FramePacer::DrawImGui(PacingSettings& settings)
+{
+    static constexpr const char* MODE_NAMES[] = { "vsync", "adaptive vsync", "half rate vsync", "uncapped", "target fps" };
+
+    bool changed      = false;
+    int  current_mode = static_cast<int>(settings.mode);
+    if (ImGui::Combo("pacing", &current_mode, MODE_NAMES, IM_ARRAYSIZE(MODE_NAMES)))
+    {
+        settings.mode = static_cast<PacingMode>(current_mode);
+        changed       = true;
+    }
+    if (settings.mode == PacingMode::TargetFps)
+    {
+        changed = ImGui::SliderInt("target fps", &settings.target_fps, MIN_TARGET_FPS, MAX_TARGET_FPS, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic) || changed;
+    }
+    changed = ImGui::SliderInt("frames in flight", &settings.frames_in_flight, 1, PacingSettings::MAX_FRAMES_IN_FLIGHT, "%d", ImGuiSliderFlags_AlwaysClamp) || changed;
+    ImGui::SetItemTooltip("fewer is fresher input, more is smoother throughput");
+    return changed;
+}
+
+bool FramePacer::Parse(std::string_view text, PacingSettings& out_settings)
+{
+    if (text == "vsync")
+        out_settings.mode = PacingMode::VSync;
+    else if (text == "adaptive")
+        out_settings.mode = PacingMode::Adaptive;
+    else if (text == "half")
+        out_settings.mode = PacingMode::HalfRate;
+    else if (text == "uncapped")
+        out_settings.mode = PacingMode::Uncapped;
+    else
+    {
+        int fps = 0;
+        if (const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), fps); error != std::errc{} || end != text.data() + text.size() || fps <= 0)
+            return false;
+        out_settings.mode       = PacingMode::TargetFps;
+        out_settings.target_fps = fps;
+    }
+    return true;
+}
+
+std::string FramePacer::Format(const PacingSettings& settings)
+{
+    switch (settings.mode)
+    {
+        case PacingMode::VSync: return "vsync";
+        case PacingMode::Adaptive: return "adaptive";
+        case PacingMode::HalfRate: return "half";
+        case PacingMode::Uncapped: return "uncapped";
+        case PacingMode::TargetFps: break;
+    }
+    return std::to_string(settings.target_fps);
+}
+
+void FramePacer::applySwapInterval()
+{
+    // https://wiki.libsdl.org/SDL_GL_SetSwapInterval
+    constexpr int ADAPTIVE_VSYNC = -1;
+    constexpr int VSYNC          = 1;
+    constexpr int HALF_RATE      = 2;
+    constexpr int IMMEDIATE      = 0;
+    switch (current.mode)
+    {
+        case PacingMode::VSync: SDL_GL_SetSwapInterval(VSYNC); break;
+        case PacingMode::Adaptive:
+            if (SDL_GL_SetSwapInterval(ADAPTIVE_VSYNC) != 0)
+            {
+                std::cout << "Adaptive vsync is not supported, using vsync: " << SDL_GetError() << '\n';
+                SDL_GL_SetSwapInterval(VSYNC);
+            }
+            break;
+        case PacingMode::HalfRate:
+            if (SDL_GL_SetSwapInterval(HALF_RATE) != 0)
+            {
+                std::cout << "A swap interval of 2 is not supported, using vsync: " << SDL_GetError() << '\n';
+                SDL_GL_SetSwapInterval(VSYNC);
+            }
+            break;
+        case PacingMode::Uncapped:
+        case PacingMode::TargetFps: SDL_GL_SetSwapInterval(IMMEDIATE); break;
+    }
+}
+
+void FramePacer::applyBrowserTiming()
+{
+#if defined(__EMSCRIPTEN__)
+    // https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_set_main_loop_timing
+    int failed = 0;
+    switch (current.mode)
+    {
+        case PacingMode::VSync:
+        case PacingMode::Adaptive: failed = emscripten_set_main_loop_timing(EM_TIMING_RAF, 1); break;
+        case PacingMode::HalfRate: failed = emscripten_set_main_loop_timing(EM_TIMING_RAF, 2); break;
+        case PacingMode::Uncapped: failed = emscripten_set_main_loop_timing(EM_TIMING_SETIMMEDIATE, 0); break;
+        case PacingMode::TargetFps: failed = emscripten_set_main_loop_timing(EM_TIMING_SETTIMEOUT, 1000 / current.target_fps); break;
+    }
+    if (failed != 0)
+        std::cout << "The browser loop kept its timing instead of " << Format(current) << '\n';
+    is_timing_due = false;
+#endif
+}
+
+void FramePacer::finishOldest(Uint64 done_ticks)
+{
+    InFlight& frame = in_flight[static_cast<std::size_t>(oldest)];
+    if (done_ticks != 0 && frame.input_ticks != 0 && done_ticks > frame.input_ticks)
+    {
+        // done on the GPU, then on average a refresh until it is scanned out with vsync; half of one tearing through it
+        const bool   synced  = current.mode != PacingMode::Uncapped && current.mode != PacingMode::TargetFps;
+        const double scanout = refresh_period_ms() * (synced ? 1.0 : 0.5);
+        stats.latency_ms     = ticks_to_ms(done_ticks - frame.input_ticks) + scanout;
+        ++stats.measured;
+    }
+    glDeleteSync(frame.fence);
+    frame  = InFlight{};
+    oldest = (oldest + 1) % PacingSettings::MAX_FRAMES_IN_FLIGHT;
+    --count;
+}
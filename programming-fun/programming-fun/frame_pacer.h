@@ -0,0 +1,113 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <SDL_stdinc.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+enum class PacingMode
+{
+    VSync,
+    Adaptive, // late frames tear instead of waiting a whole extra refresh; falls back to VSync
+    HalfRate, // every other refresh, for battery; falls back to VSync
+    Uncapped,
+    TargetFps
+};
+
+struct PacingSettings
+{
+    static constexpr int DEFAULT_TARGET_FPS       = 60;
+    static constexpr int MAX_FRAMES_IN_FLIGHT     = 3;
+    static constexpr int DEFAULT_FRAMES_IN_FLIGHT = 2;
+
+    PacingMode mode             = PacingMode::Adaptive;
+    int        target_fps       = DEFAULT_TARGET_FPS;
+    int        frames_in_flight = DEFAULT_FRAMES_IN_FLIGHT; // swapped frames the GPU may still be working on, 1 to MAX_FRAMES_IN_FLIGHT
+
+    bool operator==(const PacingSettings&) const = default;
+};
+
+/**
+ * Decides how long a frame lasts: the swap interval for the vsync modes, a wait before the swap for TargetFps.
+ *
+ * The wait sleeps with SDL_Delay until SPIN_MARGIN_MS before the deadline and spins on
+ * SDL_GetPerformanceCounter for the rest, since a sleep alone can overshoot by a scheduler tick.
+ * Deadlines advance by exactly one period so the average rate holds; after a long stall they resync to now
+ * instead of racing to catch up. Lives on the thread that swaps, with its GL context current; the settings
+ * can be edited anywhere and handed over with Apply.
+ *
+ * On Emscripten the browser paces the loop and WaitForNextFrame never waits; it hands the mode to
+ * emscripten_set_main_loop_timing instead, which needs the loop to exist: the vsync modes run on every
+ * requestAnimationFrame, HalfRate on every other one, TargetFps on setTimeout and Uncapped on setImmediate.
+ * A background tab gets no animation frames at all, but its timers keep firing, throttled.
+ *
+ * With vsync the driver will queue a few swapped frames, and every one of them is input the screen shows
+ * late. EndFrame puts a fence behind each swap and waits until no more than frames_in_flight of them are
+ * unfinished, so 1 trades throughput for the freshest input and 3 is about what the driver allows anyway.
+ * The moment a fence is seen signalled, less the frame's input poll, plus a refresh for scanout (half of
+ * one without vsync), is the input to photon estimate. A fence that was already done when polled reads
+ * late, so the estimate is an upper bound, tightest at 1.
+ */
+class FramePacer
+{
+public:
+    static constexpr double SPIN_MARGIN_MS = 2.0;
+
+    struct Stats
+    {
+        int           frames_in_flight = 0;    // unfinished after the latest EndFrame
+        double        wait_ms          = 0.0;  // the latest EndFrame's wait on the GPU
+        double        latency_ms       = -1.0; // input to photon estimate of the latest frame seen done
+        std::uint64_t measured         = 0;    // frames that gave an estimate, so a new one can be told apart
+    };
+
+    // Cheap when nothing changed, so it can be called every frame
+    void Apply(const PacingSettings& settings);
+
+    // Call right before SDL_GL_SwapWindow
+    void WaitForNextFrame();
+    // Call right after SDL_GL_SwapWindow; `input_ticks` is when the frame's input was polled
+    void  EndFrame(Uint64 input_ticks);
+    Stats LastFrameStats() const noexcept;
+    // Deletes the fences; the context has to be current
+    void Shutdown();
+
+    // Combo and slider for the caller's current window; returns true when something changed
+    static bool DrawImGui(PacingSettings& settings);
+
+    // "vsync", "adaptive", "half", "uncapped" or a number meaning TargetFps at that rate
+    static bool Parse(std::string_view text, PacingSettings& out_settings);
+    // What Parse reads back as `settings`
+    static std::string Format(const PacingSettings& settings);
+
+private:
+    struct InFlight
+    {
+        GLsync fence       = nullptr;
+        Uint64 input_ticks = 0;
+    };
+
+    void applySwapInterval();
+    void applyBrowserTiming();
+    // the oldest frame in flight is done as of `now`
+    void finishOldest(Uint64 now);
+
+private:
+    PacingSettings                                             current;
+    bool                                                       is_applied    = false;
+    bool                                                       is_timing_due = false; // Emscripten: the loop's timing waits for the next frame
+    Uint64                                                     next_deadline = 0;
+    std::array<InFlight, PacingSettings::MAX_FRAMES_IN_FLIGHT> in_flight{}; // a ring, oldest at `oldest`
+    int                                                        oldest = 0;
+    int                                                        count  = 0;
+    Stats                                                      stats;
+};
@@ -0,0 +1,52 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "frame_packet.h"
+
+FramePacket::FramePacket(std::pmr::memory_resource* arena)
+    : tile_chunks{ arena }, static_sprites{ arena }, sprites{ arena }, meshes{ arena }, models{ arena }, glyphs{ arena }, debug{ arena }, lighting{ arena }, commands{ arena }, views{ arena },
+      view_commands{ arena }, ui_damage{ arena }
+{
+}
+
+FramePacket::~FramePacket()
+{
+    releaseImGui();
+}
+
+void FramePacket::CaptureImGui(ImDrawData& draw_data, bool deep_copy)
+{
+    releaseImGui();
+    if (!deep_copy)
+    {
+        imgui = &draw_data;
+        return;
+    }
+    // ImGui rewrites its lists every NewFrame; CloneOutput keeps only what rendering reads
+    imgui_copy = draw_data;
+    for (ImDrawList*& list : imgui_copy.CmdLists)
+        list = list->CloneOutput();
+    imgui           = &imgui_copy;
+    owns_draw_lists = true;
+}
+
+ImDrawData* FramePacket::ImGuiDrawData() noexcept
+{
+    return imgui;
+}
+
+void FramePacket::releaseImGui()
+{
+    if (owns_draw_lists)
+    {
+        for (ImDrawList* list : imgui_copy.CmdLists)
+            IM_DELETE(list);
+        imgui_copy.Clear();
+    }
+    imgui           = nullptr;
+    owns_draw_lists = false;
+}
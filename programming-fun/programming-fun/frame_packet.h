@@ -0,0 +1,191 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "animated_sprite_renderer.h"
+#include "debug_draw.h"
+#include "debug_draw_renderer.h"
+#include "frame_capture.h"
+#include "frame_pacer.h"
+#include "gltf_model.h"
+#include "gpu_picker.h"
+#include "imgui_renderer.h"
+#include "latency_probe.h"
+#include "light_renderer.h"
+#include "mesh_renderer.h"
+#include "particle_system.h"
+#include "post_process.h"
+#include "render_commands.h"
+#include "render_graph.h"
+#include "render_target.h"
+#include "sprite_batch.h"
+#include "text_renderer.h"
+#include "tilemap_renderer.h"
+#include "ui_damage.h"
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <filesystem>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <imgui.h>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+struct SDL_Window;
+
+struct SpriteDraw
+{
+    GLuint         texture  = 0;
+    bool           is_array = false; // `texture` is a TextureArray's, sprite.layer picks the layer
+    SpriteInstance sprite;
+    std::uint32_t  pick_id = 0; // what GpuPicker reports for it, 0 to leave it out of picking
+};
+
+struct MeshDraw
+{
+    MeshId       mesh = MeshRenderer::INVALID_MESH;
+    MeshInstance instance;
+};
+
+// One copy of FramePacket::model
+struct ModelDraw
+{
+    MeshInstance instance; // z scaled into the projection's depth range
+    std::uint8_t lod = 0;  // LodSelector's pick, below MODEL_LOD_COUNT
+};
+
+struct ParticleDraw
+{
+    int             capacity = 0;   // 0 for no particles this frame
+    double          time     = 0.0; // simulated seconds; the render side steps by how far it moved since its last frame
+    glm::vec2       gravity{ 0.0f };
+    GLuint          texture = 0;
+    glm::vec4       uv_rect{ 0.0f, 0.0f, 1.0f, 1.0f };
+    ParticleEmitter emitters[ParticleSystem::MAX_EMITTERS];
+    int             emitter_count = 0;
+};
+
+struct AnimatedSpriteDraw
+{
+    // replaced rather than edited, so the render side uploads a set once, when it first sees the pointer
+    std::shared_ptr<const std::vector<AnimatedSprite>> sprites;
+    GLuint                                             texture = 0;
+    glm::vec4                                          uv_rect{ 0.0f, 0.0f, 1.0f, 1.0f };
+    float                                              time = 0.0f; // the clock the sprites' start times are on
+};
+
+struct TilemapDraw
+{
+    GLuint    texture   = 0;
+    float     tile_size = 16.0f;
+    glm::mat4 view{ 1.0f }; // world to screen, before the projection
+};
+
+// One of SceneViews' windows due this frame: its run of FramePacket::view_commands, already culled and sorted
+struct SceneViewDraw
+{
+    SDL_Window*   window = nullptr;
+    glm::ivec2    size{ 0 };          // the drawable, in pixels
+    glm::mat4     projection{ 1.0f }; // the main window's screen coordinates to the view's
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+};
+
+/**
+ * Everything the render side needs to draw one frame, recorded by the main thread.
+ *
+ * Lives in that frame's FrameArena, so the sprite list costs a pointer bump per element.
+ * The lists hold what each layer draws; `commands` says which of it to draw and in what
+ * order, so nothing reaches GL except through the sorted command list.
+ * Once submitted the main thread leaves it alone until its arena comes around again; the
+ * render side only writes the stats back. Create and destroy it on the main thread,
+ * since the ImGui copy is freed with ImGui's allocator.
+ */
+struct FramePacket
+{
+    explicit FramePacket(std::pmr::memory_resource* arena);
+    ~FramePacket();
+
+    FramePacket(const FramePacket&)                = delete;
+    FramePacket& operator=(const FramePacket&)     = delete;
+    FramePacket(FramePacket&&) noexcept            = delete;
+    FramePacket& operator=(FramePacket&&) noexcept = delete;
+
+    // Clones the draw lists when the frame renders after the next ImGui::NewFrame, otherwise just points at them
+    void        CaptureImGui(ImDrawData& draw_data, bool deep_copy);
+    ImDrawData* ImGuiDrawData() noexcept;
+
+    glm::vec3                           clear_color{ 0.0f };
+    glm::ivec2                          viewport_size{ 0 };
+    glm::ivec2                          scene_size{ 0 }; // the scene renders at this size and is upscaled to viewport_size
+    AntiAliasSettings                   anti_aliasing;
+    PostSettings                        post;
+    glm::mat4                           projection{ 1.0f };
+    TilemapDraw                         tilemap;
+    std::pmr::vector<TileChunkDraw>     tile_chunks;             // the tilemap's resident chunks in view, under everything else
+    std::pmr::vector<RetainedSpriteRun> static_sprites;          // StaticSprites::CollectRuns, over the tiles and under the streamed sprites
+    GLuint                              static_sprite_rects = 0; // StaticSprites::RectTexture, the runs' rect table
+    std::pmr::vector<SpriteDraw>        sprites;
+    bool                                bindless_sprites = false; // SpriteBatch::SetBindless
+    AnimatedSpriteDraw                  animated_sprites;         // over the sprites
+    std::pmr::vector<MeshDraw>          meshes;                   // drawn over the sprites
+    std::shared_ptr<const ModelData>    model;                    // replaced when another loads, so the render side makes its meshes once per pointer
+    std::pmr::vector<ModelDraw>         models;                   // copies of `model`, over the meshes
+    ParticleDraw                        particles;                // over the meshes
+    std::pmr::vector<GlyphInstance>     glyphs;                   // over the particles
+    debug_draw::Lists                   debug;                    // over everything, empty unless DEBUG_DRAW_ENABLED
+    LightBins                           lighting;                 // multiplies the drawn scene before post processing; unlit while it has no tiles
+    std::pmr::vector<RenderCommand>     commands;                 // what to draw from the lists above, in any order; the render side sorts them
+    std::pmr::vector<SceneViewDraw>     views;                    // drawn before the main window, straight to their own backbuffers
+    std::pmr::vector<RenderCommand>     view_commands;            // the views' runs, each a sorted subset of `commands`
+    PacingSettings                      pacing;
+    GLsync                              uploads_ready  = nullptr; // GL work from the upload context this frame has to wait for
+    std::uint64_t                       imgui_hash     = 0;       // hash_imgui_draw_data, 0 to always upload
+    bool                                submitted      = false;   // false when the main thread found nothing to redraw
+    bool                                retain_ui      = false;   // draw through the UiDamageTarget; never for captures, batch images or views
+    bool                                ui_partial     = false;   // nothing but the UI changed, and only inside `ui_damage`
+    std::pmr::vector<glm::ivec4>        ui_damage;                // UiDamage::Rects
+    std::uint64_t                       input_sequence = 0;       // InputSnapshot::sequence this frame was built from
+    std::uint64_t                       input_lead     = 0;       // written by the render side: how many polls newer its input was
+    std::uint64_t                       frame_number   = 0;       // ReleaseQueue::Submitted's count for this frame
+    std::uint64_t                       input_ticks    = 0;       // InputSnapshot::ticks this frame was built from
+    LatencyMark                         latency;
+    PickRequest                         pick;
+    SpriteBatch::Stats                  sprite_stats;             // written by the render side
+    SpriteBatch::Stats                  static_sprite_stats;      // written by the render side: SpriteBatch::LastRetainedStats
+    AnimatedSpriteRenderer::Stats       animated_stats;           // written by the render side
+    MeshRenderer::Stats                 mesh_stats;               // written by the render side
+    ParticleSystem::Stats               particle_stats;           // written by the render side
+    TextRenderer::Stats                 text_stats;               // written by the render side
+    TilemapRenderer::Stats              tilemap_stats;            // written by the render side
+    DebugDrawRenderer::Stats            debug_stats;              // written by the render side
+    LightRenderer::Stats                light_stats;              // written by the render side
+    RenderCommandStats                  command_stats;            // written by the render side
+    FramePacer::Stats                   pacer_stats;              // written by the render side
+    glm::ivec2                          scene_allocation{ 0 };    // written by the render side: RenderTarget::AllocatedSize
+    int                                 scene_reallocations = 0;  // written by the render side
+    int                                 capture_sequence    = 0;  // the frame capture this frame belongs to, 0 for none
+    int                                 capture_frame       = 0;  // its index within that capture
+    std::filesystem::path               batch_image;              // batch rendering: where this frame's scene goes, empty for none
+    FrameCapture::Stats                 capture_stats;            // written by the render side
+    RenderGraph::Stats                  graph_stats;              // written by the render side
+    ImGuiRenderer::Stats                imgui_stats;              // written by the render side
+    UiDamageTarget::Stats               ui_damage_stats;          // written by the render side
+
+private:
+    void releaseImGui();
+
+private:
+    ImDrawData  imgui_copy;
+    ImDrawData* imgui           = nullptr;
+    bool        owns_draw_lists = false;
+};
@@ -0,0 +1,193 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gl_backend.h"
+
+#include "gl_context.h"
+#include "gl_state.h"
+
+namespace
+{
+    namespace bind_to_edit
+    {
+        void bind_texture(GLuint texture)
+        {
+            gl_state::ActiveTexture(0);
+            gl_state::BindTexture(texture);
+        }
+
+        GLuint create_texture_2d()
+        {
+            GLuint texture = 0;
+            glGenTextures(1, &texture);
+            // the name only becomes a texture once bound
+            bind_texture(texture);
+            return texture;
+        }
+
+        void texture_parameter_i(GLuint texture, GLenum name, GLint value)
+        {
+            bind_texture(texture);
+            glTexParameteri(GL_TEXTURE_2D, name, value);
+        }
+
+        void texture_parameter_f(GLuint texture, GLenum name, GLfloat value)
+        {
+            bind_texture(texture);
+            glTexParameterf(GL_TEXTURE_2D, name, value);
+        }
+
+        void texture_storage_2d(GLuint texture, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
+        {
+            bind_texture(texture);
+            glTexStorage2D(GL_TEXTURE_2D, levels, internal_format, width, height);
+        }
+
+        void texture_sub_image_2d(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+        {
+            bind_texture(texture);
+            glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, format, type, pixels);
+        }
+
+        void compressed_texture_sub_image_2d(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLsizei bytes, const void* data)
+        {
+            bind_texture(texture);
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, format, bytes, data);
+        }
+
+        void generate_mipmap(GLuint texture)
+        {
+            bind_texture(texture);
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+
+        GLuint create_buffer()
+        {
+            GLuint buffer = 0;
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            return buffer;
+        }
+
+        void buffer_data(GLuint buffer, GLsizeiptr bytes, const void* data, GLenum usage)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, bytes, data, usage);
+        }
+
+        void buffer_sub_data(GLuint buffer, GLintptr offset, GLsizeiptr bytes, const void* data)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, data);
+        }
+
+        constexpr gl_backend::Functions FUNCTIONS{ "bind to edit",
+                                                   &create_texture_2d,
+                                                   &texture_parameter_i,
+                                                   &texture_parameter_f,
+                                                   &texture_storage_2d,
+                                                   &texture_sub_image_2d,
+                                                   &compressed_texture_sub_image_2d,
+                                                   &generate_mipmap,
+                                                   &create_buffer,
+                                                   &buffer_data,
+                                                   &buffer_sub_data };
+    }
+
+#if !defined(IS_WEBGL2)
+    namespace direct_state_access
+    {
+        GLuint create_texture_2d()
+        {
+            GLuint texture = 0;
+            glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+            return texture;
+        }
+
+        void texture_parameter_i(GLuint texture, GLenum name, GLint value)
+        {
+            glTextureParameteri(texture, name, value);
+        }
+
+        void texture_parameter_f(GLuint texture, GLenum name, GLfloat value)
+        {
+            glTextureParameterf(texture, name, value);
+        }
+
+        void texture_storage_2d(GLuint texture, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
+        {
+            glTextureStorage2D(texture, levels, internal_format, width, height);
+        }
+
+        void texture_sub_image_2d(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+        {
+            glTextureSubImage2D(texture, level, x, y, width, height, format, type, pixels);
+        }
+
+        void compressed_texture_sub_image_2d(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLsizei bytes, const void* data)
+        {
+            glCompressedTextureSubImage2D(texture, level, x, y, width, height, format, bytes, data);
+        }
+
+        void generate_mipmap(GLuint texture)
+        {
+            glGenerateTextureMipmap(texture);
+        }
+
+        GLuint create_buffer()
+        {
+            GLuint buffer = 0;
+            glCreateBuffers(1, &buffer);
+            return buffer;
+        }
+
+        void buffer_data(GLuint buffer, GLsizeiptr bytes, const void* data, GLenum usage)
+        {
+            glNamedBufferData(buffer, bytes, data, usage);
+        }
+
+        void buffer_sub_data(GLuint buffer, GLintptr offset, GLsizeiptr bytes, const void* data)
+        {
+            glNamedBufferSubData(buffer, offset, bytes, data);
+        }
+
+        constexpr gl_backend::Functions FUNCTIONS{ "direct state access",
+                                                   &create_texture_2d,
+                                                   &texture_parameter_i,
+                                                   &texture_parameter_f,
+                                                   &texture_storage_2d,
+                                                   &texture_sub_image_2d,
+                                                   &compressed_texture_sub_image_2d,
+                                                   &generate_mipmap,
+                                                   &create_buffer,
+                                                   &buffer_data,
+                                                   &buffer_sub_data };
+    }
+#endif
+
+    gl_backend::Functions gFunctions = bind_to_edit::FUNCTIONS;
+}
+
+namespace gl_backend
+{
+    void Select()
+    {
+#if !defined(IS_WEBGL2)
+        if (gl_context::HasDirectStateAccess())
+        {
+            gFunctions = direct_state_access::FUNCTIONS;
+            return;
+        }
+#endif
+        gFunctions = bind_to_edit::FUNCTIONS;
+    }
+
+    const Functions& Get() noexcept
+    {
+        return gFunctions;
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+
+/**
+ * Creating and filling textures and buffers by name, whichever way the context allows.
+ *
+ * Two implementations of the same entry points. Direct state access (GL 4.5 or ARB_direct_state_access) edits
+ * the object named in the call: glCreateTextures, glTextureStorage2D, glTextureSubImage2D, glNamedBufferSubData.
+ * Bind to edit, for WebGL2 and older desktop contexts, binds the object first: textures on unit 0 through
+ * gl_state, buffers on GL_COPY_WRITE_BUFFER so the vertex array's and the draw's bindings are left alone.
+ * Either way callers hand over the name and assume nothing about what is bound afterwards.
+ *
+ * Select picks one, once, after gl_context::Detect; the hot paths then call through a table of function
+ * pointers instead of asking on every call. Until then the table is bind to edit, which works everywhere.
+ * Textures are GL_TEXTURE_2D. Uploads read from GL_PIXEL_UNPACK_BUFFER when one is bound, like the GL calls.
+ */
+namespace gl_backend
+{
+    struct Functions
+    {
+        const char* name = "";
+        GLuint (*create_texture_2d)();
+        void (*texture_parameter_i)(GLuint texture, GLenum name, GLint value);
+        void (*texture_parameter_f)(GLuint texture, GLenum name, GLfloat value);
+        void (*texture_storage_2d)(GLuint texture, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height);
+        void (*texture_sub_image_2d)(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
+        void (*compressed_texture_sub_image_2d)(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLsizei bytes, const void* data);
+        void (*generate_mipmap)(GLuint texture);
+        GLuint (*create_buffer)();
+        void (*buffer_data)(GLuint buffer, GLsizeiptr bytes, const void* data, GLenum usage);
+        void (*buffer_sub_data)(GLuint buffer, GLintptr offset, GLsizeiptr bytes, const void* data);
+    };
+
+    // With the first context current and GLEW initialized
+    void             Select();
+    const Functions& Get() noexcept;
+}
@@ -0,0 +1,138 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gl_context.h"
+
+#include "error.h"
+#include "logger.h"
+
+#include <GL/glew.h>
+#if defined(__EMSCRIPTEN__)
+#    include <emscripten.h>
+#endif
+
+#if defined(__EMSCRIPTEN__)
+// what SDL's emscripten_webgl_create_context can't say, merged into the attributes it passes; restored right after
+EM_JS(void, wrap_canvas_context, (int power_preference, int desynchronized), {
+    const canvas = Module['canvas'];
+    if (!canvas || canvas.originalGetContext)
+        return;
+    canvas.originalGetContext = canvas.getContext;
+    const overrides           = {
+        powerPreference : [ 'default', 'high-performance', 'low-power' ][power_preference],
+        desynchronized : desynchronized != 0,
+        preserveDrawingBuffer : false
+    };
+    canvas.getContext = function(type, attributes) { return canvas.originalGetContext.call(canvas, type, Object.assign({}, attributes, overrides)); };
+});
+
+EM_JS(void, unwrap_canvas_context, (), {
+    const canvas = Module['canvas'];
+    if (!canvas || !canvas.originalGetContext)
+        return;
+    canvas.getContext = canvas.originalGetContext;
+    delete canvas.originalGetContext;
+});
+#endif
+
+namespace
+{
+    struct
+    {
+        gl_context::Settings settings;
+        gl_context::Info     info;
+    } gContext;
+
+#if !defined(IS_WEBGL2)
+    struct Version
+    {
+        int major;
+        int minor;
+    };
+
+    constexpr Version DESKTOP_VERSIONS[] = {
+        { 4, 6 },
+        { 4, 5 },
+        { 4, 3 },
+        { 4, 1 },
+        { 3, 3 }
+    };
+
+    SDL_GLContext create_newest(SDL_Window* window)
+    {
+        for (const Version version : DESKTOP_VERSIONS)
+        {
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, version.major);
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, version.minor);
+            if (SDL_GLContext context = SDL_GL_CreateContext(window); context != nullptr)
+                return context;
+        }
+        return nullptr;
+    }
+#endif
+}
+
+namespace gl_context
+{
+    void Request(const Settings& settings)
+    {
+        gContext.settings = settings;
+    }
+
+    Settings Requested() noexcept
+    {
+        return gContext.settings;
+    }
+
+    SDL_GLContext Create(SDL_Window* window)
+    {
+#if defined(IS_WEBGL2)
+#    if defined(__EMSCRIPTEN__)
+        wrap_canvas_context(static_cast<int>(gContext.settings.power_preference), gContext.settings.desynchronized ? 1 : 0);
+#    endif
+        SDL_GLContext context = SDL_GL_CreateContext(window);
+#    if defined(__EMSCRIPTEN__)
+        unwrap_canvas_context();
+#    endif
+#else
+        const Settings& settings = gContext.settings;
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_NO_ERROR, settings.no_error ? 1 : 0);
+        SDL_GLContext context = create_newest(window);
+        if (context == nullptr && settings.no_error)
+        {
+            LOG_WARN("No GL context without error checking: ", SDL_GetError(), ", trying with it");
+            SDL_GL_SetAttribute(SDL_GL_CONTEXT_NO_ERROR, 0);
+            context = create_newest(window);
+        }
+#endif
+        if (context == nullptr)
+            throw_error_message("Failed to create opengl context: ", SDL_GetError());
+        return context;
+    }
+
+    void Detect()
+    {
+        glGetIntegerv(GL_MAJOR_VERSION, &gContext.info.major);
+        glGetIntegerv(GL_MINOR_VERSION, &gContext.info.minor);
+#if !defined(IS_WEBGL2)
+        GLint flags = 0;
+        glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+        gContext.info.is_no_error             = (flags & GL_CONTEXT_FLAG_NO_ERROR_BIT_KHR) != 0;
+        gContext.info.has_direct_state_access = GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access;
+#endif
+    }
+
+    const Info& GetInfo() noexcept
+    {
+        return gContext.info;
+    }
+
+    bool HasDirectStateAccess() noexcept
+    {
+        return gContext.info.has_direct_state_access;
+    }
+}
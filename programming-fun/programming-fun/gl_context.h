@@ -0,0 +1,71 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <SDL_video.h>
+
+/**
+ * Creating the window's GL context with a version we chose instead of whatever the driver hands back.
+ *
+ * Desktop asks for a core 4.6 context and steps down through 4.5, 4.3 and 4.1 to 3.3, the first one the driver
+ * accepts wins; 4.1 is as far as macOS goes, 3.3 is what the shaders' preamble needs. The attributes of the
+ * accepted version stay set, so a context shared with it later, the render thread's, gets the same one. WebGL
+ * always gets ES 3.0.
+ *
+ * `no_error` asks for a KHR_no_error context, where the driver skips the validation behind glGetError: less CPU
+ * per call, and a bad call is undefined behaviour instead of an error. It is on by default in release builds,
+ * where nothing reads the errors, and always off with a debug context, which it contradicts. A driver without
+ * KHR_no_error gives an ordinary context; if it refuses outright, the versions are tried again without it.
+ *
+ * In the browser the context is the canvas's drawing buffer, which the page composites every frame. The app is
+ * all 2D and antialiases in its own scene target, so the window asks for no depth, stencil, alpha or multisampling.
+ * SDL has no way to pass the rest of the canvas attributes, so Create wraps the canvas's getContext for the call
+ * to add them: `power_preference`, `desynchronized` where the browser has a low latency canvas, and
+ * preserveDrawingBuffer off so the browser may swap buffers instead of copying one.
+ *
+ * Detect, with the context current and GLEW initialized, records what came back. gl_backend::Select asks
+ * HasDirectStateAccess to pick the glCreate / glNamed / glTexture entry points, which need 4.5 or
+ * ARB_direct_state_access, over binding to edit.
+ */
+namespace gl_context
+{
+    enum class PowerPreference
+    {
+        Default,
+        HighPerformance,
+        LowPower
+    };
+
+    struct Settings
+    {
+#if defined(NDEBUG)
+        bool no_error = true;
+#else
+        bool no_error = false;
+#endif
+        PowerPreference power_preference = PowerPreference::HighPerformance; // WebGL's powerPreference
+        bool            desynchronized   = true;                             // WebGL: a low latency canvas where there is one
+    };
+
+    struct Info
+    {
+        int  major                   = 0;
+        int  minor                   = 0;
+        bool is_no_error             = false;
+        bool has_direct_state_access = false;
+    };
+
+    // Before the window and its context are created
+    void     Request(const Settings& settings);
+    Settings Requested() noexcept;
+    // After the window exists; throws when no version at all can be created
+    SDL_GLContext Create(SDL_Window* window);
+    void          Detect();
+    const Info&   GetInfo() noexcept;
+    bool          HasDirectStateAccess() noexcept;
+}
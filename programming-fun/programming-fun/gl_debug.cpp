@@ -0,0 +1,231 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gl_debug.h"
+
+#include "logger.h"
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr auto   REPEAT_PERIOD   = std::chrono::seconds{ 5 }; // a repeated message is logged at most this often
+    constexpr double BUDGET_PER_SEC  = 10.0;
+    constexpr double BUDGET_BURST    = 20.0;
+    constexpr int    MAX_DISTINCT    = 1024; // past this, new messages are only rate limited
+    constexpr int    MAX_GROUP_DEPTH = 64;   // GL_MAX_DEBUG_GROUP_STACK_DEPTH is at least that
+
+    struct Seen
+    {
+        Clock::time_point last_logged;
+        std::uint64_t     repeats = 0; // since last_logged
+    };
+
+    struct
+    {
+        gl_debug::Settings settings;
+        bool               has_groups  = false;
+        int                group_depth = 0; // on the thread that draws
+
+        // the callback runs on whichever thread the driver likes when output is asynchronous
+        std::mutex                              mutex;
+        std::unordered_map<std::uint64_t, Seen> seen;
+        double                                  budget = BUDGET_BURST;
+        Clock::time_point                       budget_time;
+        std::uint64_t                           over_budget = 0; // not reported yet
+
+        std::atomic<bool>          is_active{ false };
+        std::atomic<std::uint64_t> received{ 0 };
+        std::atomic<std::uint64_t> logged{ 0 };
+        std::atomic<std::uint64_t> repeats{ 0 };
+        std::atomic<std::uint64_t> suppressed{ 0 };
+        std::atomic<int>           distinct{ 0 };
+    } gDebug;
+
+#if !defined(IS_WEBGL2)
+    const char* source_name(GLenum source) noexcept
+    {
+        switch (source)
+        {
+            case GL_DEBUG_SOURCE_API: return "api";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+            case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+            case GL_DEBUG_SOURCE_APPLICATION: return "application";
+            default: return "other";
+        }
+    }
+
+    const char* type_name(GLenum type) noexcept
+    {
+        switch (type)
+        {
+            case GL_DEBUG_TYPE_ERROR: return "error";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behaviour";
+            case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+            case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+            default: return "other";
+        }
+    }
+
+    // some drivers give every message id 0, those are told apart by their text
+    std::uint64_t message_key(GLenum source, GLenum type, GLuint id, std::string_view text) noexcept
+    {
+        std::uint64_t key = (static_cast<std::uint64_t>(source & 0xFFFF) << 48) ^ (static_cast<std::uint64_t>(type & 0xFFFF) << 32) ^ id;
+        if (id == 0)
+            key ^= std::hash<std::string_view>{}(text);
+        return key;
+    }
+
+    // refills the budget for the time gone by and takes one message from it; under the mutex
+    bool take_budget(Clock::time_point now) noexcept
+    {
+        const double seconds = std::chrono::duration<double>(now - gDebug.budget_time).count();
+        gDebug.budget_time   = now;
+        gDebug.budget        = std::min(BUDGET_BURST, gDebug.budget + seconds * BUDGET_PER_SEC);
+        if (gDebug.budget < 1.0)
+            return false;
+        gDebug.budget -= 1.0;
+        return true;
+    }
+
+    void GLAPIENTRY on_message(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void*)
+    {
+        gDebug.received.fetch_add(1, std::memory_order_relaxed);
+        const std::string_view text = length >= 0 ? std::string_view{ message, static_cast<std::size_t>(length) } : std::string_view{ message };
+        const Clock::time_point now = Clock::now();
+        std::uint64_t           folded      = 0;
+        std::uint64_t           over_budget = 0;
+        {
+            std::lock_guard lock{ gDebug.mutex };
+            const std::uint64_t key  = message_key(source, type, id, text);
+            auto                seen = gDebug.seen.find(key);
+            if (seen != gDebug.seen.end() && now - seen->second.last_logged < REPEAT_PERIOD)
+            {
+                ++seen->second.repeats;
+                gDebug.repeats.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (!take_budget(now))
+            {
+                ++gDebug.over_budget;
+                gDebug.suppressed.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (seen == gDebug.seen.end() && gDebug.seen.size() < MAX_DISTINCT)
+            {
+                seen = gDebug.seen.emplace(key, Seen{}).first;
+                gDebug.distinct.store(static_cast<int>(gDebug.seen.size()), std::memory_order_relaxed);
+            }
+            if (seen != gDebug.seen.end())
+            {
+                folded                   = seen->second.repeats;
+                seen->second.repeats     = 0;
+                seen->second.last_logged = now;
+            }
+            over_budget        = gDebug.over_budget;
+            gDebug.over_budget = 0;
+        }
+        gDebug.logged.fetch_add(1, std::memory_order_relaxed);
+        if (over_budget > 0)
+            LOG_WARN("GL debug: ", over_budget, " message(s) over the budget were dropped");
+        const logger::Level level = type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH ? logger::Level::Error : logger::Level::Warning;
+        if (folded > 0)
+            logger::Write(level, "GL ", type_name(type), " (", source_name(source), ", id ", id, "): ", text, " [", folded, " more since]");
+        else
+            logger::Write(level, "GL ", type_name(type), " (", source_name(source), ", id ", id, "): ", text);
+    }
+#endif
+}
+
+namespace gl_debug
+{
+    void Request(const Settings& settings)
+    {
+        gDebug.settings = settings;
+    }
+
+    Settings Requested() noexcept
+    {
+        return gDebug.settings;
+    }
+
+    void Install()
+    {
+#if !defined(IS_WEBGL2)
+        if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+        {
+            if (gDebug.settings.enabled)
+                LOG_WARN("GL debug output needs KHR_debug, which this context doesn't have");
+            return;
+        }
+        gDebug.has_groups = true;
+        if (!gDebug.settings.enabled)
+            return;
+        GLint flags = 0;
+        glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+        if ((flags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0)
+            LOG_WARN("GL debug output requested but the context isn't a debug context, the driver may report little");
+        glEnable(GL_DEBUG_OUTPUT);
+        if (gDebug.settings.synchronous)
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        // filtered in the driver: everything off, then only what is worth a line in the log
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+        for (const GLenum type : { GL_DEBUG_TYPE_ERROR, GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR, GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR, GL_DEBUG_TYPE_PORTABILITY, GL_DEBUG_TYPE_PERFORMANCE })
+            glDebugMessageControl(GL_DONT_CARE, type, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+        {
+            std::lock_guard lock{ gDebug.mutex };
+            gDebug.budget_time = Clock::now();
+        }
+        glDebugMessageCallback(&on_message, nullptr);
+        gDebug.is_active.store(true, std::memory_order_relaxed);
+#endif
+    }
+
+    Stats GetStats() noexcept
+    {
+        Stats stats;
+        stats.active     = gDebug.is_active.load(std::memory_order_relaxed);
+        stats.received   = gDebug.received.load(std::memory_order_relaxed);
+        stats.logged     = gDebug.logged.load(std::memory_order_relaxed);
+        stats.repeats    = gDebug.repeats.load(std::memory_order_relaxed);
+        stats.suppressed = gDebug.suppressed.load(std::memory_order_relaxed);
+        stats.distinct   = gDebug.distinct.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    Group::Group([[maybe_unused]] const char* name) noexcept
+    {
+#if !defined(IS_WEBGL2)
+        if (!gDebug.has_groups || gDebug.group_depth == MAX_GROUP_DEPTH)
+            return;
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+        ++gDebug.group_depth;
+        is_pushed = true;
+#endif
+    }
+
+    Group::~Group()
+    {
+#if !defined(IS_WEBGL2)
+        if (!is_pushed)
+            return;
+        glPopDebugGroup();
+        --gDebug.group_depth;
+#endif
+    }
+}
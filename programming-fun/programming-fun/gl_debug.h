@@ -0,0 +1,68 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The driver's own diagnostics through KHR_debug, and named groups around our render passes.
+ *
+ * Opt-in: Request before the window exists asks SDL for a debug context, which drivers only fully report in and
+ * which costs them validation. Install, with that context current, hooks the message callback and lets through
+ * errors, undefined behaviour, portability and performance warnings (implicit syncs, shader recompiles, buffer
+ * moves); notifications stay in the driver. A message is logged the first time it is seen; repeats of the same
+ * one are counted and logged again with the count at most every few seconds, and a budget of messages per
+ * second keeps a driver that warns every draw from flooding the log. Output is asynchronous unless `synchronous`,
+ * which is slower but calls back inside the GL call that caused the message, so a debugger breakpoint lands there.
+ *
+ * Groups are pushed whenever the context has KHR_debug, debug context or not, so RenderDoc and Nsight captures
+ * show the same names as the profiler's GPU zones, which push them. Neither exists on WebGL.
+ */
+namespace gl_debug
+{
+    struct Settings
+    {
+        bool enabled     = false;
+        bool synchronous = false;
+    };
+
+    struct Stats
+    {
+        bool          active     = false; // the callback is installed
+        std::uint64_t received   = 0;
+        std::uint64_t logged     = 0;
+        std::uint64_t repeats    = 0; // same message again, folded into a later count
+        std::uint64_t suppressed = 0; // over the per second budget
+        int           distinct   = 0;
+    };
+
+    // Before the window and its context are created
+    void     Request(const Settings& settings);
+    Settings Requested() noexcept;
+    // With a context current; again for every context that should report
+    void  Install();
+    Stats GetStats() noexcept;
+
+    // Pushes a debug group for its scope when the context can take one
+    class [[nodiscard]] Group
+    {
+    public:
+        explicit Group(const char* name) noexcept;
+        ~Group();
+
+        Group(const Group&)            = delete;
+        Group& operator=(const Group&) = delete;
+
+    private:
+        bool is_pushed = false;
+    };
+}
+
+#define GL_DEBUG_CONCAT_IMPL(a, b) a##b
+#define GL_DEBUG_CONCAT(a, b)      GL_DEBUG_CONCAT_IMPL(a, b)
+#define GL_DEBUG_GROUP(name)       const gl_debug::Group GL_DEBUG_CONCAT(gl_debug_group_, __LINE__){ name }
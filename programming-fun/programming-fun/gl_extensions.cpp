@@ -0,0 +1,32 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gl_extensions.h"
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+bool has_gl_extension(std::string_view name)
+{
+    static const std::vector<std::string> extensions = []()
+    {
+        std::vector<std::string> names;
+        GLint                    count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        names.reserve(static_cast<std::size_t>(count));
+        for (GLint i = 0; i < count; ++i)
+        {
+            if (const auto* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i))); extension != nullptr)
+                names.emplace_back(extension);
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }();
+    return std::binary_search(extensions.begin(), extensions.end(), name, std::less<>{});
+}
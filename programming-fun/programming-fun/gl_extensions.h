@@ -0,0 +1,14 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <string_view>
+
+// Reads the extension list from the current context once and answers from that cache afterwards.
+// Works for both desktop core profiles and WebGL2 where GLEW_* flags are not meaningful.
+bool has_gl_extension(std::string_view name);
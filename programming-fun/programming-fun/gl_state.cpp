@@ -0,0 +1,226 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gl_state.h"
+
+#include "gl_stats.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <optional>
+
+namespace
+{
+    constexpr GLuint UNKNOWN = ~0u;
+
+    enum TrackedCapability
+    {
+        Blend,
+        DepthTest,
+        CullFace,
+        ScissorTest,
+        TrackedCapabilityCount
+    };
+
+    // -1 unknown, 0 disabled, 1 enabled
+    using Tristate = signed char;
+
+    struct State
+    {
+        GLuint                                          active_unit = UNKNOWN;
+        std::array<GLuint, gl_state::MAX_TEXTURE_UNITS> textures;
+        GLuint                                          program      = UNKNOWN;
+        GLuint                                          vertex_array = UNKNOWN;
+        std::array<Tristate, TrackedCapabilityCount>    capabilities;
+        std::array<GLenum, 4>                           blend_function{ UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN }; // rgb source, destination, then alpha
+        GLenum                                          depth_function = UNKNOWN;
+        Tristate                                        depth_write    = -1;
+        std::optional<std::array<float, 4>>             clear_color;
+        std::optional<std::array<GLint, 4>>             viewport;
+
+        State()
+        {
+            textures.fill(UNKNOWN);
+            capabilities.fill(-1);
+        }
+    };
+
+    thread_local State gState;
+
+    std::atomic<int> gIssued{ 0 };
+    std::atomic<int> gSkipped{ 0 };
+    std::atomic<int> gLastIssued{ 0 };
+    std::atomic<int> gLastSkipped{ 0 };
+
+    // true when the call has to go through
+    template <typename T, typename U>
+    bool update(T& cached, const U& value) noexcept
+    {
+        if (cached == value)
+        {
+            gSkipped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        cached = value;
+        gIssued.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    int tracked_index(GLenum capability) noexcept
+    {
+        switch (capability)
+        {
+            case GL_BLEND: return Blend;
+            case GL_DEPTH_TEST: return DepthTest;
+            case GL_CULL_FACE: return CullFace;
+            case GL_SCISSOR_TEST: return ScissorTest;
+            default: return -1;
+        }
+    }
+}
+
+namespace gl_state
+{
+    void ActiveTexture(GLuint unit)
+    {
+        if (update(gState.active_unit, unit))
+            glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    void BindTexture(GLuint texture)
+    {
+        // an unknown unit could be any of them, so the binding can't be trusted either
+        if (gState.active_unit >= MAX_TEXTURE_UNITS)
+        {
+            gIssued.fetch_add(1, std::memory_order_relaxed);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            gl_stats::CountTextureBind();
+            return;
+        }
+        if (update(gState.textures[gState.active_unit], texture))
+        {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            gl_stats::CountTextureBind();
+        }
+    }
+
+    void UseProgram(GLuint program)
+    {
+        if (update(gState.program, program))
+        {
+            glUseProgram(program);
+            gl_stats::CountShaderSwitch();
+        }
+    }
+
+    void BindVertexArray(GLuint vertex_array)
+    {
+        if (update(gState.vertex_array, vertex_array))
+            glBindVertexArray(vertex_array);
+    }
+
+    void SetEnabled(GLenum capability, bool enabled)
+    {
+        const int index = tracked_index(capability);
+        if (index >= 0 && !update(gState.capabilities[static_cast<std::size_t>(index)], static_cast<Tristate>(enabled ? 1 : 0)))
+            return;
+        if (index < 0)
+            gIssued.fetch_add(1, std::memory_order_relaxed);
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+    }
+
+    void BlendFunc(GLenum source, GLenum destination)
+    {
+        if (update(gState.blend_function, std::array<GLenum, 4>{ source, destination, source, destination }))
+            glBlendFunc(source, destination);
+    }
+
+    void BlendFuncSeparate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha)
+    {
+        if (update(gState.blend_function, std::array<GLenum, 4>{ source_rgb, destination_rgb, source_alpha, destination_alpha }))
+            glBlendFuncSeparate(source_rgb, destination_rgb, source_alpha, destination_alpha);
+    }
+
+    void DepthFunc(GLenum function)
+    {
+        if (update(gState.depth_function, function))
+            glDepthFunc(function);
+    }
+
+    void DepthMask(bool write)
+    {
+        if (update(gState.depth_write, static_cast<Tristate>(write ? 1 : 0)))
+            glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+
+    void ClearColor(float red, float green, float blue, float alpha)
+    {
+        if (update(gState.clear_color, std::array<float, 4>{ red, green, blue, alpha }))
+            glClearColor(red, green, blue, alpha);
+    }
+
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        if (update(gState.viewport, std::array<GLint, 4>{ x, y, width, height }))
+            glViewport(x, y, width, height);
+    }
+
+    void DeleteTexture(GLuint texture)
+    {
+        // GL unbinds a deleted texture from every unit of the current context
+        for (GLuint& bound : gState.textures)
+        {
+            if (bound == texture)
+                bound = 0;
+        }
+        glDeleteTextures(1, &texture);
+    }
+
+    void DeleteTextures(std::span<const GLuint> textures)
+    {
+        for (GLuint& bound : gState.textures)
+        {
+            if (std::find(textures.begin(), textures.end(), bound) != textures.end())
+                bound = 0;
+        }
+        glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+    }
+
+    void DeleteProgram(GLuint program)
+    {
+        if (gState.program == program)
+            gState.program = UNKNOWN;
+        glDeleteProgram(program);
+    }
+
+    void DeleteVertexArray(GLuint vertex_array)
+    {
+        if (gState.vertex_array == vertex_array)
+            gState.vertex_array = 0;
+        glDeleteVertexArrays(1, &vertex_array);
+    }
+
+    void Invalidate() noexcept
+    {
+        gState = State{};
+    }
+
+    void EndFrame() noexcept
+    {
+        gLastIssued.store(gIssued.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        gLastSkipped.store(gSkipped.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    Counters LastFrame() noexcept
+    {
+        return Counters{ gLastIssued.load(std::memory_order_relaxed), gLastSkipped.load(std::memory_order_relaxed) };
+    }
+}
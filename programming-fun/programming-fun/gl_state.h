@@ -0,0 +1,57 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <span>
+
+/**
+ * Remembers the GL state this code base sets and drops calls that would not change it.
+ *
+ * The cache is per thread, which here means per context: the main thread and the render thread each
+ * have their own. It starts out unknown, so the first call of each kind always reaches GL. Code that changes
+ * state behind its back must either restore it (the ImGui backend does) or call Invalidate, as must anyone who
+ * makes a different context current. Delete through the helpers so a recycled name never looks already bound.
+ */
+namespace gl_state
+{
+    inline constexpr int MAX_TEXTURE_UNITS = 16;
+
+    struct Counters
+    {
+        int issued  = 0;
+        int skipped = 0;
+    };
+
+    // `unit` is zero based, GL_TEXTURE0 + unit is what reaches GL
+    void ActiveTexture(GLuint unit);
+    // GL_TEXTURE_2D on the active unit
+    void BindTexture(GLuint texture);
+    void UseProgram(GLuint program);
+    void BindVertexArray(GLuint vertex_array);
+
+    // Tracks GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE and GL_SCISSOR_TEST; other capabilities pass straight through
+    void SetEnabled(GLenum capability, bool enabled);
+    void BlendFunc(GLenum source, GLenum destination);
+    void BlendFuncSeparate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha);
+    void DepthFunc(GLenum function);
+    void DepthMask(bool write);
+    void ClearColor(float red, float green, float blue, float alpha);
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    void DeleteTexture(GLuint texture);
+    void DeleteTextures(std::span<const GLuint> textures);
+    void DeleteProgram(GLuint program);
+    void DeleteVertexArray(GLuint vertex_array);
+
+    void Invalidate() noexcept;
+
+    // Publishes the counts since the last call as LastFrame; call once per drawn frame on the thread that draws
+    void     EndFrame() noexcept;
+    Counters LastFrame() noexcept;
+}
@@ -0,0 +1,229 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gl_stats.h"
+
+#include "imgui_panels.h"
+#include "perf_counters.h"
+
+#include <imgui.h>
+#include <mutex>
+
+namespace
+{
+    constexpr const char* OTHER_PASS = "other";
+
+    // counts come from the drawing thread and (uploads) the main thread in the same frame, so one lock guards both
+    std::mutex               gMutex;
+    gl_stats::FrameCounters  gBuilding;
+    gl_stats::FrameCounters  gPublished;
+    thread_local const char* gCurrentPass = nullptr;
+
+    // caller holds gMutex; names are compared by pointer like profiler zones, a full table folds into the last pass
+    gl_stats::PassCounters& current_pass() noexcept
+    {
+        const char* name = gCurrentPass != nullptr ? gCurrentPass : OTHER_PASS;
+        for (int i = 0; i < gBuilding.pass_count; ++i)
+        {
+            if (gBuilding.passes[i].name == name)
+                return gBuilding.passes[i];
+        }
+        if (gBuilding.pass_count == gl_stats::MAX_PASSES)
+            return gBuilding.passes[gl_stats::MAX_PASSES - 1];
+        gl_stats::PassCounters& pass = gBuilding.passes[gBuilding.pass_count++];
+        pass                         = gl_stats::PassCounters{};
+        pass.name                    = name;
+        return pass;
+    }
+}
+
+namespace gl_stats
+{
+    PassCounters FrameCounters::Total() const noexcept
+    {
+        PassCounters total;
+        total.name = "total";
+        for (int i = 0; i < pass_count; ++i)
+        {
+            total.draw_calls += passes[i].draw_calls;
+            total.primitives += passes[i].primitives;
+            total.texture_binds += passes[i].texture_binds;
+            total.shader_switches += passes[i].shader_switches;
+            total.upload_bytes += passes[i].upload_bytes;
+            total.saved_bytes += passes[i].saved_bytes;
+        }
+        return total;
+    }
+
+    void CountDraw([[maybe_unused]] long long primitives, [[maybe_unused]] int draw_calls) noexcept
+    {
+#if GL_STATS_ENABLED
+        const std::lock_guard lock{ gMutex };
+        PassCounters&         pass = current_pass();
+        pass.draw_calls += draw_calls;
+        pass.primitives += primitives;
+#endif
+    }
+
+    void CountTextureBind() noexcept
+    {
+#if GL_STATS_ENABLED
+        const std::lock_guard lock{ gMutex };
+        ++current_pass().texture_binds;
+#endif
+    }
+
+    void CountShaderSwitch() noexcept
+    {
+#if GL_STATS_ENABLED
+        const std::lock_guard lock{ gMutex };
+        ++current_pass().shader_switches;
+#endif
+    }
+
+    void CountUpload([[maybe_unused]] std::size_t bytes) noexcept
+    {
+#if GL_STATS_ENABLED
+        const std::lock_guard lock{ gMutex };
+        current_pass().upload_bytes += bytes;
+#endif
+    }
+
+    void CountSavedUpload([[maybe_unused]] std::size_t bytes) noexcept
+    {
+#if GL_STATS_ENABLED
+        const std::lock_guard lock{ gMutex };
+        current_pass().saved_bytes += bytes;
+#endif
+    }
+
+    void CountImGui([[maybe_unused]] const ImDrawData& draw_data) noexcept
+    {
+#if GL_STATS_ENABLED
+        int       commands   = 0;
+        long long primitives = 0;
+        for (const ImDrawList* list : draw_data.CmdLists)
+        {
+            for (const ImDrawCmd& command : list->CmdBuffer)
+            {
+                if (command.UserCallback != nullptr)
+                    continue;
+                ++commands;
+                primitives += command.ElemCount / 3;
+            }
+        }
+        const std::lock_guard lock{ gMutex };
+        PassCounters&         pass = current_pass();
+        pass.draw_calls += commands;
+        pass.primitives += primitives;
+        pass.texture_binds += commands;
+        pass.shader_switches += draw_data.CmdListsCount > 0 ? 1 : 0;
+        pass.upload_bytes += static_cast<std::size_t>(draw_data.TotalVtxCount) * sizeof(ImDrawVert) + static_cast<std::size_t>(draw_data.TotalIdxCount) * sizeof(ImDrawIdx);
+#endif
+    }
+
+    void EndFrame() noexcept
+    {
+#if GL_STATS_ENABLED
+        using perf_counters::Kind;
+        static const perf_counters::Handle draw_calls      = perf_counters::Register("draw calls", Kind::Gauge);
+        static const perf_counters::Handle primitives      = perf_counters::Register("primitives", Kind::Gauge);
+        static const perf_counters::Handle texture_binds   = perf_counters::Register("texture binds", Kind::Gauge);
+        static const perf_counters::Handle shader_switches = perf_counters::Register("shader switches", Kind::Gauge);
+        static const perf_counters::Handle upload_bytes    = perf_counters::Register("upload bytes", Kind::Gauge);
+        static const perf_counters::Handle saved_bytes     = perf_counters::Register("upload bytes saved", Kind::Gauge);
+        PassCounters total;
+        {
+            const std::lock_guard lock{ gMutex };
+            gPublished = gBuilding;
+            gBuilding  = FrameCounters{};
+            total      = gPublished.Total();
+        }
+        perf_counters::Set(draw_calls, total.draw_calls);
+        perf_counters::Set(primitives, total.primitives);
+        perf_counters::Set(texture_binds, total.texture_binds);
+        perf_counters::Set(shader_switches, total.shader_switches);
+        perf_counters::Set(upload_bytes, static_cast<long long>(total.upload_bytes));
+        perf_counters::Set(saved_bytes, static_cast<long long>(total.saved_bytes));
+#endif
+    }
+
+    FrameCounters LastFrame() noexcept
+    {
+        const std::lock_guard lock{ gMutex };
+        return gPublished;
+    }
+
+    void DrawOverlay()
+    {
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - 10.0f, viewport->WorkPos.y + 10.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+        ImGui::SetNextWindowViewport(viewport->ID);
+        ImGui::SetNextWindowBgAlpha(0.6f);
+        constexpr ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings |
+                                           ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove;
+        if (!imgui_panels::Begin("GL Stats", 4.0f, nullptr, flags))
+        {
+            imgui_panels::End();
+            return;
+        }
+        if (!GL_STATS_ENABLED)
+        {
+            ImGui::Text("%s", "GL stats compiled out (GL_STATS_ENABLED=0)");
+            imgui_panels::End();
+            return;
+        }
+
+        const FrameCounters frame = LastFrame();
+        if (ImGui::BeginTable("gl_stats", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Pass");
+            ImGui::TableSetupColumn("Draws");
+            ImGui::TableSetupColumn("Prims");
+            ImGui::TableSetupColumn("Binds");
+            ImGui::TableSetupColumn("Shaders");
+            ImGui::TableSetupColumn("Upload (KB)");
+            ImGui::TableSetupColumn("Saved (KB)");
+            ImGui::TableHeadersRow();
+            const auto row = [](const PassCounters& pass)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", pass.name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", pass.draw_calls);
+                ImGui::TableNextColumn();
+                ImGui::Text("%lld", pass.primitives);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", pass.texture_binds);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", pass.shader_switches);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", static_cast<double>(pass.upload_bytes) / 1024.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", static_cast<double>(pass.saved_bytes) / 1024.0);
+            };
+            for (int i = 0; i < frame.pass_count; ++i)
+            {
+                row(frame.passes[i]);
+            }
+            row(frame.Total());
+            ImGui::EndTable();
+        }
+        imgui_panels::End();
+    }
+
+    Pass::Pass(const char* name) noexcept : outer{ gCurrentPass }
+    {
+        gCurrentPass = name;
+    }
+
+    Pass::~Pass()
+    {
+        gCurrentPass = outer;
+    }
+}
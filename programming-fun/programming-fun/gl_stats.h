@@ -0,0 +1,86 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "profiler.h"
+
+#include <cstddef>
+
+struct ImDrawData;
+
+// Counting follows the profiler by default; define GL_STATS_ENABLED=0 to keep the profiler and drop the counters
+#if !defined(GL_STATS_ENABLED)
+#    define GL_STATS_ENABLED PROFILER_ENABLED
+#endif
+
+/**
+ * Per frame, per pass counts of the GL work we issue: draws, primitives, texture binds, shader switches, bytes uploaded.
+ *
+ * Passes are named scopes (GL_STATS_PASS) on whichever thread draws; counts outside any pass land in "other".
+ * The drawing thread calls EndFrame once per frame to publish what it collected, uploads from other threads
+ * included. Texture binds and shader switches are counted by gl_state when a call actually reaches GL;
+ * ImGui's platform windows are derived from their draw data since the backend issues those calls itself.
+ */
+namespace gl_stats
+{
+    inline constexpr int MAX_PASSES = 8;
+
+    struct PassCounters
+    {
+        const char* name            = nullptr;
+        int         draw_calls      = 0;
+        long long   primitives      = 0;
+        int         texture_binds   = 0;
+        int         shader_switches = 0;
+        std::size_t upload_bytes    = 0;
+        std::size_t saved_bytes     = 0; // uploads skipped because the data was already on the GPU
+    };
+
+    struct FrameCounters
+    {
+        int          pass_count = 0;
+        PassCounters passes[MAX_PASSES];
+
+        PassCounters Total() const noexcept;
+    };
+
+    void CountDraw(long long primitives, int draw_calls = 1) noexcept;
+    void CountTextureBind() noexcept;
+    void CountShaderSwitch() noexcept;
+    void CountUpload(std::size_t bytes) noexcept;
+    void CountSavedUpload(std::size_t bytes) noexcept;
+    // The OpenGL3 backend (platform windows) draws one element range per command and re-uploads every list, so its counts follow from the data
+    void CountImGui(const ImDrawData& draw_data) noexcept;
+
+    void          EndFrame() noexcept;
+    FrameCounters LastFrame() noexcept;
+
+    // Small always-on-top table in the corner of the main viewport
+    void DrawOverlay();
+
+    class [[nodiscard]] Pass
+    {
+    public:
+        explicit Pass(const char* name) noexcept;
+        ~Pass();
+
+        Pass(const Pass&)            = delete;
+        Pass& operator=(const Pass&) = delete;
+
+    private:
+        const char* outer = nullptr;
+    };
+}
+
+#if GL_STATS_ENABLED
+#    define GL_STATS_CONCAT_IMPL(a, b) a##b
+#    define GL_STATS_CONCAT(a, b)      GL_STATS_CONCAT_IMPL(a, b)
+#    define GL_STATS_PASS(name)        const gl_stats::Pass GL_STATS_CONCAT(gl_stats_pass_, __LINE__){ name }
+#else
+#    define GL_STATS_PASS(name) ((void)0)
+#endif
@@ -0,0 +1,916 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gltf_model.h"
+
+#include "decoded_cache.h"
+#include "logger.h"
+#include "mapped_file.h"
+#include "mesh_optimizer.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/packing.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace
+{
+    // bumped whenever what's cached changes meaning
+    constexpr std::int32_t  CACHE_FORMAT    = 2;
+    constexpr std::size_t   MAX_PART_VERTS  = 65536;
+    constexpr float         LOD_RATIO       = 0.4f;  // of the level before's triangles
+    constexpr float         LOD_MAX_ERROR   = 0.05f; // of a part's extent, for each level; past it the level stops short
+    constexpr std::uint32_t GLB_MAGIC       = 0x46546C67; // "glTF"
+    constexpr std::uint32_t GLB_JSON        = 0x4E4F534A;
+    constexpr std::uint32_t GLB_BIN         = 0x004E4942;
+    constexpr int           MAX_JSON_DEPTH  = 64;
+    constexpr float         AMBIENT         = 0.35f; // of the baked light; the rest is the lambert term
+    constexpr int           TRIANGLES       = 4;     // glTF's primitive mode
+    constexpr int           MAX_NODE_DEPTH  = 256;
+
+    double elapsed_ms(Uint64 begin) noexcept
+    {
+        return static_cast<double>(SDL_GetPerformanceCounter() - begin) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    // a parsed JSON value; objects keep their keys beside their values, in order
+    struct Json
+    {
+        enum class Type
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        Type                     type    = Type::Null;
+        bool                     boolean = false;
+        double                   number  = 0.0;
+        std::string              text;
+        std::vector<Json>        items; // the array's elements, or the object's values
+        std::vector<std::string> keys;
+
+        const Json& operator[](std::string_view key) const noexcept;
+        const Json& operator[](std::size_t index) const noexcept;
+
+        bool IsNull() const noexcept
+        {
+            return type == Type::Null;
+        }
+
+        std::size_t Size() const noexcept
+        {
+            return type == Type::Array || type == Type::Object ? items.size() : 0;
+        }
+
+        double Number(double fallback) const noexcept
+        {
+            return type == Type::Number ? number : fallback;
+        }
+
+        // -1 when it isn't a whole number that fits
+        int Index() const noexcept
+        {
+            if (type != Type::Number || number < 0.0 || number > static_cast<double>(std::numeric_limits<int>::max()) || number != static_cast<double>(static_cast<int>(number)))
+                return -1;
+            return static_cast<int>(number);
+        }
+    };
+
+    const Json NULL_JSON{};
+
+    const Json& Json::operator[](std::string_view key) const noexcept
+    {
+        if (type != Type::Object)
+            return NULL_JSON;
+        const auto found = std::find(keys.begin(), keys.end(), key);
+        return found != keys.end() ? items[static_cast<std::size_t>(found - keys.begin())] : NULL_JSON;
+    }
+
+    const Json& Json::operator[](std::size_t index) const noexcept
+    {
+        return type == Type::Array && index < items.size() ? items[index] : NULL_JSON;
+    }
+
+    // RFC 8259, strings' escapes included; nesting is limited so a hostile file can't take the stack
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(std::string_view json_text) : text{ json_text }
+        {
+        }
+
+        bool Parse(Json& out_value)
+        {
+            return value(out_value, 0) && (skipSpace(), position == text.size());
+        }
+
+    private:
+        void skipSpace() noexcept
+        {
+            while (position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\n' || text[position] == '\r'))
+                ++position;
+        }
+
+        bool consume(char expected) noexcept
+        {
+            skipSpace();
+            if (position >= text.size() || text[position] != expected)
+                return false;
+            ++position;
+            return true;
+        }
+
+        bool literal(std::string_view word) noexcept
+        {
+            if (text.substr(position, word.size()) != word)
+                return false;
+            position += word.size();
+            return true;
+        }
+
+        bool hex4(std::uint32_t& out_code) noexcept
+        {
+            if (position + 4 > text.size())
+                return false;
+            const auto [end, error] = std::from_chars(text.data() + position, text.data() + position + 4, out_code, 16);
+            if (error != std::errc{} || end != text.data() + position + 4)
+                return false;
+            position += 4;
+            return true;
+        }
+
+        static void appendUtf8(std::string& out, std::uint32_t code)
+        {
+            if (code < 0x80)
+            {
+                out += static_cast<char>(code);
+            }
+            else if (code < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        bool string(std::string& out_text)
+        {
+            if (!consume('"'))
+                return false;
+            out_text.clear();
+            while (position < text.size())
+            {
+                const char next = text[position++];
+                if (next == '"')
+                    return true;
+                if (next != '\\')
+                {
+                    out_text += next;
+                    continue;
+                }
+                if (position >= text.size())
+                    return false;
+                switch (const char escape = text[position++]; escape)
+                {
+                    case '"':
+                    case '\\':
+                    case '/': out_text += escape; break;
+                    case 'b': out_text += '\b'; break;
+                    case 'f': out_text += '\f'; break;
+                    case 'n': out_text += '\n'; break;
+                    case 'r': out_text += '\r'; break;
+                    case 't': out_text += '\t'; break;
+                    case 'u':
+                        {
+                            std::uint32_t code = 0;
+                            if (!hex4(code))
+                                return false;
+                            // a surrogate pair is one character
+                            std::uint32_t low = 0;
+                            if (code >= 0xD800 && code < 0xDC00 && literal("\\u") && hex4(low) && low >= 0xDC00 && low < 0xE000)
+                                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                            appendUtf8(out_text, code);
+                        }
+                        break;
+                    default: return false;
+                }
+            }
+            return false;
+        }
+
+        bool value(Json& out_value, int depth)
+        {
+            skipSpace();
+            if (position >= text.size() || depth > MAX_JSON_DEPTH)
+                return false;
+            const char next = text[position];
+            if (next == '{')
+            {
+                ++position;
+                out_value.type = Json::Type::Object;
+                if (consume('}'))
+                    return true;
+                do
+                {
+                    std::string key;
+                    if (!string(key) || !consume(':'))
+                        return false;
+                    out_value.keys.push_back(std::move(key));
+                    if (!value(out_value.items.emplace_back(), depth + 1))
+                        return false;
+                } while (consume(','));
+                return consume('}');
+            }
+            if (next == '[')
+            {
+                ++position;
+                out_value.type = Json::Type::Array;
+                if (consume(']'))
+                    return true;
+                do
+                {
+                    if (!value(out_value.items.emplace_back(), depth + 1))
+                        return false;
+                } while (consume(','));
+                return consume(']');
+            }
+            if (next == '"')
+            {
+                out_value.type = Json::Type::String;
+                return string(out_value.text);
+            }
+            if (literal("true") || literal("false"))
+            {
+                out_value.type    = Json::Type::Bool;
+                out_value.boolean = next == 't';
+                return true;
+            }
+            if (literal("null"))
+                return true;
+            const auto [end, error] = std::from_chars(text.data() + position, text.data() + text.size(), out_value.number);
+            if (error != std::errc{})
+                return false;
+            out_value.type = Json::Type::Number;
+            position       = static_cast<std::size_t>(end - text.data());
+            return true;
+        }
+
+    private:
+        std::string_view text;
+        std::size_t      position = 0;
+    };
+
+    bool decode_base64(std::string_view text, std::vector<unsigned char>& out_bytes)
+    {
+        const auto sextet = [](char c) -> int
+        {
+            if (c >= 'A' && c <= 'Z')
+                return c - 'A';
+            if (c >= 'a' && c <= 'z')
+                return c - 'a' + 26;
+            if (c >= '0' && c <= '9')
+                return c - '0' + 52;
+            if (c == '+')
+                return 62;
+            if (c == '/')
+                return 63;
+            return -1;
+        };
+        out_bytes.clear();
+        out_bytes.reserve(text.size() / 4 * 3);
+        std::uint32_t bits  = 0;
+        int           count = 0;
+        for (const char c : text)
+        {
+            if (c == '=')
+                break;
+            const int value = sextet(c);
+            if (value < 0)
+                return false;
+            bits = (bits << 6) | static_cast<std::uint32_t>(value);
+            count += 6;
+            if (count >= 8)
+            {
+                count -= 8;
+                out_bytes.push_back(static_cast<unsigned char>(bits >> count));
+            }
+        }
+        return true;
+    }
+
+    // every buffer of the file, owned; the .glb's chunk and mapped files are copied so the lot outlives the mapping
+    using Buffers = std::vector<std::vector<unsigned char>>;
+
+    // a uri relative to the .gltf, with its %20s and the like decoded
+    std::filesystem::path resolve_uri(const std::filesystem::path& filename, std::string_view uri)
+    {
+        std::string decoded;
+        for (std::size_t i = 0; i < uri.size(); ++i)
+        {
+            unsigned value = 0;
+            if (uri[i] == '%' && i + 2 < uri.size() && std::from_chars(uri.data() + i + 1, uri.data() + i + 3, value, 16).ec == std::errc{})
+            {
+                decoded += static_cast<char>(value);
+                i += 2;
+            }
+            else
+            {
+                decoded += uri[i];
+            }
+        }
+        return filename.parent_path() / std::filesystem::path{ std::u8string{ decoded.begin(), decoded.end() } };
+    }
+
+    bool load_buffers(const Json& gltf, const std::filesystem::path& filename, std::span<const unsigned char> glb_bin, Buffers& out_buffers)
+    {
+        const Json& buffers = gltf["buffers"];
+        out_buffers.resize(buffers.Size());
+        for (std::size_t i = 0; i < buffers.Size(); ++i)
+        {
+            const Json&        buffer = buffers[i];
+            const std::string& uri    = buffer["uri"].text;
+            const double       length = buffer["byteLength"].Number(-1.0);
+            if (buffer["uri"].IsNull())
+            {
+                // only the first buffer of a .glb may leave out its uri
+                if (i != 0 || glb_bin.empty())
+                    return false;
+                out_buffers[i].assign(glb_bin.begin(), glb_bin.end());
+            }
+            else if (uri.starts_with("data:"))
+            {
+                const std::size_t comma = uri.find(',');
+                if (comma == std::string::npos || std::string_view{ uri }.substr(0, comma).find(";base64") == std::string_view::npos ||
+                    !decode_base64(std::string_view{ uri }.substr(comma + 1), out_buffers[i]))
+                    return false;
+            }
+            else
+            {
+                MappedFile file;
+                if (!file.Open(resolve_uri(filename, uri)))
+                {
+                    LOG_WARN("glTF buffer missing: ", uri);
+                    return false;
+                }
+                out_buffers[i].assign(file.Bytes().begin(), file.Bytes().end());
+            }
+            if (length < 0.0 || static_cast<double>(out_buffers[i].size()) < length)
+                return false;
+        }
+        return true;
+    }
+
+    // the external files' bytes, which the cache key has to cover too; empty for a .glb or embedded buffers
+    std::string external_buffers_key(const Json& gltf, const std::filesystem::path& filename)
+    {
+        std::string key;
+        const Json& buffers = gltf["buffers"];
+        for (std::size_t i = 0; i < buffers.Size(); ++i)
+        {
+            const std::string& uri = buffers[i]["uri"].text;
+            if (uri.empty() || uri.starts_with("data:"))
+                continue;
+            MappedFile file;
+            key += ' ';
+            key += file.Open(resolve_uri(filename, uri)) ? std::to_string(decoded_cache::Key(file.Bytes(), "")) : "missing";
+        }
+        return key;
+    }
+
+    // an accessor's elements as floats, `components` of them each, normalized integers scaled as glTF says
+    bool read_accessor(const Json& gltf, const Buffers& buffers, int accessor_index, int components, std::vector<float>& out_values)
+    {
+        const Json& accessor = gltf["accessors"][static_cast<std::size_t>(accessor_index)];
+        const Json& view     = gltf["bufferViews"][static_cast<std::size_t>(accessor["bufferView"].Index())];
+        const int   buffer   = view["buffer"].Index();
+        if (accessor_index < 0 || accessor.IsNull() || view.IsNull() || buffer < 0 || static_cast<std::size_t>(buffer) >= buffers.size() || !accessor["sparse"].IsNull())
+            return false;
+        static constexpr std::string_view TYPES[]     = { "SCALAR", "VEC2", "VEC3", "VEC4" };
+        const auto                        type        = std::find(std::begin(TYPES), std::end(TYPES), accessor["type"].text);
+        const int                         type_count  = type != std::end(TYPES) ? static_cast<int>(type - std::begin(TYPES)) + 1 : 0;
+        const int                         component   = accessor["componentType"].Index();
+        const bool                        normalized  = accessor["normalized"].boolean;
+        const std::size_t                 count       = static_cast<std::size_t>(std::max(accessor["count"].Index(), 0));
+        std::size_t                       size        = 0;
+        switch (component)
+        {
+            case 5120:
+            case 5121: size = 1; break;
+            case 5122:
+            case 5123: size = 2; break;
+            case 5125:
+            case 5126: size = 4; break;
+            default: return false;
+        }
+        if (type_count < components)
+            return false;
+        const std::size_t element = size * static_cast<std::size_t>(type_count);
+        const std::size_t stride  = view["byteStride"].IsNull() ? element : static_cast<std::size_t>(std::max(view["byteStride"].Index(), 0));
+        const std::size_t view_offset     = static_cast<std::size_t>(std::max(view["byteOffset"].Index(), 0));
+        const std::size_t accessor_offset = static_cast<std::size_t>(std::max(accessor["byteOffset"].Index(), 0));
+        const std::size_t length          = static_cast<std::size_t>(std::max(view["byteLength"].Index(), 0));
+        const auto&       bytes           = buffers[static_cast<std::size_t>(buffer)];
+        if (count == 0 || stride < element || view_offset + length > bytes.size() || accessor_offset + (count - 1) * stride + element > length)
+            return false;
+
+        out_values.resize(count * static_cast<std::size_t>(components));
+        const unsigned char* base = bytes.data() + view_offset + accessor_offset;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            for (int c = 0; c < components; ++c)
+            {
+                const unsigned char* at    = base + i * stride + static_cast<std::size_t>(c) * size;
+                float                value = 0.0f;
+                const auto           read  = [at]<typename T>(T) { T raw; std::memcpy(&raw, at, sizeof(T)); return raw; };
+                switch (component)
+                {
+                    case 5120: value = normalized ? std::max(static_cast<float>(read(std::int8_t{})) / 127.0f, -1.0f) : static_cast<float>(read(std::int8_t{})); break;
+                    case 5121: value = normalized ? static_cast<float>(read(std::uint8_t{})) / 255.0f : static_cast<float>(read(std::uint8_t{})); break;
+                    case 5122: value = normalized ? std::max(static_cast<float>(read(std::int16_t{})) / 32767.0f, -1.0f) : static_cast<float>(read(std::int16_t{})); break;
+                    case 5123: value = normalized ? static_cast<float>(read(std::uint16_t{})) / 65535.0f : static_cast<float>(read(std::uint16_t{})); break;
+                    case 5125: value = static_cast<float>(read(std::uint32_t{})); break;
+                    default: value = read(float{}); break;
+                }
+                out_values[i * static_cast<std::size_t>(components) + static_cast<std::size_t>(c)] = value;
+            }
+        }
+        return true;
+    }
+
+    bool read_indices(const Json& gltf, const Buffers& buffers, int accessor_index, std::vector<std::uint32_t>& out_indices)
+    {
+        // floats hold every index up to 2^24 exactly, far past what a part can take anyway
+        std::vector<float> values;
+        if (!read_accessor(gltf, buffers, accessor_index, 1, values))
+            return false;
+        out_indices.resize(values.size());
+        std::transform(values.begin(), values.end(), out_indices.begin(), [](float value) { return static_cast<std::uint32_t>(value); });
+        return true;
+    }
+
+    glm::mat4 node_transform(const Json& node)
+    {
+        const Json& matrix = node["matrix"];
+        if (matrix.Size() == 16)
+        {
+            glm::mat4 result{ 1.0f };
+            for (int i = 0; i < 16; ++i)
+                glm::value_ptr(result)[i] = static_cast<float>(matrix[static_cast<std::size_t>(i)].Number(0.0));
+            return result;
+        }
+        const auto vector = [&node](std::string_view key, glm::vec4 fallback)
+        {
+            const Json& values = node[key];
+            for (int i = 0; i < static_cast<int>(std::min<std::size_t>(values.Size(), 4)); ++i)
+                fallback[i] = static_cast<float>(values[static_cast<std::size_t>(i)].Number(fallback[i]));
+            return fallback;
+        };
+        const glm::vec4 translation = vector("translation", glm::vec4{ 0.0f });
+        const glm::vec4 rotation    = vector("rotation", glm::vec4{ 0.0f, 0.0f, 0.0f, 1.0f }); // x, y, z, w
+        const glm::vec4 scale       = vector("scale", glm::vec4{ 1.0f });
+        const glm::quat turn{ rotation.w, rotation.x, rotation.y, rotation.z };
+        return glm::translate(glm::mat4{ 1.0f }, glm::vec3{ translation }) * glm::mat4_cast(glm::normalize(turn)) * glm::scale(glm::mat4{ 1.0f }, glm::vec3{ scale });
+    }
+
+    // every triangle of the scene in model space, before it's cut into parts
+    struct Flattened
+    {
+        std::vector<MeshVertex>    vertices;
+        std::vector<glm::vec3>     positions; // the same, unpacked, for the overdraw pass
+        std::vector<std::uint32_t> indices;
+        int                        skipped = 0;
+    };
+
+    bool add_mesh(const Json& gltf, const Buffers& buffers, const Json& mesh, const glm::mat4& transform, Flattened& out_flat)
+    {
+        const glm::mat3 normal_transform = glm::inverseTranspose(glm::mat3{ transform });
+        const glm::vec3 light            = glm::normalize(glm::vec3{ 0.4f, 0.8f, 0.45f });
+        const Json&     primitives       = mesh["primitives"];
+        for (std::size_t p = 0; p < primitives.Size(); ++p)
+        {
+            const Json& primitive  = primitives[p];
+            const Json& attributes = primitive["attributes"];
+            if (primitive["mode"].Number(TRIANGLES) != TRIANGLES || attributes["POSITION"].IsNull())
+            {
+                ++out_flat.skipped;
+                continue;
+            }
+            std::vector<float> positions;
+            std::vector<float> normals;
+            std::vector<float> colors;
+            if (!read_accessor(gltf, buffers, attributes["POSITION"].Index(), 3, positions))
+                return false;
+            const std::size_t count       = positions.size() / 3;
+            const bool        has_normals = !attributes["NORMAL"].IsNull() && read_accessor(gltf, buffers, attributes["NORMAL"].Index(), 3, normals) && normals.size() == count * 3;
+            const Json&       color_0     = attributes["COLOR_0"];
+            const bool        has_rgba    = !color_0.IsNull() && gltf["accessors"][static_cast<std::size_t>(color_0.Index())]["type"].text == "VEC4";
+            const bool        has_colors  = !color_0.IsNull() && read_accessor(gltf, buffers, color_0.Index(), has_rgba ? 4 : 3, colors) && colors.size() == count * (has_rgba ? 4 : 3);
+
+            glm::vec4   base{ 1.0f };
+            const Json& factor = gltf["materials"][static_cast<std::size_t>(std::max(primitive["material"].Index(), 0))]["pbrMetallicRoughness"]["baseColorFactor"];
+            if (!primitive["material"].IsNull() && factor.Size() == 4)
+                base = glm::vec4{ factor[0].Number(1.0), factor[1].Number(1.0), factor[2].Number(1.0), factor[3].Number(1.0) };
+
+            std::vector<std::uint32_t> indices;
+            if (!primitive["indices"].IsNull())
+            {
+                if (!read_indices(gltf, buffers, primitive["indices"].Index(), indices))
+                    return false;
+            }
+            else
+            {
+                indices.resize(count);
+                for (std::size_t i = 0; i < count; ++i)
+                    indices[i] = static_cast<std::uint32_t>(i);
+            }
+            indices.resize(indices.size() / 3 * 3);
+            if (std::any_of(indices.begin(), indices.end(), [count](std::uint32_t index) { return index >= count; }))
+                return false;
+
+            const auto first = static_cast<std::uint32_t>(out_flat.vertices.size());
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const glm::vec3 position = glm::vec3{ transform * glm::vec4{ positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2], 1.0f } };
+                glm::vec4       color    = base;
+                if (has_colors)
+                {
+                    const std::size_t stride = has_rgba ? 4 : 3;
+                    color *= glm::vec4{ colors[i * stride], colors[i * stride + 1], colors[i * stride + 2], has_rgba ? colors[i * stride + 3] : 1.0f };
+                }
+                if (has_normals)
+                {
+                    const glm::vec3 normal = glm::normalize(normal_transform * glm::vec3{ normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2] });
+                    color                  = glm::vec4{ glm::vec3{ color } * (AMBIENT + (1.0f - AMBIENT) * std::max(glm::dot(normal, light), 0.0f)), color.a };
+                }
+                out_flat.vertices.push_back(MeshVertex{ position, glm::packUnorm4x8(glm::clamp(color, 0.0f, 1.0f)) });
+                out_flat.positions.push_back(position);
+            }
+            for (const std::uint32_t index : indices)
+                out_flat.indices.push_back(first + index);
+        }
+        return true;
+    }
+
+    bool flatten(const Json& gltf, const Buffers& buffers, Flattened& out_flat)
+    {
+        const Json& nodes  = gltf["nodes"];
+        const Json& meshes = gltf["meshes"];
+        const Json& scenes = gltf["scenes"];
+        const Json& scene  = scenes[static_cast<std::size_t>(std::max(gltf["scene"].Index(), 0))];
+        if (scene.IsNull())
+        {
+            // no scene to say where things go, so every mesh where it was modelled
+            for (std::size_t m = 0; m < meshes.Size(); ++m)
+            {
+                if (!add_mesh(gltf, buffers, meshes[m], glm::mat4{ 1.0f }, out_flat))
+                    return false;
+            }
+            return true;
+        }
+        struct Visit
+        {
+            int       node  = 0;
+            int       depth = 0;
+            glm::mat4 parent{ 1.0f };
+        };
+        std::vector<Visit> stack;
+        const Json&        roots = scene["nodes"];
+        for (std::size_t r = 0; r < roots.Size(); ++r)
+            stack.push_back(Visit{ roots[r].Index(), 0, glm::mat4{ 1.0f } });
+        while (!stack.empty())
+        {
+            const Visit visit = stack.back();
+            stack.pop_back();
+            const Json& node = nodes[static_cast<std::size_t>(visit.node)];
+            // a cycle would never end; glTF forbids them, but the file doesn't get to decide that
+            if (visit.node < 0 || node.IsNull() || visit.depth > MAX_NODE_DEPTH)
+                return false;
+            const glm::mat4 transform = visit.parent * node_transform(node);
+            if (!node["mesh"].IsNull() && !add_mesh(gltf, buffers, meshes[static_cast<std::size_t>(node["mesh"].Index())], transform, out_flat))
+                return false;
+            const Json& children = node["children"];
+            for (std::size_t c = 0; c < children.Size(); ++c)
+                stack.push_back(Visit{ children[c].Index(), visit.depth + 1, transform });
+        }
+        return true;
+    }
+
+    // cuts the triangles into parts of at most MAX_PART_VERTS vertices, each then optimized on its own; the whole model
+    // goes through the cache pass first so a part gets triangles that share vertices, not whatever order the file had
+    void build_parts(Flattened& flat, ModelData& out_model)
+    {
+        mesh_optimizer::OptimizeVertexCache(flat.indices, flat.vertices.size());
+        std::vector<std::uint32_t> local(flat.vertices.size(), mesh_optimizer::UNUSED);
+        std::vector<std::uint32_t> part_indices;
+        std::vector<std::uint32_t> part_globals; // by local index
+        float                      acmr      = 0.0f;
+        float                      overfetch = 0.0f;
+        std::size_t                triangle  = 0;
+        const std::size_t          triangles = flat.indices.size() / 3;
+        while (triangle < triangles)
+        {
+            part_indices.clear();
+            part_globals.clear();
+            for (; triangle < triangles; ++triangle)
+            {
+                const std::uint32_t* corners = &flat.indices[triangle * 3];
+                const std::size_t    added   = static_cast<std::size_t>(std::count_if(corners, corners + 3, [&local](std::uint32_t v) { return local[v] == mesh_optimizer::UNUSED; }));
+                if (part_globals.size() + added > MAX_PART_VERTS)
+                    break;
+                for (int k = 0; k < 3; ++k)
+                {
+                    if (local[corners[k]] == mesh_optimizer::UNUSED)
+                    {
+                        local[corners[k]] = static_cast<std::uint32_t>(part_globals.size());
+                        part_globals.push_back(corners[k]);
+                    }
+                    part_indices.push_back(local[corners[k]]);
+                }
+            }
+            for (const std::uint32_t global : part_globals)
+                local[global] = mesh_optimizer::UNUSED;
+
+            std::vector<glm::vec3> positions(part_globals.size());
+            for (std::size_t i = 0; i < part_globals.size(); ++i)
+                positions[i] = flat.positions[part_globals[i]];
+            mesh_optimizer::OptimizeVertexCache(part_indices, positions.size());
+            mesh_optimizer::OptimizeOverdraw(part_indices, positions);
+            std::vector<std::uint32_t> remap;
+            const std::size_t          used = mesh_optimizer::OptimizeVertexFetch(part_indices, positions.size(), remap);
+
+            std::vector<MeshVertex> vertices(used);
+            for (std::size_t i = 0; i < part_globals.size(); ++i)
+            {
+                if (remap[i] != mesh_optimizer::UNUSED)
+                    vertices[remap[i]] = flat.vertices[part_globals[i]];
+            }
+            ModelPart& part   = out_model.parts.emplace_back();
+            part.quantization = quantization_for(vertices);
+            part.vertices.reserve(used);
+            for (const MeshVertex& vertex : vertices)
+                part.vertices.push_back(pack_mesh_vertex(vertex, part.quantization));
+            part.indices.assign(part_indices.begin(), part_indices.end());
+            part.lods[0] = MeshLod{ 0, static_cast<std::uint32_t>(part_indices.size()) };
+
+            // each level simplified from the one before, its error the sum of theirs; the cache pass again, but not
+            // the overdraw one, since only small copies draw them
+            std::vector<glm::vec3> lod_positions(used);
+            for (std::size_t v = 0; v < used; ++v)
+                lod_positions[v] = vertices[v].position;
+            std::vector<std::uint32_t> level = part_indices;
+            float                      error = 0.0f;
+            for (std::size_t l = 1; l < part.lods.size(); ++l)
+            {
+                const std::size_t target      = static_cast<std::size_t>(static_cast<float>(level.size() / 3) * LOD_RATIO) * 3;
+                float             level_error = 0.0f;
+                const std::size_t count       = mesh_optimizer::Simplify(level, lod_positions, target, part.quantization.extent * LOD_MAX_ERROR, level_error);
+                if (count == level.size())
+                {
+                    part.lods[l] = part.lods[l - 1];
+                    continue;
+                }
+                level.resize(count);
+                error += level_error;
+                mesh_optimizer::OptimizeVertexCache(level, used);
+                part.lods[l]            = MeshLod{ static_cast<std::uint32_t>(part.indices.size()), static_cast<std::uint32_t>(count) };
+                out_model.lod_errors[l] = std::max(out_model.lod_errors[l], error);
+                part.indices.insert(part.indices.end(), level.begin(), level.end());
+            }
+
+            const float weight = static_cast<float>(part_indices.size() / 3);
+            acmr += mesh_optimizer::AnalyzeVertexCache(part_indices, used).acmr * weight;
+            overfetch += mesh_optimizer::AnalyzeVertexFetch(part_indices, used, sizeof(PackedMeshVertex)).overfetch * weight;
+        }
+        out_model.stats.acmr_after      = acmr / static_cast<float>(std::max<std::size_t>(triangles, 1));
+        out_model.stats.overfetch_after = overfetch / static_cast<float>(std::max<std::size_t>(triangles, 1));
+    }
+
+    // the counts the stats show, from the parts
+    void count_parts(ModelData& model)
+    {
+        for (const ModelPart& part : model.parts)
+        {
+            model.stats.vertices += static_cast<int>(part.vertices.size());
+            for (std::size_t l = 0; l < part.lods.size(); ++l)
+                model.stats.lod_triangles[l] += static_cast<int>(part.lods[l].index_count / 3);
+        }
+        model.stats.triangles = model.stats.lod_triangles[0];
+    }
+
+    // the first section: the bounds, the stats and each part's sizes, levels and quantization
+    struct CachedPart
+    {
+        std::uint32_t                        vertex_count = 0;
+        std::uint32_t                        index_count  = 0;
+        MeshQuantization                     quantization;
+        std::array<MeshLod, MODEL_LOD_COUNT> lods;
+    };
+
+    struct CachedHeader
+    {
+        glm::vec3 low{ 0.0f };
+        glm::vec3 high{ 0.0f };
+        int       skipped          = 0;
+        float     acmr_before      = 0.0f;
+        float     acmr_after       = 0.0f;
+        float     overfetch_before = 0.0f;
+        float     overfetch_after  = 0.0f;
+
+        std::array<float, MODEL_LOD_COUNT> lod_errors{};
+    };
+
+    static_assert(std::is_trivially_copyable_v<CachedHeader> && std::is_trivially_copyable_v<CachedPart> && std::is_trivially_copyable_v<PackedMeshVertex>);
+
+    bool open_cached(std::uint64_t key, ModelData& out_model)
+    {
+        decoded_cache::Entry entry;
+        if (!entry.Open(key))
+            return false;
+        const auto part_count = static_cast<std::size_t>(std::max(entry.Param(1), 0));
+        const auto header     = entry.Section(0);
+        if (entry.Param(0) != CACHE_FORMAT || entry.SectionCount() != 1 + 2 * part_count || header.size() != sizeof(CachedHeader) + part_count * sizeof(CachedPart))
+            return false;
+        CachedHeader cached;
+        std::memcpy(&cached, header.data(), sizeof(cached));
+        ModelData model;
+        model.low                    = cached.low;
+        model.high                   = cached.high;
+        model.stats.skipped          = cached.skipped;
+        model.stats.acmr_before      = cached.acmr_before;
+        model.stats.acmr_after       = cached.acmr_after;
+        model.stats.overfetch_before = cached.overfetch_before;
+        model.stats.overfetch_after  = cached.overfetch_after;
+        model.stats.from_cache       = true;
+        model.stats.cold_ms          = entry.ColdMs();
+        model.lod_errors             = cached.lod_errors;
+        for (std::size_t p = 0; p < part_count; ++p)
+        {
+            CachedPart sizes;
+            std::memcpy(&sizes, header.data() + sizeof(CachedHeader) + p * sizeof(CachedPart), sizeof(sizes));
+            const auto vertices = entry.Section(1 + 2 * p);
+            const auto indices  = entry.Section(2 + 2 * p);
+            if (vertices.size() != sizes.vertex_count * sizeof(PackedMeshVertex) || indices.size() != sizes.index_count * sizeof(std::uint16_t) || sizes.vertex_count > MAX_PART_VERTS ||
+                std::any_of(sizes.lods.begin(), sizes.lods.end(), [&sizes](const MeshLod& lod) { return lod.first_index > sizes.index_count || lod.index_count > sizes.index_count - lod.first_index; }))
+                return false;
+            ModelPart& part   = model.parts.emplace_back();
+            part.quantization = sizes.quantization;
+            part.lods         = sizes.lods;
+            part.vertices.resize(sizes.vertex_count);
+            part.indices.resize(sizes.index_count);
+            std::memcpy(part.vertices.data(), vertices.data(), vertices.size());
+            std::memcpy(part.indices.data(), indices.data(), indices.size());
+        }
+        count_parts(model);
+        out_model = std::move(model);
+        return true;
+    }
+
+    void store_cached(std::uint64_t key, const ModelData& model, double cold_ms)
+    {
+        std::vector<unsigned char> header(sizeof(CachedHeader) + model.parts.size() * sizeof(CachedPart));
+        const CachedHeader         cached{ model.low, model.high, model.stats.skipped, model.stats.acmr_before, model.stats.acmr_after, model.stats.overfetch_before, model.stats.overfetch_after, model.lod_errors };
+        std::memcpy(header.data(), &cached, sizeof(cached));
+        std::vector<std::span<const unsigned char>> sections{ std::span<const unsigned char>{ header } };
+        for (std::size_t p = 0; p < model.parts.size(); ++p)
+        {
+            const ModelPart& part = model.parts[p];
+            const CachedPart sizes{ static_cast<std::uint32_t>(part.vertices.size()), static_cast<std::uint32_t>(part.indices.size()), part.quantization, part.lods };
+            std::memcpy(header.data() + sizeof(CachedHeader) + p * sizeof(CachedPart), &sizes, sizeof(sizes));
+            sections.push_back(std::span<const unsigned char>{ reinterpret_cast<const unsigned char*>(part.vertices.data()), part.vertices.size() * sizeof(PackedMeshVertex) });
+            sections.push_back(std::span<const unsigned char>{ reinterpret_cast<const unsigned char*>(part.indices.data()), part.indices.size() * sizeof(std::uint16_t) });
+        }
+        decoded_cache::Store(key, { CACHE_FORMAT, static_cast<std::int32_t>(model.parts.size()), model.stats.triangles, model.stats.vertices }, sections, cold_ms);
+    }
+
+    // the JSON text and the .glb's binary chunk, or the whole file as JSON
+    bool split_glb(std::span<const unsigned char> bytes, std::string_view& out_json, std::span<const unsigned char>& out_bin)
+    {
+        const auto word = [&bytes](std::size_t offset)
+        {
+            std::uint32_t value = 0;
+            std::memcpy(&value, bytes.data() + offset, sizeof(value));
+            return value;
+        };
+        if (bytes.size() < 12 || word(0) != GLB_MAGIC)
+        {
+            out_json = std::string_view{ reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+            return true;
+        }
+        if (word(4) != 2 || word(8) > bytes.size())
+            return false;
+        const std::size_t length = word(8);
+        std::size_t       offset = 12;
+        while (offset + 8 <= length)
+        {
+            const std::size_t chunk_length = word(offset);
+            const std::uint32_t chunk_type = word(offset + 4);
+            if (offset + 8 + chunk_length > length)
+                return false;
+            const auto chunk = bytes.subspan(offset + 8, chunk_length);
+            if (chunk_type == GLB_JSON && out_json.empty())
+                out_json = std::string_view{ reinterpret_cast<const char*>(chunk.data()), chunk.size() };
+            else if (chunk_type == GLB_BIN && out_bin.empty())
+                out_bin = chunk;
+            offset += 8 + (chunk_length + 3) / 4 * 4;
+        }
+        return !out_json.empty();
+    }
+}
+
+bool load_gltf_model(const std::filesystem::path& filename, ModelData& out_model)
+{
+    const Uint64 begin = SDL_GetPerformanceCounter();
+    MappedFile   file;
+    if (!file.Open(filename))
+    {
+        LOG_WARN("No glTF model at ", filename.string());
+        return false;
+    }
+    std::string_view               json_text;
+    std::span<const unsigned char> bin;
+    Json                           gltf;
+    if (!split_glb(file.Bytes(), json_text, bin) || !JsonParser{ json_text }.Parse(gltf) || gltf.type != Json::Type::Object)
+    {
+        LOG_WARN("Not a glTF file: ", filename.string());
+        return false;
+    }
+    if (!gltf["asset"]["version"].text.starts_with("2."))
+    {
+        LOG_WARN("Only glTF 2.0 models load: ", filename.string(), " is ", gltf["asset"]["version"].text);
+        return false;
+    }
+
+    const std::uint64_t key = decoded_cache::IsEnabled() ? decoded_cache::Key(file.Bytes(), "gltf-model" + external_buffers_key(gltf, filename)) : 0;
+    if (key != 0 && open_cached(key, out_model))
+    {
+        out_model.stats.load_ms = elapsed_ms(begin);
+        decoded_cache::CountWarm(out_model.stats.load_ms, out_model.stats.cold_ms);
+        return true;
+    }
+
+    Buffers   buffers;
+    Flattened flat;
+    if (!load_buffers(gltf, filename, bin, buffers) || !flatten(gltf, buffers, flat))
+    {
+        LOG_WARN("glTF model ", filename.string(), " has buffers or accessors out of range");
+        return false;
+    }
+    if (flat.indices.empty())
+    {
+        LOG_WARN("glTF model ", filename.string(), " has no triangles");
+        return false;
+    }
+    ModelData model;
+    model.low  = flat.positions.front();
+    model.high = flat.positions.front();
+    for (const glm::vec3& position : flat.positions)
+    {
+        model.low  = glm::min(model.low, position);
+        model.high = glm::max(model.high, position);
+    }
+    model.stats.skipped          = flat.skipped;
+    model.stats.acmr_before      = mesh_optimizer::AnalyzeVertexCache(flat.indices, flat.vertices.size()).acmr;
+    model.stats.overfetch_before = mesh_optimizer::AnalyzeVertexFetch(flat.indices, flat.vertices.size(), sizeof(MeshVertex)).overfetch;
+    build_parts(flat, model);
+    count_parts(model);
+    model.stats.load_ms = elapsed_ms(begin);
+    model.stats.cold_ms = model.stats.load_ms;
+    decoded_cache::CountCold(model.stats.cold_ms);
+    if (key != 0)
+        store_cached(key, model, model.stats.cold_ms);
+    out_model = std::move(model);
+    return true;
+}
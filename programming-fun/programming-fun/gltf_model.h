@@ -0,0 +1,71 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "mesh_renderer.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <glm/vec3.hpp>
+#include <vector>
+
+inline constexpr int MODEL_LOD_COUNT = 4; // the full mesh and its simplifications
+
+// One MeshRenderer mesh of a model, small enough for 16 bit indices
+struct ModelPart
+{
+    std::vector<PackedMeshVertex>        vertices;
+    std::vector<std::uint16_t>           indices; // every level's, the full one first
+    std::array<MeshLod, MODEL_LOD_COUNT> lods;    // their runs of `indices`; a level simplification couldn't reach repeats the one before
+    MeshQuantization                     quantization;
+};
+
+// What the import did, for showing; the before and after figures are mesh_optimizer's, weighted by triangles
+struct ModelStats
+{
+    int    triangles        = 0; // at full detail
+    int    vertices         = 0;
+    int    skipped          = 0; // primitives that aren't triangle lists
+    float  acmr_before      = 0.0f;
+    float  acmr_after       = 0.0f;
+    float  overfetch_before = 0.0f;
+    float  overfetch_after  = 0.0f;
+    bool   from_cache       = false;
+    double load_ms          = 0.0; // this load, mapping the cache entry on a warm one
+    double cold_ms          = 0.0; // the import's, as the cache entry recorded it on a warm one
+
+    std::array<int, MODEL_LOD_COUNT> lod_triangles{};
+};
+
+struct ModelData
+{
+    std::vector<ModelPart> parts;
+    glm::vec3              low{ 0.0f }; // the bounds, in the model's space
+    glm::vec3              high{ 0.0f };
+    ModelStats             stats;
+
+    std::array<float, MODEL_LOD_COUNT> lod_errors{}; // how far each level strays from the full mesh at most, in model units
+};
+
+/**
+ * A glTF 2.0 model, .gltf or .glb, flattened into meshes MeshRenderer draws as they are.
+ *
+ * The default scene's nodes are walked with their transforms and every triangle list primitive lands in one
+ * model space: positions, and a color from COLOR_0 times the material's base color, shaded once from a fixed
+ * light when there are normals, since MeshRenderer doesn't light. Buffers may be the .glb's own, base64 data URIs
+ * or files beside the .gltf; sparse accessors, textures, skins and morph targets aren't read. The triangles are
+ * cut into parts of at most 65536 vertices, and each part goes through mesh_optimizer's vertex cache, overdraw
+ * and vertex fetch passes before its positions are packed to 16 bits within its bounds. Each part is then simplified
+ * into coarser levels of detail over the same vertices, each level from the one before at 40% of its triangles.
+ *
+ * The result goes into decoded_cache under the file's bytes, and any external buffers', so the next load maps
+ * GPU-ready parts instead of parsing and optimizing. Safe on any thread; the worker's, typically.
+ */
+// False, and logs why, for anything this can't read a model from
+bool load_gltf_model(const std::filesystem::path& filename, ModelData& out_model);
@@ -0,0 +1,297 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gpu_picker.h"
+
+#include "frame_packet.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "logger.h"
+#include "vertex_layout.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <limits>
+
+namespace
+{
+    constexpr const char* PICK_VERTEX_SHADER = R"(
+layout(location = 0) in vec2  aPosition;
+layout(location = 1) in vec2  aSize;
+layout(location = 2) in vec4  aRect;
+layout(location = 3) in float aRotation; // radians
+layout(location = 4) in uint  aId;
+
+uniform mat4 uProjection;
+
+out vec2      vTexCoord;
+flat out uint vId;
+
+void main()
+{
+    // triangle strip corners (0,0) (1,0) (0,1) (1,1), the same quad SpriteBatch draws
+    vec2  corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec2  local  = (corner - 0.5) * aSize;
+    float c      = cos(aRotation);
+    float s      = sin(aRotation);
+    vTexCoord    = mix(aRect.xy, aRect.zw, corner);
+    vId          = aId;
+    gl_Position  = uProjection * vec4(aPosition + vec2(c * local.x - s * local.y, s * local.x + c * local.y), 0.0, 1.0);
+}
+)";
+
+    constexpr const char* PICK_FRAGMENT_SHADER = R"(
+in vec2      vTexCoord;
+flat in uint vId;
+
+uniform sampler2D uTexture;
+uniform float     uAlphaCutoff; // 0 draws the whole quad
+
+out uint fragId;
+
+void main()
+{
+    if (texture(uTexture, vTexCoord).a < uAlphaCutoff)
+        discard;
+    fragId = vId;
+}
+)";
+
+    // per region; grows to the most sprites a pick has drawn
+    constexpr std::size_t INITIAL_STREAM_BYTES = 256 * sizeof(PickInstance);
+
+    constexpr auto PICK_LAYOUT = vertex_layout::PerInstance(vertex_layout::Make<PickInstance>(
+        VertexAttribute{ 0, attribute_format::Float2, offsetof(PickInstance, position) }, VertexAttribute{ 1, attribute_format::Float2, offsetof(PickInstance, size) },
+        VertexAttribute{ 2, attribute_format::Float4, offsetof(PickInstance, uv_rect) }, VertexAttribute{ 3, attribute_format::Float1, offsetof(PickInstance, rotation) },
+        VertexAttribute{ 4, attribute_format::UInt1, offsetof(PickInstance, id) }));
+
+    constexpr std::size_t TEXEL_BYTES = GpuPicker::SIZE * GpuPicker::SIZE * sizeof(std::uint32_t);
+}
+
+void GpuPicker::Setup()
+{
+    program.Request(PICK_VERTEX_SHADER, PICK_FRAGMENT_SHADER);
+
+    glGenVertexArrays(1, &vertex_array);
+    gl_state::BindVertexArray(vertex_array);
+    instance_stream.Setup(GL_ARRAY_BUFFER, INITIAL_STREAM_BYTES);
+    vertex_layout::Enable(PICK_LAYOUT);
+
+    glGenTextures(1, &texture);
+    gl_state::BindTexture(texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, SIZE, SIZE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LOG_ERROR("The picking target is incomplete, picks will find nothing");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (Slot& slot : slots)
+    {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(TEXEL_BYTES), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void GpuPicker::Shutdown()
+{
+    for (Slot& slot : slots)
+    {
+        if (slot.fence != nullptr)
+            glDeleteSync(slot.fence);
+        if (slot.buffer != 0)
+            glDeleteBuffers(1, &slot.buffer);
+        slot = Slot{};
+    }
+    oldest  = 0;
+    pending = 0;
+    if (framebuffer != 0)
+        glDeleteFramebuffers(1, &framebuffer);
+    gl_state::DeleteTexture(texture);
+    instance_stream.Shutdown();
+    gl_state::DeleteVertexArray(vertex_array);
+    program.Reset();
+    framebuffer         = 0;
+    texture             = 0;
+    vertex_array        = 0;
+    projection_location = -1;
+    alpha_test_location = -1;
+}
+
+void GpuPicker::Render(const FramePacket& frame)
+{
+    const PickRequest& request = frame.pick;
+    if (request.sequence == 0 || framebuffer == 0)
+        return;
+    if (!program.IsReady())
+    {
+        if (!program.Poll())
+            return;
+        projection_location = glGetUniformLocation(program.Id(), "uProjection");
+        alpha_test_location = glGetUniformLocation(program.Id(), "uAlphaCutoff");
+        gl_state::UseProgram(program.Id());
+        glUniform1i(glGetUniformLocation(program.Id(), "uTexture"), 0);
+    }
+    if (pending == SLOTS)
+    {
+        const std::lock_guard lock{ mutex };
+        ++stats.dropped;
+        return;
+    }
+
+    // the sprites that reach the square, in the order the sorted commands draw them, so the topmost writes last
+    const glm::vec2 half{ request.extent * 0.5f };
+    const glm::vec2 low  = request.cursor - half;
+    const glm::vec2 high = request.cursor + half;
+    instances.clear();
+    runs.clear();
+    for (const RenderCommand& command : frame.commands)
+    {
+        if (render_key::Layer(command.key) != RenderLayer::Sprites)
+            continue;
+        for (std::uint32_t i = command.first; i < command.first + command.count; ++i)
+        {
+            const SpriteDraw& draw = frame.sprites[i];
+            if (draw.pick_id == 0)
+                continue;
+            const SpriteInstance& sprite = draw.sprite;
+            const float           reach  = 0.5f * (std::abs(sprite.size.x) + std::abs(sprite.size.y));
+            if (sprite.position.x + reach < low.x || sprite.position.x - reach > high.x || sprite.position.y + reach < low.y || sprite.position.y - reach > high.y)
+                continue;
+            if (runs.empty() || runs.back().texture != draw.texture || runs.back().is_array != draw.is_array)
+                runs.push_back(Run{ draw.texture, draw.is_array, static_cast<std::uint32_t>(instances.size()), 0 });
+            instances.push_back(PickInstance{ sprite.position, sprite.size, sprite.uv_rect, sprite.rotation, draw.pick_id });
+            ++runs.back().count;
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    gl_state::Viewport(0, 0, SIZE, SIZE);
+    const GLuint nothing[4] = { 0, 0, 0, 0 };
+    glClearBufferuiv(GL_COLOR, 0, nothing);
+    if (!instances.empty())
+    {
+        const std::size_t bytes       = instances.size() * sizeof(PickInstance);
+        std::size_t       base_offset = 0;
+        gl_state::BindVertexArray(vertex_array);
+        if (unsigned char* mapped = instance_stream.Map(bytes, base_offset); mapped != nullptr)
+        {
+            std::memcpy(mapped, instances.data(), bytes);
+            instance_stream.Unmap();
+            gl_stats::CountUpload(bytes);
+
+            // screen y runs down, like the scene's projection
+            const glm::mat4 projection = glm::ortho(low.x, high.x, high.y, low.y);
+            gl_state::SetEnabled(GL_BLEND, false);
+            gl_state::UseProgram(program.Id());
+            glUniformMatrix4fv(projection_location, 1, GL_FALSE, glm::value_ptr(projection));
+            gl_state::ActiveTexture(0);
+            for (const Run& run : runs)
+            {
+                gl_state::BindTexture(run.is_array ? 0 : run.texture);
+                glUniform1f(alpha_test_location, run.is_array ? 0.0f : ALPHA_CUTOFF);
+                vertex_layout::Bind(PICK_LAYOUT, base_offset + run.first * sizeof(PickInstance));
+                glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(run.count));
+                gl_stats::CountDraw(static_cast<long long>(run.count) * 2);
+            }
+            instance_stream.EndFrame();
+        }
+    }
+
+    // into the buffer, so this returns once the copy is queued rather than done
+    Slot& slot = slots[static_cast<std::size_t>((oldest + pending) % SLOTS)];
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, SIZE, SIZE, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    slot.fence    = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.sequence = request.sequence;
+    slot.update   = updates;
+    ++pending;
+
+    const std::lock_guard lock{ mutex };
+    ++stats.picks;
+    stats.sprites   = static_cast<int>(instances.size());
+    stats.in_flight = pending;
+}
+
+void GpuPicker::Update()
+{
+    ++updates;
+    while (pending > 0)
+    {
+        Slot&        slot   = slots[static_cast<std::size_t>(oldest)];
+        const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        std::array<std::uint32_t, SIZE * SIZE> texels{};
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+#if defined(IS_WEBGL2)
+        // WebGL2 can't map a buffer; getBufferSubData is its non-blocking read once the fence has signalled
+        glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(TEXEL_BYTES), texels.data());
+#else
+        if (const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(TEXEL_BYTES), GL_MAP_READ_BIT); mapped != nullptr)
+        {
+            std::memcpy(texels.data(), mapped, TEXEL_BYTES);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+#endif
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        oldest = (oldest + 1) % SLOTS;
+        --pending;
+
+        const std::lock_guard lock{ mutex };
+        result          = Result{ slot.sequence, nearestId(texels), static_cast<int>(updates - slot.update) };
+        stats.in_flight = pending;
+    }
+}
+
+GpuPicker::Result GpuPicker::LastResult() const
+{
+    const std::lock_guard lock{ mutex };
+    return result;
+}
+
+GpuPicker::Stats GpuPicker::GetStats() const
+{
+    const std::lock_guard lock{ mutex };
+    return stats;
+}
+
+std::uint32_t GpuPicker::nearestId(const std::array<std::uint32_t, SIZE * SIZE>& texels) noexcept
+{
+    // texel centres against the square's middle, which falls between the four in the middle
+    std::uint32_t nearest  = 0;
+    float         distance = std::numeric_limits<float>::max();
+    for (int y = 0; y < SIZE; ++y)
+    {
+        for (int x = 0; x < SIZE; ++x)
+        {
+            const std::uint32_t id = texels[static_cast<std::size_t>(y * SIZE + x)];
+            const float         dx = static_cast<float>(x) + 0.5f - SIZE * 0.5f;
+            const float         dy = static_cast<float>(y) + 0.5f - SIZE * 0.5f;
+            if (id != 0 && dx * dx + dy * dy < distance)
+            {
+                nearest  = id;
+                distance = dx * dx + dy * dy;
+            }
+        }
+    }
+    return nearest;
+}
@@ -0,0 +1,132 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "shader.h"
+#include "stream_buffer.h"
+
+#include <GL/glew.h>
+#include <array>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <mutex>
+#include <vector>
+
+struct FramePacket;
+
+// What a frame asks the picker for; recorded by the main thread
+struct PickRequest
+{
+    std::uint64_t sequence = 0;   // 0 when this frame picks nothing
+    glm::vec2     cursor{ 0.0f }; // in window points, the scene's coordinates
+    float         extent = 16.0f; // points across the square around the cursor that is drawn
+};
+
+// What a sprite is in the id pass
+struct PickInstance
+{
+    glm::vec2     position{ 0.0f };
+    glm::vec2     size{ 0.0f };
+    glm::vec4     uv_rect{ 0.0f };
+    float         rotation = 0.0f;
+    std::uint32_t id       = 0;
+};
+
+/**
+ * Which sprite is under the cursor, found by drawing ids instead of testing shapes on the CPU.
+ *
+ * On a frame with a PickRequest, Render draws the frame's sprites around the cursor into a SIZE x SIZE
+ * GL_R32UI target: each writes its SpriteDraw::pick_id, in the order the sorted commands draw them, so the one
+ * on top wins, and texels under ALPHA_CUTOFF are discarded. With `extent` wider than SIZE the square is drawn
+ * at less than a texel a point. Only the sprites whose bounds reach the square are uploaded, and only on those
+ * frames. The texels go into one of SLOTS pixel pack buffers behind a fence, like FrameCapture's; Update reads
+ * a slot once its fence has signalled, a frame or more later, and the id nearest the middle of the square is the
+ * result. Nothing waits for the GPU: a request that finds every slot taken is dropped.
+ *
+ * Render and Update are the GL thread's; LastResult and GetStats any thread's.
+ */
+class GpuPicker
+{
+public:
+    static constexpr int   SIZE         = 16;
+    static constexpr int   SLOTS        = 3;
+    static constexpr float ALPHA_CUTOFF = 0.5f;
+
+    struct Result
+    {
+        std::uint64_t sequence = 0; // the request's, 0 before any came back
+        std::uint32_t id       = 0; // the sprite's pick_id, 0 for none
+        int           frames   = 0; // Updates between the pick and its readback
+    };
+
+    struct Stats
+    {
+        std::uint64_t picks     = 0;
+        std::uint64_t dropped   = 0; // found every slot taken
+        int           sprites   = 0; // drawn by the latest pick
+        int           in_flight = 0;
+    };
+
+    GpuPicker() = default;
+
+    GpuPicker(const GpuPicker&)                = delete;
+    GpuPicker& operator=(const GpuPicker&)     = delete;
+    GpuPicker(GpuPicker&&) noexcept            = delete;
+    GpuPicker& operator=(GpuPicker&&) noexcept = delete;
+
+    void Setup();
+    void Shutdown();
+
+    // After the frame's commands are sorted; changes the framebuffer, viewport and program bindings
+    void Render(const FramePacket& frame);
+    // Once a frame: collects the readbacks that are done, oldest first
+    void   Update();
+    Result LastResult() const;
+    Stats  GetStats() const;
+
+private:
+    // neighbours in draw order that share a texture, one instanced draw
+    struct Run
+    {
+        GLuint        texture  = 0;
+        bool          is_array = false; // a TextureArray's, which the id pass can't sample, so it draws whole quads
+        std::uint32_t first    = 0;
+        std::uint32_t count    = 0;
+    };
+
+    struct Slot
+    {
+        GLuint        buffer   = 0;
+        GLsync        fence    = nullptr;
+        std::uint64_t sequence = 0;
+        std::uint64_t update   = 0; // `updates` when it was read
+    };
+
+    // the texels' id nearest the middle of the square
+    static std::uint32_t nearestId(const std::array<std::uint32_t, SIZE * SIZE>& texels) noexcept;
+
+private:
+    ShaderProgram             program;
+    GLint                     projection_location = -1;
+    GLint                     alpha_test_location = -1;
+    GLuint                    vertex_array        = 0;
+    GLuint                    texture             = 0;
+    GLuint                    framebuffer         = 0;
+    StreamBuffer              instance_stream;
+    std::vector<PickInstance> instances; // Render's scratch
+    std::vector<Run>          runs;
+    std::array<Slot, SLOTS>   slots;
+    int                       oldest  = 0;
+    int                       pending = 0;
+    std::uint64_t             updates = 0;
+
+    mutable std::mutex mutex; // the two below, which the main thread reads
+    Result             result;
+    Stats              stats;
+};
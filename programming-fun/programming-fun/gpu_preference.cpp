@@ -0,0 +1,64 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gpu_preference.h"
+
+#include <array>
+#include <cstdlib>
+
+#if defined(_WIN32)
+// https://docs.nvidia.com/gameworks/content/technologies/desktop/optimus.htm
+// https://gpuopen.com/learn/amdpowerxpressrequesthighperformance/
+extern "C"
+{
+    __declspec(dllexport) unsigned long NvOptimusEnablement                  = 1;
+    __declspec(dllexport) int           AmdPowerXpressRequestHighPerformance = 1;
+}
+#endif
+
+namespace gpu_preference
+{
+    void Apply(GpuPreference preference)
+    {
+        const bool is_discrete = preference == GpuPreference::Performance;
+#if defined(_WIN32)
+        NvOptimusEnablement                  = is_discrete ? 1 : 0;
+        AmdPowerXpressRequestHighPerformance = is_discrete ? 1 : 0;
+#elif defined(__linux__)
+        // 1 is the other GPU than the one driving the display, usually the discrete one; an explicit setting wins
+        if (preference != GpuPreference::System)
+            setenv("DRI_PRIME", is_discrete ? "1" : "0", 0);
+#else
+        (void)is_discrete;
+#endif
+    }
+
+    bool Parse(std::string_view text, GpuPreference& out_preference)
+    {
+        constexpr std::array PREFERENCES{ GpuPreference::Performance, GpuPreference::BatterySaver, GpuPreference::System };
+        for (const GpuPreference preference : PREFERENCES)
+        {
+            if (text == Name(preference))
+            {
+                out_preference = preference;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view Name(GpuPreference preference) noexcept
+    {
+        switch (preference)
+        {
+            case GpuPreference::Performance: return "performance";
+            case GpuPreference::BatterySaver: return "battery-saver";
+            case GpuPreference::System: return "system";
+        }
+        return "performance";
+    }
+}
@@ -0,0 +1,37 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <string_view>
+
+enum class GpuPreference
+{
+    Performance,  // the discrete GPU where there is one
+    BatterySaver, // the integrated one, with the Low tier and a frame rate cap unless the config says otherwise
+    System        // whatever the driver and the OS settings pick
+};
+
+/**
+ * Which GPU a hybrid laptop gives the GL context.
+ *
+ * Optimus and PowerXpress drivers look for the exported NvOptimusEnablement and
+ * AmdPowerXpressRequestHighPerformance when they load, which happens in SDL_CreateWindow, and run the
+ * process on the discrete GPU when they are non-zero. The exports are always there; Apply clears them for
+ * anything but Performance before the window exists. Mesa's PRIME offload reads DRI_PRIME the same way, so
+ * Apply sets that too unless the environment already did. The OS's per-app graphics setting still wins over
+ * both, which is why the chosen GL_RENDERER is reported rather than assumed.
+ */
+namespace gpu_preference
+{
+    inline constexpr int BATTERY_SAVER_FPS = 30;
+
+    // Before the first GL window is created
+    void             Apply(GpuPreference preference);
+    bool             Parse(std::string_view text, GpuPreference& out_preference);
+    std::string_view Name(GpuPreference preference) noexcept;
+}
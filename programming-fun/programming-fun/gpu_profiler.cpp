@@ -0,0 +1,185 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "gpu_profiler.h"
+
+#include "gl_extensions.h"
+
+#include <algorithm>
+
+#if !defined(GL_GPU_DISJOINT_EXT)
+#    define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+namespace
+{
+    struct GpuFrameSlot
+    {
+        GLuint      queries[profiler::MAX_GPU_ZONES] = { 0 };
+        const char* names[profiler::MAX_GPU_ZONES]   = { nullptr };
+        int         count                            = 0;
+    };
+
+    struct
+    {
+        bool                     supported = false;
+        GpuFrameSlot             slots[profiler::GPU_QUERY_LATENCY];
+        GpuFrameSlot*            current      = nullptr;
+        int                      frame_index  = 0;
+        bool                     zone_is_open = false;
+        profiler::GpuFrameResult latest;
+        float                    history[profiler::MAX_FRAMES] = { 0 };
+        int                      history_write                 = 0;
+        int                      history_count                 = 0;
+        Uint64                   resolved_total                = 0;
+    } gGpu;
+
+    GLuint64 query_result(GLuint query)
+    {
+        GLuint64 nanoseconds = 0;
+#if defined(IS_WEBGL2)
+        glGetQueryObjectui64vEXT(query, GL_QUERY_RESULT, &nanoseconds);
+#else
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+#endif
+        return nanoseconds;
+    }
+
+    // Reads back the slot's queries if the GPU is done with them. Never blocks: late results are dropped.
+    void resolve(GpuFrameSlot& slot)
+    {
+        if (slot.count == 0)
+            return;
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(slot.queries[slot.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+#if defined(IS_WEBGL2)
+        GLint disjoint = GL_FALSE;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        if (disjoint)
+            available = GL_FALSE;
+#endif
+        if (available == GL_FALSE)
+        {
+            slot.count = 0;
+            return;
+        }
+
+        profiler::GpuFrameResult result;
+        for (int i = 0; i < slot.count; ++i)
+        {
+            const double ms      = static_cast<double>(query_result(slot.queries[i])) * 1e-6;
+            result.zones[i].name = slot.names[i];
+            result.zones[i].ms   = ms;
+            result.total_ms += ms;
+        }
+        result.zone_count = slot.count;
+        gGpu.latest       = result;
+
+        gGpu.history[gGpu.history_write] = static_cast<float>(result.total_ms);
+        gGpu.history_write               = (gGpu.history_write + 1) % profiler::MAX_FRAMES;
+        gGpu.history_count               = std::min(gGpu.history_count + 1, profiler::MAX_FRAMES);
+        ++gGpu.resolved_total;
+        slot.count = 0;
+    }
+}
+
+namespace profiler
+{
+    void InitGpu()
+    {
+#if defined(IS_WEBGL2)
+        gGpu.supported = has_gl_extension("GL_EXT_disjoint_timer_query_webgl2") || has_gl_extension("GL_EXT_disjoint_timer_query");
+#else
+        gGpu.supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+#endif
+        if (!gGpu.supported)
+            return;
+        for (auto& slot : gGpu.slots)
+            glGenQueries(MAX_GPU_ZONES, slot.queries);
+#if PROFILER_TRACY && !defined(IS_WEBGL2)
+        TracyGpuContext;
+#endif
+    }
+
+    void ShutdownGpu()
+    {
+        if (!gGpu.supported)
+            return;
+        for (auto& slot : gGpu.slots)
+            glDeleteQueries(MAX_GPU_ZONES, slot.queries);
+        gGpu.supported = false;
+    }
+
+    void BeginGpuFrame()
+    {
+        if (!gGpu.supported)
+            return;
+        GpuFrameSlot& slot = gGpu.slots[gGpu.frame_index % GPU_QUERY_LATENCY];
+        resolve(slot);
+        gGpu.current = &slot;
+    }
+
+    void EndGpuFrame()
+    {
+#if PROFILER_TRACY && !defined(IS_WEBGL2)
+        if (gGpu.current != nullptr)
+            TracyGpuCollect;
+#endif
+        gGpu.current = nullptr;
+        ++gGpu.frame_index;
+    }
+
+    bool IsGpuTimingSupported() noexcept
+    {
+        return gGpu.supported;
+    }
+
+    bool IsGpuFrameOpen() noexcept
+    {
+        return gGpu.current != nullptr;
+    }
+
+    const GpuFrameResult& LatestGpuFrame() noexcept
+    {
+        return gGpu.latest;
+    }
+
+    int GpuFrameCount() noexcept
+    {
+        return gGpu.history_count;
+    }
+
+    Uint64 GpuFramesResolved() noexcept
+    {
+        return gGpu.resolved_total;
+    }
+
+    float GpuFrameMilliseconds(int frames_ago) noexcept
+    {
+        return gGpu.history[(gGpu.history_write - 1 - frames_ago + 2 * MAX_FRAMES) % MAX_FRAMES];
+    }
+
+    GpuZone::GpuZone(const char* name) noexcept
+    {
+        GpuFrameSlot* slot = gGpu.current;
+        if (slot == nullptr || gGpu.zone_is_open || slot->count == MAX_GPU_ZONES)
+            return;
+        slot->names[slot->count] = name;
+        glBeginQuery(GL_TIME_ELAPSED, slot->queries[slot->count]);
+        gGpu.zone_is_open = true;
+        is_active         = true;
+    }
+
+    GpuZone::~GpuZone()
+    {
+        if (!is_active)
+            return;
+        glEndQuery(GL_TIME_ELAPSED);
+        ++gGpu.current->count;
+        gGpu.zone_is_open = false;
+    }
+}
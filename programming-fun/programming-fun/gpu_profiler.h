@@ -0,0 +1,86 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "gl_debug.h"
+#include "profiler.h"
+
+#include <GL/glew.h>
+
+// TracyOpenGL is built on GL_TIMESTAMP queries, which WebGL does not have
+#if PROFILER_TRACY && !defined(IS_WEBGL2)
+#    include <tracy/TracyOpenGL.hpp>
+#    define PROFILER_TRACY_GPU_ZONE(name) TracyGpuNamedZone(PROFILER_CONCAT(tracy_gpu_zone_, __LINE__), name, profiler::IsGpuFrameOpen());
+#else
+#    define PROFILER_TRACY_GPU_ZONE(name)
+#endif
+
+namespace profiler
+{
+    inline constexpr int MAX_GPU_ZONES = 16;
+    // results are read this many frames after submission so we never wait on the GPU
+    inline constexpr int GPU_QUERY_LATENCY = 4;
+
+    struct GpuZoneResult
+    {
+        const char* name = nullptr;
+        double      ms   = 0.0;
+    };
+
+    struct GpuFrameResult
+    {
+        int           zone_count = 0;
+        double        total_ms   = 0.0;
+        GpuZoneResult zones[MAX_GPU_ZONES];
+    };
+
+    // Call after the GL context is current / before it is destroyed
+    void InitGpu();
+    void ShutdownGpu();
+
+    void BeginGpuFrame();
+    void EndGpuFrame();
+
+    bool                  IsGpuTimingSupported() noexcept;
+    // Between BeginGpuFrame and EndGpuFrame on a context that supports timing
+    bool                  IsGpuFrameOpen() noexcept;
+    const GpuFrameResult& LatestGpuFrame() noexcept;
+    int                   GpuFrameCount() noexcept;
+    // Every frame resolved so far, not capped by the history; changes exactly when LatestGpuFrame does
+    Uint64 GpuFramesResolved() noexcept;
+    // frames_ago = 0 is the newest resolved frame
+    float GpuFrameMilliseconds(int frames_ago) noexcept;
+
+    /**
+     * Times the GL commands issued in this scope with a GL_TIME_ELAPSED query.
+     * Elapsed-time queries cannot overlap, so a zone opened inside another one is ignored.
+     */
+    class [[nodiscard]] GpuZone
+    {
+    public:
+        explicit GpuZone(const char* name) noexcept;
+        ~GpuZone();
+
+        GpuZone(const GpuZone&)            = delete;
+        GpuZone& operator=(const GpuZone&) = delete;
+
+    private:
+        bool is_active = false;
+    };
+}
+
+// the zone's name is also a debug group, so GPU captures show the passes the profiler does
+#if PROFILER_ENABLED
+#    define PROFILE_GPU_ZONE(name)    GL_DEBUG_GROUP(name); PROFILER_TRACY_GPU_ZONE(name) const profiler::GpuZone PROFILER_CONCAT(profile_gpu_zone_, __LINE__){ name }
+#    define PROFILE_GPU_BEGIN_FRAME() profiler::BeginGpuFrame()
+#    define PROFILE_GPU_END_FRAME()   profiler::EndGpuFrame()
+#else
+#    define PROFILE_GPU_ZONE(name)    GL_DEBUG_GROUP(name)
+#    define PROFILE_GPU_BEGIN_FRAME() ((void)0)
+#    define PROFILE_GPU_END_FRAME()   ((void)0)
+#endif
@@ -0,0 +1,141 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "hardware_probe.h"
+
+#include "gl_extensions.h"
+#include "gl_state.h"
+#include "shader.h"
+
+#include <GL/glew.h>
+#include <SDL_cpuinfo.h>
+#include <SDL_timer.h>
+#include <stdexcept>
+
+namespace
+{
+    constexpr GLsizei FILL_SIZE   = 1024;
+    constexpr int     FILL_PASSES = 8;
+    // Gpixels per second of the benchmark's shader; a recent integrated part sits around the first, a mid-range card well past the second
+    constexpr double LOW_FILL  = 2.0;
+    constexpr double HIGH_FILL = 8.0;
+
+    constexpr const char* FILL_VERTEX_SHADER = R"(
+void main()
+{
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    // enough ALU per pixel that the rate reflects the shader cores and not only the ROPs
+    constexpr const char* FILL_FRAGMENT_SHADER = R"(
+out vec4 fragColor;
+
+void main()
+{
+    vec2  p     = gl_FragCoord.xy * 0.001;
+    float value = 0.0;
+    for (int i = 0; i < 16; ++i)
+        value += sin(p.x * float(i) + p.y) * cos(p.y * float(i) - p.x);
+    fragColor = vec4(value, p, 1.0);
+}
+)";
+
+    std::string gl_string(GLenum name)
+    {
+        const auto* text = reinterpret_cast<const char*>(glGetString(name));
+        return text != nullptr ? text : "";
+    }
+
+    double seconds_since(Uint64 start) noexcept
+    {
+        return static_cast<double>(SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    // full screen passes into a target of our own; 0 when something wasn't available
+    double measure_fill()
+    {
+        GLuint program = 0;
+        try
+        {
+            program = compile_program(FILL_VERTEX_SHADER, FILL_FRAGMENT_SHADER);
+        }
+        catch (const std::runtime_error&)
+        {
+            return 0.0;
+        }
+        GLuint texture = 0, framebuffer = 0, vertex_array = 0;
+        glGenTextures(1, &texture);
+        gl_state::BindTexture(texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, FILL_SIZE, FILL_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        glGenVertexArrays(1, &vertex_array);
+
+        double gpixels = 0.0;
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE)
+        {
+            gl_state::Viewport(0, 0, FILL_SIZE, FILL_SIZE);
+            gl_state::UseProgram(program);
+            gl_state::BindVertexArray(vertex_array);
+            gl_state::SetEnabled(GL_BLEND, false);
+            gl_state::SetEnabled(GL_DEPTH_TEST, false);
+            // the first pass pays for whatever the driver defers to first use
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glFinish();
+            const Uint64 start = SDL_GetPerformanceCounter();
+            for (int pass = 0; pass < FILL_PASSES; ++pass)
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+            glFinish();
+            const double seconds = seconds_since(start);
+            if (seconds > 0.0)
+                gpixels = static_cast<double>(FILL_PASSES) * FILL_SIZE * FILL_SIZE / seconds * 1e-9;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        gl_state::DeleteVertexArray(vertex_array);
+        gl_state::DeleteTexture(texture);
+        gl_state::DeleteProgram(program);
+        return gpixels;
+    }
+}
+
+namespace hardware_probe
+{
+    HardwareCaps Probe()
+    {
+        const Uint64 start = SDL_GetPerformanceCounter();
+        HardwareCaps caps;
+        glGetIntegerv(GL_MAJOR_VERSION, &caps.gl_major);
+        glGetIntegerv(GL_MINOR_VERSION, &caps.gl_minor);
+        caps.vendor   = gl_string(GL_VENDOR);
+        caps.renderer = gl_string(GL_RENDERER);
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &caps.max_texture_size);
+        glGetIntegerv(GL_MAX_SAMPLES, &caps.max_samples);
+        const bool is_44          = caps.gl_major > 4 || (caps.gl_major == 4 && caps.gl_minor >= 4);
+        caps.has_buffer_storage   = is_44 || has_gl_extension("GL_ARB_buffer_storage") || has_gl_extension("GL_EXT_buffer_storage");
+        caps.has_bindless         = has_gl_extension("GL_ARB_bindless_texture");
+        caps.has_parallel_compile = has_gl_extension("GL_KHR_parallel_shader_compile") || has_gl_extension("GL_ARB_parallel_shader_compile");
+        caps.cpu_count            = SDL_GetCPUCount();
+        caps.ram_mb               = SDL_GetSystemRAM();
+        caps.fill_gpixels         = measure_fill();
+        caps.probe_ms             = seconds_since(start) * 1000.0;
+        return caps;
+    }
+
+    QualityTier ChooseTier(const HardwareCaps& caps) noexcept
+    {
+        const bool is_slow_gpu = caps.fill_gpixels > 0.0 && caps.fill_gpixels < LOW_FILL;
+        if (is_slow_gpu || caps.max_texture_size < 8192 || caps.cpu_count <= 2 || caps.ram_mb < 4096)
+            return QualityTier::Low;
+        if (caps.fill_gpixels >= HIGH_FILL && caps.max_samples >= 4 && caps.cpu_count >= 6 && caps.ram_mb >= 8192)
+            return QualityTier::High;
+        return QualityTier::Medium;
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "app_config.h"
+
+#include <string>
+
+struct HardwareCaps
+{
+    int         gl_major = 0;
+    int         gl_minor = 0;
+    std::string vendor;
+    std::string renderer;
+    bool        has_buffer_storage   = false;
+    bool        has_bindless         = false;
+    bool        has_parallel_compile = false;
+    int         max_texture_size     = 0;
+    int         max_samples          = 0;
+    int         cpu_count            = 0;
+    int         ram_mb               = 0;
+    double      fill_gpixels         = 0.0; // per second, shaded pixels in the micro-benchmark; 0 when it didn't run
+    double      probe_ms             = 0.0;
+};
+
+/**
+ * What the machine is, for picking defaults that suit it.
+ *
+ * Probe reads the context's version, limits and the extensions the renderers have faster paths for, SDL's
+ * core count and RAM, and times a short fill benchmark: a few full screen passes of a shader with some ALU
+ * work into a 1024x1024 target, waited on with glFinish. Some milliseconds at startup, once, with the GL
+ * context current and before anything else is drawn. ChooseTier turns that into a QualityTier; the thresholds
+ * are coarse on purpose, integrated parts and small machines land in Low, the rest in Medium unless the
+ * GPU and the CPU are both well ahead.
+ */
+namespace hardware_probe
+{
+    HardwareCaps Probe();
+    QualityTier  ChooseTier(const HardwareCaps& caps) noexcept;
+}
@@ -0,0 +1,87 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "hitch_detector.h"
+
+#include "logger.h"
+#include "profiler.h"
+#include "worker_pool.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+
+void HitchDetector::Setup(WorkerPool& worker_pool, Metadata system_info, std::filesystem::path trace_directory, double threshold)
+{
+    workers   = &worker_pool;
+    system    = std::move(system_info);
+    directory = std::move(trace_directory);
+    SetThreshold(threshold);
+}
+
+void HitchDetector::SetThreshold(double threshold)
+{
+    threshold_ms = std::max(threshold, 0.0);
+    if (threshold_ms > 0.0)
+        profiler::StartRecording();
+}
+
+double HitchDetector::Threshold() const noexcept
+{
+    return threshold_ms;
+}
+
+void HitchDetector::Record(double frame_ms)
+{
+    ++frame;
+    if (pending_frames > 0 && --pending_frames == 0)
+        writeTrace();
+    if (threshold_ms <= 0.0 || frame_ms <= threshold_ms)
+        return;
+    ++stats.hitches;
+    stats.worst_ms = std::max(stats.worst_ms, frame_ms);
+    const bool is_cooling = last_trace != 0 && profiler::ToMilliseconds(SDL_GetPerformanceCounter() - last_trace) < COOLDOWN_SECONDS * 1000.0;
+    if (workers == nullptr || pending_frames > 0 || is_cooling || stats.traces >= MAX_TRACES)
+        return;
+    LOG_WARN("Frame ", frame, " took ", frame_ms, " ms, over the hitch threshold of ", threshold_ms, " ms; writing a trace");
+    pending_frames = FRAMES_AFTER;
+    pending_ms     = frame_ms;
+    pending_frame  = frame;
+}
+
+const HitchDetector::Stats& HitchDetector::GetStats() const noexcept
+{
+    return stats;
+}
+
+void HitchDetector::writeTrace()
+{
+    last_trace                        = SDL_GetPerformanceCounter();
+    profiler::RecentTrace recent      = profiler::CopyRecent(WINDOW_SECONDS);
+    Metadata              metadata    = system;
+    const auto            since_epoch = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+    metadata.emplace_back("unix_time", std::to_string(since_epoch.count()));
+    metadata.emplace_back("hitch_frame", std::to_string(pending_frame));
+    metadata.emplace_back("hitch_ms", std::to_string(pending_ms));
+    metadata.emplace_back("threshold_ms", std::to_string(threshold_ms));
+    metadata.emplace_back("frames_after", std::to_string(FRAMES_AFTER));
+    metadata.emplace_back("hitches_so_far", std::to_string(stats.hitches));
+    metadata.emplace_back("zones_lapped", std::to_string(recent.lapped));
+    ++stats.traces;
+    const std::filesystem::path filename = directory / ("hitch_" + std::to_string(stats.traces) + "_" + std::to_string(static_cast<int>(pending_ms)) + "ms.json");
+    stats.last_trace                     = filename.string();
+    // formatting a few seconds of every thread would make a hitch of its own here
+    workers->Submit(
+        [recent = std::move(recent), metadata = std::move(metadata), filename]()
+        {
+            std::error_code error;
+            std::filesystem::create_directories(filename.parent_path(), error);
+            if (profiler::WriteTrace(recent, filename, metadata))
+                LOG_INFO("Hitch trace written to ", std::filesystem::absolute(filename).string());
+        });
+}
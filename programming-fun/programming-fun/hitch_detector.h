@@ -0,0 +1,78 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+class WorkerPool;
+
+/**
+ * Writes a Chrome trace of the seconds around any frame slower than a threshold, for stalls nobody can reproduce.
+ *
+ * While the threshold is above 0 the profiler's flight recorder runs, keeping every thread's recent zones. A frame
+ * over the threshold waits FRAMES_AFTER more frames, so the trace also shows what came after, then the last
+ * WINDOW_SECONDS of zones are copied out and written on a worker to the directory as "hitch_N_<ms>ms.json", with
+ * the system information given to Setup and the hitch's own numbers in its "otherData". Hitches during the
+ * COOLDOWN_SECONDS after a trace only count, and at most MAX_TRACES are written per run, so a machine that
+ * stalls all the time doesn't fill its disk. Main thread.
+ */
+class HitchDetector
+{
+public:
+    static constexpr double WINDOW_SECONDS   = 5.0;
+    static constexpr int    FRAMES_AFTER     = 30;
+    static constexpr double COOLDOWN_SECONDS = 30.0;
+    static constexpr int    MAX_TRACES       = 10;
+
+    struct Stats
+    {
+        std::uint64_t hitches  = 0;
+        int           traces   = 0; // handed to a worker to write
+        double        worst_ms = 0.0;
+        std::string   last_trace;
+    };
+
+    using Metadata = std::vector<std::pair<std::string, std::string>>;
+
+    HitchDetector() = default;
+
+    HitchDetector(const HitchDetector&)                = delete;
+    HitchDetector& operator=(const HitchDetector&)     = delete;
+    HitchDetector(HitchDetector&&) noexcept            = delete;
+    HitchDetector& operator=(HitchDetector&&) noexcept = delete;
+
+    // `system` describes the machine and build; the workers have to outlive the writes
+    void Setup(WorkerPool& workers, Metadata system, std::filesystem::path directory, double threshold_ms);
+    // 0 turns detection off; the flight recorder keeps running once started
+    void   SetThreshold(double threshold_ms);
+    double Threshold() const noexcept;
+
+    // Once per frame with the whole frame's time, end to end
+    void Record(double frame_ms);
+
+    const Stats& GetStats() const noexcept;
+
+private:
+    void writeTrace();
+
+private:
+    WorkerPool*           workers = nullptr;
+    Metadata              system;
+    std::filesystem::path directory;
+    double                threshold_ms   = 0.0;
+    std::uint64_t         frame          = 0;
+    int                   pending_frames = 0; // until the trace of `pending_ms` is written
+    double                pending_ms     = 0.0;
+    std::uint64_t         pending_frame  = 0;
+    std::uint64_t         last_trace     = 0; // performance counter when the last one was written
+    Stats                 stats;
+};
@@ -0,0 +1,330 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "imgui_fonts.h"
+
+#include "decoded_cache.h"
+#include "gl_backend.h"
+#include "gl_state.h"
+#include "imgui_renderer.h"
+#include "logger.h"
+#include "memory_tracker.h"
+#include "startup_trace.h"
+#include "upload_budget.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <backends/imgui_impl_opengl3.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <imgui.h>
+#include <span>
+#include <vector>
+
+namespace
+{
+    // one entry: params are width, height, font count and the custom rect count; sections are the alpha texels,
+    // an AtlasHeader, a FontHeader per font, the custom rects, then each font's glyphs
+    constexpr std::size_t FIXED_SECTIONS = 4;
+
+    struct AtlasHeader
+    {
+        ImVec2 uv_scale;
+        ImVec2 uv_white_pixel;
+        ImVec4 uv_lines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+        int    pack_id_mouse_cursors;
+        int    pack_id_lines;
+    };
+
+    struct FontHeader
+    {
+        float font_size;
+        float ascent;
+        float descent;
+        int   metrics_total_surface;
+    };
+
+    struct Fonts
+    {
+        GLuint                     texture        = 0;
+        bool                       is_backend_set = false;
+        std::vector<unsigned char> band; // RGBA rows on their way up
+        imgui_fonts::Stats         stats;
+    };
+
+    Fonts fonts;
+
+    template <typename T>
+    void append(std::vector<unsigned char>& bytes, const T& value)
+    {
+        const auto* first = reinterpret_cast<const unsigned char*>(&value);
+        bytes.insert(bytes.end(), first, first + sizeof(T));
+    }
+
+    template <typename T>
+    std::span<const unsigned char> bytes_of(std::span<const T> values) noexcept
+    {
+        return { reinterpret_cast<const unsigned char*>(values.data()), values.size_bytes() };
+    }
+
+    // everything Build reads, with each font's bytes folded to their hash
+    std::uint64_t key_for(ImFontAtlas& atlas)
+    {
+        std::vector<unsigned char> description;
+        append(description, IMGUI_VERSION_NUM);
+        append(description, sizeof(ImFontGlyph));
+        append(description, sizeof(ImWchar));
+        append(description, atlas.Flags);
+        append(description, atlas.TexDesiredWidth);
+        append(description, atlas.TexGlyphPadding);
+        append(description, atlas.FontBuilderFlags);
+        for (const ImFontConfig& config : atlas.ConfigData)
+        {
+            append(description, decoded_cache::Key({ static_cast<const unsigned char*>(config.FontData), static_cast<std::size_t>(config.FontDataSize) }, ""));
+            append(description, config.FontNo);
+            append(description, config.SizePixels);
+            append(description, config.OversampleH);
+            append(description, config.OversampleV);
+            append(description, config.PixelSnapH);
+            append(description, config.GlyphExtraSpacing);
+            append(description, config.GlyphOffset);
+            append(description, config.GlyphMinAdvanceX);
+            append(description, config.GlyphMaxAdvanceX);
+            append(description, config.MergeMode);
+            append(description, config.FontBuilderFlags);
+            append(description, config.RasterizerMultiply);
+            append(description, config.RasterizerDensity);
+            append(description, config.EllipsisChar);
+            for (const ImWchar* range = config.GlyphRanges != nullptr ? config.GlyphRanges : atlas.GetGlyphRangesDefault(); *range != 0; ++range)
+                append(description, *range);
+            append(description, ImWchar{ 0 });
+        }
+        return decoded_cache::Key(description, "imgui-font-atlas");
+    }
+
+    bool load(ImFontAtlas& atlas, std::uint64_t key)
+    {
+        decoded_cache::Entry cached;
+        if (!cached.Open(key))
+            return false;
+        const int width      = cached.Param(0);
+        const int height     = cached.Param(1);
+        const int font_count = cached.Param(2);
+        const int rect_count = cached.Param(3);
+        if (width <= 0 || height <= 0 || font_count != atlas.Fonts.Size || rect_count < 0 || cached.SectionCount() != FIXED_SECTIONS + static_cast<std::size_t>(font_count) ||
+            cached.Section(0).size() != static_cast<std::size_t>(width) * static_cast<std::size_t>(height) || cached.Section(1).size() != sizeof(AtlasHeader) ||
+            cached.Section(2).size() != sizeof(FontHeader) * static_cast<std::size_t>(font_count) || cached.Section(3).size() != sizeof(ImFontAtlasCustomRect) * static_cast<std::size_t>(rect_count))
+            return false;
+        for (int i = 0; i < font_count; ++i)
+        {
+            if (cached.Section(FIXED_SECTIONS + static_cast<std::size_t>(i)).size() % sizeof(ImFontGlyph) != 0)
+                return false;
+        }
+
+        AtlasHeader header;
+        std::memcpy(&header, cached.Section(1).data(), sizeof(header));
+        atlas.ClearTexData();
+        atlas.TexWidth        = width;
+        atlas.TexHeight       = height;
+        atlas.TexUvScale      = header.uv_scale;
+        atlas.TexUvWhitePixel = header.uv_white_pixel;
+        std::copy(std::begin(header.uv_lines), std::end(header.uv_lines), std::begin(atlas.TexUvLines));
+        atlas.PackIdMouseCursors = header.pack_id_mouse_cursors;
+        atlas.PackIdLines        = header.pack_id_lines;
+        atlas.CustomRects.resize(rect_count);
+        if (rect_count > 0)
+            std::memcpy(atlas.CustomRects.Data, cached.Section(3).data(), cached.Section(3).size());
+        atlas.TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(cached.Section(0).size()));
+        std::memcpy(atlas.TexPixelsAlpha8, cached.Section(0).data(), cached.Section(0).size());
+
+        for (int i = 0; i < font_count; ++i)
+        {
+            ImFont*    font = atlas.Fonts[i];
+            FontHeader metrics;
+            std::memcpy(&metrics, cached.Section(2).data() + sizeof(FontHeader) * static_cast<std::size_t>(i), sizeof(metrics));
+            font->ClearOutputData();
+            font->FontSize            = metrics.font_size;
+            font->Ascent              = metrics.ascent;
+            font->Descent             = metrics.descent;
+            font->MetricsTotalSurface = metrics.metrics_total_surface;
+            font->ContainerAtlas      = &atlas;
+            font->ConfigData          = nullptr;
+            font->ConfigDataCount     = 0;
+            for (const ImFontConfig& config : atlas.ConfigData)
+            {
+                if (config.DstFont != font)
+                    continue;
+                if (font->ConfigData == nullptr)
+                    font->ConfigData = &config;
+                ++font->ConfigDataCount;
+            }
+            const std::span<const unsigned char> glyphs = cached.Section(FIXED_SECTIONS + static_cast<std::size_t>(i));
+            font->Glyphs.resize(static_cast<int>(glyphs.size() / sizeof(ImFontGlyph)));
+            if (!glyphs.empty())
+                std::memcpy(font->Glyphs.Data, glyphs.data(), glyphs.size());
+            font->BuildLookupTable();
+        }
+        atlas.TexReady = true;
+        return true;
+    }
+
+    void store(const ImFontAtlas& atlas, std::uint64_t key, double cold_ms)
+    {
+        // a glyph added through AddCustomRectFontGlyph points at its font, which the next run can't name
+        for (const ImFontAtlasCustomRect& rect : atlas.CustomRects)
+        {
+            if (rect.Font != nullptr)
+                return;
+        }
+        AtlasHeader header{};
+        header.uv_scale       = atlas.TexUvScale;
+        header.uv_white_pixel = atlas.TexUvWhitePixel;
+        std::copy(std::begin(atlas.TexUvLines), std::end(atlas.TexUvLines), std::begin(header.uv_lines));
+        header.pack_id_mouse_cursors = atlas.PackIdMouseCursors;
+        header.pack_id_lines         = atlas.PackIdLines;
+        std::vector<FontHeader> metrics;
+        for (const ImFont* font : atlas.Fonts)
+            metrics.push_back(FontHeader{ font->FontSize, font->Ascent, font->Descent, font->MetricsTotalSurface });
+
+        std::vector<std::span<const unsigned char>> sections;
+        sections.push_back({ atlas.TexPixelsAlpha8, static_cast<std::size_t>(atlas.TexWidth) * static_cast<std::size_t>(atlas.TexHeight) });
+        sections.push_back(bytes_of(std::span<const AtlasHeader>{ &header, 1 }));
+        sections.push_back(bytes_of(std::span<const FontHeader>{ metrics }));
+        sections.push_back(bytes_of(std::span<const ImFontAtlasCustomRect>{ atlas.CustomRects.Data, static_cast<std::size_t>(atlas.CustomRects.Size) }));
+        for (const ImFont* font : atlas.Fonts)
+            sections.push_back(bytes_of(std::span<const ImFontGlyph>{ font->Glyphs.Data, static_cast<std::size_t>(font->Glyphs.Size) }));
+        decoded_cache::Store(key, { atlas.TexWidth, atlas.TexHeight, atlas.Fonts.Size, atlas.CustomRects.Size }, sections, cold_ms);
+    }
+
+    void create_texture(const ImFontAtlas& atlas)
+    {
+        const gl_backend::Functions& gl = gl_backend::Get();
+        fonts.texture                   = gl.create_texture_2d();
+        gl_state::ActiveTexture(0);
+        gl_state::BindTexture(fonts.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlas.TexWidth, atlas.TexHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        gl.texture_parameter_i(fonts.texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        gl.texture_parameter_i(fonts.texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gl.texture_parameter_i(fonts.texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        gl.texture_parameter_i(fonts.texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        gl.texture_parameter_i(fonts.texture, GL_TEXTURE_MAX_LEVEL, 0);
+        memory_tracker::Allocate(MemoryCategory::Textures, static_cast<std::size_t>(atlas.TexWidth) * static_cast<std::size_t>(atlas.TexHeight) * 4);
+    }
+}
+
+namespace imgui_fonts
+{
+    void Setup(float density)
+    {
+        const startup_trace::Scope trace{ "ImGui fonts" };
+        ImGuiIO&                   io = ImGui::GetIO();
+        // the font rasterized at the display's pixel size and drawn back at its point size, so text stays sharp
+        ImFontConfig font;
+        if (density > 1.0f)
+        {
+            font.SizePixels    = std::round(13.0f * density);
+            io.FontGlobalScale = 1.0f / density;
+        }
+        io.Fonts->AddFontDefault(&font);
+
+        const Uint64        begin = SDL_GetPerformanceCounter();
+        const std::uint64_t key   = decoded_cache::IsEnabled() ? key_for(*io.Fonts) : 0;
+        fonts.stats.was_cached    = key != 0 && load(*io.Fonts, key);
+        if (!fonts.stats.was_cached)
+            io.Fonts->Build();
+        fonts.stats.build_ms = static_cast<double>(SDL_GetPerformanceCounter() - begin) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+        if (key != 0 && !fonts.stats.was_cached && io.Fonts->TexPixelsAlpha8 != nullptr)
+            store(*io.Fonts, key, fonts.stats.build_ms);
+        fonts.stats.width  = io.Fonts->TexWidth;
+        fonts.stats.height = io.Fonts->TexHeight;
+        fonts.stats.fonts  = io.Fonts->Fonts.Size;
+        LOG_INFO("ImGui font atlas ", fonts.stats.width, "x", fonts.stats.height, fonts.stats.was_cached ? " loaded from the decoded cache in " : " baked in ", fonts.stats.build_ms, " ms");
+    }
+
+    void NewFrame()
+    {
+        if (fonts.is_backend_set)
+        {
+            ImGui_ImplOpenGL3_NewFrame();
+            return;
+        }
+        // the backend makes its font texture from GetTexDataAsRGBA32, which hands back this when it is set
+        ImFontAtlas&        atlas  = *ImGui::GetIO().Fonts;
+        unsigned int        white  = 0xFFFFFFFFu;
+        const int           width  = atlas.TexWidth;
+        const int           height = atlas.TexHeight;
+        unsigned int* const rgba   = atlas.TexPixelsRGBA32;
+        atlas.TexPixelsRGBA32      = &white;
+        atlas.TexWidth             = 1;
+        atlas.TexHeight            = 1;
+        ImGui_ImplOpenGL3_NewFrame();
+        atlas.TexPixelsRGBA32 = rgba;
+        atlas.TexWidth        = width;
+        atlas.TexHeight       = height;
+        fonts.is_backend_set  = true;
+        if (fonts.stats.uploaded_rows == fonts.stats.height && fonts.texture != 0)
+            atlas.SetTexID(imgui_texture_id(fonts.texture));
+    }
+
+    void Update(UploadBudget& budget)
+    {
+        ImFontAtlas& atlas = *ImGui::GetIO().Fonts;
+        if (atlas.TexPixelsAlpha8 == nullptr || fonts.stats.uploaded_rows >= atlas.TexHeight)
+            return;
+        const std::size_t row_bytes = static_cast<std::size_t>(atlas.TexWidth) * 4;
+        const int         left      = atlas.TexHeight - fonts.stats.uploaded_rows;
+        if (!budget.HasRoom() && fonts.stats.uploaded_rows > 0)
+        {
+            budget.Defer(row_bytes * static_cast<std::size_t>(left));
+            return;
+        }
+        // at least one row a frame, so an atlas wider than the budget still goes up
+        const int rows = std::clamp(static_cast<int>(budget.RemainingBytes() / row_bytes), 1, left);
+        budget.Spend(row_bytes * static_cast<std::size_t>(rows));
+        if (rows < left)
+            budget.Defer(row_bytes * static_cast<std::size_t>(left - rows));
+
+        const UploadBudget::Timer timer{ budget };
+        if (fonts.texture == 0)
+            create_texture(atlas);
+        // white with the coverage in alpha, what the backend would have made
+        const unsigned char* alpha = atlas.TexPixelsAlpha8 + static_cast<std::size_t>(fonts.stats.uploaded_rows) * static_cast<std::size_t>(atlas.TexWidth);
+        fonts.band.resize(row_bytes * static_cast<std::size_t>(rows));
+        for (std::size_t i = 0; i < fonts.band.size() / 4; ++i)
+        {
+            fonts.band[i * 4 + 0] = 255;
+            fonts.band[i * 4 + 1] = 255;
+            fonts.band[i * 4 + 2] = 255;
+            fonts.band[i * 4 + 3] = alpha[i];
+        }
+        gl_backend::Get().texture_sub_image_2d(fonts.texture, 0, 0, fonts.stats.uploaded_rows, atlas.TexWidth, rows, GL_RGBA, GL_UNSIGNED_BYTE, fonts.band.data());
+        fonts.stats.uploaded_rows += rows;
+        if (fonts.stats.uploaded_rows == atlas.TexHeight)
+        {
+            fonts.band = {};
+            if (fonts.is_backend_set)
+                atlas.SetTexID(imgui_texture_id(fonts.texture));
+        }
+    }
+
+    void Shutdown()
+    {
+        if (fonts.texture != 0)
+        {
+            gl_state::DeleteTexture(fonts.texture);
+            memory_tracker::Free(MemoryCategory::Textures, static_cast<std::size_t>(fonts.stats.width) * static_cast<std::size_t>(fonts.stats.height) * 4);
+        }
+        fonts = Fonts{};
+    }
+
+    Stats GetStats() noexcept
+    {
+        return fonts.stats;
+    }
+}
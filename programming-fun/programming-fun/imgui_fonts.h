@@ -0,0 +1,47 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+class UploadBudget;
+
+/**
+ * ImGui's font atlas, baked once and kept in the decoded cache, and uploaded through the upload budget.
+ *
+ * Setup adds the fonts and fills the atlas the way ImFontAtlas::Build would: from the decoded cache when an
+ * earlier run baked the same fonts, keyed by every font's bytes and config and by ImGui's version, or by
+ * baking it and storing the result. A warm start copies the texels, glyph tables and the UVs of the white
+ * pixel, lines and cursors back and marks the atlas ready, so stb_truetype never runs; adding a CJK or icon
+ * font costs its bake once. The texture is ours: the backend's first NewFrame, which makes its font texture
+ * from whatever GetTexDataAsRGBA32 returns, is handed a single white texel, and Update uploads the atlas in
+ * bands of rows as the budget allows, pointing the atlas at it once the last band is in. Until then solid
+ * shapes draw from the white texel and text draws as blocks, for a frame or two with a large atlas.
+ * Main thread, which must have GL from the first NewFrame on.
+ */
+namespace imgui_fonts
+{
+    struct Stats
+    {
+        int    width         = 0;
+        int    height        = 0;
+        int    fonts         = 0;
+        int    uploaded_rows = 0;
+        bool   was_cached    = false;
+        double build_ms      = 0.0; // baking, or loading it from the cache
+    };
+
+    // After ImGui::CreateContext; `density` is drawable pixels per window point
+    void Setup(float density);
+    // In place of ImGui_ImplOpenGL3_NewFrame
+    void NewFrame();
+    // Uploads the next rows of the atlas that fit in `budget`
+    void Update(UploadBudget& budget);
+    // Before ImGui_ImplOpenGL3_Shutdown
+    void Shutdown();
+
+    Stats GetStats() noexcept;
+}
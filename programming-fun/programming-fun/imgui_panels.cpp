@@ -0,0 +1,183 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "imgui_panels.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    struct Command
+    {
+        ImVec4      clip_rect;
+        ImTextureID texture      = ImTextureID{};
+        int         first_index  = 0; // into Panel::indices
+        int         index_count  = 0;
+        int         first_vertex = 0; // into Panel::vertices
+        int         vertex_count = 0;
+    };
+
+    struct Panel
+    {
+        bool                    has_copy    = false;
+        bool                    is_building = false; // between this frame's Begin and End, when the copy is wanted
+        double                  next_build  = 0.0;   // ImGui::GetTime
+        ImVec2                  start;               // the contents' first cursor position, in screen space
+        ImVec2                  extent;              // from `start` to the far corner of what they drew
+        ImVec2                  size;                // the window's, when built
+        ImVec2                  scroll;
+        int                     first_command = 0; // in the window's draw list, while building
+        int                     first_index   = 0;
+        std::vector<Command>    commands;
+        std::vector<unsigned>   indices; // from their command's first vertex
+        std::vector<ImDrawVert> vertices;
+    };
+
+    std::unordered_map<ImGuiID, Panel> gPanels;
+    std::vector<Panel*>                gOpen; // Begin pushes, End pops, so a panel can open another window
+    bool                               gEnabled = true;
+    imgui_panels::Stats                gStats;
+
+    void copy(Panel& panel, const ImDrawList& list)
+    {
+        panel.commands.clear();
+        panel.indices.clear();
+        panel.vertices.clear();
+        panel.has_copy = false;
+        ImVec2    far  = panel.start;
+        const int last = list.IdxBuffer.Size;
+        for (int c = std::max(panel.first_command, 0); c < list.CmdBuffer.Size; ++c)
+        {
+            const ImDrawCmd& command = list.CmdBuffer[c];
+            // the command Begin left open may have started before the contents did
+            const int first = std::max(static_cast<int>(command.IdxOffset), panel.first_index);
+            const int end   = std::min(static_cast<int>(command.IdxOffset + command.ElemCount), last);
+            if (first >= end)
+                continue;
+            // a callback can't be replayed from a copy
+            if (command.UserCallback != nullptr)
+                return;
+            unsigned lowest  = std::numeric_limits<unsigned>::max();
+            unsigned highest = 0;
+            for (int i = first; i < end; ++i)
+            {
+                const unsigned vertex = command.VtxOffset + list.IdxBuffer[i];
+                lowest                = std::min(lowest, vertex);
+                highest               = std::max(highest, vertex);
+            }
+            panel.commands.push_back(Command{ command.ClipRect, command.GetTexID(), static_cast<int>(panel.indices.size()), end - first, static_cast<int>(panel.vertices.size()),
+                                              static_cast<int>(highest - lowest + 1) });
+            for (int i = first; i < end; ++i)
+                panel.indices.push_back(command.VtxOffset + list.IdxBuffer[i] - lowest);
+            for (unsigned v = lowest; v <= highest; ++v)
+            {
+                const ImDrawVert& vertex = list.VtxBuffer[static_cast<int>(v)];
+                panel.vertices.push_back(vertex);
+                far = ImVec2{ std::max(far.x, vertex.pos.x), std::max(far.y, vertex.pos.y) };
+            }
+        }
+        // the cursor stands one item spacing below the last item; ImGui sizes windows to the item
+        const ImVec2 cursor = ImGui::GetCursorScreenPos();
+        far.y               = std::max(far.y, cursor.y - ImGui::GetStyle().ItemSpacing.y);
+        panel.extent        = ImVec2{ far.x - panel.start.x, far.y - panel.start.y };
+        panel.has_copy      = true;
+    }
+
+    void replay(const Panel& panel, ImDrawList& list, ImVec2 start)
+    {
+        const ImVec2 delta{ start.x - panel.start.x, start.y - panel.start.y };
+        for (const Command& command : panel.commands)
+        {
+            list.PushClipRect(ImVec2{ command.clip_rect.x + delta.x, command.clip_rect.y + delta.y }, ImVec2{ command.clip_rect.z + delta.x, command.clip_rect.w + delta.y });
+            list.PushTextureID(command.texture);
+            list.PrimReserve(command.index_count, command.vertex_count);
+            const unsigned base = list._VtxCurrentIdx;
+            for (int i = 0; i < command.index_count; ++i)
+                list.PrimWriteIdx(static_cast<ImDrawIdx>(base + panel.indices[static_cast<std::size_t>(command.first_index + i)]));
+            for (int v = 0; v < command.vertex_count; ++v)
+            {
+                const ImDrawVert& vertex = panel.vertices[static_cast<std::size_t>(command.first_vertex + v)];
+                list.PrimWriteVtx(ImVec2{ vertex.pos.x + delta.x, vertex.pos.y + delta.y }, vertex.uv, vertex.col);
+            }
+            list.PopTextureID();
+            list.PopClipRect();
+        }
+        ImGui::Dummy(ImVec2{ std::max(panel.extent.x, 0.0f), std::max(panel.extent.y, 0.0f) });
+    }
+}
+
+namespace imgui_panels
+{
+    bool Begin(const char* name, float hz, bool* open, ImGuiWindowFlags flags)
+    {
+        Panel& panel      = gPanels[ImGui::GetID(name)];
+        panel.is_building = false;
+        gOpen.push_back(&panel);
+        if (!ImGui::Begin(name, open, flags))
+        {
+            panel.has_copy = false;
+            return false;
+        }
+        ImDrawList&  list    = *ImGui::GetWindowDrawList();
+        const ImVec2 start   = ImGui::GetCursorScreenPos();
+        const ImVec2 size    = ImGui::GetWindowSize();
+        const ImVec2 scroll  = ImVec2{ ImGui::GetScrollX(), ImGui::GetScrollY() };
+        const double now     = ImGui::GetTime();
+        const bool   is_used = ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows) || (ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows) && ImGui::GetIO().NavActive) ||
+                             ImGui::IsAnyItemActive();
+        const bool is_throttled = gEnabled && hz > 0.0f;
+        // an auto-resizing window takes its size from the Dummy, which only comes close to what the contents measured
+        const bool is_same_size = (flags & ImGuiWindowFlags_AlwaysAutoResize) != 0 || (size.x == panel.size.x && size.y == panel.size.y);
+        const bool is_fresh     = is_throttled && panel.has_copy && now < panel.next_build && !is_used && is_same_size && scroll.x == panel.scroll.x && scroll.y == panel.scroll.y;
+        if (is_fresh)
+        {
+            replay(panel, list, start);
+            ++gStats.replayed;
+            return false;
+        }
+        // nothing to copy for a panel that builds every frame anyway
+        panel.is_building   = is_throttled;
+        panel.has_copy      = false;
+        panel.next_build    = is_throttled ? now + 1.0 / static_cast<double>(hz) : now;
+        panel.start         = start;
+        panel.size          = size;
+        panel.scroll        = scroll;
+        panel.first_command = list.CmdBuffer.Size - 1;
+        panel.first_index   = list.IdxBuffer.Size;
+        ++gStats.built;
+        return true;
+    }
+
+    void End()
+    {
+        Panel& panel = *gOpen.back();
+        gOpen.pop_back();
+        if (panel.is_building)
+            copy(panel, *ImGui::GetWindowDrawList());
+        panel.is_building = false;
+        ImGui::End();
+    }
+
+    void SetEnabled(bool enabled) noexcept
+    {
+        gEnabled = enabled;
+    }
+
+    bool IsEnabled() noexcept
+    {
+        return gEnabled;
+    }
+
+    const Stats& GetStats() noexcept
+    {
+        return gStats;
+    }
+}
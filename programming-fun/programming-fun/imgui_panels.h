@@ -0,0 +1,42 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <imgui.h>
+
+/**
+ * ImGui windows whose contents are rebuilt a few times a second and replayed in between.
+ *
+ * A statistics panel is mostly numbers nobody reads at 144 Hz. Begin runs ImGui::Begin and says whether the
+ * caller builds the contents this frame. When it does, End copies what the contents drew into the window's draw
+ * list: each command's clip rect and texture with the vertices and indices it uses. On the frames in between Begin
+ * appends that copy again, moved along with the window, and a Dummy of the same size keeps auto-resizing windows
+ * the size they were, so building costs nothing but the copy. Widgets aren't submitted on those frames, so a panel
+ * builds every frame while it is hovered, while keyboard navigation is in it and while any widget is active; a new
+ * size or scroll position, or a collapse, rebuilds it too. Child windows, which includes tables that scroll, draw
+ * into lists of their own that aren't replayed, so panels with them stay at every frame. Main thread only.
+ */
+namespace imgui_panels
+{
+    struct Stats
+    {
+        std::uint64_t built    = 0;
+        std::uint64_t replayed = 0;
+    };
+
+    // `hz` is how often the contents change in a way worth showing; 0 builds every frame. True when the caller
+    // builds the contents; false when they were replayed or the window is collapsed. Call End either way
+    bool Begin(const char* name, float hz, bool* open = nullptr, ImGuiWindowFlags flags = 0);
+    void End();
+
+    // Off builds every panel every frame, for comparing
+    void         SetEnabled(bool enabled) noexcept;
+    bool         IsEnabled() noexcept;
+    const Stats& GetStats() noexcept;
+}
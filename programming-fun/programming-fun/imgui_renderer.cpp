@@ -0,0 +1,417 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "imgui_renderer.h"
+
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "logger.h"
+#include "shader.h"
+#include "vertex_layout.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <tuple>
+
+namespace
+{
+    constexpr const char* IMGUI_VERTEX_SHADER = R"(
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aTexCoord;
+layout(location = 2) in vec4 aColor;
+
+uniform mat4 uProjection;
+uniform vec4 uUVRect;
+
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void main()
+{
+    vTexCoord   = mix(uUVRect.xy, uUVRect.zw, aTexCoord);
+    vColor      = aColor;
+    gl_Position = uProjection * vec4(aPosition, 0.0, 1.0);
+}
+)";
+
+    constexpr const char* IMGUI_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+in vec4 vColor;
+
+uniform sampler2D uTexture;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = vColor * texture(uTexture, vTexCoord);
+}
+)";
+
+    constexpr GLenum INDEX_TYPE = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    constexpr auto IMGUI_LAYOUT = vertex_layout::Make<ImDrawVert>(VertexAttribute{ 0, attribute_format::Float2, offsetof(ImDrawVert, pos) },
+                                                                  VertexAttribute{ 1, attribute_format::Float2, offsetof(ImDrawVert, uv) },
+                                                                  VertexAttribute{ 2, attribute_format::UByte4Norm, offsetof(ImDrawVert, col) });
+
+    // a word at a time, multiply and fold; only has to notice change, not resist anyone
+    constexpr std::uint64_t HASH_MULTIPLIER = 0x9E3779B97F4A7C15ull;
+
+    std::uint64_t mix(std::uint64_t hash, std::uint64_t word) noexcept
+    {
+        hash = (hash ^ word) * HASH_MULTIPLIER;
+        return hash ^ (hash >> 29);
+    }
+
+    std::uint64_t hash_bytes(std::uint64_t hash, const void* data, std::size_t size) noexcept
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        std::size_t i     = 0;
+        for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+        {
+            std::uint64_t word = 0;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            hash = mix(hash, word);
+        }
+        std::uint64_t tail = 0;
+        if (i < size)
+            std::memcpy(&tail, bytes + i, size - i);
+        return mix(mix(hash, tail), size);
+    }
+
+    template <typename T>
+    std::uint64_t hash_vector(std::uint64_t hash, const ImVector<T>& vector) noexcept
+    {
+        return hash_bytes(hash, vector.Data, static_cast<std::size_t>(vector.Size) * sizeof(T));
+    }
+
+    std::size_t draw_data_bytes(const ImDrawData& draw_data) noexcept
+    {
+        return static_cast<std::size_t>(draw_data.TotalVtxCount) * sizeof(ImDrawVert) + static_cast<std::size_t>(draw_data.TotalIdxCount) * sizeof(ImDrawIdx);
+    }
+
+    constexpr glm::vec4 WHOLE_TEXTURE{ 0.0f, 0.0f, 1.0f, 1.0f };
+
+    struct SubTexture
+    {
+        GLuint    texture = 0;
+        glm::vec4 uv_rect = WHOLE_TEXTURE;
+    };
+
+    // Slots never change once handed out, so the render thread reads them without a lock; an ImTextureID
+    // pointing into the array is a sub-texture, anything else a GL name
+    struct SubTextures
+    {
+        using Key = std::tuple<GLuint, float, float, float, float>;
+
+        std::array<SubTexture, MAX_IMGUI_SUB_TEXTURES> slots{};
+        std::map<Key, int>                             lookup;
+        bool                                           warned_full = false;
+    };
+
+    SubTextures gSubTextures;
+
+    const SubTexture* find_sub_texture(ImTextureID id) noexcept
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(id);
+        const auto first   = reinterpret_cast<std::uintptr_t>(gSubTextures.slots.data());
+        if (address < first || address >= first + sizeof(gSubTextures.slots))
+            return nullptr;
+        return static_cast<const SubTexture*>(id);
+    }
+}
+
+std::uint64_t hash_imgui_draw_data(const ImDrawData& draw_data) noexcept
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    hash               = hash_bytes(hash, &draw_data.DisplayPos, sizeof(ImVec2));
+    hash               = hash_bytes(hash, &draw_data.DisplaySize, sizeof(ImVec2));
+    hash               = hash_bytes(hash, &draw_data.FramebufferScale, sizeof(ImVec2));
+    for (const ImDrawList* list : draw_data.CmdLists)
+    {
+        // ImDrawCmd zeroes its padding, so whole commands hash deterministically
+        hash = hash_vector(hash, list->CmdBuffer);
+        hash = hash_vector(hash, list->IdxBuffer);
+        hash = hash_vector(hash, list->VtxBuffer);
+    }
+    return hash != 0 ? hash : 1;
+}
+
+std::uint64_t hash_imgui_draw_list(const ImDrawList& list) noexcept
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    hash               = hash_vector(hash, list.CmdBuffer);
+    hash               = hash_vector(hash, list.IdxBuffer);
+    hash               = hash_vector(hash, list.VtxBuffer);
+    return hash != 0 ? hash : 1;
+}
+
+ImTextureID imgui_texture_id(GLuint texture) noexcept
+{
+    return reinterpret_cast<ImTextureID>(static_cast<std::intptr_t>(texture));
+}
+
+ImTextureID imgui_texture_id(GLuint texture, const glm::vec4& uv_rect)
+{
+    if (uv_rect == WHOLE_TEXTURE)
+        return imgui_texture_id(texture);
+    const SubTextures::Key key{ texture, uv_rect.x, uv_rect.y, uv_rect.z, uv_rect.w };
+    if (const auto found = gSubTextures.lookup.find(key); found != gSubTextures.lookup.end())
+        return &gSubTextures.slots[static_cast<std::size_t>(found->second)];
+    const auto slot = static_cast<int>(gSubTextures.lookup.size());
+    if (slot == MAX_IMGUI_SUB_TEXTURES)
+    {
+        if (!gSubTextures.warned_full)
+            LOG_WARN("All ", MAX_IMGUI_SUB_TEXTURES, " ImGui sub-textures are taken; new ones show their whole texture");
+        gSubTextures.warned_full = true;
+        return imgui_texture_id(texture);
+    }
+    gSubTextures.slots[static_cast<std::size_t>(slot)] = SubTexture{ texture, uv_rect };
+    gSubTextures.lookup.emplace(key, slot);
+    return &gSubTextures.slots[static_cast<std::size_t>(slot)];
+}
+
+void ImGuiRenderer::Setup()
+{
+    program.Request(IMGUI_VERTEX_SHADER, IMGUI_FRAGMENT_SHADER);
+#if defined(IS_WEBGL2)
+    use_base_vertex = false;
+#else
+    use_base_vertex = GLEW_VERSION_3_2 || GLEW_ARB_draw_elements_base_vertex;
+#endif
+
+    glGenVertexArrays(1, &vertex_array);
+    // the element binding is part of the vertex array, so bind that first
+    gl_state::BindVertexArray(vertex_array);
+    vertices.Setup(GL_ARRAY_BUFFER, INITIAL_VERTEX_BYTES);
+    indices.Setup(GL_ELEMENT_ARRAY_BUFFER, INITIAL_INDEX_BYTES);
+    vertex_layout::Enable(IMGUI_LAYOUT);
+}
+
+void ImGuiRenderer::Shutdown()
+{
+    vertices.Shutdown();
+    indices.Shutdown();
+    gl_state::DeleteVertexArray(vertex_array);
+    program.Reset();
+    vertex_array  = 0;
+    vertex_offset = index_offset = 0;
+    uploaded_hash                = 0;
+}
+
+void ImGuiRenderer::Render(const ImDrawData& draw_data, std::uint64_t hash, std::span<const glm::ivec4> limits)
+{
+    stats                        = Stats{};
+    const int framebuffer_width  = static_cast<int>(draw_data.DisplaySize.x * draw_data.FramebufferScale.x);
+    const int framebuffer_height = static_cast<int>(draw_data.DisplaySize.y * draw_data.FramebufferScale.y);
+    if (framebuffer_width <= 0 || framebuffer_height <= 0 || draw_data.TotalIdxCount == 0)
+        return;
+    if (!isProgramReady())
+    {
+        stats.pending = true;
+        return;
+    }
+
+    gl_state::BindVertexArray(vertex_array);
+    const std::size_t bytes = draw_data_bytes(draw_data);
+    if (hash == 0 || hash != uploaded_hash)
+    {
+        uploaded_hash = 0;
+        if (!upload(draw_data))
+        {
+            vertices.EndFrame();
+            indices.EndFrame();
+            return;
+        }
+        uploaded_hash        = hash;
+        stats.uploaded_bytes = bytes;
+        gl_stats::CountUpload(bytes);
+    }
+    else
+    {
+        stats.reused_bytes = bytes;
+        gl_stats::CountSavedUpload(bytes);
+    }
+    stats.base_vertex = use_base_vertex;
+    stats.persistent  = vertices.IsPersistent() && indices.IsPersistent();
+    setupRenderState(draw_data, framebuffer_width, framebuffer_height);
+
+    // lists sit back to back in both streams, in draw order, exactly as upload wrote them
+    const ImVec2               clip_offset   = draw_data.DisplayPos;
+    const ImVec2               clip_scale    = draw_data.FramebufferScale;
+    std::size_t                list_vertex   = 0;
+    std::size_t                list_index    = 0;
+    std::size_t                bound_vertex  = SIZE_MAX; // without base vertex draws
+    std::optional<ImTextureID> bound_texture;
+    glm::vec4                  bound_uv_rect = WHOLE_TEXTURE;
+    if (use_base_vertex)
+        bindVertexAttributes(vertex_offset);
+    for (const ImDrawList* list : draw_data.CmdLists)
+    {
+        for (const ImDrawCmd& command : list->CmdBuffer)
+        {
+            if (command.UserCallback != nullptr)
+            {
+                if (command.UserCallback == ImDrawCallback_ResetRenderState)
+                {
+                    setupRenderState(draw_data, framebuffer_width, framebuffer_height);
+                    if (use_base_vertex)
+                        bindVertexAttributes(vertex_offset);
+                    bound_vertex = SIZE_MAX;
+                    bound_texture.reset();
+                    bound_uv_rect = WHOLE_TEXTURE;
+                }
+                else
+                {
+                    command.UserCallback(list, &command);
+                }
+                continue;
+            }
+            const ImVec2 clip_min{ (command.ClipRect.x - clip_offset.x) * clip_scale.x, (command.ClipRect.y - clip_offset.y) * clip_scale.y };
+            const ImVec2 clip_max{ (command.ClipRect.z - clip_offset.x) * clip_scale.x, (command.ClipRect.w - clip_offset.y) * clip_scale.y };
+            if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y)
+                continue;
+            // once per damaged rect the command reaches, or once over its whole clip rect
+            for (std::size_t pass = 0; pass < std::max<std::size_t>(limits.size(), 1); ++pass)
+            {
+                ImVec2 scissor_min = clip_min;
+                ImVec2 scissor_max = clip_max;
+                if (!limits.empty())
+                {
+                    const glm::ivec4& limit = limits[pass];
+                    scissor_min             = ImVec2{ std::max(scissor_min.x, static_cast<float>(limit.x)), std::max(scissor_min.y, static_cast<float>(limit.y)) };
+                    scissor_max             = ImVec2{ std::min(scissor_max.x, static_cast<float>(limit.z)), std::min(scissor_max.y, static_cast<float>(limit.w)) };
+                    if (scissor_max.x <= scissor_min.x || scissor_max.y <= scissor_min.y)
+                        continue;
+                }
+                // GL's scissor origin is the bottom left
+                glScissor(static_cast<GLint>(scissor_min.x), static_cast<GLint>(static_cast<float>(framebuffer_height) - scissor_max.y), static_cast<GLsizei>(scissor_max.x - scissor_min.x),
+                          static_cast<GLsizei>(scissor_max.y - scissor_min.y));
+                if (const ImTextureID id = command.GetTexID(); id != bound_texture)
+                {
+                    const SubTexture* sub_texture = find_sub_texture(id);
+                    const glm::vec4&  uv_rect     = sub_texture != nullptr ? sub_texture->uv_rect : WHOLE_TEXTURE;
+                    gl_state::BindTexture(sub_texture != nullptr ? sub_texture->texture : static_cast<GLuint>(reinterpret_cast<std::intptr_t>(id)));
+                    if (uv_rect != bound_uv_rect)
+                    {
+                        glUniform4f(uv_rect_location, uv_rect.x, uv_rect.y, uv_rect.z, uv_rect.w);
+                        bound_uv_rect = uv_rect;
+                    }
+                    bound_texture = id;
+                    ++stats.texture_binds;
+                }
+                const std::size_t first_vertex = list_vertex + command.VtxOffset;
+                const auto*       first_index  = reinterpret_cast<const void*>(index_offset + (list_index + command.IdxOffset) * sizeof(ImDrawIdx));
+#if !defined(IS_WEBGL2)
+                if (use_base_vertex)
+                {
+                    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(command.ElemCount), INDEX_TYPE, first_index, static_cast<GLint>(first_vertex));
+                }
+                else
+#endif
+                {
+                    if (first_vertex != bound_vertex)
+                    {
+                        bindVertexAttributes(vertex_offset + first_vertex * sizeof(ImDrawVert));
+                        bound_vertex = first_vertex;
+                    }
+                    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(command.ElemCount), INDEX_TYPE, first_index);
+                }
+                gl_stats::CountDraw(command.ElemCount / 3);
+                ++stats.draw_calls;
+            }
+        }
+        list_vertex += static_cast<std::size_t>(list->VtxBuffer.Size);
+        list_index += static_cast<std::size_t>(list->IdxBuffer.Size);
+    }
+    gl_state::SetEnabled(GL_SCISSOR_TEST, false);
+    // fences this frame's regions behind the draws; nothing to do on a frame that reused them
+    vertices.EndFrame();
+    indices.EndFrame();
+}
+
+const ImGuiRenderer::Stats& ImGuiRenderer::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+bool ImGuiRenderer::upload(const ImDrawData& draw_data)
+{
+    // one copy per list straight into the mapped stream, no glBufferData and nothing in between
+    const auto upload_lists = [&draw_data](StreamBuffer& stream, std::size_t bytes, std::size_t& out_offset, auto&& list_buffer)
+    {
+        unsigned char* mapped = stream.Map(bytes, out_offset);
+        if (mapped == nullptr)
+            return false;
+        for (const ImDrawList* list : draw_data.CmdLists)
+        {
+            const auto& list_data  = list_buffer(*list);
+            const auto  list_bytes = static_cast<std::size_t>(list_data.Size) * sizeof(list_data.Data[0]);
+            if (list_bytes > 0)
+                std::memcpy(mapped, list_data.Data, list_bytes);
+            mapped += list_bytes;
+        }
+        stream.Unmap();
+        return true;
+    };
+    return upload_lists(vertices, static_cast<std::size_t>(draw_data.TotalVtxCount) * sizeof(ImDrawVert), vertex_offset,
+                        [](const ImDrawList& list) -> const auto& { return list.VtxBuffer; }) &&
+           upload_lists(indices, static_cast<std::size_t>(draw_data.TotalIdxCount) * sizeof(ImDrawIdx), index_offset,
+                        [](const ImDrawList& list) -> const auto& { return list.IdxBuffer; });
+}
+
+void ImGuiRenderer::setupRenderState(const ImDrawData& draw_data, int framebuffer_width, int framebuffer_height) const
+{
+    // what the OpenGL3 backend sets: alpha blending that also accumulates coverage in alpha, no depth or culling, scissor per command
+    gl_state::SetEnabled(GL_BLEND, true);
+    gl_state::BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::SetEnabled(GL_CULL_FACE, false);
+    gl_state::SetEnabled(GL_DEPTH_TEST, false);
+    gl_state::SetEnabled(GL_SCISSOR_TEST, true);
+    gl_state::Viewport(0, 0, framebuffer_width, framebuffer_height);
+
+    const float left   = draw_data.DisplayPos.x;
+    const float right  = draw_data.DisplayPos.x + draw_data.DisplaySize.x;
+    const float top    = draw_data.DisplayPos.y;
+    const float bottom = draw_data.DisplayPos.y + draw_data.DisplaySize.y;
+
+    const float projection[4][4] = {
+        { 2.0f / (right - left), 0.0f, 0.0f, 0.0f },
+        { 0.0f, 2.0f / (top - bottom), 0.0f, 0.0f },
+        { 0.0f, 0.0f, -1.0f, 0.0f },
+        { (right + left) / (left - right), (top + bottom) / (bottom - top), 0.0f, 1.0f },
+    };
+    gl_state::UseProgram(program.Id());
+    glUniformMatrix4fv(projection_location, 1, GL_FALSE, &projection[0][0]);
+    glUniform4f(uv_rect_location, WHOLE_TEXTURE.x, WHOLE_TEXTURE.y, WHOLE_TEXTURE.z, WHOLE_TEXTURE.w);
+    gl_state::ActiveTexture(0);
+    gl_state::BindVertexArray(vertex_array);
+}
+
+bool ImGuiRenderer::isProgramReady()
+{
+    if (program.IsReady())
+        return true;
+    if (!program.Poll())
+        return false;
+    projection_location = glGetUniformLocation(program.Id(), "uProjection");
+    uv_rect_location    = glGetUniformLocation(program.Id(), "uUVRect");
+    gl_state::UseProgram(program.Id());
+    glUniform1i(glGetUniformLocation(program.Id(), "uTexture"), 0);
+    return true;
+}
+
+void ImGuiRenderer::bindVertexAttributes(std::size_t base) const
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vertices.Buffer());
+    vertex_layout::Bind(IMGUI_LAYOUT, base);
+}
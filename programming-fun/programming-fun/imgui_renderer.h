@@ -0,0 +1,99 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "shader.h"
+#include "stream_buffer.h"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <imgui.h>
+#include <span>
+
+// Hash of everything that reaches the screen: display rect, vertices, indices and commands. Never 0.
+std::uint64_t hash_imgui_draw_data(const ImDrawData& draw_data) noexcept;
+// The same for one list's vertices, indices and commands, so UiDamage can tell which ones changed. Never 0.
+std::uint64_t hash_imgui_draw_list(const ImDrawList& list) noexcept;
+
+// The ImTextureID of a whole texture, its GL name, as the OpenGL3 backend takes them
+ImTextureID imgui_texture_id(GLuint texture) noexcept;
+// The ImTextureID of `uv_rect` (min.xy, max.xy) inside `texture`, such as an atlas region: ImGui::Image
+// then addresses it with 0..1 UVs and ImGuiRenderer maps them into the rect. Each distinct rect takes one
+// of MAX_IMGUI_SUB_TEXTURES slots for the run, so pass stable regions, not scrolling ones. The backend
+// doesn't know these, so they only draw in the main viewport. Main thread.
+inline constexpr int MAX_IMGUI_SUB_TEXTURES = 4096;
+ImTextureID          imgui_texture_id(GLuint texture, const glm::vec4& uv_rect);
+
+/**
+ * Draws the main viewport's ImGui output from buffers it keeps between frames.
+ *
+ * The prebuilt OpenGL3 backend re-allocates its buffers with glBufferData for every list of every frame
+ * and sets its whole state again per list. Here all lists go back to back into a pair of StreamBuffers,
+ * persistently mapped where the context allows, and only when the caller's hash differs from the one last
+ * uploaded; otherwise last frame's data is drawn again where it lies. Vertex attributes are pointed once
+ * per frame and each command is a glDrawElementsBaseVertex; ES 3.0 lacks that, so WebGL2 re-points them
+ * per list instead. State goes through gl_state, so what the scene already left set costs nothing.
+ * Same shader, blending and clipping as the backend, plus the sub-rects of imgui_texture_id; the backend
+ * still draws the platform windows. GL thread only.
+ */
+class ImGuiRenderer
+{
+public:
+    struct Stats
+    {
+        std::size_t uploaded_bytes = 0;
+        std::size_t reused_bytes   = 0; // what the backend would have uploaded again
+        int         draw_calls     = 0;
+        int         texture_binds  = 0;
+        bool        base_vertex    = false;
+        bool        persistent     = false; // the stream buffers are persistently mapped
+        bool        pending        = false; // the program is still compiling, so nothing was drawn
+    };
+
+    ImGuiRenderer() = default;
+
+    ImGuiRenderer(const ImGuiRenderer&)                = delete;
+    ImGuiRenderer& operator=(const ImGuiRenderer&)     = delete;
+    ImGuiRenderer(ImGuiRenderer&&) noexcept            = delete;
+    ImGuiRenderer& operator=(ImGuiRenderer&&) noexcept = delete;
+
+    void Setup();
+    void Shutdown();
+
+    // `hash` from hash_imgui_draw_data; 0 always uploads. Draws into the bound framebuffer, only inside `limits`
+    // when there are any: rects in framebuffer pixels from the top left, (min x, min y, max x, max y), as UiDamage finds them
+    void Render(const ImDrawData& draw_data, std::uint64_t hash, std::span<const glm::ivec4> limits = {});
+
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    static constexpr std::size_t INITIAL_VERTEX_BYTES = 256 * 1024;
+    static constexpr std::size_t INITIAL_INDEX_BYTES  = 64 * 1024;
+
+    // false when a stream couldn't be mapped, which leaves nothing to draw
+    bool upload(const ImDrawData& draw_data);
+    void setupRenderState(const ImDrawData& draw_data, int framebuffer_width, int framebuffer_height) const;
+    void bindVertexAttributes(std::size_t base) const;
+    // false while the program is compiling; looks up the uniforms the first time it's ready
+    bool isProgramReady();
+
+private:
+    ShaderProgram program;
+    GLint         projection_location = -1;
+    GLint         uv_rect_location    = -1;
+    GLuint        vertex_array        = 0;
+    StreamBuffer  vertices;
+    StreamBuffer  indices;
+    std::size_t   vertex_offset       = 0; // bytes into each stream where the last upload begins
+    std::size_t   index_offset        = 0;
+    std::uint64_t uploaded_hash       = 0;
+    bool          use_base_vertex     = false;
+    Stats         stats;
+};
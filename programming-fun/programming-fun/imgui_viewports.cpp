@@ -0,0 +1,129 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "imgui_viewports.h"
+
+#include "gl_stats.h"
+#include "profiler.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <imgui.h>
+#include <vector>
+
+namespace
+{
+    struct AppliedInterval
+    {
+        unsigned id       = 0;
+        int      interval = -1;
+    };
+
+    ViewportSettings             gSettings;
+    bool                         gAllowed = true;
+    imgui_viewports::FrameCost   gLastFrame;
+    std::vector<AppliedInterval> gApplied;
+
+    // the context Platform_RenderWindow just made current belongs to `viewport`
+    void apply_swap_interval(const ImGuiViewport& viewport)
+    {
+        const int desired = gSettings.secondary_vsync ? 1 : 0;
+        auto      it      = std::find_if(gApplied.begin(), gApplied.end(), [&viewport](const AppliedInterval& entry) { return entry.id == viewport.ID; });
+        if (it == gApplied.end())
+            it = gApplied.insert(gApplied.end(), AppliedInterval{ viewport.ID, -1 });
+        if (it->interval != desired)
+        {
+            SDL_GL_SetSwapInterval(desired);
+            it->interval = desired;
+        }
+    }
+}
+
+namespace imgui_viewports
+{
+    void Apply(const ViewportSettings& settings, bool allowed)
+    {
+        gSettings = settings;
+        gAllowed  = allowed;
+
+        ImGuiIO& io = ImGui::GetIO();
+        if (settings.enabled && allowed)
+            io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+        else
+            io.ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+    }
+
+    void Render()
+    {
+        gLastFrame = FrameCost{};
+        ImGui::UpdatePlatformWindows();
+
+        // same order of calls as RenderPlatformWindowsDefault, with a clock around each step
+        const ImGuiPlatformIO& platform = ImGui::GetPlatformIO();
+        const Uint64           begin    = SDL_GetPerformanceCounter();
+        GL_STATS_PASS("Viewports");
+        for (int i = 1; i < platform.Viewports.Size; ++i)
+        {
+            ImGuiViewport* viewport = platform.Viewports[i];
+            if (viewport->Flags & ImGuiViewportFlags_IsMinimized)
+                continue;
+            const Uint64 render_begin = SDL_GetPerformanceCounter();
+            if (platform.Platform_RenderWindow != nullptr)
+                platform.Platform_RenderWindow(viewport, nullptr);
+            apply_swap_interval(*viewport);
+            if (platform.Renderer_RenderWindow != nullptr)
+                platform.Renderer_RenderWindow(viewport, nullptr);
+            if (viewport->DrawData != nullptr)
+                gl_stats::CountImGui(*viewport->DrawData);
+            const Uint64 swap_begin = SDL_GetPerformanceCounter();
+            if (platform.Platform_SwapBuffers != nullptr)
+                platform.Platform_SwapBuffers(viewport, nullptr);
+            if (platform.Renderer_SwapBuffers != nullptr)
+                platform.Renderer_SwapBuffers(viewport, nullptr);
+            const Uint64 end = SDL_GetPerformanceCounter();
+
+            if (gLastFrame.viewport_count < MAX_MEASURED)
+            {
+                ViewportCost& cost = gLastFrame.viewports[gLastFrame.viewport_count++];
+                cost.id            = viewport->ID;
+                cost.vertices      = viewport->DrawData != nullptr ? viewport->DrawData->TotalVtxCount : 0;
+                cost.render_ms     = profiler::ToMilliseconds(swap_begin - render_begin);
+                cost.swap_ms       = profiler::ToMilliseconds(end - swap_begin);
+            }
+        }
+        gLastFrame.total_ms = profiler::ToMilliseconds(SDL_GetPerformanceCounter() - begin);
+
+        // windows that closed take their context with them; a reused ID gets a fresh context
+        std::erase_if(gApplied, [&platform](const AppliedInterval& entry)
+                      { return std::none_of(platform.Viewports.begin(), platform.Viewports.end(), [&entry](const ImGuiViewport* viewport) { return viewport->ID == entry.id; }); });
+    }
+
+    const FrameCost& LastFrame() noexcept
+    {
+        return gLastFrame;
+    }
+
+    bool DrawImGui(ViewportSettings& settings)
+    {
+        ImGui::BeginDisabled(!gAllowed);
+        bool changed = ImGui::Checkbox("imgui viewports", &settings.enabled);
+        ImGui::EndDisabled();
+        if (!settings.enabled || !gAllowed)
+            return changed;
+        ImGui::SameLine();
+        changed = ImGui::Checkbox("vsync secondary windows", &settings.secondary_vsync) || changed;
+
+        const FrameCost& frame = gLastFrame;
+        ImGui::Text("%d secondary window(s), %.3f ms", frame.viewport_count, frame.total_ms);
+        for (int i = 0; i < frame.viewport_count; ++i)
+        {
+            const ViewportCost& cost = frame.viewports[i];
+            ImGui::Text("  0x%08X: %6d vertices | render %.3f ms  swap %.3f ms", cost.id, cost.vertices, cost.render_ms, cost.swap_ms);
+        }
+        return changed;
+    }
+}
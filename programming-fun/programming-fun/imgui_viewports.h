@@ -0,0 +1,56 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+struct ViewportSettings
+{
+    bool enabled         = true;  // ImGui windows can be dragged out into their own OS windows
+    bool secondary_vsync = false; // with it every secondary window waits for its own vblank, one after another
+
+    bool operator==(const ViewportSettings&) const = default;
+};
+
+/**
+ * Replacement for ImGui::UpdatePlatformWindows + RenderPlatformWindowsDefault that measures each secondary
+ * viewport and owns its swap interval.
+ *
+ * The SDL2 backend gives every secondary window its own GL context; Render sets that context's swap
+ * interval to match the settings the first time it sees the window or the setting changes, instead of
+ * leaving whatever the driver defaults to. Turning `enabled` off merges the windows back into the main one
+ * on the next NewFrame and ImGui destroys the OS windows. Leaves no context current: the caller
+ * makes its own current again. Main thread only.
+ */
+namespace imgui_viewports
+{
+    inline constexpr int MAX_MEASURED = 16;
+
+    struct ViewportCost
+    {
+        unsigned id        = 0;
+        int      vertices  = 0;
+        double   render_ms = 0.0; // making the context current and recording the GL commands
+        double   swap_ms   = 0.0;
+    };
+
+    struct FrameCost
+    {
+        int          viewport_count = 0; // secondary ones drawn this frame
+        double       total_ms       = 0.0;
+        ViewportCost viewports[MAX_MEASURED];
+    };
+
+    // Before ImGui::NewFrame; `allowed` is false when secondary windows can't work (render thread)
+    void Apply(const ViewportSettings& settings, bool allowed);
+    // After ImGui::Render, only while ImGuiConfigFlags_ViewportsEnable is set
+    void Render();
+
+    const FrameCost& LastFrame() noexcept;
+
+    // Controls and the cost table for the caller's current window; returns true when a setting changed
+    bool DrawImGui(ViewportSettings& settings);
+}
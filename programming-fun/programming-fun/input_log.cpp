@@ -0,0 +1,332 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "input_log.h"
+
+#include "logger.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace
+{
+    // magic, then version, frame count and event count as varints
+    constexpr char          MAGIC[4] = { 'P', 'F', 'I', 'L' };
+    constexpr std::uint64_t VERSION  = 1;
+
+    class Writer
+    {
+    public:
+        void Varint(std::uint64_t value)
+        {
+            for (; value >= 0x80; value >>= 7)
+                bytes.push_back(static_cast<char>(value | 0x80));
+            bytes.push_back(static_cast<char>(value));
+        }
+
+        void Signed(std::int64_t value)
+        {
+            Varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+        }
+
+        void Float(float value)
+        {
+            Varint(std::bit_cast<std::uint32_t>(value));
+        }
+
+        void Text(const char* text, std::size_t capacity)
+        {
+            const auto length = static_cast<std::size_t>(std::find(text, text + capacity - 1, '\0') - text);
+            Varint(length);
+            bytes.insert(bytes.end(), text, text + length);
+        }
+
+        std::vector<char> bytes;
+    };
+
+    class Reader
+    {
+    public:
+        explicit Reader(const std::vector<char>& bytes) : bytes{ bytes } {}
+
+        std::uint64_t Varint()
+        {
+            std::uint64_t value = 0;
+            for (int shift = 0; shift < 64 && at < bytes.size(); shift += 7)
+            {
+                const auto byte = static_cast<unsigned char>(bytes[at++]);
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+            is_ok = false;
+            return 0;
+        }
+
+        std::int64_t Signed()
+        {
+            const std::uint64_t value = Varint();
+            return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+        }
+
+        float Float()
+        {
+            return std::bit_cast<float>(static_cast<std::uint32_t>(Varint()));
+        }
+
+        void Text(char* out, std::size_t capacity)
+        {
+            const std::uint64_t length = Varint();
+            if (length >= capacity || length > bytes.size() - at)
+            {
+                is_ok = false;
+                return;
+            }
+            std::memcpy(out, bytes.data() + at, length);
+            out[length] = '\0';
+            at += length;
+        }
+
+        bool IsOk() const noexcept
+        {
+            return is_ok;
+        }
+
+    private:
+        const std::vector<char>& bytes;
+        std::size_t              at    = 0;
+        bool                     is_ok = true;
+    };
+
+    void write_event(Writer& out, const SDL_Event& event)
+    {
+        out.Varint(event.type);
+        switch (event.type)
+        {
+            case SDL_KEYDOWN:
+            case SDL_KEYUP:
+                out.Varint(static_cast<std::uint64_t>(event.key.keysym.scancode));
+                out.Signed(event.key.keysym.sym);
+                out.Varint(event.key.keysym.mod);
+                out.Varint(event.key.repeat);
+                break;
+            case SDL_TEXTINPUT: out.Text(event.text.text, sizeof(event.text.text)); break;
+            case SDL_MOUSEMOTION:
+                out.Varint(event.motion.state);
+                out.Signed(event.motion.x);
+                out.Signed(event.motion.y);
+                out.Signed(event.motion.xrel);
+                out.Signed(event.motion.yrel);
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+                out.Varint(event.button.button);
+                out.Varint(event.button.clicks);
+                out.Signed(event.button.x);
+                out.Signed(event.button.y);
+                break;
+            case SDL_MOUSEWHEEL:
+                out.Signed(event.wheel.x);
+                out.Signed(event.wheel.y);
+                out.Varint(event.wheel.direction);
+                out.Float(event.wheel.preciseX);
+                out.Float(event.wheel.preciseY);
+                out.Signed(event.wheel.mouseX);
+                out.Signed(event.wheel.mouseY);
+                break;
+            case SDL_CONTROLLERAXISMOTION:
+                out.Signed(event.caxis.which);
+                out.Varint(event.caxis.axis);
+                out.Signed(event.caxis.value);
+                break;
+            case SDL_CONTROLLERBUTTONDOWN:
+            case SDL_CONTROLLERBUTTONUP:
+                out.Signed(event.cbutton.which);
+                out.Varint(event.cbutton.button);
+                break;
+        }
+    }
+
+    bool read_event(Reader& in, SDL_Event& event, Uint32 window_id)
+    {
+        event      = SDL_Event{};
+        event.type = static_cast<Uint32>(in.Varint());
+        switch (event.type)
+        {
+            case SDL_KEYDOWN:
+            case SDL_KEYUP:
+                event.key.windowID        = window_id;
+                event.key.state           = event.type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+                event.key.keysym.scancode = static_cast<SDL_Scancode>(in.Varint());
+                event.key.keysym.sym      = static_cast<SDL_Keycode>(in.Signed());
+                event.key.keysym.mod      = static_cast<Uint16>(in.Varint());
+                event.key.repeat          = static_cast<Uint8>(in.Varint());
+                break;
+            case SDL_TEXTINPUT:
+                event.text.windowID = window_id;
+                in.Text(event.text.text, sizeof(event.text.text));
+                break;
+            case SDL_MOUSEMOTION:
+                event.motion.windowID = window_id;
+                event.motion.state    = static_cast<Uint32>(in.Varint());
+                event.motion.x        = static_cast<Sint32>(in.Signed());
+                event.motion.y        = static_cast<Sint32>(in.Signed());
+                event.motion.xrel     = static_cast<Sint32>(in.Signed());
+                event.motion.yrel     = static_cast<Sint32>(in.Signed());
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+                event.button.windowID = window_id;
+                event.button.state    = event.type == SDL_MOUSEBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+                event.button.button   = static_cast<Uint8>(in.Varint());
+                event.button.clicks   = static_cast<Uint8>(in.Varint());
+                event.button.x        = static_cast<Sint32>(in.Signed());
+                event.button.y        = static_cast<Sint32>(in.Signed());
+                break;
+            case SDL_MOUSEWHEEL:
+                event.wheel.windowID  = window_id;
+                event.wheel.x         = static_cast<Sint32>(in.Signed());
+                event.wheel.y         = static_cast<Sint32>(in.Signed());
+                event.wheel.direction = static_cast<Uint32>(in.Varint());
+                event.wheel.preciseX  = in.Float();
+                event.wheel.preciseY  = in.Float();
+                event.wheel.mouseX    = static_cast<Sint32>(in.Signed());
+                event.wheel.mouseY    = static_cast<Sint32>(in.Signed());
+                break;
+            case SDL_CONTROLLERAXISMOTION:
+                event.caxis.which = static_cast<SDL_JoystickID>(in.Signed());
+                event.caxis.axis  = static_cast<Uint8>(in.Varint());
+                event.caxis.value = static_cast<Sint16>(in.Signed());
+                break;
+            case SDL_CONTROLLERBUTTONDOWN:
+            case SDL_CONTROLLERBUTTONUP:
+                event.cbutton.which  = static_cast<SDL_JoystickID>(in.Signed());
+                event.cbutton.state  = event.type == SDL_CONTROLLERBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+                event.cbutton.button = static_cast<Uint8>(in.Varint());
+                break;
+            default: return false;
+        }
+        return in.IsOk();
+    }
+}
+
+bool InputLog::IsRecorded(const SDL_Event& event) noexcept
+{
+    switch (event.type)
+    {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_TEXTINPUT:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+        case SDL_CONTROLLERAXISMOTION:
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP: return true;
+        default: return false;
+    }
+}
+
+void InputLog::Add(std::uint32_t frame, const SDL_Event& event)
+{
+    if (IsRecorded(event))
+        entries.push_back(Entry{ frame, event });
+    frames = std::max(frames, frame + 1);
+}
+
+bool InputLog::Save(const std::filesystem::path& filename, std::uint32_t frame_count) const
+{
+    Writer out;
+    out.bytes.assign(std::begin(MAGIC), std::end(MAGIC));
+    out.Varint(VERSION);
+    out.Varint(std::max(frame_count, frames));
+    out.Varint(entries.size());
+    std::uint32_t previous = 0;
+    for (const Entry& entry : entries)
+    {
+        out.Varint(entry.frame - previous);
+        previous = entry.frame;
+        write_event(out, entry.event);
+    }
+    std::ofstream file{ filename, std::ios::binary };
+    if (!file.write(out.bytes.data(), static_cast<std::streamsize>(out.bytes.size())))
+    {
+        LOG_ERROR("Failed to write the input recording ", filename);
+        return false;
+    }
+    return true;
+}
+
+bool InputLog::Load(const std::filesystem::path& filename, Uint32 window_id)
+{
+    std::ifstream     file{ filename, std::ios::binary };
+    std::vector<char> bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    if (!file && !file.eof())
+        bytes.clear();
+    if (bytes.size() < sizeof(MAGIC) || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0)
+    {
+        LOG_ERROR("Not an input recording: ", filename);
+        return false;
+    }
+    bytes.erase(bytes.begin(), bytes.begin() + sizeof(MAGIC));
+    Reader in{ bytes };
+    if (in.Varint() != VERSION)
+    {
+        LOG_ERROR("Input recording ", filename, " is from another version");
+        return false;
+    }
+    const std::uint64_t frame_count = in.Varint();
+    const std::uint64_t count       = in.Varint();
+    std::vector<Entry>  loaded;
+    loaded.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(count, bytes.size())));
+    std::uint64_t frame = 0;
+    for (std::uint64_t i = 0; i < count && in.IsOk(); ++i)
+    {
+        frame += in.Varint();
+        Entry entry{ static_cast<std::uint32_t>(frame), {} };
+        if (!read_event(in, entry.event, window_id) || frame >= frame_count)
+        {
+            LOG_ERROR("Input recording ", filename, " is damaged at event ", i);
+            return false;
+        }
+        loaded.push_back(entry);
+    }
+    if (!in.IsOk())
+    {
+        LOG_ERROR("Input recording ", filename, " is truncated");
+        return false;
+    }
+    entries = std::move(loaded);
+    frames  = static_cast<std::uint32_t>(frame_count);
+    next    = 0;
+    return true;
+}
+
+std::span<const SDL_Event> InputLog::EventsAt(std::uint32_t frame)
+{
+    current.clear();
+    while (next < entries.size() && entries[next].frame < frame)
+        ++next;
+    for (; next < entries.size() && entries[next].frame == frame; ++next)
+        current.push_back(entries[next].event);
+    return current;
+}
+
+std::uint32_t InputLog::Frames() const noexcept
+{
+    return frames;
+}
+
+std::size_t InputLog::EventCount() const noexcept
+{
+    return entries.size();
+}
@@ -0,0 +1,54 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <SDL_events.h>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+/**
+ * The keyboard, text, mouse and controller events of a run, by frame, for replaying the same session exactly.
+ *
+ * Recording keeps the events Add is given in memory and Save writes them once at the end: a small header, then
+ * per event the frame delta, the type and only the fields that type uses, as varints. A few minutes of play are
+ * some tens of kilobytes. Frames count the caller's polls, not time, so a replay only lines up with the recording
+ * when both step the simulation by the same fixed amount every frame, which the Application does for both.
+ * Window, focus and device events are left out: they describe this machine, not the session.
+ * Main thread only.
+ */
+class InputLog
+{
+public:
+    // The events Add keeps; the rest are left to the live event loop even while replaying
+    static bool IsRecorded(const SDL_Event& event) noexcept;
+
+    void Add(std::uint32_t frame, const SDL_Event& event);
+    // `frames` is how many polls the recording covered, so a replay ends where it did
+    bool Save(const std::filesystem::path& filename, std::uint32_t frames) const;
+    // The events come back addressed to `window_id`, whatever the recording's window was
+    bool Load(const std::filesystem::path& filename, Uint32 window_id);
+
+    // The events of `frame` in the order they were polled; frames have to be asked for in increasing order
+    std::span<const SDL_Event> EventsAt(std::uint32_t frame);
+    std::uint32_t              Frames() const noexcept;
+    std::size_t                EventCount() const noexcept;
+
+private:
+    struct Entry
+    {
+        std::uint32_t frame = 0;
+        SDL_Event     event{};
+    };
+
+    std::vector<Entry>     entries;
+    std::vector<SDL_Event> current; // EventsAt's result
+    std::size_t            next   = 0;
+    std::uint32_t          frames = 0;
+};
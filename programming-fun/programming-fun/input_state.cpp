@@ -0,0 +1,165 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "input_state.h"
+
+#include "logger.h"
+#include "perf_counters.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+    // queued by SDL by default and read by neither the collector nor ImGui's backend
+    constexpr Uint32 IGNORED_EVENTS[] = {
+        SDL_TEXTEDITING,              SDL_TEXTEDITING_EXT,          SDL_KEYMAPCHANGED,
+        SDL_FINGERDOWN,               SDL_FINGERUP,                 SDL_FINGERMOTION,
+        SDL_DOLLARGESTURE,            SDL_DOLLARRECORD,             SDL_MULTIGESTURE,
+        SDL_SENSORUPDATE,             SDL_CONTROLLERSENSORUPDATE,   SDL_JOYBALLMOTION,
+        SDL_JOYBATTERYUPDATED,        SDL_CONTROLLERTOUCHPADDOWN,   SDL_CONTROLLERTOUCHPADUP,
+        SDL_CONTROLLERTOUCHPADMOTION, SDL_CLIPBOARDUPDATE,          SDL_DROPFILE,
+        SDL_DROPTEXT,                 SDL_DROPBEGIN,                SDL_DROPCOMPLETE,
+        SDL_AUDIODEVICEADDED,         SDL_AUDIODEVICEREMOVED,       SDL_LOCALECHANGED,
+        SDL_RENDER_TARGETS_RESET,     SDL_RENDER_DEVICE_RESET
+    };
+}
+
+InputCollector::~InputCollector()
+{
+    if (is_filtering)
+        SDL_SetEventFilter(nullptr, nullptr);
+    for (SDL_GameController* controller : controllers)
+        SDL_GameControllerClose(controller);
+}
+
+void InputCollector::InstallEventFilter()
+{
+    for (const Uint32 type : IGNORED_EVENTS)
+        SDL_EventState(type, SDL_IGNORE);
+    SDL_SetEventFilter(&InputCollector::filterEvent, this);
+    is_filtering = true;
+}
+
+int SDLCALL InputCollector::filterEvent(void* userdata, SDL_Event* event)
+{
+    auto* collector = static_cast<InputCollector*>(userdata);
+    if (!collector->isNoise(*event))
+        return 1;
+    collector->filtered.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+}
+
+bool InputCollector::isNoise(const SDL_Event& event) noexcept
+{
+    if (event.type == SDL_MOUSEMOTION)
+        return event.motion.xrel == 0 && event.motion.yrel == 0;
+    if (event.type != SDL_JOYAXISMOTION)
+        return false;
+    const SDL_JoyAxisEvent& motion = event.jaxis;
+    auto                    slot   = std::find_if(axis_values.begin(), axis_values.end(), [&motion](const AxisValue& value) { return value.joystick == motion.which && value.axis == motion.axis; });
+    if (slot == axis_values.end())
+        slot = std::find_if(axis_values.begin(), axis_values.end(), [](const AxisValue& value) { return value.joystick < 0; });
+    // rest and the ends always pass, so what the controller settles on is exact
+    const bool is_rest = motion.value == 0 || motion.value <= -32767 || motion.value >= 32767;
+    if (slot != axis_values.end() && slot->joystick >= 0 && !is_rest && std::abs(motion.value - slot->value) < AXIS_NOISE)
+        return true;
+    // a full table passes everything from the joysticks it has no room for
+    if (slot != axis_values.end())
+        *slot = AxisValue{ motion.which, motion.axis, motion.value };
+    return false;
+}
+
+InputCollector::Disposition InputCollector::Add(const SDL_Event& event)
+{
+    ++building.events;
+    Disposition disposition = Disposition::Forward;
+    switch (event.type)
+    {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            if (const auto scancode = static_cast<std::size_t>(event.key.keysym.scancode); scancode < building.keys.size())
+                building.keys.set(scancode, event.type == SDL_KEYDOWN);
+            break;
+        case SDL_MOUSEMOTION:
+            building.mouse_position = glm::vec2{ static_cast<float>(event.motion.x), static_cast<float>(event.motion.y) };
+            building.mouse_delta += glm::vec2{ static_cast<float>(event.motion.xrel), static_cast<float>(event.motion.yrel) };
+            building.mouse_buttons = event.motion.state;
+            disposition            = Disposition::Defer;
+            break;
+        case SDL_MOUSEBUTTONDOWN: building.mouse_buttons |= SDL_BUTTON(event.button.button); break;
+        case SDL_MOUSEBUTTONUP: building.mouse_buttons &= ~SDL_BUTTON(event.button.button); break;
+        case SDL_MOUSEWHEEL: building.wheel += glm::vec2{ event.wheel.preciseX, event.wheel.preciseY }; break;
+        case SDL_CONTROLLERAXISMOTION:
+            if (event.caxis.axis < SDL_CONTROLLER_AXIS_MAX)
+                building.axes[event.caxis.axis] = std::max(static_cast<float>(event.caxis.value) / 32767.0f, -1.0f);
+            disposition = Disposition::Drop;
+            break;
+        // every opened controller also reports as a joystick; nothing here reads the raw axes
+        case SDL_JOYAXISMOTION: disposition = Disposition::Drop; break;
+        case SDL_CONTROLLERDEVICEADDED:
+            // `which` is a device index here, an instance id on removal
+            if (SDL_GameController* controller = SDL_GameControllerOpen(event.cdevice.which); controller != nullptr)
+                controllers.push_back(controller);
+            else
+                LOG_ERROR("Failed to open game controller ", event.cdevice.which, ": ", SDL_GetError());
+            break;
+        case SDL_CONTROLLERDEVICEREMOVED:
+            {
+                const auto removed = std::find_if(controllers.begin(), controllers.end(),
+                                                  [id = event.cdevice.which](SDL_GameController* c) { return SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(c)) == id; });
+                if (removed != controllers.end())
+                {
+                    SDL_GameControllerClose(*removed);
+                    controllers.erase(removed);
+                }
+                building.axes.fill(0.0f);
+            }
+            break;
+        case SDL_WINDOWEVENT:
+            // the key and button ups go to whichever window has focus next
+            if (event.window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+            {
+                building.keys.reset();
+                building.mouse_buttons = 0;
+            }
+            break;
+    }
+    if (disposition == Disposition::Drop || (disposition == Disposition::Defer && has_deferred))
+        ++building.coalesced_events;
+    has_deferred = disposition == Disposition::Defer || (disposition == Disposition::Drop && has_deferred);
+    return disposition;
+}
+
+InputSnapshot InputCollector::EndFrame()
+{
+    static const perf_counters::Handle handled   = perf_counters::Register("input events", perf_counters::Kind::Counter);
+    static const perf_counters::Handle coalesced = perf_counters::Register("input events coalesced", perf_counters::Kind::Counter);
+    static const perf_counters::Handle dropped   = perf_counters::Register("input events filtered", perf_counters::Kind::Counter);
+
+    building.ticks           = SDL_GetPerformanceCounter();
+    building.filtered_events = filtered.exchange(0, std::memory_order_relaxed);
+    ++building.sequence;
+    last = building;
+    perf_counters::Add(handled, last.events);
+    perf_counters::Add(coalesced, last.coalesced_events);
+    perf_counters::Add(dropped, last.filtered_events);
+
+    // held state carries over, sums and counts start again
+    building.mouse_delta      = glm::vec2{ 0.0f };
+    building.wheel            = glm::vec2{ 0.0f };
+    building.events           = 0;
+    building.coalesced_events = 0;
+    has_deferred              = false;
+    return last;
+}
+
+const InputSnapshot& InputCollector::Last() const noexcept
+{
+    return last;
+}
@@ -0,0 +1,98 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <SDL_events.h>
+#include <SDL_gamecontroller.h>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <vector>
+
+// What the devices looked like at the end of one frame's event poll; plain data, cheap to copy across threads
+struct InputSnapshot
+{
+    std::uint64_t                              sequence         = 0; // one per poll, increasing
+    Uint64                                     ticks            = 0; // SDL_GetPerformanceCounter at the end of the poll
+    std::bitset<SDL_NUM_SCANCODES>             keys;                 // held, by scancode
+    Uint32                                     mouse_buttons    = 0; // SDL_BUTTON masks
+    glm::vec2                                  mouse_position{ 0.0f };
+    glm::vec2                                  mouse_delta{ 0.0f }; // summed over the frame
+    glm::vec2                                  wheel{ 0.0f };       // summed over the frame
+    std::array<float, SDL_CONTROLLER_AXIS_MAX> axes{};              // last controller that moved, -1 to 1
+    int                                        events           = 0;
+    int                                        coalesced_events = 0; // motion folded into a later event instead of handed on
+    int                                        filtered_events  = 0; // never queued: the event filter's, since the last poll
+};
+
+/**
+ * Folds a frame's SDL events into an InputSnapshot and thins out the motion floods.
+ *
+ * High poll rate mice and controllers send hundreds of motion events a frame. Mouse motion only
+ * matters as a running delta plus the latest position, so a run of them is handed on as its last
+ * event; axis motion is kept in the snapshot and not handed on at all. Anything else flushes the
+ * pending motion first, so a click still lands where the cursor was. Main thread only.
+ *
+ * InstallEventFilter thins them out before that, as SDL queues them. The types nothing here or in ImGui reads
+ * (touch fingers and gestures, sensors, IME composition, drops, the clipboard, audio devices...) are never
+ * queued. A filter drops what can't be told apart by type: mouse motion that didn't move, and joystick axis
+ * changes under AXIS_NOISE. The joystick axes still have to be queued, because SDL maps them onto the
+ * controller axes as they pass its event watchers, which run after the filter; a centred or full axis always
+ * gets through, so a stick comes to rest where it is.
+ */
+class InputCollector
+{
+public:
+    enum class Disposition
+    {
+        Forward, // hand the event on now
+        Defer,   // motion; hand on the latest one before the next forwarded event, or at the end of the poll
+        Drop     // fully captured by the snapshot
+    };
+
+    static constexpr int AXIS_NOISE = 256; // of 32767
+
+    InputCollector() = default;
+    ~InputCollector();
+
+    InputCollector(const InputCollector&)                = delete;
+    InputCollector& operator=(const InputCollector&)     = delete;
+    InputCollector(InputCollector&&) noexcept            = delete;
+    InputCollector& operator=(InputCollector&&) noexcept = delete;
+
+    // Once SDL's video is up; the filter is removed again with the collector
+    void        InstallEventFilter();
+    Disposition Add(const SDL_Event& event);
+    // Stamps and returns the frame's snapshot, then clears the per frame sums for the next poll
+    InputSnapshot EndFrame();
+
+    const InputSnapshot& Last() const noexcept;
+
+private:
+    struct AxisValue
+    {
+        SDL_JoystickID joystick = -1;
+        Uint8          axis     = 0;
+        Sint16         value    = 0;
+    };
+
+    static int SDLCALL filterEvent(void* userdata, SDL_Event* event);
+    // SDL calls the filter under its own lock, from whichever thread pushed the event
+    bool isNoise(const SDL_Event& event) noexcept;
+
+private:
+    InputSnapshot                    building;
+    InputSnapshot                    last;
+    std::vector<SDL_GameController*> controllers; // opened as they connect, so their axes report
+    bool                             has_deferred = false;
+    bool                             is_filtering = false;
+    std::array<AxisValue, 32>        axis_values{}; // the last passed on, by joystick and axis
+    std::atomic<int>                 filtered{ 0 };
+};
@@ -0,0 +1,242 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "ktx2.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    constexpr unsigned char IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    constexpr std::size_t   HEADER_SIZE    = 80;
+    constexpr std::size_t   LEVEL_SIZE     = 24;
+
+    // KTX2 is little-endian, as is every platform this project ships on
+    template <typename T>
+    T read_at(const std::vector<unsigned char>& bytes, std::size_t offset)
+    {
+        T value{};
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void write_at(std::vector<unsigned char>& bytes, std::size_t offset, T value)
+    {
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+
+    std::size_t align_up(std::size_t value, std::size_t alignment) noexcept
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    struct DescriptorSample
+    {
+        std::uint16_t bit_offset;
+        std::uint8_t  bit_length;
+        std::uint8_t  channel;
+    };
+
+    // Basic data format descriptor for a 4x4 block format, see the Khronos Data Format spec
+    std::vector<unsigned char> make_descriptor(std::uint32_t vk_format)
+    {
+        std::uint8_t     color_model = 0;
+        DescriptorSample samples[2]  = {};
+        int              count       = 1;
+        switch (vk_format)
+        {
+            case ktx2::FORMAT_BC1_RGBA_UNORM:
+                color_model = 128;
+                samples[0]  = { 0, 64, 0 };
+                break;
+            case ktx2::FORMAT_BC3_UNORM:
+                color_model = 130;
+                samples[0]  = { 0, 64, 15 };
+                samples[1]  = { 64, 64, 0 };
+                count       = 2;
+                break;
+            case ktx2::FORMAT_BC7_UNORM:
+                color_model = 134;
+                samples[0]  = { 0, 128, 0 };
+                break;
+            case ktx2::FORMAT_ETC2_R8G8B8A8_UNORM:
+                color_model = 161;
+                samples[0]  = { 0, 64, 15 };
+                samples[1]  = { 64, 64, 2 };
+                count       = 2;
+                break;
+            case ktx2::FORMAT_ASTC_4x4_UNORM:
+                color_model = 162;
+                samples[0]  = { 0, 128, 0 };
+                break;
+            default: break;
+        }
+
+        const auto                 block_size = static_cast<std::uint32_t>(24 + 16 * count);
+        std::vector<unsigned char> descriptor(4 + block_size, 0);
+        write_at<std::uint32_t>(descriptor, 0, static_cast<std::uint32_t>(descriptor.size()));
+        write_at<std::uint32_t>(descriptor, 4, 0);                      // vendor Khronos, basic descriptor type
+        write_at<std::uint32_t>(descriptor, 8, 2u | (block_size << 16)); // version 2
+        descriptor[12] = color_model;
+        descriptor[13] = 1; // BT.709 primaries
+        descriptor[14] = 1; // linear transfer
+        descriptor[16] = 3; // block is 4x4, stored as dimension - 1
+        descriptor[17] = 3;
+        descriptor[20] = static_cast<unsigned char>(ktx2::BlockBytes(vk_format));
+        for (int i = 0; i < count; ++i)
+        {
+            const std::size_t at = 28 + 16 * static_cast<std::size_t>(i);
+            write_at<std::uint16_t>(descriptor, at, samples[i].bit_offset);
+            descriptor[at + 2] = static_cast<unsigned char>(samples[i].bit_length - 1);
+            descriptor[at + 3] = samples[i].channel;
+            write_at<std::uint32_t>(descriptor, at + 8, 0);
+            write_at<std::uint32_t>(descriptor, at + 12, 0xFFFFFFFFu);
+        }
+        return descriptor;
+    }
+
+    bool parse(std::vector<unsigned char> bytes, const std::string& label, ktx2::Image& out_image)
+    {
+        if (bytes.size() < HEADER_SIZE)
+            return false;
+        if (std::memcmp(bytes.data(), IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+        {
+            std::cerr << "Not a KTX2 file: " << label << '\n';
+            return false;
+        }
+        const auto vk_format       = read_at<std::uint32_t>(bytes, 12);
+        const auto width           = read_at<std::uint32_t>(bytes, 20);
+        const auto height          = read_at<std::uint32_t>(bytes, 24);
+        const auto depth           = read_at<std::uint32_t>(bytes, 28);
+        const auto layers          = read_at<std::uint32_t>(bytes, 32);
+        const auto faces           = read_at<std::uint32_t>(bytes, 36);
+        const auto level_count     = std::max<std::uint32_t>(1, read_at<std::uint32_t>(bytes, 40));
+        const auto supercompressed = read_at<std::uint32_t>(bytes, 44);
+        if (ktx2::BlockBytes(vk_format) == 0 || depth > 1 || layers > 1 || faces != 1 || supercompressed != 0 || width == 0 || height == 0)
+        {
+            std::cerr << "Unsupported KTX2 layout or format " << vk_format << ": " << label << '\n';
+            return false;
+        }
+        if (HEADER_SIZE + LEVEL_SIZE * level_count > bytes.size())
+            return false;
+
+        ktx2::Image image;
+        image.vk_format = vk_format;
+        image.width     = static_cast<int>(width);
+        image.height    = static_cast<int>(height);
+        image.levels.resize(level_count);
+        for (std::uint32_t i = 0; i < level_count; ++i)
+        {
+            const std::size_t entry = HEADER_SIZE + LEVEL_SIZE * i;
+            ktx2::Level&      level = image.levels[i];
+            level.width             = std::max(1, image.width >> i);
+            level.height            = std::max(1, image.height >> i);
+            level.offset            = static_cast<std::size_t>(read_at<std::uint64_t>(bytes, entry));
+            level.size              = static_cast<std::size_t>(read_at<std::uint64_t>(bytes, entry + 8));
+            if (level.offset + level.size > bytes.size() || level.size != ktx2::LevelBytes(vk_format, level.width, level.height))
+            {
+                std::cerr << "Corrupt KTX2 level " << i << ": " << label << '\n';
+                return false;
+            }
+        }
+        image.data = std::move(bytes);
+        out_image  = std::move(image);
+        return true;
+    }
+}
+
+namespace ktx2
+{
+    std::size_t BlockBytes(std::uint32_t vk_format) noexcept
+    {
+        switch (vk_format)
+        {
+            case FORMAT_BC1_RGBA_UNORM: return 8;
+            case FORMAT_BC3_UNORM:
+            case FORMAT_BC7_UNORM:
+            case FORMAT_ETC2_R8G8B8A8_UNORM:
+            case FORMAT_ASTC_4x4_UNORM: return 16;
+            default: return 0;
+        }
+    }
+
+    std::size_t LevelBytes(std::uint32_t vk_format, int width, int height) noexcept
+    {
+        const auto blocks_x = static_cast<std::size_t>((width + 3) / 4);
+        const auto blocks_y = static_cast<std::size_t>((height + 3) / 4);
+        return blocks_x * blocks_y * BlockBytes(vk_format);
+    }
+
+    bool Load(const std::filesystem::path& filename, Image& out_image)
+    {
+        std::ifstream file{ filename, std::ios::binary | std::ios::ate };
+        if (!file)
+            return false;
+        const auto                 file_size = static_cast<std::size_t>(file.tellg());
+        std::vector<unsigned char> bytes(file_size);
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(file_size)))
+            return false;
+        return parse(std::move(bytes), filename.string(), out_image);
+    }
+
+    bool Load(std::span<const unsigned char> bytes, Image& out_image)
+    {
+        return parse(std::vector<unsigned char>(bytes.begin(), bytes.end()), "<memory>", out_image);
+    }
+    bool Save(const std::filesystem::path& filename, const Image& image)
+    {
+        const std::size_t block_bytes = BlockBytes(image.vk_format);
+        if (block_bytes == 0 || image.levels.empty())
+            return false;
+
+        const auto                 descriptor    = make_descriptor(image.vk_format);
+        const std::size_t          level_count   = image.levels.size();
+        const std::size_t          index_end     = HEADER_SIZE + LEVEL_SIZE * level_count;
+        const std::size_t          descriptor_at = align_up(index_end, 4);
+        std::size_t                cursor        = descriptor_at + descriptor.size();
+        std::vector<std::uint64_t> level_offsets(level_count);
+
+        // level data goes smallest first, each aligned to the block size
+        for (std::size_t i = level_count; i-- > 0;)
+        {
+            cursor           = align_up(cursor, block_bytes);
+            level_offsets[i] = cursor;
+            cursor += image.levels[i].size;
+        }
+
+        std::vector<unsigned char> bytes(cursor, 0);
+        std::memcpy(bytes.data(), IDENTIFIER, sizeof(IDENTIFIER));
+        write_at<std::uint32_t>(bytes, 12, image.vk_format);
+        write_at<std::uint32_t>(bytes, 16, 1); // typeSize is 1 for block compressed formats
+        write_at<std::uint32_t>(bytes, 20, static_cast<std::uint32_t>(image.width));
+        write_at<std::uint32_t>(bytes, 24, static_cast<std::uint32_t>(image.height));
+        write_at<std::uint32_t>(bytes, 36, 1); // faces
+        write_at<std::uint32_t>(bytes, 40, static_cast<std::uint32_t>(level_count));
+        write_at<std::uint32_t>(bytes, 48, static_cast<std::uint32_t>(descriptor_at));
+        write_at<std::uint32_t>(bytes, 52, static_cast<std::uint32_t>(descriptor.size()));
+        std::memcpy(bytes.data() + descriptor_at, descriptor.data(), descriptor.size());
+
+        for (std::size_t i = 0; i < level_count; ++i)
+        {
+            const Level&      level = image.levels[i];
+            const std::size_t entry = HEADER_SIZE + LEVEL_SIZE * i;
+            write_at<std::uint64_t>(bytes, entry, level_offsets[i]);
+            write_at<std::uint64_t>(bytes, entry + 8, level.size);
+            write_at<std::uint64_t>(bytes, entry + 16, level.size);
+            std::memcpy(bytes.data() + level_offsets[i], image.data.data() + level.offset, level.size);
+        }
+
+        std::ofstream file{ filename, std::ios::binary };
+        return file && file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+}
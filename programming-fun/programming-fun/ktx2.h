@@ -0,0 +1,56 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+/**
+ * Minimal KTX2 container support for block compressed 2D textures.
+ *
+ * Only what the loader and texture-converter need: one face, one layer, no supercompression, 4x4 blocks.
+ * The data format descriptor is written for compliance but ignored on load; vk_format is authoritative.
+ * No GL here so offline tools can share it.
+ */
+namespace ktx2
+{
+    // VkFormat values
+    constexpr std::uint32_t FORMAT_BC1_RGBA_UNORM      = 133;
+    constexpr std::uint32_t FORMAT_BC3_UNORM           = 137;
+    constexpr std::uint32_t FORMAT_BC7_UNORM           = 145;
+    constexpr std::uint32_t FORMAT_ETC2_R8G8B8A8_UNORM = 151;
+    constexpr std::uint32_t FORMAT_ASTC_4x4_UNORM      = 157;
+
+    struct Level
+    {
+        int         width  = 0;
+        int         height = 0;
+        std::size_t offset = 0; // into Image::data
+        std::size_t size   = 0;
+    };
+
+    struct Image
+    {
+        std::uint32_t              vk_format = 0;
+        int                        width     = 0;
+        int                        height    = 0;
+        std::vector<Level>         levels; // level 0 is the largest
+        std::vector<unsigned char> data;
+    };
+
+    // Bytes per 4x4 block, 0 for formats this module does not know
+    std::size_t BlockBytes(std::uint32_t vk_format) noexcept;
+    std::size_t LevelBytes(std::uint32_t vk_format, int width, int height) noexcept;
+
+    bool Load(const std::filesystem::path& filename, Image& out_image);
+    bool Load(std::span<const unsigned char> bytes, Image& out_image); // copies, the source can go away afterwards
+    bool Save(const std::filesystem::path& filename, const Image& image);
+}
@@ -0,0 +1,234 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "latency_probe.h"
+
+#include "gl_state.h"
+#include "logger.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <fstream>
+#include <imgui.h>
+#include <limits>
+
+namespace
+{
+    double ticks_to_ms(Uint64 from, Uint64 to)
+    {
+        return to > from ? static_cast<double>(to - from) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency()) : 0.0;
+    }
+
+    // the rank at `fraction` walked up the buckets; the bucket's upper edge
+    double percentile(const std::array<int, LatencyProbe::BUCKET_COUNT + 1>& histogram, int count, double fraction)
+    {
+        const int rank = std::max(static_cast<int>(fraction * count + 0.5), 1);
+        int       seen = 0;
+        for (int bucket = 0; bucket <= LatencyProbe::BUCKET_COUNT; ++bucket)
+        {
+            seen += histogram[static_cast<std::size_t>(bucket)];
+            if (seen >= rank)
+                return (bucket + 1) * LatencyProbe::BUCKET_MS;
+        }
+        return (LatencyProbe::BUCKET_COUNT + 1) * LatencyProbe::BUCKET_MS;
+    }
+}
+
+void LatencyProbe::SetEnabled(bool enabled)
+{
+    if (enabled == is_enabled)
+        return;
+    if (!enabled)
+    {
+        // what the render side finished still counts; presses still on their way don't
+        Collect();
+        is_enabled = false;
+        pending    = LatencyMark{};
+        is_lit     = false;
+        if (!samples.empty())
+            writeCsv();
+        return;
+    }
+    is_enabled = true;
+    samples.clear();
+    histogram.fill(0);
+    submit_sum = 0.0;
+    swap_sum   = 0.0;
+    gpu_sum    = 0.0;
+    gpu_count  = 0;
+}
+
+bool LatencyProbe::IsEnabled() const noexcept
+{
+    return is_enabled;
+}
+
+void LatencyProbe::KeyPressed(Uint64 event_ticks)
+{
+    if (!is_enabled)
+        return;
+    is_lit = !is_lit;
+    // two presses in one frame show as one flip back; the later one is what the frame answers
+    pending.id          = ++presses;
+    pending.event_ticks = event_ticks;
+}
+
+void LatencyProbe::Stamp(LatencyMark& mark)
+{
+    mark           = pending;
+    mark.is_active = is_enabled;
+    mark.is_lit    = is_lit;
+    pending.id     = 0;
+}
+
+void LatencyProbe::Collect()
+{
+    std::lock_guard lock{ finished_mutex };
+    for (const Sample& sample : finished)
+    {
+        if (!is_enabled)
+            break;
+        const double to_swap = ticks_to_ms(sample.event, sample.swap);
+        const double to_gpu  = sample.gpu != 0 ? ticks_to_ms(sample.event, sample.gpu) : 0.0;
+        submit_sum += ticks_to_ms(sample.event, sample.submit);
+        swap_sum += to_swap;
+        if (sample.gpu != 0)
+        {
+            gpu_sum += to_gpu;
+            ++gpu_count;
+        }
+        const double latest = sample.gpu != 0 ? to_gpu : to_swap;
+        ++histogram[static_cast<std::size_t>(std::min(static_cast<int>(latest / BUCKET_MS), BUCKET_COUNT))];
+        samples.push_back(sample);
+    }
+    finished.clear();
+}
+
+void LatencyProbe::DrawImGui()
+{
+    bool enabled = is_enabled;
+    if (ImGui::Checkbox("latency probe (F8, then any key flips the screen)", &enabled))
+        SetEnabled(enabled);
+    if (!is_enabled || samples.empty())
+        return;
+    const int    count = static_cast<int>(samples.size());
+    const double n     = static_cast<double>(count);
+    ImGui::Text("%d presses, mean %.1f ms to submit, %.1f ms to swap", count, submit_sum / n, swap_sum / n);
+    if (gpu_count > 0)
+        ImGui::Text("mean %.1f ms to the GPU over %d with a timestamp", gpu_sum / static_cast<double>(gpu_count), gpu_count);
+    ImGui::Text("%s p50 %.0f ms, p95 %.0f ms, p99 %.0f ms", gpu_count > 0 ? "to the GPU:" : "to swap:", percentile(histogram, count, 0.5), percentile(histogram, count, 0.95),
+                percentile(histogram, count, 0.99));
+    std::array<float, BUCKET_COUNT + 1> counts{};
+    std::transform(histogram.begin(), histogram.end(), counts.begin(), [](int bucket) { return static_cast<float>(bucket); });
+    ImGui::PlotHistogram("##latency", counts.data(), static_cast<int>(counts.size()), 0, "1 ms buckets", 0.0f, std::numeric_limits<float>::max(), ImVec2(0.0f, 60.0f));
+}
+
+void LatencyProbe::DrawPatch(const LatencyMark& mark, glm::ivec2 viewport_size)
+{
+    if (!mark.is_active)
+        return;
+    const float shade = mark.is_lit ? 1.0f : 0.0f;
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    gl_state::SetEnabled(GL_SCISSOR_TEST, true);
+    glScissor(0, 0, std::min(PATCH_SIZE, viewport_size.x), std::min(PATCH_SIZE, viewport_size.y));
+    gl_state::ClearColor(shade, shade, shade, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    gl_state::SetEnabled(GL_SCISSOR_TEST, false);
+}
+
+void LatencyProbe::Swapped(const LatencyMark& mark)
+{
+    if (!is_probed)
+    {
+        is_probed = true;
+#if !defined(IS_WEBGL2)
+        GLint bits = 0;
+        if (GLEW_VERSION_3_3 || GLEW_ARB_timer_query)
+            glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+        has_timestamps = bits > 0;
+#endif
+    }
+    const Uint64 now = SDL_GetPerformanceCounter();
+    if (has_timestamps)
+    {
+#if !defined(IS_WEBGL2)
+        for (PendingQuery& pending_query : queries)
+        {
+            GLint available = GL_FALSE;
+            if (pending_query.is_waiting)
+                glGetQueryObjectiv(pending_query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available == GL_FALSE)
+                continue;
+            GLint64 gpu_time = 0;
+            glGetQueryObjecti64v(pending_query.query, GL_QUERY_RESULT, &gpu_time);
+            const double since_ns    = static_cast<double>(gpu_time - pending_query.gpu_at);
+            const double since_ticks = since_ns * 1e-9 * static_cast<double>(SDL_GetPerformanceFrequency());
+            pending_query.sample.gpu = static_cast<Uint64>(std::max(static_cast<double>(pending_query.cpu_at) + since_ticks, 1.0));
+            pending_query.is_waiting = false;
+            finish(pending_query.sample);
+        }
+#endif
+    }
+    if (!mark.is_active || mark.id == 0)
+        return;
+    const Sample sample{ mark.id, mark.event_ticks, mark.submit_ticks, now, 0 };
+#if !defined(IS_WEBGL2)
+    const auto free_query = std::find_if(queries.begin(), queries.end(), [](const PendingQuery& entry) { return !entry.is_waiting; });
+    if (has_timestamps && free_query != queries.end())
+    {
+        if (free_query->query == 0)
+            glGenQueries(1, &free_query->query);
+        glGetInteger64v(GL_TIMESTAMP, &free_query->gpu_at);
+        free_query->cpu_at = SDL_GetPerformanceCounter();
+        glQueryCounter(free_query->query, GL_TIMESTAMP);
+        free_query->sample     = sample;
+        free_query->is_waiting = true;
+        return;
+    }
+#endif
+    finish(sample);
+}
+
+void LatencyProbe::Shutdown()
+{
+    SetEnabled(false);
+    for (PendingQuery& pending_query : queries)
+    {
+        if (pending_query.query != 0)
+            glDeleteQueries(1, &pending_query.query);
+        pending_query = PendingQuery{};
+    }
+    is_probed      = false;
+    has_timestamps = false;
+}
+
+void LatencyProbe::finish(const Sample& sample)
+{
+    std::lock_guard lock{ finished_mutex };
+    finished.push_back(sample);
+}
+
+void LatencyProbe::writeCsv() const
+{
+    std::ofstream out{ CSV_FILE };
+    if (!out)
+    {
+        LOG_WARN("Can't write ", CSV_FILE);
+        return;
+    }
+    // milliseconds from the run's first press, so the rows line up with a recording started about then
+    const Uint64 origin = samples.front().event;
+    out << "press,event_ms,submit_ms,swap_ms,gpu_ms\n";
+    for (const Sample& sample : samples)
+    {
+        out << sample.id << ',' << ticks_to_ms(origin, sample.event) << ',' << ticks_to_ms(origin, sample.submit) << ',' << ticks_to_ms(origin, sample.swap) << ',';
+        if (sample.gpu != 0)
+            out << ticks_to_ms(origin, sample.gpu);
+        out << '\n';
+    }
+    LOG_INFO("Latency of ", samples.size(), " presses written to ", std::filesystem::absolute(CSV_FILE).string());
+}
@@ -0,0 +1,117 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <SDL_stdinc.h>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <glm/vec2.hpp>
+#include <mutex>
+#include <vector>
+
+// What a frame carries of the probe: whether it is lit, and the key press it is the first to show
+struct LatencyMark
+{
+    std::uint64_t id           = 0;     // 0 when no press landed since the previous frame
+    Uint64        event_ticks  = 0;     // SDL_GetPerformanceCounter when SDL queued the press
+    Uint64        submit_ticks = 0;     // as the frame went to the render side
+    bool          is_active    = false; // the probe is on, so the corner patch is drawn
+    bool          is_lit       = false; // flipped by each press; the clear color and the patch show it
+};
+
+/**
+ * Measures key press to display latency.
+ *
+ * While it is on, every key press flips the frame's clear color and a PATCH_SIZE square in the bottom-left
+ * corner between black and white, for a photodiode to watch. The press is stamped when SDL queued it, the
+ * frame that first shows it when it goes to the render side and again when its swap returns; where the
+ * context has GL_TIMESTAMP a query after the swap tells when the GPU got there, read back frames later and
+ * moved onto the CPU clock with a glGetInteger64v(GL_TIMESTAMP) taken next to it. Each press ends up in a
+ * histogram of the latest stage it has, in BUCKET_MS buckets up to BUCKET_COUNT with one more for everything
+ * slower, and turning the probe off writes every press's stamps to CSV_FILE in the working directory, to line
+ * up with a photodiode's recording.
+ *
+ * KeyPressed, Stamp, Collect and DrawImGui are the main thread's; DrawPatch and Swapped the render side's.
+ */
+class LatencyProbe
+{
+public:
+    static constexpr int         PATCH_SIZE   = 64;
+    static constexpr int         BUCKET_COUNT = 100;
+    static constexpr double      BUCKET_MS    = 1.0;
+    static constexpr int         MAX_QUERIES  = 8; // presses waiting on their GPU timestamp; more are kept without
+    static constexpr const char* CSV_FILE     = "latency.csv";
+
+    struct Sample
+    {
+        std::uint64_t id     = 0;
+        Uint64        event  = 0;
+        Uint64        submit = 0;
+        Uint64        swap   = 0;
+        Uint64        gpu    = 0; // 0 without GL_TIMESTAMP
+    };
+
+    LatencyProbe() = default;
+
+    LatencyProbe(const LatencyProbe&)                = delete;
+    LatencyProbe& operator=(const LatencyProbe&)     = delete;
+    LatencyProbe(LatencyProbe&&) noexcept            = delete;
+    LatencyProbe& operator=(LatencyProbe&&) noexcept = delete;
+
+    // Turning it off writes CSV_FILE if there were presses
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const noexcept;
+    // `event_ticks` on the SDL_GetPerformanceCounter clock
+    void KeyPressed(Uint64 event_ticks);
+    // Before the frame is drawn; submit_ticks is the caller's
+    void Stamp(LatencyMark& mark);
+    // Once a frame: moves what the render side finished into the histogram
+    void Collect();
+    // Checkbox, stages and histogram for the caller's current window
+    void DrawImGui();
+
+    // The corner patch onto the default framebuffer, after everything else
+    void DrawPatch(const LatencyMark& mark, glm::ivec2 viewport_size);
+    // Right after SDL_GL_SwapWindow; also reads back earlier timestamps that are done
+    void Swapped(const LatencyMark& mark);
+    // Deletes the queries, with the render side's context current and the render thread stopped
+    void Shutdown();
+
+private:
+    struct PendingQuery
+    {
+        GLuint  query      = 0;
+        Sample  sample;
+        Uint64  cpu_at     = 0; // SDL_GetPerformanceCounter and glGetInteger64v(GL_TIMESTAMP) at the same moment
+        GLint64 gpu_at     = 0;
+        bool    is_waiting = false;
+    };
+
+    // render side
+    void finish(const Sample& sample);
+    void writeCsv() const;
+
+private:
+    bool                                  is_enabled = false;
+    bool                                  is_lit     = false;
+    std::uint64_t                         presses    = 0;
+    LatencyMark                           pending; // the latest press no frame has shown yet
+    std::vector<Sample>                   samples; // this run's, for the CSV
+    std::array<int, BUCKET_COUNT + 1>     histogram{};
+    double                                submit_sum = 0.0;
+    double                                swap_sum   = 0.0;
+    double                                gpu_sum    = 0.0;
+    int                                   gpu_count  = 0;
+    std::array<PendingQuery, MAX_QUERIES> queries{}; // the render side's
+    bool                                  has_timestamps = false;
+    bool                                  is_probed      = false; // whether has_timestamps was looked up
+    std::mutex                            finished_mutex;
+    std::vector<Sample>                   finished; // the render side's, until Collect
+};
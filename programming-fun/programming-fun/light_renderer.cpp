@@ -0,0 +1,385 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "light_renderer.h"
+
+#include "gl_extensions.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "gpu_profiler.h"
+#include "memory_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/packing.hpp>
+
+namespace
+{
+    // units: the tile grid, the entries and the lights while shading; the scene and the light buffer while compositing
+    constexpr GLuint TILE_UNIT  = 0;
+    constexpr GLuint INDEX_UNIT = 1;
+    constexpr GLuint LIGHT_UNIT = 2;
+
+    constexpr GLsizei TEXTURE_WIDTH = 2048; // texels of the entry and light textures, the least GL_MAX_TEXTURE_SIZE there is
+
+    constexpr const char* FULLSCREEN_VERTEX_SHADER = R"(
+void main()
+{
+    // one triangle covering the screen: (-1,-1) (3,-1) (-1,3)
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    // TILE_SIZE and TEXTURE_WIDTH as above; a pixel only visits its own tile's entries
+    constexpr const char* SHADE_FRAGMENT_SHADER = R"(
+#ifdef GL_ES
+precision highp usampler2D;
+#endif
+
+uniform usampler2D uTiles;
+uniform usampler2D uIndices;
+uniform sampler2D  uLights;
+uniform vec3       uAmbient;
+
+out vec4 fragColor;
+
+const int TILE_SIZE     = 16;
+const int TEXTURE_WIDTH = 2048;
+
+ivec2 texel(int index)
+{
+    return ivec2(index % TEXTURE_WIDTH, index / TEXTURE_WIDTH);
+}
+
+void main()
+{
+    uvec2 tile  = texelFetch(uTiles, ivec2(gl_FragCoord.xy) / TILE_SIZE, 0).xy;
+    int   first = int(tile.x);
+    vec3  light = uAmbient;
+    for (int entry = first; entry < first + int(tile.y); ++entry)
+    {
+        int   number  = int(texelFetch(uIndices, texel(entry), 0).r);
+        vec4  shape   = texelFetch(uLights, texel(number * 2), 0);
+        vec2  to      = gl_FragCoord.xy - shape.xy;
+        float falloff = max(1.0 - dot(to, to) * shape.w, 0.0);
+        if (falloff > 0.0)
+            light += texelFetch(uLights, texel(number * 2 + 1), 0).rgb * (falloff * falloff);
+    }
+    fragColor = vec4(light, 1.0);
+}
+)";
+
+    // the scene is display encoded, close enough to the square root of linear that lighting the square and taking
+    // the root back is multiplying by the light's root
+    constexpr const char* COMPOSITE_FRAGMENT_SHADER = R"(
+uniform sampler2D uScene;
+uniform sampler2D uLight;
+
+out vec4 fragColor;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec3  scene = texelFetch(uScene, pixel, 0).rgb;
+    vec3  light = texelFetch(uLight, pixel, 0).rgb;
+    fragColor   = vec4(scene * sqrt(light), 1.0);
+}
+)";
+
+    std::size_t row_bytes(std::size_t texel_bytes) noexcept
+    {
+        return static_cast<std::size_t>(TEXTURE_WIDTH) * texel_bytes;
+    }
+
+    std::size_t tile_texture_bytes(glm::ivec2 size) noexcept
+    {
+        return static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y) * sizeof(glm::uvec2);
+    }
+
+    // With the texture bound: `count` texels into rows of TEXTURE_WIDTH, growing it to at least the rows they fill
+    std::size_t upload_rows(GLenum internal_format, GLenum format, GLenum type, std::size_t texel_bytes, const void* texels, std::size_t count, int& rows)
+    {
+        const int needed = static_cast<int>((count + TEXTURE_WIDTH - 1) / TEXTURE_WIDTH);
+        if (rows == 0 || needed > rows)
+        {
+            if (rows > 0)
+                memory_tracker::Free(MemoryCategory::Textures, row_bytes(texel_bytes) * static_cast<std::size_t>(rows));
+            rows = std::max({ needed, rows * 2, 1 });
+            glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internal_format), TEXTURE_WIDTH, rows, 0, format, type, nullptr);
+            memory_tracker::Allocate(MemoryCategory::Textures, row_bytes(texel_bytes) * static_cast<std::size_t>(rows));
+        }
+        // whole rows, then what is left of the last one; the source isn't padded
+        const auto  full_rows = static_cast<GLsizei>(count / TEXTURE_WIDTH);
+        const auto  rest      = static_cast<GLsizei>(count % TEXTURE_WIDTH);
+        const auto* bytes     = static_cast<const unsigned char*>(texels);
+        if (full_rows > 0)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEXTURE_WIDTH, full_rows, format, type, bytes);
+        if (rest > 0)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, full_rows, rest, 1, format, type, bytes + static_cast<std::size_t>(full_rows) * row_bytes(texel_bytes));
+        return count * texel_bytes;
+    }
+
+    // Calls `visit` with the index of every tile the circle overlaps; false when that is none
+    template <typename Visit>
+    bool for_each_tile(glm::vec2 center, float radius, glm::ivec2 tile_counts, Visit&& visit)
+    {
+        constexpr float TILE = static_cast<float>(LightRenderer::TILE_SIZE);
+        const glm::vec2 end  = glm::vec2{ tile_counts } * TILE;
+        if (!(radius > 0.0f) || center.x + radius <= 0.0f || center.y + radius <= 0.0f || center.x - radius >= end.x || center.y - radius >= end.y)
+            return false;
+        // clamped as floats, so a light far off screen doesn't overflow the conversion
+        const glm::ivec2 first          = glm::ivec2{ glm::max(glm::floor((center - radius) / TILE), 0.0f) };
+        const glm::ivec2 last           = glm::ivec2{ glm::min(glm::floor((center + radius) / TILE), glm::vec2{ tile_counts - 1 }) };
+        const float      radius_squared = radius * radius;
+        bool             is_touching    = false;
+        for (int y = first.y; y <= last.y; ++y)
+        {
+            for (int x = first.x; x <= last.x; ++x)
+            {
+                // the rectangle's corner tiles are often outside the circle
+                const glm::vec2 low     = glm::vec2{ static_cast<float>(x), static_cast<float>(y) } * TILE;
+                const glm::vec2 nearest = glm::clamp(center, low, low + TILE);
+                const glm::vec2 to      = nearest - center;
+                if (glm::dot(to, to) >= radius_squared)
+                    continue;
+                visit(static_cast<std::size_t>(y) * static_cast<std::size_t>(tile_counts.x) + static_cast<std::size_t>(x));
+                is_touching = true;
+            }
+        }
+        return is_touching;
+    }
+}
+
+void bin_lights(std::span<const PointLight> lights, const glm::mat4& projection, glm::ivec2 scene_size, LightBins& bins)
+{
+    bins.scene_size  = glm::max(scene_size, glm::ivec2{ 0 });
+    bins.tile_counts = (bins.scene_size + (LightRenderer::TILE_SIZE - 1)) / LightRenderer::TILE_SIZE;
+    bins.culled      = 0;
+    bins.lights.clear();
+    bins.indices.clear();
+    bins.tiles.assign(static_cast<std::size_t>(bins.tile_counts.x) * static_cast<std::size_t>(bins.tile_counts.y), glm::uvec2{ 0u });
+    if (bins.tiles.empty())
+        return;
+
+    // first pass: each light counted into its tiles, which the second visits again exactly, its circle kept as it was
+    const glm::vec2 half_size = glm::vec2{ bins.scene_size } * 0.5f;
+    const float     to_pixels = std::max(std::abs(projection[0][0]) * half_size.x, std::abs(projection[1][1]) * half_size.y);
+    bins.lights.reserve(lights.size() * 2);
+    for (const PointLight& light : lights)
+    {
+        const glm::vec4 clip   = projection * glm::vec4{ light.position, 0.0f, 1.0f };
+        const glm::vec2 center = (glm::vec2{ clip } / clip.w + 1.0f) * half_size;
+        const float     radius = light.radius * to_pixels;
+        if (!for_each_tile(center, radius, bins.tile_counts, [&bins](std::size_t tile) { ++bins.tiles[tile].y; }))
+        {
+            ++bins.culled;
+            continue;
+        }
+        const glm::vec4 color = glm::unpackUnorm4x8(light.color);
+        bins.lights.push_back(glm::vec4{ center, radius, 1.0f / (radius * radius) });
+        bins.lights.push_back(glm::vec4{ glm::vec3{ color } * glm::vec3{ color } * light.intensity, 0.0f });
+    }
+
+    std::uint32_t entries = 0;
+    for (glm::uvec2& tile : bins.tiles)
+    {
+        tile.x = entries;
+        entries += tile.y;
+        tile.y = 0;
+    }
+    bins.indices.resize(entries);
+    for (std::size_t i = 0; i < bins.lights.size(); i += 2)
+    {
+        const glm::vec4     shape  = bins.lights[i];
+        const std::uint32_t number = static_cast<std::uint32_t>(i / 2);
+        for_each_tile(glm::vec2{ shape }, shape.z, bins.tile_counts, [&bins, number](std::size_t tile) {
+            glm::uvec2& entry                 = bins.tiles[tile];
+            bins.indices[entry.x + entry.y++] = number;
+        });
+    }
+}
+
+void LightRenderer::Setup()
+{
+    shade_program.Request(FULLSCREEN_VERTEX_SHADER, SHADE_FRAGMENT_SHADER);
+    composite_program.Request(FULLSCREEN_VERTEX_SHADER, COMPOSITE_FRAGMENT_SHADER);
+    glGenVertexArrays(1, &vertex_array);
+    glGenTextures(1, &tile_texture);
+    glGenTextures(1, &index_texture);
+    glGenTextures(1, &light_texture);
+    for (const GLuint texture : { tile_texture, index_texture, light_texture })
+    {
+        gl_state::BindTexture(texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+    // like bloom's targets: without the extension the light buffer clips at 1 and overlaps stop adding up
+#if defined(IS_WEBGL2)
+    light_format = has_gl_extension("GL_EXT_color_buffer_float") ? GL_RGBA16F : GL_RGBA8;
+#else
+    light_format = GL_RGBA16F;
+#endif
+}
+
+void LightRenderer::Shutdown()
+{
+    gl_state::DeleteVertexArray(vertex_array);
+    for (const GLuint texture : { tile_texture, index_texture, light_texture })
+        gl_state::DeleteTexture(texture);
+    if (tile_texture_size.x > 0)
+        memory_tracker::Free(MemoryCategory::Textures, tile_texture_bytes(tile_texture_size));
+    if (index_rows > 0)
+        memory_tracker::Free(MemoryCategory::Textures, row_bytes(sizeof(std::uint32_t)) * static_cast<std::size_t>(index_rows));
+    if (light_rows > 0)
+        memory_tracker::Free(MemoryCategory::Textures, row_bytes(sizeof(glm::vec4)) * static_cast<std::size_t>(light_rows));
+    shade_program.Reset();
+    composite_program.Reset();
+    vertex_array      = 0;
+    tile_texture      = 0;
+    index_texture     = 0;
+    light_texture     = 0;
+    tile_texture_size = glm::ivec2{ 0 };
+    index_rows        = 0;
+    light_rows        = 0;
+}
+
+RenderGraph::Resource LightRenderer::AddPasses(RenderGraph& graph, RenderGraph::Resource scene, const LightBins& bins)
+{
+    stats                            = Stats{};
+    const ColorSurface scene_surface = graph.Surface(scene);
+    // bins made for another size would light the wrong tiles
+    if (bins.tiles.empty() || scene_surface.framebuffer == 0 || scene_surface.size != bins.scene_size)
+        return scene;
+    stats.lights  = static_cast<int>(bins.lights.size() / 2);
+    stats.culled  = bins.culled;
+    stats.tiles   = static_cast<int>(bins.tiles.size());
+    stats.entries = static_cast<int>(bins.indices.size());
+    for (const glm::uvec2& tile : bins.tiles)
+    {
+        stats.occupied_tiles += tile.y > 0 ? 1 : 0;
+        stats.max_per_tile   = std::max(stats.max_per_tile, static_cast<int>(tile.y));
+    }
+    const bool is_shade_ready     = isShadeReady();
+    const bool is_composite_ready = isCompositeReady();
+    stats.pending                 = !is_shade_ready || !is_composite_ready;
+    if (stats.pending)
+        return scene;
+
+    const RenderGraph::Resource light_buffer = graph.Create("light buffer", scene_surface.size, light_format);
+    const RenderGraph::Resource lit          = graph.Create("lit scene", scene_surface.size, GL_RGBA8);
+    graph
+        .AddPass("Light Tiles",
+                 [this, light_buffer, &bins](const RenderGraph& frame_graph) {
+                     const ColorSurface target = frame_graph.Surface(light_buffer);
+                     if (target.framebuffer == 0)
+                         return;
+                     PROFILE_GPU_ZONE("Light Tiles");
+                     GL_STATS_PASS("Lighting");
+                     upload(bins);
+                     gl_state::UseProgram(shade_program.Id());
+                     glUniform3f(ambient_location, bins.ambient.r, bins.ambient.g, bins.ambient.b);
+                     drawInto(target);
+                     gl_stats::CountDraw(1);
+                 })
+        .Write(light_buffer);
+    graph
+        .AddPass("Light Composite",
+                 [this, scene, light_buffer, lit](const RenderGraph& frame_graph) {
+                     const ColorSurface source = frame_graph.Surface(scene);
+                     const ColorSurface light  = frame_graph.Surface(light_buffer);
+                     const ColorSurface target = frame_graph.Surface(lit);
+                     if (target.framebuffer == 0)
+                         return;
+                     PROFILE_GPU_ZONE("Light Composite");
+                     GL_STATS_PASS("Lighting");
+                     gl_state::UseProgram(composite_program.Id());
+                     gl_state::ActiveTexture(1);
+                     gl_state::BindTexture(light.texture);
+                     gl_state::ActiveTexture(0);
+                     gl_state::BindTexture(source.texture);
+                     drawInto(target);
+                     gl_stats::CountDraw(1);
+                 })
+        .Read(scene)
+        .Read(light_buffer)
+        .Write(lit);
+    return lit;
+}
+
+const LightRenderer::Stats& LightRenderer::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+bool LightRenderer::isShadeReady()
+{
+    if (shade_program.IsReady())
+        return true;
+    if (!shade_program.Poll())
+        return false;
+    const GLuint id  = shade_program.Id();
+    ambient_location = glGetUniformLocation(id, "uAmbient");
+    gl_state::UseProgram(id);
+    glUniform1i(glGetUniformLocation(id, "uTiles"), static_cast<GLint>(TILE_UNIT));
+    glUniform1i(glGetUniformLocation(id, "uIndices"), static_cast<GLint>(INDEX_UNIT));
+    glUniform1i(glGetUniformLocation(id, "uLights"), static_cast<GLint>(LIGHT_UNIT));
+    return true;
+}
+
+bool LightRenderer::isCompositeReady()
+{
+    if (composite_program.IsReady())
+        return true;
+    if (!composite_program.Poll())
+        return false;
+    const GLuint id = composite_program.Id();
+    gl_state::UseProgram(id);
+    glUniform1i(glGetUniformLocation(id, "uScene"), 0);
+    glUniform1i(glGetUniformLocation(id, "uLight"), 1);
+    return true;
+}
+
+void LightRenderer::upload(const LightBins& bins)
+{
+    gl_state::ActiveTexture(TILE_UNIT);
+    gl_state::BindTexture(tile_texture);
+    if (bins.tile_counts != tile_texture_size)
+    {
+        if (tile_texture_size.x > 0)
+            memory_tracker::Free(MemoryCategory::Textures, tile_texture_bytes(tile_texture_size));
+        tile_texture_size = bins.tile_counts;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, tile_texture_size.x, tile_texture_size.y, 0, GL_RG_INTEGER, GL_UNSIGNED_INT, bins.tiles.data());
+        memory_tracker::Allocate(MemoryCategory::Textures, tile_texture_bytes(tile_texture_size));
+    }
+    else
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tile_texture_size.x, tile_texture_size.y, GL_RG_INTEGER, GL_UNSIGNED_INT, bins.tiles.data());
+    }
+    stats.upload_size = tile_texture_bytes(tile_texture_size);
+
+    gl_state::ActiveTexture(INDEX_UNIT);
+    gl_state::BindTexture(index_texture);
+    stats.upload_size += upload_rows(GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, sizeof(std::uint32_t), bins.indices.data(), bins.indices.size(), index_rows);
+    gl_state::ActiveTexture(LIGHT_UNIT);
+    gl_state::BindTexture(light_texture);
+    stats.upload_size += upload_rows(GL_RGBA32F, GL_RGBA, GL_FLOAT, sizeof(glm::vec4), bins.lights.data(), bins.lights.size(), light_rows);
+    gl_stats::CountUpload(stats.upload_size);
+    gl_state::ActiveTexture(0);
+}
+
+void LightRenderer::drawInto(const ColorSurface& target)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    gl_state::Viewport(0, 0, target.size.x, target.size.y);
+    gl_state::SetEnabled(GL_BLEND, false);
+    gl_state::BindVertexArray(vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
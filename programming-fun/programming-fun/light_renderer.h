@@ -0,0 +1,121 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "render_graph.h"
+#include "render_target.h"
+#include "shader.h"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+struct PointLight
+{
+    glm::vec2     position{ 0.0f };        // in the projection's units, like the sprites
+    float         radius    = 64.0f;       // where it has faded to nothing
+    float         intensity = 1.0f;        // past 1 it overexposes what it lights
+    std::uint32_t color     = 0xFFFFFFFFu; // pack_rgba8, alpha unused
+};
+
+/**
+ * A frame's lights sorted into LightRenderer::TILE_SIZE pixel tiles of the scene, which is all the shading needs.
+ *
+ * Tiles count from the bottom left like GL's pixels. Each tile has the first of its entries in `indices` and how
+ * many there are; the entries of one tile are together, the lights they index in `lights`. Recorded on the main
+ * thread by bin_lights into the frame's arena and uploaded as it is by LightRenderer.
+ */
+struct LightBins
+{
+    explicit LightBins(std::pmr::memory_resource* arena) : lights{ arena }, tiles{ arena }, indices{ arena }
+    {
+    }
+
+    glm::ivec2                      scene_size{ 0 }; // what the tiles cover, 0 for an unlit frame
+    glm::ivec2                      tile_counts{ 0 };
+    glm::vec3                       ambient{ 1.0f }; // what every pixel gets before any light
+    std::pmr::vector<glm::vec4>     lights;          // two texels each: x, y and 1 / radius^2 in scene pixels, then linear color times intensity
+    std::pmr::vector<glm::uvec2>    tiles;           // first entry and entry count, by tile
+    std::pmr::vector<std::uint32_t> indices;         // light numbers; light n is texels 2n and 2n + 1 of `lights`
+    int                             culled = 0;      // lights that touched no tile
+};
+
+// Replaces what `bins` held with `lights` projected into a scene of `scene_size` pixels: a counting sort, each light
+// counted into the tiles its circle reaches, then written into them, so the work is the entries and not lights times tiles
+void bin_lights(std::span<const PointLight> lights, const glm::mat4& projection, glm::ivec2 scene_size, LightBins& bins);
+
+/**
+ * 2D point lights over the scene, shaded per tile so a pixel only loops over the lights that can reach it.
+ *
+ * The bins go up as three textures read with texelFetch, so WebGL 2 runs the same shader: the tile grid, the
+ * entries and the lights. A fullscreen pass into an offscreen light buffer adds up the ambient and the tile's
+ * lights with a smooth quadratic falloff, half float where the context can render to it so bright overlaps don't
+ * clip; a second pass multiplies the scene by it, in linear, into the target that goes on to post processing and
+ * the upscale. Thousands of small lights cost what their overlap does, not their count times the pixels.
+ *
+ * AddPasses returns the scene itself when the frame has no bins or a program is still compiling. GL thread only.
+ */
+class LightRenderer
+{
+public:
+    static constexpr int TILE_SIZE = 16; // pixels on a side
+
+    struct Stats
+    {
+        int         lights         = 0; // binned, those off screen excluded
+        int         culled         = 0;
+        int         tiles          = 0;
+        int         occupied_tiles = 0; // with at least one light
+        int         max_per_tile   = 0;
+        int         entries        = 0; // lights summed over the tiles
+        std::size_t upload_size    = 0;
+        bool        pending        = false; // a program is still compiling, so the scene went on unlit
+    };
+
+    LightRenderer() = default;
+
+    LightRenderer(const LightRenderer&)                = delete;
+    LightRenderer& operator=(const LightRenderer&)     = delete;
+    LightRenderer(LightRenderer&&) noexcept            = delete;
+    LightRenderer& operator=(LightRenderer&&) noexcept = delete;
+
+    void Setup();
+    void Shutdown();
+
+    // `bins` has to last until the graph has run
+    RenderGraph::Resource AddPasses(RenderGraph& graph, RenderGraph::Resource scene, const LightBins& bins);
+
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    bool isShadeReady();
+    bool isCompositeReady();
+    void upload(const LightBins& bins);
+    void drawInto(const ColorSurface& target);
+
+private:
+    ShaderProgram shade_program;
+    ShaderProgram composite_program;
+    GLint         ambient_location = -1;
+    GLuint        vertex_array     = 0;
+    GLuint        tile_texture     = 0;
+    GLuint        index_texture    = 0;
+    GLuint        light_texture    = 0;
+    glm::ivec2    tile_texture_size{ 0 };
+    int           index_rows   = 0;
+    int           light_rows   = 0;
+    GLenum        light_format = GL_RGBA8;
+    Stats         stats;
+};
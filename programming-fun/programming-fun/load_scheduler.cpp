@@ -0,0 +1,320 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "load_scheduler.h"
+
+#include "asset_fetch.h"
+#include "async_file_reader.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+namespace
+{
+    // set while this thread is in pump, so a job the pool runs inline doesn't pump again under it
+    thread_local bool is_pumping = false;
+}
+
+struct LoadScheduler::State
+{
+    struct Queued
+    {
+        Ticket                ticket = 0;
+        Job                   job;
+        bool                  is_fetched = true; // downloaded and read, when there is a fetcher and a reader
+        std::filesystem::path fetching;          // the first candidate, which names the fetch or read to promote
+        std::filesystem::path read;              // what the reader holds for the job, dropped once it ran
+    };
+
+    WorkerPool*        workers = nullptr;
+    AssetFetcher*      fetcher = nullptr; // main thread only, like the fetches
+    AsyncFileReader*   reader  = nullptr;
+    mutable std::mutex mutex;
+    int                max_in_flight = 1;
+    int                in_flight     = 0;
+    Ticket             next_ticket   = 1;
+    bool               is_closed     = false; // the scheduler is gone, finishing jobs start nothing
+    std::uint64_t      started       = 0;
+    std::uint64_t      cancelled     = 0;
+    std::uint64_t      promoted      = 0;
+
+    std::array<std::deque<Queued>, PRIORITY_COUNT> queues;
+};
+
+LoadScheduler::LoadScheduler(WorkerPool& workers, int max_in_flight) : state{ std::make_shared<State>() }
+{
+    state->workers = &workers;
+    SetMaxInFlight(max_in_flight);
+}
+
+LoadScheduler::~LoadScheduler()
+{
+    Close();
+}
+
+LoadScheduler::Ticket LoadScheduler::Submit(LoadPriority priority, Job job)
+{
+    Ticket ticket = 0;
+    {
+        std::lock_guard lock{ state->mutex };
+        ticket = state->next_ticket++;
+        state->queues[static_cast<std::size_t>(priority)].push_back(State::Queued{ ticket, std::move(job), true, {}, {} });
+    }
+    pump(state);
+    return ticket;
+}
+
+LoadScheduler::Ticket LoadScheduler::Submit(LoadPriority priority, Job job, std::vector<std::filesystem::path> candidates)
+{
+    if ((state->fetcher == nullptr && state->reader == nullptr) || candidates.empty())
+        return Submit(priority, std::move(job));
+    Ticket ticket = 0;
+    {
+        std::lock_guard lock{ state->mutex };
+        ticket = state->next_ticket++;
+        state->queues[static_cast<std::size_t>(priority)].push_back(State::Queued{ ticket, std::move(job), false, candidates.front(), {} });
+    }
+    if (state->fetcher == nullptr)
+    {
+        read_ahead(state, ticket, std::move(candidates), priority);
+        return ticket;
+    }
+    // a missing file still lets the job run, it fails the way it would on disk; read at the priority it has by then
+    state->fetcher->Fetch(candidates, priority,
+                          [state = state, ticket, candidates](bool)
+                          {
+                              LoadPriority now = LoadPriority::Count;
+                              {
+                                  std::lock_guard lock{ state->mutex };
+                                  for (std::size_t i = 0; i < PRIORITY_COUNT; ++i)
+                                  {
+                                      if (std::any_of(state->queues[i].begin(), state->queues[i].end(), [ticket](const State::Queued& entry) { return entry.ticket == ticket; }))
+                                          now = static_cast<LoadPriority>(i);
+                                  }
+                              }
+                              if (now != LoadPriority::Count)
+                                  read_ahead(state, ticket, candidates, now);
+                          });
+    return ticket;
+}
+
+bool LoadScheduler::Promote(Ticket ticket, LoadPriority priority)
+{
+    std::filesystem::path fetching; // still downloading, so the fetch moves up too
+    {
+        std::lock_guard lock{ state->mutex };
+        const auto      target = static_cast<std::size_t>(priority);
+        bool            moved  = false;
+        for (std::size_t i = target + 1; i < PRIORITY_COUNT && !moved; ++i)
+        {
+            auto&      queue = state->queues[i];
+            const auto found = std::find_if(queue.begin(), queue.end(), [ticket](const State::Queued& entry) { return entry.ticket == ticket; });
+            if (found == queue.end())
+                continue;
+            if (!found->is_fetched)
+                fetching = found->fetching;
+            state->queues[target].push_back(std::move(*found));
+            queue.erase(found);
+            ++state->promoted;
+            moved = true;
+        }
+        if (!moved)
+            return false;
+    }
+    if (!fetching.empty() && state->fetcher != nullptr)
+        state->fetcher->Promote(fetching, priority);
+    if (!fetching.empty() && state->reader != nullptr)
+        state->reader->Promote(fetching, priority);
+    // promoted to Immediate, it starts whatever the limit says
+    pump(state);
+    return true;
+}
+
+bool LoadScheduler::Cancel(Ticket ticket)
+{
+    // the job's captures and what the reader holds for it are released outside the lock
+    Job                   dropped;
+    std::filesystem::path read;
+    bool                  is_cancelled = false;
+    {
+        std::lock_guard lock{ state->mutex };
+        for (auto& queue : state->queues)
+        {
+            const auto found = std::find_if(queue.begin(), queue.end(), [ticket](const State::Queued& entry) { return entry.ticket == ticket; });
+            if (found == queue.end())
+                continue;
+            dropped = std::move(found->job);
+            read    = std::move(found->read);
+            queue.erase(found);
+            ++state->cancelled;
+            is_cancelled = true;
+            break;
+        }
+    }
+    if (!read.empty())
+        state->reader->Discard(read);
+    return is_cancelled;
+}
+
+void LoadScheduler::Close()
+{
+    // queued jobs never start; their captures are released outside the lock
+    std::array<std::deque<State::Queued>, PRIORITY_COUNT> dropped;
+    std::lock_guard                                       lock{ state->mutex };
+    state->is_closed = true;
+    dropped.swap(state->queues);
+}
+
+void LoadScheduler::SetMaxInFlight(int max_in_flight)
+{
+    {
+        std::lock_guard lock{ state->mutex };
+        const int       threads = static_cast<int>(state->workers->ThreadCount());
+        state->max_in_flight    = max_in_flight > 0 ? max_in_flight : std::max(threads - 1, 1);
+    }
+    pump(state);
+}
+
+void LoadScheduler::SetFetcher(AssetFetcher* fetcher) noexcept
+{
+    state->fetcher = fetcher;
+}
+
+void LoadScheduler::SetReader(AsyncFileReader* reader) noexcept
+{
+    state->reader = reader;
+}
+
+int LoadScheduler::MaxInFlight() const
+{
+    std::lock_guard lock{ state->mutex };
+    return state->max_in_flight;
+}
+
+LoadScheduler::Stats LoadScheduler::GetStats() const
+{
+    std::lock_guard lock{ state->mutex };
+    Stats           stats;
+    for (std::size_t i = 0; i < PRIORITY_COUNT; ++i)
+    {
+        stats.queued[i] = static_cast<int>(state->queues[i].size());
+        stats.fetching += static_cast<int>(std::count_if(state->queues[i].begin(), state->queues[i].end(), [](const State::Queued& entry) { return !entry.is_fetched; }));
+    }
+    stats.in_flight = state->in_flight;
+    stats.started   = state->started;
+    stats.cancelled = state->cancelled;
+    stats.promoted  = state->promoted;
+    return stats;
+}
+
+WorkerPool& LoadScheduler::Workers() const noexcept
+{
+    return *state->workers;
+}
+
+AsyncFileReader* LoadScheduler::Reader() const noexcept
+{
+    return state->reader;
+}
+
+const char* LoadScheduler::PriorityName(LoadPriority priority) noexcept
+{
+    switch (priority)
+    {
+        case LoadPriority::Immediate: return "immediate";
+        case LoadPriority::Visible: return "visible";
+        case LoadPriority::Prefetch: return "prefetch";
+        case LoadPriority::Background: return "background";
+        case LoadPriority::Count: break;
+    }
+    return "?";
+}
+
+void LoadScheduler::read_ahead(const std::shared_ptr<State>& state, Ticket ticket, std::vector<std::filesystem::path> candidates, LoadPriority priority)
+{
+    // the job may start now, reading its own files when there is nobody to read them for it
+    const auto ready = [state, ticket](const std::filesystem::path& read)
+    {
+        bool is_queued = false;
+        {
+            std::lock_guard lock{ state->mutex };
+            for (auto& queue : state->queues)
+            {
+                const auto found = std::find_if(queue.begin(), queue.end(), [ticket](const State::Queued& entry) { return entry.ticket == ticket; });
+                if (found == queue.end())
+                    continue;
+                found->is_fetched = true;
+                found->read       = read;
+                is_queued         = true;
+            }
+        }
+        // cancelled while it was read
+        if (!is_queued && !read.empty())
+            state->reader->Discard(read);
+        pump(state);
+    };
+    if (state->reader == nullptr)
+        ready({});
+    else
+        state->reader->Read(std::move(candidates), priority, ready);
+}
+
+void LoadScheduler::pump(const std::shared_ptr<State>& state)
+{
+    if (is_pumping)
+        return;
+    is_pumping = true;
+    for (;;)
+    {
+        Job                   job;
+        std::filesystem::path read;
+        {
+            std::lock_guard lock{ state->mutex };
+            if (state->is_closed)
+                break;
+            // the oldest of the most urgent whose files are here
+            auto queue = state->queues.begin();
+            auto entry = queue->end();
+            for (; queue != state->queues.end(); ++queue)
+            {
+                entry = std::find_if(queue->begin(), queue->end(), [](const State::Queued& queued) { return queued.is_fetched; });
+                if (entry != queue->end())
+                    break;
+            }
+            if (queue == state->queues.end())
+                break;
+            if (queue != state->queues.begin() && state->in_flight >= state->max_in_flight)
+                break;
+            job  = std::move(entry->job);
+            read = std::move(entry->read);
+            queue->erase(entry);
+            ++state->in_flight;
+            ++state->started;
+        }
+        // without threads the pool runs this inline, and the loop takes the next one once it returns
+        state->workers->Submit(
+            [state, job = std::move(job), read = std::move(read)]
+            {
+                job();
+                if (!read.empty())
+                    state->reader->Discard(read);
+                finish(state);
+            });
+    }
+    is_pumping = false;
+}
+
+void LoadScheduler::finish(const std::shared_ptr<State>& state)
+{
+    {
+        std::lock_guard lock{ state->mutex };
+        --state->in_flight;
+    }
+    pump(state);
+}
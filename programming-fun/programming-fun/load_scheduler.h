@@ -0,0 +1,110 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class AssetFetcher;
+class AsyncFileReader;
+class WorkerPool;
+
+// Most urgent first; the loaders upload in this order too
+enum class LoadPriority : std::uint8_t
+{
+    Immediate,  // waited on right now, like a texture a UI window shows; never held back by the limit
+    Visible,    // in view
+    Prefetch,   // near the view, likely wanted next
+    Background, // music and anything else that can wait for all of the above
+    Count
+};
+
+/**
+ * Orders the loaders' decodes ahead of the WorkerPool.
+ *
+ * The pool runs what it is given first come first served, so a long decode queued early holds a worker
+ * that the texture the user is waiting on needs. Loads wait here instead, in one queue per priority, and
+ * only `max_in_flight` of them are on the workers at once, the most urgent and then the oldest first; the
+ * limit also keeps threads free for the frame's own ParallelFor work. Immediate jobs skip the limit.
+ * A queued job can be promoted when something more urgent asks for the same asset, or cancelled once
+ * nobody wants it; a job that started runs to the end.
+ * With an AssetFetcher (the web build), a job submitted with files stays queued until the first of them that
+ * exists has downloaded, fetched at the job's priority; one that is still downloading doesn't hold up the rest.
+ * With an AsyncFileReader it then waits for that file to be read into memory, so the job takes the bytes instead
+ * of holding its worker on the disk; whatever it didn't take is dropped once it ran, or when it is cancelled.
+ *
+ * The queues are shared with the jobs, so a job finishing after the scheduler is gone starts nothing.
+ * Submit, Promote and Cancel are for the main thread; a finishing job starts the next one from its worker.
+ */
+class LoadScheduler
+{
+public:
+    using Job    = std::function<void()>;
+    using Ticket = std::uint64_t; // 0 is never issued
+
+    static constexpr std::size_t PRIORITY_COUNT = static_cast<std::size_t>(LoadPriority::Count);
+
+    struct Stats
+    {
+        std::array<int, PRIORITY_COUNT> queued{}; // by priority
+        int                             fetching  = 0; // of the queued, waiting for their files to download or be read
+        int                             in_flight = 0;
+        std::uint64_t                   started   = 0;
+        std::uint64_t                   cancelled = 0;
+        std::uint64_t                   promoted  = 0;
+    };
+
+    // 0 means all but one of the worker threads, at least one
+    explicit LoadScheduler(WorkerPool& workers, int max_in_flight = 0);
+    ~LoadScheduler();
+
+    LoadScheduler(const LoadScheduler&)                = delete;
+    LoadScheduler& operator=(const LoadScheduler&)     = delete;
+    LoadScheduler(LoadScheduler&&) noexcept            = delete;
+    LoadScheduler& operator=(LoadScheduler&&) noexcept = delete;
+
+    Ticket Submit(LoadPriority priority, Job job);
+    // Same, once the AssetFetcher and the AsyncFileReader have the first of `candidates` that exists; without either, or without candidates, just Submit
+    Ticket Submit(LoadPriority priority, Job job, std::vector<std::filesystem::path> candidates);
+    // Moves a queued job up to `priority`; false once it started or when it is already as urgent
+    bool Promote(Ticket ticket, LoadPriority priority);
+    // Drops a queued job; false once it started, it then finishes as usual
+    bool Cancel(Ticket ticket);
+    // Drops every queued job and starts no more, as the destructor does; the started ones finish as usual
+    void Close();
+
+    // Set before the first Submit; nullptr when the files are all on disk already
+    void  SetFetcher(AssetFetcher* fetcher) noexcept;
+    // Set before the first Submit; nullptr to leave the jobs reading their own files
+    void  SetReader(AsyncFileReader* reader) noexcept;
+    void  SetMaxInFlight(int max_in_flight);
+    int   MaxInFlight() const;
+    Stats GetStats() const;
+    // For a job that splits itself with ParallelFor; the limit counts it once however many threads it takes
+    WorkerPool& Workers() const noexcept;
+    // For a job to take the files read for it; nullptr without a reader
+    AsyncFileReader* Reader() const noexcept;
+
+    static const char* PriorityName(LoadPriority priority) noexcept;
+
+private:
+    struct State;
+
+    // into memory, when there is a reader, and then the job may start
+    static void read_ahead(const std::shared_ptr<State>& state, Ticket ticket, std::vector<std::filesystem::path> candidates, LoadPriority priority);
+    static void pump(const std::shared_ptr<State>& state);
+    static void finish(const std::shared_ptr<State>& state);
+
+private:
+    std::shared_ptr<State> state;
+};
@@ -0,0 +1,54 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "lod_selector.h"
+
+#include <algorithm>
+
+void LodSelector::Select(std::span<const float> level_errors, std::span<const float> pixels_per_unit, std::span<std::uint8_t> out_levels)
+{
+    stats = Stats{};
+    const auto  levels = static_cast<int>(std::min<std::size_t>(level_errors.size(), MAX_LEVELS));
+    const auto  count  = std::min(pixels_per_unit.size(), out_levels.size());
+    const float coarse = settings.threshold * (1.0f - settings.hysteresis);
+    if (current.size() != count)
+        current.assign(count, 0);
+    if (levels == 0)
+        return;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int level = current[i];
+        if (settings.forced >= 0)
+        {
+            level = std::min(settings.forced, levels - 1);
+        }
+        else
+        {
+            const auto pixels = [&](int l) { return level_errors[static_cast<std::size_t>(l)] * pixels_per_unit[i]; };
+            // finer straight away while the current level shows too much, coarser only while the next one is well within
+            while (level > 0 && pixels(level) > settings.threshold)
+                --level;
+            while (level + 1 < levels && pixels(level + 1) <= coarse)
+                ++level;
+        }
+        stats.switches += level != current[i] ? 1 : 0;
+        ++stats.instances[static_cast<std::size_t>(level)];
+        current[i]    = static_cast<std::uint8_t>(level);
+        out_levels[i] = current[i];
+    }
+}
+
+LodSelector::Settings& LodSelector::GetSettings() noexcept
+{
+    return settings;
+}
+
+const LodSelector::Stats& LodSelector::GetStats() const noexcept
+{
+    return stats;
+}
@@ -0,0 +1,54 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * Picks each instance's level of detail by how big its simplification error would look on screen.
+ *
+ * A level's error is how far its surface strays from the full mesh's, in model units, so times an instance's
+ * projected pixels per unit it is the error in pixels; an instance draws the coarsest level within `threshold`
+ * of them. An instance near a switch would flip between two levels as it moves or turns, so it only goes coarser
+ * once that level's error is under `threshold * (1 - hysteresis)`, while a finer one is taken as soon as the current
+ * one goes over. The levels each instance is at are kept by its index, so keep instances in a stable order; a
+ * different count starts them all over at the finest. Main thread.
+ */
+class LodSelector
+{
+public:
+    static constexpr int MAX_LEVELS = 8;
+
+    struct Settings
+    {
+        float threshold  = 1.0f;  // pixels of error allowed
+        float hysteresis = 0.25f; // of the threshold, to go coarser
+        int   forced     = -1;    // every instance at this level instead, -1 for none
+    };
+
+    struct Stats
+    {
+        std::array<int, MAX_LEVELS> instances{};  // by level, in the latest Select
+        int                         switches = 0; // instances whose level changed in it
+    };
+
+    // `level_errors` starts with the finest level's, growing from there; `pixels_per_unit` has one entry per instance,
+    // and `out_levels` gets one too
+    void Select(std::span<const float> level_errors, std::span<const float> pixels_per_unit, std::span<std::uint8_t> out_levels);
+
+    Settings&    GetSettings() noexcept;
+    const Stats& GetStats() const noexcept;
+
+private:
+    Settings                  settings;
+    Stats                     stats;
+    std::vector<std::uint8_t> current; // by instance
+};
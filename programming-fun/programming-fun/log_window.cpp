@@ -0,0 +1,61 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "logger.h"
+
+#include <imgui.h>
+
+namespace
+{
+    ImVec4 level_color(logger::Level level) noexcept
+    {
+        switch (level)
+        {
+            case logger::Level::Debug: return ImVec4{ 0.6f, 0.6f, 0.6f, 1.0f };
+            case logger::Level::Info: return ImVec4{ 0.9f, 0.9f, 0.9f, 1.0f };
+            case logger::Level::Warning: return ImVec4{ 1.0f, 0.8f, 0.3f, 1.0f };
+            case logger::Level::Error: return ImVec4{ 1.0f, 0.4f, 0.4f, 1.0f };
+        }
+        return ImVec4{ 1.0f, 1.0f, 1.0f, 1.0f };
+    }
+}
+
+namespace logger
+{
+    void DrawImGui()
+    {
+        static int             min_level = static_cast<int>(Level::Debug);
+        static ImGuiTextFilter filter;
+
+        ImGui::Begin("Log");
+        const Stats stats = GetStats();
+        ImGui::Text("%llu written, %llu dropped, %d thread(s)", static_cast<unsigned long long>(stats.written), static_cast<unsigned long long>(stats.dropped), stats.threads);
+        ImGui::SetNextItemWidth(100.0f);
+        ImGui::Combo("level", &min_level, "debug\0info\0warning\0error\0");
+        ImGui::SameLine();
+        filter.Draw("filter", 200.0f);
+        ImGui::Separator();
+        if (ImGui::BeginChild("lines", ImVec2{ 0.0f, 0.0f }, false, ImGuiWindowFlags_HorizontalScrollbar))
+        {
+            // follow new lines only while the view is already at the bottom
+            const bool is_following = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+            VisitHistory(
+                [](const Line& line)
+                {
+                    if (static_cast<int>(line.level) < min_level || !filter.PassFilter(line.text.c_str()))
+                        return;
+                    ImGui::PushStyleColor(ImGuiCol_Text, level_color(line.level));
+                    ImGui::Text("%8.3f [%d] %s", line.seconds, line.thread, line.text.c_str());
+                    ImGui::PopStyleColor();
+                });
+            if (is_following)
+                ImGui::SetScrollHereY(1.0f);
+        }
+        ImGui::EndChild();
+        ImGui::End();
+    }
+}
@@ -0,0 +1,324 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "logger.h"
+
+#include "spsc_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using logger::Level;
+    using logger::Line;
+    using logger::Record;
+
+    constexpr std::size_t QUEUE_RECORDS = 256; // per thread, about 64 KB
+    constexpr std::size_t HISTORY_LINES = 1000;
+    constexpr auto        DRAIN_PERIOD  = std::chrono::milliseconds{ 50 };
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    constexpr bool HAS_THREADS = false;
+#else
+    constexpr bool HAS_THREADS = true;
+#endif
+
+    struct ThreadQueue
+    {
+        SpscQueue<Record, QUEUE_RECORDS> records;
+        int                              thread = 0;
+        std::atomic<bool>                is_closed{ false }; // its thread ended; dropped once drained
+    };
+
+    struct State
+    {
+        std::mutex                                registry_mutex;
+        std::vector<std::shared_ptr<ThreadQueue>> queues;
+        std::atomic<int>                          thread_count{ 0 };
+
+        std::mutex drain_mutex; // one consumer at a time, and whole lines on the console
+        std::mutex history_mutex;
+        std::deque<Line> history;
+
+        std::mutex              wake_mutex;
+        std::condition_variable wake;
+        bool                    is_wake_requested = false;
+        bool                    is_stopping       = false;
+        std::thread             thread;
+        std::atomic<bool>       is_running{ false };
+
+        std::atomic<std::uint64_t> written{ 0 };
+        std::atomic<std::uint64_t> dropped{ 0 };
+        std::uint64_t              start_ticks = logger::detail::Now();
+
+        std::atomic<void (*)(const Record&)> mirror{ nullptr };
+    };
+
+    State& state()
+    {
+        static State instance;
+        return instance;
+    }
+
+    int this_thread_index()
+    {
+        thread_local const int index = state().thread_count.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    // the thread's queue outlives the thread until the logger has printed what is left in it
+    struct QueueOwner
+    {
+        std::shared_ptr<ThreadQueue> queue;
+
+        ~QueueOwner()
+        {
+            if (queue != nullptr)
+                queue->is_closed.store(true, std::memory_order_release);
+        }
+    };
+
+    ThreadQueue& this_thread_queue()
+    {
+        thread_local QueueOwner owner;
+        if (owner.queue == nullptr)
+        {
+            auto queue    = std::make_shared<ThreadQueue>();
+            queue->thread = this_thread_index();
+            {
+                State&      logger = state();
+                std::lock_guard lock{ logger.registry_mutex };
+                logger.queues.push_back(queue);
+            }
+            owner.queue = std::move(queue);
+        }
+        return *owner.queue;
+    }
+
+    template <typename T>
+    T read_at(const Record& record, std::size_t& at) noexcept
+    {
+        T value;
+        std::memcpy(&value, record.payload.data() + at, sizeof(T));
+        at += sizeof(T);
+        return value;
+    }
+
+    std::string format_record(const Record& record)
+    {
+        using logger::detail::Tag;
+        std::ostringstream text;
+        std::size_t        at = 0;
+        while (at < record.used)
+        {
+            switch (static_cast<Tag>(record.payload[at++]))
+            {
+                case Tag::Signed: text << read_at<std::int64_t>(record, at); break;
+                case Tag::Unsigned: text << read_at<std::uint64_t>(record, at); break;
+                case Tag::Float: text << read_at<double>(record, at); break;
+                case Tag::Bool: text << read_at<bool>(record, at); break;
+                case Tag::Char: text << read_at<char>(record, at); break;
+                case Tag::Text:
+                case Tag::Path:
+                    {
+                        const bool             is_path = static_cast<Tag>(record.payload[at - 1]) == Tag::Path;
+                        const auto             length  = read_at<std::uint16_t>(record, at);
+                        const std::string_view piece{ reinterpret_cast<const char*>(record.payload.data() + at), length };
+                        at += length;
+                        if (is_path)
+                            text << std::quoted(piece);
+                        else
+                            text << piece;
+                    }
+                    break;
+            }
+        }
+        if (record.is_cut)
+            text << "...";
+        return text.str();
+    }
+
+    // prints the line and keeps it for the Log window; under drain_mutex
+    void emit(State& logger, const Record& record, int thread)
+    {
+        Line line;
+        line.seconds = static_cast<double>(record.ticks - logger.start_ticks) * 1e-9;
+        line.level   = record.level;
+        line.thread  = thread;
+        line.text    = format_record(record);
+        (record.level >= Level::Warning ? std::cerr : std::cout) << line.text << '\n';
+        std::lock_guard lock{ logger.history_mutex };
+        if (logger.history.size() == HISTORY_LINES)
+            logger.history.pop_front();
+        logger.history.push_back(std::move(line));
+    }
+
+    void drain(State& logger)
+    {
+        std::lock_guard                           drain_lock{ logger.drain_mutex };
+        std::vector<std::shared_ptr<ThreadQueue>> queues;
+        {
+            std::lock_guard lock{ logger.registry_mutex };
+            queues = logger.queues;
+        }
+        std::vector<std::pair<int, Record>> batch;
+        Record                              record;
+        for (const auto& queue : queues)
+        {
+            const bool was_closed = queue->is_closed.load(std::memory_order_acquire);
+            while (queue->records.TryPop(record))
+                batch.emplace_back(queue->thread, record);
+            if (was_closed)
+            {
+                std::lock_guard lock{ logger.registry_mutex };
+                std::erase(logger.queues, queue);
+            }
+        }
+        // each queue is in order already; across threads the clock decides
+        std::stable_sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) { return a.second.ticks < b.second.ticks; });
+        for (const auto& [thread, queued] : batch)
+            emit(logger, queued, thread);
+        if (!batch.empty())
+        {
+            std::cout.flush();
+            std::cerr.flush();
+        }
+    }
+
+    void run(State& logger)
+    {
+        std::unique_lock lock{ logger.wake_mutex };
+        while (!logger.is_stopping)
+        {
+            logger.wake.wait_for(lock, DRAIN_PERIOD, [&logger] { return logger.is_stopping || logger.is_wake_requested; });
+            logger.is_wake_requested = false;
+            lock.unlock();
+            drain(logger);
+            lock.lock();
+        }
+    }
+}
+
+namespace logger
+{
+    void Start()
+    {
+        State& logger = state();
+        if (!HAS_THREADS || logger.is_running.load(std::memory_order_acquire))
+            return;
+        logger.is_stopping = false;
+        logger.thread      = std::thread{ [&logger] { run(logger); } };
+        logger.is_running.store(true, std::memory_order_release);
+    }
+
+    void Stop()
+    {
+        State& logger = state();
+        if (!logger.is_running.load(std::memory_order_acquire))
+            return;
+        {
+            std::lock_guard lock{ logger.wake_mutex };
+            logger.is_stopping = true;
+        }
+        logger.wake.notify_one();
+        logger.thread.join();
+        logger.is_running.store(false, std::memory_order_release);
+        // anything written while the thread was on its way out
+        drain(logger);
+    }
+
+    void Flush()
+    {
+        drain(state());
+    }
+
+    const char* LevelName(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Debug: return "debug";
+            case Level::Info: return "info";
+            case Level::Warning: return "warning";
+            case Level::Error: return "error";
+        }
+        return "?";
+    }
+
+    std::string Format(const Record& record)
+    {
+        return format_record(record);
+    }
+
+    void SetMirror(void (*mirror)(const Record&)) noexcept
+    {
+        state().mirror.store(mirror, std::memory_order_release);
+    }
+
+    Stats GetStats() noexcept
+    {
+        State& logger = state();
+        Stats  stats;
+        stats.written = logger.written.load(std::memory_order_relaxed);
+        stats.dropped = logger.dropped.load(std::memory_order_relaxed);
+        stats.threads = logger.thread_count.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    namespace detail
+    {
+        std::uint64_t Now() noexcept
+        {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        void Submit(const Record& record)
+        {
+            State& logger = state();
+            if (const auto mirror = logger.mirror.load(std::memory_order_acquire); mirror != nullptr)
+                mirror(record);
+            if (!logger.is_running.load(std::memory_order_acquire))
+            {
+                std::lock_guard lock{ logger.drain_mutex };
+                emit(logger, record, this_thread_index());
+                logger.written.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (!this_thread_queue().records.TryPush(record))
+            {
+                logger.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            logger.written.fetch_add(1, std::memory_order_relaxed);
+            if (record.level == Level::Error)
+            {
+                {
+                    std::lock_guard lock{ logger.wake_mutex };
+                    logger.is_wake_requested = true;
+                }
+                logger.wake.notify_one();
+            }
+        }
+
+        void ForEachLine(void (*visit)(const Line&, void*), void* context)
+        {
+            State&          logger = state();
+            std::lock_guard lock{ logger.history_mutex };
+            for (const Line& line : logger.history)
+                visit(line, context);
+        }
+    }
+}
@@ -0,0 +1,226 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Messages below this level compile to nothing: 0 debug, 1 info, 2 warning, 3 error
+#if !defined(LOG_MIN_LEVEL)
+#    if defined(NDEBUG)
+#        define LOG_MIN_LEVEL 1
+#    else
+#        define LOG_MIN_LEVEL 0
+#    endif
+#endif
+
+#define LOG_AT(level, ...)                                                                                                                                                         \
+    do                                                                                                                                                                             \
+    {                                                                                                                                                                              \
+        if constexpr (logger::IsCompiledIn(level))                                                                                                                                  \
+            logger::Write(level, __VA_ARGS__);                                                                                                                                     \
+    } while (false)
+#define LOG_DEBUG(...) LOG_AT(logger::Level::Debug, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(logger::Level::Info, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(logger::Level::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(logger::Level::Error, __VA_ARGS__)
+
+/**
+ * A logger that costs the calling thread a copy of its arguments, so loaders and renderers can log mid-frame.
+ *
+ * A message is its pieces as for `std::cerr << a << b << c`, one line without the '\n'. Write copies the
+ * numbers and the text into a fixed size record, tagged by kind, and pushes that onto the calling thread's own
+ * SpscQueue; the logger's thread drains every thread's queue a few times a second, formats the records with the
+ * usual operator<< and prints them, warnings and errors to std::cerr and the rest to std::cout. A synchronous
+ * Windows console write never lands on a frame. Arguments that are not numbers or text are formatted on the
+ * caller, the slow path. A full queue drops the message and counts it rather than waiting; an error wakes the
+ * logger's thread at once. Before Start, after Stop and without threads (the plain web build) Write prints right
+ * away, so tools that share these sources behave as before.
+ * The last lines are kept for the ImGui "Log" window, which is in log_window.cpp so tools can use the logger
+ * without ImGui. Thread safe.
+ */
+namespace logger
+{
+    enum class Level : std::uint8_t
+    {
+        Debug,
+        Info,
+        Warning,
+        Error
+    };
+
+    constexpr bool IsCompiledIn(Level level) noexcept
+    {
+        return level >= static_cast<Level>(LOG_MIN_LEVEL);
+    }
+
+    constexpr std::size_t PAYLOAD_BYTES = 240;
+
+    // What Write hands the logger's thread; built on the caller
+    struct Record
+    {
+        std::uint64_t                            ticks  = 0; // steady_clock
+        Level                                    level  = Level::Info;
+        bool                                     is_cut = false; // the arguments didn't fit
+        std::uint16_t                            used   = 0;
+        std::array<unsigned char, PAYLOAD_BYTES> payload{};
+    };
+
+    struct Line
+    {
+        double      seconds = 0.0; // since Start
+        Level       level   = Level::Info;
+        int         thread  = 0; // in the order threads first wrote
+        std::string text;
+    };
+
+    struct Stats
+    {
+        std::uint64_t written = 0;
+        std::uint64_t dropped = 0; // the writer's queue was full
+        int           threads = 0;
+    };
+
+    void Start();
+    // Prints what is still queued and ends the logger's thread
+    void Stop();
+    // Prints what every thread queued so far, on the calling thread
+    void Flush();
+
+    const char* LevelName(Level level) noexcept;
+    Stats       GetStats() noexcept;
+    // The line a record prints as, on any thread
+    std::string Format(const Record& record);
+    // Also hands every record to `mirror` on the thread that wrote it, before it is queued; nullptr for none.
+    // The profiler's trace ring keeps them this way, so a crash doesn't take the lines still queued with it
+    void        SetMirror(void (*mirror)(const Record&)) noexcept;
+    // Calls `visit` with the kept lines, oldest first, under the history's lock
+    template <typename Visit>
+    void VisitHistory(Visit&& visit);
+
+    // The "Log" window: the kept lines with a level filter; in log_window.cpp
+    void DrawImGui();
+
+    namespace detail
+    {
+        enum class Tag : std::uint8_t
+        {
+            Signed,
+            Unsigned,
+            Float,
+            Bool,
+            Char,
+            Text,
+            Path // printed quoted, like operator<< on a path
+        };
+
+        class Encoder
+        {
+        public:
+            explicit Encoder(Record& record) noexcept : record{ record } {}
+
+            void Number(Tag tag, const void* value, std::size_t size) noexcept
+            {
+                if (!fits(1 + size))
+                    return;
+                record.payload[record.used++] = static_cast<unsigned char>(tag);
+                std::memcpy(record.payload.data() + record.used, value, size);
+                record.used = static_cast<std::uint16_t>(record.used + size);
+            }
+
+            void Text(Tag tag, std::string_view text) noexcept
+            {
+                if (!fits(3))
+                    return;
+                const std::size_t room        = PAYLOAD_BYTES - record.used - 3;
+                const auto        length      = static_cast<std::uint16_t>(text.size() < room ? text.size() : room);
+                record.is_cut                 = record.is_cut || length < text.size();
+                record.payload[record.used++] = static_cast<unsigned char>(tag);
+                std::memcpy(record.payload.data() + record.used, &length, sizeof(length));
+                std::memcpy(record.payload.data() + record.used + sizeof(length), text.data(), length);
+                record.used = static_cast<std::uint16_t>(record.used + sizeof(length) + length);
+            }
+
+        private:
+            bool fits(std::size_t bytes) noexcept
+            {
+                if (record.used + bytes <= PAYLOAD_BYTES)
+                    return true;
+                record.is_cut = true;
+                return false;
+            }
+
+            Record& record;
+        };
+
+        template <typename T>
+        void put(Encoder& out, const T& value)
+        {
+            using Value = std::remove_cvref_t<T>;
+            if constexpr (std::is_same_v<Value, bool>)
+                out.Number(Tag::Bool, &value, sizeof(value));
+            else if constexpr (std::is_same_v<Value, char> || std::is_same_v<Value, signed char> || std::is_same_v<Value, unsigned char>)
+                out.Number(Tag::Char, &value, sizeof(value)); // characters, as operator<< prints them
+            else if constexpr (std::is_integral_v<Value> && std::is_signed_v<Value>)
+            {
+                const auto wide = static_cast<std::int64_t>(value);
+                out.Number(Tag::Signed, &wide, sizeof(wide));
+            }
+            else if constexpr (std::is_integral_v<Value>)
+            {
+                const auto wide = static_cast<std::uint64_t>(value);
+                out.Number(Tag::Unsigned, &wide, sizeof(wide));
+            }
+            else if constexpr (std::is_floating_point_v<Value>)
+            {
+                const auto wide = static_cast<double>(value);
+                out.Number(Tag::Float, &wide, sizeof(wide));
+            }
+            else if constexpr (std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*>)
+                out.Text(Tag::Text, value != nullptr ? std::string_view{ value } : std::string_view{ "(null)" });
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+                out.Text(Tag::Text, std::string_view{ value });
+            else if constexpr (std::is_same_v<Value, std::filesystem::path>)
+                out.Text(Tag::Path, value.string());
+            else
+            {
+                std::ostringstream text;
+                text << value;
+                out.Text(Tag::Text, text.str());
+            }
+        }
+
+        std::uint64_t Now() noexcept;
+        void          Submit(const Record& record);
+        void          ForEachLine(void (*visit)(const Line&, void*), void* context);
+    }
+
+    template <typename... Pieces>
+    void Write(Level level, const Pieces&... pieces)
+    {
+        Record record;
+        record.ticks = detail::Now();
+        record.level = level;
+        detail::Encoder out{ record };
+        (detail::put(out, pieces), ...);
+        detail::Submit(record);
+    }
+
+    template <typename Visit>
+    void VisitHistory(Visit&& visit)
+    {
+        detail::ForEachLine([](const Line& line, void* context) { (*static_cast<std::remove_reference_t<Visit>*>(context))(line); }, &visit);
+    }
+}
@@ -0,0 +1,271 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "lz4_block.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr std::size_t MIN_MATCH     = 4;
+    constexpr std::size_t LAST_LITERALS = 5;  // a block ends in at least this many literals
+    constexpr std::size_t MATCH_LIMIT   = 12; // and its last match starts at least this far from the end
+    constexpr std::size_t MAX_OFFSET    = 65535;
+    constexpr int         FAST_BITS     = 16;
+    constexpr int         DENSE_BITS    = 17;
+    constexpr int         DENSE_TRIES   = 64;
+    constexpr std::size_t WINDOW_MASK   = 65535; // the dense chain, one link per position in the window
+
+    std::uint32_t read32(const unsigned char* at) noexcept
+    {
+        std::uint32_t value = 0;
+        std::memcpy(&value, at, sizeof(value));
+        return value;
+    }
+
+    std::uint32_t hash4(std::uint32_t value, int bits) noexcept
+    {
+        return (value * 2654435761u) >> (32 - bits);
+    }
+
+    // how far `later` repeats `earlier`, stopping at `end`
+    std::size_t match_length(const unsigned char* earlier, const unsigned char* later, const unsigned char* end) noexcept
+    {
+        const unsigned char* start = later;
+        while (later < end && *later == *earlier)
+        {
+            ++later;
+            ++earlier;
+        }
+        return static_cast<std::size_t>(later - start);
+    }
+
+    // what doesn't fit a token's 4 bits, 255 at a time
+    void write_length(std::vector<unsigned char>& out, std::size_t length)
+    {
+        for (length -= 15; length >= 255; length -= 255)
+            out.push_back(255);
+        out.push_back(static_cast<unsigned char>(length));
+    }
+
+    // a match of 0 is the block's last sequence, literals only
+    void write_sequence(std::vector<unsigned char>& out, std::span<const unsigned char> literals, std::size_t offset, std::size_t match)
+    {
+        const std::size_t extra = match != 0 ? match - MIN_MATCH : 0;
+        out.push_back(static_cast<unsigned char>(std::min<std::size_t>(literals.size(), 15) << 4 | std::min<std::size_t>(extra, 15)));
+        if (literals.size() >= 15)
+            write_length(out, literals.size());
+        out.insert(out.end(), literals.begin(), literals.end());
+        if (match == 0)
+            return;
+        out.push_back(static_cast<unsigned char>(offset));
+        out.push_back(static_cast<unsigned char>(offset >> 8));
+        if (extra >= 15)
+            write_length(out, extra);
+    }
+
+    void compress_fast(std::span<const unsigned char> source, std::vector<unsigned char>& out)
+    {
+        const unsigned char*       data = source.data();
+        const std::size_t          end  = source.size() - LAST_LITERALS;
+        const std::size_t          last = source.size() - MATCH_LIMIT;
+        std::vector<std::uint32_t> table(std::size_t{ 1 } << FAST_BITS, UINT32_MAX);
+        std::size_t                anchor = 0;
+        std::size_t                at     = 0;
+        while (at < last)
+        {
+            const std::uint32_t hash      = hash4(read32(data + at), FAST_BITS);
+            std::size_t         candidate = table[hash];
+            table[hash]                   = static_cast<std::uint32_t>(at);
+            if (candidate == UINT32_MAX || at - candidate > MAX_OFFSET || read32(data + candidate) != read32(data + at))
+            {
+                // the longer nothing matched, the bigger the steps over what is likely already compressed
+                at += 1 + ((at - anchor) >> 6);
+                continue;
+            }
+            std::size_t length = MIN_MATCH + match_length(data + candidate + MIN_MATCH, data + at + MIN_MATCH, data + end);
+            while (at > anchor && candidate > 0 && data[at - 1] == data[candidate - 1])
+            {
+                --at;
+                --candidate;
+                ++length;
+            }
+            write_sequence(out, source.subspan(anchor, at - anchor), at - candidate, length);
+            at += length;
+            anchor = at;
+            if (at - 2 < last)
+                table[hash4(read32(data + at - 2), FAST_BITS)] = static_cast<std::uint32_t>(at - 2);
+        }
+        write_sequence(out, source.subspan(anchor), 0, 0);
+    }
+
+    class Chain
+    {
+    public:
+        explicit Chain(std::span<const unsigned char> source) : data{ source.data() }, end{ source.size() - LAST_LITERALS }
+        {
+        }
+
+        // every position up to `at` goes in before it is searched from
+        void InsertUpTo(std::size_t at)
+        {
+            for (; next <= at; ++next)
+            {
+                const std::uint32_t hash  = hash4(read32(data + next), DENSE_BITS);
+                links[next & WINDOW_MASK] = heads[hash];
+                heads[hash]               = static_cast<std::int32_t>(next);
+            }
+        }
+
+        // the longest match for `at`, 0 when there is none
+        std::size_t Longest(std::size_t at, std::size_t& out_offset) const
+        {
+            std::size_t  best      = 0;
+            std::int32_t candidate = heads[hash4(read32(data + at), DENSE_BITS)];
+            for (int tries = 0; tries < DENSE_TRIES && candidate >= 0 && at - static_cast<std::size_t>(candidate) <= MAX_OFFSET; ++tries)
+            {
+                const auto from = static_cast<std::size_t>(candidate);
+                // the byte that would make it longer than the best so far, before the whole compare
+                if (from != at && (best == 0 || (at + best < end && data[from + best] == data[at + best])) && read32(data + from) == read32(data + at))
+                {
+                    const std::size_t length = MIN_MATCH + match_length(data + from + MIN_MATCH, data + at + MIN_MATCH, data + end);
+                    if (length > best)
+                    {
+                        best       = length;
+                        out_offset = at - from;
+                    }
+                }
+                candidate = links[from & WINDOW_MASK];
+            }
+            return best;
+        }
+
+    private:
+        const unsigned char*      data = nullptr;
+        std::size_t               end  = 0;
+        std::size_t               next = 0;
+        std::vector<std::int32_t> heads = std::vector<std::int32_t>(std::size_t{ 1 } << DENSE_BITS, -1);
+        std::vector<std::int32_t> links = std::vector<std::int32_t>(WINDOW_MASK + 1, -1);
+    };
+
+    void compress_dense(std::span<const unsigned char> source, std::vector<unsigned char>& out)
+    {
+        const std::size_t last   = source.size() - MATCH_LIMIT;
+        Chain             chain{ source };
+        std::size_t       anchor = 0;
+        std::size_t       at     = 0;
+        while (at < last)
+        {
+            chain.InsertUpTo(at);
+            std::size_t offset = 0;
+            std::size_t length = chain.Longest(at, offset);
+            if (length == 0)
+            {
+                ++at;
+                continue;
+            }
+            // one byte on may start a longer match, worth the literal it costs
+            while (at + 1 < last)
+            {
+                chain.InsertUpTo(at + 1);
+                std::size_t       later_offset = 0;
+                const std::size_t later        = chain.Longest(at + 1, later_offset);
+                if (later <= length)
+                    break;
+                ++at;
+                length = later;
+                offset = later_offset;
+            }
+            write_sequence(out, source.subspan(anchor, at - anchor), offset, length);
+            at += length;
+            anchor = at;
+        }
+        write_sequence(out, source.subspan(anchor), 0, 0);
+    }
+}
+
+namespace lz4
+{
+    std::size_t Bound(std::size_t size) noexcept
+    {
+        return size + size / 255 + 16;
+    }
+
+    void Compress(std::span<const unsigned char> source, std::vector<unsigned char>& out, Level level)
+    {
+        out.clear();
+        out.reserve(Bound(source.size()));
+        if (source.size() <= MATCH_LIMIT)
+            write_sequence(out, source, 0, 0);
+        else if (level == Level::Dense)
+            compress_dense(source, out);
+        else
+            compress_fast(source, out);
+    }
+
+    bool Decompress(std::span<const unsigned char> block, std::span<unsigned char> out) noexcept
+    {
+        const unsigned char* in      = block.data();
+        const unsigned char* in_end  = in + block.size();
+        unsigned char*       at      = out.data();
+        unsigned char* const out_end = at + out.size();
+        // a length past its 4 bits, in 255s and then the rest; false when the block ends first
+        const auto read_length = [&in, in_end](std::size_t& length)
+        {
+            if (length != 15)
+                return true;
+            for (;;)
+            {
+                if (in == in_end)
+                    return false;
+                const unsigned char more = *in++;
+                length += more;
+                if (more != 255)
+                    return true;
+            }
+        };
+        for (;;)
+        {
+            if (in == in_end)
+                return false;
+            const unsigned char token    = *in++;
+            std::size_t         literals = token >> 4;
+            if (!read_length(literals) || literals > static_cast<std::size_t>(in_end - in) || literals > static_cast<std::size_t>(out_end - at))
+                return false;
+            if (literals != 0)
+                std::memcpy(at, in, literals);
+            in += literals;
+            at += literals;
+            if (in == in_end)
+                return at == out_end;
+
+            if (in_end - in < 2)
+                return false;
+            const std::size_t offset = static_cast<std::size_t>(in[0]) | static_cast<std::size_t>(in[1]) << 8;
+            in += 2;
+            std::size_t length = token & 15;
+            if (offset == 0 || offset > static_cast<std::size_t>(at - out.data()) || !read_length(length))
+                return false;
+            length += MIN_MATCH;
+            if (length > static_cast<std::size_t>(out_end - at))
+                return false;
+            const unsigned char* from = at - offset;
+            if (offset >= length)
+            {
+                std::memcpy(at, from, length);
+                at += length;
+            }
+            else
+            {
+                // overlapping: a run that repeats its last `offset` bytes
+                for (unsigned char* const stop = at + length; at < stop;)
+                    *at++ = *from++;
+            }
+        }
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * The LZ4 block format: what asset-packer compresses pack entries with, and what AssetPack decodes them from.
+ *
+ * A block is a run of sequences, each some literal bytes and then a copy of 4 or more bytes from at most 64 KB
+ * back, the last one literals only; no checksum and no length, the caller knows how big the block comes out.
+ * Decoding is a loop of memcpy with no tables, most of a gigabyte a second on one core, which is why the pack
+ * uses it: the disk is the slow part. Both levels write the same format and decode the same way:
+ *  - Fast takes the first match a hash of the next 4 bytes finds, and strides over data that doesn't compress.
+ *    It comes out the size of the reference LZ4's default level.
+ *  - Dense walks a chain of up to 64 earlier places with the same hash for the longest match, and checks whether
+ *    starting one byte later finds a longer one; some five times slower to write, a quarter smaller on text.
+ */
+namespace lz4
+{
+    enum class Level : std::uint8_t
+    {
+        Fast,
+        Dense
+    };
+
+    // The most Compress can write for `size` bytes, which don't compress at all
+    std::size_t Bound(std::size_t size) noexcept;
+    // Replaces `out` with the block; its size is the compressed size
+    void Compress(std::span<const unsigned char> source, std::vector<unsigned char>& out, Level level);
+    // Fills all of `out` from the block; false when the block is corrupt or doesn't come out exactly that long
+    bool Decompress(std::span<const unsigned char> block, std::span<unsigned char> out) noexcept;
+}
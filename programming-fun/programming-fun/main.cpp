@@ -5,59 +5,574 @@
  * \copyright DigiPen Institute of Technology
  */
 
+#include "app_config.h"
+#include "allocation_counter.h"
+#include "animated_sprite_renderer.h"
+#include "asset_browser.h"
+#include "asset_fetch.h"
+#include "asset_id.h"
+#include "asset_pack.h"
+#include "asset_registry.h"
+#include "asset_paths.h"
+#include "asset_tasks.h"
+#include "asset_watcher.h"
+#include "async_file_reader.h"
+#include "audio_benchmark.h"
+#include "audio_device.h"
+#include "audio_effects.h"
+#include "audio_kernels.h"
+#include "audio_occlusion.h"
+#include "audio_stats.h"
+#include "audio_stream.h"
+#include "audio_thread.h"
+#include "batch_render.h"
+#include "benchmark.h"
+#include "broadphase.h"
+#include "broadphase_benchmark.h"
+#include "debug_draw.h"
+#include "debug_draw_renderer.h"
+#include "decode_scratch.h"
+#include "decoded_cache.h"
+#include "dynamic_resolution.h"
+#include "entity_benchmark.h"
+#include "entity_store.h"
+#include "error.h"
+#include "fixed_timestep.h"
+#include "frame_arena.h"
+#include "frame_capture.h"
+#include "frame_pacer.h"
+#include "gltf_model.h"
+#include "frame_packet.h"
+#include "gl_backend.h"
+#include "gl_context.h"
+#include "gl_debug.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "gpu_picker.h"
+#include "gpu_preference.h"
+#include "gpu_profiler.h"
+#include "hardware_probe.h"
+#include "hitch_detector.h"
+#include "imgui_fonts.h"
+#include "imgui_panels.h"
+#include "imgui_renderer.h"
+#include "imgui_viewports.h"
+#include "input_log.h"
+#include "input_state.h"
+#include "latency_probe.h"
+#include "light_renderer.h"
+#include "load_scheduler.h"
+#include "lod_selector.h"
+#include "logger.h"
+#include "math_benchmark.h"
+#include "math_kernels.h"
+#include "memory_tracker.h"
+#include "mesh_optimizer.h"
+#include "mesh_renderer.h"
+#include "music_player.h"
+#include "particle_system.h"
+#include "perf_counters.h"
+#include "perf_hud.h"
+#include "pixel_benchmark.h"
+#include "post_process.h"
+#include "profiler.h"
+#include "release_queue.h"
+#include "render_commands.h"
+#include "render_graph.h"
+#include "render_target.h"
+#include "render_thread.h"
+#include "scene_file.h"
+#include "scene_views.h"
+#include "scheduling.h"
+#include "sdf_font.h"
+#include "shader.h"
+#include "side_modules.h"
+#include "software_mixer.h"
+#include "sound_cache.h"
+#include "sound_loader.h"
+#include "spatial_audio.h"
+#include "spsc_queue.h"
+#include "sprite_batch.h"
+#include "sprite_grid.h"
+#include "startup_trace.h"
+#include "static_sprites.h"
+#include "task_graph.h"
+#include "telemetry.h"
+#include "text_renderer.h"
+#include "texture_array.h"
+#include "texture_atlas.h"
+#include "texture_loader.h"
+#include "tilemap.h"
+#include "tilemap_renderer.h"
+#include "transform_hierarchy.h"
+#include "ui_damage.h"
+#include "upload_benchmark.h"
+#include "upload_budget.h"
+#include "upload_thread.h"
+#include "video_player.h"
+#include "virtual_texture.h"
+#include "voice_pool.h"
+#include "worker_pool.h"
+#include "worker_ui.h"
+#include "world_history.h"
+
 #include <GL/glew.h>
 #include <SDL.h>
 #include <al.h>
 #include <alc.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <backends/imgui_impl_opengl3.h>
 #include <backends/imgui_impl_sdl2.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/matrix.hpp>
 #include <glm/vec3.hpp> // vec3, bvec3, dvec3, ivec3 and uvec3
 #include <gsl/gsl>
 #include <imgui.h>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <numeric>
 #include <optional>
+#include <random>
+#include <span>
 #include <sstream>
-#include <stb_image.h>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
-#define STB_VORBIS_HEADER_ONLY
-#include <stb_vorbis.c>
+
+using namespace asset_literals;
 
 namespace
 {
-    int                   gWindowWidth  = 640;
-    int                   gWindowHeight = 480;
-    [[maybe_unused]] bool gNeedResize   = false;
+    int gWindowWidth  = 640;
+    int gWindowHeight = 480;
+    // the window's size in pixels, which on a high-DPI display is more than its size in points above
+    glm::ivec2 gDrawableSize{ 640, 480 };
+    // the web page's setWindowSize, width << 16 | height and 0 for none; the page's thread writes it, main_loop takes it
+    [[maybe_unused]] std::atomic<std::uint32_t> gRequestedSize{ 0 };
 
     class Demo
     {
     public:
-        void Setup();
-        void Shutdown();
+        // Start the background decodes ahead of the rest of startup: sounds need nothing, textures need GL for the formats
+        void RequestSounds(SoundCache& sound_cache);
+        // Every texture and the tileset side by side; the handles are set before it first waits, the tileset once it's built
+        AssetTask Load(AssetTasks& tasks);
+        // `label_font` lays out the marker labels; it may have no font loaded, and has to outlive the demo
+        void Setup(MeshRenderer& mesh_renderer, AnimatedSpriteRenderer& animated_renderer, const SpriteBatch& sprite_batch, const ParticleSystem& particle_system,
+                   const AudioDevice& audio_device, SdfFont& label_font);
+        // Voices and the music stream, and the grains on `backend`; once `audio_device` is current
+        void SetupAudio(AudioStreamer& audio_streamer, const AssetPack& asset_pack, AudioBackend backend);
+        void Shutdown(AudioStreamer& audio_streamer, WorkerPool& workers);
+        // Only the thread that calls AL, so the context can go without the rest of Shutdown
+        void StopAudioThread();
+        // In window points, like the mouse; the scene's pixel count is the render scale's business
         void SetDisplaySize(int width, int height);
-        void Draw() const;
-        void ImGuiDraw();
+        // The screen rectangle the stress ducks are culled to, when more than the display shows; SetDisplaySize resets it
+        void SetCullBounds(const Aabb2& screen) noexcept;
+        // `input_frame` is the poll the step runs in, kept with the step's snapshot while the history records
+        void FixedUpdate(float step_seconds, WorkerPool& workers, std::uint32_t input_frame);
+        // The input frame of the step the history was last rolled back to, once; a replay picks up from there
+        std::optional<std::uint32_t> TakeRewind() noexcept;
+        // Pushes the frame's audio commands and flushes them to the audio thread; the occlusion rays go to `workers`
+        void Update(WorkerPool& workers);
+        // Edits, builds and uploads the tilemap's chunks in view within `budget`; GL, on the main thread
+        void UpdateTilemap(WorkerPool& workers, UploadBudget& budget, ReleaseQueue& releases);
+        // Places, edits and uploads the retained scenery sprites; GL, on the main thread
+        void UpdateStaticSprites(UploadBudget& budget, ReleaseQueue& releases);
+        // Opens the tiled image on first use and streams in the tiles the view wants within `budget`; GL, on the main thread
+        void UpdateVirtualImage(LoadScheduler& load_scheduler, UploadBudget& budget);
+        // Loads the glTF model on a worker the first time it's enabled, turns it while it spins and picks its copies' levels of detail
+        void UpdateModel(LoadScheduler& load_scheduler, double delta_seconds);
+        // Opens the clip on first use, plays its soundtrack through `audio_streamer` when there is one, and shows the frame that is due
+        void UpdateVideo(LoadScheduler& load_scheduler, AudioStreamer* audio_streamer, UploadBudget& budget, double delta_seconds);
+        // `alpha` blends the previous fixed step (0) into the latest one (1); records into `frame`, no GL. The ducks record across the workers.
+        void Draw(float alpha, FramePacket& frame, WorkerPool& workers) const;
+        void ImGuiDraw(const SpriteBatch::Stats& sprite_stats, const SpriteBatch::Stats& static_sprite_stats, const AnimatedSpriteRenderer::Stats& animated_stats,
+                       const MeshRenderer::Stats& mesh_stats, const ParticleSystem::Stats& particle_stats, const TextRenderer::Stats& text_stats,
+                       const TilemapRenderer::Stats& tilemap_stats, const LightRenderer::Stats& light_stats);
+        bool IsAnimating() const;
+        // A play button was pressed before audio was set up
+        bool WantsAudio() const noexcept;
+        bool HasAudio() const noexcept;
+        // What the stress sliders would set; the benchmark's scripted scene
+        void SetStressLoad(int sprite_count, int marker_count);
+        // Replaces the stress ducks with the scene's, each column copied whole out of the mapping
+        void LoadScene(const SceneFile& scene);
+        // The stress duck a pick found, by the pick_id Draw gives it (its index + 1), 0 for none; Draw outlines it
+        void SetPickedDuck(std::uint32_t pick_id) noexcept;
+
+    private:
+        void resizeSpriteStress(int count);
+        // the stress ducks roam `world_scale` screens; the grid covers that much
+        void resetSpriteGrid();
+        // what the frame's duck textures would draw at, so the grid's bounds hold whichever of them is used
+        glm::vec2 duckHalfExtent() const;
+        // world to screen for the stress ducks, which is all the view moves
+        glm::mat3 duckView() const;
+        void resizeMarkers(int count);
+        void resizeAnimated(int count);
+        void resizeFireflies(int count);
+        void resizeTree(int count);
+        // lays out a label for each of the first markers; Draw only places the glyphs
+        void resizeLabels();
+        // a tileset sheet of flat noisy colors into the atlas, one region so every tile samples one texture
+        void placeTileset(const std::vector<unsigned char>& pixels);
+        void playPending();
+        void measureLatency();
+        // one looping quack on each of the first few stress ducks, muffled by the ducks between it and the listener
+        void updateQuackingDucks(WorkerPool& workers);
+        // starts the grains due since the last frame
+        void updateGrains();
+        // the fixed step's work as a graph, built on the first step and run every one after
+        void buildFixedUpdate(WorkerPool& workers);
+        // moves each stress duck to the cell it's in now; how many changed cell
+        int regridDucks();
+        // puts the world back as it was `steps` fixed steps before the latest one the history holds
+        void rewind(std::size_t steps);
 
     private:
         glm::vec3 background_color{ 0.392f, 0.584f, 0.929f }; // https://www.colorhexa.com/6495ed
+        glm::vec2 display_size{ 0.0f };
+        Aabb2     cull_bounds;
+
+        TextureHandle example_image;
+        TextureHandle atlas_duck;
+        TextureHandle mipmapped_duck;
+        TextureHandle array_duck;
+        TextureHandle thumbnail_duck; // shrunk on the worker; the texture test window only needs it small
+        TextureAtlas  atlas;
+        TextureArray  duck_array;
+
+        // where the stress ducks' pixels come from
+        enum class DuckSource
+        {
+            Atlas,
+            Mipmapped, // minified ducks read far less memory from a mip chain than from the atlas page
+            Array,     // a mip chain too, in a layer a whole scene of same-size images could share
+            Mixed      // every duck texture by turns, one draw per texture unless bindless
+        };
+
+        struct
+        {
+            int                    requested_count    = 0;
+            float                  scale              = 0.25f;
+            DuckSource             source             = DuckSource::Atlas;
+            bool                   bindless           = false;
+            bool                   bindless_available = false;
+            float                  world_scale        = 1.0f; // screens across
+            glm::vec2              view_offset{ 0.0f };       // the world point at the window's top left
+            float                  zoom = 1.0f;
+            bool                   cull = true;
+            bool                   show_bounds = false; // debug_draw boxes around the ducks drawn, from the jobs that record them
+            bool                   find_overlaps = false; // every overlapping pair of ducks, by SweepAndPrune in Draw
+            bool                   back_to_front = false; // ducks further down the screen over the ones above, whatever their texture
+            EntityStore            ducks; // only ever truncated, so dense indices stay the grid's ids
+            SpriteGrid             grid;
+            int                    regridded = 0; // ducks that changed cell in the latest step
+            std::mt19937           random{ 2024 };
+        } sprite_stress;
+
+        TaskGraph fixed_update;
+        float     fixed_step = 0.0f; // what the graph's tasks step by
+
+        // what a fixed step leaves behind besides the ducks; the tree's turned nodes aren't kept, nothing reads them back
+        struct StepState
+        {
+            float       hierarchy_angle  = 0.0f;
+            std::size_t hierarchy_cursor = 0;
+            double      animated_time    = 0.0;
+            double      particle_time    = 0.0;
+            double      night_time       = 0.0;
+            glm::vec2   tile_offset{ 0.0f };
+        };
+
+        // every fixed step saved as it ends, to roll the world back to for trying something else from there
+        struct
+        {
+            bool                         record   = false;
+            int                          capacity = 120; // steps
+            int                          back     = 30;  // the rewind slider's
+            WorldHistory<StepState>      ring;
+            std::uint64_t                step = 0; // fixed steps run
+            std::optional<std::uint32_t> rewound_input_frame;
+            std::size_t                  saved_bytes    = 0; // the latest save's, and restore's
+            std::size_t                  restored_bytes = 0;
+            double                       save_us        = 0.0;
+            double                       restore_us     = 0.0;
+        } step_history;
+
+        // what the latest Draw culled; Draw records otherwise nothing
+        struct CullStats
+        {
+            int visible = 0;
+            int culled  = 0;
+            int tested  = 0; // bounds the grid query looked at
+        };
+
+        mutable CullStats             sprite_culling;
+        std::uint32_t                 picked_duck = 0;
+        mutable RenderCommandRecorder sprite_commands; // a list per Draw job
+        mutable SweepAndPrune         duck_overlaps;   // keeps the ducks' order along x from one Draw to the next
+
+        struct
+        {
+            MeshId                    mesh            = MeshRenderer::INVALID_MESH;
+            int                       requested_count = 0;
+            float                     size            = 6.0f;
+            std::vector<MeshInstance> instances; // static, packed once when the count or size changes
+        } markers;
+
+        // what the labels say besides their number; past ASCII the font rasterizes glyphs as the labels first use them
+        enum class LabelScript
+        {
+            Latin,
+            Greek,
+            Cyrillic,
+            Chinese,
+            Ideographs // a different one on every label, more than the glyph cache holds at 10'000
+        };
+
+        // "marker N" over each of the first markers, shaped once when the markers or the script change
+        struct
+        {
+            SdfFont*               font            = nullptr;
+            int                    requested_count = 0;
+            LabelScript            script          = LabelScript::Latin;
+            float                  size            = 12.0f; // pixels high
+            std::vector<TextRunId> runs;                    // by marker
+            std::size_t            glyph_count = 0;         // across the runs
+        } labels;
+
+        // a map much bigger than the screen, drawn from static chunk buffers built as they come into view
+        struct
+        {
+            bool                   enabled = false;
+            int                    size    = 1024; // tiles on a side
+            Tilemap                map;
+            int                    generated_size = 0; // 0 until the first enable
+            GLuint                 texture        = 0;
+            std::vector<glm::vec4> tileset;             // uv rects, by TileId - 1
+            glm::vec2              view_offset{ 0.0f }; // the world point at the window's top left
+            float                  zoom  = 1.0f;
+            bool                   pan   = false;
+            int                    edits = 0; // random tiles in view repainted each frame
+            std::mt19937           random{ 7 };
+        } tiles;
+
+        // ducks placed once and drawn from StaticSprites' retained buffers, which only the edited ducks upload into
+        struct
+        {
+            int                                requested_count = 0;
+            int                                edits           = 0;     // random ducks recolored each frame
+            bool                               streamed        = false; // through the sprite stream every frame instead, to compare
+            StaticSprites                      sprites;
+            std::vector<StaticSprites::Handle> handles;
+            GLuint                             texture = 0; // the one the ducks were placed with; a new one places them again
+            std::mt19937                       random{ 11 };
+        } scenery;
+
+        // an image of any size, its tiles streamed into one cache texture as the view reaches them
+        struct
+        {
+            bool           enabled    = false;
+            char           path[260]  = "images/map.tiles"; // under the base path, from texture-converter --tiles
+            bool           is_missing = false;              // the last open failed; cleared by editing the path
+            bool           sparse     = true;               // a sparse texture where the driver has one, else the atlas
+            VirtualTexture texture;
+            glm::vec2      view_offset{ 0.0f }; // the image texel at the window's top left
+            float          zoom = 1.0f;         // screen pixels per texel
+        } virtual_image;
+
+        // what a model load's worker hands back, once `done` is set
+        struct ModelLoad
+        {
+            std::atomic<bool> done{ false };
+            bool              loaded = false;
+            ModelData         model;
+        };
+
+        // a glTF model imported and optimized on a worker, or mapped from the decoded cache, turning in a grid of copies
+        struct
+        {
+            bool                             enabled    = false;
+            char                             path[260]  = "models/model.glb"; // under the base path, .glb or .gltf
+            bool                             is_missing = false;              // the last load failed; cleared by editing the path
+            bool                             spin       = true;
+            float                            angle      = 0.0f; // about the vertical axis, radians
+            int                              copies     = 1;    // each at its own size, so one frame shows several levels
+            float                            zoom       = 1.0f;
+            std::shared_ptr<ModelLoad>       loading; // held by the worker too, until it's done
+            std::shared_ptr<const ModelData> data;
+            LodSelector                      lods;
+            std::vector<MeshInstance>        instances; // this frame's copies, placed by UpdateModel
+            std::vector<float>               pixels_per_unit;
+            std::vector<std::uint8_t>        levels;
+        } model;
+
+        // a clip decoded on the workers and turned into RGB on the GPU, kept in time with its soundtrack
+        struct
+        {
+            bool        enabled    = false;
+            char        path[260]  = "videos/intro.clip"; // under the base path, from texture-converter --clip
+            bool        is_missing = false;               // the last open failed; cleared by editing the path
+            bool        loop       = true;
+            bool        on_sprite  = false; // drawn in the scene as well as in its window
+
+            std::unique_ptr<VideoPlayer> player; // made once the video module has loaded, on the web that is when first enabled
+        } video;
+
+        // ducks waddling through a clip each, the frame picked on the GPU; uploaded once per count change
+        struct
+        {
+            int                                                requested_count = 0;
+            SpriteClipId                                       clip            = 0;
+            std::shared_ptr<const std::vector<AnimatedSprite>> sprites;
+            double                                             time = 0.0;  // advanced by the fixed steps
+            float                                              step = 0.0f; // the latest, for interpolation
+        } animated;
+
+        // fountains of mipmapped ducks, simulated on the render side's GPU
+        struct
+        {
+            bool   enabled   = false;
+            int    capacity  = ParticleSystem::DEFAULT_CAPACITY;
+            int    fountains = 3;
+            float  rate      = 20'000.0f; // per fountain, each second
+            double time      = 0.0;       // advanced by the fixed steps while enabled
+            float  step      = 0.0f;      // the latest, for interpolation
+            bool   compute   = false;     // ParticleSystem::IsComputeAvailable
+        } particles;
+
+        // a light circling where it was scattered, in window fractions so it stays on screen through a resize
+        struct Firefly
+        {
+            glm::vec2     center{ 0.0f };
+            float         orbit = 0.0f; // radius, in points
+            float         speed = 0.0f; // radians a second, either way round
+            float         phase = 0.0f;
+            float         size  = 1.0f; // times the slider's radius
+            std::uint32_t color = 0xFFFFFFFFu;
+        };
+
+        // the scene by night: thousands of small lights over it, binned into tiles by Draw
+        struct
+        {
+            bool                 enabled         = false;
+            int                  requested_count = 2048;
+            float                radius          = 40.0f; // points
+            float                ambient         = 0.15f;
+            std::vector<Firefly> fireflies;
+            double               time = 0.0;  // advanced by the fixed steps while enabled
+            float                step = 0.0f; // the latest, for interpolation
+        } night;
+
+        // fountains riding the arms of a turning wheel, and a tree of nodes a slice of which turns each step,
+        // which the dirty flags keep from costing the whole tree
+        TransformHierarchy transforms;
+        struct
+        {
+            bool                                                      carousel        = false; // the fountains on the wheel rather than along the bottom
+            int                                                       requested_count = 0;     // nodes in the tree, four children each
+            float                                                     moving          = 0.01f; // of the tree, turned each step
+            bool                                                      show_tree       = false; // debug_draw lines to the first few levels
+            TransformHandle                                           wheel;
+            std::array<TransformHandle, ParticleSystem::MAX_EMITTERS> arms;
+            int                                                       arm_count = 0; // the fountains the arms were spaced for
+            float                                                     angle     = 0.0f;
+            std::vector<TransformHandle>                              tree;       // breadth first, so node i's parent is (i - 1) / 4
+            std::size_t                                               cursor = 0; // where the next step's slice starts
+        } hierarchy;
+
+        // the first press in lazy mode starts the audio and plays once the sound is in
+        enum class PendingPlay
+        {
+            None,
+            Mono,
+            Stereo,
+            QuietQuacks
+        };
+
+        // a quack that follows its duck by handle, and stops when the duck is gone
+        struct QuackingDuck
+        {
+            SoundTicket  emitter;
+            EntityHandle duck;
+        };
 
+        const AudioDevice*           audio        = nullptr;
+        SoundCache*                  sounds       = nullptr;
+        SoundHandle                  quack;
+        VoicePool                    voices;
+        AudioEffects                 effects;
+        SpatialAudio                 spatial;
+        AudioThread                  audio_thread; // owns the three above once SetupAudio starts it
+        AudioStats                   audio_stats;
+        const AudioStreamer*         streamer = nullptr;
+        std::vector<QuackingDuck>    quacking_ducks;
+        int                          quacking_requested = 0;
+        AudioOcclusion               occlusion;
+        std::vector<OcclusionSource> occlusion_sources; // the quacking ducks', in the same order
+        std::shared_ptr<AudioStream> stereo_stream;
+        std::vector<unsigned char>   stereo_ogg; // the stream's file, when the pack had to decompress it
+        MusicPlayer                  music;
+        float                        music_crossfade = static_cast<float>(MusicPlayer::DEFAULT_CROSSFADE_SECONDS);
+        PendingPlay                  pending_play = PendingPlay::None;
+        int                          reverb_zone  = -1; // for "Play Mono SFX"; the quiet quacks go round every zone
+        bool                         has_audio    = false;
+
+        // "Play Mono SFX" press to the mixer starting the voice, plus what the driver says it adds after that
+        struct
+        {
+            Uint64      clicked   = 0;
+            SoundTicket sound;
+            double      last_ms   = 0.0;
+            double      mixer_ms  = 0.0;
+            double      output_ms = 0.0;
+            double      total_ms  = 0.0;
+            int         samples   = 0;
+        } latency;
+
+        // short sine grains at a steady rate, the many-voices load, on whichever backend the config picked
         struct
         {
-            GLuint handle = 0;
-            int    width  = 0;
-            int    height = 0;
-            bool   loaded = false;
-        } example_image;
+            std::unique_ptr<SoftwareMixer> mixer; // with AudioBackend::Mixer
+            SoftwareMixer::BufferId        mixer_buffer = 0;
+            ALuint                         al_buffer    = 0;
+            glm::vec3                      listener{ 0.0f };
+            int                            per_second  = 0;
+            double                         owed        = 0.0; // grains due and not started yet, the fraction carried over
+            Uint64                         last_ticks  = 0;
+            std::uint32_t                  seed        = 1;
+            bool                           reverb      = false; // the mixer's convolution reverb over a synthetic hall
+            float                          reverb_wet  = 0.3f;
+            float                          reverb_rt60 = 2.0f; // seconds for the response to fall 60 dB
+        } grains;
 
-        ALuint alBufferHandles[2] = { 0 };
-        ALuint alSourceHandles[2] = { 0 };
+        // the quack's waveform in "Audio Test"
+        struct
+        {
+            float zoom   = 1.0f;
+            float scroll = 0.0f; // which part of a zoomed in view, 0 the start and 1 the end
+        } waveform;
     };
 
     class [[nodiscard]] Application
     {
     public:
-        Application(gsl::czstring title = "Programming Fun App");
+        // `hidden` keeps the window off screen; the scene still renders into its own target
+        explicit Application(gsl::czstring title = "Programming Fun App", bool hidden = false, const AppConfig& config = {});
         ~Application();
 
         Application(const Application&)                = delete;
@@ -67,70 +582,577 @@ namespace
 
         void Update();
         bool IsDone() const noexcept;
+        // Redraw only on input, invalidation or running animation/audio instead of every iteration
+        void SetReactive(bool enabled) noexcept;
+        void SetFramePacing(const PacingSettings& settings);
+        // The page's visibilitychange on the web: draws nothing, like a minimized window, and pauses the audio device and the stream refills
+        void SetPageVisible(bool visible);
+        void SetResolution(const ResolutionSettings& settings);
+        void SetAntiAliasing(const AntiAliasSettings& settings);
+        void SetViewports(const ViewportSettings& settings);
+        // Where the Application window's "save settings" writes what is running now
+        void SetConfigFile(std::filesystem::path filename);
+        // Finishes by itself once startup_trace has both the first frame and the startup loads, for startup-benchmark
+        void ExitAfterStartup() noexcept;
+        // Scripted run: uncapped, fixed time step, no platform windows; writes the report and finishes by itself
+        void StartBenchmark(const BenchmarkSettings& settings);
+        // Uncapped, times each upload path with `frame_bytes` a frame, prints the results and finishes by itself
+        void StartUploadBenchmark(std::size_t frame_bytes);
+        // Renders the list's scenes to images as fast as it can on the hidden window and finishes by itself; false when the list is unusable
+        bool StartBatchRender(const BatchSettings& settings);
+        // Moves GL submission to its own thread; call before the first Update. False where that isn't possible.
+        bool StartRenderThread();
+        // Textures of their own are created on a loader thread's shared context; before StartRenderThread. False where there's one context.
+        bool StartUploadThread();
+        // Both step the simulation by the fixed step every frame, so the same frame of a recording and its replay
+        // see the same scene; frames count from the first one after the startup loads landed
+        void RecordInput(std::filesystem::path filename);
+        // Live input only reaches the window events and quit while replaying; finishes with the recording
+        bool ReplayInput(const std::filesystem::path& filename);
+        // The stress ducks from a binary scene, as scene-converter writes them; false, with the ducks as they were, when it won't open
+        bool LoadScene(const std::filesystem::path& filename);
 
         [[maybe_unused]] void ForceResize(int desired_width, int desired_height) const;
 
+        // Instead of the destructor: writes what still has to reach the disk or the network, then lets the GL and AL
+        // contexts take their objects with them and ends the process without deleting anything one by one
+        [[noreturn]] void ExitFast();
+
     private:
-        void setupSDLWindow(gsl::czstring title);
+        enum class InputMode
+        {
+            Live,
+            Recording,
+            Replaying
+        };
+
+        void setupSDLWindow(gsl::czstring title, bool hidden);
         void setupOpenGL();
         void setupImGui();
+        // the renderers' shaders, the label font and Demo::Setup; the web build does these after its first paint
+        void setupScene();
+        // web build: a cleared frame so the page shows something, then setupScene on the next iteration
+        void deferredStartup();
         void updateWindowEvents();
+        void waitForWork();
+        bool needsRedraw() const;
+        void invalidate(int frames) noexcept;
+        // redraw even if the UI comes out identical, for changes the UI hash can't see
+        void invalidateScene() noexcept;
+        void setVisible(bool visible);
+        // lazy and prewarm modes: opens the device and sets up the demo's audio once something wants it
+        void updateAudio();
+        // F9: start a profiler capture, or write the running one into the working directory
+        void toggleCapture();
+        // F12: the next frame, Shift+F12: the next FRAME_CAPTURE_SEQUENCE, as PNGs in the working directory
+        void startFrameCapture(int frames);
+        // decodes whatever changed under the asset root again; the loaders swap it in over the next frames
+        void reloadChangedAssets();
+        // tells the texture loader which of its textures the recorded frame draws, so idle ones can be demoted
+        void markDrawnTextures(FramePacket& frame);
+        // the knobs as they are now, restart-only ones as they were configured
+        AppConfig currentConfig() const;
+        void      drawConfigImGui();
+        void advanceBenchmark(Uint64 now);
+        void recordBenchmark(Uint64 frame_begin, bool is_threaded);
+        void advanceBatch(Uint64 now);
+        // the HUD, hitch detector and telemetry stream's share of the frame
+        void              recordFrameMetrics(Uint64 frame_begin, bool is_threaded);
+        PerfHud::Counters frameCounters() const;
+        FramePacket& beginPacket();
+        void         renderFrame(FramePacket& frame, bool gpu_timing);
+        // the scene up to the UI, drawn through `window`: the backbuffer, or the picture UiDamageTarget keeps
+        void addScenePasses(FramePacket& frame, RenderGraph::Resource backbuffer, RenderGraph::Resource scene, RenderGraph::Resource window);
+        // the frame's sorted commands into whatever is bound
+        void drawScene(FramePacket& frame);
+        // each due scene view's run of commands into its own window's backbuffer; leaves ptr_window current
+        void drawSceneViews(FramePacket& frame);
+        // sorted commands, a layer's run at a time; returns the runs
+        int drawCommands(FramePacket& frame, const glm::mat4& projection, std::span<const RenderCommand> commands);
+        // one layer's run of sorted commands
+        void drawLayer(FramePacket& frame, const glm::mat4& projection, RenderLayer layer, std::span<const RenderCommand> commands);
 
     private:
+        AssetPack                 asset_pack;  // before the pool so in-flight decodes never outlive the mapping
+        AssetRegistry             assets;      // before the loaders, which take their entries out on Shutdown
+        AssetFetcher              fetcher;     // the web build's downloads; before the scheduler, which points at it
+        AsyncFileReader           file_reader; // loose files read ahead of their decodes; before the pool, whose jobs take from it
+        WorkerPool                workers;
+        LoadScheduler             loads{ workers }; // the loaders' decodes wait here for a worker, most urgent first
+        AudioDevice               audio_device; // after the pool, its open job has to finish first
+        ReleaseQueue              releases; // what the loaders and the tilemap let go of, until the GPU is done with it
+        TextureLoader             texture_loader{ loads, assets, releases, &asset_pack };
+        SoundCache                sound_cache{ loads, assets, releases, &asset_pack };
+        AssetTasks                asset_tasks{ loads, texture_loader }; // resumes the coroutines that wait on the loaders
+        AssetTask                 demo_loading;
+        UploadBudget              uploads; // what the GL thread sends this frame, textures then tile chunks then virtual texture pages
+        UploadThread              upload_thread; // whole textures on a context of its own, outside any frame
+        AssetBrowser              asset_browser;
+        AssetWatcher              asset_watcher;
+        AudioStreamer             audio_streamer;
+        SdfFont                   label_font; // before the demo, which lays out with it
         Demo                      demo;
-        gsl::owner<SDL_Window*>   ptr_window = nullptr;
-        gsl::owner<SDL_GLContext> gl_context = nullptr;
-        gsl::owner<ALCdevice*>    al_device  = nullptr;
-        gsl::owner<ALCcontext*>   al_context = nullptr;
-        bool                      is_done    = false;
+        PacingSettings            pacing;
+        AudioSettings             audio_settings;
+        ResolutionSettings        resolution;
+        AntiAliasSettings         anti_aliasing;
+        PostSettings              post_settings;
+        ViewportSettings          viewports;
+        int                       worker_threads = 0; // as configured, 0 for the pool's default
+        bool                      pin_workers    = false; // as configured
+        std::size_t               upload_bytes   = UploadBudget::DEFAULT_BYTES;
+        double                    upload_ms      = UploadBudget::DEFAULT_MS;
+        std::filesystem::path     config_file;
+        std::string               config_status;
+        HardwareCaps              hardware;
+        QualityTier               configured_quality = QualityTier::Auto;
+        QualityTier               quality            = QualityTier::High; // what Auto turned into
+        GpuPreference             gpu_preference     = GpuPreference::Performance;
+        DynamicResolution         dynamic_resolution;
+        FixedTimestep             timestep;
+        InputCollector            input;
+        SceneViews                scene_views; // more windows onto the scene, drawn with gl_context
+        gsl::owner<SDL_Window*>   ptr_window          = nullptr;
+        gsl::owner<SDL_GLContext> gl_context          = nullptr;
+        gsl::owner<SDL_GLContext> upload_context      = nullptr; // shares with gl_context; the main thread's while the render thread runs
+        bool                      is_done             = false;
+        bool                      controllers_started = false;
+        Uint64                    last_ticks          = 0;
+        Uint64                    started_ticks       = SDL_GetPerformanceCounter();
+
+        std::optional<BenchmarkRun> benchmark;
+        Uint64                      benchmark_last_end     = 0;
+        Uint64                      benchmark_gpu_resolved = 0;
+        std::optional<BatchRender>  batch;
+        BatchRender::Step           batch_step             = BatchRender::Step::Load; // this frame's
+        PerfHud                     perf_hud;
+        HitchDetector               hitch_detector;
+        LatencyProbe                latency_probe; // stamps on both sides; see its comment for which calls are whose
+        UploadBenchmark             upload_benchmark;
+        bool                        upload_benchmark_exit  = false; // --benchmark-uploads: print and quit once it's through
+        double                      last_frame_ms          = 0.0; // end to end, what the upload benchmark times its uploads by
+        TelemetrySender             telemetry;
+        std::string                 telemetry_address      = "off"; // as configured, for currentConfig
+        int                         telemetry_hz           = TelemetrySender::DEFAULT_RATE_HZ;
+        Uint64                      hud_last_end           = 0; // 0 after a skipped frame, whose idle time isn't a frame
+        Uint64                      hud_gpu_resolved       = 0;
+        std::uint64_t               hud_latency_measured   = 0; // FramePacer::Stats::measured when last recorded
+
+        // render side: only touched from inside renderFrame once the render thread is running
+        SpriteBatch            sprite_batch;
+        AnimatedSpriteRenderer animated_renderer;
+        MeshRenderer           mesh_renderer;
+        ParticleSystem         particle_system;
+        double                 particle_time = 0.0; // the ParticleDraw::time it last stepped to
+        TextRenderer           text_renderer;
+        TilemapRenderer        tilemap_renderer;
+        DebugDrawRenderer      debug_renderer;
+        GpuPicker              gpu_picker;
+        RenderTarget           scene_target;
+        LightRenderer          light_renderer; // over scene_target, before post_process
+        PostProcess            post_process;   // between scene_target and its upscale
+        RenderGraph            render_graph; // the passes from the scene to the backbuffer, rebuilt every frame
+        FrameCapture           frame_capture;
+        ImGuiRenderer          imgui_renderer;
+        UiDamageTarget         ui_target; // the window's picture between frames, while ui_damage is on
+        FramePacer             frame_pacer;
+        RenderThread           render_thread;
+
+        // sorting space for the frame's commands, and the chunks of the tilemap's and the static sprites' runs in command order
+        std::vector<RenderCommand>                         command_scratch;
+        std::vector<TileChunkDraw>                         tile_chunk_scratch;
+        std::vector<RetainedSpriteRun>                     static_run_scratch;
+        // the animated sprite set the renderer holds, kept so a new one is told apart from it by pointer
+        std::shared_ptr<const std::vector<AnimatedSprite>> animated_uploaded;
+        // the same for the model, and the meshes made from its parts: each part's first level, the others after it
+        std::shared_ptr<const ModelData> model_uploaded;
+        std::vector<MeshId>              model_meshes;
+
+        // main thread pushes each submitted frame's input, the render side keeps the newest it finds
+        SpscQueue<InputSnapshot, 4> input_queue;
+        InputSnapshot               render_input;
+
+        FrameArenas                                             frame_arenas;
+        std::array<FramePacket*, FrameArenas::FRAMES_IN_FLIGHT> packets{}; // constructed in their frame's arena
+        int                                                     packet_slot = 0;
+        SpriteBatch::Stats                                      last_sprite_stats;
+        SpriteBatch::Stats                                      last_static_sprite_stats;
+        AnimatedSpriteRenderer::Stats                           last_animated_stats;
+        MeshRenderer::Stats                                     last_mesh_stats;
+        ParticleSystem::Stats                                   last_particle_stats;
+        TextRenderer::Stats                                     last_text_stats;
+        TilemapRenderer::Stats                                  last_tilemap_stats;
+        DebugDrawRenderer::Stats                                last_debug_stats;
+        LightRenderer::Stats                                    last_light_stats;
+        RenderCommandStats                                      last_command_stats;
+        std::uint64_t                                           last_input_lead = 0;
+        FramePacer::Stats                                       last_pacer_stats;
+        glm::ivec2                                              last_scene_allocation{ 0 };
+        int                                                     last_scene_reallocations = 0;
+        RenderGraph::Stats                                      last_graph_stats;
+        FrameCapture::Stats                                     last_capture_stats;
+        ImGuiRenderer::Stats                                    last_imgui_stats;
+        UiDamageTarget::Stats                                   last_ui_damage_stats;
+
+        // reactive mode keeps drawing for a few frames after input so ImGui hover and focus can settle
+        static constexpr int    REDRAW_FRAMES_AFTER_INPUT = 3;
+        static constexpr Uint32 IDLE_WAKE_MS              = 250;
+        // minimized or hidden: keep loading and streaming, skip drawing entirely
+        static constexpr Uint32 HIDDEN_WAKE_MS            = 100;
+        static constexpr double MAX_PARTICLE_STEP         = 0.1;
+        static constexpr int    FRAME_CAPTURE_SEQUENCE    = 120; // two seconds at 60 Hz
+        bool                    is_visible                = true;
+        bool                    reactive                  = false;
+        bool                    damage_ui                 = false; // draw only what UiDamage finds on frames where the scene holds still
+        UiDamage                ui_damage;
+        bool                    show_gl_stats             = true;
+        bool                    show_asset_browser        = false;
+        bool                    show_perf_hud             = true;
+        bool                    pick_on_click             = true;
+        float                   pick_extent               = 16.0f; // PickRequest::extent
+        std::uint64_t           pick_sequence             = 0;
+        std::uint64_t           pick_handled              = 0; // the latest GpuPicker result passed on to the demo
+        bool                    has_pick_cursor           = false; // a click waiting for the next recorded frame
+        glm::vec2               pick_cursor{ 0.0f };
+        // reuse ImGui's buffers when its draw data hashes the same, and in reactive mode skip such frames outright
+        bool                    cache_ui                  = true;
+        bool                    scene_changed             = true;
+        std::uint64_t           presented_ui_hash         = 0;
+        glm::ivec2              presented_scene_size{ 0 };
+        int                     redraw_frames             = REDRAW_FRAMES_AFTER_INPUT;
+        Uint64                  frames_drawn              = 0;
+        bool                    is_scene_ready            = true; // false until deferredStartup has run setupScene
+#if defined(__EMSCRIPTEN__)
+        bool                    has_painted               = false;
+        double                  first_paint_ms            = 0.0; // since navigation start
+#endif
+        Uint64                  frames_skipped            = 0;
+        Uint64                  frames_unchanged          = 0;
+        Uint64                  frames_hidden             = 0;
+        int                     captures_written          = 0;
+        int                     frame_captures_started    = 0;
+        int                     frame_capture_left        = 0; // frames of the current one still to be captured
+        int                     frame_capture_index       = 0;
+        bool                    hot_reload                = false;
+        int                     assets_reloaded           = 0;
+        bool                    decoded_cache_reported    = false; // also: the startup loads have landed
+        bool                    exit_after_startup        = false;
+        InputMode               input_mode                = InputMode::Live;
+        InputLog                input_log;
+        std::filesystem::path   input_log_file;
+        std::uint32_t           input_frame               = 0; // polls since the startup loads landed
+
+        std::vector<std::filesystem::path> changed_assets; // the watcher's latest Poll
     };
 }
 
 #if defined(__EMSCRIPTEN__)
 #    include <emscripten.h>
 #    include <emscripten/bind.h>
+#    include <emscripten/html5.h>
+#    if defined(__EMSCRIPTEN_PTHREADS__)
+#        include <emscripten/threading.h>
+#    endif
+
+// Web build: compile with -msimd128, or audio_kernels and math_kernels only have their scalar versions (the
+// time-to-interactive line says which ones run), and link with -sFETCH=1 for the AssetFetcher. The Application
+// paints once before setting up its scene, so the page shows while the shaders compile.
+//
+// Threaded variant: -pthread with -sPROXY_TO_PTHREAD -sOFFSCREENCANVAS_SUPPORT -sOFFSCREEN_FRAMEBUFFER and
+// -sPTHREAD_POOL_SIZE=navigator.hardwareConcurrency. main and this loop then run on a worker that owns the canvas,
+// the WorkerPool and the audio thread get real threads, and the page's own thread only handles the DOM and input.
+// It needs SharedArrayBuffer, which browsers only give cross-origin isolated pages (COOP/COEP headers); the page
+// loads the single-threaded build instead when `self.crossOriginIsolated` is false. Both are the same source.
+//
+// Side modules: with -DSIDE_MODULES=1 link the program with -sMAIN_MODULE=1, and video_clip.cpp and video_player.cpp
+// on their own with -sSIDE_MODULE=1 into video.wasm, served next to it; side_modules fetches it the first time the
+// Video window is enabled. Serve the .wasm files as application/wasm so the main one compiles while it downloads.
 
 void main_loop(Application* application)
 {
-    if (gNeedResize)
+    if (const std::uint32_t size = gRequestedSize.exchange(0, std::memory_order_acquire); size != 0)
     {
-        application->ForceResize(gWindowWidth, gWindowHeight);
-        gNeedResize = false;
+        const int width  = static_cast<int>(size >> 16);
+        const int height = static_cast<int>(size & 0xFFFF);
+        if (width != gWindowWidth || height != gWindowHeight)
+        {
+            gWindowWidth  = width;
+            gWindowHeight = height;
+            application->ForceResize(gWindowWidth, gWindowHeight);
+        }
     }
     application->Update();
     if (application->IsDone())
         emscripten_cancel_main_loop();
 }
 
+// SDL only hears of it once the loop runs again, and a hidden tab's loop on a timer still runs, throttled; this
+// stops it, the audio with it, as the tab goes. Registered from the loop's thread, which is where it is called
+EM_BOOL on_visibility_change([[maybe_unused]] int event_type, const EmscriptenVisibilityChangeEvent* event, void* user_data)
+{
+    Application* application = static_cast<Application*>(user_data);
+    if (application->IsDone())
+        return EM_FALSE;
+    application->SetPageVisible(!event->hidden);
+    if (event->hidden)
+        emscripten_pause_main_loop();
+    else
+        emscripten_resume_main_loop();
+    return EM_FALSE;
+}
+
 EMSCRIPTEN_BINDINGS(main_window)
 {
     emscripten::function(
         "setWindowSize", emscripten::optional_override(
                              [](int sizeX, int sizeY)
                              {
-                                 sizeX = (sizeX < 400) ? 400 : sizeX;
-                                 sizeY = (sizeY < 400) ? 400 : sizeY;
-                                 if (sizeX != gWindowWidth || sizeY != gWindowHeight)
-                                 {
-                                     gNeedResize   = true;
-                                     gWindowWidth  = sizeX;
-                                     gWindowHeight = sizeY;
-                                 }
+                                 // on the page's thread, which in the threaded build isn't the one running main_loop
+                                 sizeX = std::clamp(sizeX, 400, 0xFFFF);
+                                 sizeY = std::clamp(sizeY, 400, 0xFFFF);
+                                 gRequestedSize.store(static_cast<std::uint32_t>(sizeX) << 16 | static_cast<std::uint32_t>(sizeY), std::memory_order_release);
                              }));
 }
 #endif
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[])
+namespace
+{
+    bool has_flag(int argc, char* argv[], std::string_view name)
+    {
+        return std::find_if(argv + 1, argv + argc, [name](const char* argument) { return argument == name; }) != argv + argc;
+    }
+
+    // value of "--name value" or "--name=value", nullptr when absent
+    const char* find_option(int argc, char* argv[], std::string_view name)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+            if (argument == name && i + 1 < argc)
+                return argv[i + 1];
+            if (argument.size() > name.size() && argument.starts_with(name) && argument[name.size()] == '=')
+                return argv[i] + name.size() + 1;
+        }
+        return nullptr;
+    }
+
+    // "--benchmark" plus optional "--benchmark-frames", "-warmup", "-sprites", "-markers" counts and "--benchmark-report" path
+    std::optional<BenchmarkSettings> parse_benchmark(int argc, char* argv[])
+    {
+        if (!has_flag(argc, argv, "--benchmark"))
+            return std::nullopt;
+        BenchmarkSettings settings;
+        const auto        count = [argc, argv](std::string_view name, int& out_count)
+        {
+            if (const char* value = find_option(argc, argv, name); value != nullptr && !BenchmarkRun::ParseCount(value, out_count))
+                throw_error_message("Expected a positive count for ", name, ": ", value);
+        };
+        count("--benchmark-frames", settings.frames);
+        count("--benchmark-warmup", settings.warmup_frames);
+        count("--benchmark-sprites", settings.sprites);
+        count("--benchmark-markers", settings.markers);
+        if (const char* report = find_option(argc, argv, "--benchmark-report"); report != nullptr)
+            settings.report = report;
+        return settings;
+    }
+
+    // "--batch-render list" plus optional "--batch-output" directory and "--batch-settle" frames
+    std::optional<BatchSettings> parse_batch(int argc, char* argv[])
+    {
+        const char* list = find_option(argc, argv, "--batch-render");
+        if (list == nullptr)
+            return std::nullopt;
+        BatchSettings settings;
+        settings.list = list;
+        if (const char* output = find_option(argc, argv, "--batch-output"); output != nullptr)
+            settings.output = output;
+        if (const char* settle = find_option(argc, argv, "--batch-settle"); settle != nullptr && !BenchmarkRun::ParseCount(settle, settings.settle_frames))
+            throw_error_message("Expected a positive count for --batch-settle: ", settle);
+        return settings;
+    }
+}
+
+int main(int argc, char* argv[])
 try
 {
-    Application application;
+    // before SDL allocates anything, so all of its heap is counted
+    allocation_counter::InstallSdlHooks();
+    startup_trace::Instant("main");
+    // messages print from the logger's thread from here on; what is still queued prints on the way out
+    logger::Start();
+    const auto stop_logger = gsl::finally([] { logger::Stop(); });
+    // a Chrome trace of everything up to the first presented frame
+    if (const char* trace = find_option(argc, argv, "--startup-trace"); trace != nullptr)
+        startup_trace::SetOutput(trace);
+    // a ring file another run left, as a Chrome trace next to it
+    if (const char* ring = find_option(argc, argv, "--convert-trace-ring"); ring != nullptr)
+    {
+        const std::filesystem::path output = std::filesystem::path{ ring }.replace_extension(".json");
+        if (!profiler::WriteRingTrace(ring, output))
+            return 1;
+        std::cout << "Trace ring " << ring << " written to " << output << '\n';
+        return 0;
+    }
+    // the flight recorder in a mapped file from here on, before any other thread records, so a crash or a kill
+    // leaves its last seconds behind; the next run with the same file converts them
+    if (const char* ring = find_option(argc, argv, "--trace-ring"); ring != nullptr)
+        profiler::MapRecording(ring);
+    const auto close_ring = gsl::finally([] { profiler::CloseRecording(); });
+    if (has_flag(argc, argv, "--benchmark-entities"))
+    {
+        // layouts only, no window; "--benchmark-entities-count N" for other than a million
+        int entities = 1'000'000;
+        if (const char* value = find_option(argc, argv, "--benchmark-entities-count"); value != nullptr && !BenchmarkRun::ParseCount(value, entities))
+            throw_error_message("Expected a positive count for --benchmark-entities-count: ", value);
+        entity_benchmark::Print(std::cout, entity_benchmark::Run(entities));
+        return 0;
+    }
+    if (has_flag(argc, argv, "--benchmark-math"))
+    {
+        // every kernel level against glm; "--benchmark-math-count N" for other than 100k points
+        int points = 100'000;
+        if (const char* value = find_option(argc, argv, "--benchmark-math-count"); value != nullptr && !BenchmarkRun::ParseCount(value, points))
+            throw_error_message("Expected a positive count for --benchmark-math-count: ", value);
+        const math_benchmark::Result result = math_benchmark::Run(points);
+        math_benchmark::Print(std::cout, result);
+        return math_benchmark::Passed(result) ? 0 : 1;
+    }
+    if (has_flag(argc, argv, "--benchmark-pixels"))
+    {
+        // every kernel level against the scalar one; "--benchmark-pixels-size N" for an N x N image instead of 2048
+        int size = 2048;
+        if (const char* value = find_option(argc, argv, "--benchmark-pixels-size"); value != nullptr && !BenchmarkRun::ParseCount(value, size))
+            throw_error_message("Expected a positive count for --benchmark-pixels-size: ", value);
+        const pixel_benchmark::Result result = pixel_benchmark::Run(size);
+        pixel_benchmark::Print(std::cout, result);
+        return pixel_benchmark::Passed(result) ? 0 : 1;
+    }
+    if (has_flag(argc, argv, "--benchmark-broadphase"))
+    {
+        // sort and sweep over 10k and 100k moving boxes; "--benchmark-broadphase-count N" for N only
+        std::vector<int> counts{ 10'000, 100'000 };
+        if (const char* value = find_option(argc, argv, "--benchmark-broadphase-count"); value != nullptr)
+        {
+            counts.resize(1);
+            if (!BenchmarkRun::ParseCount(value, counts.front()))
+                throw_error_message("Expected a positive count for --benchmark-broadphase-count: ", value);
+        }
+        bool passed = true;
+        for (const int boxes : counts)
+        {
+            const broadphase_benchmark::Result result = broadphase_benchmark::Run(boxes);
+            broadphase_benchmark::Print(std::cout, result);
+            passed = passed && broadphase_benchmark::Passed(result);
+        }
+        return passed ? 0 : 1;
+    }
+    resolve_asset_root(argc, argv);
+#if !defined(__EMSCRIPTEN__)
+    if (has_flag(argc, argv, "--benchmark-audio"))
+    {
+        // escalating one-shots on every backend, no window; "--benchmark-audio-seconds N" for other than 2 s a rate
+        int seconds = static_cast<int>(audio_benchmark::STEP_SECONDS);
+        if (const char* value = find_option(argc, argv, "--benchmark-audio-seconds"); value != nullptr && !BenchmarkRun::ParseCount(value, seconds))
+            throw_error_message("Expected a positive count for --benchmark-audio-seconds: ", value);
+        WorkerPool workers;
+        audio_benchmark::Print(std::cout, audio_benchmark::Run(workers, audio_benchmark::DEFAULT_RATES, seconds));
+        return 0;
+    }
+#endif
+    if (const char* shader_directory = find_option(argc, argv, "--shader-cache"); shader_directory != nullptr)
+        shader_cache::SetDirectory(std::string_view{ shader_directory } == "off" ? std::filesystem::path{} : std::filesystem::path{ shader_directory });
+    if (const char* decoded_directory = find_option(argc, argv, "--decoded-cache"); decoded_directory != nullptr)
+        decoded_cache::SetDirectory(std::string_view{ decoded_directory } == "off" ? std::filesystem::path{} : std::filesystem::path{ decoded_directory });
+    const std::optional<BenchmarkSettings> benchmark = parse_benchmark(argc, argv);
+    const std::optional<BatchSettings>     batch     = parse_batch(argc, argv);
+    if (benchmark && batch)
+        throw_error_message("--benchmark and --batch-render each want the frame loop to themselves");
+    // the driver's warnings in the log; "--gl-debug-sync" reports inside the offending call, for a breakpoint
+    gl_debug::Request(gl_debug::Settings{ .enabled = has_flag(argc, argv, "--gl-debug") || has_flag(argc, argv, "--gl-debug-sync"), .synchronous = has_flag(argc, argv, "--gl-debug-sync") });
+    // "--gl-no-error on|off" over the build's default; a debug context always checks
+    gl_context::Settings context_settings;
+    if (const char* no_error = find_option(argc, argv, "--gl-no-error"); no_error != nullptr)
+        context_settings.no_error = std::string_view{ no_error } == "on";
+    context_settings.no_error = context_settings.no_error && !gl_debug::Requested().enabled;
+    gl_context::Request(context_settings);
+    // "--exit fast|full" over the build's default: a release build leaves its objects to the contexts and the OS,
+    // a debug build deletes each one so the leak checks and the memory tracker still see them go
+#if defined(NDEBUG)
+    [[maybe_unused]] bool fast_exit = true;
+#else
+    [[maybe_unused]] bool fast_exit = false;
+#endif
+    if (const char* exit_mode = find_option(argc, argv, "--exit"); exit_mode != nullptr)
+        fast_exit = std::string_view{ exit_mode } == "fast";
+    // the settings file, "--config off" for none, then every setting's own "--name value" on top
+    AppConfig             config;
+    std::filesystem::path config_file = app_config::DEFAULT_FILENAME;
+    if (const char* file = find_option(argc, argv, "--config"); file != nullptr)
+        config_file = std::string_view{ file } == "off" ? std::filesystem::path{} : std::filesystem::path{ file };
+    if (!config_file.empty() && app_config::Load(config_file, config))
+        std::cout << "Settings from " << config_file << '\n';
+    for (const app_config::Key& key : app_config::Keys())
+    {
+        if (const char* value = find_option(argc, argv, "--" + std::string{ key.name }); value != nullptr && !app_config::Set(key, value, config))
+            throw_error_message("Unknown --", key.name, " value (", key.expected, "): ", value);
+    }
+    if (has_flag(argc, argv, "--reactive"))
+        config.reactive = true;
+    if (has_flag(argc, argv, "--ui-damage"))
+        config.ui_damage = true;
+    if (has_flag(argc, argv, "--no-viewports"))
+        config.viewports.enabled = false;
+    // benchmark runs and batch images stay comparable across machines unless asked for a tier
+    if ((benchmark || batch) && !app_config::IsGiven(config, "quality"))
+        config.quality = QualityTier::High;
+    Application application{ "Programming Fun App", benchmark.has_value() || batch.has_value(), config };
+    application.SetConfigFile(config_file.empty() ? std::filesystem::path{ app_config::DEFAULT_FILENAME } : config_file);
+    // startup-benchmark's runs: out once the startup trace is written, or once the milestones are printed without one
+    if (has_flag(argc, argv, "--exit-after-startup"))
+        application.ExitAfterStartup();
+    if (benchmark)
+        application.StartBenchmark(*benchmark);
+    if (batch && !application.StartBatchRender(*batch))
+        return 1;
+    if (const char* recording = find_option(argc, argv, "--record-input"); recording != nullptr)
+        application.RecordInput(recording);
+    if (const char* replay = find_option(argc, argv, "--replay-input"); replay != nullptr && !application.ReplayInput(replay))
+        throw_error_message("Can't replay --replay-input ", replay);
+    if (const char* scene = find_option(argc, argv, "--scene"); scene != nullptr && !application.LoadScene(scene))
+        throw_error_message("Can't load --scene ", scene);
+#if !defined(__EMSCRIPTEN__)
+    if (!has_flag(argc, argv, "--no-upload-thread") && !application.StartUploadThread())
+        std::cout << "Upload thread unavailable, uploading on the main thread\n";
+#endif
+    if (has_flag(argc, argv, "--render-thread") && !application.StartRenderThread())
+        std::cout << "Render thread unavailable, drawing on the main thread\n";
+    if (has_flag(argc, argv, "--benchmark-uploads"))
+    {
+        // every upload path in turn; "--benchmark-uploads-mb N" for other than 4 MB a frame
+        int megabytes = 4;
+        if (const char* value = find_option(argc, argv, "--benchmark-uploads-mb"); value != nullptr && !BenchmarkRun::ParseCount(value, megabytes))
+            throw_error_message("Expected a positive count for --benchmark-uploads-mb: ", value);
+        application.StartUploadBenchmark(static_cast<std::size_t>(megabytes) * 1024 * 1024);
+    }
 #if !defined(__EMSCRIPTEN__)
     while (!application.IsDone())
     {
         application.Update();
     }
+    // taken before teardown so the numbers reflect the running app; compare runs with a diff
+    if (const char* snapshot = find_option(argc, argv, "--memory-snapshot"); snapshot != nullptr)
+        memory_tracker::WriteSnapshot(snapshot);
+    if (fast_exit)
+        application.ExitFast();
 #else
     // https://kripken.github.io/emscripten-site/docs/api_reference/emscripten.h.html#c.emscripten_set_main_loop_arg
+#    if defined(__EMSCRIPTEN_PTHREADS__)
+    // without -sPROXY_TO_PTHREAD every blocking wait (a ParallelFor, the audio device) stalls the page
+    if (emscripten_is_main_browser_thread())
+        std::cout << "Threaded web build on the page's thread; link with -sPROXY_TO_PTHREAD to move it to a worker\n";
+#    endif
+    emscripten_set_visibilitychange_callback(&application, EM_FALSE, &on_visibility_change);
+    // requestAnimationFrame until the first frame, where the FramePacer switches to what `pacing` asks for
     int simulate_infinite_loop  = 1;
     int match_browser_framerate = -1;
     emscripten_set_main_loop_arg(reinterpret_cast<void (*)(void*)>(&main_loop), reinterpret_cast<void*>(&application), match_browser_framerate, simulate_infinite_loop);
@@ -151,384 +1173,3724 @@ namespace
         // https://wiki.libsdl.org/SDL_GL_SetAttribute
         if (const auto success = SDL_GL_SetAttribute(attr, value); success != 0)
         {
-            std::cerr << "Failed to Set GL Attribute: " << SDL_GetError() << '\n';
+            LOG_WARN("Failed to Set GL Attribute: ", SDL_GetError());
         }
     }
-
-    template <typename... Messages>
-    [[noreturn]] void throw_error_message(Messages&&... more_messages)
-    {
-        std::ostringstream sout;
-        (sout << ... << more_messages);
-        std::cerr << sout.str() << '\n';
-        throw std::runtime_error{ sout.str() };
-    }
 }
 
-Application::Application(gsl::czstring title)
+Application::Application(gsl::czstring title, bool hidden, const AppConfig& config)
+    : workers{ static_cast<unsigned>(config.worker_threads), config.pin_workers }, loads{ workers, config.loads_in_flight }, pacing{ config.pacing }, audio_settings{ config.audio },
+      resolution{ config.resolution }, anti_aliasing{ config.anti_aliasing }, post_settings{ config.post }, viewports{ config.viewports }, worker_threads{ config.worker_threads },
+      pin_workers{ config.pin_workers }, upload_bytes{ static_cast<std::size_t>(config.upload_kb) * 1024 }, upload_ms{ config.upload_ms }, reactive{ config.reactive },
+      damage_ui{ config.ui_damage }
 {
     if (title == nullptr || title[0] == '\0')
         throw_error_message("App title shouldn't be empty");
-    setupSDLWindow(title);
+    gWindowWidth  = config.window_size.x;
+    gWindowHeight = config.window_size.y;
+    profiler::SetThreadName("main");
+    sound_cache.SetStorage(audio_settings.sound_storage);
+#if defined(__EMSCRIPTEN__)
+    // textures and sounds download as they are asked for, so the first frame doesn't wait for all of them
+    loads.SetFetcher(&fetcher);
+#else
+    // loose files are read on the reader's thread, the workers only decode
+    loads.SetReader(&file_reader);
+#endif
+    {
+        // optional: without a pack every loader reads loose files from the asset root
+        const startup_trace::Scope trace{ "Open asset pack" };
+        if (const auto pack_path = get_base_path() / AssetPack::DEFAULT_FILENAME; asset_pack.Open(pack_path))
+            std::cout << "Asset pack " << pack_path << " (" << asset_pack.EntryCount() << " files)\n";
+        // a big compressed entry's blocks decode on every worker, the job that asked for it helping
+        asset_pack.SetParallelFor([this](std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body) { workers.ParallelFor(count, grain, body); });
+    }
+    if (audio_settings.startup == AudioStartup::Eager)
+    {
+        // opening the audio device can take longer than all of the GL setup, and touches none of it
+        demo.RequestSounds(sound_cache);
+        audio_device.Open(workers, audio_settings.mix);
+    }
+    gpu_preference = config.gpu;
+    gpu_preference::Apply(gpu_preference);
+    {
+        // the browser's take on the same choice, asked for as the canvas gets its context
+        gl_context::Settings context_settings = gl_context::Requested();
+        context_settings.power_preference     = gpu_preference == GpuPreference::Performance    ? gl_context::PowerPreference::HighPerformance
+                                                : gpu_preference == GpuPreference::BatterySaver ? gl_context::PowerPreference::LowPower
+                                                                                                : gl_context::PowerPreference::Default;
+        gl_context::Request(context_settings);
+    }
+    if (gpu_preference == GpuPreference::BatterySaver && !app_config::IsGiven(config, "pacing"))
+        pacing = PacingSettings{ .mode = PacingMode::TargetFps, .target_fps = gpu_preference::BATTERY_SAVER_FPS };
+    setupSDLWindow(title, hidden);
     setupOpenGL();
     SDL_GetWindowSize(ptr_window, &gWindowWidth, &gWindowHeight);
+    SDL_GL_GetDrawableSize(ptr_window, &gDrawableSize.x, &gDrawableSize.y);
+    {
+        // the tier fills in the scale, AA and upload budget the file and command line left out
+        const startup_trace::Scope trace{ "Hardware probe" };
+        hardware           = hardware_probe::Probe();
+        configured_quality = config.quality;
+        // battery saver trades the pixels for the battery whatever the probe thinks of the GPU
+        if (config.quality != QualityTier::Auto)
+            quality = config.quality;
+        else
+            quality = gpu_preference == GpuPreference::BatterySaver ? QualityTier::Low : hardware_probe::ChooseTier(hardware);
+        AppConfig tiered   = config;
+        app_config::ApplyTier(quality, tiered);
+        resolution    = tiered.resolution;
+        anti_aliasing = tiered.anti_aliasing;
+        upload_bytes  = static_cast<std::size_t>(tiered.upload_kb) * 1024;
+        upload_ms     = tiered.upload_ms;
+        std::cout << "Quality " << app_config::TierName(quality) << (configured_quality == QualityTier::Auto ? " (auto)" : "") << ": GL " << hardware.gl_major << '.'
+                  << hardware.gl_minor << ' ' << hardware.renderer << ", " << hardware.cpu_count << " cores, " << hardware.ram_mb << " MB, " << hardware.fill_gpixels
+                  << " Gpixel/s, probed in " << hardware.probe_ms << " ms\n";
+        std::cout << "GPU preference " << gpu_preference::Name(gpu_preference) << ": running on " << hardware.renderer << " (" << hardware.vendor << ")\n";
+    }
+    hitch_detector.Setup(workers,
+                         HitchDetector::Metadata{ { "gl", std::to_string(hardware.gl_major) + "." + std::to_string(hardware.gl_minor) },
+                                                  { "vendor", hardware.vendor },
+                                                  { "renderer", hardware.renderer },
+                                                  { "gpu_preference", std::string{ gpu_preference::Name(gpu_preference) } },
+                                                  { "cpu_cores", std::to_string(hardware.cpu_count) },
+                                                  { "ram_mb", std::to_string(hardware.ram_mb) },
+                                                  { "workers", std::to_string(workers.ThreadCount()) },
+                                                  { "quality", app_config::TierName(quality) },
+                                                  { "pacing", FramePacer::Format(pacing) },
+                                                  { "frames_in_flight", std::to_string(pacing.frames_in_flight) },
+                                                  { "drawable", std::to_string(gDrawableSize.x) + "x" + std::to_string(gDrawableSize.y) } },
+                         "hitches", config.hitch_ms);
+    telemetry_address = config.telemetry;
+    telemetry_hz      = config.telemetry_hz;
+    scheduling::SetFineTimer(is_visible);
+    if (!TelemetrySender::IsOff(telemetry_address))
+        telemetry.Start(telemetry_address, telemetry_hz);
+    {
+        const startup_trace::Scope trace{ "Demo::Load" };
+        demo_loading = demo.Load(asset_tasks);
+    }
+    asset_browser.Setup(loads, &asset_pack);
     setupImGui();
-    al_device  = alcOpenDevice(nullptr);
-    al_context = alcCreateContext(al_device, nullptr);
-    alcMakeContextCurrent(al_context);
-    demo.Setup();
+    // a benchmark's scene stays what it was scripted to be
+    hot_reload = !hidden && asset_watcher.Start(get_base_path());
+    if (hot_reload)
+        std::cout << "Watching " << get_base_path() << " for asset changes\n";
+#if defined(__EMSCRIPTEN__)
+    // nothing shows until main_loop first returns to the browser, so the first one paints and the second sets up
+    is_scene_ready = false;
+#else
+    setupScene();
+#endif
 }
 
-Application::~Application()
+void Application::setupScene()
 {
-    demo.Shutdown();
+    {
+        const startup_trace::Scope trace{ "Renderer setup" };
+        sprite_batch.Setup();
+        animated_renderer.Setup();
+        mesh_renderer.Setup();
+        particle_system.Setup();
+        text_renderer.Setup();
+        tilemap_renderer.Setup();
+        debug_renderer.Setup();
+        scene_target.Setup();
+        light_renderer.Setup();
+        post_process.Setup();
+        frame_capture.Setup(workers);
+        gpu_picker.Setup();
+        imgui_renderer.Setup();
+        ui_target.Setup();
+        const shader_cache::Stats& shaders = shader_cache::GetStats();
+        std::cout << "Shaders: " << shaders.loaded << " from the cache, " << shaders.submitted << (shaders.parallel ? " compiling in parallel, " : " to compile on first use, ")
+                  << shaders.total_ms << " ms\n";
+    }
+    {
+        // printable ASCII's distance fields, a few milliseconds; the render thread isn't running yet, so the upload is ours
+        const startup_trace::Scope trace{ "Bake label font" };
+        if (label_font.Load(&asset_pack))
+            text_renderer.SetAtlas(label_font.AtlasPixels(), label_font.AtlasSize().x, label_font.AtlasSize().y);
+    }
+    const startup_trace::Scope trace{ "Demo::Setup" };
+    demo.Setup(mesh_renderer, animated_renderer, sprite_batch, particle_system, audio_device, label_font);
+    // the first thing that needs the device; voices and the music stream make their sources
+    if (audio_settings.startup == AudioStartup::Eager && audio_device.Wait())
+        demo.SetupAudio(audio_streamer, asset_pack, audio_settings.backend);
+}
 
-    alcMakeContextCurrent(nullptr);
-    alcDestroyContext(al_context);
-    alcCloseDevice(al_device);
+Application::~Application()
+{
+    scheduling::SetFineTimer(false);
+    telemetry.Stop();
+    // what it still has lands in the loader before anything is torn down
+    upload_thread.Stop();
+    if (render_thread.IsRunning())
+    {
+        render_thread.Stop();
+        SDL_GL_MakeCurrent(ptr_window, gl_context);
+        gl_state::Invalidate();
+        SDL_GL_DeleteContext(upload_context);
+    }
+    for (FramePacket*& packet : packets)
+    {
+        if (packet != nullptr)
+            std::destroy_at(packet);
+        packet = nullptr;
+    }
+    if (input_mode == InputMode::Recording && input_log.Save(input_log_file, input_frame))
+        std::cout << "Input recording of " << input_frame << " frames, " << input_log.EventCount() << " events written to " << std::filesystem::absolute(input_log_file) << '\n';
+    asset_tasks.Shutdown();
+    demo.Shutdown(audio_streamer, workers);
+    sprite_batch.Shutdown();
+    animated_renderer.Shutdown();
+    animated_uploaded.reset();
+    model_uploaded.reset();
+    mesh_renderer.Shutdown();
+    particle_system.Shutdown();
+    text_renderer.Shutdown();
+    tilemap_renderer.Shutdown();
+    debug_renderer.Shutdown();
+    render_graph.Shutdown();
+    light_renderer.Shutdown();
+    post_process.Shutdown();
+    scene_target.Shutdown();
+    frame_capture.Shutdown();
+    gpu_picker.Shutdown();
+    imgui_renderer.Shutdown();
+    ui_target.Shutdown();
+    frame_pacer.Shutdown();
+    latency_probe.Shutdown();
+    upload_benchmark.Stop();
+    asset_browser.Shutdown();
+    texture_loader.Shutdown();
+    sound_cache.Shutdown();
+    audio_streamer.Shutdown();
+    releases.Shutdown(); // the sound buffers go before the AL context
+    audio_device.Close();
+    imgui_fonts::Shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
+    profiler::ShutdownGpu();
+    SDL_GL_DeleteContext(gl_context);
+    scene_views.Shutdown();
+    SDL_DestroyWindow(ptr_window);
+    SDL_Quit();
+}
+
+void Application::ExitFast()
+{
+    scheduling::SetFineTimer(false);
+    telemetry.Stop();
+    // what it still has lands in the loader before anything is torn down
+    upload_thread.Stop();
+    if (render_thread.IsRunning())
+    {
+        render_thread.Stop();
+        SDL_GL_MakeCurrent(ptr_window, gl_context);
+        gl_state::Invalidate();
+        SDL_GL_DeleteContext(upload_context);
+    }
+    if (input_mode == InputMode::Recording && input_log.Save(input_log_file, input_frame))
+        std::cout << "Input recording of " << input_frame << " frames, " << input_log.EventCount() << " events written to " << std::filesystem::absolute(input_log_file) << '\n';
+    // the captures still reading back, then every job already on a worker: encodes, hitch traces, decoded cache entries
+    frame_capture.Shutdown();
+    loads.Close();
+    workers.Stop();
+    if (const char* ini = ImGui::GetIO().IniFilename; ini != nullptr)
+        ImGui::SaveIniSettingsToDisk(ini);
+    // the threads that call AL go before its context; the streams are a handful
+    demo.StopAudioThread();
+    audio_streamer.Shutdown();
+    audio_device.Close();
+    // every texture, buffer and program goes with the context
     SDL_GL_DeleteContext(gl_context);
+    scene_views.Shutdown();
     SDL_DestroyWindow(ptr_window);
     SDL_Quit();
+    logger::Stop();
+    profiler::CloseRecording();
+    std::cout.flush();
+    std::_Exit(0);
 }
 
-void Application::setupSDLWindow(gsl::czstring title)
+void Application::setupSDLWindow(gsl::czstring title, bool hidden)
 {
-    // https://wiki.libsdl.org/SDL_Init
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
     {
-        throw_error_message("Failed to init SDK error: ", SDL_GetError());
+        // https://wiki.libsdl.org/SDL_Init
+        const startup_trace::Scope trace{ "SDL_Init" };
+        // sizes stay in points and the drawable gets every pixel of a high-DPI display, per monitor on Windows
+        SDL_SetHint(SDL_HINT_WINDOWS_DPI_AWARENESS, "permonitorv2");
+        SDL_SetHint(SDL_HINT_WINDOWS_DPI_SCALING, "1");
+        // audio goes through OpenAL, SDL only parses WAVs; controllers come up after the first frame
+        if (SDL_Init(SDL_INIT_VIDEO) < 0)
+        {
+            throw_error_message("Failed to init SDK error: ", SDL_GetError());
+        }
     }
+    input.InstallEventFilter();
 
 #if defined(IS_WEBGL2)
     hint_gl(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     hint_gl(SDL_GL_CONTEXT_MINOR_VERSION, 0);
     hint_gl(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
-// else Desktop will pick the highest OpenGL version by default
+// else Desktop's version is chosen by gl_context::Create, newest first
 #else
     hint_gl(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    if (gl_debug::Requested().enabled)
+        hint_gl(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
 #endif
     hint_gl(SDL_GL_DOUBLEBUFFER, true);
+#if defined(IS_WEBGL2)
+    // nothing draws with depth or stencil, and an opaque canvas composites onto the page without blending
+    hint_gl(SDL_GL_STENCIL_SIZE, 0);
+    hint_gl(SDL_GL_DEPTH_SIZE, 0);
+    hint_gl(SDL_GL_ALPHA_SIZE, 0);
+#else
     hint_gl(SDL_GL_STENCIL_SIZE, 8);
     hint_gl(SDL_GL_DEPTH_SIZE, 24);
+    hint_gl(SDL_GL_ALPHA_SIZE, 8);
+#endif
     hint_gl(SDL_GL_RED_SIZE, 8);
     hint_gl(SDL_GL_GREEN_SIZE, 8);
     hint_gl(SDL_GL_BLUE_SIZE, 8);
-    hint_gl(SDL_GL_ALPHA_SIZE, 8);
-    hint_gl(SDL_GL_MULTISAMPLEBUFFERS, 1);
-    hint_gl(SDL_GL_MULTISAMPLESAMPLES, 4);
+    // the scene multisamples in its own render target; the backbuffer only gets the upscale and ImGui
+    hint_gl(SDL_GL_MULTISAMPLEBUFFERS, 0);
+    hint_gl(SDL_GL_MULTISAMPLESAMPLES, 0);
 
 
     // https://wiki.libsdl.org/SDL_CreateWindow
-    ptr_window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, gWindowWidth, gWindowHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+    const startup_trace::Scope trace{ "SDL_CreateWindow" };
+    const Uint32               visibility = hidden ? static_cast<Uint32>(SDL_WINDOW_HIDDEN) : 0u;
+    const Uint32               flags      = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI | visibility;
+    ptr_window                            = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, gWindowWidth, gWindowHeight, flags);
     if (ptr_window == nullptr)
     {
         throw_error_message("Failed to create window: ", SDL_GetError());
     }
+    startup_trace::Instant("window created");
 }
 
 void Application::setupOpenGL()
 {
-    // https://wiki.libsdl.org/SDL_GL_CreateContext
-    if (gl_context = SDL_GL_CreateContext(ptr_window); gl_context == nullptr)
     {
-        throw_error_message("Failed to create opengl context: ", SDL_GetError());
+        // https://wiki.libsdl.org/SDL_GL_CreateContext
+        const startup_trace::Scope trace{ "SDL_GL_CreateContext" };
+        gl_context = gl_context::Create(ptr_window);
     }
 
     // https://wiki.libsdl.org/SDL_GL_MakeCurrent
     SDL_GL_MakeCurrent(ptr_window, gl_context);
 
-    // http://glew.sourceforge.net/basic.html
-    if (const auto result = glewInit(); GLEW_OK != result)
     {
-        throw_error_message("Unable to initialize GLEW - error: ", glewGetErrorString(result));
+        // http://glew.sourceforge.net/basic.html
+        const startup_trace::Scope trace{ "glewInit" };
+        if (const auto result = glewInit(); GLEW_OK != result)
+        {
+            throw_error_message("Unable to initialize GLEW - error: ", glewGetErrorString(result));
+        }
     }
+    gl_context::Detect();
+    gl_backend::Select();
+    gl_debug::Install();
+    profiler::InitGpu();
 
-    // https://wiki.libsdl.org/SDL_GL_SetSwapInterval
-    constexpr int ADAPTIVE_VSYNC = -1;
-    constexpr int VSYNC          = 1;
-    if (const auto result = SDL_GL_SetSwapInterval(ADAPTIVE_VSYNC); result != 0)
-    {
-        SDL_GL_SetSwapInterval(VSYNC);
-    }
+    frame_pacer.Apply(pacing);
 }
 
 void Application::setupImGui()
 {
+    const startup_trace::Scope trace{ "ImGui init" };
     IMGUI_CHECKVERSION();
+    memory_tracker::InstallImGuiAllocator();
     ImGui ::CreateContext();
     {
         ImGuiIO& io = ImGui::GetIO();
         io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
         io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
     }
+    imgui_fonts::Setup(static_cast<float>(gDrawableSize.x) / static_cast<float>(std::max(gWindowWidth, 1)));
     ImGui_ImplSDL2_InitForOpenGL(ptr_window, gl_context);
     ImGui_ImplOpenGL3_Init();
 }
 
 void Application::Update()
 {
-    updateWindowEvents();
-    demo.Draw();
-
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplSDL2_NewFrame();
-    ImGui::NewFrame();
-    demo.ImGuiDraw();
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    const ImGuiIO& io = ImGui::GetIO();
-    if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+    waitForWork();
+    PROFILE_BEGIN_FRAME();
+    if (!is_scene_ready)
     {
-        ImGui::UpdatePlatformWindows();
-        ImGui::RenderPlatformWindowsDefault();
-        SDL_GL_MakeCurrent(ptr_window, gl_context);
+        deferredStartup();
+        PROFILE_END_FRAME();
+        return;
     }
-    SDL_GL_SwapWindow(ptr_window);
-}
-
-void Application::updateWindowEvents()
-{
-    SDL_Event event = { 0 };
-    while (SDL_PollEvent(&event) != 0)
+    const Uint64 now           = SDL_GetPerformanceCounter();
+    float        delta_seconds = last_ticks == 0 ? 0.0f : static_cast<float>(static_cast<double>(now - last_ticks) / static_cast<double>(SDL_GetPerformanceFrequency()));
+    last_ticks                 = now;
+    // a benchmark, a batch, a recording and a replay simulate the same scene however fast they run
+    constexpr float BENCHMARK_STEP_SECONDS = 1.0f / 60.0f;
+    if (benchmark || batch || input_mode != InputMode::Live)
+        delta_seconds = BENCHMARK_STEP_SECONDS;
+    if (!controllers_started && frames_drawn > 0)
     {
-        ImGui_ImplSDL2_ProcessEvent(&event);
-        switch (event.type)
-        {
-            case SDL_WINDOWEVENT:
-                switch (event.window.event)
-                {
-                    case SDL_WINDOWEVENT_CLOSE:
-                        {
-                            is_done = true;
-                        }
-                        break;
-                    case SDL_WINDOWEVENT_RESIZED:
-                    case SDL_WINDOWEVENT_SIZE_CHANGED:
-                        {
-                            gWindowWidth  = event.window.data1;
-                            gWindowHeight = event.window.data2;
-                            demo.SetDisplaySize(gWindowWidth, gWindowHeight);
-                        }
-                        break;
-                }
-                break;
-            case SDL_QUIT: [[unlikely]] is_done = true; break;
-        }
+        // enumerating HID devices can take a while and the first frame doesn't need them;
+        // controllers already plugged in arrive as SDL_CONTROLLERDEVICEADDED on the next poll
+        controllers_started = true;
+        if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) < 0)
+            LOG_ERROR("Failed to init game controllers: ", SDL_GetError());
     }
-}
-
-bool Application::IsDone() const noexcept
-{
-    return is_done;
-}
-
-void Application::ForceResize(int desired_width, int desired_height) const
-{
-    SDL_SetWindowSize(ptr_window, desired_width, desired_height);
-}
-
-namespace
-{
-    std::optional<std::filesystem::path> try_get_asset_path(const std::filesystem::path& starting_directory)
     {
-        namespace fs        = std::filesystem;
-        fs::path       p    = starting_directory;
-        const fs::path root = p.root_path();
-        do
+        PROFILE_ZONE("Events");
+        updateWindowEvents();
+    }
+    reloadChangedAssets();
+    if (texture_loader.PendingCount() > 0 || sound_cache.PendingCount() > 0 || label_font.PendingCount() > 0)
+        invalidateScene();
+    releases.Collect();
+    scene_views.Collect(releases.LastFrameStats().drawn_frame);
+    latency_probe.Collect();
+    {
+        PROFILE_ZONE("Texture Uploads");
+        GL_STATS_PASS("Uploads");
+        uploads.Begin(upload_bytes, upload_ms);
+        // ahead of the loaders, and not while they load, so their uploads never land in a method's numbers
+        if (upload_benchmark.IsRunning())
         {
-            fs::path assets_folder = fs::absolute(p / "assets");
-            if (fs::is_directory(assets_folder))
+            upload_benchmark.Update(last_frame_ms, texture_loader.PendingCount() > 0 || sound_cache.PendingCount() > 0);
+            invalidateScene();
+            if (!upload_benchmark.IsRunning() && upload_benchmark_exit)
             {
-                return std::optional<fs::path>{ assets_folder };
+                upload_benchmark.Print(std::cout);
+                is_done = true;
             }
-            p = fs::absolute(p / "..");
-        } while (fs::absolute(p) != root);
-        return std::optional<fs::path>{};
-    }
-
-    std::filesystem::path get_base_path()
-    {
-        namespace fs                  = std::filesystem;
-        static fs::path assets_folder = []()
-        {
-            auto result = try_get_asset_path(fs::current_path());
-            if (result)
-                return result.value();
-            // try from the exe path rather than the current working directory
-            const auto base_path = SDL_GetBasePath();
-            result               = try_get_asset_path(base_path);
-            SDL_free(base_path);
-            if (result)
-                return result.value();
-            throw std::runtime_error{ "Failed to find assets folder in parent folders" };
-        }();
-        return assets_folder;
-    }
-
-    // https://github.com/ocornut/imgui/wiki/Image-Loading-and-Displaying-Examples
-    bool LoadTextureFromFile(const std::filesystem::path& filename, GLuint& out_texture, int& out_width, int& out_height)
-    {
-        // Load from file
-        int            image_width  = 0;
-        int            image_height = 0;
-        unsigned char* image_data   = stbi_load(filename.string().c_str(), &image_width, &image_height, NULL, 4);
-        if (image_data == NULL)
-            return false;
-
-        // Create a OpenGL texture identifier
-        GLuint image_texture;
-        glGenTextures(1, &image_texture);
-        glBindTexture(GL_TEXTURE_2D, image_texture);
-
-        // Setup filtering parameters for display
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image_width, image_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
-        stbi_image_free(image_data);
-
-        out_texture = image_texture;
-        out_width   = image_width;
-        out_height  = image_height;
-
-        return true;
+        }
+        upload_thread.Update();
+        texture_loader.Update(uploads);
+        asset_browser.Update(uploads);
+        imgui_fonts::Update(uploads);
     }
-}
-
-namespace
-{
-    ALenum get_openal_format(const SDL_AudioSpec* spec)
+    updateAudio();
+    if (audio_device.IsCurrent())
     {
-        if ((spec->channels == 1) && (spec->format == AUDIO_U8))
-        {
-            return AL_FORMAT_MONO8;
-        }
-        else if ((spec->channels == 1) && (spec->format == AUDIO_S16SYS))
-        {
-            return AL_FORMAT_MONO16;
-        }
-        else if ((spec->channels == 2) && (spec->format == AUDIO_U8))
-        {
-            return AL_FORMAT_STEREO8;
-        }
-        else if ((spec->channels == 2) && (spec->format == AUDIO_S16SYS))
-        {
-            return AL_FORMAT_STEREO16;
-        }
-        else if ((spec->channels == 1) && (spec->format == AUDIO_F32SYS))
-        {
-            return alIsExtensionPresent("AL_EXT_FLOAT32") ? alGetEnumValue("AL_FORMAT_MONO_FLOAT32") : AL_NONE;
-        }
-        else if ((spec->channels == 2) && (spec->format == AUDIO_F32SYS))
-        {
-            return alIsExtensionPresent("AL_EXT_FLOAT32") ? alGetEnumValue("AL_FORMAT_STEREO_FLOAT32") : AL_NONE;
-        }
-        return AL_NONE;
+        audio_device.Update();
+        audio_streamer.SetSuspended(audio_device.IsLost() || audio_device.IsPaused());
     }
-}
+    if (audio_device.IsCurrent())
+    {
+        PROFILE_ZONE("Sound Uploads");
+        sound_cache.Update();
+    }
+    asset_tasks.Update();
+    demo_loading.ThrowIfFailed();
+    if (!decoded_cache_reported && texture_loader.PendingCount() == 0 && sound_cache.PendingCount() == 0)
+    {
+        // the startup loads have landed, from the cache or not; the Application window keeps counting
+        decoded_cache::Print(std::cout);
+        decoded_cache_reported = true;
+        startup_trace::Loaded();
+    }
+    if (exit_after_startup && !startup_trace::IsRecording())
+        is_done = true;
+    audio_streamer.Update();
+    if (benchmark)
+        advanceBenchmark(now);
+    if (batch)
+        advanceBatch(now);
+    if (!is_visible)
+    {
+        ++frames_hidden;
+        PROFILE_END_FRAME();
+        return;
+    }
+    if (reactive && !needsRedraw())
+    {
+        ++frames_skipped;
+        hud_last_end = 0;
+        PROFILE_END_FRAME();
+        return;
+    }
+    const bool   is_threaded = render_thread.IsRunning();
+    FramePacket& frame       = beginPacket();
+    frame.viewport_size      = gDrawableSize;
+    frame.pacing             = pacing;
+    frame.batch_image        = batch && batch_step == BatchRender::Step::Capture ? batch->Current().image : std::filesystem::path{};
+    {
+        // the GPU timer only runs when frames render on this thread
+        const bool   has_gpu_time = !is_threaded && profiler::IsGpuTimingSupported() && profiler::GpuFrameCount() > 0;
+        const double gpu_ms       = has_gpu_time ? profiler::LatestGpuFrame().total_ms : -1.0;
+        const float  render_scale = dynamic_resolution.Update(resolution, gpu_ms);
+        const glm::ivec2 base     = DynamicResolution::SceneBase(frame.viewport_size, glm::ivec2{ gWindowWidth, gWindowHeight }, resolution.scene_density);
+        frame.scene_size          = glm::ivec2{ glm::vec2{ base } * render_scale + 0.5f };
+        frame.anti_aliasing       = anti_aliasing;
+        frame.post                = post_settings;
+    }
+    {
+        PROFILE_ZONE("Demo::FixedUpdate");
+        const int   steps        = timestep.Advance(delta_seconds);
+        const float step_seconds = static_cast<float>(timestep.StepSeconds());
+        for (int step = 0; step < steps; ++step)
+            demo.FixedUpdate(step_seconds, workers, input_frame);
+    }
+    {
+        PROFILE_ZONE("Demo::Update");
+        demo.Update(workers);
+    }
+    {
+        // the chunk uploads go out under this frame's upload fence, like the textures'
+        PROFILE_ZONE("Tilemap Chunks");
+        GL_STATS_PASS("Tile Uploads");
+        demo.UpdateTilemap(workers, uploads, releases);
+    }
+    {
+        // only the edited ranges, under the same fence
+        PROFILE_ZONE("Static Sprites");
+        GL_STATS_PASS("Static Sprite Uploads");
+        demo.UpdateStaticSprites(uploads, releases);
+    }
+    {
+        PROFILE_ZONE("Virtual Texture");
+        GL_STATS_PASS("Tile Pages");
+        demo.UpdateVirtualImage(loads, uploads);
+    }
+    {
+        PROFILE_ZONE("Model");
+        demo.UpdateModel(loads, delta_seconds);
+    }
+    {
+        PROFILE_ZONE("Video");
+        GL_STATS_PASS("Video Frames");
+        demo.UpdateVideo(loads, demo.HasAudio() ? &audio_streamer : nullptr, uploads, delta_seconds);
+    }
+    {
+        // glyphs the labels asked for come back from the workers; only the rects they landed in upload
+        PROFILE_ZONE("Glyph Cache");
+        GL_STATS_PASS("Glyph Uploads");
+        label_font.Update(workers);
+        text_renderer.UpdateAtlas(label_font.AtlasPixels(), label_font.AtlasSize().x, label_font.TakeDirtyRects(), uploads);
+    }
+    {
+        PROFILE_ZONE("Demo::Draw");
+        latency_probe.Stamp(frame.latency);
+        const glm::vec2 display_size{ static_cast<float>(gWindowWidth), static_cast<float>(gWindowHeight) };
+        demo.SetCullBounds(scene_views.CullBounds(display_size));
+        // a pick comes back a frame or more after the frame that asked
+        if (const GpuPicker::Result picked = gpu_picker.LastResult(); picked.sequence != pick_handled)
+        {
+            pick_handled = picked.sequence;
+            demo.SetPickedDuck(picked.id);
+        }
+        if (has_pick_cursor)
+        {
+            frame.pick      = PickRequest{ ++pick_sequence, pick_cursor, pick_extent };
+            has_pick_cursor = false;
+        }
+        demo.Draw(timestep.Alpha(), frame, workers);
+        // whatever any thread drew since the last frame, jobs of this one included
+        debug_draw::Collect(frame.debug);
+        if (!frame.debug.lines.empty() || !frame.debug.triangles.empty())
+            frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::Debug, 0, 0, 0), 0, 1 });
+        scene_views.Record(frame, display_size, frames_drawn + 1, workers);
+    }
+    {
+        PROFILE_ZONE("ImGui Build");
+        // the render thread's context holds ImGui's device objects, created by StartRenderThread
+        if (!is_threaded)
+            imgui_fonts::NewFrame();
+        // secondary windows stay off while the render thread owns gl_context
+        imgui_viewports::Apply(viewports, !is_threaded);
+        ImGui_ImplSDL2_NewFrame();
+        // with no button held the backend asks the OS where the cursor is, which isn't where the replay put it
+        if (input_mode == InputMode::Replaying)
+        {
+            // platform windows put ImGui in screen coordinates
+            glm::ivec2 origin{ 0 };
+            if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+                SDL_GetWindowPosition(ptr_window, &origin.x, &origin.y);
+            const glm::vec2 cursor = input.Last().mouse_position + glm::vec2{ origin };
+            ImGui::GetIO().AddMousePosEvent(cursor.x, cursor.y);
+        }
+        ImGui::NewFrame();
+        demo.ImGuiDraw(last_sprite_stats, last_static_sprite_stats, last_animated_stats, last_mesh_stats, last_particle_stats, last_text_stats, last_tilemap_stats, last_light_stats);
+        // the replay goes back with the world, so the input that followed the step plays again
+        if (const std::optional<std::uint32_t> rewound = demo.TakeRewind(); rewound && input_mode == InputMode::Replaying)
+            input_frame = *rewound;
+        profiler::DrawImGui();
+        memory_tracker::DrawImGui();
+        allocation_counter::DrawImGui();
+        logger::DrawImGui();
+        worker_ui::DrawImGui();
+        assets.DrawImGui();
+        asset_browser.DrawImGui(assets, &show_asset_browser);
+        if (show_gl_stats)
+            gl_stats::DrawOverlay();
+        if (show_perf_hud)
+            perf_hud.DrawOverlay(frameCounters());
+#if !defined(__EMSCRIPTEN__)
+        ImGui::Begin("Application");
+        ImGui::Checkbox("reactive (redraw on input only)", &reactive);
+        ImGui::Checkbox("cache ui (skip unchanged uploads and frames)", &cache_ui);
+        {
+            bool throttle_panels = imgui_panels::IsEnabled();
+            if (ImGui::Checkbox("throttle stats panels", &throttle_panels))
+                imgui_panels::SetEnabled(throttle_panels);
+            const imgui_panels::Stats& panels = imgui_panels::GetStats();
+            ImGui::SameLine();
+            ImGui::Text("%llu built, %llu replayed", static_cast<unsigned long long>(panels.built), static_cast<unsigned long long>(panels.replayed));
+        }
+        if (ImGui::Checkbox("ui damage (redraw what the ui changed)", &damage_ui))
+            invalidateScene();
+        if (damage_ui)
+        {
+            const UiDamage::Stats& damage = ui_damage.GetStats();
+            ImGui::Text("ui damage: %llu partial, %llu whole; %d rects over %.1f%%; drawn %llu partial, %llu whole; %s", static_cast<unsigned long long>(damage.partial),
+                        static_cast<unsigned long long>(damage.whole), damage.rects, static_cast<double>(damage.share) * 100.0,
+                        static_cast<unsigned long long>(last_ui_damage_stats.partial), static_cast<unsigned long long>(last_ui_damage_stats.whole),
+                        last_ui_damage_stats.swap_with_damage ? "swap with damage" : "plain swap");
+        }
+        ImGui::Text("frames drawn = %llu, skipped = %llu, unchanged = %llu, hidden = %llu", static_cast<unsigned long long>(frames_drawn), static_cast<unsigned long long>(frames_skipped),
+                    static_cast<unsigned long long>(frames_unchanged), static_cast<unsigned long long>(frames_hidden));
+        if (is_threaded)
+            ImGui::Text("render thread: %llu frames rendered", static_cast<unsigned long long>(render_thread.CompletedCount()));
+        {
+            const ReleaseQueue::Stats released = releases.LastFrameStats();
+            ImGui::Text("release queue: %zu waiting (%.1f KB), %zu released in %d calls, GPU done through frame %llu", released.pending,
+                        static_cast<double>(released.pending_bytes) / 1024.0, released.released, released.delete_calls, static_cast<unsigned long long>(released.drawn_frame));
+        }
+        FramePacer::DrawImGui(pacing);
+        if (last_pacer_stats.latency_ms >= 0.0)
+            ImGui::Text("%d frames in flight, waited %.2f ms for the GPU, input to photon ~%.1f ms", last_pacer_stats.frames_in_flight, last_pacer_stats.wait_ms,
+                        last_pacer_stats.latency_ms);
+        DynamicResolution::DrawImGui(resolution);
+        RenderTarget::DrawImGui(anti_aliasing);
+        PostProcess::DrawImGui(post_settings);
+        imgui_viewports::DrawImGui(viewports);
+        scene_views.DrawImGui();
+        ImGui::Checkbox("gpu picking on left click", &pick_on_click);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120.0f);
+        ImGui::SliderFloat("pick extent", &pick_extent, 1.0f, 64.0f, "%.0f points");
+        const GpuPicker::Stats  pick_stats = gpu_picker.GetStats();
+        const GpuPicker::Result picked     = gpu_picker.LastResult();
+        ImGui::Text("picks: %llu, %llu dropped, %d in flight, %d sprites drawn; last found id %u, %d frames later", static_cast<unsigned long long>(pick_stats.picks),
+                    static_cast<unsigned long long>(pick_stats.dropped), pick_stats.in_flight, pick_stats.sprites, picked.id, picked.frames);
+        if (audio_device.DrawImGui(audio_settings.mix))
+            audio_device.Reconfigure(audio_settings.mix);
+        drawConfigImGui();
+        ImGui::Text("scene %d x %d (%.0f%%) in %d x %d, %d allocations%s", frame.scene_size.x, frame.scene_size.y, static_cast<double>(dynamic_resolution.Scale()) * 100.0,
+                    last_scene_allocation.x, last_scene_allocation.y, last_scene_reallocations, resolution.dynamic && is_threaded ? ", no GPU timer on the render thread" : "");
+        ImGui::Text("render graph: %d passes, %d culled, %d transients in %d targets, %.1f of %.1f MB (%d pooled, %d allocated so far)", last_graph_stats.passes,
+                    last_graph_stats.culled, last_graph_stats.transients, last_graph_stats.physical, static_cast<double>(last_graph_stats.allocated_bytes) / (1024.0 * 1024.0),
+                    static_cast<double>(last_graph_stats.requested_bytes) / (1024.0 * 1024.0), last_graph_stats.pool.targets, last_graph_stats.pool.allocations);
+        const InputSnapshot& input_state = input.Last();
+        ImGui::Text("input: %d events, %d coalesced, %d filtered, mouse delta (%.0f, %.0f), render side %llu polls newer", input_state.events,
+                    input_state.coalesced_events, input_state.filtered_events,
+                    static_cast<double>(input_state.mouse_delta.x), static_cast<double>(input_state.mouse_delta.y), static_cast<unsigned long long>(last_input_lead));
+        const gl_state::Counters gl_calls = gl_state::LastFrame();
+        ImGui::Text("gl state calls: %d issued, %d skipped", gl_calls.issued, gl_calls.skipped);
+#if DEBUG_DRAW_ENABLED
+        ImGui::Text("debug draw: %d lines, %d triangles in %d draws", last_debug_stats.lines, last_debug_stats.triangles, last_debug_stats.draw_calls);
+#endif
+        const gl_context::Info& context = gl_context::GetInfo();
+        ImGui::Text("GL %d.%d%s, %s", context.major, context.minor, context.is_no_error ? ", no error checking" : "", gl_backend::Get().name);
+        if (const gl_debug::Stats gl_messages = gl_debug::GetStats(); gl_messages.active)
+            ImGui::Text("gl debug (--gl-debug): %llu messages, %d distinct, %llu logged, %llu repeats folded, %llu over budget", static_cast<unsigned long long>(gl_messages.received),
+                        gl_messages.distinct, static_cast<unsigned long long>(gl_messages.logged), static_cast<unsigned long long>(gl_messages.repeats),
+                        static_cast<unsigned long long>(gl_messages.suppressed));
+        ImGui::Text("frame capture (F12, Shift+F12 for %d): %llu written, %llu dropped, %llu failed, %d in flight, %d encoding", FRAME_CAPTURE_SEQUENCE,
+                    static_cast<unsigned long long>(last_capture_stats.written), static_cast<unsigned long long>(last_capture_stats.dropped),
+                    static_cast<unsigned long long>(last_capture_stats.failed), last_capture_stats.in_flight, last_capture_stats.encoding);
+        latency_probe.DrawImGui();
+        ImGui::Text("render commands: %d in %d layers, %d of 8 sort passes", last_command_stats.commands, last_command_stats.layers, last_command_stats.sort_passes);
+        const decoded_cache::Stats decoded = decoded_cache::GetStats();
+        ImGui::Text("decoded cache: %d warm in %.1f ms (%.1f ms cold), %d cold in %.1f ms", decoded.warm_loads, decoded.warm_ms, decoded.warm_as_cold_ms, decoded.cold_loads, decoded.cold_ms);
+        const TextureLoader::Stats textures = texture_loader.GetStats();
+        ImGui::Text("textures: %.1f of %.1f MB, %d demoted, %d demoting, %d restoring, %llu demotions, %llu restores", static_cast<double>(textures.bytes) / (1024.0 * 1024.0),
+                    static_cast<double>(textures.budget) / (1024.0 * 1024.0), textures.demoted, textures.demoting, textures.restoring, static_cast<unsigned long long>(textures.demotions),
+                    static_cast<unsigned long long>(textures.restores));
+        if (upload_thread.IsRunning())
+        {
+            const UploadThread::Stats thread_uploads = upload_thread.GetStats();
+            ImGui::Text("upload thread: %llu textures, %.1f MB, %.1f ms, %d queued, %d fencing", static_cast<unsigned long long>(thread_uploads.uploads),
+                        static_cast<double>(thread_uploads.bytes) / (1024.0 * 1024.0), thread_uploads.thread_ms, thread_uploads.queued, thread_uploads.fencing);
+        }
+        if (textures.driver_total_kb >= 0)
+            ImGui::Text("video memory: %.1f MB free of %.1f MB", static_cast<double>(textures.driver_available_kb) / 1024.0, static_cast<double>(textures.driver_total_kb) / 1024.0);
+        else if (textures.driver_available_kb >= 0)
+            ImGui::Text("video memory: %.1f MB free for textures", static_cast<double>(textures.driver_available_kb) / 1024.0);
+        const imgui_fonts::Stats fonts = imgui_fonts::GetStats();
+        ImGui::Text("imgui fonts: %d in %d x %d, %s in %.1f ms, %d of %d rows uploaded", fonts.fonts, fonts.width, fonts.height, fonts.was_cached ? "from the cache" : "baked", fonts.build_ms,
+                    fonts.uploaded_rows, fonts.height);
+        ImGui::Text("imgui renderer: %d draws, %d texture binds, %.1f KB uploaded, %.1f KB reused, %s, %s", last_imgui_stats.draw_calls, last_imgui_stats.texture_binds,
+                    static_cast<double>(last_imgui_stats.uploaded_bytes) / 1024.0, static_cast<double>(last_imgui_stats.reused_bytes) / 1024.0,
+                    last_imgui_stats.persistent ? "persistent" : "mapped per frame", last_imgui_stats.base_vertex ? "base vertex" : "attributes per list");
+        const LoadScheduler::Stats load_stats = loads.GetStats();
+        ImGui::Text("loads: %d of %d on the workers, queued %d/%d/%d/%d by priority, %llu cancelled, %llu promoted", load_stats.in_flight, loads.MaxInFlight(), load_stats.queued[0],
+                    load_stats.queued[1], load_stats.queued[2], load_stats.queued[3], static_cast<unsigned long long>(load_stats.cancelled), static_cast<unsigned long long>(load_stats.promoted));
+#if defined(__EMSCRIPTEN__)
+        const AssetFetcher::Stats fetch_stats = fetcher.GetStats();
+        ImGui::Text("fetches: %d downloading, %d queued, %d loads waiting, %llu done in %.1f MB, %llu missing", fetch_stats.in_flight, fetch_stats.queued, load_stats.fetching,
+                    static_cast<unsigned long long>(fetch_stats.downloaded), static_cast<double>(fetch_stats.bytes) / (1024.0 * 1024.0), static_cast<unsigned long long>(fetch_stats.missing));
+#else
+        const AsyncFileReader::Stats read_stats = file_reader.GetStats();
+        ImGui::Text("file reads (%s): %d reading, %d queued, %d loads waiting, %llu files in %.1f MB, %llu chunks in %llu batches, %.1f MB held, %llu discarded",
+                    AsyncFileReader::BackendName(read_stats.backend), read_stats.reading, read_stats.queued, load_stats.fetching, static_cast<unsigned long long>(read_stats.read),
+                    static_cast<double>(read_stats.bytes) / (1024.0 * 1024.0), static_cast<unsigned long long>(read_stats.chunks), static_cast<unsigned long long>(read_stats.batches),
+                    static_cast<double>(read_stats.held) / (1024.0 * 1024.0), static_cast<unsigned long long>(read_stats.discarded));
+#endif
+        if (const AssetPack::Stats pack_stats = asset_pack.GetStats(); pack_stats.compressed > 0)
+        {
+            ImGui::Text("pack: %d compressed, %.1f of %.1f MB, %llu decompressed in %.1f MB at %.0f MB/s", pack_stats.compressed, static_cast<double>(pack_stats.packed_bytes) / (1024.0 * 1024.0),
+                        static_cast<double>(pack_stats.unpacked_bytes) / (1024.0 * 1024.0), static_cast<unsigned long long>(pack_stats.reads), static_cast<double>(pack_stats.read_bytes) / (1024.0 * 1024.0),
+                        pack_stats.decompress_ms > 0.0 ? static_cast<double>(pack_stats.read_bytes) / (1024.0 * 1024.0) / (pack_stats.decompress_ms / 1000.0) : 0.0);
+        }
+        const UploadBudget::Stats& upload_stats = uploads.GetStats();
+        ImGui::Text("uploads: %d, %.1f of %.1f MB in %.2f of %.1f ms, %.1f MB queued", upload_stats.uploads, static_cast<double>(upload_stats.spent_bytes) / (1024.0 * 1024.0),
+                    static_cast<double>(upload_stats.max_bytes) / (1024.0 * 1024.0), upload_stats.spent_ms, upload_stats.max_ms, static_cast<double>(upload_stats.queued_bytes) / (1024.0 * 1024.0));
+        upload_benchmark.DrawImGui();
+        if (ImGui::Checkbox("hot reload assets", &hot_reload))
+        {
+            if (hot_reload)
+                hot_reload = asset_watcher.Start(get_base_path());
+            else
+                asset_watcher.Stop();
+        }
+        ImGui::SameLine();
+        ImGui::Text("%s, %d reloaded", asset_watcher.IsWatching() ? "watching" : "not watching", assets_reloaded);
+        ImGui::Checkbox("gl stats overlay", &show_gl_stats);
+        ImGui::SameLine();
+        ImGui::Checkbox("performance hud", &show_perf_hud);
+        ImGui::SameLine();
+        ImGui::Checkbox("asset browser", &show_asset_browser);
+        int simulation_hz = static_cast<int>(1.0 / timestep.StepSeconds() + 0.5);
+        if (ImGui::SliderInt("simulation hz", &simulation_hz, 10, 240))
+            timestep.SetStepSeconds(1.0 / simulation_hz);
+        ImGui::Text("steps this frame = %d, alpha = %.2f, dropped = %.2f s", timestep.LastStepCount(), static_cast<double>(timestep.Alpha()), timestep.DroppedSeconds());
+        ImGui::End();
+#endif
+        ImGui::Render();
+        ImDrawData& draw_data = *ImGui::GetDrawData();
+        frame.imgui_hash      = cache_ui ? hash_imgui_draw_data(draw_data) : 0;
+        // input woke a reactive frame but the picture came out the same, so the last swap still shows it
+        const bool unchanged = reactive && frame.imgui_hash != 0 && frame.imgui_hash == presented_ui_hash && frame.scene_size == presented_scene_size && !scene_changed &&
+                               !demo.IsAnimating();
+        frame.submitted      = !unchanged;
+        if (frame.submitted)
+        {
+            frame.CaptureImGui(draw_data, is_threaded);
+            markDrawnTextures(frame);
+            // the scene is the same as the last frame's exactly when a reactive frame could have been skipped for it
+            frame.retain_ui = damage_ui && frame_capture_left == 0 && frame.batch_image.empty() && frame.views.empty();
+            if (frame.retain_ui)
+            {
+                const bool scene_held = frame.scene_size == presented_scene_size && !scene_changed && !demo.IsAnimating() && shader_cache::PendingCount() == 0 &&
+                                        !frame.latency.is_active && frame.pick.sequence == 0;
+                frame.ui_partial = ui_damage.Track(draw_data, !scene_held);
+                frame.ui_damage.assign(ui_damage.Rects().begin(), ui_damage.Rects().end());
+            }
+        }
+    }
+    if (frame.submitted)
+    {
+        if (is_threaded)
+        {
+            // this frame's texture uploads were issued on the upload context; the render context waits on the GPU, not here
+            frame.uploads_ready = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+        }
+        if (frame_capture_left > 0)
+        {
+            frame.capture_sequence = frame_captures_started;
+            frame.capture_frame    = frame_capture_index++;
+            // every frame of a sequence has to be drawn, even one reactive mode would have skipped
+            if (--frame_capture_left > 0)
+                invalidateScene();
+        }
+        {
+            // inline when single threaded, otherwise only blocks while the previous frame is still queued
+            PROFILE_ZONE("Render Submit");
+            frame.input_sequence = input.Last().sequence;
+            frame.frame_number   = frames_drawn + 1;
+            frame.input_ticks    = input.Last().ticks;
+            if (frame.latency.id != 0)
+                frame.latency.submit_ticks = SDL_GetPerformanceCounter();
+            // full only if the render side stopped draining; it would only want the newest anyway
+            [[maybe_unused]] const bool queued = input_queue.TryPush(input.Last());
+            render_thread.Submit([this, &frame, gpu_timing = !is_threaded] { renderFrame(frame, gpu_timing); });
+        }
+        presented_ui_hash    = frame.imgui_hash;
+        presented_scene_size = frame.scene_size;
+        scene_changed        = false;
+        ++frames_drawn;
+        releases.Submitted(frames_drawn);
+#if defined(__EMSCRIPTEN__)
+        if (frames_drawn == 1)
+        {
+            // performance.now() counts from navigation start, so this includes the download and the wasm compile
+            const double interactive_ms = emscripten_get_now();
+            EM_ASM(performance.mark('programming-fun interactive'));
+            std::cout << "Time to interactive: " << interactive_ms << " ms after navigation start, first paint at " << first_paint_ms << " ms; kernels: audio "
+                      << audio_kernels::LevelName(audio_kernels::ActiveLevel()) << ", math " << math_kernels::LevelName(math_kernels::ActiveLevel()) << '\n';
+        }
+#endif
+    }
+    else
+    {
+        ++frames_unchanged;
+    }
+    const ImGuiIO& io = ImGui::GetIO();
+    if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+    {
+        PROFILE_ZONE("Platform Windows");
+        imgui_viewports::Render();
+        SDL_GL_MakeCurrent(ptr_window, gl_context);
+    }
+    if (redraw_frames > 0)
+        --redraw_frames;
+    profiler::ReportMemory("frame arenas", frame_arenas.BytesUsed(), frame_arenas.HighWater(), frame_arenas.Capacity());
+    const decode_scratch::Stats scratch = decode_scratch::GetStats();
+    profiler::ReportMemory("decode scratch", scratch.last_peak_bytes, scratch.largest_peak_bytes, scratch.reserved_bytes);
+    memory_tracker::Set(MemoryCategory::Arenas, frame_arenas.Capacity() + scratch.reserved_bytes);
+    // the drawing thread's numbers are from the last frame it finished, one behind with the render thread
+    perf_counters::EndFrame();
+    const PerfHud::Counters counters = frameCounters();
+    allocation_counter::EndFrame(texture_loader.PendingCount() > 0 || sound_cache.PendingCount() > 0 || counters.loads_queued > 0 || counters.loads_active > 0);
+    recordFrameMetrics(now, is_threaded);
+    if (benchmark)
+        recordBenchmark(now, is_threaded);
+    PROFILE_END_FRAME();
+}
+
+FramePacket& Application::beginPacket()
+{
+    // three frames back, so the render side is done with it
+    packet_slot = (packet_slot + 1) % FrameArenas::FRAMES_IN_FLIGHT;
+    if (FramePacket*& old = packets[static_cast<std::size_t>(packet_slot)]; old != nullptr)
+    {
+        if (old->submitted)
+        {
+            last_sprite_stats        = old->sprite_stats;
+            last_static_sprite_stats = old->static_sprite_stats;
+            last_animated_stats      = old->animated_stats;
+            last_mesh_stats          = old->mesh_stats;
+            last_particle_stats      = old->particle_stats;
+            last_text_stats          = old->text_stats;
+            last_tilemap_stats       = old->tilemap_stats;
+            last_debug_stats         = old->debug_stats;
+            last_light_stats         = old->light_stats;
+            last_command_stats       = old->command_stats;
+            last_input_lead          = old->input_lead;
+            last_pacer_stats         = old->pacer_stats;
+            last_scene_allocation    = old->scene_allocation;
+            last_scene_reallocations = old->scene_reallocations;
+            last_graph_stats         = old->graph_stats;
+            last_capture_stats       = old->capture_stats;
+            last_imgui_stats         = old->imgui_stats;
+            last_ui_damage_stats     = old->ui_damage_stats;
+        }
+        std::destroy_at(old);
+        old = nullptr;
+    }
+    FrameArena&  arena  = frame_arenas.BeginFrame();
+    FramePacket* packet = std::pmr::polymorphic_allocator<>{ &arena }.new_object<FramePacket>(&arena);
+
+    packets[static_cast<std::size_t>(packet_slot)] = packet;
+    return *packet;
+}
+
+void Application::renderFrame(FramePacket& frame, bool gpu_timing)
+{
+    // CPU zones stay on the main thread; GPU timing uses the main thread's queries, so only when this is the main thread
+    if (gpu_timing)
+        PROFILE_GPU_BEGIN_FRAME();
+    if (frame.uploads_ready != nullptr)
+    {
+        glWaitSync(frame.uploads_ready, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(frame.uploads_ready);
+        frame.uploads_ready = nullptr;
+    }
+    // the main thread may have polled again since it recorded this frame; that input is the freshest there is
+    while (input_queue.TryPop(render_input))
+    {
+    }
+    frame.input_lead = render_input.sequence - frame.input_sequence;
+    shader_cache::Update();
+    // first, so the renderers' stats the frame keeps are the main window's
+    if (!frame.views.empty())
+        drawSceneViews(frame);
+    frame_pacer.Apply(frame.pacing);
+    scene_target.Resize(frame.scene_size, frame.anti_aliasing.msaa_samples);
+    frame.scene_allocation    = scene_target.AllocatedSize();
+    frame.scene_reallocations = scene_target.Reallocations();
+
+    // without a scene target the scene draws straight onto the backbuffer and nothing comes between
+    render_graph.Reset();
+    const RenderGraph::Resource backbuffer    = render_graph.Import("backbuffer", ColorSurface{ 0, 0, frame.viewport_size, frame.viewport_size });
+    const ColorSurface          scene_surface = scene_target.ResolvedSurface();
+    const RenderGraph::Resource scene         = scene_surface.framebuffer != 0 ? render_graph.Import("scene", scene_surface) : backbuffer;
+    // the scene and the UI go onto the kept picture instead, which is blitted onto the backbuffer after the UI
+    const bool retains_ui = frame.retain_ui && scene_surface.framebuffer != 0 && ui_target.Resize(frame.viewport_size);
+    if (!retains_ui)
+        ui_target.Forget();
+    // a partial frame leaves the scene as the last whole one drew it and redraws the UI inside the damage only
+    const bool                  is_partial = retains_ui && frame.ui_partial && ui_target.IsRetained() && frame.pick.sequence == 0;
+    const RenderGraph::Resource window     = retains_ui ? render_graph.Import("kept window", ui_target.Surface()) : backbuffer;
+    if (is_partial)
+    {
+        render_graph
+            .AddPass("UI Damage Restore",
+                     [this, &frame](const RenderGraph&) {
+                         PROFILE_GPU_ZONE("UI Damage Restore");
+                         GL_STATS_PASS("UI Damage");
+                         ui_target.Restore(frame.ui_damage);
+                     })
+            .Write(window);
+    }
+    else
+    {
+        addScenePasses(frame, backbuffer, scene, window);
+        if (retains_ui)
+        {
+            render_graph
+                .AddPass("UI Damage Keep",
+                         [this](const RenderGraph&) {
+                             PROFILE_GPU_ZONE("UI Damage Keep");
+                             GL_STATS_PASS("UI Damage");
+                             ui_target.Keep();
+                         })
+                .Write(window);
+        }
+    }
+    // an empty damage has nothing to draw, and no limits would draw the whole UI over itself
+    if (ImDrawData* draw_data = frame.ImGuiDrawData(); draw_data != nullptr && (!is_partial || !frame.ui_damage.empty()))
+    {
+        render_graph
+            .AddPass("ImGui",
+                     [this, &frame, draw_data, window, is_partial](const RenderGraph& graph) {
+                         PROFILE_GPU_ZONE("ImGui Render");
+                         GL_STATS_PASS("ImGui");
+                         glBindFramebuffer(GL_FRAMEBUFFER, graph.Surface(window).framebuffer);
+                         imgui_renderer.Render(*draw_data, frame.imgui_hash, is_partial ? std::span<const glm::ivec4>{ frame.ui_damage } : std::span<const glm::ivec4>{});
+                     })
+            .Write(window);
+    }
+    if (retains_ui)
+    {
+        render_graph
+            .AddPass("UI Damage Present",
+                     [this](const RenderGraph&) {
+                         PROFILE_GPU_ZONE("UI Damage Present");
+                         GL_STATS_PASS("UI Damage");
+                         ui_target.Present();
+                     })
+            .Read(window)
+            .Write(backbuffer);
+    }
+    render_graph.Execute();
+    render_graph.EndFrame();
+    frame.graph_stats     = render_graph.LastFrameStats();
+    frame.light_stats     = light_renderer.LastFrameStats();
+    frame.imgui_stats     = imgui_renderer.LastFrameStats();
+    frame.ui_damage_stats = ui_target.GetStats();
+    latency_probe.DrawPatch(frame.latency, frame.viewport_size);
+    frame_capture.Update();
+    frame.capture_stats = frame_capture.GetStats();
+    gpu_picker.Update();
+    gl_state::EndFrame();
+    gl_stats::EndFrame();
+    releases.Drawn(frame.frame_number);
+    frame_pacer.WaitForNextFrame();
+    if (retains_ui)
+        ui_target.Swap(ptr_window, is_partial ? std::span<const glm::ivec4>{ frame.ui_damage } : std::span<const glm::ivec4>{});
+    else
+        SDL_GL_SwapWindow(ptr_window);
+    latency_probe.Swapped(frame.latency);
+    frame_pacer.EndFrame(frame.input_ticks);
+    frame.pacer_stats = frame_pacer.LastFrameStats();
+    PROFILE_FRAME_MARK();
+    if (gpu_timing)
+        PROFILE_GPU_END_FRAME();
+    startup_trace::Finish();
+}
+
+void Application::addScenePasses(FramePacket& frame, RenderGraph::Resource backbuffer, RenderGraph::Resource scene, RenderGraph::Resource window)
+{
+    render_graph
+        .AddPass("Scene",
+                 [this, &frame](const RenderGraph&) {
+                     const bool has_scene_target = scene_target.Bind();
+                     if (!has_scene_target)
+                         gl_state::Viewport(0, 0, frame.viewport_size.x, frame.viewport_size.y);
+                     drawScene(frame);
+                     if (has_scene_target)
+                         scene_target.Resolve();
+                 })
+        .Write(scene);
+    if (frame.pick.sequence != 0)
+    {
+        // after the scene pass sorted the commands, so the ids go down in the order the sprites did
+        render_graph
+            .AddPass("Pick",
+                     [this, &frame](const RenderGraph&) {
+                         PROFILE_GPU_ZONE("Pick");
+                         GL_STATS_PASS("Pick");
+                         gpu_picker.Render(frame);
+                     })
+            .Read(scene)
+            .SideEffect();
+    }
+    // the scene as it goes onto the window: lit, post processed, still at its own size
+    RenderGraph::Resource finished = backbuffer;
+    if (scene != backbuffer)
+    {
+        const RenderGraph::Resource lit       = light_renderer.AddPasses(render_graph, scene, frame.lighting);
+        const RenderGraph::Resource presented = post_process.AddPasses(render_graph, lit, frame.post);
+        finished                              = presented;
+        render_graph
+            .AddPass("Upscale",
+                     [this, &frame, presented, window](const RenderGraph& graph) {
+                         PROFILE_GPU_ZONE("Upscale");
+                         GL_STATS_PASS("Upscale");
+                         scene_target.Present(graph.Surface(presented), frame.viewport_size, frame.anti_aliasing.fxaa, graph.Surface(window).framebuffer);
+                         gl_stats::CountDraw(1);
+                     })
+            .Read(presented)
+            .Write(window);
+    }
+    if (frame.capture_sequence != 0)
+    {
+        // before the UI, so captures of two runs compare even though the overlay's numbers differ
+        render_graph
+            .AddPass("Frame Capture Read",
+                     [this, &frame](const RenderGraph&) {
+                         PROFILE_ZONE("Frame Capture Read");
+                         char filename[48];
+                         std::snprintf(filename, sizeof(filename), "frame_capture_%d_%04d.png", frame.capture_sequence, frame.capture_frame);
+                         frame_capture.Read(frame.viewport_size, filename);
+                     })
+            .Read(backbuffer)
+            .SideEffect();
+    }
+    if (!frame.batch_image.empty())
+    {
+        // offscreen, none of the window's scaling or UI; a batch image is never dropped, so it waits for a slot if it must
+        render_graph
+            .AddPass("Batch Capture Read",
+                     [this, &frame, finished](const RenderGraph& graph) {
+                         PROFILE_ZONE("Batch Capture Read");
+                         const ColorSurface surface = graph.Surface(finished);
+                         frame_capture.WaitForSlot();
+                         frame_capture.Read(surface.size, frame.batch_image, surface.framebuffer);
+                     })
+            .Read(finished)
+            .SideEffect();
+    }
+}
+
+void Application::drawScene(FramePacket& frame)
+{
+    gl_state::ClearColor(frame.clear_color.r, frame.clear_color.g, frame.clear_color.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    {
+        // the main thread recorded in whatever order its systems and jobs ran; by key the state changes come out grouped
+        PROFILE_ZONE("Sort Commands");
+        frame.command_stats.commands    = static_cast<int>(frame.commands.size());
+        frame.command_stats.sort_passes = radix_sort(frame.commands, command_scratch, &workers);
+    }
+    frame.command_stats.layers = drawCommands(frame, frame.projection, frame.commands);
+}
+
+void Application::drawSceneViews(FramePacket& frame)
+{
+    PROFILE_GPU_ZONE("Scene Views");
+    GL_STATS_PASS("Scene Views");
+    // a view never waits for a vblank; the main window gets its interval back before its own swap
+    const int interval = SDL_GL_GetSwapInterval();
+    for (const SceneViewDraw& view : frame.views)
+    {
+        SDL_GL_MakeCurrent(view.window, gl_context);
+        if (interval != 0)
+            SDL_GL_SetSwapInterval(0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        gl_state::Viewport(0, 0, view.size.x, view.size.y);
+        gl_state::ClearColor(frame.clear_color.r, frame.clear_color.g, frame.clear_color.b, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        drawCommands(frame, view.projection, std::span<const RenderCommand>{ frame.view_commands }.subspan(view.first, view.count));
+        SDL_GL_SwapWindow(view.window);
+    }
+    SDL_GL_MakeCurrent(ptr_window, gl_context);
+    if (interval != 0)
+        SDL_GL_SetSwapInterval(interval);
+}
+
+int Application::drawCommands(FramePacket& frame, const glm::mat4& projection, std::span<const RenderCommand> commands)
+{
+    int runs = 0;
+    while (!commands.empty())
+    {
+        const RenderLayer layer = render_key::Layer(commands.front().key);
+        const auto        end   = std::find_if(commands.begin(), commands.end(), [layer](const RenderCommand& command) { return render_key::Layer(command.key) != layer; });
+        const auto        run   = static_cast<std::size_t>(end - commands.begin());
+        drawLayer(frame, projection, layer, commands.first(run));
+        commands = commands.subspan(run);
+        ++runs;
+    }
+    return runs;
+}
+
+void Application::drawLayer(FramePacket& frame, const glm::mat4& projection, RenderLayer layer, std::span<const RenderCommand> commands)
+{
+    switch (layer)
+    {
+        case RenderLayer::Tilemap:
+            {
+                PROFILE_GPU_ZONE("Tilemap");
+                GL_STATS_PASS("Tilemap");
+                tile_chunk_scratch.clear();
+                for (const RenderCommand& command : commands)
+                    tile_chunk_scratch.insert(tile_chunk_scratch.end(), frame.tile_chunks.begin() + command.first, frame.tile_chunks.begin() + command.first + command.count);
+                tilemap_renderer.Draw(projection * frame.tilemap.view, tile_chunk_scratch, frame.tilemap.texture, frame.tilemap.tile_size);
+                frame.tilemap_stats = tilemap_renderer.LastFrameStats();
+            }
+            break;
+        case RenderLayer::StaticSprites:
+            {
+                PROFILE_GPU_ZONE("Static Sprites");
+                GL_STATS_PASS("Static Sprites");
+                static_run_scratch.clear();
+                for (const RenderCommand& command : commands)
+                    static_run_scratch.insert(static_run_scratch.end(), frame.static_sprites.begin() + command.first, frame.static_sprites.begin() + command.first + command.count);
+                sprite_batch.DrawRetained(projection, static_run_scratch, frame.static_sprite_rects);
+                frame.static_sprite_stats = sprite_batch.LastRetainedStats();
+            }
+            break;
+        case RenderLayer::Sprites:
+            {
+                PROFILE_GPU_ZONE("Demo::Draw");
+                GL_STATS_PASS("Sprites");
+                // grouped by texture or back to front, the commands' order is the one to draw in
+                sprite_batch.SetBindless(frame.bindless_sprites);
+                sprite_batch.SetKeepOrder(true);
+                sprite_batch.Begin(projection);
+                for (const RenderCommand& command : commands)
+                {
+                    for (std::uint32_t i = command.first; i < command.first + command.count; ++i)
+                    {
+                        const SpriteDraw& draw = frame.sprites[i];
+                        if (draw.is_array)
+                            sprite_batch.DrawArray(draw.texture, draw.sprite);
+                        else
+                            sprite_batch.Draw(draw.texture, draw.sprite);
+                    }
+                }
+                sprite_batch.End();
+                frame.sprite_stats = sprite_batch.LastFrameStats();
+            }
+            break;
+        case RenderLayer::AnimatedSprites:
+            {
+                PROFILE_GPU_ZONE("Animated Sprites");
+                GL_STATS_PASS("Animated Sprites");
+                const AnimatedSpriteDraw& animated = frame.animated_sprites;
+                if (animated.sprites != animated_uploaded)
+                {
+                    animated_renderer.SetSprites(*animated.sprites);
+                    animated_uploaded = animated.sprites;
+                }
+                animated_renderer.Draw(projection, animated.texture, animated.uv_rect, animated.time);
+                frame.animated_stats = animated_renderer.LastFrameStats();
+            }
+            break;
+        case RenderLayer::Meshes:
+            {
+                PROFILE_GPU_ZONE("Meshes");
+                GL_STATS_PASS("Meshes");
+                mesh_renderer.Begin(projection);
+                for (const RenderCommand& command : commands)
+                {
+                    for (std::uint32_t i = command.first; i < command.first + command.count; ++i)
+                        mesh_renderer.Draw(frame.meshes[i].mesh, frame.meshes[i].instance);
+                }
+                mesh_renderer.End();
+                frame.mesh_stats = mesh_renderer.LastFrameStats();
+            }
+            break;
+        case RenderLayer::Models:
+            {
+                PROFILE_GPU_ZONE("Models");
+                GL_STATS_PASS("Models");
+                if (frame.model != model_uploaded)
+                {
+                    // MeshRenderer can't free a mesh, so a replaced model's stay until shutdown; only reloading by hand replaces one
+                    model_meshes.clear();
+                    for (const ModelPart& part : frame.model->parts)
+                        model_meshes.push_back(mesh_renderer.CreateMeshLods(part.vertices, part.indices, part.quantization, part.lods));
+                    model_uploaded = frame.model;
+                }
+                // the model's triangles only test against each other: cleared here, and off again for the layers over it
+                gl_state::DepthMask(true);
+                gl_state::DepthFunc(GL_LESS);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                gl_state::SetEnabled(GL_DEPTH_TEST, true);
+                // a level is a mesh of its own, so the copies at each level group into one draw
+                mesh_renderer.Begin(projection);
+                for (const RenderCommand& command : commands)
+                {
+                    for (std::uint32_t i = command.first; i < command.first + command.count; ++i)
+                    {
+                        for (const MeshId first_level : model_meshes)
+                            mesh_renderer.Draw(first_level + frame.models[i].lod, frame.models[i].instance);
+                    }
+                }
+                mesh_renderer.End();
+                gl_state::SetEnabled(GL_DEPTH_TEST, false);
+            }
+            break;
+        case RenderLayer::Particles:
+            {
+                PROFILE_GPU_ZONE("Particles");
+                GL_STATS_PASS("Particles");
+                // however many fixed steps went by since the last drawn frame, as one; a long stall doesn't throw them across the screen
+                const ParticleDraw& particles = frame.particles;
+                const double        delta     = std::clamp(particles.time - particle_time, 0.0, MAX_PARTICLE_STEP);
+                particle_time                 = particles.time;
+                particle_system.SetCapacity(particles.capacity);
+                particle_system.Update(static_cast<float>(delta), std::span{ particles.emitters, static_cast<std::size_t>(particles.emitter_count) }, particles.gravity);
+                particle_system.Draw(projection, particles.texture, particles.uv_rect);
+                frame.particle_stats = particle_system.LastFrameStats();
+            }
+            break;
+        case RenderLayer::Text:
+            {
+                PROFILE_GPU_ZONE("Text");
+                GL_STATS_PASS("Text");
+                // the labels record one command over all their glyphs
+                for (const RenderCommand& command : commands)
+                    text_renderer.Draw(projection, std::span<const GlyphInstance>{ frame.glyphs }.subspan(command.first, command.count));
+                frame.text_stats = text_renderer.LastFrameStats();
+            }
+            break;
+        case RenderLayer::Debug:
+            {
+                PROFILE_GPU_ZONE("Debug Draw");
+                GL_STATS_PASS("Debug Draw");
+                debug_renderer.Draw(projection, frame.debug.lines, frame.debug.triangles);
+                frame.debug_stats = debug_renderer.LastFrameStats();
+            }
+            break;
+    }
+}
+
+void Application::updateWindowEvents()
+{
+    SDL_Event  event      = { 0 };
+    SDL_Event  motion     = { 0 };
+    bool       has_motion = false;
+    glm::ivec2 resized{ 0 };
+    // nothing is recorded or replayed until the startup loads landed, however long they took this time
+    const bool                 is_logged = input_mode != InputMode::Live && decoded_cache_reported;
+    std::span<const SDL_Event> replayed  = is_logged && input_mode == InputMode::Replaying ? input_log.EventsAt(input_frame) : std::span<const SDL_Event>{};
+    // the live events first, without the input a replay stands in for, then the replay's for this frame
+    const auto next_event = [&](SDL_Event& out)
+    {
+        while (SDL_PollEvent(&out) != 0)
+        {
+            if (input_mode == InputMode::Replaying && InputLog::IsRecorded(out))
+                continue;
+            if (is_logged && input_mode == InputMode::Recording)
+                input_log.Add(input_frame, out);
+            return true;
+        }
+        if (replayed.empty())
+            return false;
+        out      = replayed.front();
+        replayed = replayed.subspan(1);
+        return true;
+    };
+    while (next_event(event))
+    {
+        invalidate(REDRAW_FRAMES_AFTER_INPUT);
+        const InputCollector::Disposition disposition = input.Add(event);
+        if (disposition == InputCollector::Disposition::Drop)
+            continue;
+        if (disposition == InputCollector::Disposition::Defer)
+        {
+            motion     = event;
+            has_motion = true;
+            continue;
+        }
+        if (has_motion)
+        {
+            ImGui_ImplSDL2_ProcessEvent(&motion);
+            has_motion = false;
+        }
+        ImGui_ImplSDL2_ProcessEvent(&event);
+        switch (event.type)
+        {
+            case SDL_WINDOWEVENT:
+                if (scene_views.HandleWindowEvent(event.window))
+                    break;
+                switch (event.window.event)
+                {
+                    case SDL_WINDOWEVENT_CLOSE:
+                        {
+                            is_done = true;
+                        }
+                        break;
+                    // ImGui's platform windows send these too; only the main window decides
+                    case SDL_WINDOWEVENT_MINIMIZED:
+                    case SDL_WINDOWEVENT_HIDDEN:
+                        if (event.window.windowID == SDL_GetWindowID(ptr_window))
+                            setVisible(false);
+                        break;
+                    case SDL_WINDOWEVENT_RESTORED:
+                    case SDL_WINDOWEVENT_MAXIMIZED:
+                    case SDL_WINDOWEVENT_SHOWN:
+                        if (event.window.windowID == SDL_GetWindowID(ptr_window))
+                            setVisible(true);
+                        break;
+                    // one resize sends both, and a drag several a frame; only the last size is applied, after the loop
+                    case SDL_WINDOWEVENT_RESIZED:
+                    case SDL_WINDOWEVENT_SIZE_CHANGED:
+                        if (event.window.windowID == SDL_GetWindowID(ptr_window))
+                            resized = glm::ivec2{ event.window.data1, event.window.data2 };
+                        break;
+                }
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+                // ImGui's answer from the last frame; a click on one of its windows is the window's
+                if (pick_on_click && event.button.button == SDL_BUTTON_LEFT && event.button.windowID == SDL_GetWindowID(ptr_window) && !ImGui::GetIO().WantCaptureMouse)
+                {
+                    pick_cursor     = glm::vec2{ static_cast<float>(event.button.x), static_cast<float>(event.button.y) };
+                    has_pick_cursor = true;
+                    invalidateScene();
+                }
+                break;
+            case SDL_KEYDOWN:
+                if (event.key.keysym.sym == SDLK_F9 && event.key.repeat == 0)
+                    toggleCapture();
+                if (event.key.keysym.sym == SDLK_F12 && event.key.repeat == 0)
+                    startFrameCapture((event.key.keysym.mod & KMOD_SHIFT) != 0 ? FRAME_CAPTURE_SEQUENCE : 1);
+                if (event.key.keysym.sym == SDLK_F8 && event.key.repeat == 0)
+                {
+                    latency_probe.SetEnabled(!latency_probe.IsEnabled());
+                    invalidateScene();
+                }
+                else if (latency_probe.IsEnabled() && event.key.repeat == 0)
+                {
+                    // back to when SDL queued it; a replayed press is as old as its recording, so only a little
+                    const Uint64 now    = SDL_GetPerformanceCounter();
+                    const Uint32 queued = std::min<Uint32>(SDL_GetTicks() - event.key.timestamp, 100);
+                    latency_probe.KeyPressed(now - std::min<Uint64>(now, static_cast<Uint64>(queued) * SDL_GetPerformanceFrequency() / 1000));
+                    invalidateScene();
+                }
+                break;
+            case SDL_QUIT: [[unlikely]] is_done = true; break;
+        }
+    }
+    if (has_motion)
+        ImGui_ImplSDL2_ProcessEvent(&motion);
+    if (resized != glm::ivec2{ 0 })
+    {
+        // the events carry points; the pixels behind them can change with the display the window is on
+        gWindowWidth  = resized.x;
+        gWindowHeight = resized.y;
+        SDL_GL_GetDrawableSize(ptr_window, &gDrawableSize.x, &gDrawableSize.y);
+        demo.SetDisplaySize(gWindowWidth, gWindowHeight);
+        invalidateScene();
+    }
+    input.EndFrame();
+    if (!is_logged)
+        return;
+    if (++input_frame >= input_log.Frames() && input_mode == InputMode::Replaying)
+    {
+        std::cout << "Replay of " << input_log_file << " finished after " << input_frame << " frames\n";
+        is_done = true;
+    }
+}
+
+bool Application::IsDone() const noexcept
+{
+    return is_done;
+}
+
+void Application::ExitAfterStartup() noexcept
+{
+    exit_after_startup = true;
+}
+
+void Application::SetReactive(bool enabled) noexcept
+{
+    reactive = enabled;
+    invalidate(REDRAW_FRAMES_AFTER_INPUT);
+}
+
+void Application::SetFramePacing(const PacingSettings& settings)
+{
+    pacing = settings;
+    invalidateScene();
+}
+
+void Application::SetPageVisible(bool visible)
+{
+    setVisible(visible);
+    if (!audio_device.IsCurrent())
+        return;
+    // a device that can't pause keeps playing what is queued, and the refills keep it going
+    audio_device.SetPaused(!visible);
+    audio_streamer.SetSuspended(audio_device.IsLost() || audio_device.IsPaused());
+}
+
+void Application::SetResolution(const ResolutionSettings& settings)
+{
+    resolution = settings;
+    invalidateScene();
+}
+
+void Application::SetAntiAliasing(const AntiAliasSettings& settings)
+{
+    anti_aliasing = settings;
+    invalidateScene();
+}
+
+void Application::SetViewports(const ViewportSettings& settings)
+{
+    viewports = settings;
+    invalidateScene();
+}
+
+void Application::SetConfigFile(std::filesystem::path filename)
+{
+    config_file = std::move(filename);
+}
+
+AppConfig Application::currentConfig() const
+{
+    AppConfig config;
+    config.quality         = configured_quality;
+    config.gpu             = gpu_preference;
+    config.window_size     = glm::ivec2{ gWindowWidth, gWindowHeight };
+    config.pacing          = pacing;
+    config.resolution      = resolution;
+    config.anti_aliasing   = anti_aliasing;
+    config.post            = post_settings;
+    config.viewports       = viewports;
+    config.audio           = audio_settings;
+    config.reactive        = reactive;
+    config.ui_damage       = damage_ui;
+    config.worker_threads  = worker_threads;
+    config.pin_workers     = pin_workers;
+    config.loads_in_flight = loads.MaxInFlight();
+    config.upload_kb       = static_cast<int>(upload_bytes / 1024);
+    config.upload_ms       = upload_ms;
+    config.hitch_ms        = hitch_detector.Threshold();
+    config.telemetry       = telemetry_address;
+    config.telemetry_hz    = telemetry_hz;
+    return config;
+}
+
+void Application::drawConfigImGui()
+{
+    if (!ImGui::CollapsingHeader("Settings"))
+        return;
+    // pacing, scale, AA, viewports and the audio mix have their editors above; these are the loaders' and the next start's
+    int in_flight = loads.MaxInFlight();
+    if (ImGui::SliderInt("loads in flight", &in_flight, 1, static_cast<int>(workers.ThreadCount()) + 1))
+        loads.SetMaxInFlight(in_flight);
+    int upload_kb = static_cast<int>(upload_bytes / 1024);
+    if (ImGui::SliderInt("upload budget (KB)", &upload_kb, 256, 64 * 1024, "%d", ImGuiSliderFlags_Logarithmic))
+        upload_bytes = static_cast<std::size_t>(upload_kb) * 1024;
+    float upload_budget_ms = static_cast<float>(upload_ms);
+    if (ImGui::SliderFloat("upload budget (ms)", &upload_budget_ms, 0.25f, 16.0f, "%.2f", ImGuiSliderFlags_Logarithmic))
+        upload_ms = static_cast<double>(upload_budget_ms);
+    float hitch_ms = static_cast<float>(hitch_detector.Threshold());
+    if (ImGui::SliderFloat("hitch trace threshold (ms, 0 off)", &hitch_ms, 0.0f, 1000.0f, "%.0f"))
+        hitch_detector.SetThreshold(static_cast<double>(hitch_ms));
+    if (const HitchDetector::Stats& hitches = hitch_detector.GetStats(); hitches.hitches > 0)
+        ImGui::Text("%llu hitches, worst %.1f ms, %d traces, last %s", static_cast<unsigned long long>(hitches.hitches), hitches.worst_ms, hitches.traces, hitches.last_trace.c_str());
+    if (telemetry.IsRunning())
+    {
+        const TelemetrySender::Stats sender = telemetry.GetStats();
+        ImGui::Text("telemetry to %s at %d Hz: %llu sent, %llu failed, %llu frames dropped", telemetry_address.c_str(), telemetry_hz, static_cast<unsigned long long>(sender.sent),
+                    static_cast<unsigned long long>(sender.failed), static_cast<unsigned long long>(sender.dropped));
+    }
+    ImGui::InputInt("worker threads (next start, 0 per core)", &worker_threads);
+    worker_threads = std::clamp(worker_threads, 0, 64);
+    ImGui::Checkbox("pin workers to physical cores (next start)", &pin_workers);
+    ImGui::Text("running %u worker threads, %d physical cores found", workers.ThreadCount(), scheduling::PhysicalCoreCount());
+    ImGui::Text("quality %s%s: GL %d.%d %s, %d cores, %d MB, %.1f Gpixel/s", app_config::TierName(quality), configured_quality == QualityTier::Auto ? " (auto)" : "",
+                hardware.gl_major, hardware.gl_minor, hardware.renderer.c_str(), hardware.cpu_count, hardware.ram_mb, hardware.fill_gpixels);
+    {
+        // the driver picks the GPU as it loads, so this is the next start's
+        static constexpr const char* PREFERENCES[] = { "performance", "battery-saver", "system" };
+        int                          preference    = static_cast<int>(gpu_preference);
+        if (ImGui::Combo("gpu (next start)", &preference, PREFERENCES, IM_ARRAYSIZE(PREFERENCES)))
+            gpu_preference = static_cast<GpuPreference>(preference);
+    }
+    if (config_file.empty())
+        return;
+    if (ImGui::Button("save settings"))
+        config_status = app_config::Save(config_file, currentConfig()) ? "wrote " + std::filesystem::absolute(config_file).string() : "failed to write " + config_file.string();
+    if (!config_status.empty())
+    {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(config_status.c_str());
+    }
+}
+
+bool Application::StartUploadThread()
+{
+    if (!upload_thread.Start(ptr_window, gl_context))
+        return false;
+    texture_loader.SetUploadThread(&upload_thread);
+    return true;
+}
+
+bool Application::StartRenderThread()
+{
+#if defined(__EMSCRIPTEN__)
+    return false;
+#else
+    // ImGui makes its shaders and placeholder font texture on the first NewFrame; do it while gl_context is still ours
+    imgui_fonts::NewFrame();
+    // platform windows would need gl_context back on the main thread every frame
+    ImGui::GetIO().ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+
+    hint_gl(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    upload_context = SDL_GL_CreateContext(ptr_window);
+    hint_gl(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    if (upload_context == nullptr)
+    {
+        LOG_WARN("Failed to create the upload context: ", SDL_GetError());
+        SDL_GL_MakeCurrent(ptr_window, gl_context);
+        return false;
+    }
+    SDL_GL_MakeCurrent(ptr_window, gl_context);
+    if (!render_thread.Start(ptr_window, gl_context))
+    {
+        SDL_GL_DeleteContext(upload_context);
+        upload_context = nullptr;
+        return false;
+    }
+    // texture uploads and the shutdown path keep working on the main thread through the shared context
+    SDL_GL_MakeCurrent(ptr_window, upload_context);
+    gl_state::Invalidate();
+    gl_debug::Install();
+    return true;
+#endif
+}
+
+void Application::waitForWork()
+{
+#if !defined(__EMSCRIPTEN__)
+    // the browser drives the Emscripten loop, blocking it would freeze the page
+    if (!is_visible)
+    {
+        SDL_WaitEventTimeout(nullptr, static_cast<int>(HIDDEN_WAKE_MS));
+        last_ticks = 0;
+        return;
+    }
+    if (!reactive || needsRedraw())
+        return;
+    // a NULL event leaves the wake-up event queued for updateWindowEvents; the timeout is a slow tick for background work
+    SDL_WaitEventTimeout(nullptr, static_cast<int>(IDLE_WAKE_MS));
+    // time spent asleep isn't simulation time
+    last_ticks = 0;
+#endif
+}
+
+bool Application::needsRedraw() const
+{
+    // a frame drawn while a program compiles is missing whatever that program draws
+    return redraw_frames > 0 || demo.IsAnimating() || ImGui::GetIO().WantTextInput || shader_cache::PendingCount() > 0;
+}
+
+void Application::invalidate(int frames) noexcept
+{
+    redraw_frames = std::max(redraw_frames, frames);
+}
+
+void Application::invalidateScene() noexcept
+{
+    scene_changed = true;
+    invalidate(1);
+}
+
+void Application::updateAudio()
+{
+    if (demo.HasAudio() || audio_device.HasFailed())
+        return;
+    const bool prewarm = audio_settings.startup == AudioStartup::Prewarm && frames_drawn > 0;
+    if (!prewarm && !demo.WantsAudio())
+        return;
+    if (!audio_device.IsRequested())
+    {
+        demo.RequestSounds(sound_cache);
+        audio_device.Open(workers, audio_settings.mix);
+    }
+    if (audio_device.Poll())
+    {
+        demo.SetupAudio(audio_streamer, asset_pack, audio_settings.backend);
+        invalidate(1);
+    }
+}
+
+void Application::deferredStartup()
+{
+#if defined(__EMSCRIPTEN__)
+    if (!has_painted)
+    {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        SDL_GL_SwapWindow(ptr_window);
+        has_painted    = true;
+        first_paint_ms = emscripten_get_now();
+        EM_ASM(performance.mark('programming-fun first paint'));
+        return;
+    }
+#endif
+    setupScene();
+    is_scene_ready = true;
+    // the setup frames are not simulation time
+    last_ticks = 0;
+    invalidateScene();
+}
+
+void Application::toggleCapture()
+{
+    if (!profiler::IsCapturing())
+    {
+        profiler::StartCapture();
+        std::cout << "Profiler capture started, F9 again to write it\n";
+        return;
+    }
+    const std::filesystem::path filename = "profile_capture_" + std::to_string(++captures_written) + ".json";
+    if (profiler::StopCapture(filename))
+        std::cout << "Profiler capture written to " << std::filesystem::absolute(filename) << '\n';
+}
+
+void Application::RecordInput(std::filesystem::path filename)
+{
+    input_mode     = InputMode::Recording;
+    input_log_file = std::move(filename);
+}
+
+bool Application::ReplayInput(const std::filesystem::path& filename)
+{
+    if (!input_log.Load(filename, SDL_GetWindowID(ptr_window)))
+        return false;
+    input_mode     = InputMode::Replaying;
+    input_log_file = filename;
+    std::cout << "Replaying " << input_log.Frames() << " frames, " << input_log.EventCount() << " events from " << filename << '\n';
+    return true;
+}
+
+bool Application::LoadScene(const std::filesystem::path& filename)
+{
+    SceneFile scene;
+    if (!scene.Open(filename))
+        return false;
+    demo.LoadScene(scene);
+    std::cout << "Scene " << filename << ": " << scene.EntityCount() << " ducks\n";
+    return true;
+}
+
+void Application::startFrameCapture(int frames)
+{
+    if (frame_capture_left > 0)
+        return;
+    ++frame_captures_started;
+    frame_capture_left  = frames;
+    frame_capture_index = 0;
+    invalidateScene();
+    std::cout << "Capturing " << frames << (frames == 1 ? " frame" : " frames") << " to " << std::filesystem::absolute("frame_capture_" + std::to_string(frame_captures_started) + "_*.png")
+              << '\n';
+}
+
+void Application::setVisible(bool visible)
+{
+    // a benchmark's or a batch's window is hidden on purpose and keeps drawing
+    if (visible == is_visible || benchmark || batch)
+        return;
+    is_visible = visible;
+    audio_streamer.SetBackground(!visible);
+    scheduling::SetFineTimer(visible);
+    if (visible)
+    {
+        // nothing was drawn meanwhile, and the time away is not simulation time
+        last_ticks = 0;
+        invalidateScene();
+        invalidate(REDRAW_FRAMES_AFTER_INPUT);
+    }
+}
+
+void Application::StartBenchmark(const BenchmarkSettings& settings)
+{
+    benchmark.emplace(settings);
+    SetReactive(false);
+    SetFramePacing(PacingSettings{ .mode = PacingMode::Uncapped });
+    SetViewports(ViewportSettings{ .enabled = false });
+    std::cout << "Benchmark: " << settings.frames << " frames after " << settings.warmup_frames << " warmup, report " << settings.report << '\n';
+}
+
+void Application::StartUploadBenchmark(std::size_t frame_bytes)
+{
+    SetReactive(false);
+    SetFramePacing(PacingSettings{ .mode = PacingMode::Uncapped });
+    upload_benchmark.Start(frame_bytes);
+    upload_benchmark_exit = true;
+    std::cout << "Upload benchmark: " << static_cast<double>(upload_benchmark.FrameBytes()) / (1024.0 * 1024.0) << " MB a frame\n";
+}
+
+void Application::reloadChangedAssets()
+{
+    if (!asset_watcher.IsWatching())
+        return;
+    PROFILE_ZONE("Asset Watcher");
+    changed_assets.clear();
+    asset_watcher.Poll(changed_assets);
+    for (const std::filesystem::path& changed : changed_assets)
+    {
+        // files nothing loaded, an editor's backup or the pack itself, match nothing
+        const std::size_t queued = texture_loader.Reload(changed) + sound_cache.Reload(changed);
+        if (queued == 0)
+            continue;
+        std::cout << "Reloading " << changed.lexically_relative(asset_watcher.Root()).generic_string() << " (" << queued << (queued == 1 ? " asset)\n" : " assets)\n");
+        ++assets_reloaded;
+    }
+}
+
+void Application::markDrawnTextures(FramePacket& frame)
+{
+    // sprites come in runs of one texture, so only where it changes
+    GLuint previous = 0;
+    for (const SpriteDraw& sprite : frame.sprites)
+    {
+        if (sprite.texture != previous)
+            texture_loader.MarkDrawn(sprite.texture);
+        previous = sprite.texture;
+    }
+    texture_loader.MarkDrawn(frame.animated_sprites.texture);
+    texture_loader.MarkDrawn(frame.particles.texture);
+    texture_loader.MarkDrawn(frame.tilemap.texture);
+    if (const ImDrawData* draw_data = frame.ImGuiDrawData(); draw_data != nullptr)
+    {
+        for (const ImDrawList* list : draw_data->CmdLists)
+        {
+            for (const ImDrawCmd& command : list->CmdBuffer)
+                texture_loader.MarkDrawn(static_cast<GLuint>(reinterpret_cast<std::intptr_t>(command.GetTexID())));
+        }
+    }
+    texture_loader.FrameDrawn();
+}
+
+void Application::advanceBenchmark(Uint64 now)
+{
+    const bool                loading  = texture_loader.PendingCount() > 0 || sound_cache.PendingCount() > 0;
+    const BenchmarkRun::Phase previous = benchmark->GetPhase();
+    const BenchmarkRun::Phase phase    = benchmark->Advance(loading, profiler::ToMilliseconds(now - started_ticks));
+    if (previous == BenchmarkRun::Phase::Loading && phase == BenchmarkRun::Phase::Warmup)
+        demo.SetStressLoad(benchmark->Settings().sprites, benchmark->Settings().markers);
+}
+
+bool Application::StartBatchRender(const BatchSettings& settings)
+{
+    batch.emplace();
+    if (!batch->Open(settings))
+    {
+        batch.reset();
+        return false;
+    }
+    SetReactive(false);
+    // the GPU may run as far ahead as it likes; nobody is waiting on input
+    SetFramePacing(PacingSettings{ .mode = PacingMode::Uncapped, .frames_in_flight = PacingSettings::MAX_FRAMES_IN_FLIGHT });
+    SetViewports(ViewportSettings{ .enabled = false });
+    // every image at the window's size, whatever the GPU timer says
+    resolution.dynamic = false;
+    std::cout << "Batch: " << batch->JobCount() << " scenes from " << settings.list << " to " << std::filesystem::absolute(settings.output) << '\n';
+    return true;
+}
+
+void Application::advanceBatch(Uint64 now)
+{
+    const bool loading = texture_loader.PendingCount() > 0 || sound_cache.PendingCount() > 0;
+    // the render side's numbers, a frame or more behind; WaitForSlot and Shutdown cover what they miss
+    const bool can_capture = last_capture_stats.in_flight < FrameCapture::SLOTS;
+    const bool writing     = last_capture_stats.in_flight > 0 || last_capture_stats.encoding > 0;
+    batch_step             = batch->Advance(loading, can_capture, writing, profiler::ToMilliseconds(now - started_ticks));
+    if (batch_step == BatchRender::Step::Load && !LoadScene(batch->Current().scene))
+    {
+        std::cerr << "Skipping batch scene " << batch->Current().scene << '\n';
+        batch->Skip();
+    }
+    if (batch_step != BatchRender::Step::Done)
+        return;
+    batch->Print(std::cout);
+    is_done = true;
+}
+
+void Application::recordBenchmark(Uint64 frame_begin, bool is_threaded)
+{
+    const Uint64 end      = SDL_GetPerformanceCounter();
+    const double cpu_ms   = profiler::ToMilliseconds(end - frame_begin);
+    // start to start would include the idle wait; end to end is the whole loop, swap included
+    const double frame_ms = benchmark_last_end == 0 ? cpu_ms : profiler::ToMilliseconds(end - benchmark_last_end);
+    benchmark_last_end    = end;
+    double gpu_ms         = -1.0;
+    if (!is_threaded && profiler::GpuFramesResolved() != benchmark_gpu_resolved)
+    {
+        benchmark_gpu_resolved = profiler::GpuFramesResolved();
+        gpu_ms                 = profiler::LatestGpuFrame().total_ms;
+    }
+    benchmark->Record(frame_ms, cpu_ms, gpu_ms);
+    if (benchmark->GetPhase() != BenchmarkRun::Phase::Done)
+        return;
+    if (benchmark->WriteReport(is_threaded))
+        std::cout << "Benchmark report written to " << std::filesystem::absolute(benchmark->Settings().report) << '\n';
+    is_done = true;
+}
+
+void Application::recordFrameMetrics(Uint64 frame_begin, bool is_threaded)
+{
+    const Uint64 end      = SDL_GetPerformanceCounter();
+    const double cpu_ms   = profiler::ToMilliseconds(end - frame_begin);
+    const double frame_ms = hud_last_end == 0 ? cpu_ms : profiler::ToMilliseconds(end - hud_last_end);
+    hud_last_end          = end;
+    last_frame_ms         = frame_ms;
+    double gpu_ms         = -1.0;
+    if (!is_threaded && profiler::GpuFramesResolved() != hud_gpu_resolved)
+    {
+        hud_gpu_resolved = profiler::GpuFramesResolved();
+        gpu_ms           = profiler::LatestGpuFrame().total_ms;
+    }
+    perf_hud.Record(frame_ms, cpu_ms, gpu_ms, 1000.0 / static_cast<double>(std::max(pacing.target_fps, 1)));
+    if (last_pacer_stats.measured != hud_latency_measured)
+    {
+        hud_latency_measured = last_pacer_stats.measured;
+        perf_hud.RecordLatency(last_pacer_stats.latency_ms);
+    }
+    // the first frame is startup's, which the startup trace covers
+    if (frames_drawn > 1)
+        hitch_detector.Record(frame_ms);
+    if (telemetry.IsRunning())
+    {
+        const PerfHud::Counters       counters = frameCounters();
+        TelemetrySender::FrameMetrics metrics;
+        metrics.frame        = frames_drawn;
+        metrics.frame_ms     = static_cast<float>(frame_ms);
+        metrics.cpu_ms       = static_cast<float>(cpu_ms);
+        metrics.gpu_ms       = static_cast<float>(gpu_ms);
+        metrics.memory_bytes = counters.memory_bytes;
+        metrics.draw_calls   = counters.draw_calls;
+        metrics.loads_queued = counters.loads_queued;
+        metrics.loads_active = counters.loads_active;
+        for (const perf_counters::Sample& sample : counters.published)
+        {
+            if ((sample.publish & perf_counters::InTelemetry) != 0 && metrics.counter_count < telemetry::MAX_COUNTERS)
+                metrics.counters[static_cast<std::size_t>(metrics.counter_count++)] = TelemetrySender::PublishedCounter{ sample.name, sample.value, sample.kind == perf_counters::Kind::Counter };
+        }
+        telemetry.Push(metrics);
+    }
+}
+
+PerfHud::Counters Application::frameCounters() const
+{
+    PerfHud::Counters counters;
+    for (int category = 0; category < static_cast<int>(MemoryCategory::Count); ++category)
+        counters.memory_bytes += memory_tracker::GetStats(static_cast<MemoryCategory>(category)).current_bytes;
+    counters.draw_calls                   = gl_stats::LastFrame().Total().draw_calls;
+    const LoadScheduler::Stats load_stats = loads.GetStats();
+    for (const int queued : load_stats.queued)
+        counters.loads_queued += queued;
+    counters.loads_active = load_stats.in_flight;
+    if (allocation_counter::IsEnabled())
+    {
+        const allocation_counter::FrameCounts allocations = allocation_counter::LastFrame();
+        counters.allocations                              = static_cast<int>(allocations.allocations);
+        counters.allocated_bytes                          = static_cast<std::size_t>(allocations.bytes);
+        counters.is_steady                                = allocation_counter::IsSteady();
+    }
+    counters.published = perf_counters::LastFrame();
+    return counters;
+}
+
+void Application::ForceResize(int desired_width, int desired_height) const
+{
+    SDL_SetWindowSize(ptr_window, desired_width, desired_height);
+}
+
+void Demo::RequestSounds(SoundCache& sound_cache)
+{
+    // decodes in the background; the buttons wait for it instead of the window
+    sounds = &sound_cache;
+    quack  = sound_cache.Acquire("audio/duck-quacking-loudly-three-times.wav"_asset);
+}
+
+void Demo::Setup(MeshRenderer& mesh_renderer, AnimatedSpriteRenderer& animated_renderer, const SpriteBatch& sprite_batch, const ParticleSystem& particle_system,
+                 const AudioDevice& audio_device, SdfFont& label_font)
+{
+    SetDisplaySize(gWindowWidth, gWindowHeight);
+    // the duck and its mirror image, a waddle whatever region of the atlas the duck lands in
+    const SpriteClipFrame waddle[] = { { glm::vec4{ 0.0f, 0.0f, 1.0f, 1.0f }, 0.25f }, { glm::vec4{ 1.0f, 0.0f, 0.0f, 1.0f }, 0.25f } };
+    animated.clip                  = animated_renderer.AddClip(waddle);
+    sprite_stress.bindless_available = sprite_batch.IsBindlessAvailable();
+    particles.compute                = particle_system.IsComputeAvailable();
+    markers.mesh = mesh_renderer.CreateMesh(make_marker_mesh(8, pack_rgba8(0.4f, 0.4f, 0.4f, 1.0f)));
+    labels.font  = &label_font;
+    audio        = &audio_device;
+    hierarchy.wheel = transforms.Create(Transform2D{});
+    for (TransformHandle& arm : hierarchy.arms)
+        arm = transforms.Create(Transform2D{}, hierarchy.wheel);
+}
+
+void Demo::SetupAudio(AudioStreamer& audio_streamer, const AssetPack& asset_pack, AudioBackend backend)
+{
+    voices.Setup();
+    effects.Setup();
+    spatial.Setup();
+    // more zones than slots, so the quiet quacks show slots being reused and voices falling back to dry
+    static const struct
+    {
+        const char*            name;
+        EFXEAXREVERBPROPERTIES reverb;
+    } ZONES[] = {
+        { "room", EFX_REVERB_PRESET_ROOM },
+        { "bathroom", EFX_REVERB_PRESET_BATHROOM },
+        { "hallway", EFX_REVERB_PRESET_HALLWAY },
+        { "cave", EFX_REVERB_PRESET_CAVE },
+        { "arena", EFX_REVERB_PRESET_ARENA },
+        { "underwater", EFX_REVERB_PRESET_UNDERWATER },
+    };
+    for (const auto& zone : ZONES)
+        effects.AddZone(zone.name, zone.reverb);
+
+    // a Hann windowed 880 Hz burst; both backends get the same samples
+    constexpr int   GRAIN_FREQUENCY = 48000;
+    constexpr float GRAIN_SECONDS   = 0.04f;
+    constexpr int   GRAIN_FRAMES    = static_cast<int>(GRAIN_SECONDS * GRAIN_FREQUENCY);
+    DecodedSound    grain;
+    grain.type      = SampleType::Signed16;
+    grain.channels  = 1;
+    grain.frequency = GRAIN_FREQUENCY;
+    grain.samples.resize(static_cast<std::size_t>(GRAIN_FRAMES) * sizeof(std::int16_t));
+    for (int i = 0; i < GRAIN_FRAMES; ++i)
+    {
+        const float t      = static_cast<float>(i) / static_cast<float>(GRAIN_FRAMES - 1);
+        const float window = 0.5f - 0.5f * std::cos(glm::two_pi<float>() * t);
+        const auto  value  = static_cast<std::int16_t>(32767.0f * window * std::sin(glm::two_pi<float>() * 880.0f * static_cast<float>(i) / GRAIN_FREQUENCY));
+        std::memcpy(grain.samples.data() + static_cast<std::size_t>(i) * sizeof(value), &value, sizeof(value));
+    }
+    if (backend == AudioBackend::Mixer)
+    {
+        grains.mixer = std::make_unique<SoftwareMixer>(SoftwareMixer::DEFAULT_FREQUENCY, SoftwareMixer::MAX_VOICES);
+        if (grains.mixer->Open())
+        {
+            grains.mixer_buffer = grains.mixer->AddBuffer(grain);
+            grains.mixer->SetListener(grains.listener, glm::vec3{ 0.0f, 0.0f, -1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+        }
+        else
+        {
+            LOG_WARN("The grains fall back to OpenAL");
+            grains.mixer.reset();
+        }
+    }
+    alGenBuffers(1, &grains.al_buffer);
+    alBufferData(grains.al_buffer, AL_FORMAT_MONO16, grain.samples.data(), static_cast<ALsizei>(grain.samples.size()), GRAIN_FREQUENCY);
+
+    // from here on voices, effects and spatial audio are only touched through the command queue
+    audio_thread.Start(voices, effects, spatial);
+    has_audio = true;
+    streamer  = &audio_streamer;
+
+    constexpr AssetId stereo_id   = "audio/duck_vocalizations.ogg"_asset;
+    const auto        stereo_path = stereo_id.Path();
+    const auto        ogg_bytes   = asset_pack.Read(stereo_id, stereo_ogg);
+    stereo_stream          = ogg_bytes.empty() ? audio_streamer.Open(stereo_path) : audio_streamer.Open(ogg_bytes);
+    if (stereo_stream == nullptr)
+    {
+        throw_error_message("Failed to load OGG file: ", stereo_path);
+    }
+    // one track twice over, which is all the assets have, still shows the preload and the crossfade
+    music.Setup(audio_streamer);
+    music.SetPlaylist({ MusicPlayer::Track{ stereo_path, ogg_bytes }, MusicPlayer::Track{ stereo_path, ogg_bytes } });
+}
+
+void Demo::Shutdown(AudioStreamer& audio_streamer, WorkerPool& workers)
+{
+    tiles.map.Shutdown(workers);
+    scenery.sprites.Shutdown();
+    scenery.handles.clear();
+    virtual_image.texture.Close();
+    // before the streamer goes, the soundtrack being one of its streams
+    if (video.player != nullptr)
+        video.player->Close();
+    // the textures are the loader's; the atlas pages and the array are ours
+    example_image.reset();
+    atlas_duck.reset();
+    mipmapped_duck.reset();
+    array_duck.reset();
+    thumbnail_duck.reset();
+    atlas.Shutdown();
+    duck_array.Shutdown();
+
+    music.Shutdown();
+    audio_streamer.Close(stereo_stream);
+    audio_thread.Stop();
+    spatial.Shutdown(voices);
+    quacking_ducks.clear();
+    voices.Shutdown();
+    effects.Shutdown();
+    grains.mixer.reset();
+    if (grains.al_buffer != 0)
+        alDeleteBuffers(1, &grains.al_buffer);
+    grains.al_buffer = 0;
+    quack.reset();
+}
+
+void Demo::StopAudioThread()
+{
+    audio_thread.Stop();
+}
+
+void Demo::FixedUpdate(float step_seconds, WorkerPool& workers, std::uint32_t input_frame)
+{
+    fixed_step = step_seconds;
+    if (fixed_update.IsEmpty())
+        buildFixedUpdate(workers);
+    fixed_update.Run(workers);
+    ++step_history.step;
+    if (!step_history.record)
+        return;
+    PROFILE_ZONE("Save Step");
+    const Uint64                    started = SDL_GetPerformanceCounter();
+    WorldHistory<StepState>::Entry& entry   = step_history.ring.Push(step_history.step, input_frame);
+    step_history.saved_bytes                     = sprite_stress.ducks.Save(entry.entities);
+    entry.extra                             = StepState{ hierarchy.angle, hierarchy.cursor, animated.time, particles.time, night.time, tiles.view_offset };
+    step_history.save_us                         = static_cast<double>(SDL_GetPerformanceCounter() - started) * 1'000'000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+std::optional<std::uint32_t> Demo::TakeRewind() noexcept
+{
+    return std::exchange(step_history.rewound_input_frame, std::nullopt);
+}
+
+void Demo::rewind(std::size_t steps)
+{
+    const WorldHistory<StepState>::Entry* entry = step_history.ring.Back(steps);
+    if (entry == nullptr)
+        return;
+    PROFILE_ZONE("Rewind");
+    const Uint64 started   = SDL_GetPerformanceCounter();
+    step_history.restored_bytes = sprite_stress.ducks.Restore(entry->entities);
+    hierarchy.angle        = entry->extra.hierarchy_angle;
+    hierarchy.cursor       = entry->extra.hierarchy_cursor;
+    animated.time          = entry->extra.animated_time;
+    particles.time         = entry->extra.particle_time;
+    night.time             = entry->extra.night_time;
+    tiles.view_offset      = entry->extra.tile_offset;
+    step_history.restore_us     = static_cast<double>(SDL_GetPerformanceCounter() - started) * 1'000'000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    // the grid has the ducks where they are now, and a rollback past a resize brings back ducks it never had
+    if (step_history.restored_bytes > 0)
+    {
+        resetSpriteGrid();
+        sprite_stress.regridded       = regridDucks();
+        sprite_stress.requested_count = static_cast<int>(sprite_stress.ducks.Size());
+    }
+    step_history.step                = entry->step;
+    step_history.rewound_input_frame = entry->input_frame;
+    step_history.ring.Rewind(steps);
+}
+
+int Demo::regridDucks()
+{
+    // one by one, but most ducks stay in their cell and cost a compare; the bounds reach back to the previous
+    // position too, since Draw interpolates from there
+    const glm::vec2 half_extent = duckHalfExtent();
+    const auto      positions   = std::as_const(sprite_stress.ducks).Positions();
+    const auto      velocities  = std::as_const(sprite_stress.ducks).Velocities();
+    int             regridded   = 0;
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        const glm::vec2 reach = half_extent + glm::abs(velocities[i]) * fixed_step;
+        if (sprite_stress.grid.Set(static_cast<std::uint32_t>(i), positions[i], reach))
+            ++regridded;
+    }
+    return regridded;
+}
+
+void Demo::buildFixedUpdate(WorkerPool& workers)
+{
+    // regridding reads what integrating wrote; the particles and the tilemap's pan touch neither, so they go alongside
+    const TaskGraph::Task integrate = fixed_update.Add("Integrate Ducks",
+                                                       [this, &workers]
+                                                       {
+                                                           const glm::vec2   world_size = display_size * sprite_stress.world_scale;
+                                                           const std::size_t count      = sprite_stress.ducks.Size();
+                                                           const Uint64      started    = SDL_GetPerformanceCounter();
+                                                           workers.ParallelFor("Integrate Ducks", count, workers.GrainFor(count, sizeof(glm::vec2)),
+                                                                               [this, world_size](std::size_t begin, std::size_t end)
+                                                                               { sprite_stress.ducks.Integrate(begin, end, fixed_step, world_size); });
+                                                           // from whichever worker ran the task, without waiting on the ui
+                                                           if (count > 0)
+                                                               worker_ui::Plot("integrate ducks ms", static_cast<float>(profiler::ToMilliseconds(SDL_GetPerformanceCounter() - started)));
+                                                       });
+    fixed_update.Add("Regrid Ducks", [this] { sprite_stress.regridded = regridDucks(); }, { integrate });
+    fixed_update.Add("Transforms",
+                     [this, &workers]
+                     {
+                         if (hierarchy.carousel)
+                         {
+                             hierarchy.angle += 0.5f * fixed_step;
+                             const glm::vec2 center{ display_size.x * 0.5f, display_size.y * 0.6f };
+                             transforms.SetLocal(hierarchy.wheel, Transform2D{ center, hierarchy.angle, glm::vec2{ display_size.y * 0.3f } });
+                         }
+                         if (hierarchy.arm_count != particles.fountains)
+                         {
+                             // on the unit circle; the wheel's scale makes them its radius
+                             hierarchy.arm_count = particles.fountains;
+                             for (int i = 0; i < hierarchy.arm_count; ++i)
+                             {
+                                 const float angle = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(hierarchy.arm_count);
+                                 transforms.SetLocal(hierarchy.arms[static_cast<std::size_t>(i)], Transform2D{ glm::vec2{ std::cos(angle), std::sin(angle) } });
+                             }
+                         }
+                         const std::size_t count = hierarchy.tree.size();
+                         const auto        moves = std::min(count, static_cast<std::size_t>(static_cast<float>(count) * hierarchy.moving));
+                         for (std::size_t i = 0; i < moves; ++i)
+                         {
+                             const TransformHandle node  = hierarchy.tree[(hierarchy.cursor + i) % count];
+                             Transform2D           local = transforms.Local(node);
+                             local.rotation += fixed_step;
+                             transforms.SetLocal(node, local);
+                         }
+                         hierarchy.cursor = count > 0 ? (hierarchy.cursor + moves) % count : 0;
+                         transforms.Update(workers);
+                     });
+    fixed_update.Add("Particles And Tiles",
+                     [this]
+                     {
+                         if (particles.enabled)
+                             particles.time += fixed_step;
+                         particles.step = fixed_step;
+                         animated.time  += fixed_step;
+                         animated.step  = fixed_step;
+                         if (night.enabled)
+                             night.time += fixed_step;
+                         night.step = fixed_step;
+                         if (tiles.enabled && tiles.pan)
+                         {
+                             // a screen every few seconds whatever the zoom, wrapping round at the right edge
+                             const float view_width = display_size.x / tiles.zoom;
+                             tiles.view_offset.x += view_width * 0.25f * fixed_step;
+                             if (tiles.view_offset.x + view_width > tiles.map.WorldSize().x)
+                                 tiles.view_offset.x = 0.0f;
+                         }
+                     });
+}
+
+void Demo::Update(WorkerPool& workers)
+{
+    measureLatency();
+    // a disconnected device stops whatever starts, so nothing new does until it's reopened
+    if (!has_audio || !audio->IsLost())
+    {
+        playPending();
+        updateQuackingDucks(workers);
+        updateGrains();
+    }
+    if (has_audio)
+    {
+        music.Update();
+        audio_thread.Flush();
+        audio_stats.Update(*audio, audio_thread, sounds, *streamer);
+    }
+}
+
+namespace
+{
+    constexpr float TILE_SIZE   = 16.0f; // world units, a pixel each at zoom 1
+    constexpr int   TILE_PIXELS = 16;    // texels a tile in the sheet
+
+    // water, sand, grass, forest, rock and snow, by TileId - 1; not constexpr, glm's aligned types can't be
+    const std::array<glm::vec3, 6> TILE_COLORS{
+        glm::vec3{ 0.18f, 0.36f, 0.70f }, glm::vec3{ 0.86f, 0.80f, 0.55f }, glm::vec3{ 0.36f, 0.66f, 0.28f },
+        glm::vec3{ 0.16f, 0.42f, 0.20f }, glm::vec3{ 0.50f, 0.48f, 0.46f }, glm::vec3{ 0.94f, 0.95f, 0.97f },
+    };
+    constexpr int TILE_COUNT    = static_cast<int>(std::tuple_size_v<decltype(TILE_COLORS)>);
+    constexpr int TILESET_WIDTH = TILE_PIXELS * TILE_COUNT;
+
+    float lattice(int x, int y) noexcept
+    {
+        auto hash = static_cast<std::uint32_t>(x) * 0x27D4EB2Du ^ static_cast<std::uint32_t>(y) * 0x165667B1u;
+        hash ^= hash >> 15;
+        hash *= 0x2C1B3C6Du;
+        hash ^= hash >> 12;
+        return static_cast<float>(hash & 0xFFFFu) / 65535.0f;
+    }
+
+    // bilinear between hashed lattice points, smoothstepped so the cells don't show
+    float value_noise(float x, float y) noexcept
+    {
+        const float x0     = std::floor(x);
+        const float y0     = std::floor(y);
+        const int   ix     = static_cast<int>(x0);
+        const int   iy     = static_cast<int>(y0);
+        const float fx     = (x - x0) * (x - x0) * (3.0f - 2.0f * (x - x0));
+        const float fy     = (y - y0) * (y - y0) * (3.0f - 2.0f * (y - y0));
+        const float top    = std::lerp(lattice(ix, iy), lattice(ix + 1, iy), fx);
+        const float bottom = std::lerp(lattice(ix, iy + 1), lattice(ix + 1, iy + 1), fx);
+        return std::lerp(top, bottom, fy);
+    }
+
+    TileId terrain_tile(int x, int y)
+    {
+        // four octaves, continents down to coves
+        float height    = 0.0f;
+        float amplitude = 0.5f;
+        float frequency = 1.0f / 128.0f;
+        for (int octave = 0; octave < 4; ++octave)
+        {
+            height += amplitude * value_noise(static_cast<float>(x) * frequency, static_cast<float>(y) * frequency);
+            amplitude *= 0.5f;
+            frequency *= 2.0f;
+        }
+        height /= 0.9375f;
+        constexpr float LEVELS[] = { 0.42f, 0.46f, 0.58f, 0.68f, 0.78f };
+        TileId          tile     = 1;
+        for (const float level : LEVELS)
+            tile = static_cast<TileId>(tile + (height > level ? 1 : 0));
+        return tile;
+    }
+}
+
+void Demo::UpdateTilemap(WorkerPool& workers, UploadBudget& budget, ReleaseQueue& releases)
+{
+    if (!tiles.enabled || tiles.texture == 0)
+    {
+        // nothing in view, so the chunks still age out
+        tiles.map.Update(workers, Aabb2{ glm::vec2{ 0.0f }, glm::vec2{ -1.0f } }, budget, releases);
+        return;
+    }
+    if (tiles.generated_size != tiles.size)
+    {
+        tiles.map.Resize(workers, glm::ivec2{ tiles.size }, TILE_SIZE);
+        tiles.map.SetTileset(tiles.tileset);
+        tiles.map.Generate(workers, terrain_tile);
+        tiles.generated_size = tiles.size;
+        tiles.view_offset    = glm::clamp(tiles.view_offset, glm::vec2{ 0.0f }, tiles.map.WorldSize());
+    }
+    const Aabb2 view{ tiles.view_offset, tiles.view_offset + display_size / tiles.zoom };
+    if (tiles.edits > 0)
+    {
+        // inside the view, so each edit is a chunk rebuilt where it shows
+        const glm::ivec2 first = glm::max(glm::ivec2{ view.min / TILE_SIZE }, glm::ivec2{ 0 });
+        const glm::ivec2 last  = glm::min(glm::ivec2{ view.max / TILE_SIZE }, tiles.map.Size() - 1);
+        if (first.x <= last.x && first.y <= last.y)
+        {
+            std::uniform_int_distribution<int> along_x{ first.x, last.x };
+            std::uniform_int_distribution<int> along_y{ first.y, last.y };
+            std::uniform_int_distribution<int> kind{ 1, static_cast<int>(tiles.tileset.size()) };
+            for (int i = 0; i < tiles.edits; ++i)
+                tiles.map.Set(along_x(tiles.random), along_y(tiles.random), static_cast<TileId>(kind(tiles.random)));
+        }
+    }
+    tiles.map.Update(workers, view, budget, releases);
+}
+
+void Demo::UpdateStaticSprites(UploadBudget& budget, ReleaseQueue& releases)
+{
+    const bool has_texture = atlas_duck->IsResident();
+    if (!has_texture || atlas_duck->texture.handle != scenery.texture)
+    {
+        scenery.sprites.Clear();
+        scenery.handles.clear();
+        scenery.texture = has_texture ? atlas_duck->texture.handle : 0;
+    }
+    if (has_texture)
+    {
+        const auto count = static_cast<std::size_t>(scenery.requested_count);
+        while (scenery.handles.size() > count)
+        {
+            scenery.sprites.Remove(scenery.handles.back());
+            scenery.handles.pop_back();
+        }
+        // scattered over the window as it is when they're placed; they stay there
+        const Texture&                        texture = atlas_duck->texture;
+        std::uniform_real_distribution<float> along_x{ 0.0f, display_size.x };
+        std::uniform_real_distribution<float> along_y{ 0.0f, display_size.y };
+        while (scenery.handles.size() < count)
+        {
+            SpriteInstance sprite;
+            sprite.position = glm::vec2{ along_x(scenery.random), along_y(scenery.random) };
+            sprite.size     = glm::vec2{ static_cast<float>(texture.width), static_cast<float>(texture.height) } * 0.15f;
+            sprite.uv_rect  = texture.uv_rect;
+            scenery.handles.push_back(scenery.sprites.Add(texture.handle, false, sprite));
+        }
+        if (scenery.edits > 0 && !scenery.handles.empty())
+        {
+            std::uniform_int_distribution<std::size_t>   which{ 0, scenery.handles.size() - 1 };
+            std::uniform_int_distribution<std::uint32_t> color{ 0, 0xFFFFFFu };
+            for (int i = 0; i < scenery.edits; ++i)
+            {
+                const StaticSprites::Handle handle = scenery.handles[which(scenery.random)];
+                SpriteInstance              sprite = scenery.sprites.Get(handle);
+                sprite.color                       = 0xFF000000u | color(scenery.random);
+                scenery.sprites.Set(handle, sprite);
+            }
+        }
+    }
+    scenery.sprites.Update(budget, releases);
+}
+
+void Demo::UpdateVirtualImage(LoadScheduler& load_scheduler, UploadBudget& budget)
+{
+    if (!virtual_image.enabled)
+        return;
+    if (!virtual_image.texture.IsOpen())
+    {
+        if (virtual_image.is_missing)
+            return;
+        virtual_image.is_missing = !virtual_image.texture.Open(load_scheduler, get_base_path() / virtual_image.path, VirtualTexture::DEFAULT_CACHE_PAGES, virtual_image.sparse);
+        if (virtual_image.is_missing)
+            return;
+    }
+    const Aabb2 view{ virtual_image.view_offset, virtual_image.view_offset + display_size / virtual_image.zoom };
+    virtual_image.texture.Update(view, virtual_image.zoom, budget);
+}
+
+void Demo::UpdateModel(LoadScheduler& load_scheduler, double delta_seconds)
+{
+    if (!model.enabled)
+        return;
+    if (model.spin)
+        model.angle = std::fmod(model.angle + static_cast<float>(delta_seconds) * 0.6f, glm::two_pi<float>());
+    if (model.loading != nullptr && model.loading->done.load(std::memory_order_acquire))
+    {
+        if (model.loading->loaded)
+            model.data = std::make_shared<const ModelData>(std::move(model.loading->model));
+        model.is_missing = !model.loading->loaded;
+        model.loading.reset();
+    }
+    else if (model.loading == nullptr && model.data == nullptr && !model.is_missing)
+    {
+        // a .gltf's external buffers are read by the loader itself, beside it
+        const std::filesystem::path path = get_base_path() / model.path;
+        model.loading                    = std::make_shared<ModelLoad>();
+        load_scheduler.Submit(
+            LoadPriority::Visible,
+            [path, load = model.loading]
+            {
+                const std::string name = "glTF " + path.filename().string();
+                worker_ui::Progress(name, 0.0f);
+                load->loaded = load_gltf_model(path, load->model);
+                worker_ui::Progress(name, 1.0f);
+                worker_ui::Text(load->loaded ? "loaded " + name + ", " + std::to_string(load->model.parts.size()) + " parts" : "failed to load " + name);
+                load->done.store(true, std::memory_order_release);
+            },
+            { path });
+    }
+
+    model.instances.clear();
+    model.pixels_per_unit.clear();
+    if (model.data == nullptr || model.data->parts.empty())
+        return;
+    // a grid of cells over the window, each copy centred in one and tipped towards the viewer; y flips to point up
+    // the screen, and z is squeezed into the projection's [-1, 1] so the depth test has the whole model to work with
+    const int       copies  = std::max(model.copies, 1);
+    const int       columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(copies) * display_size.x / std::max(display_size.y, 1.0f))));
+    const int       rows    = (copies + columns - 1) / columns;
+    const float     cell    = std::min(display_size.x / static_cast<float>(columns), display_size.y / static_cast<float>(rows));
+    const glm::vec2 origin  = (display_size - glm::vec2{ static_cast<float>(columns), static_cast<float>(rows) } * cell) * 0.5f;
+    const glm::vec3 middle  = (model.data->low + model.data->high) * 0.5f;
+    const float     radius  = std::max(glm::length(model.data->high - model.data->low) * 0.5f, 1e-6f);
+    for (int i = 0; i < copies; ++i)
+    {
+        // sizes spread evenly by the golden ratio, the first copy at full size
+        const float     size   = 1.0f - 0.6f * glm::fract(static_cast<float>(i) * 0.618034f);
+        const float     scale  = cell * 0.45f * model.zoom * size / radius;
+        const glm::vec2 center = origin + (glm::vec2{ static_cast<float>(i % columns), static_cast<float>(i / columns) } + 0.5f) * cell;
+        glm::mat4       transform{ 1.0f };
+        transform = glm::translate(transform, glm::vec3{ center, 0.0f });
+        transform = glm::scale(transform, glm::vec3{ scale, -scale, 0.99f / radius });
+        transform = glm::rotate(transform, 0.35f, glm::vec3{ 1.0f, 0.0f, 0.0f });
+        transform = glm::rotate(transform, model.angle, glm::vec3{ 0.0f, 1.0f, 0.0f });
+        transform = glm::translate(transform, -middle);
+        model.instances.push_back(pack_mesh_instance(transform, 0xFFFFFFFFu));
+        model.pixels_per_unit.push_back(scale);
+    }
+    model.levels.resize(model.instances.size());
+    model.lods.Select(model.data->lod_errors, model.pixels_per_unit, model.levels);
+}
+
+void Demo::UpdateVideo(LoadScheduler& load_scheduler, AudioStreamer* audio_streamer, UploadBudget& budget, double delta_seconds)
+{
+    if (!video.enabled)
+    {
+        if (video.player != nullptr && video.player->IsPlaying())
+            video.player->Stop();
+        return;
+    }
+    if (video.player == nullptr)
+    {
+        if (side_modules::Require(SideModule::Video) != ModuleState::Ready)
+            return;
+        video.player = std::make_unique<VideoPlayer>();
+    }
+    if (!video.player->IsOpen())
+    {
+        if (video.is_missing)
+            return;
+        video.is_missing = !video.player->Open(load_scheduler, get_base_path() / video.path, audio_streamer);
+        if (video.is_missing)
+            return;
+        video.player->Play();
+    }
+    video.player->SetLooping(video.loop);
+    video.player->Update(delta_seconds, budget);
+}
+
+void Demo::Draw(float alpha, FramePacket& frame, WorkerPool& workers) const
+{
+    // the latency probe's flip, inverted so it shows whatever the color
+    frame.clear_color = frame.latency.is_lit ? glm::vec3{ 1.0f } - background_color : background_color;
+    frame.projection  = glm::ortho(0.0f, display_size.x, display_size.y, 0.0f);
+
+    if (tiles.enabled)
+    {
+        frame.tilemap.texture   = tiles.texture;
+        frame.tilemap.tile_size = tiles.map.TileSize();
+        frame.tilemap.view      = glm::translate(glm::scale(glm::mat4{ 1.0f }, glm::vec3{ tiles.zoom, tiles.zoom, 1.0f }), glm::vec3{ -tiles.view_offset, 0.0f });
+        tiles.map.CollectVisible(frame.tile_chunks);
+        if (!frame.tile_chunks.empty())
+            frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::Tilemap, 0, tiles.texture, 0), 0, static_cast<std::uint32_t>(frame.tile_chunks.size()) });
+    }
+
+    if (scenery.streamed)
+    {
+        // the same ducks packed and uploaded all over again, as any sprite is
+        for (const StaticSprites::Handle handle : scenery.handles)
+        {
+            const auto index = static_cast<std::uint32_t>(frame.sprites.size());
+            frame.sprites.push_back(SpriteDraw{ scenery.texture, false, scenery.sprites.Get(handle) });
+            frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::Sprites, 0, scenery.texture, 0), index, 1 });
+        }
+    }
+    else if (!scenery.handles.empty())
+    {
+        const auto first = static_cast<std::uint32_t>(frame.static_sprites.size());
+        scenery.sprites.CollectRuns(frame.static_sprites);
+        frame.static_sprite_rects = scenery.sprites.RectTexture();
+        for (auto i = first; i < frame.static_sprites.size(); ++i)
+            frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::StaticSprites, 0, frame.static_sprites[i].texture, i), i, 1 });
+    }
+
+    if (virtual_image.enabled && virtual_image.texture.IsOpen())
+    {
+        // the tiles come in image texels; the view places them, and they all share the one cache texture
+        const GLuint cache = virtual_image.texture.CacheTexture();
+        for (SpriteInstance sprite : virtual_image.texture.Sprites())
+        {
+            sprite.position  = (sprite.position - virtual_image.view_offset) * virtual_image.zoom;
+            sprite.size      = sprite.size * virtual_image.zoom;
+            const auto index = static_cast<std::uint32_t>(frame.sprites.size());
+            frame.sprites.push_back(SpriteDraw{ cache, false, sprite });
+            frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::Sprites, 0, cache, 0), index, 1 });
+        }
+    }
+
+    if (video.enabled && video.on_sprite && video.player != nullptr && video.player->Texture() != 0)
+    {
+        // centred, at its own size or the window's, whichever is smaller
+        const glm::vec2 size    = video.player->Size();
+        const GLuint    texture = video.player->Texture();
+        SpriteInstance  sprite;
+        sprite.size      = size * std::min(1.0f, std::min(display_size.x / size.x, display_size.y / size.y));
+        sprite.position  = display_size * 0.5f;
+        const auto index = static_cast<std::uint32_t>(frame.sprites.size());
+        frame.sprites.push_back(SpriteDraw{ texture, false, sprite });
+        frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::Sprites, 0, texture, 0), index, 1 });
+    }
+
+    if (animated.sprites != nullptr && !animated.sprites->empty() && atlas_duck->IsResident())
+    {
+        AnimatedSpriteDraw& draw = frame.animated_sprites;
+        draw.sprites             = animated.sprites;
+        draw.texture             = atlas_duck->texture.handle;
+        draw.uv_rect             = atlas_duck->texture.uv_rect;
+        draw.time                = static_cast<float>(animated.time - (1.0 - static_cast<double>(alpha)) * animated.step);
+        frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::AnimatedSprites, 0, draw.texture, 0), 0, 1 });
+    }
+
+    frame.meshes.reserve(markers.instances.size());
+    frame.commands.reserve(markers.instances.size() + 2);
+    for (const MeshInstance& instance : markers.instances)
+    {
+        const auto index = static_cast<std::uint32_t>(frame.meshes.size());
+        frame.meshes.push_back(MeshDraw{ markers.mesh, instance });
+        frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::Meshes, 0, static_cast<std::uint32_t>(markers.mesh), index), index, 1 });
+    }
+
+    if (model.enabled && model.data != nullptr && !model.instances.empty())
+    {
+        // grouped by level, though MeshRenderer would group them anyway
+        frame.model = model.data;
+        frame.models.reserve(model.instances.size());
+        for (std::size_t i = 0; i < model.instances.size(); ++i)
+        {
+            const auto index = static_cast<std::uint32_t>(frame.models.size());
+            frame.models.push_back(ModelDraw{ model.instances[i], model.levels[i] });
+            frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::Models, 0, model.levels[i], index), index, 1 });
+        }
+    }
+
+    // the runs were laid out when the markers changed, and again by the font as their glyphs landed; a frame only scales and places them
+    frame.glyphs.reserve(labels.glyph_count);
+    const float label_scale = labels.size / SdfFont::BAKE_SIZE;
+    for (std::size_t i = 0; i < labels.runs.size(); ++i)
+    {
+        labels.font->MarkDrawn(labels.runs[i]);
+        const TextRun&   run  = labels.font->Run(labels.runs[i]);
+        const glm::vec4* rows = markers.instances[i].rows;
+        const glm::vec2  top_left{ rows[0].w - run.width * label_scale * 0.5f, rows[1].w - markers.size - labels.size };
+        append_text_run(frame.glyphs, run, top_left, labels.size, 0xFFFFFFFFu);
+    }
+    if (!frame.glyphs.empty())
+        frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::Text, 0, 0, 0), 0, static_cast<std::uint32_t>(frame.glyphs.size()) });
+
+    if (particles.enabled && mipmapped_duck->IsResident())
+    {
+        ParticleDraw& draw = frame.particles;
+        draw.capacity      = particles.capacity;
+        // `alpha` of the way into the latest step, like the ducks
+        draw.time          = particles.time - (1.0 - static_cast<double>(alpha)) * particles.step;
+        draw.gravity       = glm::vec2{ 0.0f, display_size.y * 0.5f };
+        draw.texture       = mipmapped_duck->texture.handle;
+        draw.uv_rect       = mipmapped_duck->texture.uv_rect;
+        draw.emitter_count = particles.fountains;
+        for (int i = 0; i < particles.fountains; ++i)
+        {
+            const float      across  = (static_cast<float>(i) + 0.5f) / static_cast<float>(particles.fountains);
+            ParticleEmitter& emitter = draw.emitters[i];
+            emitter.position         = glm::vec2{ display_size.x * across, display_size.y * 0.95f };
+            if (hierarchy.carousel)
+                emitter.position = transforms.WorldPosition(hierarchy.arms[static_cast<std::size_t>(i)]);
+            emitter.velocity         = glm::vec2{ 0.0f, -display_size.y * 0.9f };
+            emitter.spread           = 0.3f;
+            emitter.speed_variation  = 0.3f;
+            emitter.rate             = particles.rate;
+            emitter.min_life         = 1.5f;
+            emitter.max_life         = 2.5f;
+            emitter.start_size       = 12.0f;
+            emitter.end_size         = 4.0f;
+            emitter.spin             = 4.0f;
+            emitter.start_color      = glm::vec4{ 1.0f, 0.6f + 0.4f * across, 1.0f - 0.8f * across, 1.0f };
+            emitter.end_color        = glm::vec4{ glm::vec3{ emitter.start_color }, 0.0f };
+        }
+        frame.commands.push_back(RenderCommand{ render_key::Make(RenderLayer::Particles, 0, draw.texture, 0), 0, 1 });
+    }
+
+    if (hierarchy.show_tree)
+    {
+        // 1 + 4 + 16 + 64 + 256 nodes, past which the lines are a blur
+        const std::size_t shown = std::min<std::size_t>(hierarchy.tree.size(), 341);
+        for (std::size_t i = 1; i < shown; ++i)
+            debug_draw::Line(transforms.WorldPosition(hierarchy.tree[(i - 1) / 4]), transforms.WorldPosition(hierarchy.tree[i]), 0xFF40FFFFu);
+        for (int i = 0; hierarchy.carousel && i < hierarchy.arm_count; ++i)
+            debug_draw::Line(transforms.WorldPosition(hierarchy.wheel), transforms.WorldPosition(hierarchy.arms[static_cast<std::size_t>(i)]), 0xFFFFFF40u);
+    }
+
+    if (night.enabled)
+    {
+        // the lights only live this frame, in its arena; binned here so the render side has nothing to sort
+        PROFILE_ZONE("Bin Lights");
+        std::pmr::vector<PointLight> lights{ frame.commands.get_allocator() };
+        lights.reserve(night.fireflies.size());
+        const double time = night.time - (1.0 - static_cast<double>(alpha)) * night.step;
+        for (const Firefly& firefly : night.fireflies)
+        {
+            const double    angle = static_cast<double>(firefly.phase) + static_cast<double>(firefly.speed) * time;
+            const glm::vec2 around{ static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)) };
+            lights.push_back(PointLight{ firefly.center * display_size + around * firefly.orbit, night.radius * firefly.size, 1.0f, firefly.color });
+        }
+        // moonlight, a little blue
+        frame.lighting.ambient = glm::vec3{ 0.6f, 0.7f, 1.0f } * night.ambient;
+        bin_lights(lights, frame.projection, frame.scene_size, frame.lighting);
+    }
+
+    if (sprite_stress.ducks.IsEmpty())
+        return;
+    // the ducks take their textures by turns, skipping any that haven't loaded
+    const TextureHandle* candidates[4]   = {};
+    std::size_t          candidate_count = 0;
+    switch (sprite_stress.source)
+    {
+        case DuckSource::Atlas: candidates[candidate_count++] = &atlas_duck; break;
+        case DuckSource::Mipmapped: candidates[candidate_count++] = &mipmapped_duck; break;
+        case DuckSource::Array: candidates[candidate_count++] = &array_duck; break;
+        case DuckSource::Mixed:
+            for (const TextureHandle* duck : { &atlas_duck, &mipmapped_duck, &example_image, &array_duck })
+                candidates[candidate_count++] = duck;
+            break;
+    }
+    SpriteDraw  draws[4];
+    std::size_t draw_count = 0;
+    for (std::size_t i = 0; i < candidate_count; ++i)
+    {
+        if (!(*candidates[i])->IsResident())
+            continue;
+        const Texture& texture = (*candidates[i])->texture;
+        SpriteDraw&    draw    = draws[draw_count++];
+        draw.texture           = texture.handle;
+        draw.is_array          = texture.layer >= 0;
+        draw.sprite.size       = glm::vec2{ static_cast<float>(texture.width), static_cast<float>(texture.height) } * sprite_stress.scale * sprite_stress.zoom;
+        draw.sprite.uv_rect    = texture.uv_rect;
+        draw.sprite.layer      = static_cast<std::uint32_t>(std::max(texture.layer, 0));
+    }
+    if (draw_count == 0)
+        return;
+
+    frame.bindless_sprites  = sprite_stress.bindless;
+    const std::size_t count = sprite_stress.ducks.Size();
+    const glm::mat3   view  = duckView();
+    sprite_culling          = CullStats{};
+
+    // in index order either way, so overlapping ducks keep their order as they cross cells
+    const std::pmr::polymorphic_allocator<std::byte> arena = frame.sprites.get_allocator();
+    std::pmr::vector<std::uint32_t>                  chosen{ arena };
+    if (sprite_stress.find_overlaps)
+    {
+        // the latest step's positions in the grid's bounds; the pairs last as long as the frame's arena
+        const glm::vec2               half_extent = duckHalfExtent();
+        const auto                    positions   = sprite_stress.ducks.Positions();
+        std::pmr::vector<Aabb2>       boxes(count, arena);
+        std::pmr::vector<OverlapPair> pairs{ arena };
+        for (std::size_t i = 0; i < count; ++i)
+            boxes[i] = Aabb2{ positions[i] - half_extent, positions[i] + half_extent };
+        duck_overlaps.Update(boxes, pairs);
+        if (sprite_stress.show_bounds)
+        {
+            // a line across each of the first few thousand pairs; past that they would only fill the screen
+            const std::size_t shown = std::min<std::size_t>(pairs.size(), 4096);
+            for (std::size_t i = 0; i < shown; ++i)
+            {
+                const glm::vec2 from{ view * glm::vec3{ positions[pairs[i].first], 1.0f } };
+                const glm::vec2 to{ view * glm::vec3{ positions[pairs[i].second], 1.0f } };
+                debug_draw::Line(from, to, pack_rgba8(1.0f, 0.3f, 0.2f, 0.8f));
+            }
+        }
+    }
+    if (sprite_stress.cull)
+    {
+        // the window's corners, and the scene views' around it, back through the view give the world they show
+        const glm::vec2 corners[4] = { cull_bounds.min, glm::vec2{ cull_bounds.max.x, cull_bounds.min.y }, glm::vec2{ cull_bounds.min.x, cull_bounds.max.y }, cull_bounds.max };
+        glm::vec2       world_corners[4];
+        math_kernels::TransformPoints(glm::inverse(view), corners, world_corners, 4);
+        const Aabb2 shown = math_kernels::Bounds(world_corners, 4);
+
+        std::pmr::vector<unsigned char> visible(count, 0, arena);
+        sprite_culling.tested = sprite_stress.grid.Query(shown.min, shown.max,
+                                                         [&visible](std::uint32_t id)
+                                                         {
+                                                             if (id < visible.size())
+                                                                 visible[id] = 1;
+                                                         });
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            if (visible[i] != 0)
+                chosen.push_back(i);
+        }
+    }
+    else
+    {
+        chosen.resize(count);
+        std::iota(chosen.begin(), chosen.end(), 0u);
+    }
+
+    // the arena allocates on the main thread only, so the lists are sized here and the jobs just fill their slice
+    const std::size_t           grain         = workers.GrainFor(chosen.size(), sizeof(SpriteDraw));
+    const std::size_t           jobs          = (chosen.size() + grain - 1) / grain;
+    const std::size_t           base          = frame.sprites.size();
+    std::pmr::vector<glm::vec2> on_screen(chosen.size(), arena);
+    frame.sprites.resize(base + chosen.size());
+    sprite_commands.Begin(jobs);
+
+    // interpolated in the world, then through the view in one batch a job; the depth is the duck's index, so overlaps stay put within a texture
+    const auto previous  = sprite_stress.ducks.PreviousPositions();
+    const auto positions = sprite_stress.ducks.Positions();
+    const auto sprites   = sprite_stress.ducks.Sprites();
+    const auto colors    = sprite_stress.ducks.Colors();
+    workers.ParallelFor("Record Ducks", chosen.size(), grain,
+                        [&](std::size_t begin, std::size_t end)
+                        {
+                            for (std::size_t k = begin; k < end; ++k)
+                                on_screen[k] = glm::mix(previous[chosen[k]], positions[chosen[k]], alpha);
+                            math_kernels::TransformPoints(view, &on_screen[begin], &on_screen[begin], end - begin);
+                            std::vector<RenderCommand>& list = sprite_commands.List(begin / grain);
+                            list.reserve(end - begin);
+                            for (std::size_t k = begin; k < end; ++k)
+                            {
+                                const auto  index    = static_cast<std::uint32_t>(base + k);
+                                SpriteDraw& draw     = frame.sprites[index];
+                                draw                 = draws[sprites[chosen[k]] % draw_count];
+                                draw.sprite.position = on_screen[k];
+                                draw.sprite.color    = colors[chosen[k]];
+                                draw.pick_id         = chosen[k] + 1;
+                                list.push_back(RenderCommand{ sprite_stress.back_to_front ? render_key::MakeBackToFront(RenderLayer::Sprites, render_key::Depth(draw.sprite.position.y), 0, draw.texture)
+                                                                                          : render_key::Make(RenderLayer::Sprites, 0, draw.texture, chosen[k]),
+                                                              index, 1 });
+                                if (sprite_stress.show_bounds)
+                                    debug_draw::Box(draw.sprite.position - draw.sprite.size * 0.5f, draw.sprite.position + draw.sprite.size * 0.5f, pack_rgba8(0.2f, 1.0f, 0.4f, 0.6f));
+                                if (draw.pick_id == picked_duck)
+                                    debug_draw::Box(draw.sprite.position - draw.sprite.size * 0.5f, draw.sprite.position + draw.sprite.size * 0.5f, pack_rgba8(1.0f, 0.9f, 0.1f, 1.0f));
+                            }
+                        });
+    sprite_commands.MergeInto(frame.commands);
+    sprite_culling.visible = static_cast<int>(chosen.size());
+    sprite_culling.culled  = static_cast<int>(count) - sprite_culling.visible;
+}
+
+void Demo::ImGuiDraw(const SpriteBatch::Stats& sprite_stats, const SpriteBatch::Stats& static_sprite_stats, const AnimatedSpriteRenderer::Stats& animated_stats,
+                     const MeshRenderer::Stats& mesh_stats, const ParticleSystem::Stats& particle_stats, const TextRenderer::Stats& text_stats,
+                     const TilemapRenderer::Stats& tilemap_stats, const LightRenderer::Stats& light_stats)
+{
+    ImGui::Begin("OpenGL Texture Test");
+    if (example_image->IsResident())
+    {
+        const Texture& texture = example_image->texture;
+        ImGui::Text("handle = %d", texture.handle);
+        ImGui::Text("size = %d x %d", texture.width, texture.height);
+        ImGui::Text("decode scratch = %.1f KB", static_cast<double>(example_image->scratch_bytes) / 1024.0);
+        ImGui::Text("format = 0x%04X", texture.internal_format);
+        ImGui::Image(imgui_texture_id(texture.handle, texture.uv_rect), ImVec2(static_cast<float>(texture.width), static_cast<float>(texture.height)));
+        if (thumbnail_duck->IsResident())
+        {
+            const Texture& thumbnail = thumbnail_duck->texture;
+            ImGui::Text("thumbnail = %d x %d, %.1f KB", thumbnail.width, thumbnail.height, static_cast<double>(thumbnail.vram_bytes) / 1024.0);
+            ImGui::Image(imgui_texture_id(thumbnail.handle, thumbnail.uv_rect), ImVec2(static_cast<float>(thumbnail.width), static_cast<float>(thumbnail.height)));
+        }
+    }
+    else if (example_image->HasFailed())
+    {
+        ImGui::Text("%s", "Failed to load texture image...");
+    }
+    else
+    {
+        ImGui::Text("%s", "Loading texture image...");
+    }
+    ImGui::End();
+
+    ImGui::Begin("Audio Test");
+    if (audio->HasFailed())
+    {
+        ImGui::Text("%s", "No audio device");
+    }
+    else
+    {
+        // before the audio is up a press only queues, and the press itself is what starts it in lazy mode
+        const bool quack_pending = quack == nullptr || !quack->IsReady();
+        ImGui::BeginDisabled(has_audio && quack_pending);
+        if (ImGui::Button("Play Mono SFX"))
+        {
+            pending_play = PendingPlay::Mono;
+            // a press that has to open the device first would measure the startup, not the mix
+            latency.clicked = has_audio ? SDL_GetPerformanceCounter() : 0;
+        }
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        if (ImGui::Button("Play Stereo SFX"))
+        {
+            pending_play = PendingPlay::Stereo;
+        }
+        ImGui::BeginDisabled(has_audio && quack_pending);
+        if (ImGui::Button("Play 64 Quiet Quacks"))
+        {
+            pending_play = PendingPlay::QuietQuacks;
+        }
+        ImGui::EndDisabled();
+        if (effects.ZoneCount() > 0 && ImGui::BeginCombo("reverb zone", reverb_zone < 0 ? "dry" : effects.ZoneName(reverb_zone).c_str()))
+        {
+            if (ImGui::Selectable("dry", reverb_zone < 0))
+                reverb_zone = -1;
+            for (int zone = 0; zone < effects.ZoneCount(); ++zone)
+            {
+                if (ImGui::Selectable(effects.ZoneName(zone).c_str(), zone == reverb_zone))
+                    reverb_zone = zone;
+            }
+            ImGui::EndCombo();
+        }
+        playPending();
+        if (quack != nullptr && quack->HasFailed())
+        {
+            ImGui::SameLine();
+            ImGui::Text("%s", "Failed to load WAV file...");
+        }
+        if (!has_audio)
+            ImGui::Text("%s", audio->IsRequested() ? "opening the audio device..." : "audio starts on first use");
+        if (has_audio)
+            audio_stats.DrawImGui();
+        if (const AudioThread::Stats thread_stats = audio_thread.GetStats(); effects.IsAvailable())
+        {
+            const AudioEffects::Stats& reverb = thread_stats.effects;
+            ImGui::Text("reverb slots = %d / %d bound, %d sends, %llu rebinds, %llu dry fallbacks", reverb.bound_slots, reverb.slots, thread_stats.active_sends,
+                        static_cast<unsigned long long>(reverb.rebinds), static_cast<unsigned long long>(reverb.dry_fallbacks));
+        }
+        else if (has_audio)
+        {
+            ImGui::Text("%s", "reverb: no EFX, everything plays dry");
+        }
+        if (has_audio)
+        {
+            ImGui::SliderInt("grains per second", &grains.per_second, 0, 20000, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+            if (grains.mixer != nullptr)
+            {
+                const SoftwareMixer::Stats mixer_stats = grains.mixer->GetStats();
+                ImGui::Text("software mixer (%s): %d / %d voices, %d steals/s, %.2f ms to mix %.2f ms, %llu late, %llu dropped", audio_kernels::LevelName(audio_kernels::ActiveLevel()),
+                            mixer_stats.voices_in_use, mixer_stats.voice_capacity, mixer_stats.steals_per_second, mixer_stats.render_ms, mixer_stats.period_ms,
+                            static_cast<unsigned long long>(mixer_stats.late), static_cast<unsigned long long>(mixer_stats.dropped));
+                // decaying stereo noise, the shape of a measured hall's response without shipping one
+                const auto hall = [this]
+                {
+                    constexpr int FREQUENCY = SoftwareMixer::DEFAULT_FREQUENCY;
+                    const int     frames    = static_cast<int>(grains.reverb_rt60 * FREQUENCY);
+                    DecodedSound  response;
+                    response.type      = SampleType::Float32;
+                    response.channels  = 2;
+                    response.frequency = FREQUENCY;
+                    response.samples.resize(static_cast<std::size_t>(frames) * 2 * sizeof(float));
+                    std::minstd_rand                      random{ 7 };
+                    std::uniform_real_distribution<float> noise{ -1.0f, 1.0f };
+                    const float                           decay = std::log(1000.0f) / (grains.reverb_rt60 * FREQUENCY);
+                    for (int i = 0; i < frames * 2; ++i)
+                    {
+                        const float value = 0.1f * noise(random) * std::exp(-decay * static_cast<float>(i / 2));
+                        std::memcpy(response.samples.data() + static_cast<std::size_t>(i) * sizeof(float), &value, sizeof(value));
+                    }
+                    return response;
+                };
+                if (ImGui::Checkbox("convolution reverb", &grains.reverb))
+                {
+                    if (grains.reverb)
+                        grains.reverb = grains.mixer->SetImpulseResponse(hall());
+                    else
+                        grains.mixer->ClearImpulseResponse();
+                }
+                if (grains.reverb)
+                {
+                    if (ImGui::SliderFloat("reverb wet", &grains.reverb_wet, 0.0f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp))
+                        grains.mixer->SetReverbWet(grains.reverb_wet);
+                    ImGui::SliderFloat("reverb RT60", &grains.reverb_rt60, 0.1f, 6.0f, "%.1f s", ImGuiSliderFlags_AlwaysClamp);
+                    if (ImGui::IsItemDeactivatedAfterEdit())
+                        grains.mixer->SetImpulseResponse(hall());
+                    ImGui::Text("reverb: %d partitions of %d frames, %.2f ms of the %.2f ms period (%.0f%% of a core), %d frames latency", mixer_stats.reverb_partitions,
+                                Convolver::BLOCK_FRAMES, mixer_stats.reverb_ms, mixer_stats.period_ms, mixer_stats.period_ms > 0.0 ? 100.0 * mixer_stats.reverb_ms / mixer_stats.period_ms : 0.0,
+                                Convolver::BLOCK_FRAMES);
+                }
+            }
+            else
+            {
+                const AudioThread::Stats thread_stats = audio_thread.GetStats();
+                ImGui::Text("OpenAL: %d / %d voices, %d steals/s, %.2f ms per command drain", thread_stats.voices_in_use, thread_stats.voice_capacity, thread_stats.steals_per_second,
+                            thread_stats.drain_ms);
+            }
+            if (ImGui::Button(music.IsPlaying() ? "Next Track" : "Play Music"))
+            {
+                if (music.IsPlaying())
+                    music.Next();
+                else
+                    music.Play();
+            }
+            ImGui::SameLine();
+            ImGui::BeginDisabled(!music.IsPlaying());
+            if (ImGui::Button("Stop Music"))
+                music.Stop();
+            ImGui::EndDisabled();
+            if (ImGui::SliderFloat("crossfade seconds", &music_crossfade, 0.0f, 10.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp))
+                music.SetCrossfade(music_crossfade);
+            if (const MusicPlayer::Stats music_stats = music.GetStats(); music_stats.track >= 0)
+            {
+                ImGui::Text("music: track %d at %.1f / %.1f s, next %d (primed in %.1f ms), fade %.0f%%, %d streams holding %zu KB, %d crossfades", music_stats.track,
+                            music_stats.position, music_stats.length, music_stats.next_track, music_stats.last_preload_ms, music_stats.fade * 100.0, music_stats.open_streams,
+                            music_stats.ring_bytes / 1024, music_stats.crossfades);
+            }
+        }
+        if (latency.samples > 0)
+        {
+            ImGui::Text("click to sound = %.1f ms (mixer %.1f + output %.1f), mean %.1f ms over %d", latency.last_ms, latency.mixer_ms, latency.output_ms,
+                        latency.total_ms / latency.samples, latency.samples);
+        }
+        if (sounds != nullptr)
+        {
+            const SoundCache::Stats& cache = sounds->GetStats();
+            ImGui::Text("sound cache: %zu buffer(s), %.1f KB resident, %.0f%% hits, %zu decoding", cache.entries, static_cast<double>(cache.resident_bytes) / 1024.0,
+                        cache.HitRate() * 100.0, sounds->PendingCount());
+            if (sounds->Storage() == SoundStorage::Vorbis)
+            {
+                ImGui::Text("vorbis pool: %.1f KB, %llu decodes on play, %llu dropped", static_cast<double>(cache.pool_bytes) / 1024.0,
+                            static_cast<unsigned long long>(cache.decodes_on_play), static_cast<unsigned long long>(cache.pool_exhausted));
+            }
+            if (quack != nullptr && quack->IsReady())
+                ImGui::Text("quack: %.1f KB as %s, %.1f KB at 1/%d rate for distant loops", static_cast<double>(quack->bytes) / 1024.0,
+                            quack->storage == SoundStorage::Pcm ? "PCM" : quack->storage == SoundStorage::Adpcm ? "IMA ADPCM" : "Vorbis", static_cast<double>(quack->distant_bytes) / 1024.0,
+                            SoundCache::DISTANT_RATE_DIVISOR);
+            if (quack != nullptr && quack->IsReady() && !quack->peaks.IsEmpty())
+            {
+                ImGui::SliderFloat("waveform zoom", &waveform.zoom, 1.0f, 256.0f, "%.0fx", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+                ImGui::BeginDisabled(waveform.zoom <= 1.0f);
+                ImGui::SliderFloat("waveform scroll", &waveform.scroll, 0.0f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+                ImGui::EndDisabled();
+                quack->peaks.DrawImGui(64.0f, waveform.zoom, waveform.scroll);
+                ImGui::Text("peaks: %d levels for %zu frames, %.1f KB across the cache", quack->peaks.LevelCount(), quack->peaks.Frames(),
+                            static_cast<double>(cache.peak_bytes) / 1024.0);
+            }
+        }
+    }
+    ImGui::End();
+
+    ImGui::Begin("Sprite Stress");
+    {
+        if (ImGui::SliderInt("ducks", &sprite_stress.requested_count, 0, 100'000, "%d", ImGuiSliderFlags_Logarithmic))
+        {
+            resizeSpriteStress(sprite_stress.requested_count);
+        }
+        ImGui::SliderFloat("scale", &sprite_stress.scale, 0.01f, 1.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+        if (const float old_scale = sprite_stress.world_scale; ImGui::SliderFloat("world", &sprite_stress.world_scale, 1.0f, 16.0f, "%.1f screens", ImGuiSliderFlags_AlwaysClamp))
+        {
+            // stretched with the world, so nobody ends up outside it
+            const auto positions = sprite_stress.ducks.Positions();
+            const auto previous  = sprite_stress.ducks.PreviousPositions();
+            for (std::size_t i = 0; i < positions.size(); ++i)
+                previous[i] = positions[i] *= sprite_stress.world_scale / old_scale;
+            resetSpriteGrid();
+        }
+        ImGui::SliderFloat2("view", &sprite_stress.view_offset.x, 0.0f, std::max(display_size.x, display_size.y) * sprite_stress.world_scale, "%.0f");
+        ImGui::SliderFloat("zoom", &sprite_stress.zoom, 1.0f / 16.0f, 4.0f, "%.3fx", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp);
+        ImGui::Checkbox("cull with grid", &sprite_stress.cull);
+#if DEBUG_DRAW_ENABLED
+        ImGui::SameLine();
+        ImGui::Checkbox("show bounds", &sprite_stress.show_bounds);
+#endif
+        ImGui::SameLine();
+        ImGui::Checkbox("find overlaps", &sprite_stress.find_overlaps);
+        ImGui::SameLine();
+        ImGui::Checkbox("back to front", &sprite_stress.back_to_front);
+        ImGui::SetItemTooltip("sorted by y for the overlaps to blend right; the other ducks' draws then split wherever their texture changes");
+        static constexpr const char* SOURCES[] = { "atlas", "mipmapped", "texture array", "mixed" };
+        int                          source    = static_cast<int>(sprite_stress.source);
+        if (ImGui::Combo("texture", &source, SOURCES, IM_ARRAYSIZE(SOURCES)))
+            sprite_stress.source = static_cast<DuckSource>(source);
+        ImGui::BeginDisabled(!sprite_stress.bindless_available);
+        ImGui::Checkbox("bindless", &sprite_stress.bindless);
+        ImGui::SetItemTooltip("%s", sprite_stress.bindless_available ? "every 2D texture in one draw, through resident handles" : "needs GL_ARB_bindless_texture and storage buffers");
+        ImGui::EndDisabled();
+        // a Vorbis bank has no buffer to loop for long
+        ImGui::BeginDisabled(!has_audio || quack == nullptr || !quack->IsReady() || quack->storage == SoundStorage::Vorbis);
+        ImGui::SliderInt("quacking ducks", &quacking_requested, 0, 2048, "%d", ImGuiSliderFlags_AlwaysClamp);
+        ImGui::EndDisabled();
+        if (const SpatialAudio::Stats spatial_stats = audio_thread.GetStats().spatial; spatial_stats.emitters > 0)
+        {
+            ImGui::Text("emitters = %d, audible = %d, voiced = %d (+%d -%d), %d moves batched with %s", spatial_stats.emitters, spatial_stats.audible, spatial_stats.voiced,
+                        spatial_stats.started, spatial_stats.stopped, spatial_stats.source_updates, spatial_stats.deferred ? "AL_SOFT_deferred_updates" : "alcSuspendContext");
+            ImGui::Text("virtual = %d, resumed part way = %d, one-shots finished = %d", spatial_stats.virtualized, spatial_stats.resumed, spatial_stats.finished);
+            ImGui::Text("lod: near = %d, far = %d, distant = %d (%d on low rate buffers), %d moves held back, %d swaps", spatial_stats.lod_near, spatial_stats.lod_far,
+                        spatial_stats.lod_distant, spatial_stats.low_rate, spatial_stats.held_back, spatial_stats.lod_swaps);
+            const AudioOcclusion::Stats& rays = occlusion.GetStats();
+            ImGui::Text("occlusion: %d rays (1/%d of the emitters a frame), %d ducks tested, %d blocked, %.3f ms; %d voices muffled, %d filter changes", rays.rays,
+                        AudioOcclusion::SPREAD_FRAMES, rays.tested, rays.occluded, rays.trace_ms, spatial_stats.occluded, spatial_stats.filter_updates);
+        }
+        ImGui::Text("visible = %d, culled = %d, tested = %d in %d cells, %d changed cell", sprite_culling.visible, sprite_culling.culled, sprite_culling.tested,
+                    sprite_stress.grid.CellCount(), sprite_stress.regridded);
+        if (picked_duck != 0)
+            ImGui::Text("picked duck #%u", picked_duck - 1);
+        else
+            ImGui::TextUnformatted("left click a duck to pick it");
+        if (const SweepAndPrune::Stats overlap_stats = duck_overlaps.GetStats(); sprite_stress.find_overlaps && overlap_stats.boxes > 0)
+        {
+            ImGui::Text("overlapping pairs = %d, %lld tested, %d shifts%s, sort %.2f ms, sweep %.2f ms", overlap_stats.pairs, static_cast<long long>(overlap_stats.swept),
+                        overlap_stats.shifts, overlap_stats.resorted ? " (sorted again)" : "", overlap_stats.sort_ms, overlap_stats.sweep_ms);
+        }
+        if (const TaskGraph::Stats graph_stats = fixed_update.GetStats(); graph_stats.tasks > 0)
+        {
+            ImGui::Text("fixed step graph: %d tasks, %d at once at first, %d in a chain, %.2f ms", graph_stats.tasks, graph_stats.roots, graph_stats.longest_chain,
+                        graph_stats.run_ms);
+        }
+        // the ring only takes memory while it records
+        if (ImGui::Checkbox("record steps", &step_history.record))
+            step_history.ring.SetCapacity(step_history.record ? static_cast<std::size_t>(step_history.capacity) : 0);
+        ImGui::SetItemTooltip("saves the world after every fixed step, copying only the duck columns that step changed");
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8.0f);
+        if (ImGui::SliderInt("kept", &step_history.capacity, 10, 600, "%d steps", ImGuiSliderFlags_AlwaysClamp) && step_history.record)
+            step_history.ring.SetCapacity(static_cast<std::size_t>(step_history.capacity));
+        if (step_history.record)
+        {
+            const int kept = static_cast<int>(step_history.ring.Count());
+            ImGui::BeginDisabled(kept < 2);
+            ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8.0f);
+            ImGui::SliderInt("steps back", &step_history.back, 1, std::max(kept - 1, 1), "%d", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::SameLine();
+            if (ImGui::Button("rewind"))
+                rewind(static_cast<std::size_t>(step_history.back));
+            ImGui::EndDisabled();
+            ImGui::Text("%d steps kept in %.1f MB; save %.1f KB in %.1f us, restore %.1f KB in %.1f us", kept, static_cast<double>(step_history.ring.Bytes()) / (1024.0 * 1024.0),
+                        static_cast<double>(step_history.saved_bytes) / 1024.0, step_history.save_us, static_cast<double>(step_history.restored_bytes) / 1024.0,
+                        step_history.restore_us);
+        }
+        ImGui::Text("sprites = %d, textures = %d, draw calls = %d%s", sprite_stats.sprites, sprite_stats.textures, sprite_stats.draw_calls, sprite_stats.bindless ? " (bindless)" : "");
+        ImGui::Text("instance buffer = %.1f KB", static_cast<double>(sprite_stats.buffer_size) / 1024.0);
+        ImGui::Text("uv rects = %d%s", sprite_stats.rects, sprite_stats.rects_over > 0 ? " (table full)" : "");
+    }
+    ImGui::End();
+
+    ImGui::Begin("Static Sprites");
+    {
+        ImGui::SliderInt("ducks", &scenery.requested_count, 0, 200'000, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderInt("edits per frame", &scenery.edits, 0, 10'000, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::Checkbox("stream them instead", &scenery.streamed);
+        const StaticSprites::Stats& stats = scenery.sprites.GetStats();
+        ImGui::Text("%d sprites in %d batches, %d uv rects", stats.sprites, stats.batches, stats.rects);
+        ImGui::Text("this frame: %d uploads, %.1f KB, %d regrown", stats.uploads, static_cast<double>(stats.uploaded_bytes) / 1024.0, stats.regrown);
+        ImGui::Text("buffers = %.1f KB", static_cast<double>(stats.buffer_bytes) / 1024.0);
+        ImGui::Text("drawn retained: %d sprites, %d draw calls%s", static_sprite_stats.sprites, static_sprite_stats.draw_calls, static_sprite_stats.pending ? " (compiling)" : "");
+    }
+    ImGui::End();
+
+    ImGui::Begin("Instanced Markers");
+    {
+        bool changed = ImGui::SliderInt("markers", &markers.requested_count, 0, 100'000, "%d", ImGuiSliderFlags_Logarithmic);
+        changed |= ImGui::SliderFloat("size", &markers.size, 1.0f, 32.0f, "%.1f");
+        if (changed)
+        {
+            resizeMarkers(markers.requested_count);
+        }
+        ImGui::Text("instances = %d, draw calls = %d", mesh_stats.instances, mesh_stats.draw_calls);
+        if (mesh_stats.gpu_driven)
+            ImGui::TextUnformatted("culled on the GPU into one indirect multi-draw");
+        else
+            ImGui::Text("culled = %d", mesh_stats.culled);
+        ImGui::Text("instance buffer = %.1f KB", static_cast<double>(mesh_stats.buffer_size) / 1024.0);
+
+        // only the count lays anything out; the size just scales the same runs
+        ImGui::BeginDisabled(!labels.font->IsLoaded());
+        if (ImGui::SliderInt("labels", &labels.requested_count, 0, 10'000, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic))
+        {
+            resizeLabels();
+        }
+        ImGui::SetItemTooltip("%s", labels.font->IsLoaded() ? "signed distance field text, one draw for all of it" : "no font: add assets/fonts/label.ttf");
+        static constexpr const char* SCRIPTS[] = { "Latin", "Greek", "Cyrillic", "Chinese", "an ideograph each" };
+        int                          script    = static_cast<int>(labels.script);
+        if (ImGui::Combo("label script", &script, SCRIPTS, IM_ARRAYSIZE(SCRIPTS)))
+        {
+            labels.script = static_cast<LabelScript>(script);
+            resizeLabels();
+        }
+        ImGui::SetItemTooltip("past ASCII, glyphs are rasterized on the workers as the labels first use them; characters the font lacks show as '?'");
+        ImGui::SliderFloat("label size", &labels.size, 4.0f, 96.0f, "%.1f", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::EndDisabled();
+        ImGui::Text("glyphs = %d, draw calls = %d, runs laid out = %d%s", text_stats.glyphs, text_stats.draw_calls, labels.font->RunCount(), text_stats.pending ? " (compiling)" : "");
+        const SdfFont::Stats& glyph_cache = labels.font->GetStats();
+        ImGui::Text("glyph cache: %d glyphs on %d of %d pages (%d pinned), %d rasterizing, %d waiting for room", glyph_cache.glyphs, glyph_cache.used_pages,
+                    (SdfFont::ATLAS_SIZE / SdfFont::PAGE_SIZE) * (SdfFont::ATLAS_SIZE / SdfFont::PAGE_SIZE), glyph_cache.pinned_pages, glyph_cache.rasterizing + glyph_cache.wanted, glyph_cache.waiting);
+        ImGui::Text("rasterized = %llu, pages evicted = %llu (%llu glyphs), uploaded = %.1f KB", static_cast<unsigned long long>(glyph_cache.rasterized),
+                    static_cast<unsigned long long>(glyph_cache.evicted_pages), static_cast<unsigned long long>(glyph_cache.evicted_glyphs), static_cast<double>(glyph_cache.uploaded_bytes) / 1024.0);
+    }
+    ImGui::End();
+
+    ImGui::Begin("Tilemap");
+    {
+        ImGui::BeginDisabled(tiles.texture == 0);
+        ImGui::Checkbox("enabled", &tiles.enabled);
+        ImGui::EndDisabled();
+        static constexpr int         SIZES[]      = { 256, 1024, 4096 };
+        static constexpr const char* SIZE_NAMES[] = { "256 x 256", "1024 x 1024", "4096 x 4096" };
+        int                          size_choice  = static_cast<int>(std::find(std::begin(SIZES), std::end(SIZES), tiles.size) - std::begin(SIZES));
+        if (ImGui::Combo("tiles", &size_choice, SIZE_NAMES, IM_ARRAYSIZE(SIZE_NAMES)))
+            tiles.size = SIZES[size_choice];
+        const glm::vec2 world = glm::vec2{ static_cast<float>(tiles.size) } * TILE_SIZE;
+        ImGui::SliderFloat2("view", &tiles.view_offset.x, 0.0f, std::max(world.x, world.y), "%.0f");
+        ImGui::SliderFloat("zoom", &tiles.zoom, 0.05f, 4.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::Checkbox("pan", &tiles.pan);
+        ImGui::SliderInt("edits per frame", &tiles.edits, 0, 1000, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        const Tilemap::Stats& map_stats = tiles.map.GetStats();
+        ImGui::Text("chunks: %d in view, %d resident of %d, %d building", map_stats.visible, map_stats.resident, map_stats.chunks, map_stats.building);
+        ImGui::Text("this frame: %d built, %d prefetched, %d evicted", map_stats.built, map_stats.prefetched, map_stats.evicted);
+        ImGui::Text("vertex buffers = %.1f MB", static_cast<double>(map_stats.buffer_bytes) / (1024.0 * 1024.0));
+        ImGui::Text("drawn: %d chunks, %d tiles, %d draw calls%s", tilemap_stats.chunks, tilemap_stats.tiles, tilemap_stats.draw_calls, tilemap_stats.pending ? " (compiling)" : "");
+    }
+    ImGui::End();
+
+    ImGui::Begin("Virtual Texture");
+    {
+        ImGui::Checkbox("enabled", &virtual_image.enabled);
+        if (ImGui::InputText("file", virtual_image.path, sizeof(virtual_image.path)))
+            virtual_image.is_missing = false;
+        ImGui::SameLine();
+        if (ImGui::Button("reopen"))
+        {
+            virtual_image.texture.Close();
+            virtual_image.is_missing = false;
+        }
+        // the cache is made at open, so switching reopens
+        if (ImGui::Checkbox("sparse texture", &virtual_image.sparse))
+        {
+            virtual_image.texture.Close();
+            virtual_image.is_missing = false;
+        }
+        const glm::ivec2 size = virtual_image.texture.Size();
+        ImGui::SliderFloat2("view", &virtual_image.view_offset.x, 0.0f, static_cast<float>(std::max(std::max(size.x, size.y), 1)), "%.0f");
+        ImGui::SliderFloat("zoom", &virtual_image.zoom, 1.0f / 64.0f, 4.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        if (virtual_image.is_missing)
+            ImGui::TextWrapped("no tiled image there: make one with texture-converter --tiles");
+        else if (virtual_image.texture.IsOpen())
+        {
+            const VirtualTexture::Stats& stats = virtual_image.texture.GetStats();
+            ImGui::Text("%d x %d, %d levels, drawing level %d", size.x, size.y, virtual_image.texture.LevelCount(), stats.level);
+            ImGui::Text("tiles: %d in view, %d from a coarser level", stats.wanted, stats.fallbacks);
+            ImGui::Text("cache: %d pages resident, %d loading, %d uploaded this frame", stats.resident, stats.loading, stats.uploaded);
+            ImGui::Text("%llu evicted, %llu cancelled, %llu failed", static_cast<unsigned long long>(stats.evicted), static_cast<unsigned long long>(stats.cancelled),
+                        static_cast<unsigned long long>(stats.failed));
+            if (stats.sparse)
+                ImGui::Text("sparse texture = %.1f MB committed, %d commitment calls this frame", static_cast<double>(stats.cache_bytes) / (1024.0 * 1024.0), stats.commits);
+            else
+                ImGui::Text("cache texture = %.1f MB", static_cast<double>(stats.cache_bytes) / (1024.0 * 1024.0));
+        }
+    }
+    ImGui::End();
+
+    ImGui::Begin("glTF Model");
+    {
+        ImGui::Checkbox("enabled", &model.enabled);
+        if (ImGui::InputText("file", model.path, sizeof(model.path)))
+            model.is_missing = false;
+        ImGui::SameLine();
+        if (ImGui::Button("reload") && model.loading == nullptr)
+        {
+            model.data.reset();
+            model.is_missing = false;
+        }
+        ImGui::Checkbox("spin", &model.spin);
+        ImGui::SameLine();
+        ImGui::SliderAngle("angle", &model.angle, 0.0f, 360.0f);
+        ImGui::SliderInt("copies", &model.copies, 1, 1024, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("zoom", &model.zoom, 0.05f, 2.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        LodSelector::Settings& lod_settings = model.lods.GetSettings();
+        ImGui::SliderFloat("LOD threshold", &lod_settings.threshold, 0.25f, 16.0f, "%.2f px", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("hysteresis", &lod_settings.hysteresis, 0.0f, 0.9f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        ImGui::SliderInt("force LOD", &lod_settings.forced, -1, MODEL_LOD_COUNT - 1, lod_settings.forced < 0 ? "off" : "%d", ImGuiSliderFlags_AlwaysClamp);
+        if (model.is_missing)
+            ImGui::TextWrapped("no glTF 2.0 model there, or nothing in it to draw: the log says which");
+        else if (model.loading != nullptr)
+            ImGui::Text("loading...");
+        else if (model.data != nullptr)
+        {
+            const ModelStats& stats = model.data->stats;
+            ImGui::Text("%d triangles, %d vertices in %d parts", stats.triangles, stats.vertices, static_cast<int>(model.data->parts.size()));
+            if (stats.skipped > 0)
+                ImGui::Text("%d primitives skipped, not triangle lists", stats.skipped);
+            ImGui::Text("ACMR %.3f -> %.3f (%u entry FIFO)", static_cast<double>(stats.acmr_before), static_cast<double>(stats.acmr_after), mesh_optimizer::CACHE_SIZE);
+            ImGui::Text("overfetch %.2f -> %.2f", static_cast<double>(stats.overfetch_before), static_cast<double>(stats.overfetch_after));
+            ImGui::Text("vertex = %d bytes, %d before packing", static_cast<int>(sizeof(PackedMeshVertex)), static_cast<int>(sizeof(MeshVertex)));
+            if (stats.from_cache)
+                ImGui::Text("from the decoded cache in %.1f ms, imported in %.1f ms", stats.load_ms, stats.cold_ms);
+            else
+                ImGui::Text("imported in %.1f ms", stats.load_ms);
+            const LodSelector::Stats& selection = model.lods.GetStats();
+            for (std::size_t l = 0; l < stats.lod_triangles.size(); ++l)
+                ImGui::Text("LOD %d: %7d triangles, error %.4f, %d copies", static_cast<int>(l), stats.lod_triangles[l], static_cast<double>(model.data->lod_errors[l]), selection.instances[l]);
+            ImGui::Text("%d copies changed level this frame", selection.switches);
+        }
+    }
+    ImGui::End();
+
+    ImGui::Begin("Video");
+    {
+        // nothing of the player exists until the video module has loaded
+        VideoPlayer* const player = video.player.get();
+        if (ImGui::Checkbox("enabled", &video.enabled) && !video.enabled && player != nullptr)
+            player->Stop();
+        if (ImGui::InputText("file", video.path, sizeof(video.path)))
+            video.is_missing = false;
+        ImGui::SameLine();
+        if (ImGui::Button("reopen"))
+        {
+            if (player != nullptr)
+                player->Close();
+            video.is_missing = false;
+        }
+        if (player != nullptr && ImGui::Button(player->IsPlaying() ? "stop" : "play"))
+        {
+            if (player->IsPlaying())
+                player->Stop();
+            else
+                player->Play();
+        }
+        ImGui::SameLine();
+        ImGui::Checkbox("loop", &video.loop);
+        ImGui::SameLine();
+        ImGui::Checkbox("on a sprite", &video.on_sprite);
+        if (const ModuleState module = side_modules::GetState(SideModule::Video); module != ModuleState::Ready)
+            ImGui::Text("%s %s", side_modules::FileName(SideModule::Video).data(), module == ModuleState::Failed ? "failed to load" : "loads when enabled");
+        else if (video.is_missing)
+            ImGui::TextWrapped("no clip there: make one with texture-converter --clip");
+        else if (player != nullptr && player->IsOpen())
+        {
+            const VideoPlayer::Stats& stats = player->GetStats();
+            const glm::ivec2          size  = player->Size();
+            ImGui::Text("%d x %d, %.1f s, %s", size.x, size.y, player->DurationSeconds(), player->HasSoundtrack() ? "timed by its soundtrack" : "no soundtrack");
+            ImGui::Text("frame %u, %d decoded ahead, %.2f ms to decode, %.1f ms behind the clock", stats.frame, stats.ready, stats.decode_ms, stats.drift_ms);
+            ImGui::Text("%llu shown, %llu dropped, %llu seeks, %llu failed", static_cast<unsigned long long>(stats.shown), static_cast<unsigned long long>(stats.dropped),
+                        static_cast<unsigned long long>(stats.seeks), static_cast<unsigned long long>(stats.failed));
+            ImGui::Text("%llu staged through the ring, %.1f MB in frames and textures", static_cast<unsigned long long>(stats.staged),
+                        static_cast<double>(stats.memory_bytes) / (1024.0 * 1024.0));
+            if (player->Texture() != 0)
+            {
+                const float width = std::min(512.0f, static_cast<float>(size.x));
+                ImGui::Image(imgui_texture_id(player->Texture()), ImVec2(width, width * static_cast<float>(size.y) / static_cast<float>(size.x)));
+            }
+        }
+    }
+    ImGui::End();
+
+    ImGui::Begin("Animated Sprites");
+    {
+        if (ImGui::SliderInt("ducks", &animated.requested_count, 0, 200'000, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic))
+            resizeAnimated(animated.requested_count);
+        ImGui::Text("sprites = %d, clips = %d of %d frames, draw calls = %d%s", animated_stats.sprites, animated_stats.clips, animated_stats.frames, animated_stats.draw_calls,
+                    animated_stats.pending ? " (compiling)" : "");
+        ImGui::Text("uploaded this frame = %.1f KB", static_cast<double>(animated_stats.upload_size) / 1024.0);
+    }
+    ImGui::End();
+
+    ImGui::Begin("GPU Particles");
+    {
+        ImGui::Checkbox("enabled", &particles.enabled);
+        ImGui::SliderInt("capacity", &particles.capacity, 1024, 1 << 21, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderInt("fountains", &particles.fountains, 1, ParticleSystem::MAX_EMITTERS, "%d", ImGuiSliderFlags_AlwaysClamp);
+        ImGui::SliderFloat("rate", &particles.rate, 100.0f, 1'000'000.0f, "%.0f / s", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::Text("%s", particles.compute ? "compute shader and indirect draw" : "transform feedback");
+        ImGui::Text("spawned = %d, capacity = %d, passes = %d%s", particle_stats.spawned, particle_stats.capacity, particle_stats.draw_calls,
+                    particle_stats.pending ? " (compiling)" : "");
+    }
+    ImGui::End();
+
+    ImGui::Begin("Night Lights");
+    {
+        ImGui::Checkbox("enabled", &night.enabled);
+        ImGui::SliderInt("lights", &night.requested_count, 0, 16384, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("radius", &night.radius, 4.0f, 256.0f, "%.0f", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("ambient", &night.ambient, 0.0f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        if (night.enabled && night.fireflies.size() != static_cast<std::size_t>(night.requested_count))
+            resizeFireflies(night.requested_count);
+        const double occupancy = light_stats.tiles > 0 ? 100.0 * light_stats.occupied_tiles / light_stats.tiles : 0.0;
+        const double per_tile  = light_stats.occupied_tiles > 0 ? static_cast<double>(light_stats.entries) / light_stats.occupied_tiles : 0.0;
+        ImGui::Text("lights = %d binned, %d off screen%s", light_stats.lights, light_stats.culled, light_stats.pending ? " (compiling)" : "");
+        ImGui::Text("tiles = %d of %d lit (%.1f%%), %.1f lights in a lit one, %d at most", light_stats.occupied_tiles, light_stats.tiles, occupancy, per_tile,
+                    light_stats.max_per_tile);
+        ImGui::Text("entries = %d, uploaded this frame = %.1f KB", light_stats.entries, static_cast<double>(light_stats.upload_size) / 1024.0);
+    }
+    ImGui::End();
+
+    ImGui::Begin("Transform Hierarchy");
+    {
+        ImGui::Checkbox("fountains on a wheel", &hierarchy.carousel);
+        if (ImGui::SliderInt("tree nodes", &hierarchy.requested_count, 0, 1 << 18, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic))
+            resizeTree(hierarchy.requested_count);
+        ImGui::SliderFloat("turning", &hierarchy.moving, 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+        ImGui::Checkbox("show tree", &hierarchy.show_tree);
+        const TransformHierarchy::Stats transform_stats = transforms.GetStats();
+        ImGui::Text("nodes = %d in %d levels, %d sorts", transform_stats.nodes, transform_stats.levels, transform_stats.sorts);
+        ImGui::Text("updated = %d, %d levels skipped, %.3f ms", transform_stats.updated, transform_stats.levels_skipped, transform_stats.update_ms);
+    }
+    ImGui::End();
+
+    ImGui::Begin("Texture Atlas");
+    {
+        ImGui::Text("%d regions in %d page(s) of %d x %d", atlas.RegionCount(), atlas.PageCount(), atlas.PageSize(), atlas.PageSize());
+        for (int page = 0; page < atlas.PageCount(); ++page)
+        {
+            ImGui::Text("page %d: %.1f%% used", page, static_cast<double>(atlas.PageOccupancy(page)) * 100.0);
+            ImGui::Image(imgui_texture_id(atlas.PageTexture(page)), ImVec2(256.0f, 256.0f));
+        }
+    }
+    ImGui::End();
+}
 
-void Demo::Setup()
+bool Demo::IsAnimating() const
 {
-    glViewport(0, 0, gWindowWidth, gWindowHeight);
-    glClearColor(background_color.r, background_color.g, background_color.b, 1.0f);
-    example_image.loaded = LoadTextureFromFile(::get_base_path() / "images" / "duck.png", example_image.handle, example_image.width, example_image.height);
+    // a tilemap still building has chunks to show as they land
+    const bool tiles_changing = tiles.enabled && (tiles.pan || tiles.edits > 0 || tiles.map.GetStats().building > 0);
+    const bool pages_loading  = virtual_image.enabled && virtual_image.texture.GetStats().loading > 0;
+    const bool model_changing = model.enabled && (model.spin || model.loading != nullptr);
+    // the scenery only changes while it's edited or still being placed
+    const bool scenery_edited = (scenery.edits > 0 && !scenery.handles.empty()) || (scenery.texture != 0 && scenery.handles.size() != static_cast<std::size_t>(scenery.requested_count));
+    // and a video module still downloading has a player to make when it lands
+    const bool video_changing = video.player != nullptr ? video.player->IsPlaying() : video.enabled && side_modules::GetState(SideModule::Video) == ModuleState::Loading;
+    return !sprite_stress.ducks.IsEmpty() || animated.requested_count > 0 || particles.enabled || night.enabled || (hierarchy.moving > 0.0f && !hierarchy.tree.empty()) ||
+           tiles_changing || scenery_edited || pages_loading || model_changing || video_changing || audio_thread.GetStats().voices_in_use > 0 || (stereo_stream != nullptr && stereo_stream->IsPlaying()) ||
+           music.IsPlaying() || WantsAudio();
+}
 
-    alGenBuffers(2, alBufferHandles);
-    alGenSources(2, alSourceHandles);
+bool Demo::WantsAudio() const noexcept
+{
+    return pending_play != PendingPlay::None && !audio->HasFailed();
+}
 
-    ALenum  format = 0;
-    ALvoid* data   = nullptr;
-    ALsizei size   = 0;
-    ALsizei freq   = 0;
+bool Demo::HasAudio() const noexcept
+{
+    return has_audio;
+}
 
-    SDL_AudioSpec wavSpec;
-    Uint32        wavLength;
-    Uint8*        wavBuffer;
-    const auto    e_path = get_base_path() / "audio" / "duck-quacking-loudly-three-times.wav";
-    if (SDL_LoadWAV(e_path.string().c_str(), &wavSpec, &wavBuffer, &wavLength) == nullptr)
+void Demo::playPending()
+{
+    if (!has_audio || pending_play == PendingPlay::None)
+        return;
+    if (pending_play == PendingPlay::Stereo)
+    {
+        stereo_stream->Play();
+        pending_play = PendingPlay::None;
+        return;
+    }
+    if (quack->HasFailed())
+        pending_play = PendingPlay::None;
+    if (!quack->IsReady())
+        return;
+    // a Vorbis bank decodes here, and gives nothing back when voices hold every pool buffer
+    const ALuint quack_buffer = sounds->BufferFor(quack);
+    if (quack_buffer == 0)
+    {
+        pending_play = PendingPlay::None;
+        return;
+    }
+    if (pending_play == PendingPlay::Mono)
     {
-        throw_error_message("Failed to load WAV file: ", e_path, SDL_GetError());
+        const bool        measured = latency.clicked != 0;
+        const SoundTicket sound    = audio_thread.Play(quack_buffer, VoiceParams{}, reverb_zone, measured);
+        if (measured)
+            latency.sound = sound;
     }
-    format = get_openal_format(&wavSpec);
-    data   = wavBuffer;
-    size   = gsl::narrow_cast<ALsizei>(wavLength);
-    freq   = wavSpec.freq;
-    alBufferData(alBufferHandles[0], format, data, size, freq);
-    SDL_FreeWAV(wavBuffer);
-    alSourcei(alSourceHandles[0], AL_BUFFER, gsl::narrow_cast<ALint>(alBufferHandles[0]));
+    else
+    {
+        for (int i = 0; i < 64; ++i)
+        {
+            const int zone = effects.ZoneCount() > 0 ? i % effects.ZoneCount() : -1;
+            audio_thread.Play(quack_buffer, VoiceParams{ 0.05f + 0.01f * static_cast<float>(i % 8), 0.75f + 0.01f * static_cast<float>(i) }, zone);
+        }
+    }
+    pending_play = PendingPlay::None;
+}
 
-    int        channels, sample_rate;
-    short*     output;
-    const auto stereo_path = get_base_path() / "audio" / "duck_vocalizations.ogg";
-    int        samples     = stb_vorbis_decode_filename(stereo_path.string().c_str(), &channels, &sample_rate, &output);
-    if (samples == -1)
+void Demo::updateGrains()
+{
+    constexpr int MAX_PER_FRAME = 2048; // after a stall, rather than a burst that fills the queue
+    const Uint64  now           = SDL_GetPerformanceCounter();
+    const double  elapsed       = grains.last_ticks != 0 ? static_cast<double>(now - grains.last_ticks) / static_cast<double>(SDL_GetPerformanceFrequency()) : 0.0;
+    grains.last_ticks           = now;
+    if (grains.mixer != nullptr)
+        grains.mixer->Update(static_cast<float>(elapsed));
+    if (!has_audio || grains.per_second <= 0)
     {
-        throw_error_message("Failed to load OGG file: ", stereo_path);
+        grains.owed = 0.0;
+        return;
     }
+    grains.owed += elapsed * grains.per_second;
+    const int due = std::min(static_cast<int>(grains.owed), MAX_PER_FRAME);
+    grains.owed -= due;
+    if (due == 0)
+        return;
 
-    format = (channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
-    data   = output;
-    size   = samples * channels * int(sizeof(short));
-    freq   = sample_rate;
-    alBufferData(alBufferHandles[1], format, data, size, freq);
-    free(output);
-    alSourcei(alSourceHandles[1], AL_BUFFER, gsl::narrow_cast<ALint>(alBufferHandles[1]));
+    // spread across the stereo field, and quieter the more overlap, so the sum stays clear of clipping
+    constexpr float SPREAD  = 200.0f;
+    const float     overlap = std::max(1.0f, static_cast<float>(grains.per_second) * 0.04f);
+    VoiceParams     params;
+    params.gain               = 0.5f / std::sqrt(overlap);
+    params.reference_distance = SPREAD * 2.0f;
+    params.max_distance       = SPREAD * 4.0f;
+    for (int i = 0; i < due; ++i)
+    {
+        grains.seed     = grains.seed * 1664525u + 1013904223u;
+        const float pan = static_cast<float>(grains.seed >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+        params.position = grains.listener + glm::vec3{ pan * SPREAD, 0.0f, 0.0f };
+        if (grains.mixer != nullptr)
+            grains.mixer->Play(grains.mixer_buffer, params);
+        else
+            audio_thread.Play(grains.al_buffer, params);
+    }
 }
 
-void Demo::Shutdown()
+void Demo::measureLatency()
 {
-    if (example_image.loaded)
+    AudioThread::StartReport report;
+    if (!latency.sound.IsValid() || !audio_thread.TakeStartReport(report) || report.ticket.value != latency.sound.value)
+        return;
+    if (report.played_seconds > 0.0f)
     {
-        glDeleteTextures(1, &example_image.handle);
+        // the offset only moves once per mixer update, so this is the start of the update that picked the voice up
+        const double since = static_cast<double>(report.observed - latency.clicked) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+        latency.mixer_ms   = since - static_cast<double>(report.played_seconds) * 1000.0;
+        latency.output_ms  = std::max(0.0, audio->OutputLatencyMs());
+        latency.last_ms    = latency.mixer_ms + latency.output_ms;
+        latency.total_ms += latency.last_ms;
+        ++latency.samples;
     }
+    latency.sound   = SoundTicket{};
+    latency.clicked = 0;
+}
 
-    alDeleteSources(2, alSourceHandles);
-    alDeleteBuffers(2, alBufferHandles);
+void Demo::SetDisplaySize(int width, int height)
+{
+    display_size = glm::vec2{ static_cast<float>(width), static_cast<float>(height) };
+    cull_bounds  = Aabb2{ glm::vec2{ 0.0f }, display_size };
+    resetSpriteGrid();
+    // over the middle of the screen looking down at it; y flips since screen y runs down
+    constexpr float LISTENER_HEIGHT = 100.0f;
+    const glm::vec3 listener{ display_size.x * 0.5f, -display_size.y * 0.5f, LISTENER_HEIGHT };
+    if (audio_thread.IsRunning())
+        audio_thread.SetListener(listener, glm::vec3{ 0.0f, 0.0f, -1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+    else
+        spatial.SetListener(listener, glm::vec3{ 0.0f, 0.0f, -1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+    grains.listener = listener;
+    if (grains.mixer != nullptr)
+        grains.mixer->SetListener(listener, glm::vec3{ 0.0f, 0.0f, -1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
 }
 
-void Demo::Draw() const
+void Demo::SetCullBounds(const Aabb2& screen) noexcept
 {
-    glClearColor(background_color.r, background_color.g, background_color.b, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    cull_bounds = screen;
 }
 
-void Demo::ImGuiDraw()
+void Demo::SetPickedDuck(std::uint32_t pick_id) noexcept
 {
-    ImGui::Begin("OpenGL Texture Test");
-    if (example_image.loaded)
+    picked_duck = pick_id;
+}
+
+void Demo::updateQuackingDucks(WorkerPool& workers)
+{
+    if (!has_audio)
+        return;
+    const auto to_world = [](glm::vec2 position) { return glm::vec3{ position.x, -position.y, 0.0f }; };
+    const EntityStore& ducks  = sprite_stress.ducks;
+    const auto         target = static_cast<std::size_t>(std::min(quacking_requested, static_cast<int>(ducks.Size())));
+    std::erase_if(quacking_ducks,
+                  [this, &ducks](const QuackingDuck& quacking)
+                  {
+                      if (ducks.Contains(quacking.duck))
+                          return false;
+                      audio_thread.RemoveEmitter(quacking.emitter);
+                      return true;
+                  });
+    while (quacking_ducks.size() > target)
     {
-        ImGui::Text("handle = %d", example_image.handle);
-        ImGui::Text("size = %d x %d", example_image.width, example_image.height);
-        ImGui::Image(reinterpret_cast<void*>(static_cast<intptr_t>(example_image.handle)), ImVec2(static_cast<float>(example_image.width), static_cast<float>(example_image.height)));
+        audio_thread.RemoveEmitter(quacking_ducks.back().emitter);
+        quacking_ducks.pop_back();
     }
-    else
+    if (quacking_ducks.size() < target && quack->IsReady() && quack->storage != SoundStorage::Vorbis)
     {
-        ImGui::Text("%s", "Failed to load texture image...");
+        EmitterParams params;
+        params.gain               = 0.3f;
+        params.reference_distance = 60.0f;
+        params.max_distance       = 320.0f;
+        params.distant_buffer     = quack->distant_buffer;
+        while (quacking_ducks.size() < target)
+        {
+            // the ducks are only truncated, so the next dense index is one nobody quacks for yet
+            const EntityHandle duck    = ducks.HandleAt(quacking_ducks.size());
+            const SoundTicket  emitter = audio_thread.AddEmitter(quack->buffer, to_world(ducks.Positions()[ducks.IndexOf(duck)]), params);
+            if (!emitter.IsValid())
+                break; // the queue is full, the rest go in next frame
+            quacking_ducks.push_back(QuackingDuck{ emitter, duck });
+        }
     }
-    ImGui::End();
+    // the audio thread culls and batches them when it drains
+    for (const QuackingDuck& quacking : quacking_ducks)
+        audio_thread.MoveEmitter(quacking.emitter, to_world(ducks.Positions()[ducks.IndexOf(quacking.duck)]));
 
-    ImGui::Begin("Audio Test");
+    // the grid's ids are the ducks' dense indices, and the listener is over the middle of the screen
+    occlusion_sources.clear();
+    for (const QuackingDuck& quacking : quacking_ducks)
     {
-        if (ImGui::Button("Play Mono SFX"))
+        const std::size_t index = ducks.IndexOf(quacking.duck);
+        occlusion_sources.push_back(OcclusionSource{ ducks.Positions()[index], static_cast<std::uint32_t>(index) });
+    }
+    for (const std::uint32_t traced : occlusion.Update(sprite_stress.grid, display_size * 0.5f, occlusion_sources, workers))
+        audio_thread.OccludeEmitter(quacking_ducks[traced].emitter, occlusion.Occlusion(traced));
+}
+
+void Demo::SetStressLoad(int sprite_count, int marker_count)
+{
+    sprite_stress.requested_count = sprite_count;
+    markers.requested_count       = marker_count;
+    resizeSpriteStress(sprite_count);
+    resizeMarkers(marker_count);
+}
+
+void Demo::LoadScene(const SceneFile& scene)
+{
+    sprite_stress.ducks.Assign(scene.Positions(), scene.Velocities(), scene.Sprites(), scene.Colors());
+    sprite_stress.requested_count = static_cast<int>(scene.EntityCount());
+    // as many screens as the scene's world takes, or the window when it gives none
+    if (const glm::vec2 world = scene.WorldSize(); world.x > 0.0f && world.y > 0.0f && display_size.x > 0.0f && display_size.y > 0.0f)
+        sprite_stress.world_scale = std::clamp(std::max(world.x / display_size.x, world.y / display_size.y), 1.0f, 16.0f);
+    sprite_stress.grid.Truncate(0);
+    resetSpriteGrid();
+    const glm::vec2 half_extent = duckHalfExtent();
+    const auto      positions   = sprite_stress.ducks.Positions();
+    for (std::size_t i = 0; i < positions.size(); ++i)
+        sprite_stress.grid.Set(static_cast<std::uint32_t>(i), positions[i], half_extent);
+}
+
+void Demo::resizeSpriteStress(int count)
+{
+    const auto new_count = static_cast<std::size_t>(count);
+    auto&      random    = sprite_stress.random;
+
+    std::uniform_real_distribution<float> along_x{ 0.0f, display_size.x * sprite_stress.world_scale };
+    std::uniform_real_distribution<float> along_y{ 0.0f, display_size.y * sprite_stress.world_scale };
+    std::uniform_real_distribution<float> speed{ -200.0f, 200.0f };
+    EntityStore& ducks = sprite_stress.ducks;
+    ducks.Reserve(new_count);
+    while (ducks.Size() < new_count)
+    {
+        // the sprite id picks among the frame's duck textures
+        const glm::vec2 position{ along_x(random), along_y(random) };
+        const glm::vec2 velocity{ speed(random), speed(random) };
+        ducks.Create(position, velocity, static_cast<std::uint16_t>(ducks.Size() % 4));
+    }
+    ducks.Truncate(new_count);
+    sprite_stress.grid.Truncate(new_count);
+    const glm::vec2 half_extent = duckHalfExtent();
+    for (std::size_t i = 0; i < new_count; ++i)
+        sprite_stress.grid.Set(static_cast<std::uint32_t>(i), ducks.Positions()[i], half_extent);
+}
+
+void Demo::resetSpriteGrid()
+{
+    // a few ducks across at the default scale; the grid coarsens by itself for the biggest worlds
+    constexpr float CELL_SIZE = 128.0f;
+    sprite_stress.grid.Reset(glm::vec2{ 0.0f }, display_size * sprite_stress.world_scale, CELL_SIZE);
+}
+
+glm::mat3 Demo::duckView() const
+{
+    // scale(zoom) * translate(-view_offset), column major
+    const float zoom = sprite_stress.zoom;
+    return glm::mat3{ glm::vec3{ zoom, 0.0f, 0.0f }, glm::vec3{ 0.0f, zoom, 0.0f }, glm::vec3{ -sprite_stress.view_offset * zoom, 1.0f } };
+}
+
+glm::vec2 Demo::duckHalfExtent() const
+{
+    glm::vec2 largest{ 0.0f };
+    for (const TextureHandle* duck : { &atlas_duck, &mipmapped_duck, &example_image, &array_duck })
+    {
+        if (*duck != nullptr && (*duck)->IsResident())
+            largest = glm::max(largest, glm::vec2{ static_cast<float>((*duck)->texture.width), static_cast<float>((*duck)->texture.height) });
+    }
+    return largest * sprite_stress.scale * 0.5f;
+}
+
+void Demo::resizeMarkers(int count)
+{
+    // same seed every time, so changing the size keeps the layout
+    std::mt19937                          random{ 1999 };
+    std::uniform_real_distribution<float> along_x{ 0.0f, display_size.x };
+    std::uniform_real_distribution<float> along_y{ 0.0f, display_size.y };
+    std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+    markers.instances.clear();
+    markers.instances.reserve(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        const glm::vec3     position{ along_x(random), along_y(random), 0.0f };
+        const float         rotation = unit(random) * glm::two_pi<float>();
+        const std::uint32_t color    = pack_rgba8(unit(random), unit(random), unit(random), 1.0f);
+        markers.instances.push_back(pack_mesh_instance(position, rotation, glm::vec3{ markers.size }, color));
+    }
+    resizeLabels();
+}
+
+void Demo::resizeAnimated(int count)
+{
+    // a new set rather than an edit of the one a frame in flight may still be uploading
+    std::mt19937                          random{ 1066 };
+    std::uniform_real_distribution<float> along_x{ 0.0f, display_size.x };
+    std::uniform_real_distribution<float> along_y{ 0.0f, display_size.y };
+    std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+    auto                                  sprites = std::make_shared<std::vector<AnimatedSprite>>();
+    sprites->reserve(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        AnimatedSprite sprite;
+        sprite.position   = glm::vec2{ along_x(random), along_y(random) };
+        sprite.size       = glm::vec2{ 24.0f };
+        sprite.color      = pack_rgba8(0.6f + 0.4f * unit(random), 0.6f + 0.4f * unit(random), 0.6f + 0.4f * unit(random), 1.0f);
+        sprite.clip       = animated.clip;
+        sprite.start_time = static_cast<float>(animated.time) - unit(random);
+        sprite.speed      = 0.5f + 1.5f * unit(random);
+        sprites->push_back(sprite);
+    }
+    animated.sprites = std::move(sprites);
+}
+
+void Demo::resizeTree(int count)
+{
+    // the root takes the rest with it
+    if (!hierarchy.tree.empty())
+        transforms.Destroy(hierarchy.tree.front());
+    hierarchy.tree.clear();
+    hierarchy.tree.reserve(static_cast<std::size_t>(count));
+    hierarchy.cursor = 0;
+    std::mt19937                          random{ 2718 };
+    std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+    for (int i = 0; i < count; ++i)
+    {
+        // each level at half the scale of the one above, so however deep the tree stays on screen
+        Transform2D     local;
+        TransformHandle parent;
+        const float     angle = glm::two_pi<float>() * unit(random);
+        if (i == 0)
         {
-            alSourcePlay(alSourceHandles[0]);
+            local.position = display_size * 0.5f;
         }
-        ImGui::SameLine();
-        if (ImGui::Button("Play Stereo SFX"))
+        else
         {
-            alSourcePlay(alSourceHandles[1]);
+            parent         = hierarchy.tree[static_cast<std::size_t>(i - 1) / 4];
+            local.position = glm::vec2{ std::cos(angle), std::sin(angle) } * (120.0f + 80.0f * unit(random));
+            local.scale    = glm::vec2{ 0.5f };
         }
+        hierarchy.tree.push_back(transforms.Create(local, parent));
     }
-    ImGui::End();
 }
 
-void Demo::SetDisplaySize(int width, int height)
+void Demo::resizeFireflies(int count)
+{
+    std::mt19937                          random{ 1776 };
+    std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+    night.fireflies.resize(static_cast<std::size_t>(count));
+    for (Firefly& firefly : night.fireflies)
+    {
+        firefly.center = glm::vec2{ unit(random), unit(random) };
+        firefly.orbit  = 8.0f + 56.0f * unit(random);
+        firefly.speed  = (unit(random) < 0.5f ? -1.0f : 1.0f) * (0.3f + 1.2f * unit(random));
+        firefly.phase  = glm::two_pi<float>() * unit(random);
+        firefly.size   = 0.5f + unit(random);
+        // warm yellows and greens, a few cold ones
+        const float hue = unit(random);
+        firefly.color   = hue < 0.85f ? pack_rgba8(1.0f, 0.7f + 0.3f * hue, 0.3f * unit(random), 1.0f) : pack_rgba8(0.4f, 0.7f, 1.0f, 1.0f);
+    }
+}
+
+namespace
+{
+    // a texel of darker rim on every tile, so the grid reads when zoomed in
+    std::vector<unsigned char> make_tileset_pixels()
+    {
+        std::vector<unsigned char> pixels(static_cast<std::size_t>(TILESET_WIDTH * TILE_PIXELS) * 4);
+        for (int y = 0; y < TILE_PIXELS; ++y)
+        {
+            for (int x = 0; x < TILESET_WIDTH; ++x)
+            {
+                const int       local_x = x % TILE_PIXELS;
+                const bool      rim     = local_x == 0 || y == 0 || local_x == TILE_PIXELS - 1 || y == TILE_PIXELS - 1;
+                const float     shade   = (rim ? 0.85f : 1.0f) * (0.9f + 0.1f * lattice(x, y));
+                const glm::vec3 color   = TILE_COLORS[static_cast<std::size_t>(x / TILE_PIXELS)] * shade;
+                unsigned char*  texel   = &pixels[static_cast<std::size_t>(y * TILESET_WIDTH + x) * 4];
+                texel[0]                = static_cast<unsigned char>(color.r * 255.0f + 0.5f);
+                texel[1]                = static_cast<unsigned char>(color.g * 255.0f + 0.5f);
+                texel[2]                = static_cast<unsigned char>(color.b * 255.0f + 0.5f);
+                texel[3]                = 255;
+            }
+        }
+        return pixels;
+    }
+}
+
+void Demo::placeTileset(const std::vector<unsigned char>& pixels)
+{
+    const AtlasRegion region = atlas.Add(pixels.data(), TILESET_WIDTH, TILE_PIXELS);
+    if (region.texture == 0)
+    {
+        LOG_ERROR("The tileset didn't fit the atlas");
+        return;
+    }
+    // half a texel in from each edge, so filtering never reaches the neighbouring tile or the atlas padding
+    tiles.texture = region.texture;
+    tiles.tileset.clear();
+    const glm::vec2 sheet_min{ region.uv_rect.x, region.uv_rect.y };
+    const glm::vec2 sheet_max{ region.uv_rect.z, region.uv_rect.w };
+    const glm::vec2 sheet_texels{ static_cast<float>(TILESET_WIDTH), static_cast<float>(TILE_PIXELS) };
+    for (int i = 0; i < TILE_COUNT; ++i)
+    {
+        const glm::vec2 low{ static_cast<float>(i * TILE_PIXELS) + 0.5f, 0.5f };
+        const glm::vec2 high{ static_cast<float>((i + 1) * TILE_PIXELS) - 0.5f, static_cast<float>(TILE_PIXELS) - 0.5f };
+        tiles.tileset.emplace_back(glm::mix(sheet_min, sheet_max, low / sheet_texels), glm::mix(sheet_min, sheet_max, high / sheet_texels));
+    }
+}
+
+AssetTask Demo::Load(AssetTasks& tasks)
+{
+    const Uint64 started = SDL_GetPerformanceCounter();
+    const auto   duck    = get_base_path() / "images" / "duck.png";
+    // everything is asked for before the first co_await, so it all loads at once; the windows poll the handles meanwhile.
+    // the texture test window shows the first, so it goes ahead of the rest
+    auto example = tasks.LoadTexture(duck, {}, nullptr, LoadPriority::Immediate);
+    auto atlased = tasks.LoadTexture(duck, {}, &atlas);
+
+    TextureOptions mipmapped;
+    mipmapped.generate_mipmaps  = true;
+    mipmapped.mipmaps_on_worker = true;
+    mipmapped.max_anisotropy    = 8.0f;
+    auto mipmapped_load         = tasks.LoadTexture(duck, mipmapped);
+    auto array_load             = tasks.LoadTexture(duck, {}, duck_array);
+
+    TextureOptions thumbnail;
+    thumbnail.max_dimension = 64;
+    auto thumbnail_load     = tasks.LoadTexture(duck, thumbnail);
+    auto tileset            = tasks.OnWorker(make_tileset_pixels, LoadPriority::Visible);
+
+    example_image  = example.Handle();
+    atlas_duck     = atlased.Handle();
+    mipmapped_duck = mipmapped_load.Handle();
+    array_duck     = array_load.Handle();
+    thumbnail_duck = thumbnail_load.Handle();
+
+    // the atlas is the GL thread's, which is where this resumes
+    placeTileset(co_await tileset);
+    int failed = 0;
+    for (AssetTasks::TextureLoad* load : { &example, &atlased, &mipmapped_load, &array_load, &thumbnail_load })
+    {
+        const TextureHandle texture = co_await *load;
+        failed += texture->HasFailed() ? 1 : 0;
+    }
+    const double ms = static_cast<double>(SDL_GetPerformanceCounter() - started) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    if (failed > 0)
+        LOG_WARN(failed, " of the demo's textures failed to load");
+    else
+        LOG_INFO("The demo's textures and tileset loaded in ", ms, " ms");
+}
+
+void Demo::resizeLabels()
 {
-    glViewport(0, 0, width, height);
+    // the font keeps every line it has laid out, so coming back to a count costs lookups only
+    const std::size_t count = labels.font->IsLoaded() ? std::min(static_cast<std::size_t>(labels.requested_count), markers.instances.size()) : 0;
+    labels.runs.resize(count);
+    labels.glyph_count = 0;
+    // spelled in escapes, so the source file's encoding doesn't matter
+    static constexpr std::u8string_view WORDS[] = { u8"marker ", u8"\u03b4\u03b5\u03af\u03ba\u03c4\u03b7\u03c2 ", u8"\u043c\u0430\u0440\u043a\u0435\u0440 ", u8"\u6807\u8bb0 ", u8"" };
+    constexpr char32_t                  FIRST_IDEOGRAPH = 0x4E00;
+    constexpr std::size_t               IDEOGRAPHS      = 20'992; // the CJK Unified Ideographs block
+    const std::u8string_view            word            = WORDS[static_cast<std::size_t>(labels.script)];
+    std::string                         text;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        text.assign(reinterpret_cast<const char*>(word.data()), word.size());
+        if (labels.script == LabelScript::Ideographs)
+        {
+            // all three-byte sequences
+            const char32_t ideograph = FIRST_IDEOGRAPH + static_cast<char32_t>(i % IDEOGRAPHS);
+            text += static_cast<char>(0xE0 | ideograph >> 12);
+            text += static_cast<char>(0x80 | (ideograph >> 6 & 0x3F));
+            text += static_cast<char>(0x80 | (ideograph & 0x3F));
+            text += ' ';
+        }
+        text += std::to_string(i);
+        labels.runs[i] = labels.font->Shape(text);
+        labels.glyph_count += labels.font->Run(labels.runs[i]).glyphs.size();
+    }
 }
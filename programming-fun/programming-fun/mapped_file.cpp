@@ -0,0 +1,110 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <Windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::filesystem::path& filename)
+{
+    Close();
+#if defined(_WIN32)
+    HANDLE handle = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(handle, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(handle);
+        return false;
+    }
+    file    = handle;
+    mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping != nullptr)
+        view = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    size = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    const int descriptor = ::open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        return false;
+    struct stat info{};
+    if (fstat(descriptor, &info) == 0 && info.st_size > 0)
+    {
+        void* address = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address != MAP_FAILED)
+        {
+            view = static_cast<const unsigned char*>(address);
+            size = static_cast<std::size_t>(info.st_size);
+        }
+    }
+    // the mapping keeps its own reference to the file
+    ::close(descriptor);
+#endif
+    if (view == nullptr)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+    if (view != nullptr)
+        UnmapViewOfFile(view);
+    if (mapping != nullptr)
+        CloseHandle(mapping);
+    if (file != nullptr)
+        CloseHandle(file);
+    mapping = file = nullptr;
+#else
+    if (view != nullptr)
+        munmap(const_cast<unsigned char*>(view), size);
+#endif
+    view = nullptr;
+    size = 0;
+}
+
+bool MappedFile::IsOpen() const noexcept
+{
+    return view != nullptr;
+}
+
+std::span<const unsigned char> MappedFile::Bytes() const noexcept
+{
+    return { view, size };
+}
+
+void MappedFile::Prefetch([[maybe_unused]] std::span<const unsigned char> range) const noexcept
+{
+    if (view == nullptr || range.empty() || range.data() < view || range.data() + range.size() > view + size)
+        return;
+#if defined(_WIN32)
+    WIN32_MEMORY_RANGE_ENTRY entry{ const_cast<unsigned char*>(range.data()), range.size() };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+#elif !defined(__EMSCRIPTEN__)
+    // madvise wants a page boundary, and the mapping starts on one
+    const auto page  = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const auto first = static_cast<std::size_t>(range.data() - view) / page * page;
+    madvise(const_cast<unsigned char*>(view + first), static_cast<std::size_t>(range.data() - view) + range.size() - first, MADV_WILLNEED);
+#endif
+}
@@ -0,0 +1,45 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+/**
+ * Read-only memory mapping of a whole file.
+ *
+ * Pages are faulted in on first touch, so opening is one system call no matter how big the file is.
+ * Uses CreateFileMapping on Windows and mmap elsewhere (Emscripten's mmap copies from its virtual FS).
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)                = delete;
+    MappedFile& operator=(const MappedFile&)     = delete;
+    MappedFile(MappedFile&&) noexcept            = delete;
+    MappedFile& operator=(MappedFile&&) noexcept = delete;
+
+    bool Open(const std::filesystem::path& filename);
+    void Close();
+
+    bool                           IsOpen() const noexcept;
+    std::span<const unsigned char> Bytes() const noexcept;
+    // Has the OS start reading `range`, a part of Bytes(), in the background, so the first touch finds it in memory
+    void                           Prefetch(std::span<const unsigned char> range) const noexcept;
+
+private:
+    const unsigned char* view = nullptr;
+    std::size_t          size = 0;
+#if defined(_WIN32)
+    void* file    = nullptr;
+    void* mapping = nullptr;
+#endif
+};
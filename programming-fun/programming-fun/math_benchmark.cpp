@@ -0,0 +1,138 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "math_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/vec3.hpp>
+#include <ostream>
+#include <random>
+
+namespace
+{
+    // a float sum of a few products drifts by a few ulps from the order glm adds them in
+    constexpr float TOLERANCE = 1e-5f;
+
+    template <typename Work>
+    double best_ms(int runs, Work&& work)
+    {
+        using clock = std::chrono::steady_clock;
+        double best = 0.0;
+        for (int i = 0; i < runs; ++i)
+        {
+            const auto begin = clock::now();
+            work();
+            const double ms = std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+            best            = i == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    }
+
+    template <typename Vector>
+    float relative_error(const Vector& value, const Vector& expected)
+    {
+        const Vector difference = glm::abs(value - expected) / glm::max(glm::abs(expected), Vector{ 1.0f });
+        float        largest    = 0.0f;
+        for (int i = 0; i < Vector::length(); ++i)
+            largest = std::max(largest, difference[i]);
+        return largest;
+    }
+}
+
+namespace math_benchmark
+{
+    Result Run(int point_count, int runs)
+    {
+        Result result;
+        result.points = std::max(point_count, 1);
+        result.runs   = std::max(runs, 1);
+#if defined(GLM_FORCE_INTRINSICS)
+        result.glm_simd = true;
+#endif
+
+        const auto                            count = static_cast<std::size_t>(result.points);
+        std::mt19937                          random{ 2024 };
+        std::uniform_real_distribution<float> spread{ -1000.0f, 1000.0f };
+        std::vector<glm::vec2>                points2(count);
+        std::vector<glm::vec4>                points4(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            points2[i] = glm::vec2{ spread(random), spread(random) };
+            points4[i] = glm::vec4{ spread(random), spread(random), spread(random), 1.0f };
+        }
+        // a view like the ducks' and a camera like a 3D scene's
+        const glm::mat3 transform2{ glm::vec3{ 0.8f, 0.6f, 0.0f }, glm::vec3{ -0.6f, 0.8f, 0.0f }, glm::vec3{ 120.0f, -40.0f, 1.0f } };
+        const glm::mat4 transform4 = glm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 5000.0f) * glm::lookAt(glm::vec3{ 0.0f, 200.0f, 1500.0f }, glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+
+        std::vector<glm::vec2> expected2(count);
+        std::vector<glm::vec4> expected4(count);
+        result.glm_transform2_ms = best_ms(result.runs,
+                                           [&]
+                                           {
+                                               for (std::size_t i = 0; i < count; ++i)
+                                                   expected2[i] = glm::vec2{ transform2 * glm::vec3{ points2[i], 1.0f } };
+                                           });
+        result.glm_transform4_ms = best_ms(result.runs,
+                                           [&]
+                                           {
+                                               for (std::size_t i = 0; i < count; ++i)
+                                                   expected4[i] = transform4 * points4[i];
+                                           });
+        Aabb2 expected_bounds{ points2.front(), points2.front() };
+        for (const glm::vec2& point : points2)
+        {
+            expected_bounds.min = glm::min(expected_bounds.min, point);
+            expected_bounds.max = glm::max(expected_bounds.max, point);
+        }
+
+        const math_kernels::Level previous = math_kernels::ActiveLevel();
+        std::vector<glm::vec2>    out2(count);
+        std::vector<glm::vec4>    out4(count);
+        for (const math_kernels::Level level : { math_kernels::Level::Scalar, math_kernels::Level::Sse2, math_kernels::Level::Neon, math_kernels::Level::Wasm })
+        {
+            if (!math_kernels::SetLevel(level))
+                continue;
+            LevelResult& timing  = result.levels.emplace_back();
+            timing.level         = level;
+            timing.transform2_ms = best_ms(result.runs, [&] { math_kernels::TransformPoints(transform2, points2.data(), out2.data(), count); });
+            timing.transform4_ms = best_ms(result.runs, [&] { math_kernels::TransformPoints(transform4, points4.data(), out4.data(), count); });
+            Aabb2 bounds;
+            timing.bounds_ms     = best_ms(result.runs, [&] { bounds = math_kernels::Bounds(points2.data(), count); });
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                timing.max_error = std::max(timing.max_error, relative_error(out2[i], expected2[i]));
+                timing.max_error = std::max(timing.max_error, relative_error(out4[i], expected4[i]));
+            }
+            // min and max don't round, so these have to be exact
+            const bool same_bounds = bounds.min == expected_bounds.min && bounds.max == expected_bounds.max;
+            timing.matches_glm     = same_bounds && timing.max_error <= TOLERANCE;
+        }
+        math_kernels::SetLevel(previous);
+        return result;
+    }
+
+    void Print(std::ostream& out, const Result& result)
+    {
+        out << "Math kernels, " << result.points << " points, best of " << result.runs << " runs" << (result.glm_simd ? ", glm with intrinsics" : "") << '\n';
+        out << "  glm loops: mat3 " << result.glm_transform2_ms << " ms, mat4 " << result.glm_transform4_ms << " ms\n";
+        for (const LevelResult& level : result.levels)
+        {
+            out << "  " << math_kernels::LevelName(level.level) << ": mat3 " << level.transform2_ms << " ms, mat4 " << level.transform4_ms << " ms, bounds " << level.bounds_ms
+                << " ms, max error " << level.max_error << (level.matches_glm ? "" : "  MISMATCH") << '\n';
+        }
+    }
+
+    bool Passed(const Result& result) noexcept
+    {
+        return std::all_of(result.levels.begin(), result.levels.end(), [](const LevelResult& level) { return level.matches_glm; });
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "math_kernels.h"
+
+#include <iosfwd>
+#include <vector>
+
+/**
+ * math_kernels at each level this build and CPU have, checked against plain glm on the same random
+ * points and timed over the same arrays. Run with "--benchmark-math [count]" before any window opens;
+ * it fails when a kernel strays from glm by more than float rounding.
+ */
+namespace math_benchmark
+{
+    struct LevelResult
+    {
+        math_kernels::Level level         = math_kernels::Level::Scalar;
+        double              transform2_ms = 0.0; // best of the runs, for all the points
+        double              transform4_ms = 0.0;
+        double              bounds_ms     = 0.0;
+        float               max_error     = 0.0f; // against glm, relative to the values' size
+        bool                matches_glm   = false;
+    };
+
+    struct Result
+    {
+        int                      points            = 0;
+        int                      runs              = 0;
+        double                   glm_transform2_ms = 0.0; // the same loops written with glm's operators
+        double                   glm_transform4_ms = 0.0;
+        bool                     glm_simd          = false; // built with GLM_FORCE_INTRINSICS
+        std::vector<LevelResult> levels;
+    };
+
+    Result Run(int point_count = 100'000, int runs = 50);
+    void   Print(std::ostream& out, const Result& result);
+    // every level matched glm
+    bool   Passed(const Result& result) noexcept;
+}
@@ -0,0 +1,472 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "math_kernels.h"
+
+#include <SDL_cpuinfo.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <glm/common.hpp>
+#include <glm/vec3.hpp>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    define MATH_KERNELS_X86 1
+#    include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#    define MATH_KERNELS_NEON 1
+#    include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#    define MATH_KERNELS_WASM 1
+#    include <wasm_simd128.h>
+#endif
+
+// MSVC takes any intrinsic in any function; GCC and Clang want the function marked for its instruction set
+#if defined(MATH_KERNELS_X86) && defined(__GNUC__)
+#    define MATH_KERNELS_TARGET(isa) __attribute__((target(isa)))
+#else
+#    define MATH_KERNELS_TARGET(isa)
+#endif
+
+namespace
+{
+    using math_kernels::Level;
+
+    // glm keeps the components of vec2 and vec4 and the columns of its matrices packed, with or without
+    // aligned gentypes, so the vector versions can load them as plain floats
+    static_assert(sizeof(glm::vec2) == 2 * sizeof(float));
+    static_assert(sizeof(glm::vec4) == 4 * sizeof(float));
+
+    const Aabb2 EMPTY_BOUNDS{ glm::vec2{ std::numeric_limits<float>::max() }, glm::vec2{ std::numeric_limits<float>::lowest() } };
+
+    struct Kernels
+    {
+        Level level;
+        void (*transform2)(const glm::mat3& transform, const glm::vec2* in, glm::vec2* out, std::size_t count);
+        void (*transform4)(const glm::mat4& transform, const glm::vec4* in, glm::vec4* out, std::size_t count);
+        Aabb2 (*bounds)(const glm::vec2* points, std::size_t count);
+        std::size_t (*sweep)(const float* min_x, const float* min_y, const float* max_y, std::size_t count, const Aabb2& box, std::uint32_t* hits, std::size_t& swept);
+    };
+
+    // the references, and the tails the vector versions leave over
+    namespace scalar
+    {
+        void transform2(const glm::mat3& transform, const glm::vec2* in, glm::vec2* out, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                out[i] = glm::vec2{ transform * glm::vec3{ in[i], 1.0f } };
+        }
+
+        void transform4(const glm::mat4& transform, const glm::vec4* in, glm::vec4* out, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                out[i] = transform * in[i];
+        }
+
+        Aabb2 bounds(const glm::vec2* points, std::size_t count)
+        {
+            Aabb2 box = EMPTY_BOUNDS;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                box.min = glm::min(box.min, points[i]);
+                box.max = glm::max(box.max, points[i]);
+            }
+            return box;
+        }
+
+        std::size_t sweep(const float* min_x, const float* min_y, const float* max_y, std::size_t count, const Aabb2& box, std::uint32_t* hits, std::size_t& swept)
+        {
+            std::size_t found = 0;
+            std::size_t i     = 0;
+            for (; i < count && min_x[i] <= box.max.x; ++i)
+            {
+                if (min_y[i] <= box.max.y && max_y[i] >= box.min.y)
+                    hits[found++] = static_cast<std::uint32_t>(i);
+            }
+            swept = i;
+            return found;
+        }
+
+        // the vector versions' last few boxes, numbered from `first`
+        std::size_t sweep_tail(const float* min_x, const float* min_y, const float* max_y, std::size_t first, std::size_t count, const Aabb2& box,
+                               std::uint32_t* hits, std::size_t& swept)
+        {
+            const std::size_t found = sweep(min_x + first, min_y + first, max_y + first, count - first, box, hits, swept);
+            for (std::size_t k = 0; k < found; ++k)
+                hits[k] += static_cast<std::uint32_t>(first);
+            swept += first;
+            return found;
+        }
+
+        // one bit a lane, lane 0 lowest
+        std::size_t write_hits(unsigned mask, std::size_t first, std::uint32_t* hits)
+        {
+            std::size_t found = 0;
+            for (; mask != 0; mask &= mask - 1)
+                hits[found++] = static_cast<std::uint32_t>(first + static_cast<std::size_t>(std::countr_zero(mask)));
+            return found;
+        }
+
+        constexpr Kernels KERNELS{ Level::Scalar, transform2, transform4, bounds, sweep };
+    }
+
+#if defined(MATH_KERNELS_X86)
+    namespace sse2
+    {
+        // two points a register, x0 y0 x1 y1, against the columns repeated the same way
+        MATH_KERNELS_TARGET("sse2") void transform2(const glm::mat3& transform, const glm::vec2* in, glm::vec2* out, std::size_t count)
+        {
+            const __m128 column0 = _mm_setr_ps(transform[0][0], transform[0][1], transform[0][0], transform[0][1]);
+            const __m128 column1 = _mm_setr_ps(transform[1][0], transform[1][1], transform[1][0], transform[1][1]);
+            const __m128 column2 = _mm_setr_ps(transform[2][0], transform[2][1], transform[2][0], transform[2][1]);
+            std::size_t  i       = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const __m128 points = _mm_loadu_ps(&in[i].x);
+                const __m128 xs     = _mm_shuffle_ps(points, points, _MM_SHUFFLE(2, 2, 0, 0));
+                const __m128 ys     = _mm_shuffle_ps(points, points, _MM_SHUFFLE(3, 3, 1, 1));
+                _mm_storeu_ps(&out[i].x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, column0), _mm_mul_ps(ys, column1)), column2));
+            }
+            scalar::transform2(transform, in + i, out + i, count - i);
+        }
+
+        MATH_KERNELS_TARGET("sse2") void transform4(const glm::mat4& transform, const glm::vec4* in, glm::vec4* out, std::size_t count)
+        {
+            const __m128 column0 = _mm_loadu_ps(&transform[0].x);
+            const __m128 column1 = _mm_loadu_ps(&transform[1].x);
+            const __m128 column2 = _mm_loadu_ps(&transform[2].x);
+            const __m128 column3 = _mm_loadu_ps(&transform[3].x);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const __m128 point = _mm_loadu_ps(&in[i].x);
+                const __m128 xy    = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(point, point, _MM_SHUFFLE(0, 0, 0, 0)), column0),
+                                                _mm_mul_ps(_mm_shuffle_ps(point, point, _MM_SHUFFLE(1, 1, 1, 1)), column1));
+                const __m128 zw    = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(point, point, _MM_SHUFFLE(2, 2, 2, 2)), column2),
+                                                _mm_mul_ps(_mm_shuffle_ps(point, point, _MM_SHUFFLE(3, 3, 3, 3)), column3));
+                _mm_storeu_ps(&out[i].x, _mm_add_ps(xy, zw));
+            }
+        }
+
+        MATH_KERNELS_TARGET("sse2") Aabb2 bounds(const glm::vec2* points, std::size_t count)
+        {
+            __m128      low  = _mm_set1_ps(EMPTY_BOUNDS.min.x);
+            __m128      high = _mm_set1_ps(EMPTY_BOUNDS.max.x);
+            std::size_t i    = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const __m128 pair = _mm_loadu_ps(&points[i].x);
+                low               = _mm_min_ps(low, pair);
+                high              = _mm_max_ps(high, pair);
+            }
+            // fold the two points' lanes onto the first two
+            low  = _mm_min_ps(low, _mm_movehl_ps(low, low));
+            high = _mm_max_ps(high, _mm_movehl_ps(high, high));
+            alignas(16) float lows[4];
+            alignas(16) float highs[4];
+            _mm_store_ps(lows, low);
+            _mm_store_ps(highs, high);
+            const Aabb2 tail = scalar::bounds(points + i, count - i);
+            return Aabb2{ glm::min(glm::vec2{ lows[0], lows[1] }, tail.min), glm::max(glm::vec2{ highs[0], highs[1] }, tail.max) };
+        }
+
+        // four boxes a register; sorted by min_x, the lanes still in reach are always the first few
+        MATH_KERNELS_TARGET("sse2") std::size_t sweep(const float* min_x, const float* min_y, const float* max_y, std::size_t count, const Aabb2& box, std::uint32_t* hits, std::size_t& swept)
+        {
+            const __m128 reach  = _mm_set1_ps(box.max.x);
+            const __m128 top    = _mm_set1_ps(box.max.y);
+            const __m128 bottom = _mm_set1_ps(box.min.y);
+            std::size_t  found  = 0;
+            std::size_t  i      = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const auto   in_reach  = static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(min_x + i), reach)));
+                const __m128 overlap_y = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(min_y + i), top), _mm_cmpge_ps(_mm_loadu_ps(max_y + i), bottom));
+                found += scalar::write_hits(static_cast<unsigned>(_mm_movemask_ps(overlap_y)) & in_reach, i, hits + found);
+                if (in_reach != 0xFu)
+                {
+                    swept = i + static_cast<std::size_t>(std::popcount(in_reach));
+                    return found;
+                }
+            }
+            return found + scalar::sweep_tail(min_x, min_y, max_y, i, count, box, hits + found, swept);
+        }
+
+        constexpr Kernels KERNELS{ Level::Sse2, transform2, transform4, bounds, sweep };
+    }
+#endif
+
+#if defined(MATH_KERNELS_NEON)
+    namespace neon
+    {
+        void transform2(const glm::mat3& transform, const glm::vec2* in, glm::vec2* out, std::size_t count)
+        {
+            const float32x4_t column0 = vcombine_f32(vld1_f32(&transform[0].x), vld1_f32(&transform[0].x));
+            const float32x4_t column1 = vcombine_f32(vld1_f32(&transform[1].x), vld1_f32(&transform[1].x));
+            const float32x4_t column2 = vcombine_f32(vld1_f32(&transform[2].x), vld1_f32(&transform[2].x));
+            std::size_t       i       = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const float32x4_t points = vld1q_f32(&in[i].x);
+                const float32x4_t xs     = vtrn1q_f32(points, points);
+                const float32x4_t ys     = vtrn2q_f32(points, points);
+                vst1q_f32(&out[i].x, vmlaq_f32(vmlaq_f32(column2, xs, column0), ys, column1));
+            }
+            scalar::transform2(transform, in + i, out + i, count - i);
+        }
+
+        void transform4(const glm::mat4& transform, const glm::vec4* in, glm::vec4* out, std::size_t count)
+        {
+            const float32x4_t column0 = vld1q_f32(&transform[0].x);
+            const float32x4_t column1 = vld1q_f32(&transform[1].x);
+            const float32x4_t column2 = vld1q_f32(&transform[2].x);
+            const float32x4_t column3 = vld1q_f32(&transform[3].x);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const float32x4_t point = vld1q_f32(&in[i].x);
+                float32x4_t       sum   = vmulq_laneq_f32(column0, point, 0);
+                sum                     = vfmaq_laneq_f32(sum, column1, point, 1);
+                sum                     = vfmaq_laneq_f32(sum, column2, point, 2);
+                sum                     = vfmaq_laneq_f32(sum, column3, point, 3);
+                vst1q_f32(&out[i].x, sum);
+            }
+        }
+
+        Aabb2 bounds(const glm::vec2* points, std::size_t count)
+        {
+            float32x4_t low  = vdupq_n_f32(EMPTY_BOUNDS.min.x);
+            float32x4_t high = vdupq_n_f32(EMPTY_BOUNDS.max.x);
+            std::size_t i    = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const float32x4_t pair = vld1q_f32(&points[i].x);
+                low                    = vminq_f32(low, pair);
+                high                   = vmaxq_f32(high, pair);
+            }
+            const float32x2_t low2  = vmin_f32(vget_low_f32(low), vget_high_f32(low));
+            const float32x2_t high2 = vmax_f32(vget_low_f32(high), vget_high_f32(high));
+            const Aabb2       tail  = scalar::bounds(points + i, count - i);
+            return Aabb2{ glm::min(glm::vec2{ vget_lane_f32(low2, 0), vget_lane_f32(low2, 1) }, tail.min),
+                          glm::max(glm::vec2{ vget_lane_f32(high2, 0), vget_lane_f32(high2, 1) }, tail.max) };
+        }
+
+        std::size_t sweep(const float* min_x, const float* min_y, const float* max_y, std::size_t count, const Aabb2& box, std::uint32_t* hits, std::size_t& swept)
+        {
+            static constexpr std::uint32_t LANE_BITS[4] = { 1u, 2u, 4u, 8u };
+            const uint32x4_t               lane_bits    = vld1q_u32(LANE_BITS);
+            const float32x4_t              reach        = vdupq_n_f32(box.max.x);
+            const float32x4_t              top          = vdupq_n_f32(box.max.y);
+            const float32x4_t              bottom       = vdupq_n_f32(box.min.y);
+            std::size_t                    found        = 0;
+            std::size_t                    i            = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const uint32x4_t reach_lanes = vcleq_f32(vld1q_f32(min_x + i), reach);
+                const uint32x4_t overlap_y   = vandq_u32(vcleq_f32(vld1q_f32(min_y + i), top), vcgeq_f32(vld1q_f32(max_y + i), bottom));
+                const unsigned   in_reach    = vaddvq_u32(vandq_u32(reach_lanes, lane_bits));
+                found += scalar::write_hits(vaddvq_u32(vandq_u32(vandq_u32(overlap_y, reach_lanes), lane_bits)), i, hits + found);
+                if (in_reach != 0xFu)
+                {
+                    swept = i + static_cast<std::size_t>(std::popcount(in_reach));
+                    return found;
+                }
+            }
+            return found + scalar::sweep_tail(min_x, min_y, max_y, i, count, box, hits + found, swept);
+        }
+
+        constexpr Kernels KERNELS{ Level::Neon, transform2, transform4, bounds, sweep };
+    }
+#endif
+
+#if defined(MATH_KERNELS_WASM)
+    namespace wasm
+    {
+        void transform2(const glm::mat3& transform, const glm::vec2* in, glm::vec2* out, std::size_t count)
+        {
+            const v128_t column0 = wasm_f32x4_make(transform[0][0], transform[0][1], transform[0][0], transform[0][1]);
+            const v128_t column1 = wasm_f32x4_make(transform[1][0], transform[1][1], transform[1][0], transform[1][1]);
+            const v128_t column2 = wasm_f32x4_make(transform[2][0], transform[2][1], transform[2][0], transform[2][1]);
+            std::size_t  i       = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const v128_t points = wasm_v128_load(&in[i].x);
+                const v128_t xs     = wasm_i32x4_shuffle(points, points, 0, 0, 2, 2);
+                const v128_t ys     = wasm_i32x4_shuffle(points, points, 1, 1, 3, 3);
+                wasm_v128_store(&out[i].x, wasm_f32x4_add(wasm_f32x4_add(wasm_f32x4_mul(xs, column0), wasm_f32x4_mul(ys, column1)), column2));
+            }
+            scalar::transform2(transform, in + i, out + i, count - i);
+        }
+
+        void transform4(const glm::mat4& transform, const glm::vec4* in, glm::vec4* out, std::size_t count)
+        {
+            const v128_t column0 = wasm_v128_load(&transform[0].x);
+            const v128_t column1 = wasm_v128_load(&transform[1].x);
+            const v128_t column2 = wasm_v128_load(&transform[2].x);
+            const v128_t column3 = wasm_v128_load(&transform[3].x);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const v128_t point = wasm_v128_load(&in[i].x);
+                const v128_t xy    = wasm_f32x4_add(wasm_f32x4_mul(wasm_i32x4_shuffle(point, point, 0, 0, 0, 0), column0),
+                                                    wasm_f32x4_mul(wasm_i32x4_shuffle(point, point, 1, 1, 1, 1), column1));
+                const v128_t zw    = wasm_f32x4_add(wasm_f32x4_mul(wasm_i32x4_shuffle(point, point, 2, 2, 2, 2), column2),
+                                                    wasm_f32x4_mul(wasm_i32x4_shuffle(point, point, 3, 3, 3, 3), column3));
+                wasm_v128_store(&out[i].x, wasm_f32x4_add(xy, zw));
+            }
+        }
+
+        Aabb2 bounds(const glm::vec2* points, std::size_t count)
+        {
+            v128_t      low  = wasm_f32x4_splat(EMPTY_BOUNDS.min.x);
+            v128_t      high = wasm_f32x4_splat(EMPTY_BOUNDS.max.x);
+            std::size_t i    = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const v128_t pair = wasm_v128_load(&points[i].x);
+                low               = wasm_f32x4_pmin(low, pair);
+                high              = wasm_f32x4_pmax(high, pair);
+            }
+            const Aabb2     tail = scalar::bounds(points + i, count - i);
+            const glm::vec2 low2{ std::min(wasm_f32x4_extract_lane(low, 0), wasm_f32x4_extract_lane(low, 2)),
+                                  std::min(wasm_f32x4_extract_lane(low, 1), wasm_f32x4_extract_lane(low, 3)) };
+            const glm::vec2 high2{ std::max(wasm_f32x4_extract_lane(high, 0), wasm_f32x4_extract_lane(high, 2)),
+                                   std::max(wasm_f32x4_extract_lane(high, 1), wasm_f32x4_extract_lane(high, 3)) };
+            return Aabb2{ glm::min(low2, tail.min), glm::max(high2, tail.max) };
+        }
+
+        std::size_t sweep(const float* min_x, const float* min_y, const float* max_y, std::size_t count, const Aabb2& box, std::uint32_t* hits, std::size_t& swept)
+        {
+            const v128_t reach  = wasm_f32x4_splat(box.max.x);
+            const v128_t top    = wasm_f32x4_splat(box.max.y);
+            const v128_t bottom = wasm_f32x4_splat(box.min.y);
+            std::size_t  found  = 0;
+            std::size_t  i      = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const auto   in_reach  = static_cast<unsigned>(wasm_i32x4_bitmask(wasm_f32x4_le(wasm_v128_load(min_x + i), reach)));
+                const v128_t overlap_y = wasm_v128_and(wasm_f32x4_le(wasm_v128_load(min_y + i), top), wasm_f32x4_ge(wasm_v128_load(max_y + i), bottom));
+                found += scalar::write_hits(static_cast<unsigned>(wasm_i32x4_bitmask(overlap_y)) & in_reach, i, hits + found);
+                if (in_reach != 0xFu)
+                {
+                    swept = i + static_cast<std::size_t>(std::popcount(in_reach));
+                    return found;
+                }
+            }
+            return found + scalar::sweep_tail(min_x, min_y, max_y, i, count, box, hits + found, swept);
+        }
+
+        constexpr Kernels KERNELS{ Level::Wasm, transform2, transform4, bounds, sweep };
+    }
+#endif
+
+    // null when the build has no such kernels
+    const Kernels* compiled_kernels(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Scalar: return &scalar::KERNELS;
+#if defined(MATH_KERNELS_X86)
+            case Level::Sse2: return &sse2::KERNELS;
+#endif
+#if defined(MATH_KERNELS_NEON)
+            case Level::Neon: return &neon::KERNELS;
+#endif
+#if defined(MATH_KERNELS_WASM)
+            case Level::Wasm: return &wasm::KERNELS;
+#endif
+            default: return nullptr;
+        }
+    }
+
+    bool cpu_runs(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Sse2: return SDL_HasSSE2() == SDL_TRUE;
+            case Level::Neon: return SDL_HasNEON() == SDL_TRUE;
+            // a browser without SIMD refuses the whole module, so getting here means it has it
+            default: return true;
+        }
+    }
+
+    const Kernels& best_kernels() noexcept
+    {
+        for (const Level level : { Level::Sse2, Level::Neon, Level::Wasm })
+        {
+            if (math_kernels::IsAvailable(level))
+                return *compiled_kernels(level);
+        }
+        return scalar::KERNELS;
+    }
+
+    // picking twice on a race is harmless, both threads land on the same table
+    std::atomic<const Kernels*> active{ nullptr };
+
+    const Kernels& kernels() noexcept
+    {
+        const Kernels* current = active.load(std::memory_order_acquire);
+        if (current == nullptr)
+        {
+            current = &best_kernels();
+            active.store(current, std::memory_order_release);
+        }
+        return *current;
+    }
+}
+
+namespace math_kernels
+{
+    bool IsAvailable(Level level) noexcept
+    {
+        return compiled_kernels(level) != nullptr && cpu_runs(level);
+    }
+
+    Level ActiveLevel() noexcept
+    {
+        return kernels().level;
+    }
+
+    bool SetLevel(Level level) noexcept
+    {
+        if (!IsAvailable(level))
+            return false;
+        active.store(compiled_kernels(level), std::memory_order_release);
+        return true;
+    }
+
+    const char* LevelName(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Scalar: return "scalar";
+            case Level::Sse2: return "sse2";
+            case Level::Neon: return "neon";
+            case Level::Wasm: return "wasm simd";
+        }
+        return "unknown";
+    }
+
+    void TransformPoints(const glm::mat3& transform, const glm::vec2* in, glm::vec2* out, std::size_t count) noexcept
+    {
+        kernels().transform2(transform, in, out, count);
+    }
+
+    void TransformPoints(const glm::mat4& transform, const glm::vec4* in, glm::vec4* out, std::size_t count) noexcept
+    {
+        kernels().transform4(transform, in, out, count);
+    }
+
+    Aabb2 Bounds(const glm::vec2* points, std::size_t count) noexcept
+    {
+        return kernels().bounds(points, count);
+    }
+
+    std::size_t SweepOverlaps(const float* min_x, const float* min_y, const float* max_y, std::size_t count, const Aabb2& box, std::uint32_t* hits,
+                              std::size_t& swept) noexcept
+    {
+        return kernels().sweep(min_x, min_y, max_y, count, box, hits, swept);
+    }
+}
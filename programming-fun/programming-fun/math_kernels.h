@@ -0,0 +1,62 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+struct Aabb2
+{
+    glm::vec2 min{ 0.0f };
+    glm::vec2 max{ 0.0f };
+};
+
+/**
+ * Batch math for the packers and the broadphase: many points through one matrix, the box around many points,
+ * and which of many boxes a box overlaps.
+ *
+ * Like audio_kernels, each kernel has a scalar version and, where the build targets them, SSE2 (x86),
+ * NEON (ARM) or wasm SIMD versions, picked on the first call and swapped by SetLevel for benchmarks.
+ * They match glm up to float rounding. This is independent of glm's own SIMD, which stays off unless
+ * the build opts in (GLM_FORCE_INTRINSICS and GLM_FORCE_DEFAULT_ALIGNED_GENTYPES, /p:GlmSimd=true on the
+ * Visual Studio project): that makes vec4 and mat4 math use intrinsics one value at a time, while these
+ * run across the arrays either way. `in` and `out` may be the same array, but not otherwise overlap.
+ */
+namespace math_kernels
+{
+    enum class Level
+    {
+        Scalar,
+        Sse2,
+        Neon,
+        Wasm
+    };
+
+    // Whether this build has `level` and the CPU can run it
+    bool        IsAvailable(Level level) noexcept;
+    Level       ActiveLevel() noexcept;
+    // For benchmarks; false, and nothing changes, when `level` isn't available
+    bool        SetLevel(Level level) noexcept;
+    const char* LevelName(Level level) noexcept;
+
+    // 2D affine: out = (transform * vec3{ in, 1 }).xy; the bottom row is never read
+    void        TransformPoints(const glm::mat3& transform, const glm::vec2* in, glm::vec2* out, std::size_t count) noexcept;
+    // out = transform * in, w and all
+    void        TransformPoints(const glm::mat4& transform, const glm::vec4* in, glm::vec4* out, std::size_t count) noexcept;
+    // The smallest box holding every point; min above max when `count` is 0
+    Aabb2       Bounds(const glm::vec2* points, std::size_t count) noexcept;
+    // Boxes as columns sorted by min_x, swept from the first up to the first whose min_x is past box.max.x: the
+    // indices of those whose y span meets box's go into `hits`, which needs room for `count`. Returns how many
+    // hit; `swept` gets how many were looked at. Touching counts as overlapping.
+    std::size_t SweepOverlaps(const float* min_x, const float* min_y, const float* max_y, std::size_t count, const Aabb2& box, std::uint32_t* hits,
+                              std::size_t& swept) noexcept;
+}
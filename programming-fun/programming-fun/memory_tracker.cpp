@@ -0,0 +1,295 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "memory_tracker.h"
+
+#include "allocation_counter.h"
+#include "imgui_panels.h"
+#include "logger.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <imgui.h>
+#include <string>
+
+namespace
+{
+    constexpr std::size_t CATEGORY_COUNT = static_cast<std::size_t>(MemoryCategory::Count);
+
+    struct Counters
+    {
+        std::atomic<std::size_t> current{ 0 };
+        std::atomic<std::size_t> peak{ 0 };
+        std::atomic<std::size_t> allocations{ 0 };
+    };
+
+    std::array<Counters, CATEGORY_COUNT> gCounters;
+
+    Counters& counters_for(MemoryCategory category) noexcept
+    {
+        return gCounters[static_cast<std::size_t>(category)];
+    }
+
+    void raise_peak(Counters& counters, std::size_t value) noexcept
+    {
+        std::size_t peak = counters.peak.load(std::memory_order_relaxed);
+        while (value > peak && !counters.peak.compare_exchange_weak(peak, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Tracy keys plots by the name pointer, so each category gets its own literal
+    void plot_current(MemoryCategory category, std::size_t current) noexcept
+    {
+#if PROFILER_TRACY
+        switch (category)
+        {
+            case MemoryCategory::Textures: TracyPlot("Memory textures", static_cast<int64_t>(current)); break;
+            case MemoryCategory::Audio: TracyPlot("Memory audio", static_cast<int64_t>(current)); break;
+            case MemoryCategory::ImGui: TracyPlot("Memory imgui", static_cast<int64_t>(current)); break;
+            case MemoryCategory::Arenas: TracyPlot("Memory arenas", static_cast<int64_t>(current)); break;
+            case MemoryCategory::Geometry: TracyPlot("Memory geometry", static_cast<int64_t>(current)); break;
+            case MemoryCategory::Count: break;
+        }
+#else
+        (void)category;
+        (void)current;
+#endif
+    }
+
+    // ImGui hands back only the pointer, so the size rides in front of the block
+    struct alignas(16) ImGuiBlockHeader
+    {
+        std::size_t bytes;
+    };
+
+    void* imgui_alloc(std::size_t bytes, void*)
+    {
+        auto* header = static_cast<ImGuiBlockHeader*>(std::malloc(sizeof(ImGuiBlockHeader) + bytes));
+        if (header == nullptr)
+            return nullptr;
+        header->bytes = bytes;
+        memory_tracker::Allocate(MemoryCategory::ImGui, bytes);
+        allocation_counter::Count(bytes);
+#if PROFILER_TRACY
+        TracyAllocN(header + 1, bytes, "ImGui");
+#endif
+        return header + 1;
+    }
+
+    void imgui_free(void* pointer, void*)
+    {
+        if (pointer == nullptr)
+            return;
+#if PROFILER_TRACY
+        TracyFreeN(pointer, "ImGui");
+#endif
+        auto* header = static_cast<ImGuiBlockHeader*>(pointer) - 1;
+        memory_tracker::Free(MemoryCategory::ImGui, header->bytes);
+        std::free(header);
+    }
+
+    struct BlockFormat
+    {
+        GLenum      internal_format;
+        std::size_t bytes; // per 4x4 block
+    };
+
+    // the compressed formats texture_loader can upload
+    constexpr BlockFormat BLOCK_FORMATS[] = {
+        { 0x83F1, 8 },  // BC1
+        { 0x83F3, 16 }, // BC3
+        { 0x8E8C, 16 }, // BC7
+        { 0x9278, 16 }, // ETC2 RGBA8
+        { 0x93B0, 16 }, // ASTC 4x4
+    };
+
+    std::size_t block_bytes(GLenum internal_format) noexcept
+    {
+        for (const BlockFormat& format : BLOCK_FORMATS)
+        {
+            if (format.internal_format == internal_format)
+                return format.bytes;
+        }
+        return 0;
+    }
+
+    std::size_t pixel_bytes(GLenum internal_format) noexcept
+    {
+        switch (internal_format)
+        {
+            case GL_R8: return 1;
+            case GL_RG8: return 2;
+            case GL_R16F: return 2;
+            case GL_RGB16F: return 8; // padded like RGB8
+            case GL_RGBA16F: return 8;
+            case GL_RGBA32F: return 16;
+            default: return 4; // RGBA8, RG16F and RGB8, which drivers pad to four bytes
+        }
+    }
+
+    std::string format_kilobytes(std::size_t bytes)
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.1f KB", static_cast<double>(bytes) / 1024.0);
+        return text;
+    }
+}
+
+namespace memory_tracker
+{
+    void Allocate(MemoryCategory category, std::size_t bytes) noexcept
+    {
+        Counters&         counters = counters_for(category);
+        const std::size_t current  = counters.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        raise_peak(counters, current);
+        plot_current(category, current);
+    }
+
+    void Free(MemoryCategory category, std::size_t bytes) noexcept
+    {
+        Counters&         counters = counters_for(category);
+        const std::size_t current  = counters.current.fetch_sub(bytes, std::memory_order_relaxed) - bytes;
+        counters.allocations.fetch_sub(1, std::memory_order_relaxed);
+        plot_current(category, current);
+    }
+
+    void Set(MemoryCategory category, std::size_t bytes) noexcept
+    {
+        Counters& counters = counters_for(category);
+        counters.current.store(bytes, std::memory_order_relaxed);
+        counters.allocations.store(bytes > 0 ? 1 : 0, std::memory_order_relaxed);
+        raise_peak(counters, bytes);
+        plot_current(category, bytes);
+    }
+
+    CategoryStats GetStats(MemoryCategory category) noexcept
+    {
+        const Counters& counters = counters_for(category);
+        CategoryStats   stats;
+        stats.current_bytes = counters.current.load(std::memory_order_relaxed);
+        stats.peak_bytes    = counters.peak.load(std::memory_order_relaxed);
+        stats.allocations   = counters.allocations.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    const char* CategoryName(MemoryCategory category) noexcept
+    {
+        switch (category)
+        {
+            case MemoryCategory::Textures: return "textures";
+            case MemoryCategory::Audio: return "audio";
+            case MemoryCategory::ImGui: return "imgui";
+            case MemoryCategory::Arenas: return "arenas";
+            case MemoryCategory::Geometry: return "geometry";
+            case MemoryCategory::Count: break;
+        }
+        return "?";
+    }
+
+    std::size_t EstimateTextureBytes(GLenum internal_format, int width, int height, int levels) noexcept
+    {
+        const std::size_t block = block_bytes(internal_format);
+        std::size_t       total = 0;
+        for (int level = 0; level < std::max(levels, 1); ++level)
+        {
+            const auto w = static_cast<std::size_t>(std::max(1, width >> level));
+            const auto h = static_cast<std::size_t>(std::max(1, height >> level));
+            total += block != 0 ? ((w + 3) / 4) * ((h + 3) / 4) * block : w * h * pixel_bytes(internal_format);
+        }
+        return total;
+    }
+
+    void InstallImGuiAllocator()
+    {
+        ImGui::SetAllocatorFunctions(imgui_alloc, imgui_free);
+    }
+
+    bool WriteSnapshot(const std::filesystem::path& filename)
+    {
+        std::ofstream out{ filename };
+        if (!out)
+        {
+            LOG_ERROR("Failed to write memory snapshot ", filename);
+            return false;
+        }
+        out << "category,current_bytes,peak_bytes,allocations\n";
+        CategoryStats total;
+        for (std::size_t i = 0; i < CATEGORY_COUNT; ++i)
+        {
+            const auto          category = static_cast<MemoryCategory>(i);
+            const CategoryStats stats    = GetStats(category);
+            out << CategoryName(category) << ',' << stats.current_bytes << ',' << stats.peak_bytes << ',' << stats.allocations << '\n';
+            total.current_bytes += stats.current_bytes;
+            total.peak_bytes += stats.peak_bytes;
+            total.allocations += stats.allocations;
+        }
+        out << "total," << total.current_bytes << ',' << total.peak_bytes << ',' << total.allocations << '\n';
+        return static_cast<bool>(out);
+    }
+
+    void DrawImGui()
+    {
+        static std::string snapshot_status;
+
+        if (!imgui_panels::Begin("Memory", 4.0f))
+        {
+            imgui_panels::End();
+            return;
+        }
+        if (ImGui::BeginTable("categories", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+        {
+            ImGui::TableSetupColumn("category");
+            ImGui::TableSetupColumn("current");
+            ImGui::TableSetupColumn("peak");
+            ImGui::TableSetupColumn("blocks");
+            ImGui::TableHeadersRow();
+            CategoryStats total;
+            for (std::size_t i = 0; i < CATEGORY_COUNT; ++i)
+            {
+                const auto          category = static_cast<MemoryCategory>(i);
+                const CategoryStats stats    = GetStats(category);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(CategoryName(category));
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(format_kilobytes(stats.current_bytes).c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(format_kilobytes(stats.peak_bytes).c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", stats.allocations);
+                total.current_bytes += stats.current_bytes;
+                total.peak_bytes += stats.peak_bytes;
+            }
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted("total");
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(format_kilobytes(total.current_bytes).c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(format_kilobytes(total.peak_bytes).c_str()); // sum of peaks, an upper bound
+            ImGui::EndTable();
+        }
+        if (ImGui::Button("Save Snapshot"))
+        {
+            const std::filesystem::path filename = "memory-snapshot.csv";
+            snapshot_status                      = WriteSnapshot(filename) ? "wrote " + std::filesystem::absolute(filename).string() : "failed to write " + filename.string();
+        }
+        if (!snapshot_status.empty())
+        {
+            ImGui::SameLine();
+            ImGui::TextUnformatted(snapshot_status.c_str());
+        }
+        imgui_panels::End();
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <filesystem>
+
+enum class MemoryCategory
+{
+    Textures, // estimated VRAM
+    Audio,    // PCM held by OpenAL buffers
+    ImGui,    // ImGui's heap, counted by its allocator hook
+    Arenas,   // frame arenas and decode scratch, reported as what they reserve
+    Geometry, // static vertex and index buffers
+    Count
+};
+
+/**
+ * Running totals of where the memory goes, by category.
+ *
+ * Owners report their own allocations (allocation_counter counts every operator new, but not by owner), so the
+ * numbers only cover what is tagged: every texture the loader or an atlas makes, every sound cache and stream
+ * buffer, ImGui's allocations and the arenas. Thread safe; workers can report too.
+ */
+namespace memory_tracker
+{
+    struct CategoryStats
+    {
+        std::size_t current_bytes = 0;
+        std::size_t peak_bytes    = 0;
+        std::size_t allocations   = 0; // live
+    };
+
+    void Allocate(MemoryCategory category, std::size_t bytes) noexcept;
+    void Free(MemoryCategory category, std::size_t bytes) noexcept;
+    // For pools that report their whole reserve once per frame instead of individual blocks
+    void Set(MemoryCategory category, std::size_t bytes) noexcept;
+
+    CategoryStats GetStats(MemoryCategory category) noexcept;
+    const char*   CategoryName(MemoryCategory category) noexcept;
+
+    // What the driver most likely holds for a 2D texture with `levels` mip levels; drivers pad, so treat it as a floor
+    std::size_t EstimateTextureBytes(GLenum internal_format, int width, int height, int levels) noexcept;
+
+    // Routes ImGui's heap through the tracker; call before ImGui::CreateContext
+    void InstallImGuiAllocator();
+
+    // CSV with one row per category and a total, for diffing runs against each other
+    bool WriteSnapshot(const std::filesystem::path& filename);
+
+    void DrawImGui();
+}
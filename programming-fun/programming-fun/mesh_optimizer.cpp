@@ -0,0 +1,635 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <glm/geometric.hpp>
+
+namespace
+{
+    // Forsyth's constants, from "Linear-Speed Vertex Cache Optimisation"
+    constexpr int   SCORE_CACHE_SIZE    = 2 * static_cast<int>(mesh_optimizer::CACHE_SIZE);
+    constexpr float CACHE_DECAY_POWER   = 1.5f;
+    constexpr float LAST_TRIANGLE       = 0.75f;
+    constexpr float VALENCE_BOOST       = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+    float vertex_score(int cache_position, std::uint32_t remaining) noexcept
+    {
+        if (remaining == 0)
+            return -1.0f;
+        float score = 0.0f;
+        if (cache_position >= 0)
+        {
+            // the last triangle's three score the same, so it doesn't matter which order they went in
+            if (cache_position < 3)
+                score = LAST_TRIANGLE;
+            else
+                score = std::pow(1.0f - static_cast<float>(cache_position - 3) / static_cast<float>(SCORE_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        // vertices with few triangles left get them done, so they leave the cache for good
+        return score + VALENCE_BOOST * std::pow(static_cast<float>(remaining), -VALENCE_BOOST_POWER);
+    }
+
+    // the triangles around each vertex, as offsets into one list
+    struct Adjacency
+    {
+        std::vector<std::uint32_t> offsets; // vertex_count + 1
+        std::vector<std::uint32_t> counts;  // still to emit
+        std::vector<std::uint32_t> triangles;
+    };
+
+    Adjacency build_adjacency(std::span<const std::uint32_t> indices, std::size_t vertex_count)
+    {
+        Adjacency adjacency;
+        adjacency.counts.assign(vertex_count, 0);
+        for (const std::uint32_t index : indices)
+            ++adjacency.counts[index];
+        adjacency.offsets.resize(vertex_count + 1);
+        adjacency.offsets[0] = 0;
+        for (std::size_t v = 0; v < vertex_count; ++v)
+            adjacency.offsets[v + 1] = adjacency.offsets[v] + adjacency.counts[v];
+        adjacency.triangles.resize(indices.size());
+        std::vector<std::uint32_t> filled(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+        for (std::size_t i = 0; i < indices.size(); ++i)
+            adjacency.triangles[filled[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+        return adjacency;
+    }
+
+    // a FIFO told by timestamps: a vertex is in it while fewer than cache_size misses came after its own
+    unsigned update_fifo(const std::uint32_t* triangle, std::vector<std::uint32_t>& stamps, std::uint32_t& timestamp, unsigned cache_size) noexcept
+    {
+        unsigned misses = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const std::uint32_t vertex = triangle[k];
+            if (timestamp - stamps[vertex] > cache_size)
+            {
+                stamps[vertex] = timestamp++;
+                ++misses;
+            }
+        }
+        return misses;
+    }
+
+    std::size_t vertex_count_of(std::span<const std::uint32_t> indices) noexcept
+    {
+        return indices.empty() ? 0 : static_cast<std::size_t>(*std::max_element(indices.begin(), indices.end())) + 1;
+    }
+
+    constexpr double BORDER_WEIGHT = 10.0; // how much more an open edge's plane counts than the faces'
+
+    // planes summed as a symmetric 4x4, so one evaluation is the weighted squared distance to all of them
+    struct Quadric
+    {
+        double a00 = 0.0, a11 = 0.0, a22 = 0.0, a01 = 0.0, a12 = 0.0, a02 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0, c = 0.0;
+        double weight = 0.0;
+
+        void AddPlane(const glm::dvec3& normal, double distance, double plane_weight) noexcept
+        {
+            a00 += plane_weight * normal.x * normal.x;
+            a11 += plane_weight * normal.y * normal.y;
+            a22 += plane_weight * normal.z * normal.z;
+            a01 += plane_weight * normal.x * normal.y;
+            a12 += plane_weight * normal.y * normal.z;
+            a02 += plane_weight * normal.x * normal.z;
+            b0 += plane_weight * normal.x * distance;
+            b1 += plane_weight * normal.y * distance;
+            b2 += plane_weight * normal.z * distance;
+            c += plane_weight * distance * distance;
+            weight += plane_weight;
+        }
+
+        Quadric& operator+=(const Quadric& other) noexcept
+        {
+            a00 += other.a00, a11 += other.a11, a22 += other.a22, a01 += other.a01, a12 += other.a12, a02 += other.a02;
+            b0 += other.b0, b1 += other.b1, b2 += other.b2, c += other.c, weight += other.weight;
+            return *this;
+        }
+
+        // the squared distance, averaged over the planes' weights
+        double Error(const glm::vec3& point) const noexcept
+        {
+            const double x = point.x, y = point.y, z = point.z;
+            const double sum = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a12 * y * z + a02 * x * z) + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+            return weight > 0.0 ? std::max(sum, 0.0) / weight : 0.0;
+        }
+    };
+
+    // each vertex's first vertex at exactly the same position; the others there differ in color or the like
+    std::vector<std::uint32_t> position_owners(std::span<const glm::vec3> positions)
+    {
+        std::vector<std::uint32_t> order(positions.size());
+        for (std::size_t v = 0; v < positions.size(); ++v)
+            order[v] = static_cast<std::uint32_t>(v);
+        const auto less = [&positions](std::uint32_t a, std::uint32_t b)
+        {
+            const glm::vec3& p = positions[a];
+            const glm::vec3& q = positions[b];
+            return p.x != q.x ? p.x < q.x : p.y != q.y ? p.y < q.y : p.z != q.z ? p.z < q.z : a < b;
+        };
+        std::sort(order.begin(), order.end(), less);
+        std::vector<std::uint32_t> owners(positions.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+            owners[order[i]] = i > 0 && positions[order[i]] == positions[order[i - 1]] ? owners[order[i - 1]] : order[i];
+        return owners;
+    }
+
+    // how many triangles share each corner's edge to the next corner, counting positions rather than vertices
+    std::vector<std::uint8_t> count_edges(std::span<const std::uint32_t> corners)
+    {
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> edges(corners.size());
+        for (std::size_t i = 0; i < corners.size(); ++i)
+        {
+            const std::uint32_t a = corners[i];
+            const std::uint32_t b = corners[i - i % 3 + (i + 1) % 3];
+            edges[i]              = { (static_cast<std::uint64_t>(std::min(a, b)) << 32) | std::max(a, b), static_cast<std::uint32_t>(i) };
+        }
+        std::sort(edges.begin(), edges.end());
+        std::vector<std::uint8_t> counts(corners.size());
+        for (std::size_t run = 0; run < edges.size();)
+        {
+            std::size_t end = run + 1;
+            while (end < edges.size() && edges[end].first == edges[run].first)
+                ++end;
+            for (std::size_t i = run; i < end; ++i)
+                counts[edges[i].second] = static_cast<std::uint8_t>(std::min<std::size_t>(end - run, 255));
+            run = end;
+        }
+        return counts;
+    }
+
+    // drops the triangles with two corners at one position; returns how many indices are left
+    std::size_t compact_triangles(std::span<std::uint32_t> indices, std::span<const std::uint32_t> remap, std::span<const std::uint32_t> owners) noexcept
+    {
+        std::size_t written = 0;
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const std::uint32_t a = remap[indices[i]];
+            const std::uint32_t b = remap[indices[i + 1]];
+            const std::uint32_t c = remap[indices[i + 2]];
+            if (owners[a] == owners[b] || owners[b] == owners[c] || owners[a] == owners[c])
+                continue;
+            indices[written++] = a;
+            indices[written++] = b;
+            indices[written++] = c;
+        }
+        return written;
+    }
+}
+
+namespace mesh_optimizer
+{
+    VertexCacheStats AnalyzeVertexCache(std::span<const std::uint32_t> indices, std::size_t vertex_count, unsigned cache_size)
+    {
+        VertexCacheStats result;
+        if (indices.size() < 3)
+            return result;
+        std::vector<std::uint32_t> stamps(vertex_count, 0);
+        std::vector<bool>          used(vertex_count, false);
+        std::uint32_t              timestamp = cache_size + 1;
+        std::size_t                misses    = 0;
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+            misses += update_fifo(&indices[i], stamps, timestamp, cache_size);
+        for (const std::uint32_t index : indices)
+            used[index] = true;
+        const auto unique = static_cast<std::size_t>(std::count(used.begin(), used.end(), true));
+        result.acmr       = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+        result.atvr       = static_cast<float>(misses) / static_cast<float>(std::max<std::size_t>(unique, 1));
+        return result;
+    }
+
+    VertexFetchStats AnalyzeVertexFetch(std::span<const std::uint32_t> indices, std::size_t vertex_count, std::size_t vertex_bytes)
+    {
+        VertexFetchStats result;
+        if (indices.size() < 3 || vertex_bytes == 0)
+            return result;
+        std::vector<std::uint32_t> stamps(vertex_count, 0);
+        std::vector<bool>          used(vertex_count, false);
+        std::uint32_t              timestamp = CACHE_SIZE + 1;
+        // the fetch cache, as a FIFO of lines told by timestamps too
+        const std::size_t          line_count = (vertex_count * vertex_bytes + FETCH_LINE_BYTES - 1) / FETCH_LINE_BYTES;
+        std::vector<std::uint32_t> line_stamps(line_count, 0);
+        std::uint32_t              line_time = FETCH_LINES + 1;
+        std::size_t                fetched   = 0;
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const std::uint32_t vertex = indices[i + static_cast<std::size_t>(k)];
+                used[vertex]               = true;
+                if (timestamp - stamps[vertex] <= CACHE_SIZE)
+                    continue;
+                stamps[vertex] = timestamp++;
+                const std::size_t first = vertex * vertex_bytes / FETCH_LINE_BYTES;
+                const std::size_t last  = ((vertex + 1) * vertex_bytes - 1) / FETCH_LINE_BYTES;
+                for (std::size_t line = first; line <= last; ++line)
+                {
+                    if (line_time - line_stamps[line] > FETCH_LINES)
+                    {
+                        line_stamps[line] = line_time++;
+                        fetched += FETCH_LINE_BYTES;
+                    }
+                }
+            }
+        }
+        const auto unique = static_cast<std::size_t>(std::count(used.begin(), used.end(), true));
+        result.overfetch  = static_cast<float>(fetched) / static_cast<float>(std::max<std::size_t>(unique * vertex_bytes, 1));
+        return result;
+    }
+
+    void OptimizeVertexCache(std::span<std::uint32_t> indices, std::size_t vertex_count)
+    {
+        const std::size_t triangle_count = indices.size() / 3;
+        if (triangle_count < 2)
+            return;
+        Adjacency adjacency = build_adjacency(indices, vertex_count);
+
+        std::vector<int>   cache_positions(vertex_count, -1);
+        std::vector<float> vertex_scores(vertex_count);
+        for (std::size_t v = 0; v < vertex_count; ++v)
+            vertex_scores[v] = vertex_score(-1, adjacency.counts[v]);
+        std::vector<float> triangle_scores(triangle_count);
+        for (std::size_t t = 0; t < triangle_count; ++t)
+            triangle_scores[t] = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+        std::vector<bool> emitted(triangle_count, false);
+
+        std::vector<std::uint32_t>                      result;
+        std::array<std::uint32_t, SCORE_CACHE_SIZE + 3> cache{};
+        std::array<std::uint32_t, SCORE_CACHE_SIZE + 3> next_cache{};
+        std::size_t                                     cache_count = 0;
+        std::size_t                                     cursor      = 0; // the next triangle in input order, for when the cache has nothing to offer
+        std::uint32_t                                   best        = 0;
+        float                                           best_score  = -1.0f;
+        result.reserve(indices.size());
+        for (std::size_t t = 0; t < triangle_count; ++t)
+        {
+            if (triangle_scores[t] > best_score)
+            {
+                best       = static_cast<std::uint32_t>(t);
+                best_score = triangle_scores[t];
+            }
+        }
+
+        for (std::size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count)
+        {
+            if (best_score < 0.0f)
+            {
+                while (emitted[cursor])
+                    ++cursor;
+                best = static_cast<std::uint32_t>(cursor);
+            }
+            const std::uint32_t* triangle = &indices[static_cast<std::size_t>(best) * 3];
+            result.insert(result.end(), triangle, triangle + 3);
+            emitted[best] = true;
+
+            // the triangle leaves its vertices' lists
+            for (int k = 0; k < 3; ++k)
+            {
+                const std::uint32_t vertex = triangle[k];
+                std::uint32_t*      first  = &adjacency.triangles[adjacency.offsets[vertex]];
+                std::uint32_t*      last   = first + adjacency.counts[vertex];
+                *std::find(first, last, best) = *(last - 1);
+                --adjacency.counts[vertex];
+            }
+
+            // its vertices to the front of the cache, the rest after them
+            std::size_t next_count = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                if (std::find(next_cache.begin(), next_cache.begin() + static_cast<std::ptrdiff_t>(next_count), triangle[k]) == next_cache.begin() + static_cast<std::ptrdiff_t>(next_count))
+                    next_cache[next_count++] = triangle[k];
+            }
+            for (std::size_t i = 0; i < cache_count; ++i)
+            {
+                const std::uint32_t vertex = cache[i];
+                if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                    next_cache[next_count++] = vertex;
+            }
+            for (std::size_t i = 0; i < next_count; ++i)
+                cache_positions[next_cache[i]] = i < SCORE_CACHE_SIZE ? static_cast<int>(i) : -1;
+
+            // rescore what moved, and look for the best triangle around it
+            best_score = -1.0f;
+            for (std::size_t i = 0; i < next_count; ++i)
+            {
+                const std::uint32_t vertex = next_cache[i];
+                const float         score  = vertex_score(cache_positions[vertex], adjacency.counts[vertex]);
+                const float         delta  = score - vertex_scores[vertex];
+                vertex_scores[vertex]      = score;
+                const std::uint32_t begin  = adjacency.offsets[vertex];
+                for (std::uint32_t j = begin; j < begin + adjacency.counts[vertex]; ++j)
+                {
+                    const std::uint32_t around = adjacency.triangles[j];
+                    triangle_scores[around] += delta;
+                    if (triangle_scores[around] > best_score)
+                    {
+                        best       = around;
+                        best_score = triangle_scores[around];
+                    }
+                }
+            }
+            cache_count = std::min<std::size_t>(next_count, SCORE_CACHE_SIZE);
+            std::copy_n(next_cache.begin(), cache_count, cache.begin());
+        }
+        std::copy(result.begin(), result.end(), indices.begin());
+    }
+
+    void OptimizeOverdraw(std::span<std::uint32_t> indices, std::span<const glm::vec3> positions, float threshold)
+    {
+        const std::size_t triangle_count = indices.size() / 3;
+        if (triangle_count < 2)
+            return;
+        const std::size_t vertex_count = std::max(positions.size(), vertex_count_of(indices));
+
+        // hard boundaries: wherever a triangle misses on all three, the cache started over anyway
+        std::vector<std::uint32_t> stamps(vertex_count, 0);
+        std::uint32_t              timestamp = CACHE_SIZE + 1;
+        std::vector<std::size_t>   hard;
+        for (std::size_t t = 0; t < triangle_count; ++t)
+        {
+            const unsigned misses = update_fifo(&indices[t * 3], stamps, timestamp, CACHE_SIZE);
+            if (t == 0 || misses == 3)
+                hard.push_back(t);
+        }
+
+        // soft boundaries: within each, a new cluster once this one's misses come to its share
+        std::vector<std::size_t> clusters;
+        for (std::size_t h = 0; h < hard.size(); ++h)
+        {
+            const std::size_t start = hard[h];
+            const std::size_t end   = h + 1 < hard.size() ? hard[h + 1] : triangle_count;
+            timestamp += CACHE_SIZE + 1;
+            unsigned misses = 0;
+            for (std::size_t t = start; t < end; ++t)
+                misses += update_fifo(&indices[t * 3], stamps, timestamp, CACHE_SIZE);
+            const float limit = threshold * static_cast<float>(misses) / static_cast<float>(end - start);
+
+            clusters.push_back(start);
+            timestamp += CACHE_SIZE + 1;
+            unsigned running_misses    = 0;
+            unsigned running_triangles = 0;
+            for (std::size_t t = start; t < end; ++t)
+            {
+                running_misses += update_fifo(&indices[t * 3], stamps, timestamp, CACHE_SIZE);
+                ++running_triangles;
+                if (t + 1 < end && static_cast<float>(running_misses) / static_cast<float>(running_triangles) <= limit)
+                {
+                    clusters.push_back(t + 1);
+                    timestamp += CACHE_SIZE + 1;
+                    running_misses    = 0;
+                    running_triangles = 0;
+                }
+            }
+        }
+
+        // each cluster's area weighted middle and facing, and the mesh's middle
+        struct Cluster
+        {
+            std::size_t start = 0;
+            std::size_t end   = 0;
+            glm::vec3   middle{ 0.0f };
+            glm::vec3   normal{ 0.0f };
+            float       area = 0.0f;
+            float       sort = 0.0f;
+        };
+        std::vector<Cluster> sorted(clusters.size());
+        glm::vec3            mesh_middle{ 0.0f };
+        float                mesh_area = 0.0f;
+        for (std::size_t c = 0; c < clusters.size(); ++c)
+        {
+            Cluster& cluster = sorted[c];
+            cluster.start    = clusters[c];
+            cluster.end      = c + 1 < clusters.size() ? clusters[c + 1] : triangle_count;
+            for (std::size_t t = cluster.start; t < cluster.end; ++t)
+            {
+                const glm::vec3 p0     = positions[indices[t * 3]];
+                const glm::vec3 p1     = positions[indices[t * 3 + 1]];
+                const glm::vec3 p2     = positions[indices[t * 3 + 2]];
+                const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float     area   = glm::length(normal);
+                cluster.middle += (p0 + p1 + p2) * (area / 3.0f);
+                cluster.normal += normal;
+                cluster.area += area;
+            }
+            mesh_middle += cluster.middle;
+            mesh_area += cluster.area;
+            cluster.middle /= std::max(cluster.area, 1e-12f);
+        }
+        mesh_middle /= std::max(mesh_area, 1e-12f);
+        for (Cluster& cluster : sorted)
+        {
+            const float length = glm::length(cluster.normal);
+            cluster.sort       = length > 0.0f ? glm::dot(cluster.middle - mesh_middle, cluster.normal / length) : 0.0f;
+        }
+        // outermost and facing out first; ties keep the cache's order
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sort > b.sort; });
+
+        std::vector<std::uint32_t> result;
+        result.reserve(indices.size());
+        for (const Cluster& cluster : sorted)
+            result.insert(result.end(), indices.begin() + static_cast<std::ptrdiff_t>(cluster.start * 3), indices.begin() + static_cast<std::ptrdiff_t>(cluster.end * 3));
+        std::copy(result.begin(), result.end(), indices.begin());
+    }
+
+    std::size_t Simplify(std::span<std::uint32_t> indices, std::span<const glm::vec3> positions, std::size_t target_index_count, float target_error, float& out_error)
+    {
+        out_error                  = 0.0f;
+        const std::size_t vertex_count = positions.size();
+        std::vector<std::uint32_t> owners = position_owners(positions);
+        std::vector<std::uint32_t> remap(vertex_count);
+        for (std::size_t v = 0; v < vertex_count; ++v)
+            remap[v] = static_cast<std::uint32_t>(v);
+        std::size_t index_count = compact_triangles(indices.first(indices.size() / 3 * 3), remap, owners);
+
+        // the vertices at each position, so they all follow when it collapses
+        std::vector<std::uint32_t> first_wedge(vertex_count, UNUSED);
+        std::vector<std::uint32_t> next_wedge(vertex_count, UNUSED);
+        for (std::size_t v = vertex_count; v-- > 0;)
+        {
+            next_wedge[v]         = first_wedge[owners[v]];
+            first_wedge[owners[v]] = static_cast<std::uint32_t>(v);
+        }
+
+        // each position's quadric: the planes of the faces around it by area, and of its open edges
+        std::vector<Quadric>       quadrics(vertex_count);
+        std::vector<std::uint32_t> corners(index_count);
+        for (std::size_t i = 0; i < index_count; ++i)
+            corners[i] = owners[indices[i]];
+        const std::vector<std::uint8_t> initial_edges = count_edges(std::span{ corners }.first(index_count));
+        for (std::size_t t = 0; t < index_count / 3; ++t)
+        {
+            const glm::dvec3 p[3]   = { positions[corners[t * 3]], positions[corners[t * 3 + 1]], positions[corners[t * 3 + 2]] };
+            glm::dvec3       normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+            const double     length = glm::length(normal);
+            if (length <= 0.0)
+                continue;
+            normal /= length;
+            for (int k = 0; k < 3; ++k)
+                quadrics[corners[t * 3 + static_cast<std::size_t>(k)]].AddPlane(normal, -glm::dot(normal, p[0]), length * 0.5);
+            for (int k = 0; k < 3; ++k)
+            {
+                if (initial_edges[t * 3 + static_cast<std::size_t>(k)] != 1)
+                    continue;
+                // a plane through the open edge, square to the face, holds the outline in place
+                const glm::dvec3 edge   = p[(k + 1) % 3] - p[k];
+                const glm::dvec3 across = glm::cross(edge, normal);
+                const double     span   = glm::length(across);
+                if (span <= 0.0)
+                    continue;
+                const glm::dvec3 plane = across / span;
+                const double     area  = glm::dot(edge, edge) * BORDER_WEIGHT;
+                quadrics[corners[t * 3 + static_cast<std::size_t>(k)]].AddPlane(plane, -glm::dot(plane, p[k]), area);
+                quadrics[corners[t * 3 + static_cast<std::size_t>((k + 1) % 3)]].AddPlane(plane, -glm::dot(plane, p[k]), area);
+            }
+        }
+
+        struct Collapse
+        {
+            std::uint32_t from = 0;
+            std::uint32_t to   = 0;
+            double        cost = 0.0;
+        };
+        enum Kind : std::uint8_t
+        {
+            Interior,
+            Border, // on an open edge: only slides along it
+            Locked  // on an edge of more than two faces
+        };
+        const double          error_limit = static_cast<double>(target_error) * static_cast<double>(target_error);
+        double                worst       = 0.0;
+        std::vector<Kind>     kinds(vertex_count);
+        std::vector<Collapse> best(vertex_count);
+        std::vector<Collapse> collapses;
+        std::vector<bool>     touched(vertex_count);
+
+        // in passes: the cheapest collapse of each position, cheapest first, none touching a face another one changed
+        while (index_count > target_index_count)
+        {
+            corners.resize(index_count);
+            for (std::size_t i = 0; i < index_count; ++i)
+                corners[i] = owners[indices[i]];
+            const std::vector<std::uint8_t> edge_counts = count_edges(corners);
+            const Adjacency                 around      = build_adjacency(corners, vertex_count);
+            std::fill(kinds.begin(), kinds.end(), Interior);
+            for (std::size_t i = 0; i < index_count; ++i)
+            {
+                const Kind kind = edge_counts[i] == 1 ? Border : edge_counts[i] > 2 ? Locked : Interior;
+                for (const std::uint32_t end : { corners[i], corners[i - i % 3 + (i + 1) % 3] })
+                    kinds[end] = std::max(kinds[end], kind);
+            }
+
+            for (Collapse& collapse : best)
+                collapse.cost = -1.0;
+            for (std::size_t i = 0; i < index_count; ++i)
+            {
+                const std::uint32_t a = corners[i];
+                const std::uint32_t b = corners[i - i % 3 + (i + 1) % 3];
+                for (const auto& [from, to] : { std::pair{ a, b }, std::pair{ b, a } })
+                {
+                    if (kinds[from] == Locked || (kinds[from] == Border && edge_counts[i] != 1))
+                        continue;
+                    Quadric merged = quadrics[from];
+                    merged += quadrics[to];
+                    const double cost = merged.Error(positions[to]);
+                    if (best[from].cost < 0.0 || cost < best[from].cost)
+                        best[from] = Collapse{ from, to, cost };
+                }
+            }
+            collapses.clear();
+            for (const Collapse& collapse : best)
+            {
+                if (collapse.cost >= 0.0 && collapse.cost <= error_limit)
+                    collapses.push_back(collapse);
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+            std::fill(touched.begin(), touched.end(), false);
+            const std::size_t wanted  = (index_count - target_index_count + 2) / 3;
+            std::size_t       removed = 0;
+            std::size_t       done    = 0;
+            for (const Collapse& collapse : collapses)
+            {
+                if (removed >= wanted)
+                    break;
+                if (touched[collapse.from] || touched[collapse.to])
+                    continue;
+                const std::uint32_t* first = &around.triangles[around.offsets[collapse.from]];
+                const std::uint32_t* last  = first + around.counts[collapse.from];
+
+                // no face around it may turn over
+                bool flips = false;
+                for (const std::uint32_t* t = first; t != last && !flips; ++t)
+                {
+                    const std::uint32_t* face = &corners[static_cast<std::size_t>(*t) * 3];
+                    if (face[0] == collapse.to || face[1] == collapse.to || face[2] == collapse.to)
+                        continue;
+                    glm::vec3 p[3] = { positions[face[0]], positions[face[1]], positions[face[2]] };
+                    const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    for (glm::vec3& corner : p)
+                        corner = corner == positions[collapse.from] ? positions[collapse.to] : corner;
+                    flips = glm::dot(before, glm::cross(p[1] - p[0], p[2] - p[0])) <= 0.0f;
+                }
+                if (flips)
+                    continue;
+
+                // each vertex here becomes the one at the other end of an edge it shares, its color kept as near as there is
+                for (std::uint32_t wedge = first_wedge[collapse.from]; wedge != UNUSED; wedge = next_wedge[wedge])
+                    remap[wedge] = first_wedge[collapse.to];
+                for (const std::uint32_t* t = first; t != last; ++t)
+                {
+                    const std::uint32_t* face = &corners[static_cast<std::size_t>(*t) * 3];
+                    const std::uint32_t* real = &indices[static_cast<std::size_t>(*t) * 3];
+                    for (int k = 0; k < 3; ++k)
+                        touched[face[k]] = true;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        if (face[k] != collapse.from)
+                            continue;
+                        for (int j = 0; j < 3; ++j)
+                        {
+                            if (face[j] == collapse.to)
+                            {
+                                remap[real[k]] = real[j];
+                                ++removed;
+                            }
+                        }
+                    }
+                }
+                quadrics[collapse.to] += quadrics[collapse.from];
+                worst = std::max(worst, collapse.cost);
+                ++done;
+            }
+            if (done == 0)
+                break;
+            index_count = compact_triangles(indices.first(index_count), remap, owners);
+            for (std::size_t v = 0; v < vertex_count; ++v)
+                remap[v] = static_cast<std::uint32_t>(v);
+        }
+        out_error = static_cast<float>(std::sqrt(worst));
+        return index_count;
+    }
+
+    std::size_t OptimizeVertexFetch(std::span<std::uint32_t> indices, std::size_t vertex_count, std::vector<std::uint32_t>& out_remap)
+    {
+        out_remap.assign(vertex_count, UNUSED);
+        std::uint32_t next = 0;
+        for (std::uint32_t& index : indices)
+        {
+            assert(index < vertex_count);
+            if (out_remap[index] == UNUSED)
+                out_remap[index] = next++;
+            index = out_remap[index];
+        }
+        return next;
+    }
+}
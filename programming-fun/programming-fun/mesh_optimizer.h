@@ -0,0 +1,65 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+/**
+ * Index and vertex reordering for raster throughput, the three passes meshoptimizer runs on a mesh before upload.
+ *
+ * OptimizeVertexCache orders triangles so their vertices are still in the post-transform cache when the next ones
+ * come: Forsyth's linear-speed greedy, scoring vertices by where they sit in a simulated LRU of CACHE_SIZE * 2 and
+ * by how few triangles they have left. OptimizeOverdraw then cuts that order into clusters where the cache starts
+ * over anyway, or wherever a cluster already has its share of misses, and puts the clusters that face outwards
+ * from the mesh's middle first, so the depth test rejects more of what comes after for most viewpoints; it gives up
+ * at most `threshold` of the cache's efficiency for that (Sander, Nehab and Barczak's "Fast Triangle Reordering").
+ * OptimizeVertexFetch numbers the vertices in the order the indices first reach them, so the fetches walk memory
+ * forwards. Run them in that order: each keeps what the one before did. The Analyze functions measure the same
+ * caches, for showing what the passes won.
+ *
+ * Simplify makes the coarser levels of detail: Garland and Heckbert's quadric error edge collapses, each position
+ * moved onto a neighbour's so the result indexes the same vertices. Vertices sharing a position (the seams of hard
+ * edges or color changes) collapse together, open edges only slide along themselves, and no collapse may turn a face
+ * over. Pure functions over index arrays, safe on any thread.
+ */
+namespace mesh_optimizer
+{
+    inline constexpr unsigned      CACHE_SIZE       = 16; // vertices in the FIFO the analysis models; a fair guess for most GPUs
+    inline constexpr std::size_t   FETCH_LINE_BYTES = 64;
+    inline constexpr std::size_t   FETCH_LINES      = 64; // a 4 KB fetch cache
+    inline constexpr std::uint32_t UNUSED           = ~std::uint32_t{ 0 };
+
+    struct VertexCacheStats
+    {
+        float acmr = 0.0f; // transformed vertices per triangle: 3 at worst, towards 0.5 on a large grid
+        float atvr = 0.0f; // transformed vertices per vertex: 1 at best
+    };
+
+    struct VertexFetchStats
+    {
+        float overfetch = 0.0f; // bytes fetched per byte of vertices used: 1 at best
+    };
+
+    // `indices` is a triangle list
+    VertexCacheStats AnalyzeVertexCache(std::span<const std::uint32_t> indices, std::size_t vertex_count, unsigned cache_size = CACHE_SIZE);
+    // The vertices that miss the post-transform cache, read FETCH_LINE_BYTES at a time through FETCH_LINES of them
+    VertexFetchStats AnalyzeVertexFetch(std::span<const std::uint32_t> indices, std::size_t vertex_count, std::size_t vertex_bytes);
+
+    void OptimizeVertexCache(std::span<std::uint32_t> indices, std::size_t vertex_count);
+    // After OptimizeVertexCache; `threshold` is the ACMR a cluster may grow to, as a multiple of its own
+    void OptimizeOverdraw(std::span<std::uint32_t> indices, std::span<const glm::vec3> positions, float threshold = 1.05f);
+    // Rewrites the first indices into a mesh of at most `target_index_count` where that costs no more than `target_error`,
+    // in the positions' units; returns the indices left and how far the surface moved, roughly, in `out_error`
+    std::size_t Simplify(std::span<std::uint32_t> indices, std::span<const glm::vec3> positions, std::size_t target_index_count, float target_error, float& out_error);
+    // Renumbers the indices; `out_remap` gets each old vertex's new number, or UNUSED. Returns how many are used
+    std::size_t OptimizeVertexFetch(std::span<std::uint32_t> indices, std::size_t vertex_count, std::vector<std::uint32_t>& out_remap);
+}
@@ -0,0 +1,665 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "mesh_renderer.h"
+
+#include "gl_backend.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "shader.h"
+#include "vertex_layout.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <numbers>
+#include <string>
+
+namespace
+{
+    constexpr const char* MESH_VERTEX_SHADER = R"(
+layout(location = 0) in vec4 aPosition; // packed; the instance's rows unpack it
+layout(location = 1) in vec4 aVertexColor;
+layout(location = 2) in vec4 aRow0;
+layout(location = 3) in vec4 aRow1;
+layout(location = 4) in vec4 aRow2;
+layout(location = 5) in vec4 aColor;
+
+uniform mat4 uViewProjection;
+
+out vec4 vColor;
+
+void main()
+{
+    vec4 local  = vec4(aPosition.xyz, 1.0);
+    vec3 world  = vec3(dot(aRow0, local), dot(aRow1, local), dot(aRow2, local));
+    vColor      = aVertexColor * aColor;
+    gl_Position = uViewProjection * vec4(world, 1.0);
+}
+)";
+
+    constexpr const char* MESH_FRAGMENT_SHADER = R"(
+in vec4 vColor;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = vColor;
+}
+)";
+
+    constexpr auto MESH_VERTEX_LAYOUT = vertex_layout::Make<PackedMeshVertex>(VertexAttribute{ 0, attribute_format::Short4Norm, offsetof(PackedMeshVertex, position) },
+                                                                              VertexAttribute{ 1, attribute_format::UByte4Norm, offsetof(PackedMeshVertex, color) });
+
+    constexpr float SNORM16_MAX = 32767.0f;
+
+    // the instance's rows times the mesh's unpacking, so they take the packed position straight to the world
+    MeshInstance unpacking(MeshInstance instance, const MeshQuantization& quantization) noexcept
+    {
+        for (glm::vec4& row : instance.rows)
+        {
+            const glm::vec3 axes{ row };
+            row = glm::vec4{ axes * quantization.extent, row.w + glm::dot(axes, quantization.center) };
+        }
+        return instance;
+    }
+
+    constexpr auto MESH_INSTANCE_LAYOUT = vertex_layout::PerInstance(vertex_layout::Make<MeshInstance>(
+        VertexAttribute{ 2, attribute_format::Float4, offsetof(MeshInstance, rows) }, VertexAttribute{ 3, attribute_format::Float4, offsetof(MeshInstance, rows) + sizeof(glm::vec4) },
+        VertexAttribute{ 4, attribute_format::Float4, offsetof(MeshInstance, rows) + 2 * sizeof(glm::vec4) }, VertexAttribute{ 5, attribute_format::UByte4Norm, offsetof(MeshInstance, color) }));
+
+    // per region; grows to the largest frame seen
+    constexpr std::size_t INITIAL_STREAM_BYTES = 1024 * sizeof(MeshInstance);
+
+    using FrustumPlanes = std::array<glm::vec4, 6>;
+
+    // left, right, bottom, top, near, far from the rows of `view_projection`, normalized so distances are in world units
+    FrustumPlanes frustum_planes(const glm::mat4& view_projection) noexcept
+    {
+        const auto row = [&view_projection](int i) { return glm::vec4{ view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i] }; };
+        FrustumPlanes planes{ row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(3) + row(2), row(3) - row(2) };
+        for (glm::vec4& plane : planes)
+            plane /= std::max(glm::length(glm::vec3{ plane }), 1e-12f);
+        return planes;
+    }
+
+    // the mesh's sphere moved to the instance and grown by its largest axis scale, which bounds any rotation or shear
+    bool is_visible(const FrustumPlanes& planes, const MeshInstance& instance, float radius) noexcept
+    {
+        const glm::vec4* rows   = instance.rows;
+        const glm::vec3  center{ rows[0].w, rows[1].w, rows[2].w };
+        const float      scale2 = std::max({ rows[0].x * rows[0].x + rows[1].x * rows[1].x + rows[2].x * rows[2].x, rows[0].y * rows[0].y + rows[1].y * rows[1].y + rows[2].y * rows[2].y,
+                                             rows[0].z * rows[0].z + rows[1].z * rows[1].z + rows[2].z * rows[2].z });
+        const float      bound  = radius * std::sqrt(scale2);
+        return std::all_of(planes.begin(), planes.end(), [&](const glm::vec4& plane) { return glm::dot(glm::vec3{ plane }, center) + plane.w >= -bound; });
+    }
+
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    constexpr const char* GPU_PREAMBLE = "#version 430 core\n";
+    constexpr GLuint      GROUP_SIZE   = 256;
+
+    // the same instance the CPU path streams, padded to std430's vec4 stride, with its mesh beside the color
+    struct GpuInstance
+    {
+        glm::vec4     rows[3]{};
+        std::uint32_t color = 0;
+        std::uint32_t mesh  = 0;
+        std::uint32_t padding[2]{};
+    };
+    static_assert(sizeof(GpuInstance) == 64);
+
+    // glMultiDrawElementsIndirect's, tightly packed; the cull counts the instances
+    struct DrawElementsCommand
+    {
+        GLuint count          = 0;
+        GLuint instance_count = 0;
+        GLuint first_index    = 0;
+        GLint  base_vertex    = 0;
+        GLuint base_instance  = 0;
+    };
+    static_assert(sizeof(DrawElementsCommand) == 20);
+
+    constexpr const char* INSTANCE_BLOCK = R"(
+struct Instance
+{
+    vec4 rows[3];
+    uint color;
+    uint mesh;
+    uint padding0;
+    uint padding1;
+};
+
+layout(std430, binding = 0) readonly buffer Instances
+{
+    Instance instances[];
+};
+)";
+
+    // one thread per instance, appending what it keeps to its mesh's slice of the visible list
+    constexpr const char* CULL_SHADER = R"(
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 1) readonly buffer Radii
+{
+    float radii[];
+};
+
+layout(std430, binding = 2) writeonly buffer Visible
+{
+    uint visible[];
+};
+
+struct Command
+{
+    uint count;
+    uint instance_count;
+    uint first_index;
+    int  base_vertex;
+    uint base_instance;
+};
+
+layout(std430, binding = 3) buffer Commands
+{
+    Command commands[];
+};
+
+uniform vec4 uPlanes[6];
+uniform uint uInstanceCount;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uInstanceCount)
+        return;
+    Instance instance = instances[index];
+    vec3     center   = vec3(instance.rows[0].w, instance.rows[1].w, instance.rows[2].w);
+    vec3     axis_x   = vec3(instance.rows[0].x, instance.rows[1].x, instance.rows[2].x);
+    vec3     axis_y   = vec3(instance.rows[0].y, instance.rows[1].y, instance.rows[2].y);
+    vec3     axis_z   = vec3(instance.rows[0].z, instance.rows[1].z, instance.rows[2].z);
+    float    bound    = radii[instance.mesh] * sqrt(max(dot(axis_x, axis_x), max(dot(axis_y, axis_y), dot(axis_z, axis_z))));
+    for (int i = 0; i < 6; ++i)
+    {
+        if (dot(uPlanes[i].xyz, center) + uPlanes[i].w < -bound)
+            return;
+    }
+    uint slot = atomicAdd(commands[instance.mesh].instance_count, 1u);
+    visible[commands[instance.mesh].base_instance + slot] = index;
+}
+)";
+
+    // the instance index comes from the visible list as an attribute, since GL 4.3's gl_InstanceID leaves out the base instance
+    constexpr const char* GPU_VERTEX_SHADER = R"(
+layout(location = 0) in vec4 aPosition;
+layout(location = 1) in vec4 aVertexColor;
+layout(location = 2) in uint aInstance;
+
+uniform mat4 uViewProjection;
+
+out vec4 vColor;
+
+void main()
+{
+    Instance instance = instances[aInstance];
+    vec4     local    = vec4(aPosition.xyz, 1.0);
+    vec3     world    = vec3(dot(instance.rows[0], local), dot(instance.rows[1], local), dot(instance.rows[2], local));
+    vColor            = aVertexColor * unpackUnorm4x8(instance.color);
+    gl_Position       = uViewProjection * vec4(world, 1.0);
+}
+)";
+
+    constexpr auto VISIBLE_LAYOUT = vertex_layout::PerInstance(vertex_layout::Make<GLuint>(VertexAttribute{ 2, attribute_format::UInt1, 0 }));
+
+    std::string join(const char* first, const char* second)
+    {
+        return std::string{ first } + second;
+    }
+#endif
+}
+
+MeshInstance pack_mesh_instance(const glm::mat4& transform, std::uint32_t color) noexcept
+{
+    // glm is column major, transform[column][row]
+    MeshInstance instance;
+    for (int row = 0; row < 3; ++row)
+        instance.rows[row] = glm::vec4{ transform[0][row], transform[1][row], transform[2][row], transform[3][row] };
+    instance.color = color;
+    return instance;
+}
+
+MeshInstance pack_mesh_instance(const glm::vec3& position, float rotation, const glm::vec3& scale, std::uint32_t color) noexcept
+{
+    const float  c = std::cos(rotation);
+    const float  s = std::sin(rotation);
+    MeshInstance instance;
+    instance.rows[0] = glm::vec4{ c * scale.x, -s * scale.y, 0.0f, position.x };
+    instance.rows[1] = glm::vec4{ s * scale.x, c * scale.y, 0.0f, position.y };
+    instance.rows[2] = glm::vec4{ 0.0f, 0.0f, scale.z, position.z };
+    instance.color   = color;
+    return instance;
+}
+
+MeshQuantization quantization_for(std::span<const MeshVertex> vertices) noexcept
+{
+    if (vertices.empty())
+        return MeshQuantization{};
+    glm::vec3 low{ vertices.front().position };
+    glm::vec3 high{ low };
+    for (const MeshVertex& vertex : vertices)
+    {
+        low  = glm::min(low, vertex.position);
+        high = glm::max(high, vertex.position);
+    }
+    const glm::vec3 half = (high - low) * 0.5f;
+    // a flat or empty box still needs a nonzero scale
+    return MeshQuantization{ low + half, std::max({ half.x, half.y, half.z, 1e-6f }) };
+}
+
+PackedMeshVertex pack_mesh_vertex(const MeshVertex& vertex, const MeshQuantization& quantization) noexcept
+{
+    const glm::vec3  unit = glm::clamp((vertex.position - quantization.center) / quantization.extent, -1.0f, 1.0f);
+    PackedMeshVertex packed;
+    for (int i = 0; i < 3; ++i)
+        packed.position[i] = static_cast<std::int16_t>(std::lround(unit[i] * SNORM16_MAX));
+    packed.color = vertex.color;
+    return packed;
+}
+
+MeshData make_marker_mesh(int sides, std::uint32_t rim_color)
+{
+    sides = std::clamp(sides, 3, 1024);
+    MeshData mesh;
+    mesh.vertices.reserve(static_cast<std::size_t>(sides) + 1);
+    mesh.indices.reserve(static_cast<std::size_t>(sides) * 3);
+    mesh.vertices.push_back(MeshVertex{ glm::vec3{ 0.0f }, 0xFFFFFFFFu });
+    for (int i = 0; i < sides; ++i)
+    {
+        const float angle = 2.0f * std::numbers::pi_v<float> * static_cast<float>(i) / static_cast<float>(sides);
+        mesh.vertices.push_back(MeshVertex{ glm::vec3{ std::cos(angle), std::sin(angle), 0.0f }, rim_color });
+        mesh.indices.push_back(0);
+        mesh.indices.push_back(static_cast<std::uint16_t>(1 + i));
+        mesh.indices.push_back(static_cast<std::uint16_t>(1 + (i + 1) % sides));
+    }
+    return mesh;
+}
+
+void MeshRenderer::Setup()
+{
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    // the vertex shader reads the instances from storage, which GL 4.3 only promises to compute shaders
+    GLint vertex_blocks = 0;
+    if (GLEW_VERSION_4_3)
+        glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &vertex_blocks);
+    gpu_driven = vertex_blocks >= 1;
+    if (gpu_driven)
+    {
+        program.Request(join(INSTANCE_BLOCK, GPU_VERTEX_SHADER), MESH_FRAGMENT_SHADER, GPU_PREAMBLE);
+        cull_program.RequestCompute(join(INSTANCE_BLOCK, CULL_SHADER), GPU_PREAMBLE);
+        glGenVertexArrays(1, &geometry_array);
+        GLuint buffers[6] = {};
+        glGenBuffers(6, buffers);
+        geometry_vertices = buffers[0];
+        geometry_indices  = buffers[1];
+        radius_buffer     = buffers[2];
+        instance_buffer   = buffers[3];
+        visible_buffer    = buffers[4];
+        command_buffer    = buffers[5];
+        // the element binding is part of the vertex array; the buffers are refilled later under the same names
+        gl_state::BindVertexArray(geometry_array);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry_indices);
+        glBindBuffer(GL_ARRAY_BUFFER, geometry_vertices);
+        vertex_layout::Enable(MESH_VERTEX_LAYOUT);
+        vertex_layout::Bind(MESH_VERTEX_LAYOUT);
+        glBindBuffer(GL_ARRAY_BUFFER, visible_buffer);
+        vertex_layout::Enable(VISIBLE_LAYOUT);
+        vertex_layout::Bind(VISIBLE_LAYOUT);
+        return;
+    }
+#endif
+    program.Request(MESH_VERTEX_SHADER, MESH_FRAGMENT_SHADER);
+    instance_stream.Setup(GL_ARRAY_BUFFER, INITIAL_STREAM_BYTES);
+}
+
+void MeshRenderer::Shutdown()
+{
+    for (Mesh& mesh : meshes)
+    {
+        if (!mesh.owns_buffers)
+            continue;
+        glDeleteBuffers(1, &mesh.vertex_buffer);
+        glDeleteBuffers(1, &mesh.index_buffer);
+        gl_state::DeleteVertexArray(mesh.vertex_array);
+    }
+    meshes.clear();
+    instance_stream.Shutdown();
+    program.Reset();
+
+    for (GLuint* buffer : { &geometry_vertices, &geometry_indices, &radius_buffer, &instance_buffer, &visible_buffer, &command_buffer })
+    {
+        if (*buffer != 0)
+            glDeleteBuffers(1, buffer);
+        *buffer = 0;
+    }
+    gl_state::DeleteVertexArray(geometry_array);
+    cull_program.Reset();
+    geometry_array          = 0;
+    planes_location         = -1;
+    instance_count_location = -1;
+    instance_capacity       = 0;
+    command_capacity        = 0;
+    is_geometry_dirty       = false;
+    gpu_driven              = false;
+    all_vertices.clear();
+    all_indices.clear();
+}
+
+MeshId MeshRenderer::CreateMesh(std::span<const MeshVertex> vertices, std::span<const std::uint16_t> indices)
+{
+    const MeshQuantization        quantization = quantization_for(vertices);
+    std::vector<PackedMeshVertex> packed;
+    packed.reserve(vertices.size());
+    for (const MeshVertex& vertex : vertices)
+        packed.push_back(pack_mesh_vertex(vertex, quantization));
+    return CreateMesh(packed, indices, quantization);
+}
+
+MeshId MeshRenderer::CreateMesh(std::span<const PackedMeshVertex> vertices, std::span<const std::uint16_t> indices, const MeshQuantization& quantization)
+{
+    const MeshLod whole{ 0, static_cast<std::uint32_t>(indices.size()) };
+    return CreateMeshLods(vertices, indices, quantization, std::span{ &whole, 1 });
+}
+
+MeshId MeshRenderer::CreateMeshLods(std::span<const PackedMeshVertex> vertices, std::span<const std::uint16_t> indices, const MeshQuantization& quantization, std::span<const MeshLod> lods)
+{
+    Mesh mesh;
+    mesh.quantization = quantization;
+    for (const PackedMeshVertex& vertex : vertices)
+        mesh.radius = std::max(mesh.radius, glm::length(glm::vec3{ vertex.position[0], vertex.position[1], vertex.position[2] } / SNORM16_MAX));
+    const auto first_mesh = static_cast<MeshId>(meshes.size());
+
+    if (gpu_driven)
+    {
+        // appended to the shared buffers, uploaded at the next End
+        mesh.base_vertex = static_cast<GLint>(all_vertices.size());
+        for (const MeshLod& lod : lods)
+        {
+            mesh.first_index = static_cast<GLuint>(all_indices.size() + lod.first_index);
+            mesh.index_count = static_cast<GLsizei>(lod.index_count);
+            meshes.push_back(mesh);
+        }
+        all_vertices.insert(all_vertices.end(), vertices.begin(), vertices.end());
+        all_indices.insert(all_indices.end(), indices.begin(), indices.end());
+        is_geometry_dirty = true;
+        return first_mesh;
+    }
+
+    glGenVertexArrays(1, &mesh.vertex_array);
+    glGenBuffers(1, &mesh.vertex_buffer);
+    glGenBuffers(1, &mesh.index_buffer);
+
+    // the element binding is part of the vertex array, so bind that first
+    gl_state::BindVertexArray(mesh.vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size_bytes()), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.index_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size_bytes()), indices.data(), GL_STATIC_DRAW);
+    gl_stats::CountUpload(vertices.size_bytes() + indices.size_bytes());
+
+    vertex_layout::Enable(MESH_VERTEX_LAYOUT);
+    vertex_layout::Bind(MESH_VERTEX_LAYOUT);
+    vertex_layout::Enable(MESH_INSTANCE_LAYOUT);
+
+    for (const MeshLod& lod : lods)
+    {
+        mesh.first_index = lod.first_index;
+        mesh.index_count = static_cast<GLsizei>(lod.index_count);
+        meshes.push_back(mesh);
+        mesh.owns_buffers = false;
+    }
+    return first_mesh;
+}
+
+MeshId MeshRenderer::CreateMesh(const MeshData& data)
+{
+    return CreateMesh(data.vertices, data.indices);
+}
+
+bool MeshRenderer::IsGpuDrivenAvailable() const noexcept
+{
+    return gpu_driven;
+}
+
+void MeshRenderer::Begin(const glm::mat4& new_view_projection)
+{
+    view_projection = new_view_projection;
+    instances.clear();
+    instance_meshes.clear();
+}
+
+void MeshRenderer::Draw(MeshId mesh, const MeshInstance& instance)
+{
+    if (mesh < 0 || static_cast<std::size_t>(mesh) >= meshes.size())
+        return;
+    instances.push_back(unpacking(instance, meshes[static_cast<std::size_t>(mesh)].quantization));
+    instance_meshes.push_back(mesh);
+}
+
+void MeshRenderer::End()
+{
+    stats            = Stats{};
+    stats.gpu_driven = gpu_driven;
+    if (instances.empty())
+        return;
+    if (!isProgramReady())
+    {
+        stats.pending = true;
+        return;
+    }
+    stats.instances = static_cast<int>(instances.size());
+    if (gpu_driven)
+        endGpuDriven();
+    else
+        endWithCpuCulling();
+}
+
+const MeshRenderer::Stats& MeshRenderer::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+void MeshRenderer::endWithCpuCulling()
+{
+    // kept in submission order; same grouping as SpriteBatch, sorted only when there is more than one mesh
+    const FrustumPlanes planes = frustum_planes(view_projection);
+    sort_keys.clear();
+    bool single_mesh = true;
+    for (std::size_t i = 0; i < instances.size(); ++i)
+    {
+        const MeshId mesh_id = instance_meshes[i];
+        if (!is_visible(planes, instances[i], meshes[static_cast<std::size_t>(mesh_id)].radius))
+            continue;
+        single_mesh = single_mesh && (sort_keys.empty() || static_cast<MeshId>(sort_keys.front() >> 32) == mesh_id);
+        sort_keys.push_back((static_cast<std::uint64_t>(mesh_id) << 32) | static_cast<std::uint64_t>(i));
+    }
+    stats.culled = static_cast<int>(instances.size() - sort_keys.size());
+    if (sort_keys.empty())
+        return;
+    if (!single_mesh)
+        std::sort(sort_keys.begin(), sort_keys.end());
+
+    const std::size_t count       = sort_keys.size();
+    const auto        bytes       = count * sizeof(MeshInstance);
+    std::size_t       base_offset = 0;
+    auto*             mapped      = reinterpret_cast<MeshInstance*>(instance_stream.Map(bytes, base_offset));
+    if (mapped == nullptr)
+        return;
+    if (count == instances.size() && single_mesh)
+    {
+        std::memcpy(mapped, instances.data(), bytes);
+    }
+    else
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            mapped[i] = instances[static_cast<std::size_t>(sort_keys[i] & 0xFFFFFFFFu)];
+    }
+    instance_stream.Unmap();
+    gl_stats::CountUpload(bytes);
+
+    gl_state::SetEnabled(GL_BLEND, true);
+    gl_state::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::UseProgram(program.Id());
+    glUniformMatrix4fv(view_projection_location, 1, GL_FALSE, glm::value_ptr(view_projection));
+
+    std::size_t run_start = 0;
+    while (run_start < count)
+    {
+        const auto  mesh_id = static_cast<MeshId>(sort_keys[run_start] >> 32);
+        std::size_t run_end = run_start + 1;
+        while (run_end < count && static_cast<MeshId>(sort_keys[run_end] >> 32) == mesh_id)
+            ++run_end;
+
+        const Mesh&   mesh  = meshes[static_cast<std::size_t>(mesh_id)];
+        const GLsizei count = static_cast<GLsizei>(run_end - run_start);
+        const auto    first = reinterpret_cast<const void*>(static_cast<std::uintptr_t>(mesh.first_index) * sizeof(std::uint16_t)); // a level's run
+        gl_state::BindVertexArray(mesh.vertex_array);
+        bindInstanceAttributes(base_offset + run_start * sizeof(MeshInstance));
+        glDrawElementsInstanced(GL_TRIANGLES, mesh.index_count, GL_UNSIGNED_SHORT, first, count);
+        gl_stats::CountDraw(static_cast<long long>(mesh.index_count / 3) * count);
+        ++stats.draw_calls;
+        run_start = run_end;
+    }
+    instance_stream.EndFrame();
+
+    stats.buffer_size = static_cast<int>(instance_stream.GetStats().region_bytes * StreamBuffer::REGION_COUNT);
+}
+
+void MeshRenderer::endGpuDriven()
+{
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    if (is_geometry_dirty)
+        uploadGeometry();
+
+    // the instances as submitted; the buffers only grow, and orphaning each frame keeps the GPU's copy from last frame safe
+    const std::size_t count = instances.size();
+    if (count > instance_capacity)
+    {
+        instance_capacity = std::max(count, instance_capacity * 2);
+        gl_backend::Get().buffer_data(visible_buffer, static_cast<GLsizeiptr>(instance_capacity * sizeof(GLuint)), nullptr, GL_DYNAMIC_COPY);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, instance_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(instance_capacity * sizeof(GpuInstance)), nullptr, GL_STREAM_DRAW);
+    auto* mapped = static_cast<GpuInstance*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(count * sizeof(GpuInstance)),
+                                                              GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (mapped == nullptr)
+        return;
+    mesh_counts.assign(meshes.size(), 0);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const MeshInstance& instance = instances[i];
+        GpuInstance&        gpu      = mapped[i];
+        gpu.rows[0]                  = instance.rows[0];
+        gpu.rows[1]                  = instance.rows[1];
+        gpu.rows[2]                  = instance.rows[2];
+        gpu.color                    = instance.color;
+        gpu.mesh                     = static_cast<std::uint32_t>(instance_meshes[i]);
+        ++mesh_counts[static_cast<std::size_t>(instance_meshes[i])];
+    }
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    gl_stats::CountUpload(count * sizeof(GpuInstance));
+
+    // each mesh's slice of the visible list starts where the one before could end; the cull fills in the counts
+    std::vector<DrawElementsCommand> commands(meshes.size());
+    GLuint                           base_instance = 0;
+    for (std::size_t m = 0; m < meshes.size(); ++m)
+    {
+        commands[m].count         = static_cast<GLuint>(meshes[m].index_count);
+        commands[m].first_index   = meshes[m].first_index;
+        commands[m].base_vertex   = meshes[m].base_vertex;
+        commands[m].base_instance = base_instance;
+        base_instance             += mesh_counts[m];
+    }
+    const auto command_bytes = static_cast<GLsizeiptr>(commands.size() * sizeof(DrawElementsCommand));
+    if (commands.size() > command_capacity)
+    {
+        command_capacity = commands.size();
+        gl_backend::Get().buffer_data(command_buffer, command_bytes, commands.data(), GL_DYNAMIC_COPY);
+    }
+    else
+    {
+        gl_backend::Get().buffer_sub_data(command_buffer, 0, command_bytes, commands.data());
+    }
+    gl_stats::CountUpload(static_cast<std::size_t>(command_bytes));
+
+    const FrustumPlanes planes = frustum_planes(view_projection);
+    gl_state::UseProgram(cull_program.Id());
+    glUniform4fv(planes_location, 6, glm::value_ptr(planes[0]));
+    glUniform1ui(instance_count_location, static_cast<GLuint>(count));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instance_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, radius_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, visible_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, command_buffer);
+    glDispatchCompute((static_cast<GLuint>(count) + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+    // the draw takes its commands from one buffer and the visible list as an attribute from another
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+    gl_state::SetEnabled(GL_BLEND, true);
+    gl_state::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::UseProgram(program.Id());
+    glUniformMatrix4fv(view_projection_location, 1, GL_FALSE, glm::value_ptr(view_projection));
+    gl_state::BindVertexArray(geometry_array);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(commands.size()), 0);
+    // how many survived never leaves the GPU
+    gl_stats::CountDraw(0);
+
+    stats.draw_calls  = 2;
+    stats.buffer_size = static_cast<int>(instance_capacity * (sizeof(GpuInstance) + sizeof(GLuint)) + static_cast<std::size_t>(command_bytes));
+#endif
+}
+
+void MeshRenderer::uploadGeometry()
+{
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    std::vector<float> radii;
+    radii.reserve(meshes.size());
+    for (const Mesh& mesh : meshes)
+        radii.push_back(mesh.radius);
+    const gl_backend::Functions& backend = gl_backend::Get();
+    backend.buffer_data(geometry_vertices, static_cast<GLsizeiptr>(all_vertices.size() * sizeof(PackedMeshVertex)), all_vertices.data(), GL_STATIC_DRAW);
+    backend.buffer_data(geometry_indices, static_cast<GLsizeiptr>(all_indices.size() * sizeof(std::uint16_t)), all_indices.data(), GL_STATIC_DRAW);
+    backend.buffer_data(radius_buffer, static_cast<GLsizeiptr>(radii.size() * sizeof(float)), radii.data(), GL_STATIC_DRAW);
+    gl_stats::CountUpload(all_vertices.size() * sizeof(PackedMeshVertex) + all_indices.size() * sizeof(std::uint16_t) + radii.size() * sizeof(float));
+    is_geometry_dirty = false;
+#endif
+}
+
+bool MeshRenderer::isProgramReady()
+{
+    if (gpu_driven && !cull_program.IsReady())
+    {
+        if (!cull_program.Poll())
+            return false;
+        planes_location         = glGetUniformLocation(cull_program.Id(), "uPlanes");
+        instance_count_location = glGetUniformLocation(cull_program.Id(), "uInstanceCount");
+    }
+    if (program.IsReady())
+        return true;
+    if (!program.Poll())
+        return false;
+    view_projection_location = glGetUniformLocation(program.Id(), "uViewProjection");
+    return true;
+}
+
+void MeshRenderer::bindInstanceAttributes(std::size_t base) const
+{
+    // GL_ARRAY_BUFFER is still the stream buffer from the Map in End
+    vertex_layout::Bind(MESH_INSTANCE_LAYOUT, base);
+}
@@ -0,0 +1,182 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "shader.h"
+#include "stream_buffer.h"
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+struct MeshVertex
+{
+    glm::vec3     position{ 0.0f };
+    std::uint32_t color = 0xFFFFFFFFu; // RGBA8, multiplied with the instance color
+};
+
+// A vertex as the renderer keeps it: the position in 16 bit snorm across its mesh's bounds, 12 bytes instead of 16
+struct PackedMeshVertex
+{
+    std::int16_t  position[4]{ 0, 0, 0, 32767 }; // w is padding
+    std::uint32_t color = 0xFFFFFFFFu;
+};
+
+// Takes a packed position back to its mesh's space: center + position * extent
+struct MeshQuantization
+{
+    glm::vec3 center{ 0.0f };
+    float     extent = 1.0f; // the bounds' largest half size, one for every axis so a rotation stays one
+};
+
+// Centered on the bounds of `vertices`
+MeshQuantization quantization_for(std::span<const MeshVertex> vertices) noexcept;
+PackedMeshVertex pack_mesh_vertex(const MeshVertex& vertex, const MeshQuantization& quantization) noexcept;
+
+// The affine part of a model matrix as three rows, so the vertex shader does three dot products
+struct MeshInstance
+{
+    glm::vec4     rows[3]{ { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f } };
+    std::uint32_t color = 0xFFFFFFFFu; // RGBA8, R in the low byte
+};
+
+// The bottom row of `transform` is assumed to be (0, 0, 0, 1)
+MeshInstance pack_mesh_instance(const glm::mat4& transform, std::uint32_t color) noexcept;
+// Translate * rotate about z * scale without building the matrix
+MeshInstance pack_mesh_instance(const glm::vec3& position, float rotation, const glm::vec3& scale, std::uint32_t color) noexcept;
+
+struct MeshData
+{
+    std::vector<MeshVertex>    vertices;
+    std::vector<std::uint16_t> indices; // triangles
+};
+
+// One level of detail: a run of its mesh's indices, over the same vertices as the others
+struct MeshLod
+{
+    std::uint32_t first_index = 0;
+    std::uint32_t index_count = 0;
+};
+
+// A flat `sides`-gon of radius 1 with a bright center fading to `rim_color` at the edge
+MeshData make_marker_mesh(int sides, std::uint32_t rim_color);
+
+using MeshId = int;
+
+/**
+ * Draws many copies of a few small indexed meshes.
+ *
+ * Draw calls between Begin and End are grouped by mesh; all instances go into one StreamBuffer
+ * and each mesh gets a single glDrawElementsInstanced. ES 3.0 has no base-instance draws, so every
+ * group re-points the instance attributes at its slice of the buffer instead. Instances whose bounding
+ * sphere is outside the view are dropped before the upload.
+ *
+ * On desktop GL 4.3, where vertex shaders can read storage buffers, the frame is GPU driven instead.
+ * Every mesh lives in one vertex and one index buffer, the instances go into a storage buffer as they
+ * were submitted, and a compute pass tests each against the view and appends the ones it keeps to its
+ * mesh's slice of a visible list, counting them into that mesh's glMultiDrawElementsIndirect command.
+ * One multi-draw then covers every mesh, with the visible list as a per-instance attribute that the
+ * command's base instance offsets. The CPU's part is the upload and a fixed number of calls, however
+ * many instances there are or how many survive, which never comes back from the GPU.
+ *
+ * Either way vertices are PackedMeshVertex, quantized within their mesh's bounds. Draw folds the mesh's
+ * MeshQuantization into the instance's rows, so the shaders take the snorm position as it is and the cull's
+ * radius is the packed one's. CreateMeshLods' levels of detail are meshes of their own over shared buffers, so
+ * instances at one level group into one draw like any mesh's.
+ */
+class MeshRenderer
+{
+public:
+    static constexpr MeshId INVALID_MESH = -1;
+
+    struct Stats
+    {
+        int  instances   = 0;
+        int  draw_calls  = 0;     // including the cull dispatch when GPU driven
+        int  buffer_size = 0;
+        int  culled      = 0;     // on the CPU; the GPU's count stays there
+        bool gpu_driven  = false; // culled by compute into one indirect multi-draw
+        bool pending     = false; // the program is still compiling, so nothing was drawn
+    };
+
+    void Setup();
+    void Shutdown();
+
+    // GL thread only; the mesh lives until Shutdown
+    MeshId CreateMesh(std::span<const MeshVertex> vertices, std::span<const std::uint16_t> indices);
+    MeshId CreateMesh(const MeshData& data);
+    // Already packed, as a model from the decoded cache is
+    MeshId CreateMesh(std::span<const PackedMeshVertex> vertices, std::span<const std::uint16_t> indices, const MeshQuantization& quantization);
+    // One mesh per level, all on one vertex and index buffer; returns the first level's id, the others follow it in order
+    MeshId CreateMeshLods(std::span<const PackedMeshVertex> vertices, std::span<const std::uint16_t> indices, const MeshQuantization& quantization, std::span<const MeshLod> lods);
+    bool   IsGpuDrivenAvailable() const noexcept;
+
+    void Begin(const glm::mat4& view_projection);
+    void Draw(MeshId mesh, const MeshInstance& instance);
+    void End();
+
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    struct Mesh
+    {
+        GLuint           vertex_array  = 0;
+        GLuint           vertex_buffer = 0;
+        GLuint           index_buffer  = 0;
+        GLsizei          index_count   = 0;
+        GLuint           first_index   = 0; // in the shared index buffer when GPU driven, or in the levels' one
+        GLint            base_vertex   = 0;
+        float            radius        = 0.0f; // of the bounding sphere about the packed origin, in packed units
+        MeshQuantization quantization;
+        bool             owns_buffers = true; // false for the levels after the first, which share its buffers
+    };
+
+    // `base` is the byte offset of the group's first instance in the stream buffer
+    void bindInstanceAttributes(std::size_t base) const;
+    // false while a program is compiling; looks up the uniforms the first time it's ready
+    bool isProgramReady();
+    void endWithCpuCulling();
+    void endGpuDriven();
+    // the shared vertex and index buffers and the radii, after CreateMesh added to them
+    void uploadGeometry();
+
+private:
+    ShaderProgram program;
+    GLint         view_projection_location = -1;
+    StreamBuffer  instance_stream;
+
+    // GPU driven only
+    bool                          gpu_driven = false;
+    ShaderProgram                 cull_program;
+    GLint                         planes_location         = -1;
+    GLint                         instance_count_location = -1;
+    GLuint                        geometry_array          = 0; // the shared buffers and the visible list
+    GLuint                        geometry_vertices       = 0;
+    GLuint                        geometry_indices        = 0;
+    GLuint                        radius_buffer           = 0; // storage: per mesh
+    GLuint                        instance_buffer         = 0; // storage: the frame's instances as submitted
+    GLuint                        visible_buffer          = 0; // instance indices, by mesh
+    GLuint                        command_buffer          = 0; // one indirect command per mesh
+    std::size_t                   instance_capacity       = 0;
+    std::size_t                   command_capacity        = 0;
+    bool                          is_geometry_dirty       = false;
+    std::vector<PackedMeshVertex> all_vertices;
+    std::vector<std::uint16_t>    all_indices;
+    std::vector<GLuint>           mesh_counts; // this frame's instances, by mesh
+
+    std::vector<Mesh>          meshes;
+    glm::mat4                  view_projection{ 1.0f };
+    std::vector<MeshInstance>  instances;
+    std::vector<MeshId>        instance_meshes;
+    std::vector<std::uint64_t> sort_keys;
+    Stats                      stats;
+};
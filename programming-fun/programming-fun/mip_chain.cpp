@@ -0,0 +1,165 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "mip_chain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace
+{
+    // the source texels one output texel covers along an axis and how much of each
+    struct Footprint
+    {
+        int first = 0;
+        int count = 0;
+        int taps  = 0; // into the weights
+    };
+
+    void build_footprints(int source_size, int target_size, std::vector<Footprint>& out_footprints, std::vector<float>& out_weights)
+    {
+        const double ratio = static_cast<double>(source_size) / static_cast<double>(target_size);
+        for (int i = 0; i < target_size; ++i)
+        {
+            const double begin = static_cast<double>(i) * ratio;
+            const double end   = std::min(static_cast<double>(i + 1) * ratio, static_cast<double>(source_size));
+            Footprint    footprint;
+            footprint.first = static_cast<int>(begin);
+            footprint.taps  = static_cast<int>(out_weights.size());
+            for (int texel = footprint.first; texel < source_size && static_cast<double>(texel) < end; ++texel)
+            {
+                const double covered = std::min(end, static_cast<double>(texel + 1)) - std::max(begin, static_cast<double>(texel));
+                out_weights.push_back(static_cast<float>(covered / (end - begin)));
+                ++footprint.count;
+            }
+            out_footprints.push_back(footprint);
+        }
+    }
+}
+
+std::vector<unsigned char> downsample_rgba(const unsigned char* source, int width, int height, int& out_width, int& out_height, int channels)
+{
+    out_width  = std::max(1, width / 2);
+    out_height = std::max(1, height / 2);
+    std::vector<unsigned char> result(static_cast<std::size_t>(out_width) * static_cast<std::size_t>(out_height) * static_cast<std::size_t>(channels));
+    for (int y = 0; y < out_height; ++y)
+    {
+        const int y0 = std::min(2 * y, height - 1);
+        const int y1 = std::min(2 * y + 1, height - 1);
+        for (int x = 0; x < out_width; ++x)
+        {
+            const int x0 = std::min(2 * x, width - 1);
+            const int x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < channels; ++c)
+            {
+                const int sum = source[(y0 * width + x0) * channels + c] + source[(y0 * width + x1) * channels + c] + source[(y1 * width + x0) * channels + c] +
+                                source[(y1 * width + x1) * channels + c];
+                result[static_cast<std::size_t>((y * out_width + x) * channels + c)] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<unsigned char> shrink_rgba_to_fit(const unsigned char* source, int width, int height, int max_dimension, int& out_width, int& out_height, int channels)
+{
+    const auto texel  = static_cast<std::size_t>(channels);
+    const int  longer = std::max(width, height);
+    if (max_dimension <= 0 || longer <= max_dimension)
+    {
+        out_width  = width;
+        out_height = height;
+        return std::vector<unsigned char>(source, source + static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * texel);
+    }
+    const double scale         = static_cast<double>(max_dimension) / static_cast<double>(longer);
+    const int    target_width  = std::clamp(static_cast<int>(std::lround(width * scale)), 1, max_dimension);
+    const int    target_height = std::clamp(static_cast<int>(std::lround(height * scale)), 1, max_dimension);
+
+    std::vector<unsigned char> halved;
+    const unsigned char*       pixels = source;
+    while (width / 2 >= target_width && height / 2 >= target_height)
+    {
+        int half_width  = 0;
+        int half_height = 0;
+        halved          = downsample_rgba(pixels, width, height, half_width, half_height, channels);
+        pixels          = halved.data();
+        width           = half_width;
+        height          = half_height;
+    }
+    out_width  = target_width;
+    out_height = target_height;
+    if (width == target_width && height == target_height)
+        return halved;
+
+    std::vector<Footprint> columns;
+    std::vector<Footprint> rows;
+    std::vector<float>     column_weights;
+    std::vector<float>     row_weights;
+    build_footprints(width, target_width, columns, column_weights);
+    build_footprints(height, target_height, rows, row_weights);
+
+    // rows first into floats, a row of the output at a time, then the columns of those rows
+    std::vector<float>         row_sum(static_cast<std::size_t>(width) * texel);
+    std::vector<unsigned char> result(static_cast<std::size_t>(target_width) * static_cast<std::size_t>(target_height) * texel);
+    for (int y = 0; y < target_height; ++y)
+    {
+        const Footprint& row = rows[static_cast<std::size_t>(y)];
+        std::fill(row_sum.begin(), row_sum.end(), 0.0f);
+        for (int tap = 0; tap < row.count; ++tap)
+        {
+            const float          weight = row_weights[static_cast<std::size_t>(row.taps + tap)];
+            const unsigned char* line   = pixels + static_cast<std::size_t>(row.first + tap) * static_cast<std::size_t>(width) * texel;
+            for (std::size_t i = 0; i < row_sum.size(); ++i)
+                row_sum[i] += weight * static_cast<float>(line[i]);
+        }
+        unsigned char* out = result.data() + static_cast<std::size_t>(y) * static_cast<std::size_t>(target_width) * texel;
+        for (int x = 0; x < target_width; ++x)
+        {
+            const Footprint& column = columns[static_cast<std::size_t>(x)];
+            float            sum[4] = {};
+            for (int tap = 0; tap < column.count; ++tap)
+            {
+                const float  weight = column_weights[static_cast<std::size_t>(column.taps + tap)];
+                const float* taps   = row_sum.data() + static_cast<std::size_t>(column.first + tap) * texel;
+                for (int c = 0; c < channels; ++c)
+                    sum[c] += weight * taps[c];
+            }
+            for (int c = 0; c < channels; ++c)
+                out[x * channels + c] = static_cast<unsigned char>(std::min(sum[c] + 0.5f, 255.0f));
+        }
+    }
+    return result;
+}
+
+std::vector<std::vector<unsigned char>> build_mip_chain(const unsigned char* pixels, int width, int height, int channels)
+{
+    std::vector<std::vector<unsigned char>> levels;
+    const unsigned char*                    source = pixels;
+    while (width > 1 || height > 1)
+    {
+        int next_width  = 0;
+        int next_height = 0;
+        levels.push_back(downsample_rgba(source, width, height, next_width, next_height, channels));
+        source = levels.back().data();
+        width  = next_width;
+        height = next_height;
+    }
+    return levels;
+}
+
+int mip_level_count(int width, int height) noexcept
+{
+    int levels = 1;
+    while (width > 1 || height > 1)
+    {
+        width  = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        ++levels;
+    }
+    return levels;
+}
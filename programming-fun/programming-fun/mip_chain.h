@@ -0,0 +1,25 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <vector>
+
+// These take RGBA8 by default, or 8 bit texels of `channels` components: R8, RG8 or RGB8
+
+// 2x2 box filter of an RGBA8 image; odd edges reuse the last row/column
+std::vector<unsigned char> downsample_rgba(const unsigned char* source, int width, int height, int& out_width, int& out_height, int channels = 4);
+
+// An RGBA8 image whose longer side is over `max_dimension`, shrunk to fit with its aspect kept: 2x2 halvings while
+// they don't undershoot, then one area-weighted pass for the rest. An image that already fits is copied as it is.
+std::vector<unsigned char> shrink_rgba_to_fit(const unsigned char* source, int width, int height, int max_dimension, int& out_width, int& out_height, int channels = 4);
+
+// Levels 1 down to 1x1 of an RGBA8 image; level 0 is the source itself and is not copied
+std::vector<std::vector<unsigned char>> build_mip_chain(const unsigned char* pixels, int width, int height, int channels = 4);
+
+// Number of levels in a full chain, including level 0
+int mip_level_count(int width, int height) noexcept;
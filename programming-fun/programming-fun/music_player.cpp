@@ -0,0 +1,217 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "music_player.h"
+
+#include "logger.h"
+#include "profiler.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+void MusicPlayer::Setup(AudioStreamer& audio_streamer)
+{
+    streamer = &audio_streamer;
+}
+
+void MusicPlayer::SetPlaylist(std::vector<Track> tracks)
+{
+    Stop();
+    playlist = std::move(tracks);
+}
+
+void MusicPlayer::SetCrossfade(double seconds) noexcept
+{
+    crossfade_seconds = std::max(seconds, 0.0);
+}
+
+double MusicPlayer::Crossfade() const noexcept
+{
+    return crossfade_seconds;
+}
+
+void MusicPlayer::SetGain(float new_gain)
+{
+    gain = new_gain;
+    // mid fade, Update scales both tracks by it
+    if (current != nullptr && !is_fading)
+        current->SetGain(gain);
+}
+
+void MusicPlayer::Play(int track)
+{
+    Stop();
+    if (streamer == nullptr || playlist.empty())
+        return;
+    current_track = std::clamp(track, 0, static_cast<int>(playlist.size()) - 1);
+    current       = open(current_track);
+    if (current == nullptr)
+    {
+        current_track = -1;
+        return;
+    }
+    current->SetGain(gain);
+    current->Play();
+}
+
+void MusicPlayer::Next()
+{
+    if (current == nullptr)
+        return;
+    if (is_fading)
+        finishFade();
+    if (next_track < 0)
+        preload();
+    if (next != nullptr)
+        startFade();
+}
+
+void MusicPlayer::Stop()
+{
+    close(next);
+    close(current);
+    current_track = -1;
+    next_track    = -1;
+    is_fading     = false;
+    fade          = 0.0;
+}
+
+bool MusicPlayer::IsPlaying() const noexcept
+{
+    return current != nullptr;
+}
+
+void MusicPlayer::Update()
+{
+    PROFILE_ZONE("MusicPlayer::Update");
+    if (current == nullptr)
+        return;
+    if (is_fading)
+    {
+        const double elapsed = static_cast<double>(SDL_GetPerformanceCounter() - fade_started) / static_cast<double>(SDL_GetPerformanceFrequency());
+        fade                 = crossfade_seconds > 0.0 ? std::min(elapsed / crossfade_seconds, 1.0) : 1.0;
+        // equal power: cos² + sin² = 1, so the overlap doesn't dip the way a linear fade does
+        const float angle = static_cast<float>(fade) * glm::half_pi<float>();
+        current->SetGain(gain * std::cos(angle));
+        next->SetGain(gain * std::sin(angle));
+        if (fade >= 1.0)
+            finishFade();
+        return;
+    }
+
+    const double left = secondsLeft();
+    // next_track is set even when opening it failed, so a broken track is tried once, not every frame
+    if (next_track < 0 && left <= crossfade_seconds + PRELOAD_SECONDS)
+        preload();
+    if (next != nullptr && (left <= crossfade_seconds || !current->IsPlaying()))
+    {
+        startFade();
+    }
+    else if (!current->IsPlaying())
+    {
+        close(current);
+        current_track = -1;
+        next_track    = -1;
+    }
+}
+
+MusicPlayer::Stats MusicPlayer::GetStats() const
+{
+    Stats result;
+    result.track           = current_track;
+    result.next_track      = next != nullptr ? next_track : -1;
+    result.fade            = is_fading ? fade : 0.0;
+    result.crossfades      = crossfades;
+    result.last_preload_ms = last_preload_ms;
+    for (const AudioStream* stream : { current.get(), next.get() })
+    {
+        if (stream == nullptr)
+            continue;
+        ++result.open_streams;
+        result.ring_bytes += static_cast<std::size_t>(AudioStream::BUFFER_COUNT) * AudioStream::FRAMES_PER_BUFFER * static_cast<std::size_t>(stream->Channels()) * sizeof(short);
+    }
+    if (current != nullptr && current->SampleRate() > 0)
+    {
+        const double rate = current->SampleRate();
+        result.position   = std::max(static_cast<double>(current->PlayedFrames()), 0.0) / rate;
+        result.length     = current->LengthFrames() / rate;
+    }
+    return result;
+}
+
+void MusicPlayer::Shutdown()
+{
+    Stop();
+    playlist.clear();
+    streamer = nullptr;
+}
+
+std::shared_ptr<AudioStream> MusicPlayer::open(int track)
+{
+    const Track&                 entry  = playlist[static_cast<std::size_t>(track)];
+    std::shared_ptr<AudioStream> stream = entry.bytes.empty() ? streamer->Open(entry.path) : streamer->Open(entry.bytes);
+    if (stream == nullptr)
+        LOG_WARN("Can't stream music track ", track, ": ", entry.path);
+    return stream;
+}
+
+void MusicPlayer::close(std::shared_ptr<AudioStream>& stream)
+{
+    if (stream == nullptr)
+        return;
+    streamer->Close(stream);
+    stream.reset();
+}
+
+void MusicPlayer::preload()
+{
+    PROFILE_ZONE("MusicPlayer::preload");
+    const Uint64 started = SDL_GetPerformanceCounter();
+    // a playlist of one crossfades into a second copy of itself
+    next_track           = following(current_track);
+    next                 = open(next_track);
+    if (next != nullptr && !next->Prime(0))
+        close(next);
+    last_preload_ms = static_cast<double>(SDL_GetPerformanceCounter() - started) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+void MusicPlayer::startFade()
+{
+    next->SetGain(0.0f);
+    next->Start();
+    is_fading    = true;
+    fade_started = SDL_GetPerformanceCounter();
+    fade         = 0.0;
+    ++crossfades;
+}
+
+void MusicPlayer::finishFade()
+{
+    close(current);
+    current       = std::move(next);
+    current_track = next_track;
+    next_track    = -1;
+    is_fading     = false;
+    fade          = 0.0;
+    current->SetGain(gain);
+}
+
+double MusicPlayer::secondsLeft() const
+{
+    // an unknown length never comes due; the track ending starts the next one instead
+    const std::uint32_t length = current->LengthFrames();
+    if (length == 0 || current->SampleRate() <= 0)
+        return crossfade_seconds + PRELOAD_SECONDS + 1.0;
+    return static_cast<double>(static_cast<std::int64_t>(length) - current->PlayedFrames()) / current->SampleRate();
+}
+
+int MusicPlayer::following(int track) const noexcept
+{
+    return (track + 1) % static_cast<int>(playlist.size());
+}
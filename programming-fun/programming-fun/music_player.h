@@ -0,0 +1,105 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "audio_stream.h"
+
+#include <SDL_stdinc.h>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+/**
+ * Background music: a playlist of OGG tracks streamed one after the other, each crossfading into the next.
+ *
+ * At most two AudioStreams are open at once, the track that's playing and the one after it, so what music
+ * holds in memory is two stream rings whatever the tracks' lengths. The next track is opened and primed (its
+ * whole ring decoded, the source left stopped) PRELOAD_SECONDS before the crossfade is due, so starting it
+ * costs nothing on the frame the fade begins; the fade itself is equal power, the outgoing track's gain
+ * following a cosine and the incoming one's a sine, so the sum stays level through the overlap. When the
+ * outgoing track's fade ends it is closed and the incoming one becomes the current track.
+ *
+ * Everything is the main thread's; the AudioStreamer that opened the streams keeps their queues topped up.
+ */
+class MusicPlayer
+{
+public:
+    static constexpr double DEFAULT_CROSSFADE_SECONDS = 3.0;
+    static constexpr double PRELOAD_SECONDS           = 2.0; // ahead of the crossfade
+
+    // A path, or bytes (e.g. an AssetPack view) that outlive the player
+    struct Track
+    {
+        std::filesystem::path          path;
+        std::span<const unsigned char> bytes;
+    };
+
+    struct Stats
+    {
+        int         track           = -1; // playing, -1 when stopped
+        int         next_track      = -1; // primed, -1 until PRELOAD_SECONDS before the crossfade
+        double      position        = 0.0;
+        double      length          = 0.0;
+        double      fade            = 0.0; // 0 to 1 through a crossfade
+        int         open_streams    = 0;
+        std::size_t ring_bytes      = 0; // every open stream's ring
+        int         crossfades      = 0;
+        double      last_preload_ms = 0.0; // opening and priming the next track
+    };
+
+    MusicPlayer() = default;
+
+    MusicPlayer(const MusicPlayer&)                = delete;
+    MusicPlayer& operator=(const MusicPlayer&)     = delete;
+    MusicPlayer(MusicPlayer&&) noexcept            = delete;
+    MusicPlayer& operator=(MusicPlayer&&) noexcept = delete;
+
+    void   Setup(AudioStreamer& audio_streamer);
+    // Stops what's playing
+    void   SetPlaylist(std::vector<Track> tracks);
+    void   SetCrossfade(double seconds) noexcept;
+    double Crossfade() const noexcept;
+    void   SetGain(float gain);
+
+    void Play(int track = 0);
+    // Crossfades into the next track now
+    void Next();
+    void Stop();
+    bool IsPlaying() const noexcept;
+
+    // Once a frame
+    void  Update();
+    Stats GetStats() const;
+    void  Shutdown();
+
+private:
+    std::shared_ptr<AudioStream> open(int track);
+    void                         close(std::shared_ptr<AudioStream>& stream);
+    void                         preload();
+    void                         startFade();
+    void                         finishFade();
+    double                       secondsLeft() const;
+    int                          following(int track) const noexcept;
+
+private:
+    AudioStreamer*               streamer = nullptr;
+    std::vector<Track>           playlist;
+    std::shared_ptr<AudioStream> current;
+    std::shared_ptr<AudioStream> next;
+    int                          current_track     = -1;
+    int                          next_track        = -1;
+    double                       crossfade_seconds = DEFAULT_CROSSFADE_SECONDS;
+    float                        gain              = 1.0f;
+    bool                         is_fading         = false;
+    Uint64                       fade_started      = 0; // SDL_GetPerformanceCounter
+    double                       fade              = 0.0;
+    int                          crossfades        = 0;
+    double                       last_preload_ms   = 0.0;
+};
@@ -0,0 +1,240 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+/**
+ * A slot index and the generation it was issued in, packed into 32 bits so it costs what an index does.
+ *
+ * The low INDEX_BITS are the slot, the rest its generation, which is never 0 for an issued handle, so a
+ * default handle is invalid. The generation wraps after GENERATION_MASK reuses of one slot, so a handle
+ * kept across that many is the only kind that can resolve to the wrong object. `Tag` keeps handles of
+ * different pools from converting into each other.
+ */
+template <typename Tag>
+class PoolHandle
+{
+public:
+    static constexpr std::uint32_t INDEX_BITS      = 20;
+    static constexpr std::uint32_t MAX_SLOTS       = 1u << INDEX_BITS;
+    static constexpr std::uint32_t INDEX_MASK      = MAX_SLOTS - 1;
+    static constexpr std::uint32_t GENERATION_MASK = 0xFFFFFFFFu >> INDEX_BITS;
+
+    PoolHandle() = default;
+
+    // `generation` is kept to its low bits; 0 makes an invalid handle
+    static constexpr PoolHandle Make(std::uint32_t index, std::uint32_t generation) noexcept
+    {
+        assert(index < MAX_SLOTS);
+        PoolHandle handle;
+        handle.bits = (generation & GENERATION_MASK) == 0 ? 0 : ((generation & GENERATION_MASK) << INDEX_BITS) | index;
+        return handle;
+    }
+
+    // The one after `generation`, wrapping past 0
+    static constexpr std::uint32_t NextGeneration(std::uint32_t generation) noexcept
+    {
+        const std::uint32_t next = (generation + 1) & GENERATION_MASK;
+        return next == 0 ? 1 : next;
+    }
+
+    constexpr std::uint32_t Index() const noexcept
+    {
+        return bits & INDEX_MASK;
+    }
+
+    constexpr std::uint32_t Generation() const noexcept
+    {
+        return bits >> INDEX_BITS;
+    }
+
+    constexpr std::uint32_t Bits() const noexcept
+    {
+        return bits;
+    }
+
+    constexpr bool IsValid() const noexcept
+    {
+        return bits != 0;
+    }
+
+    friend constexpr bool operator==(const PoolHandle&, const PoolHandle&) = default;
+
+private:
+    std::uint32_t bits = 0;
+};
+
+/**
+ * Objects that come and go behind generational handles, stored contiguously for iteration.
+ *
+ * The objects live packed in one array with no holes, so Items walks them like a vector. Handles go
+ * through a sparse set like EntityStore's: each names a slot holding the object's dense index and its
+ * generation, bumped on Erase so old handles stop resolving. Erase moves the last object into the hole,
+ * which changes its dense index but never its handle, and puts the slot on a free list that Insert takes
+ * from first. Capacity is fixed up front: Insert past it fails instead of growing, so a pool sized for its
+ * worst case never reallocates and pointers from Get stay good until the next Insert or Erase.
+ */
+template <typename T, typename Tag>
+class ObjectPool
+{
+public:
+    using Handle = PoolHandle<Tag>;
+
+    explicit ObjectPool(std::uint32_t capacity = Handle::MAX_SLOTS)
+    {
+        SetCapacity(capacity);
+    }
+
+    // Never below Size(); slots keep their generations, so handles from before stay stale
+    void SetCapacity(std::uint32_t capacity)
+    {
+        assert(capacity >= items.size() && capacity <= Handle::MAX_SLOTS);
+        max_items = capacity;
+        if (capacity < Handle::MAX_SLOTS)
+        {
+            items.reserve(capacity);
+            dense_slots.reserve(capacity);
+            slots.reserve(capacity);
+        }
+    }
+
+    // An invalid handle when the pool is full
+    Handle Insert(T value)
+    {
+        if (items.size() >= max_items)
+            return {};
+        std::uint32_t slot = free_slot;
+        if (slot == NO_SLOT)
+        {
+            slot = static_cast<std::uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        else
+        {
+            free_slot = slots[slot].index;
+        }
+        slots[slot].index = static_cast<std::uint32_t>(items.size());
+        items.push_back(std::move(value));
+        dense_slots.push_back(slot);
+        return Handle::Make(slot, slots[slot].generation);
+    }
+
+    // false when the handle was already stale
+    bool Erase(Handle handle)
+    {
+        if (!Contains(handle))
+            return false;
+        Slot&               slot = slots[handle.Index()];
+        const std::uint32_t hole = slot.index;
+        const std::size_t   last = items.size() - 1;
+        if (hole != last)
+        {
+            items[hole]                    = std::move(items[last]);
+            dense_slots[hole]              = dense_slots[last];
+            slots[dense_slots[hole]].index = hole;
+        }
+        items.pop_back();
+        dense_slots.pop_back();
+
+        slot.generation = Handle::NextGeneration(slot.generation);
+        slot.index      = free_slot;
+        free_slot       = handle.Index();
+        return true;
+    }
+
+    void Clear()
+    {
+        while (!items.empty())
+            Erase(HandleAt(items.size() - 1));
+    }
+
+    bool Contains(Handle handle) const noexcept
+    {
+        const std::uint32_t slot = handle.Index();
+        return handle.IsValid() && slot < slots.size() && slots[slot].generation == handle.Generation() && slots[slot].index < dense_slots.size() &&
+               dense_slots[slots[slot].index] == slot;
+    }
+
+    // nullptr for a stale handle
+    T* Get(Handle handle) noexcept
+    {
+        return Contains(handle) ? &items[slots[handle.Index()].index] : nullptr;
+    }
+
+    const T* Get(Handle handle) const noexcept
+    {
+        return Contains(handle) ? &items[slots[handle.Index()].index] : nullptr;
+    }
+
+    // Size() for a stale handle
+    std::size_t IndexOf(Handle handle) const noexcept
+    {
+        return Contains(handle) ? slots[handle.Index()].index : items.size();
+    }
+
+    Handle HandleAt(std::size_t index) const noexcept
+    {
+        if (index >= dense_slots.size())
+            return {};
+        const std::uint32_t slot = dense_slots[index];
+        return Handle::Make(slot, slots[slot].generation);
+    }
+
+    std::size_t Size() const noexcept
+    {
+        return items.size();
+    }
+
+    std::uint32_t Capacity() const noexcept
+    {
+        return max_items;
+    }
+
+    bool IsEmpty() const noexcept
+    {
+        return items.empty();
+    }
+
+    bool IsFull() const noexcept
+    {
+        return items.size() >= max_items;
+    }
+
+    // Dense, in no particular order; Erase reorders it
+    std::span<T> Items() noexcept
+    {
+        return items;
+    }
+
+    std::span<const T> Items() const noexcept
+    {
+        return items;
+    }
+
+private:
+    static constexpr std::uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+    struct Slot
+    {
+        std::uint32_t index      = 0; // dense, or the next free slot once erased
+        std::uint32_t generation = 1;
+    };
+
+private:
+    std::vector<T>             items;
+    std::vector<std::uint32_t> dense_slots;
+    std::vector<Slot>          slots;
+    std::uint32_t              free_slot = NO_SLOT;
+    std::uint32_t              max_items = 0;
+};
@@ -0,0 +1,584 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "particle_system.h"
+
+#include "gl_backend.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <glm/gtc/type_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+    static_assert(ParticleSystem::MAX_EMITTERS == 8, "the shaders size their emitter arrays by hand");
+
+    // both update paths: the slots from uSpawnBegin on respawn, by emitter in order, and the rest age and fall
+    constexpr const char* SIMULATE_SOURCE = R"(
+uniform vec4  uEmitterOrigin[8]; // position, velocity
+uniform vec4  uEmitterShape[8];  // spread, speed variation, min life, max life
+uniform float uEmitterSpin[8];
+uniform uint  uSpawnEnd[8];
+uniform int   uEmitterCount;
+uniform uint  uSpawnBegin;
+uniform uint  uCapacity;
+uniform uint  uSeed;
+uniform float uDelta;
+uniform vec2  uGravity;
+
+uint hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float random01(inout uint state)
+{
+    state = hash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+float random11(inout uint state)
+{
+    return random01(state) * 2.0 - 1.0;
+}
+
+// motion: position, velocity; life: age, lifetime, emitter, spin
+void simulate(uint index, inout vec4 motion, inout vec4 life)
+{
+    uint spawn = (index + uCapacity - uSpawnBegin) % uCapacity;
+    if (uEmitterCount > 0 && spawn < uSpawnEnd[uEmitterCount - 1])
+    {
+        int emitter = 0;
+        while (spawn >= uSpawnEnd[emitter])
+            ++emitter;
+        uint  state  = hash(index ^ uSeed);
+        vec4  origin = uEmitterOrigin[emitter];
+        vec4  shape  = uEmitterShape[emitter];
+        float base   = length(origin.zw);
+        float speed  = base * (1.0 + shape.y * random11(state));
+        float angle  = (base > 0.0 ? atan(origin.w, origin.z) : 0.0) + shape.x * random11(state);
+        motion       = vec4(origin.xy, cos(angle) * speed, sin(angle) * speed);
+        life         = vec4(0.0, mix(shape.z, shape.w, random01(state)), float(emitter), uEmitterSpin[emitter] * random11(state));
+        return;
+    }
+    if (life.x >= life.y)
+        return;
+    life.x    += uDelta;
+    motion.zw += uGravity * uDelta;
+    motion.xy += motion.zw * uDelta;
+}
+)";
+
+    // both draw paths: a quad per particle, corners from gl_VertexID like the sprite batch
+    constexpr const char* PLACE_SOURCE = R"(
+uniform mat4 uProjection;
+uniform vec4 uUVRect;
+uniform vec2 uEmitterSize[8]; // start, end
+uniform vec4 uEmitterStart[8];
+uniform vec4 uEmitterEnd[8];
+
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void place(vec4 motion, vec4 life)
+{
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vTexCoord   = mix(uUVRect.xy, uUVRect.zw, corner);
+    if (life.x >= life.y)
+    {
+        // every corner in the same place outside the view, so the quad covers nothing
+        vColor      = vec4(0.0);
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+    int   emitter = clamp(int(life.z), 0, 7);
+    float t       = life.x / life.y;
+    vec2  size    = uEmitterSize[emitter];
+    vec2  local   = (corner - 0.5) * mix(size.x, size.y, t);
+    float angle   = life.w * life.x;
+    float c       = cos(angle);
+    float s       = sin(angle);
+    vec2  world   = motion.xy + vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+    vColor        = mix(uEmitterStart[emitter], uEmitterEnd[emitter], t);
+    gl_Position   = uProjection * vec4(world, 0.0, 1.0);
+}
+)";
+
+    constexpr const char* DRAW_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+in vec4 vColor;
+
+uniform sampler2D uTexture;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture(uTexture, vTexCoord) * vColor;
+}
+)";
+
+    constexpr const char* FEEDBACK_VERTEX_SHADER = R"(
+layout(location = 0) in vec4 aMotion;
+layout(location = 1) in vec4 aLife;
+
+out vec4 vMotion;
+out vec4 vLife;
+
+void main()
+{
+    vMotion = aMotion;
+    vLife   = aLife;
+    simulate(uint(gl_VertexID), vMotion, vLife);
+    gl_Position = vec4(0.0);
+}
+)";
+
+    // never runs with the rasterizer off, but ES won't link a program without one
+    constexpr const char* FEEDBACK_FRAGMENT_SHADER = R"(
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = vec4(0.0);
+}
+)";
+
+    constexpr const char* FEEDBACK_VARYINGS[] = { "vMotion", "vLife" };
+
+    constexpr const char* FEEDBACK_DRAW_VERTEX_SHADER = R"(
+layout(location = 0) in vec4 aMotion;
+layout(location = 1) in vec4 aLife;
+
+void main()
+{
+    place(aMotion, aLife);
+}
+)";
+
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    constexpr const char* COMPUTE_PREAMBLE = "#version 430 core\n";
+    constexpr GLuint      GROUP_SIZE       = 256;
+
+    // one global atomic per group rather than per particle appends the live ones and counts the draw's instances
+    constexpr const char* COMPUTE_SHADER = R"(
+layout(local_size_x = 256) in;
+
+struct Particle
+{
+    vec4 motion;
+    vec4 life;
+};
+
+layout(std430, binding = 0) buffer Particles
+{
+    Particle particles[];
+};
+
+layout(std430, binding = 1) writeonly buffer Alive
+{
+    uint alive[];
+};
+
+layout(std430, binding = 2) buffer Command
+{
+    uint vertex_count;
+    uint instance_count;
+    uint first_vertex;
+    uint base_instance;
+};
+
+shared uint group_alive;
+shared uint group_base;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (gl_LocalInvocationIndex == 0u)
+        group_alive = 0u;
+    barrier();
+
+    bool is_alive = false;
+    uint slot     = 0u;
+    if (index < uCapacity)
+    {
+        vec4 motion = particles[index].motion;
+        vec4 life   = particles[index].life;
+        simulate(index, motion, life);
+        particles[index].motion = motion;
+        particles[index].life   = life;
+        is_alive                = life.x < life.y;
+        if (is_alive)
+            slot = atomicAdd(group_alive, 1u);
+    }
+    barrier();
+    if (gl_LocalInvocationIndex == 0u)
+        group_base = atomicAdd(instance_count, group_alive);
+    barrier();
+    if (is_alive)
+        alive[group_base + slot] = index;
+}
+)";
+
+    constexpr const char* COMPUTE_DRAW_VERTEX_SHADER = R"(
+struct Particle
+{
+    vec4 motion;
+    vec4 life;
+};
+
+layout(std430, binding = 0) readonly buffer Particles
+{
+    Particle particles[];
+};
+
+layout(std430, binding = 1) readonly buffer Alive
+{
+    uint alive[];
+};
+
+void main()
+{
+    Particle particle = particles[alive[gl_InstanceID]];
+    place(particle.motion, particle.life);
+}
+)";
+
+    // glDrawArraysIndirect's command; the dispatch counts the instances
+    struct DrawCommand
+    {
+        GLuint vertex_count   = 4;
+        GLuint instance_count = 0;
+        GLuint first_vertex   = 0;
+        GLuint base_instance  = 0;
+    };
+#endif
+
+    std::string join(const char* first, const char* second)
+    {
+        return std::string{ first } + second;
+    }
+
+    std::uint32_t next_seed(std::uint32_t seed) noexcept
+    {
+        return seed * 1664525u + 1013904223u;
+    }
+}
+
+void ParticleSystem::Setup(int new_capacity)
+{
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    // the draw reads the particles in its vertex shader, where GL 4.3 only promises storage buffers in compute
+    GLint vertex_blocks = 0;
+    if (GLEW_VERSION_4_3)
+        glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &vertex_blocks);
+    use_compute = vertex_blocks >= 2;
+    if (use_compute)
+    {
+        update_program.RequestCompute(join(SIMULATE_SOURCE, COMPUTE_SHADER), COMPUTE_PREAMBLE);
+        draw_program.Request(join(PLACE_SOURCE, COMPUTE_DRAW_VERTEX_SHADER), DRAW_FRAGMENT_SHADER, COMPUTE_PREAMBLE);
+    }
+#endif
+    if (!use_compute)
+    {
+        update_program.RequestFeedback(join(SIMULATE_SOURCE, FEEDBACK_VERTEX_SHADER), FEEDBACK_FRAGMENT_SHADER, FEEDBACK_VARYINGS);
+        draw_program.Request(join(PLACE_SOURCE, FEEDBACK_DRAW_VERTEX_SHADER), DRAW_FRAGMENT_SHADER);
+        glGenVertexArrays(1, &update_vertex_array);
+    }
+    // the compute draw has no attributes, but core profiles still want a vertex array bound
+    glGenVertexArrays(1, &draw_vertex_array);
+    SetCapacity(new_capacity);
+}
+
+void ParticleSystem::Shutdown()
+{
+    release();
+    update_program.Reset();
+    draw_program.Reset();
+    gl_state::DeleteVertexArray(update_vertex_array);
+    gl_state::DeleteVertexArray(draw_vertex_array);
+    update_vertex_array = 0;
+    draw_vertex_array   = 0;
+    update_locations    = {};
+    draw_locations      = {};
+    use_compute         = false;
+    capacity            = 0;
+}
+
+void ParticleSystem::SetCapacity(int new_capacity)
+{
+    new_capacity = std::max(1, new_capacity);
+    if (new_capacity == capacity)
+        return;
+    release();
+    capacity = new_capacity;
+    allocate();
+}
+
+int ParticleSystem::Capacity() const noexcept
+{
+    return capacity;
+}
+
+bool ParticleSystem::IsComputeAvailable() const noexcept
+{
+    return use_compute;
+}
+
+void ParticleSystem::Update(float delta_seconds, std::span<const ParticleEmitter> emitters, const glm::vec2& gravity)
+{
+    stats          = Stats{};
+    stats.capacity = capacity;
+    stats.compute  = use_compute;
+    if (capacity == 0 || delta_seconds <= 0.0f)
+        return;
+    if (!isReady(update_program, update_locations))
+    {
+        stats.pending = true;
+        return;
+    }
+
+    emitter_count = std::min(static_cast<int>(emitters.size()), MAX_EMITTERS);
+    GLuint total  = 0;
+    for (int i = 0; i < MAX_EMITTERS; ++i)
+    {
+        if (i >= emitter_count)
+        {
+            spawn_carry[i] = 0.0f;
+            spawn_end[i]   = total;
+            continue;
+        }
+        const ParticleEmitter& emitter = emitters[static_cast<std::size_t>(i)];
+        emitter_origin[i]              = glm::vec4{ emitter.position, emitter.velocity };
+        emitter_shape[i]               = glm::vec4{ emitter.spread, emitter.speed_variation, emitter.min_life, std::max(emitter.min_life, emitter.max_life) };
+        emitter_spin[i]                = emitter.spin;
+        emitter_size[i]                = glm::vec2{ emitter.start_size, emitter.end_size };
+        emitter_start[i]               = emitter.start_color;
+        emitter_end[i]                 = emitter.end_color;
+
+        // a step never wraps the ring onto its own spawns
+        const float wanted = std::min(std::max(emitter.rate, 0.0f) * delta_seconds + spawn_carry[i], static_cast<float>(capacity));
+        const auto  spawns = static_cast<GLuint>(wanted);
+        spawn_carry[i]     = wanted - static_cast<float>(spawns);
+        total              = std::min(total + spawns, static_cast<GLuint>(capacity));
+        spawn_end[i]       = total;
+    }
+    seed           = next_seed(seed);
+    stats.emitters = emitter_count;
+    stats.spawned  = static_cast<int>(total);
+
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    if (use_compute)
+        updateWithCompute(delta_seconds, gravity);
+    else
+#endif
+        updateWithFeedback(delta_seconds, gravity);
+    spawn_begin = (spawn_begin + total) % static_cast<std::uint32_t>(capacity);
+    has_stepped = true;
+}
+
+void ParticleSystem::Draw(const glm::mat4& projection, GLuint texture, const glm::vec4& uv_rect)
+{
+    if (!has_stepped || texture == 0)
+        return;
+    if (!isReady(draw_program, draw_locations))
+    {
+        stats.pending = true;
+        return;
+    }
+    gl_state::SetEnabled(GL_BLEND, true);
+    gl_state::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::UseProgram(draw_program.Id());
+    setDrawUniforms(draw_locations, projection, uv_rect);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(texture);
+    gl_state::BindVertexArray(draw_vertex_array);
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    if (use_compute)
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, particle_buffers[0]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, alive_buffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+        glDrawArraysIndirect(GL_TRIANGLE_STRIP, nullptr);
+        // how many were alive never leaves the GPU
+        gl_stats::CountDraw(0);
+    }
+    else
+#endif
+    {
+        // ES 3.0 has no indirect draws, so the dead particles go through the vertex shader too
+        glBindBuffer(GL_ARRAY_BUFFER, particle_buffers[current]);
+        vertex_layout::Bind(PARTICLE_LAYOUT);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, capacity);
+        gl_stats::CountDraw(2 * static_cast<long long>(capacity));
+    }
+    ++stats.draw_calls;
+}
+
+const ParticleSystem::Stats& ParticleSystem::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+void ParticleSystem::allocate()
+{
+    // all zero is every particle dead, aged 0 of a 0 second life
+    const std::vector<Particle> dead(static_cast<std::size_t>(capacity));
+    const auto                  bytes = static_cast<GLsizeiptr>(dead.size() * sizeof(Particle));
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    if (use_compute)
+    {
+        const DrawCommand command;
+        glGenBuffers(1, &particle_buffers[0]);
+        glGenBuffers(1, &alive_buffer);
+        glGenBuffers(1, &indirect_buffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, particle_buffers[0]);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, dead.data(), GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, alive_buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(dead.size() * sizeof(GLuint)), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(command), &command, GL_DYNAMIC_DRAW);
+        gl_stats::CountUpload(static_cast<std::size_t>(bytes));
+    }
+    else
+#endif
+    {
+        glGenBuffers(2, particle_buffers);
+        for (const GLuint buffer : particle_buffers)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBufferData(GL_ARRAY_BUFFER, bytes, dead.data(), GL_DYNAMIC_COPY);
+            gl_stats::CountUpload(static_cast<std::size_t>(bytes));
+        }
+        // the attributes are pointed at a buffer each frame, since which one that is alternates
+        gl_state::BindVertexArray(update_vertex_array);
+        vertex_layout::Enable(PARTICLE_LAYOUT);
+        gl_state::BindVertexArray(draw_vertex_array);
+        vertex_layout::Enable(vertex_layout::PerInstance(PARTICLE_LAYOUT));
+    }
+    current     = 0;
+    spawn_begin = 0;
+    has_stepped = false;
+}
+
+void ParticleSystem::release()
+{
+    for (GLuint& buffer : particle_buffers)
+    {
+        if (buffer != 0)
+            glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    if (alive_buffer != 0)
+        glDeleteBuffers(1, &alive_buffer);
+    if (indirect_buffer != 0)
+        glDeleteBuffers(1, &indirect_buffer);
+    alive_buffer    = 0;
+    indirect_buffer = 0;
+    has_stepped     = false;
+}
+
+bool ParticleSystem::isReady(ShaderProgram& program, Locations& locations)
+{
+    if (program.IsReady())
+        return true;
+    if (!program.Poll())
+        return false;
+    const GLuint id = program.Id();
+    const auto   at = [id](const char* name) { return glGetUniformLocation(id, name); };
+    // each program has only its half of these; the rest stay -1, which glUniform* ignores
+    locations.emitter_origin = at("uEmitterOrigin");
+    locations.emitter_shape  = at("uEmitterShape");
+    locations.emitter_spin   = at("uEmitterSpin");
+    locations.spawn_end      = at("uSpawnEnd");
+    locations.emitter_count  = at("uEmitterCount");
+    locations.spawn_begin    = at("uSpawnBegin");
+    locations.capacity       = at("uCapacity");
+    locations.seed           = at("uSeed");
+    locations.delta          = at("uDelta");
+    locations.gravity        = at("uGravity");
+    locations.projection     = at("uProjection");
+    locations.uv_rect        = at("uUVRect");
+    locations.emitter_size   = at("uEmitterSize");
+    locations.emitter_start  = at("uEmitterStart");
+    locations.emitter_end    = at("uEmitterEnd");
+    if (const GLint sampler = at("uTexture"); sampler >= 0)
+    {
+        gl_state::UseProgram(id);
+        glUniform1i(sampler, 0);
+    }
+    return true;
+}
+
+void ParticleSystem::setUpdateUniforms(const Locations& locations, float delta_seconds, const glm::vec2& gravity) const
+{
+    glUniform4fv(locations.emitter_origin, MAX_EMITTERS, glm::value_ptr(emitter_origin[0]));
+    glUniform4fv(locations.emitter_shape, MAX_EMITTERS, glm::value_ptr(emitter_shape[0]));
+    glUniform1fv(locations.emitter_spin, MAX_EMITTERS, emitter_spin);
+    glUniform1uiv(locations.spawn_end, MAX_EMITTERS, spawn_end);
+    glUniform1i(locations.emitter_count, emitter_count);
+    glUniform1ui(locations.spawn_begin, spawn_begin);
+    glUniform1ui(locations.capacity, static_cast<GLuint>(capacity));
+    glUniform1ui(locations.seed, seed);
+    glUniform1f(locations.delta, delta_seconds);
+    glUniform2f(locations.gravity, gravity.x, gravity.y);
+}
+
+void ParticleSystem::setDrawUniforms(const Locations& locations, const glm::mat4& projection, const glm::vec4& uv_rect) const
+{
+    glUniformMatrix4fv(locations.projection, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform4fv(locations.uv_rect, 1, glm::value_ptr(uv_rect));
+    glUniform2fv(locations.emitter_size, MAX_EMITTERS, glm::value_ptr(emitter_size[0]));
+    glUniform4fv(locations.emitter_start, MAX_EMITTERS, glm::value_ptr(emitter_start[0]));
+    glUniform4fv(locations.emitter_end, MAX_EMITTERS, glm::value_ptr(emitter_end[0]));
+}
+
+void ParticleSystem::updateWithCompute([[maybe_unused]] float delta_seconds, [[maybe_unused]] const glm::vec2& gravity)
+{
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    const DrawCommand command;
+    gl_backend::Get().buffer_sub_data(indirect_buffer, 0, sizeof(command), &command);
+    gl_state::UseProgram(update_program.Id());
+    setUpdateUniforms(update_locations, delta_seconds, gravity);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, particle_buffers[0]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, alive_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, indirect_buffer);
+    glDispatchCompute((static_cast<GLuint>(capacity) + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+    // the draw reads both storage buffers in its vertex shader and its command from the third
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+    ++stats.draw_calls;
+#endif
+}
+
+void ParticleSystem::updateWithFeedback(float delta_seconds, const glm::vec2& gravity)
+{
+    gl_state::UseProgram(update_program.Id());
+    setUpdateUniforms(update_locations, delta_seconds, gravity);
+    gl_state::BindVertexArray(update_vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, particle_buffers[current]);
+    vertex_layout::Bind(PARTICLE_LAYOUT);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, particle_buffers[1 - current]);
+    gl_state::SetEnabled(GL_RASTERIZER_DISCARD, true);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, capacity);
+    glEndTransformFeedback();
+    gl_state::SetEnabled(GL_RASTERIZER_DISCARD, false);
+    // WebGL refuses a draw while the buffer it reads is still bound for feedback
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    gl_stats::CountDraw(capacity);
+    ++stats.draw_calls;
+    current = 1 - current;
+}
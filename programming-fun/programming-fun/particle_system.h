@@ -0,0 +1,148 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "shader.h"
+#include "vertex_layout.h"
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+
+// Where particles come from and how they look over their life, in the sprite batch's units
+struct ParticleEmitter
+{
+    glm::vec2 position{ 0.0f };
+    glm::vec2 velocity{ 0.0f, -100.0f }; // per second, the direction the spread is centered on
+    float     spread          = 0.5f;    // radians either side of `velocity`
+    float     speed_variation = 0.25f;   // fraction of the speed either way
+    float     rate            = 1000.0f; // spawns per second
+    float     min_life        = 1.0f;    // seconds
+    float     max_life        = 2.0f;
+    float     start_size      = 16.0f;
+    float     end_size        = 4.0f;
+    float     spin            = 0.0f; // radians per second at most, either way
+    glm::vec4 start_color{ 1.0f };
+    glm::vec4 end_color{ 1.0f, 1.0f, 1.0f, 0.0f };
+};
+
+/**
+ * Particles simulated and drawn entirely on the GPU, for more of them than a CPU update could touch.
+ *
+ * The state lives in buffers that never come back to the CPU; each Update only sends the emitters and
+ * how many each spawns this step. Spawns take the next slots of a ring over the whole capacity, so a
+ * step costs one pass over every particle and nothing is allocated; too small a capacity cuts the oldest
+ * particles short. On desktop GL 4.3 a compute shader updates the storage buffer in place and appends the
+ * live ones to a list whose count writes the instance count of an indirect draw, so dead slots cost the
+ * draw nothing. Elsewhere (GL 3.3, ES 3.0 and WebGL2) transform feedback ping-pongs between two vertex
+ * buffers and the draw covers the whole capacity, dead particles collapsing to nothing in the vertex
+ * shader. Sprites are one texture, or an atlas region of one, alpha blended like the sprite batch.
+ */
+class ParticleSystem
+{
+public:
+    static constexpr int MAX_EMITTERS     = 8;
+    static constexpr int DEFAULT_CAPACITY = 1 << 17;
+
+    struct Stats
+    {
+        int  capacity   = 0;
+        int  emitters   = 0;
+        int  spawned    = 0;     // this Update
+        int  draw_calls = 0;     // including the compute dispatch or feedback pass
+        bool compute    = false; // compute and indirect draw, else transform feedback
+        bool pending    = false; // a program is still compiling, so nothing moved or was drawn
+    };
+
+    void Setup(int capacity = DEFAULT_CAPACITY);
+    void Shutdown();
+    // Drops every particle when it changes the capacity
+    void SetCapacity(int capacity);
+    int  Capacity() const noexcept;
+    bool IsComputeAvailable() const noexcept;
+
+    // One simulation step of `delta_seconds`; emitters past MAX_EMITTERS are ignored
+    void Update(float delta_seconds, std::span<const ParticleEmitter> emitters, const glm::vec2& gravity);
+    // With the emitters of the last Update, which the particles' sizes and colors follow
+    void Draw(const glm::mat4& projection, GLuint texture, const glm::vec4& uv_rect = { 0.0f, 0.0f, 1.0f, 1.0f });
+
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    // 32 bytes, the same in the storage buffer and the feedback buffers
+    struct Particle
+    {
+        glm::vec4 motion{ 0.0f }; // position, velocity
+        glm::vec4 life{ 0.0f };   // age, lifetime, emitter, spin; dead once age reaches lifetime
+    };
+
+    // what the feedback update reads; drawing reads it per instance
+    static constexpr auto PARTICLE_LAYOUT = vertex_layout::Make<Particle>(VertexAttribute{ 0, attribute_format::Float4, offsetof(Particle, motion) },
+                                                                          VertexAttribute{ 1, attribute_format::Float4, offsetof(Particle, life) });
+
+    struct Locations
+    {
+        GLint emitter_origin = -1;
+        GLint emitter_shape  = -1;
+        GLint emitter_spin   = -1;
+        GLint spawn_end      = -1;
+        GLint emitter_count  = -1;
+        GLint spawn_begin    = -1;
+        GLint capacity       = -1;
+        GLint seed           = -1;
+        GLint delta          = -1;
+        GLint gravity        = -1;
+        GLint projection     = -1;
+        GLint uv_rect        = -1;
+        GLint emitter_size   = -1;
+        GLint emitter_start  = -1;
+        GLint emitter_end    = -1;
+    };
+
+    void allocate();
+    void release();
+    // false while compiling; looks the uniforms up the first time it's ready
+    bool isReady(ShaderProgram& program, Locations& locations);
+    void setUpdateUniforms(const Locations& locations, float delta_seconds, const glm::vec2& gravity) const;
+    void setDrawUniforms(const Locations& locations, const glm::mat4& projection, const glm::vec4& uv_rect) const;
+    void updateWithCompute(float delta_seconds, const glm::vec2& gravity);
+    void updateWithFeedback(float delta_seconds, const glm::vec2& gravity);
+
+private:
+    ShaderProgram update_program; // compute, or vertex shader with feedback
+    ShaderProgram draw_program;
+    Locations     update_locations;
+    Locations     draw_locations;
+
+    bool   use_compute         = false;
+    GLuint particle_buffers[2] = {}; // only the first with compute; feedback reads one and writes the other
+    GLuint alive_buffer        = 0;  // compute: indices of the live particles
+    GLuint indirect_buffer     = 0;  // compute: the draw's command, its instance count written by the dispatch
+    GLuint update_vertex_array = 0;  // feedback: per vertex particles
+    GLuint draw_vertex_array   = 0;  // per instance particles with feedback, none with compute
+    int    current             = 0;  // feedback: which buffer holds the latest step
+    int    capacity            = 0;
+
+    // this step's emitters, packed the way the shaders take them
+    glm::vec4     emitter_origin[MAX_EMITTERS]{}; // position, velocity
+    glm::vec4     emitter_shape[MAX_EMITTERS]{};  // spread, speed variation, min life, max life
+    float         emitter_spin[MAX_EMITTERS]{};
+    glm::vec2     emitter_size[MAX_EMITTERS]{};
+    glm::vec4     emitter_start[MAX_EMITTERS]{};
+    glm::vec4     emitter_end[MAX_EMITTERS]{};
+    GLuint        spawn_end[MAX_EMITTERS]{};   // running total of the spawns, by emitter
+    float         spawn_carry[MAX_EMITTERS]{}; // fractions of a spawn left over from earlier steps
+    int           emitter_count = 0;
+    std::uint32_t spawn_begin   = 0;     // the ring slot this step's first spawn takes
+    std::uint32_t seed          = 0;
+    bool          has_stepped   = false; // there is something to draw
+    Stats         stats;
+};
@@ -0,0 +1,121 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "perf_counters.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace
+{
+    using perf_counters::MAX_COUNTERS;
+    using perf_counters::MAX_THREADS;
+
+    static_assert(profiler::MAX_COUNTERS >= MAX_COUNTERS, "every counter has to fit in the profiler's frame record");
+
+    struct ThreadSlot
+    {
+        std::array<std::atomic<long long>, MAX_COUNTERS> totals{};
+    };
+
+    // a thread's first Add can come during another file's static initialization
+    constinit std::array<ThreadSlot, MAX_THREADS>              gSlots;
+    constinit std::atomic<int>                                 gSlotCount{ 0 };
+    constinit std::array<std::atomic<long long>, MAX_COUNTERS> gGauges{};
+    // entries below gCount are written once by Register and only their values change after
+    constinit std::array<perf_counters::Sample, MAX_COUNTERS> gSamples{};
+    constinit std::atomic<int>                                 gCount{ 0 };
+    std::mutex                                                 gRegisterMutex;
+    thread_local ThreadSlot*                                   tSlot     = nullptr;
+    thread_local bool                                          tIsShared = false; // the last slot, which more threads may write
+
+    // main thread
+    std::array<long long, MAX_COUNTERS> gSeen{}; // the counters' sums at the last EndFrame
+    int                                 gPublished = 0;
+
+    ThreadSlot& this_slot() noexcept
+    {
+        if (tSlot == nullptr)
+        {
+            const int index = std::min(gSlotCount.fetch_add(1, std::memory_order_relaxed), MAX_THREADS - 1);
+            tSlot           = &gSlots[static_cast<std::size_t>(index)];
+            tIsShared       = index == MAX_THREADS - 1;
+        }
+        return *tSlot;
+    }
+}
+
+namespace perf_counters
+{
+    Handle Register(const char* name, Kind kind, std::uint8_t publish) noexcept
+    {
+        const std::lock_guard lock{ gRegisterMutex };
+        const int             count = gCount.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; ++i)
+        {
+            if (std::strcmp(gSamples[static_cast<std::size_t>(i)].name, name) == 0)
+                return Handle{ i };
+        }
+        if (count == MAX_COUNTERS)
+            return Handle{};
+        gSamples[static_cast<std::size_t>(count)] = Sample{ name, kind, publish, 0 };
+        gCount.store(count + 1, std::memory_order_release);
+        return Handle{ count };
+    }
+
+    void Add(Handle counter, long long amount) noexcept
+    {
+        if (!counter.IsValid())
+            return;
+        std::atomic<long long>& total = this_slot().totals[static_cast<std::size_t>(counter.index)];
+        if (tIsShared)
+            total.fetch_add(amount, std::memory_order_relaxed);
+        else
+            total.store(total.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void Set(Handle gauge, long long value) noexcept
+    {
+        if (gauge.IsValid())
+            gGauges[static_cast<std::size_t>(gauge.index)].store(value, std::memory_order_relaxed);
+    }
+
+    void EndFrame() noexcept
+    {
+        const int count = gCount.load(std::memory_order_acquire);
+        const int slots = std::min(gSlotCount.load(std::memory_order_relaxed), MAX_THREADS);
+        for (int i = 0; i < count; ++i)
+        {
+            const auto index  = static_cast<std::size_t>(i);
+            Sample&    sample = gSamples[index];
+            if (sample.kind == Kind::Gauge)
+            {
+                sample.value = gGauges[index].load(std::memory_order_relaxed);
+            }
+            else
+            {
+                long long sum = 0;
+                for (int slot = 0; slot < slots; ++slot)
+                    sum += gSlots[static_cast<std::size_t>(slot)].totals[index].load(std::memory_order_relaxed);
+                sample.value = sum - gSeen[index];
+                gSeen[index] = sum;
+            }
+            profiler::ReportCounter(sample.name, sample.value);
+        }
+        gPublished = count;
+    }
+
+    std::span<const Sample> LastFrame() noexcept
+    {
+        return std::span{ gSamples.data(), static_cast<std::size_t>(gPublished) };
+    }
+}
@@ -0,0 +1,71 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+/**
+ * Named numbers any subsystem publishes, gathered once a frame for the profiler, the perf HUD and telemetry.
+ *
+ * A name is registered once, on first use in a function-local static, and the Handle kept. A Counter is
+ * added to from any thread, into that thread's own slot with a relaxed load and store: no lock, and no cache
+ * line another thread writes. Its frame value is what every thread added since the last EndFrame. A Gauge is
+ * a level set from any thread, and its frame value is the latest.
+ *
+ * EndFrame sums the slots on the main thread and hands each value to profiler::ReportCounter, which plots it
+ * in Tracy, keeps its history for the Profiler window and writes it into captures as a counter track. Those
+ * registered InHud are also in PerfHud's overlay, and those InTelemetry go out with TelemetrySender.
+ */
+namespace perf_counters
+{
+    constexpr int MAX_COUNTERS = 32; // registrations past this get an invalid handle
+    constexpr int MAX_THREADS  = 64; // threads past this share the last slot
+
+    enum class Kind : std::uint8_t
+    {
+        Counter,
+        Gauge
+    };
+
+    enum Publish : std::uint8_t
+    {
+        InProfiler  = 0, // always
+        InHud       = 1 << 0,
+        InTelemetry = 1 << 1
+    };
+
+    struct Handle
+    {
+        int index = -1;
+
+        bool IsValid() const noexcept
+        {
+            return index >= 0;
+        }
+    };
+
+    struct Sample
+    {
+        const char*  name    = nullptr;
+        Kind         kind    = Kind::Gauge;
+        std::uint8_t publish = InProfiler;
+        long long    value   = 0;
+    };
+
+    // `name` must outlive the program (a string literal); registering a name again returns its handle
+    Handle Register(const char* name, Kind kind, std::uint8_t publish = InProfiler) noexcept;
+    // Any thread; an invalid handle is ignored
+    void Add(Handle counter, long long amount = 1) noexcept;
+    void Set(Handle gauge, long long value) noexcept;
+
+    // Main thread, once a frame before the profiler's frame ends
+    void EndFrame() noexcept;
+    // The last EndFrame's values, in registration order
+    std::span<const Sample> LastFrame() noexcept;
+}
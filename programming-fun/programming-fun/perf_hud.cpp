@@ -0,0 +1,170 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "perf_hud.h"
+
+#include "imgui_panels.h"
+#include "profiler.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <imgui.h>
+
+void FrameTimeWindow::Add(float ms) noexcept
+{
+    ms = std::max(ms, 0.0f);
+    if (count == WINDOW)
+    {
+        const float oldest = samples[static_cast<std::size_t>(next)];
+        --counts[static_cast<std::size_t>(bucketOf(oldest))];
+        sum -= static_cast<double>(oldest);
+    }
+    else
+    {
+        ++count;
+    }
+    samples[static_cast<std::size_t>(next)] = ms;
+    ++counts[static_cast<std::size_t>(bucketOf(ms))];
+    sum += static_cast<double>(ms);
+    next = (next + 1) % WINDOW;
+}
+
+int FrameTimeWindow::Count() const noexcept
+{
+    return count;
+}
+
+float FrameTimeWindow::Percentile(float fraction) const noexcept
+{
+    if (count == 0)
+        return 0.0f;
+    // the rank of the sample at `fraction`, counting from 1
+    const int rank = std::clamp(static_cast<int>(std::ceil(fraction * static_cast<float>(count))), 1, count);
+    int       seen = 0;
+    for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+    {
+        seen += counts[static_cast<std::size_t>(bucket)];
+        if (seen >= rank)
+            return std::min(static_cast<float>(bucket + 1) * BUCKET_MS, Max());
+    }
+    return Max();
+}
+
+float FrameTimeWindow::Max() const noexcept
+{
+    float highest = 0.0f;
+    for (int i = 0; i < count; ++i)
+        highest = std::max(highest, samples[static_cast<std::size_t>(i)]);
+    return highest;
+}
+
+float FrameTimeWindow::Mean() const noexcept
+{
+    return count == 0 ? 0.0f : static_cast<float>(sum / static_cast<double>(count));
+}
+
+const float* FrameTimeWindow::Samples() const noexcept
+{
+    return samples.data();
+}
+
+int FrameTimeWindow::Offset() const noexcept
+{
+    return count == WINDOW ? next : 0;
+}
+
+int FrameTimeWindow::bucketOf(float ms) noexcept
+{
+    return std::min(static_cast<int>(ms / BUCKET_MS), BUCKET_COUNT);
+}
+
+void PerfHud::Record(double frame_ms, double cpu_ms, double gpu_ms, double frame_budget_ms) noexcept
+{
+    frame.Add(static_cast<float>(frame_ms));
+    cpu.Add(static_cast<float>(cpu_ms));
+    if (gpu_ms >= 0.0)
+        gpu.Add(static_cast<float>(gpu_ms));
+    budget_ms = frame_budget_ms;
+    ++recent_hitch;
+    if (frame_budget_ms > 0.0 && frame_ms > frame_budget_ms)
+    {
+        ++hitches;
+        recent_hitch = 0;
+    }
+}
+
+void PerfHud::RecordLatency(double latency_ms) noexcept
+{
+    latency.Add(static_cast<float>(latency_ms));
+}
+
+void PerfHud::DrawOverlay(const Counters& counters)
+{
+    const Uint64         begin    = SDL_GetPerformanceCounter();
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + 10.0f, viewport->WorkPos.y + 10.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowViewport(viewport->ID);
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    constexpr ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings |
+                                       ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove;
+    // percentiles over a second of frames; a tenth of a second is as fast as anyone reads them
+    if (!imgui_panels::Begin("Performance HUD", 10.0f, nullptr, flags))
+    {
+        imgui_panels::End();
+        return;
+    }
+    const float mean_ms = frame.Mean();
+    ImGui::Text("%.1f fps, budget %.2f ms, %llu hitches (last %llu frames ago)", mean_ms > 0.0f ? 1000.0 / static_cast<double>(mean_ms) : 0.0, budget_ms,
+                static_cast<unsigned long long>(hitches), static_cast<unsigned long long>(recent_hitch));
+    if (ImGui::BeginTable("perf_hud", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit))
+    {
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableHeadersRow();
+        const auto row = [](const char* name, const FrameTimeWindow& window)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name);
+            if (window.Count() == 0)
+            {
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted("-");
+                return;
+            }
+            for (const float fraction : { 0.5f, 0.95f, 0.99f })
+            {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", static_cast<double>(window.Percentile(fraction)));
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", static_cast<double>(window.Max()));
+        };
+        row("frame", frame);
+        row("cpu", cpu);
+        row("gpu", gpu);
+        row("latency", latency);
+        ImGui::EndTable();
+    }
+    ImGui::PlotLines("##frame", frame.Samples(), frame.Count(), frame.Offset(), nullptr, 0.0f, static_cast<float>(std::max(budget_ms * 2.0, 1.0)), ImVec2(240.0f, 40.0f));
+    ImGui::Text("memory %.1f MB, %d draws, loads %d queued %d running", static_cast<double>(counters.memory_bytes) / (1024.0 * 1024.0), counters.draw_calls, counters.loads_queued,
+                counters.loads_active);
+    if (counters.allocations >= 0)
+        ImGui::Text("%d allocations, %.1f KB%s", counters.allocations, static_cast<double>(counters.allocated_bytes) / 1024.0, counters.is_steady ? " (steady)" : "");
+    for (const perf_counters::Sample& sample : counters.published)
+    {
+        if (sample.publish & perf_counters::InHud)
+            ImGui::Text("%s %lld", sample.name, sample.value);
+    }
+    ImGui::TextDisabled("hud %.3f ms", draw_ms);
+    imgui_panels::End();
+    draw_ms = profiler::ToMilliseconds(SDL_GetPerformanceCounter() - begin);
+}
@@ -0,0 +1,94 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "perf_counters.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * Moving percentiles of one time over the last WINDOW samples.
+ *
+ * A ring keeps the samples and a histogram keeps their counts in BUCKET_MS wide buckets up to
+ * BUCKET_COUNT * BUCKET_MS, with one more for everything slower; adding a sample takes the oldest one's
+ * count back out, so a percentile is one walk over the buckets and nothing is sorted or allocated. A
+ * percentile is its bucket's upper edge, so it reads at most BUCKET_MS high; one in the last bucket is
+ * the window's max, which is exact.
+ */
+class FrameTimeWindow
+{
+public:
+    static constexpr int   WINDOW       = 240;
+    static constexpr int   BUCKET_COUNT = 200;
+    static constexpr float BUCKET_MS    = 0.25f;
+
+    void Add(float ms) noexcept;
+
+    int   Count() const noexcept;
+    // `fraction` in [0, 1]; 0 when empty
+    float Percentile(float fraction) const noexcept;
+    float Max() const noexcept;
+    float Mean() const noexcept;
+    // Oldest first from Offset(), for ImGui::PlotLines
+    const float* Samples() const noexcept;
+    int          Offset() const noexcept;
+
+private:
+    static int bucketOf(float ms) noexcept;
+
+private:
+    std::array<float, WINDOW>                   samples{};
+    std::array<std::uint16_t, BUCKET_COUNT + 1> counts{};
+    int                                         next  = 0;
+    int                                         count = 0;
+    double                                      sum   = 0.0;
+};
+
+/**
+ * A small overlay with the frame's vitals: moving p50/p95/p99/max of the whole frame, the CPU's part
+ * and the GPU's and the input to photon estimate, FPS, frames over budget, tracked memory, draw calls, the
+ * loads waiting, the last frame's heap allocations and the perf counters published to it.
+ *
+ * Record takes one frame's times; the GPU's only when a new result came back, which never happens with
+ * the render thread. RecordLatency takes FramePacer's estimates as they arrive. Everything lives in fixed arrays, so neither Record nor DrawOverlay allocates, and
+ * the overlay shows what drawing it took last time. Main thread.
+ */
+class PerfHud
+{
+public:
+    struct Counters
+    {
+        std::size_t memory_bytes    = 0; // memory_tracker's categories together
+        int         draw_calls      = 0;
+        int         loads_queued    = 0;
+        int         loads_active    = 0;
+        int         allocations     = -1; // the last frame's heap allocations, -1 when they aren't counted
+        std::size_t allocated_bytes = 0;
+        bool        is_steady       = false; // settled, so any allocation is one too many
+        // perf_counters' last frame; those published InHud get a line each
+        std::span<const perf_counters::Sample> published;
+    };
+
+    // `gpu_ms` < 0 when no new GPU time arrived; a frame over `frame_budget_ms` counts as a hitch
+    void Record(double frame_ms, double cpu_ms, double gpu_ms, double frame_budget_ms) noexcept;
+    void RecordLatency(double latency_ms) noexcept;
+    void DrawOverlay(const Counters& counters);
+
+private:
+    FrameTimeWindow frame;
+    FrameTimeWindow cpu;
+    FrameTimeWindow gpu;
+    FrameTimeWindow latency;
+    double          budget_ms    = 0.0;
+    std::uint64_t   hitches      = 0;
+    std::uint64_t   recent_hitch = 0; // frames since the last one
+    double          draw_ms      = 0.0; // the last DrawOverlay's own cost
+};
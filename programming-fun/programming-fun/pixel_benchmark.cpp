@@ -0,0 +1,114 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "pixel_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <random>
+
+namespace
+{
+    // `prepare` puts the source back before each run, outside the timing, since the kernels work in place
+    template <typename Prepare, typename Work>
+    double best_ms(int runs, Prepare&& prepare, Work&& work)
+    {
+        using clock = std::chrono::steady_clock;
+        double best = 0.0;
+        for (int i = 0; i < runs; ++i)
+        {
+            prepare();
+            const auto begin = clock::now();
+            work();
+            const double ms = std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+            best            = i == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    }
+
+    double megabytes_per_second(std::size_t bytes, double ms)
+    {
+        return ms > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / (ms / 1000.0) : 0.0;
+    }
+}
+
+namespace pixel_benchmark
+{
+    Result Run(int size, int runs)
+    {
+        Result result;
+        result.size = std::max(size, 1);
+        result.runs = std::max(runs, 1);
+
+        const auto                                 bytes = static_cast<std::size_t>(result.size) * static_cast<std::size_t>(result.size) * 4;
+        std::mt19937                               random{ 2024 };
+        std::uniform_int_distribution<unsigned>    byte{ 0, 255 };
+        std::vector<std::uint8_t>                  source(bytes);
+        for (std::uint8_t& value : source)
+            value = static_cast<std::uint8_t>(byte(random));
+        // a sprite's alphas: mostly clear or opaque, an edge of everything between
+        for (std::size_t i = 3; i < bytes; i += 4)
+            source[i] = source[i] < 96 ? 0 : source[i] > 160 ? 255 : source[i];
+
+        using pixel_kernels::Ops;
+        const Ops                 premultiply{ .premultiply = true };
+        const Ops                 swizzle{ .swap_red_blue = true };
+        const Ops                 flip{ .flip_rows = true };
+        const Ops                 fused{ .premultiply = true, .swap_red_blue = true, .flip_rows = true };
+        std::vector<std::uint8_t> pixels(bytes);
+        std::vector<std::uint8_t> expected;
+        const auto                reset = [&] { std::copy(source.begin(), source.end(), pixels.begin()); };
+        const auto                apply = [&](const Ops& ops) { pixel_kernels::Convert(pixels.data(), result.size, result.size, 4, ops); };
+
+        const pixel_kernels::Level previous = pixel_kernels::ActiveLevel();
+        for (const pixel_kernels::Level level : { pixel_kernels::Level::Scalar, pixel_kernels::Level::Sse41, pixel_kernels::Level::Avx2, pixel_kernels::Level::Neon,
+                                                  pixel_kernels::Level::Wasm })
+        {
+            if (!pixel_kernels::SetLevel(level))
+                continue;
+            LevelResult& timing   = result.levels.emplace_back();
+            timing.level          = level;
+            timing.premultiply_ms = best_ms(result.runs, reset, [&] { apply(premultiply); });
+            timing.swizzle_ms     = best_ms(result.runs, reset, [&] { apply(swizzle); });
+            timing.flip_ms        = best_ms(result.runs, reset, [&] { apply(flip); });
+            timing.separate_ms    = best_ms(result.runs, reset,
+                                         [&]
+                                         {
+                                             apply(premultiply);
+                                             apply(swizzle);
+                                             apply(flip);
+                                         });
+            const std::vector<std::uint8_t> separate = pixels;
+            timing.fused_ms                          = best_ms(result.runs, reset, [&] { apply(fused); });
+            if (expected.empty())
+                expected = pixels;
+            // fused or not, and at any level, the same bytes
+            timing.matches = pixels == expected && separate == expected;
+        }
+        pixel_kernels::SetLevel(previous);
+        return result;
+    }
+
+    void Print(std::ostream& out, const Result& result)
+    {
+        const auto bytes = static_cast<std::size_t>(result.size) * static_cast<std::size_t>(result.size) * 4;
+        out << "Pixel kernels, " << result.size << " x " << result.size << " RGBA8, best of " << result.runs << " runs\n";
+        for (const LevelResult& level : result.levels)
+        {
+            out << "  " << pixel_kernels::LevelName(level.level) << ": premultiply " << level.premultiply_ms << " ms, swizzle " << level.swizzle_ms << " ms, flip " << level.flip_ms
+                << " ms; all three fused " << level.fused_ms << " ms (" << megabytes_per_second(bytes, level.fused_ms) << " MB/s), as separate passes " << level.separate_ms << " ms"
+                << (level.matches ? "" : "  MISMATCH") << '\n';
+        }
+    }
+
+    bool Passed(const Result& result) noexcept
+    {
+        return std::all_of(result.levels.begin(), result.levels.end(), [](const LevelResult& level) { return level.matches; });
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "pixel_kernels.h"
+
+#include <iosfwd>
+#include <vector>
+
+/**
+ * pixel_kernels at each level this build and CPU have, over the same random RGBA8 image: premultiplying,
+ * swizzling and flipping on their own, then all three fused into one pass, against the same three run as
+ * separate passes. Every level has to give the scalar one's bytes. Run with "--benchmark-pixels" for a
+ * 2048 x 2048 image, or "--benchmark-pixels-size N" for N x N, before any window opens.
+ */
+namespace pixel_benchmark
+{
+    struct LevelResult
+    {
+        pixel_kernels::Level level          = pixel_kernels::Level::Scalar;
+        double               premultiply_ms = 0.0; // best of the runs, for the whole image
+        double               swizzle_ms     = 0.0;
+        double               flip_ms        = 0.0;
+        double               fused_ms       = 0.0; // all three in one pass
+        double               separate_ms    = 0.0; // all three, one pass each
+        bool                 matches        = false;
+    };
+
+    struct Result
+    {
+        int                      size = 0; // pixels on a side
+        int                      runs = 0;
+        std::vector<LevelResult> levels; // the scalar one first
+    };
+
+    Result Run(int size = 2048, int runs = 20);
+    void   Print(std::ostream& out, const Result& result);
+    // every level gave the scalar one's bytes
+    bool   Passed(const Result& result) noexcept;
+}
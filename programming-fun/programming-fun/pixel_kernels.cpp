@@ -0,0 +1,444 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "pixel_kernels.h"
+
+#include <SDL_cpuinfo.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#    define PIXEL_KERNELS_X86 1
+#    include <immintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#    define PIXEL_KERNELS_NEON 1
+#    include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#    define PIXEL_KERNELS_WASM 1
+#    include <wasm_simd128.h>
+#endif
+
+// MSVC takes any intrinsic in any function; GCC and Clang want the function marked for its instruction set
+#if defined(PIXEL_KERNELS_X86) && defined(__GNUC__)
+#    define PIXEL_KERNELS_TARGET(isa) __attribute__((target(isa)))
+#else
+#    define PIXEL_KERNELS_TARGET(isa)
+#endif
+
+namespace
+{
+    using pixel_kernels::Level;
+
+    struct Kernels
+    {
+        Level level;
+        // `texels` from `in` to `out`
+        void (*convert)(const std::uint8_t* in, std::uint8_t* out, std::size_t texels, bool premultiply, bool swap);
+        // `texels` of `a` converted into `b` and the other way round
+        void (*exchange)(std::uint8_t* a, std::uint8_t* b, std::size_t texels, bool premultiply, bool swap);
+    };
+
+    // the references, and the tails the vector versions leave over
+    namespace scalar
+    {
+        // c * a / 255 rounded to nearest, exact for every pair of bytes; the vector versions do the same in 16 bits
+        std::uint8_t times_alpha(unsigned color, unsigned alpha)
+        {
+            const unsigned product = color * alpha + 128;
+            return static_cast<std::uint8_t>((product + (product >> 8)) >> 8);
+        }
+
+        void texel(const std::uint8_t* in, std::uint8_t* out, bool premultiply, bool swap)
+        {
+            std::uint8_t red   = in[0];
+            std::uint8_t green = in[1];
+            std::uint8_t blue  = in[2];
+            const auto   alpha = in[3];
+            if (premultiply)
+            {
+                red   = times_alpha(red, alpha);
+                green = times_alpha(green, alpha);
+                blue  = times_alpha(blue, alpha);
+            }
+            if (swap)
+                std::swap(red, blue);
+            out[0] = red;
+            out[1] = green;
+            out[2] = blue;
+            out[3] = alpha;
+        }
+
+        void convert(const std::uint8_t* in, std::uint8_t* out, std::size_t texels, bool premultiply, bool swap)
+        {
+            for (std::size_t i = 0; i < texels; ++i)
+                texel(in + i * 4, out + i * 4, premultiply, swap);
+        }
+
+        void exchange(std::uint8_t* a, std::uint8_t* b, std::size_t texels, bool premultiply, bool swap)
+        {
+            for (std::size_t i = 0; i < texels; ++i)
+            {
+                std::uint8_t from_a[4];
+                texel(a + i * 4, from_a, premultiply, swap);
+                texel(b + i * 4, a + i * 4, premultiply, swap);
+                std::memcpy(b + i * 4, from_a, sizeof(from_a));
+            }
+        }
+
+        constexpr Kernels KERNELS{ Level::Scalar, convert, exchange };
+    }
+
+#if defined(PIXEL_KERNELS_X86)
+    namespace sse41
+    {
+        // two texels widened to 16 bits; alpha goes in every lane of its texel but its own, which multiplies by 255 and stays
+        PIXEL_KERNELS_TARGET("sse4.1") __m128i times_alpha(__m128i colors)
+        {
+            const __m128i alpha   = _mm_blend_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(colors, 0xFF), 0xFF), _mm_set1_epi16(255), 0x88);
+            const __m128i product = _mm_add_epi16(_mm_mullo_epi16(colors, alpha), _mm_set1_epi16(128));
+            return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+        }
+
+        // four texels
+        PIXEL_KERNELS_TARGET("sse4.1") __m128i block(__m128i texels, bool premultiply, bool swap)
+        {
+            if (premultiply)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                texels             = _mm_packus_epi16(times_alpha(_mm_unpacklo_epi8(texels, zero)), times_alpha(_mm_unpackhi_epi8(texels, zero)));
+            }
+            if (swap)
+                texels = _mm_shuffle_epi8(texels, _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+            return texels;
+        }
+
+        PIXEL_KERNELS_TARGET("sse4.1") void convert(const std::uint8_t* in, std::uint8_t* out, std::size_t texels, bool premultiply, bool swap)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= texels; i += 4)
+            {
+                const __m128i loaded = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), block(loaded, premultiply, swap));
+            }
+            scalar::convert(in + i * 4, out + i * 4, texels - i, premultiply, swap);
+        }
+
+        PIXEL_KERNELS_TARGET("sse4.1") void exchange(std::uint8_t* a, std::uint8_t* b, std::size_t texels, bool premultiply, bool swap)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= texels; i += 4)
+            {
+                const __m128i from_a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i * 4));
+                const __m128i from_b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i * 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(a + i * 4), block(from_b, premultiply, swap));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(b + i * 4), block(from_a, premultiply, swap));
+            }
+            scalar::exchange(a + i * 4, b + i * 4, texels - i, premultiply, swap);
+        }
+
+        constexpr Kernels KERNELS{ Level::Sse41, convert, exchange };
+    }
+
+    namespace avx2
+    {
+        // the SSE4.1 version in each 128 bit half; the unpacks and the pack stay within their half, so the order holds
+        PIXEL_KERNELS_TARGET("avx2") __m256i times_alpha(__m256i colors)
+        {
+            const __m256i alpha   = _mm256_blend_epi16(_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(colors, 0xFF), 0xFF), _mm256_set1_epi16(255), 0x88);
+            const __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(colors, alpha), _mm256_set1_epi16(128));
+            return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+        }
+
+        // eight texels
+        PIXEL_KERNELS_TARGET("avx2") __m256i block(__m256i texels, bool premultiply, bool swap)
+        {
+            if (premultiply)
+            {
+                const __m256i zero = _mm256_setzero_si256();
+                texels             = _mm256_packus_epi16(times_alpha(_mm256_unpacklo_epi8(texels, zero)), times_alpha(_mm256_unpackhi_epi8(texels, zero)));
+            }
+            if (swap)
+            {
+                texels = _mm256_shuffle_epi8(
+                    texels, _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+            }
+            return texels;
+        }
+
+        PIXEL_KERNELS_TARGET("avx2") void convert(const std::uint8_t* in, std::uint8_t* out, std::size_t texels, bool premultiply, bool swap)
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= texels; i += 8)
+            {
+                const __m256i loaded = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 4));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4), block(loaded, premultiply, swap));
+            }
+            scalar::convert(in + i * 4, out + i * 4, texels - i, premultiply, swap);
+        }
+
+        PIXEL_KERNELS_TARGET("avx2") void exchange(std::uint8_t* a, std::uint8_t* b, std::size_t texels, bool premultiply, bool swap)
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= texels; i += 8)
+            {
+                const __m256i from_a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i * 4));
+                const __m256i from_b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i * 4));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i * 4), block(from_b, premultiply, swap));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(b + i * 4), block(from_a, premultiply, swap));
+            }
+            scalar::exchange(a + i * 4, b + i * 4, texels - i, premultiply, swap);
+        }
+
+        constexpr Kernels KERNELS{ Level::Avx2, convert, exchange };
+    }
+#endif
+
+#if defined(PIXEL_KERNELS_NEON)
+    namespace neon
+    {
+        // sixteen colors by their alphas, widened and narrowed again
+        uint8x16_t times_alpha(uint8x16_t colors, uint8x16_t alpha)
+        {
+            const uint16x8_t low  = vmlal_u8(vdupq_n_u16(128), vget_low_u8(colors), vget_low_u8(alpha));
+            const uint16x8_t high = vmlal_high_u8(vdupq_n_u16(128), colors, alpha);
+            return vcombine_u8(vshrn_n_u16(vsraq_n_u16(low, low, 8), 8), vshrn_n_u16(vsraq_n_u16(high, high, 8), 8));
+        }
+
+        // sixteen texels, split into their channels by vld4q
+        void block(uint8x16x4_t& texels, bool premultiply, bool swap)
+        {
+            if (premultiply)
+            {
+                for (int channel = 0; channel < 3; ++channel)
+                    texels.val[channel] = times_alpha(texels.val[channel], texels.val[3]);
+            }
+            if (swap)
+                std::swap(texels.val[0], texels.val[2]);
+        }
+
+        void convert(const std::uint8_t* in, std::uint8_t* out, std::size_t texels, bool premultiply, bool swap)
+        {
+            std::size_t i = 0;
+            for (; i + 16 <= texels; i += 16)
+            {
+                uint8x16x4_t loaded = vld4q_u8(in + i * 4);
+                block(loaded, premultiply, swap);
+                vst4q_u8(out + i * 4, loaded);
+            }
+            scalar::convert(in + i * 4, out + i * 4, texels - i, premultiply, swap);
+        }
+
+        void exchange(std::uint8_t* a, std::uint8_t* b, std::size_t texels, bool premultiply, bool swap)
+        {
+            std::size_t i = 0;
+            for (; i + 16 <= texels; i += 16)
+            {
+                uint8x16x4_t from_a = vld4q_u8(a + i * 4);
+                uint8x16x4_t from_b = vld4q_u8(b + i * 4);
+                block(from_a, premultiply, swap);
+                block(from_b, premultiply, swap);
+                vst4q_u8(a + i * 4, from_b);
+                vst4q_u8(b + i * 4, from_a);
+            }
+            scalar::exchange(a + i * 4, b + i * 4, texels - i, premultiply, swap);
+        }
+
+        constexpr Kernels KERNELS{ Level::Neon, convert, exchange };
+    }
+#endif
+
+#if defined(PIXEL_KERNELS_WASM)
+    namespace wasm
+    {
+        // two texels widened to 16 bits; the shuffle puts 255 in each texel's own alpha lane so it stays
+        v128_t times_alpha(v128_t colors)
+        {
+            const v128_t alpha   = wasm_i16x8_shuffle(colors, wasm_i16x8_splat(255), 3, 3, 3, 8, 7, 7, 7, 8);
+            const v128_t product = wasm_i16x8_add(wasm_i16x8_mul(colors, alpha), wasm_i16x8_splat(128));
+            return wasm_u16x8_shr(wasm_i16x8_add(product, wasm_u16x8_shr(product, 8)), 8);
+        }
+
+        // four texels
+        v128_t block(v128_t texels, bool premultiply, bool swap)
+        {
+            if (premultiply)
+                texels = wasm_u8x16_narrow_i16x8(times_alpha(wasm_u16x8_extend_low_u8x16(texels)), times_alpha(wasm_u16x8_extend_high_u8x16(texels)));
+            if (swap)
+                texels = wasm_i8x16_shuffle(texels, texels, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            return texels;
+        }
+
+        void convert(const std::uint8_t* in, std::uint8_t* out, std::size_t texels, bool premultiply, bool swap)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= texels; i += 4)
+                wasm_v128_store(out + i * 4, block(wasm_v128_load(in + i * 4), premultiply, swap));
+            scalar::convert(in + i * 4, out + i * 4, texels - i, premultiply, swap);
+        }
+
+        void exchange(std::uint8_t* a, std::uint8_t* b, std::size_t texels, bool premultiply, bool swap)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= texels; i += 4)
+            {
+                const v128_t from_a = wasm_v128_load(a + i * 4);
+                const v128_t from_b = wasm_v128_load(b + i * 4);
+                wasm_v128_store(a + i * 4, block(from_b, premultiply, swap));
+                wasm_v128_store(b + i * 4, block(from_a, premultiply, swap));
+            }
+            scalar::exchange(a + i * 4, b + i * 4, texels - i, premultiply, swap);
+        }
+
+        constexpr Kernels KERNELS{ Level::Wasm, convert, exchange };
+    }
+#endif
+
+    const Kernels* compiled_kernels(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Scalar: return &scalar::KERNELS;
+#if defined(PIXEL_KERNELS_X86)
+            case Level::Sse41: return &sse41::KERNELS;
+            case Level::Avx2: return &avx2::KERNELS;
+#endif
+#if defined(PIXEL_KERNELS_NEON)
+            case Level::Neon: return &neon::KERNELS;
+#endif
+#if defined(PIXEL_KERNELS_WASM)
+            case Level::Wasm: return &wasm::KERNELS;
+#endif
+            default: return nullptr;
+        }
+    }
+
+    bool cpu_runs(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Sse41: return SDL_HasSSE41() == SDL_TRUE;
+            case Level::Avx2: return SDL_HasAVX2() == SDL_TRUE;
+            case Level::Neon: return SDL_HasNEON() == SDL_TRUE;
+            // a browser without SIMD refuses the whole module, so getting here means it has it
+            default: return true;
+        }
+    }
+
+    const Kernels& best_kernels() noexcept
+    {
+        for (const Level level : { Level::Avx2, Level::Sse41, Level::Neon, Level::Wasm })
+        {
+            if (pixel_kernels::IsAvailable(level))
+                return *compiled_kernels(level);
+        }
+        return scalar::KERNELS;
+    }
+
+    // a byte at a time doesn't vectorize; a chunk through the stack is three memcpys the library does wide
+    void swap_rows(std::uint8_t* a, std::uint8_t* b, std::size_t bytes) noexcept
+    {
+        std::uint8_t chunk[1024];
+        for (std::size_t offset = 0; offset < bytes; offset += sizeof(chunk))
+        {
+            const std::size_t count = std::min(sizeof(chunk), bytes - offset);
+            std::memcpy(chunk, a + offset, count);
+            std::memcpy(a + offset, b + offset, count);
+            std::memcpy(b + offset, chunk, count);
+        }
+    }
+
+    // picking twice on a race is harmless, both threads land on the same table
+    std::atomic<const Kernels*> active{ nullptr };
+
+    const Kernels& kernels() noexcept
+    {
+        const Kernels* current = active.load(std::memory_order_acquire);
+        if (current == nullptr)
+        {
+            current = &best_kernels();
+            active.store(current, std::memory_order_release);
+        }
+        return *current;
+    }
+}
+
+namespace pixel_kernels
+{
+    bool IsAvailable(Level level) noexcept
+    {
+        return compiled_kernels(level) != nullptr && cpu_runs(level);
+    }
+
+    Level ActiveLevel() noexcept
+    {
+        return kernels().level;
+    }
+
+    bool SetLevel(Level level) noexcept
+    {
+        if (!IsAvailable(level))
+            return false;
+        active.store(compiled_kernels(level), std::memory_order_release);
+        return true;
+    }
+
+    const char* LevelName(Level level) noexcept
+    {
+        switch (level)
+        {
+            case Level::Scalar: return "scalar";
+            case Level::Sse41: return "sse4.1";
+            case Level::Avx2: return "avx2";
+            case Level::Neon: return "neon";
+            case Level::Wasm: return "wasm simd";
+        }
+        return "unknown";
+    }
+
+    void ConvertRow(const std::uint8_t* in, std::uint8_t* out, std::size_t texels, const Ops& ops) noexcept
+    {
+        if (ops.premultiply || ops.swap_red_blue)
+            kernels().convert(in, out, texels, ops.premultiply, ops.swap_red_blue);
+        else if (in != out)
+            std::memcpy(out, in, texels * 4);
+    }
+
+    void Convert(std::uint8_t* pixels, int width, int height, std::size_t texel_bytes, const Ops& ops) noexcept
+    {
+        const bool has_colors = ops.premultiply || ops.swap_red_blue;
+        assert(!has_colors || texel_bytes == 4);
+        if (width <= 0 || height <= 0)
+            return;
+        const Kernels&    active_kernels = kernels();
+        const auto        texels         = static_cast<std::size_t>(width);
+        const std::size_t row_bytes      = texels * texel_bytes;
+        if (!ops.flip_rows)
+        {
+            if (has_colors)
+                active_kernels.convert(pixels, pixels, texels * static_cast<std::size_t>(height), ops.premultiply, ops.swap_red_blue);
+            return;
+        }
+        for (int top = 0, bottom = height - 1; top < bottom; ++top, --bottom)
+        {
+            std::uint8_t* const a = pixels + static_cast<std::size_t>(top) * row_bytes;
+            std::uint8_t* const b = pixels + static_cast<std::size_t>(bottom) * row_bytes;
+            if (has_colors)
+                active_kernels.exchange(a, b, texels, ops.premultiply, ops.swap_red_blue);
+            else
+                swap_rows(a, b, row_bytes);
+        }
+        // an odd height leaves the middle row where it is
+        if (has_colors && height % 2 == 1)
+        {
+            std::uint8_t* const middle = pixels + static_cast<std::size_t>(height / 2) * row_bytes;
+            active_kernels.convert(middle, middle, texels, ops.premultiply, ops.swap_red_blue);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * What a decoded image goes through before it uploads: alpha premultiplied into the color, red and blue swapped
+ * for a GL_BGRA upload, and the rows flipped for GL's bottom-left origin, all in one pass over the pixels.
+ *
+ * Like math_kernels, each kernel has a scalar version and, where the build targets them, SSE4.1 and AVX2 (x86),
+ * NEON (ARM) or wasm SIMD versions, picked on the first call and swapped by SetLevel for benchmarks. Every level
+ * gives the same bytes: premultiplying rounds c * a / 255 to nearest, and the alpha stays as it was. A flip swaps
+ * row i with row height - 1 - i, converting both on the way, so the image is read and written once.
+ */
+namespace pixel_kernels
+{
+    enum class Level
+    {
+        Scalar,
+        Sse41,
+        Avx2,
+        Neon,
+        Wasm
+    };
+
+    struct Ops
+    {
+        bool premultiply   = false; // RGBA8 only
+        bool swap_red_blue = false; // RGBA8 only
+        bool flip_rows     = false; // any texel size
+
+        bool Any() const noexcept
+        {
+            return premultiply || swap_red_blue || flip_rows;
+        }
+    };
+
+    // Whether this build has `level` and the CPU can run it
+    bool        IsAvailable(Level level) noexcept;
+    Level       ActiveLevel() noexcept;
+    // For benchmarks; false, and nothing changes, when `level` isn't available
+    bool        SetLevel(Level level) noexcept;
+    const char* LevelName(Level level) noexcept;
+
+    // `texels` RGBA8 texels from `in` to `out`, which may be the same array but not otherwise overlap; flip_rows is ignored
+    void ConvertRow(const std::uint8_t* in, std::uint8_t* out, std::size_t texels, const Ops& ops) noexcept;
+    // A whole image in place, rows packed; `texel_bytes` is 4 whenever premultiply or swap_red_blue is set
+    void Convert(std::uint8_t* pixels, int width, int height, std::size_t texel_bytes, const Ops& ops) noexcept;
+}
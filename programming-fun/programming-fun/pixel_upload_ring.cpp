@@ -0,0 +1,141 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "pixel_upload_ring.h"
+
+#include "logger.h"
+
+namespace
+{
+    constexpr std::size_t ALIGNMENT = 16;
+
+    constexpr std::size_t align_up(std::size_t value) noexcept
+    {
+        return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+}
+
+PixelUploadRing::~PixelUploadRing()
+{
+    Shutdown();
+}
+
+void PixelUploadRing::Setup([[maybe_unused]] std::size_t requested_capacity)
+{
+#if !defined(IS_WEBGL2)
+    if (buffer != 0 || !(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage))
+        return;
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(requested_capacity), nullptr, flags);
+    mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(requested_capacity), flags));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (mapped == nullptr)
+    {
+        LOG_WARN("Failed to map the pixel upload ring, textures will upload from client memory");
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        return;
+    }
+    capacity = requested_capacity;
+#endif
+}
+
+void PixelUploadRing::Shutdown()
+{
+    if (buffer == 0)
+        return;
+    for (const Segment& segment : in_flight)
+    {
+        if (segment.fence != nullptr)
+            glDeleteSync(segment.fence);
+    }
+    in_flight.clear();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    buffer   = 0;
+    mapped   = nullptr;
+    capacity = head = segment_begin = 0;
+}
+
+bool PixelUploadRing::IsAvailable() const noexcept
+{
+    return mapped != nullptr;
+}
+
+unsigned char* PixelUploadRing::Reserve(std::size_t bytes, std::size_t& out_offset)
+{
+    if (mapped == nullptr || bytes > capacity)
+        return nullptr;
+
+    retireSignaled();
+    std::size_t offset = head;
+    if (offset + bytes > capacity)
+    {
+        offset = 0;
+        if (overlapsInFlight(offset, bytes))
+            return nullptr;
+        // the unfenced tail is still waiting for the next Fence(), keep it reserved until then
+        if (head > segment_begin)
+            in_flight.push_back(Segment{ nullptr, segment_begin, head });
+        segment_begin = 0;
+    }
+    else if (overlapsInFlight(offset, offset + bytes))
+    {
+        return nullptr;
+    }
+
+    head       = align_up(offset + bytes);
+    out_offset = offset;
+    return mapped + offset;
+}
+
+void PixelUploadRing::Fence()
+{
+    if (mapped == nullptr)
+        return;
+    // each segment owns its own sync object so retiring one never invalidates another
+    for (auto it = in_flight.rbegin(); it != in_flight.rend() && it->fence == nullptr; ++it)
+        it->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (head > segment_begin)
+        in_flight.push_back(Segment{ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), segment_begin, head });
+    segment_begin = head;
+}
+
+GLuint PixelUploadRing::Buffer() const noexcept
+{
+    return buffer;
+}
+
+void PixelUploadRing::retireSignaled()
+{
+    while (!in_flight.empty() && in_flight.front().fence != nullptr)
+    {
+        const GLenum status = glClientWaitSync(in_flight.front().fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        glDeleteSync(in_flight.front().fence);
+        in_flight.pop_front();
+    }
+}
+
+bool PixelUploadRing::overlapsInFlight(std::size_t begin, std::size_t end) const noexcept
+{
+    // the open segment has no fence yet, it is only free again after the next Fence() signals
+    if (begin < head && end > segment_begin && head > segment_begin)
+        return true;
+    for (const Segment& segment : in_flight)
+    {
+        if (begin < segment.end && end > segment.begin)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,67 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <deque>
+
+/**
+ * A persistently mapped GL_PIXEL_UNPACK_BUFFER used as a ring for texture uploads.
+ *
+ * Pixels are written once into driver-visible memory and glTexSubImage2D reads them from a buffer
+ * offset, so the driver can copy asynchronously instead of taking a synchronous client-memory copy.
+ * Every Fence() protects what was reserved since the previous one; space is reused only once its fence
+ * has signalled. Reserve never waits on the GPU: it returns nullptr when the ring is full, and callers
+ * upload from client memory instead.
+ *
+ * Needs GL 4.4 or ARB_buffer_storage. Without it (and always on WebGL2) IsAvailable() is false.
+ * GL thread only.
+ */
+class PixelUploadRing
+{
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 32 * 1024 * 1024;
+
+    PixelUploadRing() = default;
+    ~PixelUploadRing();
+
+    PixelUploadRing(const PixelUploadRing&)                = delete;
+    PixelUploadRing& operator=(const PixelUploadRing&)     = delete;
+    PixelUploadRing(PixelUploadRing&&) noexcept            = delete;
+    PixelUploadRing& operator=(PixelUploadRing&&) noexcept = delete;
+
+    void Setup(std::size_t capacity = DEFAULT_CAPACITY);
+    void Shutdown();
+
+    bool IsAvailable() const noexcept;
+
+    // Returns a mapped pointer to `bytes` of free space and its offset inside Buffer(), or nullptr when full.
+    unsigned char* Reserve(std::size_t bytes, std::size_t& out_offset);
+    void           Fence();
+    GLuint         Buffer() const noexcept;
+
+private:
+    struct Segment
+    {
+        GLsync      fence = nullptr;
+        std::size_t begin = 0;
+        std::size_t end   = 0;
+    };
+
+    void retireSignaled();
+    bool overlapsInFlight(std::size_t begin, std::size_t end) const noexcept;
+
+private:
+    GLuint              buffer        = 0;
+    unsigned char*      mapped        = nullptr;
+    std::size_t         capacity      = 0;
+    std::size_t         head          = 0;
+    std::size_t         segment_begin = 0;
+    std::deque<Segment> in_flight;
+};
@@ -0,0 +1,234 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "png_writer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+
+namespace
+{
+    constexpr unsigned char SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    constexpr int           MIN_MATCH    = 4; // a 3 byte match costs about what its literals do in the fixed code
+    constexpr int           MAX_MATCH    = 258;
+    constexpr std::size_t   MAX_DISTANCE = 32768;
+
+    constexpr std::array<std::uint16_t, 29> LENGTH_BASE = { 3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                                            31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    constexpr std::array<std::uint8_t, 29>  LENGTH_EXTRA = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    constexpr std::array<std::uint16_t, 30> DISTANCE_BASE  = { 1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                                               193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    constexpr std::array<std::uint8_t, 30>  DISTANCE_EXTRA = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    constexpr std::array<std::uint32_t, 256> make_crc_table() noexcept
+    {
+        std::array<std::uint32_t, 256> table{};
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) != 0 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            table[i] = crc;
+        }
+        return table;
+    }
+
+    constexpr std::array<std::uint32_t, 256> CRC_TABLE = make_crc_table();
+
+    std::uint32_t crc32(const unsigned char* data, std::size_t size) noexcept
+    {
+        std::uint32_t crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < size; ++i)
+            crc = CRC_TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    std::uint32_t adler32(const std::vector<unsigned char>& data) noexcept
+    {
+        constexpr std::uint32_t MOD = 65521;
+        // 5552 bytes is the most that can be summed before the 32 bit sums have to be reduced
+        std::uint32_t a = 1, b = 0;
+        for (std::size_t begin = 0; begin < data.size(); begin += 5552)
+        {
+            const std::size_t end = std::min(begin + 5552, data.size());
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= MOD;
+            b %= MOD;
+        }
+        return b << 16 | a;
+    }
+
+    void put_u32(std::vector<unsigned char>& out, std::uint32_t value)
+    {
+        out.push_back(static_cast<unsigned char>(value >> 24));
+        out.push_back(static_cast<unsigned char>(value >> 16));
+        out.push_back(static_cast<unsigned char>(value >> 8));
+        out.push_back(static_cast<unsigned char>(value));
+    }
+
+    void put_chunk(std::vector<unsigned char>& out, const char (&type)[5], const std::vector<unsigned char>& data)
+    {
+        put_u32(out, static_cast<std::uint32_t>(data.size()));
+        const std::size_t begin = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        put_u32(out, crc32(out.data() + begin, out.size() - begin));
+    }
+
+    // deflate's bits go in least significant first, its Huffman codes most significant first
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<unsigned char>& out) : out{ out } {}
+
+        void Bits(std::uint32_t value, int count)
+        {
+            buffer |= static_cast<std::uint64_t>(value) << filled;
+            filled += count;
+            while (filled >= 8)
+            {
+                out.push_back(static_cast<unsigned char>(buffer));
+                buffer >>= 8;
+                filled -= 8;
+            }
+        }
+
+        void Code(std::uint32_t code, int length)
+        {
+            std::uint32_t reversed = 0;
+            for (int i = 0; i < length; ++i)
+                reversed |= ((code >> i) & 1u) << (length - 1 - i);
+            Bits(reversed, length);
+        }
+
+        void Flush()
+        {
+            if (filled > 0)
+                out.push_back(static_cast<unsigned char>(buffer));
+            buffer = 0;
+            filled = 0;
+        }
+
+    private:
+        std::vector<unsigned char>& out;
+        std::uint64_t               buffer = 0;
+        int                         filled = 0;
+    };
+
+    // the fixed literal/length code of RFC 1951 3.2.6
+    void put_symbol(BitWriter& bits, int symbol)
+    {
+        if (symbol < 144)
+            bits.Code(static_cast<std::uint32_t>(0x30 + symbol), 8);
+        else if (symbol < 256)
+            bits.Code(static_cast<std::uint32_t>(0x190 + symbol - 144), 9);
+        else if (symbol < 280)
+            bits.Code(static_cast<std::uint32_t>(symbol - 256), 7);
+        else
+            bits.Code(static_cast<std::uint32_t>(0xC0 + symbol - 280), 8);
+    }
+
+    void put_match(BitWriter& bits, int length, std::size_t distance)
+    {
+        const auto length_code = static_cast<std::size_t>(std::upper_bound(LENGTH_BASE.begin(), LENGTH_BASE.end(), length) - LENGTH_BASE.begin() - 1);
+        put_symbol(bits, 257 + static_cast<int>(length_code));
+        bits.Bits(static_cast<std::uint32_t>(length - LENGTH_BASE[length_code]), LENGTH_EXTRA[length_code]);
+        const auto distance_code = static_cast<std::size_t>(std::upper_bound(DISTANCE_BASE.begin(), DISTANCE_BASE.end(), distance) - DISTANCE_BASE.begin() - 1);
+        bits.Code(static_cast<std::uint32_t>(distance_code), 5);
+        bits.Bits(static_cast<std::uint32_t>(distance - DISTANCE_BASE[distance_code]), DISTANCE_EXTRA[distance_code]);
+    }
+
+    int match_length(const std::vector<unsigned char>& data, std::size_t at, std::size_t distance) noexcept
+    {
+        if (distance == 0 || distance > at || distance > MAX_DISTANCE)
+            return 0;
+        const std::size_t limit  = std::min<std::size_t>(MAX_MATCH, data.size() - at);
+        std::size_t       length = 0;
+        while (length < limit && data[at + length] == data[at + length - distance])
+            ++length;
+        return static_cast<int>(length);
+    }
+
+    std::vector<unsigned char> deflate(const std::vector<unsigned char>& data, std::size_t row_bytes)
+    {
+        std::vector<unsigned char> out;
+        out.reserve(data.size() / 2 + 64);
+        out.push_back(0x78); // deflate with a 32K window
+        out.push_back(0x01); // fastest, and the check bits that make the header a multiple of 31
+        BitWriter bits{ out };
+        bits.Bits(1, 1); // the last block
+        bits.Bits(1, 2); // fixed Huffman codes
+        std::size_t at = 0;
+        while (at < data.size())
+        {
+            // a filtered row is its filter byte then the pixels, so the row above is exactly row_bytes back
+            const int  previous = match_length(data, at, 3);
+            const int  above    = match_length(data, at, row_bytes);
+            const bool is_above = above > previous;
+            const int  length   = is_above ? above : previous;
+            if (length >= MIN_MATCH)
+            {
+                put_match(bits, length, is_above ? row_bytes : 3);
+                at += static_cast<std::size_t>(length);
+            }
+            else
+            {
+                put_symbol(bits, data[at]);
+                ++at;
+            }
+        }
+        put_symbol(bits, 256);
+        bits.Flush();
+        put_u32(out, adler32(data));
+        return out;
+    }
+}
+
+namespace png_writer
+{
+    std::vector<unsigned char> Encode(const unsigned char* rgba, int width, int height, std::ptrdiff_t stride)
+    {
+        const std::size_t          row_bytes = static_cast<std::size_t>(width) * 3 + 1;
+        std::vector<unsigned char> filtered(row_bytes * static_cast<std::size_t>(height));
+        for (int y = 0; y < height; ++y)
+        {
+            const unsigned char* source = rgba + static_cast<std::ptrdiff_t>(y) * stride;
+            unsigned char*       row    = filtered.data() + static_cast<std::size_t>(y) * row_bytes;
+            row[0]                      = 0; // no filter; the matches against the row above do what Up would
+            for (int x = 0; x < width; ++x)
+            {
+                row[1 + x * 3]     = source[x * 4];
+                row[1 + x * 3 + 1] = source[x * 4 + 1];
+                row[1 + x * 3 + 2] = source[x * 4 + 2];
+            }
+        }
+
+        std::vector<unsigned char> header;
+        put_u32(header, static_cast<std::uint32_t>(width));
+        put_u32(header, static_cast<std::uint32_t>(height));
+        header.insert(header.end(), { 8, 2, 0, 0, 0 }); // 8 bits, RGB, deflate, adaptive filtering, not interlaced
+
+        std::vector<unsigned char> png(std::begin(SIGNATURE), std::end(SIGNATURE));
+        put_chunk(png, "IHDR", header);
+        put_chunk(png, "IDAT", deflate(filtered, row_bytes));
+        put_chunk(png, "IEND", {});
+        return png;
+    }
+
+    bool Write(const std::filesystem::path& filename, const unsigned char* rgba, int width, int height, std::ptrdiff_t stride)
+    {
+        const std::vector<unsigned char> bytes = Encode(rgba, width, height, stride);
+        std::ofstream                    file{ filename, std::ios::binary };
+        return static_cast<bool>(file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())));
+    }
+}
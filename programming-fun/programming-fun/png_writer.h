@@ -0,0 +1,27 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+/**
+ * Writes RGBA8 pixels out as an 8-bit RGB PNG, for screenshots and frame captures.
+ *
+ * The deflate stream is a single fixed-Huffman block whose only matches are against the previous pixel and the
+ * row above, found greedily without a hash chain. That keeps a frame's encode to a few milliseconds on one worker
+ * and still shrinks flat backgrounds and repeated rows well; any decoder reads it, only the ratio is behind zlib's.
+ * Alpha is dropped, a backbuffer's alpha is whatever blending left there. No GL or threads here.
+ */
+namespace png_writer
+{
+    // `stride` is the distance between the starts of two rows in bytes, negative to write bottom-up rows (GL's) top-down
+    std::vector<unsigned char> Encode(const unsigned char* rgba, int width, int height, std::ptrdiff_t stride);
+    bool                       Write(const std::filesystem::path& filename, const unsigned char* rgba, int width, int height, std::ptrdiff_t stride);
+}
@@ -0,0 +1,430 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "post_process.h"
+
+#include "gl_extensions.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "gpu_profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <imgui.h>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr int LUT_SIZE = 16;
+
+    // units: the scene or the pass's source on 0, bloom on 1, the LUT on 2
+    constexpr GLuint BLOOM_UNIT = 1;
+    constexpr GLuint LUT_UNIT   = 2;
+
+    constexpr const char* FULLSCREEN_VERTEX_SHADER = R"(
+out vec2 vTexCoord;
+
+void main()
+{
+    // one triangle covering the screen: (-1,-1) (3,-1) (-1,3)
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    vTexCoord   = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    // four bilinear taps a texel apart average a 4x4 block, which is what a halving downsample needs
+    constexpr const char* BRIGHT_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+
+uniform sampler2D uSource;
+uniform vec2      uScale;
+uniform vec2      uLimit;
+uniform vec2      uTexel;
+uniform float     uThreshold;
+
+out vec4 fragColor;
+
+vec3 tap(vec2 uv)
+{
+    vec3 color = texture(uSource, min(uv, uLimit)).rgb;
+    return color * color;
+}
+
+void main()
+{
+    vec2  uv         = vTexCoord * uScale;
+    vec3  color      = 0.25 * (tap(uv + vec2(-1.0, -1.0) * uTexel) + tap(uv + vec2(1.0, -1.0) * uTexel) + tap(uv + vec2(-1.0, 1.0) * uTexel) + tap(uv + vec2(1.0, 1.0) * uTexel));
+    float brightness = max(color.r, max(color.g, color.b));
+    fragColor        = vec4(color * (max(brightness - uThreshold, 0.0) / max(brightness, 0.0001)), 1.0);
+}
+)";
+
+    // nine taps of a gaussian in five bilinear fetches
+    constexpr const char* BLUR_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+
+uniform sampler2D uSource;
+uniform vec2      uStep;
+
+out vec4 fragColor;
+
+void main()
+{
+    vec3 sum = texture(uSource, vTexCoord).rgb * 0.2270270270;
+    sum += (texture(uSource, vTexCoord + uStep * 1.3846153846).rgb + texture(uSource, vTexCoord - uStep * 1.3846153846).rgb) * 0.3162162162;
+    sum += (texture(uSource, vTexCoord + uStep * 3.2307692308).rgb + texture(uSource, vTexCoord - uStep * 3.2307692308).rgb) * 0.0702702703;
+    fragColor = vec4(sum, 1.0);
+}
+)";
+
+    // the scene is display encoded; squaring and a square root stand in for the sRGB curve either side of the linear math
+    constexpr const char* COMPOSITE_FRAGMENT_SHADER = R"(
+#ifdef GL_ES
+precision mediump sampler3D;
+#endif
+
+in vec2 vTexCoord;
+
+uniform sampler2D uScene;
+uniform vec2      uScale;
+uniform vec2      uLimit;
+uniform sampler2D uBloom;
+uniform float     uBloomIntensity;
+uniform float     uExposure;
+uniform bool      uToneMap;
+uniform sampler3D uLut;
+uniform float     uLutStrength;
+
+out vec4 fragColor;
+
+const float LUT_SIZE = 16.0;
+
+vec3 aces(vec3 x)
+{
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main()
+{
+    vec3 scene = texture(uScene, min(vTexCoord * uScale, uLimit)).rgb;
+    vec3 color = scene * scene;
+    if (uBloomIntensity > 0.0)
+        color += texture(uBloom, vTexCoord).rgb * uBloomIntensity;
+    color = uToneMap ? aces(color * uExposure) : min(color, vec3(1.0));
+    color = sqrt(color);
+    if (uLutStrength > 0.0)
+        color = mix(color, texture(uLut, color * ((LUT_SIZE - 1.0) / LUT_SIZE) + 0.5 / LUT_SIZE).rgb, uLutStrength);
+    fragColor = vec4(color, 1.0);
+}
+)";
+
+    constexpr int         DIVISORS[]      = { 1, 2, 4 };
+    constexpr const char* DIVISOR_NAMES[] = { "full", "half", "quarter" };
+
+    glm::vec3 grade(glm::vec3 color, const PostSettings& settings)
+    {
+        color            = (color - 0.5f) * settings.contrast + 0.5f;
+        const float luma = glm::dot(color, glm::vec3{ 0.299f, 0.587f, 0.114f });
+        color            = glm::mix(glm::vec3{ luma }, color, settings.saturation);
+        color.r += settings.warmth;
+        color.b -= settings.warmth;
+        return glm::clamp(color, 0.0f, 1.0f);
+    }
+
+    bool is_grade_changed(const PostSettings& a, const PostSettings& b) noexcept
+    {
+        return a.contrast != b.contrast || a.saturation != b.saturation || a.warmth != b.warmth;
+    }
+}
+
+void PostProcess::Setup()
+{
+    bright_program.Request(FULLSCREEN_VERTEX_SHADER, BRIGHT_FRAGMENT_SHADER);
+    blur_program.Request(FULLSCREEN_VERTEX_SHADER, BLUR_FRAGMENT_SHADER);
+    composite_program.Request(FULLSCREEN_VERTEX_SHADER, COMPOSITE_FRAGMENT_SHADER);
+    glGenVertexArrays(1, &vertex_array);
+    // ES renders to half float only with the extension; without it bloom bands a little more
+#if defined(IS_WEBGL2)
+    bloom_format = has_gl_extension("GL_EXT_color_buffer_float") ? GL_RGBA16F : GL_RGBA8;
+#else
+    bloom_format = GL_RGBA16F;
+#endif
+}
+
+void PostProcess::Shutdown()
+{
+    gl_state::DeleteVertexArray(vertex_array);
+    if (lut != 0)
+        glDeleteTextures(1, &lut);
+    bright_program.Reset();
+    blur_program.Reset();
+    composite_program.Reset();
+    vertex_array = lut = 0;
+}
+
+RenderGraph::Resource PostProcess::AddPasses(RenderGraph& graph, RenderGraph::Resource scene, const PostSettings& settings)
+{
+    const ColorSurface scene_surface = graph.Surface(scene);
+    if (!settings.IsEnabled() || scene_surface.framebuffer == 0 || !isCompositeReady())
+        return scene;
+    const RenderGraph::Resource bloomed = settings.bloom ? addBloom(graph, scene, settings) : RenderGraph::NONE;
+    if (settings.grade)
+        updateLut(settings);
+
+    const RenderGraph::Resource output    = graph.Create("post output", scene_surface.size, GL_RGBA8);
+    const bool                  has_bloom = bloomed != RenderGraph::NONE && settings.bloom_intensity > 0.0f;
+    auto                        pass      = graph.AddPass("Post Composite", [this, scene, bloomed, output, has_bloom, &settings](const RenderGraph& frame_graph) {
+        const ColorSurface source = frame_graph.Surface(scene);
+        const ColorSurface target = frame_graph.Surface(output);
+        if (target.framebuffer == 0)
+            return;
+        PROFILE_GPU_ZONE("Tone Map and Grade");
+        GL_STATS_PASS("Post Composite");
+        gl_state::UseProgram(composite_program.Id());
+        const glm::vec2 texel = 1.0f / glm::vec2{ source.allocated };
+        const glm::vec2 limit = (glm::vec2{ source.size } - 0.5f) * texel;
+        glUniform2f(composite_locations.scale, static_cast<float>(source.size.x) * texel.x, static_cast<float>(source.size.y) * texel.y);
+        glUniform2f(composite_locations.limit, limit.x, limit.y);
+        const ColorSurface bloom_surface = has_bloom ? frame_graph.Surface(bloomed) : ColorSurface{};
+        glUniform1f(bloom_intensity_location, bloom_surface.framebuffer != 0 ? settings.bloom_intensity : 0.0f);
+        glUniform1f(exposure_location, settings.exposure);
+        glUniform1i(tone_map_location, settings.tone_map ? 1 : 0);
+        glUniform1f(lut_strength_location, settings.grade && lut != 0 ? 1.0f : 0.0f);
+        gl_state::ActiveTexture(LUT_UNIT);
+        glBindTexture(GL_TEXTURE_3D, settings.grade ? lut : 0);
+        gl_state::ActiveTexture(BLOOM_UNIT);
+        gl_state::BindTexture(bloom_surface.texture);
+        gl_state::ActiveTexture(0);
+        gl_state::BindTexture(source.texture);
+        drawInto(target);
+        gl_stats::CountDraw(1);
+    });
+    pass.Read(scene).Write(output);
+    // at zero intensity nothing reads the bloom, and the graph culls its passes
+    if (has_bloom)
+        pass.Read(bloomed);
+    return output;
+}
+
+bool PostProcess::DrawImGui(PostSettings& settings)
+{
+    bool changed = ImGui::Checkbox("bloom", &settings.bloom);
+    if (settings.bloom)
+    {
+        int current = 0;
+        while (current + 1 < IM_ARRAYSIZE(DIVISORS) && DIVISORS[current] < settings.bloom_divisor)
+            ++current;
+        if (ImGui::Combo("bloom resolution", &current, DIVISOR_NAMES, IM_ARRAYSIZE(DIVISOR_NAMES)))
+        {
+            settings.bloom_divisor = DIVISORS[current];
+            changed                = true;
+        }
+        changed = ImGui::SliderFloat("bloom threshold", &settings.bloom_threshold, 0.0f, 1.0f, "%.2f") || changed;
+        changed = ImGui::SliderFloat("bloom intensity", &settings.bloom_intensity, 0.0f, 2.0f, "%.2f") || changed;
+    }
+    changed = ImGui::Checkbox("tone mapping", &settings.tone_map) || changed;
+    if (settings.tone_map)
+        changed = ImGui::SliderFloat("exposure", &settings.exposure, 0.25f, 4.0f, "%.2f", ImGuiSliderFlags_Logarithmic) || changed;
+    changed = ImGui::Checkbox("color grading", &settings.grade) || changed;
+    if (settings.grade)
+    {
+        changed = ImGui::SliderFloat("contrast", &settings.contrast, 0.5f, 2.0f, "%.2f") || changed;
+        changed = ImGui::SliderFloat("saturation", &settings.saturation, 0.0f, 2.0f, "%.2f") || changed;
+        changed = ImGui::SliderFloat("warmth", &settings.warmth, -0.2f, 0.2f, "%.3f") || changed;
+    }
+    return changed;
+}
+
+bool PostProcess::Parse(std::string_view text, PostSettings& out_settings)
+{
+    PostSettings parsed = out_settings;
+    parsed.bloom = parsed.tone_map = parsed.grade = false;
+    while (!text.empty())
+    {
+        const auto             plus  = text.find('+');
+        const std::string_view token = text.substr(0, plus);
+        text                         = plus == std::string_view::npos ? std::string_view{} : text.substr(plus + 1);
+        if (token == "bloom")
+            parsed.bloom = true;
+        else if (token == "tonemap")
+            parsed.tone_map = true;
+        else if (token == "grade")
+            parsed.grade = true;
+        else if (token != "off")
+            return false;
+    }
+    out_settings = parsed;
+    return true;
+}
+
+std::string PostProcess::Format(const PostSettings& settings)
+{
+    std::string text;
+    for (const auto& [enabled, name] : { std::pair{ settings.bloom, "bloom" }, std::pair{ settings.tone_map, "tonemap" }, std::pair{ settings.grade, "grade" } })
+    {
+        if (enabled)
+            text += text.empty() ? name : std::string{ "+" } + name;
+    }
+    return text.empty() ? "off" : text;
+}
+
+bool PostProcess::isBrightReady()
+{
+    if (bright_program.IsReady())
+        return true;
+    if (!bright_program.Poll())
+        return false;
+    const GLuint id           = bright_program.Id();
+    bright_locations          = { glGetUniformLocation(id, "uScale"), glGetUniformLocation(id, "uLimit") };
+    bright_texel_location     = glGetUniformLocation(id, "uTexel");
+    bright_threshold_location = glGetUniformLocation(id, "uThreshold");
+    gl_state::UseProgram(id);
+    glUniform1i(glGetUniformLocation(id, "uSource"), 0);
+    return true;
+}
+
+bool PostProcess::isBlurReady()
+{
+    if (blur_program.IsReady())
+        return true;
+    if (!blur_program.Poll())
+        return false;
+    const GLuint id    = blur_program.Id();
+    blur_step_location = glGetUniformLocation(id, "uStep");
+    gl_state::UseProgram(id);
+    glUniform1i(glGetUniformLocation(id, "uSource"), 0);
+    return true;
+}
+
+bool PostProcess::isCompositeReady()
+{
+    if (composite_program.IsReady())
+        return true;
+    if (!composite_program.Poll())
+        return false;
+    const GLuint id          = composite_program.Id();
+    composite_locations      = { glGetUniformLocation(id, "uScale"), glGetUniformLocation(id, "uLimit") };
+    bloom_intensity_location = glGetUniformLocation(id, "uBloomIntensity");
+    exposure_location        = glGetUniformLocation(id, "uExposure");
+    tone_map_location        = glGetUniformLocation(id, "uToneMap");
+    lut_strength_location    = glGetUniformLocation(id, "uLutStrength");
+    gl_state::UseProgram(id);
+    glUniform1i(glGetUniformLocation(id, "uScene"), 0);
+    glUniform1i(glGetUniformLocation(id, "uBloom"), static_cast<GLint>(BLOOM_UNIT));
+    glUniform1i(glGetUniformLocation(id, "uLut"), static_cast<GLint>(LUT_UNIT));
+    return true;
+}
+
+RenderGraph::Resource PostProcess::addBloom(RenderGraph& graph, RenderGraph::Resource scene, const PostSettings& settings)
+{
+    if (!isBrightReady() || !isBlurReady())
+        return RenderGraph::NONE;
+    const glm::ivec2            size   = glm::max(graph.Surface(scene).size / std::clamp(settings.bloom_divisor, 1, 4), glm::ivec2{ 1 });
+    const RenderGraph::Resource bright = graph.Create("bloom bright", size, bloom_format);
+    const RenderGraph::Resource across = graph.Create("bloom across", size, bloom_format);
+    const RenderGraph::Resource bloom  = graph.Create("bloom", size, bloom_format);
+    graph
+        .AddPass("Bloom Bright Pass",
+                 [this, scene, bright, &settings](const RenderGraph& frame_graph) {
+                     const ColorSurface source = frame_graph.Surface(scene);
+                     const ColorSurface target = frame_graph.Surface(bright);
+                     if (target.framebuffer == 0)
+                         return;
+                     PROFILE_GPU_ZONE("Bloom Bright Pass");
+                     GL_STATS_PASS("Bloom");
+                     gl_state::UseProgram(bright_program.Id());
+                     const glm::vec2 texel = 1.0f / glm::vec2{ source.allocated };
+                     const glm::vec2 limit = (glm::vec2{ source.size } - 0.5f) * texel;
+                     glUniform2f(bright_locations.scale, static_cast<float>(source.size.x) * texel.x, static_cast<float>(source.size.y) * texel.y);
+                     glUniform2f(bright_locations.limit, limit.x, limit.y);
+                     glUniform2f(bright_texel_location, texel.x, texel.y);
+                     glUniform1f(bright_threshold_location, settings.bloom_threshold);
+                     gl_state::ActiveTexture(0);
+                     gl_state::BindTexture(source.texture);
+                     drawInto(target);
+                     gl_stats::CountDraw(1);
+                 })
+        .Read(scene)
+        .Write(bright);
+    // the vertical half writes a third image rather than back into `bright`; that one is free by then, so the graph
+    // puts both in the same target and the chain still takes two
+    for (const auto& [source, target, is_horizontal] : { std::tuple{ bright, across, true }, std::tuple{ across, bloom, false } })
+    {
+        graph
+            .AddPass(is_horizontal ? "Bloom Blur Horizontal" : "Bloom Blur Vertical",
+                     [this, source, target, is_horizontal, size](const RenderGraph& frame_graph) {
+                         const ColorSurface from = frame_graph.Surface(source);
+                         const ColorSurface to   = frame_graph.Surface(target);
+                         if (to.framebuffer == 0)
+                             return;
+                         PROFILE_GPU_ZONE("Bloom Blur");
+                         GL_STATS_PASS("Bloom");
+                         gl_state::UseProgram(blur_program.Id());
+                         const glm::vec2 texel = 1.0f / glm::vec2{ size };
+                         glUniform2f(blur_step_location, is_horizontal ? texel.x : 0.0f, is_horizontal ? 0.0f : texel.y);
+                         gl_state::ActiveTexture(0);
+                         gl_state::BindTexture(from.texture);
+                         drawInto(to);
+                         gl_stats::CountDraw(1);
+                     })
+            .Read(source)
+            .Write(target);
+    }
+    return bloom;
+}
+
+void PostProcess::updateLut(const PostSettings& settings)
+{
+    if (lut != 0 && !is_grade_changed(settings, lut_settings))
+        return;
+    std::vector<std::uint8_t> texels;
+    texels.reserve(LUT_SIZE * LUT_SIZE * LUT_SIZE * 3);
+    constexpr float STEP = 1.0f / static_cast<float>(LUT_SIZE - 1);
+    for (int b = 0; b < LUT_SIZE; ++b)
+    {
+        for (int g = 0; g < LUT_SIZE; ++g)
+        {
+            for (int r = 0; r < LUT_SIZE; ++r)
+            {
+                const glm::vec3 color = grade(glm::vec3{ static_cast<float>(r), static_cast<float>(g), static_cast<float>(b) } * STEP, settings);
+                for (int channel = 0; channel < 3; ++channel)
+                    texels.push_back(static_cast<std::uint8_t>(color[channel] * 255.0f + 0.5f));
+            }
+        }
+    }
+    if (lut == 0)
+    {
+        glGenTextures(1, &lut);
+        gl_state::ActiveTexture(LUT_UNIT);
+        glBindTexture(GL_TEXTURE_3D, lut);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+    gl_state::ActiveTexture(LUT_UNIT);
+    glBindTexture(GL_TEXTURE_3D, lut);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB8, LUT_SIZE, LUT_SIZE, LUT_SIZE, 0, GL_RGB, GL_UNSIGNED_BYTE, texels.data());
+    lut_settings = settings;
+}
+
+void PostProcess::drawInto(const ColorSurface& target)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    gl_state::Viewport(0, 0, target.size.x, target.size.y);
+    gl_state::SetEnabled(GL_BLEND, false);
+    gl_state::BindVertexArray(vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
@@ -0,0 +1,103 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "render_graph.h"
+#include "render_target.h"
+#include "shader.h"
+
+#include <GL/glew.h>
+#include <string>
+#include <string_view>
+
+struct PostSettings
+{
+    bool  bloom           = false;
+    bool  tone_map        = false;
+    bool  grade           = false; // through the 3D LUT built from the numbers below
+    int   bloom_divisor   = 2;     // the bloom passes run at the scene's size over this: 1, 2 or 4
+    float bloom_threshold = 0.8f;
+    float bloom_intensity = 0.5f;
+    float exposure        = 1.0f;
+    float contrast        = 1.1f;
+    float saturation      = 1.15f;
+    float warmth          = 0.03f; // added to red and taken from blue
+
+    bool operator==(const PostSettings&) const = default;
+    bool IsEnabled() const noexcept { return bloom || tone_map || grade; }
+};
+
+/**
+ * Bloom, tone mapping and color grading between the scene and its upscale.
+ *
+ * Bloom is a bright pass that also downsamples, at half the scene's size by default, then a separable gaussian
+ * blur there. Tone mapping and grading share one full size pass that adds the bloom back, decodes to linear,
+ * applies exposure and the ACES fit, re-encodes, and looks the result up in a 16x16x16 LUT; the LUT is rebuilt on
+ * the CPU when the grade's numbers change. Every intermediate comes from a RenderTargetPool, so the chain holds a
+ * few targets whatever it runs, and each pass is its own GPU zone in the profiler: toggling an effect shows what
+ * it costs. Bloom's targets are half float where the context can render to them.
+ *
+ * Apply returns what to present: the scene itself when nothing is enabled or a program is still compiling.
+ * EndFrame after presenting gives its targets back. GL thread only.
+ */
+class PostProcess
+{
+public:
+    PostProcess() = default;
+
+    PostProcess(const PostProcess&)                = delete;
+    PostProcess& operator=(const PostProcess&)     = delete;
+    PostProcess(PostProcess&&) noexcept            = delete;
+    PostProcess& operator=(PostProcess&&) noexcept = delete;
+
+    void Setup();
+    void Shutdown();
+
+    RenderGraph::Resource AddPasses(RenderGraph& graph, RenderGraph::Resource scene, const PostSettings& settings);
+
+    // Controls for the caller's current window; returns true when something changed
+    static bool DrawImGui(PostSettings& settings);
+
+    // "off", or any of "bloom", "tonemap" and "grade" joined by '+'
+    static bool Parse(std::string_view text, PostSettings& out_settings);
+    // What Parse reads back; the effects' numbers are not part of it
+    static std::string Format(const PostSettings& settings);
+
+private:
+    struct SceneLocations
+    {
+        GLint scale = -1;
+        GLint limit = -1;
+    };
+
+    // each sets its samplers' units the first time it's ready
+    bool                  isBrightReady();
+    bool                  isBlurReady();
+    bool                  isCompositeReady();
+    RenderGraph::Resource addBloom(RenderGraph& graph, RenderGraph::Resource scene, const PostSettings& settings);
+    void                  updateLut(const PostSettings& settings);
+    void                  drawInto(const ColorSurface& target);
+
+private:
+    ShaderProgram  bright_program;
+    ShaderProgram  blur_program;
+    ShaderProgram  composite_program;
+    SceneLocations bright_locations;
+    SceneLocations composite_locations;
+    GLint          bright_texel_location     = -1;
+    GLint          bright_threshold_location = -1;
+    GLint          blur_step_location        = -1;
+    GLint          bloom_intensity_location  = -1;
+    GLint          exposure_location         = -1;
+    GLint          tone_map_location         = -1;
+    GLint          lut_strength_location     = -1;
+    GLuint         vertex_array              = 0;
+    GLuint         lut                       = 0;
+    GLenum         bloom_format              = GL_RGBA8;
+    PostSettings   lut_settings; // what `lut` was built from
+};
@@ -0,0 +1,839 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "profiler.h"
+
+#include "allocation_counter.h"
+#include "gpu_profiler.h"
+#include "logger.h"
+#include "mapped_file.h"
+#include "trace_ring.h"
+
+#include <SDL_stdinc.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <imgui.h>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    struct
+    {
+        profiler::FrameRecord  frames[profiler::MAX_FRAMES];
+        profiler::FrameRecord* current         = nullptr;
+        int                    write_index     = 0;
+        int                    completed_count = 0;
+        int                    depth           = 0;
+    } gProfiler;
+
+    struct MemoryStat
+    {
+        const char* name       = nullptr;
+        std::size_t used       = 0;
+        std::size_t high_water = 0;
+        std::size_t capacity   = 0;
+    };
+
+    MemoryStat gMemoryStats[profiler::MAX_MEMORY_STATS];
+
+    struct TraceEvent
+    {
+        const char* name  = nullptr;
+        Uint64      begin = 0;
+        Uint64      end   = 0;
+    };
+
+    // Written only by its own thread. `count` is published with release after the event it covers, so a
+    // reader that sees a count can read that many events; a new capture generation makes the owner start over.
+    // The flight recorder's ring works the same way with its `written`, except that the owner laps it.
+    struct ThreadTrace
+    {
+        char                                name[32] = {};
+        int                                 slot     = 0; // in gThreadTraces, and the ring file's threads
+        std::unique_ptr<TraceEvent[]>       events;
+        std::atomic<int>                    count{ 0 };
+        std::atomic<int>                    dropped{ 0 };
+        std::atomic<int>                    generation{ 0 };
+        trace_ring::Thread*                 recent     = nullptr; // owned_recent, or the thread's ring in the file
+        bool                                is_in_file = false;
+        std::unique_ptr<trace_ring::Thread> owned_recent;
+    };
+
+    std::atomic<bool> gCapturing{ false };
+    std::atomic<bool> gRecording{ false };
+    std::atomic<int>  gCaptureGeneration{ 0 };
+    Uint64            gCaptureBegin = 0;
+
+    // MapRecording's, never unmapped; with it the flight recorder writes there instead of the heap
+    std::atomic<trace_ring::File*>  gRingFile{ nullptr };
+    std::mutex                      gRingNameMutex;
+    std::unordered_set<const char*> gRingNamed; // under gRingNameMutex
+
+    struct CounterEvent
+    {
+        const char* name  = nullptr;
+        Uint64      time  = 0;
+        long long   value = 0;
+    };
+
+    // main thread: what ReportCounter was given while capturing
+    std::unique_ptr<CounterEvent[]> gCounterEvents;
+    int                             gCounterEventCount = 0;
+    int                             gCounterDropped    = 0;
+    // never freed: a thread's buffer has to stay readable after the thread is gone
+    std::array<std::atomic<ThreadTrace*>, profiler::MAX_TRACE_THREADS> gThreadTraces{};
+    std::atomic<int>                                                   gThreadTraceCount{ 0 };
+
+    ThreadTrace* register_thread() noexcept
+    {
+        const int slot = gThreadTraceCount.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= profiler::MAX_TRACE_THREADS)
+            return nullptr;
+        ThreadTrace* trace = new (std::nothrow) ThreadTrace{};
+        if (trace != nullptr)
+            trace->slot = slot;
+        gThreadTraces[static_cast<std::size_t>(slot)].store(trace, std::memory_order_release);
+        return trace;
+    }
+
+    ThreadTrace* this_thread_trace() noexcept
+    {
+        thread_local ThreadTrace* const trace = register_thread();
+        return trace;
+    }
+
+    bool is_tracing() noexcept
+    {
+        return gCapturing.load(std::memory_order_relaxed) || gRecording.load(std::memory_order_relaxed);
+    }
+
+    // the text behind a name pointer, copied into the ring file the first time this thread records it; a thread's
+    // own cache of the pointers it already noted keeps the lock off the common case
+    void note_name(trace_ring::File& file, const char* name) noexcept
+    {
+        constexpr std::size_t                            CACHE_SIZE = 256;
+        thread_local std::array<const char*, CACHE_SIZE> noted{};
+        const char*&                                     cached = noted[(reinterpret_cast<std::uintptr_t>(name) >> 4) % CACHE_SIZE];
+        if (cached == name)
+            return;
+        cached = name;
+        std::lock_guard lock{ gRingNameMutex };
+        if (!gRingNamed.insert(name).second)
+            return;
+        const std::uint32_t count = file.header.name_count.load(std::memory_order_relaxed);
+        if (count == trace_ring::MAX_NAMES)
+            return;
+        trace_ring::Name& entry = file.names[count];
+        entry.pointer           = reinterpret_cast<std::uintptr_t>(name);
+        SDL_strlcpy(entry.text, name, sizeof(entry.text));
+        file.header.name_count.store(count + 1, std::memory_order_release);
+    }
+
+    // on the thread's first zone: its slot in the ring file when MapRecording made one, the heap otherwise
+    void bind_recent(ThreadTrace* trace) noexcept
+    {
+        if (trace_ring::File* file = gRingFile.load(std::memory_order_acquire); file != nullptr)
+        {
+            trace->recent     = &file->threads[trace->slot];
+            trace->is_in_file = true;
+            SDL_strlcpy(trace->recent->name, trace->name, sizeof(trace->recent->name));
+            return;
+        }
+        trace->owned_recent.reset(new (std::nothrow) trace_ring::Thread{});
+        trace->recent = trace->owned_recent.get();
+    }
+
+    void record_recent(ThreadTrace* trace, const char* name, Uint64 begin, Uint64 end) noexcept
+    {
+        if (trace->recent == nullptr)
+            bind_recent(trace);
+        if (trace->recent == nullptr)
+            return;
+        if (trace->is_in_file)
+            note_name(*gRingFile.load(std::memory_order_relaxed), name);
+        const std::uint64_t written = trace->recent->written.load(std::memory_order_relaxed);
+        trace->recent->events[static_cast<std::size_t>(written % profiler::MAX_RECENT_EVENTS)] = trace_ring::Event{ reinterpret_cast<std::uintptr_t>(name), begin, end };
+        trace->recent->written.store(written + 1, std::memory_order_release);
+    }
+
+    void record_counter(trace_ring::File& file, const char* name, long long value) noexcept
+    {
+        note_name(file, name);
+        const std::uint64_t written                             = file.header.counters_written.load(std::memory_order_relaxed);
+        file.counters[written % trace_ring::MAX_COUNTER_VALUES] = trace_ring::Counter{ reinterpret_cast<std::uintptr_t>(name), SDL_GetPerformanceCounter(), value };
+        file.header.counters_written.store(written + 1, std::memory_order_release);
+    }
+
+    // any thread, from logger::Write
+    void record_log(const logger::Record& record)
+    {
+        trace_ring::File* file = gRingFile.load(std::memory_order_acquire);
+        if (file == nullptr)
+            return;
+        const std::uint64_t written = file->header.logs_written.fetch_add(1, std::memory_order_relaxed);
+        trace_ring::Log&    slot    = file->logs[written % trace_ring::MAX_LOG_RECORDS];
+        slot.sequence.store(0, std::memory_order_relaxed);
+        slot.record = record;
+        slot.sequence.store(written + 1, std::memory_order_release);
+    }
+
+    void record_capture(ThreadTrace* trace, const char* name, Uint64 begin, Uint64 end) noexcept
+    {
+        if (const int generation = gCaptureGeneration.load(std::memory_order_acquire); trace->generation.load(std::memory_order_relaxed) != generation)
+        {
+            trace->count.store(0, std::memory_order_relaxed);
+            trace->dropped.store(0, std::memory_order_relaxed);
+            trace->generation.store(generation, std::memory_order_release);
+        }
+        if (trace->events == nullptr)
+            trace->events.reset(new (std::nothrow) TraceEvent[profiler::MAX_TRACE_EVENTS]);
+        const int count = trace->count.load(std::memory_order_relaxed);
+        if (trace->events == nullptr || count == profiler::MAX_TRACE_EVENTS)
+        {
+            trace->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        trace->events[static_cast<std::size_t>(count)] = TraceEvent{ name, begin, end };
+        trace->count.store(count + 1, std::memory_order_release);
+    }
+
+    void record_trace(const char* name, Uint64 begin, Uint64 end) noexcept
+    {
+        ThreadTrace* trace = this_thread_trace();
+        if (trace == nullptr)
+            return;
+        if (gRecording.load(std::memory_order_relaxed))
+            record_recent(trace, name, begin, end);
+        if (gCapturing.load(std::memory_order_relaxed))
+            record_capture(trace, name, begin, end);
+    }
+
+    void write_json_string(std::ostream& out, std::string_view text)
+    {
+        out << '"';
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                out << ' ';
+            else
+                out << c;
+        }
+        out << '"';
+    }
+
+    // a char array another process filled, which may have no terminator
+    template <std::size_t Size>
+    std::string_view fixed_text(const char (&text)[Size])
+    {
+        return { text, static_cast<std::size_t>(std::find(text, text + Size, '\0') - text) };
+    }
+
+    double to_trace_microseconds(Uint64 ticks)
+    {
+        return profiler::ToMilliseconds(ticks - gCaptureBegin) * 1000.0;
+    }
+
+    double average_zone_ms(const char* name, int frame_count)
+    {
+        double total = 0.0;
+        int    found = 0;
+        for (int i = 0; i < frame_count; ++i)
+        {
+            const auto& frame = profiler::GetFrame(i);
+            for (int z = 0; z < frame.zone_count; ++z)
+            {
+                if (frame.zones[z].name == name)
+                {
+                    total += profiler::ToMilliseconds(frame.zones[z].end - frame.zones[z].begin);
+                    ++found;
+                    break;
+                }
+            }
+        }
+        return found > 0 ? total / found : 0.0;
+    }
+
+    // average and peak over the frames that reported `name`
+    void counter_summary(const char* name, int frame_count, double& out_average, long long& out_peak)
+    {
+        double total = 0.0;
+        int    found = 0;
+        out_peak     = 0;
+        for (int i = 0; i < frame_count; ++i)
+        {
+            const auto& frame = profiler::GetFrame(i);
+            for (int c = 0; c < frame.counter_count; ++c)
+            {
+                if (frame.counters[c].name == name)
+                {
+                    total += static_cast<double>(frame.counters[c].value);
+                    out_peak = std::max(out_peak, frame.counters[c].value);
+                    ++found;
+                    break;
+                }
+            }
+        }
+        out_average = found > 0 ? total / found : 0.0;
+    }
+}
+
+namespace profiler
+{
+    void BeginFrame() noexcept
+    {
+        FrameRecord& frame = gProfiler.frames[gProfiler.write_index];
+        frame.zone_count    = 0;
+        frame.counter_count = 0;
+        frame.begin         = SDL_GetPerformanceCounter();
+        frame.end           = frame.begin;
+        gProfiler.current   = &frame;
+        gProfiler.depth     = 0;
+    }
+
+    void EndFrame() noexcept
+    {
+        if (gProfiler.current == nullptr)
+            return;
+        gProfiler.current->end = SDL_GetPerformanceCounter();
+        if (is_tracing())
+            record_trace("Frame", gProfiler.current->begin, gProfiler.current->end);
+        gProfiler.current         = nullptr;
+        gProfiler.write_index     = (gProfiler.write_index + 1) % MAX_FRAMES;
+        gProfiler.completed_count = std::min(gProfiler.completed_count + 1, MAX_FRAMES);
+    }
+
+    const FrameRecord& GetFrame(int frames_ago) noexcept
+    {
+        const int index = (gProfiler.write_index - 1 - frames_ago + 2 * MAX_FRAMES) % MAX_FRAMES;
+        return gProfiler.frames[index];
+    }
+
+    int FrameCount() noexcept
+    {
+        return gProfiler.completed_count;
+    }
+
+    void ReportMemory(const char* name, std::size_t used, std::size_t high_water, std::size_t capacity) noexcept
+    {
+#if PROFILER_TRACY
+        TracyPlot(name, static_cast<int64_t>(used));
+#endif
+        for (MemoryStat& stat : gMemoryStats)
+        {
+            if (stat.name == nullptr || stat.name == name)
+            {
+                stat = MemoryStat{ name, used, high_water, capacity };
+                return;
+            }
+        }
+    }
+
+    void ReportCounter(const char* name, long long value) noexcept
+    {
+#if PROFILER_TRACY
+        TracyPlot(name, static_cast<int64_t>(value));
+#endif
+        if (trace_ring::File* file = gRingFile.load(std::memory_order_relaxed); file != nullptr && gRecording.load(std::memory_order_relaxed))
+            record_counter(*file, name, value);
+        if (gCapturing.load(std::memory_order_relaxed))
+        {
+            if (gCounterEvents != nullptr && gCounterEventCount < MAX_TRACE_EVENTS)
+                gCounterEvents[static_cast<std::size_t>(gCounterEventCount++)] = CounterEvent{ name, SDL_GetPerformanceCounter(), value };
+            else
+                ++gCounterDropped;
+        }
+        FrameRecord* frame = gProfiler.current;
+        if (frame == nullptr)
+            return;
+        for (int c = 0; c < frame->counter_count; ++c)
+        {
+            if (frame->counters[c].name == name)
+            {
+                frame->counters[c].value = value;
+                return;
+            }
+        }
+        if (frame->counter_count < MAX_COUNTERS)
+            frame->counters[frame->counter_count++] = CounterRecord{ name, value };
+    }
+
+    double ToMilliseconds(Uint64 ticks) noexcept
+    {
+        static const double ms_per_tick = 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+        return static_cast<double>(ticks) * ms_per_tick;
+    }
+
+    Zone::Zone(const char* new_name) noexcept : name{ new_name }, begin{ SDL_GetPerformanceCounter() }
+    {
+        FrameRecord* frame = gProfiler.current;
+        if (frame == nullptr || frame->zone_count == MAX_ZONES)
+            return;
+        index            = frame->zone_count++;
+        ZoneRecord& zone = frame->zones[index];
+        zone.name        = name;
+        zone.depth       = gProfiler.depth++;
+        zone.begin       = begin;
+        zone.end         = zone.begin;
+    }
+
+    Zone::~Zone()
+    {
+        const Uint64 end = SDL_GetPerformanceCounter();
+        if (is_tracing())
+            record_trace(name, begin, end);
+        if (index < 0 || gProfiler.current == nullptr)
+            return;
+        gProfiler.current->zones[index].end = end;
+        --gProfiler.depth;
+    }
+
+    TraceZone::TraceZone(const char* new_name) noexcept : name{ new_name }
+    {
+        if (is_tracing())
+            begin = SDL_GetPerformanceCounter();
+    }
+
+    TraceZone::~TraceZone()
+    {
+        if (begin != 0 && is_tracing())
+            record_trace(name, begin, SDL_GetPerformanceCounter());
+    }
+
+    void StartCapture() noexcept
+    {
+        if (IsCapturing())
+            return;
+        if (gCounterEvents == nullptr)
+            gCounterEvents.reset(new (std::nothrow) CounterEvent[MAX_TRACE_EVENTS]);
+        gCounterEventCount = 0;
+        gCounterDropped    = 0;
+        gCaptureBegin      = SDL_GetPerformanceCounter();
+        gCaptureGeneration.fetch_add(1, std::memory_order_release);
+        gCapturing.store(true, std::memory_order_release);
+    }
+
+    // https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+    bool StopCapture(const std::filesystem::path& filename)
+    {
+        if (!IsCapturing())
+            return false;
+        gCapturing.store(false, std::memory_order_release);
+        std::ofstream out{ filename };
+        if (!out)
+        {
+            LOG_ERROR("Failed to write profiler capture ", filename);
+            return false;
+        }
+        const int generation = gCaptureGeneration.load(std::memory_order_relaxed);
+        const int threads    = std::min(gThreadTraceCount.load(std::memory_order_relaxed), MAX_TRACE_THREADS);
+        int       dropped    = 0;
+        bool      first      = true;
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (int t = 0; t < threads; ++t)
+        {
+            const ThreadTrace* trace = gThreadTraces[static_cast<std::size_t>(t)].load(std::memory_order_acquire);
+            if (trace == nullptr || trace->generation.load(std::memory_order_acquire) != generation)
+                continue;
+            const int count = trace->count.load(std::memory_order_acquire);
+            dropped += trace->dropped.load(std::memory_order_relaxed);
+            out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":\"";
+            if (trace->name[0] != '\0')
+                out << trace->name;
+            else
+                out << "thread " << t;
+            out << "\"}}";
+            first = false;
+            for (int e = 0; e < count; ++e)
+            {
+                // zones still open when the capture started have nothing to line up with
+                const TraceEvent& event = trace->events[static_cast<std::size_t>(e)];
+                if (event.begin < gCaptureBegin)
+                    continue;
+                out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t << ",\"ts\":" << to_trace_microseconds(event.begin)
+                    << ",\"dur\":" << ToMilliseconds(event.end - event.begin) * 1000.0 << '}';
+            }
+        }
+        // one track per name
+        for (int e = 0; e < gCounterEventCount; ++e)
+        {
+            const CounterEvent& event = gCounterEvents[static_cast<std::size_t>(e)];
+            out << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"C\",\"pid\":1,\"ts\":" << to_trace_microseconds(event.time) << ",\"args\":{\"value\":" << event.value
+                << "}}";
+            first = false;
+        }
+        out << "\n]}\n";
+        if (dropped > 0)
+            LOG_WARN("Profiler capture dropped ", dropped, " zone(s) past ", MAX_TRACE_EVENTS, " per thread");
+        if (gCounterDropped > 0)
+            LOG_WARN("Profiler capture dropped ", gCounterDropped, " counter value(s) past ", MAX_TRACE_EVENTS);
+        return static_cast<bool>(out);
+    }
+
+    bool IsCapturing() noexcept
+    {
+        return gCapturing.load(std::memory_order_acquire);
+    }
+
+    double CaptureSeconds() noexcept
+    {
+        return IsCapturing() ? ToMilliseconds(SDL_GetPerformanceCounter() - gCaptureBegin) / 1000.0 : 0.0;
+    }
+
+    void StartRecording() noexcept
+    {
+        gRecording.store(true, std::memory_order_release);
+    }
+
+    bool IsRecording() noexcept
+    {
+        return gRecording.load(std::memory_order_acquire);
+    }
+
+    RecentTrace CopyRecent(double seconds)
+    {
+        RecentTrace copy;
+        copy.end                 = SDL_GetPerformanceCounter();
+        const auto window_ticks  = static_cast<Uint64>(seconds * static_cast<double>(SDL_GetPerformanceFrequency()));
+        copy.begin               = copy.end > window_ticks ? copy.end - window_ticks : 0;
+        constexpr auto RING_SIZE = static_cast<std::uint64_t>(MAX_RECENT_EVENTS);
+        const int      threads   = std::min(gThreadTraceCount.load(std::memory_order_relaxed), MAX_TRACE_THREADS);
+        std::vector<trace_ring::Event> ring;
+        for (int t = 0; t < threads; ++t)
+        {
+            const ThreadTrace* trace = gThreadTraces[static_cast<std::size_t>(t)].load(std::memory_order_acquire);
+            if (trace == nullptr || trace->recent == nullptr)
+                continue;
+            const std::uint64_t written = trace->recent->written.load(std::memory_order_acquire);
+            if (written == 0)
+                continue;
+            const std::uint64_t first = written > RING_SIZE ? written - RING_SIZE : 0;
+            ring.clear();
+            for (std::uint64_t i = first; i < written; ++i)
+                ring.push_back(trace->recent->events[static_cast<std::size_t>(i % RING_SIZE)]);
+            // what the owner wrote meanwhile went over the oldest entries, which can't be trusted now
+            const std::uint64_t after  = trace->recent->written.load(std::memory_order_acquire);
+            const std::uint64_t intact = after > RING_SIZE ? after - RING_SIZE : 0;
+            const int           thread = static_cast<int>(copy.thread_names.size());
+            copy.thread_names.push_back(trace->name[0] != '\0' ? std::string{ trace->name } : "thread " + std::to_string(t));
+            for (std::uint64_t i = first; i < written; ++i)
+            {
+                const trace_ring::Event& event = ring[static_cast<std::size_t>(i - first)];
+                if (i < intact)
+                    ++copy.lapped;
+                else if (event.end >= copy.begin)
+                    copy.events.push_back(TraceRecord{ reinterpret_cast<const char*>(static_cast<std::uintptr_t>(event.name)), event.begin, event.end, thread });
+            }
+        }
+        return copy;
+    }
+
+    bool WriteTrace(const RecentTrace& trace, const std::filesystem::path& filename, std::span<const std::pair<std::string, std::string>> metadata)
+    {
+        std::ofstream out{ filename };
+        if (!out)
+        {
+            LOG_ERROR("Failed to write trace ", filename);
+            return false;
+        }
+        out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{";
+        for (std::size_t i = 0; i < metadata.size(); ++i)
+        {
+            out << (i == 0 ? "" : ",");
+            write_json_string(out, metadata[i].first);
+            out << ':';
+            write_json_string(out, metadata[i].second);
+        }
+        out << "},\"traceEvents\":[";
+        for (std::size_t t = 0; t < trace.thread_names.size(); ++t)
+        {
+            out << (t == 0 ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":";
+            write_json_string(out, trace.thread_names[t]);
+            out << "}}";
+        }
+        for (const TraceRecord& event : trace.events)
+        {
+            // zones that began before the window have nothing to line up with, as in a capture
+            if (event.begin < trace.begin)
+                continue;
+            out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << ToMilliseconds(event.begin - trace.begin) * 1000.0
+                << ",\"dur\":" << ToMilliseconds(event.end - event.begin) * 1000.0 << '}';
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+
+    bool MapRecording(const std::filesystem::path& filename)
+    {
+        if (gRingFile.load(std::memory_order_acquire) != nullptr)
+            return true;
+        {
+            MappedFile previous;
+            if (const trace_ring::File* file = previous.Open(filename) ? trace_ring::View(previous.Bytes()) : nullptr; file != nullptr && file->header.is_closed.load(std::memory_order_acquire) == 0)
+            {
+                auto crash = filename;
+                crash.replace_extension();
+                crash += "_crash_" + std::to_string(file->header.unix_time) + ".json";
+                previous.Close();
+                if (WriteRingTrace(filename, crash))
+                    LOG_WARN("The last run didn't exit cleanly; its trace ring is in ", std::filesystem::absolute(crash).string());
+            }
+        }
+        trace_ring::File* file = trace_ring::Create(filename);
+        if (file == nullptr)
+            return false;
+        gRingFile.store(file, std::memory_order_release);
+        logger::SetMirror(&record_log);
+        StartRecording();
+        return true;
+    }
+
+    void CloseRecording() noexcept
+    {
+        if (trace_ring::File* file = gRingFile.load(std::memory_order_acquire); file != nullptr)
+            file->header.is_closed.store(1, std::memory_order_release);
+    }
+
+    bool WriteRingTrace(const std::filesystem::path& ring, const std::filesystem::path& filename)
+    {
+        MappedFile mapped;
+        if (!mapped.Open(ring))
+        {
+            LOG_ERROR("Failed to open the trace ring ", ring);
+            return false;
+        }
+        const trace_ring::File* file = trace_ring::View(mapped.Bytes());
+        if (file == nullptr)
+        {
+            LOG_ERROR(ring, " isn't a trace ring this build wrote");
+            return false;
+        }
+        std::ofstream out{ filename };
+        if (!out)
+        {
+            LOG_ERROR("Failed to write trace ", filename);
+            return false;
+        }
+
+        const trace_ring::Header&                           header     = file->header;
+        std::unordered_map<std::uint64_t, std::string_view> names;
+        const std::uint32_t                                 name_count = std::min(header.name_count.load(std::memory_order_acquire), static_cast<std::uint32_t>(trace_ring::MAX_NAMES));
+        for (std::uint32_t n = 0; n < name_count; ++n)
+            names.emplace(file->names[n].pointer, fixed_text(file->names[n].text));
+        const auto name_of = [&names](std::uint64_t pointer)
+        {
+            const auto found = names.find(pointer);
+            return found != names.end() ? found->second : std::string_view{ "?" };
+        };
+        // from when the file was made; zones that began before it have nothing to line up with
+        const auto microseconds = [&header](Uint64 ticks) { return static_cast<double>(ticks - header.start_ticks) * 1e6 / static_cast<double>(header.ticks_per_second); };
+
+        out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"unix_time\":\"" << header.unix_time << "\",\"clean_exit\":\"" << (header.is_closed.load(std::memory_order_acquire) != 0 ? "yes" : "no")
+            << "\"},\"traceEvents\":[";
+        bool first = true;
+        for (int t = 0; t < MAX_TRACE_THREADS; ++t)
+        {
+            const trace_ring::Thread& thread  = file->threads[t];
+            const std::uint64_t       written = thread.written.load(std::memory_order_acquire);
+            if (written == 0)
+                continue;
+            out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":";
+            const std::string_view thread_name = fixed_text(thread.name);
+            write_json_string(out, thread_name.empty() ? "thread " + std::to_string(t) : std::string{ thread_name });
+            out << "}}";
+            first = false;
+            // a lapped ring's oldest entry may be the one its thread was writing over when it died
+            constexpr auto      RING_SIZE = static_cast<std::uint64_t>(MAX_RECENT_EVENTS);
+            const std::uint64_t oldest    = written > RING_SIZE ? written - RING_SIZE + 1 : 0;
+            for (std::uint64_t i = oldest; i < written; ++i)
+            {
+                const trace_ring::Event& event = thread.events[i % RING_SIZE];
+                if (event.begin < header.start_ticks || event.end < event.begin)
+                    continue;
+                out << ",\n{\"name\":";
+                write_json_string(out, name_of(event.name));
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << t << ",\"ts\":" << microseconds(event.begin) << ",\"dur\":" << microseconds(event.end) - microseconds(event.begin) << '}';
+            }
+        }
+
+        const std::uint64_t counters = header.counters_written.load(std::memory_order_acquire);
+        for (std::uint64_t i = counters > trace_ring::MAX_COUNTER_VALUES ? counters - trace_ring::MAX_COUNTER_VALUES + 1 : 0; i < counters; ++i)
+        {
+            const trace_ring::Counter& counter = file->counters[i % trace_ring::MAX_COUNTER_VALUES];
+            out << (first ? "\n" : ",\n") << "{\"name\":";
+            write_json_string(out, name_of(counter.name));
+            out << ",\"ph\":\"C\",\"pid\":1,\"ts\":" << microseconds(counter.time) << ",\"args\":{\"value\":" << counter.value << "}}";
+            first = false;
+        }
+
+        // global instant events; log records are stamped with the logger's steady clock in nanoseconds
+        std::vector<const trace_ring::Log*> logs;
+        for (const trace_ring::Log& log : file->logs)
+        {
+            if (log.sequence.load(std::memory_order_acquire) != 0 && log.record.ticks >= header.start_log_ticks)
+                logs.push_back(&log);
+        }
+        std::sort(logs.begin(), logs.end(), [](const trace_ring::Log* a, const trace_ring::Log* b) { return a->sequence.load(std::memory_order_relaxed) < b->sequence.load(std::memory_order_relaxed); });
+        for (const trace_ring::Log* log : logs)
+        {
+            out << (first ? "\n" : ",\n") << "{\"name\":";
+            write_json_string(out, logger::Format(log->record));
+            out << ",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":" << static_cast<double>(log->record.ticks - header.start_log_ticks) / 1000.0 << ",\"args\":{\"level\":\""
+                << logger::LevelName(log->record.level) << "\"}}";
+            first = false;
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+
+    void SetThreadName(const char* name) noexcept
+    {
+#if PROFILER_TRACY
+        tracy::SetThreadName(name);
+#endif
+        if (ThreadTrace* trace = this_thread_trace(); trace != nullptr)
+        {
+            SDL_strlcpy(trace->name, name, sizeof(trace->name));
+            if (trace->recent != nullptr)
+                SDL_strlcpy(trace->recent->name, name, sizeof(trace->recent->name));
+        }
+        allocation_counter::NameThread(name);
+    }
+
+    void DrawImGui()
+    {
+        ImGui::Begin("Profiler");
+        if (IsCapturing())
+            ImGui::Text("capturing a trace: %.1f s, F9 writes it", CaptureSeconds());
+        else
+            ImGui::Text("%s", "F9 captures a trace of every thread");
+        const int frame_count = FrameCount();
+        if (!PROFILER_ENABLED || frame_count == 0)
+        {
+            ImGui::Text("%s", PROFILER_ENABLED ? "Waiting for frames..." : "Profiler compiled out (PROFILER_ENABLED=0)");
+            ImGui::End();
+            return;
+        }
+
+        static float frame_ms[MAX_FRAMES];
+        float        total   = 0.0f;
+        float        longest = 0.0f;
+        float        fastest = 1e9f;
+        for (int i = 0; i < frame_count; ++i)
+        {
+            const auto& frame = GetFrame(frame_count - 1 - i);
+            const float ms    = static_cast<float>(ToMilliseconds(frame.end - frame.begin));
+            frame_ms[i]       = ms;
+            total += ms;
+            longest = std::max(longest, ms);
+            fastest = std::min(fastest, ms);
+        }
+        const float average = total / static_cast<float>(frame_count);
+        ImGui::Text("frame %.2f ms | avg %.2f  min %.2f  max %.2f | %.0f FPS", frame_ms[frame_count - 1], average, fastest, longest, 1000.0f / average);
+        ImGui::PlotLines("##frame_ms", frame_ms, frame_count, 0, nullptr, 0.0f, longest * 1.2f, ImVec2(-1.0f, 80.0f));
+
+        // pacing shows up in the start-to-start interval rather than the work inside a frame
+        if (frame_count > 2)
+        {
+            double interval_sum    = 0.0;
+            double interval_square = 0.0;
+            double worst_interval  = 0.0;
+            for (int i = 0; i + 1 < frame_count; ++i)
+            {
+                const double interval = ToMilliseconds(GetFrame(i).begin - GetFrame(i + 1).begin);
+                interval_sum += interval;
+                interval_square += interval * interval;
+                worst_interval = std::max(worst_interval, interval);
+            }
+            const double samples       = static_cast<double>(frame_count - 1);
+            const double mean_interval = interval_sum / samples;
+            const double jitter        = std::sqrt(std::max(0.0, interval_square / samples - mean_interval * mean_interval));
+            ImGui::Text("interval avg %.2f ms  max %.2f | jitter %.3f ms (std dev)", mean_interval, worst_interval, jitter);
+        }
+
+        if (ImGui::BeginTable("zones", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+        {
+            ImGui::TableSetupColumn("Zone");
+            ImGui::TableSetupColumn("Last (ms)");
+            ImGui::TableSetupColumn("Avg (ms)");
+            ImGui::TableHeadersRow();
+            const auto& latest = GetFrame(0);
+            for (int z = 0; z < latest.zone_count; ++z)
+            {
+                const ZoneRecord& zone = latest.zones[z];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%*s%s", zone.depth * 2, "", zone.name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", ToMilliseconds(zone.end - zone.begin));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", average_zone_ms(zone.name, frame_count));
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::SeparatorText("GPU");
+        if (!IsGpuTimingSupported())
+        {
+            ImGui::Text("%s", "GPU timer queries are not available on this context");
+        }
+        else if (const int gpu_count = GpuFrameCount(); gpu_count > 0)
+        {
+            static float gpu_ms[MAX_FRAMES];
+            float        gpu_longest = 0.0f;
+            for (int i = 0; i < gpu_count; ++i)
+            {
+                gpu_ms[i]   = GpuFrameMilliseconds(gpu_count - 1 - i);
+                gpu_longest = std::max(gpu_longest, gpu_ms[i]);
+            }
+            const GpuFrameResult& gpu = LatestGpuFrame();
+            ImGui::Text("gpu %.3f ms (%d frames behind)", gpu.total_ms, GPU_QUERY_LATENCY);
+            ImGui::PlotLines("##gpu_ms", gpu_ms, gpu_count, 0, nullptr, 0.0f, gpu_longest * 1.2f, ImVec2(-1.0f, 60.0f));
+            for (int z = 0; z < gpu.zone_count; ++z)
+            {
+                ImGui::Text("%-24s %.3f ms", gpu.zones[z].name, gpu.zones[z].ms);
+            }
+        }
+
+        if (const auto& latest = GetFrame(0); latest.counter_count > 0)
+        {
+            ImGui::SeparatorText("Counters");
+            for (int c = 0; c < latest.counter_count; ++c)
+            {
+                const CounterRecord& counter = latest.counters[c];
+                double               average = 0.0;
+                long long            peak    = 0;
+                counter_summary(counter.name, frame_count, average, peak);
+                ImGui::Text("%-24s %lld | avg %.1f  max %lld", counter.name, counter.value, average, peak);
+            }
+        }
+
+        if (gMemoryStats[0].name != nullptr)
+        {
+            ImGui::SeparatorText("Memory");
+            for (const MemoryStat& stat : gMemoryStats)
+            {
+                if (stat.name == nullptr)
+                    break;
+                ImGui::Text("%-24s %.1f KB used | high water %.1f KB of %.1f KB", stat.name, static_cast<double>(stat.used) / 1024.0, static_cast<double>(stat.high_water) / 1024.0,
+                            static_cast<double>(stat.capacity) / 1024.0);
+            }
+        }
+        ImGui::End();
+    }
+}
@@ -0,0 +1,204 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <SDL_stdinc.h>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Define PROFILER_ENABLED=0 in the project settings to compile every zone away
+#if !defined(PROFILER_ENABLED)
+#    define PROFILER_ENABLED 1
+#endif
+
+// The Tracy configuration defines PROFILER_TRACY=1 (and TRACY_ENABLE) to also send zones, frame marks,
+// counters and memory totals to a Tracy client; everywhere else the Tracy half of each macro is empty
+#if !defined(PROFILER_TRACY)
+#    define PROFILER_TRACY 0
+#endif
+
+#if PROFILER_TRACY
+#    include <tracy/Tracy.hpp>
+#endif
+
+namespace profiler
+{
+    inline constexpr int MAX_FRAMES       = 256;
+    inline constexpr int MAX_ZONES        = 32;
+    inline constexpr int MAX_MEMORY_STATS = 8;
+    inline constexpr int MAX_COUNTERS     = 32;
+    // per capture: threads past the first MAX_TRACE_THREADS and zones past MAX_TRACE_EVENTS per thread are dropped
+    inline constexpr int MAX_TRACE_THREADS = 32;
+    inline constexpr int MAX_TRACE_EVENTS  = 1 << 16;
+    // per thread, for the flight recorder
+    inline constexpr int MAX_RECENT_EVENTS = 1 << 14;
+
+    struct ZoneRecord
+    {
+        const char* name  = nullptr;
+        Uint64      begin = 0;
+        Uint64      end   = 0;
+        int         depth = 0;
+    };
+
+    struct CounterRecord
+    {
+        const char* name  = nullptr;
+        long long   value = 0;
+    };
+
+    struct FrameRecord
+    {
+        Uint64        begin         = 0;
+        Uint64        end           = 0;
+        int           zone_count    = 0;
+        int           counter_count = 0;
+        ZoneRecord    zones[MAX_ZONES];
+        CounterRecord counters[MAX_COUNTERS];
+    };
+
+    void BeginFrame() noexcept;
+    void EndFrame() noexcept;
+
+    // frames_ago = 0 is the most recently completed frame
+    const FrameRecord& GetFrame(int frames_ago) noexcept;
+    int                FrameCount() noexcept;
+    double             ToMilliseconds(Uint64 ticks) noexcept;
+
+    // Listed under "Memory" by DrawImGui; `name` is the key and must outlive the profiler
+    void ReportMemory(const char* name, std::size_t used, std::size_t high_water, std::size_t capacity) noexcept;
+    // Recorded into the current frame, listed under "Counters" and written into captures as a counter track;
+    // `name` must outlive the profiler. perf_counters reports everything registered with it here
+    void ReportCounter(const char* name, long long value) noexcept;
+
+    void DrawImGui();
+
+    /**
+     * Captures: every zone on every thread, frame after frame, for as long as it runs.
+     *
+     * Each thread appends to its own fixed buffer, allocated the first time it records, so a zone
+     * ending costs no lock and no allocation. StopCapture writes Chrome trace-event JSON for
+     * chrome://tracing or ui.perfetto.dev. Start and stop on the main thread.
+     */
+    void StartCapture() noexcept;
+    bool StopCapture(const std::filesystem::path& filename);
+    bool IsCapturing() noexcept;
+    // Seconds since StartCapture, 0 when not capturing
+    double CaptureSeconds() noexcept;
+    // Labels the calling thread's track in captures; copied
+    void SetThreadName(const char* name) noexcept;
+
+    struct TraceRecord
+    {
+        const char* name   = nullptr;
+        Uint64      begin  = 0;
+        Uint64      end    = 0;
+        int         thread = 0; // into RecentTrace::thread_names
+    };
+
+    struct RecentTrace
+    {
+        Uint64                   begin = 0; // the oldest moment it covers
+        Uint64                   end   = 0;
+        std::vector<std::string> thread_names;
+        std::vector<TraceRecord> events;
+        int                      lapped = 0; // overwritten by their thread while they were copied
+    };
+
+    /**
+     * The flight recorder: the last MAX_RECENT_EVENTS zones of every thread, kept in a ring for as long as it
+     * runs, so the moments before something went wrong can be written after the fact. Each thread's ring is
+     * allocated the first time it records and a zone costs one more store, capture or not. CopyRecent is quick
+     * enough for the main thread; WriteTrace formats the copy as a Chrome trace on any thread, `metadata` going
+     * into its "otherData".
+     */
+    void        StartRecording() noexcept;
+    bool        IsRecording() noexcept;
+    RecentTrace CopyRecent(double seconds);
+    bool        WriteTrace(const RecentTrace& trace, const std::filesystem::path& filename, std::span<const std::pair<std::string, std::string>> metadata);
+
+    /**
+     * The flight recorder in a memory-mapped file instead, see trace_ring.h, with the counters and the log lines
+     * too, so the last seconds outlive a crash or a kill. A zone costs the same stores as in the heap ring; a name
+     * is copied once per thread. MapRecording also starts recording; call it on the main thread before any other
+     * thread records, which then keep to the heap. A ring the last run left open is written first, as
+     * <name>_crash_<unix time>.json next to it. CloseRecording marks the file as a clean exit and keeps the rings
+     * going until the process ends. WriteRingTrace converts a ring file, from any process of this build, into a
+     * Chrome trace.
+     */
+    bool MapRecording(const std::filesystem::path& filename);
+    void CloseRecording() noexcept;
+    bool WriteRingTrace(const std::filesystem::path& ring, const std::filesystem::path& filename);
+
+    /**
+     * Times the enclosing scope on the main thread, for the frame record and any capture. `name` must outlive the profiler (use a string literal).
+     */
+    class [[nodiscard]] Zone
+    {
+    public:
+        explicit Zone(const char* name) noexcept;
+        ~Zone();
+
+        Zone(const Zone&)            = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* name  = nullptr;
+        Uint64      begin = 0;
+        int         index = -1;
+    };
+
+    /**
+     * Times the enclosing scope on any thread, only while capturing; for workers, the render thread and the like.
+     */
+    class [[nodiscard]] TraceZone
+    {
+    public:
+        explicit TraceZone(const char* name) noexcept;
+        ~TraceZone();
+
+        TraceZone(const TraceZone&)            = delete;
+        TraceZone& operator=(const TraceZone&) = delete;
+
+    private:
+        const char* name  = nullptr;
+        Uint64      begin = 0;
+    };
+}
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b)      PROFILER_CONCAT_IMPL(a, b)
+
+#if PROFILER_TRACY
+#    define PROFILER_TRACY_ZONE(name)       ZoneNamedN(PROFILER_CONCAT(tracy_zone_, __LINE__), name, true);
+#    define PROFILER_TRACY_NAMED_ZONE(name) ZoneTransientN(PROFILER_CONCAT(tracy_zone_, __LINE__), name, true);
+#    define PROFILE_FRAME_MARK()            FrameMark
+#else
+#    define PROFILER_TRACY_ZONE(name)
+#    define PROFILER_TRACY_NAMED_ZONE(name)
+#    define PROFILE_FRAME_MARK()            ((void)0)
+#endif
+
+// PROFILE_NAMED_TRACE_ZONE is for a name that isn't a literal, which has to outlive the capture
+#if PROFILER_ENABLED
+#    define PROFILE_ZONE(name)             PROFILER_TRACY_ZONE(name) const profiler::Zone PROFILER_CONCAT(profile_zone_, __LINE__){ name }
+#    define PROFILE_TRACE_ZONE(name)       PROFILER_TRACY_ZONE(name) const profiler::TraceZone PROFILER_CONCAT(profile_trace_zone_, __LINE__){ name }
+#    define PROFILE_NAMED_TRACE_ZONE(name) PROFILER_TRACY_NAMED_ZONE(name) const profiler::TraceZone PROFILER_CONCAT(profile_trace_zone_, __LINE__){ name }
+#    define PROFILE_BEGIN_FRAME()          profiler::BeginFrame()
+#    define PROFILE_END_FRAME()            profiler::EndFrame()
+#else
+#    define PROFILE_ZONE(name)             PROFILER_TRACY_ZONE(name) ((void)0)
+#    define PROFILE_TRACE_ZONE(name)       PROFILER_TRACY_ZONE(name) ((void)0)
+#    define PROFILE_NAMED_TRACE_ZONE(name) PROFILER_TRACY_NAMED_ZONE(name) ((void)0)
+#    define PROFILE_BEGIN_FRAME()          ((void)0)
+#    define PROFILE_END_FRAME()            ((void)0)
+#endif
@@ -0,0 +1,284 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "qoi_strips.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    // magic, version, width, height, strip rows, strip count; then strip count + 1 offsets from the start of the file
+    constexpr char          MAGIC[4]    = { 'P', 'F', 'Q', 'S' };
+    constexpr std::uint32_t VERSION     = 1;
+    constexpr std::size_t   HEADER_SIZE = 24;
+
+    constexpr unsigned char OP_INDEX = 0x00;
+    constexpr unsigned char OP_DIFF  = 0x40;
+    constexpr unsigned char OP_LUMA  = 0x80;
+    constexpr unsigned char OP_RUN   = 0xC0;
+    constexpr unsigned char OP_RGB   = 0xFE;
+    constexpr unsigned char OP_RGBA  = 0xFF;
+    constexpr unsigned char TAG_MASK = 0xC0;
+    constexpr int           MAX_RUN  = 62;
+
+    struct Pixel
+    {
+        unsigned char r = 0;
+        unsigned char g = 0;
+        unsigned char b = 0;
+        unsigned char a = 255;
+
+        bool operator==(const Pixel&) const = default;
+    };
+
+    std::size_t hash(Pixel pixel) noexcept
+    {
+        return static_cast<std::size_t>(pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+    }
+
+    template <typename T>
+    T read_at(const unsigned char* bytes, std::size_t offset) noexcept
+    {
+        T value{};
+        std::memcpy(&value, bytes + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void write_at(std::vector<unsigned char>& bytes, std::size_t offset, T value) noexcept
+    {
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+
+    void encode_strip(const unsigned char* pixels, std::size_t count, std::vector<unsigned char>& out)
+    {
+        std::array<Pixel, 64> index{};
+        Pixel                 previous;
+        int                   run = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const unsigned char* source = pixels + i * 4;
+            const Pixel          pixel{ source[0], source[1], source[2], source[3] };
+            if (pixel == previous)
+            {
+                ++run;
+                if (run == MAX_RUN || i + 1 == count)
+                {
+                    out.push_back(static_cast<unsigned char>(OP_RUN | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0)
+            {
+                out.push_back(static_cast<unsigned char>(OP_RUN | (run - 1)));
+                run = 0;
+            }
+
+            const std::size_t slot = hash(pixel);
+            if (index[slot] == pixel)
+            {
+                out.push_back(static_cast<unsigned char>(OP_INDEX | slot));
+            }
+            else if (index[slot] = pixel; pixel.a == previous.a)
+            {
+                const auto dr   = static_cast<signed char>(pixel.r - previous.r);
+                const auto dg   = static_cast<signed char>(pixel.g - previous.g);
+                const auto db   = static_cast<signed char>(pixel.b - previous.b);
+                const int  dr_g = dr - dg;
+                const int  db_g = db - dg;
+                if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+                {
+                    out.push_back(static_cast<unsigned char>(OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                }
+                else if (dr_g > -9 && dr_g < 8 && dg > -33 && dg < 32 && db_g > -9 && db_g < 8)
+                {
+                    out.push_back(static_cast<unsigned char>(OP_LUMA | (dg + 32)));
+                    out.push_back(static_cast<unsigned char>((dr_g + 8) << 4 | (db_g + 8)));
+                }
+                else
+                {
+                    out.insert(out.end(), { OP_RGB, pixel.r, pixel.g, pixel.b });
+                }
+            }
+            else
+            {
+                out.insert(out.end(), { OP_RGBA, pixel.r, pixel.g, pixel.b, pixel.a });
+            }
+            previous = pixel;
+        }
+    }
+}
+
+namespace qoi_strips
+{
+    std::vector<unsigned char> Encode(const unsigned char* pixels, int width, int height, int strip_rows)
+    {
+        const auto                 strip_count = static_cast<std::size_t>((height + strip_rows - 1) / strip_rows);
+        const std::size_t          table_size  = (strip_count + 1) * sizeof(std::uint64_t);
+        std::vector<unsigned char> out(HEADER_SIZE + table_size);
+        std::memcpy(out.data(), MAGIC, sizeof(MAGIC));
+        write_at<std::uint32_t>(out, 4, VERSION);
+        write_at<std::uint32_t>(out, 8, static_cast<std::uint32_t>(width));
+        write_at<std::uint32_t>(out, 12, static_cast<std::uint32_t>(height));
+        write_at<std::uint32_t>(out, 16, static_cast<std::uint32_t>(strip_rows));
+        write_at<std::uint32_t>(out, 20, static_cast<std::uint32_t>(strip_count));
+
+        const std::size_t row_pixels = static_cast<std::size_t>(width);
+        for (std::size_t strip = 0; strip < strip_count; ++strip)
+        {
+            write_at<std::uint64_t>(out, HEADER_SIZE + strip * sizeof(std::uint64_t), out.size());
+            const std::size_t first = strip * static_cast<std::size_t>(strip_rows);
+            const std::size_t rows  = std::min(static_cast<std::size_t>(strip_rows), static_cast<std::size_t>(height) - first);
+            encode_strip(pixels + first * row_pixels * 4, rows * row_pixels, out);
+        }
+        write_at<std::uint64_t>(out, HEADER_SIZE + strip_count * sizeof(std::uint64_t), out.size());
+        return out;
+    }
+
+    bool Write(const std::filesystem::path& filename, const unsigned char* pixels, int width, int height)
+    {
+        const std::vector<unsigned char> bytes = Encode(pixels, width, height);
+        std::ofstream                    file{ filename, std::ios::binary };
+        return static_cast<bool>(file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())));
+    }
+
+    bool ReadHeader(std::span<const unsigned char> bytes, Header& out_header)
+    {
+        if (bytes.size() < HEADER_SIZE || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0 || read_at<std::uint32_t>(bytes.data(), 4) != VERSION)
+            return false;
+        const auto width       = read_at<std::uint32_t>(bytes.data(), 8);
+        const auto height      = read_at<std::uint32_t>(bytes.data(), 12);
+        const auto strip_rows  = read_at<std::uint32_t>(bytes.data(), 16);
+        const auto strip_count = read_at<std::uint32_t>(bytes.data(), 20);
+        if (width == 0 || height == 0 || width > (1u << 15) || height > (1u << 15) || strip_rows == 0 || strip_count != (height + strip_rows - 1) / strip_rows)
+            return false;
+        const std::size_t table_end = HEADER_SIZE + (static_cast<std::size_t>(strip_count) + 1) * sizeof(std::uint64_t);
+        if (bytes.size() < table_end)
+            return false;
+        // in order and inside the file, so DecodeStrip only has to watch its own end
+        std::uint64_t previous = table_end;
+        for (std::size_t i = 0; i <= strip_count; ++i)
+        {
+            const auto offset = read_at<std::uint64_t>(bytes.data(), HEADER_SIZE + i * sizeof(std::uint64_t));
+            if (offset < previous || offset > bytes.size())
+                return false;
+            previous = offset;
+        }
+        out_header.width       = static_cast<int>(width);
+        out_header.height      = static_cast<int>(height);
+        out_header.strip_rows  = static_cast<int>(strip_rows);
+        out_header.strip_count = strip_count;
+        return true;
+    }
+
+    bool DecodeStrip(std::span<const unsigned char> bytes, const Header& header, std::size_t strip, unsigned char* out_pixels)
+    {
+        const auto           begin = read_at<std::uint64_t>(bytes.data(), HEADER_SIZE + strip * sizeof(std::uint64_t));
+        const auto           end   = read_at<std::uint64_t>(bytes.data(), HEADER_SIZE + (strip + 1) * sizeof(std::uint64_t));
+        const unsigned char* code  = bytes.data() + begin;
+        const unsigned char* last  = bytes.data() + end;
+
+        const std::size_t first = strip * static_cast<std::size_t>(header.strip_rows);
+        const std::size_t rows  = std::min(static_cast<std::size_t>(header.strip_rows), static_cast<std::size_t>(header.height) - first);
+        const std::size_t count = rows * static_cast<std::size_t>(header.width);
+        unsigned char*    out   = out_pixels + first * static_cast<std::size_t>(header.width) * 4;
+
+        std::array<Pixel, 64> index{};
+        Pixel                 pixel;
+        int                   run = 0;
+        for (std::size_t i = 0; i < count; ++i, out += 4)
+        {
+            if (run > 0)
+            {
+                --run;
+            }
+            else
+            {
+                if (code == last)
+                    return false;
+                const unsigned char op = *code++;
+                if (op == OP_RGB || op == OP_RGBA)
+                {
+                    const std::ptrdiff_t size = op == OP_RGB ? 3 : 4;
+                    if (last - code < size)
+                        return false;
+                    pixel.r = code[0];
+                    pixel.g = code[1];
+                    pixel.b = code[2];
+                    if (op == OP_RGBA)
+                        pixel.a = code[3];
+                    code += size;
+                }
+                else if ((op & TAG_MASK) == OP_INDEX)
+                {
+                    pixel = index[op];
+                }
+                else if ((op & TAG_MASK) == OP_DIFF)
+                {
+                    pixel.r = static_cast<unsigned char>(pixel.r + ((op >> 4) & 0x03) - 2);
+                    pixel.g = static_cast<unsigned char>(pixel.g + ((op >> 2) & 0x03) - 2);
+                    pixel.b = static_cast<unsigned char>(pixel.b + (op & 0x03) - 2);
+                }
+                else if ((op & TAG_MASK) == OP_LUMA)
+                {
+                    if (code == last)
+                        return false;
+                    const unsigned char second = *code++;
+                    const int           dg     = (op & 0x3F) - 32;
+                    pixel.r                    = static_cast<unsigned char>(pixel.r + dg - 8 + ((second >> 4) & 0x0F));
+                    pixel.g                    = static_cast<unsigned char>(pixel.g + dg);
+                    pixel.b                    = static_cast<unsigned char>(pixel.b + dg - 8 + (second & 0x0F));
+                }
+                else
+                {
+                    run = op & 0x3F;
+                }
+                index[hash(pixel)] = pixel;
+            }
+            out[0] = pixel.r;
+            out[1] = pixel.g;
+            out[2] = pixel.b;
+            out[3] = pixel.a;
+        }
+        // whatever is left over belongs to nothing
+        return code == last && run == 0;
+    }
+
+    bool Decode(std::span<const unsigned char> bytes, std::vector<unsigned char>& out_pixels, int& out_width, int& out_height, const StripRunner& run_strips)
+    {
+        Header header;
+        if (!ReadHeader(bytes, header))
+            return false;
+        out_pixels.resize(static_cast<std::size_t>(header.width) * static_cast<std::size_t>(header.height) * 4);
+        std::atomic<bool> ok{ true };
+        const auto        body = [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t strip = begin; strip < end; ++strip)
+            {
+                if (!DecodeStrip(bytes, header, strip, out_pixels.data()))
+                    ok.store(false, std::memory_order_relaxed);
+            }
+        };
+        if (run_strips)
+            run_strips(header.strip_count, body);
+        else
+            body(0, header.strip_count);
+        if (!ok.load(std::memory_order_relaxed))
+        {
+            out_pixels.clear();
+            return false;
+        }
+        out_width  = header.width;
+        out_height = header.height;
+        return true;
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+/**
+ * RGBA8 images as horizontal strips of QOI ops, each one coded on its own so they decode side by side.
+ *
+ * PNG is a single deflate stream, so stb_image inflates a big one on one thread however many are idle.
+ * texture-converter --qoi writes <name>.qois next to the PNG: a header, an offset table and STRIP_ROWS
+ * rows at a time as the ops of https://qoiformat.org/qoi-specification.pdf, every strip starting from
+ * the format's initial state and without its end marker. On one thread QOI already decodes about four times
+ * faster than stb_image inflates the demo's duck, and the strips split that across the workers. Files come out
+ * near the PNG's size, smaller for flat art and bigger for photos. Like the KTX2 variants it has to be written
+ * again when the PNG changes. No GL or threads here, so offline tools can share it; Decode takes whatever runs
+ * the strips in parallel.
+ */
+namespace qoi_strips
+{
+    constexpr int STRIP_ROWS = 64;
+
+    struct Header
+    {
+        int         width       = 0;
+        int         height      = 0;
+        int         strip_rows  = STRIP_ROWS;
+        std::size_t strip_count = 0;
+    };
+
+    // Runs body(begin, end) over [0, count) of the strips, in parallel or not, and returns once all of them are done
+    using StripRunner = std::function<void(std::size_t count, const std::function<void(std::size_t, std::size_t)>& body)>;
+
+    std::vector<unsigned char> Encode(const unsigned char* pixels, int width, int height, int strip_rows = STRIP_ROWS);
+    bool                       Write(const std::filesystem::path& filename, const unsigned char* pixels, int width, int height);
+
+    // Checks the header and that the offset table stays inside `bytes`
+    bool ReadHeader(std::span<const unsigned char> bytes, Header& out_header);
+    // Strip `strip` into its rows of `out_pixels`, which holds the whole image; false when it runs short or over
+    bool DecodeStrip(std::span<const unsigned char> bytes, const Header& header, std::size_t strip, unsigned char* out_pixels);
+    // The whole image, the strips through `run_strips` when there is one and one after another when not
+    bool Decode(std::span<const unsigned char> bytes, std::vector<unsigned char>& out_pixels, int& out_width, int& out_height, const StripRunner& run_strips = {});
+}
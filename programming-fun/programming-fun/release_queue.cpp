@@ -0,0 +1,146 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "release_queue.h"
+
+#include "gl_state.h"
+
+#include <algorithm>
+
+void ReleaseQueue::RetireTexture(GLuint texture, std::size_t bytes)
+{
+    if (texture == 0)
+        return;
+    textures.push_back(Retired{ texture, bytes, MemoryCategory::Textures, submitted });
+    ++stats.pending;
+    stats.pending_bytes += bytes;
+}
+
+void ReleaseQueue::RetireBuffer(GLuint buffer, std::size_t bytes, MemoryCategory category)
+{
+    if (buffer == 0)
+        return;
+    buffers.push_back(Retired{ buffer, bytes, category, submitted });
+    ++stats.pending;
+    stats.pending_bytes += bytes;
+}
+
+void ReleaseQueue::RetireSoundBuffer(ALuint buffer, std::size_t bytes)
+{
+    if (buffer == 0)
+        return;
+    sound_buffers.push_back(Retired{ buffer, bytes, MemoryCategory::Audio, submitted });
+    ++stats.pending;
+    stats.pending_bytes += bytes;
+}
+
+void ReleaseQueue::Submitted(std::uint64_t frame) noexcept
+{
+    submitted = frame;
+}
+
+void ReleaseQueue::Drawn(std::uint64_t frame)
+{
+    // the swap that follows flushes it, so the main thread's context sees it signal
+    const GLsync    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    std::lock_guard lock{ drawn_mutex };
+    drawn.push_back(DrawnFence{ frame, fence });
+}
+
+void ReleaseQueue::Collect()
+{
+    stats.released     = 0;
+    stats.delete_calls = 0;
+    {
+        // the GPU runs frames in order, so the first one still going holds up the rest
+        std::lock_guard lock{ drawn_mutex };
+        while (!drawn.empty())
+        {
+            const GLenum status = glClientWaitSync(drawn.front().fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                break;
+            stats.drawn_frame = drawn.front().frame;
+            glDeleteSync(drawn.front().fence);
+            drawn.pop_front();
+        }
+    }
+    release(textures, Kind::Texture, false);
+    release(buffers, Kind::Buffer, false);
+    release(sound_buffers, Kind::SoundBuffer, false);
+}
+
+ReleaseQueue::Stats ReleaseQueue::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+void ReleaseQueue::Shutdown()
+{
+    release(textures, Kind::Texture, true);
+    release(buffers, Kind::Buffer, true);
+    release(sound_buffers, Kind::SoundBuffer, true);
+    // a buffer still attached at shutdown goes with the AL context
+    for (const Retired& entry : sound_buffers)
+        memory_tracker::Free(entry.category, entry.bytes);
+    sound_buffers.clear();
+    std::lock_guard lock{ drawn_mutex };
+    for (const DrawnFence& entry : drawn)
+        glDeleteSync(entry.fence);
+    drawn.clear();
+    stats = Stats{};
+}
+
+void ReleaseQueue::release(std::vector<Retired>& list, Kind kind, bool all)
+{
+    const auto due = all ? list.end() : std::find_if(list.begin(), list.end(), [this](const Retired& entry) { return entry.frame > stats.drawn_frame; });
+    if (due == list.begin())
+        return;
+    names.clear();
+    for (auto it = list.begin(); it != due; ++it)
+        names.push_back(it->name);
+
+    const auto forget = [this](const Retired& entry)
+    {
+        memory_tracker::Free(entry.category, entry.bytes);
+        --stats.pending;
+        stats.pending_bytes -= entry.bytes;
+        ++stats.released;
+    };
+    ++stats.delete_calls;
+    if (kind == Kind::Texture)
+    {
+        gl_state::DeleteTextures(names);
+    }
+    else if (kind == Kind::Buffer)
+    {
+        glDeleteBuffers(static_cast<GLsizei>(names.size()), names.data());
+    }
+    else
+    {
+        alGetError();
+        alDeleteBuffers(static_cast<ALsizei>(names.size()), names.data());
+        if (alGetError() != AL_NO_ERROR)
+        {
+            // AL deleted none of them; those a source still holds stay at the front for next time
+            const auto kept = std::remove_if(list.begin(), due,
+                                             [&](const Retired& entry)
+                                             {
+                                                 alGetError();
+                                                 alDeleteBuffers(1, &entry.name);
+                                                 ++stats.delete_calls;
+                                                 if (alGetError() != AL_NO_ERROR)
+                                                     return false;
+                                                 forget(entry);
+                                                 return true;
+                                             });
+            list.erase(kept, due);
+            return;
+        }
+    }
+    std::for_each(list.begin(), due, forget);
+    list.erase(list.begin(), due);
+}
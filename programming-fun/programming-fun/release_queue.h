@@ -0,0 +1,102 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "memory_tracker.h"
+
+#include <GL/glew.h>
+#include <al.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * Deletes GL textures, GL buffers and AL buffers once nothing can still be using them, rather than when
+ * their owner lets go.
+ *
+ * A hot reload or an eviction lets go of a texture that frames still on the render side may draw, and
+ * deleting it there and then makes the driver wait for the GPU. Retire instead tags it with the latest
+ * frame handed to the render side. After each frame's last GL call the render side puts a fence behind it
+ * with Drawn; Collect polls those fences without waiting and deletes what frames done on the GPU left
+ * behind, each type in a single glDeleteTextures, glDeleteBuffers or alDeleteBuffers call. AL refuses a whole
+ * call when a source still has one of the buffers attached, so a refused batch goes again one at a time and
+ * whatever is still playing waits for a later Collect. The memory tracker hears of each as it goes.
+ *
+ * Retire, Submitted and Collect are main thread calls with GL current (the upload context while the render
+ * thread runs); Drawn is the render side's.
+ */
+class ReleaseQueue
+{
+public:
+    struct Stats
+    {
+        std::size_t   pending       = 0;
+        std::size_t   pending_bytes = 0;
+        std::size_t   released      = 0; // by the latest Collect
+        int           delete_calls  = 0; // by the latest Collect
+        std::uint64_t drawn_frame   = 0; // the latest frame known to be done on the GPU
+    };
+
+    ReleaseQueue() = default;
+
+    ReleaseQueue(const ReleaseQueue&)                = delete;
+    ReleaseQueue& operator=(const ReleaseQueue&)     = delete;
+    ReleaseQueue(ReleaseQueue&&) noexcept            = delete;
+    ReleaseQueue& operator=(ReleaseQueue&&) noexcept = delete;
+
+    void RetireTexture(GLuint texture, std::size_t bytes); // counted under MemoryCategory::Textures
+    void RetireBuffer(GLuint buffer, std::size_t bytes, MemoryCategory category);
+    void RetireSoundBuffer(ALuint buffer, std::size_t bytes); // counted under MemoryCategory::Audio
+
+    // As `frame` goes to the render side; what is retired from then on waits for it
+    void Submitted(std::uint64_t frame) noexcept;
+    // After `frame`'s last GL call, on the thread that drew it
+    void Drawn(std::uint64_t frame);
+    // Once a frame
+    void  Collect();
+    Stats LastFrameStats() const noexcept;
+    // Deletes everything now; nothing may draw any more
+    void Shutdown();
+
+private:
+    struct Retired
+    {
+        GLuint         name  = 0; // an ALuint for sound buffers
+        std::size_t    bytes = 0;
+        MemoryCategory category{};
+        std::uint64_t  frame = 0; // goes once this one is drawn
+    };
+
+    struct DrawnFence
+    {
+        std::uint64_t frame = 0;
+        GLsync        fence = nullptr;
+    };
+
+    enum class Kind
+    {
+        Texture,
+        Buffer,
+        SoundBuffer
+    };
+
+    // the front of `list` that is due, or all of it, in one delete call
+    void release(std::vector<Retired>& list, Kind kind, bool all);
+
+private:
+    std::vector<Retired>   textures; // each in frame order
+    std::vector<Retired>   buffers;
+    std::vector<Retired>   sound_buffers;
+    std::vector<GLuint>    names; // Collect's scratch
+    std::uint64_t          submitted = 0;
+    Stats                  stats;
+    std::mutex             drawn_mutex;
+    std::deque<DrawnFence> drawn; // the render side's, oldest first
+};
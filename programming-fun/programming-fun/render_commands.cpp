@@ -0,0 +1,154 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "render_commands.h"
+
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace
+{
+    constexpr int KEY_BYTES = 8;
+
+    using Histogram  = std::array<std::uint32_t, 256>;
+    using Histograms = std::array<Histogram, KEY_BYTES>;
+
+    void count_bytes(std::span<const RenderCommand> commands, Histograms& counts)
+    {
+        for (const RenderCommand& command : commands)
+        {
+            for (int byte = 0; byte < KEY_BYTES; ++byte)
+                ++counts[static_cast<std::size_t>(byte)][(command.key >> (byte * 8)) & 0xFFu];
+        }
+    }
+
+    // the same passes as below with a slice a job: a job's slice goes where the slices before it leave off in each bucket, so it stays stable
+    int parallel_radix_sort(std::span<RenderCommand> commands, std::span<RenderCommand> scratch, WorkerPool& workers)
+    {
+        const std::size_t       count = commands.size();
+        const std::size_t       jobs  = std::min<std::size_t>(workers.ThreadCount() + 1, count / (PARALLEL_SORT_COMMANDS / 4));
+        const std::size_t       grain = (count + jobs - 1) / jobs;
+        std::vector<Histograms> slices(jobs);
+        workers.ParallelFor("Sort Count", count, grain, [&](std::size_t begin, std::size_t end) { count_bytes(commands.subspan(begin, end - begin), slices[begin / grain]); });
+        Histograms totals{};
+        for (const Histograms& slice : slices)
+        {
+            for (int byte = 0; byte < KEY_BYTES; ++byte)
+            {
+                for (std::size_t bucket = 0; bucket < 256; ++bucket)
+                    totals[static_cast<std::size_t>(byte)][bucket] += slice[static_cast<std::size_t>(byte)][bucket];
+            }
+        }
+
+        std::span<RenderCommand> from   = commands;
+        std::span<RenderCommand> to     = scratch;
+        int                      passes = 0;
+        std::vector<Histogram>   offsets(jobs);
+        for (int byte = 0; byte < KEY_BYTES; ++byte)
+        {
+            const auto      shift = byte * 8;
+            const Histogram total = totals[static_cast<std::size_t>(byte)];
+            if (std::find(total.begin(), total.end(), static_cast<std::uint32_t>(count)) != total.end())
+                continue;
+            // the counts up front were of the keys as they came; after a pass each slice holds others
+            if (passes > 0)
+            {
+                workers.ParallelFor("Sort Count", count, grain,
+                                    [&](std::size_t begin, std::size_t end)
+                                    {
+                                        Histogram& slice = slices[begin / grain][static_cast<std::size_t>(byte)];
+                                        slice.fill(0);
+                                        for (const RenderCommand& command : from.subspan(begin, end - begin))
+                                            ++slice[(command.key >> shift) & 0xFFu];
+                                    });
+            }
+            std::uint32_t offset = 0;
+            for (std::size_t bucket = 0; bucket < 256; ++bucket)
+            {
+                for (std::size_t job = 0; job < jobs; ++job)
+                {
+                    offsets[job][bucket] = offset;
+                    offset += slices[job][static_cast<std::size_t>(byte)][bucket];
+                }
+            }
+            workers.ParallelFor("Sort Scatter", count, grain,
+                                [&](std::size_t begin, std::size_t end)
+                                {
+                                    Histogram& next = offsets[begin / grain];
+                                    for (const RenderCommand& command : from.subspan(begin, end - begin))
+                                        to[next[(command.key >> shift) & 0xFFu]++] = command;
+                                });
+            std::swap(from, to);
+            ++passes;
+        }
+        if (from.data() != commands.data())
+            std::copy(from.begin(), from.end(), commands.begin());
+        return passes;
+    }
+}
+
+int radix_sort(std::span<RenderCommand> commands, std::vector<RenderCommand>& scratch, WorkerPool* workers)
+{
+    // a frame recorded in the order it draws, like most static scenes, costs one read
+    if (commands.size() < 2 || std::is_sorted(commands.begin(), commands.end(), [](const RenderCommand& a, const RenderCommand& b) { return a.key < b.key; }))
+        return 0;
+    scratch.resize(commands.size());
+    if (workers != nullptr && workers->ThreadCount() > 0 && commands.size() >= PARALLEL_SORT_COMMANDS)
+        return parallel_radix_sort(commands, scratch, *workers);
+
+    // every byte's histogram in one read of the keys
+    Histograms counts{};
+    count_bytes(commands, counts);
+
+    std::span<RenderCommand> from   = commands;
+    std::span<RenderCommand> to     = scratch;
+    int                      passes = 0;
+    for (int byte = 0; byte < KEY_BYTES; ++byte)
+    {
+        Histogram& count = counts[static_cast<std::size_t>(byte)];
+        // one bucket holding everything would only copy; most frames have a few layers and textures, so most bytes are like that
+        if (std::find(count.begin(), count.end(), static_cast<std::uint32_t>(commands.size())) != count.end())
+            continue;
+        std::uint32_t offset = 0;
+        for (std::uint32_t& bucket : count)
+            bucket = std::exchange(offset, offset + bucket);
+        for (const RenderCommand& command : from)
+            to[count[(command.key >> (byte * 8)) & 0xFFu]++] = command;
+        std::swap(from, to);
+        ++passes;
+    }
+    if (from.data() != commands.data())
+        std::copy(from.begin(), from.end(), commands.begin());
+    return passes;
+}
+
+void RenderCommandRecorder::Begin(std::size_t jobs)
+{
+    if (lists.size() < jobs)
+        lists.resize(jobs);
+    for (std::size_t job = 0; job < jobs; ++job)
+        lists[job].clear();
+    job_count = jobs;
+}
+
+std::vector<RenderCommand>& RenderCommandRecorder::List(std::size_t job) noexcept
+{
+    return lists[job];
+}
+
+void RenderCommandRecorder::MergeInto(std::pmr::vector<RenderCommand>& out) const
+{
+    std::size_t total = out.size();
+    for (std::size_t job = 0; job < job_count; ++job)
+        total += lists[job].size();
+    out.reserve(total);
+    for (std::size_t job = 0; job < job_count; ++job)
+        out.insert(out.end(), lists[job].begin(), lists[job].end());
+}
@@ -0,0 +1,118 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+class WorkerPool;
+
+// What a command draws, and the order the layers draw in: each one over the ones before it
+enum class RenderLayer : std::uint8_t
+{
+    Tilemap,
+    StaticSprites, // StaticSprites' retained batches, a command per batch
+    Sprites,
+    AnimatedSprites,
+    Meshes,
+    Models, // a glTF model's parts, depth tested against each other only
+    Particles,
+    Text,
+    Debug // debug_draw's shapes, over the whole scene
+};
+
+/**
+ * One draw recorded for the render side: the sort key, and the range of the layer's list in the FramePacket it covers.
+ *
+ * Sprites and meshes record a command each so the sort can group them; the layers that already draw
+ * as one (the tilemap's chunks, the particles, the glyphs) record one command over their whole list.
+ */
+struct RenderCommand
+{
+    std::uint64_t key   = 0;
+    std::uint32_t first = 0;
+    std::uint32_t count = 1;
+};
+
+/**
+ * The 64-bit sort key: layer in the top 4 bits, then 8 of program, 20 of texture and 32 of depth.
+ *
+ * Sorted ascending, commands come out by layer, then grouped by program and texture so the state
+ * cache sees each change once, and within those by depth, which is submission order where nothing
+ * better applies. GL names are small, so 20 bits of texture only alias past a million textures.
+ *
+ * Blended draws that overlap have to come out back to front whatever their texture, so MakeBackToFront
+ * puts the depth right under the layer and the program and texture under it; only neighbours in depth
+ * that share a texture batch together then. Both kinds in one layer still sort, just not meaningfully against each other.
+ */
+namespace render_key
+{
+    constexpr std::uint64_t Make(RenderLayer layer, std::uint32_t program, std::uint32_t texture, std::uint32_t depth) noexcept
+    {
+        return (static_cast<std::uint64_t>(layer) << 60) | (static_cast<std::uint64_t>(program & 0xFFu) << 52) | (static_cast<std::uint64_t>(texture & 0xFFFFFu) << 32) |
+               static_cast<std::uint64_t>(depth);
+    }
+
+    // Lower depths draw first, under the higher ones
+    constexpr std::uint64_t MakeBackToFront(RenderLayer layer, std::uint32_t depth, std::uint32_t program, std::uint32_t texture) noexcept
+    {
+        return (static_cast<std::uint64_t>(layer) << 60) | (static_cast<std::uint64_t>(depth) << 28) | (static_cast<std::uint64_t>(program & 0xFFu) << 20) |
+               static_cast<std::uint64_t>(texture & 0xFFFFFu);
+    }
+
+    // A float depth as bits that sort in the same order, negatives included
+    constexpr std::uint32_t Depth(float depth) noexcept
+    {
+        const auto bits = std::bit_cast<std::uint32_t>(depth);
+        return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+    }
+
+    constexpr RenderLayer Layer(std::uint64_t key) noexcept
+    {
+        return static_cast<RenderLayer>(key >> 60);
+    }
+}
+
+struct RenderCommandStats
+{
+    int commands    = 0;
+    int layers      = 0; // runs of one layer the render side drew
+    int sort_passes = 0; // of the 8 a full radix sort takes; 0 when the commands came in order
+};
+
+// Fewer sort faster on one thread than the jobs take to hand out
+constexpr std::size_t PARALLEL_SORT_COMMANDS = 32 * 1024;
+
+// Stable sort by key, 8 bits at a time through `scratch`; byte positions every key agrees on are skipped, and commands
+// already in order aren't moved at all. From PARALLEL_SORT_COMMANDS on, each pass is split across `workers` when
+// there are any: every job counts and then scatters its own slice. Returns the passes it took.
+int radix_sort(std::span<RenderCommand> commands, std::vector<RenderCommand>& scratch, WorkerPool* workers = nullptr);
+
+/**
+ * One command list per job, so a ParallelFor can record without sharing anything, merged in job order afterwards.
+ *
+ * The lists are heap vectors kept from frame to frame rather than arena ones, since the frame's arena
+ * only takes allocations from the main thread. Begin and MergeInto are main thread; List(job) belongs
+ * to that job in between.
+ */
+class RenderCommandRecorder
+{
+public:
+    void                        Begin(std::size_t jobs);
+    std::vector<RenderCommand>& List(std::size_t job) noexcept;
+    // Appends every job's commands to `out`, job 0 first, so the order doesn't depend on which worker ran what
+    void MergeInto(std::pmr::vector<RenderCommand>& out) const;
+
+private:
+    std::vector<std::vector<RenderCommand>> lists;
+    std::size_t                             job_count = 0;
+};
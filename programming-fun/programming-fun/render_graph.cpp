@@ -0,0 +1,220 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "render_graph.h"
+
+#include "logger.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <glm/common.hpp>
+#include <utility>
+
+namespace
+{
+    std::size_t bytes_of(glm::ivec2 size, GLenum internal_format) noexcept
+    {
+        return static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y) * (internal_format == GL_RGBA16F ? 8 : 4);
+    }
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(Resource resource)
+{
+    graph->addAccess(pass, resource, false);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(Resource resource)
+{
+    graph->addAccess(pass, resource, true);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::SideEffect()
+{
+    graph->passes[static_cast<std::size_t>(pass)].has_side_effect = true;
+    return *this;
+}
+
+void RenderGraph::Shutdown()
+{
+    Reset();
+    pool.Shutdown();
+}
+
+void RenderGraph::Reset()
+{
+    resources.clear();
+    passes.clear();
+    accesses.clear();
+    physicals.clear();
+    order.clear();
+}
+
+RenderGraph::Resource RenderGraph::Import(const char* name, const ColorSurface& surface)
+{
+    ResourceNode& node = resources.emplace_back();
+    node.name          = name;
+    node.surface       = surface;
+    node.size          = surface.size;
+    node.is_imported   = true;
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::Create(const char* name, glm::ivec2 size, GLenum internal_format)
+{
+    ResourceNode& node   = resources.emplace_back();
+    node.name            = name;
+    node.size            = glm::max(size, glm::ivec2{ 1 });
+    node.internal_format = internal_format;
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(const char* name, PassFunction execute)
+{
+    PassNode& node = passes.emplace_back();
+    node.name      = name;
+    node.execute   = std::move(execute);
+    return PassBuilder{ *this, static_cast<int>(passes.size() - 1) };
+}
+
+void RenderGraph::Execute()
+{
+    PROFILE_ZONE("Render Graph");
+    stats = Stats{};
+    cull();
+    mapTransients();
+    for (int step = 0; step < static_cast<int>(order.size()); ++step)
+    {
+        for (Physical& physical : physicals)
+        {
+            if (physical.first_pass == step)
+                physical.surface = pool.Acquire(physical.size, physical.internal_format);
+        }
+        for (ResourceNode& resource : resources)
+        {
+            if (!resource.is_imported && resource.first_pass == step)
+                resource.surface = physicals[static_cast<std::size_t>(resource.physical)].surface;
+        }
+        passes[static_cast<std::size_t>(order[static_cast<std::size_t>(step)])].execute(*this);
+        for (Physical& physical : physicals)
+        {
+            if (physical.last_pass == step)
+            {
+                pool.Release(physical.surface);
+                physical.surface = ColorSurface{};
+            }
+        }
+    }
+    // what the passes captured may own memory; it goes now rather than at the next Reset
+    for (PassNode& pass : passes)
+        pass.execute = nullptr;
+}
+
+void RenderGraph::EndFrame()
+{
+    pool.EndFrame();
+    stats.pool = pool.GetStats();
+}
+
+ColorSurface RenderGraph::Surface(Resource resource) const noexcept
+{
+    if (resource < 0 || resource >= static_cast<Resource>(resources.size()))
+        return ColorSurface{};
+    return resources[static_cast<std::size_t>(resource)].surface;
+}
+
+const RenderGraph::Stats& RenderGraph::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+void RenderGraph::addAccess(int pass, Resource resource, bool is_write)
+{
+    if (resource < 0 || resource >= static_cast<Resource>(resources.size()))
+    {
+        LOG_ERROR("Render graph pass ", passes[static_cast<std::size_t>(pass)].name, " uses a resource from another frame");
+        return;
+    }
+    accesses.push_back(Access{ pass, resource, is_write });
+}
+
+void RenderGraph::cull()
+{
+    // walking back from the end, a pass is needed when it writes something a needed later pass reads or writes
+    std::vector<bool> is_needed(resources.size(), false);
+    for (int pass = static_cast<int>(passes.size()) - 1; pass >= 0; --pass)
+    {
+        PassNode& node = passes[static_cast<std::size_t>(pass)];
+        node.is_kept   = node.has_side_effect;
+        for (const Access& access : accesses)
+        {
+            if (access.pass == pass && access.is_write)
+                node.is_kept = node.is_kept || resources[static_cast<std::size_t>(access.resource)].is_imported || is_needed[static_cast<std::size_t>(access.resource)];
+        }
+        if (!node.is_kept)
+        {
+            ++stats.culled;
+            continue;
+        }
+        for (const Access& access : accesses)
+        {
+            if (access.pass == pass)
+                is_needed[static_cast<std::size_t>(access.resource)] = true;
+        }
+    }
+    for (int pass = 0; pass < static_cast<int>(passes.size()); ++pass)
+    {
+        if (passes[static_cast<std::size_t>(pass)].is_kept)
+            order.push_back(pass);
+    }
+    stats.passes = static_cast<int>(order.size());
+}
+
+void RenderGraph::mapTransients()
+{
+    for (int step = 0; step < static_cast<int>(order.size()); ++step)
+    {
+        for (const Access& access : accesses)
+        {
+            if (access.pass != order[static_cast<std::size_t>(step)])
+                continue;
+            ResourceNode& resource = resources[static_cast<std::size_t>(access.resource)];
+            if (resource.first_pass < 0)
+                resource.first_pass = step;
+            resource.last_pass = step;
+        }
+    }
+
+    // in order of first use, each transient takes the first physical target of its size and format that was released
+    // before it starts, so targets are handed over between passes the way the pool would hand them over
+    for (int step = 0; step < static_cast<int>(order.size()); ++step)
+    {
+        for (ResourceNode& resource : resources)
+        {
+            if (resource.is_imported || resource.first_pass != step)
+                continue;
+            const auto found = std::find_if(physicals.begin(), physicals.end(), [&resource, step](const Physical& physical) {
+                return physical.last_pass < step && physical.size == resource.size && physical.internal_format == resource.internal_format;
+            });
+            if (found != physicals.end())
+            {
+                found->last_pass  = resource.last_pass;
+                resource.physical = static_cast<int>(found - physicals.begin());
+            }
+            else
+            {
+                physicals.push_back(Physical{ resource.size, resource.internal_format, step, resource.last_pass, ColorSurface{} });
+                resource.physical = static_cast<int>(physicals.size() - 1);
+                stats.allocated_bytes += bytes_of(resource.size, resource.internal_format);
+            }
+            ++stats.transients;
+            stats.requested_bytes += bytes_of(resource.size, resource.internal_format);
+        }
+    }
+    stats.physical = static_cast<int>(physicals.size());
+}
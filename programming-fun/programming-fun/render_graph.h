@@ -0,0 +1,145 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "render_target.h"
+#include "render_target_pool.h"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <vector>
+
+/**
+ * A frame's passes and the color targets between them, declared up front and then run in one go.
+ *
+ * Each frame the renderer imports the surfaces that outlive it (the scene target, the backbuffer), creates
+ * transient ones by size and format, and adds passes that say which of them they read and write. Execute then
+ * culls every pass whose writes nobody kept reads, unless it writes an imported surface or was marked as having
+ * a side effect; works out each transient's lifetime, from the first kept pass touching it to the last; and maps
+ * transients whose lifetimes don't overlap onto the same physical target when their size and format match, so
+ * the bloom chain's three half size images live in two textures. Physical targets come from a RenderTargetPool,
+ * acquired just before their first pass and released after their last, so nothing is allocated from one frame to
+ * the next while the sizes hold.
+ *
+ * Passes run in the order they were added: a pass sees the writes of every earlier pass to what it reads, which
+ * is what the code that builds the frame already reads like. Resources are plain indices that are only valid
+ * until the next Reset. GL thread only.
+ */
+class RenderGraph
+{
+public:
+    using Resource = int;
+
+    static constexpr Resource NONE = -1;
+
+    struct Stats
+    {
+        int                     passes          = 0; // run, culled ones excluded
+        int                     culled          = 0;
+        int                     transients      = 0; // used by a pass that ran
+        int                     physical        = 0; // targets those transients were mapped onto
+        std::size_t             requested_bytes = 0; // what the transients would need each on their own
+        std::size_t             allocated_bytes = 0; // what the physical targets take
+        RenderTargetPool::Stats pool;
+    };
+
+    using PassFunction = std::function<void(const RenderGraph& graph)>;
+
+    // Returned by AddPass to declare what the pass touches
+    class PassBuilder
+    {
+    public:
+        PassBuilder& Read(Resource resource);
+        // Writes add to what earlier passes wrote there, so those are kept along with this one
+        PassBuilder& Write(Resource resource);
+        // Never culled, e.g. a readback
+        PassBuilder& SideEffect();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, int pass) noexcept : graph(&graph), pass(pass) {}
+
+        RenderGraph* graph;
+        int          pass;
+    };
+
+    RenderGraph() = default;
+
+    RenderGraph(const RenderGraph&)                = delete;
+    RenderGraph& operator=(const RenderGraph&)     = delete;
+    RenderGraph(RenderGraph&&) noexcept            = delete;
+    RenderGraph& operator=(RenderGraph&&) noexcept = delete;
+
+    void Shutdown();
+
+    // Forgets the last frame's passes and resources; their storage is kept
+    void        Reset();
+    Resource    Import(const char* name, const ColorSurface& surface);
+    Resource    Create(const char* name, glm::ivec2 size, GLenum internal_format);
+    PassBuilder AddPass(const char* name, PassFunction execute);
+    // Culls, maps the transients and runs what is left in order
+    void Execute();
+    // After presenting: lets the pool trim what went unused
+    void EndFrame();
+
+    // For a pass that is running: the surface behind `resource`, which has framebuffer 0 if it couldn't be created
+    ColorSurface Surface(Resource resource) const noexcept;
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    struct ResourceNode
+    {
+        const char*  name = nullptr;
+        ColorSurface surface; // imported, or bound to the physical target while it is live
+        glm::ivec2   size{ 0 };
+        GLenum       internal_format = GL_RGBA8;
+        bool         is_imported     = false;
+        int          first_pass      = -1; // among the passes that run
+        int          last_pass       = -1;
+        int          physical        = -1;
+    };
+
+    struct PassNode
+    {
+        const char*  name = nullptr;
+        PassFunction execute;
+        bool         has_side_effect = false;
+        bool         is_kept         = false;
+    };
+
+    struct Access
+    {
+        int      pass     = 0;
+        Resource resource = NONE;
+        bool     is_write = false;
+    };
+
+    struct Physical
+    {
+        glm::ivec2   size{ 0 };
+        GLenum       internal_format = GL_RGBA8;
+        int          first_pass      = 0; // among the passes that run
+        int          last_pass       = 0;
+        ColorSurface surface;
+    };
+
+    void addAccess(int pass, Resource resource, bool is_write);
+    void cull();
+    void mapTransients();
+
+private:
+    std::vector<ResourceNode> resources;
+    std::vector<PassNode>     passes;
+    std::vector<Access>       accesses;
+    std::vector<Physical>     physicals;
+    std::vector<int>          order; // indices of the passes that run
+    RenderTargetPool          pool;
+    Stats                     stats;
+};
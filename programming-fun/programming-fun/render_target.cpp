@@ -0,0 +1,390 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "render_target.h"
+
+#include "gl_state.h"
+#include "logger.h"
+#include "memory_tracker.h"
+#include "shader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vector_relational.hpp>
+#include <imgui.h>
+
+namespace
+{
+    constexpr const char* UPSCALE_VERTEX_SHADER = R"(
+out vec2 vTexCoord;
+
+void main()
+{
+    // one triangle covering the screen: (-1,-1) (3,-1) (-1,3)
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    vTexCoord   = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    constexpr const char* UPSCALE_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+
+uniform sampler2D uScene;
+uniform vec2      uScale; // the part of the texture the scene drew into
+uniform vec2      uLimit; // its last texel's center, so filtering never reaches past it
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture(uScene, min(vTexCoord * uScale, uLimit));
+}
+)";
+
+    // FXAA in its original, cheapest form: blur along the local edge direction from four diagonal taps,
+    // and fall back to the narrower blur when the wide one picks up a luma outside the neighbourhood
+    constexpr const char* FXAA_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+
+uniform sampler2D uScene;
+uniform vec2      uTexel;
+uniform vec2      uScale;
+uniform vec2      uLimit;
+
+out vec4 fragColor;
+
+const float REDUCE_MIN = 1.0 / 128.0;
+const float REDUCE_MUL = 1.0 / 8.0;
+const float SPAN_MAX   = 8.0;
+
+float luma(vec3 color)
+{
+    return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+vec4 tap(vec2 uv)
+{
+    return texture(uScene, min(uv, uLimit));
+}
+
+void main()
+{
+    vec2  uv     = vTexCoord * uScale;
+    vec4  center = tap(uv);
+    float nw     = luma(tap(uv + vec2(-1.0, -1.0) * uTexel).rgb);
+    float ne     = luma(tap(uv + vec2(1.0, -1.0) * uTexel).rgb);
+    float sw     = luma(tap(uv + vec2(-1.0, 1.0) * uTexel).rgb);
+    float se     = luma(tap(uv + vec2(1.0, 1.0) * uTexel).rgb);
+    float m      = luma(center.rgb);
+    float lowest  = min(m, min(min(nw, ne), min(sw, se)));
+    float highest = max(m, max(max(nw, ne), max(sw, se)));
+
+    vec2  direction = vec2(-((nw + ne) - (sw + se)), (nw + sw) - (ne + se));
+    float reduce    = max((nw + ne + sw + se) * 0.25 * REDUCE_MUL, REDUCE_MIN);
+    float scale     = 1.0 / (min(abs(direction.x), abs(direction.y)) + reduce);
+    direction       = clamp(direction * scale, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * uTexel;
+
+    vec3  narrow = 0.5 * (tap(uv - direction / 6.0).rgb + tap(uv + direction / 6.0).rgb);
+    vec3  wide   = 0.5 * narrow + 0.25 * (tap(uv - direction * 0.5).rgb + tap(uv + direction * 0.5).rgb);
+    float l      = luma(wide);
+    fragColor    = vec4((l < lowest || l > highest) ? narrow : wide, center.a);
+}
+)";
+
+    constexpr int         MSAA_CHOICES[] = { 1, 2, 4, 8 };
+    constexpr const char* MSAA_NAMES[]   = { "off", "2x", "4x", "8x" };
+
+    // growing past the allocation rounds up to this step after adding an eighth, so a window dragged bigger
+    // or dynamic resolution creeping up lands in the same allocation for a while
+    constexpr int GROWTH_STEP = 64;
+
+    int with_headroom(int extent, int limit)
+    {
+        const int padded = (extent + extent / 8 + GROWTH_STEP - 1) / GROWTH_STEP * GROWTH_STEP;
+        return std::max(std::min(padded, limit), extent);
+    }
+}
+
+void RenderTarget::Setup()
+{
+    program.Request(UPSCALE_VERTEX_SHADER, UPSCALE_FRAGMENT_SHADER);
+    fxaa_program.Request(UPSCALE_VERTEX_SHADER, FXAA_FRAGMENT_SHADER);
+    // no attributes, but core profiles refuse to draw without a vertex array
+    glGenVertexArrays(1, &vertex_array);
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    max_samples = std::max(max_samples, 1);
+    GLint max_texture = 0, max_renderbuffer = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture);
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &max_renderbuffer);
+    max_size = std::max(std::min(max_texture, max_renderbuffer), 1);
+}
+
+void RenderTarget::Shutdown()
+{
+    release();
+    gl_state::DeleteVertexArray(vertex_array);
+    program.Reset();
+    fxaa_program.Reset();
+    vertex_array = 0;
+    size         = glm::ivec2{ 0 };
+    samples      = 0;
+}
+
+void RenderTarget::Resize(glm::ivec2 new_size, int new_samples)
+{
+    new_size    = glm::clamp(new_size, glm::ivec2{ 1 }, glm::ivec2{ max_size });
+    new_samples = std::clamp(new_samples, 1, max_samples);
+    if (new_size == size && new_samples == samples)
+        return;
+    // a failed size stays failed until it changes, instead of being retried every frame; it has no allocation to fit in
+    const bool fits      = glm::all(glm::lessThanEqual(new_size, allocated));
+    const bool is_wasted = glm::all(glm::lessThan(new_size * 2, allocated)); // less than a quarter of it in use
+    if (fits && !is_wasted && new_samples == samples)
+    {
+        size = new_size;
+        return;
+    }
+    // only growth gets headroom; the first allocation, a sample count change and a trim are exact
+    const bool       is_growing = !fits && resolve_framebuffer != 0 && new_samples == samples;
+    const glm::ivec2 extent     = is_growing ? glm::ivec2{ with_headroom(new_size.x, max_size), with_headroom(new_size.y, max_size) } : new_size;
+    release();
+    size      = new_size;
+    samples   = new_samples;
+    allocated = extent;
+
+    glGenTextures(1, &resolve_color);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(resolve_color);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, allocated.x, allocated.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glGenFramebuffers(1, &resolve_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, resolve_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, resolve_color, 0);
+
+    if (samples > 1)
+    {
+        glGenRenderbuffers(1, &msaa_color);
+        glBindRenderbuffer(GL_RENDERBUFFER, msaa_color);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, allocated.x, allocated.y);
+        glGenFramebuffers(1, &msaa_framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, msaa_framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msaa_color);
+    }
+    // on the framebuffer the scene draws into, still bound; the resolve blits color alone
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples > 1 ? samples : 0, GL_DEPTH_COMPONENT24, allocated.x, allocated.y);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    bool is_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (samples > 1)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, resolve_framebuffer);
+        is_complete = is_complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!is_complete)
+    {
+        LOG_ERROR("Scene render target ", allocated.x, 'x', allocated.y, " (", samples, " samples) is incomplete");
+        release();
+        return;
+    }
+    ++reallocations;
+    // the color texture, the multisampled color and the depth, 4 bytes a sample each
+    allocated_bytes = static_cast<std::size_t>(allocated.x) * static_cast<std::size_t>(allocated.y) * 4 * static_cast<std::size_t>(samples > 1 ? 2 * samples + 1 : 2);
+    memory_tracker::Allocate(MemoryCategory::Textures, allocated_bytes);
+}
+
+bool RenderTarget::Bind()
+{
+    if (resolve_framebuffer == 0)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, msaa_framebuffer != 0 ? msaa_framebuffer : resolve_framebuffer);
+    gl_state::Viewport(0, 0, size.x, size.y);
+    return true;
+}
+
+void RenderTarget::Present(glm::ivec2 window_size, bool fxaa)
+{
+    if (resolve_framebuffer == 0)
+        return;
+    Present(Resolve(), window_size, fxaa);
+}
+
+ColorSurface RenderTarget::Resolve()
+{
+    if (resolve_framebuffer == 0)
+        return ColorSurface{};
+    if (msaa_framebuffer != 0)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, msaa_framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolve_framebuffer);
+        glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    return ColorSurface{ resolve_framebuffer, resolve_color, size, allocated };
+}
+
+ColorSurface RenderTarget::ResolvedSurface() const noexcept
+{
+    if (resolve_framebuffer == 0)
+        return ColorSurface{};
+    return ColorSurface{ resolve_framebuffer, resolve_color, size, allocated };
+}
+
+void RenderTarget::Present(const ColorSurface& source, glm::ivec2 window_size, bool fxaa, GLuint framebuffer)
+{
+    if (source.framebuffer == 0)
+        return;
+    fxaa = fxaa && isFxaaReady();
+    if (!fxaa && !isProgramReady())
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, source.framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        glBlitFramebuffer(0, 0, source.size.x, source.size.y, 0, 0, window_size.x, window_size.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    gl_state::Viewport(0, 0, window_size.x, window_size.y);
+    gl_state::SetEnabled(GL_BLEND, false);
+    gl_state::UseProgram(fxaa ? fxaa_program.Id() : program.Id());
+    const Locations& locations = fxaa ? fxaa_locations : program_locations;
+    const glm::vec2  texel     = 1.0f / glm::vec2{ source.allocated };
+    const glm::vec2  limit     = (glm::vec2{ source.size } - 0.5f) * texel;
+    glUniform2f(locations.scale, static_cast<float>(source.size.x) * texel.x, static_cast<float>(source.size.y) * texel.y);
+    glUniform2f(locations.limit, limit.x, limit.y);
+    if (fxaa)
+        glUniform2f(fxaa_texel_location, texel.x, texel.y);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(source.texture);
+    gl_state::BindVertexArray(vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+glm::ivec2 RenderTarget::Size() const noexcept
+{
+    return size;
+}
+
+glm::ivec2 RenderTarget::AllocatedSize() const noexcept
+{
+    return allocated;
+}
+
+int RenderTarget::Reallocations() const noexcept
+{
+    return reallocations;
+}
+
+int RenderTarget::Samples() const noexcept
+{
+    return samples;
+}
+
+GLuint RenderTarget::ColorTexture() const noexcept
+{
+    return resolve_color;
+}
+
+bool RenderTarget::DrawImGui(AntiAliasSettings& settings)
+{
+    bool changed = false;
+    int  current = 0;
+    while (current + 1 < IM_ARRAYSIZE(MSAA_CHOICES) && MSAA_CHOICES[current] < settings.msaa_samples)
+        ++current;
+    if (ImGui::Combo("msaa", &current, MSAA_NAMES, IM_ARRAYSIZE(MSAA_NAMES)))
+    {
+        settings.msaa_samples = MSAA_CHOICES[current];
+        changed               = true;
+    }
+    changed = ImGui::Checkbox("fxaa", &settings.fxaa) || changed;
+    return changed;
+}
+
+bool RenderTarget::Parse(std::string_view text, AntiAliasSettings& out_settings)
+{
+    AntiAliasSettings parsed;
+    parsed.msaa_samples = 1;
+    while (!text.empty())
+    {
+        const auto             plus  = text.find('+');
+        const std::string_view token = text.substr(0, plus);
+        text                         = plus == std::string_view::npos ? std::string_view{} : text.substr(plus + 1);
+        if (token == "fxaa")
+            parsed.fxaa = true;
+        else if (token == "msaa2")
+            parsed.msaa_samples = 2;
+        else if (token == "msaa4")
+            parsed.msaa_samples = 4;
+        else if (token == "msaa8")
+            parsed.msaa_samples = 8;
+        else if (token != "off")
+            return false;
+    }
+    out_settings = parsed;
+    return true;
+}
+
+std::string RenderTarget::Format(const AntiAliasSettings& settings)
+{
+    std::string text = settings.msaa_samples >= 8 ? "msaa8" : settings.msaa_samples >= 4 ? "msaa4" : settings.msaa_samples >= 2 ? "msaa2" : "";
+    if (settings.fxaa)
+        text += text.empty() ? "fxaa" : "+fxaa";
+    return text.empty() ? "off" : text;
+}
+
+bool RenderTarget::isProgramReady()
+{
+    if (program.IsReady())
+        return true;
+    if (!program.Poll())
+        return false;
+    program_locations = { glGetUniformLocation(program.Id(), "uScale"), glGetUniformLocation(program.Id(), "uLimit") };
+    gl_state::UseProgram(program.Id());
+    glUniform1i(glGetUniformLocation(program.Id(), "uScene"), 0);
+    return true;
+}
+
+bool RenderTarget::isFxaaReady()
+{
+    if (fxaa_program.IsReady())
+        return true;
+    if (!fxaa_program.Poll())
+        return false;
+    fxaa_texel_location = glGetUniformLocation(fxaa_program.Id(), "uTexel");
+    fxaa_locations      = { glGetUniformLocation(fxaa_program.Id(), "uScale"), glGetUniformLocation(fxaa_program.Id(), "uLimit") };
+    gl_state::UseProgram(fxaa_program.Id());
+    glUniform1i(glGetUniformLocation(fxaa_program.Id(), "uScene"), 0);
+    return true;
+}
+
+void RenderTarget::release()
+{
+    if (msaa_framebuffer != 0)
+        glDeleteFramebuffers(1, &msaa_framebuffer);
+    if (msaa_color != 0)
+        glDeleteRenderbuffers(1, &msaa_color);
+    if (depth != 0)
+        glDeleteRenderbuffers(1, &depth);
+    if (resolve_framebuffer != 0)
+        glDeleteFramebuffers(1, &resolve_framebuffer);
+    gl_state::DeleteTexture(resolve_color);
+    memory_tracker::Free(MemoryCategory::Textures, allocated_bytes);
+    msaa_framebuffer = msaa_color = resolve_framebuffer = resolve_color = depth = 0;
+    allocated_bytes  = 0;
+    allocated        = glm::ivec2{ 0 };
+}
@@ -0,0 +1,125 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "shader.h"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <glm/vec2.hpp>
+#include <string>
+#include <string_view>
+
+struct AntiAliasSettings
+{
+    int  msaa_samples = 4;     // 1 for none; clamped to what the driver supports
+    bool fxaa         = false; // post-process pass folded into the upscale, alone or on top of MSAA
+
+    bool operator==(const AntiAliasSettings&) const = default;
+};
+
+// A color texture and the framebuffer it is attached to; the lower left `size` of its `allocated` texels hold the image
+struct ColorSurface
+{
+    GLuint     framebuffer = 0;
+    GLuint     texture     = 0;
+    glm::ivec2 size{ 0 };
+    glm::ivec2 allocated{ 0 };
+};
+
+/**
+ * An offscreen color target the scene renders into at its own resolution, upscaled onto the backbuffer afterwards.
+ *
+ * With more than one sample the scene draws into a multisampled renderbuffer that Present resolves
+ * into a texture of the same size; the texture is then stretched over the window with a bilinear
+ * fullscreen triangle. A draw rather than a blit, because ES 3.0 can't blit into a multisampled
+ * default framebuffer and a blit can't filter while resolving. UI drawn after Present stays at native resolution.
+ * The FXAA variant of that draw is a cheap edge blur for when MSAA costs too much; both switch at runtime,
+ * so the Profiler's GPU zones can compare them frame to frame. While the FXAA program is still compiling
+ * the plain one stands in, and while that one is too a blit does, filtered but maybe refused by a
+ * multisampled backbuffer.
+ * The allocation only follows the size one way: growing past it reallocates with some headroom, shrinking renders
+ * into the corner of what is there and Present samples just that part, so a live window resize or dynamic resolution
+ * doesn't reallocate every frame. It is trimmed back once less than a quarter of it is in use. The bound framebuffer
+ * has a 24-bit depth buffer for the passes that test against one; nothing resolves or keeps it. GL thread only.
+ */
+class RenderTarget
+{
+public:
+    RenderTarget() = default;
+
+    RenderTarget(const RenderTarget&)                = delete;
+    RenderTarget& operator=(const RenderTarget&)     = delete;
+    RenderTarget(RenderTarget&&) noexcept            = delete;
+    RenderTarget& operator=(RenderTarget&&) noexcept = delete;
+
+    void Setup();
+    void Shutdown();
+
+    // Reallocates only when the sample count changes or the size outgrows, or uses too little of, the allocation;
+    // samples are clamped to GL_MAX_SAMPLES
+    void Resize(glm::ivec2 size, int samples);
+    // Binds the target for drawing and sets the viewport to its size; false (and the backbuffer bound) if it couldn't be created
+    bool Bind();
+    // Resolves, then draws the result over `window_size` of the default framebuffer, which is left bound
+    void Present(glm::ivec2 window_size, bool fxaa);
+    // The multisampled image resolved into the color texture, for passes between the scene and Present
+    ColorSurface Resolve();
+    // What Resolve returns, without resolving; for declaring the target before anything is drawn into it
+    ColorSurface ResolvedSurface() const noexcept;
+    // The upscale on its own, from any surface; post-processing hands over its output. Draws into `framebuffer`,
+    // the default one unless the window's picture is kept offscreen, and leaves it bound
+    void Present(const ColorSurface& source, glm::ivec2 window_size, bool fxaa, GLuint framebuffer = 0);
+
+    glm::ivec2 Size() const noexcept;
+    glm::ivec2 AllocatedSize() const noexcept; // at least Size(); the color texture's size
+    int        Reallocations() const noexcept;
+    int        Samples() const noexcept;
+    GLuint     ColorTexture() const noexcept;
+
+    // Controls for the caller's current window; returns true when something changed
+    static bool DrawImGui(AntiAliasSettings& settings);
+
+    // "off", "fxaa", "msaa2", "msaa4", "msaa8", or an msaa value and fxaa joined by '+' ("msaa2+fxaa")
+    static bool Parse(std::string_view text, AntiAliasSettings& out_settings);
+    // What Parse reads back; sample counts it doesn't know round down to one it does
+    static std::string Format(const AntiAliasSettings& settings);
+
+private:
+    struct Locations
+    {
+        GLint scale = -1;
+        GLint limit = -1;
+    };
+
+    void release();
+    // both set the sampler uniform the first time they're ready
+    bool isProgramReady();
+    bool isFxaaReady();
+
+private:
+    ShaderProgram program;
+    ShaderProgram fxaa_program;
+    Locations     program_locations;
+    Locations     fxaa_locations;
+    GLint         fxaa_texel_location = -1;
+    GLuint        vertex_array        = 0;
+    GLuint        msaa_framebuffer    = 0;
+    GLuint        msaa_color          = 0; // renderbuffer
+    GLuint        resolve_framebuffer = 0;
+    GLuint        resolve_color       = 0; // texture
+    GLuint        depth               = 0; // renderbuffer, on whichever framebuffer Bind binds
+
+    glm::ivec2  size{ 0 };
+    glm::ivec2  allocated{ 0 };
+    int         samples         = 0;
+    int         max_samples     = 1;
+    int         max_size        = 1;
+    int         reallocations   = 0;
+    std::size_t allocated_bytes = 0;
+};
@@ -0,0 +1,111 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "render_target_pool.h"
+
+#include "gl_state.h"
+#include "logger.h"
+#include "memory_tracker.h"
+
+#include <algorithm>
+#include <glm/common.hpp>
+
+ColorSurface RenderTargetPool::Acquire(glm::ivec2 size, GLenum internal_format)
+{
+    size = glm::max(size, glm::ivec2{ 1 });
+    for (Target& target : targets)
+    {
+        if (!target.is_in_use && target.internal_format == internal_format && target.surface.size == size)
+        {
+            target.is_in_use   = true;
+            target.idle_frames = 0;
+            return target.surface;
+        }
+    }
+
+    Target target;
+    target.internal_format   = internal_format;
+    target.surface.size      = size;
+    target.surface.allocated = size;
+    const bool is_half_float = internal_format == GL_RGBA16F;
+    target.bytes             = static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y) * (is_half_float ? 8 : 4);
+    glGenTextures(1, &target.surface.texture);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(target.surface.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internal_format), size.x, size.y, 0, GL_RGBA, is_half_float ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glGenFramebuffers(1, &target.surface.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.surface.framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.surface.texture, 0);
+    const bool is_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!is_complete)
+    {
+        LOG_ERROR("Pooled render target ", size.x, 'x', size.y, " is incomplete");
+        target.bytes = 0;
+        destroy(target);
+        return ColorSurface{};
+    }
+    memory_tracker::Allocate(MemoryCategory::Textures, target.bytes);
+    ++allocations;
+    target.is_in_use = true;
+    targets.push_back(target);
+    return target.surface;
+}
+
+void RenderTargetPool::Release(const ColorSurface& surface)
+{
+    if (surface.framebuffer == 0)
+        return;
+    const auto found = std::find_if(targets.begin(), targets.end(), [&surface](const Target& target) { return target.surface.framebuffer == surface.framebuffer; });
+    if (found != targets.end())
+        found->is_in_use = false;
+}
+
+void RenderTargetPool::EndFrame()
+{
+    for (Target& target : targets)
+    {
+        if (!target.is_in_use && ++target.idle_frames > UNUSED_FRAMES)
+            destroy(target);
+    }
+    std::erase_if(targets, [](const Target& target) { return target.surface.framebuffer == 0; });
+}
+
+void RenderTargetPool::Shutdown()
+{
+    for (Target& target : targets)
+        destroy(target);
+    targets.clear();
+}
+
+RenderTargetPool::Stats RenderTargetPool::GetStats() const noexcept
+{
+    Stats stats;
+    stats.targets     = static_cast<int>(targets.size());
+    stats.allocations = allocations;
+    for (const Target& target : targets)
+    {
+        stats.in_use += target.is_in_use ? 1 : 0;
+        stats.bytes += target.bytes;
+    }
+    return stats;
+}
+
+void RenderTargetPool::destroy(Target& target)
+{
+    if (target.surface.framebuffer != 0)
+        glDeleteFramebuffers(1, &target.surface.framebuffer);
+    gl_state::DeleteTexture(target.surface.texture);
+    memory_tracker::Free(MemoryCategory::Textures, target.bytes);
+    target.surface = ColorSurface{};
+    target.bytes   = 0;
+}
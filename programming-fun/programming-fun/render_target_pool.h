@@ -0,0 +1,68 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "render_target.h"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <glm/vec2.hpp>
+#include <vector>
+
+/**
+ * Transient color targets for passes that only need one for part of a frame.
+ *
+ * Acquire hands out a free target of exactly that size and format, creating one only when none is free, and
+ * Release gives it back for the next pass to reuse; a post-processing chain of several passes at two sizes ends
+ * up holding a handful, however many passes it runs. Targets that go unused for UNUSED_FRAMES frames are deleted
+ * at EndFrame, so a resize or a dynamic resolution step doesn't keep the old sizes around. Sampling is bilinear
+ * and clamped to the edge. Everything acquired in a frame should be released before its EndFrame. GL thread only.
+ */
+class RenderTargetPool
+{
+public:
+    static constexpr int UNUSED_FRAMES = 30;
+
+    struct Stats
+    {
+        int         targets     = 0;
+        int         in_use      = 0;
+        int         allocations = 0; // ever, deleted ones included
+        std::size_t bytes       = 0;
+    };
+
+    RenderTargetPool() = default;
+
+    RenderTargetPool(const RenderTargetPool&)                = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&)     = delete;
+    RenderTargetPool(RenderTargetPool&&) noexcept            = delete;
+    RenderTargetPool& operator=(RenderTargetPool&&) noexcept = delete;
+
+    // `internal_format` is GL_RGBA8 or GL_RGBA16F; a surface with framebuffer 0 when it couldn't be created
+    ColorSurface Acquire(glm::ivec2 size, GLenum internal_format);
+    void         Release(const ColorSurface& surface);
+    void         EndFrame();
+    void         Shutdown();
+    Stats        GetStats() const noexcept;
+
+private:
+    struct Target
+    {
+        ColorSurface surface;
+        GLenum       internal_format = GL_RGBA8;
+        std::size_t  bytes           = 0;
+        int          idle_frames     = 0;
+        bool         is_in_use       = false;
+    };
+
+    static void destroy(Target& target);
+
+private:
+    std::vector<Target> targets;
+    int                 allocations = 0;
+};
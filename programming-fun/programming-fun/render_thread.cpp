@@ -0,0 +1,136 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "render_thread.h"
+
+#include "logger.h"
+#include "profiler.h"
+#include "scheduling.h"
+
+#include <SDL.h>
+
+RenderThread::~RenderThread()
+{
+    Stop();
+}
+
+bool RenderThread::Start([[maybe_unused]] SDL_Window* window, [[maybe_unused]] SDL_GLContext context)
+{
+#if defined(__EMSCRIPTEN__)
+    return false;
+#else
+    if (is_running)
+        return true;
+    // a context can only be current on one thread at a time
+    SDL_GL_MakeCurrent(window, nullptr);
+    {
+        std::lock_guard lock{ mutex };
+        is_stopping = false;
+        has_failed  = false;
+        is_busy     = true; // until the thread owns the context
+    }
+    thread = std::thread{ [this, window, context] { threadLoop(window, context); } };
+
+    std::unique_lock lock{ mutex };
+    changed.wait(lock, [this] { return !is_busy; });
+    if (has_failed)
+    {
+        lock.unlock();
+        thread.join();
+        SDL_GL_MakeCurrent(window, context);
+        return false;
+    }
+    is_running = true;
+    return true;
+#endif
+}
+
+void RenderThread::Stop()
+{
+    if (!thread.joinable())
+        return;
+    {
+        std::lock_guard lock{ mutex };
+        is_stopping = true;
+    }
+    changed.notify_all();
+    thread.join();
+    is_running = false;
+}
+
+void RenderThread::Submit(Work work)
+{
+    if (!is_running)
+    {
+        work();
+        ++completed;
+        return;
+    }
+    {
+        std::unique_lock lock{ mutex };
+        changed.wait(lock, [this] { return pending == nullptr; });
+        pending = std::move(work);
+    }
+    changed.notify_all();
+}
+
+bool RenderThread::IsRunning() const noexcept
+{
+    return is_running;
+}
+
+std::uint64_t RenderThread::CompletedCount() const noexcept
+{
+    std::lock_guard lock{ mutex };
+    return completed;
+}
+
+void RenderThread::threadLoop(SDL_Window* window, SDL_GLContext context)
+{
+    profiler::SetThreadName("render");
+    scheduling::SetThreadRole(scheduling::ThreadRole::Render);
+    const bool is_current = SDL_GL_MakeCurrent(window, context) == 0;
+    {
+        std::lock_guard lock{ mutex };
+        if (!is_current)
+        {
+            LOG_ERROR("Render thread could not take the GL context: ", SDL_GetError());
+            has_failed = true;
+        }
+        is_busy = false;
+    }
+    changed.notify_all();
+    if (!is_current)
+        return;
+
+    while (true)
+    {
+        Work work;
+        {
+            std::unique_lock lock{ mutex };
+            changed.wait(lock, [this] { return pending != nullptr || is_stopping; });
+            if (pending == nullptr)
+                break;
+            work    = std::move(pending);
+            pending = nullptr;
+            is_busy = true;
+        }
+        // frees the slot so the main thread can queue the next frame while this one runs
+        changed.notify_all();
+        {
+            PROFILE_TRACE_ZONE("Render Frame");
+            work();
+        }
+        {
+            std::lock_guard lock{ mutex };
+            is_busy = false;
+            ++completed;
+        }
+        changed.notify_all();
+    }
+    SDL_GL_MakeCurrent(window, nullptr);
+}
@@ -0,0 +1,61 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <SDL_video.h>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * A thread that owns the window's GL context and runs one frame of GL work at a time.
+ *
+ * At most one frame waits while another executes: Submit blocks when the slot is taken, which keeps the
+ * main thread no more than one frame ahead. When the thread is not running Submit runs the work inline,
+ * so callers have a single path. Not available on Emscripten: WebGL contexts can't be shared for the uploads, so
+ * the pthreads web build runs the whole main loop on a worker with an OffscreenCanvas instead (see main.cpp).
+ */
+class RenderThread
+{
+public:
+    using Work = std::function<void()>;
+
+    RenderThread() = default;
+    ~RenderThread();
+
+    RenderThread(const RenderThread&)                = delete;
+    RenderThread& operator=(const RenderThread&)     = delete;
+    RenderThread(RenderThread&&) noexcept            = delete;
+    RenderThread& operator=(RenderThread&&) noexcept = delete;
+
+    // Releases `context` from the calling thread and makes it current on the render thread; false if that fails
+    bool Start(SDL_Window* window, SDL_GLContext context);
+    // Finishes queued work and releases the context; make it current again on the caller afterwards
+    void Stop();
+
+    void Submit(Work work);
+
+    bool          IsRunning() const noexcept;
+    std::uint64_t CompletedCount() const noexcept;
+
+private:
+    void threadLoop(SDL_Window* window, SDL_GLContext context);
+
+private:
+    std::thread             thread;
+    mutable std::mutex      mutex;
+    std::condition_variable changed;
+    Work                    pending;
+    bool                    is_busy     = false;
+    bool                    is_running  = false;
+    bool                    is_stopping = false;
+    bool                    has_failed  = false;
+    std::uint64_t           completed   = 0;
+};
@@ -0,0 +1,273 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "scene_file.h"
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+
+namespace
+{
+    using scene_format::ALIGNMENT;
+    using scene_format::Header;
+    using scene_format::RelativeArray;
+
+    std::size_t align_up(std::size_t value) noexcept
+    {
+        return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    template <typename T>
+    bool parse_number(std::string_view text, T& out_value, int base = 10)
+    {
+        T value{};
+        if constexpr (std::is_integral_v<T>)
+        {
+            if (const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value, base); error != std::errc{} || end != text.data() + text.size())
+                return false;
+        }
+        else
+        {
+            if (const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value); error != std::errc{} || end != text.data() + text.size())
+                return false;
+        }
+        out_value = value;
+        return true;
+    }
+
+    // splits on spaces and tabs; at most `N` words, false past that
+    template <std::size_t N>
+    bool split_words(std::string_view text, std::string_view (&words)[N], std::size_t& out_count)
+    {
+        constexpr std::string_view SPACE = " \t\r";
+        out_count                        = 0;
+        for (std::size_t begin = text.find_first_not_of(SPACE); begin != std::string_view::npos; begin = text.find_first_not_of(SPACE, begin))
+        {
+            if (out_count == N)
+                return false;
+            const std::size_t end = std::min(text.find_first_of(SPACE, begin), text.size());
+            words[out_count++]    = text.substr(begin, end - begin);
+            begin                 = end;
+        }
+        return true;
+    }
+
+    // the array `field` describes lies inside `bytes`, aligned for its type, and holds `count` elements
+    template <typename T>
+    bool is_inside(std::span<const unsigned char> bytes, const RelativeArray<T>& field, std::uint64_t count)
+    {
+        const auto field_at = static_cast<std::int64_t>(reinterpret_cast<const unsigned char*>(&field) - bytes.data());
+        const auto first    = field_at + field.offset;
+        if (field.count != count)
+            return false;
+        if (count == 0)
+            return true;
+        return first >= static_cast<std::int64_t>(sizeof(Header)) && static_cast<std::uint64_t>(first) <= bytes.size() && first % static_cast<std::int64_t>(alignof(T)) == 0 &&
+               field.count <= (bytes.size() - static_cast<std::uint64_t>(first)) / sizeof(T);
+    }
+
+    // appends `values` on the next boundary and points `field`, which sits at `field_at` in `blob`, at them
+    template <typename T>
+    void append_array(std::vector<unsigned char>& blob, std::size_t field_at, std::span<const T> values)
+    {
+        RelativeArray<T> field;
+        field.count = values.size();
+        if (!values.empty())
+        {
+            const std::size_t first = align_up(blob.size());
+            blob.resize(first + values.size_bytes());
+            std::memcpy(blob.data() + first, values.data(), values.size_bytes());
+            field.offset = static_cast<std::int64_t>(first) - static_cast<std::int64_t>(field_at);
+        }
+        std::memcpy(blob.data() + field_at, &field, sizeof(field));
+    }
+}
+
+bool SceneFile::Open(const std::filesystem::path& filename)
+{
+    Close();
+    if (!file.Open(filename))
+        return false;
+
+    // the mapping starts on a page, so the header and every aligned array in it can be read in place
+    const auto bytes = file.Bytes();
+    Header     copy;
+    if (bytes.size() >= sizeof(Header))
+        std::memcpy(&copy, bytes.data(), sizeof(Header));
+    if (bytes.size() < sizeof(Header) || std::memcmp(copy.magic, scene_format::MAGIC, sizeof(copy.magic)) != 0 || copy.version != scene_format::VERSION ||
+        copy.header_size != sizeof(Header))
+    {
+        std::cerr << "Not a scene file (or an old version): " << filename << '\n';
+        Close();
+        return false;
+    }
+    const auto* mapped = reinterpret_cast<const Header*>(bytes.data());
+    const auto  count  = static_cast<std::uint64_t>(copy.entity_count);
+    if (copy.file_size != bytes.size() || !is_inside(bytes, mapped->positions, count) || !is_inside(bytes, mapped->velocities, count) ||
+        !is_inside(bytes, mapped->sprites, count) || !(is_inside(bytes, mapped->colors, count) || is_inside(bytes, mapped->colors, 0)))
+    {
+        std::cerr << "Corrupt scene file: " << filename << '\n';
+        Close();
+        return false;
+    }
+    header = mapped;
+    return true;
+}
+
+void SceneFile::Close()
+{
+    header = nullptr;
+    file.Close();
+}
+
+bool SceneFile::IsOpen() const noexcept
+{
+    return header != nullptr;
+}
+
+std::size_t SceneFile::EntityCount() const noexcept
+{
+    return header != nullptr ? header->entity_count : 0;
+}
+
+glm::vec2 SceneFile::WorldSize() const noexcept
+{
+    return header != nullptr ? glm::vec2{ header->world_size[0], header->world_size[1] } : glm::vec2{ 0.0f };
+}
+
+std::span<const glm::vec2> SceneFile::Positions() const noexcept
+{
+    return header != nullptr ? header->positions.Span() : std::span<const glm::vec2>{};
+}
+
+std::span<const glm::vec2> SceneFile::Velocities() const noexcept
+{
+    return header != nullptr ? header->velocities.Span() : std::span<const glm::vec2>{};
+}
+
+std::span<const std::uint16_t> SceneFile::Sprites() const noexcept
+{
+    return header != nullptr ? header->sprites.Span() : std::span<const std::uint16_t>{};
+}
+
+std::span<const std::uint32_t> SceneFile::Colors() const noexcept
+{
+    return header != nullptr ? header->colors.Span() : std::span<const std::uint32_t>{};
+}
+
+bool read_scene_text(const std::filesystem::path& filename, SceneData& out_scene)
+{
+    std::ifstream file{ filename, std::ios::binary };
+    if (!file)
+    {
+        std::cerr << "Failed to read " << filename << '\n';
+        return false;
+    }
+    const std::string text{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    return parse_scene_text(text, out_scene, filename.string());
+}
+
+bool parse_scene_text(std::string_view text, SceneData& out_scene, std::string_view source_name)
+{
+    SceneData scene;
+    int       number = 0;
+    while (!text.empty())
+    {
+        ++number;
+        const std::size_t end  = std::min(text.find('\n'), text.size());
+        std::string_view  line = text.substr(0, end);
+        text.remove_prefix(std::min(end + 1, text.size()));
+        line = line.substr(0, line.find('#'));
+
+        std::string_view words[8];
+        std::size_t      count = 0;
+        bool             is_ok = split_words(line, words, count);
+        if (is_ok && count == 0)
+            continue;
+        if (is_ok && words[0] == "world")
+        {
+            is_ok = count == 3 && parse_number(words[1], scene.world_size.x) && parse_number(words[2], scene.world_size.y);
+            is_ok = is_ok && scene.world_size.x >= 0.0f && scene.world_size.y >= 0.0f;
+        }
+        else if (is_ok && words[0] == "entity")
+        {
+            glm::vec2     position{ 0.0f };
+            glm::vec2     velocity{ 0.0f };
+            std::uint16_t sprite = 0;
+            std::uint32_t color  = 0xFFFFFFFFu;
+            is_ok                = count >= 5 && count <= 7 && parse_number(words[1], position.x) && parse_number(words[2], position.y);
+            is_ok                = is_ok && parse_number(words[3], velocity.x) && parse_number(words[4], velocity.y);
+            is_ok                = is_ok && (count < 6 || parse_number(words[5], sprite));
+            is_ok                = is_ok && (count < 7 || (words[6].size() == 8 && parse_number(words[6], color, 16)));
+            if (is_ok)
+            {
+                // written as it reads, RRGGBBAA; pack_rgba8 keeps red in the low byte
+                color = (color >> 24) | ((color >> 8) & 0xFF00u) | ((color << 8) & 0xFF0000u) | (color << 24);
+                scene.positions.push_back(position);
+                scene.velocities.push_back(velocity);
+                scene.sprites.push_back(sprite);
+                scene.colors.push_back(color);
+            }
+        }
+        else
+        {
+            is_ok = false;
+        }
+        if (!is_ok)
+        {
+            std::cerr << source_name << ':' << number << ": expected \"world <width> <height>\" or \"entity <x> <y> <vx> <vy> [sprite] [RRGGBBAA]\"\n";
+            return false;
+        }
+    }
+    if (scene.positions.size() > std::numeric_limits<std::uint32_t>::max())
+    {
+        std::cerr << source_name << ": too many entities for one scene\n";
+        return false;
+    }
+    out_scene = std::move(scene);
+    return true;
+}
+
+bool write_scene_file(const SceneData& scene, const std::filesystem::path& output)
+{
+    const std::size_t count = scene.positions.size();
+    if (scene.velocities.size() != count || scene.sprites.size() != count || (!scene.colors.empty() && scene.colors.size() != count))
+    {
+        std::cerr << "Scene columns differ in length, not writing " << output << '\n';
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, scene_format::MAGIC, sizeof(header.magic));
+    header.version       = scene_format::VERSION;
+    header.header_size   = sizeof(Header);
+    header.entity_count  = static_cast<std::uint32_t>(count);
+    header.world_size[0] = scene.world_size.x;
+    header.world_size[1] = scene.world_size.y;
+    std::vector<unsigned char> blob(sizeof(Header));
+    append_array(blob, offsetof(Header, positions), std::span<const glm::vec2>{ scene.positions });
+    append_array(blob, offsetof(Header, velocities), std::span<const glm::vec2>{ scene.velocities });
+    append_array(blob, offsetof(Header, sprites), std::span<const std::uint16_t>{ scene.sprites });
+    append_array(blob, offsetof(Header, colors), std::span<const std::uint32_t>{ scene.colors });
+    blob.resize(align_up(blob.size()));
+    header.file_size = blob.size();
+    // the fixed fields over the front, leaving the array fields append_array wrote
+    std::memcpy(blob.data(), &header, offsetof(Header, positions));
+
+    std::ofstream file{ output, std::ios::binary };
+    if (!file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size())))
+    {
+        std::cerr << "Failed to write " << output << '\n';
+        return false;
+    }
+    return true;
+}
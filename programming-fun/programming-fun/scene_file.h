@@ -0,0 +1,122 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "mapped_file.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glm/vec2.hpp>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// A scene as the text format and the converter see it: EntityStore's columns, one entry per entity in each
+struct SceneData
+{
+    glm::vec2                  world_size{ 0.0f }; // what the entities roam, 0 for the window
+    std::vector<glm::vec2>     positions;
+    std::vector<glm::vec2>     velocities;
+    std::vector<std::uint16_t> sprites;
+    std::vector<std::uint32_t> colors; // RGBA8
+};
+
+/**
+ * The binary scene file, laid out so it can be used where it lies in a mapping.
+ *
+ * A fixed Header, then each column of the scene as a plain array on a 16 byte boundary, in the same element
+ * types EntityStore keeps. The header finds them by RelativeArray: an offset from the offset field itself rather
+ * than from the file's start, so the header means the same copied out on its own as mapped whole, and nothing
+ * in the file needs fixing up after it is read. Little-endian, like every platform this builds for; a version
+ * other than VERSION is refused rather than guessed at, the converter being the way to a new one.
+ */
+namespace scene_format
+{
+    inline constexpr char          MAGIC[4]  = { 'P', 'F', 'S', 'C' };
+    inline constexpr std::uint32_t VERSION   = 1;
+    inline constexpr std::size_t   ALIGNMENT = 16;
+
+    static_assert(std::endian::native == std::endian::little, "scene files are little-endian");
+
+    template <typename T>
+    struct RelativeArray
+    {
+        std::int64_t  offset = 0; // in bytes from this very field to the first element
+        std::uint64_t count  = 0;
+
+        // Only where the header sits in its file, so the offset lands on the array
+        std::span<const T> Span() const noexcept
+        {
+            return std::span<const T>{ reinterpret_cast<const T*>(reinterpret_cast<const unsigned char*>(this) + offset), static_cast<std::size_t>(count) };
+        }
+    };
+
+    struct Header
+    {
+        char                         magic[4]      = {};
+        std::uint32_t                version       = 0;
+        std::uint32_t                header_size   = 0; // sizeof(Header) when written
+        std::uint32_t                entity_count  = 0;
+        std::uint64_t                file_size     = 0;
+        float                        world_size[2] = {};
+        RelativeArray<glm::vec2>     positions;
+        RelativeArray<glm::vec2>     velocities;
+        RelativeArray<std::uint16_t> sprites;
+        RelativeArray<std::uint32_t> colors;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) == 96, "the header is written and read as it is");
+    static_assert(sizeof(glm::vec2) == 8, "positions and velocities are two packed floats");
+}
+
+/**
+ * A binary scene file mapped read-only, its columns handed out as spans straight into the mapping.
+ *
+ * Open checks the header and that every array lies inside the file, aligned for its type and as long as the
+ * entity count, and reads nothing else: the pages come in when something reads the spans, which is typically
+ * EntityStore::Assign copying each column whole. The spans are valid until Close.
+ */
+class SceneFile
+{
+public:
+    SceneFile() = default;
+
+    SceneFile(const SceneFile&)                = delete;
+    SceneFile& operator=(const SceneFile&)     = delete;
+    SceneFile(SceneFile&&) noexcept            = delete;
+    SceneFile& operator=(SceneFile&&) noexcept = delete;
+
+    // False, and logs why, for anything but a well formed scene of this version
+    bool Open(const std::filesystem::path& filename);
+    void Close();
+
+    bool        IsOpen() const noexcept;
+    std::size_t EntityCount() const noexcept;
+    glm::vec2   WorldSize() const noexcept;
+
+    std::span<const glm::vec2>     Positions() const noexcept;
+    std::span<const glm::vec2>     Velocities() const noexcept;
+    std::span<const std::uint16_t> Sprites() const noexcept;
+    std::span<const std::uint32_t> Colors() const noexcept;
+
+private:
+    MappedFile                  file;
+    const scene_format::Header* header = nullptr; // into the mapping
+};
+
+// The text format: one "name values..." a line, '#' starting a comment.
+//     world <width> <height>
+//     entity <x> <y> <velocity x> <velocity y> [sprite] [RRGGBBAA]
+// The sprite defaults to 0 and the color to FFFFFFFF. False, with the line logged, on anything else.
+bool read_scene_text(const std::filesystem::path& filename, SceneData& out_scene);
+bool parse_scene_text(std::string_view text, SceneData& out_scene, std::string_view source_name = "scene");
+// The binary format SceneFile maps. Returns false (and logs) on I/O errors.
+bool write_scene_file(const SceneData& scene, const std::filesystem::path& output);
@@ -0,0 +1,239 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "scene_views.h"
+
+#include "frame_packet.h"
+#include "logger.h"
+#include "profiler.h"
+#include "worker_pool.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui.h>
+#include <span>
+
+namespace
+{
+    glm::ivec2 window_points(SDL_Window* window)
+    {
+        glm::ivec2 size{ 0 };
+        SDL_GetWindowSize(window, &size.x, &size.y);
+        return size;
+    }
+
+    Aabb2 shown_rectangle(const SceneViewSettings& settings, glm::vec2 display_size, glm::ivec2 points)
+    {
+        const glm::vec2 center = settings.center * display_size;
+        const glm::vec2 half   = glm::vec2{ points } * (0.5f / std::max(settings.zoom, 0.01f));
+        return Aabb2{ center - half, center + half };
+    }
+
+    bool is_shown(const FramePacket& frame, const RenderCommand& command, const Aabb2& shown) noexcept
+    {
+        if (render_key::Layer(command.key) != RenderLayer::Sprites)
+            return true;
+        for (std::uint32_t i = command.first; i < command.first + command.count; ++i)
+        {
+            // half the width plus half the height reaches every corner, however the sprite turns
+            const SpriteInstance& sprite = frame.sprites[i].sprite;
+            const float           reach  = 0.5f * (std::abs(sprite.size.x) + std::abs(sprite.size.y));
+            if (sprite.position.x + reach >= shown.min.x && sprite.position.x - reach <= shown.max.x && sprite.position.y + reach >= shown.min.y &&
+                sprite.position.y - reach <= shown.max.y)
+                return true;
+        }
+        return false;
+    }
+}
+
+bool SceneViews::Open(const char* title, const SceneViewSettings& settings)
+{
+#if defined(__EMSCRIPTEN__)
+    LOG_WARN("Scene view ", title, " needs a window of its own, and the web build only has its canvas");
+    return false;
+#else
+    if (views.size() >= static_cast<std::size_t>(MAX_VIEWS))
+    {
+        LOG_WARN("Scene view ", title, " not opened, ", MAX_VIEWS, " are already open");
+        return false;
+    }
+    // the same GL attributes as the main window, which are still set, so its context can draw here too
+    constexpr Uint32 flags  = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
+    SDL_Window*      window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 640, 360, flags);
+    if (window == nullptr)
+    {
+        LOG_WARN("Failed to create scene view ", title, ": ", SDL_GetError());
+        return false;
+    }
+    View& view    = views.emplace_back();
+    view.window   = window;
+    view.title    = title;
+    view.settings = settings;
+    return true;
+#endif
+}
+
+bool SceneViews::HandleWindowEvent(const SDL_WindowEvent& event)
+{
+    const auto it = std::find_if(views.begin(), views.end(), [&event](const View& view) { return SDL_GetWindowID(view.window) == event.windowID; });
+    if (it == views.end())
+        return std::any_of(closed.begin(), closed.end(), [&event](const Closed& entry) { return SDL_GetWindowID(entry.window) == event.windowID; });
+    switch (event.event)
+    {
+        case SDL_WINDOWEVENT_CLOSE: close(static_cast<std::size_t>(it - views.begin())); break;
+        // whatever was on screen is gone, so the next frame draws it however long its rate still had to go
+        case SDL_WINDOWEVENT_EXPOSED:
+        case SDL_WINDOWEVENT_SIZE_CHANGED:
+        case SDL_WINDOWEVENT_RESTORED: it->is_due = true; break;
+    }
+    return true;
+}
+
+Aabb2 SceneViews::CullBounds(glm::vec2 display_size) const
+{
+    Aabb2 bounds{ glm::vec2{ 0.0f }, display_size };
+    for (const View& view : views)
+    {
+        const Aabb2 shown = shown_rectangle(view.settings, display_size, window_points(view.window));
+        bounds.min        = glm::min(bounds.min, shown.min);
+        bounds.max        = glm::max(bounds.max, shown.max);
+    }
+    return bounds;
+}
+
+void SceneViews::Record(FramePacket& frame, glm::vec2 display_size, std::uint64_t frame_number, WorkerPool& workers)
+{
+    const Uint64 now       = SDL_GetPerformanceCounter();
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    due.clear();
+    due_shown.clear();
+    for (std::size_t i = 0; i < views.size(); ++i)
+    {
+        const View& view = views[i];
+        if ((SDL_GetWindowFlags(view.window) & SDL_WINDOW_MINIMIZED) != 0)
+            continue;
+        if (!view.is_due && view.settings.rate_hz > 0 && now - view.last_drawn < frequency / static_cast<Uint64>(view.settings.rate_hz))
+            continue;
+        due.push_back(i);
+        due_shown.push_back(shown_rectangle(view.settings, display_size, window_points(view.window)));
+    }
+    if (due.empty())
+        return;
+
+    // the arena takes allocations from the main thread only, so every view gets room for all of the commands
+    // and its job says how many it kept
+    const std::size_t total = frame.commands.size();
+    frame.views.resize(due.size());
+    frame.view_commands.resize(total * due.size());
+    for (std::size_t k = 0; k < due.size(); ++k)
+    {
+        View&          view  = views[due[k]];
+        SceneViewDraw& draw  = frame.views[k];
+        const Aabb2&   shown = due_shown[k];
+        draw.window          = view.window;
+        draw.projection      = glm::ortho(shown.min.x, shown.max.x, shown.max.y, shown.min.y);
+        draw.first           = static_cast<std::uint32_t>(k * total);
+        SDL_GL_GetDrawableSize(view.window, &draw.size.x, &draw.size.y);
+        view.last_drawn = now;
+        view.last_frame = frame_number;
+        view.is_due     = false;
+    }
+
+    workers.ParallelFor("Scene Views", due.size(), 1,
+                        [&](std::size_t begin, std::size_t end)
+                        {
+                            for (std::size_t k = begin; k < end; ++k)
+                            {
+                                const Uint64   started = SDL_GetPerformanceCounter();
+                                View&          view    = views[due[k]];
+                                SceneViewDraw& draw    = frame.views[k];
+                                RenderCommand* kept    = frame.view_commands.data() + draw.first;
+                                std::uint32_t  count   = 0;
+                                for (const RenderCommand& command : frame.commands)
+                                {
+                                    if (is_shown(frame, command, due_shown[k]))
+                                        kept[count++] = command;
+                                }
+                                draw.count             = count;
+                                view.stats.sort_passes = radix_sort(std::span{ kept, count }, view.sort_scratch);
+                                view.stats.commands    = static_cast<int>(count);
+                                view.stats.culled      = static_cast<int>(total - count);
+                                view.stats.record_ms   = profiler::ToMilliseconds(SDL_GetPerformanceCounter() - started);
+                                ++view.stats.frames;
+                            }
+                        });
+}
+
+void SceneViews::Collect(std::uint64_t drawn_frame)
+{
+    std::erase_if(closed,
+                  [drawn_frame](const Closed& entry)
+                  {
+                      if (entry.frame > drawn_frame)
+                          return false;
+                      SDL_DestroyWindow(entry.window);
+                      return true;
+                  });
+}
+
+void SceneViews::Shutdown()
+{
+    for (const View& view : views)
+        SDL_DestroyWindow(view.window);
+    for (const Closed& entry : closed)
+        SDL_DestroyWindow(entry.window);
+    views.clear();
+    closed.clear();
+}
+
+int SceneViews::Count() const noexcept
+{
+    return static_cast<int>(views.size());
+}
+
+void SceneViews::DrawImGui()
+{
+    ImGui::Text("scene views: %d open", Count());
+    ImGui::SameLine();
+    ImGui::BeginDisabled(views.size() >= static_cast<std::size_t>(MAX_VIEWS));
+    if (ImGui::SmallButton("overview"))
+        Open("Overview", SceneViewSettings{ glm::vec2{ 0.5f }, 0.25f, 10 });
+    ImGui::SameLine();
+    if (ImGui::SmallButton("detail"))
+        Open("Detail", SceneViewSettings{ glm::vec2{ 0.5f }, 2.0f, 0 });
+    ImGui::EndDisabled();
+
+    for (std::size_t i = 0; i < views.size(); ++i)
+    {
+        View& view = views[i];
+        ImGui::PushID(static_cast<int>(i));
+        ImGui::Text("  %s: %d commands, %d culled, %d sort passes, %.3f ms, %llu frames", view.title.c_str(), view.stats.commands, view.stats.culled, view.stats.sort_passes,
+                    view.stats.record_ms, static_cast<unsigned long long>(view.stats.frames));
+        ImGui::SameLine();
+        const bool is_closing = ImGui::SmallButton("close");
+        ImGui::SliderFloat2("center", &view.settings.center.x, 0.0f, 1.0f);
+        ImGui::SliderFloat("zoom", &view.settings.zoom, 0.05f, 8.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderInt("rate hz (0 every frame)", &view.settings.rate_hz, 0, 120);
+        ImGui::PopID();
+        if (is_closing)
+        {
+            close(i);
+            break;
+        }
+    }
+}
+
+void SceneViews::close(std::size_t index)
+{
+    View& view = views[index];
+    SDL_HideWindow(view.window);
+    closed.push_back(Closed{ view.window, view.last_frame });
+    views.erase(views.begin() + static_cast<std::ptrdiff_t>(index));
+}
@@ -0,0 +1,114 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "math_kernels.h"
+#include "render_commands.h"
+
+#include <SDL_events.h>
+#include <SDL_video.h>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <string>
+#include <vector>
+
+struct FramePacket;
+class WorkerPool;
+
+struct SceneViewSettings
+{
+    glm::vec2 center{ 0.5f }; // what it looks at, as a fraction of the main window
+    float     zoom    = 1.0f; // 1 is the main window's scale, under 1 shows more of the scene
+    int       rate_hz = 0;    // 0 draws with every frame the main window draws
+};
+
+/**
+ * More OS windows onto the scene beside the main one, like an overview and a detail.
+ *
+ * Every view draws with the main window's GL context, made current on the view's window in turn, so the
+ * textures, buffers, programs and vertex arrays are the same objects and a view uploads nothing of its own. A
+ * view shows a rectangle of the main window's screen coordinates around `center`, its window's size over
+ * `zoom`.
+ *
+ * Record comes after the scene is recorded. For each view due at its rate it picks the frame's commands
+ * inside the view's rectangle and sorts them, one job per view on the workers, into the frame's view_commands;
+ * the render side then just draws each view's run straight to its backbuffer before the main window. Only
+ * sprites are tested, since the other layers record one command over their whole list and meshes don't carry
+ * their size. A view can only show what the main window recorded: CullBounds widens the sprite stress's culling
+ * to every view, but the tilemap streams only the main window's chunks, and the scene target, lights and
+ * post-processing are the main window's alone.
+ *
+ * A closed view's window is hidden at once and destroyed once the frames that drew into it are done on the
+ * GPU. The web build has one canvas, so Open fails there. Main thread.
+ */
+class SceneViews
+{
+public:
+    static constexpr int MAX_VIEWS = 4;
+
+    struct Stats
+    {
+        int           commands    = 0; // kept out of the frame's
+        int           culled      = 0;
+        int           sort_passes = 0;
+        double        record_ms   = 0.0; // culling and sorting, on its job
+        std::uint64_t frames      = 0;   // recorded since it opened
+    };
+
+    SceneViews() = default;
+
+    SceneViews(const SceneViews&)                = delete;
+    SceneViews& operator=(const SceneViews&)     = delete;
+    SceneViews(SceneViews&&) noexcept            = delete;
+    SceneViews& operator=(SceneViews&&) noexcept = delete;
+
+    // After the main window exists, with the GL attributes it was made with; false, logged, when it can't
+    bool Open(const char* title, const SceneViewSettings& settings);
+    // Any window's event; true when it was a view's, whose close button closes only that view
+    bool HandleWindowEvent(const SDL_WindowEvent& event);
+    // The main window's screen rectangle grown to take in every view's
+    Aabb2 CullBounds(glm::vec2 display_size) const;
+    // After the frame's scene is recorded; `frame_number` is what ReleaseQueue::Submitted is told for it
+    void Record(FramePacket& frame, glm::vec2 display_size, std::uint64_t frame_number, WorkerPool& workers);
+    // Destroys the windows whose last frame is at or before `drawn_frame`, ReleaseQueue's latest done on the GPU
+    void Collect(std::uint64_t drawn_frame);
+    // Every window, now; nothing may draw any more
+    void Shutdown();
+
+    int Count() const noexcept;
+    // Opening, closing and steering them, for the caller's current window
+    void DrawImGui();
+
+private:
+    struct View
+    {
+        SDL_Window*                window = nullptr;
+        std::string                title;
+        SceneViewSettings          settings;
+        Uint64                     last_drawn = 0;    // performance counter at its last Record
+        std::uint64_t              last_frame = 0;    // the latest frame it was recorded into
+        bool                       is_due     = true; // exposed or resized since
+        std::vector<RenderCommand> sort_scratch;      // its job's
+        Stats                      stats;
+    };
+
+    struct Closed
+    {
+        SDL_Window*   window = nullptr;
+        std::uint64_t frame  = 0;
+    };
+
+    void close(std::size_t index);
+
+private:
+    std::vector<View>        views;
+    std::vector<Closed>      closed;
+    std::vector<std::size_t> due; // Record's, into `views`
+    std::vector<Aabb2>       due_shown;
+};
@@ -0,0 +1,168 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "scheduling.h"
+
+#include "logger.h"
+
+#include <SDL.h>
+#include <mutex>
+#include <vector>
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <Windows.h>
+#    include <timeapi.h>
+#elif defined(__linux__)
+#    include <fstream>
+#    include <map>
+#    include <pthread.h>
+#    include <sched.h>
+#    include <string>
+#    include <utility>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    using CoreMask = GROUP_AFFINITY;
+
+    std::vector<CoreMask> find_cores()
+    {
+        DWORD length = 0;
+        GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+        std::vector<unsigned char> buffer(length);
+        if (length == 0 || !GetLogicalProcessorInformationEx(RelationProcessorCore, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length))
+            return {};
+        std::vector<CoreMask> cores;
+        for (DWORD offset = 0; offset < length;)
+        {
+            const auto* info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+            // a core's logical processors never straddle groups
+            cores.push_back(info->Processor.GroupMask[0]);
+            offset += info->Size;
+        }
+        return cores;
+    }
+
+    bool pin_to(const CoreMask& core)
+    {
+        return SetThreadGroupAffinity(GetCurrentThread(), &core, nullptr) != 0;
+    }
+#elif defined(__linux__)
+    using CoreMask = cpu_set_t;
+
+    int read_number(const std::string& path)
+    {
+        std::ifstream in{ path };
+        int           value = -1;
+        in >> value;
+        return in ? value : -1;
+    }
+
+    std::vector<CoreMask> find_cores()
+    {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+            return {};
+        // (package, core) to the logical processors on it that this process may use
+        std::map<std::pair<int, int>, cpu_set_t> by_core;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (!CPU_ISSET(cpu, &allowed))
+                continue;
+            const std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            const int         package  = read_number(topology + "physical_package_id");
+            const int         core     = read_number(topology + "core_id");
+            if (package < 0 || core < 0)
+                return {};
+            auto [entry, is_new] = by_core.try_emplace(std::pair{ package, core });
+            if (is_new)
+                CPU_ZERO(&entry->second);
+            CPU_SET(cpu, &entry->second);
+        }
+        std::vector<CoreMask> cores;
+        for (const auto& [id, set] : by_core)
+            cores.push_back(set);
+        return cores;
+    }
+
+    bool pin_to(const CoreMask& core)
+    {
+        return pthread_setaffinity_np(pthread_self(), sizeof(core), &core) == 0;
+    }
+#else
+    struct CoreMask
+    {
+    };
+
+    std::vector<CoreMask> find_cores()
+    {
+        return {};
+    }
+
+    bool pin_to(const CoreMask&)
+    {
+        return false;
+    }
+#endif
+
+    const std::vector<CoreMask>& cores()
+    {
+        static const std::vector<CoreMask> found = find_cores();
+        return found;
+    }
+
+    bool is_fine_timer = false;
+}
+
+namespace scheduling
+{
+    void SetFineTimer(bool fine)
+    {
+        if (fine == is_fine_timer)
+            return;
+        is_fine_timer = fine;
+#if defined(_WIN32)
+        if (fine)
+            timeBeginPeriod(1);
+        else
+            timeEndPeriod(1);
+#endif
+    }
+
+    void SetThreadRole(ThreadRole role)
+    {
+        SDL_ThreadPriority priority = SDL_THREAD_PRIORITY_NORMAL;
+        switch (role)
+        {
+            case ThreadRole::Audio: priority = SDL_THREAD_PRIORITY_TIME_CRITICAL; break;
+            case ThreadRole::Render: priority = SDL_THREAD_PRIORITY_HIGH; break;
+            case ThreadRole::Worker: priority = SDL_THREAD_PRIORITY_NORMAL; break;
+        }
+        if (SDL_SetThreadPriority(priority) != 0)
+        {
+            static std::once_flag logged;
+            std::call_once(logged, [] { LOG_INFO("Thread priorities stay as they were: ", SDL_GetError()); });
+        }
+    }
+
+    int PhysicalCoreCount()
+    {
+        return static_cast<int>(cores().size());
+    }
+
+    bool PinToCore(int core)
+    {
+        const std::vector<CoreMask>& found = cores();
+        if (found.empty() || core < 0)
+            return false;
+        return pin_to(found[static_cast<std::size_t>(core) % found.size()]);
+    }
+}
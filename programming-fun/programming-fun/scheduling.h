@@ -0,0 +1,44 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+/**
+ * How the OS schedules this process's threads: the system timer's granularity, each thread's priority and,
+ * optionally, which physical core a worker runs on.
+ *
+ * Windows ticks its scheduler every 15.6 ms by default, so SDL_Delay(1) and every timed wait can oversleep a
+ * whole tick, which breaks FramePacer's target rate and the audio threads' service periods. SetFineTimer asks
+ * for 1 ms with timeBeginPeriod while the app is on screen and gives it back when it's hidden, since the finer
+ * tick costs the whole system power. Other systems already time in microseconds and ignore it.
+ *
+ * SetThreadRole maps a role onto SDL_SetThreadPriority: the audio threads time critical, since a late refill
+ * is a click, and the render thread high, since it holds up the swap. Workers stay normal: the main thread
+ * waits on their frame jobs, so a lower priority would leave it waiting behind anything else on the machine.
+ * The OS may refuse (Linux without rtkit); that's logged once and otherwise harmless.
+ *
+ * PinToCore keeps a thread on one physical core, both SMT siblings of it, as found through
+ * GetLogicalProcessorInformationEx on Windows and sysfs on Linux; without a known topology it does nothing.
+ */
+namespace scheduling
+{
+    enum class ThreadRole
+    {
+        Audio,
+        Render,
+        Worker
+    };
+
+    // Main thread; cheap when nothing changes
+    void SetFineTimer(bool fine);
+    // For the calling thread
+    void SetThreadRole(ThreadRole role);
+    // 0 when the topology isn't known
+    int PhysicalCoreCount();
+    // The calling thread onto physical core `core` modulo the count; false when it couldn't be
+    bool PinToCore(int core);
+}
@@ -0,0 +1,507 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "sdf_font.h"
+
+#include "asset_pack.h"
+#include "asset_paths.h"
+#include "logger.h"
+#include "mapped_file.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+// ImGui compiles its own static copies for the font atlas, so we keep ours private to this file too;
+// third party code, and being static, every function we don't call is a warning
+#if defined(_MSC_VER)
+#    pragma warning(push, 0)
+#elif defined(__GNUC__)
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <imstb_truetype.h>
+
+#if defined(_MSC_VER)
+#    pragma warning(pop)
+#elif defined(__GNUC__)
+#    pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+    constexpr unsigned char ON_EDGE          = 128;
+    constexpr float         PIXEL_DIST_SCALE = static_cast<float>(ON_EDGE) / static_cast<float>(SdfFont::PADDING);
+    // the frames in flight and the one being recorded; a page drawn from since then isn't evicted
+    constexpr std::uint64_t RETIRE_UPDATES = 4;
+    constexpr char32_t      REPLACEMENT    = 0xFFFD;
+
+    // where a font is likely to be when the assets have none
+    std::vector<std::filesystem::path> system_fonts()
+    {
+        std::vector<std::filesystem::path> fonts;
+#if defined(_WIN32)
+        const char*                 windows = std::getenv("WINDIR");
+        const std::filesystem::path folder  = std::filesystem::path{ windows != nullptr ? windows : "C:\\Windows" } / "Fonts";
+        fonts.push_back(folder / "segoeui.ttf");
+        fonts.push_back(folder / "arial.ttf");
+#elif defined(__APPLE__)
+        fonts.emplace_back("/System/Library/Fonts/Supplemental/Arial.ttf");
+        fonts.emplace_back("/Library/Fonts/Arial.ttf");
+#elif !defined(__EMSCRIPTEN__)
+        fonts.emplace_back("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+        fonts.emplace_back("/usr/share/fonts/TTF/DejaVuSans.ttf");
+        fonts.emplace_back("/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf");
+#endif
+        return fonts;
+    }
+
+    // the code point at `at`, which moves past it; a malformed sequence is a replacement character a byte
+    char32_t next_character(std::string_view text, std::size_t& at) noexcept
+    {
+        const auto lead = static_cast<unsigned char>(text[at++]);
+        if (lead < 0x80)
+            return lead;
+        const int length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0; // continuation bytes
+        if (length == 0 || lead > 0xF4 || at + static_cast<std::size_t>(length) > text.size())
+            return REPLACEMENT;
+        char32_t character = lead & (0x3Fu >> length);
+        for (int i = 0; i < length; ++i)
+        {
+            const auto next = static_cast<unsigned char>(text[at + static_cast<std::size_t>(i)]);
+            if ((next & 0xC0) != 0x80)
+                return REPLACEMENT;
+            character = character << 6 | (next & 0x3Fu);
+        }
+        at += static_cast<std::size_t>(length);
+        return character;
+    }
+
+    void grow(AtlasRect& rect, const AtlasRect& other) noexcept
+    {
+        if (rect.width == 0)
+        {
+            rect = other;
+            return;
+        }
+        const int right  = std::max(rect.x + rect.width, other.x + other.width);
+        const int bottom = std::max(rect.y + rect.height, other.y + other.height);
+        rect.x           = std::min(rect.x, other.x);
+        rect.y           = std::min(rect.y, other.y);
+        rect.width       = right - rect.x;
+        rect.height      = bottom - rect.y;
+    }
+}
+
+// the file's bytes stay for the workers, which only read them
+struct SdfFont::Source
+{
+    std::vector<unsigned char> bytes;
+    stbtt_fontinfo             info{};
+};
+
+// the packer's context points into itself, so a page never moves once set up
+struct SdfFont::Page
+{
+    stbrp_context           context{};
+    std::vector<stbrp_node> nodes;
+    AtlasRect               dirty; // atlas texels, empty when clean
+    std::uint64_t           last_drawn = 0; // update count
+    int                     glyphs     = 0;
+    bool                    is_pinned  = false;
+};
+
+SdfFont::SdfFont()                              = default;
+SdfFont::~SdfFont()                             = default;
+SdfFont::SdfFont(SdfFont&&) noexcept            = default;
+SdfFont& SdfFont::operator=(SdfFont&&) noexcept = default;
+
+bool SdfFont::Load(const AssetPack* pack)
+{
+    const std::filesystem::path asset = get_base_path() / "fonts" / "label.ttf";
+    if (pack != nullptr && pack->IsOpen())
+    {
+        std::vector<unsigned char> storage;
+        if (const std::span<const unsigned char> bytes = pack->ReadFile(asset, storage); !bytes.empty())
+            return Load(bytes);
+    }
+    std::vector<std::filesystem::path> candidates = system_fonts();
+    candidates.insert(candidates.begin(), asset);
+    for (const std::filesystem::path& candidate : candidates)
+    {
+        // the font keeps a copy of the bytes, so the file is let go
+        MappedFile file;
+        if (std::error_code error; std::filesystem::is_regular_file(candidate, error) && file.Open(candidate) && Load(file.Bytes()))
+        {
+            std::cout << "Label font " << candidate << '\n';
+            return true;
+        }
+    }
+    LOG_WARN("No font for labels: add one as ", asset);
+    return false;
+}
+
+bool SdfFont::Load(std::span<const unsigned char> ttf)
+{
+    *this     = SdfFont{};
+    auto font = std::make_shared<Source>();
+    font->bytes.assign(ttf.begin(), ttf.end());
+    const int offset = ttf.empty() ? -1 : stbtt_GetFontOffsetForIndex(font->bytes.data(), 0);
+    if (offset < 0 || stbtt_InitFont(&font->info, font->bytes.data(), offset) == 0)
+    {
+        LOG_ERROR("Not a TrueType font (", ttf.size(), " bytes)");
+        return false;
+    }
+    source           = std::move(font);
+    scale            = stbtt_ScaleForPixelHeight(&source->info, BAKE_SIZE);
+    int ascent_units = 0;
+    int descent      = 0;
+    int gap          = 0;
+    stbtt_GetFontVMetrics(&source->info, &ascent_units, &descent, &gap);
+    ascent      = static_cast<float>(ascent_units) * scale;
+    line_height = static_cast<float>(ascent_units - descent + gap) * scale;
+    has_kerning = stbtt_GetKerningTableLength(&source->info) > 0 || source->info.gpos != 0;
+    completed   = std::make_shared<CompletionQueue>();
+
+    // a texel between glyphs so bilinear filtering never reads a neighbour, and the last row and column of a page
+    // never packed so nothing reads the next page's
+    atlas.assign(static_cast<std::size_t>(ATLAS_SIZE) * ATLAS_SIZE, 0);
+    pages = std::vector<Page>(PAGE_COUNT);
+    for (Page& page : pages)
+    {
+        page.nodes.resize(PAGE_SIZE - 1);
+        stbrp_init_target(&page.context, PAGE_SIZE - 1, PAGE_SIZE - 1, page.nodes.data(), static_cast<int>(page.nodes.size()));
+    }
+
+    // printable ASCII now, on this thread; the pages it lands on are never evicted
+    for (char32_t character = U' '; character <= U'~'; ++character)
+    {
+        if (const Glyph& glyph = glyphFor(character); glyph.has_pixels && glyph.page < 0)
+            place(rasterize(*source, glyph.character, glyph.index, scale));
+    }
+    for (Page& page : pages)
+    {
+        page.is_pinned = page.glyphs > 0;
+        page.dirty     = AtlasRect{}; // the first upload is the whole atlas
+        stats.pinned_pages += page.is_pinned ? 1 : 0;
+    }
+    stats.used_pages = stats.pinned_pages;
+    return true;
+}
+
+bool SdfFont::IsLoaded() const noexcept
+{
+    return source != nullptr;
+}
+
+const std::vector<unsigned char>& SdfFont::AtlasPixels() const noexcept
+{
+    return atlas;
+}
+
+glm::ivec2 SdfFont::AtlasSize() const noexcept
+{
+    return IsLoaded() ? glm::ivec2{ ATLAS_SIZE } : glm::ivec2{ 0 };
+}
+
+float SdfFont::LineHeight() const noexcept
+{
+    return line_height;
+}
+
+TextRunId SdfFont::Shape(std::string_view text)
+{
+    if (!IsLoaded())
+        return INVALID_RUN;
+    std::string key{ text };
+    if (const auto found = run_ids.find(key); found != run_ids.end())
+        return found->second;
+
+    Line line;
+    line.text       = key;
+    line.last_drawn = update_count;
+    layout(line, true);
+    const auto id = static_cast<TextRunId>(lines.size());
+    lines.push_back(std::move(line));
+    run_ids.emplace(std::move(key), id);
+    return id;
+}
+
+const TextRun& SdfFont::Run(TextRunId id) const noexcept
+{
+    static const TextRun EMPTY;
+    return id >= 0 && id < static_cast<TextRunId>(lines.size()) ? lines[static_cast<std::size_t>(id)].run : EMPTY;
+}
+
+int SdfFont::RunCount() const noexcept
+{
+    return static_cast<int>(lines.size());
+}
+
+void SdfFont::Update(WorkerPool& workers)
+{
+    if (!IsLoaded())
+        return;
+    ++update_count;
+    {
+        const std::lock_guard lock{ completed->mutex };
+        stats.rasterizing -= static_cast<int>(completed->finished.size());
+        stats.rasterized += completed->finished.size();
+        for (Raster& raster : completed->finished)
+            waiting.push_back(std::move(raster));
+        completed->finished.clear();
+    }
+
+    // oldest first; what finds no room stays for a later frame, when a page may have gone out of use
+    bool        has_placed = false;
+    std::size_t kept       = 0;
+    for (std::size_t i = 0; i < waiting.size(); ++i)
+    {
+        if (place(waiting[i]))
+            has_placed = true;
+        else if (kept++ != i)
+            waiting[kept - 1] = std::move(waiting[i]);
+    }
+    waiting.resize(kept);
+    // the lines nobody has drawn for a while don't ask for glyphs again, so they can't evict the ones being drawn
+    if (has_placed || has_drawn_missing)
+    {
+        for (Line& line : lines)
+        {
+            if (line.is_missing && (has_placed || !line.is_asking))
+            {
+                layout(line, line.last_drawn + RETIRE_UPDATES > update_count);
+                ++stats.relayouts;
+            }
+        }
+    }
+    has_drawn_missing = false;
+
+    std::size_t submitted = 0;
+    for (; submitted < wanted.size() && stats.rasterizing + static_cast<int>(waiting.size()) < MAX_RASTERS; ++submitted)
+    {
+        const Glyph& glyph = glyphs.at(wanted[submitted]);
+        workers.Submit([font = source, queue = completed, character = glyph.character, index = glyph.index, size = scale] {
+            Raster raster = rasterize(*font, character, index, size);
+            const std::lock_guard lock{ queue->mutex };
+            queue->finished.push_back(std::move(raster));
+        });
+        ++stats.rasterizing;
+    }
+    wanted.erase(wanted.begin(), wanted.begin() + static_cast<std::ptrdiff_t>(submitted));
+    stats.waiting    = static_cast<int>(waiting.size());
+    stats.wanted     = static_cast<int>(wanted.size());
+    stats.used_pages = static_cast<int>(std::count_if(pages.begin(), pages.end(), [](const Page& page) { return page.glyphs > 0; }));
+}
+
+void SdfFont::MarkDrawn(TextRunId id) noexcept
+{
+    if (id < 0 || id >= static_cast<TextRunId>(lines.size()))
+        return;
+    Line& line      = lines[static_cast<std::size_t>(id)];
+    line.last_drawn = update_count;
+    has_drawn_missing |= line.is_missing && !line.is_asking;
+    for (std::uint32_t bits = line.pages; bits != 0; bits &= bits - 1)
+        pages[static_cast<std::size_t>(std::countr_zero(bits))].last_drawn = update_count;
+}
+
+std::vector<AtlasRect> SdfFont::TakeDirtyRects()
+{
+    std::vector<AtlasRect> rects;
+    stats.uploaded_bytes = 0;
+    for (Page& page : pages)
+    {
+        if (page.dirty.width == 0)
+            continue;
+        rects.push_back(page.dirty);
+        stats.uploaded_bytes += static_cast<std::size_t>(page.dirty.width) * static_cast<std::size_t>(page.dirty.height);
+        page.dirty = AtlasRect{};
+    }
+    return rects;
+}
+
+int SdfFont::PendingCount() const noexcept
+{
+    return static_cast<int>(wanted.size()) + stats.rasterizing;
+}
+
+const SdfFont::Stats& SdfFont::GetStats() const noexcept
+{
+    return stats;
+}
+
+SdfFont::Raster SdfFont::rasterize(const Source& font, char32_t character, int index, float size_scale)
+{
+    Raster raster;
+    raster.character = character;
+    // null for glyphs with no outline
+    unsigned char* pixels = stbtt_GetGlyphSDF(&font.info, size_scale, index, PADDING, ON_EDGE, PIXEL_DIST_SCALE, &raster.width, &raster.height, &raster.x, &raster.y);
+    if (pixels != nullptr)
+        raster.pixels.assign(pixels, pixels + static_cast<std::size_t>(raster.width) * static_cast<std::size_t>(raster.height));
+    stbtt_FreeSDF(pixels, nullptr);
+    return raster;
+}
+
+SdfFont::Glyph& SdfFont::glyphFor(char32_t character)
+{
+    if (const auto found = glyphs.find(character); found != glyphs.end())
+        return found->second;
+    // 0 is the font's missing glyph
+    const int index = stbtt_FindGlyphIndex(&source->info, static_cast<int>(character));
+    if (index == 0 && character != U'?')
+        return glyphFor(U'?');
+    int advance = 0;
+    int bearing = 0;
+    stbtt_GetGlyphHMetrics(&source->info, index, &advance, &bearing);
+    Glyph glyph;
+    glyph.character  = character;
+    glyph.index      = index;
+    glyph.advance    = static_cast<float>(advance) * scale;
+    glyph.has_pixels = stbtt_IsGlyphEmpty(&source->info, index) == 0;
+    return glyphs.emplace(character, glyph).first->second;
+}
+
+void SdfFont::layout(Line& line, bool is_wanted)
+{
+    TextRun& run = line.run;
+    run.glyphs.clear();
+    line.pages      = 0;
+    line.is_missing = false;
+    line.is_asking  = is_wanted;
+    float pen       = 0.0f;
+    int   previous  = -1;
+    for (std::size_t at = 0; at < line.text.size();)
+    {
+        Glyph& glyph = glyphFor(next_character(line.text, at));
+        if (previous >= 0 && has_kerning)
+            pen += static_cast<float>(stbtt_GetGlyphKernAdvance(&source->info, previous, glyph.index)) * scale;
+        if (glyph.page >= 0)
+        {
+            GlyphQuad& quad = run.glyphs.emplace_back(glyph.quad);
+            quad.offset.x += pen;
+            line.pages |= 1u << glyph.page;
+        }
+        else if (glyph.has_pixels)
+        {
+            // spaced as it will be, and drawn once it lands
+            line.is_missing = true;
+            if (is_wanted && !glyph.is_requested)
+            {
+                wanted.push_back(glyph.character);
+                glyph.is_requested = true;
+            }
+        }
+        pen += glyph.advance;
+        previous = glyph.index;
+    }
+    run.width = pen;
+}
+
+bool SdfFont::place(const Raster& raster)
+{
+    Glyph& glyph       = glyphs.at(raster.character);
+    glyph.is_requested = false;
+    if (raster.pixels.empty() || raster.width + 1 > PAGE_SIZE - 1 || raster.height + 1 > PAGE_SIZE - 1)
+    {
+        if (!raster.pixels.empty())
+            LOG_WARN("Character ", static_cast<std::uint32_t>(raster.character), "'s glyph is bigger than an atlas page");
+        glyph.has_pixels = false;
+        return true;
+    }
+    stbrp_rect rect{ 0, raster.width + 1, raster.height + 1, 0, 0, 0 };
+    int        chosen = -1;
+    for (std::size_t i = 0; i < pages.size() && chosen < 0; ++i)
+    {
+        if (stbrp_pack_rects(&pages[i].context, &rect, 1) == 1)
+            chosen = static_cast<int>(i);
+    }
+    if (chosen < 0)
+    {
+        // the page longest out of use; frames in flight may still draw from the recent ones
+        std::uint64_t oldest = ~std::uint64_t{ 0 };
+        for (std::size_t i = 0; i < pages.size(); ++i)
+        {
+            const Page& page = pages[i];
+            if (!page.is_pinned && page.last_drawn + RETIRE_UPDATES <= update_count && page.last_drawn < oldest)
+            {
+                chosen = static_cast<int>(i);
+                oldest = page.last_drawn;
+            }
+        }
+        if (chosen < 0)
+        {
+            glyph.is_requested = true;
+            return false;
+        }
+        evict(chosen);
+        stbrp_pack_rects(&pages[static_cast<std::size_t>(chosen)].context, &rect, 1);
+    }
+
+    Page&     page = pages[static_cast<std::size_t>(chosen)];
+    const int x    = (chosen % PAGES_ACROSS) * PAGE_SIZE + rect.x;
+    const int y    = (chosen / PAGES_ACROSS) * PAGE_SIZE + rect.y;
+    for (int row = 0; row < raster.height; ++row)
+    {
+        std::memcpy(&atlas[static_cast<std::size_t>(y + row) * ATLAS_SIZE + static_cast<std::size_t>(x)], raster.pixels.data() + static_cast<std::size_t>(row) * static_cast<std::size_t>(raster.width),
+                    static_cast<std::size_t>(raster.width));
+    }
+    grow(page.dirty, AtlasRect{ x, y, raster.width, raster.height });
+    // so it isn't evicted before the lines waiting for it draw
+    page.last_drawn = update_count;
+    ++page.glyphs;
+    ++stats.glyphs;
+
+    const glm::vec2 texel = glm::vec2{ 1.0f / static_cast<float>(ATLAS_SIZE) };
+    const glm::vec2 corner{ static_cast<float>(x), static_cast<float>(y) };
+    glyph.page         = chosen;
+    glyph.quad.offset  = glm::vec2{ static_cast<float>(raster.x), static_cast<float>(raster.y) + ascent };
+    glyph.quad.size    = glm::vec2{ static_cast<float>(raster.width), static_cast<float>(raster.height) };
+    glyph.quad.uv_rect = glm::vec4{ corner * texel, (corner + glyph.quad.size) * texel };
+    return true;
+}
+
+void SdfFont::evict(int page_index)
+{
+    Page& page = pages[static_cast<std::size_t>(page_index)];
+    for (auto& [character, glyph] : glyphs)
+    {
+        if (glyph.page == page_index)
+            glyph.page = -1;
+    }
+    // the lines drawing from it lay out again, asking for what they still need
+    const std::uint32_t bit = 1u << page_index;
+    for (Line& line : lines)
+    {
+        if ((line.pages & bit) != 0)
+        {
+            line.is_missing = true;
+            line.is_asking  = false;
+        }
+    }
+    stats.glyphs -= page.glyphs;
+    stats.evicted_glyphs += static_cast<std::uint64_t>(page.glyphs);
+    ++stats.evicted_pages;
+    page.glyphs = 0;
+    stbrp_init_target(&page.context, PAGE_SIZE - 1, PAGE_SIZE - 1, page.nodes.data(), static_cast<int>(page.nodes.size()));
+
+    // cleared, so the texels around the next glyphs are empty again
+    const int x = (page_index % PAGES_ACROSS) * PAGE_SIZE;
+    const int y = (page_index / PAGES_ACROSS) * PAGE_SIZE;
+    for (int row = 0; row < PAGE_SIZE; ++row)
+        std::memset(&atlas[static_cast<std::size_t>(y + row) * ATLAS_SIZE + static_cast<std::size_t>(x)], 0, PAGE_SIZE);
+    page.dirty = AtlasRect{ x, y, PAGE_SIZE, PAGE_SIZE };
+}
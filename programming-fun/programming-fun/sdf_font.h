@@ -0,0 +1,200 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class AssetPack;
+class WorkerPool;
+
+// One glyph of a laid out line, in pixels at SdfFont::BAKE_SIZE from the line's top left
+struct GlyphQuad
+{
+    glm::vec2 offset{ 0.0f };
+    glm::vec2 size{ 0.0f };
+    glm::vec4 uv_rect{ 0.0f }; // u0, v0, u1, v1
+};
+
+struct TextRun
+{
+    std::vector<GlyphQuad> glyphs; // only the ones with pixels, so no spaces
+    float                  width = 0.0f;
+};
+
+using TextRunId = int;
+
+// Texels of the atlas that changed, to upload
+struct AtlasRect
+{
+    int x      = 0;
+    int y      = 0;
+    int width  = 0;
+    int height = 0;
+};
+
+/**
+ * A TrueType font rasterized into a signed distance field atlas as its glyphs are first used, and the lines
+ * laid out with it.
+ *
+ * Each glyph's distances are baked at BAKE_SIZE with PADDING texels of reach outside the outline, 128 on
+ * the edge, into a single channel atlas; the one atlas then draws crisp text at any size with bilinear
+ * filtering, unlike a bitmap font that needs a bake per size. Printable ASCII is baked by Load and stays;
+ * any other character is rasterized on a worker the first time Shape meets it, so a CJK font costs the
+ * glyphs the text uses rather than tens of thousands of them up front. Characters the font lacks lay out as
+ * '?'. The atlas is a fixed ATLAS_SIZE square of PAGE_SIZE pages, each packed on its own; when a finished
+ * glyph fits none of them, the page least recently drawn from gives its glyphs up and is cleared for it,
+ * unless it was drawn from in the last few frames, which may still be in flight, in which case the glyph
+ * waits. Glyphs are packed and evicted a page at a time because the packer can't free single rects.
+ *
+ * Shape lays a line out once, kerning and all, and hands back the same id for the same text from then on,
+ * so labels that don't change cost a lookup a frame instead of a layout. A line whose glyphs are still on
+ * the workers lays out without them, spaced as it will be; Update lays it out again, same id, once they
+ * land, and again when a page it drew from is evicted. MarkDrawn says which lines a frame drew, and
+ * TakeDirtyRects which texels to upload. Main thread; the workers only read the font file, which is kept.
+ */
+class SdfFont
+{
+public:
+    static constexpr float     BAKE_SIZE   = 48.0f; // pixel height the distances are baked at
+    static constexpr int       PADDING     = 6;     // texels of distance around each glyph
+    static constexpr TextRunId INVALID_RUN = -1;
+    static constexpr int       ATLAS_SIZE  = 2048;
+    static constexpr int       PAGE_SIZE   = 512;
+    static constexpr int       MAX_RASTERS = 64; // glyphs on the workers or waiting for room
+
+    struct Stats
+    {
+        int           glyphs         = 0; // in the atlas
+        int           pinned_pages   = 0; // ASCII's, never evicted
+        int           used_pages     = 0;
+        int           rasterizing    = 0; // on the workers
+        int           waiting        = 0; // rasterized, with every page drawn from too recently to evict
+        int           wanted         = 0; // not submitted yet
+        std::uint64_t rasterized     = 0;
+        std::uint64_t evicted_pages  = 0;
+        std::uint64_t evicted_glyphs = 0;
+        std::uint64_t relayouts      = 0;
+        std::size_t   uploaded_bytes = 0; // by the latest TakeDirtyRects
+    };
+
+    SdfFont();
+    ~SdfFont();
+
+    SdfFont(const SdfFont&)                = delete;
+    SdfFont& operator=(const SdfFont&)     = delete;
+    SdfFont(SdfFont&&) noexcept;
+    SdfFont& operator=(SdfFont&&) noexcept;
+
+    // `fonts/label.ttf` under the asset root, from the pack when it has it, else a common system font; false and logged when there is none
+    bool Load(const AssetPack* pack);
+    bool Load(std::span<const unsigned char> ttf);
+    bool IsLoaded() const noexcept;
+
+    const std::vector<unsigned char>& AtlasPixels() const noexcept; // one byte a texel, rows top down
+    glm::ivec2                        AtlasSize() const noexcept;
+    float                             LineHeight() const noexcept; // at BAKE_SIZE
+
+    // Lays out one UTF-8 line, or finds it laid out already; characters not in the atlas yet are asked for
+    TextRunId      Shape(std::string_view text);
+    const TextRun& Run(TextRunId id) const noexcept;
+    int            RunCount() const noexcept;
+
+    // Once a frame, before drawing: packs the glyphs the workers finished, lays out again the lines that were
+    // waiting for them or lost theirs, and submits the glyphs asked for since
+    void Update(WorkerPool& workers);
+    // The line was drawn this frame, so the pages it uses aren't evicted for a while
+    void MarkDrawn(TextRunId id) noexcept;
+    // The atlas texels written since the last call, a rect per page at most; the runs use them already
+    std::vector<AtlasRect> TakeDirtyRects();
+    // Glyphs asked for and not in the atlas yet, not counting the ones waiting for room
+    int          PendingCount() const noexcept;
+    const Stats& GetStats() const noexcept;
+
+private:
+    static constexpr int PAGES_ACROSS = ATLAS_SIZE / PAGE_SIZE;
+    static constexpr int PAGE_COUNT   = PAGES_ACROSS * PAGES_ACROSS;
+
+    struct Source;
+
+    struct Glyph
+    {
+        GlyphQuad quad;
+        char32_t  character    = 0; // its key
+        int       index        = 0; // in the font
+        float     advance      = 0.0f;
+        int       page         = -1; // -1 while not in the atlas
+        bool      has_pixels   = false;
+        bool      is_requested = false; // wanted, on a worker or waiting for room
+    };
+
+    struct Raster
+    {
+        char32_t                   character = 0;
+        std::vector<unsigned char> pixels; // empty for a glyph with no outline
+        int                        width  = 0;
+        int                        height = 0;
+        int                        x      = 0; // of the top left, from the pen on the baseline
+        int                        y      = 0;
+    };
+
+    struct CompletionQueue
+    {
+        std::mutex          mutex;
+        std::vector<Raster> finished;
+    };
+
+    struct Page;
+
+    struct Line
+    {
+        std::string   text;
+        TextRun       run;
+        std::uint32_t pages      = 0; // bit per page its glyphs are on
+        std::uint64_t last_drawn = 0; // update count, or when it was shaped
+        bool          is_missing = false; // some glyphs weren't in the atlas when it was laid out
+        bool          is_asking  = false; // and it asked for them
+    };
+
+    static Raster rasterize(const Source& font, char32_t character, int index, float size_scale);
+
+    Glyph& glyphFor(char32_t character);
+    // asks for the glyphs that aren't in the atlas when `is_wanted`; a line nobody draws doesn't
+    void   layout(Line& line, bool is_wanted);
+    // false when every page was drawn from too recently to make room
+    bool   place(const Raster& raster);
+    void   evict(int page);
+
+private:
+    std::shared_ptr<const Source>              source; // shared with the rasterizing jobs
+    float                                      scale       = 0.0f;
+    float                                      ascent      = 0.0f; // at BAKE_SIZE
+    float                                      line_height = 0.0f;
+    bool                                       has_kerning = false;
+    std::unordered_map<char32_t, Glyph>        glyphs;
+    std::vector<unsigned char>                 atlas;
+    std::vector<Page>                          pages;
+    std::vector<Line>                          lines;
+    std::unordered_map<std::string, TextRunId> run_ids;
+    std::vector<char32_t>                      wanted;
+    std::vector<Raster>                        waiting;
+    std::shared_ptr<CompletionQueue>           completed;
+    std::uint64_t                              update_count      = 0;
+    bool                                       has_drawn_missing = false; // a line that doesn't ask for its glyphs was drawn
+    Stats                                      stats;
+};
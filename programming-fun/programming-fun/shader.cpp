@@ -0,0 +1,517 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "shader.h"
+
+#include "asset_paths.h"
+#include "error.h"
+#include "gl_extensions.h"
+#include "gl_state.h"
+#include "logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // magic, version, source hash, binary format, driver string length, binary length; then the string and the binary
+    constexpr char          CACHE_MAGIC[4] = { 'P', 'F', 'S', 'B' };
+    constexpr std::uint32_t CACHE_VERSION  = 1;
+    constexpr std::size_t   HEADER_SIZE    = 28;
+
+    // GL_COMPLETION_STATUS_KHR, which GL_ARB_parallel_shader_compile shares
+    constexpr GLenum COMPLETION_STATUS = 0x91B1;
+
+    struct ShaderCache
+    {
+        std::filesystem::path directory;
+        std::string           driver;
+        bool                  is_configured = false; // SetDirectory was called
+        bool                  is_checked    = false; // the first build looked at the context
+        bool                  is_enabled    = false;
+        shader_cache::Stats   stats;
+        std::vector<GLuint>   compiling; // programs the driver's threads haven't finished
+        std::atomic<int>      pending = 0; // compiling.size(), for other threads
+    };
+
+    ShaderCache cache;
+
+    constexpr std::uint64_t fnv1a(std::uint64_t hash, std::string_view text) noexcept
+    {
+        for (const char c : text)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    // what one program is built from; a compute program leaves the vertex and fragment sources empty
+    struct Sources
+    {
+        std::string_view             preamble;
+        std::string_view             vertex;
+        std::string_view             fragment;
+        std::string_view             compute;
+        std::span<const char* const> varyings; // transform feedback, interleaved
+    };
+
+    // the NUL keeps "ab" + "c" apart from "a" + "bc"; a plain program hashes as it did before compute and feedback
+    std::uint64_t source_hash(const Sources& sources) noexcept
+    {
+        constexpr std::string_view separator{ "\0", 1 };
+        std::uint64_t              hash = fnv1a(0xcbf29ce484222325ull, sources.preamble);
+        hash                            = fnv1a(hash, separator);
+        hash                            = fnv1a(hash, sources.vertex);
+        hash                            = fnv1a(hash, separator);
+        hash                            = fnv1a(hash, sources.fragment);
+        if (!sources.compute.empty())
+            hash = fnv1a(fnv1a(hash, std::string_view{ "\0compute\0", 9 }), sources.compute);
+        for (const char* varying : sources.varyings)
+            hash = fnv1a(fnv1a(hash, separator), varying);
+        return hash;
+    }
+
+    std::string gl_string(GLenum name)
+    {
+        const auto* text = reinterpret_cast<const char*>(glGetString(name));
+        return text != nullptr ? text : "";
+    }
+
+    std::filesystem::path file_for(std::uint64_t key)
+    {
+        char name[24] = {};
+        for (int i = 0; i < 16; ++i)
+            name[i] = "0123456789abcdef"[(key >> (60 - 4 * i)) & 0xf];
+        std::memcpy(name + 16, ".bin", 4);
+        return cache.directory / name;
+    }
+
+    template <typename T>
+    void write_at(std::vector<unsigned char>& bytes, std::size_t offset, T value) noexcept
+    {
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+
+    template <typename T>
+    T read_at(const std::vector<unsigned char>& bytes, std::size_t offset) noexcept
+    {
+        T value{};
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    void check_context()
+    {
+        cache.is_checked     = true;
+        cache.stats.parallel = has_gl_extension("GL_KHR_parallel_shader_compile") || has_gl_extension("GL_ARB_parallel_shader_compile");
+#if !defined(__EMSCRIPTEN__)
+        // as many compiler threads as the driver likes; WebGL has no such call and picks for itself
+        if (glMaxShaderCompilerThreadsKHR != nullptr)
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        else if (glMaxShaderCompilerThreadsARB != nullptr)
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+        if (!cache.is_configured)
+            cache.directory = get_base_path().parent_path() / "shader_cache";
+        if (cache.directory.empty())
+            return;
+        GLint formats = 0;
+        if (glGetProgramBinary != nullptr && glProgramBinary != nullptr)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (formats <= 0)
+        {
+            std::cout << "Shader cache: off, the driver offers no program binary formats\n";
+            return;
+        }
+        std::error_code error;
+        std::filesystem::create_directories(cache.directory, error);
+        if (error)
+        {
+            LOG_WARN("Shader cache: off, can't make ", cache.directory, ": ", error.message());
+            return;
+        }
+        cache.driver     = gl_string(GL_VENDOR) + '\n' + gl_string(GL_RENDERER) + '\n' + gl_string(GL_VERSION);
+        cache.is_enabled = true;
+        std::cout << "Shader cache: " << cache.directory << '\n';
+#endif
+    }
+
+    // 0 on a miss; a file for another driver or source counts as rejected and is overwritten after the compile
+    GLuint load_binary([[maybe_unused]] std::uint64_t key)
+    {
+#if defined(__EMSCRIPTEN__)
+        return 0;
+#else
+        std::ifstream file{ file_for(key), std::ios::binary | std::ios::ate };
+        if (!file)
+            return 0;
+        const auto                 file_size = static_cast<std::size_t>(file.tellg());
+        std::vector<unsigned char> bytes(file_size);
+        file.seekg(0);
+        if (file_size < HEADER_SIZE || !file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(file_size)))
+        {
+            ++cache.stats.rejected;
+            return 0;
+        }
+        const auto driver_length = read_at<std::uint32_t>(bytes, 20);
+        const auto binary_length = read_at<std::uint32_t>(bytes, 24);
+        const bool matches       = std::memcmp(bytes.data(), CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 && read_at<std::uint32_t>(bytes, 4) == CACHE_VERSION &&
+                             read_at<std::uint64_t>(bytes, 8) == key && file_size == HEADER_SIZE + std::size_t{ driver_length } + binary_length &&
+                             std::string_view{ reinterpret_cast<const char*>(bytes.data()) + HEADER_SIZE, driver_length } == cache.driver;
+        if (!matches)
+        {
+            ++cache.stats.rejected;
+            return 0;
+        }
+
+        // a driver update can refuse a binary it wrote itself, so the link status is the final word
+        const GLuint program = glCreateProgram();
+        glProgramBinary(program, read_at<GLenum>(bytes, 16), bytes.data() + HEADER_SIZE + driver_length, static_cast<GLsizei>(binary_length));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE)
+        {
+            glDeleteProgram(program);
+            ++cache.stats.rejected;
+            return 0;
+        }
+        ++cache.stats.loaded;
+        return program;
+#endif
+    }
+
+    void save_binary([[maybe_unused]] std::uint64_t key, [[maybe_unused]] GLuint program)
+    {
+#if !defined(__EMSCRIPTEN__)
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+        std::vector<unsigned char> bytes(HEADER_SIZE + cache.driver.size() + static_cast<std::size_t>(length));
+        GLsizei                    written = 0;
+        GLenum                     format  = 0;
+        glGetProgramBinary(program, length, &written, &format, bytes.data() + HEADER_SIZE + cache.driver.size());
+        if (written <= 0)
+            return;
+        bytes.resize(HEADER_SIZE + cache.driver.size() + static_cast<std::size_t>(written));
+        std::memcpy(bytes.data(), CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        write_at<std::uint32_t>(bytes, 4, CACHE_VERSION);
+        write_at<std::uint64_t>(bytes, 8, key);
+        write_at<std::uint32_t>(bytes, 16, format);
+        write_at<std::uint32_t>(bytes, 20, static_cast<std::uint32_t>(cache.driver.size()));
+        write_at<std::uint32_t>(bytes, 24, static_cast<std::uint32_t>(written));
+        std::memcpy(bytes.data() + HEADER_SIZE, cache.driver.data(), cache.driver.size());
+
+        // written aside and renamed over, so a second instance never loads half a file
+        const std::filesystem::path filename  = file_for(key);
+        std::filesystem::path       temporary = filename;
+        temporary += ".tmp";
+        {
+            std::ofstream file{ temporary, std::ios::binary };
+            if (!file || !file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+            {
+                LOG_WARN("Shader cache: can't write ", temporary);
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, filename, error);
+        if (error)
+        {
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+        ++cache.stats.written;
+#endif
+    }
+
+    // adds the calling thread's share of a build to the stats
+    struct BuildTimer
+    {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+        ~BuildTimer()
+        {
+            cache.stats.total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        }
+    };
+
+    struct Build
+    {
+        GLuint        program    = 0;
+        GLuint        shaders[2] = {}; // none for a cached binary, which comes back linked
+        std::uint64_t key        = 0;
+    };
+
+    // no status query, so a parallel compiler doesn't have to finish first
+    GLuint submit_shader(GLenum type, std::string_view preamble, std::string_view source)
+    {
+        const GLchar* sources[2] = { preamble.data(), source.data() };
+        const GLint   lengths[2] = { static_cast<GLint>(preamble.size()), static_cast<GLint>(source.size()) };
+
+        const GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 2, sources, lengths);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    Build submit(const Sources& sources)
+    {
+        if (!cache.is_checked)
+            check_context();
+        Build build;
+        build.key = source_hash(sources);
+        if (cache.is_enabled && (build.program = load_binary(build.key)) != 0)
+            return build;
+
+        ++cache.stats.submitted;
+        build.program = glCreateProgram();
+        if (!sources.compute.empty())
+        {
+#if defined(__EMSCRIPTEN__) || defined(IS_WEBGL2)
+            glDeleteProgram(build.program);
+            throw_error_message("Compute programs need desktop GL 4.3");
+#else
+            build.shaders[0] = submit_shader(GL_COMPUTE_SHADER, sources.preamble, sources.compute);
+#endif
+        }
+        else
+        {
+            build.shaders[0] = submit_shader(GL_VERTEX_SHADER, sources.preamble, sources.vertex);
+            build.shaders[1] = submit_shader(GL_FRAGMENT_SHADER, sources.preamble, sources.fragment);
+        }
+        for (const GLuint shader : build.shaders)
+        {
+            if (shader != 0)
+                glAttachShader(build.program, shader);
+        }
+        // names the captured outputs before the link, which is where they take effect
+        if (!sources.varyings.empty())
+            glTransformFeedbackVaryings(build.program, static_cast<GLsizei>(sources.varyings.size()), sources.varyings.data(), GL_INTERLEAVED_ATTRIBS);
+#if !defined(__EMSCRIPTEN__)
+        if (cache.is_enabled)
+            glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+        glLinkProgram(build.program);
+        return build;
+    }
+
+    // only asked with a parallel compiler; anywhere else this blocks until the link is done
+    bool is_compiled(GLuint program)
+    {
+        GLint done = GL_FALSE;
+        glGetProgramiv(program, COMPLETION_STATUS, &done);
+        return done != GL_FALSE;
+    }
+
+    bool is_built(const Build& build)
+    {
+        return build.shaders[0] == 0 || !cache.stats.parallel || is_compiled(build.program);
+    }
+
+    void forget_compiling(GLuint program)
+    {
+        std::erase(cache.compiling, program);
+        cache.pending = static_cast<int>(cache.compiling.size());
+    }
+
+    // checks the compiles and the link, throwing with the first log that failed, then caches the binary
+    void delete_shaders(const GLuint (&shaders)[2])
+    {
+        for (const GLuint shader : shaders)
+        {
+            if (shader != 0)
+                glDeleteShader(shader);
+        }
+    }
+
+    const char* stage_name(GLuint shader)
+    {
+        GLint type = 0;
+        glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+        switch (type)
+        {
+            case GL_VERTEX_SHADER: return "vertex";
+            case GL_FRAGMENT_SHADER: return "fragment";
+            default: return "compute";
+        }
+    }
+
+    GLuint finish(Build& build)
+    {
+        if (build.shaders[0] == 0)
+            return build.program;
+        const Build built = std::exchange(build, Build{});
+        const auto  fail  = [&built](const std::string& log, auto... what)
+        {
+            delete_shaders(built.shaders);
+            glDeleteProgram(built.program);
+            throw_error_message(what..., log);
+        };
+        for (const GLuint shader : built.shaders)
+        {
+            if (shader == 0)
+                continue;
+            GLint compiled = GL_FALSE;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+            if (compiled == GL_FALSE)
+            {
+                GLint length = 0;
+                glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+                std::string log(static_cast<std::size_t>(length), '\0');
+                glGetShaderInfoLog(shader, length, nullptr, log.data());
+                fail(log, "Failed to compile ", stage_name(shader), " shader:\n");
+            }
+        }
+        GLint linked = GL_FALSE;
+        glGetProgramiv(built.program, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE)
+        {
+            GLint length = 0;
+            glGetProgramiv(built.program, GL_INFO_LOG_LENGTH, &length);
+            std::string log(static_cast<std::size_t>(length), '\0');
+            glGetProgramInfoLog(built.program, length, nullptr, log.data());
+            fail(log, "Failed to link shader program:\n");
+        }
+        delete_shaders(built.shaders);
+        ++cache.stats.compiled;
+        if (cache.is_enabled)
+            save_binary(built.key, built.program);
+        return built.program;
+    }
+}
+
+std::string_view glsl_preamble() noexcept
+{
+#if defined(IS_WEBGL2)
+    return "#version 300 es\nprecision highp float;\nprecision highp int;\n";
+#else
+    return "#version 330 core\n";
+#endif
+}
+
+GLuint compile_program(std::string_view vertex_source, std::string_view fragment_source)
+{
+    const BuildTimer timer;
+    Build            build = submit(Sources{ glsl_preamble(), vertex_source, fragment_source, {}, {} });
+    return finish(build);
+}
+
+ShaderProgram::~ShaderProgram()
+{
+    Reset();
+}
+
+void ShaderProgram::Request(std::string_view vertex_source, std::string_view fragment_source, std::string_view preamble)
+{
+    request(preamble, vertex_source, fragment_source, {}, {});
+}
+
+void ShaderProgram::RequestFeedback(std::string_view vertex_source, std::string_view fragment_source, std::span<const char* const> varyings)
+{
+    request(glsl_preamble(), vertex_source, fragment_source, {}, varyings);
+}
+
+void ShaderProgram::RequestCompute(std::string_view compute_source, std::string_view preamble)
+{
+    request(preamble, {}, {}, compute_source, {});
+}
+
+bool ShaderProgram::Poll()
+{
+    if (is_ready || program == 0)
+        return is_ready;
+    Build build{ program, { shaders[0], shaders[1] }, key };
+    if (!is_built(build))
+        return false;
+    const BuildTimer timer;
+    // a failed build throws with this one emptied, so it isn't polled again
+    program    = 0;
+    shaders[0] = 0;
+    shaders[1] = 0;
+    forget_compiling(build.program);
+    program  = finish(build);
+    is_ready = true;
+    return true;
+}
+
+bool ShaderProgram::IsReady() const noexcept
+{
+    return is_ready;
+}
+
+GLuint ShaderProgram::Id() const noexcept
+{
+    return is_ready ? program : 0;
+}
+
+void ShaderProgram::request(std::string_view preamble, std::string_view vertex_source, std::string_view fragment_source, std::string_view compute_source,
+                            std::span<const char* const> varyings)
+{
+    Reset();
+    const BuildTimer timer;
+    const Build      build = submit(Sources{ preamble, vertex_source, fragment_source, compute_source, varyings });
+    program                = build.program;
+    shaders[0]             = build.shaders[0];
+    shaders[1]             = build.shaders[1];
+    key                    = build.key;
+    if (shaders[0] != 0 && cache.stats.parallel)
+    {
+        cache.compiling.push_back(program);
+        cache.pending = static_cast<int>(cache.compiling.size());
+    }
+}
+
+void ShaderProgram::Reset()
+{
+    forget_compiling(program);
+    delete_shaders(shaders);
+    gl_state::DeleteProgram(program);
+    program    = 0;
+    shaders[0] = 0;
+    shaders[1] = 0;
+    key        = 0;
+    is_ready   = false;
+}
+
+namespace shader_cache
+{
+    void SetDirectory(std::filesystem::path directory)
+    {
+        cache.directory     = std::move(directory);
+        cache.is_configured = true;
+    }
+
+    bool IsEnabled() noexcept
+    {
+        return cache.is_enabled;
+    }
+
+    const Stats& GetStats() noexcept
+    {
+        return cache.stats;
+    }
+
+    void Update()
+    {
+        std::erase_if(cache.compiling, is_compiled);
+        cache.pending = static_cast<int>(cache.compiling.size());
+    }
+
+    int PendingCount() noexcept
+    {
+        return cache.pending;
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+// "#version ..." plus default precision, so one GLSL body works on desktop core and IS_WEBGL2
+std::string_view glsl_preamble() noexcept;
+
+// Compiles and links a program from preamble-less sources. Throws std::runtime_error with the info log on failure.
+// Goes through the shader cache first when it's on, see below. Blocks until the program is linked; see ShaderProgram.
+GLuint compile_program(std::string_view vertex_source, std::string_view fragment_source);
+
+/**
+ * One program built without blocking, where GL_KHR_parallel_shader_compile (or the ARB one) lets the driver
+ * compile on threads of its own.
+ *
+ * Request tries the shader cache, else submits both compiles and the link, and returns at once. Poll asks
+ * GL_COMPLETION_STATUS_KHR, so a renderer can call it every frame and draw without, or with something
+ * simpler, until it says yes; that first yes checks the link, throwing like compile_program, and caches
+ * the binary. Without the extension the first Poll finishes the build, so the wait only moves from Setup
+ * to the first frame. Request everything before polling anything, so the driver has it all queued, and
+ * before the thread that draws, which does the polling and shader_cache::Update, starts.
+ */
+class ShaderProgram
+{
+public:
+    ShaderProgram() = default;
+    ~ShaderProgram();
+
+    ShaderProgram(const ShaderProgram&)                = delete;
+    ShaderProgram& operator=(const ShaderProgram&)     = delete;
+    ShaderProgram(ShaderProgram&&) noexcept            = delete;
+    ShaderProgram& operator=(ShaderProgram&&) noexcept = delete;
+
+    // Drops any program this one had. A `preamble` of its own is for programs that need extensions the default lacks.
+    void Request(std::string_view vertex_source, std::string_view fragment_source, std::string_view preamble = glsl_preamble());
+    // The same, capturing `varyings` interleaved in that order into transform feedback buffer 0
+    void RequestFeedback(std::string_view vertex_source, std::string_view fragment_source, std::span<const char* const> varyings);
+    // A compute program; `preamble` names the version, 430 or one with GL_ARB_compute_shader
+    void RequestCompute(std::string_view compute_source, std::string_view preamble);
+    // True once linked, and from then on; cheap to call every frame
+    bool Poll();
+    bool IsReady() const noexcept;
+    // 0 until it's ready
+    GLuint Id() const noexcept;
+    void   Reset();
+
+private:
+    // a compute program leaves `vertex_source` and `fragment_source` empty
+    void request(std::string_view preamble, std::string_view vertex_source, std::string_view fragment_source, std::string_view compute_source,
+                 std::span<const char* const> varyings);
+
+private:
+    GLuint        program    = 0;
+    GLuint        shaders[2] = {}; // until the build is finished; none for a cached binary
+    std::uint64_t key        = 0;
+    bool          is_ready   = false;
+};
+
+/**
+ * Linked program binaries kept between runs, so a launch after the first skips the GLSL compiler.
+ *
+ * compile_program and ShaderProgram name each program by an FNV-1a hash of the preamble and both sources,
+ * and store what glGetProgramBinary returns under that name together with the GL vendor, renderer and
+ * version strings. A later run loads it with glProgramBinary; a file from another driver, or one the driver
+ * refuses, is compiled from source again and overwritten. Off where the context offers no binary formats,
+ * and always under Emscripten since WebGL has no program binaries. Builds go one thread at a time: setup
+ * on the main thread, polling on whichever thread draws.
+ */
+namespace shader_cache
+{
+    struct Stats
+    {
+        int    loaded    = 0;   // linked from a cached binary
+        int    submitted = 0;   // compiles started from source
+        int    compiled  = 0;   // and finished
+        int    rejected  = 0;   // cached for another driver or source, or refused
+        int    written   = 0;   // binaries saved
+        double total_ms  = 0.0; // on the calling threads, either way; parallel compiles take theirs elsewhere
+        bool   parallel  = false;
+    };
+
+    // Before the first program is built; an empty path turns the cache off.
+    // Defaults to "shader_cache" next to the assets folder.
+    void SetDirectory(std::filesystem::path directory);
+
+    // Only meaningful after the first program build, which checks the context
+    bool         IsEnabled() noexcept;
+    const Stats& GetStats() noexcept;
+    // Once a frame on the thread that draws: notes which parallel compiles the driver has finished
+    void Update();
+    // Parallel compiles not finished as of the last Update, so frames drawn now are missing something; safe from any thread
+    int PendingCount() noexcept;
+}
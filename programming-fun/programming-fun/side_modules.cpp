@@ -0,0 +1,85 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "side_modules.h"
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#if defined(__EMSCRIPTEN__) && SIDE_MODULES
+#    include <dlfcn.h>
+#    include <emscripten.h>
+#    define LOADS_SIDE_MODULES 1
+#else
+#    define LOADS_SIDE_MODULES 0
+#endif
+
+namespace
+{
+    constexpr std::size_t MODULE_COUNT = static_cast<std::size_t>(SideModule::Video) + 1;
+
+    struct Module
+    {
+        ModuleState state      = LOADS_SIDE_MODULES ? ModuleState::Unloaded : ModuleState::Ready;
+        double      started_ms = 0.0;
+    };
+
+    // only the thread running the frames touches these, the dlopen callbacks included
+    std::array<Module, MODULE_COUNT> modules{};
+
+#if LOADS_SIDE_MODULES
+    void on_loaded(void* user_data, [[maybe_unused]] void* handle)
+    {
+        const auto module = static_cast<SideModule>(reinterpret_cast<std::size_t>(user_data));
+        Module&    loaded = modules[static_cast<std::size_t>(module)];
+        loaded.state      = ModuleState::Ready;
+        std::cout << side_modules::FileName(module) << " loaded in " << emscripten_get_now() - loaded.started_ms << " ms\n";
+    }
+
+    void on_failed(void* user_data)
+    {
+        const auto module = static_cast<SideModule>(reinterpret_cast<std::size_t>(user_data));
+        Module&    failed = modules[static_cast<std::size_t>(module)];
+        failed.state      = ModuleState::Failed;
+        std::cerr << "Failed to load " << side_modules::FileName(module) << ": " << dlerror() << '\n';
+    }
+#endif
+}
+
+namespace side_modules
+{
+    ModuleState Require(SideModule module)
+    {
+        Module& wanted = modules[static_cast<std::size_t>(module)];
+        if (wanted.state != ModuleState::Unloaded)
+            return wanted.state;
+#if LOADS_SIDE_MODULES
+        // https://emscripten.org/docs/compiling/Dynamic-Linking.html#runtime-dynamic-linking-with-dlopen
+        wanted.state      = ModuleState::Loading;
+        wanted.started_ms = emscripten_get_now();
+        const std::string file_name{ FileName(module) };
+        emscripten_dlopen(file_name.c_str(), RTLD_NOW | RTLD_GLOBAL, reinterpret_cast<void*>(static_cast<std::size_t>(module)), &on_loaded, &on_failed);
+#endif
+        return wanted.state;
+    }
+
+    ModuleState GetState(SideModule module) noexcept
+    {
+        return modules[static_cast<std::size_t>(module)].state;
+    }
+
+    std::string_view FileName(SideModule module) noexcept
+    {
+        switch (module)
+        {
+            case SideModule::Video: return "video.wasm";
+        }
+        return {};
+    }
+}
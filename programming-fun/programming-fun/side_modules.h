@@ -0,0 +1,48 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <string_view>
+
+// Define SIDE_MODULES=1 in a web build linked with -sMAIN_MODULE=1 and the side modules next to the page; see main.cpp
+#if !defined(SIDE_MODULES)
+#    define SIDE_MODULES 0
+#endif
+
+// Optional subsystems the web build can leave out of the first download
+enum class SideModule
+{
+    Video // video_clip and video_player, as video.wasm
+};
+
+enum class ModuleState
+{
+    Unloaded,
+    Loading,
+    Ready,
+    Failed
+};
+
+/**
+ * Subsystems fetched the first time something needs them, so the wasm the page waits for before its first frame
+ * only carries the window, GL, ImGui and what every frame runs.
+ *
+ * Require starts emscripten_dlopen on the first call, which downloads and compiles the module asynchronously,
+ * and reports Ready once it is linked in. Until then nothing may call into the module, constructors and
+ * destructors included: the main module's references to its symbols only resolve when it loads. So whoever
+ * owns one of its objects makes it after Ready, and keeps asking once a frame until then. The callbacks run on
+ * the thread that called Require, between frames. Desktop builds, and web builds without SIDE_MODULES, link
+ * everything in and are Ready from the start.
+ */
+namespace side_modules
+{
+    ModuleState      Require(SideModule module);
+    ModuleState      GetState(SideModule module) noexcept;
+    // what the page serves it as
+    std::string_view FileName(SideModule module) noexcept;
+}
@@ -0,0 +1,702 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "software_mixer.h"
+
+#include "audio_kernels.h"
+#include "logger.h"
+#include "sound_loader.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/geometric.hpp>
+#include <numbers>
+
+#if defined(PROGRAMMING_FUN_AUDIO_WORKLET)
+#    include <emscripten/html5.h>
+#    include <emscripten/webaudio.h>
+#endif
+
+// planar float at the mixer's rate
+struct SoftwareMixer::Pcm
+{
+    std::vector<float> left;
+    std::vector<float> right; // empty for mono
+};
+
+struct SoftwareMixer::Command
+{
+    enum class Type : std::uint8_t
+    {
+        Play,
+        Stop,
+        SetGain,
+        Place,
+        Listener,
+        Forget, // a removed buffer: whatever still plays it stops
+        Reverb  // `convolver` at `gain` from now on
+    };
+
+    Type          type               = Type::Play;
+    std::uint32_t voice              = 0;
+    std::uint32_t generation         = 0;
+    const Pcm*    pcm                = nullptr;
+    float         gain               = 1.0f;
+    float         pitch              = 1.0f;
+    float         offset_seconds     = 0.0f;
+    bool          looping            = false;
+    float         max_distance       = 0.0f;
+    float         reference_distance = 1.0f;
+    glm::vec3     position{ 0.0f };
+    glm::vec3     forward{ 0.0f, 0.0f, -1.0f };
+    glm::vec3     up{ 0.0f, 1.0f, 0.0f };
+    Convolver*    convolver = nullptr;
+};
+
+struct SoftwareMixer::RenderVoice
+{
+    const Pcm*    pcm                = nullptr;
+    double        cursor             = 0.0; // in frames, fractional while the pitch isn't 1
+    float         gain               = 1.0f;
+    float         pitch              = 1.0f;
+    bool          looping            = false;
+    bool          active             = false;
+    std::uint32_t generation         = 0;
+    float         max_distance       = 0.0f;
+    float         reference_distance = 1.0f;
+    glm::vec3     position{ 0.0f };
+};
+
+namespace
+{
+    // VoicePool's AL_LINEAR_DISTANCE_CLAMPED: full gain up to the reference distance, silence at the maximum
+    float distance_gain(float distance, float reference_distance, float max_distance) noexcept
+    {
+        if (distance <= reference_distance)
+            return 1.0f;
+        if (distance >= max_distance || max_distance <= reference_distance)
+            return 0.0f;
+        return 1.0f - (distance - reference_distance) / (max_distance - reference_distance);
+    }
+
+    std::vector<float> to_float_channel(const DecodedSound& sound, int channel)
+    {
+        const auto         frames = sound.samples.size() / (static_cast<std::size_t>(sound.channels) * (sound.type == SampleType::Unsigned8 ? 1u : sound.type == SampleType::Signed16 ? 2u : 4u));
+        std::vector<float> out(frames);
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            const std::size_t sample = i * static_cast<std::size_t>(sound.channels) + static_cast<std::size_t>(channel);
+            switch (sound.type)
+            {
+                case SampleType::Unsigned8: out[i] = (static_cast<float>(sound.samples[sample]) - 128.0f) / 128.0f; break;
+                case SampleType::Signed16:
+                    {
+                        std::int16_t value = 0;
+                        std::memcpy(&value, sound.samples.data() + sample * 2, sizeof(value));
+                        out[i] = static_cast<float>(value) / 32768.0f;
+                        break;
+                    }
+                case SampleType::Float32: std::memcpy(&out[i], sound.samples.data() + sample * 4, sizeof(float)); break;
+            }
+        }
+        return out;
+    }
+
+    std::vector<float> resample(std::vector<float> samples, int from, int to)
+    {
+        if (from == to)
+            return samples;
+        audio_kernels::Resampler resampler{ from, to };
+        std::vector<float>       out;
+        out.reserve(samples.size() * static_cast<std::size_t>(to) / static_cast<std::size_t>(from) + audio_kernels::Resampler::TAPS);
+        resampler.Process(samples, out);
+        resampler.Flush(out);
+        return out;
+    }
+
+#if defined(PROGRAMMING_FUN_AUDIO_WORKLET)
+    constexpr const char* PROCESSOR_NAME     = "programming-fun-mixer";
+    constexpr std::size_t WORKLET_STACK_SIZE = 16 * 1024;
+
+    alignas(16) std::uint8_t gWorkletStack[WORKLET_STACK_SIZE]; // one mixer per page
+    EMSCRIPTEN_WEBAUDIO_T    gContext = 0;
+
+    bool process(int, const AudioSampleFrame*, int output_count, AudioSampleFrame* outputs, int, const AudioParamFrame*, void* user_data)
+    {
+        if (output_count < 1 || outputs[0].numberOfChannels < 2)
+            return true;
+        float* data = outputs[0].data;
+        static_cast<SoftwareMixer*>(user_data)->Render(data, data + SoftwareMixer::QUANTUM_FRAMES, SoftwareMixer::QUANTUM_FRAMES);
+        return true;
+    }
+
+    void processor_created(EMSCRIPTEN_WEBAUDIO_T context, bool success, void* user_data)
+    {
+        if (!success)
+        {
+            LOG_ERROR("Failed to create the audio worklet processor");
+            return;
+        }
+        int                                     channels[] = { 2 };
+        EmscriptenAudioWorkletNodeCreateOptions options{ .numberOfInputs = 0, .numberOfOutputs = 1, .outputChannelCounts = channels };
+        const EMSCRIPTEN_AUDIO_WORKLET_NODE_T   node = emscripten_create_wasm_audio_worklet_node(context, PROCESSOR_NAME, &options, &process, user_data);
+        emscripten_audio_node_connect(node, context, 0, 0);
+    }
+
+    void worklet_started(EMSCRIPTEN_WEBAUDIO_T context, bool success, void* user_data)
+    {
+        if (!success)
+        {
+            LOG_ERROR("Failed to start the audio worklet thread");
+            return;
+        }
+        WebAudioWorkletProcessorCreateOptions options{ .name = PROCESSOR_NAME };
+        emscripten_create_wasm_audio_worklet_processor_async(context, &options, &processor_created, user_data);
+    }
+
+    // a context made outside a user gesture starts suspended
+    bool resume_on_click(int, const EmscriptenMouseEvent*, void*)
+    {
+        emscripten_resume_audio_context_sync(gContext);
+        return false;
+    }
+
+    bool resume_on_key(int, const EmscriptenKeyboardEvent*, void*)
+    {
+        emscripten_resume_audio_context_sync(gContext);
+        return false;
+    }
+#endif
+}
+
+SoftwareMixer::SoftwareMixer(int mixer_frequency, int voice_count)
+    : frequency{ mixer_frequency > 0 ? mixer_frequency : DEFAULT_FREQUENCY }, queue{ std::make_unique<SpscQueue<Command, QUEUE_CAPACITY>>() }
+{
+    const auto count = static_cast<std::size_t>(std::clamp(voice_count, 1, MAX_VOICES));
+    voices.resize(count);
+    free_voices.reserve(count);
+    for (int i = static_cast<int>(count) - 1; i >= 0; --i)
+        free_voices.push_back(i);
+    published = std::make_unique<Published[]>(count);
+    render_voices.resize(count);
+}
+
+SoftwareMixer::~SoftwareMixer()
+{
+    Close();
+}
+
+bool SoftwareMixer::Open()
+{
+    if (is_open)
+        return true;
+#if defined(PROGRAMMING_FUN_AUDIO_WORKLET)
+    EmscriptenWebAudioCreateAttributes attributes{ .latencyHint = "interactive", .sampleRate = static_cast<std::uint32_t>(frequency) };
+    gContext = emscripten_create_audio_context(&attributes);
+    if (gContext == 0)
+        return false;
+    emscripten_start_wasm_audio_worklet_thread_async(gContext, gWorkletStack, sizeof(gWorkletStack), &worklet_started, this);
+    emscripten_set_click_callback(EMSCRIPTEN_EVENT_TARGET_DOCUMENT, nullptr, false, &resume_on_click);
+    emscripten_set_keydown_callback(EMSCRIPTEN_EVENT_TARGET_DOCUMENT, nullptr, false, &resume_on_key);
+    is_open = true;
+    return true;
+#else
+    // SDL_Init only brought up video; the subsystem is reference counted, so Close can quit it again
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+    {
+        LOG_ERROR("Software mixer: no SDL audio: ", SDL_GetError());
+        return false;
+    }
+    SDL_AudioSpec desired{};
+    desired.freq     = frequency;
+    desired.format   = AUDIO_F32SYS;
+    desired.channels = 2;
+    desired.samples  = SDL_PERIOD_FRAMES;
+    desired.callback = &SoftwareMixer::sdlCallback;
+    desired.userdata = this;
+    SDL_AudioSpec obtained{};
+    // SDL converts if the device runs at another rate, so the buffers stay at `frequency`
+    device = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+    if (device == 0)
+    {
+        LOG_ERROR("Software mixer: SDL_OpenAudioDevice failed: ", SDL_GetError());
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+    // the device starts paused, so nothing reads the planes yet
+    scratch_left.assign(std::max<std::size_t>(obtained.samples, 1), 0.0f);
+    scratch_right.assign(scratch_left.size(), 0.0f);
+    is_open = true;
+    SDL_PauseAudioDevice(device, 0);
+    LOG_INFO("Software mixer on SDL audio: ", obtained.freq, " Hz, ", obtained.samples, " frame periods, ", voices.size(), " voices");
+    return true;
+#endif
+}
+
+void SoftwareMixer::Close()
+{
+    if (!is_open)
+        return;
+#if defined(PROGRAMMING_FUN_AUDIO_WORKLET)
+    emscripten_destroy_audio_context(gContext);
+    gContext = 0;
+#else
+    // waits out a callback in progress
+    SDL_CloseAudioDevice(device);
+    device = 0;
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+#endif
+    is_open = false;
+}
+
+bool SoftwareMixer::IsOpen() const noexcept
+{
+    return is_open;
+}
+
+int SoftwareMixer::Frequency() const noexcept
+{
+    return frequency;
+}
+
+SoftwareMixer::BufferId SoftwareMixer::AddBuffer(const DecodedSound& sound)
+{
+    if (sound.channels < 1 || sound.channels > 2 || sound.frequency <= 0 || sound.samples.empty())
+        return 0;
+    auto pcm  = std::make_unique<Pcm>();
+    pcm->left = resample(to_float_channel(sound, 0), sound.frequency, frequency);
+    if (sound.channels == 2)
+    {
+        pcm->right = resample(to_float_channel(sound, 1), sound.frequency, frequency);
+        pcm->right.resize(pcm->left.size());
+    }
+    buffers.push_back(std::move(pcm));
+    return static_cast<BufferId>(buffers.size());
+}
+
+void SoftwareMixer::RemoveBuffer(BufferId buffer)
+{
+    if (buffer == 0 || buffer > buffers.size() || buffers[buffer - 1] == nullptr)
+        return;
+    for (std::size_t i = 0; i < voices.size(); ++i)
+    {
+        if (voices[i].active && voices[i].buffer == buffer)
+        {
+            voices[i].active = false;
+            free_voices.push_back(static_cast<int>(i));
+            --in_use;
+        }
+    }
+    // Update sends the Forget if the queue is full now; until the render side has drained it the samples stay
+    RetiredBuffer entry{ std::move(buffers[buffer - 1]), 0 };
+    Command       forget{ .type = Command::Type::Forget, .pcm = entry.pcm.get() };
+    entry.after = push(forget) ? pushed : UINT64_MAX;
+    retired.push_back(std::move(entry));
+}
+
+VoiceId SoftwareMixer::Play(BufferId buffer, const VoiceParams& params)
+{
+    if (buffer == 0 || buffer > buffers.size() || buffers[buffer - 1] == nullptr)
+        return {};
+    int  index  = -1;
+    bool stolen = false;
+    if (!free_voices.empty())
+    {
+        index = free_voices.back();
+    }
+    else
+    {
+        index = pickVictim(params.priority);
+        if (index < 0)
+            return {};
+        stolen = true;
+    }
+
+    Voice&              voice      = voices[static_cast<std::size_t>(index)];
+    const std::uint32_t generation = VoiceId::NextGeneration(voice.generation);
+    Command             command{ .type = Command::Type::Play, .voice = static_cast<std::uint32_t>(index), .generation = generation, .pcm = buffers[buffer - 1].get() };
+    command.gain               = params.gain;
+    command.pitch              = params.pitch;
+    command.offset_seconds     = params.offset_seconds;
+    command.looping            = params.looping;
+    command.max_distance       = params.max_distance;
+    command.reference_distance = params.reference_distance;
+    command.position           = params.position;
+    // on a full queue the voice a steal picked keeps playing, as far as both sides know
+    if (!push(command))
+        return {};
+    if (stolen)
+    {
+        ++steals_this_window;
+    }
+    else
+    {
+        free_voices.pop_back();
+        ++in_use;
+    }
+    voice = Voice{ generation, ++play_count, params.gain, params.priority, buffer, true };
+    published[static_cast<std::size_t>(index)].seconds.store(0.0f, std::memory_order_relaxed);
+    return VoiceId::Make(static_cast<std::uint32_t>(index), generation);
+}
+
+void SoftwareMixer::Stop(VoiceId voice)
+{
+    if (!IsCurrent(voice))
+        return;
+    if (push(Command{ .type = Command::Type::Stop, .voice = voice.Index(), .generation = voice.Generation() }))
+    {
+        voices[voice.Index()].active = false;
+        free_voices.push_back(static_cast<int>(voice.Index()));
+        --in_use;
+    }
+}
+
+bool SoftwareMixer::IsCurrent(VoiceId voice) const noexcept
+{
+    return voice.IsValid() && voice.Index() < voices.size() && voices[voice.Index()].active && voices[voice.Index()].generation == voice.Generation();
+}
+
+void SoftwareMixer::Place(VoiceId voice, const glm::vec3& position)
+{
+    if (IsCurrent(voice))
+        push(Command{ .type = Command::Type::Place, .voice = voice.Index(), .generation = voice.Generation(), .position = position });
+}
+
+void SoftwareMixer::SetGain(VoiceId voice, float gain)
+{
+    if (IsCurrent(voice) && push(Command{ .type = Command::Type::SetGain, .voice = voice.Index(), .generation = voice.Generation(), .gain = gain }))
+        voices[voice.Index()].gain = gain;
+}
+
+void SoftwareMixer::SetListener(const glm::vec3& position, const glm::vec3& forward, const glm::vec3& up)
+{
+    push(Command{ .type = Command::Type::Listener, .position = position, .forward = forward, .up = up });
+}
+
+float SoftwareMixer::PlaybackSeconds(VoiceId voice) const
+{
+    if (!IsCurrent(voice))
+        return -1.0f;
+    return published[voice.Index()].seconds.load(std::memory_order_relaxed);
+}
+
+bool SoftwareMixer::SetImpulseResponse(const DecodedSound& response)
+{
+    if (response.channels < 1 || response.channels > 2 || response.frequency <= 0 || response.samples.empty())
+        return false;
+    const std::vector<float> left  = resample(to_float_channel(response, 0), response.frequency, frequency);
+    const std::vector<float> right = response.channels == 2 ? resample(to_float_channel(response, 1), response.frequency, frequency) : std::vector<float>{};
+    auto                     convolver = std::make_unique<Convolver>(left, right);
+    if (convolver->IsTruncated())
+        LOG_WARN("Software mixer: the impulse response is cut to ", Convolver::MAX_PARTITIONS * Convolver::BLOCK_FRAMES, " frames");
+    return setReverb(std::move(convolver), reverb_wet);
+}
+
+void SoftwareMixer::ClearImpulseResponse()
+{
+    setReverb(nullptr, reverb_wet);
+}
+
+void SoftwareMixer::SetReverbWet(float wet)
+{
+    reverb_wet = std::max(wet, 0.0f);
+    if (reverb != nullptr)
+        push(Command{ .type = Command::Type::Reverb, .gain = reverb_wet, .convolver = reverb.get() });
+}
+
+void SoftwareMixer::Update(float delta_seconds)
+{
+    for (std::size_t i = 0; i < voices.size(); ++i)
+    {
+        Voice& voice = voices[i];
+        if (voice.active && published[i].finished.load(std::memory_order_acquire) == voice.generation)
+        {
+            voice.active = false;
+            free_voices.push_back(static_cast<int>(i));
+            --in_use;
+        }
+    }
+
+    const std::uint64_t seen = drained.load(std::memory_order_acquire);
+    for (RetiredBuffer& entry : retired)
+    {
+        if (entry.after == UINT64_MAX && push(Command{ .type = Command::Type::Forget, .pcm = entry.pcm.get() }))
+            entry.after = pushed;
+    }
+    retired.erase(std::remove_if(retired.begin(), retired.end(), [seen](const RetiredBuffer& entry) { return entry.after != UINT64_MAX && seen >= entry.after; }), retired.end());
+    retired_reverbs.erase(std::remove_if(retired_reverbs.begin(), retired_reverbs.end(), [seen](const RetiredReverb& entry) { return seen >= entry.after; }), retired_reverbs.end());
+
+    window_seconds += delta_seconds;
+    if (window_seconds >= 1.0f)
+    {
+        steals_per_second  = steals_this_window;
+        steals_this_window = 0;
+        window_seconds     = 0.0f;
+    }
+}
+
+int SoftwareMixer::VoicesInUse() const noexcept
+{
+    return in_use;
+}
+
+SoftwareMixer::Stats SoftwareMixer::GetStats() const noexcept
+{
+    return Stats{ in_use,
+                  static_cast<int>(voices.size()),
+                  steals_per_second,
+                  quanta.load(std::memory_order_relaxed),
+                  dropped,
+                  render_ms.load(std::memory_order_relaxed),
+                  period_ms.load(std::memory_order_relaxed),
+                  static_cast<double>(busy_ticks.load(std::memory_order_relaxed)) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency()),
+                  late.load(std::memory_order_relaxed),
+                  reverb_ms.load(std::memory_order_relaxed),
+                  reverb != nullptr ? reverb->Partitions() : 0 };
+}
+
+void SoftwareMixer::Render(float* left, float* right, int frames) noexcept
+{
+    const Uint64  begin = SDL_GetPerformanceCounter();
+    Command       command;
+    std::uint64_t applied = 0;
+    while (queue->TryPop(command))
+    {
+        apply(command);
+        ++applied;
+    }
+    if (applied > 0)
+        drained.fetch_add(applied, std::memory_order_release);
+
+    std::fill(left, left + frames, 0.0f);
+    std::fill(right, right + frames, 0.0f);
+    for (std::size_t i = 0; i < render_voices.size(); ++i)
+    {
+        if (render_voices[i].active)
+            mixVoice(render_voices[i], i, left, right, frames);
+    }
+    if (render_reverb != nullptr && render_wet > 0.0f)
+    {
+        const Uint64 reverb_begin = SDL_GetPerformanceCounter();
+        render_reverb->Process(left, right, left, right, frames, render_wet);
+        reverb_ms.store(static_cast<float>(static_cast<double>(SDL_GetPerformanceCounter() - reverb_begin) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency())),
+                        std::memory_order_relaxed);
+    }
+    else
+    {
+        reverb_ms.store(0.0f, std::memory_order_relaxed);
+    }
+    quanta.fetch_add(1, std::memory_order_relaxed);
+    const Uint64 ticks  = SDL_GetPerformanceCounter() - begin;
+    const double took   = static_cast<double>(ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    const float  period = static_cast<float>(frames) * 1000.0f / static_cast<float>(frequency);
+    busy_ticks.fetch_add(ticks, std::memory_order_relaxed);
+    if (took > static_cast<double>(period))
+        late.fetch_add(1, std::memory_order_relaxed);
+    render_ms.store(static_cast<float>(took), std::memory_order_relaxed);
+    period_ms.store(period, std::memory_order_relaxed);
+}
+
+void SDLCALL SoftwareMixer::sdlCallback(void* user_data, Uint8* stream, int length)
+{
+    static_cast<SoftwareMixer*>(user_data)->renderInterleaved(reinterpret_cast<float*>(stream), length / static_cast<int>(2 * sizeof(float)));
+}
+
+void SoftwareMixer::renderInterleaved(float* out, int frames) noexcept
+{
+    const int piece = static_cast<int>(scratch_left.size());
+    for (int done = 0; done < frames; done += piece)
+    {
+        const int    count    = std::min(piece, frames - done);
+        const float* planes[] = { scratch_left.data(), scratch_right.data() };
+        Render(scratch_left.data(), scratch_right.data(), count);
+        audio_kernels::Interleave(planes, 2, static_cast<std::size_t>(count), out + static_cast<std::ptrdiff_t>(done) * 2);
+    }
+}
+
+bool SoftwareMixer::push(const Command& command)
+{
+    if (!queue->TryPush(command))
+    {
+        ++dropped;
+        return false;
+    }
+    ++pushed;
+    return true;
+}
+
+bool SoftwareMixer::setReverb(std::unique_ptr<Convolver> convolver, float wet)
+{
+    if (!push(Command{ .type = Command::Type::Reverb, .gain = wet, .convolver = convolver.get() }))
+        return false;
+    if (reverb != nullptr)
+        retired_reverbs.push_back(RetiredReverb{ std::move(reverb), pushed });
+    reverb = std::move(convolver);
+    return true;
+}
+
+int SoftwareMixer::pickVictim(int priority) const
+{
+    // VoicePool's rule: the lowest priority not above the request's, then the quietest, then the oldest
+    int victim = -1;
+    for (int i = 0; i < static_cast<int>(voices.size()); ++i)
+    {
+        const Voice& voice = voices[static_cast<std::size_t>(i)];
+        if (!voice.active || voice.priority > priority)
+            continue;
+        if (victim < 0)
+        {
+            victim = i;
+            continue;
+        }
+        const Voice& best = voices[static_cast<std::size_t>(victim)];
+        if (voice.priority != best.priority)
+        {
+            if (voice.priority < best.priority)
+                victim = i;
+        }
+        else if (voice.gain != best.gain)
+        {
+            if (voice.gain < best.gain)
+                victim = i;
+        }
+        else if (voice.started < best.started)
+        {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+void SoftwareMixer::apply(const Command& command) noexcept
+{
+    if (command.type == Command::Type::Listener)
+    {
+        listener_position = command.position;
+        const glm::vec3 right = glm::cross(command.forward, command.up);
+        listener_right        = glm::dot(right, right) > 0.0f ? glm::normalize(right) : glm::vec3{ 1.0f, 0.0f, 0.0f };
+        return;
+    }
+    if (command.type == Command::Type::Reverb)
+    {
+        // back from silence, the tail it had then would play now
+        if (command.convolver != nullptr && command.convolver == render_reverb && render_wet <= 0.0f)
+            command.convolver->Reset();
+        render_reverb = command.convolver;
+        render_wet    = command.gain;
+        return;
+    }
+    if (command.type == Command::Type::Forget)
+    {
+        for (std::size_t i = 0; i < render_voices.size(); ++i)
+        {
+            RenderVoice& voice = render_voices[i];
+            if (voice.active && voice.pcm == command.pcm)
+            {
+                voice.active = false;
+                published[i].finished.store(voice.generation, std::memory_order_release);
+                published[i].seconds.store(-1.0f, std::memory_order_relaxed);
+            }
+        }
+        return;
+    }
+
+    RenderVoice& voice = render_voices[command.voice];
+    if (command.type == Command::Type::Play)
+    {
+        // whole frames, so a voice at unit pitch stays on the copy path
+        const double cursor = std::floor(static_cast<double>(std::max(command.offset_seconds, 0.0f)) * frequency);
+        voice = RenderVoice{ command.pcm, cursor, command.gain, std::max(command.pitch, 0.0f), command.looping, true, command.generation, command.max_distance, command.reference_distance, command.position };
+        return;
+    }
+    if (!voice.active || voice.generation != command.generation)
+        return;
+    switch (command.type)
+    {
+        case Command::Type::Stop:
+            voice.active = false;
+            published[command.voice].finished.store(voice.generation, std::memory_order_release);
+            published[command.voice].seconds.store(-1.0f, std::memory_order_relaxed);
+            break;
+        case Command::Type::SetGain: voice.gain = command.gain; break;
+        case Command::Type::Place: voice.position = command.position; break;
+        default: break;
+    }
+}
+
+void SoftwareMixer::mixVoice(RenderVoice& voice, std::size_t index, float* left, float* right, int frames) noexcept
+{
+    const Pcm&        pcm    = *voice.pcm;
+    const std::size_t length = pcm.left.size();
+    const bool        stereo = !pcm.right.empty();
+
+    float left_gain  = voice.gain;
+    float right_gain = voice.gain;
+    if (voice.max_distance > 0.0f && !stereo)
+    {
+        // constant power across the listener's right axis, scaled so straight ahead is the voice's own gain
+        const glm::vec3 offset   = voice.position - listener_position;
+        const float     distance = glm::length(offset);
+        const float     fade     = distance_gain(distance, voice.reference_distance, voice.max_distance);
+        const float     pan      = distance > 0.0f ? std::clamp(glm::dot(offset / distance, listener_right), -1.0f, 1.0f) : 0.0f;
+        const float     angle    = (pan + 1.0f) * std::numbers::pi_v<float> * 0.25f;
+        left_gain *= fade * std::cos(angle) * std::numbers::sqrt2_v<float>;
+        right_gain *= fade * std::sin(angle) * std::numbers::sqrt2_v<float>;
+    }
+
+    const float* left_source  = pcm.left.data();
+    const float* right_source = stereo ? pcm.right.data() : left_source;
+    if (voice.pitch == 1.0f && voice.cursor == std::floor(voice.cursor))
+    {
+        // no interpolation: whole runs up to the end of the buffer go through the SIMD kernel
+        for (int frame = 0; frame < frames;)
+        {
+            if (voice.cursor >= static_cast<double>(length))
+            {
+                if (!voice.looping || length == 0)
+                {
+                    voice.active = false;
+                    published[index].finished.store(voice.generation, std::memory_order_release);
+                    published[index].seconds.store(-1.0f, std::memory_order_relaxed);
+                    return;
+                }
+                voice.cursor -= static_cast<double>(length);
+            }
+            const auto at  = static_cast<std::size_t>(voice.cursor);
+            const auto run = std::min(static_cast<std::size_t>(frames - frame), length - at);
+            audio_kernels::MixGain(left_source + at, left + frame, run, left_gain);
+            audio_kernels::MixGain(right_source + at, right + frame, run, right_gain);
+            voice.cursor += static_cast<double>(run);
+            frame += static_cast<int>(run);
+        }
+        published[index].seconds.store(static_cast<float>(voice.cursor / frequency), std::memory_order_relaxed);
+        return;
+    }
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        if (voice.cursor >= static_cast<double>(length))
+        {
+            if (!voice.looping || length == 0)
+            {
+                voice.active = false;
+                published[index].finished.store(voice.generation, std::memory_order_release);
+                published[index].seconds.store(-1.0f, std::memory_order_relaxed);
+                return;
+            }
+            voice.cursor -= static_cast<double>(length);
+        }
+        const auto        at       = static_cast<std::size_t>(voice.cursor);
+        const float       fraction = static_cast<float>(voice.cursor - static_cast<double>(at));
+        const std::size_t next     = at + 1 < length ? at + 1 : voice.looping ? 0 : at;
+        left[frame] += (left_source[at] + (left_source[next] - left_source[at]) * fraction) * left_gain;
+        right[frame] += (right_source[at] + (right_source[next] - right_source[at]) * fraction) * right_gain;
+        voice.cursor += voice.pitch;
+    }
+    published[index].seconds.store(static_cast<float>(voice.cursor / frequency), std::memory_order_relaxed);
+}
@@ -0,0 +1,204 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "convolver.h"
+#include "spsc_queue.h"
+#include "voice_pool.h"
+
+#include <SDL_audio.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <memory>
+#include <vector>
+
+struct DecodedSound;
+
+/**
+ * A software voice mixer that replaces OpenAL's sources with its own loop, for thousands of short voices at once.
+ *
+ * OpenAL pays per source on every update, in the mixer and in each alSource call, which is what caps it at a few
+ * hundred voices. Here a voice is a cursor into float PCM and the mix is MixGain over runs of it, the SIMD kernel
+ * audio_kernels picks for the CPU, with the interpolating loop only for voices off unit pitch. The producer side has
+ * VoicePool's requests (Play, Stop, SetGain, Place, IsCurrent, PlaybackSeconds, Update) and the same stealing rule,
+ * and sends them through an SpscQueue the render side drains at the start of every callback; the render side
+ * reports back through atomics, never a lock. Sounds are added up front as float PCM already resampled to the
+ * mixer's rate with audio_kernels::Resampler, so the callback only copies, interpolates for pitch and pans. Voices
+ * play dry: there are no EFX sends, and a positional voice gets VoicePool's linear fade and a constant power pan
+ * from the listener, mono sources only. In their place the whole mix can go through a convolution reverb with a
+ * measured impulse response (SetImpulseResponse), a Convolver made on the producer thread and handed over through
+ * the queue like a buffer; it adds Convolver::BLOCK_FRAMES of latency to the wet signal only, and its share of
+ * each callback shows in the stats.
+ *
+ * Open picks the backend. With PROGRAMMING_FUN_AUDIO_WORKLET defined (link with -sAUDIO_WORKLET -sWASM_WORKERS) it
+ * starts an AudioContext and mixes in the worklet, one 128 frame quantum at a time on the audio rendering thread,
+ * which skips the buffering Emscripten's OpenAL schedules ahead; the browser only lets the context run after a
+ * click or key press on the page, which Open waits for by itself. Everywhere else it opens an SDL audio device of
+ * its own, float stereo at the mixer's rate in SDL_PERIOD_FRAMES callbacks, next to whatever OpenAL has open.
+ * Render can also be called directly, for a benchmark. Everything but Render belongs to one producer thread.
+ */
+class SoftwareMixer
+{
+public:
+    using BufferId = std::uint32_t; // 0 is never issued
+
+    static constexpr int         DEFAULT_VOICES    = 64;
+    static constexpr int         MAX_VOICES        = 8192;
+    static constexpr int         QUANTUM_FRAMES    = 128; // Web Audio's render quantum
+    static constexpr int         SDL_PERIOD_FRAMES = 256; // about 5 ms at 48 kHz; SDL may pick another
+    static constexpr int         DEFAULT_FREQUENCY = 48000;
+    static constexpr std::size_t QUEUE_CAPACITY    = 8192;
+
+    struct Stats
+    {
+        int           voices_in_use     = 0;
+        int           voice_capacity    = 0;
+        int           steals_per_second = 0;
+        std::uint64_t quanta            = 0;   // callbacks rendered since Open
+        std::uint64_t dropped           = 0;   // requests pushed into a full queue
+        double        render_ms         = 0.0; // the last callback's mix
+        double        period_ms         = 0.0; // how much audio that callback made, so the time it had
+        double        busy_ms           = 0.0; // every callback's mix since the mixer was made
+        std::uint64_t late              = 0;   // callbacks whose mix took longer than the audio they made, heard as a gap
+        double        reverb_ms         = 0.0; // the last callback's convolution, part of render_ms
+        int           reverb_partitions = 0;   // of Convolver::BLOCK_FRAMES each, 0 without a reverb
+    };
+
+    explicit SoftwareMixer(int frequency = DEFAULT_FREQUENCY, int voice_count = DEFAULT_VOICES);
+    ~SoftwareMixer();
+
+    SoftwareMixer(const SoftwareMixer&)                = delete;
+    SoftwareMixer& operator=(const SoftwareMixer&)     = delete;
+    SoftwareMixer(SoftwareMixer&&) noexcept            = delete;
+    SoftwareMixer& operator=(SoftwareMixer&&) noexcept = delete;
+
+    // Starts the worklet or the SDL device; false, logged, when neither opens
+    bool Open();
+    // Stops the callbacks; the voices and buffers stay
+    void Close();
+    bool IsOpen() const noexcept;
+    int  Frequency() const noexcept;
+
+    // Converts the PCM to the mixer's rate once; an invalid id when the format isn't one it plays (up to stereo)
+    BufferId AddBuffer(const DecodedSound& sound);
+    // Stops the voices playing it; the samples go once the render side has seen that
+    void     RemoveBuffer(BufferId buffer);
+
+    VoiceId Play(BufferId buffer, const VoiceParams& params = {});
+    void    Stop(VoiceId voice);
+    bool    IsCurrent(VoiceId voice) const noexcept;
+    void    Place(VoiceId voice, const glm::vec3& position);
+    void    SetGain(VoiceId voice, float gain);
+    void    SetListener(const glm::vec3& position, const glm::vec3& forward, const glm::vec3& up);
+    // How far the render side is into the buffer, a quantum at a time; negative once it stopped
+    float   PlaybackSeconds(VoiceId voice) const;
+    // Reclaims finished voices, frees removed buffers and rolls the steal counter over once a second
+    void    Update(float delta_seconds);
+
+    // Partitions the response (up to stereo, converted to the mixer's rate) for the reverb, replacing the one before;
+    // false when it isn't a format AddBuffer takes or the queue is full. Longer than Convolver::MAX_PARTITIONS is cut
+    bool SetImpulseResponse(const DecodedSound& response);
+    void ClearImpulseResponse();
+    // How much of the reverb is added to the dry mix, 0 to skip the convolution
+    void SetReverbWet(float wet);
+
+    int   VoicesInUse() const noexcept;
+    Stats GetStats() const noexcept;
+
+    // The render side: applies the queued requests and mixes `frames` into the two planar outputs
+    void Render(float* left, float* right, int frames) noexcept;
+
+private:
+    static void SDLCALL sdlCallback(void* user_data, Uint8* stream, int length);
+
+    struct Pcm;
+    struct Command;
+    struct RenderVoice;
+
+    // the producer's view of a voice
+    struct Voice
+    {
+        std::uint32_t generation = 0;
+        std::uint64_t started    = 0;
+        float         gain       = 0.0f;
+        int           priority   = 0;
+        BufferId      buffer     = 0;
+        bool          active     = false;
+    };
+
+    // what the render side reports for each voice
+    struct Published
+    {
+        std::atomic<std::uint32_t> finished{ 0 }; // the generation that ran out or was stopped
+        std::atomic<float>         seconds{ -1.0f };
+    };
+
+    struct RetiredBuffer
+    {
+        std::unique_ptr<Pcm> pcm;
+        std::uint64_t        after = 0; // freed once this many commands were drained
+    };
+
+    struct RetiredReverb
+    {
+        std::unique_ptr<Convolver> convolver;
+        std::uint64_t              after = 0;
+    };
+
+    bool push(const Command& command);
+    // Hands the render side another convolver, or none; the one it had is freed once it has seen that
+    bool setReverb(std::unique_ptr<Convolver> convolver, float wet);
+    // Render in pieces of the scratch planes, interleaved for SDL
+    void renderInterleaved(float* out, int frames) noexcept;
+    int  pickVictim(int priority) const;
+    void apply(const Command& command) noexcept;
+    void mixVoice(RenderVoice& voice, std::size_t index, float* left, float* right, int frames) noexcept;
+
+private:
+    int frequency = DEFAULT_FREQUENCY;
+
+    // producer side
+    std::vector<std::unique_ptr<Pcm>> buffers; // by id - 1, null once removed
+    std::vector<RetiredBuffer>        retired;
+    std::unique_ptr<Convolver>        reverb;
+    std::vector<RetiredReverb>        retired_reverbs;
+    float                             reverb_wet         = 0.5f;
+    std::vector<Voice>                voices;
+    std::vector<int>                  free_voices;
+    std::uint64_t                     play_count         = 0;
+    std::uint64_t                     pushed             = 0;
+    std::uint64_t                     dropped            = 0;
+    int                               in_use             = 0;
+    int                               steals_this_window = 0;
+    int                               steals_per_second  = 0;
+    float                             window_seconds     = 0.0f;
+    bool                              is_open            = false;
+    SDL_AudioDeviceID                 device             = 0; // 0 with the worklet
+
+    // shared
+    std::unique_ptr<SpscQueue<Command, QUEUE_CAPACITY>> queue;
+    std::unique_ptr<Published[]>                        published;
+    std::atomic<std::uint64_t>                          drained{ 0 };
+    std::atomic<std::uint64_t>                          quanta{ 0 };
+    std::atomic<float>                                  render_ms{ 0.0f };
+    std::atomic<float>                                  period_ms{ 0.0f };
+    std::atomic<std::uint64_t>                          busy_ticks{ 0 };
+    std::atomic<std::uint64_t>                          late{ 0 };
+    std::atomic<float>                                  reverb_ms{ 0.0f };
+
+    // render side
+    std::vector<RenderVoice> render_voices;
+    std::vector<float>       scratch_left; // SDL's planes before interleaving
+    std::vector<float>       scratch_right;
+    glm::vec3                listener_position{ 0.0f };
+    glm::vec3                listener_right{ 1.0f, 0.0f, 0.0f };
+    Convolver*               render_reverb = nullptr;
+    float                    render_wet    = 0.0f;
+};
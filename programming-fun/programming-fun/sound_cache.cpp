@@ -0,0 +1,592 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "sound_cache.h"
+
+#include "asset_pack.h"
+#include "async_file_reader.h"
+#include "audio_kernels.h"
+#include "decoded_cache.h"
+#include "load_scheduler.h"
+#include "logger.h"
+#include "memory_tracker.h"
+#include "profiler.h"
+#include "release_queue.h"
+#include "sound_loader.h"
+#include "startup_trace.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+struct SoundCache::Job
+{
+    std::shared_ptr<SoundBuffer>   target;
+    SoundStorage                   storage = SoundStorage::Pcm; // asked for, then what the worker produced
+    DecodedSound                   decoded;
+    DecodedSound                   distant; // empty when the sound gets no distant_buffer
+    std::vector<unsigned char>     ima4;
+    WaveformPeaks                  peaks;
+    std::span<const unsigned char> vorbis; // in the pack
+    std::vector<unsigned char>     file;   // a loose OGG file, read whole
+    bool                           ok           = false;
+    bool                           reconverted  = false;
+    bool                           reload       = false; // of a resident sound, which keeps playing the old data until this lands
+    Uint64                         submitted    = 0;     // SDL_GetPerformanceCounter at Acquire
+    Uint64                         worker_ticks = 0;
+    AssetHandle                    asset;
+    LoadPriority                   priority = LoadPriority::Visible;
+};
+
+namespace
+{
+    // the reader's copy when it read the file ahead of the job
+    bool read_file(const std::filesystem::path& filename, AsyncFileReader* reader, std::vector<unsigned char>& out_bytes, std::string& out_error)
+    {
+        if (reader != nullptr && reader->Take(filename, out_bytes))
+            return true;
+        std::size_t size = 0;
+        void*       data = SDL_LoadFile(filename.string().c_str(), &size);
+        if (data == nullptr)
+        {
+            out_error = SDL_GetError();
+            return false;
+        }
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        out_bytes.assign(bytes, bytes + size);
+        SDL_free(data);
+        return true;
+    }
+
+    double ticks_to_ms(Uint64 ticks)
+    {
+        return static_cast<double>(ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    bool is_sample_type(std::int32_t value)
+    {
+        return value == static_cast<std::int32_t>(SampleType::Unsigned8) || value == static_cast<std::int32_t>(SampleType::Signed16) || value == static_cast<std::int32_t>(SampleType::Float32);
+    }
+
+    // mono 16 bit PCM at DISTANT_RATE_DIVISOR less rate and as many seconds long, so a playhead means the same in both
+    void resample_for_distance(const DecodedSound& decoded, DecodedSound& out_distant)
+    {
+        const int rate = decoded.frequency / SoundCache::DISTANT_RATE_DIVISOR;
+        if (decoded.channels != 1 || decoded.type != SampleType::Signed16 || rate < SoundCache::DISTANT_MIN_RATE)
+            return;
+        const std::size_t         count = decoded.samples.size() / sizeof(std::int16_t);
+        std::vector<std::int16_t> pcm(count);
+        std::memcpy(pcm.data(), decoded.samples.data(), count * sizeof(std::int16_t));
+        std::vector<float> in(count);
+        audio_kernels::S16ToF32(pcm.data(), in.data(), count);
+
+        audio_kernels::Resampler resampler{ decoded.frequency, rate };
+        std::vector<float>       out;
+        out.reserve(count / static_cast<std::size_t>(SoundCache::DISTANT_RATE_DIVISOR) + audio_kernels::Resampler::TAPS);
+        resampler.Process(in, out);
+        resampler.Flush(out);
+        // the flush's tail is the filter ringing out past the end
+        out.resize(std::min(out.size(), count * static_cast<std::size_t>(rate) / static_cast<std::size_t>(decoded.frequency)));
+        pcm.resize(out.size());
+        audio_kernels::F32ToS16(out.data(), pcm.data(), out.size());
+
+        out_distant.type      = SampleType::Signed16;
+        out_distant.channels  = 1;
+        out_distant.frequency = rate;
+        out_distant.samples.resize(pcm.size() * sizeof(std::int16_t));
+        std::memcpy(out_distant.samples.data(), pcm.data(), out_distant.samples.size());
+    }
+}
+
+SoundCache::SoundCache(LoadScheduler& load_scheduler, AssetRegistry& asset_registry, ReleaseQueue& release_queue, const AssetPack* asset_pack, std::size_t budget_bytes)
+    : scheduler{ load_scheduler }, registry{ asset_registry }, releases{ release_queue }, pack{ asset_pack }, budget{ budget_bytes }, completed{ std::make_shared<CompletionQueue>() }
+{
+}
+
+SoundCache::~SoundCache()
+{
+    Shutdown();
+}
+
+SoundHandle SoundCache::Acquire(const std::filesystem::path& filename, LoadPriority priority)
+{
+    return Acquire(AssetId::FromPath(filename), priority);
+}
+
+SoundHandle SoundCache::Acquire(AssetId id, LoadPriority priority)
+{
+    if (const auto found = entries.find(id.Hash()); found != entries.end())
+    {
+        ++stats.hits;
+        registry.Touch(found->second.asset);
+        if (Entry& entry = found->second; priority < entry.priority)
+        {
+            scheduler.Promote(entry.ticket, priority);
+            entry.priority = priority;
+        }
+        return found->second.sound;
+    }
+    ++stats.misses;
+
+    auto job          = std::make_shared<Job>();
+    job->target       = std::make_shared<SoundBuffer>();
+    job->target->path = id.Path();
+    job->storage      = storage;
+    job->submitted    = SDL_GetPerformanceCounter();
+    job->priority     = priority;
+    job->asset        = registry.Add(AssetKind::Sound, std::string{ id.Name() }, std::string{ id.Name() }, std::shared_ptr<const std::atomic<SoundState>>{ job->target, &job->target->state });
+    entries.emplace(id.Hash(), Entry{ job->target, job->asset, priority, submit(job) });
+    stats.entries = entries.size();
+    return job->target;
+}
+
+std::size_t SoundCache::Reload(const std::filesystem::path& filename)
+{
+    const auto found = entries.find(asset_name_hash(AssetRegistry::FileId(filename)));
+    if (found == entries.end() || !found->second.sound->IsReady())
+        return 0;
+    auto job       = std::make_shared<Job>();
+    job->target    = found->second.sound;
+    job->storage   = storage;
+    job->reload    = true;
+    job->submitted = SDL_GetPerformanceCounter();
+    job->asset     = found->second.asset;
+    job->priority  = found->second.priority;
+    submit(job);
+    return 1;
+}
+
+LoadScheduler::Ticket SoundCache::submit(const std::shared_ptr<Job>& job)
+{
+    ++in_flight;
+
+    // a first load the pack doesn't have may still be on the server, and is read ahead; one it has starts paging in
+    // while the job waits its turn. A reload is of a file already on disk
+    std::vector<std::filesystem::path> candidates;
+    if (!job->reload && (pack == nullptr || !pack->Prefetch(job->target->path)))
+        candidates.push_back(job->target->path);
+
+    // the queue is shared so a job finishing after Shutdown has somewhere harmless to land;
+    // a reload is of the file that changed on disk, which the pack only has a stale copy of
+    return scheduler.Submit(
+        job->priority,
+        [job, queue = completed, pack = job->reload ? nullptr : pack, reader = scheduler.Reader()]()
+        {
+            if (!job->reload)
+                job->target->state.store(SoundState::Decoding, std::memory_order_release);
+            const Uint64                 begin  = SDL_GetPerformanceCounter();
+            const std::filesystem::path& path   = job->target->path;
+            const startup_trace::Scope   trace{ "Decode sound", path.filename().string() };
+            std::vector<unsigned char>   unpacked; // a compressed pack entry
+            const auto                   bytes  = pack != nullptr ? pack->ReadFile(path, unpacked) : std::span<const unsigned char>{};
+            const bool                   is_ogg = path.extension() == ".ogg";
+            if (job->storage == SoundStorage::Vorbis && is_ogg)
+            {
+                // nothing decodes until it plays; a pack entry is already in memory, a compressed one is kept
+                job->vorbis = bytes;
+                job->file   = std::move(unpacked);
+                job->ok     = !bytes.empty() || read_file(path, reader, job->file, job->decoded.error);
+            }
+            else
+            {
+                // the encoded bytes name the cached decode, so an edited file misses
+                std::vector<unsigned char>     file_bytes;
+                std::span<const unsigned char> source = bytes;
+                if (source.empty() && read_file(path, reader, file_bytes, job->decoded.error))
+                    source = file_bytes;
+                const std::uint64_t  key = !source.empty() && decoded_cache::IsEnabled() ? decoded_cache::Key(source, job->storage == SoundStorage::Pcm ? "pcm" : "adpcm") : 0;
+                decoded_cache::Entry cached;
+                if (key != 0 && cached.Open(key) && cached.SectionCount() == 2 && is_sample_type(cached.Param(0)) && cached.Param(1) > 0 && cached.Param(2) > 0)
+                {
+                    job->decoded.samples.assign(cached.Section(0).begin(), cached.Section(0).end());
+                    job->decoded.type      = static_cast<SampleType>(cached.Param(0));
+                    job->decoded.channels  = cached.Param(1);
+                    job->decoded.frequency = cached.Param(2);
+                    job->ima4.assign(cached.Section(1).begin(), cached.Section(1).end());
+                    job->storage = cached.Param(3) == static_cast<std::int32_t>(SoundStorage::Adpcm) && !job->ima4.empty() ? SoundStorage::Adpcm : SoundStorage::Pcm;
+                    job->ok      = true;
+                    job->peaks.Build(job->decoded);
+                    decoded_cache::CountWarm(ticks_to_ms(SDL_GetPerformanceCounter() - begin), cached.ColdMs());
+                }
+                else
+                {
+                    job->ok = !source.empty() && (is_ogg ? DecodeOgg(source, job->decoded) : DecodeWav(source, job->decoded));
+                    // the PCM is kept too, for a device without AL_EXT_IMA4
+                    const bool encoded = job->ok && job->storage != SoundStorage::Pcm && EncodeIma4(job->decoded, job->ima4);
+                    job->storage       = encoded ? SoundStorage::Adpcm : SoundStorage::Pcm;
+                    if (job->ok)
+                    {
+                        job->peaks.Build(job->decoded);
+                        const double cold_ms = ticks_to_ms(SDL_GetPerformanceCounter() - begin);
+                        decoded_cache::CountCold(cold_ms);
+                        const std::span<const unsigned char> sections[] = { job->decoded.samples, job->ima4 };
+                        if (key != 0)
+                            decoded_cache::Store(key, { static_cast<std::int32_t>(job->decoded.type), job->decoded.channels, job->decoded.frequency, static_cast<std::int32_t>(job->storage) },
+                                                 sections, cold_ms);
+                    }
+                }
+            }
+            if (job->ok && job->storage != SoundStorage::Vorbis)
+                resample_for_distance(job->decoded, job->distant);
+            job->worker_ticks += SDL_GetPerformanceCounter() - begin;
+
+            std::lock_guard lock{ queue->mutex };
+            queue->finished.push_back(job);
+        },
+        std::move(candidates));
+}
+
+void SoundCache::Update()
+{
+    cancelUnwanted();
+    std::vector<std::shared_ptr<Job>> finished;
+    {
+        std::lock_guard lock{ completed->mutex };
+        finished.swap(completed->finished);
+    }
+    if (finished.empty())
+        return;
+
+    for (const auto& job : finished)
+    {
+        --in_flight;
+        SoundBuffer& sound  = *job->target;
+        ALuint       buffer = 0;
+        std::size_t  bytes  = 0;
+        if (job->ok && job->storage != SoundStorage::Vorbis)
+        {
+            const bool as_adpcm = job->storage == SoundStorage::Adpcm && IsIma4Supported();
+            if (!as_adpcm && !job->reconverted && FindOpenALFormat(job->decoded.type, job->decoded.channels) == AL_NONE)
+            {
+                // decoded before the context said what it takes
+                convertOnWorker(job);
+                continue;
+            }
+            alGenBuffers(1, &buffer);
+            job->ok = as_adpcm ? UploadIma4(job->ima4, job->decoded.channels, job->decoded.frequency, buffer) : UploadSound(job->decoded, buffer);
+            if (job->ok)
+            {
+                ALint size = 0;
+                alGetBufferi(buffer, AL_SIZE, &size);
+                job->storage = as_adpcm ? SoundStorage::Adpcm : SoundStorage::Pcm;
+                bytes        = static_cast<std::size_t>(size);
+            }
+            else
+            {
+                job->decoded.error = SDL_GetError();
+                alDeleteBuffers(1, &buffer);
+                buffer = 0;
+            }
+        }
+        if (!job->ok && job->reload)
+        {
+            // likely caught half written; the next save reloads it again
+            LOG_WARN("Failed to reload sound ", sound.path, ": ", job->decoded.error, ", keeping the old one");
+            continue;
+        }
+        if (!job->ok)
+        {
+            LOG_ERROR("Failed to load sound ", sound.path, ": ", job->decoded.error);
+            sound.state.store(SoundState::Failed, std::memory_order_release);
+            continue;
+        }
+
+        if (job->reload)
+            retire(sound);
+        if (job->storage == SoundStorage::Vorbis)
+        {
+            sound.file   = std::move(job->file);
+            sound.vorbis = sound.file.empty() ? job->vorbis : std::span<const unsigned char>{ sound.file };
+            bytes        = sound.vorbis.size();
+        }
+        // without it the emitters keep the full rate buffer at every distance, so a failure here costs nothing else
+        ALuint      distant_buffer = 0;
+        std::size_t distant_bytes  = 0;
+        if (!job->distant.samples.empty())
+        {
+            alGenBuffers(1, &distant_buffer);
+            ALint size = 0;
+            if (UploadSound(job->distant, distant_buffer))
+                alGetBufferi(distant_buffer, AL_SIZE, &size);
+            else
+                alDeleteBuffers(1, &distant_buffer);
+            distant_buffer = size > 0 ? distant_buffer : 0;
+            distant_bytes  = static_cast<std::size_t>(size);
+        }
+        sound.buffer         = buffer;
+        sound.distant_buffer = distant_buffer;
+        sound.storage        = job->storage;
+        sound.bytes          = bytes;
+        sound.distant_bytes  = distant_bytes;
+        sound.scratch_bytes  = job->decoded.scratch_bytes;
+        sound.peaks          = std::move(job->peaks);
+        stats.resident_bytes += sound.bytes + sound.distant_bytes;
+        stats.peak_bytes += sound.peaks.Bytes();
+        memory_tracker::Allocate(MemoryCategory::Audio, sound.bytes + sound.distant_bytes);
+        registry.SetBytes(job->asset, sound.bytes + sound.distant_bytes);
+        sound.state.store(SoundState::Resident, std::memory_order_release);
+
+        const double latency_ms = ticks_to_ms(SDL_GetPerformanceCounter() - job->submitted);
+        ++stats.decodes;
+        stats.last_latency_ms = latency_ms;
+        stats.max_latency_ms  = std::max(stats.max_latency_ms, latency_ms);
+        stats.total_latency_ms += latency_ms;
+        stats.total_worker_ms += ticks_to_ms(job->worker_ticks);
+    }
+    evictToBudget();
+}
+
+ALuint SoundCache::BufferFor(const SoundHandle& sound)
+{
+    if (sound == nullptr || !sound->IsReady())
+        return 0;
+    if (sound->storage != SoundStorage::Vorbis)
+        return sound->buffer;
+    for (PoolBuffer& pooled : decode_pool)
+    {
+        if (pooled.sound.lock() == sound)
+        {
+            pooled.last_used = ++pool_clock;
+            return pooled.buffer;
+        }
+    }
+    return decodeIntoPool(sound);
+}
+
+void SoundCache::Shutdown()
+{
+    for (auto& [id, entry] : entries)
+    {
+        scheduler.Cancel(entry.ticket);
+        if (entry.sound->buffer != 0)
+        {
+            alDeleteBuffers(1, &entry.sound->buffer);
+            memory_tracker::Free(MemoryCategory::Audio, entry.sound->bytes);
+        }
+        if (entry.sound->distant_buffer != 0)
+        {
+            alDeleteBuffers(1, &entry.sound->distant_buffer);
+            memory_tracker::Free(MemoryCategory::Audio, entry.sound->distant_bytes);
+        }
+        entry.sound->buffer         = 0;
+        entry.sound->distant_buffer = 0;
+        registry.Remove(entry.asset);
+    }
+    for (PoolBuffer& pooled : decode_pool)
+    {
+        alDeleteBuffers(1, &pooled.buffer);
+        if (pooled.bytes > 0)
+            memory_tracker::Free(MemoryCategory::Audio, pooled.bytes);
+    }
+    decode_pool.clear();
+    entries.clear();
+    {
+        std::lock_guard lock{ completed->mutex };
+        completed->finished.clear();
+    }
+    // jobs still running hold the old queue and are dropped with it
+    completed            = std::make_shared<CompletionQueue>();
+    in_flight            = 0;
+    stats.resident_bytes = 0;
+    stats.pool_bytes     = 0;
+    stats.peak_bytes     = 0;
+    stats.entries        = 0;
+}
+
+void SoundCache::SetBudget(std::size_t budget_bytes)
+{
+    budget = budget_bytes;
+    evictToBudget();
+}
+
+std::size_t SoundCache::Budget() const noexcept
+{
+    return budget;
+}
+
+void SoundCache::SetStorage(SoundStorage new_storage) noexcept
+{
+    storage = new_storage;
+}
+
+SoundStorage SoundCache::Storage() const noexcept
+{
+    return storage;
+}
+
+std::size_t SoundCache::PendingCount() const noexcept
+{
+    return in_flight;
+}
+
+const SoundCache::Stats& SoundCache::GetStats() const noexcept
+{
+    return stats;
+}
+
+bool SoundCache::Parse(std::string_view text, SoundStorage& out_storage)
+{
+    if (text == "pcm")
+        out_storage = SoundStorage::Pcm;
+    else if (text == "adpcm")
+        out_storage = SoundStorage::Adpcm;
+    else if (text == "vorbis")
+        out_storage = SoundStorage::Vorbis;
+    else
+        return false;
+    return true;
+}
+
+std::string SoundCache::Format(SoundStorage storage)
+{
+    switch (storage)
+    {
+        case SoundStorage::Pcm: return "pcm";
+        case SoundStorage::Adpcm: return "adpcm";
+        case SoundStorage::Vorbis: return "vorbis";
+    }
+    return "pcm";
+}
+
+void SoundCache::cancelUnwanted()
+{
+    for (auto entry = entries.begin(); entry != entries.end();)
+    {
+        // the entry and the queued job hold the only references left
+        const SoundBuffer& sound = *entry->second.sound;
+        if (entry->second.ticket != 0 && entry->second.sound.use_count() <= 2 && sound.state.load(std::memory_order_acquire) == SoundState::Queued && scheduler.Cancel(entry->second.ticket))
+        {
+            --in_flight;
+            registry.Remove(entry->second.asset);
+            entry = entries.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+    stats.entries = entries.size();
+}
+
+void SoundCache::evictToBudget()
+{
+    if (stats.resident_bytes <= budget)
+        return;
+    // the entry's own handle is the one reference left on a sound nobody holds
+    for (const AssetHandle handle : registry.Unreferenced(AssetKind::Sound, 1))
+    {
+        if (stats.resident_bytes <= budget)
+            break;
+        // another cache's, sharing the registry
+        const auto found = entries.find(asset_name_hash(registry.Get(handle)->id));
+        if (found == entries.end())
+            continue;
+        SoundBuffer& sound = *found->second.sound;
+
+        // a source can still have either attached; AL refuses the delete and they stay until next time
+        alGetError();
+        const ALuint sound_buffers[] = { sound.buffer, sound.distant_buffer };
+        alDeleteBuffers(sound.distant_buffer != 0 ? 2 : 1, sound_buffers);
+        if (alGetError() != AL_NO_ERROR)
+            continue;
+        stats.resident_bytes -= sound.bytes + sound.distant_bytes;
+        stats.peak_bytes -= sound.peaks.Bytes();
+        memory_tracker::Free(MemoryCategory::Audio, sound.bytes + sound.distant_bytes);
+        ++stats.evictions;
+        registry.Evict(handle);
+        entries.erase(found);
+    }
+    stats.entries = entries.size();
+}
+
+void SoundCache::retire(SoundBuffer& sound)
+{
+    if (sound.buffer != 0)
+        releases.RetireSoundBuffer(sound.buffer, sound.bytes);
+    else
+        memory_tracker::Free(MemoryCategory::Audio, sound.bytes);
+    if (sound.distant_buffer != 0)
+        releases.RetireSoundBuffer(sound.distant_buffer, sound.distant_bytes);
+    stats.resident_bytes -= sound.bytes + sound.distant_bytes;
+    stats.peak_bytes -= sound.peaks.Bytes();
+    // pool buffers decoded from the old file go back to the pool
+    for (PoolBuffer& pooled : decode_pool)
+    {
+        if (pooled.sound.lock().get() == &sound)
+            pooled.sound.reset();
+    }
+}
+
+void SoundCache::convertOnWorker(const std::shared_ptr<Job>& job)
+{
+    job->reconverted = true;
+    ++in_flight;
+    // the rest of a decode that already had its turn, so it doesn't queue behind the loads after it
+    scheduler.Submit(
+        LoadPriority::Immediate,
+        [job, queue = completed]()
+        {
+            const Uint64 begin = SDL_GetPerformanceCounter();
+            if (!ConvertForOpenAL(job->decoded, GetAudioFormats()))
+                job->ok = false;
+            job->worker_ticks += SDL_GetPerformanceCounter() - begin;
+            std::lock_guard lock{ queue->mutex };
+            queue->finished.push_back(job);
+        });
+}
+
+ALuint SoundCache::decodeIntoPool(const SoundHandle& sound)
+{
+    DecodedSound decoded;
+    {
+        PROFILE_ZONE("Decode Vorbis On Play");
+        const Uint64 begin = SDL_GetPerformanceCounter();
+        if (!DecodeOgg(sound->vorbis, decoded))
+        {
+            LOG_ERROR("Failed to decode sound ", sound->path, ": ", decoded.error);
+            return 0;
+        }
+        stats.last_play_decode_ms = ticks_to_ms(SDL_GetPerformanceCounter() - begin);
+    }
+    ++stats.decodes_on_play;
+    if (decode_pool.empty())
+    {
+        decode_pool.resize(DECODE_POOL_SIZE);
+        for (PoolBuffer& pooled : decode_pool)
+            alGenBuffers(1, &pooled.buffer);
+    }
+
+    // least recently used first; AL refuses new data for a buffer a source still holds, so those fail and are passed over
+    std::array<PoolBuffer*, DECODE_POOL_SIZE> order{};
+    std::transform(decode_pool.begin(), decode_pool.end(), order.begin(), [](PoolBuffer& pooled) { return &pooled; });
+    std::sort(order.begin(), order.end(), [](const PoolBuffer* a, const PoolBuffer* b) { return a->last_used < b->last_used; });
+    if (FindOpenALFormat(decoded.type, decoded.channels) == AL_NONE)
+    {
+        LOG_ERROR("Failed to load sound ", sound->path, ": no OpenAL format for ", decoded.channels, " channel(s)");
+        return 0;
+    }
+    for (PoolBuffer* pooled : order)
+    {
+        if (!UploadSound(decoded, pooled->buffer))
+            continue;
+
+        ALint size = 0;
+        alGetBufferi(pooled->buffer, AL_SIZE, &size);
+        if (pooled->bytes > 0)
+            memory_tracker::Free(MemoryCategory::Audio, pooled->bytes);
+        stats.pool_bytes -= pooled->bytes;
+        pooled->bytes     = static_cast<std::size_t>(size);
+        pooled->sound     = sound;
+        pooled->last_used = ++pool_clock;
+        stats.pool_bytes += pooled->bytes;
+        memory_tracker::Allocate(MemoryCategory::Audio, pooled->bytes);
+        return pooled->buffer;
+    }
+    ++stats.pool_exhausted;
+    return 0;
+}
@@ -0,0 +1,222 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "asset_registry.h"
+#include "load_scheduler.h"
+#include "waveform_peaks.h"
+
+#include <al.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class AssetPack;
+class ReleaseQueue;
+
+// Queued, Decoding on a worker, then Resident or Failed; the upload is part of the Update that takes it
+using SoundState = AssetState;
+
+// What a cache trades between memory and CPU for the sounds it loads
+enum class SoundStorage
+{
+    Pcm,   // 16-bit PCM in the AL buffer
+    Adpcm, // IMA ADPCM in the AL buffer (AL_EXT_IMA4), a quarter of the memory, decoded while mixing; PCM without the extension
+    Vorbis // OGG files stay compressed and decode into a pooled buffer when played; WAV files fall back to Adpcm
+};
+
+/**
+ * A sound buffer that may still be decoding.
+ *
+ * Everything but `path` and `state` is only written on the AL thread and is valid once `state` is
+ * Resident. Vorbis sounds have no `buffer` of their own; play them through SoundCache::BufferFor.
+ */
+struct SoundBuffer
+{
+    std::filesystem::path          path;
+    ALuint                         buffer         = 0;
+    ALuint                         distant_buffer = 0; // a mono sound again at a lower rate, for SpatialAudio's Distant emitters; 0 for none
+    std::size_t                    bytes          = 0; // what the driver holds, or the compressed file for Vorbis
+    std::size_t                    distant_bytes  = 0; // what the driver holds for distant_buffer, besides `bytes`
+    std::size_t                    scratch_bytes  = 0; // peak decoder working memory, 0 for WAV
+    SoundStorage                   storage        = SoundStorage::Pcm;
+    std::span<const unsigned char> vorbis; // the OGG file, in the asset pack or in `file`
+    std::vector<unsigned char>     file;
+    WaveformPeaks                  peaks; // built with the PCM; empty for Vorbis, which isn't decoded until it plays
+    std::atomic<SoundState>        state{ SoundState::Queued };
+
+    bool IsReady() const noexcept
+    {
+        return state.load(std::memory_order_acquire) == SoundState::Resident;
+    }
+
+    bool HasFailed() const noexcept
+    {
+        return state.load(std::memory_order_acquire) == SoundState::Failed;
+    }
+};
+
+// Keeps the buffer resident; voices playing it should not outlive the handle
+using SoundHandle = std::shared_ptr<const SoundBuffer>;
+
+/**
+ * One OpenAL buffer per sound asset, shared by everything that asks for it.
+ *
+ * Assets are keyed by their path relative to the asset root, the same id an AssetPack uses, and each
+ * one is an entry in the AssetRegistry, which tracks its state, its bytes and when it was last acquired.
+ * Acquire returns at once; WAV and OGG files decode on the workers through the shared LoadScheduler at
+ * the priority asked for, and Update uploads the finished PCM, so sounds become playable over the first
+ * frames instead of stalling startup. A load is promoted like a texture's when asked for again more urgently,
+ * and cancelled when the last handle goes before it started.
+ * Buffers nobody holds a handle to stay cached for later hits and are evicted least recently used
+ * first once resident bytes go over the budget. Held buffers are never evicted, so the budget is a
+ * target rather than a hard cap. A reloaded sound's old buffer goes to the ReleaseQueue. Everything but decoding
+ * happens on the thread that owns the AL context.
+ *
+ * The storage setting is per cache, so a bank of a few thousand rarely played effects can sit in
+ * its own cache as Vorbis or ADPCM while the handful that fire every frame stay PCM in another.
+ * Vorbis sounds share DECODE_POOL_SIZE buffers: BufferFor decodes into the least recently used
+ * one a voice isn't holding, so only the sounds playing right now cost PCM.
+ *
+ * A mono 16 bit sound also gets a distant_buffer, resampled on the worker to DISTANT_RATE_DIVISOR less rate when
+ * that leaves at least DISTANT_MIN_RATE: what a far away loop plays, a quarter of the data for the mixer to read
+ * for what distance attenuation leaves of it. Its bytes are counted with the sound's and it goes with the sound.
+ */
+class SoundCache
+{
+public:
+    static constexpr std::size_t DEFAULT_BUDGET       = 32 * 1024 * 1024;
+    static constexpr int         DECODE_POOL_SIZE     = 16;
+    static constexpr int         DISTANT_RATE_DIVISOR = 4;
+    static constexpr int         DISTANT_MIN_RATE     = 8000; // Hz; a sound that would go under it gets no distant_buffer
+
+    struct Stats
+    {
+        std::uint64_t hits            = 0;
+        std::uint64_t misses          = 0;
+        std::uint64_t evictions       = 0;
+        std::uint64_t decodes_on_play = 0; // Vorbis sounds that weren't in a pool buffer already
+        std::uint64_t pool_exhausted  = 0; // plays dropped because voices held every pool buffer
+        std::size_t   resident_bytes  = 0;
+        std::size_t   pool_bytes      = 0;
+        std::size_t   peak_bytes      = 0; // every WaveformPeaks, on the heap
+        std::size_t   entries         = 0;
+
+        // Acquire to playable: the wait for a worker, the decode and the upload the next Update does
+        std::uint64_t decodes             = 0;
+        double        last_latency_ms     = 0.0;
+        double        max_latency_ms      = 0.0;
+        double        total_latency_ms    = 0.0;
+        double        total_worker_ms     = 0.0; // of that, time a worker spent decoding and converting
+        double        last_play_decode_ms = 0.0; // Vorbis, on the AL thread
+
+        double HitRate() const noexcept
+        {
+            return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+        }
+
+        double MeanLatencyMs() const noexcept
+        {
+            return decodes == 0 ? 0.0 : total_latency_ms / static_cast<double>(decodes);
+        }
+
+        double MeanWorkerMs() const noexcept
+        {
+            return decodes == 0 ? 0.0 : total_worker_ms / static_cast<double>(decodes);
+        }
+    };
+
+    // `pack` is optional; it must outlive the worker pool like it does for TextureLoader
+    SoundCache(LoadScheduler& scheduler, AssetRegistry& registry, ReleaseQueue& releases, const AssetPack* pack = nullptr, std::size_t budget_bytes = DEFAULT_BUDGET);
+    ~SoundCache();
+
+    SoundCache(const SoundCache&)                = delete;
+    SoundCache& operator=(const SoundCache&)     = delete;
+    SoundCache(SoundCache&&) noexcept            = delete;
+    SoundCache& operator=(SoundCache&&) noexcept = delete;
+
+    SoundHandle Acquire(const std::filesystem::path& filename, LoadPriority priority = LoadPriority::Visible);
+    // A hit is one hash lookup; the path is only built on a miss
+    SoundHandle Acquire(AssetId id, LoadPriority priority = LoadPriority::Visible);
+    // Decodes a resident sound again from the loose file, never the pack; it plays the old data until a later Update swaps in a new buffer. Returns 1 if queued.
+    std::size_t Reload(const std::filesystem::path& filename);
+    // The AL buffer to play `sound` from, 0 while it isn't ready; Vorbis sounds decode here
+    ALuint      BufferFor(const SoundHandle& sound);
+    void        Update();
+    void        Shutdown();
+
+    void         SetBudget(std::size_t budget_bytes);
+    std::size_t  Budget() const noexcept;
+    // Applies to sounds acquired from now on
+    void         SetStorage(SoundStorage new_storage) noexcept;
+    SoundStorage Storage() const noexcept;
+    std::size_t  PendingCount() const noexcept;
+    const Stats& GetStats() const noexcept;
+
+    // "pcm", "adpcm" or "vorbis"
+    static bool Parse(std::string_view text, SoundStorage& out_storage);
+    // What Parse reads back
+    static std::string Format(SoundStorage storage);
+
+private:
+    struct Job;
+
+    struct CompletionQueue
+    {
+        std::mutex                        mutex;
+        std::vector<std::shared_ptr<Job>> finished;
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<SoundBuffer> sound;
+        AssetHandle                  asset;
+        LoadPriority                 priority = LoadPriority::Visible;
+        LoadScheduler::Ticket        ticket   = 0; // of the first decode
+    };
+
+    struct PoolBuffer
+    {
+        ALuint                           buffer    = 0;
+        std::weak_ptr<const SoundBuffer> sound;
+        std::size_t                      bytes     = 0;
+        std::uint64_t                    last_used = 0;
+    };
+
+    LoadScheduler::Ticket submit(const std::shared_ptr<Job>& job);
+    // first decodes still queued with no handle left but the cache's own
+    void                  cancelUnwanted();
+    void                  evictToBudget();
+    // a reloaded sound's old buffer, to the ReleaseQueue, which waits for the sources that hold it
+    void                  retire(SoundBuffer& sound);
+    ALuint                decodeIntoPool(const SoundHandle& sound);
+    // Samples stay off the AL thread: formats the context turned out not to take go back to a worker
+    void                  convertOnWorker(const std::shared_ptr<Job>& job);
+
+private:
+    LoadScheduler&                           scheduler;
+    AssetRegistry&                           registry;
+    ReleaseQueue&                            releases;
+    const AssetPack*                         pack   = nullptr;
+    std::size_t                              budget = DEFAULT_BUDGET;
+    std::shared_ptr<CompletionQueue>         completed;
+    std::size_t                              in_flight = 0;
+    std::unordered_map<std::uint64_t, Entry> entries; // by AssetId hash
+    std::vector<PoolBuffer>                  decode_pool;
+    std::uint64_t                            pool_clock = 0;
+    SoundStorage                             storage    = SoundStorage::Pcm;
+    Stats                                    stats;
+};
@@ -0,0 +1,487 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "sound_loader.h"
+
+#include "audio_kernels.h"
+#include "decode_scratch.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <gsl/gsl>
+#define STB_VORBIS_HEADER_ONLY
+#include <stb_vorbis.c>
+
+namespace
+{
+    constexpr int MAX_CHANNELS = 8;
+
+    enum FormatBits : unsigned
+    {
+        FORMATS_KNOWN        = 1u << 0,
+        FORMATS_FLOAT32      = 1u << 1,
+        FORMATS_MULTICHANNEL = 1u << 2,
+        FORMATS_IMA4         = 1u << 3
+    };
+
+    // written by DetectAudioFormats and read by uploads, all on the AL thread; AL_NONE where the context has no such format
+    ALenum                al_formats[MAX_CHANNELS + 1][3] = {};
+    ALenum                ima4_formats[3]                 = {};
+    std::atomic<unsigned> detected_formats{ 0 }; // FormatBits, for the decode workers
+
+    int type_index(SampleType type)
+    {
+        switch (type)
+        {
+            case SampleType::Unsigned8: return 0;
+            case SampleType::Signed16: return 1;
+            case SampleType::Float32: return 2;
+        }
+        return 0;
+    }
+
+    SDL_AudioFormat to_sdl_format(SampleType type)
+    {
+        switch (type)
+        {
+            case SampleType::Unsigned8: return AUDIO_U8;
+            case SampleType::Signed16: return AUDIO_S16SYS;
+            case SampleType::Float32: return AUDIO_F32SYS;
+        }
+        return AUDIO_S16SYS;
+    }
+
+    // AL_EXT_MCFORMATS has quad, 5.1, 6.1 and 7.1; everything else past stereo gets mixed down to it
+    int playable_channels(int channels, const AudioFormats& formats)
+    {
+        const bool multichannel = !formats.known || formats.multichannel;
+        if (channels <= 2 || (multichannel && (channels == 4 || channels == 6 || channels == 7 || channels == 8)))
+            return channels;
+        return 2;
+    }
+
+    bool convert_samples(DecodedSound& sound, SDL_AudioFormat from_format, SampleType to_type, int to_channels)
+    {
+        SDL_AudioCVT cvt;
+        if (SDL_BuildAudioCVT(&cvt, from_format, gsl::narrow_cast<Uint8>(sound.channels), sound.frequency, to_sdl_format(to_type), gsl::narrow_cast<Uint8>(to_channels), sound.frequency) < 0)
+        {
+            sound.error = SDL_GetError();
+            return false;
+        }
+        if (cvt.needed != 0)
+        {
+            std::vector<unsigned char> converted(sound.samples.size() * static_cast<std::size_t>(cvt.len_mult));
+            std::memcpy(converted.data(), sound.samples.data(), sound.samples.size());
+            cvt.buf = converted.data();
+            cvt.len = gsl::narrow_cast<int>(sound.samples.size());
+            if (SDL_ConvertAudio(&cvt) != 0)
+            {
+                sound.error = SDL_GetError();
+                return false;
+            }
+            converted.resize(static_cast<std::size_t>(cvt.len_cvt));
+            sound.samples = std::move(converted);
+        }
+        sound.type     = to_type;
+        sound.channels = to_channels;
+        return true;
+    }
+
+    // Vorbis puts the center second and the LFE last; OpenAL wants FL FR FC LFE and then the rest
+    void reorder_vorbis_channels(DecodedSound& sound)
+    {
+        static constexpr int ORDER_51[] = { 0, 2, 1, 5, 3, 4 };
+        static constexpr int ORDER_61[] = { 0, 2, 1, 6, 5, 3, 4 };
+        static constexpr int ORDER_71[] = { 0, 2, 1, 7, 5, 6, 3, 4 };
+
+        const int* order = sound.channels == 6 ? ORDER_51 : sound.channels == 7 ? ORDER_61 : sound.channels == 8 ? ORDER_71 : nullptr;
+        if (order == nullptr)
+            return;
+        const std::size_t channels = static_cast<std::size_t>(sound.channels);
+        auto*             samples  = reinterpret_cast<short*>(sound.samples.data());
+        short             frame[MAX_CHANNELS];
+        for (std::size_t offset = 0; offset + channels <= sound.samples.size() / sizeof(short); offset += channels)
+        {
+            std::copy_n(samples + offset, channels, frame);
+            for (std::size_t c = 0; c < channels; ++c)
+                samples[offset + c] = frame[order[c]];
+        }
+    }
+
+    // takes ownership of `stream`, the same as SDL_LoadWAV_RW with freesrc = 1
+    bool decode_wav(SDL_RWops* stream, DecodedSound& out_sound)
+    {
+        SDL_AudioSpec wavSpec;
+        Uint32        wavLength = 0;
+        Uint8*        wavBuffer = nullptr;
+        if (stream == nullptr || SDL_LoadWAV_RW(stream, 1, &wavSpec, &wavBuffer, &wavLength) == nullptr)
+        {
+            out_sound.error = SDL_GetError();
+            return false;
+        }
+
+        out_sound.channels  = wavSpec.channels;
+        out_sound.frequency = wavSpec.freq;
+        out_sound.samples.assign(wavBuffer, wavBuffer + wavLength);
+        SDL_FreeWAV(wavBuffer);
+        switch (wavSpec.format)
+        {
+            case AUDIO_U8: out_sound.type = SampleType::Unsigned8; break;
+            case AUDIO_S16SYS: out_sound.type = SampleType::Signed16; break;
+            case AUDIO_F32SYS: out_sound.type = SampleType::Float32; break;
+            default:
+                // signed 8-bit, 32-bit integer, the other byte order: nothing OpenAL takes as is
+                if (!convert_samples(out_sound, wavSpec.format, SampleType::Signed16, out_sound.channels))
+                    return false;
+                break;
+        }
+        return ConvertForOpenAL(out_sound, GetAudioFormats());
+    }
+
+    constexpr std::size_t IMA4_BLOCK_FRAMES        = 65; // the header's sample plus 64 coded ones
+    constexpr std::size_t IMA4_CHANNEL_BLOCK_BYTES = 36; // 4 byte header and 32 bytes of nibbles
+
+    // https://wiki.multimedia.cx/index.php/IMA_ADPCM
+    constexpr int IMA_STEPS[89] = { 7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279,
+                                    307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428,
+                                    4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767 };
+    constexpr int IMA_INDEX_STEPS[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+
+    struct ImaChannel
+    {
+        int predictor = 0;
+        int index     = 0;
+    };
+
+    // tracks the decoder's reconstruction rather than the input, so the error never accumulates
+    unsigned char encode_ima(ImaChannel& channel, int sample)
+    {
+        const int     step   = IMA_STEPS[channel.index];
+        int           diff   = sample - channel.predictor;
+        unsigned char nibble = 0;
+        if (diff < 0)
+        {
+            nibble = 8;
+            diff   = -diff;
+        }
+        int delta = step >> 3;
+        if (diff >= step)
+        {
+            nibble |= 4;
+            diff -= step;
+            delta += step;
+        }
+        if (diff >= step >> 1)
+        {
+            nibble |= 2;
+            diff -= step >> 1;
+            delta += step >> 1;
+        }
+        if (diff >= step >> 2)
+        {
+            nibble |= 1;
+            delta += step >> 2;
+        }
+        channel.predictor = std::clamp(channel.predictor + ((nibble & 8) != 0 ? -delta : delta), -32768, 32767);
+        channel.index     = std::clamp(channel.index + IMA_INDEX_STEPS[nibble], 0, 88);
+        return nibble;
+    }
+
+    bool read_file(const std::filesystem::path& filename, std::vector<unsigned char>& out_bytes, std::string& out_error)
+    {
+        std::size_t size = 0;
+        void*       data = SDL_LoadFile(filename.string().c_str(), &size);
+        if (data == nullptr)
+        {
+            out_error = SDL_GetError();
+            return false;
+        }
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        out_bytes.assign(bytes, bytes + size);
+        SDL_free(data);
+        return true;
+    }
+}
+
+bool DecodeSoundFile(const std::filesystem::path& filename, DecodedSound& out_sound)
+{
+    if (filename.extension() == ".ogg")
+    {
+        std::vector<unsigned char> bytes;
+        return read_file(filename, bytes, out_sound.error) && DecodeOgg(bytes, out_sound);
+    }
+    return decode_wav(SDL_RWFromFile(filename.string().c_str(), "rb"), out_sound);
+}
+
+bool DecodeWav(std::span<const unsigned char> bytes, DecodedSound& out_sound)
+{
+    return decode_wav(SDL_RWFromConstMem(bytes.data(), gsl::narrow_cast<int>(bytes.size())), out_sound);
+}
+
+bool DecodeOgg(std::span<const unsigned char> bytes, DecodedSound& out_sound)
+{
+    // setup tables for ordinary files fit in the first try; a bigger block is only an arena bump away
+    constexpr int VORBIS_SCRATCH_BYTES     = 256 * 1024;
+    constexpr int MAX_VORBIS_SCRATCH_BYTES = 16 * 1024 * 1024;
+
+    const decode_scratch::Scope scratch;
+    stb_vorbis*                 vorbis = nullptr;
+    stb_vorbis_alloc            alloc{};
+    int                         error  = VORBIS__no_error;
+    for (int size = VORBIS_SCRATCH_BYTES; vorbis == nullptr && size <= MAX_VORBIS_SCRATCH_BYTES; size *= 2)
+    {
+        alloc  = stb_vorbis_alloc{ static_cast<char*>(decode_scratch::Allocate(static_cast<std::size_t>(size))), size };
+        vorbis = alloc.alloc_buffer != nullptr ? stb_vorbis_open_memory(bytes.data(), gsl::narrow_cast<int>(bytes.size()), &error, &alloc) : nullptr;
+        if (vorbis == nullptr)
+        {
+            decode_scratch::Free(alloc.alloc_buffer);
+            if (error != VORBIS_outofmem)
+                break;
+        }
+    }
+    if (vorbis == nullptr)
+    {
+        out_sound.error = "Failed to decode OGG (stb_vorbis error " + std::to_string(error) + ")";
+        return false;
+    }
+
+    // stb_vorbis mixes down by itself when asked for fewer channels than the file has
+    const stb_vorbis_info info         = stb_vorbis_get_info(vorbis);
+    const int             out_channels = playable_channels(info.channels, GetAudioFormats());
+    const std::size_t     channels     = static_cast<std::size_t>(out_channels);
+    const std::size_t     frame_bytes  = channels * sizeof(short);
+    std::size_t           frames       = 0;
+    std::size_t           frames_space = std::max<std::size_t>(stb_vorbis_stream_length_in_samples(vorbis), 4096);
+    out_sound.samples.resize(frames_space * frame_bytes);
+    while (true)
+    {
+        if (frames == frames_space)
+        {
+            frames_space *= 2;
+            out_sound.samples.resize(frames_space * frame_bytes);
+        }
+        auto*     destination = reinterpret_cast<short*>(out_sound.samples.data() + frames * frame_bytes);
+        const int decoded     = stb_vorbis_get_samples_short_interleaved(vorbis, out_channels, destination, gsl::narrow_cast<int>((frames_space - frames) * channels));
+        if (decoded <= 0)
+            break;
+        frames += static_cast<std::size_t>(decoded);
+    }
+    stb_vorbis_close(vorbis);
+    decode_scratch::Free(alloc.alloc_buffer);
+
+    out_sound.samples.resize(frames * frame_bytes);
+    out_sound.type          = SampleType::Signed16;
+    out_sound.channels      = out_channels;
+    out_sound.frequency     = static_cast<int>(info.sample_rate);
+    out_sound.scratch_bytes = scratch.PeakBytes();
+    reorder_vorbis_channels(out_sound);
+    return true;
+}
+
+void DetectAudioFormats()
+{
+    for (auto& row : al_formats)
+        std::fill(std::begin(row), std::end(row), AL_NONE);
+    std::fill(std::begin(ima4_formats), std::end(ima4_formats), AL_NONE);
+    al_formats[1][0] = AL_FORMAT_MONO8;
+    al_formats[1][1] = AL_FORMAT_MONO16;
+    al_formats[2][0] = AL_FORMAT_STEREO8;
+    al_formats[2][1] = AL_FORMAT_STEREO16;
+
+    unsigned bits = FORMATS_KNOWN;
+    if (alIsExtensionPresent("AL_EXT_FLOAT32") == AL_TRUE)
+    {
+        bits |= FORMATS_FLOAT32;
+        al_formats[1][2] = alGetEnumValue("AL_FORMAT_MONO_FLOAT32");
+        al_formats[2][2] = alGetEnumValue("AL_FORMAT_STEREO_FLOAT32");
+    }
+    if (alIsExtensionPresent("AL_EXT_MCFORMATS") == AL_TRUE)
+    {
+        struct Layout
+        {
+            int         channels;
+            const char* names[3];
+        };
+        // the 32-bit layouts are float, so they come with AL_EXT_FLOAT32
+        static constexpr Layout LAYOUTS[] = {
+            { 4, { "AL_FORMAT_QUAD8", "AL_FORMAT_QUAD16", "AL_FORMAT_QUAD32" } },
+            { 6, { "AL_FORMAT_51CHN8", "AL_FORMAT_51CHN16", "AL_FORMAT_51CHN32" } },
+            { 7, { "AL_FORMAT_61CHN8", "AL_FORMAT_61CHN16", "AL_FORMAT_61CHN32" } },
+            { 8, { "AL_FORMAT_71CHN8", "AL_FORMAT_71CHN16", "AL_FORMAT_71CHN32" } },
+        };
+        bits |= FORMATS_MULTICHANNEL;
+        for (const Layout& layout : LAYOUTS)
+        {
+            for (int type = 0; type < 3; ++type)
+            {
+                if (type < 2 || (bits & FORMATS_FLOAT32) != 0)
+                    al_formats[layout.channels][type] = alGetEnumValue(layout.names[type]);
+            }
+        }
+    }
+    if (alIsExtensionPresent("AL_EXT_IMA4") == AL_TRUE)
+    {
+        bits |= FORMATS_IMA4;
+        ima4_formats[1] = alGetEnumValue("AL_FORMAT_MONO_IMA4");
+        ima4_formats[2] = alGetEnumValue("AL_FORMAT_STEREO_IMA4");
+    }
+    detected_formats.store(bits, std::memory_order_release);
+}
+
+AudioFormats GetAudioFormats() noexcept
+{
+    const unsigned bits = detected_formats.load(std::memory_order_acquire);
+    AudioFormats   formats;
+    formats.known        = (bits & FORMATS_KNOWN) != 0;
+    formats.float32      = (bits & FORMATS_FLOAT32) != 0;
+    formats.multichannel = (bits & FORMATS_MULTICHANNEL) != 0;
+    formats.ima4         = (bits & FORMATS_IMA4) != 0;
+    return formats;
+}
+
+ALenum FindOpenALFormat(SampleType type, int channels) noexcept
+{
+    if (channels < 1 || channels > MAX_CHANNELS)
+        return AL_NONE;
+    return al_formats[channels][type_index(type)];
+}
+
+bool ConvertForOpenAL(DecodedSound& sound, const AudioFormats& formats)
+{
+    const int  channels = playable_channels(sound.channels, formats);
+    SampleType type     = sound.type;
+    if (type == SampleType::Float32 && formats.known && !formats.float32)
+        type = SampleType::Signed16;
+    if (channels == sound.channels && type == sound.type)
+        return true;
+    if (channels == sound.channels && sound.type == SampleType::Float32)
+    {
+        // the common case, float Vorbis or WAV on a driver without AL_EXT_FLOAT32, skips SDL's converters
+        const std::size_t          count = sound.samples.size() / sizeof(float);
+        std::vector<float>         floats(count);
+        std::vector<unsigned char> converted(count * sizeof(std::int16_t));
+        std::memcpy(floats.data(), sound.samples.data(), count * sizeof(float));
+        audio_kernels::F32ToS16(floats.data(), reinterpret_cast<std::int16_t*>(converted.data()), count);
+        sound.samples = std::move(converted);
+        sound.type    = SampleType::Signed16;
+        return true;
+    }
+    return convert_samples(sound, to_sdl_format(sound.type), type, channels);
+}
+
+bool UploadSound(const DecodedSound& sound, ALuint out_buffer)
+{
+    const ALenum format = FindOpenALFormat(sound.type, sound.channels);
+    if (format == AL_NONE)
+    {
+        SDL_SetError("No OpenAL format for %d channel(s) of this sample type", sound.channels);
+        return false;
+    }
+    alGetError();
+    alBufferData(out_buffer, format, sound.samples.data(), gsl::narrow_cast<ALsizei>(sound.samples.size()), sound.frequency);
+    if (const ALenum error = alGetError(); error != AL_NO_ERROR)
+    {
+        SDL_SetError("alBufferData failed: %s", alGetString(error));
+        return false;
+    }
+    return true;
+}
+
+bool EncodeIma4(const DecodedSound& sound, std::vector<unsigned char>& out_blocks)
+{
+    if (sound.type != SampleType::Signed16 || (sound.channels != 1 && sound.channels != 2))
+        return false;
+    const std::size_t channels = static_cast<std::size_t>(sound.channels);
+    const std::size_t frames   = sound.samples.size() / (channels * sizeof(std::int16_t));
+    const std::size_t blocks   = (frames + IMA4_BLOCK_FRAMES - 1) / IMA4_BLOCK_FRAMES;
+    const auto        sample   = [&sound, channels, frames](std::size_t frame, std::size_t channel)
+    {
+        std::int16_t value = 0;
+        if (frame < frames)
+            std::memcpy(&value, sound.samples.data() + (frame * channels + channel) * sizeof(std::int16_t), sizeof(value));
+        return static_cast<int>(value);
+    };
+
+    out_blocks.assign(blocks * channels * IMA4_CHANNEL_BLOCK_BYTES, 0);
+    ImaChannel state[2];
+    for (std::size_t block = 0; block < blocks; ++block)
+    {
+        const std::size_t first = block * IMA4_BLOCK_FRAMES;
+        unsigned char*    out   = out_blocks.data() + block * channels * IMA4_CHANNEL_BLOCK_BYTES;
+        for (std::size_t c = 0; c < channels; ++c)
+        {
+            // each block restarts from an exact sample; the step index carries over
+            state[c].predictor = sample(first, c);
+            out[c * 4 + 0]     = static_cast<unsigned char>(state[c].predictor & 0xFF);
+            out[c * 4 + 1]     = static_cast<unsigned char>((state[c].predictor >> 8) & 0xFF);
+            out[c * 4 + 2]     = static_cast<unsigned char>(state[c].index);
+        }
+        out += channels * 4;
+        for (std::size_t group = 0; group < 8; ++group)
+        {
+            for (std::size_t c = 0; c < channels; ++c)
+            {
+                for (std::size_t pair = 0; pair < 4; ++pair)
+                {
+                    const std::size_t   frame = first + 1 + group * 8 + pair * 2;
+                    const unsigned char low   = encode_ima(state[c], sample(frame, c));
+                    const unsigned char high  = encode_ima(state[c], sample(frame + 1, c));
+                    *out++                    = static_cast<unsigned char>(low | (high << 4));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool IsIma4Supported()
+{
+    return GetAudioFormats().ima4;
+}
+
+bool UploadIma4(std::span<const unsigned char> blocks, int channels, int frequency, ALuint out_buffer)
+{
+    const ALenum format = channels == 1 || channels == 2 ? ima4_formats[channels] : AL_NONE;
+    if (format == AL_NONE)
+    {
+        SDL_SetError("No OpenAL IMA4 format for %d channel(s)", channels);
+        return false;
+    }
+    alGetError();
+    alBufferData(out_buffer, format, blocks.data(), gsl::narrow_cast<ALsizei>(blocks.size()), frequency);
+    if (const ALenum error = alGetError(); error != AL_NO_ERROR)
+    {
+        SDL_SetError("alBufferData failed: %s", alGetString(error));
+        return false;
+    }
+    return true;
+}
+
+bool LoadWavFromFile(const std::filesystem::path& filename, ALuint out_buffer)
+{
+    DecodedSound sound;
+    if (!decode_wav(SDL_RWFromFile(filename.string().c_str(), "rb"), sound))
+    {
+        SDL_SetError("%s", sound.error.c_str());
+        return false;
+    }
+    return UploadSound(sound, out_buffer);
+}
+
+bool LoadWavFromMemory(std::span<const unsigned char> bytes, ALuint out_buffer)
+{
+    DecodedSound sound;
+    if (!DecodeWav(bytes, sound))
+    {
+        SDL_SetError("%s", sound.error.c_str());
+        return false;
+    }
+    return UploadSound(sound, out_buffer);
+}
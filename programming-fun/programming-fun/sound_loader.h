@@ -0,0 +1,76 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <al.h>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+enum class SampleType
+{
+    Unsigned8,
+    Signed16,
+    Float32
+};
+
+// What the AL context takes beyond core mono/stereo 8/16-bit, from DetectAudioFormats
+struct AudioFormats
+{
+    bool known        = false; // until the context exists decoders assume the extensions are there; SoundCache converts again if not
+    bool float32      = false; // AL_EXT_FLOAT32
+    bool multichannel = false; // AL_EXT_MCFORMATS: quad, 5.1, 6.1 and 7.1
+    bool ima4         = false; // AL_EXT_IMA4
+};
+
+// Interleaved PCM for a whole sound, ready for alBufferData; multichannel in OpenAL's order (FL FR FC LFE ...)
+struct DecodedSound
+{
+    std::vector<unsigned char> samples;
+    SampleType                 type      = SampleType::Signed16;
+    int                        channels  = 0;
+    int                        frequency = 0;
+    std::string                error;             // why decoding failed, SDL_GetError() is per thread
+    std::size_t                scratch_bytes = 0; // decoder working memory at its peak, see decode_scratch
+};
+
+/**
+ * Decoding touches no OpenAL state, so it can run on any thread; UploadSound must run where the AL context is current.
+ *
+ * WAV goes through SDL_LoadWAV_RW (SDL_RWFromConstMem for memory), OGG through stb_vorbis with its
+ * working memory in the thread's decode_scratch arena, decoding straight into `samples`.
+ * Memory overloads read in place; the bytes only need to live for the duration of the call.
+ * Both finish with ConvertForOpenAL, so whatever the file holds comes out in a format the context takes.
+ */
+bool DecodeSoundFile(const std::filesystem::path& filename, DecodedSound& out_sound);
+bool DecodeWav(std::span<const unsigned char> bytes, DecodedSound& out_sound);
+bool DecodeOgg(std::span<const unsigned char> bytes, DecodedSound& out_sound);
+bool UploadSound(const DecodedSound& sound, ALuint out_buffer);
+
+// Call on the AL thread whenever a context is made current; GetAudioFormats is then safe from any thread
+void         DetectAudioFormats();
+AudioFormats GetAudioFormats() noexcept;
+// AL_NONE when the context has no such format; AL thread only
+ALenum       FindOpenALFormat(SampleType type, int channels) noexcept;
+// SDL_AudioCVT to 16-bit without AL_EXT_FLOAT32, and down to stereo for layouts AL_EXT_MCFORMATS lacks
+bool         ConvertForOpenAL(DecodedSound& sound, const AudioFormats& formats);
+
+/**
+ * IMA ADPCM in the block layout AL_EXT_IMA4 reads by default: 65 frames per block, each channel's
+ * 4 byte header first, then the channels' nibbles interleaved 8 frames at a time. About a quarter
+ * of the 16-bit size; the tail is padded with silence to a whole block. Signed16 mono or stereo only.
+ */
+bool EncodeIma4(const DecodedSound& sound, std::vector<unsigned char>& out_blocks);
+// Both after DetectAudioFormats
+bool IsIma4Supported();
+bool UploadIma4(std::span<const unsigned char> blocks, int channels, int frequency, ALuint out_buffer);
+
+// Decode and upload in one go; false on failure with the reason in SDL_GetError()
+bool LoadWavFromFile(const std::filesystem::path& filename, ALuint out_buffer);
+bool LoadWavFromMemory(std::span<const unsigned char> bytes, ALuint out_buffer);
@@ -0,0 +1,404 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "spatial_audio.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <alc.h>
+#include <cmath>
+#include <glm/geometric.hpp>
+
+namespace
+{
+    // from OpenAL Soft's alext.h, which external/include doesn't carry
+    using DeferUpdatesFn   = void(AL_APIENTRY*)();
+    using ProcessUpdatesFn = void(AL_APIENTRY*)();
+
+    DeferUpdatesFn   defer_updates   = nullptr;
+    ProcessUpdatesFn process_updates = nullptr;
+
+    // a voiced emitter ranks this much louder, so two about as loud don't trade a voice every frame
+    constexpr float KEEP_BIAS = 1.1f;
+
+    float buffer_seconds(ALuint buffer)
+    {
+        ALint size = 0, bits = 0, channels = 0, frequency = 0;
+        alGetBufferi(buffer, AL_SIZE, &size);
+        alGetBufferi(buffer, AL_BITS, &bits);
+        alGetBufferi(buffer, AL_CHANNELS, &channels);
+        alGetBufferi(buffer, AL_FREQUENCY, &frequency);
+        const ALint bytes_per_second = bits / 8 * channels * frequency;
+        return bytes_per_second > 0 ? static_cast<float>(size) / static_cast<float>(bytes_per_second) : 0.0f;
+    }
+
+    // what AL_LINEAR_DISTANCE_CLAMPED leaves of the gain this far out, 0 to 1
+    float attenuation_at(float distance_squared, const EmitterParams& params)
+    {
+        const float distance = std::sqrt(distance_squared);
+        const float span     = params.max_distance - params.reference_distance;
+        if (span <= 0.0f)
+            return 1.0f;
+        return 1.0f - (std::clamp(distance, params.reference_distance, params.max_distance) - params.reference_distance) / span;
+    }
+
+    AudioLod lod_for(float attenuation, AudioLod previous)
+    {
+        if (attenuation >= SpatialAudio::NEAR_ATTENUATION)
+            return AudioLod::Near;
+        const float distant_below = SpatialAudio::DISTANT_ATTENUATION + (previous == AudioLod::Distant ? SpatialAudio::LOD_HYSTERESIS : 0.0f);
+        return attenuation < distant_below ? AudioLod::Distant : AudioLod::Far;
+    }
+
+    // what's left of the direct path, overall and in the highs
+    float occluded_gain(float occlusion)
+    {
+        return 1.0f - (1.0f - SpatialAudio::OCCLUDED_GAIN) * occlusion;
+    }
+
+    float occluded_gain_hf(float occlusion)
+    {
+        return 1.0f - (1.0f - SpatialAudio::OCCLUDED_GAIN_HF) * occlusion;
+    }
+}
+
+void SpatialAudio::Setup(int new_voice_budget)
+{
+    voice_budget    = std::max(1, new_voice_budget);
+    defer_updates   = nullptr;
+    process_updates = nullptr;
+    if (alIsExtensionPresent("AL_SOFT_deferred_updates") == AL_TRUE)
+    {
+        defer_updates   = reinterpret_cast<DeferUpdatesFn>(alGetProcAddress("alDeferUpdatesSOFT"));
+        process_updates = reinterpret_cast<ProcessUpdatesFn>(alGetProcAddress("alProcessUpdatesSOFT"));
+    }
+    stats.deferred = defer_updates != nullptr && process_updates != nullptr;
+    listener.moved = true;
+}
+
+void SpatialAudio::Shutdown(VoicePool& voices)
+{
+    for (const VoiceId voice : voices_of)
+        voices.Stop(voice);
+    positions.clear();
+    max_distances_squared.clear();
+    moved.clear();
+    alive.clear();
+    generations.clear();
+    buffers.clear();
+    params.clear();
+    voices_of.clear();
+    playheads.clear();
+    durations.clear();
+    lods.clear();
+    on_distant.clear();
+    occlusion_targets.clear();
+    occlusions.clear();
+    sent_occlusions.clear();
+    free_emitters.clear();
+    live_count = 0;
+    stats      = Stats{ .deferred = stats.deferred };
+}
+
+EmitterId SpatialAudio::Add(ALuint buffer, const glm::vec3& position, const EmitterParams& emitter_params)
+{
+    std::uint32_t index = 0;
+    if (!free_emitters.empty())
+    {
+        index = free_emitters.back();
+        free_emitters.pop_back();
+    }
+    else
+    {
+        index = static_cast<std::uint32_t>(positions.size());
+        positions.emplace_back();
+        max_distances_squared.push_back(0.0f);
+        moved.push_back(0);
+        alive.push_back(0);
+        generations.push_back(0);
+        buffers.push_back(0);
+        params.emplace_back();
+        voices_of.emplace_back();
+        playheads.push_back(0.0f);
+        durations.push_back(0.0f);
+        lods.push_back(AudioLod::Near);
+        on_distant.push_back(0);
+        occlusion_targets.push_back(0.0f);
+        occlusions.push_back(0.0f);
+        sent_occlusions.push_back(0.0f);
+    }
+    generations[index] += 1;
+    if (generations[index] == 0)
+        generations[index] = 1;
+    positions[index]             = position;
+    max_distances_squared[index] = emitter_params.max_distance * emitter_params.max_distance;
+    moved[index]                 = 1;
+    alive[index]                 = 1;
+    buffers[index]               = buffer;
+    params[index]                = emitter_params;
+    voices_of[index]             = VoiceId{};
+    playheads[index]             = 0.0f;
+    durations[index]             = buffer_seconds(buffer);
+    lods[index]                  = AudioLod::Near;
+    on_distant[index]            = 0;
+    occlusion_targets[index]     = 0.0f;
+    occlusions[index]            = 0.0f;
+    sent_occlusions[index]       = 0.0f;
+    ++live_count;
+    return EmitterId{ index, generations[index] };
+}
+
+void SpatialAudio::Remove(EmitterId emitter, VoicePool& voices)
+{
+    if (!owns(emitter))
+        return;
+    voices.Stop(voices_of[emitter.index]);
+    retire(emitter.index);
+}
+
+void SpatialAudio::SetPosition(EmitterId emitter, const glm::vec3& position) noexcept
+{
+    if (!owns(emitter))
+        return;
+    positions[emitter.index] = position;
+    moved[emitter.index]     = 1;
+}
+
+void SpatialAudio::SetListener(const glm::vec3& position, const glm::vec3& forward, const glm::vec3& up) noexcept
+{
+    listener.position = position;
+    listener.forward  = forward;
+    listener.up       = up;
+    listener.moved    = true;
+}
+
+void SpatialAudio::SetOcclusion(EmitterId emitter, float occlusion) noexcept
+{
+    if (owns(emitter))
+        occlusion_targets[emitter.index] = std::clamp(occlusion, 0.0f, 1.0f);
+}
+
+bool SpatialAudio::IsAlive(EmitterId emitter) const noexcept
+{
+    return owns(emitter);
+}
+
+void SpatialAudio::Update(VoicePool& voices, float delta_seconds)
+{
+    PROFILE_ZONE("SpatialAudio::Update");
+    stats.started        = 0;
+    stats.resumed        = 0;
+    stats.stopped        = 0;
+    stats.finished       = 0;
+    stats.source_updates = 0;
+    stats.lod_near       = 0;
+    stats.lod_far        = 0;
+    stats.lod_distant    = 0;
+    stats.low_rate       = 0;
+    stats.held_back      = 0;
+    stats.lod_swaps      = 0;
+    stats.occluded       = 0;
+    stats.filter_updates = 0;
+    ++updates;
+    advance(voices, delta_seconds);
+    stats.emitters = live_count;
+
+    // distances and gains only, nothing here talks to AL
+    const std::size_t count = positions.size();
+    const float       ease  = 1.0f - std::exp(-std::max(delta_seconds, 0.0f) / OCCLUSION_SECONDS);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float gap = occlusion_targets[i] - occlusions[i];
+        occlusions[i]   = std::abs(gap) < 0.001f ? occlusion_targets[i] : occlusions[i] + gap * ease;
+    }
+    candidates.clear();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (alive[i] == 0)
+            continue;
+        const glm::vec3 offset           = positions[i] - listener.position;
+        const float     distance_squared = glm::dot(offset, offset);
+        if (distance_squared >= max_distances_squared[i])
+            continue;
+        const bool  voiced      = voices.IsCurrent(voices_of[i]);
+        const float attenuation = attenuation_at(distance_squared, params[i]);
+        const float loudness    = params[i].gain * attenuation * occluded_gain(occlusions[i]);
+        lods[i]                 = lod_for(attenuation, lods[i]);
+        stats.lod_near += lods[i] == AudioLod::Near ? 1 : 0;
+        stats.lod_far += lods[i] == AudioLod::Far ? 1 : 0;
+        stats.lod_distant += lods[i] == AudioLod::Distant ? 1 : 0;
+        candidates.push_back(Candidate{ voiced ? loudness * KEEP_BIAS : loudness, static_cast<std::uint32_t>(i) });
+    }
+    stats.audible = static_cast<int>(candidates.size());
+    if (candidates.size() > static_cast<std::size_t>(voice_budget))
+    {
+        const auto louder = [](const Candidate& a, const Candidate& b) { return a.loudness > b.loudness; };
+        std::nth_element(candidates.begin(), candidates.begin() + voice_budget, candidates.end(), louder);
+        candidates.resize(static_cast<std::size_t>(voice_budget));
+    }
+    wanted.assign(count, 0);
+    for (const Candidate& candidate : candidates)
+        wanted[candidate.emitter] = 1;
+
+    beginBatch();
+    // stops first, so the voices they free can go straight to the emitters that won them
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (wanted[i] != 0 || !voices_of[i].IsValid())
+            continue;
+        if (voices.IsCurrent(voices_of[i]))
+        {
+            // the mixer's offset beats the software clock, which only estimated it while voiced
+            if (const float seconds = voices.PlaybackSeconds(voices_of[i]); seconds >= 0.0f)
+                playheads[i] = seconds;
+            voices.Stop(voices_of[i]);
+            ++stats.stopped;
+        }
+        voices_of[i] = VoiceId{};
+    }
+    if (listener.moved)
+    {
+        const ALfloat orientation[] = { listener.forward.x, listener.forward.y, listener.forward.z, listener.up.x, listener.up.y, listener.up.z };
+        alListener3f(AL_POSITION, listener.position.x, listener.position.y, listener.position.z);
+        alListenerfv(AL_ORIENTATION, orientation);
+        listener.moved = false;
+        stats.source_updates += 2;
+    }
+    int voiced = 0;
+    for (const Candidate& candidate : candidates)
+    {
+        const std::uint32_t i            = candidate.emitter;
+        const bool          is_low_rate  = lods[i] == AudioLod::Distant && params[i].looping && params[i].distant_buffer != 0;
+        const bool          is_scheduled = lods[i] == AudioLod::Near || (updates + i) % FAR_INTERVAL == 0;
+        if (voices.IsCurrent(voices_of[i]) && (on_distant[i] != 0) != is_low_rate)
+        {
+            // the other buffer from where this one got to; a restart a mixer period long is lost in the distance
+            if (const float seconds = voices.PlaybackSeconds(voices_of[i]); seconds >= 0.0f)
+                playheads[i] = seconds;
+            voices.Stop(voices_of[i]);
+            voices_of[i] = VoiceId{};
+            ++stats.lod_swaps;
+        }
+        if (voices.IsCurrent(voices_of[i]))
+        {
+            if (moved[i] != 0 && is_scheduled)
+            {
+                voices.Place(voices_of[i], positions[i]);
+                moved[i] = 0;
+                ++stats.source_updates;
+            }
+            else if (moved[i] != 0)
+            {
+                ++stats.held_back;
+            }
+        }
+        else
+        {
+            VoiceParams voice_params;
+            voice_params.gain               = params[i].gain;
+            voice_params.pitch              = params[i].pitch;
+            voice_params.priority           = params[i].priority;
+            voice_params.looping            = params[i].looping;
+            voice_params.max_distance       = params[i].max_distance;
+            voice_params.reference_distance = params[i].reference_distance;
+            voice_params.offset_seconds     = playheads[i];
+            voice_params.position           = positions[i];
+            voices_of[i]                    = voices.Play(is_low_rate ? params[i].distant_buffer : buffers[i], voice_params);
+            if (!voices_of[i].IsValid())
+                continue;
+            on_distant[i]      = is_low_rate ? 1 : 0;
+            moved[i]           = 0;
+            sent_occlusions[i] = 0.0f;
+            ++stats.started;
+            if (playheads[i] > 0.0f)
+                ++stats.resumed;
+        }
+        // in steps while it glides, and the settled value once it gets there
+        const float occlusion = occlusions[i];
+        if (voices.HasLowPass() && occlusion != sent_occlusions[i] && (std::abs(occlusion - sent_occlusions[i]) >= OCCLUSION_STEP || occlusion == occlusion_targets[i]))
+        {
+            voices.SetLowPass(voices_of[i], occluded_gain(occlusion), occluded_gain_hf(occlusion));
+            sent_occlusions[i] = occlusion;
+            ++stats.filter_updates;
+        }
+        stats.occluded += sent_occlusions[i] > 0.0f ? 1 : 0;
+        stats.low_rate += on_distant[i];
+        ++voiced;
+    }
+    endBatch();
+
+    // emitters out of range and held back moves keep their flag, so the position goes out when they are sent
+    stats.voiced      = voiced;
+    stats.virtualized = live_count - voiced;
+}
+
+int SpatialAudio::EmitterCount() const noexcept
+{
+    return live_count;
+}
+
+const SpatialAudio::Stats& SpatialAudio::GetStats() const noexcept
+{
+    return stats;
+}
+
+void SpatialAudio::advance(VoicePool& voices, float delta_seconds)
+{
+    const std::size_t count = positions.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (alive[i] == 0)
+            continue;
+        const float duration = durations[i];
+        playheads[i] += delta_seconds * params[i].pitch;
+        if (duration <= 0.0f || playheads[i] < duration)
+            continue;
+        if (params[i].looping)
+        {
+            playheads[i] = std::fmod(playheads[i], duration);
+            continue;
+        }
+        // a voiced one-shot ends when its source does; the clock only guessed at the tail
+        if (voices.IsCurrent(voices_of[i]))
+        {
+            playheads[i] = duration;
+            continue;
+        }
+        retire(static_cast<std::uint32_t>(i));
+        ++stats.finished;
+    }
+}
+
+void SpatialAudio::retire(std::uint32_t index)
+{
+    voices_of[index] = VoiceId{};
+    alive[index]     = 0;
+    free_emitters.push_back(index);
+    --live_count;
+}
+
+bool SpatialAudio::owns(EmitterId emitter) const noexcept
+{
+    return emitter.IsValid() && emitter.index < positions.size() && alive[emitter.index] != 0 && generations[emitter.index] == emitter.generation;
+}
+
+void SpatialAudio::beginBatch()
+{
+    if (stats.deferred)
+        defer_updates();
+    else if (ALCcontext* context = alcGetCurrentContext(); context != nullptr)
+        alcSuspendContext(context);
+}
+
+void SpatialAudio::endBatch()
+{
+    if (stats.deferred)
+        process_updates();
+    else if (ALCcontext* context = alcGetCurrentContext(); context != nullptr)
+        alcProcessContext(context);
+}
@@ -0,0 +1,180 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "voice_pool.h"
+
+#include <al.h>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <vector>
+
+// Names one emitter; stale once it's removed and its index reused
+struct EmitterId
+{
+    std::uint32_t index      = 0;
+    std::uint32_t generation = 0; // 0 is never issued
+
+    bool IsValid() const noexcept
+    {
+        return generation != 0;
+    }
+};
+
+struct EmitterParams
+{
+    float  gain               = 1.0f;
+    float  pitch              = 1.0f;   // also how fast the playhead runs while the emitter is virtual
+    float  reference_distance = 1.0f;   // full gain up to this far from the listener
+    float  max_distance       = 100.0f; // silent from here on, so the emitter gives up its voice
+    int    priority           = 0;      // for the voice pool, against one-shots and the other emitters
+    bool   looping            = true;   // false plays the buffer once, then the emitter removes itself
+    ALuint distant_buffer     = 0;      // the buffer at a lower rate and the same length, SoundBuffer::distant_buffer; 0 for none
+};
+
+// How often an emitter's voice hears from Update, by how much of its gain distance leaves it
+enum class AudioLod : std::uint8_t
+{
+    Near,    // its position every Update it moved
+    Far,     // its position every FAR_INTERVAL Updates at most
+    Distant, // as Far, and a loop with a distant_buffer plays that instead
+};
+
+/**
+ * Positional emitters as virtual voices, thousands of them over a few dozen real ones.
+ *
+ * Every emitter is a logical playback whether or not it has a voice: its playhead advances in software
+ * by the update's elapsed time times its pitch, wrapping for a loop and removing a one-shot at the end of
+ * its buffer. Positions live in one array indexed by emitter, so moving them costs nothing AL side. Once a
+ * frame, Update drops every emitter past its max_distance (VoicePool::Setup picks the linear clamped model,
+ * so they are silent out there anyway), ranks the rest by the gain that model gives them at their distance,
+ * realizes the loudest up to the budget onto voices and virtualizes the others, and sends the listener plus
+ * every position that changed in one batch: between alDeferUpdatesSOFT and alProcessUpdatesSOFT where
+ * AL_SOFT_deferred_updates exists, else between alcSuspendContext and alcProcessContext.
+ *
+ * A voice taken back hands its mixer offset (AL_SEC_OFFSET) to the playhead, which keeps the software clock
+ * from drifting while it was voiced, and a voice given out starts at the playhead, so a sound that comes
+ * back into range picks up where it would have been. Buffers must be mono to be spatialized. All calls
+ * belong to the thread that owns the AL context.
+ *
+ * Voiced emitters are levelled by what the distance model leaves of their gain. Near ones send every move;
+ * Far ones send theirs every FAR_INTERVAL Updates, staggered by emitter so the sends spread over the Updates, and
+ * the moves in between wait. A Distant loop with a distant_buffer has its voice swapped onto that buffer at its
+ * playhead, and back once it is over DISTANT_ATTENUATION plus LOD_HYSTERESIS again, so an emitter hovering at the
+ * edge doesn't swap every Update.
+ *
+ * SetOcclusion gives an emitter a target, from AudioOcclusion's rays say, that its occlusion eases toward with a
+ * time constant of OCCLUSION_SECONDS whether or not it is voiced: a new target, however far from the last,
+ * is a glide of the low-pass instead of a click. A voice's filter is sent when the eased value has moved
+ * OCCLUSION_STEP since it was last sent, or has settled, and with none at all while it stays clear. Fully
+ * occluded is OCCLUDED_GAIN overall and OCCLUDED_GAIN_HF in the highs, which also ranks it for a voice.
+ */
+class SpatialAudio
+{
+public:
+    static constexpr int   DEFAULT_VOICE_BUDGET = 32;
+    static constexpr float NEAR_ATTENUATION     = 0.5f;  // at least this much of its gain left is Near
+    static constexpr float DISTANT_ATTENUATION  = 0.15f; // under this much is Distant
+    static constexpr float LOD_HYSTERESIS       = 0.05f; // over DISTANT_ATTENUATION a Distant emitter has to get before it isn't
+    static constexpr int   FAR_INTERVAL         = 4;     // Updates between a Far voice's sends
+    static constexpr float OCCLUSION_SECONDS    = 0.12f;
+    static constexpr float OCCLUSION_STEP       = 0.02f;
+    static constexpr float OCCLUDED_GAIN        = 0.5f;
+    static constexpr float OCCLUDED_GAIN_HF     = 0.05f;
+
+    struct Stats
+    {
+        int  emitters       = 0;
+        int  audible        = 0;     // within max_distance
+        int  voiced         = 0;
+        int  virtualized    = 0;     // alive without a voice, their playheads kept in software
+        int  started        = 0;     // this Update, swaps included
+        int  resumed        = 0;     // of those, how many picked up part way into their buffer
+        int  stopped        = 0;     // this Update, by culling or losing out to louder emitters
+        int  finished       = 0;     // one-shots that reached their end this Update
+        int  source_updates = 0;     // moves in this Update's batch, the listener's two calls included
+        int  lod_near       = 0;     // of the audible, by AudioLod
+        int  lod_far        = 0;
+        int  lod_distant    = 0;
+        int  low_rate       = 0;     // voiced on their distant_buffer
+        int  held_back      = 0;     // moves of Far and Distant voices left for a later Update
+        int  lod_swaps      = 0;     // voices moved between their buffers this Update
+        int  occluded       = 0;     // voiced with some occlusion
+        int  filter_updates = 0;     // low-pass changes in this Update's batch
+        bool deferred       = false; // AL_SOFT_deferred_updates, else a suspended context
+    };
+
+    // Needs a current AL context; at most `voice_budget` emitters play at once
+    void Setup(int voice_budget = DEFAULT_VOICE_BUDGET);
+    // Stops every emitter's voice and forgets the emitters; the buffers must stay alive until then
+    void Shutdown(VoicePool& voices);
+
+    EmitterId Add(ALuint buffer, const glm::vec3& position, const EmitterParams& params = {});
+    void      Remove(EmitterId emitter, VoicePool& voices);
+    void      SetPosition(EmitterId emitter, const glm::vec3& position) noexcept;
+    void      SetListener(const glm::vec3& position, const glm::vec3& forward, const glm::vec3& up) noexcept;
+    // 0 clear to 1 fully occluded; what the emitter's low-pass eases toward from the next Update
+    void      SetOcclusion(EmitterId emitter, float occlusion) noexcept;
+    // False once removed, including a one-shot that finished
+    bool      IsAlive(EmitterId emitter) const noexcept;
+
+    // `delta_seconds` since the previous Update moves every playhead
+    void Update(VoicePool& voices, float delta_seconds);
+
+    int          EmitterCount() const noexcept;
+    const Stats& GetStats() const noexcept;
+
+private:
+    bool owns(EmitterId emitter) const noexcept;
+    void advance(VoicePool& voices, float delta_seconds);
+    void retire(std::uint32_t index);
+    void beginBatch();
+    void endBatch();
+
+private:
+    // one entry per emitter index, live or not
+    std::vector<glm::vec3>     positions;
+    std::vector<float>         max_distances_squared;
+    std::vector<unsigned char> moved;
+    std::vector<unsigned char> alive;
+    std::vector<std::uint32_t> generations;
+    std::vector<ALuint>        buffers;
+    std::vector<EmitterParams> params;
+    std::vector<VoiceId>       voices_of;
+    std::vector<float>         playheads;  // seconds into the buffer
+    std::vector<float>         durations;  // of the buffer, in seconds; 0 when AL didn't say
+    std::vector<AudioLod>      lods;       // as of the last Update it was audible in
+    std::vector<unsigned char> on_distant; // its voice plays its distant_buffer
+    std::vector<float>         occlusion_targets;
+    std::vector<float>         occlusions;      // eased toward the target
+    std::vector<float>         sent_occlusions; // what its voice's filter has
+
+    struct Candidate
+    {
+        float         loudness = 0.0f;
+        std::uint32_t emitter  = 0;
+    };
+
+    // scratch for Update
+    std::vector<Candidate>     candidates;
+    std::vector<unsigned char> wanted;
+
+    struct
+    {
+        glm::vec3 position{ 0.0f };
+        glm::vec3 forward{ 0.0f, 0.0f, -1.0f };
+        glm::vec3 up{ 0.0f, 1.0f, 0.0f };
+        bool      moved = true;
+    } listener;
+
+    std::vector<std::uint32_t> free_emitters;
+    int                        voice_budget = DEFAULT_VOICE_BUDGET;
+    int                        live_count   = 0;
+    std::uint32_t              updates      = 0; // staggers the Far emitters' sends
+    Stats                      stats;
+};
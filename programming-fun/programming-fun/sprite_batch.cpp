@@ -0,0 +1,525 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "sprite_batch.h"
+
+#include "gl_extensions.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "memory_tracker.h"
+#include "vertex_layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/packing.hpp>
+
+namespace
+{
+    // the rect table's layout and the position's fixed point have to match SpriteBatch::RECT_TEXTURE_WIDTH and POSITION_SCALE
+    constexpr const char* SPRITE_VERTEX_SHADER = R"(
+layout(location = 0) in vec2  aOffset;   // eighths of a pixel from uOrigin
+layout(location = 1) in vec2  aSize;
+layout(location = 2) in vec4  aColor;
+layout(location = 3) in uint  aRect;
+layout(location = 4) in float aRotation; // of a half turn, either way
+
+uniform mat4              uProjection;
+uniform vec2              uOrigin;
+uniform highp sampler2D   uRects;
+
+out vec2      vTexCoord;
+out vec4      vColor;
+flat out uint vLayer;
+
+void main()
+{
+    // triangle strip corners (0,0) (1,0) (0,1) (1,1)
+    vec2  corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec2  local  = (corner - 0.5) * aSize;
+    float angle  = aRotation * 3.14159265;
+    float c      = cos(angle);
+    float s      = sin(angle);
+    vec2  world  = uOrigin + aOffset * 0.125 + vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+    int   texel  = int(aRect) * 2;
+    ivec2 at     = ivec2(texel & 2047, texel >> 11);
+    vec4  uvRect = texelFetch(uRects, at, 0);
+    vTexCoord    = mix(uvRect.xy, uvRect.zw, corner);
+    vColor       = aColor;
+    vLayer       = uint(texelFetch(uRects, at + ivec2(1, 0), 0).x);
+    gl_Position  = uProjection * vec4(world, 0.0, 1.0);
+}
+)";
+
+    constexpr const char* SPRITE_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+in vec4 vColor;
+
+uniform sampler2D uTexture;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture(uTexture, vTexCoord) * vColor;
+}
+)";
+
+    // ES has no default precision for array samplers
+    constexpr const char* ARRAY_FRAGMENT_SHADER = R"(
+in vec2      vTexCoord;
+in vec4      vColor;
+flat in uint vLayer;
+
+uniform mediump sampler2DArray uTexture;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture(uTexture, vec3(vTexCoord, float(vLayer))) * vColor;
+}
+)";
+
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    constexpr const char* BINDLESS_PREAMBLE = "#version 330 core\n#extension GL_ARB_bindless_texture : require\n#extension GL_ARB_shader_storage_buffer_object : require\n";
+
+    // no binding qualifier before GLSL 4.20; a block's binding starts out as 0, which is where End puts the handles
+    constexpr const char* BINDLESS_FRAGMENT_SHADER = R"(
+in vec2      vTexCoord;
+in vec4      vColor;
+flat in uint vLayer;
+
+layout(std430) readonly buffer SpriteTextures
+{
+    uvec2 uHandles[];
+};
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture(sampler2D(uHandles[vLayer]), vTexCoord) * vColor;
+}
+)";
+#endif
+
+    // per region; grows to the largest frame seen
+    constexpr std::size_t INITIAL_STREAM_BYTES = 1024 * sizeof(SpriteInstance);
+
+    using PackedSprite = SpriteBatch::PackedSprite;
+    static_assert(sizeof(PackedSprite) == 16);
+
+    constexpr auto SPRITE_LAYOUT = vertex_layout::PerInstance(vertex_layout::Make<PackedSprite>(
+        VertexAttribute{ 0, attribute_format::Short2, offsetof(PackedSprite, x) }, VertexAttribute{ 1, attribute_format::Half2, offsetof(PackedSprite, size) },
+        VertexAttribute{ 2, attribute_format::UByte4Norm, offsetof(PackedSprite, color) }, VertexAttribute{ 3, attribute_format::UShort1, offsetof(PackedSprite, rect) },
+        VertexAttribute{ 4, attribute_format::Short1Norm, offsetof(PackedSprite, rotation) }));
+
+    std::size_t rect_texture_bytes(int rows) noexcept
+    {
+        return static_cast<std::size_t>(SpriteBatch::RECT_TEXTURE_WIDTH) * static_cast<std::size_t>(rows) * sizeof(glm::vec4);
+    }
+
+    // the run key of every 2D texture when they go through handles together
+    constexpr std::uint64_t BINDLESS_RUN = 0;
+}
+
+void SpriteBatch::Setup()
+{
+    programs[static_cast<int>(Kind::Texture)].program.Request(SPRITE_VERTEX_SHADER, SPRITE_FRAGMENT_SHADER);
+    programs[static_cast<int>(Kind::Array)].program.Request(SPRITE_VERTEX_SHADER, ARRAY_FRAGMENT_SHADER);
+#if !defined(__EMSCRIPTEN__) && !defined(IS_WEBGL2)
+    bindless_available = has_gl_extension("GL_ARB_bindless_texture") && has_gl_extension("GL_ARB_shader_storage_buffer_object");
+    if (bindless_available)
+    {
+        programs[static_cast<int>(Kind::Bindless)].program.Request(SPRITE_VERTEX_SHADER, BINDLESS_FRAGMENT_SHADER, BINDLESS_PREAMBLE);
+        glGenBuffers(1, &handle_buffer);
+    }
+#endif
+
+    glGenVertexArrays(1, &vertex_array);
+    gl_state::BindVertexArray(vertex_array);
+    instance_stream.Setup(GL_ARRAY_BUFFER, INITIAL_STREAM_BYTES);
+    vertex_layout::Enable(SPRITE_LAYOUT);
+
+    glGenTextures(1, &rect_texture);
+    gl_state::BindTexture(rect_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+}
+
+void SpriteBatch::Shutdown()
+{
+    instance_stream.Shutdown();
+    gl_state::DeleteVertexArray(vertex_array);
+    for (Program& entry : programs)
+    {
+        entry.program.Reset();
+        entry.projection_location = -1;
+    }
+    if (handle_buffer != 0)
+        glDeleteBuffers(1, &handle_buffer);
+    gl_state::DeleteTexture(rect_texture);
+    if (rect_rows > 0)
+        memory_tracker::Free(MemoryCategory::Textures, rect_texture_bytes(rect_rows));
+    rect_texture       = 0;
+    rect_rows          = 0;
+    vertex_array       = 0;
+    handle_buffer      = 0;
+    bindless_available = false;
+}
+
+void SpriteBatch::SetBindless(bool enabled) noexcept
+{
+    bindless_requested = enabled;
+}
+
+bool SpriteBatch::IsBindlessAvailable() const noexcept
+{
+    return bindless_available;
+}
+
+void SpriteBatch::SetKeepOrder(bool enabled) noexcept
+{
+    keep_order = enabled;
+}
+
+SpriteBatch::PackedSprite SpriteBatch::Pack(const SpriteInstance& sprite, const glm::vec2& origin, std::uint16_t rect) noexcept
+{
+    const glm::vec2 offset = glm::round((sprite.position - origin) * POSITION_SCALE);
+    // wrapped first, so any angle fits
+    const float  half_turns = std::remainder(sprite.rotation, glm::two_pi<float>()) / glm::pi<float>();
+    PackedSprite packed;
+    packed.x        = static_cast<std::int16_t>(offset.x);
+    packed.y        = static_cast<std::int16_t>(offset.y);
+    packed.size     = glm::packHalf2x16(sprite.size);
+    packed.color    = sprite.color;
+    packed.rect     = rect;
+    packed.rotation = static_cast<std::int16_t>(std::lround(half_turns * 32767.0f));
+    return packed;
+}
+
+void SpriteBatch::DrawRetained(const glm::mat4& view_projection, std::span<const RetainedSpriteRun> retained, GLuint rect_table)
+{
+    retained_stats = Stats{};
+    if (retained.empty() || rect_table == 0)
+        return;
+    const bool has_array = std::any_of(retained.begin(), retained.end(), [](const RetainedSpriteRun& run) { return run.is_array; });
+    if (!isProgramReady(Kind::Texture) || (has_array && !isProgramReady(Kind::Array)))
+    {
+        retained_stats.pending = true;
+        return;
+    }
+
+    gl_state::SetEnabled(GL_BLEND, true);
+    gl_state::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::ActiveTexture(1);
+    gl_state::BindTexture(rect_table);
+    gl_state::ActiveTexture(0);
+    gl_state::BindVertexArray(vertex_array);
+
+    bool   has_projection[2] = {};
+    GLuint last_texture      = 0;
+    for (const RetainedSpriteRun& run : retained)
+    {
+        const Kind kind  = run.is_array ? Kind::Array : Kind::Texture;
+        Program&   entry = programs[static_cast<int>(kind)];
+        gl_state::UseProgram(entry.program.Id());
+        if (!has_projection[static_cast<int>(kind)])
+        {
+            glUniformMatrix4fv(entry.projection_location, 1, GL_FALSE, glm::value_ptr(view_projection));
+            has_projection[static_cast<int>(kind)] = true;
+        }
+        glUniform2f(entry.origin_location, run.origin.x, run.origin.y);
+        if (run.is_array)
+            glBindTexture(GL_TEXTURE_2D_ARRAY, run.texture);
+        else
+            gl_state::BindTexture(run.texture);
+        // the buffers are the runs' own; nothing of the frame's stream is read
+        glBindBuffer(GL_ARRAY_BUFFER, run.instance_buffer);
+        bindInstanceAttributes(0);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(run.count));
+        gl_stats::CountDraw(2 * static_cast<long long>(run.count));
+        retained_stats.sprites += static_cast<int>(run.count);
+        retained_stats.textures += run.texture != last_texture ? 1 : 0;
+        last_texture = run.texture;
+        ++retained_stats.draw_calls;
+    }
+}
+
+const SpriteBatch::Stats& SpriteBatch::LastRetainedStats() const noexcept
+{
+    return retained_stats;
+}
+
+void SpriteBatch::Begin(const glm::mat4& view_projection)
+{
+    projection = view_projection;
+    sprites.clear();
+    textures.clear();
+    array_textures.clear();
+}
+
+void SpriteBatch::Draw(GLuint texture, const SpriteInstance& sprite)
+{
+    sprites.push_back(sprite);
+    textures.push_back(texture);
+}
+
+void SpriteBatch::DrawArray(GLuint array_texture, const SpriteInstance& sprite)
+{
+    if (!isArray(array_texture))
+        array_textures.push_back(array_texture);
+    sprites.push_back(sprite);
+    textures.push_back(array_texture);
+}
+
+void SpriteBatch::End()
+{
+    stats = Stats{};
+    if (sprites.empty())
+        return;
+    if (!isProgramReady(Kind::Texture) || (!array_textures.empty() && !isProgramReady(Kind::Array)))
+    {
+        stats.pending = true;
+        return;
+    }
+
+    // Sort by texture only when there is more than one; the key keeps submission order within a texture
+    const bool single_texture = std::all_of(textures.begin(), textures.end(), [first = textures.front()](GLuint t) { return t == first; });
+    bool       bindless       = false;
+    if (bindless_requested && bindless_available && !single_texture)
+    {
+        try
+        {
+            // still compiling draws bound; a driver that refuses the program leaves bindless off from then on
+            bindless = isProgramReady(Kind::Bindless) && prepareBindless();
+        }
+        catch (const std::exception&)
+        {
+            bindless_available = false;
+        }
+    }
+    if (!single_texture)
+    {
+        sort_keys.resize(sprites.size());
+        for (std::size_t i = 0; i < sprites.size(); ++i)
+        {
+            const bool          shared = bindless && !isArray(textures[i]);
+            const std::uint64_t run    = shared ? BINDLESS_RUN : static_cast<std::uint64_t>(textures[i]);
+            sort_keys[i]               = (run << 32) | static_cast<std::uint64_t>(i);
+        }
+        // a frame that came through the sorted command list is in order already; one kept in order goes a run per texture change
+        if (!keep_order && !std::is_sorted(sort_keys.begin(), sort_keys.end()))
+            std::sort(sort_keys.begin(), sort_keys.end());
+    }
+
+    const auto  bytes       = sprites.size() * sizeof(PackedSprite);
+    std::size_t base_offset = 0;
+    auto*       mapped      = reinterpret_cast<PackedSprite*>(instance_stream.Map(bytes, base_offset));
+    if (mapped == nullptr)
+        return;
+    rect_texels.clear();
+    rect_indices.clear();
+    runs.clear();
+    int texture_runs = 0;
+    // packed in sorted order straight into the mapping, written front to back since it may be write-combined memory
+    for (std::size_t i = 0; i < sprites.size(); ++i)
+    {
+        const auto            index  = single_texture ? i : static_cast<std::size_t>(sort_keys[i] & 0xFFFFFFFFu);
+        const std::uint64_t   run    = single_texture ? textures.front() : sort_keys[i] >> 32;
+        const SpriteInstance& sprite = sprites[index];
+        const bool            is_new = runs.empty() || runs.back().run != run;
+        const glm::vec2       offset = is_new ? glm::vec2{ 0.0f } : glm::abs(sprite.position - runs.back().origin);
+        if (is_new || offset.x > MAX_OFFSET || offset.y > MAX_OFFSET)
+            runs.push_back(DrawRun{ i, 0, run, glm::round(sprite.position) });
+        texture_runs += is_new ? 1 : 0;
+        ++runs.back().count;
+        const std::uint32_t layer = bindless && run == BINDLESS_RUN ? sprite_slots[index] : sprite.layer;
+        mapped[i]                 = Pack(sprite, runs.back().origin, rectFor(sprite.uv_rect, layer));
+    }
+    instance_stream.Unmap();
+    gl_stats::CountUpload(bytes);
+    uploadRects();
+
+    gl_state::SetEnabled(GL_BLEND, true);
+    gl_state::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::ActiveTexture(0);
+    // left bound; with the state cache the next frame's bind is free
+    gl_state::BindVertexArray(vertex_array);
+
+    bool has_projection[3] = {};
+    for (const DrawRun& draw : runs)
+    {
+        const auto texture = static_cast<GLuint>(draw.run);
+        const Kind kind    = bindless && draw.run == BINDLESS_RUN ? Kind::Bindless : (isArray(texture) ? Kind::Array : Kind::Texture);
+        Program&   entry   = programs[static_cast<int>(kind)];
+        gl_state::UseProgram(entry.program.Id());
+        if (!has_projection[static_cast<int>(kind)])
+        {
+            glUniformMatrix4fv(entry.projection_location, 1, GL_FALSE, glm::value_ptr(projection));
+            has_projection[static_cast<int>(kind)] = true;
+        }
+        glUniform2f(entry.origin_location, draw.origin.x, draw.origin.y);
+        if (kind == Kind::Texture)
+            gl_state::BindTexture(texture);
+        else if (kind == Kind::Array)
+            glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        bindInstanceAttributes(base_offset + draw.first * sizeof(PackedSprite));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(draw.count));
+        gl_stats::CountDraw(2 * static_cast<long long>(draw.count)); // one quad per instance
+        ++stats.draw_calls;
+    }
+    instance_stream.EndFrame();
+
+    stats.sprites     = static_cast<int>(sprites.size());
+    stats.buffer_size = static_cast<int>(instance_stream.GetStats().region_bytes * StreamBuffer::REGION_COUNT);
+    stats.bindless    = bindless;
+    stats.textures    = bindless ? static_cast<int>(slot_textures.size() + array_textures.size()) : texture_runs;
+    stats.rects       = static_cast<int>(rect_indices.size());
+}
+
+const SpriteBatch::Stats& SpriteBatch::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+bool SpriteBatch::isProgramReady(Kind kind)
+{
+    Program& entry = programs[static_cast<int>(kind)];
+    if (entry.program.IsReady())
+        return true;
+    if (!entry.program.Poll())
+        return false;
+    entry.projection_location = glGetUniformLocation(entry.program.Id(), "uProjection");
+    entry.origin_location     = glGetUniformLocation(entry.program.Id(), "uOrigin");
+    gl_state::UseProgram(entry.program.Id());
+    glUniform1i(glGetUniformLocation(entry.program.Id(), "uRects"), 1);
+    if (kind != Kind::Bindless)
+        glUniform1i(glGetUniformLocation(entry.program.Id(), "uTexture"), 0);
+    return true;
+}
+
+bool SpriteBatch::isArray(GLuint texture) const noexcept
+{
+    // a frame uses a handful of arrays at most
+    return std::find(array_textures.begin(), array_textures.end(), texture) != array_textures.end();
+}
+
+bool SpriteBatch::prepareBindless()
+{
+#if defined(__EMSCRIPTEN__) || defined(IS_WEBGL2)
+    return false;
+#else
+    slot_textures.clear();
+    for (const GLuint texture : textures)
+    {
+        if ((slot_textures.empty() || slot_textures.back() != texture) && !isArray(texture))
+            slot_textures.push_back(texture);
+    }
+    std::sort(slot_textures.begin(), slot_textures.end());
+    slot_textures.erase(std::unique(slot_textures.begin(), slot_textures.end()), slot_textures.end());
+
+    // a texture's handle is the same every time it's asked for, and goes away with the texture
+    slot_handles.resize(slot_textures.size());
+    for (std::size_t slot = 0; slot < slot_textures.size(); ++slot)
+    {
+        const GLuint64 handle = glGetTextureHandleARB(slot_textures[slot]);
+        if (handle == 0)
+            return false;
+        if (glIsTextureHandleResidentARB(handle) == GL_FALSE)
+            glMakeTextureHandleResidentARB(handle);
+        slot_handles[slot] = handle;
+    }
+
+    sprite_slots.resize(textures.size());
+    GLuint        last_texture = 0;
+    std::uint32_t last_slot    = 0;
+    for (std::size_t i = 0; i < textures.size(); ++i)
+    {
+        if (textures[i] != last_texture)
+        {
+            const auto found = std::lower_bound(slot_textures.begin(), slot_textures.end(), textures[i]);
+            last_texture     = textures[i];
+            last_slot        = static_cast<std::uint32_t>(found - slot_textures.begin());
+        }
+        sprite_slots[i] = last_slot;
+    }
+
+    const auto bytes = static_cast<GLsizeiptr>(slot_handles.size() * sizeof(GLuint64));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, handle_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, slot_handles.data(), GL_STREAM_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, handle_buffer);
+    gl_stats::CountUpload(static_cast<std::size_t>(bytes));
+    return true;
+#endif
+}
+
+void SpriteBatch::bindInstanceAttributes(std::size_t base) const
+{
+    // ES 3.0 has no base-instance draws, so each texture run re-points the attributes instead
+    vertex_layout::Bind(SPRITE_LAYOUT, base);
+}
+
+std::uint16_t SpriteBatch::rectFor(const glm::vec4& uv_rect, std::uint32_t layer)
+{
+    RectKey key;
+    std::memcpy(key.words.data(), &uv_rect, sizeof(uv_rect));
+    key.words[4] = layer;
+    if (!rect_texels.empty() && key == last_rect_key)
+        return last_rect;
+    const std::size_t count = rect_texels.size() / 2;
+    if (count >= MAX_RECTS && !rect_indices.contains(key))
+    {
+        ++stats.rects_over;
+        return static_cast<std::uint16_t>(MAX_RECTS - 1);
+    }
+    const auto [found, added] = rect_indices.try_emplace(key, static_cast<std::uint16_t>(count));
+    if (added)
+    {
+        rect_texels.push_back(uv_rect);
+        rect_texels.push_back(glm::vec4{ static_cast<float>(layer), 0.0f, 0.0f, 0.0f });
+    }
+    last_rect_key = key;
+    last_rect     = found->second;
+    return last_rect;
+}
+
+void SpriteBatch::uploadRects()
+{
+    const int rows = static_cast<int>((rect_texels.size() + RECT_TEXTURE_WIDTH - 1) / RECT_TEXTURE_WIDTH);
+    rect_texels.resize(static_cast<std::size_t>(rows) * RECT_TEXTURE_WIDTH); // whole rows, the last one padded
+    gl_state::ActiveTexture(1);
+    gl_state::BindTexture(rect_texture);
+    if (rows > rect_rows)
+    {
+        if (rect_rows > 0)
+            memory_tracker::Free(MemoryCategory::Textures, rect_texture_bytes(rect_rows));
+        rect_rows = std::max(rows, rect_rows * 2);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, RECT_TEXTURE_WIDTH, rect_rows, 0, GL_RGBA, GL_FLOAT, nullptr);
+        memory_tracker::Allocate(MemoryCategory::Textures, rect_texture_bytes(rect_rows));
+    }
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, RECT_TEXTURE_WIDTH, rows, GL_RGBA, GL_FLOAT, rect_texels.data());
+    gl_stats::CountUpload(rect_texels.size() * sizeof(glm::vec4));
+    gl_state::ActiveTexture(0);
+}
+
+std::size_t SpriteBatch::RectKeyHash::operator()(const RectKey& key) const noexcept
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const std::uint32_t word : key.words)
+    {
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    return static_cast<std::size_t>(hash);
+}
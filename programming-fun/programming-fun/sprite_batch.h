@@ -0,0 +1,207 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "shader.h"
+#include "stream_buffer.h"
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+struct SpriteInstance
+{
+    glm::vec2     position{ 0.0f }; // center
+    glm::vec2     size{ 1.0f };
+    glm::vec4     uv_rect{ 0.0f, 0.0f, 1.0f, 1.0f }; // u0, v0, u1, v1
+    std::uint32_t color    = 0xFFFFFFFFu;            // RGBA8, R in the low byte
+    float         rotation = 0.0f;                   // radians
+    std::uint32_t layer    = 0;                      // for DrawArray; the batch reuses it as a handle slot when bindless
+};
+
+// Sprites of one texture around one origin in a buffer that outlives the frame, in SpriteBatch::PackedSprite form; StaticSprites builds them
+struct RetainedSpriteRun
+{
+    GLuint        instance_buffer = 0;
+    GLuint        texture         = 0;
+    bool          is_array        = false; // `texture` is a TextureArray's
+    glm::vec2     origin{ 0.0f };
+    std::uint32_t count = 0;
+};
+
+/**
+ * Collects sprites between Begin and End, then sorts them by texture and submits one instanced
+ * draw per texture from a single streaming instance buffer. Corners are generated from gl_VertexID
+ * so there is no per-vertex data at all. With SetKeepOrder the sprites stay in the order they came,
+ * which blending overlaps back to front needs, and a draw goes wherever the texture changes.
+ *
+ * What reaches the GPU is 16 bytes a sprite rather than SpriteInstance's 44: the position in 16-bit
+ * eighths of a pixel from the draw's origin, the size as half floats, the color as is, the rotation as
+ * a 16-bit fraction of a half turn, and a 16-bit index into a table of the frame's distinct uv rects and
+ * layers, which goes up as a float texture the vertex shader fetches from. A sprite more than about 4000
+ * pixels from its draw's origin starts another draw. A frame has room for 65536 distinct rects; past that,
+ * sprites take the last one and Stats counts them.
+ *
+ * Sprites drawn from a TextureArray share the array's run whatever their layer, so same-size images
+ * cost one draw together. With SetBindless, where the driver has GL_ARB_bindless_texture and storage
+ * buffers, every 2D texture of the frame goes into one draw as well: their resident handles go into a
+ * storage buffer each sprite indexes. That index differs within the draw, which the extension only
+ * promises to handle when it's the same across a draw, so it's opt-in; the drivers that expose the
+ * extension sample it per sprite anyway. Handles stay resident until their texture is deleted.
+ *
+ * DrawRetained draws sprites packed once into buffers of their own, with a rect table of their own, so
+ * sprites that don't move cost nothing a frame but their draws; its stats are kept apart from End's.
+ */
+class SpriteBatch
+{
+public:
+    // what a sprite is on the GPU
+    struct PackedSprite
+    {
+        std::int16_t  x        = 0; // from the draw's origin, in 1 / POSITION_SCALE pixels
+        std::int16_t  y        = 0;
+        std::uint32_t size     = 0; // two half floats, width in the low half
+        std::uint32_t color    = 0;
+        std::uint16_t rect     = 0; // into the rect table, two texels a rect
+        std::int16_t  rotation = 0; // snorm of a half turn
+    };
+
+    static constexpr float       POSITION_SCALE     = 8.0f;
+    static constexpr float       MAX_OFFSET         = 32767.0f / POSITION_SCALE - 1.0f; // pixels from the origin a draw can reach
+    static constexpr std::size_t MAX_RECTS          = 65536;
+    static constexpr GLsizei     RECT_TEXTURE_WIDTH = 2048; // texels, the least GL_MAX_TEXTURE_SIZE there is
+
+    struct Stats
+    {
+        int  sprites     = 0;
+        int  draw_calls  = 0;
+        int  buffer_size = 0;
+        int  textures    = 0;     // 2D textures and arrays the frame used
+        int  rects       = 0;     // distinct uv rect and layer pairs in the rect table
+        int  rects_over  = 0;     // sprites past the table's room, drawn with the wrong rect
+        bool bindless    = false; // the 2D textures went through resident handles
+        bool pending     = false; // the program is still compiling, so nothing was drawn
+    };
+
+    void Setup();
+    void Shutdown();
+
+    // Asked of the next End; ignored where IsBindlessAvailable is false
+    void SetBindless(bool enabled) noexcept;
+    bool IsBindlessAvailable() const noexcept;
+    // Draw in the order Draw saw, a run per change of texture, for sprites sorted already (back to front, say)
+    void SetKeepOrder(bool enabled) noexcept;
+
+    // `sprite`'s position relative to `origin`, which has to be within MAX_OFFSET of it
+    static PackedSprite Pack(const SpriteInstance& sprite, const glm::vec2& origin, std::uint16_t rect) noexcept;
+
+    // Outside Begin and End; `rect_texture` is the runs' RGBA32F rect table, RECT_TEXTURE_WIDTH wide
+    void         DrawRetained(const glm::mat4& projection, std::span<const RetainedSpriteRun> runs, GLuint rect_texture);
+    const Stats& LastRetainedStats() const noexcept;
+
+    void Begin(const glm::mat4& projection);
+    void Draw(GLuint texture, const SpriteInstance& sprite);
+    // `array_texture` is a GL_TEXTURE_2D_ARRAY; sprite.layer picks the layer
+    void DrawArray(GLuint array_texture, const SpriteInstance& sprite);
+    void End();
+
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    enum class Kind
+    {
+        Texture,
+        Array,
+        Bindless
+    };
+
+    // the uv rect's bits, then the layer
+    struct RectKey
+    {
+        std::array<std::uint32_t, 5> words{};
+
+        bool operator==(const RectKey&) const noexcept = default;
+    };
+
+    struct RectKeyHash
+    {
+        std::size_t operator()(const RectKey& key) const noexcept;
+    };
+
+    // sprites [first, first + count) of the sorted instances, all of one run key and close enough to `origin`
+    struct DrawRun
+    {
+        std::size_t   first = 0;
+        std::size_t   count = 0;
+        std::uint64_t run   = 0; // the texture, or BINDLESS_RUN
+        glm::vec2     origin{ 0.0f };
+    };
+
+    // `base` is the byte offset of the run's first instance in the stream buffer
+    void          bindInstanceAttributes(std::size_t base) const;
+    std::uint16_t rectFor(const glm::vec4& uv_rect, std::uint32_t layer);
+    // this frame's rect table to rect_texture, on texture unit 1
+    void          uploadRects();
+    // false while the kind's program is compiling; looks up the uniforms the first time it's ready
+    bool          isProgramReady(Kind kind);
+    bool          isArray(GLuint texture) const noexcept;
+    // resident handles for this frame's 2D textures into the storage buffer; false to draw them bound instead
+    bool          prepareBindless();
+
+private:
+    struct Program
+    {
+        ShaderProgram program;
+        GLint         projection_location = -1;
+        GLint         origin_location     = -1;
+    };
+
+    Program      programs[3]; // by Kind
+    GLuint       vertex_array = 0;
+    StreamBuffer instance_stream;
+
+    // rect table, two RGBA32F texels a rect: its uv rect, then its layer
+    GLuint                                                  rect_texture = 0;
+    int                                                     rect_rows    = 0; // allocated
+    std::vector<glm::vec4>                                  rect_texels;
+    std::unordered_map<RectKey, std::uint16_t, RectKeyHash> rect_indices;
+    RectKey                                                 last_rect_key; // consecutive sprites mostly share one
+    std::uint16_t                                           last_rect = 0;
+    std::vector<DrawRun>                                    runs;
+
+    glm::mat4                   projection{ 1.0f };
+    std::vector<SpriteInstance> sprites;
+    std::vector<GLuint>         textures;
+    std::vector<GLuint>         array_textures; // the ones DrawArray saw this frame
+    std::vector<std::uint64_t>  sort_keys;
+    Stats                       stats;
+    Stats                       retained_stats;
+
+    // bindless
+    bool                       bindless_available = false;
+    bool                       bindless_requested = false;
+    bool                       keep_order         = false;
+    GLuint                     handle_buffer      = 0; // GL_SHADER_STORAGE_BUFFER, one uvec2 per slot
+    std::vector<GLuint>        slot_textures;          // this frame's 2D textures, sorted, by slot
+    std::vector<GLuint64>      slot_handles;
+    std::vector<std::uint32_t> sprite_slots; // per sprite, in submission order
+};
+
+// Packs 0-1 floats into the batch's RGBA8 color
+constexpr std::uint32_t pack_rgba8(float r, float g, float b, float a) noexcept
+{
+    auto to_byte = [](float v) { return static_cast<std::uint32_t>((v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v)) * 255.0f + 0.5f); };
+    return to_byte(r) | (to_byte(g) << 8) | (to_byte(b) << 16) | (to_byte(a) << 24);
+}
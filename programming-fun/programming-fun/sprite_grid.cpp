@@ -0,0 +1,117 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "sprite_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // a huge world gets bigger cells instead of millions of empty lists
+    constexpr int MAX_CELLS = 1 << 16;
+}
+
+void SpriteGrid::Reset(const glm::vec2& new_origin, const glm::vec2& size, float cell_size)
+{
+    cell_size = std::max(cell_size, 1.0f);
+    while (std::ceil(size.x / cell_size) * std::ceil(size.y / cell_size) > static_cast<float>(MAX_CELLS))
+        cell_size *= 2.0f;
+    origin            = new_origin;
+    inverse_cell_size = 1.0f / cell_size;
+    columns           = std::max(1, static_cast<int>(std::ceil(size.x / cell_size)));
+    rows              = std::max(1, static_cast<int>(std::ceil(size.y / cell_size)));
+    cells.assign(static_cast<std::size_t>(columns * rows), {});
+
+    max_half_extent = glm::vec2{ 0.0f };
+    for (std::uint32_t id = 0; id < items.size(); ++id)
+    {
+        Item& item = items[id];
+        if (item.cell == NO_CELL)
+            continue;
+        max_half_extent = glm::max(max_half_extent, item.half_extent);
+        insert(id, cellIndex(item.center));
+    }
+}
+
+bool SpriteGrid::Set(std::uint32_t id, const glm::vec2& center, const glm::vec2& half_extent)
+{
+    if (cells.empty())
+        return false;
+    if (id >= items.size())
+        items.resize(static_cast<std::size_t>(id) + 1);
+    Item& item       = items[id];
+    item.center      = center;
+    item.half_extent = half_extent;
+    max_half_extent  = glm::max(max_half_extent, half_extent);
+
+    const std::uint32_t cell = cellIndex(center);
+    if (cell == item.cell)
+        return false;
+    if (item.cell != NO_CELL)
+        remove(id);
+    else
+        ++sprite_count;
+    insert(id, cell);
+    return true;
+}
+
+void SpriteGrid::Truncate(std::size_t count)
+{
+    if (count >= items.size())
+        return;
+    for (std::size_t id = count; id < items.size(); ++id)
+    {
+        if (items[id].cell == NO_CELL)
+            continue;
+        remove(static_cast<std::uint32_t>(id));
+        --sprite_count;
+    }
+    items.resize(count);
+}
+
+int SpriteGrid::CellCount() const noexcept
+{
+    return static_cast<int>(cells.size());
+}
+
+std::size_t SpriteGrid::SpriteCount() const noexcept
+{
+    return sprite_count;
+}
+
+glm::ivec2 SpriteGrid::cellOf(const glm::vec2& point) const noexcept
+{
+    // compared as floats first, so a far off point can't overflow the int
+    const glm::vec2 cell = glm::floor((point - origin) * inverse_cell_size);
+    return glm::ivec2{ glm::clamp(cell, glm::vec2{ 0.0f }, glm::vec2{ static_cast<float>(columns - 1), static_cast<float>(rows - 1) }) };
+}
+
+std::uint32_t SpriteGrid::cellIndex(const glm::vec2& point) const noexcept
+{
+    const glm::ivec2 cell = cellOf(point);
+    return static_cast<std::uint32_t>(cell.y * columns + cell.x);
+}
+
+void SpriteGrid::insert(std::uint32_t id, std::uint32_t cell)
+{
+    std::vector<std::uint32_t>& list = cells[cell];
+    items[id].cell                   = cell;
+    items[id].slot                   = static_cast<std::uint32_t>(list.size());
+    list.push_back(id);
+}
+
+void SpriteGrid::remove(std::uint32_t id)
+{
+    Item&                       item  = items[id];
+    std::vector<std::uint32_t>& list  = cells[item.cell];
+    const std::uint32_t         moved = list.back();
+    list[item.slot]                   = moved;
+    items[moved].slot                 = item.slot;
+    list.pop_back();
+    item.cell = NO_CELL;
+}
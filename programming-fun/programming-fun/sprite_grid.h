@@ -0,0 +1,167 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
+#include <vector>
+
+/**
+ * A uniform grid over sprite bounds, kept up to date one sprite at a time, for culling before batching.
+ *
+ * Each sprite sits in the one cell its center falls in, so a move that stays in its cell only costs a
+ * compare, and one that crosses over is a swap-remove from the old cell's list and a push onto the new
+ * one. A query widens its rectangle by the largest half extent set since Reset, tests every sprite in
+ * the cells that touches, and visits the ones whose bounds overlap. Centers outside the grid go to the
+ * nearest edge cell, so nothing goes missing, it only culls slower. Ids are small dense integers, the
+ * indices into the caller's own arrays.
+ *
+ * A segment query walks the rows of cells the segment crosses, each row only as wide as the segment's
+ * stretch through it plus the widening, so a long diagonal ray tests a band of cells instead of its whole
+ * bounding box. Queries don't change the grid, so any number of threads may run them while nothing Sets.
+ */
+class SpriteGrid
+{
+public:
+    // Drops the cells and sorts every sprite into the new ones; call before the first Set
+    void Reset(const glm::vec2& origin, const glm::vec2& size, float cell_size);
+    // Adds the sprite or moves it; true when that put it in another cell
+    bool Set(std::uint32_t id, const glm::vec2& center, const glm::vec2& half_extent);
+    // Removes every id from `count` on
+    void Truncate(std::size_t count);
+
+    // Calls `visit(id)` for each sprite overlapping [min, max]; returns how many it had to test
+    template <typename Visit>
+    int Query(const glm::vec2& min, const glm::vec2& max, Visit&& visit) const;
+    // Calls `visit(id)` for each sprite whose bounds the segment from `from` to `to` crosses; returns how many it had to test
+    template <typename Visit>
+    int QuerySegment(const glm::vec2& from, const glm::vec2& to, Visit&& visit) const;
+
+    int         CellCount() const noexcept;
+    std::size_t SpriteCount() const noexcept;
+
+private:
+    static constexpr std::uint32_t NO_CELL = 0xFFFFFFFFu;
+
+    struct Item
+    {
+        glm::vec2     center{ 0.0f };
+        glm::vec2     half_extent{ 0.0f };
+        std::uint32_t cell = NO_CELL;
+        std::uint32_t slot = 0; // where in its cell's list
+    };
+
+    glm::ivec2    cellOf(const glm::vec2& point) const noexcept;
+    std::uint32_t cellIndex(const glm::vec2& point) const noexcept;
+    void          insert(std::uint32_t id, std::uint32_t cell);
+    void          remove(std::uint32_t id);
+
+private:
+    std::vector<std::vector<std::uint32_t>> cells; // row major
+    std::vector<Item>                       items; // by id
+    glm::vec2                               origin{ 0.0f };
+    glm::vec2                               max_half_extent{ 0.0f };
+    float                                   inverse_cell_size = 1.0f;
+    int                                     columns           = 0;
+    int                                     rows              = 0;
+    std::size_t                             sprite_count      = 0;
+};
+
+template <typename Visit>
+int SpriteGrid::Query(const glm::vec2& min, const glm::vec2& max, Visit&& visit) const
+{
+    if (cells.empty())
+        return 0;
+    const glm::ivec2 first  = cellOf(min - max_half_extent);
+    const glm::ivec2 last   = cellOf(max + max_half_extent);
+    int              tested = 0;
+    for (int row = first.y; row <= last.y; ++row)
+    {
+        for (int column = first.x; column <= last.x; ++column)
+        {
+            for (const std::uint32_t id : cells[static_cast<std::size_t>(row * columns + column)])
+            {
+                const Item& item = items[id];
+                ++tested;
+                if (glm::all(glm::lessThanEqual(item.center - item.half_extent, max)) && glm::all(glm::greaterThanEqual(item.center + item.half_extent, min)))
+                    visit(id);
+            }
+        }
+    }
+    return tested;
+}
+
+template <typename Visit>
+int SpriteGrid::QuerySegment(const glm::vec2& from, const glm::vec2& to, Visit&& visit) const
+{
+    if (cells.empty())
+        return 0;
+    const glm::vec2 delta     = to - from;
+    const float     cell_size = 1.0f / inverse_cell_size;
+    const int       first_row = cellOf(glm::min(from, to) - max_half_extent).y;
+    const int       last_row  = cellOf(glm::max(from, to) + max_half_extent).y;
+    int             tested    = 0;
+    for (int row = first_row; row <= last_row; ++row)
+    {
+        // the band whose centers can reach the segment; the edge rows also hold everything clamped past them
+        const float band_min = row == 0 ? -INFINITY : origin.y + static_cast<float>(row) * cell_size - max_half_extent.y;
+        const float band_max = row == rows - 1 ? INFINITY : origin.y + static_cast<float>(row + 1) * cell_size + max_half_extent.y;
+        float       t0       = 0.0f;
+        float       t1       = 1.0f;
+        if (delta.y != 0.0f)
+        {
+            const float enter = (band_min - from.y) / delta.y;
+            const float leave = (band_max - from.y) / delta.y;
+            t0                = std::max(t0, std::min(enter, leave));
+            t1                = std::min(t1, std::max(enter, leave));
+        }
+        else if (from.y < band_min || from.y > band_max)
+        {
+            continue;
+        }
+        if (t0 > t1)
+            continue;
+        const float first_x = std::min(from.x + delta.x * t0, from.x + delta.x * t1) - max_half_extent.x;
+        const float last_x  = std::max(from.x + delta.x * t0, from.x + delta.x * t1) + max_half_extent.x;
+        const int   first   = cellOf(glm::vec2{ first_x, from.y }).x;
+        const int   last    = cellOf(glm::vec2{ last_x, from.y }).x;
+        for (int column = first; column <= last; ++column)
+        {
+            for (const std::uint32_t id : cells[static_cast<std::size_t>(row * columns + column)])
+            {
+                // slabs: the stretch of the segment inside the bounds, empty when it misses them
+                const Item&     item  = items[id];
+                const glm::vec2 low   = item.center - item.half_extent;
+                const glm::vec2 high  = item.center + item.half_extent;
+                float           enter = 0.0f;
+                float           leave = 1.0f;
+                ++tested;
+                for (int axis = 0; axis < 2 && enter <= leave; ++axis)
+                {
+                    if (delta[axis] == 0.0f)
+                    {
+                        if (from[axis] < low[axis] || from[axis] > high[axis])
+                            leave = -1.0f;
+                        continue;
+                    }
+                    const float near_t = (low[axis] - from[axis]) / delta[axis];
+                    const float far_t  = (high[axis] - from[axis]) / delta[axis];
+                    enter              = std::max(enter, std::min(near_t, far_t));
+                    leave              = std::min(leave, std::max(near_t, far_t));
+                }
+                if (enter <= leave)
+                    visit(id);
+            }
+        }
+    }
+    return tested;
+}
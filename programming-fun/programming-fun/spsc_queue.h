@@ -0,0 +1,92 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+
+#if defined(_MSC_VER)
+#    pragma warning(push)
+#    pragma warning(disable : 4324) // padded on purpose, see below
+#endif
+
+/**
+ * Fixed size ring for exactly one producer thread and one consumer thread, without locks.
+ *
+ * Each side owns one index and only reads the other's, so a push or pop is a copy plus one release
+ * store. Each side also caches the last value it saw of the other's index and only reloads it when
+ * the ring looks full (or empty), which keeps the shared cache line quiet in the common case.
+ * The two sides sit on separate cache lines so they don't invalidate each other.
+ */
+template <typename T, std::size_t CAPACITY>
+class SpscQueue
+{
+    static_assert(std::has_single_bit(CAPACITY), "capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&)                = delete;
+    SpscQueue& operator=(const SpscQueue&)     = delete;
+    SpscQueue(SpscQueue&&) noexcept            = delete;
+    SpscQueue& operator=(SpscQueue&&) noexcept = delete;
+
+    // Producer only; false when full
+    bool TryPush(const T& value)
+    {
+        const std::size_t tail = write_index.load(std::memory_order_relaxed);
+        if (tail - read_cache == CAPACITY)
+        {
+            read_cache = read_index.load(std::memory_order_acquire);
+            if (tail - read_cache == CAPACITY)
+                return false;
+        }
+        slots[tail & (CAPACITY - 1)] = value;
+        write_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only; false when empty
+    bool TryPop(T& out_value)
+    {
+        const std::size_t head = read_index.load(std::memory_order_relaxed);
+        if (head == write_cache)
+        {
+            write_cache = write_index.load(std::memory_order_acquire);
+            if (head == write_cache)
+                return false;
+        }
+        out_value = slots[head & (CAPACITY - 1)];
+        read_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Exact on either side's own thread only when the other side is idle
+    std::size_t SizeApprox() const noexcept
+    {
+        return write_index.load(std::memory_order_acquire) - read_index.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // producer side
+    alignas(CACHE_LINE) std::atomic<std::size_t> write_index{ 0 };
+    std::size_t read_cache = 0;
+    // consumer side
+    alignas(CACHE_LINE) std::atomic<std::size_t> read_index{ 0 };
+    std::size_t write_cache = 0;
+
+    alignas(CACHE_LINE) std::array<T, CAPACITY> slots{};
+};
+
+#if defined(_MSC_VER)
+#    pragma warning(pop)
+#endif
@@ -0,0 +1,208 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "startup_trace.h"
+
+#include "logger.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char* name       = nullptr;
+        std::string detail;
+        Uint64      begin      = 0;
+        Uint64      end        = 0;
+        int         thread     = 0;
+        bool        is_instant = false;
+    };
+
+    // taken during static initialization, so on the main thread and before main runs
+    const Uint64          origin      = SDL_GetPerformanceCounter();
+    const std::thread::id main_thread = std::this_thread::get_id();
+
+    std::atomic<bool>     recording{ true };
+    std::atomic<int>      next_thread{ 1 };
+    std::mutex            mutex;
+    std::vector<Event>    events;
+    std::filesystem::path output;
+    Uint64                presented = 0; // when Finish and Loaded came, once they have
+    Uint64                loaded    = 0;
+
+    // main is track 0, the others number themselves in the order they first record
+    int thread_track()
+    {
+        thread_local const int track = std::this_thread::get_id() == main_thread ? 0 : next_thread.fetch_add(1, std::memory_order_relaxed);
+        return track;
+    }
+
+    double to_microseconds(Uint64 ticks)
+    {
+        return static_cast<double>(ticks - origin) * 1'000'000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    void record(Event event)
+    {
+        event.thread = thread_track();
+        std::lock_guard lock{ mutex };
+        if (recording.load(std::memory_order_relaxed))
+            events.push_back(std::move(event));
+    }
+
+    void record_instant(const char* name, Uint64 ticks)
+    {
+        Event event;
+        event.name       = name;
+        event.begin      = ticks;
+        event.end        = ticks;
+        event.is_instant = true;
+        record(std::move(event));
+    }
+
+    void write_escaped(std::ostream& out, std::string_view text)
+    {
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) >= 0x20)
+                out << c;
+        }
+    }
+
+    // https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+    bool write_trace(const std::filesystem::path& filename, const std::vector<Event>& trace)
+    {
+        std::ofstream out{ filename };
+        if (!out)
+        {
+            LOG_ERROR("Failed to write startup trace ", filename);
+            return false;
+        }
+        int thread_count = 1;
+        for (const Event& event : trace)
+            thread_count = std::max(thread_count, event.thread + 1);
+
+        // as strings: a counter in nanoseconds outgrows a double's integers after some months of uptime
+        out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"origin_counter\":\"" << origin << "\",\"counter_frequency\":\"" << SDL_GetPerformanceFrequency()
+            << "\"},\"traceEvents\":[\n";
+        for (int i = 0; i < thread_count; ++i)
+        {
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":\"";
+            if (i == 0)
+                out << "main";
+            else
+                out << "thread " << i;
+            out << "\"}},\n";
+        }
+        for (std::size_t i = 0; i < trace.size(); ++i)
+        {
+            const Event& event = trace[i];
+            out << "{\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << to_microseconds(event.begin);
+            if (event.is_instant)
+                out << ",\"ph\":\"i\",\"s\":\"g\"";
+            else
+                out << ",\"ph\":\"X\",\"dur\":" << to_microseconds(event.end) - to_microseconds(event.begin);
+            if (!event.detail.empty())
+            {
+                out << ",\"args\":{\"detail\":\"";
+                write_escaped(out, event.detail);
+                out << "\"}";
+            }
+            out << (i + 1 < trace.size() ? "},\n" : "}\n");
+        }
+        out << "]}\n";
+        return static_cast<bool>(out);
+    }
+
+    // Marks one of the two milestones the first time it comes; true when that stopped the recording
+    bool reach(const char* name, Uint64& out_ticks)
+    {
+        const Uint64    now = SDL_GetPerformanceCounter();
+        Event           event{ .name = name, .detail = {}, .begin = now, .end = now, .thread = thread_track(), .is_instant = true };
+        std::lock_guard lock{ mutex };
+        if (out_ticks != 0 || !recording.load(std::memory_order_relaxed))
+            return false;
+        out_ticks = now;
+        events.push_back(std::move(event));
+        if (presented == 0 || loaded == 0)
+            return false;
+        recording.store(false);
+        return true;
+    }
+
+    void write()
+    {
+        std::vector<Event>    trace;
+        std::filesystem::path filename;
+        {
+            std::lock_guard lock{ mutex };
+            trace.swap(events);
+            filename = output;
+        }
+        std::cout << "Startup: " << to_microseconds(presented) / 1000.0 << " ms to the first frame, " << to_microseconds(loaded) / 1000.0 << " ms to the startup loads\n";
+        if (!filename.empty() && write_trace(filename, trace))
+            std::cout << "Startup trace written to " << filename << '\n';
+    }
+}
+
+namespace startup_trace
+{
+    void SetOutput(std::filesystem::path filename)
+    {
+        std::lock_guard lock{ mutex };
+        output = std::move(filename);
+    }
+
+    bool IsRecording() noexcept
+    {
+        return recording.load(std::memory_order_relaxed);
+    }
+
+    void Instant(const char* name)
+    {
+        if (!IsRecording())
+            return;
+        record_instant(name, SDL_GetPerformanceCounter());
+    }
+
+    void Finish()
+    {
+        if (IsRecording() && reach("first frame presented", presented))
+            write();
+    }
+
+    void Loaded()
+    {
+        if (IsRecording() && reach("assets loaded", loaded))
+            write();
+    }
+
+    Scope::Scope(const char* new_name, std::string_view new_detail) : name{ new_name }
+    {
+        if (!IsRecording())
+            return;
+        detail = new_detail;
+        begin  = SDL_GetPerformanceCounter();
+    }
+
+    Scope::~Scope()
+    {
+        if (begin == 0 || !IsRecording())
+            return;
+        record(Event{ .name = name, .detail = std::move(detail), .begin = begin, .end = SDL_GetPerformanceCounter() });
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <SDL_stdinc.h>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/**
+ * Timestamps everything from process start to the first presented frame and the startup loads landing, whichever
+ * is later, and writes it as a Chrome trace (open it in chrome://tracing or ui.perfetto.dev) to see which steps are
+ * on the critical path. The trace's otherData has the SDL performance counter at its zero, so a launcher reading the
+ * same counter (startup-benchmark) can add the time before static initialization.
+ *
+ * Scopes may be opened on any thread; each thread gets its own track. Recording stops once both Finish and Loaded
+ * have been called, after which a Scope costs one atomic load, so worker jobs can keep theirs for the whole run.
+ */
+namespace startup_trace
+{
+    // Where Finish writes the trace; without one it only prints the total
+    void SetOutput(std::filesystem::path filename);
+
+    bool IsRecording() noexcept;
+    // A zero length marker on the calling thread's track; `name` must outlive the trace (use a string literal)
+    void Instant(const char* name);
+    // Call once the first frame is on screen; later calls do nothing
+    void Finish();
+    // Call once the startup loads have landed; later calls do nothing
+    void Loaded();
+
+    /**
+     * Records the enclosing scope while tracing. `name` must outlive the trace (use a string literal);
+     * `detail` (an asset name, say) is copied and shown as the event's argument.
+     */
+    class [[nodiscard]] Scope
+    {
+    public:
+        explicit Scope(const char* name, std::string_view detail = {});
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        std::string detail;
+        Uint64      begin = 0;
+    };
+}
@@ -0,0 +1,325 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "static_sprites.h"
+
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "memory_tracker.h"
+#include "release_queue.h"
+#include "upload_budget.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // sprites a new batch's buffer holds; it doubles from there
+    constexpr std::size_t MIN_CAPACITY = 256;
+    constexpr std::size_t TABLE_WIDTH  = static_cast<std::size_t>(SpriteBatch::RECT_TEXTURE_WIDTH);
+
+    static_assert(StaticSprites::CELL_SIZE * 0.5f < SpriteBatch::MAX_OFFSET, "a batch's sprites have to reach from its origin");
+
+    std::size_t rect_texture_bytes(int rows) noexcept
+    {
+        return TABLE_WIDTH * static_cast<std::size_t>(rows) * sizeof(glm::vec4);
+    }
+
+    glm::ivec2 cell_of(const glm::vec2& position) noexcept
+    {
+        return glm::ivec2{ glm::floor(position / StaticSprites::CELL_SIZE) };
+    }
+}
+
+StaticSprites::Handle StaticSprites::Add(GLuint texture, bool is_array, const SpriteInstance& sprite)
+{
+    Handle handle = INVALID_HANDLE;
+    if (!free_handles.empty())
+    {
+        handle = free_handles.back();
+        free_handles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<Handle>(locations.size());
+        locations.emplace_back();
+    }
+    append(batchFor(texture, is_array, sprite.position), handle, sprite);
+    ++sprite_count;
+    return handle;
+}
+
+void StaticSprites::Set(Handle handle, const SpriteInstance& sprite)
+{
+    assert(handle < locations.size() && locations[handle].batch >= 0);
+    const Location location = locations[handle];
+    Batch&         batch    = batches[static_cast<std::size_t>(location.batch)];
+    // into another cell's batch when it moved out of its own
+    if (cell_of(sprite.position) != batch.cell)
+    {
+        const GLuint texture  = batch.texture;
+        const bool   is_array = batch.is_array;
+        erase(location.batch, location.slot);
+        append(batchFor(texture, is_array, sprite.position), handle, sprite);
+        return;
+    }
+    batch.sprites[location.slot] = sprite;
+    batch.packed[location.slot]  = SpriteBatch::Pack(sprite, batch.origin, rectFor(sprite.uv_rect, sprite.layer));
+    touch(batch, location.slot);
+}
+
+void StaticSprites::Remove(Handle handle)
+{
+    if (handle >= locations.size() || locations[handle].batch < 0)
+        return;
+    const Location location = locations[handle];
+    erase(location.batch, location.slot);
+    locations[handle] = Location{};
+    free_handles.push_back(handle);
+    --sprite_count;
+}
+
+const SpriteInstance& StaticSprites::Get(Handle handle) const
+{
+    assert(handle < locations.size() && locations[handle].batch >= 0);
+    const Location location = locations[handle];
+    return batches[static_cast<std::size_t>(location.batch)].sprites[location.slot];
+}
+
+void StaticSprites::Clear()
+{
+    for (Batch& batch : batches)
+    {
+        batch.sprites.clear();
+        batch.packed.clear();
+        batch.handles.clear();
+        batch.dirty_first = 0;
+        batch.dirty_end   = 0;
+    }
+    locations.clear();
+    free_handles.clear();
+    sprite_count = 0;
+}
+
+void StaticSprites::Update(UploadBudget& budget, ReleaseQueue& releases)
+{
+    stats.uploads        = 0;
+    stats.regrown        = 0;
+    stats.uploaded_bytes = 0;
+    const UploadBudget::Timer timer{ budget };
+    uploadRects(budget, releases);
+
+    constexpr std::size_t SPRITE_BYTES = sizeof(SpriteBatch::PackedSprite);
+    for (Batch& batch : batches)
+    {
+        if (batch.packed.size() > batch.capacity)
+        {
+            // a new buffer rather than new contents, so frames in flight keep drawing the old one
+            if (batch.buffer != 0)
+            {
+                releases.RetireBuffer(batch.buffer, batch.capacity * SPRITE_BYTES, MemoryCategory::Geometry);
+                stats.buffer_bytes -= batch.capacity * SPRITE_BYTES;
+                ++stats.regrown;
+            }
+            batch.capacity          = std::max({ std::bit_ceil(batch.packed.size()), 2 * batch.capacity, MIN_CAPACITY });
+            const std::size_t bytes = batch.capacity * SPRITE_BYTES;
+            glGenBuffers(1, &batch.buffer);
+            glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_DYNAMIC_DRAW);
+            memory_tracker::Allocate(MemoryCategory::Geometry, bytes);
+            stats.buffer_bytes += bytes;
+            batch.dirty_first = 0;
+            batch.dirty_end   = batch.packed.size();
+        }
+        // removals can leave the range past the end
+        const std::size_t end = std::min(batch.dirty_end, batch.packed.size());
+        if (batch.dirty_first < end)
+        {
+            const std::size_t bytes = (end - batch.dirty_first) * SPRITE_BYTES;
+            glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(batch.dirty_first * SPRITE_BYTES), static_cast<GLsizeiptr>(bytes), &batch.packed[batch.dirty_first]);
+            budget.Spend(bytes);
+            gl_stats::CountUpload(bytes);
+            stats.uploaded_bytes += bytes;
+            ++stats.uploads;
+        }
+        batch.dirty_first = 0;
+        batch.dirty_end   = 0;
+        batch.uploaded    = batch.packed.size();
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    stats.sprites = static_cast<int>(sprite_count);
+    stats.batches = static_cast<int>(std::count_if(batches.begin(), batches.end(), [](const Batch& batch) { return !batch.packed.empty(); }));
+    stats.rects   = static_cast<int>(rect_indices.size());
+}
+
+void StaticSprites::CollectRuns(std::pmr::vector<RetainedSpriteRun>& out) const
+{
+    for (const Batch& batch : batches)
+    {
+        if (batch.uploaded > 0)
+            out.push_back(RetainedSpriteRun{ batch.buffer, batch.texture, batch.is_array, batch.origin, static_cast<std::uint32_t>(batch.uploaded) });
+    }
+}
+
+GLuint StaticSprites::RectTexture() const noexcept
+{
+    return rect_texture;
+}
+
+void StaticSprites::Shutdown()
+{
+    for (Batch& batch : batches)
+    {
+        if (batch.buffer != 0)
+        {
+            glDeleteBuffers(1, &batch.buffer);
+            memory_tracker::Free(MemoryCategory::Geometry, batch.capacity * sizeof(SpriteBatch::PackedSprite));
+        }
+    }
+    if (rect_texture != 0)
+    {
+        gl_state::DeleteTexture(rect_texture);
+        memory_tracker::Free(MemoryCategory::Textures, rect_texture_bytes(rect_rows));
+    }
+    batches.clear();
+    locations.clear();
+    free_handles.clear();
+    rect_indices.clear();
+    rect_texels.clear();
+    rects_uploaded = 0;
+    rect_texture   = 0;
+    rect_rows      = 0;
+    sprite_count   = 0;
+    stats          = Stats{};
+}
+
+std::size_t StaticSprites::Size() const noexcept
+{
+    return sprite_count;
+}
+
+const StaticSprites::Stats& StaticSprites::GetStats() const noexcept
+{
+    return stats;
+}
+
+int StaticSprites::batchFor(GLuint texture, bool is_array, const glm::vec2& position)
+{
+    // a handful of textures times the cells the scene covers, so a scan
+    const glm::ivec2 cell = cell_of(position);
+    for (std::size_t i = 0; i < batches.size(); ++i)
+    {
+        const Batch& batch = batches[i];
+        if (batch.texture == texture && batch.is_array == is_array && batch.cell == cell)
+            return static_cast<int>(i);
+    }
+    Batch& batch   = batches.emplace_back();
+    batch.texture  = texture;
+    batch.is_array = is_array;
+    batch.cell     = cell;
+    batch.origin   = (glm::vec2{ cell } + 0.5f) * CELL_SIZE;
+    return static_cast<int>(batches.size() - 1);
+}
+
+std::uint16_t StaticSprites::rectFor(const glm::vec4& uv_rect, std::uint32_t layer)
+{
+    RectKey key;
+    std::memcpy(key.data(), &uv_rect, sizeof(uv_rect));
+    key[4] = layer;
+    if (const auto found = rect_indices.find(key); found != rect_indices.end())
+        return found->second;
+    const std::size_t count = rect_indices.size();
+    if (count >= SpriteBatch::MAX_RECTS)
+        return static_cast<std::uint16_t>(SpriteBatch::MAX_RECTS - 1);
+    // whole rows, so the upload never reads past the end
+    const std::size_t texel = 2 * count;
+    if (texel + 2 > rect_texels.size())
+        rect_texels.resize(rect_texels.size() + TABLE_WIDTH);
+    rect_texels[texel]     = uv_rect;
+    rect_texels[texel + 1] = glm::vec4{ static_cast<float>(layer), 0.0f, 0.0f, 0.0f };
+    const auto index       = static_cast<std::uint16_t>(count);
+    rect_indices.emplace(key, index);
+    return index;
+}
+
+void StaticSprites::append(int batch_index, Handle handle, const SpriteInstance& sprite)
+{
+    Batch& batch = batches[static_cast<std::size_t>(batch_index)];
+    locations[handle] = Location{ batch_index, batch.sprites.size() };
+    batch.sprites.push_back(sprite);
+    batch.packed.push_back(SpriteBatch::Pack(sprite, batch.origin, rectFor(sprite.uv_rect, sprite.layer)));
+    batch.handles.push_back(handle);
+    touch(batch, batch.sprites.size() - 1);
+}
+
+void StaticSprites::erase(int batch_index, std::size_t slot)
+{
+    Batch&            batch = batches[static_cast<std::size_t>(batch_index)];
+    const std::size_t last  = batch.sprites.size() - 1;
+    if (slot != last)
+    {
+        batch.sprites[slot]                 = batch.sprites[last];
+        batch.packed[slot]                  = batch.packed[last];
+        batch.handles[slot]                 = batch.handles[last];
+        locations[batch.handles[slot]].slot = slot;
+        touch(batch, slot);
+    }
+    batch.sprites.pop_back();
+    batch.packed.pop_back();
+    batch.handles.pop_back();
+}
+
+void StaticSprites::touch(Batch& batch, std::size_t slot) noexcept
+{
+    if (batch.dirty_first == batch.dirty_end)
+    {
+        batch.dirty_first = slot;
+        batch.dirty_end   = slot + 1;
+        return;
+    }
+    batch.dirty_first = std::min(batch.dirty_first, slot);
+    batch.dirty_end   = std::max(batch.dirty_end, slot + 1);
+}
+
+void StaticSprites::uploadRects(UploadBudget& budget, ReleaseQueue& releases)
+{
+    const std::size_t texels = 2 * rect_indices.size();
+    if (rects_uploaded == texels)
+        return;
+    const int   rows      = static_cast<int>((texels + TABLE_WIDTH - 1) / TABLE_WIDTH);
+    std::size_t first_row = rects_uploaded / TABLE_WIDTH;
+    gl_state::ActiveTexture(1);
+    if (rows > rect_rows)
+    {
+        // a new table, so frames in flight keep reading the old one
+        if (rect_texture != 0)
+            releases.RetireTexture(rect_texture, rect_texture_bytes(rect_rows));
+        rect_rows = std::max(rows, rect_rows * 2);
+        glGenTextures(1, &rect_texture);
+        gl_state::BindTexture(rect_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, SpriteBatch::RECT_TEXTURE_WIDTH, rect_rows, 0, GL_RGBA, GL_FLOAT, nullptr);
+        memory_tracker::Allocate(MemoryCategory::Textures, rect_texture_bytes(rect_rows));
+        first_row = 0;
+    }
+    gl_state::BindTexture(rect_texture);
+    const int upload_rows = rows - static_cast<int>(first_row);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLint>(first_row), SpriteBatch::RECT_TEXTURE_WIDTH, upload_rows, GL_RGBA, GL_FLOAT, &rect_texels[first_row * TABLE_WIDTH]);
+    gl_state::ActiveTexture(0);
+    const std::size_t bytes = static_cast<std::size_t>(upload_rows) * TABLE_WIDTH * sizeof(glm::vec4);
+    budget.Spend(bytes);
+    gl_stats::CountUpload(bytes);
+    stats.uploaded_bytes += bytes;
+    ++stats.uploads;
+    rects_uploaded = texels;
+}
@@ -0,0 +1,129 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "sprite_batch.h"
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <map>
+#include <memory_resource>
+#include <vector>
+
+class ReleaseQueue;
+class UploadBudget;
+
+/**
+ * Sprites that stay where they are, kept in GPU buffers built once instead of going through SpriteBatch's
+ * stream every frame.
+ *
+ * Add files a sprite into a batch by its texture and by the CELL_SIZE square of the world it sits in, so
+ * every batch is one retained draw around one origin. A batch keeps its sprites packed the way SpriteBatch
+ * draws them, in a GL buffer of its own; Set and Remove only widen the range of it they touched, and Update
+ * sends each batch's range with one glBufferSubData and the rect table's new rows the same way, so a frame
+ * with no edits uploads nothing. Remove moves the batch's last sprite into the hole, so batches stay dense.
+ * A batch that outgrows its buffer gets one twice the size, uploaded whole, and the old one goes to the
+ * ReleaseQueue so frames in flight keep drawing it; an edit in place may show up in a frame still in flight,
+ * a frame early. Main thread, with GL current (the upload context while the render thread runs), like Tilemap.
+ */
+class StaticSprites
+{
+public:
+    using Handle = std::uint32_t;
+
+    static constexpr Handle INVALID_HANDLE = ~Handle{ 0 };
+    static constexpr float  CELL_SIZE      = 4096.0f; // world pixels; a sprite is at most half of this from its batch's origin
+
+    struct Stats
+    {
+        int         sprites        = 0;
+        int         batches        = 0; // with sprites in them
+        int         rects          = 0; // distinct uv rect and layer pairs in the rect table
+        int         uploads        = 0; // glBufferSubData and glTexSubImage2D calls by the latest Update
+        int         regrown        = 0; // batches the latest Update gave a bigger buffer
+        std::size_t uploaded_bytes = 0; // by the latest Update
+        std::size_t buffer_bytes   = 0;
+    };
+
+    StaticSprites() = default;
+
+    StaticSprites(const StaticSprites&)                = delete;
+    StaticSprites& operator=(const StaticSprites&)     = delete;
+    StaticSprites(StaticSprites&&) noexcept            = delete;
+    StaticSprites& operator=(StaticSprites&&) noexcept = delete;
+
+    // `is_array` when `texture` is a TextureArray's, with sprite.layer picking the layer
+    Handle                Add(GLuint texture, bool is_array, const SpriteInstance& sprite);
+    // Moves or changes a sprite, keeping its texture and handle
+    void                  Set(Handle handle, const SpriteInstance& sprite);
+    void                  Remove(Handle handle);
+    const SpriteInstance& Get(Handle handle) const;
+    // Every sprite goes; the buffers stay for the next ones
+    void                  Clear();
+
+    // Uploads what changed since the last call, whatever `budget` has left, since the next draws need it
+    void   Update(UploadBudget& budget, ReleaseQueue& releases);
+    // A run per batch with sprites, as of the latest Update
+    void   CollectRuns(std::pmr::vector<RetainedSpriteRun>& out) const;
+    GLuint RectTexture() const noexcept;
+    // Once nothing draws any more
+    void   Shutdown();
+
+    std::size_t  Size() const noexcept;
+    const Stats& GetStats() const noexcept;
+
+private:
+    struct Batch
+    {
+        GLuint                                 texture  = 0;
+        bool                                   is_array = false;
+        glm::ivec2                             cell{ 0 };
+        glm::vec2                              origin{ 0.0f };
+        std::vector<SpriteInstance>            sprites;
+        std::vector<SpriteBatch::PackedSprite> packed;
+        std::vector<Handle>                    handles; // by slot, back to Location
+        GLuint                                 buffer      = 0;
+        std::size_t                            capacity    = 0; // sprites the buffer holds
+        std::size_t                            uploaded    = 0; // sprites the buffer has, as of the latest Update
+        std::size_t                            dirty_first = 0; // slots [dirty_first, dirty_end) changed since
+        std::size_t                            dirty_end   = 0;
+    };
+
+    struct Location
+    {
+        int         batch = -1; // -1 for a free handle
+        std::size_t slot  = 0;
+    };
+
+    using RectKey = std::array<std::uint32_t, 5>; // the uv rect's bits, then the layer
+
+    int           batchFor(GLuint texture, bool is_array, const glm::vec2& position);
+    std::uint16_t rectFor(const glm::vec4& uv_rect, std::uint32_t layer);
+    // `sprite` into the end of `batch` for `handle`
+    void          append(int batch, Handle handle, const SpriteInstance& sprite);
+    // the sprite at `slot`, moving the batch's last one into it
+    void          erase(int batch, std::size_t slot);
+    void          uploadRects(UploadBudget& budget, ReleaseQueue& releases);
+    static void   touch(Batch& batch, std::size_t slot) noexcept;
+
+private:
+    std::vector<Batch>               batches;
+    std::vector<Location>            locations; // by handle
+    std::vector<Handle>              free_handles;
+    std::map<RectKey, std::uint16_t> rect_indices;
+    std::vector<glm::vec4>           rect_texels;        // two a rect, like SpriteBatch's table
+    std::size_t                      rects_uploaded = 0; // texels
+    GLuint                           rect_texture   = 0;
+    int                              rect_rows      = 0; // allocated
+    std::size_t                      sprite_count   = 0;
+    Stats                            stats;
+};
@@ -0,0 +1,45 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+// stb_image and stb_vorbis are compiled here rather than linked from stb.lib so their allocations
+// can be routed through decode_scratch; texture-converter still links the prebuilt library.
+
+#include "decode_scratch.h"
+#include "vorbis_seek_index.h"
+
+#define STBI_MALLOC(size)                        decode_scratch::Allocate(size)
+#define STBI_REALLOC_SIZED(pointer, old, size)   decode_scratch::Reallocate(pointer, old, size)
+#define STBI_FREE(pointer)                       decode_scratch::Free(pointer)
+#define STB_IMAGE_IMPLEMENTATION
+
+// third party code, /W4 /WX would stop the build over its conversions
+#if defined(_MSC_VER)
+#    pragma warning(push, 0)
+#endif
+
+#include <stb_image.h>
+#include <stb_vorbis.c>
+
+#if defined(_MSC_VER)
+#    pragma warning(pop)
+#endif
+
+int stb_vorbis_seek_between(stb_vorbis* vorbis, unsigned int sample_number, const VorbisSeekIndex::Page& left, const VorbisSeekIndex::Page& right)
+{
+    // the search checks the target against the length, which finds (and keeps) the real last page; before the swap
+    if (stb_vorbis_stream_length_in_samples(vorbis) == 0)
+        return 0;
+    // seek_to_sample_coarse starts from p_first and p_last; with them a second apart it only walks the pages between
+    const ProbedPage first = vorbis->p_first;
+    const ProbedPage last  = vorbis->p_last;
+    vorbis->p_first        = ProbedPage{ left.start, left.end, left.sample };
+    vorbis->p_last         = ProbedPage{ right.start, right.end, right.sample };
+    const int result       = stb_vorbis_seek(vorbis, sample_number);
+    vorbis->p_first        = first;
+    vorbis->p_last         = last;
+    return result;
+}
@@ -0,0 +1,197 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "stream_buffer.h"
+
+#include "logger.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+    // covers attribute offsets, index offsets and std140 vec4s
+    constexpr std::size_t ALIGNMENT = 16;
+
+    constexpr std::size_t align_up(std::size_t value) noexcept
+    {
+        return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    constexpr GLuint64 FENCE_TIMEOUT_NS = 1'000'000'000;
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    Shutdown();
+}
+
+void StreamBuffer::Setup(GLenum buffer_target, std::size_t region_bytes)
+{
+    Shutdown();
+    target = buffer_target;
+#if defined(IS_WEBGL2)
+    use_storage = false;
+#else
+    use_storage = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+#endif
+    stats = Stats{};
+    allocate(align_up(std::max<std::size_t>(region_bytes, ALIGNMENT)));
+}
+
+void StreamBuffer::Shutdown()
+{
+    if (buffer == 0)
+        return;
+    release();
+    stats = Stats{};
+}
+
+unsigned char* StreamBuffer::Map(std::size_t bytes, std::size_t& out_offset)
+{
+    if (buffer == 0 || is_mapped)
+        return nullptr;
+
+    std::size_t offset = align_up(head);
+    if (offset + bytes > stats.region_bytes)
+    {
+        // the old buffer stays alive for any draw already issued from it this frame
+        ++stats.reallocation_count;
+        allocate(std::bit_ceil(std::max(offset + bytes, 2 * stats.region_bytes)));
+        offset = 0;
+    }
+    glBindBuffer(target, buffer);
+    if (is_wrapped)
+    {
+        glBufferData(target, static_cast<GLsizeiptr>(stats.region_bytes * REGION_COUNT), nullptr, GL_STREAM_DRAW);
+        is_wrapped = false;
+    }
+    if (offset == 0)
+        waitForRegion(region);
+
+    const std::size_t absolute = static_cast<std::size_t>(region) * stats.region_bytes + offset;
+    head                       = offset + bytes;
+    stats.used_bytes           = head;
+    out_offset                 = absolute;
+    if (use_storage)
+        return persistent + absolute;
+
+    // nothing the GPU may still read lives here: regions are only revisited after the orphaning above
+    constexpr GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    auto*                mapped = static_cast<unsigned char*>(glMapBufferRange(target, static_cast<GLintptr>(absolute), static_cast<GLsizeiptr>(bytes), access));
+    is_mapped                   = mapped != nullptr;
+    return mapped;
+}
+
+void StreamBuffer::Unmap()
+{
+    if (!is_mapped)
+        return;
+    glBindBuffer(target, buffer);
+    glUnmapBuffer(target);
+    is_mapped = false;
+}
+
+void StreamBuffer::EndFrame()
+{
+    if (buffer == 0 || head == 0)
+        return;
+    Unmap();
+    const auto index = static_cast<std::size_t>(region);
+    if (use_storage)
+    {
+        if (fences[index] != nullptr)
+            glDeleteSync(fences[index]);
+        fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    region           = (region + 1) % REGION_COUNT;
+    head             = 0;
+    stats.used_bytes = 0;
+    // orphaning waits for the next Map, so what was just written can still be drawn until then
+    is_wrapped = !use_storage && region == 0;
+}
+
+GLuint StreamBuffer::Buffer() const noexcept
+{
+    return buffer;
+}
+
+bool StreamBuffer::IsPersistent() const noexcept
+{
+    return persistent != nullptr;
+}
+
+const StreamBuffer::Stats& StreamBuffer::GetStats() const noexcept
+{
+    return stats;
+}
+
+void StreamBuffer::allocate(std::size_t region_bytes)
+{
+    release();
+    const auto total = static_cast<GLsizeiptr>(region_bytes * REGION_COUNT);
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+#if !defined(IS_WEBGL2)
+    if (use_storage)
+    {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, total, nullptr, flags);
+        persistent = static_cast<unsigned char*>(glMapBufferRange(target, 0, total, flags));
+        if (persistent == nullptr)
+        {
+            LOG_WARN("Failed to map a persistent stream buffer, falling back to unsynchronized mapping");
+            use_storage = false;
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(target, buffer);
+        }
+    }
+#endif
+    if (!use_storage)
+        glBufferData(target, total, nullptr, GL_STREAM_DRAW);
+    stats.region_bytes = region_bytes;
+}
+
+void StreamBuffer::release()
+{
+    if (buffer == 0)
+        return;
+    Unmap();
+    for (GLsync& fence : fences)
+    {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (persistent != nullptr)
+    {
+        glBindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        persistent = nullptr;
+    }
+    glDeleteBuffers(1, &buffer);
+    buffer           = 0;
+    is_wrapped       = false;
+    region           = 0;
+    head             = 0;
+    stats.used_bytes = 0;
+}
+
+void StreamBuffer::waitForRegion(int index)
+{
+    GLsync& fence = fences[static_cast<std::size_t>(index)];
+    if (fence == nullptr)
+        return;
+    if (const GLenum status = glClientWaitSync(fence, 0, 0); status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    {
+        ++stats.fence_waits;
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
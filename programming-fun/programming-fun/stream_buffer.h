@@ -0,0 +1,79 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+
+/**
+ * A GL buffer split into REGION_COUNT regions that are written in turn, one per frame, for data that changes every frame.
+ *
+ * With GL 4.4 or ARB_buffer_storage the whole buffer is mapped once, persistent and coherent, and
+ * EndFrame() fences the region just written; a region is only reused after its fence signals, which
+ * with three of them is normally long ago. Elsewhere (always on WebGL2) each Map is a
+ * glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT) of untouched space, and the buffer is orphaned
+ * when the regions wrap around instead of being fenced. Either way the last data written stays in
+ * place until the next Map, so a caller may draw it again in frames that write nothing.
+ *
+ * Several Map/Unmap pairs may go into one frame (vertices, then indices), but only one mapping can be open.
+ * A frame that outgrows its region reallocates everything at the next size up.
+ * Keep the buffer bound to `target` from Map until the draw using it; GL thread only.
+ */
+class StreamBuffer
+{
+public:
+    static constexpr int REGION_COUNT = 3;
+
+    struct Stats
+    {
+        std::size_t region_bytes       = 0;
+        std::size_t used_bytes         = 0; // in the region being written
+        int         fence_waits        = 0; // times Map had to wait for the GPU, since Setup
+        int         reallocation_count = 0;
+    };
+
+    StreamBuffer() = default;
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&)                = delete;
+    StreamBuffer& operator=(const StreamBuffer&)     = delete;
+    StreamBuffer(StreamBuffer&&) noexcept            = delete;
+    StreamBuffer& operator=(StreamBuffer&&) noexcept = delete;
+
+    // `target` is GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER; bind the vertex array first for the latter
+    void Setup(GLenum target, std::size_t region_bytes);
+    void Shutdown();
+
+    // Binds the buffer and returns `bytes` of write-only memory at `out_offset` inside Buffer()
+    unsigned char* Map(std::size_t bytes, std::size_t& out_offset);
+    void           Unmap();
+    // After the draws that read this frame's data have been issued
+    void EndFrame();
+
+    GLuint       Buffer() const noexcept;
+    bool         IsPersistent() const noexcept;
+    const Stats& GetStats() const noexcept;
+
+private:
+    void allocate(std::size_t region_bytes);
+    void release();
+    void waitForRegion(int region);
+
+private:
+    GLenum                           target      = GL_ARRAY_BUFFER;
+    GLuint                           buffer      = 0;
+    unsigned char*                   persistent  = nullptr;
+    bool                             use_storage = false;
+    bool                             is_mapped   = false;
+    bool                             is_wrapped  = false; // unfenced regions wrapped; orphan before the next Map
+    int                              region      = 0;
+    std::size_t                      head        = 0; // inside the current region
+    std::array<GLsync, REGION_COUNT> fences{};
+    Stats                            stats;
+};
@@ -0,0 +1,90 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "task_graph.h"
+
+#include "profiler.h"
+#include "worker_pool.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <cassert>
+
+TaskGraph::Task TaskGraph::Add(const char* name, Job job, std::initializer_list<Task> dependencies)
+{
+    const auto task = static_cast<Task>(nodes.size());
+    Node       node;
+    node.name         = name;
+    node.job          = std::move(job);
+    node.dependencies = static_cast<int>(dependencies.size());
+    for (const Task dependency : dependencies)
+    {
+        // only tasks already added, which is what keeps the graph acyclic
+        assert(dependency < task);
+        nodes[dependency].successors.push_back(task);
+        node.depth = std::max(node.depth, nodes[dependency].depth + 1);
+    }
+    stats.tasks         = static_cast<int>(nodes.size()) + 1;
+    stats.roots         += node.dependencies == 0 ? 1 : 0;
+    stats.longest_chain = std::max(stats.longest_chain, node.depth);
+    nodes.push_back(std::move(node));
+    return task;
+}
+
+void TaskGraph::Run(WorkerPool& workers)
+{
+    if (nodes.empty())
+        return;
+    const Uint64 started = SDL_GetPerformanceCounter();
+    if (remaining_size < nodes.size())
+    {
+        remaining      = std::make_unique<std::atomic<int>[]>(nodes.size());
+        remaining_size = nodes.size();
+    }
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+        remaining[i].store(nodes[i].dependencies, std::memory_order_relaxed);
+
+    // a task submits its successors before it finishes, so the counter can't reach zero while any are left
+    JobCounter counter;
+    for (Task task = 0; task < static_cast<Task>(nodes.size()); ++task)
+    {
+        if (nodes[task].dependencies == 0)
+            workers.Submit([this, &workers, &counter, task] { runTask(workers, counter, task); }, &counter);
+    }
+    workers.Wait(counter);
+    stats.run_ms = static_cast<double>(SDL_GetPerformanceCounter() - started) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+void TaskGraph::Clear()
+{
+    nodes.clear();
+    stats = Stats{};
+}
+
+bool TaskGraph::IsEmpty() const noexcept
+{
+    return nodes.empty();
+}
+
+TaskGraph::Stats TaskGraph::GetStats() const noexcept
+{
+    return stats;
+}
+
+void TaskGraph::runTask(WorkerPool& workers, JobCounter& counter, Task task)
+{
+    const Node& node = nodes[task];
+    {
+        PROFILE_NAMED_TRACE_ZONE(node.name);
+        node.job();
+    }
+    for (const Task successor : node.successors)
+    {
+        if (remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            workers.Submit([this, &workers, &counter, successor] { runTask(workers, counter, successor); }, &counter);
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+class JobCounter;
+class WorkerPool;
+
+/**
+ * A fixed set of jobs and the order between them, built once and run as often as needed.
+ *
+ * Add names the tasks a new one waits for, which are already in the graph, so there is never a cycle.
+ * Run puts every task that waits for nothing on the WorkerPool, and each task that finishes puts up the ones
+ * it was the last wait of, so independent branches run side by side on as many threads as they can fill;
+ * the calling thread runs tasks too until the graph is done. A task can ParallelFor inside itself. Each task
+ * is a trace zone under its name. The jobs are kept, so whatever changes between runs they read through
+ * what they captured rather than being rebuilt; one Run at a time.
+ */
+class TaskGraph
+{
+public:
+    using Task = std::uint32_t;
+    using Job  = std::function<void()>;
+
+    struct Stats
+    {
+        int    tasks         = 0;
+        int    roots         = 0; // waiting for nothing
+        int    longest_chain = 0; // tasks that have to run one after the other, at least
+        double run_ms        = 0.0;
+    };
+
+    TaskGraph() = default;
+
+    TaskGraph(const TaskGraph&)                = delete;
+    TaskGraph& operator=(const TaskGraph&)     = delete;
+    TaskGraph(TaskGraph&&) noexcept            = delete;
+    TaskGraph& operator=(TaskGraph&&) noexcept = delete;
+
+    // `name` outlives any profiler capture, a literal in practice
+    Task  Add(const char* name, Job job, std::initializer_list<Task> dependencies = {});
+    void  Run(WorkerPool& workers);
+    void  Clear();
+    bool  IsEmpty() const noexcept;
+    Stats GetStats() const noexcept;
+
+private:
+    struct Node
+    {
+        const char*       name = nullptr;
+        Job               job;
+        std::vector<Task> successors;
+        int               dependencies = 0;
+        int               depth        = 1; // the longest chain ending here
+    };
+
+    void runTask(WorkerPool& workers, JobCounter& counter, Task task);
+
+private:
+    std::vector<Node>                   nodes;
+    std::unique_ptr<std::atomic<int>[]> remaining; // per node, its dependencies still running this Run
+    std::size_t                         remaining_size = 0;
+    Stats                               stats;
+};
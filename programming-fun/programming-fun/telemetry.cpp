@@ -0,0 +1,166 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "telemetry.h"
+
+#include "logger.h"
+#include "telemetry_protocol.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <random>
+
+namespace
+{
+    // into the summary's entry of that name, the next free one the first time it comes
+    void fold_counter(telemetry::Summary& summary, std::array<bool, telemetry::MAX_COUNTERS>& is_sum, const TelemetrySender::PublishedCounter& counter)
+    {
+        int index = 0;
+        while (index < summary.counter_count && std::strncmp(summary.counters[static_cast<std::size_t>(index)].name.data(), counter.name, telemetry::MAX_COUNTER_NAME) != 0)
+            ++index;
+        if (index == telemetry::MAX_COUNTERS)
+            return;
+        telemetry::Counter& entry = summary.counters[static_cast<std::size_t>(index)];
+        if (index == summary.counter_count)
+        {
+            ++summary.counter_count;
+            // the last byte stays the terminator
+            std::strncpy(entry.name.data(), counter.name, telemetry::MAX_COUNTER_NAME);
+            entry.value                             = 0;
+            is_sum[static_cast<std::size_t>(index)] = counter.is_sum;
+        }
+        entry.value = counter.is_sum ? entry.value + counter.value : counter.value;
+    }
+}
+
+TelemetrySender::~TelemetrySender()
+{
+    Stop();
+}
+
+bool TelemetrySender::Start(std::string_view address, int rate_hz)
+{
+    Stop();
+    if (IsOff(address) || !socket.Connect(address, telemetry::DEFAULT_PORT))
+        return false;
+    is_stopping = false;
+    thread      = std::thread{ [this, rate = std::clamp(rate_hz, 1, MAX_RATE_HZ)] { threadLoop(rate); } };
+    LOG_INFO("Streaming telemetry to ", address, " ", std::clamp(rate_hz, 1, MAX_RATE_HZ), " times a second");
+    return true;
+}
+
+void TelemetrySender::Stop()
+{
+    if (!thread.joinable())
+        return;
+    {
+        std::lock_guard lock{ mutex };
+        is_stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+    socket.Close();
+}
+
+bool TelemetrySender::IsRunning() const noexcept
+{
+    return thread.joinable();
+}
+
+void TelemetrySender::Push(const FrameMetrics& metrics) noexcept
+{
+    if (!thread.joinable())
+        return;
+    if (!queue.TryPush(metrics))
+        dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+TelemetrySender::Stats TelemetrySender::GetStats() const noexcept
+{
+    return Stats{ sent.load(std::memory_order_relaxed), failed.load(std::memory_order_relaxed), dropped.load(std::memory_order_relaxed) };
+}
+
+bool TelemetrySender::IsOff(std::string_view address) noexcept
+{
+    return address.empty() || address == "off";
+}
+
+void TelemetrySender::threadLoop(int rate_hz)
+{
+    const auto                                period = std::chrono::microseconds{ 1'000'000 / rate_hz };
+    telemetry::Summary                        summary;
+    std::array<bool, telemetry::MAX_COUNTERS> is_sum{}; // by the summary's counters
+    summary.instance = std::random_device{}();
+    auto next_tick   = std::chrono::steady_clock::now() + period;
+    std::unique_lock lock{ mutex };
+    while (!wake.wait_until(lock, next_tick, [this] { return is_stopping; }))
+    {
+        lock.unlock();
+        next_tick += period;
+        // a ticker that fell behind (a suspended laptop) starts over rather than sending a burst
+        if (next_tick < std::chrono::steady_clock::now())
+            next_tick = std::chrono::steady_clock::now() + period;
+
+        summary.frames       = 0;
+        summary.frame_ms     = 0.0f;
+        summary.frame_max_ms = 0.0f;
+        summary.cpu_ms       = 0.0f;
+        summary.cpu_max_ms   = 0.0f;
+        summary.gpu_ms       = -1.0f;
+        summary.gpu_max_ms   = -1.0f;
+        for (int c = 0; c < summary.counter_count; ++c)
+        {
+            if (is_sum[static_cast<std::size_t>(c)])
+                summary.counters[static_cast<std::size_t>(c)].value = 0;
+        }
+        double       frame_sum = 0.0;
+        double       cpu_sum   = 0.0;
+        double       gpu_sum   = 0.0;
+        int          gpu_count = 0;
+        FrameMetrics metrics;
+        while (summary.frames < std::numeric_limits<std::uint16_t>::max() && queue.TryPop(metrics))
+        {
+            ++summary.frames;
+            frame_sum += static_cast<double>(metrics.frame_ms);
+            cpu_sum += static_cast<double>(metrics.cpu_ms);
+            summary.frame_max_ms = std::max(summary.frame_max_ms, metrics.frame_ms);
+            summary.cpu_max_ms   = std::max(summary.cpu_max_ms, metrics.cpu_ms);
+            if (metrics.gpu_ms >= 0.0f)
+            {
+                ++gpu_count;
+                gpu_sum += static_cast<double>(metrics.gpu_ms);
+                summary.gpu_max_ms = std::max(summary.gpu_max_ms, metrics.gpu_ms);
+            }
+            // the counters are levels rather than rates, so the latest frame's stand for the lot
+            summary.last_frame   = metrics.frame;
+            summary.memory_bytes = metrics.memory_bytes;
+            summary.draw_calls   = static_cast<std::uint32_t>(std::max(metrics.draw_calls, 0));
+            summary.loads_queued = static_cast<std::uint16_t>(std::clamp(metrics.loads_queued, 0, 0xFFFF));
+            summary.loads_active = static_cast<std::uint16_t>(std::clamp(metrics.loads_active, 0, 0xFFFF));
+            for (int c = 0; c < metrics.counter_count; ++c)
+                fold_counter(summary, is_sum, metrics.counters[static_cast<std::size_t>(c)]);
+        }
+        if (summary.frames > 0)
+        {
+            summary.frame_ms = static_cast<float>(frame_sum / summary.frames);
+            summary.cpu_ms   = static_cast<float>(cpu_sum / summary.frames);
+        }
+        if (gpu_count > 0)
+            summary.gpu_ms = static_cast<float>(gpu_sum / gpu_count);
+
+        const auto packet = telemetry::Encode(summary);
+        if (socket.Send(packet.View()))
+            sent.fetch_add(1, std::memory_order_relaxed);
+        else
+            failed.fetch_add(1, std::memory_order_relaxed);
+        ++summary.sequence;
+        lock.lock();
+    }
+}
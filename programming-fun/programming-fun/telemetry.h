@@ -0,0 +1,102 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "spsc_queue.h"
+#include "telemetry_protocol.h"
+#include "udp_socket.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+/**
+ * Streams a summary of the recent frames to a telemetry-aggregator, so a room of lab machines can be
+ * watched from one desk.
+ *
+ * The main thread only pushes each frame's numbers into a lock-free queue; a thread of its own wakes
+ * `rate_hz` times a second, folds whatever arrived into one telemetry::Summary and sends it as a single
+ * UDP datagram. Nothing is retried or acknowledged: a lost datagram is a gap in the aggregator's table and
+ * a full queue drops frames, counted in Stats. A tick with no frames still sends, so a minimized or
+ * stalled instance shows up as quiet rather than gone. Not available in the browser.
+ */
+class TelemetrySender
+{
+public:
+    static constexpr int DEFAULT_RATE_HZ = 4;
+    static constexpr int MAX_RATE_HZ     = 60;
+
+    struct PublishedCounter
+    {
+        const char* name   = nullptr; // perf_counters', which outlive the sender
+        long long   value  = 0;
+        bool        is_sum = false; // a counter, summed over the datagram's frames; a gauge keeps the latest
+    };
+
+    struct FrameMetrics
+    {
+        std::uint64_t frame        = 0;
+        float         frame_ms     = 0.0f;
+        float         cpu_ms       = 0.0f;
+        float         gpu_ms       = -1.0f; // -1 when no new GPU time arrived
+        std::size_t   memory_bytes = 0;
+        int           draw_calls   = 0;
+        int           loads_queued = 0;
+        int           loads_active = 0;
+        // the perf counters published InTelemetry
+        int                                                   counter_count = 0;
+        std::array<PublishedCounter, telemetry::MAX_COUNTERS> counters{};
+    };
+
+    struct Stats
+    {
+        std::uint64_t sent    = 0;
+        std::uint64_t failed  = 0; // datagrams the socket refused
+        std::uint64_t dropped = 0; // frames pushed while the queue was full
+    };
+
+    TelemetrySender() = default;
+    ~TelemetrySender();
+
+    TelemetrySender(const TelemetrySender&)                = delete;
+    TelemetrySender& operator=(const TelemetrySender&)     = delete;
+    TelemetrySender(TelemetrySender&&) noexcept            = delete;
+    TelemetrySender& operator=(TelemetrySender&&) noexcept = delete;
+
+    // "host:port" or a bare host for telemetry::DEFAULT_PORT; false when it can't be resolved
+    bool Start(std::string_view address, int rate_hz);
+    void Stop();
+    bool IsRunning() const noexcept;
+    // Main thread, once per frame
+    void  Push(const FrameMetrics& metrics) noexcept;
+    Stats GetStats() const noexcept;
+
+    // "off" and the empty string are both off
+    static bool IsOff(std::string_view address) noexcept;
+
+private:
+    static constexpr std::size_t QUEUE_CAPACITY = 1024;
+
+    void threadLoop(int rate_hz);
+
+private:
+    SpscQueue<FrameMetrics, QUEUE_CAPACITY> queue;
+    UdpSocket                               socket; // the thread's once started
+    std::mutex                              mutex;
+    std::condition_variable                 wake;
+    std::thread                             thread;
+    bool                                    is_stopping = false;
+    std::atomic<std::uint64_t>              sent{ 0 };
+    std::atomic<std::uint64_t>              failed{ 0 };
+    std::atomic<std::uint64_t>              dropped{ 0 };
+};
@@ -0,0 +1,177 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+/**
+ * What a TelemetrySender puts in each UDP datagram and the telemetry-aggregator reads back.
+ *
+ * One datagram summarizes the frames since the previous one: their count, the mean and max of the frame, CPU
+ * and GPU times, and the latest memory, draw call and loader numbers. Then come the perf counters published
+ * InTelemetry, at most MAX_COUNTERS: each its name's length in a byte, the name and the value, summed over the
+ * frames for a counter and the latest for a gauge. Fields are written one after another in the host's byte
+ * order, little-endian on every machine this runs on, with no padding. The instance is
+ * random per run, so two runs on one machine stay apart, and the sequence number lets the receiver count
+ * what it lost. A version the reader doesn't know is dropped whole.
+ */
+namespace telemetry
+{
+    inline constexpr std::uint32_t MAGIC            = 0x4C544650; // "PFTL"
+    inline constexpr std::uint16_t VERSION          = 2;
+    inline constexpr std::uint16_t DEFAULT_PORT     = 47811;
+    inline constexpr int           MAX_COUNTERS     = 8;
+    inline constexpr std::size_t   MAX_COUNTER_NAME = 31; // longer names are cut
+
+    struct Counter
+    {
+        std::array<char, MAX_COUNTER_NAME + 1> name{}; // nul terminated
+        std::int64_t                           value = 0;
+    };
+
+    struct Summary
+    {
+        std::uint32_t                     instance      = 0;
+        std::uint32_t                     sequence      = 0;
+        std::uint64_t                     last_frame    = 0;
+        std::uint16_t                     frames        = 0;  // summarized here; 0 for a heartbeat while nothing was drawn
+        float                             frame_ms      = 0;  // mean
+        float                             frame_max_ms  = 0;
+        float                             cpu_ms        = 0;
+        float                             cpu_max_ms    = 0;
+        float                             gpu_ms        = -1; // mean of the frames that had a GPU time, -1 for none
+        float                             gpu_max_ms    = -1;
+        std::uint64_t                     memory_bytes  = 0;
+        std::uint32_t                     draw_calls    = 0;
+        std::uint16_t                     loads_queued  = 0;
+        std::uint16_t                     loads_active  = 0;
+        int                               counter_count = 0;
+        std::array<Counter, MAX_COUNTERS> counters{};
+    };
+
+    // a datagram without counters, and with all of them at their longest
+    inline constexpr std::size_t MIN_PACKET_SIZE = 4 + 2 + 4 + 4 + 8 + 2 + 6 * 4 + 8 + 4 + 2 + 2 + 1;
+    inline constexpr std::size_t MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_COUNTERS * (1 + MAX_COUNTER_NAME + 8);
+
+    struct Packet
+    {
+        std::array<unsigned char, MAX_PACKET_SIZE> bytes{};
+        std::size_t                                size = 0;
+
+        std::span<const unsigned char> View() const noexcept
+        {
+            return std::span{ bytes.data(), size };
+        }
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        void put(unsigned char*& out, T value) noexcept
+        {
+            std::memcpy(out, &value, sizeof(T));
+            out += sizeof(T);
+        }
+
+        template <typename T>
+        T take(const unsigned char*& in) noexcept
+        {
+            T value{};
+            std::memcpy(&value, in, sizeof(T));
+            in += sizeof(T);
+            return value;
+        }
+    }
+
+    inline Packet Encode(const Summary& summary) noexcept
+    {
+        Packet         packet;
+        unsigned char* out = packet.bytes.data();
+        detail::put(out, MAGIC);
+        detail::put(out, VERSION);
+        detail::put(out, summary.instance);
+        detail::put(out, summary.sequence);
+        detail::put(out, summary.last_frame);
+        detail::put(out, summary.frames);
+        detail::put(out, summary.frame_ms);
+        detail::put(out, summary.frame_max_ms);
+        detail::put(out, summary.cpu_ms);
+        detail::put(out, summary.cpu_max_ms);
+        detail::put(out, summary.gpu_ms);
+        detail::put(out, summary.gpu_max_ms);
+        detail::put(out, summary.memory_bytes);
+        detail::put(out, summary.draw_calls);
+        detail::put(out, summary.loads_queued);
+        detail::put(out, summary.loads_active);
+        const int count = std::clamp(summary.counter_count, 0, MAX_COUNTERS);
+        detail::put(out, static_cast<std::uint8_t>(count));
+        for (int c = 0; c < count; ++c)
+        {
+            const Counter&    counter = summary.counters[static_cast<std::size_t>(c)];
+            std::size_t       length  = 0;
+            while (length < MAX_COUNTER_NAME && counter.name[length] != '\0')
+                ++length;
+            detail::put(out, static_cast<std::uint8_t>(length));
+            std::memcpy(out, counter.name.data(), length);
+            out += length;
+            detail::put(out, counter.value);
+        }
+        packet.size = static_cast<std::size_t>(out - packet.bytes.data());
+        return packet;
+    }
+
+    // False for anything that isn't a whole packet of this version
+    inline bool Decode(std::span<const unsigned char> packet, Summary& out_summary) noexcept
+    {
+        if (packet.size() < MIN_PACKET_SIZE || packet.size() > MAX_PACKET_SIZE)
+            return false;
+        const unsigned char* in  = packet.data();
+        const unsigned char* end = packet.data() + packet.size();
+        if (detail::take<std::uint32_t>(in) != MAGIC || detail::take<std::uint16_t>(in) != VERSION)
+            return false;
+        Summary summary;
+        summary.instance     = detail::take<std::uint32_t>(in);
+        summary.sequence     = detail::take<std::uint32_t>(in);
+        summary.last_frame   = detail::take<std::uint64_t>(in);
+        summary.frames       = detail::take<std::uint16_t>(in);
+        summary.frame_ms     = detail::take<float>(in);
+        summary.frame_max_ms = detail::take<float>(in);
+        summary.cpu_ms       = detail::take<float>(in);
+        summary.cpu_max_ms   = detail::take<float>(in);
+        summary.gpu_ms       = detail::take<float>(in);
+        summary.gpu_max_ms   = detail::take<float>(in);
+        summary.memory_bytes = detail::take<std::uint64_t>(in);
+        summary.draw_calls   = detail::take<std::uint32_t>(in);
+        summary.loads_queued = detail::take<std::uint16_t>(in);
+        summary.loads_active  = detail::take<std::uint16_t>(in);
+        summary.counter_count = detail::take<std::uint8_t>(in);
+        if (summary.counter_count > MAX_COUNTERS)
+            return false;
+        for (int c = 0; c < summary.counter_count; ++c)
+        {
+            Counter& counter = summary.counters[static_cast<std::size_t>(c)];
+            if (in == end)
+                return false;
+            const std::size_t length = detail::take<std::uint8_t>(in);
+            if (length > MAX_COUNTER_NAME || static_cast<std::size_t>(end - in) < length + sizeof(std::int64_t))
+                return false;
+            std::memcpy(counter.name.data(), in, length);
+            in += length;
+            counter.value = detail::take<std::int64_t>(in);
+        }
+        if (in != end)
+            return false;
+        out_summary = summary;
+        return true;
+    }
+}
@@ -0,0 +1,203 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "text_renderer.h"
+
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "memory_tracker.h"
+#include "upload_budget.h"
+#include "vertex_layout.h"
+
+#include <cstddef>
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace
+{
+    constexpr const char* TEXT_VERTEX_SHADER = R"(
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aSize;
+layout(location = 2) in vec4 aUVRect;
+layout(location = 3) in vec4 aColor;
+
+uniform mat4 uProjection;
+
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void main()
+{
+    // triangle strip corners (0,0) (1,0) (0,1) (1,1)
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vTexCoord   = mix(aUVRect.xy, aUVRect.zw, corner);
+    vColor      = aColor;
+    gl_Position = uProjection * vec4(aPosition + corner * aSize, 0.0, 1.0);
+}
+)";
+
+    // 0.5 is the outline; fwidth is how much the distance changes across one pixel at this size
+    constexpr const char* TEXT_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+in vec4 vColor;
+
+uniform sampler2D uAtlas;
+
+out vec4 fragColor;
+
+void main()
+{
+    float distance = texture(uAtlas, vTexCoord).r;
+    float width    = max(fwidth(distance) * 0.5, 1e-4);
+    float coverage = smoothstep(0.5 - width, 0.5 + width, distance);
+    fragColor      = vec4(vColor.rgb, vColor.a * coverage);
+}
+)";
+
+    // per region; grows to the largest frame seen
+    constexpr std::size_t INITIAL_STREAM_BYTES = 4096 * sizeof(GlyphInstance);
+
+    constexpr auto GLYPH_LAYOUT = vertex_layout::PerInstance(vertex_layout::Make<GlyphInstance>(
+        VertexAttribute{ 0, attribute_format::Float2, offsetof(GlyphInstance, position) }, VertexAttribute{ 1, attribute_format::Float2, offsetof(GlyphInstance, size) },
+        VertexAttribute{ 2, attribute_format::Float4, offsetof(GlyphInstance, uv_rect) }, VertexAttribute{ 3, attribute_format::UByte4Norm, offsetof(GlyphInstance, color) }));
+}
+
+void TextRenderer::Setup()
+{
+    program.Request(TEXT_VERTEX_SHADER, TEXT_FRAGMENT_SHADER);
+
+    glGenVertexArrays(1, &vertex_array);
+    gl_state::BindVertexArray(vertex_array);
+    instance_stream.Setup(GL_ARRAY_BUFFER, INITIAL_STREAM_BYTES);
+    vertex_layout::Enable(GLYPH_LAYOUT);
+}
+
+void TextRenderer::Shutdown()
+{
+    instance_stream.Shutdown();
+    gl_state::DeleteVertexArray(vertex_array);
+    program.Reset();
+    if (atlas != 0)
+    {
+        gl_state::DeleteTexture(atlas);
+        memory_tracker::Free(MemoryCategory::Textures, memory_tracker::EstimateTextureBytes(GL_R8, atlas_size.x, atlas_size.y, 1));
+    }
+    vertex_array        = 0;
+    atlas               = 0;
+    atlas_size          = glm::ivec2{ 0 };
+    projection_location = -1;
+}
+
+void TextRenderer::SetAtlas(std::span<const unsigned char> pixels, int width, int height)
+{
+    if (atlas == 0)
+    {
+        glGenTextures(1, &atlas);
+    }
+    else
+    {
+        memory_tracker::Free(MemoryCategory::Textures, memory_tracker::EstimateTextureBytes(GL_R8, atlas_size.x, atlas_size.y, 1));
+    }
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(atlas);
+    // distances filter linearly into distances, which is all an SDF needs; mips would blur the edge
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    // rows of one byte texels needn't be 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    atlas_size = glm::ivec2{ width, height };
+    memory_tracker::Allocate(MemoryCategory::Textures, memory_tracker::EstimateTextureBytes(GL_R8, width, height, 1));
+    gl_stats::CountUpload(pixels.size());
+}
+
+void TextRenderer::UpdateAtlas(std::span<const unsigned char> pixels, int width, std::span<const AtlasRect> rects, UploadBudget& budget)
+{
+    if (atlas == 0 || rects.empty())
+        return;
+    const UploadBudget::Timer timer{ budget };
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(atlas);
+    // each rect straight out of the whole atlas's rows
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+    for (const AtlasRect& rect : rects)
+    {
+        const std::size_t first = static_cast<std::size_t>(rect.y) * static_cast<std::size_t>(width) + static_cast<std::size_t>(rect.x);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, GL_RED, GL_UNSIGNED_BYTE, pixels.data() + first);
+        const std::size_t bytes = static_cast<std::size_t>(rect.width) * static_cast<std::size_t>(rect.height);
+        budget.Spend(bytes);
+        gl_stats::CountUpload(bytes);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+bool TextRenderer::HasAtlas() const noexcept
+{
+    return atlas != 0;
+}
+
+void TextRenderer::Draw(const glm::mat4& projection, std::span<const GlyphInstance> glyphs)
+{
+    stats = Stats{};
+    if (glyphs.empty() || atlas == 0)
+        return;
+    if (!program.IsReady())
+    {
+        if (!program.Poll())
+        {
+            stats.pending = true;
+            return;
+        }
+        projection_location = glGetUniformLocation(program.Id(), "uProjection");
+        gl_state::UseProgram(program.Id());
+        glUniform1i(glGetUniformLocation(program.Id(), "uAtlas"), 0);
+    }
+
+    const auto  bytes       = glyphs.size_bytes();
+    std::size_t base_offset = 0;
+    void*       mapped      = instance_stream.Map(bytes, base_offset);
+    if (mapped == nullptr)
+        return;
+    std::memcpy(mapped, glyphs.data(), bytes);
+    instance_stream.Unmap();
+    gl_stats::CountUpload(bytes);
+
+    gl_state::SetEnabled(GL_BLEND, true);
+    gl_state::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(atlas);
+    gl_state::UseProgram(program.Id());
+    glUniformMatrix4fv(projection_location, 1, GL_FALSE, glm::value_ptr(projection));
+    gl_state::BindVertexArray(vertex_array);
+
+    vertex_layout::Bind(GLYPH_LAYOUT, base_offset);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(glyphs.size()));
+    gl_stats::CountDraw(2 * static_cast<long long>(glyphs.size())); // one quad per glyph
+    instance_stream.EndFrame();
+
+    stats.glyphs      = static_cast<int>(glyphs.size());
+    stats.draw_calls  = 1;
+    stats.buffer_size = static_cast<int>(instance_stream.GetStats().region_bytes * StreamBuffer::REGION_COUNT);
+}
+
+const TextRenderer::Stats& TextRenderer::LastFrameStats() const noexcept
+{
+    return stats;
+}
+
+void append_text_run(std::pmr::vector<GlyphInstance>& glyphs, const TextRun& run, const glm::vec2& top_left, float size, std::uint32_t color)
+{
+    const float scale = size / SdfFont::BAKE_SIZE;
+    for (const GlyphQuad& quad : run.glyphs)
+        glyphs.push_back(GlyphInstance{ top_left + quad.offset * scale, quad.size * scale, quad.uv_rect, color });
+}
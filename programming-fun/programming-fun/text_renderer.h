@@ -0,0 +1,76 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "sdf_font.h"
+#include "shader.h"
+#include "stream_buffer.h"
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+class UploadBudget;
+
+struct GlyphInstance
+{
+    glm::vec2     position{ 0.0f }; // top left
+    glm::vec2     size{ 0.0f };
+    glm::vec4     uv_rect{ 0.0f }; // u0, v0, u1, v1 in the font atlas
+    std::uint32_t color = 0xFFFFFFFFu; // RGBA8, R in the low byte
+};
+
+/**
+ * Draws glyphs from an SdfFont's atlas as one instanced draw, quads from gl_VertexID like SpriteBatch.
+ *
+ * The fragment shader turns the distance into coverage over about a screen pixel, measured with fwidth,
+ * so the edges stay sharp when magnified and don't shimmer when minified. The atlas is the one texture,
+ * so the whole frame's text is a single draw. SetAtlas uploads all of it; UpdateAtlas, on the main thread
+ * with the other uploads, only the rects the font wrote since.
+ */
+class TextRenderer
+{
+public:
+    struct Stats
+    {
+        int  glyphs      = 0;
+        int  draw_calls  = 0;
+        int  buffer_size = 0;
+        bool pending     = false; // the program is still compiling, so nothing was drawn
+    };
+
+    void Setup();
+    void Shutdown();
+
+    // The font's atlas, one byte a texel; replaces any earlier one
+    void SetAtlas(std::span<const unsigned char> pixels, int width, int height);
+    // `rects` of the atlas from `pixels`, rows `width` texels long; they go out whatever `budget` has left, since lines use them already
+    void UpdateAtlas(std::span<const unsigned char> pixels, int width, std::span<const AtlasRect> rects, UploadBudget& budget);
+    bool HasAtlas() const noexcept;
+
+    void Draw(const glm::mat4& projection, std::span<const GlyphInstance> glyphs);
+
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    ShaderProgram program;
+    GLint         projection_location = -1;
+    GLuint        vertex_array        = 0;
+    GLuint        atlas               = 0;
+    glm::ivec2    atlas_size{ 0 };
+    StreamBuffer  instance_stream;
+    Stats         stats;
+};
+
+// Appends `run`'s glyphs with the line's top left at `top_left`, `size` pixels high
+void append_text_run(std::pmr::vector<GlyphInstance>& glyphs, const TextRun& run, const glm::vec2& top_left, float size, std::uint32_t color);
@@ -0,0 +1,143 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "texture_array.h"
+
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "memory_tracker.h"
+#include "mip_chain.h"
+
+#include <algorithm>
+
+namespace
+{
+    bool has_texture_storage()
+    {
+#if defined(IS_WEBGL2)
+        return true;
+#else
+        return GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+#endif
+    }
+}
+
+TextureArray::TextureArray(int requested_max_layers, bool generate_mipmaps) : max_layers{ std::max(requested_max_layers, 1) }, mipmaps{ generate_mipmaps }
+{
+}
+
+TextureArray::~TextureArray()
+{
+    Shutdown();
+}
+
+ArrayLayer TextureArray::Add(const unsigned char* rgba_pixels, int image_width, int image_height)
+{
+    ArrayLayer result;
+    if (image_width <= 0 || image_height <= 0)
+        return result;
+    if (texture == 0)
+        createStorage(image_width, image_height);
+    if (image_width != width || image_height != height || layer_count >= max_layers)
+        return result;
+
+    uploadLayer(layer_count, rgba_pixels);
+    result.texture = texture;
+    result.layer   = layer_count++;
+    return result;
+}
+
+bool TextureArray::Replace(int layer, const unsigned char* rgba_pixels, int image_width, int image_height)
+{
+    if (texture == 0 || layer < 0 || layer >= layer_count || image_width != width || image_height != height)
+        return false;
+    uploadLayer(layer, rgba_pixels);
+    return true;
+}
+
+void TextureArray::Shutdown()
+{
+    gl_state::DeleteTexture(texture);
+    memory_tracker::Free(MemoryCategory::Textures, vram_bytes);
+    texture     = 0;
+    layer_count = 0;
+    width       = 0;
+    height      = 0;
+    levels      = 1;
+    vram_bytes  = 0;
+}
+
+GLuint TextureArray::Texture() const noexcept
+{
+    return texture;
+}
+
+int TextureArray::LayerCount() const noexcept
+{
+    return layer_count;
+}
+
+int TextureArray::MaxLayers() const noexcept
+{
+    return max_layers;
+}
+
+int TextureArray::Width() const noexcept
+{
+    return width;
+}
+
+int TextureArray::Height() const noexcept
+{
+    return height;
+}
+
+void TextureArray::createStorage(int layer_width, int layer_height)
+{
+    GLint max_size  = 0;
+    GLint max_depth = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_depth);
+    if (layer_width > max_size || layer_height > max_size)
+        return;
+    max_layers = std::min(max_layers, static_cast<int>(max_depth));
+    width      = layer_width;
+    height     = layer_height;
+    levels     = mipmaps ? mip_level_count(width, height) : 1;
+
+    glGenTextures(1, &texture);
+    gl_state::ActiveTexture(0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (has_texture_storage())
+    {
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, width, height, max_layers);
+    }
+    else
+    {
+        // glGenerateMipmap makes the rest of the chain on the first Add
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, max_layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    vram_bytes = memory_tracker::EstimateTextureBytes(GL_RGBA8, width, height, levels) * static_cast<std::size_t>(max_layers);
+    memory_tracker::Allocate(MemoryCategory::Textures, vram_bytes);
+}
+
+void TextureArray::uploadLayer(int layer, const unsigned char* rgba_pixels)
+{
+    gl_state::ActiveTexture(0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba_pixels);
+    gl_stats::CountUpload(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (levels > 1)
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
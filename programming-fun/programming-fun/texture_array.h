@@ -0,0 +1,65 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+
+struct ArrayLayer
+{
+    GLuint texture = 0; // 0 when the image did not fit: another size, or no layers left
+    int    layer   = -1;
+};
+
+/**
+ * Same-size RGBA8 images as the layers of one GL_TEXTURE_2D_ARRAY, so sprites of different images share a draw.
+ *
+ * The first Add picks the layer size and makes storage for every layer, immutable where glTexStorage3D
+ * exists; images of any other size are rejected like ones too large for an atlas page. Each layer has its
+ * own mip chain, so unlike an atlas minified sprites never pick up their neighbours' pixels. The chain is
+ * regenerated for the whole array on each Add, which suits loading a handful of images rather than streaming.
+ */
+class TextureArray
+{
+public:
+    static constexpr int DEFAULT_MAX_LAYERS = 16;
+
+    explicit TextureArray(int max_layers = DEFAULT_MAX_LAYERS, bool mipmaps = true);
+    ~TextureArray();
+
+    TextureArray(const TextureArray&)                = delete;
+    TextureArray& operator=(const TextureArray&)     = delete;
+    TextureArray(TextureArray&&) noexcept            = delete;
+    TextureArray& operator=(TextureArray&&) noexcept = delete;
+
+    // GL thread only. Leaves GL_TEXTURE_2D_ARRAY on unit 0 bound to the array.
+    ArrayLayer Add(const unsigned char* rgba_pixels, int width, int height);
+    // New pixels for a layer Add filled; false unless they're the array's size
+    bool Replace(int layer, const unsigned char* rgba_pixels, int width, int height);
+    void Shutdown();
+
+    GLuint Texture() const noexcept;
+    int    LayerCount() const noexcept;
+    int    MaxLayers() const noexcept;
+    int    Width() const noexcept;
+    int    Height() const noexcept;
+
+private:
+    void createStorage(int width, int height);
+    void uploadLayer(int layer, const unsigned char* rgba_pixels);
+
+private:
+    GLuint      texture     = 0;
+    int         max_layers  = DEFAULT_MAX_LAYERS;
+    int         layer_count = 0;
+    int         width       = 0;
+    int         height      = 0;
+    int         levels      = 1;
+    bool        mipmaps     = true;
+    std::size_t vram_bytes  = 0;
+};
@@ -0,0 +1,170 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "texture_atlas.h"
+
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "memory_tracker.h"
+
+#include <algorithm>
+
+// ImGui compiles its own static copy for the font atlas, so we keep ours private to this file too
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
+
+struct TextureAtlas::Page
+{
+    GLuint                  texture = 0;
+    stbrp_context           packer{};
+    std::vector<stbrp_node> nodes;
+    long long               used_area = 0;
+};
+
+TextureAtlas::TextureAtlas(int requested_page_size) : page_size{ requested_page_size }
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    Shutdown();
+}
+
+AtlasRegion TextureAtlas::Add(const unsigned char* rgba_pixels, int width, int height)
+{
+    AtlasRegion region;
+    if (width + PADDING > page_size || height + PADDING > page_size)
+        return region;
+
+    stbrp_rect rect{};
+    rect.w = width + PADDING;
+    rect.h = height + PADDING;
+
+    Page* target = nullptr;
+    for (auto& page : pages)
+    {
+        if (stbrp_pack_rects(&page->packer, &rect, 1) != 0 && rect.was_packed)
+        {
+            target = page.get();
+            break;
+        }
+    }
+    if (target == nullptr)
+    {
+        target = &createPage();
+        stbrp_pack_rects(&target->packer, &rect, 1);
+        if (!rect.was_packed)
+            return region;
+    }
+
+    region.texture = target->texture;
+    region.page    = static_cast<int>(std::find_if(pages.begin(), pages.end(), [target](const auto& p) { return p.get() == target; }) - pages.begin());
+    region.x       = rect.x + PADDING / 2;
+    region.y       = rect.y + PADDING / 2;
+    region.width   = width;
+    region.height  = height;
+
+    const float inverse = 1.0f / static_cast<float>(page_size);
+    region.uv_rect      = glm::vec4{ static_cast<float>(region.x), static_cast<float>(region.y), static_cast<float>(region.x + width), static_cast<float>(region.y + height) } * inverse;
+
+    upload(region, rgba_pixels);
+    target->used_area += static_cast<long long>(rect.w) * rect.h;
+    ++region_count;
+    return region;
+}
+
+bool TextureAtlas::Replace(const AtlasRegion& region, const unsigned char* rgba_pixels, int width, int height)
+{
+    if (region.texture == 0 || width != region.width || height != region.height)
+        return false;
+    upload(region, rgba_pixels);
+    return true;
+}
+
+void TextureAtlas::Shutdown()
+{
+    for (auto& page : pages)
+    {
+        gl_state::DeleteTexture(page->texture);
+        memory_tracker::Free(MemoryCategory::Textures, memory_tracker::EstimateTextureBytes(GL_RGBA8, page_size, page_size, 1));
+    }
+    pages.clear();
+    region_count = 0;
+}
+
+int TextureAtlas::PageCount() const noexcept
+{
+    return static_cast<int>(pages.size());
+}
+
+int TextureAtlas::PageSize() const noexcept
+{
+    return page_size;
+}
+
+GLuint TextureAtlas::PageTexture(int page) const noexcept
+{
+    return pages[static_cast<std::size_t>(page)]->texture;
+}
+
+int TextureAtlas::RegionCount() const noexcept
+{
+    return region_count;
+}
+
+float TextureAtlas::PageOccupancy(int page) const noexcept
+{
+    const auto total = static_cast<double>(page_size) * page_size;
+    return static_cast<float>(static_cast<double>(pages[static_cast<std::size_t>(page)]->used_area) / total);
+}
+
+void TextureAtlas::upload(const AtlasRegion& region, const unsigned char* rgba_pixels)
+{
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(region.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, region.x, region.y, region.width, region.height, GL_RGBA, GL_UNSIGNED_BYTE, rgba_pixels);
+    gl_stats::CountUpload(static_cast<std::size_t>(region.width) * static_cast<std::size_t>(region.height) * 4);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+TextureAtlas::Page& TextureAtlas::createPage()
+{
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    page_size = std::min(page_size, static_cast<int>(max_size));
+
+    auto page = std::make_unique<Page>();
+    page->nodes.resize(static_cast<std::size_t>(page_size));
+    stbrp_init_target(&page->packer, page_size, page_size, page->nodes.data(), static_cast<int>(page->nodes.size()));
+
+    glGenTextures(1, &page->texture);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(page->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, page_size, page_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    memory_tracker::Allocate(MemoryCategory::Textures, memory_tracker::EstimateTextureBytes(GL_RGBA8, page_size, page_size, 1));
+
+    // clear through a framebuffer so the padding gutters are transparent without a page-sized CPU buffer
+    GLuint framebuffer = 0;
+    GLint  previous    = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, page->texture, 0);
+    const GLfloat transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, transparent);
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previous));
+    glDeleteFramebuffers(1, &framebuffer);
+
+    pages.push_back(std::move(page));
+    return *pages.back();
+}
@@ -0,0 +1,68 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <vector>
+
+struct AtlasRegion
+{
+    GLuint    texture = 0; // 0 when the image did not fit
+    int       page    = -1;
+    int       x       = 0;
+    int       y       = 0;
+    int       width   = 0;
+    int       height  = 0;
+    glm::vec4 uv_rect{ 0.0f, 0.0f, 1.0f, 1.0f };
+};
+
+/**
+ * Packs RGBA8 images into a few large page textures with imstb_rectpack.
+ *
+ * Packing is incremental: each page keeps its skyline between calls, so a new image only consumes
+ * remaining space and existing regions never move. A new page is created when no page has room.
+ */
+class TextureAtlas
+{
+public:
+    static constexpr int DEFAULT_PAGE_SIZE = 2048;
+    static constexpr int PADDING           = 2;
+
+    explicit TextureAtlas(int page_size = DEFAULT_PAGE_SIZE);
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&)                = delete;
+    TextureAtlas& operator=(const TextureAtlas&)     = delete;
+    TextureAtlas(TextureAtlas&&) noexcept            = delete;
+    TextureAtlas& operator=(TextureAtlas&&) noexcept = delete;
+
+    // GL thread only. Images larger than a page are rejected (texture == 0).
+    AtlasRegion Add(const unsigned char* rgba_pixels, int width, int height);
+    // New pixels for a region Add returned; false unless they're the region's size, since regions never move
+    bool Replace(const AtlasRegion& region, const unsigned char* rgba_pixels, int width, int height);
+    void Shutdown();
+
+    int    PageCount() const noexcept;
+    int    PageSize() const noexcept;
+    GLuint PageTexture(int page) const noexcept;
+    int    RegionCount() const noexcept;
+    float  PageOccupancy(int page) const noexcept;
+
+private:
+    struct Page;
+
+    Page& createPage();
+    void  upload(const AtlasRegion& region, const unsigned char* rgba_pixels);
+
+private:
+    int                                page_size = DEFAULT_PAGE_SIZE;
+    std::vector<std::unique_ptr<Page>> pages;
+    int                                region_count = 0;
+};
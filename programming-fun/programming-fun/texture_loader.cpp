@@ -0,0 +1,1517 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "texture_loader.h"
+
+#include "asset_pack.h"
+#include "async_file_reader.h"
+#include "decode_scratch.h"
+#include "decoded_cache.h"
+#include "gl_backend.h"
+#include "gl_extensions.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "ktx2.h"
+#include "load_scheduler.h"
+#include "logger.h"
+#include "memory_tracker.h"
+#include "mip_chain.h"
+#include "perf_counters.h"
+#include "pixel_kernels.h"
+#include "qoi_strips.h"
+#include "release_queue.h"
+#include "startup_trace.h"
+#include "texture_array.h"
+#include "texture_atlas.h"
+#include "upload_budget.h"
+#include "upload_thread.h"
+#include "worker_pool.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <glm/gtc/packing.hpp>
+#include <sstream>
+#include <stb_image.h>
+#include <string>
+
+#if !defined(GL_TEXTURE_MAX_ANISOTROPY_EXT)
+#    define GL_TEXTURE_MAX_ANISOTROPY_EXT     0x84FE
+#    define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+namespace
+{
+    // how a decoded image's texels are laid out: one to four components, 8 bit or half float
+    struct PixelFormat
+    {
+        int  channels = 4;
+        bool is_half  = false;
+        bool is_bgra  = false; // four 8 bit channels, red and blue swapped for a GL_BGRA upload
+
+        bool operator==(const PixelFormat&) const = default;
+
+        std::size_t TexelBytes() const noexcept
+        {
+            return static_cast<std::size_t>(channels) * (is_half ? 2 : 1);
+        }
+
+        GLenum InternalFormat() const noexcept
+        {
+            constexpr GLenum BYTES[]  = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+            constexpr GLenum HALVES[] = { GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F };
+            return (is_half ? HALVES : BYTES)[channels - 1];
+        }
+
+        GLenum TransferFormat() const noexcept
+        {
+            constexpr GLenum FORMATS[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+            return is_bgra ? GL_BGRA : FORMATS[channels - 1];
+        }
+
+        GLenum TransferType() const noexcept
+        {
+            return is_half ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE;
+        }
+
+        // names the decoded cache's variant
+        const char* Name() const noexcept
+        {
+            constexpr const char* BYTES[]  = { "r8", "rg8", "rgb8", "rgba8" };
+            constexpr const char* HALVES[] = { "r16f", "rg16f", "rgb16f", "rgba16f" };
+            return is_bgra ? "bgra8" : (is_half ? HALVES : BYTES)[channels - 1];
+        }
+    };
+
+    constexpr PixelFormat RGBA8{};
+
+    // what a worker may decode a texture of its own into, settled on the GL thread since it depends on the context
+    struct FormatRules
+    {
+        bool keep_rgb    = false;
+        bool keep_gray   = false; // one and two channels, which need swizzles to read as RGBA
+        bool half_float  = false;
+        bool premultiply = false; // these three make pixel_kernels::Ops; the first and the last want RGBA8
+        bool flip        = false;
+        bool bgra        = false;
+
+        pixel_kernels::Ops Ops() const noexcept
+        {
+            return pixel_kernels::Ops{ .premultiply = premultiply, .swap_red_blue = bgra, .flip_rows = flip };
+        }
+    };
+}
+
+struct TextureLoader::DecodedImage
+{
+    std::vector<unsigned char>                  pixels; // copied out of the worker's decode scratch
+    int                                         width  = 0;
+    int                                         height = 0;
+    PixelFormat                                 format;     // of pixels, levels and the preview
+    std::vector<std::vector<unsigned char>>     mip_levels; // level 1 onward, only when built on the worker
+    decoded_cache::Entry                        cached;     // a warm start maps both instead
+    std::vector<std::span<const unsigned char>> levels;     // level 0 then the worker's mips, from either; empty when decoding failed
+    ktx2::Image                                 compressed; // used instead of levels when a compressed variant was found
+    std::span<const unsigned char>              preview;    // a progressive image's small level, in one of the others or in preview_pixels
+    std::vector<unsigned char>                  preview_pixels;
+    int                                         preview_width  = 0;
+    int                                         preview_height = 0;
+
+    // what uploading it all sends, the preview aside
+    std::size_t Bytes() const noexcept
+    {
+        std::size_t bytes = compressed.data.size();
+        for (const auto& level : levels)
+            bytes += level.size();
+        return bytes;
+    }
+};
+
+struct TextureLoader::Job
+{
+    std::shared_ptr<AsyncTexture> target;
+    TextureOptions                options;
+    TextureAtlas*                 atlas = nullptr;
+    TextureArray*                 array = nullptr;
+    DecodedImage                  image;
+    FormatRules                   formats;
+    bool                          try_compressed = false;
+    std::shared_ptr<AsyncTexture> replaces;            // a reload: `target` only carries the path, the image goes into this one
+    Swap                          swap = Swap::Reload; // what goes in place of `replaces`'s texture
+    AtlasRegion                   region;              // where a reload into the atlas goes
+    AssetHandle                   asset;
+    LoadPriority                  priority = LoadPriority::Visible;
+    Texture                       refined; // a texture uploaded in bands, filled in behind its preview if it has one
+    int                           refine_level   = 0;
+    int                           refine_row     = 0;
+    std::size_t                   uploaded_bytes = 0; // of its bands so far
+    std::size_t                   demoting       = 0; // the live texture's bytes, counted in demoting_bytes until its stand-in lands
+};
+
+namespace
+{
+    float max_supported_anisotropy()
+    {
+        static const float limit = []()
+        {
+            if (!has_gl_extension("GL_EXT_texture_filter_anisotropic") && !has_gl_extension("GL_ARB_texture_filter_anisotropic"))
+                return 1.0f;
+            GLfloat value = 1.0f;
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &value);
+            return value;
+        }();
+        return limit;
+    }
+
+    bool has_texture_storage()
+    {
+#if defined(IS_WEBGL2)
+        return true;
+#else
+        return GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+#endif
+    }
+
+    bool has_texture_swizzle()
+    {
+#if defined(IS_WEBGL2)
+        return false;
+#else
+        return GLEW_VERSION_3_3 || GLEW_ARB_texture_swizzle;
+#endif
+    }
+
+    // glGenerateMipmap needs a format it can render to, which WebGL2 only has in half floats with EXT_color_buffer_float
+    bool has_half_float_mips()
+    {
+#if defined(IS_WEBGL2)
+        return has_gl_extension("GL_EXT_color_buffer_float");
+#else
+        return true;
+#endif
+    }
+
+    bool has_bgra_upload()
+    {
+#if defined(IS_WEBGL2)
+        return false;
+#else
+        return true;
+#endif
+    }
+
+    // atlas pages and array layers are RGBA8 whatever the options say
+    FormatRules format_rules(const TextureOptions& options, bool is_own_texture)
+    {
+        FormatRules rules;
+        rules.premultiply = options.premultiply_alpha;
+        rules.flip        = options.flip_vertically;
+        rules.bgra        = is_own_texture && options.upload_bgra && has_bgra_upload();
+        // premultiplying and swizzling work on four 8 bit channels
+        const bool rgba8  = rules.premultiply || rules.bgra;
+        rules.keep_rgb    = is_own_texture && options.keep_channels && !rgba8;
+        rules.keep_gray   = rules.keep_rgb && has_texture_swizzle();
+        rules.half_float  = is_own_texture && options.high_precision && options.max_dimension <= 0 && has_half_float_mips() && !rgba8;
+        return rules;
+    }
+
+    // read from the encoded file's header, before anything is decoded
+    PixelFormat choose_format(std::span<const unsigned char> source, const FormatRules& rules)
+    {
+        const auto size     = static_cast<int>(source.size());
+        int        width    = 0;
+        int        height   = 0;
+        int        channels = 0;
+        if (source.empty() || !stbi_info_from_memory(source.data(), size, &width, &height, &channels))
+            return PixelFormat{ .is_bgra = rules.bgra };
+        PixelFormat format;
+        format.is_bgra = rules.bgra;
+        format.is_half = rules.half_float && (stbi_is_16_bit_from_memory(source.data(), size) || stbi_is_hdr_from_memory(source.data(), size));
+        if ((channels == 3 && rules.keep_rgb) || (channels < 3 && rules.keep_gray))
+            format.channels = channels;
+#if defined(IS_WEBGL2)
+        // RGBA16F is the one half float format it can make mips for
+        if (format.is_half)
+            format.channels = 4;
+#endif
+        return format;
+    }
+
+    std::size_t image_bytes(int width, int height, PixelFormat format)
+    {
+        return static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * format.TexelBytes();
+    }
+
+    // premultiplies, swizzles and flips as the rules say, in one pass; after any shrink, before the mips
+    void convert_pixels(std::vector<unsigned char>& pixels, int width, int height, PixelFormat format, const FormatRules& rules)
+    {
+        const pixel_kernels::Ops ops = rules.Ops();
+        if (!ops.Any() || pixels.empty())
+            return;
+        pixel_kernels::Convert(pixels.data(), width, height, format.TexelBytes(), ops);
+    }
+
+    // names what convert_pixels did to the decoded cache's variant; the swizzle is in the format's name already
+    std::string conversion_name(const FormatRules& rules)
+    {
+        return std::string{ rules.premultiply ? "+premultiplied" : "" } + (rules.flip ? "+flipped" : "");
+    }
+
+    // stb's own buffer goes before returning, so in a decode_scratch::Scope only `out_pixels` outlives the arena
+    bool decode_pixels(std::span<const unsigned char> source, PixelFormat format, std::vector<unsigned char>& out_pixels, int& out_width, int& out_height)
+    {
+        if (source.empty())
+            return false;
+        const auto size = static_cast<int>(source.size());
+        if (!format.is_half)
+        {
+            unsigned char* texels = stbi_load_from_memory(source.data(), size, &out_width, &out_height, NULL, format.channels);
+            if (texels == nullptr)
+                return false;
+            out_pixels.assign(texels, texels + image_bytes(out_width, out_height, format));
+            stbi_image_free(texels);
+            return true;
+        }
+
+        // HDR components are taken as they are and 16 bit ones as unorm, then each goes to half the bytes
+        const auto store = [&out_pixels](std::size_t index, float value)
+        {
+            const std::uint16_t half = glm::packHalf1x16(value);
+            std::memcpy(out_pixels.data() + index * sizeof(half), &half, sizeof(half));
+        };
+        if (stbi_is_hdr_from_memory(source.data(), size))
+        {
+            float* texels = stbi_loadf_from_memory(source.data(), size, &out_width, &out_height, NULL, format.channels);
+            if (texels == nullptr)
+                return false;
+            out_pixels.resize(image_bytes(out_width, out_height, format));
+            for (std::size_t i = 0; i < out_pixels.size() / 2; ++i)
+                store(i, texels[i]);
+            stbi_image_free(texels);
+            return true;
+        }
+        stbi_us* texels = stbi_load_16_from_memory(source.data(), size, &out_width, &out_height, NULL, format.channels);
+        if (texels == nullptr)
+            return false;
+        out_pixels.resize(image_bytes(out_width, out_height, format));
+        for (std::size_t i = 0; i < out_pixels.size() / 2; ++i)
+            store(i, static_cast<float>(texels[i]) / 65535.0f);
+        stbi_image_free(texels);
+        return true;
+    }
+
+    // gray reads as (l, l, l, 1) and gray+alpha as (l, l, l, a), so shaders see RGBA whatever was kept
+    void apply_swizzle(GLuint texture, PixelFormat format)
+    {
+        if (format.channels > 2)
+            return;
+        const gl_backend::Functions& gl = gl_backend::Get();
+        gl.texture_parameter_i(texture, GL_TEXTURE_SWIZZLE_R, GL_RED);
+        gl.texture_parameter_i(texture, GL_TEXTURE_SWIZZLE_G, GL_RED);
+        gl.texture_parameter_i(texture, GL_TEXTURE_SWIZZLE_B, GL_RED);
+        gl.texture_parameter_i(texture, GL_TEXTURE_SWIZZLE_A, format.channels == 1 ? GL_ONE : GL_GREEN);
+    }
+
+    // rows of R8, RG8 and RGB8 texels, or RGB16F, needn't fill whole words
+    bool needs_byte_alignment(PixelFormat format)
+    {
+        return format.TexelBytes() % 4 != 0;
+    }
+
+    struct UploadLevel
+    {
+        const unsigned char* pixels = nullptr;
+        std::size_t          bytes  = 0;
+        int                  width  = 0;
+        int                  height = 0;
+    };
+
+    // A new texture with the request's sampling; immutable storage when supported, otherwise only the level range
+    GLuint create_texture(GLenum internal_format, int width, int height, int storage_levels, const TextureOptions& options)
+    {
+        const gl_backend::Functions& gl            = gl_backend::Get();
+        const GLuint                 image_texture = gl.create_texture_2d();
+
+        // Setup filtering parameters for display
+        const bool has_mips = storage_levels > 1;
+        gl.texture_parameter_i(image_texture, GL_TEXTURE_MIN_FILTER, has_mips ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        gl.texture_parameter_i(image_texture, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(options.mag_filter));
+        gl.texture_parameter_i(image_texture, GL_TEXTURE_WRAP_S, static_cast<GLint>(options.wrap_s));
+        gl.texture_parameter_i(image_texture, GL_TEXTURE_WRAP_T, static_cast<GLint>(options.wrap_t));
+        if (const float anisotropy = std::min(options.max_anisotropy, max_supported_anisotropy()); anisotropy > 1.0f)
+        {
+            gl.texture_parameter_f(image_texture, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+        }
+
+        // immutable storage lets the driver skip re-validating the level chain on every upload
+        if (has_texture_storage())
+            gl.texture_storage_2d(image_texture, storage_levels, internal_format, width, height);
+        else
+            gl.texture_parameter_i(image_texture, GL_TEXTURE_MAX_LEVEL, storage_levels - 1);
+        return image_texture;
+    }
+
+    // Uploads `levels` of `format` texels into a new texture, or blocks of `compressed_format` through the
+    // glCompressedTex* entry points when it isn't 0; storage_levels may exceed levels.size() when the rest is generated.
+    GLuint upload_levels(PixelFormat format, GLenum compressed_format, const std::vector<UploadLevel>& levels, int storage_levels, const TextureOptions& options, PixelUploadRing* ring)
+    {
+        const gl_backend::Functions& gl              = gl_backend::Get();
+        const GLenum                 internal_format = compressed_format != 0 ? compressed_format : format.InternalFormat();
+        const GLuint                 image_texture   = create_texture(internal_format, levels.front().width, levels.front().height, storage_levels, options);
+        const bool                   immutable       = has_texture_storage();
+        const bool                   byte_aligned    = compressed_format == 0 && needs_byte_alignment(format);
+        if (compressed_format == 0)
+            apply_swizzle(image_texture, format);
+        if (!immutable)
+        {
+            // mutable levels have no by-name entry point; only contexts without direct state access get here
+            gl_state::ActiveTexture(0);
+            gl_state::BindTexture(image_texture);
+        }
+
+        std::size_t total_bytes = 0;
+        for (const UploadLevel& level : levels)
+            total_bytes += level.bytes;
+
+        // Stage every level in the ring so the driver copies from buffer memory instead of our heap
+        std::size_t    ring_offset = 0;
+        unsigned char* staging     = (immutable && ring != nullptr) ? ring->Reserve(total_bytes, ring_offset) : nullptr;
+        if (staging != nullptr)
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->Buffer());
+        if (byte_aligned)
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        std::size_t offset = ring_offset;
+        for (std::size_t i = 0; i < levels.size(); ++i)
+        {
+            const UploadLevel& level  = levels[i];
+            const void*        source = level.pixels;
+            const auto         index  = static_cast<GLint>(i);
+            const auto         bytes  = static_cast<GLsizei>(level.bytes);
+            if (staging != nullptr)
+            {
+                std::memcpy(staging + (offset - ring_offset), level.pixels, level.bytes);
+                source = reinterpret_cast<const void*>(offset);
+                offset += level.bytes;
+            }
+            if (compressed_format != 0 && immutable)
+                gl.compressed_texture_sub_image_2d(image_texture, index, 0, 0, level.width, level.height, compressed_format, bytes, source);
+            else if (compressed_format != 0)
+                glCompressedTexImage2D(GL_TEXTURE_2D, index, compressed_format, level.width, level.height, 0, bytes, source);
+            else if (immutable)
+                gl.texture_sub_image_2d(image_texture, index, 0, 0, level.width, level.height, format.TransferFormat(), format.TransferType(), source);
+            else
+                glTexImage2D(GL_TEXTURE_2D, index, static_cast<GLint>(internal_format), level.width, level.height, 0, format.TransferFormat(), format.TransferType(), source);
+            gl_stats::CountUpload(level.bytes);
+        }
+
+        if (byte_aligned)
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (staging != nullptr)
+        {
+            ring->Fence();
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        return image_texture;
+    }
+
+    GLuint upload_pixels(PixelFormat format, const unsigned char* image_data, int image_width, int image_height, const TextureOptions& options,
+                         std::span<const std::span<const unsigned char>> mip_levels = {}, PixelUploadRing* ring = nullptr)
+    {
+        std::vector<UploadLevel> levels{ UploadLevel{ image_data, image_bytes(image_width, image_height, format), image_width, image_height } };
+        for (const auto& pixels : mip_levels)
+        {
+            const UploadLevel& previous = levels.back();
+            const int          width    = std::max(1, previous.width / 2);
+            const int          height   = std::max(1, previous.height / 2);
+            levels.push_back(UploadLevel{ pixels.data(), pixels.size(), width, height });
+        }
+
+        const int    storage_levels = options.generate_mipmaps ? mip_level_count(image_width, image_height) : 1;
+        const GLuint texture        = upload_levels(format, 0, levels, storage_levels, options, ring);
+        if (options.generate_mipmaps && mip_levels.empty())
+        {
+            gl_backend::Get().generate_mipmap(texture);
+        }
+        return texture;
+    }
+
+    // Storage for `storage_levels` of `format` with nothing in it yet, for upload_rows to fill
+    GLuint allocate_pixels(PixelFormat format, int width, int height, int storage_levels, const TextureOptions& options)
+    {
+        const GLuint texture = create_texture(format.InternalFormat(), width, height, storage_levels, options);
+        apply_swizzle(texture, format);
+        if (!has_texture_storage())
+        {
+            gl_state::ActiveTexture(0);
+            gl_state::BindTexture(texture);
+            for (int level = 0; level < storage_levels; ++level)
+                glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(format.InternalFormat()), std::max(1, width >> level), std::max(1, height >> level), 0, format.TransferFormat(),
+                             format.TransferType(), nullptr);
+        }
+        return texture;
+    }
+
+    // Rows [y, y + rows) of a level of `texture`, staged in the ring when it has room
+    void upload_rows(GLuint texture, int level, int y, int width, int rows, const unsigned char* pixels, PixelFormat format, PixelUploadRing* ring)
+    {
+        const std::size_t bytes   = image_bytes(width, rows, format);
+        std::size_t       offset  = 0;
+        unsigned char*    staging = ring != nullptr ? ring->Reserve(bytes, offset) : nullptr;
+        const void*       source  = pixels;
+        if (staging != nullptr)
+        {
+            std::memcpy(staging, pixels, bytes);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->Buffer());
+            source = reinterpret_cast<const void*>(offset);
+        }
+        if (needs_byte_alignment(format))
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        gl_backend::Get().texture_sub_image_2d(texture, level, 0, y, width, rows, format.TransferFormat(), format.TransferType(), source);
+        if (needs_byte_alignment(format))
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        gl_stats::CountUpload(bytes);
+        if (staging != nullptr)
+        {
+            ring->Fence();
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+    }
+
+    GLuint upload_compressed(const ktx2::Image& image, GLenum gl_format, const TextureOptions& options, PixelUploadRing* ring)
+    {
+        // compressed chains cannot be generated on the GPU, so whatever the file holds is what we sample
+        std::vector<UploadLevel> levels;
+        for (const ktx2::Level& level : image.levels)
+            levels.push_back(UploadLevel{ image.data.data() + level.offset, level.size, level.width, level.height });
+        return upload_levels(RGBA8, gl_format, levels, static_cast<int>(levels.size()), options, ring);
+    }
+
+    // drops the levels over PREVIEW_SIZE for a demoted texture's stand-in, and their bytes; a chain without a small level stays whole
+    void keep_small_levels(ktx2::Image& image)
+    {
+        const auto small = std::find_if(image.levels.begin(), image.levels.end(),
+                                        [](const ktx2::Level& level) { return level.width <= TextureLoader::PREVIEW_SIZE && level.height <= TextureLoader::PREVIEW_SIZE; });
+        if (small == image.levels.begin() || small == image.levels.end())
+            return;
+        image.levels.erase(image.levels.begin(), small);
+        std::vector<unsigned char> data;
+        for (ktx2::Level& level : image.levels)
+        {
+            data.insert(data.end(), image.data.begin() + static_cast<std::ptrdiff_t>(level.offset), image.data.begin() + static_cast<std::ptrdiff_t>(level.offset + level.size));
+            level.offset = data.size() - level.size;
+        }
+        image.data   = std::move(data);
+        image.width  = image.levels.front().width;
+        image.height = image.levels.front().height;
+    }
+
+    bool is_half_float(GLenum internal_format) noexcept
+    {
+        return internal_format == GL_R16F || internal_format == GL_RG16F || internal_format == GL_RGB16F || internal_format == GL_RGBA16F;
+    }
+
+    struct CompressedVariant
+    {
+        const char*   suffix;
+        std::uint32_t vk_format;
+        GLenum        gl_format;
+        const char*   extensions[3];
+    };
+
+    // In preference order. ETC2 is left out on desktop where drivers usually decompress it in software.
+    constexpr CompressedVariant COMPRESSED_VARIANTS[] = {
+        { "bc7", ktx2::FORMAT_BC7_UNORM, 0x8E8C, { "GL_ARB_texture_compression_bptc", "GL_EXT_texture_compression_bptc", nullptr } },
+        { "astc", ktx2::FORMAT_ASTC_4x4_UNORM, 0x93B0, { "GL_KHR_texture_compression_astc_ldr", "GL_WEBGL_compressed_texture_astc", "WEBGL_compressed_texture_astc" } },
+        { "bc3", ktx2::FORMAT_BC3_UNORM, 0x83F3, { "GL_EXT_texture_compression_s3tc", "GL_WEBGL_compressed_texture_s3tc", "WEBGL_compressed_texture_s3tc" } },
+#if defined(IS_WEBGL2)
+        { "etc2", ktx2::FORMAT_ETC2_R8G8B8A8_UNORM, 0x9278, { "GL_WEBGL_compressed_texture_etc", "WEBGL_compressed_texture_etc", nullptr } },
+#endif
+        { "bc1", ktx2::FORMAT_BC1_RGBA_UNORM, 0x83F1, { "GL_EXT_texture_compression_s3tc", "GL_WEBGL_compressed_texture_s3tc", "WEBGL_compressed_texture_s3tc" } },
+    };
+
+    bool is_variant_supported(const CompressedVariant& variant)
+    {
+#if !defined(IS_WEBGL2)
+        if (variant.vk_format == ktx2::FORMAT_BC7_UNORM && GLEW_VERSION_4_2)
+            return true;
+#endif
+        return std::any_of(std::begin(variant.extensions), std::end(variant.extensions), [](const char* name) { return name != nullptr && has_gl_extension(name); });
+    }
+
+    // Asked on the GL thread; the workers only get the resulting list
+    const std::vector<const CompressedVariant*>& supported_variants()
+    {
+        static const std::vector<const CompressedVariant*> supported = []()
+        {
+            std::vector<const CompressedVariant*> result;
+            for (const CompressedVariant& variant : COMPRESSED_VARIANTS)
+            {
+                if (is_variant_supported(variant))
+                    result.push_back(&variant);
+            }
+            return result;
+        }();
+        return supported;
+    }
+
+    GLenum gl_format_for(std::uint32_t vk_format)
+    {
+        for (const CompressedVariant* variant : supported_variants())
+        {
+            if (variant->vk_format == vk_format)
+                return variant->gl_format;
+        }
+        return 0;
+    }
+
+    // duck.png -> duck.bc7.ktx2, duck.bc3.ktx2, ... next to it, first supported one that exists wins
+    bool load_ktx2(const std::filesystem::path& filename, const AssetPack* pack, AsyncFileReader* reader, ktx2::Image& out_image)
+    {
+        if (pack != nullptr && pack->IsOpen())
+        {
+            std::vector<unsigned char> storage;
+            const auto                 bytes = pack->ReadFile(filename, storage);
+            return !bytes.empty() && ktx2::Load(bytes, out_image);
+        }
+        if (std::vector<unsigned char> bytes; reader != nullptr && reader->Take(filename, bytes))
+            return ktx2::Load(bytes, out_image);
+        std::error_code error;
+        return std::filesystem::exists(filename, error) && ktx2::Load(filename, out_image);
+    }
+
+    bool load_compressed_variant(const std::filesystem::path& filename, const AssetPack* pack, AsyncFileReader* reader, const std::vector<const CompressedVariant*>& variants,
+                                 ktx2::Image& out_image)
+    {
+        if (filename.extension() == ".ktx2")
+            return load_ktx2(filename, pack, reader, out_image);
+        for (const CompressedVariant* variant : variants)
+        {
+            auto candidate = filename;
+            candidate.replace_extension(std::string{ "." } + variant->suffix + ".ktx2");
+            if (load_ktx2(candidate, pack, reader, out_image) && out_image.vk_format == variant->vk_format)
+                return true;
+        }
+        return false;
+    }
+
+    // duck.png for itself, for duck.bc7.ktx2 and the other variants next to it, and for duck.qois
+    bool is_source_of(const std::filesystem::path& requested, const std::filesystem::path& changed)
+    {
+        if (requested == changed)
+            return true;
+        if (changed.extension() == ".qois")
+            return changed.parent_path() == requested.parent_path() && changed.stem() == requested.stem();
+        return changed.extension() == ".ktx2" && changed.parent_path() == requested.parent_path() && changed.stem().stem() == requested.stem();
+    }
+
+    // duck.png -> duck.qois, decoded in strips across the workers instead when texture-converter wrote one
+    std::filesystem::path strips_for(const std::filesystem::path& filename)
+    {
+        auto strips = filename;
+        strips.replace_extension(".qois");
+        return strips;
+    }
+
+    // what the web build downloads before the decode can start, best first: the fetcher stops at the first one
+    // the server has, and decoding reads that one from disk the same way it would have here
+    std::vector<std::filesystem::path> fetch_candidates(const std::filesystem::path& filename, bool try_compressed)
+    {
+        std::vector<std::filesystem::path> candidates;
+        if (filename.extension() != ".ktx2")
+        {
+            if (try_compressed)
+            {
+                for (const CompressedVariant* variant : supported_variants())
+                {
+                    auto candidate = filename;
+                    candidate.replace_extension(std::string{ "." } + variant->suffix + ".ktx2");
+                    candidates.push_back(std::move(candidate));
+                }
+            }
+            candidates.push_back(strips_for(filename));
+        }
+        candidates.push_back(filename);
+        return candidates;
+    }
+
+    // the encoded file, from the pack when it has it; `storage` holds a compressed entry or a loose file, which the reader
+    // may have read already
+    std::span<const unsigned char> read_source(const std::filesystem::path& filename, const AssetPack* pack, AsyncFileReader* reader, std::vector<unsigned char>& storage)
+    {
+        if (pack != nullptr)
+        {
+            if (const auto bytes = pack->ReadFile(filename, storage); !bytes.empty())
+                return bytes;
+        }
+        if (reader != nullptr && reader->Take(filename, storage))
+            return storage;
+        std::ifstream file{ filename, std::ios::binary | std::ios::ate };
+        if (!file)
+            return {};
+        storage.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(storage.data()), static_cast<std::streamsize>(storage.size())))
+            storage.clear();
+        return storage;
+    }
+
+    // a warm start: the levels a cold one stored, as long as each is the size its place in the chain says;
+    // a preview of its own, when params 2 and 3 give its size, is the last section and not part of the chain
+    bool open_cached(std::uint64_t key, PixelFormat format, decoded_cache::Entry& out_entry, std::vector<std::span<const unsigned char>>& out_levels, int& out_width, int& out_height)
+    {
+        if (!out_entry.Open(key))
+            return false;
+        int               width       = out_entry.Param(0);
+        int               height      = out_entry.Param(1);
+        const bool        has_preview = out_entry.Param(2) > 0 && out_entry.Param(3) > 0;
+        const std::size_t chain       = out_entry.SectionCount() - (has_preview ? 1 : 0);
+        if (width <= 0 || height <= 0 || out_entry.SectionCount() <= (has_preview ? 1u : 0u) ||
+            (has_preview && out_entry.Section(chain).size() != image_bytes(out_entry.Param(2), out_entry.Param(3), format)))
+        {
+            out_entry.Close();
+            return false;
+        }
+        out_width  = width;
+        out_height = height;
+        for (std::size_t i = 0; i < chain; ++i)
+        {
+            if (out_entry.Section(i).size() != image_bytes(width, height, format))
+            {
+                out_levels.clear();
+                out_entry.Close();
+                return false;
+            }
+            out_levels.push_back(out_entry.Section(i));
+            width  = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        return true;
+    }
+
+    // the first level no bigger than PREVIEW_SIZE: one of the worker's mips, or box filtered from the smallest there is into `storage`
+    std::span<const unsigned char> pick_preview(std::span<const std::span<const unsigned char>> levels, int width, int height, PixelFormat format, std::vector<unsigned char>& storage, int& out_width,
+                                                int& out_height)
+    {
+        const unsigned char* pixels = levels.front().data();
+        out_width                   = width;
+        out_height                  = height;
+        for (std::size_t index = 1; out_width > TextureLoader::PREVIEW_SIZE || out_height > TextureLoader::PREVIEW_SIZE; ++index)
+        {
+            if (index < levels.size())
+            {
+                pixels     = levels[index].data();
+                out_width  = std::max(1, out_width / 2);
+                out_height = std::max(1, out_height / 2);
+            }
+            else
+            {
+                std::vector<unsigned char> smaller = downsample_rgba(pixels, out_width, out_height, out_width, out_height, format.channels);
+                storage                            = std::move(smaller);
+                pixels                             = storage.data();
+            }
+        }
+        return { pixels, image_bytes(out_width, out_height, format) };
+    }
+
+    // the file, and everything about the request that makes a different texture of it
+    std::string texture_id(const std::string& file, const TextureOptions& options, const void* destination)
+    {
+        std::ostringstream id;
+        id << file << "?mips=" << options.generate_mipmaps << options.mipmaps_on_worker << "&aniso=" << options.max_anisotropy << "&max=" << options.max_dimension << std::hex << "&wrap=" << options.wrap_s << ','
+           << options.wrap_t << "&mag=" << options.mag_filter << "&compressed=" << options.allow_compressed << "&progressive=" << options.progressive << "&channels=" << options.keep_channels
+           << "&hdr=" << options.high_precision << "&convert=" << options.premultiply_alpha << options.flip_vertically << options.upload_bgra;
+        if (destination != nullptr)
+            id << "&into=" << destination;
+        return id.str();
+    }
+
+    double elapsed_ms(Uint64 start)
+    {
+        return static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    // LoadTextureFromFile and LoadTextureFromMemory, on the GL thread
+    bool load_texture(std::span<const unsigned char> bytes, GLuint& out_texture, int& out_width, int& out_height, const TextureOptions& options)
+    {
+        const decode_scratch::Scope scratch;
+        const FormatRules           rules  = format_rules(options, true);
+        const PixelFormat           format = choose_format(bytes, rules);
+        std::vector<unsigned char>  pixels;
+        int                         image_width  = 0;
+        int                         image_height = 0;
+        if (!decode_pixels(bytes, format, pixels, image_width, image_height))
+            return false;
+
+        if (options.max_dimension > 0 && std::max(image_width, image_height) > options.max_dimension)
+            pixels = shrink_rgba_to_fit(pixels.data(), image_width, image_height, options.max_dimension, image_width, image_height, format.channels);
+        convert_pixels(pixels, image_width, image_height, format, rules);
+        out_texture = upload_pixels(format, pixels.data(), image_width, image_height, options);
+        out_width   = image_width;
+        out_height  = image_height;
+
+        return true;
+    }
+}
+
+void ReleaseTexture(const Texture& texture)
+{
+    if (texture.owned_by_atlas || texture.handle == 0)
+        return;
+    gl_state::DeleteTexture(texture.handle);
+    if (texture.vram_bytes > 0)
+        memory_tracker::Free(MemoryCategory::Textures, texture.vram_bytes);
+}
+
+bool LoadTextureFromFile(const std::filesystem::path& filename, GLuint& out_texture, int& out_width, int& out_height, const TextureOptions& options)
+{
+    // Load from file
+    std::vector<unsigned char> storage;
+    return load_texture(read_source(filename, nullptr, nullptr, storage), out_texture, out_width, out_height, options);
+}
+
+bool LoadTextureFromMemory(std::span<const unsigned char> bytes, GLuint& out_texture, int& out_width, int& out_height, const TextureOptions& options)
+{
+    return load_texture(bytes, out_texture, out_width, out_height, options);
+}
+
+TextureLoader::TextureLoader(LoadScheduler& load_scheduler, AssetRegistry& asset_registry, ReleaseQueue& release_queue, const AssetPack* asset_pack)
+    : scheduler{ load_scheduler }, registry{ asset_registry }, releases{ release_queue }, pack{ asset_pack }, completed{ std::make_shared<CompletionQueue>() }
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+    Shutdown();
+}
+
+TextureHandle TextureLoader::Request(const std::filesystem::path& filename, const TextureOptions& options, TextureAtlas* atlas, LoadPriority priority)
+{
+    return request(filename, options, atlas, nullptr, priority);
+}
+
+TextureHandle TextureLoader::Request(const std::filesystem::path& filename, const TextureOptions& options, TextureArray& array, LoadPriority priority)
+{
+    return request(filename, options, nullptr, &array, priority);
+}
+
+TextureHandle TextureLoader::request(const std::filesystem::path& filename, const TextureOptions& options, TextureAtlas* atlas, TextureArray* array, LoadPriority priority)
+{
+    const std::string file = AssetRegistry::FileId(filename);
+    std::string       id   = texture_id(file, options, atlas != nullptr ? static_cast<const void*>(atlas) : array);
+    if (const AssetHandle found = registry.Find(AssetKind::Texture, id); found.IsValid())
+    {
+        registry.Touch(found);
+        const auto source = std::find_if(sources.begin(), sources.end(), [found](const Source& entry) { return entry.asset == found; });
+        // a more urgent ask moves a queued decode up; one already running uploads at the new priority
+        if (priority < source->priority)
+        {
+            scheduler.Promote(source->ticket, priority);
+            source->priority = priority;
+        }
+        return source->target;
+    }
+
+    auto job          = std::make_shared<Job>();
+    job->target       = std::make_shared<AsyncTexture>();
+    job->target->path = filename;
+    job->options      = options;
+    job->atlas        = atlas;
+    job->array        = array;
+    job->priority     = priority;
+    job->formats      = format_rules(options, atlas == nullptr && array == nullptr);
+    // atlas pages and array layers are RGBA8, and the variant list has to be built here since it queries GL
+    job->try_compressed = options.allow_compressed && options.max_dimension <= 0 && atlas == nullptr && array == nullptr && !job->formats.Ops().Any() && !supported_variants().empty();
+    job->asset          = registry.Add(AssetKind::Texture, std::move(id), file, std::shared_ptr<const std::atomic<TextureState>>{ job->target, &job->target->state });
+    sources.push_back(Source{ job->target, job->asset, options, atlas, array, {}, job->try_compressed, priority, 0 });
+    sources.back().ticket     = submit(job);
+    sources.back().last_drawn = drawn_frames; // idle from now on, not from the first frame
+
+    return job->target;
+}
+
+std::size_t TextureLoader::Reload(const std::filesystem::path& filename)
+{
+    const std::filesystem::path changed = filename.lexically_normal();
+    std::size_t                 queued  = 0;
+    for (Source& source : sources)
+    {
+        const std::shared_ptr<AsyncTexture>& live = source.target;
+        if (!live->IsResident() || !is_source_of(live->path.lexically_normal(), changed))
+            continue;
+        resubmit(source, Swap::Reload);
+        ++queued;
+    }
+    return queued;
+}
+
+void TextureLoader::resubmit(Source& source, Swap swap)
+{
+    auto job            = std::make_shared<Job>();
+    job->target         = std::make_shared<AsyncTexture>();
+    job->target->path   = source.target->path;
+    job->options        = source.options;
+    job->atlas          = source.atlas;
+    job->array          = source.array;
+    job->formats        = format_rules(source.options, source.atlas == nullptr && source.array == nullptr);
+    job->try_compressed = source.try_compressed;
+    job->replaces       = source.target;
+    job->swap           = swap;
+    job->region         = source.region;
+    job->asset          = source.asset;
+    job->priority       = source.priority;
+    if (swap == Swap::Demote)
+    {
+        // nothing waits on it, and the bytes it frees count against the budget from now on
+        job->priority = LoadPriority::Background;
+        job->demoting = source.target->texture.vram_bytes;
+        demoting_bytes += job->demoting;
+    }
+    else if (swap == Swap::Restore)
+    {
+        // a frame is drawing the stand-in
+        job->priority = std::min(source.priority, LoadPriority::Visible);
+    }
+    source.is_swapping = swap != Swap::Reload;
+    submit(job);
+}
+
+LoadScheduler::Ticket TextureLoader::submit(const std::shared_ptr<Job>& job)
+{
+    in_flight.fetch_add(1, std::memory_order_relaxed);
+
+    // a first load the pack doesn't have may still be on the server, and is read ahead; one it has starts paging in
+    // while the job waits its turn. A reload is of a file already on disk, and a demotion or restore of one loaded before
+    const bool                         is_reload = job->replaces != nullptr && job->swap == Swap::Reload;
+    std::vector<std::filesystem::path> candidates;
+    if (job->replaces == nullptr && (pack == nullptr || !pack->Prefetch(job->target->path)))
+        candidates = fetch_candidates(job->target->path, job->try_compressed);
+    else if (job->replaces != nullptr && !is_reload && pack != nullptr)
+        pack->Prefetch(job->target->path);
+
+    // the job only holds the completion queue, never `this`, so it is safe to finish after the loader is gone;
+    // a reload is of the file that changed on disk, which the pack only has a stale copy of
+    return scheduler.Submit(
+        job->priority,
+        [job, queue = completed, pack = is_reload ? nullptr : pack, reader = scheduler.Reader(), workers = &scheduler.Workers()]()
+        {
+            const startup_trace::Scope trace{ "Decode texture", job->target->path.filename().string() };
+            job->target->state.store(TextureState::Decoding, std::memory_order_release);
+            if (job->try_compressed && load_compressed_variant(job->target->path, pack, reader, supported_variants(), job->image.compressed))
+            {
+                job->image.width  = job->image.compressed.width;
+                job->image.height = job->image.compressed.height;
+                if (job->swap == Swap::Demote)
+                    keep_small_levels(job->image.compressed);
+                std::lock_guard lock{ queue->mutex };
+                queue->finished.push_back(job);
+                return;
+            }
+
+            // the encoded bytes name the cached decode, so an edited file misses; strips always decode to RGBA8, swizzled after
+            const Uint64                         begin = SDL_GetPerformanceCounter();
+            std::vector<unsigned char>           file_bytes;
+            const std::span<const unsigned char> strips      = read_source(strips_for(job->target->path), pack, reader, file_bytes);
+            const std::span<const unsigned char> source      = strips.empty() ? read_source(job->target->path, pack, reader, file_bytes) : strips;
+            const PixelFormat                    format      = strips.empty() ? choose_format(source, job->formats) : PixelFormat{ .is_bgra = job->formats.bgra };
+            const bool                           worker_mips = job->atlas == nullptr && job->array == nullptr && job->options.generate_mipmaps && job->options.mipmaps_on_worker && !format.is_half;
+            const std::string                    variant     = std::string{ format.Name() } + conversion_name(job->formats) + (worker_mips ? "+mips" : "") +
+                                          (job->options.max_dimension > 0 ? "<=" + std::to_string(job->options.max_dimension) : "");
+            const std::uint64_t                  key         = !source.empty() && decoded_cache::IsEnabled() ? decoded_cache::Key(source, variant) : 0;
+            DecodedImage&                        image       = job->image;
+            image.format                                     = format;
+            // only a texture of its own can be swapped for the full one later; a reload replaces a texture that is already whole,
+            // and a demotion wants nothing else
+            const auto wants_preview = [&job, format](int width, int height)
+            {
+                if (job->swap == Swap::Demote)
+                    return !format.is_half;
+                return job->options.progressive && job->atlas == nullptr && job->array == nullptr && job->replaces == nullptr && !format.is_half &&
+                       image_bytes(width, height, format) >= TextureLoader::PROGRESSIVE_BYTES;
+            };
+            if (key != 0 && open_cached(key, format, image.cached, image.levels, image.width, image.height))
+            {
+                if (wants_preview(image.width, image.height) && image.cached.Param(2) > 0)
+                {
+                    image.preview        = image.cached.Section(image.cached.SectionCount() - 1);
+                    image.preview_width  = image.cached.Param(2);
+                    image.preview_height = image.cached.Param(3);
+                }
+                else if (wants_preview(image.width, image.height))
+                {
+                    image.preview = pick_preview(image.levels, image.width, image.height, format, image.preview_pixels, image.preview_width, image.preview_height);
+                }
+                decoded_cache::CountWarm(elapsed_ms(begin), image.cached.ColdMs());
+                std::lock_guard lock{ queue->mutex };
+                queue->finished.push_back(job);
+                return;
+            }
+
+            int width  = 0;
+            int height = 0;
+            if (!strips.empty())
+            {
+                // a strip at a time across the pool, this worker taking its share while it waits on the rest
+                const auto run_strips = [workers](std::size_t count, const std::function<void(std::size_t, std::size_t)>& body) { workers->ParallelFor(count, 1, body); };
+                qoi_strips::Decode(strips, image.pixels, width, height, run_strips);
+            }
+            else
+            {
+                // stb's intermediate buffers stay in this worker's arena; only the final image is copied out
+                const decode_scratch::Scope scratch;
+                decode_pixels(source, format, image.pixels, width, height);
+                job->target->scratch_bytes = scratch.PeakBytes();
+            }
+            if (!image.pixels.empty() && job->options.max_dimension > 0 && std::max(width, height) > job->options.max_dimension)
+                image.pixels = shrink_rgba_to_fit(image.pixels.data(), width, height, job->options.max_dimension, width, height, format.channels);
+            convert_pixels(image.pixels, width, height, format, job->formats);
+            image.width  = width;
+            image.height = height;
+            if (!image.pixels.empty())
+            {
+                if (worker_mips)
+                    image.mip_levels = build_mip_chain(image.pixels.data(), width, height, format.channels);
+                image.levels.push_back(image.pixels);
+                for (const auto& level : image.mip_levels)
+                    image.levels.push_back(level);
+                if (wants_preview(width, height))
+                    image.preview = pick_preview(image.levels, width, height, format, image.preview_pixels, image.preview_width, image.preview_height);
+                const double cold_ms = elapsed_ms(begin);
+                decoded_cache::CountCold(cold_ms);
+                if (key != 0 && image.preview_pixels.empty())
+                {
+                    decoded_cache::Store(key, { width, height, 0, 0 }, image.levels, cold_ms);
+                }
+                else if (key != 0)
+                {
+                    // the preview built here goes along, so a warm start doesn't filter it again
+                    std::vector<std::span<const unsigned char>> sections = image.levels;
+                    sections.push_back(image.preview_pixels);
+                    decoded_cache::Store(key, { width, height, image.preview_width, image.preview_height }, sections, cold_ms);
+                }
+            }
+            std::lock_guard lock{ queue->mutex };
+            queue->finished.push_back(job);
+        },
+        std::move(candidates));
+}
+
+void TextureLoader::Update(UploadBudget& budget)
+{
+    cancelUnwanted();
+    {
+        std::lock_guard lock{ completed->mutex };
+        for (auto& job : completed->finished)
+        {
+            // a reload's target is only a carrier; the texture it replaces stays resident throughout
+            if (job->replaces == nullptr)
+                job->target->state.store(TextureState::Uploading, std::memory_order_release);
+            // promoted since it was queued, or not; uploads go most urgent first and in request order within a priority
+            if (const auto source = std::find_if(sources.begin(), sources.end(), [&job](const Source& entry) { return entry.asset == job->asset; }); source != sources.end())
+                job->priority = std::min(job->priority, source->priority);
+            const auto after = std::upper_bound(pending_uploads.begin(), pending_uploads.end(), job->priority,
+                                                [](LoadPriority priority, const std::shared_ptr<Job>& queued) { return priority < queued->priority; });
+            pending_uploads.insert(after, std::move(job));
+        }
+        completed->finished.clear();
+    }
+
+    if (!upload_ring_ready)
+    {
+        upload_ring.Setup();
+        upload_ring_ready = true;
+    }
+
+    const UploadBudget::Timer timer{ budget };
+    for (int uploads = 0; !pending_uploads.empty() && (uploads == 0 || budget.HasRoom()); ++uploads)
+    {
+        const auto job = std::move(pending_uploads.front());
+        pending_uploads.pop_front();
+        in_flight.fetch_sub(1, std::memory_order_relaxed);
+
+        AsyncTexture& target = *job->target;
+        if (job->replaces != nullptr && job->swap == Swap::Demote)
+        {
+            swapStandIn(*job);
+            budget.Spend(job->image.preview.size() + job->image.compressed.data.size());
+        }
+        else if (job->replaces != nullptr)
+        {
+            swapReloaded(*job);
+            budget.Spend(job->image.Bytes());
+            // a stand-in that didn't go stays one, and a restore that failed isn't tried on every draw after it
+            if (const auto source = std::find_if(sources.begin(), sources.end(), [&job](const Source& entry) { return entry.asset == job->asset; }); source != sources.end())
+            {
+                const bool whole   = !job->replaces->texture.is_preview;
+                source->is_demoted = source->is_demoted && !whole;
+                if (job->swap == Swap::Restore)
+                {
+                    source->is_swapping = false;
+                    source->is_pinned   = !whole;
+                    stats.restores += whole ? 1 : 0;
+                }
+            }
+        }
+        else if (job->image.levels.empty() && job->image.compressed.levels.empty())
+        {
+            target.state.store(TextureState::Failed, std::memory_order_release);
+        }
+        else if (upload_thread != nullptr && job->atlas == nullptr && job->array == nullptr)
+        {
+            uploadOnThread(job);
+        }
+        else if (job->atlas == nullptr && job->array == nullptr && !job->image.levels.empty() &&
+                 (!job->image.preview.empty() || image_bytes(job->image.width, job->image.height, job->image.format) > REFINE_BAND_BYTES))
+        {
+            // behind the others at its priority until it is whole, so one big image doesn't hold up the small ones
+            if (!uploadBands(*job, budget))
+            {
+                in_flight.fetch_add(1, std::memory_order_relaxed);
+                const auto after = std::upper_bound(pending_uploads.begin(), pending_uploads.end(), job->priority,
+                                                    [](LoadPriority priority, const std::shared_ptr<Job>& queued) { return priority < queued->priority; });
+                pending_uploads.insert(after, job);
+            }
+        }
+        else
+        {
+            AtlasRegion region;
+            ArrayLayer  layer;
+            if (job->atlas != nullptr)
+                region = job->atlas->Add(job->image.levels.front().data(), job->image.width, job->image.height);
+            if (job->array != nullptr)
+                layer = job->array->Add(job->image.levels.front().data(), job->image.width, job->image.height);
+            if (region.texture != 0)
+            {
+                target.texture.handle         = region.texture;
+                target.texture.uv_rect        = region.uv_rect;
+                target.texture.owned_by_atlas = true;
+            }
+            else if (layer.texture != 0)
+            {
+                target.texture.handle         = layer.texture;
+                target.texture.layer          = layer.layer;
+                target.texture.owned_by_atlas = true;
+            }
+            else
+            {
+                uploadOwnTexture(*job, target.texture, &upload_ring);
+            }
+            target.texture.width  = job->image.width;
+            target.texture.height = job->image.height;
+            target.texture.loaded = true;
+            // a reload goes where this one landed, not where it was asked to
+            if (const auto source = std::find_if(sources.begin(), sources.end(), [&job](const Source& entry) { return entry.asset == job->asset; }); source != sources.end())
+            {
+                source->atlas  = region.texture != 0 ? job->atlas : nullptr;
+                source->array  = layer.texture != 0 ? job->array : nullptr;
+                source->region = region;
+            }
+            registry.SetBytes(job->asset, target.texture.vram_bytes);
+            target.state.store(TextureState::Resident, std::memory_order_release);
+            budget.Spend(job->image.Bytes());
+        }
+    }
+    for (const auto& job : pending_uploads)
+        budget.Defer(job->image.Bytes() - job->uploaded_bytes);
+    queryDriverMemory();
+    unloadToBudget();
+    demoteToBudget();
+
+    static const perf_counters::Handle resident = perf_counters::Register("textures resident", perf_counters::Kind::Gauge, perf_counters::InHud | perf_counters::InTelemetry);
+    perf_counters::Set(resident, std::count_if(sources.begin(), sources.end(), [](const Source& source) { return source.target->IsResident(); }));
+}
+
+void TextureLoader::cancelUnwanted()
+{
+    // the Source and the queued job hold the only references left, so nothing will ever draw it
+    const auto unwanted = [this](const Source& source)
+    {
+        if (source.ticket == 0 || source.target.use_count() > 2 || source.target->state.load(std::memory_order_acquire) != TextureState::Queued || !scheduler.Cancel(source.ticket))
+            return false;
+        in_flight.fetch_sub(1, std::memory_order_relaxed);
+        registry.Remove(source.asset);
+        return true;
+    };
+    sources.erase(std::remove_if(sources.begin(), sources.end(), unwanted), sources.end());
+}
+
+void TextureLoader::uploadOwnTexture(const Job& job, Texture& out_texture, PixelUploadRing* ring)
+{
+    if (job.image.levels.empty())
+    {
+        const GLenum format         = gl_format_for(job.image.compressed.vk_format);
+        out_texture.handle          = upload_compressed(job.image.compressed, format, job.options, ring);
+        out_texture.internal_format = format;
+        out_texture.vram_bytes      = memory_tracker::EstimateTextureBytes(format, job.image.width, job.image.height, static_cast<int>(job.image.compressed.levels.size()));
+    }
+    else
+    {
+        const PixelFormat format    = job.image.format;
+        const int         levels    = job.options.generate_mipmaps ? mip_level_count(job.image.width, job.image.height) : 1;
+        out_texture.handle          = upload_pixels(format, job.image.levels.front().data(), job.image.width, job.image.height, job.options, std::span{ job.image.levels }.subspan(1), ring);
+        out_texture.internal_format = format.InternalFormat();
+        out_texture.vram_bytes      = memory_tracker::EstimateTextureBytes(format.InternalFormat(), job.image.width, job.image.height, levels);
+    }
+    memory_tracker::Allocate(MemoryCategory::Textures, out_texture.vram_bytes);
+}
+
+void TextureLoader::uploadOnThread(const std::shared_ptr<Job>& job)
+{
+    // PendingCount goes on counting it until it lands
+    in_flight.fetch_add(1, std::memory_order_relaxed);
+    // the ring is mapped for this thread's context, so the loader's context uploads straight from the decoded image
+    upload_thread->Submit([job] { uploadOwnTexture(*job, job->refined, nullptr); },
+                          [this, job]
+                          {
+                              in_flight.fetch_sub(1, std::memory_order_relaxed);
+                              AsyncTexture& target  = *job->target;
+                              target.texture        = job->refined;
+                              target.texture.width  = job->image.width;
+                              target.texture.height = job->image.height;
+                              target.texture.loaded = true;
+                              job->refined          = Texture{};
+                              if (const auto source = std::find_if(sources.begin(), sources.end(), [&job](const Source& entry) { return entry.asset == job->asset; });
+                                  source != sources.end())
+                              {
+                                  source->atlas  = nullptr;
+                                  source->array  = nullptr;
+                                  source->region = AtlasRegion{};
+                              }
+                              registry.SetBytes(job->asset, target.texture.vram_bytes);
+                              target.state.store(TextureState::Resident, std::memory_order_release);
+                          },
+                          job->image.Bytes());
+}
+
+bool TextureLoader::uploadBands(Job& job, UploadBudget& budget)
+{
+    AsyncTexture&       target = *job.target;
+    const DecodedImage& image  = job.image;
+    const PixelFormat   format = image.format;
+    const int           levels = job.options.generate_mipmaps ? mip_level_count(image.width, image.height) : 1;
+    if (job.refined.handle == 0 && !image.preview.empty())
+    {
+        // small enough for any budget, and drawable from the next recorded frame
+        Texture    preview;
+        const auto preview_levels = job.options.generate_mipmaps ? mip_level_count(image.preview_width, image.preview_height) : 1;
+        preview.handle            = upload_pixels(format, image.preview.data(), image.preview_width, image.preview_height, job.options, {}, &upload_ring);
+        preview.internal_format   = format.InternalFormat();
+        preview.vram_bytes        = memory_tracker::EstimateTextureBytes(format.InternalFormat(), image.preview_width, image.preview_height, preview_levels);
+        preview.width             = image.width;
+        preview.height            = image.height;
+        preview.loaded            = true;
+        preview.is_preview        = true;
+        memory_tracker::Allocate(MemoryCategory::Textures, preview.vram_bytes);
+        target.texture = preview;
+        registry.SetBytes(job.asset, preview.vram_bytes);
+        target.state.store(TextureState::Resident, std::memory_order_release);
+        budget.Spend(image.preview.size());
+    }
+    if (job.refined.handle == 0)
+    {
+        job.refined.handle          = allocate_pixels(format, image.width, image.height, levels, job.options);
+        job.refined.internal_format = format.InternalFormat();
+        job.refined.vram_bytes      = memory_tracker::EstimateTextureBytes(format.InternalFormat(), image.width, image.height, levels);
+        job.refined.width           = image.width;
+        job.refined.height          = image.height;
+        job.refined.loaded          = true;
+        memory_tracker::Allocate(MemoryCategory::Textures, job.refined.vram_bytes);
+        return false;
+    }
+
+    // at least one band, so a tight budget still gets there
+    const auto level_count = static_cast<int>(image.levels.size());
+    do
+    {
+        const int            level_width  = std::max(1, image.width >> job.refine_level);
+        const int            level_height = std::max(1, image.height >> job.refine_level);
+        const int            rows         = std::min(level_height - job.refine_row, std::max(1, static_cast<int>(REFINE_BAND_BYTES / image_bytes(level_width, 1, format))));
+        const unsigned char* pixels       = image.levels[static_cast<std::size_t>(job.refine_level)].data() + image_bytes(level_width, job.refine_row, format);
+        upload_rows(job.refined.handle, job.refine_level, job.refine_row, level_width, rows, pixels, format, &upload_ring);
+        budget.Spend(image_bytes(level_width, rows, format));
+        job.uploaded_bytes += image_bytes(level_width, rows, format);
+        job.refine_row += rows;
+        if (job.refine_row == level_height)
+        {
+            ++job.refine_level;
+            job.refine_row = 0;
+        }
+    } while (job.refine_level < level_count && budget.HasRoom());
+    if (job.refine_level < level_count)
+        return false;
+    if (levels > level_count)
+        gl_backend::Get().generate_mipmap(job.refined.handle);
+
+    if (image.preview.empty())
+    {
+        target.texture = job.refined;
+        registry.SetBytes(job.asset, job.refined.vram_bytes);
+        target.state.store(TextureState::Resident, std::memory_order_release);
+        job.refined = Texture{};
+        return true;
+    }
+    // a reload may have put a whole texture in place of the preview already; this one was never drawn
+    if (!target.texture.is_preview)
+    {
+        ReleaseTexture(job.refined);
+        return true;
+    }
+    retire(target.texture);
+    target.texture.handle     = job.refined.handle;
+    target.texture.vram_bytes = job.refined.vram_bytes;
+    target.texture.is_preview = false;
+    registry.SetBytes(job.asset, job.refined.vram_bytes);
+    job.refined = Texture{};
+    return true;
+}
+
+void TextureLoader::swapReloaded(const Job& job)
+{
+    AsyncTexture& live = *job.replaces;
+    if (job.image.levels.empty() && job.image.compressed.levels.empty())
+    {
+        // likely caught half written; the next save reloads it again
+        LOG_WARN("Failed to reload ", live.path, ", keeping the old texture");
+        return;
+    }
+    if (live.texture.owned_by_atlas)
+    {
+        const unsigned char* pixels   = job.image.levels.front().data();
+        const bool           replaced = job.atlas != nullptr ? job.atlas->Replace(job.region, pixels, job.image.width, job.image.height)
+                                                             : job.array != nullptr && job.array->Replace(live.texture.layer, pixels, job.image.width, job.image.height);
+        if (!replaced)
+            LOG_WARN("Can't reload ", live.path, " at ", job.image.width, " x ", job.image.height, " in place of ", live.texture.width, " x ", live.texture.height, ", keeping the old texture");
+        return;
+    }
+
+    // frames already recorded still name the old texture, so it goes a few updates later
+    Texture fresh;
+    uploadOwnTexture(job, fresh, &upload_ring);
+    fresh.width  = job.image.width;
+    fresh.height = job.image.height;
+    fresh.loaded = true;
+    retire(live.texture);
+    live.texture       = fresh;
+    live.scratch_bytes = job.target->scratch_bytes;
+    registry.SetBytes(job.asset, fresh.vram_bytes);
+}
+
+void TextureLoader::swapStandIn(const Job& job)
+{
+    AsyncTexture& live   = *job.replaces;
+    const auto    source = std::find_if(sources.begin(), sources.end(), [&job](const Source& entry) { return entry.asset == job.asset; });
+    demoting_bytes -= job.demoting;
+    if (source == sources.end())
+        return;
+    source->is_swapping = false;
+
+    // sized before it is made, so a stand-in that wouldn't save anything never goes up
+    const DecodedImage& image    = job.image;
+    const bool          has_mips = job.options.generate_mipmaps;
+    Texture             stand_in;
+    if (!image.preview.empty())
+    {
+        stand_in.internal_format = image.format.InternalFormat();
+        stand_in.vram_bytes      = memory_tracker::EstimateTextureBytes(stand_in.internal_format, image.preview_width, image.preview_height, has_mips ? mip_level_count(image.preview_width, image.preview_height) : 1);
+    }
+    else if (!image.compressed.levels.empty())
+    {
+        stand_in.internal_format = gl_format_for(image.compressed.vk_format);
+        stand_in.vram_bytes      = memory_tracker::EstimateTextureBytes(stand_in.internal_format, image.compressed.width, image.compressed.height, static_cast<int>(image.compressed.levels.size()));
+    }
+    if (stand_in.vram_bytes == 0 || stand_in.vram_bytes >= live.texture.vram_bytes || live.texture.is_preview || live.texture.owned_by_atlas)
+    {
+        source->is_pinned = true;
+        return;
+    }
+
+    stand_in.handle     = !image.preview.empty() ? upload_pixels(image.format, image.preview.data(), image.preview_width, image.preview_height, job.options, {}, &upload_ring)
+                                                 : upload_compressed(image.compressed, stand_in.internal_format, job.options, &upload_ring);
+    stand_in.width      = live.texture.width;
+    stand_in.height     = live.texture.height;
+    stand_in.loaded     = true;
+    stand_in.is_preview = true;
+    memory_tracker::Allocate(MemoryCategory::Textures, stand_in.vram_bytes);
+    // frames already recorded still name the whole texture, like a reload's
+    retire(live.texture);
+    live.texture       = stand_in;
+    source->is_demoted = true;
+    registry.SetBytes(job.asset, stand_in.vram_bytes);
+    ++stats.demotions;
+}
+
+void TextureLoader::retire(const Texture& texture)
+{
+    if (!texture.owned_by_atlas)
+        releases.RetireTexture(texture.handle, texture.vram_bytes);
+}
+
+void TextureLoader::unloadToBudget()
+{
+    const std::size_t limit = effectiveBudget();
+    if (registry.Bytes(AssetKind::Texture) <= limit)
+        return;
+    // the loader's own Source is the one reference left on a texture nobody uses
+    for (const AssetHandle handle : registry.Unreferenced(AssetKind::Texture, 1))
+    {
+        if (registry.Bytes(AssetKind::Texture) <= limit)
+            break;
+        // atlas regions and failed loads hold no memory of their own
+        if (registry.Get(handle)->bytes == 0)
+            continue;
+        const auto source = std::find_if(sources.begin(), sources.end(), [handle](const Source& entry) { return entry.asset == handle; });
+        // frames in flight may still sample it, like a texture a reload replaced
+        retire(source->target->texture);
+        registry.Evict(handle);
+        sources.erase(source);
+    }
+}
+
+void TextureLoader::demoteToBudget()
+{
+    const std::size_t limit = effectiveBudget();
+    const auto        over  = [this, limit]() { return registry.Bytes(AssetKind::Texture) > limit + demoting_bytes; };
+    if (!over())
+        return;
+    // whole textures of their own with a smaller level to stand in; half floats have none
+    std::vector<Source*> idle;
+    for (Source& source : sources)
+    {
+        const Texture& texture = source.target->texture;
+        if (source.is_demoted || source.is_swapping || source.is_pinned || !source.target->IsResident() || texture.owned_by_atlas || texture.is_preview ||
+            is_half_float(texture.internal_format) || std::max(texture.width, texture.height) <= PREVIEW_SIZE || drawn_frames - source.last_drawn < IDLE_FRAMES)
+            continue;
+        idle.push_back(&source);
+    }
+    std::sort(idle.begin(), idle.end(), [](const Source* a, const Source* b) { return a->last_drawn < b->last_drawn; });
+    for (Source* source : idle)
+    {
+        if (!over())
+            break;
+        resubmit(*source, Swap::Demote);
+    }
+}
+
+void TextureLoader::queryDriverMemory()
+{
+    if (--driver_query > 0)
+        return;
+    driver_query = DRIVER_QUERY_FRAMES;
+#if !defined(IS_WEBGL2)
+    // both in KB; what the registry holds is already out of what is available
+    GLint total     = -1;
+    GLint available = -1;
+    if (has_gl_extension("GL_NVX_gpu_memory_info"))
+    {
+        glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+    }
+    else if (has_gl_extension("GL_ATI_meminfo"))
+    {
+        GLint free_memory[4] = { -1, -1, -1, -1 }; // the pool's free, the largest free block, and the same for shared memory
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, free_memory);
+        available = free_memory[0];
+    }
+    stats.driver_total_kb     = total;
+    stats.driver_available_kb = available;
+    if (available < 0)
+        return;
+    const std::size_t reachable = registry.Bytes(AssetKind::Texture) + static_cast<std::size_t>(available) * 1024;
+    driver_limit                = reachable > DRIVER_RESERVE_BYTES ? reachable - DRIVER_RESERVE_BYTES : 0;
+#endif
+}
+
+std::size_t TextureLoader::effectiveBudget() const noexcept
+{
+    return std::min(budget, driver_limit);
+}
+
+void TextureLoader::MarkDrawn(GLuint texture)
+{
+    if (texture != 0)
+        drawn.insert(texture);
+}
+
+void TextureLoader::FrameDrawn()
+{
+    ++drawn_frames;
+    if (drawn.empty())
+        return;
+    for (Source& source : sources)
+    {
+        if (!drawn.contains(source.target->texture.handle))
+            continue;
+        source.last_drawn = drawn_frames;
+        if (source.is_demoted && !source.is_swapping && !source.is_pinned)
+            resubmit(source, Swap::Restore);
+    }
+    drawn.clear();
+}
+
+TextureLoader::Stats TextureLoader::GetStats() const noexcept
+{
+    Stats out  = stats;
+    out.bytes  = registry.Bytes(AssetKind::Texture);
+    out.budget = effectiveBudget();
+    for (const Source& source : sources)
+    {
+        out.demoted += source.is_demoted ? 1 : 0;
+        out.demoting += source.is_swapping && !source.is_demoted ? 1 : 0;
+        out.restoring += source.is_swapping && source.is_demoted ? 1 : 0;
+    }
+    return out;
+}
+
+void TextureLoader::Shutdown()
+{
+    // anything not uploaded yet is dropped, full textures still filling in behind a preview with it; workers still decoding will push into a queue nobody drains
+    for (const Source& source : sources)
+        scheduler.Cancel(source.ticket);
+    {
+        std::lock_guard lock{ completed->mutex };
+        completed->finished.clear();
+    }
+    for (const auto& job : pending_uploads)
+        ReleaseTexture(job->refined);
+    pending_uploads.clear();
+    for (const Source& source : sources)
+    {
+        if (source.target->IsResident())
+            ReleaseTexture(source.target->texture);
+        registry.Remove(source.asset);
+    }
+    sources.clear();
+    drawn.clear();
+    demoting_bytes = 0;
+    driver_limit   = SIZE_MAX;
+    driver_query   = 0;
+    completed      = std::make_shared<CompletionQueue>();
+    in_flight.store(0, std::memory_order_relaxed);
+    upload_ring.Shutdown();
+}
+
+void TextureLoader::SetBudget(std::size_t budget_bytes)
+{
+    budget = budget_bytes;
+    unloadToBudget();
+}
+
+std::size_t TextureLoader::Budget() const noexcept
+{
+    return budget;
+}
+
+void TextureLoader::SetUploadThread(UploadThread* thread) noexcept
+{
+    upload_thread = thread;
+}
+
+std::size_t TextureLoader::PendingCount() const noexcept
+{
+    return in_flight.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,290 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "asset_registry.h"
+#include "load_scheduler.h"
+#include "pixel_upload_ring.h"
+#include "texture_atlas.h"
+
+#include <GL/glew.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+class AssetPack;
+class ReleaseQueue;
+class TextureArray;
+class UploadBudget;
+class UploadThread;
+
+struct Texture
+{
+    GLuint      handle = 0;
+    int         width  = 0;
+    int         height = 0;
+    bool        loaded = false;
+    glm::vec4   uv_rect{ 0.0f, 0.0f, 1.0f, 1.0f };
+    bool        owned_by_atlas  = false; // the atlas or texture array deletes `handle`, callers must not
+    int         layer           = -1;    // in a TextureArray, when `handle` is its GL_TEXTURE_2D_ARRAY
+    GLenum      internal_format = GL_RGBA8;
+    std::size_t vram_bytes      = 0;     // estimate counted under MemoryCategory::Textures until ReleaseTexture
+    bool        is_preview      = false; // a small level standing in while the full image uploads; width and height are still the image's
+};
+
+struct TextureOptions
+{
+    bool   generate_mipmaps  = false;
+    bool   mipmaps_on_worker = false; // box filter the chain while decoding instead of glGenerateMipmap on the GL thread
+    float  max_anisotropy    = 1.0f;  // clamped to the driver limit, ignored without EXT_texture_filter_anisotropic
+    GLenum wrap_s            = GL_CLAMP_TO_EDGE;
+    GLenum wrap_t            = GL_CLAMP_TO_EDGE;
+    GLenum mag_filter        = GL_LINEAR;
+    bool   allow_compressed  = true;  // use a supported <name>.<format>.ktx2 next to the image when there is one
+    bool   progressive       = true;  // a big image of its own shows a small level first and fills in over later Updates
+    int    max_dimension     = 0;     // 0 for any; a longer side over it is filtered down on the decoding thread, for thumbnails
+    bool   keep_channels     = true;  // gray, gray+alpha and RGB images get R8, RG8 or RGB8 storage, swizzled to sample like RGBA
+    bool   high_precision    = false; // 16 bit and HDR images become half floats instead of being cut to 8 bits; not with a max_dimension
+    bool   premultiply_alpha = false; // color times alpha on the decoding thread, for a GL_ONE, GL_ONE_MINUS_SRC_ALPHA blend; makes it RGBA8
+    bool   flip_vertically   = false; // the last row first, for GL's bottom-left origin
+    bool   upload_bgra       = false; // a texture of its own goes up as GL_BGRA, swizzled on the decoding thread; makes it RGBA8, not on WebGL2
+};
+
+// Queued, Decoding on a worker, Uploading once the worker is done, then Resident or Failed
+using TextureState = AssetState;
+
+/**
+ * A texture that is being loaded in the background.
+ *
+ * `texture` is only written on the GL thread and is valid once `state` is Resident.
+ * The loader owns the GL texture, unless it was packed into an atlas, and deletes it at Shutdown
+ * or once no handle to it is left and the loader is over its budget.
+ */
+struct AsyncTexture
+{
+    std::filesystem::path     path;
+    Texture                   texture;
+    std::size_t               scratch_bytes = 0; // peak decoder working memory on the worker, 0 for compressed variants
+    std::atomic<TextureState> state{ TextureState::Queued };
+
+    bool IsResident() const noexcept
+    {
+        return state.load(std::memory_order_acquire) == TextureState::Resident;
+    }
+
+    bool HasFailed() const noexcept
+    {
+        return state.load(std::memory_order_acquire) == TextureState::Failed;
+    }
+};
+
+using TextureHandle = std::shared_ptr<const AsyncTexture>;
+
+// Deletes a texture TextureLoader made and takes it off the memory tracker; atlas regions are left to their atlas
+void ReleaseTexture(const Texture& texture);
+
+// https://github.com/ocornut/imgui/wiki/Image-Loading-and-Displaying-Examples
+bool LoadTextureFromFile(const std::filesystem::path& filename, GLuint& out_texture, int& out_width, int& out_height, const TextureOptions& options = {});
+// Same, decoding an encoded image (PNG, JPG, ...) already in memory; `bytes` only needs to live for the call
+bool LoadTextureFromMemory(std::span<const unsigned char> bytes, GLuint& out_texture, int& out_width, int& out_height, const TextureOptions& options = {});
+
+/**
+ * Decodes images on worker threads and uploads them on the GL thread.
+ *
+ * Request returns immediately; Update must be called once per frame on the GL thread and performs
+ * as many pending uploads as fit in the frame's UploadBudget (always at least one so loading makes progress).
+ * A texture of its own bigger than REFINE_BAND_BYTES goes up a band of rows at a time, behind the uploads
+ * waiting at its priority, and is Resident once the last band is in.
+ * A texture of its own keeps the source's channels unless keep_channels is off: a gray PNG is a quarter of the
+ * RGBA8 bytes to decode, upload and keep, and swizzling makes it sample as (l, l, l, 1) or (l, l, l, a) all the same.
+ * Without swizzles (WebGL2) only RGB is kept. Atlas pages, array layers and .qois strips stay RGBA8. With
+ * high_precision a 16 bit or HDR source keeps its range as half floats; their mips are always made on the GPU,
+ * they have no preview, and WebGL2 only takes them as RGBA16F where EXT_color_buffer_float lets it make the mips.
+ * premultiply_alpha, flip_vertically and upload_bgra run on the decoded pixels in one pass of pixel_kernels, after
+ * any max_dimension shrink and before the mips, preview and decoded cache, which keeps them apart by the options;
+ * a compressed variant can't be changed after the fact, so none is used with them.
+ * Decodes go through a LoadScheduler at the request's priority and uploads go in the same order, so a texture
+ * asked for as Immediate overtakes whatever was queued before it. Asking again at a more urgent priority
+ * promotes a load that hasn't started, and one whose every handle went before it started is cancelled.
+ * Textures get immutable storage where supported and are staged through a PixelUploadRing when one can be mapped.
+ * Pre-compressed KTX2 variants made by texture-converter are preferred over decoding the PNG; they carry their own
+ * mip chain, so generate_mipmaps does not apply to them; nor are they used with a max_dimension, whose image is
+ * shrunk after decoding, before any mips or preview are made of it and before it goes in the decoded cache. A <name>.qois from texture-converter --qoi is decoded
+ * instead of the PNG, its strips split across the WorkerPool with ParallelFor from the decode's own worker.
+ * With an AssetFetcher on the scheduler (the web build), a first load that isn't in the pack downloads the best of
+ * those that the server has, KTX2 variant then .qois then the image, before its decode is let on a worker.
+ * A progressive 8 bit image of PROGRESSIVE_BYTES or more is Resident as soon as a preview of at most PREVIEW_SIZE
+ * has uploaded, taken from the worker's mips or the decoded cache when they have it. The full image then goes up
+ * in bands the same way and replaces the preview when the last level is in; the preview goes to the ReleaseQueue.
+ * With an atlas the image is packed into one of its pages, falling back to its own texture if it does not fit.
+ * The atlas must outlive the request, and the page's own sampling applies instead of `options`.
+ * A TextureArray works the same way with a layer instead of a region, falling back when the size doesn't match.
+ * With an open AssetPack, files under the asset root are read from the pack and the rest from disk;
+ * the pack must outlive the worker pool since decodes may still be running when the loader goes away.
+ *
+ * Every request is an entry in the AssetRegistry, keyed by the file, the options and where it goes, so
+ * asking for the same thing again returns the handle the first request made. Textures stay cached after
+ * the last handle to them goes; once the textures in the registry go over the budget, the ones nobody
+ * holds are deleted least recently requested first. Atlas regions only go with their atlas.
+ *
+ * If that isn't enough, textures of their own that no frame drew for IDLE_FRAMES are demoted least recently drawn
+ * first: a worker loads the image again, from the decoded cache when it is warm, and a stand-in of at most
+ * PREVIEW_SIZE (the small levels of a compressed variant) replaces the texture the way a reload does, is_preview
+ * set and the handles unchanged. Drawing a stand-in restores the whole texture the same way. What is drawn is told
+ * by MarkDrawn and FrameDrawn. The budget is the lower of SetBudget's and, where GL_NVX_gpu_memory_info or
+ * GL_ATI_meminfo says how much video memory is left, what keeps DRIVER_RESERVE_BYTES of it free.
+ *
+ * Reload decodes a changed file again on a worker and swaps it in at a later Update, so the handles
+ * already out there show the new image from the next recorded frame: a texture of its own gets a new
+ * GL texture and the old one goes to the ReleaseQueue, deleted once no frame in flight can sample it;
+ * atlas regions and array layers can't move, so they are overwritten in place while the size is unchanged.
+ *
+ * With an UploadThread, a first load that gets a texture of its own goes up whole on the thread's context instead,
+ * mips and all, with no preview and nothing spent from the frame's budget, and is Resident at the UploadThread::Update
+ * that sees its fence. Atlas pages, array layers, reloads and stand-ins stay with Update.
+ */
+class TextureLoader
+{
+public:
+    static constexpr std::size_t DEFAULT_BUDGET       = 256 * 1024 * 1024;
+    static constexpr std::size_t PROGRESSIVE_BYTES    = 4 * 1024 * 1024;   // 1024 x 1024 RGBA8
+    static constexpr int         PREVIEW_SIZE         = 128;               // the preview's longer side at most
+    static constexpr std::size_t REFINE_BAND_BYTES    = 1024 * 1024;       // uploaded between budget checks
+    static constexpr int         IDLE_FRAMES          = 120;               // drawn frames a texture goes undrawn before it may be demoted
+    static constexpr std::size_t DRIVER_RESERVE_BYTES = 128 * 1024 * 1024; // video memory left to everything else
+    static constexpr int         DRIVER_QUERY_FRAMES  = 30;                // Updates between asking the driver
+
+    struct Stats
+    {
+        std::size_t   bytes               = 0;  // in the registry: whole textures, previews and stand-ins
+        std::size_t   budget              = 0;  // the one in effect, after what the driver says
+        std::int64_t  driver_total_kb     = -1; // -1 where the driver doesn't say
+        std::int64_t  driver_available_kb = -1;
+        int           demoted             = 0; // standing in with a small level now
+        int           demoting            = 0;
+        int           restoring           = 0;
+        std::uint64_t demotions           = 0;
+        std::uint64_t restores            = 0;
+    };
+
+    TextureLoader(LoadScheduler& scheduler, AssetRegistry& registry, ReleaseQueue& releases, const AssetPack* pack = nullptr);
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&)                = delete;
+    TextureLoader& operator=(const TextureLoader&)     = delete;
+    TextureLoader(TextureLoader&&) noexcept            = delete;
+    TextureLoader& operator=(TextureLoader&&) noexcept = delete;
+
+    TextureHandle Request(const std::filesystem::path& filename, const TextureOptions& options = {}, TextureAtlas* atlas = nullptr, LoadPriority priority = LoadPriority::Visible);
+    TextureHandle Request(const std::filesystem::path& filename, const TextureOptions& options, TextureArray& array, LoadPriority priority = LoadPriority::Visible);
+    // Queues every resident texture requested from `filename`, or whose compressed variant it is; reads the loose file, never the pack. Returns how many.
+    std::size_t Reload(const std::filesystem::path& filename);
+    // Uploads whatever fits in `budget` and defers the rest, counted in its queued bytes
+    void        Update(UploadBudget& budget);
+    void        Shutdown();
+    // Textures of their own go to `thread` from the next Update, nullptr for none; it must be stopped before Shutdown
+    void        SetUploadThread(UploadThread* thread) noexcept;
+
+    void        SetBudget(std::size_t budget_bytes);
+    std::size_t Budget() const noexcept;
+    std::size_t PendingCount() const noexcept;
+    Stats       GetStats() const noexcept;
+
+    // A texture a recorded frame draws, by its GL name; names the loader didn't make are ignored
+    void MarkDrawn(GLuint texture);
+    // After a frame's MarkDrawn calls: what they named was drawn now, and drawing a stand-in starts its restore
+    void FrameDrawn();
+
+private:
+    struct DecodedImage;
+    struct Job;
+
+    // what a job that replaces a texture is for
+    enum class Swap : std::uint8_t
+    {
+        Reload,  // the file changed on disk
+        Demote,  // a stand-in of at most PREVIEW_SIZE instead
+        Restore, // the whole texture back in place of its stand-in
+    };
+
+    // what a request asked for, kept so a reload can ask again; holding `target` is what keeps an unused texture cached
+    struct Source
+    {
+        std::shared_ptr<AsyncTexture> target;
+        AssetHandle                   asset;
+        TextureOptions                options;
+        TextureAtlas*                 atlas = nullptr;
+        TextureArray*                 array = nullptr;
+        AtlasRegion                   region;
+        bool                          try_compressed = false;
+        LoadPriority                  priority       = LoadPriority::Visible; // the most urgent it was asked for
+        LoadScheduler::Ticket         ticket         = 0;                     // of the first load, to promote or cancel it while it is queued
+        std::uint64_t                 last_drawn     = 0;                     // FrameDrawn's count
+        bool                          is_demoted     = false;                 // a stand-in is in place of the texture
+        bool                          is_swapping    = false;                 // a demotion or a restore is on its way
+        bool                          is_pinned      = false;                 // demoting it wouldn't save anything, or restoring it failed
+    };
+
+    // the registry's entry for the request, or a new one and its job
+    TextureHandle         request(const std::filesystem::path& filename, const TextureOptions& options, TextureAtlas* atlas, TextureArray* array, LoadPriority priority);
+    LoadScheduler::Ticket submit(const std::shared_ptr<Job>& job);
+    // first loads nobody holds a handle to any more, while they are still queued
+    void cancelUnwanted();
+    // a texture of its own for the job's image, compressed or not, counted on the memory tracker; any thread with a context
+    static void uploadOwnTexture(const Job& job, Texture& out_texture, PixelUploadRing* ring);
+    // the upload thread makes the job's texture, and it is Resident once its fence signals
+    void uploadOnThread(const std::shared_ptr<Job>& job);
+    // the preview, if there is one, and the full texture's storage on the first call, then bands of it
+    // until the budget is spent; true once the texture is whole
+    bool uploadBands(Job& job, UploadBudget& budget);
+    void swapReloaded(const Job& job);
+    void swapStandIn(const Job& job);
+    // a job that loads `source`'s image again and puts it in place of the texture
+    void resubmit(Source& source, Swap swap);
+    // to the ReleaseQueue, since frames in flight may still sample it
+    void retire(const Texture& texture);
+    void unloadToBudget();
+    // stand-ins for the least recently drawn textures until the demotions on their way bring it under the budget
+    void        demoteToBudget();
+    void        queryDriverMemory();
+    std::size_t effectiveBudget() const noexcept;
+
+    struct CompletionQueue
+    {
+        std::mutex                        mutex;
+        std::vector<std::shared_ptr<Job>> finished;
+    };
+
+private:
+    LoadScheduler&                   scheduler;
+    AssetRegistry&                   registry;
+    ReleaseQueue&                    releases;
+    const AssetPack*                 pack   = nullptr;
+    std::size_t                      budget = DEFAULT_BUDGET;
+    std::shared_ptr<CompletionQueue> completed;
+    std::deque<std::shared_ptr<Job>> pending_uploads;
+    std::atomic<std::size_t>         in_flight{ 0 };
+    PixelUploadRing                  upload_ring;
+    bool                             upload_ring_ready = false;
+    UploadThread*                    upload_thread     = nullptr;
+    std::vector<Source>              sources; // every request, in the registry
+
+    std::unordered_set<GLuint> drawn; // since the last FrameDrawn
+    std::uint64_t              drawn_frames   = 0;
+    std::size_t                demoting_bytes = 0; // of the textures being demoted, still in the registry until their stand-ins land
+    std::size_t                driver_limit   = SIZE_MAX; // what keeps DRIVER_RESERVE_BYTES free, as of the last query
+    int                        driver_query   = 0;        // Updates until the next
+    Stats                      stats;
+};
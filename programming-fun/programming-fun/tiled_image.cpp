@@ -0,0 +1,162 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "tiled_image.h"
+
+#include "mip_chain.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    // magic, version, width, height, tile size, border, level count; the pages follow
+    constexpr char          MAGIC[4]    = { 'P', 'F', 'T', 'I' };
+    constexpr std::uint32_t VERSION     = 1;
+    constexpr std::size_t   HEADER_SIZE = 28;
+
+    template <typename T>
+    T read_at(const unsigned char* bytes, std::size_t offset) noexcept
+    {
+        T value{};
+        std::memcpy(&value, bytes + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void write_at(unsigned char* bytes, std::size_t offset, T value) noexcept
+    {
+        std::memcpy(bytes + offset, &value, sizeof(T));
+    }
+
+    // tile (x, y) of a level and its border, clamped to the level's edges
+    void cut_page(const unsigned char* pixels, int width, int height, int x, int y, unsigned char* out_page) noexcept
+    {
+        const int left = x * tiled_image::TILE_SIZE - tiled_image::BORDER;
+        const int top  = y * tiled_image::TILE_SIZE - tiled_image::BORDER;
+        for (int row = 0; row < tiled_image::PAGE_SIZE; ++row)
+        {
+            const int            source_y = std::clamp(top + row, 0, height - 1);
+            const unsigned char* line     = pixels + static_cast<std::size_t>(source_y) * static_cast<std::size_t>(width) * 4;
+            unsigned char*       out      = out_page + static_cast<std::size_t>(row) * tiled_image::PAGE_SIZE * 4;
+            for (int column = 0; column < tiled_image::PAGE_SIZE; ++column)
+            {
+                const int source_x = std::clamp(left + column, 0, width - 1);
+                std::memcpy(out + static_cast<std::size_t>(column) * 4, line + static_cast<std::size_t>(source_x) * 4, 4);
+            }
+        }
+    }
+}
+
+namespace tiled_image
+{
+    Info Describe(int width, int height)
+    {
+        Info info;
+        info.width  = width;
+        info.height = height;
+        if (width <= 0 || height <= 0)
+            return info;
+        std::uint64_t pages        = 0;
+        int           level_width  = width;
+        int           level_height = height;
+        for (;;)
+        {
+            Level level;
+            level.width      = level_width;
+            level.height     = level_height;
+            level.tiles_x    = (level_width + TILE_SIZE - 1) / TILE_SIZE;
+            level.tiles_y    = (level_height + TILE_SIZE - 1) / TILE_SIZE;
+            level.first_page = pages;
+            pages += static_cast<std::uint64_t>(level.tiles_x) * static_cast<std::uint64_t>(level.tiles_y);
+            info.levels.push_back(level);
+            if (level_width <= TILE_SIZE && level_height <= TILE_SIZE)
+                break;
+            level_width  = std::max(1, level_width / 2);
+            level_height = std::max(1, level_height / 2);
+        }
+        return info;
+    }
+
+    bool ReadInfo(const std::filesystem::path& filename, Info& out_info)
+    {
+        std::ifstream file{ filename, std::ios::binary | std::ios::ate };
+        if (!file)
+            return false;
+        const auto    size = static_cast<std::uint64_t>(file.tellg());
+        unsigned char header[HEADER_SIZE];
+        if (size < HEADER_SIZE || !file.seekg(0) || !file.read(reinterpret_cast<char*>(header), HEADER_SIZE))
+            return false;
+        if (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || read_at<std::uint32_t>(header, 4) != VERSION || read_at<std::uint32_t>(header, 16) != static_cast<std::uint32_t>(TILE_SIZE) ||
+            read_at<std::uint32_t>(header, 20) != static_cast<std::uint32_t>(BORDER))
+            return false;
+        const auto width  = read_at<std::uint32_t>(header, 8);
+        const auto height = read_at<std::uint32_t>(header, 12);
+        if (width == 0 || height == 0 || width > (1u << 24) || height > (1u << 24))
+            return false;
+
+        Info        info = Describe(static_cast<int>(width), static_cast<int>(height));
+        const Level last = info.levels.back();
+        if (read_at<std::uint32_t>(header, 24) != info.levels.size() || size < PageOffset(info, static_cast<int>(info.levels.size()) - 1, last.tiles_x - 1, last.tiles_y - 1) + PAGE_BYTES)
+            return false;
+        out_info = std::move(info);
+        return true;
+    }
+
+    std::uint64_t PageOffset(const Info& info, int level, int x, int y) noexcept
+    {
+        const Level&        entry = info.levels[static_cast<std::size_t>(level)];
+        const std::uint64_t page  = entry.first_page + static_cast<std::uint64_t>(y) * static_cast<std::uint64_t>(entry.tiles_x) + static_cast<std::uint64_t>(x);
+        return HEADER_SIZE + page * PAGE_BYTES;
+    }
+
+    bool Write(const std::filesystem::path& filename, const unsigned char* pixels, int width, int height)
+    {
+        const Info info = Describe(width, height);
+        if (info.levels.empty())
+            return false;
+        std::ofstream file{ filename, std::ios::binary };
+        unsigned char header[HEADER_SIZE] = {};
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        write_at<std::uint32_t>(header, 4, VERSION);
+        write_at<std::uint32_t>(header, 8, static_cast<std::uint32_t>(width));
+        write_at<std::uint32_t>(header, 12, static_cast<std::uint32_t>(height));
+        write_at<std::uint32_t>(header, 16, TILE_SIZE);
+        write_at<std::uint32_t>(header, 20, BORDER);
+        write_at<std::uint32_t>(header, 24, static_cast<std::uint32_t>(info.levels.size()));
+        if (!file.write(reinterpret_cast<const char*>(header), HEADER_SIZE))
+            return false;
+
+        // only one level below the source is held at a time
+        std::vector<unsigned char> level_pixels;
+        std::vector<unsigned char> page(PAGE_BYTES);
+        const unsigned char*       current = pixels;
+        for (std::size_t index = 0; index < info.levels.size(); ++index)
+        {
+            const Level& level = info.levels[index];
+            if (index > 0)
+            {
+                const Level& above         = info.levels[index - 1];
+                int          unused_width  = 0;
+                int          unused_height = 0;
+                level_pixels               = downsample_rgba(current, above.width, above.height, unused_width, unused_height);
+                current                    = level_pixels.data();
+            }
+            for (int y = 0; y < level.tiles_y; ++y)
+            {
+                for (int x = 0; x < level.tiles_x; ++x)
+                {
+                    cut_page(current, level.width, level.height, x, y, page.data());
+                    if (!file.write(reinterpret_cast<const char*>(page.data()), static_cast<std::streamsize>(page.size())))
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+}
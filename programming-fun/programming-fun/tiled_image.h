@@ -0,0 +1,57 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+/**
+ * Images too big to load whole, stored as a pyramid of fixed-size tiles for VirtualTexture to stream.
+ *
+ * texture-converter --tiles writes one next to an image: level 0 is the image and every level after it half
+ * the size, down to the first that fits in one tile. Each level is cut into TILE_SIZE squares, stored level by
+ * level and row by row as raw RGBA8 pages with a BORDER of the neighbouring texels around them, so bilinear
+ * filtering at a tile's edge reads what the image has there rather than the next page in the cache. Edges past
+ * the image repeat its last texel. Raw pages make a load one seek and one read, with nothing to decode.
+ * No GL here so offline tools can share it.
+ */
+namespace tiled_image
+{
+    constexpr int         TILE_SIZE  = 128;
+    constexpr int         BORDER     = 1;
+    constexpr int         PAGE_SIZE  = TILE_SIZE + 2 * BORDER;
+    constexpr std::size_t PAGE_BYTES = static_cast<std::size_t>(PAGE_SIZE) * PAGE_SIZE * 4;
+
+    struct Level
+    {
+        int           width      = 0;
+        int           height     = 0;
+        int           tiles_x    = 0;
+        int           tiles_y    = 0;
+        std::uint64_t first_page = 0; // its top left tile, counted across the levels before it
+    };
+
+    struct Info
+    {
+        int                width  = 0;
+        int                height = 0;
+        std::vector<Level> levels; // level 0 first; the last is a single tile
+    };
+
+    // The pyramid of a width x height image
+    Info Describe(int width, int height);
+    // Checks the header and that the file holds every page
+    bool ReadInfo(const std::filesystem::path& filename, Info& out_info);
+    // Where the page of tile (x, y) of `level` starts in the file
+    std::uint64_t PageOffset(const Info& info, int level, int x, int y) noexcept;
+
+    // `pixels` is level 0, RGBA8; the levels below are box filtered from it one at a time
+    bool Write(const std::filesystem::path& filename, const unsigned char* pixels, int width, int height);
+}
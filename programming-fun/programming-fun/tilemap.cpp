@@ -0,0 +1,355 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "tilemap.h"
+
+#include "gl_stats.h"
+#include "memory_tracker.h"
+#include "release_queue.h"
+#include "upload_budget.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // out of view this long and a chunk's buffer goes, about ten seconds at 60 Hz
+    constexpr std::uint64_t EVICT_FRAMES = 600;
+    // a zoom out over the whole map queues its chunks over a few frames instead of all at once
+    constexpr int MAX_BUILD_STARTS = 64;
+    // chunks this far outside the view are built ahead of a pan, once everything in view is under way
+    constexpr int PREFETCH_CHUNKS = 1;
+    // and only while few builds are out, so they never hold the workers from the view's own
+    constexpr int MAX_PREFETCH_BUILDING = 8;
+
+    std::uint16_t to_unorm16(float value) noexcept
+    {
+        return static_cast<std::uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+}
+
+void Tilemap::Resize(WorkerPool& workers, glm::ivec2 size_in_tiles, float new_tile_size)
+{
+    dropChunks(workers);
+    size       = glm::max(size_in_tiles, glm::ivec2{ 0 });
+    chunk_grid = (size + CHUNK_TILES - 1) / CHUNK_TILES;
+    tile_size  = new_tile_size;
+    tiles.assign(static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y), TileId{ 0 });
+    chunks.assign(static_cast<std::size_t>(chunk_grid.x) * static_cast<std::size_t>(chunk_grid.y), Chunk{});
+    stats        = Stats{};
+    stats.chunks = static_cast<int>(chunks.size());
+}
+
+void Tilemap::SetTileset(std::span<const glm::vec4> uv_rects)
+{
+    tileset.assign(uv_rects.begin(), uv_rects.end());
+    for (Chunk& chunk : chunks)
+        ++chunk.generation;
+}
+
+void Tilemap::Generate(WorkerPool& workers, const std::function<TileId(int, int)>& tile_at)
+{
+    // whole rows a job; each writes only its own
+    const std::size_t rows = static_cast<std::size_t>(size.y);
+    workers.ParallelFor("Generate Tiles", rows, workers.GrainFor(rows, static_cast<std::size_t>(size.x) * sizeof(TileId)),
+                        [this, &tile_at](std::size_t begin, std::size_t end)
+                        {
+                            for (auto y = static_cast<int>(begin); y < static_cast<int>(end); ++y)
+                            {
+                                TileId* row = &tiles[static_cast<std::size_t>(y) * static_cast<std::size_t>(size.x)];
+                                for (int x = 0; x < size.x; ++x)
+                                    row[x] = tile_at(x, y);
+                            }
+                        });
+    for (Chunk& chunk : chunks)
+        ++chunk.generation;
+}
+
+void Tilemap::Set(int x, int y, TileId tile)
+{
+    if (x < 0 || y < 0 || x >= size.x || y >= size.y)
+        return;
+    TileId& current = tiles[static_cast<std::size_t>(y) * static_cast<std::size_t>(size.x) + static_cast<std::size_t>(x)];
+    if (current == tile)
+        return;
+    current = tile;
+    ++chunks[static_cast<std::size_t>((y / CHUNK_TILES) * chunk_grid.x + x / CHUNK_TILES)].generation;
+}
+
+TileId Tilemap::Get(int x, int y) const noexcept
+{
+    if (x < 0 || y < 0 || x >= size.x || y >= size.y)
+        return TileId{ 0 };
+    return tiles[static_cast<std::size_t>(y) * static_cast<std::size_t>(size.x) + static_cast<std::size_t>(x)];
+}
+
+void Tilemap::Update(WorkerPool& workers, const Aabb2& view, UploadBudget& budget, ReleaseQueue& releases)
+{
+    ++frame;
+    stats.built   = 0;
+    stats.evicted = 0;
+
+    std::vector<std::shared_ptr<Build>> done;
+    {
+        std::lock_guard lock{ finished_mutex };
+        done.swap(finished);
+    }
+    // still building until uploaded; what doesn't fit goes back ahead of the builds that land meanwhile
+    std::size_t uploaded = 0;
+    {
+        const UploadBudget::Timer timer{ budget };
+        for (; uploaded < done.size() && (uploaded == 0 || budget.HasRoom()); ++uploaded)
+        {
+            const Build& build = *done[uploaded];
+            Chunk&       chunk = chunks[static_cast<std::size_t>(build.chunk)];
+            chunk.building     = false;
+            --stats.building;
+            upload(build);
+            budget.Spend(build.vertices.size() * sizeof(TileVertex));
+        }
+    }
+    if (uploaded < done.size())
+    {
+        for (std::size_t i = uploaded; i < done.size(); ++i)
+            budget.Defer(done[i]->vertices.size() * sizeof(TileVertex));
+        std::lock_guard lock{ finished_mutex };
+        finished.insert(finished.begin(), done.begin() + static_cast<std::ptrdiff_t>(uploaded), done.end());
+    }
+
+    visible.clear();
+    to_build.clear();
+    const float      chunk_world = static_cast<float>(CHUNK_TILES) * tile_size;
+    const glm::ivec2 first       = glm::max(glm::ivec2{ glm::floor(view.min / chunk_world) }, glm::ivec2{ 0 });
+    const glm::ivec2 last        = glm::min(glm::ivec2{ glm::floor(view.max / chunk_world) }, chunk_grid - 1);
+    // dirty or never built; a chunk edited while building goes again once that build lands
+    const auto needs_build = [](const Chunk& chunk) { return !chunk.building && chunk.built != chunk.generation; };
+    for (int chunk_y = first.y; chunk_y <= last.y; ++chunk_y)
+    {
+        for (int chunk_x = first.x; chunk_x <= last.x; ++chunk_x)
+        {
+            const int index       = chunk_y * chunk_grid.x + chunk_x;
+            Chunk&    chunk       = chunks[static_cast<std::size_t>(index)];
+            chunk.last_seen_frame = frame;
+            visible.push_back(index);
+            if (needs_build(chunk))
+                to_build.push_back(index);
+        }
+    }
+    stats.visible = static_cast<int>(visible.size());
+
+    // the middle of the view first, where the eye is
+    const glm::vec2 center   = (view.min + view.max) * 0.5f / chunk_world;
+    const auto      distance = [this, center](int index)
+    {
+        const glm::vec2 middle{ static_cast<float>(index % chunk_grid.x) + 0.5f, static_cast<float>(index / chunk_grid.x) + 0.5f };
+        const glm::vec2 offset = middle - center;
+        return glm::dot(offset, offset);
+    };
+    std::sort(to_build.begin(), to_build.end(), [&distance](int a, int b) { return distance(a) < distance(b); });
+    const int starts = std::min(static_cast<int>(to_build.size()), MAX_BUILD_STARTS);
+    for (int i = 0; i < starts; ++i)
+        startBuild(workers, to_build[static_cast<std::size_t>(i)]);
+
+    // the ring around the view counts as seen, so what a pan back and forth needs stays resident
+    stats.prefetched = 0;
+    if (first.x <= last.x && first.y <= last.y)
+    {
+        const glm::ivec2 near_first = glm::max(first - PREFETCH_CHUNKS, glm::ivec2{ 0 });
+        const glm::ivec2 near_last  = glm::min(last + PREFETCH_CHUNKS, chunk_grid - 1);
+        const bool       prefetch   = starts == static_cast<int>(to_build.size());
+        for (int chunk_y = near_first.y; chunk_y <= near_last.y; ++chunk_y)
+        {
+            for (int chunk_x = near_first.x; chunk_x <= near_last.x; ++chunk_x)
+            {
+                if (chunk_x >= first.x && chunk_x <= last.x && chunk_y >= first.y && chunk_y <= last.y)
+                    continue;
+                const int index       = chunk_y * chunk_grid.x + chunk_x;
+                Chunk&    chunk       = chunks[static_cast<std::size_t>(index)];
+                chunk.last_seen_frame = frame;
+                if (prefetch && stats.building < MAX_PREFETCH_BUILDING && needs_build(chunk))
+                {
+                    startBuild(workers, index);
+                    ++stats.prefetched;
+                }
+            }
+        }
+    }
+
+    for (Chunk& chunk : chunks)
+    {
+        if (chunk.buffer != 0 && frame - chunk.last_seen_frame > EVICT_FRAMES)
+        {
+            retire(chunk);
+            chunk.built = 0; // built again when next seen
+            ++stats.evicted;
+        }
+    }
+    // this Update's and any a Resize left
+    for (const RetiredBuffer& entry : retired)
+        releases.RetireBuffer(entry.buffer, entry.bytes, MemoryCategory::Geometry);
+    retired.clear();
+}
+
+void Tilemap::CollectVisible(std::pmr::vector<TileChunkDraw>& out) const
+{
+    const float chunk_world = static_cast<float>(CHUNK_TILES) * tile_size;
+    out.reserve(out.size() + visible.size());
+    for (const int index : visible)
+    {
+        const Chunk& chunk = chunks[static_cast<std::size_t>(index)];
+        if (chunk.buffer == 0)
+            continue;
+        const glm::vec2 origin{ static_cast<float>(index % chunk_grid.x) * chunk_world, static_cast<float>(index / chunk_grid.x) * chunk_world };
+        out.push_back(TileChunkDraw{ chunk.buffer, origin, chunk.tile_count });
+    }
+}
+
+void Tilemap::Shutdown(WorkerPool& workers)
+{
+    dropChunks(workers);
+    deleteRetired();
+    tiles.clear();
+    size       = glm::ivec2{ 0 };
+    chunk_grid = glm::ivec2{ 0 };
+    stats      = Stats{};
+}
+
+glm::ivec2 Tilemap::Size() const noexcept
+{
+    return size;
+}
+
+float Tilemap::TileSize() const noexcept
+{
+    return tile_size;
+}
+
+glm::vec2 Tilemap::WorldSize() const noexcept
+{
+    return glm::vec2{ size } * tile_size;
+}
+
+const Tilemap::Stats& Tilemap::GetStats() const noexcept
+{
+    return stats;
+}
+
+void Tilemap::buildVertices(Build& build)
+{
+    // corners in the order TilemapRenderer's shared indices expect: top left, top right, bottom left, bottom right
+    build.vertices.clear();
+    build.vertices.reserve(build.tiles.size() * 4);
+    for (int y = 0; y < build.extent.y; ++y)
+    {
+        for (int x = 0; x < build.extent.x; ++x)
+        {
+            const TileId tile = build.tiles[static_cast<std::size_t>(y * build.extent.x + x)];
+            if (tile == 0 || static_cast<std::size_t>(tile) > build.tileset.size())
+                continue;
+            const glm::vec4     uv = build.tileset[tile - 1u];
+            const std::uint16_t u0 = to_unorm16(uv.x);
+            const std::uint16_t v0 = to_unorm16(uv.y);
+            const std::uint16_t u1 = to_unorm16(uv.z);
+            const std::uint16_t v1 = to_unorm16(uv.w);
+            const auto          x0 = static_cast<std::int16_t>(x);
+            const auto          y0 = static_cast<std::int16_t>(y);
+            const auto          x1 = static_cast<std::int16_t>(x + 1);
+            const auto          y1 = static_cast<std::int16_t>(y + 1);
+            build.vertices.push_back(TileVertex{ x0, y0, u0, v0 });
+            build.vertices.push_back(TileVertex{ x1, y0, u1, v0 });
+            build.vertices.push_back(TileVertex{ x0, y1, u0, v1 });
+            build.vertices.push_back(TileVertex{ x1, y1, u1, v1 });
+        }
+    }
+    build.tile_count = static_cast<int>(build.vertices.size() / 4);
+}
+
+void Tilemap::startBuild(WorkerPool& workers, int index)
+{
+    Chunk&           chunk = chunks[static_cast<std::size_t>(index)];
+    const glm::ivec2 corner{ (index % chunk_grid.x) * CHUNK_TILES, (index / chunk_grid.x) * CHUNK_TILES };
+    const auto       build = std::make_shared<Build>();
+
+    build->chunk      = index;
+    build->generation = chunk.generation;
+    build->extent     = glm::min(glm::ivec2{ CHUNK_TILES }, size - corner);
+    build->tiles.resize(static_cast<std::size_t>(build->extent.x) * static_cast<std::size_t>(build->extent.y));
+    for (int y = 0; y < build->extent.y; ++y)
+    {
+        const TileId* row = &tiles[static_cast<std::size_t>(corner.y + y) * static_cast<std::size_t>(size.x) + static_cast<std::size_t>(corner.x)];
+        std::copy_n(row, build->extent.x, &build->tiles[static_cast<std::size_t>(y * build->extent.x)]);
+    }
+    build->tileset = tileset;
+    chunk.building = true;
+    ++stats.building;
+    workers.Submit(
+        [this, build]
+        {
+            buildVertices(*build);
+            std::lock_guard lock{ finished_mutex };
+            finished.push_back(build);
+        },
+        &builds);
+}
+
+void Tilemap::upload(const Build& build)
+{
+    Chunk& chunk = chunks[static_cast<std::size_t>(build.chunk)];
+    retire(chunk);
+    chunk.built      = build.generation;
+    chunk.tile_count = build.tile_count;
+    if (build.tile_count == 0)
+        return;
+    // a new buffer rather than new contents, so frames in flight keep drawing the old one
+    const std::size_t bytes = build.vertices.size() * sizeof(TileVertex);
+    glGenBuffers(1, &chunk.buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.buffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes), build.vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    chunk.buffer_bytes = bytes;
+    memory_tracker::Allocate(MemoryCategory::Geometry, bytes);
+    gl_stats::CountUpload(bytes);
+    stats.buffer_bytes += bytes;
+    ++stats.resident;
+    ++stats.built;
+}
+
+void Tilemap::retire(Chunk& chunk)
+{
+    if (chunk.buffer == 0)
+        return;
+    retired.push_back(RetiredBuffer{ chunk.buffer, chunk.buffer_bytes });
+    stats.buffer_bytes -= chunk.buffer_bytes;
+    --stats.resident;
+    chunk.buffer       = 0;
+    chunk.buffer_bytes = 0;
+    chunk.tile_count   = 0;
+}
+
+void Tilemap::dropChunks(WorkerPool& workers)
+{
+    // the builds write into `finished`, and would land in whatever chunk has their index next
+    workers.Wait(builds);
+    {
+        std::lock_guard lock{ finished_mutex };
+        finished.clear();
+    }
+    for (Chunk& chunk : chunks)
+        retire(chunk);
+    chunks.clear();
+    visible.clear();
+}
+
+void Tilemap::deleteRetired()
+{
+    for (const RetiredBuffer& entry : retired)
+    {
+        glDeleteBuffers(1, &entry.buffer);
+        memory_tracker::Free(MemoryCategory::Geometry, entry.bytes);
+    }
+    retired.clear();
+}
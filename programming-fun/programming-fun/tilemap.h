@@ -0,0 +1,146 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "math_kernels.h"
+#include "tilemap_renderer.h"
+#include "worker_pool.h"
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <vector>
+
+class ReleaseQueue;
+class UploadBudget;
+
+using TileId = std::uint16_t; // 0 is no tile; otherwise one past its index in the tileset
+
+/**
+ * A large grid of tiles kept as chunks of static vertex buffers, built on the workers as they're needed.
+ *
+ * Nothing is built up front: Update finds the chunks the view overlaps, snapshots the tiles of the dirty
+ * or missing ones into jobs that write their vertices on the workers, and uploads what finished since
+ * the last call into a fresh buffer each, as many as the frame's UploadBudget has room for. The builds nearest the middle of the view start first, and once
+ * all of the view's are under way the ring of chunks around it is built ahead, so a pan finds them ready.
+ * Editing a tile only dirties its chunk, so one edit costs one chunk's rebuild. Chunks that stay out of
+ * view for a while give their buffers back, so VRAM follows the view instead of the map: a 4096 x 4096
+ * map is 4096 chunks and half a gigabyte of vertices if all of it were resident. Replaced buffers go to
+ * the ReleaseQueue at the end of the Update, to be deleted once no frame in flight can still draw them.
+ *
+ * Main thread, with GL current (the upload context while the render thread runs), like TextureLoader.
+ */
+class Tilemap
+{
+public:
+    static constexpr int CHUNK_TILES = TilemapRenderer::CHUNK_TILES;
+
+    struct Stats
+    {
+        int         chunks       = 0;
+        int         visible      = 0; // chunks the view overlaps
+        int         resident     = 0; // chunks with a buffer
+        int         building     = 0; // chunks with a job on the workers
+        int         built        = 0; // uploaded by the latest Update
+        int         prefetched   = 0; // builds the latest Update started just outside the view
+        int         evicted      = 0; // by the latest Update
+        std::size_t buffer_bytes = 0;
+    };
+
+    Tilemap() = default;
+
+    Tilemap(const Tilemap&)                = delete;
+    Tilemap& operator=(const Tilemap&)     = delete;
+    Tilemap(Tilemap&&) noexcept            = delete;
+    Tilemap& operator=(Tilemap&&) noexcept = delete;
+
+    // Drops every tile and chunk; waits for the builds in flight first
+    void Resize(WorkerPool& workers, glm::ivec2 size_in_tiles, float tile_size);
+    // The atlas uv rect of each tile, by TileId - 1; every chunk rebuilds
+    void SetTileset(std::span<const glm::vec4> uv_rects);
+    // Every tile from tile_at(x, y), rows split across the workers
+    void   Generate(WorkerPool& workers, const std::function<TileId(int, int)>& tile_at);
+    void   Set(int x, int y, TileId tile);
+    TileId Get(int x, int y) const noexcept;
+
+    // Uploads finished builds within `budget`, starts builds for the chunks `view` overlaps (world units), and evicts the long unseen
+    void Update(WorkerPool& workers, const Aabb2& view, UploadBudget& budget, ReleaseQueue& releases);
+    // The resident chunks the latest Update saw in view
+    void CollectVisible(std::pmr::vector<TileChunkDraw>& out) const;
+    void Shutdown(WorkerPool& workers);
+
+    glm::ivec2   Size() const noexcept;
+    float        TileSize() const noexcept;
+    glm::vec2    WorldSize() const noexcept;
+    const Stats& GetStats() const noexcept;
+
+private:
+    struct Chunk
+    {
+        GLuint        buffer          = 0;
+        int           tile_count      = 0;
+        std::size_t   buffer_bytes    = 0;
+        std::uint32_t generation      = 1; // bumped by every edit
+        std::uint32_t built           = 0; // the generation the buffer shows
+        bool          building        = false;
+        std::uint64_t last_seen_frame = 0;
+    };
+
+    // everything a worker reads is copied in when the build starts, so edits can carry on meanwhile
+    struct Build
+    {
+        int                     chunk      = 0;
+        std::uint32_t           generation = 0;
+        glm::ivec2              extent{ 0 }; // tiles wide and high
+        std::vector<TileId>     tiles;       // the chunk's, row by row
+        std::vector<glm::vec4>  tileset;
+        std::vector<TileVertex> vertices;
+        int                     tile_count = 0;
+    };
+
+    struct RetiredBuffer
+    {
+        GLuint      buffer = 0;
+        std::size_t bytes  = 0;
+    };
+
+    static void buildVertices(Build& build);
+
+    void startBuild(WorkerPool& workers, int chunk);
+    void upload(const Build& build);
+    void retire(Chunk& chunk);
+    // waits out the builds, then retires every buffer
+    void dropChunks(WorkerPool& workers);
+    // Shutdown's, once nothing draws any more
+    void deleteRetired();
+
+private:
+    glm::ivec2                 size{ 0 };
+    glm::ivec2                 chunk_grid{ 0 };
+    float                      tile_size = 16.0f;
+    std::vector<TileId>        tiles;
+    std::vector<Chunk>         chunks;
+    std::vector<glm::vec4>     tileset;
+    std::vector<int>           visible;  // chunk indices the latest Update saw in view
+    std::vector<int>           to_build; // Update's scratch, the dirty ones in view
+    std::vector<RetiredBuffer> retired;
+
+    // builds the workers finished since the latest Update, and those it had no budget left for
+    std::mutex                          finished_mutex;
+    std::vector<std::shared_ptr<Build>> finished;
+    JobCounter                          builds;
+
+    std::uint64_t frame = 0;
+    Stats         stats;
+};
@@ -0,0 +1,148 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "tilemap_renderer.h"
+
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "memory_tracker.h"
+#include "vertex_layout.h"
+
+#include <cstddef>
+#include <glm/gtc/type_ptr.hpp>
+#include <vector>
+
+namespace
+{
+    constexpr const char* TILE_VERTEX_SHADER = R"(
+layout(location = 0) in vec2 aCorner;
+layout(location = 1) in vec2 aTexCoord;
+
+uniform mat4  uViewProjection;
+uniform vec2  uOrigin;
+uniform float uTileSize;
+
+out vec2 vTexCoord;
+
+void main()
+{
+    vTexCoord   = aTexCoord;
+    gl_Position = uViewProjection * vec4(uOrigin + aCorner * uTileSize, 0.0, 1.0);
+}
+)";
+
+    constexpr const char* TILE_FRAGMENT_SHADER = R"(
+in vec2 vTexCoord;
+
+uniform sampler2D uTexture;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture(uTexture, vTexCoord);
+}
+)";
+
+    constexpr std::size_t MAX_CHUNK_TILES = static_cast<std::size_t>(TilemapRenderer::CHUNK_TILES) * TilemapRenderer::CHUNK_TILES;
+    static_assert(MAX_CHUNK_TILES * 4 <= 65536, "a chunk's corners have to fit 16-bit indices");
+
+    // 8 bytes a corner: tile units as shorts, texture coordinates as normalized ones
+    constexpr auto TILE_LAYOUT = vertex_layout::Make<TileVertex>(VertexAttribute{ 0, attribute_format::Short2, offsetof(TileVertex, x) },
+                                                                 VertexAttribute{ 1, attribute_format::UShort2Norm, offsetof(TileVertex, u) });
+
+    std::size_t index_buffer_bytes()
+    {
+        return MAX_CHUNK_TILES * 6 * sizeof(std::uint16_t);
+    }
+}
+
+void TilemapRenderer::Setup()
+{
+    program.Request(TILE_VERTEX_SHADER, TILE_FRAGMENT_SHADER);
+
+    // corners 0 1 2 3 are top left, top right, bottom left, bottom right, as Tilemap writes them
+    std::vector<std::uint16_t> indices;
+    indices.reserve(MAX_CHUNK_TILES * 6);
+    for (std::size_t tile = 0; tile < MAX_CHUNK_TILES; ++tile)
+    {
+        const auto first = static_cast<std::uint16_t>(tile * 4);
+        for (const int corner : { 0, 1, 2, 2, 1, 3 })
+            indices.push_back(static_cast<std::uint16_t>(first + corner));
+    }
+    glGenVertexArrays(1, &vertex_array);
+    gl_state::BindVertexArray(vertex_array);
+    glGenBuffers(1, &index_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(index_buffer_bytes()), indices.data(), GL_STATIC_DRAW);
+    memory_tracker::Allocate(MemoryCategory::Geometry, index_buffer_bytes());
+    gl_stats::CountUpload(index_buffer_bytes());
+    vertex_layout::Enable(TILE_LAYOUT);
+}
+
+void TilemapRenderer::Shutdown()
+{
+    gl_state::DeleteVertexArray(vertex_array);
+    if (index_buffer != 0)
+    {
+        glDeleteBuffers(1, &index_buffer);
+        memory_tracker::Free(MemoryCategory::Geometry, index_buffer_bytes());
+    }
+    program.Reset();
+    vertex_array             = 0;
+    index_buffer             = 0;
+    view_projection_location = -1;
+    origin_location          = -1;
+    tile_size_location       = -1;
+}
+
+void TilemapRenderer::Draw(const glm::mat4& view_projection, std::span<const TileChunkDraw> chunks, GLuint texture, float tile_size)
+{
+    stats = Stats{};
+    if (chunks.empty() || texture == 0)
+        return;
+    if (!program.IsReady())
+    {
+        if (!program.Poll())
+        {
+            stats.pending = true;
+            return;
+        }
+        view_projection_location = glGetUniformLocation(program.Id(), "uViewProjection");
+        origin_location          = glGetUniformLocation(program.Id(), "uOrigin");
+        tile_size_location       = glGetUniformLocation(program.Id(), "uTileSize");
+        gl_state::UseProgram(program.Id());
+        glUniform1i(glGetUniformLocation(program.Id(), "uTexture"), 0);
+    }
+
+    // tiles are opaque, and drawn before anything that blends over them
+    gl_state::SetEnabled(GL_BLEND, false);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(texture);
+    gl_state::UseProgram(program.Id());
+    glUniformMatrix4fv(view_projection_location, 1, GL_FALSE, glm::value_ptr(view_projection));
+    glUniform1f(tile_size_location, tile_size);
+    gl_state::BindVertexArray(vertex_array);
+
+    for (const TileChunkDraw& chunk : chunks)
+    {
+        // the buffer is all that changes between chunks; the indices stay bound to the vertex array
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vertex_buffer);
+        vertex_layout::Bind(TILE_LAYOUT);
+        glUniform2f(origin_location, chunk.origin.x, chunk.origin.y);
+        glDrawElements(GL_TRIANGLES, chunk.tile_count * 6, GL_UNSIGNED_SHORT, nullptr);
+        gl_stats::CountDraw(2 * static_cast<long long>(chunk.tile_count));
+        stats.tiles += chunk.tile_count;
+        ++stats.draw_calls;
+    }
+    stats.chunks = static_cast<int>(chunks.size());
+}
+
+const TilemapRenderer::Stats& TilemapRenderer::LastFrameStats() const noexcept
+{
+    return stats;
+}
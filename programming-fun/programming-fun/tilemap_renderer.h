@@ -0,0 +1,70 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "shader.h"
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <span>
+
+// A tile corner inside its chunk: whole tiles for the position, the atlas uv as 16-bit fractions
+struct TileVertex
+{
+    std::int16_t  x = 0;
+    std::int16_t  y = 0;
+    std::uint16_t u = 0;
+    std::uint16_t v = 0;
+};
+
+// One chunk's static vertex buffer, four TileVertex a tile in the shared quad order
+struct TileChunkDraw
+{
+    GLuint    vertex_buffer = 0;
+    glm::vec2 origin{ 0.0f }; // world position of the chunk's top left
+    int       tile_count = 0;
+};
+
+/**
+ * Draws tilemap chunks whose vertices were uploaded once into static buffers, one indexed draw each.
+ *
+ * Every chunk shares one index buffer of quads, so a chunk only needs its vertices and how many tiles
+ * it holds. Chunk buffers belong to whoever built them (Tilemap, on the main thread's context); the
+ * renderer only reads them, which the frame's upload fence covers.
+ */
+class TilemapRenderer
+{
+public:
+    static constexpr int CHUNK_TILES = 64; // a chunk is this many tiles on a side; 4 corners a tile stays within 16-bit indices
+
+    struct Stats
+    {
+        int  chunks     = 0;
+        int  tiles      = 0;
+        int  draw_calls = 0;
+        bool pending    = false; // the program is still compiling, so nothing was drawn
+    };
+
+    void Setup();
+    void Shutdown();
+
+    void Draw(const glm::mat4& view_projection, std::span<const TileChunkDraw> chunks, GLuint texture, float tile_size);
+
+    const Stats& LastFrameStats() const noexcept;
+
+private:
+    ShaderProgram program;
+    GLint         view_projection_location = -1;
+    GLint         origin_location          = -1;
+    GLint         tile_size_location       = -1;
+    GLuint        vertex_array             = 0;
+    GLuint        index_buffer             = 0;
+    Stats         stats;
+};
@@ -0,0 +1,89 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "trace_ring.h"
+
+#include <SDL_timer.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <Windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+namespace
+{
+    // the pages of a fresh file read as zeros, which every member but the header starts as, so only that is written
+    void* map_file([[maybe_unused]] const std::filesystem::path& filename, [[maybe_unused]] std::size_t size)
+    {
+#if defined(_WIN32)
+        // the mapping keeps the file open; both handles go with the process
+        HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return nullptr;
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<std::uint64_t>(size) >> 32), static_cast<DWORD>(size), nullptr);
+        if (mapping == nullptr)
+        {
+            CloseHandle(file);
+            return nullptr;
+        }
+        return MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+#elif !defined(__EMSCRIPTEN__)
+        const int descriptor = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (descriptor < 0)
+            return nullptr;
+        void* address = ftruncate(descriptor, static_cast<off_t>(size)) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+        // the mapping keeps its own reference to the file
+        ::close(descriptor);
+        return address != MAP_FAILED ? address : nullptr;
+#else
+        // Emscripten's mmap is a copy in the virtual FS, which goes with the page anyway
+        return nullptr;
+#endif
+    }
+}
+
+namespace trace_ring
+{
+    File* Create(const std::filesystem::path& filename)
+    {
+        void* address = map_file(filename, sizeof(File));
+        if (address == nullptr)
+        {
+            LOG_ERROR("Failed to map the trace ring ", filename);
+            return nullptr;
+        }
+        File*   file             = static_cast<File*>(address);
+        Header* header           = std::construct_at(&file->header);
+        header->version          = VERSION;
+        header->file_bytes       = static_cast<std::uint32_t>(sizeof(File));
+        header->ticks_per_second = SDL_GetPerformanceFrequency();
+        header->start_ticks      = SDL_GetPerformanceCounter();
+        header->start_log_ticks  = logger::detail::Now();
+        header->unix_time        = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        // last, so a file cut short by a crash right here doesn't pass View
+        std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        return file;
+    }
+
+    const File* View(std::span<const unsigned char> bytes) noexcept
+    {
+        if (bytes.size() < sizeof(File))
+            return nullptr;
+        const auto* file = reinterpret_cast<const File*>(bytes.data());
+        if (std::memcmp(file->header.magic, MAGIC, sizeof(MAGIC)) != 0 || file->header.version != VERSION || file->header.file_bytes != sizeof(File))
+            return nullptr;
+        return file;
+    }
+}
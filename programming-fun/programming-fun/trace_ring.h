@@ -0,0 +1,102 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "logger.h"
+#include "profiler.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+/**
+ * The flight recorder's rings as a file, so the last seconds survive the process that wrote them.
+ *
+ * A File is the whole mapping: a header, the zone names, one ring of zones per thread, a ring of counter values
+ * and a ring of log records. Zones and counters keep their name as the pointer the program used, which costs a
+ * store like the in-memory ring does; the first time a thread sees a pointer the profiler copies its text into
+ * `names`, so a converter can look it up after the program is gone. Everything is plain stores into a shared
+ * mapping: the OS keeps the pages when the process crashes or is killed, and writes them back on its own time.
+ * A power cut is another matter. `is_closed` is set on a clean exit, so the next run can tell.
+ */
+namespace trace_ring
+{
+    inline constexpr char          MAGIC[8]           = "PFRING1";
+    inline constexpr std::uint32_t VERSION            = 1;
+    inline constexpr int           MAX_NAMES          = 4096;
+    inline constexpr int           NAME_BYTES         = 56;
+    inline constexpr int           MAX_COUNTER_VALUES = 1 << 14;
+    inline constexpr int           MAX_LOG_RECORDS    = 1024;
+
+    struct Event
+    {
+        std::uint64_t name  = 0; // the pointer the zone was named with
+        std::uint64_t begin = 0; // SDL_GetPerformanceCounter
+        std::uint64_t end   = 0;
+    };
+
+    struct Thread
+    {
+        char                       name[32] = {};
+        std::atomic<std::uint64_t> written{ 0 }; // published with release after the event it covers; the ring laps
+        Event                      events[profiler::MAX_RECENT_EVENTS];
+    };
+
+    struct Name
+    {
+        std::uint64_t pointer          = 0;
+        char          text[NAME_BYTES] = {};
+    };
+
+    struct Counter
+    {
+        std::uint64_t name  = 0;
+        std::uint64_t time  = 0;
+        std::int64_t  value = 0;
+    };
+
+    struct Log
+    {
+        std::atomic<std::uint64_t> sequence{ 0 }; // 1 + its place among every record written, set last; 0 while never written
+        logger::Record             record;
+    };
+
+    struct Header
+    {
+        char                       magic[8]         = {};
+        std::uint32_t              version          = 0;
+        std::uint32_t              file_bytes       = 0; // sizeof(File), which changes with the limits above
+        std::uint64_t              ticks_per_second = 0;
+        std::uint64_t              start_ticks      = 0; // SDL_GetPerformanceCounter when the file was made
+        std::uint64_t              start_log_ticks  = 0; // logger::detail::Now at the same moment
+        std::int64_t               unix_time        = 0;
+        std::atomic<std::uint32_t> name_count{ 0 };
+        std::atomic<std::uint32_t> is_closed{ 0 };
+        std::atomic<std::uint64_t> counters_written{ 0 };
+        std::atomic<std::uint64_t> logs_written{ 0 };
+    };
+
+    struct File
+    {
+        Header  header;
+        Name    names[MAX_NAMES];
+        Thread  threads[profiler::MAX_TRACE_THREADS];
+        Counter counters[MAX_COUNTER_VALUES];
+        Log     logs[MAX_LOG_RECORDS];
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the rings are read by another process, which can't share a lock");
+
+    // Makes `filename`, or truncates it, at sizeof(File) and maps it writable with the header filled in; the mapping
+    // stays until the process ends. nullptr, logged, when the file or the mapping can't be made, and on the web
+    File* Create(const std::filesystem::path& filename);
+    // `bytes` is a File this build wrote
+    const File* View(std::span<const unsigned char> bytes) noexcept;
+}
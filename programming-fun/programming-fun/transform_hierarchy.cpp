@@ -0,0 +1,295 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "transform_hierarchy.h"
+
+#include "worker_pool.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+    glm::mat3 to_matrix(const Transform2D& local) noexcept
+    {
+        // translate * rotate * scale, column major
+        const float c = std::cos(local.rotation);
+        const float s = std::sin(local.rotation);
+        return glm::mat3{ glm::vec3{ c * local.scale.x, s * local.scale.x, 0.0f }, glm::vec3{ -s * local.scale.y, c * local.scale.y, 0.0f }, glm::vec3{ local.position, 1.0f } };
+    }
+}
+
+TransformHandle TransformHierarchy::Create(const Transform2D& local, TransformHandle parent)
+{
+    std::uint32_t parent_index = NONE;
+    std::uint32_t depth        = 0;
+    if (parent.IsValid())
+    {
+        if (!Contains(parent))
+            return {};
+        parent_index = slots[parent.Index()].index;
+        depth        = depths[parent_index] + 1;
+    }
+    std::uint32_t slot = free_slot;
+    if (slot == NONE)
+    {
+        slot = static_cast<std::uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    else
+    {
+        free_slot = slots[slot].index;
+    }
+    const auto index  = static_cast<std::uint32_t>(locals.size());
+    slots[slot].index = index;
+
+    // appending keeps the order when the node is no shallower than the deepest level so far
+    const auto levels = static_cast<std::uint32_t>(level_dirty.size());
+    if (depth + 1 < levels)
+        is_sorted = false;
+    if (is_sorted)
+    {
+        if (level_begins.empty())
+            level_begins.push_back(0);
+        if (depth == levels)
+            level_begins.push_back(index + 1);
+        else
+            level_begins.back() = index + 1;
+    }
+    if (depth >= levels)
+        level_dirty.resize(depth + 1, 0);
+    ++level_dirty[depth];
+
+    locals.push_back(local);
+    worlds.emplace_back(1.0f);
+    parents.push_back(parent_index);
+    depths.push_back(depth);
+    changed.push_back(0);
+    dirty.push_back(1);
+    destroyed.push_back(0);
+    dense_slots.push_back(slot);
+    return TransformHandle::Make(slot, slots[slot].generation);
+}
+
+bool TransformHierarchy::Destroy(TransformHandle handle)
+{
+    if (!Contains(handle))
+        return false;
+    auto take = [this](std::uint32_t index) {
+        const std::uint32_t slot = dense_slots[index];
+        destroyed[index]         = 1;
+        slots[slot].generation   = TransformHandle::NextGeneration(slots[slot].generation);
+        slots[slot].index        = free_slot;
+        free_slot                = slot;
+    };
+    const std::uint32_t root = slots[handle.Index()].index;
+    take(root);
+    // parents come first, so one pass forward reaches every descendant after its parent was taken
+    for (auto i = static_cast<std::uint32_t>(root + 1); i < locals.size(); ++i)
+    {
+        if (!destroyed[i] && parents[i] != NONE && destroyed[parents[i]])
+            take(i);
+    }
+    is_sorted = false;
+    return true;
+}
+
+void TransformHierarchy::Clear()
+{
+    locals.clear();
+    worlds.clear();
+    parents.clear();
+    depths.clear();
+    changed.clear();
+    dirty.clear();
+    destroyed.clear();
+    dense_slots.clear();
+    level_begins.clear();
+    level_dirty.clear();
+    // the slots keep their generations, so handles from before stay stale
+    free_slot = NONE;
+    for (std::uint32_t slot = 0; slot < slots.size(); ++slot)
+    {
+        slots[slot].generation = TransformHandle::NextGeneration(slots[slot].generation);
+        slots[slot].index      = free_slot;
+        free_slot              = slot;
+    }
+    is_sorted = true;
+    stats     = Stats{};
+}
+
+void TransformHierarchy::Reserve(std::size_t count)
+{
+    locals.reserve(count);
+    worlds.reserve(count);
+    parents.reserve(count);
+    depths.reserve(count);
+    changed.reserve(count);
+    dirty.reserve(count);
+    destroyed.reserve(count);
+    dense_slots.reserve(count);
+    slots.reserve(count);
+}
+
+bool TransformHierarchy::Contains(TransformHandle handle) const noexcept
+{
+    const std::uint32_t slot = handle.Index();
+    return handle.IsValid() && slot < slots.size() && slots[slot].generation == handle.Generation() && slots[slot].index < dense_slots.size() &&
+           dense_slots[slots[slot].index] == slot && !destroyed[slots[slot].index];
+}
+
+std::size_t TransformHierarchy::Size() const noexcept
+{
+    return static_cast<std::size_t>(std::count(destroyed.begin(), destroyed.end(), std::uint8_t{ 0 }));
+}
+
+const Transform2D& TransformHierarchy::Local(TransformHandle handle) const noexcept
+{
+    assert(Contains(handle));
+    return locals[slots[handle.Index()].index];
+}
+
+void TransformHierarchy::SetLocal(TransformHandle handle, const Transform2D& local) noexcept
+{
+    if (!Contains(handle))
+        return;
+    const std::uint32_t index = slots[handle.Index()].index;
+    locals[index]             = local;
+    if (dirty[index] == 0)
+    {
+        dirty[index] = 1;
+        ++level_dirty[depths[index]];
+    }
+}
+
+const glm::mat3& TransformHierarchy::World(TransformHandle handle) const noexcept
+{
+    assert(Contains(handle));
+    return worlds[slots[handle.Index()].index];
+}
+
+glm::vec2 TransformHierarchy::WorldPosition(TransformHandle handle) const noexcept
+{
+    return glm::vec2{ World(handle)[2] };
+}
+
+void TransformHierarchy::Update(WorkerPool& workers)
+{
+    const Uint64 started = SDL_GetPerformanceCounter();
+    if (!is_sorted)
+        sort();
+    ++stamp;
+    stats.nodes          = static_cast<int>(locals.size());
+    stats.levels         = static_cast<int>(level_dirty.size());
+    stats.updated        = 0;
+    stats.levels_skipped = 0;
+
+    // a level below one where nothing changed only has its own dirty nodes to look at
+    bool is_above_changed = false;
+    for (std::size_t depth = 0; depth < level_dirty.size(); ++depth)
+    {
+        if (level_dirty[depth] == 0 && !is_above_changed)
+        {
+            ++stats.levels_skipped;
+            continue;
+        }
+        const std::size_t begin = level_begins[depth];
+        const std::size_t count = level_begins[depth + 1] - begin;
+        std::atomic<int>  updated{ 0 };
+        workers.ParallelFor("Update Transforms", count, workers.GrainFor(count, sizeof(glm::mat3)), [this, begin, &updated](std::size_t first, std::size_t last) {
+            updated.fetch_add(updateLevel(begin + first, begin + last), std::memory_order_relaxed);
+        });
+        level_dirty[depth] = 0;
+        is_above_changed   = updated.load(std::memory_order_relaxed) > 0;
+        stats.updated      += updated.load(std::memory_order_relaxed);
+    }
+    stats.update_ms = static_cast<double>(SDL_GetPerformanceCounter() - started) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+TransformHierarchy::Stats TransformHierarchy::GetStats() const noexcept
+{
+    return stats;
+}
+
+void TransformHierarchy::sort()
+{
+    // counting sort by depth, stable, so each level keeps the order its nodes were made in
+    std::vector<std::uint32_t> level_counts;
+    for (std::size_t i = 0; i < locals.size(); ++i)
+    {
+        if (destroyed[i])
+            continue;
+        if (depths[i] >= level_counts.size())
+            level_counts.resize(depths[i] + 1, 0);
+        ++level_counts[depths[i]];
+    }
+    level_begins.assign(level_counts.size() + 1, 0);
+    for (std::size_t depth = 0; depth < level_counts.size(); ++depth)
+        level_begins[depth + 1] = level_begins[depth] + level_counts[depth];
+
+    std::vector<std::uint32_t> new_index(locals.size(), NONE);
+    std::vector<std::uint32_t> cursors(level_begins.begin(), level_begins.end() - 1);
+    for (std::size_t i = 0; i < locals.size(); ++i)
+    {
+        if (!destroyed[i])
+            new_index[i] = cursors[depths[i]]++;
+    }
+    const std::size_t          size = level_begins.back();
+    std::vector<Transform2D>   sorted_locals(size);
+    std::vector<glm::mat3>     sorted_worlds(size);
+    std::vector<std::uint32_t> sorted_parents(size);
+    std::vector<std::uint32_t> sorted_depths(size);
+    std::vector<std::uint32_t> sorted_changed(size);
+    std::vector<std::uint8_t>  sorted_dirty(size);
+    std::vector<std::uint32_t> sorted_slots(size);
+    level_dirty.assign(level_counts.size(), 0);
+    for (std::size_t i = 0; i < locals.size(); ++i)
+    {
+        const std::uint32_t to = new_index[i];
+        if (to == NONE)
+            continue;
+        sorted_locals[to]           = locals[i];
+        sorted_worlds[to]           = worlds[i];
+        sorted_parents[to]          = parents[i] == NONE ? NONE : new_index[parents[i]];
+        sorted_depths[to]           = depths[i];
+        sorted_changed[to]          = changed[i];
+        sorted_dirty[to]            = dirty[i];
+        sorted_slots[to]            = dense_slots[i];
+        slots[dense_slots[i]].index = to;
+        level_dirty[depths[i]]      += dirty[i];
+    }
+    locals      = std::move(sorted_locals);
+    worlds      = std::move(sorted_worlds);
+    parents     = std::move(sorted_parents);
+    depths      = std::move(sorted_depths);
+    changed     = std::move(sorted_changed);
+    dirty       = std::move(sorted_dirty);
+    dense_slots = std::move(sorted_slots);
+    destroyed.assign(size, 0);
+    is_sorted = true;
+    ++stats.sorts;
+}
+
+int TransformHierarchy::updateLevel(std::size_t begin, std::size_t end) noexcept
+{
+    int updated = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const std::uint32_t parent = parents[i];
+        if (dirty[i] == 0 && (parent == NONE || changed[parent] != stamp))
+            continue;
+        const glm::mat3 local = to_matrix(locals[i]);
+        worlds[i]             = parent == NONE ? local : worlds[parent] * local;
+        changed[i]            = stamp;
+        dirty[i]              = 0;
+        ++updated;
+    }
+    return updated;
+}
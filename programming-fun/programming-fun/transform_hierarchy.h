@@ -0,0 +1,110 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "object_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat3x3.hpp>
+#include <glm/vec2.hpp>
+#include <vector>
+
+class WorkerPool;
+
+struct TransformTag;
+using TransformHandle = PoolHandle<TransformTag>;
+
+// Relative to the parent: scaled, then rotated, then moved
+struct Transform2D
+{
+    glm::vec2 position{ 0.0f };
+    float     rotation = 0.0f; // radians
+    glm::vec2 scale{ 1.0f };
+};
+
+/**
+ * 2D transforms with parents, whose world matrices are only recomputed where something moved.
+ *
+ * The nodes live in dense arrays sorted by depth, every root before every child and each level contiguous, so
+ * a level's parents are all final by the time it is reached. SetLocal marks a node dirty; Update walks the levels
+ * in order and recomputes a node when it is dirty or its parent's world changed in this same Update, which it
+ * can tell from the frame stamp the parent left. A level with nothing dirty under an unchanged level above is
+ * skipped without a look, so a still hierarchy costs a loop over its levels. Inside a level nodes only read
+ * their parents, so each level is one ParallelFor across the workers.
+ *
+ * Handles are generational, like ObjectPool's. Creating a node shallower than the deepest, or destroying one,
+ * only marks the order stale; the next Update sorts it again by depth in one stable counting pass rather than
+ * each call shifting the arrays. A node is always appended after its parent and the sort keeps that, so a
+ * parent precedes its children even while unsorted, and Destroy finds the whole subtree it takes in one scan
+ * forward. One thread at a time, Update's own jobs aside.
+ */
+class TransformHierarchy
+{
+public:
+    struct Stats
+    {
+        int    nodes          = 0;
+        int    levels         = 0; // the deepest node's depth + 1
+        int    updated        = 0; // world matrices recomputed by the latest Update
+        int    levels_skipped = 0; // by the latest Update, for having nothing to do
+        int    sorts          = 0; // since Clear
+        double update_ms      = 0.0;
+    };
+
+    // An invalid handle for `parent` makes a root; a stale one fails
+    TransformHandle Create(const Transform2D& local, TransformHandle parent = {});
+    // With everything under it; false when the handle was already stale
+    bool            Destroy(TransformHandle handle);
+    void            Clear();
+    void            Reserve(std::size_t count);
+
+    bool               Contains(TransformHandle handle) const noexcept;
+    std::size_t        Size() const noexcept;
+    const Transform2D& Local(TransformHandle handle) const noexcept;
+    void               SetLocal(TransformHandle handle, const Transform2D& local) noexcept;
+    // As of the latest Update
+    const glm::mat3&   World(TransformHandle handle) const noexcept;
+    glm::vec2          WorldPosition(TransformHandle handle) const noexcept;
+
+    void  Update(WorkerPool& workers);
+    Stats GetStats() const noexcept;
+
+private:
+    static constexpr std::uint32_t NONE = 0xFFFFFFFFu; // no parent, no free slot
+
+    struct Slot
+    {
+        std::uint32_t index      = 0; // dense, or the next free slot once destroyed
+        std::uint32_t generation = 1;
+    };
+
+    // the order by depth again, and destroyed nodes gone
+    void sort();
+    // recomputes what needs it among dense [begin, end) of one level; returns how many did
+    int  updateLevel(std::size_t begin, std::size_t end) noexcept;
+
+private:
+    // dense, all the same length, roots first and then level by level
+    std::vector<Transform2D>   locals;
+    std::vector<glm::mat3>     worlds;
+    std::vector<std::uint32_t> parents;   // dense, NONE for roots
+    std::vector<std::uint32_t> depths;    // 0 for roots
+    std::vector<std::uint32_t> changed;   // the stamp of the Update that last recomputed it
+    std::vector<std::uint8_t>  dirty;     // its local changed since
+    std::vector<std::uint8_t>  destroyed; // until the next sort takes it out
+    std::vector<std::uint32_t> dense_slots;
+    std::vector<std::uint32_t> level_begins; // by depth, then one past the last node; only kept while sorted
+    std::vector<std::uint32_t> level_dirty;  // nodes marked dirty, by depth
+    // sparse
+    std::vector<Slot> slots;
+    std::uint32_t     free_slot = NONE;
+    std::uint32_t     stamp     = 0; // counts the Updates
+    bool              is_sorted = true;
+    Stats             stats;
+};
@@ -0,0 +1,274 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "udp_socket.h"
+
+#include "logger.h"
+
+#include <charconv>
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <WinSock2.h>
+#    include <WS2tcpip.h>
+#elif !defined(__EMSCRIPTEN__)
+#    include <netdb.h>
+#    include <netinet/in.h>
+#    include <sys/select.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    using native_socket                   = SOCKET;
+    constexpr native_socket INVALID_NATIVE = INVALID_SOCKET;
+
+    // Winsock wants starting once per process before the first socket
+    bool start_sockets()
+    {
+        static const bool is_started = []
+        {
+            WSADATA data{};
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        return is_started;
+    }
+
+    void close_native(native_socket socket) noexcept
+    {
+        closesocket(socket);
+    }
+#elif !defined(__EMSCRIPTEN__)
+    using native_socket                   = int;
+    constexpr native_socket INVALID_NATIVE = -1;
+
+    bool start_sockets()
+    {
+        return true;
+    }
+
+    void close_native(native_socket socket) noexcept
+    {
+        ::close(socket);
+    }
+#endif
+}
+
+UdpSocket::~UdpSocket()
+{
+    Close();
+}
+
+bool UdpSocket::SplitAddress(std::string_view address, std::uint16_t default_port, std::string& out_host, std::uint16_t& out_port)
+{
+    std::string_view host = address;
+    std::string_view port;
+    if (host.starts_with('['))
+    {
+        const std::size_t close = host.find(']');
+        if (close == std::string_view::npos)
+            return false;
+        if (close + 1 < host.size())
+        {
+            if (host[close + 1] != ':')
+                return false;
+            port = host.substr(close + 2);
+        }
+        host = host.substr(1, close - 1);
+    }
+    else if (const std::size_t colon = host.rfind(':'); colon != std::string_view::npos && host.find(':') == colon)
+    {
+        port = host.substr(colon + 1);
+        host = host.substr(0, colon);
+    }
+    if (host.empty())
+        return false;
+    out_port = default_port;
+    if (!port.empty())
+    {
+        const auto [end, error] = std::from_chars(port.data(), port.data() + port.size(), out_port);
+        if (error != std::errc{} || end != port.data() + port.size() || out_port == 0)
+            return false;
+    }
+    out_host = host;
+    return true;
+}
+
+#if defined(__EMSCRIPTEN__)
+
+bool UdpSocket::Connect(std::string_view, std::uint16_t)
+{
+    LOG_WARN("UDP sockets aren't available in the browser");
+    return false;
+}
+
+bool UdpSocket::Bind(std::uint16_t)
+{
+    LOG_WARN("UDP sockets aren't available in the browser");
+    return false;
+}
+
+void UdpSocket::Close() noexcept
+{
+}
+
+bool UdpSocket::Send(std::span<const unsigned char>) noexcept
+{
+    return false;
+}
+
+int UdpSocket::Receive(std::span<unsigned char>, int, std::string*)
+{
+    return -1;
+}
+
+#else
+
+bool UdpSocket::Connect(std::string_view address, std::uint16_t default_port)
+{
+    Close();
+    std::string   host;
+    std::uint16_t port = 0;
+    if (!SplitAddress(address, default_port, host, port))
+    {
+        LOG_WARN("Can't read \"", address, "\" as host:port");
+        return false;
+    }
+    if (!start_sockets())
+    {
+        LOG_WARN("Sockets failed to start");
+        return false;
+    }
+    addrinfo hints{};
+    hints.ai_family            = AF_UNSPEC;
+    hints.ai_socktype          = SOCK_DGRAM;
+    hints.ai_protocol          = IPPROTO_UDP;
+    addrinfo*         results  = nullptr;
+    const std::string service  = std::to_string(port);
+    if (const int error = getaddrinfo(host.c_str(), service.c_str(), &hints, &results); error != 0 || results == nullptr)
+    {
+        LOG_WARN("Can't resolve ", host, ": ", gai_strerror(error));
+        return false;
+    }
+    for (const addrinfo* candidate = results; candidate != nullptr; candidate = candidate->ai_next)
+    {
+        const native_socket socket = ::socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (socket == INVALID_NATIVE)
+            continue;
+        // a connected UDP socket remembers where send goes and drops datagrams from anyone else
+        if (::connect(socket, candidate->ai_addr, static_cast<int>(candidate->ai_addrlen)) == 0)
+        {
+            handle = static_cast<std::intptr_t>(socket);
+            break;
+        }
+        close_native(socket);
+    }
+    freeaddrinfo(results);
+    if (!IsOpen())
+        LOG_WARN("Can't open a UDP socket to ", host, ":", port);
+    return IsOpen();
+}
+
+bool UdpSocket::Bind(std::uint16_t port)
+{
+    Close();
+    if (!start_sockets())
+    {
+        LOG_WARN("Sockets failed to start");
+        return false;
+    }
+    // dual stack where the system allows it, so IPv4 senders arrive too
+    native_socket socket = ::socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    if (socket != INVALID_NATIVE)
+    {
+        int v6_only = 0;
+        setsockopt(socket, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<const char*>(&v6_only), sizeof(v6_only));
+        sockaddr_in6 any{};
+        any.sin6_family = AF_INET6;
+        any.sin6_addr   = in6addr_any;
+        any.sin6_port   = htons(port);
+        if (::bind(socket, reinterpret_cast<const sockaddr*>(&any), sizeof(any)) == 0)
+        {
+            handle = static_cast<std::intptr_t>(socket);
+            return true;
+        }
+        close_native(socket);
+    }
+    socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socket != INVALID_NATIVE)
+    {
+        sockaddr_in any{};
+        any.sin_family      = AF_INET;
+        any.sin_addr.s_addr = htonl(INADDR_ANY);
+        any.sin_port        = htons(port);
+        if (::bind(socket, reinterpret_cast<const sockaddr*>(&any), sizeof(any)) == 0)
+        {
+            handle = static_cast<std::intptr_t>(socket);
+            return true;
+        }
+        close_native(socket);
+    }
+    LOG_WARN("Can't bind a UDP socket to port ", port);
+    return false;
+}
+
+void UdpSocket::Close() noexcept
+{
+    if (!IsOpen())
+        return;
+    close_native(static_cast<native_socket>(handle));
+    handle = -1;
+}
+
+bool UdpSocket::Send(std::span<const unsigned char> datagram) noexcept
+{
+    if (!IsOpen())
+        return false;
+    // nobody listening shows up as an error on some later call; the stream doesn't care
+    const auto sent = ::send(static_cast<native_socket>(handle), reinterpret_cast<const char*>(datagram.data()), static_cast<int>(datagram.size()), 0);
+    return sent >= 0 && static_cast<std::size_t>(sent) == datagram.size();
+}
+
+int UdpSocket::Receive(std::span<unsigned char> buffer, int timeout_ms, std::string* out_from)
+{
+    if (!IsOpen())
+        return -1;
+    const native_socket socket = static_cast<native_socket>(handle);
+    fd_set              readable;
+    FD_ZERO(&readable);
+    FD_SET(socket, &readable);
+    timeval timeout{};
+    timeout.tv_sec  = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    if (select(static_cast<int>(socket) + 1, &readable, nullptr, nullptr, &timeout) <= 0)
+        return -1;
+    sockaddr_storage from{};
+    socklen_t        from_size = sizeof(from);
+    const auto       received  = ::recvfrom(socket, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0, reinterpret_cast<sockaddr*>(&from), &from_size);
+    if (received < 0)
+        return -1;
+    if (out_from != nullptr)
+    {
+        char host[NI_MAXHOST]{};
+        char service[NI_MAXSERV]{};
+        if (getnameinfo(reinterpret_cast<const sockaddr*>(&from), from_size, host, sizeof(host), service, sizeof(service), NI_NUMERICHOST | NI_NUMERICSERV) == 0)
+            *out_from = std::string{ host } + ":" + service;
+        else
+            out_from->clear();
+    }
+    return static_cast<int>(received);
+}
+
+#endif
+
+bool UdpSocket::IsOpen() const noexcept
+{
+    return handle != -1;
+}
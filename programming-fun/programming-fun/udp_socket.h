@@ -0,0 +1,50 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+/**
+ * A blocking IPv4/IPv6 UDP socket, for the telemetry stream and its aggregator.
+ *
+ * Winsock on Windows, BSD sockets elsewhere; Emscripten has no datagrams to offer, so there every call
+ * fails. Errors are logged once where they happen and reported as false. One thread at a time.
+ */
+class UdpSocket
+{
+public:
+    UdpSocket() = default;
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket&)                = delete;
+    UdpSocket& operator=(const UdpSocket&)     = delete;
+    UdpSocket(UdpSocket&&) noexcept            = delete;
+    UdpSocket& operator=(UdpSocket&&) noexcept = delete;
+
+    // "host:port", "[v6 host]:port", or a bare host with `default_port`; resolves once
+    bool Connect(std::string_view address, std::uint16_t default_port);
+    // Every interface, for a receiver
+    bool Bind(std::uint16_t port);
+    void Close() noexcept;
+    bool IsOpen() const noexcept;
+
+    bool Send(std::span<const unsigned char> datagram) noexcept;
+    // Waits up to `timeout_ms` for one datagram; -1 on timeout or error, or its size, cut to the buffer.
+    // `out_from` gets the sender as "host:port" when given
+    int Receive(std::span<unsigned char> buffer, int timeout_ms, std::string* out_from = nullptr);
+
+    // Splits "host:port" the way Connect does
+    static bool SplitAddress(std::string_view address, std::uint16_t default_port, std::string& out_host, std::uint16_t& out_port);
+
+private:
+    std::intptr_t handle = -1;
+};
@@ -0,0 +1,350 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "ui_damage.h"
+
+#include "gl_state.h"
+#include "imgui_renderer.h"
+#include "logger.h"
+#include "memory_tracker.h"
+
+#include <SDL_loadso.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+#include <limits>
+#include <string_view>
+
+namespace
+{
+    constexpr std::int32_t EGL_DRAW       = 0x3059;
+    constexpr std::int32_t EGL_EXTENSIONS = 0x3055;
+
+    bool is_empty(const glm::ivec4& rect) noexcept
+    {
+        return rect.z <= rect.x || rect.w <= rect.y;
+    }
+
+    std::int64_t area(const glm::ivec4& rect) noexcept
+    {
+        return is_empty(rect) ? 0 : static_cast<std::int64_t>(rect.z - rect.x) * static_cast<std::int64_t>(rect.w - rect.y);
+    }
+
+    glm::ivec4 join(const glm::ivec4& a, const glm::ivec4& b) noexcept
+    {
+        return glm::ivec4{ std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w) };
+    }
+
+    bool overlaps(const glm::ivec4& a, const glm::ivec4& b) noexcept
+    {
+        return a.x < b.z && b.x < a.z && a.y < b.w && b.y < a.w;
+    }
+
+    // what the list can touch: its vertices, inside the union of its commands' clip rects, in framebuffer pixels
+    glm::ivec4 list_box(const ImDrawList& list, const ImDrawData& draw_data)
+    {
+        if (list.VtxBuffer.Size == 0)
+            return glm::ivec4{ 0 };
+        ImVec2 clip_min{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        ImVec2 clip_max{ -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+        for (const ImDrawCmd& command : list.CmdBuffer)
+        {
+            clip_min = ImVec2{ std::min(clip_min.x, command.ClipRect.x), std::min(clip_min.y, command.ClipRect.y) };
+            clip_max = ImVec2{ std::max(clip_max.x, command.ClipRect.z), std::max(clip_max.y, command.ClipRect.w) };
+        }
+        ImVec2 vertex_min{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        ImVec2 vertex_max{ -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+        for (const ImDrawVert& vertex : list.VtxBuffer)
+        {
+            vertex_min = ImVec2{ std::min(vertex_min.x, vertex.pos.x), std::min(vertex_min.y, vertex.pos.y) };
+            vertex_max = ImVec2{ std::max(vertex_max.x, vertex.pos.x), std::max(vertex_max.y, vertex.pos.y) };
+        }
+        const ImVec2 offset = draw_data.DisplayPos;
+        const ImVec2 scale  = draw_data.FramebufferScale;
+        const float  min_x  = (std::max(clip_min.x, vertex_min.x) - offset.x) * scale.x;
+        const float  min_y  = (std::max(clip_min.y, vertex_min.y) - offset.y) * scale.y;
+        const float  max_x  = (std::min(clip_max.x, vertex_max.x) - offset.x) * scale.x;
+        const float  max_y  = (std::min(clip_max.y, vertex_max.y) - offset.y) * scale.y;
+        // out to whole pixels, so the edge texels a triangle half covers are redrawn too
+        return glm::ivec4{ std::floor(min_x), std::floor(min_y), std::ceil(max_x), std::ceil(max_y) };
+    }
+
+    bool make_surface(glm::ivec2 size, GLuint& framebuffer, GLuint& texture)
+    {
+        glGenTextures(1, &texture);
+        gl_state::ActiveTexture(0);
+        gl_state::BindTexture(texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+}
+
+bool UiDamage::Track(const ImDrawData& draw_data, bool whole)
+{
+    const glm::ivec2 size{ static_cast<int>(draw_data.DisplaySize.x * draw_data.FramebufferScale.x), static_cast<int>(draw_data.DisplaySize.y * draw_data.FramebufferScale.y) };
+    // a resize moves everything, and the render side has no picture at the new size yet
+    whole        = whole || size != tracked_size;
+    tracked_size = size;
+    rects.clear();
+    for (List& list : lists)
+        list.seen = false;
+    for (int i = 0; i < draw_data.CmdLists.Size; ++i)
+    {
+        const ImDrawList& draw_list = *draw_data.CmdLists[i];
+        int               index     = 0;
+        for (int earlier = 0; earlier < i; ++earlier)
+            index += draw_data.CmdLists[earlier]->_OwnerName == draw_list._OwnerName ? 1 : 0;
+        const std::uint64_t hash  = hash_imgui_draw_list(draw_list);
+        const glm::ivec4    box   = list_box(draw_list, draw_data);
+        const auto          found = std::find_if(lists.begin(), lists.end(), [&](const List& list) { return list.owner == draw_list._OwnerName && list.index == index; });
+        if (found == lists.end())
+        {
+            rects.push_back(box);
+            lists.push_back(List{ draw_list._OwnerName, index, hash, box, true });
+            continue;
+        }
+        if (found->hash != hash)
+        {
+            rects.push_back(found->box);
+            rects.push_back(box);
+        }
+        found->hash = hash;
+        found->box  = box;
+        found->seen = true;
+    }
+    // a window closed or hidden since the last frame leaves the scene showing where it was
+    for (const List& list : lists)
+    {
+        if (!list.seen)
+            rects.push_back(list.box);
+    }
+    std::erase_if(lists, [](const List& list) { return !list.seen; });
+    if (!whole)
+    {
+        merge(size);
+        std::int64_t covered = 0;
+        for (const glm::ivec4& rect : rects)
+            covered += area(rect);
+        stats.share = static_cast<float>(static_cast<double>(covered) / static_cast<double>(std::max<std::int64_t>(area(glm::ivec4{ 0, 0, size }), 1)));
+        whole       = stats.share > FULL_SHARE;
+    }
+    if (whole)
+    {
+        rects.clear();
+        ++stats.whole;
+        return false;
+    }
+    stats.rects = static_cast<int>(rects.size());
+    ++stats.partial;
+    return true;
+}
+
+std::span<const glm::ivec4> UiDamage::Rects() const noexcept
+{
+    return rects;
+}
+
+const UiDamage::Stats& UiDamage::GetStats() const noexcept
+{
+    return stats;
+}
+
+void UiDamage::merge(glm::ivec2 size)
+{
+    for (glm::ivec4& rect : rects)
+        rect = glm::clamp(rect, glm::ivec4{ 0 }, glm::ivec4{ size, size });
+    std::erase_if(rects, is_empty);
+    // overlapping pairs first, as they cost nothing to join; then the cheapest while there are too many
+    for (;;)
+    {
+        std::size_t  best_a      = rects.size();
+        std::size_t  best_b      = rects.size();
+        std::int64_t best_growth = std::numeric_limits<std::int64_t>::max();
+        for (std::size_t a = 0; a < rects.size() && best_growth > 0; ++a)
+        {
+            for (std::size_t b = a + 1; b < rects.size(); ++b)
+            {
+                const std::int64_t growth = overlaps(rects[a], rects[b]) ? 0 : area(join(rects[a], rects[b])) - area(rects[a]) - area(rects[b]);
+                if (growth < best_growth)
+                {
+                    best_a      = a;
+                    best_b      = b;
+                    best_growth = growth;
+                    if (growth == 0)
+                        break;
+                }
+            }
+        }
+        if (best_a == rects.size() || (best_growth > 0 && rects.size() <= static_cast<std::size_t>(MAX_RECTS)))
+            break;
+        rects[best_a] = join(rects[best_a], rects[best_b]);
+        rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(best_b));
+    }
+}
+
+void UiDamageTarget::Setup()
+{
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+    // loaded by name rather than through SDL_GL_GetProcAddress, which under GLX hands back a pointer for any name at all
+    egl_library = SDL_LoadObject("libEGL.so.1");
+    if (egl_library == nullptr)
+        return;
+    using QueryString    = const char* (*)(void* display, std::int32_t name);
+    using GetProcAddress = void* (*)(const char* name);
+    get_display          = reinterpret_cast<GetCurrentDisplay>(SDL_LoadFunction(egl_library, "eglGetCurrentDisplay"));
+    get_surface          = reinterpret_cast<GetCurrentSurface>(SDL_LoadFunction(egl_library, "eglGetCurrentSurface"));
+    const auto query     = reinterpret_cast<QueryString>(SDL_LoadFunction(egl_library, "eglQueryString"));
+    const auto get_proc  = reinterpret_cast<GetProcAddress>(SDL_LoadFunction(egl_library, "eglGetProcAddress"));
+    // EGL_NO_DISPLAY unless the window's context is an EGL one
+    void* const display = get_display != nullptr ? get_display() : nullptr;
+    if (display == nullptr || get_surface == nullptr || query == nullptr || get_proc == nullptr)
+    {
+        Shutdown();
+        return;
+    }
+    const char* const      extensions = query(display, EGL_EXTENSIONS);
+    const std::string_view names      = extensions != nullptr ? extensions : "";
+    if (names.find("EGL_KHR_swap_buffers_with_damage") != std::string_view::npos)
+        swap_with_damage = reinterpret_cast<SwapWithDamage>(get_proc("eglSwapBuffersWithDamageKHR"));
+    else if (names.find("EGL_EXT_swap_buffers_with_damage") != std::string_view::npos)
+        swap_with_damage = reinterpret_cast<SwapWithDamage>(get_proc("eglSwapBuffersWithDamageEXT"));
+    stats.swap_with_damage = swap_with_damage != nullptr;
+    if (swap_with_damage == nullptr)
+        Shutdown();
+#endif
+}
+
+void UiDamageTarget::Shutdown()
+{
+    release();
+    size = glm::ivec2{ 0 };
+    if (egl_library != nullptr)
+        SDL_UnloadObject(egl_library);
+    egl_library            = nullptr;
+    get_display            = nullptr;
+    get_surface            = nullptr;
+    swap_with_damage       = nullptr;
+    stats.swap_with_damage = false;
+}
+
+bool UiDamageTarget::Resize(glm::ivec2 new_size)
+{
+    // a failed size stays failed until it changes, like RenderTarget's
+    if (new_size == size)
+        return composed_framebuffer != 0;
+    release();
+    size = new_size;
+    if (glm::any(glm::lessThanEqual(size, glm::ivec2{ 0 })))
+        return false;
+    const bool is_complete = make_surface(size, composed_framebuffer, composed_color) && make_surface(size, scene_framebuffer, scene_color);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!is_complete)
+    {
+        LOG_ERROR("UI damage target ", size.x, 'x', size.y, " is incomplete");
+        release();
+        return false;
+    }
+    allocated_bytes = static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y) * 4 * 2;
+    memory_tracker::Allocate(MemoryCategory::Textures, allocated_bytes);
+    return true;
+}
+
+bool UiDamageTarget::IsRetained() const noexcept
+{
+    return is_retained;
+}
+
+void UiDamageTarget::Forget() noexcept
+{
+    is_retained = false;
+}
+
+ColorSurface UiDamageTarget::Surface() const noexcept
+{
+    if (composed_framebuffer == 0)
+        return ColorSurface{};
+    return ColorSurface{ composed_framebuffer, composed_color, size, size };
+}
+
+void UiDamageTarget::Keep()
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, composed_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, scene_framebuffer);
+    glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    // the UI goes on next, into what the upscale left bound
+    glBindFramebuffer(GL_FRAMEBUFFER, composed_framebuffer);
+    is_retained = true;
+    ++stats.whole;
+}
+
+void UiDamageTarget::Restore(std::span<const glm::ivec4> rects)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, scene_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, composed_framebuffer);
+    // GL's origin is the bottom left
+    for (const glm::ivec4& rect : rects)
+        glBlitFramebuffer(rect.x, size.y - rect.w, rect.z, size.y - rect.y, rect.x, size.y - rect.w, rect.z, size.y - rect.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, composed_framebuffer);
+    ++stats.partial;
+}
+
+void UiDamageTarget::Present()
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, composed_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void UiDamageTarget::Swap(SDL_Window* window, std::span<const glm::ivec4> rects)
+{
+    void* const display = swap_with_damage != nullptr && !rects.empty() ? get_display() : nullptr;
+    void* const surface = display != nullptr ? get_surface(EGL_DRAW) : nullptr;
+    if (surface == nullptr)
+    {
+        SDL_GL_SwapWindow(window);
+        return;
+    }
+    egl_rects.clear();
+    for (const glm::ivec4& rect : rects)
+    {
+        egl_rects.push_back(rect.x);
+        egl_rects.push_back(size.y - rect.w);
+        egl_rects.push_back(rect.z - rect.x);
+        egl_rects.push_back(rect.w - rect.y);
+    }
+    // around SDL, which on Wayland would also wait for the compositor's frame callback; the FramePacer paces instead
+    if (swap_with_damage(display, surface, egl_rects.data(), static_cast<std::int32_t>(rects.size())) == 0)
+        SDL_GL_SwapWindow(window);
+}
+
+const UiDamageTarget::Stats& UiDamageTarget::GetStats() const noexcept
+{
+    return stats;
+}
+
+void UiDamageTarget::release()
+{
+    if (composed_framebuffer != 0)
+        glDeleteFramebuffers(1, &composed_framebuffer);
+    if (scene_framebuffer != 0)
+        glDeleteFramebuffers(1, &scene_framebuffer);
+    gl_state::DeleteTexture(composed_color);
+    gl_state::DeleteTexture(scene_color);
+    memory_tracker::Free(MemoryCategory::Textures, allocated_bytes);
+    composed_framebuffer = composed_color = scene_framebuffer = scene_color = 0;
+    allocated_bytes      = 0;
+    is_retained          = false;
+}
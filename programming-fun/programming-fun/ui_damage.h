@@ -0,0 +1,145 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "render_target.h"
+
+#include <GL/glew.h>
+#include <SDL_video.h>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <imgui.h>
+#include <span>
+#include <vector>
+
+/**
+ * Finds what part of the window the UI changed, for frames where nothing else did.
+ *
+ * Each draw list is hashed on its own and boxed by the clip rects of its commands. A list that changed, appeared or
+ * went away damages its box as it was and as it is now, so a window that moves clears where it stood. Lists are told
+ * apart by the window that owns them and their order among that window's lists. Overlapping boxes are merged, then
+ * the pair that grows least when joined until MAX_RECTS are left; past FULL_SHARE of the window redrawing it whole
+ * costs about the same, so the frame goes whole. Rects are framebuffer pixels from the top left, (min x, min y,
+ * max x, max y), what ImGuiRenderer::Render takes as limits. Main thread only.
+ */
+class UiDamage
+{
+public:
+    static constexpr int   MAX_RECTS  = 8;
+    static constexpr float FULL_SHARE = 0.5f;
+
+    struct Stats
+    {
+        int           rects   = 0;    // the last partial frame's
+        float         share   = 0.0f; // of the window they covered
+        std::uint64_t partial = 0;    // frames that only needed their rects drawn
+        std::uint64_t whole   = 0;
+    };
+
+    // After ImGui::Render, on every frame that goes to the render side. `whole` when anything but the UI may have
+    // changed since the last one; true when only Rects need drawing, which may be none
+    bool Track(const ImDrawData& draw_data, bool whole);
+
+    std::span<const glm::ivec4> Rects() const noexcept;
+    const Stats&                GetStats() const noexcept;
+
+private:
+    struct List
+    {
+        const char*   owner = nullptr; // ImDrawList::_OwnerName, which lives as long as its window
+        int           index = 0;       // among the lists with the same owner, in draw order
+        std::uint64_t hash  = 0;
+        glm::ivec4    box{ 0 };
+        bool          seen = false; // by the current Track
+    };
+
+    void merge(glm::ivec2 size);
+
+private:
+    std::vector<List>       lists;
+    std::vector<glm::ivec4> rects;
+    glm::ivec2              tracked_size{ 0 };
+    Stats                   stats;
+};
+
+/**
+ * The window's picture kept from one frame to the next, so a frame UiDamage found partial only redraws its rects.
+ *
+ * A whole frame upscales the scene into `composed` instead of the backbuffer, copies it to `scene` before the UI
+ * goes on top, then draws the UI. A partial frame skips the scene, light, post and upscale passes: it copies each
+ * rect back from `scene` and draws the UI scissored to the rects. Either way `composed` is then blitted onto the
+ * backbuffer, whose contents are undefined after a swap. Swap hands the rects to the compositor with
+ * EGL_KHR_swap_buffers_with_damage where the context is EGL and has it, and falls back to SDL_GL_SwapWindow
+ * elsewhere (WGL, the web, GLX). GL thread only.
+ */
+class UiDamageTarget
+{
+public:
+    struct Stats
+    {
+        std::uint64_t partial          = 0; // frames drawn from their rects
+        std::uint64_t whole            = 0; // frames drawn into the kept picture whole
+        bool          swap_with_damage = false;
+    };
+
+    UiDamageTarget() = default;
+
+    UiDamageTarget(const UiDamageTarget&)                = delete;
+    UiDamageTarget& operator=(const UiDamageTarget&)     = delete;
+    UiDamageTarget(UiDamageTarget&&) noexcept            = delete;
+    UiDamageTarget& operator=(UiDamageTarget&&) noexcept = delete;
+
+    // With the window's context current; looks up the EGL entry points
+    void Setup();
+    void Shutdown();
+
+    // Reallocates both surfaces when `size` differs, which forgets the picture; false when they couldn't be made
+    bool Resize(glm::ivec2 size);
+    // A whole frame was kept at the current size, so a partial one can draw over it
+    bool         IsRetained() const noexcept;
+    // For a frame drawn straight to the backbuffer: the picture no longer matches the UI UiDamage last saw.
+    // The surfaces stay until the size changes or Shutdown
+    void         Forget() noexcept;
+    ColorSurface Surface() const noexcept;
+
+    // Whole frames, after the upscale and before the UI
+    void Keep();
+    // Partial frames, before the UI
+    void Restore(std::span<const glm::ivec4> rects);
+    // Blits the picture onto the default framebuffer, which is left bound
+    void Present();
+    // Rects as Restore had them; none for a whole frame
+    void Swap(SDL_Window* window, std::span<const glm::ivec4> rects);
+
+    const Stats& GetStats() const noexcept;
+
+private:
+    // eglGetCurrentDisplay, eglGetCurrentSurface and eglSwapBuffersWithDamageKHR, without EGL's headers
+    using GetCurrentDisplay = void* (*)();
+    using GetCurrentSurface = void* (*)(std::int32_t read_or_draw);
+    using SwapWithDamage    = unsigned (*)(void* display, void* surface, const std::int32_t* rects, std::int32_t count);
+
+    void release();
+
+private:
+    GLuint                    composed_framebuffer = 0;
+    GLuint                    composed_color       = 0;
+    GLuint                    scene_framebuffer    = 0;
+    GLuint                    scene_color          = 0;
+    glm::ivec2                size{ 0 };
+    std::size_t               allocated_bytes  = 0;
+    bool                      is_retained      = false;
+    void*                     egl_library      = nullptr; // SDL_LoadObject's
+    GetCurrentDisplay         get_display      = nullptr;
+    GetCurrentSurface         get_surface      = nullptr;
+    SwapWithDamage            swap_with_damage = nullptr;
+    std::vector<std::int32_t> egl_rects; // Swap's, from the bottom left, x y width height
+    Stats                     stats;
+};
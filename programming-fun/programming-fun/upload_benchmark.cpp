@@ -0,0 +1,390 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "upload_benchmark.h"
+
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "profiler.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <cstring>
+#include <imgui.h>
+#include <numeric>
+#include <ostream>
+
+namespace
+{
+    constexpr GLuint64 FENCE_TIMEOUT_NS = 1'000'000'000;
+
+    double percentile(std::vector<double> values, double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+        const auto index = std::min(values.size() - 1, static_cast<std::size_t>(fraction * static_cast<double>(values.size())));
+        std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+        return values[index];
+    }
+}
+
+UploadBenchmark::~UploadBenchmark()
+{
+    Stop();
+}
+
+void UploadBenchmark::Start(std::size_t bytes)
+{
+    Stop();
+    rows        = std::max(1, static_cast<int>(bytes / (TEXTURE_WIDTH * 4)));
+    frame_bytes = static_cast<std::size_t>(rows) * TEXTURE_WIDTH * 4;
+    // something other than zeros, which a driver could in principle clear instead of copying
+    source.resize(frame_bytes);
+    for (std::size_t i = 0; i < source.size(); ++i)
+        source[i] = static_cast<unsigned char>(i * 7 + i / 4096);
+    results.clear();
+    current    = 0;
+    frame      = 0;
+    is_timed   = false;
+    is_running = advance();
+}
+
+void UploadBenchmark::Stop()
+{
+    releaseMethod();
+    is_running = false;
+    is_timed   = false;
+}
+
+bool UploadBenchmark::IsRunning() const noexcept
+{
+    return is_running;
+}
+
+void UploadBenchmark::Update(double previous_frame_ms, bool loading)
+{
+    if (!is_running)
+        return;
+    // the frame before was the one the previous call uploaded for
+    if (is_timed)
+        frame_times.push_back(previous_frame_ms);
+    is_timed = false;
+    if (loading)
+        return;
+
+    if (frame == WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        finishMethod();
+        ++current;
+        if (!advance())
+        {
+            is_running = false;
+            return;
+        }
+    }
+    const auto   method = static_cast<Method>(current);
+    const Uint64 begin  = SDL_GetPerformanceCounter();
+    upload(method);
+    if (frame >= WARMUP_FRAMES)
+    {
+        submit_sum += profiler::ToMilliseconds(SDL_GetPerformanceCounter() - begin);
+        is_timed = true;
+    }
+    ++frame;
+}
+
+std::span<const UploadBenchmark::Result> UploadBenchmark::Results() const noexcept
+{
+    return results;
+}
+
+std::size_t UploadBenchmark::FrameBytes() const noexcept
+{
+    return frame_bytes;
+}
+
+void UploadBenchmark::Print(std::ostream& out) const
+{
+    out << "Upload paths, " << static_cast<double>(frame_bytes) / (1024.0 * 1024.0) << " MB a frame, " << MEASURED_FRAMES << " frames each after " << WARMUP_FRAMES << " to warm up\n";
+    for (const Result& result : results)
+    {
+        out << "  " << MethodName(result.method) << ": ";
+        if (!result.supported)
+        {
+            out << "not available\n";
+            continue;
+        }
+        out << "submit " << result.submit_ms << " ms (" << result.mb_per_second << " MB/s), frame " << result.frame_ms << " ms, p95 " << result.frame_p95_ms << " ms, "
+            << (result.over_baseline_ms >= 0.0 ? "+" : "") << result.over_baseline_ms << " ms over the baseline";
+        if (result.stalls > 0)
+            out << ", " << result.stalls << " stalls";
+        out << '\n';
+    }
+}
+
+void UploadBenchmark::DrawImGui()
+{
+    ImGui::BeginDisabled(is_running);
+    ImGui::SetNextItemWidth(120.0f);
+    ImGui::SliderFloat("MB a frame", &size_mb, 0.25f, 64.0f, "%.2f", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp);
+    ImGui::SameLine();
+    if (ImGui::Button("time upload paths"))
+        Start(static_cast<std::size_t>(static_cast<double>(size_mb) * 1024.0 * 1024.0));
+    ImGui::EndDisabled();
+    if (is_running)
+    {
+        ImGui::SameLine();
+        ImGui::Text("%s, frame %d of %d", MethodName(static_cast<Method>(current)), frame, WARMUP_FRAMES + MEASURED_FRAMES);
+    }
+    if (results.empty() || !ImGui::BeginTable("upload paths", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+        return;
+    ImGui::TableSetupColumn("method");
+    ImGui::TableSetupColumn("submit ms");
+    ImGui::TableSetupColumn("MB/s");
+    ImGui::TableSetupColumn("frame ms (p95)");
+    ImGui::TableSetupColumn("over baseline");
+    ImGui::TableHeadersRow();
+    for (const Result& result : results)
+    {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(MethodName(result.method));
+        ImGui::TableNextColumn();
+        if (!result.supported)
+        {
+            ImGui::TextDisabled("not available");
+            continue;
+        }
+        ImGui::Text("%.3f", result.submit_ms);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.0f", result.mb_per_second);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f (%.2f)", result.frame_ms, result.frame_p95_ms);
+        ImGui::TableNextColumn();
+        ImGui::Text("%+.2f ms%s", result.over_baseline_ms, result.stalls > 0 ? ", stalled" : "");
+    }
+    ImGui::EndTable();
+}
+
+const char* UploadBenchmark::MethodName(Method method) noexcept
+{
+    constexpr const char* NAMES[] = { "baseline", "glTexImage2D", "glTexSubImage2D", "pixel ring", "DSA", "glBufferData orphan", "map unsynchronized", "map persistent" };
+    return NAMES[static_cast<std::size_t>(method)];
+}
+
+bool UploadBenchmark::isSupported(Method method) const noexcept
+{
+#if defined(IS_WEBGL2)
+    return method != Method::PixelRing && method != Method::Dsa && method != Method::MapPersistent;
+#else
+    const bool has_storage        = GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+    const bool has_buffer_storage = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+    switch (method)
+    {
+        case Method::TexSubImage: return has_storage;
+        case Method::PixelRing: return has_storage && has_buffer_storage;
+        case Method::Dsa: return GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access;
+        case Method::MapPersistent: return has_buffer_storage;
+        default: return true;
+    }
+#endif
+}
+
+void UploadBenchmark::setupMethod(Method method)
+{
+    const auto total = static_cast<GLsizeiptr>(frame_bytes * STREAM_REGIONS);
+    switch (method)
+    {
+        case Method::None: break;
+        case Method::TexImage:
+        case Method::TexSubImage:
+        case Method::PixelRing:
+            glGenTextures(1, &texture);
+            gl_state::BindTexture(texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            if (method == Method::TexImage)
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TEXTURE_WIDTH, rows, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            else
+                glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, TEXTURE_WIDTH, rows);
+            // a few frames' worth, so the ring only fills when the GPU falls behind
+            if (method == Method::PixelRing)
+                ring.Setup(frame_bytes * STREAM_REGIONS);
+            break;
+        case Method::Dsa:
+#if !defined(IS_WEBGL2)
+            glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+            glTextureStorage2D(texture, 1, GL_RGBA8, TEXTURE_WIDTH, rows);
+#endif
+            break;
+        case Method::BufferOrphan:
+        case Method::MapUnsynchronized:
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, method == Method::BufferOrphan ? static_cast<GLsizeiptr>(frame_bytes) : total, nullptr, GL_STREAM_DRAW);
+            break;
+        case Method::MapPersistent:
+#if !defined(IS_WEBGL2)
+            {
+                constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                glGenBuffers(1, &buffer);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+                glBufferStorage(GL_COPY_WRITE_BUFFER, total, nullptr, flags);
+                persistent = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags));
+            }
+#endif
+            break;
+        case Method::Count: break;
+    }
+    region     = 0;
+    is_wrapped = false;
+}
+
+void UploadBenchmark::releaseMethod()
+{
+    for (GLsync& fence : fences)
+    {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (persistent != nullptr)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        persistent = nullptr;
+    }
+    if (buffer != 0)
+        glDeleteBuffers(1, &buffer);
+    buffer = 0;
+    if (texture != 0)
+        gl_state::DeleteTexture(texture);
+    texture = 0;
+    ring.Shutdown();
+}
+
+void UploadBenchmark::upload(Method method)
+{
+    // every frame's bytes differ a little from the last's
+    source[static_cast<std::size_t>(frame) % source.size()] ^= 0xFFu;
+    const auto bytes  = static_cast<GLsizeiptr>(frame_bytes);
+    const auto offset = static_cast<GLintptr>(static_cast<std::size_t>(region) * frame_bytes);
+    switch (method)
+    {
+        case Method::None: return;
+        case Method::TexImage:
+            gl_state::BindTexture(texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TEXTURE_WIDTH, rows, 0, GL_RGBA, GL_UNSIGNED_BYTE, source.data());
+            break;
+        case Method::TexSubImage:
+            gl_state::BindTexture(texture);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEXTURE_WIDTH, rows, GL_RGBA, GL_UNSIGNED_BYTE, source.data());
+            break;
+        case Method::PixelRing:
+            {
+                // a full ring means the GPU is behind; client memory then, the way the texture loader falls back
+                std::size_t    ring_offset = 0;
+                unsigned char* staging     = ring.Reserve(frame_bytes, ring_offset);
+                gl_state::BindTexture(texture);
+                if (staging == nullptr)
+                {
+                    ++stalls;
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEXTURE_WIDTH, rows, GL_RGBA, GL_UNSIGNED_BYTE, source.data());
+                    break;
+                }
+                std::memcpy(staging, source.data(), frame_bytes);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.Buffer());
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEXTURE_WIDTH, rows, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(ring_offset));
+                ring.Fence();
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            }
+            break;
+        case Method::Dsa:
+#if !defined(IS_WEBGL2)
+            glTextureSubImage2D(texture, 0, 0, 0, TEXTURE_WIDTH, rows, GL_RGBA, GL_UNSIGNED_BYTE, source.data());
+#endif
+            break;
+        case Method::BufferOrphan:
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, 0, bytes, source.data());
+            break;
+        case Method::MapUnsynchronized:
+            {
+                // like StreamBuffer without storage: a region is only written again after the orphaning
+                constexpr GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+                glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+                if (is_wrapped)
+                    glBufferData(GL_COPY_WRITE_BUFFER, bytes * STREAM_REGIONS, nullptr, GL_STREAM_DRAW);
+                is_wrapped = false;
+                if (void* mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, bytes, access); mapped != nullptr)
+                {
+                    std::memcpy(mapped, source.data(), frame_bytes);
+                    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+                }
+                region     = (region + 1) % STREAM_REGIONS;
+                is_wrapped = region == 0;
+            }
+            break;
+        case Method::MapPersistent:
+            {
+                // the region's fence is from STREAM_REGIONS frames ago, so waiting on it means the GPU is that far behind
+                GLsync& fence = fences[static_cast<std::size_t>(region)];
+                if (fence != nullptr && glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                {
+                    ++stalls;
+                    glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+                }
+                if (fence != nullptr)
+                    glDeleteSync(fence);
+                if (persistent != nullptr)
+                    std::memcpy(persistent + offset, source.data(), frame_bytes);
+                fence  = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                region = (region + 1) % STREAM_REGIONS;
+            }
+            break;
+        case Method::Count: return;
+    }
+    gl_stats::CountUpload(frame_bytes);
+}
+
+void UploadBenchmark::finishMethod()
+{
+    Result result;
+    result.method        = static_cast<Method>(current);
+    result.supported     = true;
+    result.frames        = static_cast<int>(frame_times.size());
+    result.submit_ms     = submit_sum / MEASURED_FRAMES;
+    result.mb_per_second = result.method != Method::None && result.submit_ms > 0.0 ? static_cast<double>(frame_bytes) / (1024.0 * 1024.0) / (result.submit_ms / 1000.0) : 0.0;
+    result.frame_ms      = frame_times.empty() ? 0.0 : std::accumulate(frame_times.begin(), frame_times.end(), 0.0) / static_cast<double>(frame_times.size());
+    result.frame_p95_ms  = percentile(frame_times, 0.95);
+    result.stalls        = stalls;
+    // the baseline runs first
+    result.over_baseline_ms = results.empty() ? 0.0 : result.frame_ms - results.front().frame_ms;
+    results.push_back(result);
+    releaseMethod();
+}
+
+bool UploadBenchmark::advance()
+{
+    for (; current < static_cast<int>(Method::Count); ++current)
+    {
+        const auto method = static_cast<Method>(current);
+        if (isSupported(method))
+        {
+            setupMethod(method);
+            frame      = 0;
+            submit_sum = 0.0;
+            stalls     = 0;
+            frame_times.clear();
+            return true;
+        }
+        Result skipped;
+        skipped.method = method;
+        results.push_back(skipped);
+    }
+    return false;
+}
@@ -0,0 +1,132 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "pixel_upload_ring.h"
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+/**
+ * Times texture and buffer uploads each way the context offers, so the path a driver gets is picked from numbers.
+ *
+ * Every method runs WARMUP_FRAMES and then MEASURED_FRAMES frames in turn, each frame uploading the same number of
+ * bytes as RGBA8 texels or as buffer data, after a baseline that uploads nothing. For each it reports the upload
+ * calls' time on the CPU, the MB/s that makes, and how much longer its frames were than the baseline's: a copy
+ * the driver put off, or a wait on the GPU, only shows up there. A frame cap or vsync hides that, so it is best run
+ * uncapped, which "--benchmark-uploads" does before printing the results and quitting. What the context can't
+ * do is reported as skipped; on WebGL2 that is the DSA, pixel ring and persistent methods, and its
+ * glMapBufferRange is Emscripten's copy at unmap. The textures it fills are never drawn.
+ *
+ * Textures:
+ *  - TexImage respecifies one texture with glTexImage2D every frame, the way storage was made before it was immutable
+ *  - TexSubImage writes glTexStorage2D storage, bound
+ *  - PixelRing stages the texels in a PixelUploadRing and writes the same storage from its offset
+ *  - Dsa writes glTextureStorage2D storage with glTextureSubImage2D, with nothing bound
+ * Buffers of STREAM_REGIONS frames:
+ *  - BufferOrphan orphans with glBufferData and no data, then glBufferSubData
+ *  - MapUnsynchronized maps the frame's region invalidated and unsynchronized, orphaning when the regions wrap
+ *  - MapPersistent writes a persistent coherent mapping of glBufferStorage memory, a fence a region
+ * Main thread, with GL current.
+ */
+class UploadBenchmark
+{
+public:
+    static constexpr int         WARMUP_FRAMES       = 30;
+    static constexpr int         MEASURED_FRAMES     = 120;
+    static constexpr int         STREAM_REGIONS      = 3;
+    static constexpr int         TEXTURE_WIDTH       = 1024;
+    static constexpr std::size_t DEFAULT_FRAME_BYTES = 4 * 1024 * 1024; // a 1024 x 1024 RGBA8 texture
+
+    enum class Method : std::uint8_t
+    {
+        None, // the baseline
+        TexImage,
+        TexSubImage,
+        PixelRing,
+        Dsa,
+        BufferOrphan,
+        MapUnsynchronized,
+        MapPersistent,
+        Count
+    };
+
+    struct Result
+    {
+        Method method           = Method::None;
+        bool   supported        = false;
+        int    frames           = 0;   // measured
+        double submit_ms        = 0.0; // the upload calls on the CPU, a frame
+        double mb_per_second    = 0.0; // the frame's bytes over submit_ms
+        double frame_ms         = 0.0; // mean whole frame
+        double frame_p95_ms     = 0.0;
+        double over_baseline_ms = 0.0; // frame_ms less the baseline's
+        int    stalls           = 0;   // the pixel ring full, or a persistent region still being read
+    };
+
+    UploadBenchmark() = default;
+    ~UploadBenchmark();
+
+    UploadBenchmark(const UploadBenchmark&)                = delete;
+    UploadBenchmark& operator=(const UploadBenchmark&)     = delete;
+    UploadBenchmark(UploadBenchmark&&) noexcept            = delete;
+    UploadBenchmark& operator=(UploadBenchmark&&) noexcept = delete;
+
+    // Drops earlier results; `frame_bytes` is rounded to whole rows of TEXTURE_WIDTH texels
+    void Start(std::size_t frame_bytes = DEFAULT_FRAME_BYTES);
+    void Stop();
+    bool IsRunning() const noexcept;
+    // Once a frame, before the frame's other uploads; `previous_frame_ms` is the whole of the frame before.
+    // Frames while `loading` upload nothing and count for nobody, so the loads aren't timed with a method
+    void Update(double previous_frame_ms, bool loading);
+
+    std::span<const Result> Results() const noexcept;
+    std::size_t             FrameBytes() const noexcept;
+    void                    Print(std::ostream& out) const;
+    // Run button, size and the results for the caller's current window
+    void DrawImGui();
+
+    static const char* MethodName(Method method) noexcept;
+
+private:
+    bool isSupported(Method method) const noexcept;
+    void setupMethod(Method method);
+    void releaseMethod();
+    void upload(Method method);
+    void finishMethod();
+    // the next supported method from `current` on, the skipped ones recorded as such; false past the last
+    bool advance();
+
+private:
+    bool                       is_running  = false;
+    std::size_t                frame_bytes = DEFAULT_FRAME_BYTES;
+    int                        rows        = 0;
+    std::vector<unsigned char> source;
+    std::vector<Result>        results;
+    std::vector<double>        frame_times; // the current method's measured frames
+    double                     submit_sum = 0.0;
+    int                        current    = 0;     // Method
+    int                        frame      = 0;     // of the current method's, warm up included
+    bool                       is_timed   = false; // the previous frame uploaded and was measured
+    int                        stalls     = 0;
+    float                      size_mb    = 4.0f; // DrawImGui's slider
+
+    // the current method's objects
+    GLuint                             texture    = 0;
+    GLuint                             buffer     = 0;
+    unsigned char*                     persistent = nullptr;
+    std::array<GLsync, STREAM_REGIONS> fences{};
+    int                                region     = 0;
+    bool                               is_wrapped = false;
+    PixelUploadRing                    ring;
+};
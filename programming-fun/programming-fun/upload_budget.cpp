@@ -0,0 +1,62 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "upload_budget.h"
+
+#include <SDL_timer.h>
+
+UploadBudget::Timer::Timer(UploadBudget& upload_budget) noexcept : budget{ upload_budget }
+{
+    budget.timer_start = SDL_GetPerformanceCounter();
+}
+
+UploadBudget::Timer::~Timer()
+{
+    budget.stats.spent_ms = budget.elapsedMs();
+    budget.timer_start    = 0;
+}
+
+void UploadBudget::Begin(std::size_t max_bytes, double max_ms) noexcept
+{
+    stats           = Stats{};
+    stats.max_bytes = max_bytes;
+    stats.max_ms    = max_ms;
+    timer_start     = 0;
+}
+
+bool UploadBudget::HasRoom() const noexcept
+{
+    return stats.spent_bytes < stats.max_bytes && elapsedMs() < stats.max_ms;
+}
+
+std::size_t UploadBudget::RemainingBytes() const noexcept
+{
+    return stats.spent_bytes < stats.max_bytes ? stats.max_bytes - stats.spent_bytes : 0;
+}
+
+void UploadBudget::Spend(std::size_t bytes) noexcept
+{
+    stats.spent_bytes += bytes;
+    ++stats.uploads;
+}
+
+void UploadBudget::Defer(std::size_t bytes) noexcept
+{
+    stats.queued_bytes += bytes;
+}
+
+const UploadBudget::Stats& UploadBudget::GetStats() const noexcept
+{
+    return stats;
+}
+
+double UploadBudget::elapsedMs() const noexcept
+{
+    if (timer_start == 0)
+        return stats.spent_ms;
+    return stats.spent_ms + static_cast<double>(SDL_GetPerformanceCounter() - timer_start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
@@ -0,0 +1,69 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <SDL_stdinc.h>
+#include <cstddef>
+
+/**
+ * How much the GL thread uploads in one Update: bytes and milliseconds, whichever runs out first.
+ *
+ * Application::update calls Begin once a frame, then hands the budget to everything that uploads as its loads
+ * land: TextureLoader, the tilemap's chunk buffers and VirtualTexture's pages, in that order. Each one times its
+ * upload loop with a Timer, asks HasRoom before every upload after its first and Spends what it sent; the first is
+ * always let through so a later uploader can't starve behind an earlier one, and an upload bigger than the whole
+ * budget still goes. What an uploader holds back for a later frame it reports with Defer, which the stats show as
+ * queued. Main thread only.
+ */
+class UploadBudget
+{
+public:
+    static constexpr std::size_t DEFAULT_BYTES = 8 * 1024 * 1024;
+    static constexpr double      DEFAULT_MS    = 2.0;
+
+    struct Stats
+    {
+        std::size_t max_bytes    = DEFAULT_BYTES;
+        double      max_ms       = DEFAULT_MS;
+        std::size_t spent_bytes  = 0;
+        double      spent_ms     = 0.0; // inside the Timers
+        int         uploads      = 0;
+        std::size_t queued_bytes = 0; // deferred to a later frame, as far as the uploaders know
+    };
+
+    // Times what it encloses against the budget; not nested
+    class [[nodiscard]] Timer
+    {
+    public:
+        explicit Timer(UploadBudget& budget) noexcept;
+        ~Timer();
+
+        Timer(const Timer&)            = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        UploadBudget& budget;
+    };
+
+    // Starts a frame's budget; the previous frame's stats are gone
+    void Begin(std::size_t max_bytes = DEFAULT_BYTES, double max_ms = DEFAULT_MS) noexcept;
+    // Bytes and time both left
+    bool        HasRoom() const noexcept;
+    std::size_t RemainingBytes() const noexcept;
+    void        Spend(std::size_t bytes) noexcept;
+    void        Defer(std::size_t bytes) noexcept;
+
+    const Stats& GetStats() const noexcept;
+
+private:
+    double elapsedMs() const noexcept;
+
+private:
+    Stats  stats;
+    Uint64 timer_start = 0; // while a Timer is running
+};
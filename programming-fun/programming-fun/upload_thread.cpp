@@ -0,0 +1,193 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "upload_thread.h"
+
+#include "logger.h"
+#include "perf_counters.h"
+#include "profiler.h"
+
+#include <SDL.h>
+#include <vector>
+
+UploadThread::~UploadThread()
+{
+    Stop();
+}
+
+bool UploadThread::Start([[maybe_unused]] SDL_Window* window, [[maybe_unused]] SDL_GLContext share)
+{
+#if defined(__EMSCRIPTEN__)
+    return false;
+#else
+    if (is_running)
+        return true;
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    context = SDL_GL_CreateContext(window);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    // creating it made it current here, and a context can only be current on one thread at a time
+    SDL_GL_MakeCurrent(window, share);
+    if (context == nullptr)
+    {
+        LOG_WARN("Failed to create the upload thread's context: ", SDL_GetError());
+        return false;
+    }
+    {
+        std::lock_guard lock{ mutex };
+        is_stopping = false;
+        has_failed  = false;
+        is_starting = true; // until the thread owns the context
+    }
+    thread = std::thread{ [this, window] { threadLoop(window); } };
+
+    std::unique_lock lock{ mutex };
+    changed.wait(lock, [this] { return !is_starting; });
+    if (has_failed)
+    {
+        lock.unlock();
+        thread.join();
+        SDL_GL_DeleteContext(context);
+        context = nullptr;
+        return false;
+    }
+    is_running = true;
+    return true;
+#endif
+}
+
+void UploadThread::Stop()
+{
+    if (!thread.joinable())
+        return;
+    {
+        std::lock_guard lock{ mutex };
+        is_stopping = true;
+    }
+    changed.notify_all();
+    thread.join();
+    is_running = false;
+
+    // the thread flushed every fence before it let go of its context, so none of these waits forever
+    for (Item& item : fencing)
+    {
+        glClientWaitSync(item.fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(item.fence);
+        item.done();
+    }
+    {
+        std::lock_guard lock{ mutex };
+        for (const Item& item : fencing)
+        {
+            ++stats.uploads;
+            stats.bytes += item.bytes;
+        }
+        fencing.clear();
+    }
+    SDL_GL_DeleteContext(context);
+    context = nullptr;
+}
+
+void UploadThread::Submit(Work work, Done done, std::size_t bytes)
+{
+    if (!is_running)
+    {
+        work();
+        done();
+        std::lock_guard lock{ mutex };
+        ++stats.uploads;
+        stats.bytes += bytes;
+        return;
+    }
+    {
+        std::lock_guard lock{ mutex };
+        queued.push_back(Item{ std::move(work), std::move(done), bytes });
+    }
+    changed.notify_all();
+}
+
+void UploadThread::Update()
+{
+    std::vector<Item> signalled;
+    {
+        std::lock_guard lock{ mutex };
+        // in order, so a later upload never lands before an earlier one
+        while (!fencing.empty())
+        {
+            const GLenum status = glClientWaitSync(fencing.front().fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                break;
+            glDeleteSync(fencing.front().fence);
+            ++stats.uploads;
+            stats.bytes += fencing.front().bytes;
+            signalled.push_back(std::move(fencing.front()));
+            fencing.pop_front();
+        }
+    }
+    for (Item& item : signalled)
+        item.done();
+}
+
+bool UploadThread::IsRunning() const noexcept
+{
+    return is_running;
+}
+
+UploadThread::Stats UploadThread::GetStats() const
+{
+    std::lock_guard lock{ mutex };
+    Stats           copy = stats;
+    copy.queued          = static_cast<int>(queued.size());
+    copy.fencing         = static_cast<int>(fencing.size());
+    return copy;
+}
+
+void UploadThread::threadLoop(SDL_Window* window)
+{
+    profiler::SetThreadName("upload");
+    const bool is_current = SDL_GL_MakeCurrent(window, context) == 0;
+    {
+        std::lock_guard lock{ mutex };
+        if (!is_current)
+        {
+            LOG_ERROR("Upload thread could not take its GL context: ", SDL_GetError());
+            has_failed = true;
+        }
+        is_starting = false;
+    }
+    changed.notify_all();
+    if (!is_current)
+        return;
+
+    static const perf_counters::Handle uploaded = perf_counters::Register("upload thread bytes", perf_counters::Kind::Counter, perf_counters::InTelemetry);
+    while (true)
+    {
+        Item item;
+        {
+            std::unique_lock lock{ mutex };
+            changed.wait(lock, [this] { return !queued.empty() || is_stopping; });
+            if (queued.empty())
+                break;
+            item = std::move(queued.front());
+            queued.pop_front();
+        }
+        const Uint64 started = SDL_GetPerformanceCounter();
+        {
+            PROFILE_TRACE_ZONE("Upload");
+            item.work();
+        }
+        // without the flush the fence might never reach the GPU, and other contexts would wait on it forever
+        item.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+        perf_counters::Add(uploaded, static_cast<long long>(item.bytes));
+        {
+            std::lock_guard lock{ mutex };
+            stats.thread_ms += profiler::ToMilliseconds(SDL_GetPerformanceCounter() - started);
+            fencing.push_back(std::move(item));
+        }
+    }
+    SDL_GL_MakeCurrent(window, nullptr);
+}
@@ -0,0 +1,93 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <SDL_video.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * A loader thread with a GL context of its own, shared with the window's, that creates and fills textures and
+ * buffers so their uploads never land in a frame.
+ *
+ * Submit queues work for the thread, which runs one item at a time, then puts a fence in its context's stream
+ * and flushes it. Update, on whichever thread holds a context of the same share group, runs the `done` of
+ * every item whose fence has signalled, in the order they were submitted: from then on the objects the work made
+ * are complete and any context may bind them. Update never waits for the GPU. The work must only use GL through
+ * names it makes itself, and state through gl_state, which is per thread; `done` is where the results are handed
+ * to the rest of the program.
+ *
+ * Not available on Emscripten: WebGL contexts can't share objects, so the web build keeps uploading on its one
+ * context within the frame's UploadBudget.
+ */
+class UploadThread
+{
+public:
+    using Work = std::function<void()>;
+    using Done = std::function<void()>;
+
+    struct Stats
+    {
+        std::uint64_t uploads   = 0;   // whose fences have signalled
+        std::size_t   bytes     = 0;   // as Submit was told, of those
+        int           queued    = 0;   // waiting for the thread
+        int           fencing   = 0;   // run, their fences not signalled yet
+        double        thread_ms = 0.0; // in the work, all of it
+    };
+
+    UploadThread() = default;
+    ~UploadThread();
+
+    UploadThread(const UploadThread&)                = delete;
+    UploadThread& operator=(const UploadThread&)     = delete;
+    UploadThread(UploadThread&&) noexcept            = delete;
+    UploadThread& operator=(UploadThread&&) noexcept = delete;
+
+    // With `share` current on the caller, which it is again afterwards; false, logged, where there can't be a second context
+    bool Start(SDL_Window* window, SDL_GLContext share);
+    // Finishes the queued work, then waits for its fences and runs every `done` left; needs a context of the share group current
+    void Stop();
+
+    // `bytes` is only counted; with the thread not running both run at once on the caller
+    void Submit(Work work, Done done, std::size_t bytes);
+    // Once a frame, before what waits on the uploads
+    void Update();
+
+    bool  IsRunning() const noexcept;
+    Stats GetStats() const;
+
+private:
+    struct Item
+    {
+        Work        work;
+        Done        done;
+        std::size_t bytes = 0;
+        GLsync      fence = nullptr;
+    };
+
+    void threadLoop(SDL_Window* window);
+
+private:
+    std::thread             thread;
+    SDL_GLContext           context = nullptr;
+    mutable std::mutex      mutex;
+    std::condition_variable changed;
+    std::deque<Item>        queued;
+    std::deque<Item>        fencing;
+    bool                    is_starting = false;
+    bool                    is_running  = false;
+    bool                    is_stopping = false;
+    bool                    has_failed  = false;
+    Stats                   stats;
+};
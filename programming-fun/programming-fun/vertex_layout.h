@@ -0,0 +1,162 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// How one attribute's bytes reach the shader: what glVertexAttribPointer gets, or glVertexAttribIPointer when `is_integer`
+struct AttributeFormat
+{
+    GLint         components = 0;
+    GLenum        type       = GL_FLOAT;
+    bool          normalized = false;
+    bool          is_integer = false; // ivec/uvec in the shader, no conversion to float
+    std::uint32_t bytes      = 0;
+};
+
+/**
+ * The formats the renderers use, smallest first where there is a choice.
+ *
+ * Normalized types arrive in the shader as [0, 1] or [-1, 1] floats. The packed ones want their bits made
+ * on the CPU: glm::packHalf2x16 and packHalf4x16 for the half floats, packSnorm3x10_1x2 for Int2_10_10_10Norm,
+ * which carries a normal or a tangent and its sign in the bytes of one float.
+ */
+namespace attribute_format
+{
+    inline constexpr AttributeFormat Float1{ 1, GL_FLOAT, false, false, 4 };
+    inline constexpr AttributeFormat Float2{ 2, GL_FLOAT, false, false, 8 };
+    inline constexpr AttributeFormat Float3{ 3, GL_FLOAT, false, false, 12 };
+    inline constexpr AttributeFormat Float4{ 4, GL_FLOAT, false, false, 16 };
+    inline constexpr AttributeFormat Half2{ 2, GL_HALF_FLOAT, false, false, 4 };
+    inline constexpr AttributeFormat Half4{ 4, GL_HALF_FLOAT, false, false, 8 };
+    inline constexpr AttributeFormat Short1Norm{ 1, GL_SHORT, true, false, 2 };
+    inline constexpr AttributeFormat Short2{ 2, GL_SHORT, false, false, 4 };
+    inline constexpr AttributeFormat Short2Norm{ 2, GL_SHORT, true, false, 4 };
+    inline constexpr AttributeFormat Short4Norm{ 4, GL_SHORT, true, false, 8 };
+    inline constexpr AttributeFormat UShort2Norm{ 2, GL_UNSIGNED_SHORT, true, false, 4 };
+    inline constexpr AttributeFormat UShort4Norm{ 4, GL_UNSIGNED_SHORT, true, false, 8 };
+    inline constexpr AttributeFormat UByte4Norm{ 4, GL_UNSIGNED_BYTE, true, false, 4 }; // RGBA8 colors
+    inline constexpr AttributeFormat Int2_10_10_10Norm{ 4, GL_INT_2_10_10_10_REV, true, false, 4 };
+    inline constexpr AttributeFormat UShort1{ 1, GL_UNSIGNED_SHORT, false, true, 2 };
+    inline constexpr AttributeFormat UInt1{ 1, GL_UNSIGNED_INT, false, true, 4 };
+}
+
+struct VertexAttribute
+{
+    GLuint          location = 0;
+    AttributeFormat format;
+    std::size_t     offset = 0; // offsetof the member in the vertex
+};
+
+template <std::size_t Count>
+struct VertexLayout
+{
+    std::array<VertexAttribute, Count> attributes;
+    GLsizei                            stride  = 0;
+    GLuint                             divisor = 0; // 1 for per instance
+};
+
+namespace vertex_layout
+{
+    // Past this a stride isn't guaranteed (GL_MAX_VERTEX_ATTRIB_STRIDE's minimum); WebGL 2 caps it here too
+    inline constexpr std::size_t MAX_STRIDE    = 2048;
+    // What the smallest implementations give, GL_MAX_VERTEX_ATTRIBS
+    inline constexpr GLuint      MAX_LOCATIONS = 16;
+
+    // What an attribute's offset has to be a multiple of: its component type's size, or the whole word of a packed one
+    constexpr std::size_t Alignment(const AttributeFormat& format) noexcept
+    {
+        switch (format.type)
+        {
+            case GL_BYTE:
+            case GL_UNSIGNED_BYTE: return 1;
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:
+            case GL_HALF_FLOAT: return 2;
+            default: return 4;
+        }
+    }
+
+    /**
+     * The layout of a vertex or instance struct, checked by the compiler:
+     *
+     *     constexpr auto TILE_LAYOUT = vertex_layout::Make<TileVertex>(
+     *         VertexAttribute{ 0, attribute_format::Short2, offsetof(TileVertex, x) },
+     *         VertexAttribute{ 1, attribute_format::UShort2Norm, offsetof(TileVertex, u) });
+     *
+     * A location used twice or past MAX_LOCATIONS, attributes that overlap or run off the end of the struct,
+     * or an offset that isn't a multiple of its Alignment, which WebGL refuses and desktop drivers fetch
+     * slowly, stop the build instead of showing up as garbage on screen.
+     */
+    template <typename Vertex, typename... Attributes>
+    consteval VertexLayout<sizeof...(Attributes)> Make(Attributes... attributes)
+    {
+        static_assert(sizeof(Vertex) % 4 == 0, "vertex strides have to be a multiple of 4");
+        static_assert(sizeof(Vertex) <= MAX_STRIDE, "vertex is larger than a stride can be");
+        VertexLayout<sizeof...(Attributes)> layout{ { attributes... }, static_cast<GLsizei>(sizeof(Vertex)), 0 };
+        for (std::size_t i = 0; i < layout.attributes.size(); ++i)
+        {
+            const VertexAttribute& a = layout.attributes[i];
+            if (a.location >= MAX_LOCATIONS)
+                throw "attribute location past what every implementation has";
+            if (a.format.components < 1 || a.format.components > 4 || a.format.bytes == 0)
+                throw "attribute format isn't one of attribute_format's";
+            if (a.offset % Alignment(a.format) != 0)
+                throw "attribute offset isn't a multiple of its component size";
+            if (a.offset + a.format.bytes > sizeof(Vertex))
+                throw "attribute runs past the end of the vertex";
+            for (std::size_t j = 0; j < i; ++j)
+            {
+                const VertexAttribute& b = layout.attributes[j];
+                if (a.location == b.location)
+                    throw "two attributes share a location";
+                if (a.offset < b.offset + b.format.bytes && b.offset < a.offset + a.format.bytes)
+                    throw "two attributes overlap";
+            }
+        }
+        return layout;
+    }
+
+    // Every attribute advances once per instance
+    template <std::size_t Count>
+    consteval VertexLayout<Count> PerInstance(VertexLayout<Count> layout)
+    {
+        layout.divisor = 1;
+        return layout;
+    }
+
+    // With the vertex array bound: turns the layout's locations on, which the vertex array remembers
+    template <std::size_t Count>
+    void Enable(const VertexLayout<Count>& layout)
+    {
+        for (const VertexAttribute& attribute : layout.attributes)
+        {
+            glEnableVertexAttribArray(attribute.location);
+            if (layout.divisor != 0)
+                glVertexAttribDivisor(attribute.location, layout.divisor);
+        }
+    }
+
+    // With the vertex array and the GL_ARRAY_BUFFER bound: points every attribute `base` bytes into the buffer
+    template <std::size_t Count>
+    void Bind(const VertexLayout<Count>& layout, std::size_t base = 0)
+    {
+        for (const VertexAttribute& attribute : layout.attributes)
+        {
+            const void*            pointer = reinterpret_cast<const void*>(base + attribute.offset);
+            const AttributeFormat& format  = attribute.format;
+            if (format.is_integer)
+                glVertexAttribIPointer(attribute.location, format.components, format.type, layout.stride, pointer);
+            else
+                glVertexAttribPointer(attribute.location, format.components, format.type, format.normalized ? GL_TRUE : GL_FALSE, layout.stride, pointer);
+        }
+    }
+}
@@ -0,0 +1,287 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "video_clip.h"
+
+#include "lz4_block.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+    // magic, version, width, height, frame count, rate numerator, rate denominator, keyframe interval, u64 index offset
+    constexpr char          MAGIC[4]     = { 'P', 'F', 'V', 'C' };
+    constexpr std::uint32_t VERSION      = 1;
+    constexpr std::size_t   HEADER_SIZE  = 40;
+    constexpr std::size_t   FRAME_HEADER = 3 * sizeof(std::uint32_t);
+    constexpr int           MAX_SIZE     = 1 << 14;
+
+    template <typename T>
+    T read_at(const unsigned char* bytes, std::size_t offset) noexcept
+    {
+        T value{};
+        std::memcpy(&value, bytes + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void write_at(unsigned char* bytes, std::size_t offset, T value) noexcept
+    {
+        std::memcpy(bytes + offset, &value, sizeof(T));
+    }
+
+    std::array<std::size_t, 3> plane_sizes(const video_clip::Info& info) noexcept
+    {
+        const std::size_t luma   = static_cast<std::size_t>(info.width) * static_cast<std::size_t>(info.height);
+        const std::size_t chroma = luma / 4;
+        return { luma, chroma, chroma };
+    }
+
+    // [begin, end) of `frame` in the file; the index was checked by Parse
+    void frame_range(std::span<const unsigned char> file, const video_clip::Info& info, std::uint32_t frame, std::size_t& out_begin, std::size_t& out_end) noexcept
+    {
+        const auto index = static_cast<std::size_t>(read_at<std::uint64_t>(file.data(), 32));
+        out_begin        = static_cast<std::size_t>(read_at<std::uint64_t>(file.data(), index + frame * sizeof(std::uint64_t)));
+        out_end          = frame + 1 < info.frame_count ? static_cast<std::size_t>(read_at<std::uint64_t>(file.data(), index + (frame + 1) * sizeof(std::uint64_t))) : index;
+    }
+
+    // BT.601 studio range in 8.8 fixed point; chroma from the average of each 2x2 block
+    void rgba_to_yuv(const unsigned char* pixels, int source_width, int source_height, const video_clip::Info& info, unsigned char* out_planes) noexcept
+    {
+        unsigned char* luma  = out_planes;
+        unsigned char* u     = luma + static_cast<std::size_t>(info.width) * static_cast<std::size_t>(info.height);
+        unsigned char* v     = u + static_cast<std::size_t>(info.width / 2) * static_cast<std::size_t>(info.height / 2);
+        const auto     pixel = [&](int x, int y)
+        {
+            // the padding repeats the last column and row
+            const std::size_t at = (static_cast<std::size_t>(std::min(y, source_height - 1)) * static_cast<std::size_t>(source_width) + static_cast<std::size_t>(std::min(x, source_width - 1))) * 4;
+            return pixels + at;
+        };
+        for (int y = 0; y < info.height; ++y)
+        {
+            for (int x = 0; x < info.width; ++x)
+            {
+                const unsigned char* rgb = pixel(x, y);
+                luma[static_cast<std::size_t>(y) * static_cast<std::size_t>(info.width) + static_cast<std::size_t>(x)] =
+                    static_cast<unsigned char>(((66 * rgb[0] + 129 * rgb[1] + 25 * rgb[2] + 128) >> 8) + 16);
+            }
+        }
+        for (int y = 0; y < info.height / 2; ++y)
+        {
+            for (int x = 0; x < info.width / 2; ++x)
+            {
+                int r = 0;
+                int g = 0;
+                int b = 0;
+                for (const auto& [dx, dy] : { std::pair{ 0, 0 }, std::pair{ 1, 0 }, std::pair{ 0, 1 }, std::pair{ 1, 1 } })
+                {
+                    const unsigned char* rgb = pixel(2 * x + dx, 2 * y + dy);
+                    r += rgb[0];
+                    g += rgb[1];
+                    b += rgb[2];
+                }
+                const std::size_t at = static_cast<std::size_t>(y) * static_cast<std::size_t>(info.width / 2) + static_cast<std::size_t>(x);
+                u[at]                = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+                v[at]                = static_cast<unsigned char>(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+            }
+        }
+    }
+}
+
+namespace video_clip
+{
+    std::size_t FrameBytes(const Info& info) noexcept
+    {
+        const auto sizes = plane_sizes(info);
+        return sizes[0] + sizes[1] + sizes[2];
+    }
+
+    double FramesPerSecond(const Info& info) noexcept
+    {
+        return static_cast<double>(info.rate_numerator) / static_cast<double>(info.rate_denominator);
+    }
+
+    bool IsKeyframe(const Info& info, std::uint32_t frame) noexcept
+    {
+        return frame % info.keyframe_interval == 0;
+    }
+
+    std::uint64_t FrameAt(const Info& info, double seconds) noexcept
+    {
+        return static_cast<std::uint64_t>(std::floor(std::max(seconds, 0.0) * FramesPerSecond(info)));
+    }
+
+    bool Parse(std::span<const unsigned char> file, Info& out_info)
+    {
+        if (file.size() < HEADER_SIZE || std::memcmp(file.data(), MAGIC, sizeof(MAGIC)) != 0 || read_at<std::uint32_t>(file.data(), 4) != VERSION)
+            return false;
+        Info info;
+        info.width             = static_cast<int>(std::min(read_at<std::uint32_t>(file.data(), 8), std::uint32_t{ MAX_SIZE + 1 }));
+        info.height            = static_cast<int>(std::min(read_at<std::uint32_t>(file.data(), 12), std::uint32_t{ MAX_SIZE + 1 }));
+        info.frame_count       = read_at<std::uint32_t>(file.data(), 16);
+        info.rate_numerator    = read_at<std::uint32_t>(file.data(), 20);
+        info.rate_denominator  = read_at<std::uint32_t>(file.data(), 24);
+        info.keyframe_interval = read_at<std::uint32_t>(file.data(), 28);
+        const auto index       = read_at<std::uint64_t>(file.data(), 32);
+        if (info.width <= 0 || info.height <= 0 || info.width > MAX_SIZE || info.height > MAX_SIZE || info.width % 2 != 0 || info.height % 2 != 0 || info.frame_count == 0 ||
+            info.rate_numerator == 0 || info.rate_denominator == 0 || info.keyframe_interval == 0 || index < HEADER_SIZE || index > file.size() ||
+            (file.size() - index) / sizeof(std::uint64_t) < info.frame_count)
+            return false;
+
+        // in order from right after the header, each long enough for its plane sizes, none past the index
+        std::uint64_t end = HEADER_SIZE;
+        for (std::uint32_t frame = 0; frame < info.frame_count; ++frame)
+        {
+            const auto offset = read_at<std::uint64_t>(file.data(), static_cast<std::size_t>(index) + frame * sizeof(std::uint64_t));
+            if ((frame == 0 && offset != HEADER_SIZE) || offset < end)
+                return false;
+            end = offset + FRAME_HEADER;
+        }
+        if (end > index)
+            return false;
+        out_info = info;
+        return true;
+    }
+
+    bool DecodeFrame(std::span<const unsigned char> file, const Info& info, std::uint32_t frame, std::span<const unsigned char> previous, std::span<unsigned char> out_planes) noexcept
+    {
+        const bool is_key = IsKeyframe(info, frame);
+        if (frame >= info.frame_count || out_planes.size() != FrameBytes(info) || (!is_key && previous.size() != out_planes.size()))
+            return false;
+        std::size_t begin = 0;
+        std::size_t end   = 0;
+        frame_range(file, info, frame, begin, end);
+
+        std::size_t at = begin + FRAME_HEADER;
+        std::size_t to = 0;
+        for (std::size_t plane = 0; const std::size_t size : plane_sizes(info))
+        {
+            const auto stored = read_at<std::uint32_t>(file.data(), begin + plane * sizeof(std::uint32_t));
+            if (stored > end - at)
+                return false;
+            const auto block = file.subspan(at, stored);
+            const auto out   = out_planes.subspan(to, size);
+            if (stored == size)
+                std::memcpy(out.data(), block.data(), size);
+            else if (!lz4::Decompress(block, out))
+                return false;
+            at += stored;
+            to += size;
+            ++plane;
+        }
+        if (at != end)
+            return false;
+        if (!is_key)
+        {
+            // the planes came out as differences from the previous frame, wrapping
+            for (std::size_t i = 0; i < out_planes.size(); ++i)
+                out_planes[i] = static_cast<unsigned char>(out_planes[i] + previous[i]);
+        }
+        return true;
+    }
+
+    bool Writer::Open(const std::filesystem::path& filename, int width, int height, std::uint32_t rate_numerator, std::uint32_t rate_denominator, std::uint32_t keyframe_interval)
+    {
+        if (width <= 0 || height <= 0 || width > MAX_SIZE || height > MAX_SIZE || rate_numerator == 0 || rate_denominator == 0 || keyframe_interval == 0)
+        {
+            std::cerr << "Can't make a " << width << " x " << height << " clip at " << rate_numerator << '/' << rate_denominator << " fps\n";
+            return false;
+        }
+        file.open(filename, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "Failed to open " << filename << " for writing\n";
+            return false;
+        }
+        info                   = Info{};
+        info.width             = (width + 1) & ~1;
+        info.height            = (height + 1) & ~1;
+        info.rate_numerator    = rate_numerator;
+        info.rate_denominator  = rate_denominator;
+        info.keyframe_interval = keyframe_interval;
+        source_width           = width;
+        source_height          = height;
+        offsets.clear();
+        planes.resize(FrameBytes(info));
+        previous.resize(planes.size());
+        delta.resize(planes.size());
+        // the header is written again by Finish, once the index is
+        const unsigned char header[HEADER_SIZE] = {};
+        file.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+        return static_cast<bool>(file);
+    }
+
+    bool Writer::Add(const unsigned char* pixels)
+    {
+        const auto frame = static_cast<std::uint32_t>(offsets.size());
+        rgba_to_yuv(pixels, source_width, source_height, info, planes.data());
+        std::span<const unsigned char> source = planes;
+        if (!IsKeyframe(info, frame))
+        {
+            for (std::size_t i = 0; i < planes.size(); ++i)
+                delta[i] = static_cast<unsigned char>(planes[i] - previous[i]);
+            source = delta;
+        }
+        offsets.push_back(static_cast<std::uint64_t>(file.tellp()));
+
+        // the sizes go in front, so they are patched in once the planes are out
+        const auto    start               = file.tellp();
+        unsigned char sizes[FRAME_HEADER] = {};
+        file.write(reinterpret_cast<const char*>(sizes), FRAME_HEADER);
+        std::size_t at = 0;
+        for (std::size_t plane = 0; const std::size_t size : plane_sizes(info))
+        {
+            const auto raw = source.subspan(at, size);
+            lz4::Compress(raw, block, lz4::Level::Fast);
+            const auto stored = block.size() < raw.size() ? std::span<const unsigned char>{ block } : raw;
+            file.write(reinterpret_cast<const char*>(stored.data()), static_cast<std::streamsize>(stored.size()));
+            write_at<std::uint32_t>(sizes, plane * sizeof(std::uint32_t), static_cast<std::uint32_t>(stored.size()));
+            at += size;
+            ++plane;
+        }
+        const auto end = file.tellp();
+        file.seekp(start);
+        file.write(reinterpret_cast<const char*>(sizes), FRAME_HEADER);
+        file.seekp(end);
+        std::swap(planes, previous);
+        info.frame_count = static_cast<std::uint32_t>(offsets.size());
+        return static_cast<bool>(file);
+    }
+
+    bool Writer::Finish()
+    {
+        if (offsets.empty())
+            return false;
+        const auto index = static_cast<std::uint64_t>(file.tellp());
+        file.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t)));
+
+        unsigned char header[HEADER_SIZE] = {};
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        write_at<std::uint32_t>(header, 4, VERSION);
+        write_at<std::uint32_t>(header, 8, static_cast<std::uint32_t>(info.width));
+        write_at<std::uint32_t>(header, 12, static_cast<std::uint32_t>(info.height));
+        write_at<std::uint32_t>(header, 16, info.frame_count);
+        write_at<std::uint32_t>(header, 20, info.rate_numerator);
+        write_at<std::uint32_t>(header, 24, info.rate_denominator);
+        write_at<std::uint32_t>(header, 28, info.keyframe_interval);
+        write_at<std::uint64_t>(header, 32, index);
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+        file.close();
+        return !file.fail();
+    }
+
+    const Info& Writer::GetInfo() const noexcept
+    {
+        return info;
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+/**
+ * Video clips for VideoPlayer: planar YUV 4:2:0 frames, each plane an LZ4 block (see lz4_block.h).
+ *
+ * texture-converter --clip writes one from a folder of PNG frames. A frame is the full-size Y plane and the
+ * half-size U and V planes, BT.601 studio range, so the GPU does the one multiply-add per pixel that makes
+ * them RGB and the CPU only ever moves a byte and a half of them. Every KEYFRAME_INTERVAL-th frame stands
+ * alone; the ones between store each plane as its difference from the previous frame's, which is mostly
+ * zeros wherever the picture holds still and compresses to almost nothing. Decoding is an LZ4 decode and,
+ * between keyframes, an add, so a frame costs a couple of milliseconds on one worker and seeking goes back
+ * to the nearest keyframe at most an interval away. Odd sizes are padded to even with the last column or row.
+ *
+ * Layout: 40 byte header, the frames, then a u64 offset per frame; each frame is the u32 stored size of its
+ * three planes and then the planes, one stored as it is when LZ4 wouldn't make it smaller.
+ * No GL here so offline tools can share it.
+ */
+namespace video_clip
+{
+    constexpr std::uint32_t DEFAULT_KEYFRAME_INTERVAL = 30;
+
+    struct Info
+    {
+        int           width             = 0; // even; the Y plane's size, the chroma planes are half of it both ways
+        int           height            = 0;
+        std::uint32_t frame_count       = 0;
+        std::uint32_t rate_numerator    = 0; // frames per second, as a fraction so 30000/1001 is exact
+        std::uint32_t rate_denominator  = 1;
+        std::uint32_t keyframe_interval = DEFAULT_KEYFRAME_INTERVAL;
+    };
+
+    // Y, then U, then V
+    std::size_t FrameBytes(const Info& info) noexcept;
+    double      FramesPerSecond(const Info& info) noexcept;
+    bool        IsKeyframe(const Info& info, std::uint32_t frame) noexcept;
+    // The frame showing `seconds` in, which may be past the last
+    std::uint64_t FrameAt(const Info& info, double seconds) noexcept;
+
+    // Checks the header and that every frame lies inside the file
+    bool Parse(std::span<const unsigned char> file, Info& out_info);
+    // `previous` is frame - 1 decoded, unused for a keyframe; false when the frame is corrupt
+    bool DecodeFrame(std::span<const unsigned char> file, const Info& info, std::uint32_t frame, std::span<const unsigned char> previous, std::span<unsigned char> out_planes) noexcept;
+
+    /**
+     * Writes a clip a frame at a time, so a long one never has to fit in memory.
+     * Each frame is RGBA8 of the size given to Open; alpha is dropped.
+     */
+    class Writer
+    {
+    public:
+        bool Open(const std::filesystem::path& filename, int width, int height, std::uint32_t rate_numerator, std::uint32_t rate_denominator,
+                  std::uint32_t keyframe_interval = DEFAULT_KEYFRAME_INTERVAL);
+        bool Add(const unsigned char* pixels);
+        // Writes the index and the frame count; the file isn't a clip until it has
+        bool Finish();
+
+        const Info& GetInfo() const noexcept;
+
+    private:
+        std::ofstream              file;
+        Info                       info;
+        int                        source_width  = 0;
+        int                        source_height = 0;
+        std::vector<std::uint64_t> offsets;
+        std::vector<unsigned char> planes;
+        std::vector<unsigned char> previous;
+        std::vector<unsigned char> delta;
+        std::vector<unsigned char> block;
+    };
+}
@@ -0,0 +1,439 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "video_player.h"
+
+#include "audio_stream.h"
+#include "gl_backend.h"
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "logger.h"
+#include "memory_tracker.h"
+#include "upload_budget.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <span>
+
+namespace
+{
+    constexpr GLuint LUMA_UNIT = 0;
+    constexpr GLuint BLUE_UNIT = 1; // Cb, the U plane
+    constexpr GLuint RED_UNIT  = 2; // Cr, the V plane
+
+    // a few frames of planes in flight to the driver
+    constexpr std::size_t RING_FRAMES = 3;
+
+    constexpr const char* FULLSCREEN_VERTEX_SHADER = R"(
+void main()
+{
+    // one triangle covering the screen: (-1,-1) (3,-1) (-1,3)
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    // BT.601 studio range; the chroma planes are half size, filtered up bilinearly
+    constexpr const char* YUV_FRAGMENT_SHADER = R"(
+uniform sampler2D uLuma;
+uniform sampler2D uBlue;
+uniform sampler2D uRed;
+
+out vec4 fragColor;
+
+void main()
+{
+    vec2  at   = gl_FragCoord.xy / vec2(textureSize(uLuma, 0));
+    float luma = (texelFetch(uLuma, ivec2(gl_FragCoord.xy), 0).r - 16.0 / 255.0) * 1.164;
+    float cb   = texture(uBlue, at).r - 0.5;
+    float cr   = texture(uRed, at).r - 0.5;
+    vec3  rgb  = vec3(luma + 1.596 * cr, luma - 0.392 * cb - 0.813 * cr, luma + 2.017 * cb);
+    fragColor  = vec4(clamp(rgb, 0.0, 1.0), 1.0);
+}
+)";
+
+    double ticks_to_ms(Uint64 ticks) noexcept
+    {
+        return static_cast<double>(ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+}
+
+VideoPlayer::~VideoPlayer()
+{
+    Close();
+}
+
+bool VideoPlayer::Open(LoadScheduler& load_scheduler, const std::filesystem::path& filename, AudioStreamer* audio_streamer)
+{
+    Close();
+    auto clip = std::make_shared<Shared>();
+    if (!clip->file.Open(filename) || !video_clip::Parse(clip->file.Bytes(), clip->info))
+    {
+        LOG_WARN("Not a video clip: ", filename);
+        return false;
+    }
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    if (clip->info.width > max_size || clip->info.height > max_size)
+    {
+        LOG_WARN("Video clip ", filename, " is bigger than GL_MAX_TEXTURE_SIZE");
+        return false;
+    }
+    info                         = clip->info;
+    const std::size_t frame_size = video_clip::FrameBytes(info);
+    for (std::vector<unsigned char>& slot : clip->slots)
+        slot.resize(frame_size);
+    shared    = std::move(clip);
+    scheduler = &load_scheduler;
+    streamer  = audio_streamer;
+    stats     = Stats{};
+
+    // the Y plane full size, U and V half of it both ways; bilinear for the chroma, which the shader scales up
+    const glm::ivec2 sizes[3] = { { info.width, info.height }, { info.width / 2, info.height / 2 }, { info.width / 2, info.height / 2 } };
+    glGenTextures(static_cast<GLsizei>(planes.size()), planes.data());
+    glGenTextures(OUTPUT_COUNT, outputs.data());
+    gl_state::ActiveTexture(0);
+    for (std::size_t i = 0; i < planes.size(); ++i)
+    {
+        gl_state::BindTexture(planes[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, sizes[i].x, sizes[i].y, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+        gpu_bytes += memory_tracker::EstimateTextureBytes(GL_R8, sizes[i].x, sizes[i].y, 1);
+    }
+    glGenFramebuffers(OUTPUT_COUNT, framebuffers.data());
+    bool is_complete = true;
+    for (int i = 0; i < OUTPUT_COUNT; ++i)
+    {
+        gl_state::BindTexture(outputs[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, info.width, info.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        gpu_bytes += memory_tracker::EstimateTextureBytes(GL_RGBA8, info.width, info.height, 1);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outputs[i], 0);
+        is_complete = is_complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    memory_tracker::Allocate(MemoryCategory::Textures, gpu_bytes);
+    if (!is_complete)
+    {
+        LOG_WARN("Can't render into the video textures");
+        Close();
+        return false;
+    }
+    glGenVertexArrays(1, &vertex_array);
+    program.Request(FULLSCREEN_VERTEX_SHADER, YUV_FRAGMENT_SHADER);
+    ring.Setup(RING_FRAMES * frame_size);
+    stats.memory_bytes = FRAME_SLOTS * frame_size + (ring.IsAvailable() ? RING_FRAMES * frame_size : 0) + gpu_bytes;
+
+    if (audio_streamer != nullptr)
+    {
+        std::error_code error;
+        if (const auto ogg = std::filesystem::path{ filename }.replace_extension(".ogg"); std::filesystem::is_regular_file(ogg, error))
+            soundtrack = audio_streamer->Open(ogg);
+    }
+    // the first frame stands in until Play
+    decodeNext();
+    return true;
+}
+
+void VideoPlayer::Close()
+{
+    if (ticket != 0)
+        scheduler->Cancel(ticket);
+    if (soundtrack != nullptr)
+        streamer->Close(soundtrack);
+    if (outputs[0] != 0)
+    {
+        gl_state::DeleteTextures(planes);
+        gl_state::DeleteTextures(outputs);
+        glDeleteFramebuffers(OUTPUT_COUNT, framebuffers.data());
+        gl_state::DeleteVertexArray(vertex_array);
+        memory_tracker::Free(MemoryCategory::Textures, gpu_bytes);
+    }
+    program.Reset();
+    ring.Shutdown();
+    // a decode still running finishes into the old buffers, which go with it
+    shared.reset();
+    soundtrack.reset();
+    scheduler    = nullptr;
+    streamer     = nullptr;
+    info         = video_clip::Info{};
+    stats        = Stats{};
+    ticket       = 0;
+    decoding     = -1;
+    reference    = -1;
+    next_frame   = 0;
+    shown        = -1;
+    wall_seconds = 0.0;
+    is_playing   = false;
+    vertex_array = 0;
+    planes       = {};
+    outputs      = {};
+    framebuffers = {};
+    current      = -1;
+    gpu_bytes    = 0;
+    ready.clear();
+}
+
+bool VideoPlayer::IsOpen() const noexcept
+{
+    return shared != nullptr;
+}
+
+void VideoPlayer::Play()
+{
+    if (!IsOpen())
+        return;
+    wall_seconds = 0.0;
+    is_playing   = true;
+    if (soundtrack != nullptr)
+        soundtrack->PlayFrom(0);
+}
+
+void VideoPlayer::Stop()
+{
+    is_playing = false;
+    if (soundtrack != nullptr)
+        soundtrack->Stop();
+}
+
+void VideoPlayer::SetLooping(bool loop) noexcept
+{
+    is_looping = loop;
+}
+
+bool VideoPlayer::IsPlaying() const noexcept
+{
+    return is_playing;
+}
+
+bool VideoPlayer::HasSoundtrack() const noexcept
+{
+    return soundtrack != nullptr;
+}
+
+void VideoPlayer::Update(double delta_seconds, UploadBudget& budget)
+{
+    if (!IsOpen())
+        return;
+    collect();
+    if (is_playing)
+    {
+        wall_seconds = soundtrack != nullptr && soundtrack->IsPlaying() ? clockSeconds() : wall_seconds + delta_seconds;
+        if (wall_seconds >= DurationSeconds())
+        {
+            if (is_looping)
+            {
+                // the clip is the loop; its soundtrack starts over with it
+                wall_seconds = std::fmod(wall_seconds, DurationSeconds());
+                if (soundtrack != nullptr)
+                    soundtrack->PlayFrom(0);
+            }
+            else
+            {
+                Stop();
+            }
+        }
+    }
+    const std::uint64_t target = std::min<std::uint64_t>(video_clip::FrameAt(info, wall_seconds), info.frame_count - 1);
+    seekIfNeeded(target);
+
+    // the newest frame that is due; the ones before it came in too late to be seen
+    if (isProgramReady())
+    {
+        int slot = -1;
+        while (!ready.empty() && ready.front().frame <= target)
+        {
+            if (slot != -1)
+                ++stats.dropped;
+            slot  = ready.front().slot;
+            shown = ready.front().frame;
+            ready.pop_front();
+        }
+        if (slot != -1)
+            show(slot, budget);
+    }
+    decodeNext();
+
+    stats.frame    = shown < 0 ? 0 : static_cast<std::uint32_t>(shown);
+    stats.ready    = static_cast<int>(ready.size());
+    stats.drift_ms = shown < 0 ? 0.0 : (wall_seconds - static_cast<double>(shown) / video_clip::FramesPerSecond(info)) * 1000.0;
+}
+
+GLuint VideoPlayer::Texture() const noexcept
+{
+    return current < 0 ? 0 : outputs[static_cast<std::size_t>(current)];
+}
+
+glm::ivec2 VideoPlayer::Size() const noexcept
+{
+    return { info.width, info.height };
+}
+
+double VideoPlayer::DurationSeconds() const noexcept
+{
+    return info.rate_numerator == 0 ? 0.0 : static_cast<double>(info.frame_count) / video_clip::FramesPerSecond(info);
+}
+
+const VideoPlayer::Stats& VideoPlayer::GetStats() const noexcept
+{
+    return stats;
+}
+
+void VideoPlayer::collect()
+{
+    std::vector<Decoded> finished;
+    {
+        std::lock_guard lock{ shared->mutex };
+        finished.swap(shared->finished);
+    }
+    for (const Decoded& decoded : finished)
+    {
+        ticket   = 0;
+        decoding = -1;
+        if (!decoded.ok)
+        {
+            // nothing after it can be decoded either, short of the next keyframe
+            LOG_WARN("Corrupt video frame ", decoded.frame);
+            ++stats.failed;
+            Stop();
+            continue;
+        }
+        ++stats.decoded;
+        stats.decode_ms = decoded.ms;
+        reference       = decoded.slot;
+        next_frame      = decoded.frame + 1;
+        ready.push_back(decoded);
+    }
+}
+
+void VideoPlayer::seekIfNeeded(std::uint64_t target)
+{
+    // a frame still decoding lands first, whatever it is
+    if (decoding != -1 || stats.failed > 0)
+        return;
+    // back past the frame on screen is a loop or a replay; a keyframe ahead of the decoder makes the frames before it not worth decoding
+    const std::uint64_t keyframe  = target - target % info.keyframe_interval;
+    const bool          went_back = shown >= 0 && static_cast<std::int64_t>(target) < shown;
+    if (!went_back && keyframe <= next_frame)
+        return;
+    ready.clear();
+    reference  = -1;
+    next_frame = static_cast<std::uint32_t>(keyframe);
+    shown      = -1;
+    ++stats.seeks;
+}
+
+void VideoPlayer::decodeNext()
+{
+    if (decoding != -1 || next_frame >= info.frame_count || stats.failed > 0 || (reference == -1 && !video_clip::IsKeyframe(info, next_frame)))
+        return;
+    // a slot nothing needs: not the reference, not waiting to be shown
+    int slot = -1;
+    for (int i = 0; i < FRAME_SLOTS && slot == -1; ++i)
+    {
+        if (i != reference && std::none_of(ready.begin(), ready.end(), [i](const Decoded& decoded) { return decoded.slot == i; }))
+            slot = i;
+    }
+    if (slot == -1)
+        return;
+
+    // the job holds the buffers, never `this`; the reference is only read, and nothing writes it until this frame is in
+    const int previous = video_clip::IsKeyframe(info, next_frame) ? -1 : reference;
+    auto      job      = [clip = shared, slot, previous, frame = next_frame]
+    {
+        const Uint64 begin = SDL_GetPerformanceCounter();
+        const auto   from  = previous < 0 ? std::span<const unsigned char>{} : std::span<const unsigned char>{ clip->slots[static_cast<std::size_t>(previous)] };
+        const bool   ok    = video_clip::DecodeFrame(clip->file.Bytes(), clip->info, frame, from, clip->slots[static_cast<std::size_t>(slot)]);
+        std::lock_guard lock{ clip->mutex };
+        clip->finished.push_back(Decoded{ slot, frame, ok, ticks_to_ms(SDL_GetPerformanceCounter() - begin) });
+    };
+    decoding = slot;
+    ticket   = scheduler->Submit(LoadPriority::Visible, std::move(job));
+}
+
+void VideoPlayer::show(int slot, UploadBudget& budget)
+{
+    const UploadBudget::Timer         timer{ budget };
+    const std::vector<unsigned char>& frame   = shared->slots[static_cast<std::size_t>(slot)];
+    std::size_t                       offset  = 0;
+    unsigned char*                    staging = ring.Reserve(frame.size(), offset);
+    const unsigned char*              source  = frame.data();
+    if (staging != nullptr)
+    {
+        std::memcpy(staging, frame.data(), frame.size());
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.Buffer());
+        source = nullptr;
+        ++stats.staged;
+    }
+
+    // the chroma rows may be an odd number of bytes
+    const std::size_t luma  = static_cast<std::size_t>(info.width) * static_cast<std::size_t>(info.height);
+    const std::size_t at[3] = { 0, luma, luma + luma / 4 };
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (std::size_t i = 0; i < planes.size(); ++i)
+    {
+        const int   width  = i == 0 ? info.width : info.width / 2;
+        const int   height = i == 0 ? info.height : info.height / 2;
+        const auto* pixels = source != nullptr ? static_cast<const void*>(source + at[i]) : reinterpret_cast<const void*>(offset + at[i]);
+        gl_backend::Get().texture_sub_image_2d(planes[i], 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (staging != nullptr)
+    {
+        ring.Fence();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    gl_stats::CountUpload(frame.size());
+    budget.Spend(frame.size());
+
+    // into the output nobody can still be drawing from
+    current = (current + 1) % OUTPUT_COUNT;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[static_cast<std::size_t>(current)]);
+    gl_state::Viewport(0, 0, info.width, info.height);
+    gl_state::SetEnabled(GL_BLEND, false);
+    gl_state::UseProgram(program.Id());
+    for (std::size_t i = 0; i < planes.size(); ++i)
+    {
+        gl_state::ActiveTexture(LUMA_UNIT + static_cast<GLuint>(i));
+        gl_state::BindTexture(planes[i]);
+    }
+    gl_state::ActiveTexture(0);
+    gl_state::BindVertexArray(vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    ++stats.shown;
+}
+
+bool VideoPlayer::isProgramReady()
+{
+    if (program.IsReady())
+        return true;
+    if (!program.Poll())
+        return false;
+    const GLuint id = program.Id();
+    gl_state::UseProgram(id);
+    glUniform1i(glGetUniformLocation(id, "uLuma"), static_cast<GLint>(LUMA_UNIT));
+    glUniform1i(glGetUniformLocation(id, "uBlue"), static_cast<GLint>(BLUE_UNIT));
+    glUniform1i(glGetUniformLocation(id, "uRed"), static_cast<GLint>(RED_UNIT));
+    return true;
+}
+
+double VideoPlayer::clockSeconds() const
+{
+    return static_cast<double>(soundtrack->PlayedFrames()) / static_cast<double>(soundtrack->SampleRate());
+}
@@ -0,0 +1,154 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "load_scheduler.h"
+#include "mapped_file.h"
+#include "pixel_upload_ring.h"
+#include "shader.h"
+#include "video_clip.h"
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class AudioStream;
+class AudioStreamer;
+class UploadBudget;
+
+/**
+ * Plays a video_clip into a texture, for an ImGui window or a sprite to show.
+ *
+ * The clip is mapped; its frames are decoded one after another on the workers through the LoadScheduler, each
+ * into one of FRAME_SLOTS CPU buffers, so memory is a few frames whatever the clip's length. Update takes the
+ * newest decoded frame that is due, drops any older one that came in too late, stages its three planes in a
+ * PixelUploadRing (client memory where there is none) and uploads them into R8 textures; a fullscreen pass turns
+ * them into RGB on the GPU, into the next of OUTPUT_COUNT RGBA8 textures so the frame the render thread may
+ * still be drawing is never written. The decoder runs up to two frames ahead of the clock. When the clock
+ * moves back, on a loop, or past a keyframe the decoder hasn't reached, it starts again at the keyframe before.
+ *
+ * A soundtrack is an OGG next to the clip with the same name; it streams through the AudioStreamer and its
+ * played frames are the clock, so the picture follows the sound and not the other way round. Without one,
+ * or while it isn't playing, the clock is Update's `delta_seconds`. Main thread, with GL current, like
+ * VirtualTexture.
+ */
+class VideoPlayer
+{
+public:
+    static constexpr int FRAME_SLOTS  = 4; // the one the next decodes from, the one decoding, two ready
+    static constexpr int OUTPUT_COUNT = 3; // the one recorded, the one queued and the one being drawn
+
+    struct Stats
+    {
+        std::uint32_t frame        = 0; // on screen
+        int           ready        = 0; // decoded ahead of it
+        std::uint64_t decoded      = 0;
+        std::uint64_t shown        = 0;
+        std::uint64_t dropped      = 0; // decoded, and late by the time they came in
+        std::uint64_t seeks        = 0; // restarts at a keyframe
+        std::uint64_t failed       = 0; // corrupt frames; playback stops at one
+        std::uint64_t staged       = 0; // frames uploaded through the ring
+        double        decode_ms    = 0.0; // the latest frame's, on its worker
+        double        drift_ms     = 0.0; // the clock ahead of the frame on screen, less than a frame when keeping up
+        std::size_t   memory_bytes = 0;   // the decoded frames, the ring and the textures
+    };
+
+    VideoPlayer() = default;
+    ~VideoPlayer();
+
+    VideoPlayer(const VideoPlayer&)                = delete;
+    VideoPlayer& operator=(const VideoPlayer&)     = delete;
+    VideoPlayer(VideoPlayer&&) noexcept            = delete;
+    VideoPlayer& operator=(VideoPlayer&&) noexcept = delete;
+
+    // Maps the clip and makes the textures, then decodes the first frame; false (and logged) when it isn't a clip.
+    // `audio_streamer`, when there is one, plays the soundtrack. Both must outlive the player.
+    bool Open(LoadScheduler& scheduler, const std::filesystem::path& filename, AudioStreamer* audio_streamer);
+    void Close();
+    bool IsOpen() const noexcept;
+
+    // From the start
+    void Play();
+    void Stop();
+    void SetLooping(bool loop) noexcept;
+    bool IsPlaying() const noexcept;
+    bool HasSoundtrack() const noexcept;
+
+    // Moves the clock on by `delta_seconds` (the soundtrack's wins while it plays), shows the frame that is due and
+    // keeps the decoder going; the upload is one of `budget`'s, never deferred since the frame is due now
+    void Update(double delta_seconds, UploadBudget& budget);
+
+    // RGBA8, the picture's top row first like a loaded image; 0 until the first frame is in
+    GLuint       Texture() const noexcept;
+    glm::ivec2   Size() const noexcept;
+    double       DurationSeconds() const noexcept;
+    const Stats& GetStats() const noexcept;
+
+private:
+    struct Decoded
+    {
+        int           slot  = -1;
+        std::uint32_t frame = 0;
+        bool          ok    = false;
+        double        ms    = 0.0;
+    };
+
+    // what the decode jobs touch, so one finishing after Close has somewhere harmless to land
+    struct Shared
+    {
+        MappedFile                                          file;
+        video_clip::Info                                    info;
+        std::array<std::vector<unsigned char>, FRAME_SLOTS> slots;
+        std::mutex                                          mutex;
+        std::vector<Decoded>                                finished;
+    };
+
+    void collect();
+    // starts the decoder again at a keyframe when the clock moved back, or past a keyframe it hasn't reached
+    void seekIfNeeded(std::uint64_t target);
+    void decodeNext();
+    void show(int slot, UploadBudget& budget);
+    bool isProgramReady();
+    double clockSeconds() const;
+
+private:
+    LoadScheduler*               scheduler = nullptr;
+    AudioStreamer*               streamer  = nullptr;
+    std::shared_ptr<AudioStream> soundtrack;
+    std::shared_ptr<Shared>      shared;
+    video_clip::Info             info;
+    Stats                        stats;
+
+    // decoding, on the main thread's side
+    LoadScheduler::Ticket ticket     = 0;
+    int                   decoding   = -1; // slot
+    int                   reference  = -1; // slot holding the frame before `next_frame`
+    std::uint32_t         next_frame = 0;
+    std::int64_t          shown      = -1;
+    std::deque<Decoded>   ready;
+
+    double wall_seconds = 0.0;
+    bool   is_playing   = false;
+    bool   is_looping   = false;
+
+    PixelUploadRing                  ring;
+    ShaderProgram                    program;
+    GLuint                           vertex_array = 0;
+    std::array<GLuint, 3>            planes{};
+    std::array<GLuint, OUTPUT_COUNT> outputs{};
+    std::array<GLuint, OUTPUT_COUNT> framebuffers{};
+    int                              current   = -1; // output on screen
+    std::size_t                      gpu_bytes = 0;
+};
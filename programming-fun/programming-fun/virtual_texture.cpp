@@ -0,0 +1,520 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "virtual_texture.h"
+
+#include "gl_state.h"
+#include "gl_stats.h"
+#include "memory_tracker.h"
+#include "upload_budget.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+    // the frames in flight and the one being recorded; a page drawn since then isn't overwritten
+    constexpr std::uint64_t RETIRE_UPDATES = 4;
+    // tiles this far outside the view are read ahead of a pan
+    constexpr int PREFETCH_TILES = 1;
+    // what a sparse texture commits per tile, its borders dropped
+    constexpr std::size_t TILE_BYTES = static_cast<std::size_t>(tiled_image::TILE_SIZE) * tiled_image::TILE_SIZE * 4;
+
+    int tile_level(std::uint64_t key) noexcept
+    {
+        return static_cast<int>(key >> 48);
+    }
+
+    glm::ivec2 tile_position(std::uint64_t key) noexcept
+    {
+        return glm::ivec2{ static_cast<int>(key & 0xFFFFFF), static_cast<int>((key >> 24) & 0xFFFFFF) };
+    }
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    Close();
+}
+
+bool VirtualTexture::Open(LoadScheduler& load_scheduler, const std::filesystem::path& filename, int page_count, bool allow_sparse)
+{
+    Close();
+    if (!tiled_image::ReadInfo(filename, info))
+        return false;
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    scheduler   = &load_scheduler;
+    path        = filename;
+    cache_pages = std::clamp(page_count, 2, std::max(2, max_size / tiled_image::PAGE_SIZE));
+    completed   = std::make_shared<CompletionQueue>();
+    pages.assign(static_cast<std::size_t>(cache_pages) * static_cast<std::size_t>(cache_pages), Page{});
+    stats = Stats{};
+    if (!allow_sparse || !makeSparse())
+        makeAtlas();
+    stats.sparse = sparse;
+
+    // what every other tile falls back to until its own is in
+    request(LevelCount() - 1, 0, 0, LoadPriority::Immediate);
+    return true;
+}
+
+void VirtualTexture::makeAtlas()
+{
+    const int size = cache_pages * tiled_image::PAGE_SIZE;
+    glGenTextures(1, &cache_texture);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(cache_texture);
+    // pages are drawn at about a texel per pixel, so no mips; the borders keep linear filtering inside a page
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    cache_size        = glm::ivec2{ size };
+    sparse            = false;
+    stats.cache_bytes = memory_tracker::EstimateTextureBytes(GL_RGBA8, size, size, 1);
+    memory_tracker::Allocate(MemoryCategory::Textures, stats.cache_bytes);
+}
+
+bool VirtualTexture::makeSparse()
+{
+    if (!GLEW_ARB_sparse_texture || !(GLEW_VERSION_4_2 || (GLEW_ARB_texture_storage && GLEW_ARB_internalformat_query)))
+        return false;
+
+    // level 0 at the origin and the others down a column to its right, each starting on a tile
+    const auto& levels = info.levels;
+    int         column = 0;
+    level_origins.assign(1, glm::ivec2{ 0 });
+    for (std::size_t i = 1; i < levels.size(); ++i)
+    {
+        level_origins.emplace_back(levels[0].tiles_x * tiled_image::TILE_SIZE, column);
+        column += levels[i].tiles_y * tiled_image::TILE_SIZE;
+    }
+    const glm::ivec2 size{ (levels[0].tiles_x + (levels.size() > 1 ? levels[1].tiles_x : 0)) * tiled_image::TILE_SIZE, std::max(levels[0].tiles_y * tiled_image::TILE_SIZE, column) };
+    GLint            max_size = 0;
+    glGetIntegerv(GL_MAX_SPARSE_TEXTURE_SIZE_ARB, &max_size);
+    if (size.x > max_size || size.y > max_size)
+    {
+        level_origins.clear();
+        return false;
+    }
+
+    // a virtual page size a tile is made of whole, so tiles commit one by one
+    GLint size_count = 0;
+    glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_NUM_VIRTUAL_PAGE_SIZES_ARB, 1, &size_count);
+    std::vector<GLint> page_x(static_cast<std::size_t>(std::max(size_count, 0)));
+    std::vector<GLint> page_y(page_x.size());
+    if (size_count > 0)
+    {
+        glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_VIRTUAL_PAGE_SIZE_X_ARB, size_count, page_x.data());
+        glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_VIRTUAL_PAGE_SIZE_Y_ARB, size_count, page_y.data());
+    }
+    int fits = -1;
+    for (std::size_t i = 0; i < page_x.size() && fits < 0; ++i)
+    {
+        if (page_x[i] > 0 && page_y[i] > 0 && tiled_image::TILE_SIZE % page_x[i] == 0 && tiled_image::TILE_SIZE % page_y[i] == 0)
+            fits = static_cast<int>(i);
+    }
+    if (fits < 0)
+    {
+        level_origins.clear();
+        return false;
+    }
+
+    glGenTextures(1, &cache_texture);
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(cache_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+    glTexParameteri(GL_TEXTURE_2D, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, fits);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, size.x, size.y);
+    cache_size = size;
+    sparse     = true;
+    return true;
+}
+
+void VirtualTexture::Close()
+{
+    if (scheduler != nullptr)
+    {
+        for (const auto& [tile, ticket] : loading)
+            scheduler->Cancel(ticket);
+    }
+    if (cache_texture != 0)
+    {
+        glDeleteTextures(1, &cache_texture);
+        memory_tracker::Free(MemoryCategory::Textures, stats.cache_bytes);
+    }
+    // reads still running finish into the old queue, which goes with them
+    completed.reset();
+    scheduler     = nullptr;
+    cache_texture = 0;
+    cache_pages   = 0;
+    cache_size    = glm::ivec2{ 0 };
+    sparse        = false;
+    level         = 0;
+    info          = tiled_image::Info{};
+    stats         = Stats{};
+    pages.clear();
+    resident.clear();
+    loading.clear();
+    pending_uploads.clear();
+    wanted.clear();
+    nearby.clear();
+    keep.clear();
+    sprites.clear();
+    level_origins.clear();
+    to_commit.clear();
+    to_decommit.clear();
+    placed.clear();
+}
+
+bool VirtualTexture::IsOpen() const noexcept
+{
+    return cache_texture != 0;
+}
+
+void VirtualTexture::Update(const Aabb2& view, float pixels_per_texel, UploadBudget& budget)
+{
+    if (!IsOpen())
+        return;
+    ++update_count;
+    stats.uploaded = 0;
+    stats.commits  = 0;
+    {
+        std::lock_guard lock{ completed->mutex };
+        for (auto& load : completed->finished)
+            pending_uploads.push_back(std::move(load));
+        completed->finished.clear();
+    }
+
+    // the level nearest a texel per pixel, in log terms
+    const int   top              = LevelCount() - 1;
+    const float texels_per_pixel = 1.0f / std::max(pixels_per_texel, 1e-6f);
+    level                        = std::clamp(static_cast<int>(std::floor(std::log2(texels_per_pixel) + 0.5f)), 0, top);
+
+    const tiled_image::Level& entry       = info.levels[static_cast<std::size_t>(level)];
+    const float               tile_texels = static_cast<float>(tiled_image::TILE_SIZE) * std::exp2(static_cast<float>(level));
+    const glm::ivec2          tiles{ entry.tiles_x, entry.tiles_y };
+    const glm::ivec2          first = glm::max(glm::ivec2{ glm::floor(view.min / tile_texels) }, glm::ivec2{ 0 });
+    const glm::ivec2          last  = glm::min(glm::ivec2{ glm::floor(view.max / tile_texels) }, tiles - 1);
+    wanted.clear();
+    nearby.clear();
+    keep.clear();
+    keep.insert(tileKey(top, 0, 0));
+    for (int y = first.y; y <= last.y; ++y)
+    {
+        for (int x = first.x; x <= last.x; ++x)
+        {
+            wanted.emplace_back(x, y);
+            keep.insert(tileKey(level, x, y));
+        }
+    }
+    if (!wanted.empty())
+    {
+        const glm::ivec2 near_first = glm::max(first - PREFETCH_TILES, glm::ivec2{ 0 });
+        const glm::ivec2 near_last  = glm::min(last + PREFETCH_TILES, tiles - 1);
+        for (int y = near_first.y; y <= near_last.y; ++y)
+        {
+            for (int x = near_first.x; x <= near_last.x; ++x)
+            {
+                if (x < first.x || x > last.x || y < first.y || y > last.y)
+                {
+                    nearby.emplace_back(x, y);
+                    keep.insert(tileKey(level, x, y));
+                }
+            }
+        }
+    }
+    // the middle of the view first, where the eye is
+    const glm::vec2 center   = (view.min + view.max) * 0.5f / tile_texels;
+    const auto      distance = [center](glm::ivec2 tile)
+    {
+        const glm::vec2 offset = glm::vec2{ tile } + 0.5f - center;
+        return glm::dot(offset, offset);
+    };
+    std::sort(wanted.begin(), wanted.end(), [&distance](glm::ivec2 a, glm::ivec2 b) { return distance(a) < distance(b); });
+    std::sort(nearby.begin(), nearby.end(), [&distance](glm::ivec2 a, glm::ivec2 b) { return distance(a) < distance(b); });
+
+    // whatever the view draws from stays, its own page or the ancestor standing in for it
+    int ancestor = 0;
+    for (const glm::ivec2 tile : wanted)
+    {
+        if (const int page = pageFor(level, tile.x, tile.y, ancestor); page >= 0)
+            pages[static_cast<std::size_t>(page)].last_used = update_count;
+    }
+    for (const glm::ivec2 tile : nearby)
+    {
+        if (const auto found = resident.find(tileKey(level, tile.x, tile.y)); found != resident.end())
+            pages[static_cast<std::size_t>(found->second)].last_used = update_count;
+    }
+
+    // reads still queued for tiles the view left
+    for (auto load = loading.begin(); load != loading.end();)
+    {
+        if (!keep.contains(load->first) && scheduler->Cancel(load->second))
+        {
+            ++stats.cancelled;
+            load = loading.erase(load);
+        }
+        else
+        {
+            ++load;
+        }
+    }
+
+    {
+        const UploadBudget::Timer timer{ budget };
+        for (int i = 0; !pending_uploads.empty() && (i == 0 || budget.HasRoom()); ++i)
+        {
+            std::shared_ptr<Load> load = std::move(pending_uploads.front());
+            pending_uploads.pop_front();
+            loading.erase(load->tile);
+            budget.Spend(load->pixels.size());
+            if (const int page = place(*load); page >= 0)
+                placed.emplace_back(std::move(load), page);
+        }
+        // the whole frame's commitment changes in one go, then the copies into them
+        commitPages();
+        for (const auto& [load, page] : placed)
+            copy(*load, page);
+        placed.clear();
+    }
+    budget.Defer(pending_uploads.size() * tiled_image::PAGE_BYTES);
+    buildSprites();
+
+    for (const glm::ivec2 tile : wanted)
+        request(level, tile.x, tile.y, LoadPriority::Visible);
+    for (const glm::ivec2 tile : nearby)
+        request(level, tile.x, tile.y, LoadPriority::Prefetch);
+
+    stats.level    = level;
+    stats.wanted   = static_cast<int>(wanted.size());
+    stats.resident = static_cast<int>(resident.size());
+    stats.loading  = static_cast<int>(loading.size());
+}
+
+std::span<const SpriteInstance> VirtualTexture::Sprites() const noexcept
+{
+    return sprites;
+}
+
+GLuint VirtualTexture::CacheTexture() const noexcept
+{
+    return cache_texture;
+}
+
+glm::ivec2 VirtualTexture::Size() const noexcept
+{
+    return glm::ivec2{ info.width, info.height };
+}
+
+int VirtualTexture::LevelCount() const noexcept
+{
+    return static_cast<int>(info.levels.size());
+}
+
+const VirtualTexture::Stats& VirtualTexture::GetStats() const noexcept
+{
+    return stats;
+}
+
+std::uint64_t VirtualTexture::tileKey(int tile_level, int x, int y) noexcept
+{
+    return (static_cast<std::uint64_t>(tile_level) << 48) | (static_cast<std::uint64_t>(y) << 24) | static_cast<std::uint64_t>(x);
+}
+
+int VirtualTexture::pageFor(int tile_level, int x, int y, int& out_ancestor_level) const
+{
+    for (int candidate = tile_level; candidate < LevelCount(); ++candidate)
+    {
+        const int shift = candidate - tile_level;
+        if (const auto found = resident.find(tileKey(candidate, x >> shift, y >> shift)); found != resident.end())
+        {
+            out_ancestor_level = candidate;
+            return found->second;
+        }
+    }
+    return -1;
+}
+
+void VirtualTexture::request(int tile_level, int x, int y, LoadPriority priority)
+{
+    const std::uint64_t key = tileKey(tile_level, x, y);
+    if (resident.contains(key) || loading.contains(key) || loading.size() >= static_cast<std::size_t>(MAX_LOADS))
+        return;
+    auto load  = std::make_shared<Load>();
+    load->tile = key;
+
+    // the job holds the queue and its own copy of the path, never `this`
+    const std::uint64_t offset = tiled_image::PageOffset(info, tile_level, x, y);
+    loading.emplace(key, scheduler->Submit(priority,
+                                           [load, queue = completed, file = path, offset]
+                                           {
+                                               std::ifstream in{ file, std::ios::binary };
+                                               load->pixels.resize(tiled_image::PAGE_BYTES);
+                                               load->ok = in.seekg(static_cast<std::streamoff>(offset)) &&
+                                                          in.read(reinterpret_cast<char*>(load->pixels.data()), static_cast<std::streamsize>(load->pixels.size()));
+                                               std::lock_guard lock{ queue->mutex };
+                                               queue->finished.push_back(load);
+                                           }));
+}
+
+glm::ivec2 VirtualTexture::corner(int page) const
+{
+    if (sparse)
+    {
+        const std::uint64_t tile = pages[static_cast<std::size_t>(page)].tile;
+        return level_origins[static_cast<std::size_t>(tile_level(tile))] + tile_position(tile) * tiled_image::TILE_SIZE;
+    }
+    return glm::ivec2{ (page % cache_pages) * tiled_image::PAGE_SIZE + tiled_image::BORDER, (page / cache_pages) * tiled_image::PAGE_SIZE + tiled_image::BORDER };
+}
+
+int VirtualTexture::place(const Load& load)
+{
+    if (!load.ok)
+    {
+        ++stats.failed;
+        return -1;
+    }
+    if (resident.contains(load.tile))
+        return -1;
+
+    // an empty slot, or the one longest out of view; frames in flight may still draw the recent ones
+    int           chosen = -1;
+    std::uint64_t oldest = NO_TILE;
+    for (std::size_t i = 0; i < pages.size(); ++i)
+    {
+        const Page& page = pages[i];
+        if (page.tile == NO_TILE)
+        {
+            chosen = static_cast<int>(i);
+            break;
+        }
+        if (!page.pinned && page.last_used + RETIRE_UPDATES <= update_count && page.last_used < oldest)
+        {
+            chosen = static_cast<int>(i);
+            oldest = page.last_used;
+        }
+    }
+    // every slot is in view; the tile goes on drawing from its ancestor
+    if (chosen < 0)
+        return -1;
+
+    Page& page = pages[static_cast<std::size_t>(chosen)];
+    if (page.tile != NO_TILE)
+    {
+        resident.erase(page.tile);
+        ++stats.evicted;
+        if (sparse)
+            to_decommit.push_back(page.tile);
+    }
+    if (sparse)
+        to_commit.push_back(load.tile);
+    page.tile      = load.tile;
+    page.last_used = update_count;
+    page.pinned    = load.tile == tileKey(LevelCount() - 1, 0, 0);
+    resident.emplace(load.tile, chosen);
+    return chosen;
+}
+
+void VirtualTexture::commitPages()
+{
+    if (to_commit.empty() && to_decommit.empty())
+        return;
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(cache_texture);
+    // sorted by level, row and column, so a run of neighbours in a row is one region; freed pages go first
+    const auto apply = [this](std::vector<std::uint64_t>& tiles, GLboolean commit)
+    {
+        std::sort(tiles.begin(), tiles.end());
+        for (std::size_t first = 0; first < tiles.size();)
+        {
+            std::size_t last = first;
+            while (last + 1 < tiles.size() && tiles[last + 1] == tiles[last] + 1)
+                ++last;
+            const glm::ivec2 origin = level_origins[static_cast<std::size_t>(tile_level(tiles[first]))] + tile_position(tiles[first]) * tiled_image::TILE_SIZE;
+            const auto       count  = static_cast<int>(last - first + 1);
+            glTexPageCommitmentARB(GL_TEXTURE_2D, 0, origin.x, origin.y, 0, count * tiled_image::TILE_SIZE, tiled_image::TILE_SIZE, 1, commit);
+            ++stats.commits;
+            first = last + 1;
+        }
+    };
+    apply(to_decommit, GL_FALSE);
+    apply(to_commit, GL_TRUE);
+
+    const std::size_t freed = to_decommit.size() * TILE_BYTES;
+    const std::size_t taken = to_commit.size() * TILE_BYTES;
+    memory_tracker::Free(MemoryCategory::Textures, freed);
+    memory_tracker::Allocate(MemoryCategory::Textures, taken);
+    stats.cache_bytes = stats.cache_bytes + taken - freed;
+    to_decommit.clear();
+    to_commit.clear();
+}
+
+void VirtualTexture::copy(const Load& load, int page)
+{
+    // a sparse texture takes the tile without its borders, read out of the middle of the page
+    const glm::ivec2 at   = sparse ? corner(page) : corner(page) - tiled_image::BORDER;
+    const int        size = sparse ? tiled_image::TILE_SIZE : tiled_image::PAGE_SIZE;
+    gl_state::ActiveTexture(0);
+    gl_state::BindTexture(cache_texture);
+    if (sparse)
+    {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, tiled_image::PAGE_SIZE);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, tiled_image::BORDER);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, tiled_image::BORDER);
+    }
+    glTexSubImage2D(GL_TEXTURE_2D, 0, at.x, at.y, size, size, GL_RGBA, GL_UNSIGNED_BYTE, load.pixels.data());
+    if (sparse)
+    {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    }
+    gl_stats::CountUpload(static_cast<std::size_t>(size) * static_cast<std::size_t>(size) * 4);
+    ++stats.uploaded;
+}
+
+void VirtualTexture::buildSprites()
+{
+    sprites.clear();
+    stats.fallbacks = 0;
+    const tiled_image::Level& entry     = info.levels[static_cast<std::size_t>(level)];
+    const glm::vec2           texels    = glm::vec2{ cache_size };
+    const float               scale     = std::exp2(static_cast<float>(level)); // this level's texels in level 0's
+    const auto                tile_size = static_cast<float>(tiled_image::TILE_SIZE);
+    for (const glm::ivec2 tile : wanted)
+    {
+        int       ancestor = level;
+        const int page     = pageFor(level, tile.x, tile.y, ancestor);
+        if (page < 0)
+            continue;
+        if (ancestor != level)
+            ++stats.fallbacks;
+
+        // the tile's own texels, short along the right and bottom edges
+        const glm::vec2 extent{ static_cast<float>(std::min(tiled_image::TILE_SIZE, entry.width - tile.x * tiled_image::TILE_SIZE)),
+                                static_cast<float>(std::min(tiled_image::TILE_SIZE, entry.height - tile.y * tiled_image::TILE_SIZE)) };
+        // all of its own page, or the corner of an ancestor's that covers it
+        const int        shift = ancestor - level;
+        const float      part  = 1.0f / static_cast<float>(1 << shift);
+        const glm::ivec2 within{ tile.x & ((1 << shift) - 1), tile.y & ((1 << shift) - 1) };
+        const glm::vec2  uv_min = (glm::vec2{ corner(page) } + glm::vec2{ within } * tile_size * part) / texels;
+        const glm::vec2  uv_max = uv_min + extent * part / texels;
+
+        SpriteInstance sprite;
+        sprite.size     = extent * scale;
+        sprite.position = glm::vec2{ tile } * tile_size * scale + sprite.size * 0.5f;
+        sprite.uv_rect  = glm::vec4{ uv_min, uv_max };
+        sprites.push_back(sprite);
+    }
+}
@@ -0,0 +1,161 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "load_scheduler.h"
+#include "math_kernels.h"
+#include "sprite_batch.h"
+#include "tiled_image.h"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class UploadBudget;
+
+/**
+ * A tiled image of any size drawn from a fixed-size cache of its tiles, read in as the view needs them.
+ *
+ * Update works out the pyramid level whose texels come closest to one per screen pixel and the tiles of it
+ * the view covers; that list is the feedback the loads follow. Missing tiles are read on the workers through
+ * the LoadScheduler, nearest the middle of the view first, with the ring just outside the view as prefetch,
+ * and queued reads the view moved away from are cancelled. Finished pages are copied into a slot of one
+ * cache texture as the frame's UploadBudget allows, taking the least recently wanted slot once it is full, so VRAM is the cache however big the
+ * image is, and no more than MAX_LOADS pages are ever off disk at once. A tile that isn't in yet is drawn from
+ * the part of its nearest resident ancestor that covers it; the single tile at the top of the pyramid loads
+ * first and is never evicted, so there is always one.
+ *
+ * With GL_ARB_sparse_texture, a virtual page size that divides TILE_SIZE, and an image whose pyramid fits
+ * GL_MAX_SPARSE_TEXTURE_SIZE_ARB, the cache is a sparse texture instead: every tile has its own place in it
+ * (level 0 at the origin, the rest stacked in a column to its right) and only the tiles resident are committed,
+ * the same cache_pages squared of them. Evictions and new tiles become one batch of decommits, then commits,
+ * per Update, with adjacent tiles of a row merged into one glTexPageCommitmentARB, before any page is copied
+ * in. Neighbouring tiles sit side by side there, so the borders are dropped; filtering at the edge of a tile
+ * whose neighbour isn't committed reads whatever the driver gives unbacked memory.
+ *
+ * The image lies in level 0 texels from (0, 0), y down. Sprites gives a quad per tile in those units, all
+ * sampling CacheTexture, for the caller to place. Main thread, with GL current, like Tilemap.
+ */
+class VirtualTexture
+{
+public:
+    static constexpr int DEFAULT_CACHE_PAGES = 24; // on a side: 3120 x 3120 RGBA8, 37 MB
+    static constexpr int MAX_LOADS           = 32; // pages being read or waiting to upload
+
+    struct Stats
+    {
+        int           level       = 0;
+        int           wanted      = 0; // tiles of `level` in view
+        int           fallbacks   = 0; // of those, drawn from a coarser tile
+        int           resident    = 0; // cache slots in use
+        int           loading     = 0;
+        int           uploaded    = 0; // by the latest Update
+        std::uint64_t evicted     = 0;
+        std::uint64_t cancelled   = 0;
+        std::uint64_t failed      = 0;     // reads that came back short
+        std::size_t   cache_bytes = 0;     // with `sparse`, only what is committed
+        bool          sparse      = false; // pages committed in a sparse texture rather than copied into an atlas's slots
+        int           commits     = 0;     // glTexPageCommitmentARB calls by the latest Update, decommits included
+    };
+
+    VirtualTexture() = default;
+    ~VirtualTexture();
+
+    VirtualTexture(const VirtualTexture&)                = delete;
+    VirtualTexture& operator=(const VirtualTexture&)     = delete;
+    VirtualTexture(VirtualTexture&&) noexcept            = delete;
+    VirtualTexture& operator=(VirtualTexture&&) noexcept = delete;
+
+    // Reads the header and makes the cache, sparse when `allow_sparse` and the driver can; false when `filename` isn't a tiled image.
+    // The scheduler must outlive the texture.
+    bool Open(LoadScheduler& scheduler, const std::filesystem::path& filename, int cache_pages = DEFAULT_CACHE_PAGES, bool allow_sparse = true);
+    void Close();
+    bool IsOpen() const noexcept;
+
+    // `view` in level 0 texels, and how many screen pixels one of them covers; each page uploaded is one glTexSubImage2D out of `budget`
+    void                            Update(const Aabb2& view, float pixels_per_texel, UploadBudget& budget);
+    std::span<const SpriteInstance> Sprites() const noexcept;
+    GLuint                          CacheTexture() const noexcept;
+    glm::ivec2                      Size() const noexcept;
+    int                             LevelCount() const noexcept;
+    const Stats&                    GetStats() const noexcept;
+
+private:
+    static constexpr std::uint64_t NO_TILE = ~std::uint64_t{ 0 };
+
+    struct Page
+    {
+        std::uint64_t tile      = NO_TILE;
+        std::uint64_t last_used = 0; // Update count when a view last drew from it
+        bool          pinned    = false;
+    };
+
+    struct Load
+    {
+        std::uint64_t              tile = NO_TILE;
+        std::vector<unsigned char> pixels;
+        bool                       ok = false;
+    };
+
+    struct CompletionQueue
+    {
+        std::mutex                         mutex;
+        std::vector<std::shared_ptr<Load>> finished;
+    };
+
+    static std::uint64_t tileKey(int level, int x, int y) noexcept;
+
+    void makeAtlas();
+    bool makeSparse(); // false when the driver can't hold this image sparse
+    // the page drawn for tile (x, y) of `level`: its own, or the nearest resident ancestor's; -1 for none
+    int  pageFor(int level, int x, int y, int& out_ancestor_level) const;
+    // where the tile in `page` starts in the cache texture, past its border in an atlas
+    glm::ivec2 corner(int page) const;
+    void       request(int level, int x, int y, LoadPriority priority);
+    // a page for the load's tile, evicting one if need be; -1 when every page is still in use
+    int  place(const Load& load);
+    void commitPages();
+    void copy(const Load& load, int page);
+    void buildSprites();
+
+private:
+    LoadScheduler*        scheduler = nullptr;
+    std::filesystem::path path;
+    tiled_image::Info     info;
+    GLuint                cache_texture = 0;
+    int                   cache_pages   = 0; // slots on a side
+    glm::ivec2            cache_size{ 0 };
+    bool                  sparse = false;
+    int                   level  = 0;
+    std::uint64_t         update_count  = 0;
+    Stats                 stats;
+
+    std::vector<Page>                                        pages;
+    std::unordered_map<std::uint64_t, int>                   resident; // tile key to page
+    std::unordered_map<std::uint64_t, LoadScheduler::Ticket> loading;
+    std::shared_ptr<CompletionQueue>                         completed;
+    std::deque<std::shared_ptr<Load>>                        pending_uploads;
+    std::vector<glm::ivec2>                                  wanted; // tiles of `level` in view, nearest the middle first
+    std::vector<glm::ivec2>                                  nearby; // the prefetch ring just outside them
+    std::unordered_set<std::uint64_t>                        keep;   // wanted, plus the prefetch ring and the pinned tile
+    std::vector<SpriteInstance>                              sprites;
+    std::vector<glm::ivec2>                                  level_origins; // each level's top left in the sparse texture
+    std::vector<std::uint64_t>                               to_commit;     // the latest Update's batch, applied by commitPages
+    std::vector<std::uint64_t>                               to_decommit;
+    std::vector<std::pair<std::shared_ptr<Load>, int>>       placed; // this Update's uploads and their pages, copied once committed
+};
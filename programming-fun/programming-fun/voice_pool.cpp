@@ -0,0 +1,335 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "voice_pool.h"
+
+#include <algorithm>
+#include <alc.h>
+#include <cfloat>
+#include <efx.h>
+#include <iostream>
+#include <span>
+
+namespace
+{
+    // ALC_EXT_EFX's filter objects, through alGetProcAddress like AudioEffects' effects
+    LPALGENFILTERS    gen_filters    = nullptr;
+    LPALDELETEFILTERS delete_filters = nullptr;
+    LPALFILTERI       filter_i       = nullptr;
+    LPALFILTERF       filter_f       = nullptr;
+
+    bool load_filter_functions()
+    {
+        gen_filters    = reinterpret_cast<LPALGENFILTERS>(alGetProcAddress("alGenFilters"));
+        delete_filters = reinterpret_cast<LPALDELETEFILTERS>(alGetProcAddress("alDeleteFilters"));
+        filter_i       = reinterpret_cast<LPALFILTERI>(alGetProcAddress("alFilteri"));
+        filter_f       = reinterpret_cast<LPALFILTERF>(alGetProcAddress("alFilterf"));
+        return gen_filters != nullptr && delete_filters != nullptr && filter_i != nullptr && filter_f != nullptr;
+    }
+}
+
+VoicePool::~VoicePool()
+{
+    Shutdown();
+}
+
+void VoicePool::Setup(int max_voices)
+{
+    Shutdown();
+    if (max_voices <= 0)
+    {
+        ALCint      device_sources = 0;
+        ALCcontext* context        = alcGetCurrentContext();
+        if (ALCdevice* device = context != nullptr ? alcGetContextsDevice(context) : nullptr; device != nullptr)
+            alcGetIntegerv(device, ALC_MONO_SOURCES, 1, &device_sources);
+        max_voices = device_sources > 0 ? device_sources - RESERVED_SOURCES : MAX_VOICES;
+    }
+    max_voices = std::clamp(max_voices, 1, MAX_VOICES);
+    // silent from max_distance on, so whoever culls by that distance cuts nothing audible
+    alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
+
+    // the device count is a hint, so stop at the first source the implementation refuses
+    alGetError();
+    idle_sources.reserve(static_cast<std::size_t>(max_voices));
+    for (int i = 0; i < max_voices; ++i)
+    {
+        ALuint source = 0;
+        alGenSources(1, &source);
+        if (alGetError() != AL_NO_ERROR)
+            break;
+        idle_sources.push_back(source);
+    }
+    voices.SetCapacity(static_cast<std::uint32_t>(idle_sources.size()));
+    std::cout << "Voice pool: " << idle_sources.size() << " sources\n";
+
+    // one filter for every voice: a source copies the filter's parameters when it is attached
+    ALCcontext* context = alcGetCurrentContext();
+    ALCdevice*  device  = context != nullptr ? alcGetContextsDevice(context) : nullptr;
+    if (device != nullptr && alcIsExtensionPresent(device, ALC_EXT_EFX_NAME) == ALC_TRUE && load_filter_functions())
+    {
+        alGetError();
+        gen_filters(1, &lowpass);
+        filter_i(lowpass, AL_FILTER_TYPE, AL_FILTER_LOWPASS);
+        if (alGetError() != AL_NO_ERROR)
+        {
+            delete_filters(1, &lowpass);
+            lowpass = 0;
+        }
+    }
+}
+
+void VoicePool::Shutdown()
+{
+    for (const Voice& voice : voices.Items())
+    {
+        alSourceStop(voice.source);
+        alSourcei(voice.source, AL_BUFFER, 0);
+        idle_sources.push_back(voice.source);
+    }
+    voices.Clear();
+    voices.SetCapacity(0);
+    for (ALuint source : idle_sources)
+        alDeleteSources(1, &source);
+    idle_sources.clear();
+    active_sends = 0;
+    if (lowpass != 0)
+        delete_filters(1, &lowpass);
+    lowpass = 0;
+}
+
+VoiceId VoicePool::Play(ALuint buffer, const VoiceParams& params)
+{
+    if (voices.Capacity() == 0)
+        return {};
+    if (idle_sources.empty())
+        reclaimStopped();
+
+    ALuint source      = 0;
+    ALuint effect_slot = 0;     // what the source is routed to now, which route compares against
+    bool   filtered    = false; // the stolen voice's low-pass, still on the source
+    if (!idle_sources.empty())
+    {
+        source = idle_sources.back();
+        idle_sources.pop_back();
+    }
+    else
+    {
+        const VoiceId victim = pickVictim(params.priority);
+        if (!victim.IsValid())
+            return {};
+        const Voice& stolen = *voices.Get(victim);
+        source              = stolen.source;
+        effect_slot         = stolen.effect_slot;
+        filtered            = stolen.filtered;
+        alSourceStop(source);
+        voices.Erase(victim);
+        ++steals_this_window;
+    }
+
+    const VoiceId id    = voices.Insert(Voice{ source, ++play_count, params.gain, params.priority, effect_slot });
+    Voice&        voice = *voices.Get(id);
+
+    alSourcei(voice.source, AL_BUFFER, static_cast<ALint>(buffer));
+    alSourcef(voice.source, AL_GAIN, params.gain);
+    alSourcef(voice.source, AL_PITCH, params.pitch);
+    alSourcei(voice.source, AL_LOOPING, params.looping ? AL_TRUE : AL_FALSE);
+    route(voice, params.effect_slot);
+    if (filtered)
+        alSourcei(voice.source, AL_DIRECT_FILTER, AL_FILTER_NULL);
+    // a recycled source may have been positional, so both kinds set everything
+    const bool positional = params.max_distance > 0.0f;
+    alSourcei(voice.source, AL_SOURCE_RELATIVE, positional ? AL_FALSE : AL_TRUE);
+    alSource3f(voice.source, AL_POSITION, positional ? params.position.x : 0.0f, positional ? params.position.y : 0.0f, positional ? params.position.z : 0.0f);
+    alSourcef(voice.source, AL_REFERENCE_DISTANCE, params.reference_distance);
+    alSourcef(voice.source, AL_MAX_DISTANCE, positional ? params.max_distance : FLT_MAX);
+    // taken by the play below; a stopped source otherwise starts from the top
+    if (params.offset_seconds > 0.0f)
+        alSourcef(voice.source, AL_SEC_OFFSET, params.offset_seconds);
+    alSourcePlay(voice.source);
+    return id;
+}
+
+void VoicePool::Stop(VoiceId voice)
+{
+    if (!IsPlaying(voice))
+        return;
+    alSourceStop(voices.Get(voice)->source);
+    release(voice);
+}
+
+void VoicePool::Place(VoiceId voice, const glm::vec3& position)
+{
+    if (const Voice* slot = voices.Get(voice); slot != nullptr)
+        alSource3f(slot->source, AL_POSITION, position.x, position.y, position.z);
+}
+
+void VoicePool::SetGain(VoiceId voice, float gain)
+{
+    Voice* slot = voices.Get(voice);
+    if (slot == nullptr)
+        return;
+    slot->gain = gain;
+    alSourcef(slot->source, AL_GAIN, gain);
+}
+
+void VoicePool::SetLowPass(VoiceId voice, float gain, float gain_hf)
+{
+    Voice* slot = voices.Get(voice);
+    if (slot == nullptr || lowpass == 0)
+        return;
+    const bool is_filtered = gain < 1.0f || gain_hf < 1.0f;
+    if (!is_filtered && !slot->filtered)
+        return;
+    if (is_filtered)
+    {
+        filter_f(lowpass, AL_LOWPASS_GAIN, std::clamp(gain, 0.0f, 1.0f));
+        filter_f(lowpass, AL_LOWPASS_GAINHF, std::clamp(gain_hf, 0.0f, 1.0f));
+    }
+    alSourcei(slot->source, AL_DIRECT_FILTER, is_filtered ? static_cast<ALint>(lowpass) : AL_FILTER_NULL);
+    slot->filtered = is_filtered;
+}
+
+bool VoicePool::HasLowPass() const noexcept
+{
+    return lowpass != 0;
+}
+
+bool VoicePool::IsCurrent(VoiceId voice) const noexcept
+{
+    return voices.Contains(voice);
+}
+
+bool VoicePool::IsPlaying(VoiceId voice) const
+{
+    const Voice* slot = voices.Get(voice);
+    if (slot == nullptr)
+        return false;
+    ALint state = AL_STOPPED;
+    alGetSourcei(slot->source, AL_SOURCE_STATE, &state);
+    return state == AL_PLAYING || state == AL_PAUSED;
+}
+
+float VoicePool::PlaybackSeconds(VoiceId voice) const
+{
+    if (!IsPlaying(voice))
+        return -1.0f;
+    ALfloat seconds = 0.0f;
+    alGetSourcef(voices.Get(voice)->source, AL_SEC_OFFSET, &seconds);
+    return seconds;
+}
+
+void VoicePool::Update(float delta_seconds)
+{
+    reclaimStopped();
+    window_seconds += delta_seconds;
+    if (window_seconds >= 1.0f)
+    {
+        steals_per_second  = static_cast<int>(static_cast<float>(steals_this_window) / window_seconds + 0.5f);
+        steals_this_window = 0;
+        window_seconds     = 0.0f;
+    }
+}
+
+int VoicePool::Capacity() const noexcept
+{
+    return static_cast<int>(voices.Capacity());
+}
+
+int VoicePool::VoicesInUse() const noexcept
+{
+    return static_cast<int>(voices.Size());
+}
+
+int VoicePool::StealsPerSecond() const noexcept
+{
+    return steals_per_second;
+}
+
+int VoicePool::ActiveSends() const noexcept
+{
+    return active_sends;
+}
+
+int VoicePool::SendsTo(ALuint effect_slot) const noexcept
+{
+    if (effect_slot == 0)
+        return 0;
+    int sends = 0;
+    for (const Voice& voice : voices.Items())
+    {
+        if (voice.effect_slot == effect_slot)
+            ++sends;
+    }
+    return sends;
+}
+
+void VoicePool::reclaimStopped()
+{
+    // backwards, since releasing moves the last voice into the hole
+    for (std::size_t i = voices.Size(); i-- > 0;)
+    {
+        ALint state = AL_STOPPED;
+        alGetSourcei(voices.Items()[i].source, AL_SOURCE_STATE, &state);
+        if (state == AL_STOPPED)
+            release(voices.HandleAt(i));
+    }
+}
+
+VoiceId VoicePool::pickVictim(int priority) const
+{
+    const std::span<const Voice> playing = voices.Items();
+    int                          victim  = -1;
+    for (int i = 0; i < static_cast<int>(playing.size()); ++i)
+    {
+        const Voice& voice = playing[static_cast<std::size_t>(i)];
+        if (voice.priority > priority)
+            continue;
+        if (victim < 0)
+        {
+            victim = i;
+            continue;
+        }
+        const Voice& best = playing[static_cast<std::size_t>(victim)];
+        if (voice.priority != best.priority)
+        {
+            if (voice.priority < best.priority)
+                victim = i;
+        }
+        else if (voice.gain != best.gain)
+        {
+            if (voice.gain < best.gain)
+                victim = i;
+        }
+        else if (voice.started < best.started)
+        {
+            victim = i;
+        }
+    }
+    return victim < 0 ? VoiceId{} : voices.HandleAt(static_cast<std::size_t>(victim));
+}
+
+void VoicePool::release(VoiceId id)
+{
+    Voice& voice = *voices.Get(id);
+    alSourcei(voice.source, AL_BUFFER, 0);
+    route(voice, 0);
+    // the source's next playback starts unfiltered
+    if (voice.filtered)
+        alSourcei(voice.source, AL_DIRECT_FILTER, AL_FILTER_NULL);
+    idle_sources.push_back(voice.source);
+    voices.Erase(id);
+}
+
+void VoicePool::route(Voice& voice, ALuint effect_slot)
+{
+    // only touched when it changes, which also keeps dry voices off the EFX enums on devices without it
+    if (voice.effect_slot == effect_slot)
+        return;
+    alSource3i(voice.source, AL_AUXILIARY_SEND_FILTER, static_cast<ALint>(effect_slot), 0, AL_FILTER_NULL);
+    active_sends += (effect_slot != 0 ? 1 : 0) - (voice.effect_slot != 0 ? 1 : 0);
+    voice.effect_slot = effect_slot;
+}
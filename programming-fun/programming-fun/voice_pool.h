@@ -0,0 +1,117 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "object_pool.h"
+
+#include <al.h>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <vector>
+
+struct VoiceIdTag;
+
+// Names one playback on a pool voice; stale once the voice is reused, so Stop on an old id is harmless
+using VoiceId = PoolHandle<VoiceIdTag>;
+
+struct VoiceParams
+{
+    float     gain               = 1.0f;
+    float     pitch              = 1.0f;
+    int       priority           = 0;    // higher survives longer when the pool is exhausted
+    bool      looping            = false;
+    ALuint    effect_slot        = 0;    // auxiliary send 0 goes here (AudioEffects::SlotFor); 0 keeps the voice dry
+    float     max_distance       = 0.0f; // > 0 places the voice at `position`, fading out linearly to silence here; 0 plays it on the listener
+    float     reference_distance = 1.0f; // full gain up to this far
+    float     offset_seconds     = 0.0f; // where in the buffer to start (AL_SEC_OFFSET), to resume a virtual voice
+    glm::vec3 position{ 0.0f };
+};
+
+/**
+ * Preallocated OpenAL sources for fire-and-forget one-shots.
+ *
+ * Sources are created once in Setup, up to what the device reports (ALC_MONO_SOURCES), minus a few
+ * kept back for AudioStream. When every voice is busy, Play steals the lowest priority one, breaking
+ * ties by the quietest and then the oldest; a request that outranks no one is dropped instead.
+ * A voice with an effect slot uses one auxiliary send, which the mixer pays for on every update, so the
+ * send is cut as soon as the voice is released. Playing voices live in an ObjectPool, so the per-update
+ * walks only touch those, and idle sources wait on a list of their own; a steal hands the victim's source
+ * to a new voice with a new id. With ALC_EXT_EFX, SetLowPass puts a direct path low-pass on a voice, for
+ * occlusion; one filter object serves them all, since a source keeps its own copy of the parameters.
+ * All calls belong to the thread that owns the AL context.
+ */
+class VoicePool
+{
+public:
+    static constexpr int MAX_VOICES       = 256;
+    static constexpr int RESERVED_SOURCES = 4; // left for streams and anything else that allocates its own
+
+    VoicePool() = default;
+    ~VoicePool();
+
+    VoicePool(const VoicePool&)                = delete;
+    VoicePool& operator=(const VoicePool&)     = delete;
+    VoicePool(VoicePool&&) noexcept            = delete;
+    VoicePool& operator=(VoicePool&&) noexcept = delete;
+
+    // 0 asks the device; needs a current AL context
+    void Setup(int max_voices = 0);
+    void Shutdown();
+
+    VoiceId Play(ALuint buffer, const VoiceParams& params = {});
+    void    Stop(VoiceId voice);
+    bool    IsPlaying(VoiceId voice) const;
+    // Moves a positional voice; no-op for a stale id. Cheap enough to call for every voice each frame, see SpatialAudio.
+    void    Place(VoiceId voice, const glm::vec3& position);
+    // Also what stealing compares; no-op for a stale id
+    void    SetGain(VoiceId voice, float gain);
+    // AL_LOWPASS_GAIN and AL_LOWPASS_GAINHF on the direct path, both 1 to take it off; no-op for a stale id or without EFX
+    void    SetLowPass(VoiceId voice, float gain, float gain_hf);
+    bool    HasLowPass() const noexcept;
+    // Still this playback's voice: not stolen and not reclaimed. Answers without asking AL, unlike IsPlaying.
+    bool    IsCurrent(VoiceId voice) const noexcept;
+    // How far the mixer is into the buffer (AL_SEC_OFFSET), advancing one mixer update at a time; negative once it stopped
+    float   PlaybackSeconds(VoiceId voice) const;
+
+    // Reclaims finished voices and rolls the steal counter over once a second
+    void Update(float delta_seconds);
+
+    int Capacity() const noexcept;
+    int VoicesInUse() const noexcept;
+    int StealsPerSecond() const noexcept;
+    // Playing voices with an auxiliary send connected
+    int ActiveSends() const noexcept;
+    // How many of those go to `effect_slot`
+    int SendsTo(ALuint effect_slot) const noexcept;
+
+private:
+    struct Voice
+    {
+        ALuint        source      = 0;
+        std::uint64_t started     = 0;
+        float         gain        = 0.0f;
+        int           priority    = 0;
+        ALuint        effect_slot = 0;
+        bool          filtered    = false; // the low-pass is on its direct path
+    };
+
+    void    reclaimStopped();
+    VoiceId pickVictim(int priority) const;
+    void    release(VoiceId voice);
+    void    route(Voice& voice, ALuint effect_slot);
+
+private:
+    ObjectPool<Voice, VoiceIdTag> voices{ 0 }; // the ones playing
+    std::vector<ALuint>           idle_sources;
+    std::uint64_t                 play_count         = 0;
+    int                           active_sends       = 0;
+    int                           steals_this_window = 0;
+    int                           steals_per_second  = 0;
+    float                         window_seconds     = 0.0f;
+    ALuint                        lowpass            = 0; // SetLowPass's filter, 0 without EFX
+};
@@ -0,0 +1,124 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "vorbis_seek_index.h"
+
+#include "decoded_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#define STB_VORBIS_HEADER_ONLY
+#include <stb_vorbis.c>
+
+namespace
+{
+    constexpr std::size_t      HEADER_BYTES  = 27;
+    constexpr std::string_view CACHE_VARIANT = "vorbis-seek-index";
+
+    // a page's granule position is the centre of a window, up to half a long block from where its audio ends
+    constexpr std::uint32_t LEFT_MARGIN = 8192;
+
+    std::uint32_t read_u32(const unsigned char* bytes) noexcept
+    {
+        return static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8 | static_cast<std::uint32_t>(bytes[2]) << 16 | static_cast<std::uint32_t>(bytes[3]) << 24;
+    }
+}
+
+bool VorbisSeekIndex::Build(std::span<const unsigned char> ogg_bytes, int sample_rate)
+{
+    Clear();
+    if (ogg_bytes.empty() || sample_rate <= 0 || ogg_bytes.size() > UINT32_MAX)
+        return false;
+
+    const auto          begin = std::chrono::steady_clock::now();
+    const std::uint64_t key   = decoded_cache::IsEnabled() ? decoded_cache::Key(ogg_bytes, CACHE_VARIANT) : 0;
+    if (key != 0)
+    {
+        decoded_cache::Entry entry;
+        if (entry.Open(key) && entry.SectionCount() == 1 && entry.Section(0).size() == static_cast<std::size_t>(entry.Param(0)) * sizeof(Page))
+        {
+            pages.resize(static_cast<std::size_t>(entry.Param(0)));
+            std::memcpy(pages.data(), entry.Section(0).data(), entry.Section(0).size());
+            was_cached = true;
+            return !pages.empty();
+        }
+    }
+
+    const auto rate   = static_cast<std::uint32_t>(sample_rate);
+    Page       last;
+    bool       has_last = false;
+    for (std::size_t offset = 0; offset + HEADER_BYTES <= ogg_bytes.size();)
+    {
+        const unsigned char* header = ogg_bytes.data() + offset;
+        if (std::memcmp(header, "OggS", 4) != 0)
+            break;
+        const std::size_t segments = header[26];
+        if (offset + HEADER_BYTES + segments > ogg_bytes.size())
+            break;
+        std::size_t body = 0;
+        for (std::size_t i = 0; i < segments; ++i)
+            body += header[HEADER_BYTES + i];
+        const std::size_t end = offset + HEADER_BYTES + segments + body;
+        if (end > ogg_bytes.size())
+            break;
+
+        // stb_vorbis keeps the low 32 bits too; ~0 is a page where no packet ends, 0 the header pages
+        const std::uint32_t granule = read_u32(header + 6);
+        if (granule != ~0u && granule != 0)
+        {
+            last     = Page{ static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(end), granule };
+            has_last = true;
+            if (pages.empty() || granule / rate > pages.back().sample / rate)
+                pages.push_back(last);
+        }
+        offset = end;
+    }
+    if (has_last && pages.back().start != last.start)
+        pages.push_back(last);
+
+    if (key != 0 && !pages.empty())
+    {
+        const std::span<const unsigned char> section{ reinterpret_cast<const unsigned char*>(pages.data()), pages.size() * sizeof(Page) };
+        const double                         ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        decoded_cache::Store(key, { static_cast<std::int32_t>(pages.size()), sample_rate, 0, 0 }, std::span{ &section, 1 }, ms);
+    }
+    return !pages.empty();
+}
+
+void VorbisSeekIndex::Clear() noexcept
+{
+    pages.clear();
+    was_cached = false;
+}
+
+bool VorbisSeekIndex::IsEmpty() const noexcept
+{
+    return pages.empty();
+}
+
+std::size_t VorbisSeekIndex::PageCount() const noexcept
+{
+    return pages.size();
+}
+
+bool VorbisSeekIndex::WasCached() const noexcept
+{
+    return was_cached;
+}
+
+bool VorbisSeekIndex::Seek(stb_vorbis* vorbis, std::uint32_t frame) const
+{
+    // the first page past the target, and the last one far enough before it that its audio can't reach it
+    const auto right = std::upper_bound(pages.begin(), pages.end(), frame, [](std::uint32_t target, const Page& page) { return target < page.sample; });
+    auto       left  = right;
+    while (left != pages.begin() && (left == right || left->sample + LEFT_MARGIN > frame))
+        --left;
+    if (right == pages.end() || left == right || left->sample + LEFT_MARGIN > frame)
+        return stb_vorbis_seek(vorbis, frame) != 0;
+    return stb_vorbis_seek_between(vorbis, frame, *left, *right) != 0;
+}
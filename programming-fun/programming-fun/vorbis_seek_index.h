@@ -0,0 +1,55 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct stb_vorbis;
+
+/**
+ * Where each second of an OGG Vorbis stream starts, so a seek goes straight to the right page.
+ *
+ * stb_vorbis_seek bisects the whole file for the page holding a sample, reading page headers from all over a
+ * long track. Build walks the page headers once instead, 27 bytes and a lacing table a page with no decoding,
+ * and keeps the first page of every second that has a granule position, plus the last page. Seek hands
+ * stb_vorbis the entries either side of the target as the bounds of its search, which leaves about a second
+ * of pages to step through before it decodes up to the exact sample. The index goes into the decoded_cache
+ * next to the decoded assets, keyed by the file's bytes, so a warm start maps it instead of walking the file.
+ */
+class VorbisSeekIndex
+{
+public:
+    struct Page
+    {
+        std::uint32_t start  = 0; // byte offset of its "OggS"
+        std::uint32_t end    = 0; // where the next page starts
+        std::uint32_t sample = 0; // the granule position, the last frame the page completes
+    };
+
+    // False, and empty, when `ogg_bytes` isn't Ogg; Seek still works then, through stb_vorbis's own search
+    bool Build(std::span<const unsigned char> ogg_bytes, int sample_rate);
+    void Clear() noexcept;
+
+    bool        IsEmpty() const noexcept;
+    std::size_t PageCount() const noexcept;
+    // Mapped from the decoded_cache rather than walked
+    bool        WasCached() const noexcept;
+
+    // To exactly `frame`, like stb_vorbis_seek; `vorbis` must decode the bytes the index was built from
+    bool Seek(stb_vorbis* vorbis, std::uint32_t frame) const;
+
+private:
+    std::vector<Page> pages;
+    bool              was_cached = false;
+};
+
+// In stb_implementation.cpp, next to stb_vorbis's internals: stb_vorbis_seek with its page search bracketed by two pages
+int stb_vorbis_seek_between(stb_vorbis* vorbis, unsigned int sample_number, const VorbisSeekIndex::Page& left, const VorbisSeekIndex::Page& right);
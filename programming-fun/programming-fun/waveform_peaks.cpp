@@ -0,0 +1,189 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "waveform_peaks.h"
+
+#include "profiler.h"
+#include "sound_loader.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <imgui.h>
+
+namespace
+{
+    std::int16_t read_sample(const unsigned char* sample, SampleType type) noexcept
+    {
+        switch (type)
+        {
+            case SampleType::Unsigned8: return static_cast<std::int16_t>((static_cast<int>(*sample) - 128) * 256);
+            case SampleType::Signed16:
+            {
+                std::int16_t value = 0;
+                std::memcpy(&value, sample, sizeof(value));
+                return value;
+            }
+            case SampleType::Float32:
+            {
+                float value = 0.0f;
+                std::memcpy(&value, sample, sizeof(value));
+                return static_cast<std::int16_t>(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+            }
+        }
+        return 0;
+    }
+
+    std::size_t sample_size(SampleType type) noexcept
+    {
+        switch (type)
+        {
+            case SampleType::Unsigned8: return 1;
+            case SampleType::Signed16: return 2;
+            case SampleType::Float32: return 4;
+        }
+        return 2;
+    }
+
+    WaveformPeaks::Peak merge(WaveformPeaks::Peak a, WaveformPeaks::Peak b) noexcept
+    {
+        return WaveformPeaks::Peak{ std::min(a.min, b.min), std::max(a.max, b.max) };
+    }
+}
+
+void WaveformPeaks::Build(const DecodedSound& sound)
+{
+    PROFILE_ZONE("WaveformPeaks::Build");
+    Clear();
+    if (sound.channels <= 0)
+        return;
+    const std::size_t bytes_per_sample = sample_size(sound.type);
+    const std::size_t frame_bytes      = bytes_per_sample * static_cast<std::size_t>(sound.channels);
+    frames                             = sound.samples.size() / frame_bytes;
+    if (frames == 0)
+        return;
+
+    // level 0 straight from the samples, every level after it from the one below
+    const std::size_t base_count = (frames + BLOCK_FRAMES - 1) / BLOCK_FRAMES;
+    peaks.reserve(base_count * 2);
+    level_offsets.push_back(0);
+    const unsigned char* sample = sound.samples.data();
+    for (std::size_t block = 0; block < base_count; ++block)
+    {
+        const std::size_t block_frames = std::min<std::size_t>(BLOCK_FRAMES, frames - block * BLOCK_FRAMES);
+        Peak              peak{ INT16_MAX, INT16_MIN };
+        for (std::size_t i = 0; i < block_frames * static_cast<std::size_t>(sound.channels); ++i, sample += bytes_per_sample)
+        {
+            const std::int16_t value = read_sample(sample, sound.type);
+            peak.min                 = std::min(peak.min, value);
+            peak.max                 = std::max(peak.max, value);
+        }
+        peaks.push_back(peak);
+    }
+    std::size_t below = base_count;
+    while (below > 1)
+    {
+        const std::size_t first = level_offsets.back();
+        level_offsets.push_back(peaks.size());
+        for (std::size_t i = 0; i < below; i += 2)
+            peaks.push_back(i + 1 < below ? merge(peaks[first + i], peaks[first + i + 1]) : peaks[first + i]);
+        below = (below + 1) / 2;
+    }
+    level_offsets.push_back(peaks.size());
+}
+
+void WaveformPeaks::Clear() noexcept
+{
+    peaks.clear();
+    level_offsets.clear();
+    frames = 0;
+}
+
+bool WaveformPeaks::IsEmpty() const noexcept
+{
+    return peaks.empty();
+}
+
+std::size_t WaveformPeaks::Frames() const noexcept
+{
+    return frames;
+}
+
+int WaveformPeaks::LevelCount() const noexcept
+{
+    return level_offsets.empty() ? 0 : static_cast<int>(level_offsets.size()) - 1;
+}
+
+std::size_t WaveformPeaks::Bytes() const noexcept
+{
+    return peaks.size() * sizeof(Peak) + level_offsets.size() * sizeof(std::size_t);
+}
+
+std::size_t WaveformPeaks::BlockFrames(int level) const noexcept
+{
+    return static_cast<std::size_t>(BLOCK_FRAMES) << level;
+}
+
+std::span<const WaveformPeaks::Peak> WaveformPeaks::Level(int level) const
+{
+    const std::size_t begin = level_offsets.at(static_cast<std::size_t>(level));
+    return std::span<const Peak>{ peaks }.subspan(begin, level_offsets.at(static_cast<std::size_t>(level) + 1) - begin);
+}
+
+void WaveformPeaks::Sample(std::size_t first_frame, std::size_t frame_count, std::span<Peak> out_columns) const
+{
+    std::fill(out_columns.begin(), out_columns.end(), Peak{});
+    first_frame = std::min(first_frame, frames);
+    frame_count = std::min(frame_count, frames - first_frame);
+    if (IsEmpty() || frame_count == 0 || out_columns.empty())
+        return;
+
+    // the coarsest level whose blocks are no wider than a column
+    const std::size_t columns          = out_columns.size();
+    const std::size_t blocks_in_column = std::max<std::size_t>(1, frame_count / columns / BLOCK_FRAMES);
+    const int         level            = std::min(static_cast<int>(std::bit_width(blocks_in_column)) - 1, LevelCount() - 1);
+    const auto        blocks           = Level(level);
+    const std::size_t block_frames     = BlockFrames(level);
+    for (std::size_t column = 0; column < columns; ++column)
+    {
+        const std::size_t begin = first_frame + column * frame_count / columns;
+        const std::size_t end   = std::max(begin + 1, first_frame + (column + 1) * frame_count / columns);
+        const std::size_t last  = std::min((end - 1) / block_frames, blocks.size() - 1);
+        Peak              peak  = blocks[begin / block_frames];
+        for (std::size_t block = begin / block_frames + 1; block <= last; ++block)
+            peak = merge(peak, blocks[block]);
+        out_columns[column] = peak;
+    }
+}
+
+void WaveformPeaks::DrawImGui(float height, float zoom, float scroll) const
+{
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float  width  = std::max(1.0f, ImGui::GetContentRegionAvail().x);
+    ImGui::Dummy(ImVec2(width, height));
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    draw_list->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), IM_COL32(20, 20, 24, 255));
+    if (IsEmpty())
+        return;
+
+    std::array<Peak, MAX_COLUMNS> columns;
+    const std::size_t             column_count = std::min<std::size_t>(MAX_COLUMNS, static_cast<std::size_t>(width));
+    const std::size_t             shown        = std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(frames) / std::max(1.0f, zoom)));
+    const std::size_t             first        = static_cast<std::size_t>(static_cast<double>(frames - shown) * std::clamp(scroll, 0.0f, 1.0f));
+    Sample(first, shown, std::span<Peak>{ columns.data(), column_count });
+
+    const float middle = origin.y + height * 0.5f;
+    const float scale  = height * 0.5f / 32768.0f;
+    for (std::size_t column = 0; column < column_count; ++column)
+    {
+        const float x = origin.x + static_cast<float>(column) + 0.5f;
+        const float top    = middle - static_cast<float>(columns[column].max) * scale;
+        const float bottom = middle - static_cast<float>(columns[column].min) * scale;
+        draw_list->AddLine(ImVec2(x, top), ImVec2(x, bottom + 1.0f), IM_COL32(110, 200, 140, 255));
+    }
+}
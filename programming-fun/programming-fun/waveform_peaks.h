@@ -0,0 +1,58 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct DecodedSound;
+
+/**
+ * The min/max envelope of a sound at every power of two zoom, for drawing its waveform.
+ *
+ * Level 0 holds one pair per BLOCK_FRAMES frames with every channel folded in, and each level above
+ * halves the one below down to a single pair, so the whole pyramid is about 8 / BLOCK_FRAMES bytes per
+ * frame. It's built once where the PCM is decoded; Sample then reads each column from the coarsest level
+ * that still has a pair per column, a few pairs per column at any zoom instead of every sample under it.
+ */
+class WaveformPeaks
+{
+public:
+    static constexpr int BLOCK_FRAMES = 64;
+    static constexpr int MAX_COLUMNS  = 2048;
+
+    struct Peak
+    {
+        std::int16_t min = 0;
+        std::int16_t max = 0;
+    };
+
+    void Build(const DecodedSound& sound);
+    void Clear() noexcept;
+
+    bool        IsEmpty() const noexcept;
+    std::size_t Frames() const noexcept;
+    int         LevelCount() const noexcept;
+    std::size_t Bytes() const noexcept;
+    // Frames `level` folds into one pair
+    std::size_t BlockFrames(int level) const noexcept;
+    std::span<const Peak> Level(int level) const;
+
+    // One pair per column of `out_columns` over frames [first_frame, first_frame + frame_count)
+    void Sample(std::size_t first_frame, std::size_t frame_count, std::span<Peak> out_columns) const;
+
+    // Plots `height` pixels of waveform across the available width; `zoom` 1 shows it all, `scroll` 0..1 picks which part
+    void DrawImGui(float height, float zoom, float scroll) const;
+
+private:
+    std::vector<Peak>        peaks;         // every level back to back, level 0 first
+    std::vector<std::size_t> level_offsets; // into `peaks`, plus the end
+    std::size_t              frames = 0;
+};
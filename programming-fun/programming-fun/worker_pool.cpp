@@ -0,0 +1,277 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "worker_pool.h"
+
+#include "profiler.h"
+#include "scheduling.h"
+
+#include <SDL.h>
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+namespace
+{
+    // which queue the current thread owns; the shared one for threads outside any pool
+    thread_local const void* current_pool   = nullptr;
+    thread_local std::size_t current_worker = 0;
+}
+
+bool JobCounter::IsDone() const noexcept
+{
+    return pending.load(std::memory_order_acquire) == 0;
+}
+
+WorkerPool::WorkerPool([[maybe_unused]] unsigned thread_count, [[maybe_unused]] bool pin_to_cores)
+{
+#if !WORKER_POOL_SYNCHRONOUS
+    if (thread_count == 0)
+    {
+        thread_count = static_cast<unsigned>(std::max(1, SDL_GetCPUCount() - 1));
+    }
+    for (unsigned i = 0; i < thread_count + 2; ++i)
+    {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    threads.reserve(thread_count);
+    for (unsigned i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back([this, i, pin_to_cores] { workerLoop(i, pin_to_cores); });
+    }
+#endif
+}
+
+WorkerPool::~WorkerPool()
+{
+    Stop();
+}
+
+void WorkerPool::Submit(Job job, JobCounter* counter)
+{
+    if (counter != nullptr)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+#if WORKER_POOL_SYNCHRONOUS
+    wrap(std::move(job), counter)();
+#else
+    push(wrap(std::move(job), counter), counter != nullptr);
+#endif
+}
+
+void WorkerPool::SubmitAfter(JobCounter& dependency, Job job, JobCounter* counter)
+{
+    if (counter != nullptr)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    Job wrapped = wrap(std::move(job), counter);
+    {
+        std::lock_guard lock{ dependency.mutex };
+        if (!dependency.IsDone())
+        {
+            dependency.continuations.push_back([this, counted = counter != nullptr, wrapped = std::move(wrapped)]() mutable { push(std::move(wrapped), counted); });
+            return;
+        }
+    }
+#if WORKER_POOL_SYNCHRONOUS
+    wrapped();
+#else
+    push(std::move(wrapped), counter != nullptr);
+#endif
+}
+
+void WorkerPool::Wait(JobCounter& counter)
+{
+    while (!counter.IsDone())
+    {
+        if (!tryRunOne())
+            std::this_thread::yield();
+    }
+    // the last job decrements under the lock, so taking it here means nobody touches the counter after we return
+    std::lock_guard lock{ counter.mutex };
+}
+
+void WorkerPool::ParallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body)
+{
+    ParallelFor("ParallelFor", count, grain, body);
+}
+
+void WorkerPool::ParallelFor(const char* name, std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body)
+{
+    grain = std::max<std::size_t>(grain, 1);
+    if (count <= grain || threads.empty())
+    {
+        if (count > 0)
+        {
+            PROFILE_NAMED_TRACE_ZONE(name);
+            body(0, count);
+        }
+        return;
+    }
+
+    JobCounter counter;
+    for (std::size_t begin = grain; begin < count; begin += grain)
+    {
+        const std::size_t end = std::min(count, begin + grain);
+        Submit(
+            [name, &body, begin, end]
+            {
+                PROFILE_NAMED_TRACE_ZONE(name);
+                body(begin, end);
+            },
+            &counter);
+    }
+    // the first chunk runs here so the caller is never just waiting
+    {
+        PROFILE_NAMED_TRACE_ZONE(name);
+        body(0, grain);
+    }
+    Wait(counter);
+}
+
+std::size_t WorkerPool::GrainFor(std::size_t count, std::size_t item_bytes) const noexcept
+{
+    item_bytes                   = std::max<std::size_t>(item_bytes, 1);
+    const std::size_t chunks     = (threads.size() + 1) * CHUNKS_PER_THREAD;
+    const std::size_t least      = (MIN_CHUNK_BYTES + item_bytes - 1) / item_bytes;
+    const std::size_t grain      = std::max((count + chunks - 1) / chunks, least);
+    // the fewest items that end on a line boundary, 1 for items of whole lines
+    const std::size_t line_items = CACHE_LINE_BYTES / std::gcd(item_bytes, CACHE_LINE_BYTES);
+    return (grain + line_items - 1) / line_items * line_items;
+}
+
+unsigned WorkerPool::ThreadCount() const noexcept
+{
+    return static_cast<unsigned>(threads.size());
+}
+
+void WorkerPool::Stop()
+{
+    {
+        std::lock_guard lock{ sleep_mutex };
+        is_stopping = true;
+    }
+    has_work.notify_all();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    threads.clear();
+}
+
+WorkerPool::Job WorkerPool::wrap(Job job, JobCounter* counter)
+{
+    if (counter == nullptr)
+        return job;
+    return [this, job = std::move(job), counter]
+    {
+        job();
+        finish(*counter);
+    };
+}
+
+void WorkerPool::push(Job job, [[maybe_unused]] bool counted)
+{
+#if WORKER_POOL_SYNCHRONOUS
+    job();
+#else
+    // counted before it is visible so a thief can never take it below zero
+    {
+        std::lock_guard lock{ sleep_mutex };
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    const std::size_t index = current_pool == this ? current_worker : queues.size() - (counted ? 1 : 2);
+    {
+        std::lock_guard lock{ queues[index]->mutex };
+        queues[index]->jobs.push_back(std::move(job));
+    }
+    has_work.notify_one();
+#endif
+}
+
+bool WorkerPool::tryRunOne()
+{
+    Job job;
+    if (!tryPop(job))
+        return false;
+    PROFILE_TRACE_ZONE("Job");
+    job();
+    return true;
+}
+
+bool WorkerPool::tryPop(Job& out_job)
+{
+    if (queues.empty() || queued.load(std::memory_order_acquire) == 0)
+        return false;
+
+    const std::size_t background = queues.size() - 2;
+    const std::size_t counted    = queues.size() - 1;
+    const bool        is_worker  = current_pool == this;
+    auto              take       = [this, &out_job](std::size_t index, bool newest)
+    {
+        WorkQueue&      queue = *queues[index];
+        std::lock_guard lock{ queue.mutex };
+        if (queue.jobs.empty())
+            return false;
+        if (newest)
+        {
+            out_job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        }
+        else
+        {
+            out_job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    };
+
+    if (!is_worker)
+        return take(counted, false);
+
+    // own work newest first for cache warmth, then outside submissions in order, then steal the oldest
+    if (take(current_worker, true) || take(counted, false) || take(background, false))
+        return true;
+    for (std::size_t offset = 1; offset < background; ++offset)
+    {
+        if (take((current_worker + offset) % background, false))
+            return true;
+    }
+    return false;
+}
+
+void WorkerPool::finish(JobCounter& counter)
+{
+    std::vector<Job> ready;
+    {
+        std::lock_guard lock{ counter.mutex };
+        if (counter.pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        ready.swap(counter.continuations);
+    }
+    for (auto& continuation : ready)
+        continuation();
+}
+
+void WorkerPool::workerLoop(std::size_t index, bool pin_to_core)
+{
+    current_pool   = this;
+    current_worker = index;
+    profiler::SetThreadName(("worker " + std::to_string(index)).c_str());
+    scheduling::SetThreadRole(scheduling::ThreadRole::Worker);
+    // core 0 is left to the main thread, which the OS is free to move anyway
+    if (pin_to_core)
+        scheduling::PinToCore(static_cast<int>(index) + 1);
+    while (true)
+    {
+        if (tryRunOne())
+            continue;
+        std::unique_lock lock{ sleep_mutex };
+        has_work.wait(lock, [this] { return is_stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (is_stopping && queued.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#    define WORKER_POOL_SYNCHRONOUS 1
+#else
+#    define WORKER_POOL_SYNCHRONOUS 0
+#endif
+
+/**
+ * Counts the unfinished jobs submitted against it.
+ *
+ * Wait on it to join a batch, or pass it to SubmitAfter to make jobs depend on the batch.
+ * A counter can be reused once it is done; it must outlive every job that names it.
+ */
+class JobCounter
+{
+public:
+    JobCounter() = default;
+
+    JobCounter(const JobCounter&)                = delete;
+    JobCounter& operator=(const JobCounter&)     = delete;
+    JobCounter(JobCounter&&) noexcept            = delete;
+    JobCounter& operator=(JobCounter&&) noexcept = delete;
+
+    bool IsDone() const noexcept;
+
+private:
+    friend class WorkerPool;
+
+    std::atomic<int>                   pending{ 0 };
+    std::mutex                         mutex;
+    std::vector<std::function<void()>> continuations;
+};
+
+/**
+ * Fixed set of background threads with one work-stealing deque each.
+ *
+ * A worker runs its own newest job first and steals the oldest from the others when it runs dry;
+ * jobs submitted from outside the pool land in shared FIFOs. Wait lets the calling thread run jobs
+ * while the counter drains instead of blocking, so the main thread can join a ParallelFor. Outside
+ * the pool it only helps with counted jobs, so a fire-and-forget decode never lands on the main thread.
+ * Without pthreads (plain Emscripten builds) there are no threads and Submit runs the job inline.
+ */
+class WorkerPool
+{
+public:
+    using Job = std::function<void()>;
+
+    static constexpr std::size_t CACHE_LINE_BYTES  = 64;
+    static constexpr std::size_t MIN_CHUNK_BYTES   = 16 * 1024; // less isn't worth a job
+    static constexpr std::size_t CHUNKS_PER_THREAD = 4;         // so stealing can even out uneven chunks
+
+    // 0 means one thread per core minus the main thread; pinned, worker i stays on physical core i + 1
+    explicit WorkerPool(unsigned thread_count = 0, bool pin_to_cores = false);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&)                = delete;
+    WorkerPool& operator=(const WorkerPool&)     = delete;
+    WorkerPool(WorkerPool&&) noexcept            = delete;
+    WorkerPool& operator=(WorkerPool&&) noexcept = delete;
+
+    void Submit(Job job, JobCounter* counter = nullptr);
+    // Queues `job` once `dependency` is done, right away if it already is
+    void SubmitAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+    void Wait(JobCounter& counter);
+
+    // Runs body(begin, end) over [0, count) in chunks of `grain` and returns when all of them are done
+    void ParallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body);
+    // Same, each chunk a trace zone under `name`, which outlives the capture
+    void ParallelFor(const char* name, std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body);
+    // A grain for `count` items of `item_bytes`: CHUNKS_PER_THREAD chunks a thread but at least MIN_CHUNK_BYTES,
+    // rounded to whole cache lines so chunks of an aligned array never write the same line
+    std::size_t GrainFor(std::size_t count, std::size_t item_bytes) const noexcept;
+
+    unsigned ThreadCount() const noexcept;
+
+    // What the destructor does, for an exit that never gets to it: runs every queued job and joins the threads.
+    // Jobs submitted afterwards only run when something Waits on them.
+    void Stop();
+
+private:
+    struct WorkQueue
+    {
+        std::mutex      mutex;
+        std::deque<Job> jobs;
+    };
+
+    Job  wrap(Job job, JobCounter* counter);
+    void push(Job job, bool counted);
+    bool tryRunOne();
+    bool tryPop(Job& out_job);
+    void finish(JobCounter& counter);
+    void workerLoop(std::size_t index, bool pin_to_core);
+
+private:
+    std::vector<std::thread>                threads;
+    std::vector<std::unique_ptr<WorkQueue>> queues; // one per worker, then the shared background and counted queues
+    std::mutex                              sleep_mutex;
+    std::condition_variable                 has_work;
+    std::atomic<std::size_t>                queued{ 0 };
+    bool                                    is_stopping = false;
+};
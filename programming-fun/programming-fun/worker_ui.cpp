@@ -0,0 +1,235 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "worker_ui.h"
+
+#include "imgui_panels.h"
+#include "spsc_queue.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <imgui.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Command
+    {
+        enum class Type : std::uint8_t
+        {
+            Progress,
+            Text,
+            Plot
+        };
+
+        Type                                    type  = Type::Text;
+        float                                   value = 0.0f;
+        std::array<char, worker_ui::TEXT_BYTES> text{}; // the line, or the bar's or plot's name; always terminated
+    };
+
+    struct ThreadQueue
+    {
+        SpscQueue<Command, worker_ui::QUEUE_CAPACITY> commands;
+        std::atomic<std::uint64_t>                    dropped{ 0 };
+    };
+
+    // never freed: a thread can end with commands the next DrawImGui still has to take
+    struct Registry
+    {
+        std::mutex                                mutex;
+        std::vector<std::unique_ptr<ThreadQueue>> queues;
+    };
+
+    Registry& registry()
+    {
+        static Registry* const instance = new Registry{};
+        return *instance;
+    }
+
+    ThreadQueue* register_thread()
+    {
+        Registry&              all = registry();
+        const std::scoped_lock lock{ all.mutex };
+        all.queues.push_back(std::make_unique<ThreadQueue>());
+        return all.queues.back().get();
+    }
+
+    ThreadQueue& this_thread_queue()
+    {
+        thread_local ThreadQueue* const queue = register_thread();
+        return *queue;
+    }
+
+    void record(Command::Type type, std::string_view text, float value)
+    {
+        Command command;
+        command.type  = type;
+        command.value = value;
+        std::memcpy(command.text.data(), text.data(), std::min(text.size(), command.text.size() - 1));
+        ThreadQueue& queue = this_thread_queue();
+        if (!queue.commands.TryPush(command))
+            queue.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // what the window shows, main thread only
+    struct Bar
+    {
+        std::string name;
+        float       fraction = 0.0f;
+        Uint64      finished = 0; // the counter when it reached 1
+    };
+
+    struct Series
+    {
+        std::string                                name;
+        std::array<float, worker_ui::PLOT_SAMPLES> samples{};
+        int                                        count = 0;
+        int                                        next  = 0; // the oldest once full
+    };
+
+    struct Shown
+    {
+        std::vector<Bar>        bars;
+        std::deque<std::string> lines;
+        std::vector<Series>     plots;
+    };
+
+    Shown& shown()
+    {
+        static Shown instance;
+        return instance;
+    }
+
+    void apply(Shown& out, const Command& command)
+    {
+        const std::string_view text{ command.text.data() };
+        switch (command.type)
+        {
+            case Command::Type::Progress:
+                {
+                    auto bar = std::find_if(out.bars.begin(), out.bars.end(), [text](const Bar& entry) { return entry.name == text; });
+                    if (bar == out.bars.end())
+                        bar = out.bars.insert(out.bars.end(), Bar{ std::string{ text } });
+                    bar->fraction = std::clamp(command.value, 0.0f, 1.0f);
+                    bar->finished = bar->fraction >= 1.0f ? SDL_GetPerformanceCounter() : 0;
+                    break;
+                }
+            case Command::Type::Text:
+                out.lines.emplace_back(text);
+                if (out.lines.size() > static_cast<std::size_t>(worker_ui::MAX_LINES))
+                    out.lines.pop_front();
+                break;
+            case Command::Type::Plot:
+                {
+                    auto series = std::find_if(out.plots.begin(), out.plots.end(), [text](const Series& entry) { return entry.name == text; });
+                    if (series == out.plots.end())
+                        series = out.plots.insert(out.plots.end(), Series{ std::string{ text } });
+                    series->samples[static_cast<std::size_t>(series->next)] = command.value;
+                    series->next                                             = (series->next + 1) % worker_ui::PLOT_SAMPLES;
+                    series->count                                            = std::min(series->count + 1, worker_ui::PLOT_SAMPLES);
+                    break;
+                }
+        }
+    }
+
+    // every thread's commands since the last frame, one thread's after another's
+    void drain(Shown& out)
+    {
+        Registry&              all = registry();
+        const std::scoped_lock lock{ all.mutex };
+        for (const std::unique_ptr<ThreadQueue>& queue : all.queues)
+        {
+            Command command;
+            while (queue->commands.TryPop(command))
+                apply(out, command);
+        }
+        const Uint64 linger = static_cast<Uint64>(worker_ui::FINISHED_SECONDS * static_cast<double>(SDL_GetPerformanceFrequency()));
+        const Uint64 now    = SDL_GetPerformanceCounter();
+        std::erase_if(out.bars, [linger, now](const Bar& bar) { return bar.finished != 0 && now - bar.finished > linger; });
+    }
+}
+
+namespace worker_ui
+{
+    void Progress(std::string_view name, float fraction)
+    {
+        record(Command::Type::Progress, name, fraction);
+    }
+
+    void Text(std::string_view line)
+    {
+        record(Command::Type::Text, line, 0.0f);
+    }
+
+    void Plot(std::string_view name, float value)
+    {
+        record(Command::Type::Plot, name, value);
+    }
+
+    void DrawImGui()
+    {
+        Shown& out = shown();
+        drain(out);
+
+        if (!imgui_panels::Begin("Worker Reports", 10.0f))
+        {
+            imgui_panels::End();
+            return;
+        }
+        const Stats stats = GetStats();
+        ImGui::Text("%d threads reporting, %llu commands dropped", stats.threads, static_cast<unsigned long long>(stats.dropped));
+        for (const Bar& bar : out.bars)
+        {
+            ImGui::ProgressBar(bar.fraction, ImVec2(200.0f, 0.0f));
+            ImGui::SameLine();
+            ImGui::TextUnformatted(bar.name.c_str());
+        }
+        for (const Series& series : out.plots)
+        {
+            // oldest first once the ring has wrapped
+            const int  offset = series.count < PLOT_SAMPLES ? 0 : series.next;
+            const auto latest = series.samples[static_cast<std::size_t>((series.next + PLOT_SAMPLES - 1) % PLOT_SAMPLES)];
+            char       overlay[32];
+            std::snprintf(overlay, sizeof(overlay), "%.3f", static_cast<double>(latest));
+            ImGui::PlotLines(series.name.c_str(), series.samples.data(), series.count, offset, overlay, 0.0f, FLT_MAX, ImVec2(200.0f, 40.0f));
+        }
+        if (ImGui::BeginChild("lines", ImVec2(0.0f, 120.0f), true))
+        {
+            for (const std::string& line : out.lines)
+                ImGui::TextUnformatted(line.c_str());
+            // follow the newest unless scrolled back
+            if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
+                ImGui::SetScrollHereY(1.0f);
+        }
+        ImGui::EndChild();
+        imgui_panels::End();
+    }
+
+    Stats GetStats()
+    {
+        Stats stats;
+        {
+            Registry&              all = registry();
+            const std::scoped_lock lock{ all.mutex };
+            stats.threads = static_cast<int>(all.queues.size());
+            for (const std::unique_ptr<ThreadQueue>& queue : all.queues)
+                stats.dropped += queue->dropped.load(std::memory_order_relaxed);
+        }
+        stats.bars  = static_cast<int>(shown().bars.size());
+        stats.plots = static_cast<int>(shown().plots.size());
+        return stats;
+    }
+}
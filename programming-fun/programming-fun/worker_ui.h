@@ -0,0 +1,52 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Progress bars, text lines and plot samples reported from any thread, shown by the main thread's ImGui.
+ *
+ * ImGui calls belong to the main thread between NewFrame and Render, so a loader or a simulation job can't draw
+ * its own window. Instead each thread records small fixed-size commands into a ring of its own, an SpscQueue
+ * with the main thread as the consumer. Only a thread's first call takes a lock, to register its ring; every
+ * call after it is a copy and one release store, and a full ring drops the command and counts it rather than
+ * wait. Names and lines longer than TEXT_BYTES - 1 are cut.
+ *
+ * DrawImGui drains every ring once a frame into what the window keeps between frames: each bar's latest
+ * fraction, the last MAX_LINES lines and the last PLOT_SAMPLES of each plot, in the order each thread recorded
+ * them. A bar that reaches 1 stays FINISHED_SECONDS, then goes.
+ */
+namespace worker_ui
+{
+    constexpr std::size_t TEXT_BYTES       = 96;
+    constexpr std::size_t QUEUE_CAPACITY   = 256; // commands per thread between two frames
+    constexpr int         MAX_LINES        = 64;
+    constexpr int         PLOT_SAMPLES     = 256;
+    constexpr double      FINISHED_SECONDS = 2.0;
+
+    struct Stats
+    {
+        int           threads = 0; // that have reported since startup
+        int           bars    = 0;
+        int           plots   = 0;
+        std::uint64_t dropped = 0; // commands a full ring turned away
+    };
+
+    // Any thread. `name` keys the bar; `fraction` is clamped to [0, 1]
+    void Progress(std::string_view name, float fraction);
+    void Text(std::string_view line);
+    // Any thread. `name` keys the plot, one sample per call
+    void Plot(std::string_view name, float value);
+
+    // Main thread, once a frame between ImGui::NewFrame and ImGui::Render: takes everything recorded since the last call
+    void  DrawImGui();
+    Stats GetStats();
+}
@@ -0,0 +1,98 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include "entity_store.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The latest fixed steps' worlds, to roll back to: a ring of EntityStore snapshots with whatever small state
+ * `Extra` holds beside them, one entry per step.
+ *
+ * Entries are reused once the ring is full, and with them their snapshots' buffers, so saving costs the copy of
+ * the columns that changed and nothing else. Each entry keeps the step it was saved after and the input frame that
+ * step ran in, so a replay can go back to the input that followed. Rewinding drops the entries newer than the one
+ * restored: the steps run after it make a new history.
+ */
+template <typename Extra>
+class WorldHistory
+{
+public:
+    struct Entry
+    {
+        std::uint64_t         step        = 0;
+        std::uint32_t         input_frame = 0;
+        EntityStore::Snapshot entities;
+        Extra                 extra{};
+    };
+
+    // Forgets every entry; the entries' buffers stay as long as the capacity does
+    void SetCapacity(std::size_t steps)
+    {
+        entries.resize(steps);
+        newest = 0;
+        count  = 0;
+    }
+
+    // The entry to save step `step` into: a new one, or the oldest once the ring is full
+    Entry& Push(std::uint64_t step, std::uint32_t input_frame)
+    {
+        assert(!entries.empty());
+        newest            = (newest + 1) % entries.size();
+        count             = std::min(count + 1, entries.size());
+        Entry& entry      = entries[newest];
+        entry.step        = step;
+        entry.input_frame = input_frame;
+        return entry;
+    }
+
+    // `steps` back from the newest, which is 0; nullptr past the oldest
+    const Entry* Back(std::size_t steps) const noexcept
+    {
+        if (steps >= count)
+            return nullptr;
+        return &entries[(newest + entries.size() - steps) % entries.size()];
+    }
+
+    // Drops the `steps` newest entries, after a rollback to Back(steps), which becomes the newest
+    void Rewind(std::size_t steps) noexcept
+    {
+        steps  = std::min(steps, count);
+        newest = (newest + entries.size() - steps) % std::max<std::size_t>(entries.size(), 1);
+        count -= steps;
+    }
+
+    std::size_t Count() const noexcept
+    {
+        return count;
+    }
+
+    std::size_t Capacity() const noexcept
+    {
+        return entries.size();
+    }
+
+    // What the snapshots hold across the ring, retired entries included until they're reused
+    std::size_t Bytes() const noexcept
+    {
+        std::size_t bytes = 0;
+        for (const Entry& entry : entries)
+            bytes += entry.entities.Bytes() + sizeof(Entry);
+        return bytes;
+    }
+
+private:
+    std::vector<Entry> entries;
+    std::size_t        newest = 0;
+    std::size_t        count  = 0;
+};
@@ -0,0 +1,66 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "scene_file.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+    void print_usage()
+    {
+        std::cout << "usage: scene-converter <scene.txt> [output.scene]\n"
+                     "Converts a text scene to the binary format the game maps with --scene; the default output is\n"
+                     "the input with a .scene extension. Text scenes hold one line per item, '#' starting a comment:\n"
+                     "  world <width> <height>\n"
+                     "  entity <x> <y> <velocity x> <velocity y> [sprite] [RRGGBBAA]\n";
+    }
+
+    template <typename T>
+    bool same_column(std::span<const T> mapped, const std::vector<T>& parsed)
+    {
+        return mapped.size() == parsed.size() && (parsed.empty() || std::memcmp(mapped.data(), parsed.data(), mapped.size_bytes()) == 0);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3 || !std::filesystem::is_regular_file(argv[1]))
+    {
+        print_usage();
+        return 1;
+    }
+
+    const std::filesystem::path source = argv[1];
+    const std::filesystem::path output = argc == 3 ? std::filesystem::path{ argv[2] } : std::filesystem::path{ source }.replace_extension(".scene");
+    if (output == source)
+    {
+        std::cerr << "The output would overwrite " << source << "; name one\n";
+        return 1;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    SceneData  scene;
+    if (!read_scene_text(source, scene) || !write_scene_file(scene, output))
+        return 1;
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << output.string() << ": " << scene.positions.size() << " entities, " << std::filesystem::file_size(output) / 1024 << " KB in " << elapsed.count() << " ms\n";
+
+    // map it back and compare every column, so a bad file never ships
+    SceneFile file;
+    if (!file.Open(output) || file.EntityCount() != scene.positions.size() || file.WorldSize() != scene.world_size || !same_column(file.Positions(), scene.positions) ||
+        !same_column(file.Velocities(), scene.velocities) || !same_column(file.Sprites(), scene.sprites) || !same_column(file.Colors(), scene.colors))
+    {
+        std::cerr << "Verification failed for " << output << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,692 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <Windows.h>
+#else
+#    include <chrono>
+#    include <csignal>
+#    include <ctime>
+#    include <fcntl.h>
+#    include <spawn.h>
+#    include <sys/wait.h>
+#    include <thread>
+#    include <unistd.h>
+extern char** environ;
+#endif
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    struct Options
+    {
+        int                      cold_runs = 3;
+        int                      warm_runs = 10;
+        int                      timeout_s = 120; // a run that hasn't exited by then is killed and left out
+        bool                     verbose   = false;
+        fs::path                 executable;
+        fs::path                 report;
+        std::vector<std::string> arguments; // after "--", passed to every run
+    };
+
+    // The milestones startup_trace writes, from the launch when the trace says where its zero is and from static
+    // initialization when it doesn't
+    struct Run
+    {
+        double                        launch_ms       = -1.0; // to static initialization, where the trace's clock starts
+        double                        window_ms       = -1.0;
+        double                        first_frame_ms  = -1.0;
+        double                        assets_ms       = -1.0;
+        std::map<std::string, double> main_thread_ms; // each step on the main thread, summed by name
+    };
+
+    // The milestone rows, in the order they happen
+    struct Milestone
+    {
+        const char*   name;
+        double Run::* ms;
+    };
+    constexpr Milestone MILESTONES[] = {
+        { "process to main", &Run::launch_ms },
+        { "window created", &Run::window_ms },
+        { "first frame presented", &Run::first_frame_ms },
+        { "assets loaded", &Run::assets_ms },
+    };
+
+    void print_usage()
+    {
+        std::cout << "usage: startup-benchmark [--cold N] [--warm N] [--timeout seconds] [--report file.json] [--verbose] <programming-fun> [-- arguments...]\n"
+                     "Launches the game --cold times (3) with its files dropped from the OS file cache first, then --warm times (10),\n"
+                     "each with --startup-trace and --exit-after-startup, and reports the distribution of the time from launch to\n"
+                     "the window, the first presented frame and the startup loads landing, and of the main thread's steps. The\n"
+                     "files dropped are the executable's directory and the decoded cache beside it: the OS's own and the driver's\n"
+                     "stay cached, so a cold run here is a cold game, not a cold boot. Runs' output is hidden unless --verbose.\n";
+    }
+
+    const char* find_option(int argc, char* argv[], std::string_view name)
+    {
+        for (int i = 1; i + 1 < argc; ++i)
+        {
+            if (argv[i] == std::string_view{ "--" })
+                return nullptr;
+            if (argv[i] == name)
+                return argv[i + 1];
+        }
+        return nullptr;
+    }
+
+    bool parse_count(const char* text, int& out_count)
+    {
+        const auto end          = text + std::strlen(text);
+        const auto [ptr, error] = std::from_chars(text, end, out_count);
+        return error == std::errc{} && ptr == end && out_count >= 0;
+    }
+
+    // Options before the executable, its arguments after "--"
+    bool parse_arguments(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+            if (argument == "--cold" || argument == "--warm" || argument == "--timeout" || argument == "--report")
+            {
+                ++i;
+                continue;
+            }
+            if (argument == "--verbose")
+            {
+                options.verbose = true;
+                continue;
+            }
+            if (argument == "--")
+            {
+                options.arguments.assign(argv + i + 1, argv + argc);
+                break;
+            }
+            if (!options.executable.empty())
+                return false;
+            options.executable = argument;
+        }
+        return !options.executable.empty();
+    }
+
+    // The counter SDL_GetPerformanceCounter reads, which every process on the machine shares
+    std::uint64_t performance_counter()
+    {
+#if defined(_WIN32)
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return static_cast<std::uint64_t>(counter.QuadPart);
+#else
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+        return static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000u + static_cast<std::uint64_t>(now.tv_nsec);
+#endif
+    }
+
+    // Drops one file's pages from the OS cache: a noncached open makes Windows' cache manager purge what it holds of
+    // the file, unless something has it mapped (a running program's image); POSIX has an advice for it
+    bool evict_file(const fs::path& file)
+    {
+#if defined(_WIN32)
+        const HANDLE handle = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            return false;
+        CloseHandle(handle);
+        return true;
+#else
+        const int fd = open(file.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        const bool evicted = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        close(fd);
+        return evicted;
+#endif
+    }
+
+    void evict_directory(const fs::path& directory, int& out_evicted, int& out_failed)
+    {
+        std::error_code error;
+        if (!fs::is_directory(directory, error))
+            return;
+        for (fs::recursive_directory_iterator it{ directory, fs::directory_options::skip_permission_denied, error }, end; it != end; it.increment(error))
+        {
+            if (error)
+                break;
+            if (!it->is_regular_file(error))
+                continue;
+            if (evict_file(it->path()))
+                ++out_evicted;
+            else
+                ++out_failed;
+        }
+    }
+
+    // Returns the counter just before the process was created, or nothing when it couldn't start or didn't exit in time
+    std::optional<std::uint64_t> launch(const Options& options, const fs::path& trace)
+    {
+        std::vector<std::string> arguments{ options.executable.string(), "--startup-trace", trace.string(), "--exit-after-startup" };
+        arguments.insert(arguments.end(), options.arguments.begin(), options.arguments.end());
+        const fs::path working_directory = fs::absolute(options.executable).parent_path();
+#if defined(_WIN32)
+        // quoted the way CommandLineToArgvW splits it back
+        std::wstring command_line;
+        for (const std::string& argument : arguments)
+        {
+            if (!command_line.empty())
+                command_line += L' ';
+            command_line += L'"';
+            std::size_t backslashes = 0;
+            for (const wchar_t c : fs::path{ argument }.wstring())
+            {
+                if (c == L'\\')
+                {
+                    ++backslashes;
+                    continue;
+                }
+                command_line.append(c == L'"' ? backslashes * 2 + 1 : backslashes, L'\\');
+                backslashes = 0;
+                command_line += c;
+            }
+            command_line.append(backslashes * 2, L'\\');
+            command_line += L'"';
+        }
+        SECURITY_ATTRIBUTES inherit{ sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+        const HANDLE        null_output = options.verbose ? INVALID_HANDLE_VALUE : CreateFileW(L"NUL", GENERIC_WRITE, FILE_SHARE_WRITE, &inherit, OPEN_EXISTING, 0, nullptr);
+        STARTUPINFOW        startup{};
+        startup.cb = sizeof(startup);
+        if (null_output != INVALID_HANDLE_VALUE)
+        {
+            startup.dwFlags    = STARTF_USESTDHANDLES;
+            startup.hStdInput  = GetStdHandle(STD_INPUT_HANDLE);
+            startup.hStdOutput = null_output;
+            startup.hStdError  = null_output;
+        }
+        PROCESS_INFORMATION process{};
+        const std::uint64_t launched = performance_counter();
+        const BOOL          created  = CreateProcessW(nullptr, command_line.data(), nullptr, nullptr, null_output != INVALID_HANDLE_VALUE, 0, nullptr, working_directory.c_str(), &startup, &process);
+        if (null_output != INVALID_HANDLE_VALUE)
+            CloseHandle(null_output);
+        if (!created)
+        {
+            std::cerr << "Failed to start " << options.executable << " (error " << GetLastError() << ")\n";
+            return std::nullopt;
+        }
+        CloseHandle(process.hThread);
+        const bool exited = WaitForSingleObject(process.hProcess, static_cast<DWORD>(options.timeout_s) * 1000) == WAIT_OBJECT_0;
+        if (!exited)
+        {
+            TerminateProcess(process.hProcess, 1);
+            WaitForSingleObject(process.hProcess, INFINITE);
+        }
+        DWORD exit_code = 0;
+        GetExitCodeProcess(process.hProcess, &exit_code);
+        CloseHandle(process.hProcess);
+#else
+        std::vector<char*> argv;
+        for (std::string& argument : arguments)
+            argv.push_back(argument.data());
+        argv.push_back(nullptr);
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        if (!options.verbose)
+        {
+            posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+            posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+        }
+        // posix_spawn has no working directory of its own, so the executable's path goes in absolute and ours moves
+        const fs::path      previous_directory = fs::current_path();
+        const fs::path      program            = fs::absolute(options.executable);
+        pid_t               child              = 0;
+        const std::uint64_t launched           = performance_counter();
+        fs::current_path(working_directory);
+        const int spawned = posix_spawn(&child, program.c_str(), &actions, nullptr, argv.data(), environ);
+        fs::current_path(previous_directory);
+        posix_spawn_file_actions_destroy(&actions);
+        if (spawned != 0)
+        {
+            std::cerr << "Failed to start " << options.executable << ": " << std::strerror(spawned) << '\n';
+            return std::nullopt;
+        }
+        int        status   = 0;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ options.timeout_s };
+        bool       exited   = false;
+        while (!(exited = waitpid(child, &status, WNOHANG) == child) && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+        if (!exited)
+        {
+            kill(child, SIGKILL);
+            waitpid(child, &status, 0);
+        }
+        const int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+        if (!exited)
+        {
+            std::cerr << "A run didn't finish its startup within " << options.timeout_s << " s\n";
+            return std::nullopt;
+        }
+        if (exit_code != 0)
+        {
+            std::cerr << "A run exited with " << exit_code << '\n';
+            return std::nullopt;
+        }
+        return launched;
+    }
+
+    // The Chrome trace startup_trace writes: flat objects of strings and numbers under "traceEvents", and "otherData"
+    class TraceReader
+    {
+    public:
+        explicit TraceReader(std::string_view json_text) : text{ json_text }
+        {
+        }
+
+        // `launched` is the counter before the process was created, when the trace has the counter at its zero
+        bool Read(std::uint64_t launched, Run& out_run)
+        {
+            std::map<std::string, std::string> other;
+            std::vector<Fields>                events;
+            if (!consume('{'))
+                return false;
+            do
+            {
+                std::string key;
+                if (!string(key) || !consume(':'))
+                    return false;
+                if (key == "otherData")
+                {
+                    if (!object(other))
+                        return false;
+                }
+                else if (key == "traceEvents")
+                {
+                    if (!consume('['))
+                        return false;
+                    if (!consume(']'))
+                    {
+                        do
+                        {
+                            if (!object(events.emplace_back()))
+                                return false;
+                        } while (consume(','));
+                        if (!consume(']'))
+                            return false;
+                    }
+                }
+                else
+                {
+                    std::string ignored;
+                    if (!scalar(ignored))
+                        return false;
+                }
+            } while (consume(','));
+            if (!consume('}'))
+                return false;
+
+            std::uint64_t origin    = 0;
+            std::uint64_t frequency = 0;
+            if (parse_counter(other["origin_counter"], origin) && parse_counter(other["counter_frequency"], frequency) && frequency != 0 && origin >= launched)
+                out_run.launch_ms = static_cast<double>(origin - launched) * 1000.0 / static_cast<double>(frequency);
+            const double zero_ms = std::max(out_run.launch_ms, 0.0);
+            for (Fields& event : events)
+            {
+                const double ts_ms = number(event["ts"]) / 1000.0;
+                const auto&  name  = event["name"];
+                const auto&  phase = event["ph"];
+                if (phase == "i")
+                {
+                    if (name == "window created")
+                        out_run.window_ms = zero_ms + ts_ms;
+                    else if (name == "first frame presented")
+                        out_run.first_frame_ms = zero_ms + ts_ms;
+                    else if (name == "assets loaded")
+                        out_run.assets_ms = zero_ms + ts_ms;
+                }
+                else if (phase == "X" && event["tid"] == "0")
+                {
+                    out_run.main_thread_ms[name] += number(event["dur"]) / 1000.0;
+                }
+            }
+            return out_run.first_frame_ms >= 0.0 && out_run.assets_ms >= 0.0;
+        }
+
+    private:
+        using Fields = std::map<std::string, std::string>;
+
+        static bool parse_counter(const std::string& digits, std::uint64_t& out_value)
+        {
+            const auto [ptr, error] = std::from_chars(digits.data(), digits.data() + digits.size(), out_value);
+            return error == std::errc{} && ptr == digits.data() + digits.size() && !digits.empty();
+        }
+
+        static double number(const std::string& digits)
+        {
+            double value = 0.0;
+            std::from_chars(digits.data(), digits.data() + digits.size(), value);
+            return value;
+        }
+
+        void skipSpace()
+        {
+            while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+                ++position;
+        }
+
+        bool consume(char expected)
+        {
+            skipSpace();
+            if (position >= text.size() || text[position] != expected)
+                return false;
+            ++position;
+            return true;
+        }
+
+        // startup_trace only escapes quotes and backslashes
+        bool string(std::string& out_text)
+        {
+            if (!consume('"'))
+                return false;
+            out_text.clear();
+            while (position < text.size() && text[position] != '"')
+            {
+                if (text[position] == '\\' && position + 1 < text.size())
+                    ++position;
+                out_text += text[position++];
+            }
+            return position++ < text.size();
+        }
+
+        // a string's contents or a number's text; an object's fields go in `out_text` as nothing, since only the
+        // events' own are needed ("args" is skipped)
+        bool scalar(std::string& out_text)
+        {
+            skipSpace();
+            if (position >= text.size())
+                return false;
+            if (text[position] == '"')
+                return string(out_text);
+            if (text[position] == '{')
+            {
+                Fields ignored;
+                return object(ignored);
+            }
+            const std::size_t begin = position;
+            while (position < text.size() && text[position] != ',' && text[position] != '}' && text[position] != ']' && !std::isspace(static_cast<unsigned char>(text[position])))
+                ++position;
+            out_text = text.substr(begin, position - begin);
+            return position > begin;
+        }
+
+        bool object(Fields& out_fields)
+        {
+            if (!consume('{'))
+                return false;
+            if (consume('}'))
+                return true;
+            do
+            {
+                std::string key;
+                if (!string(key) || !consume(':') || !scalar(out_fields[key]))
+                    return false;
+            } while (consume(','));
+            return consume('}');
+        }
+
+    private:
+        std::string_view text;
+        std::size_t      position = 0;
+    };
+
+    bool read_trace(const fs::path& file, std::uint64_t launched, Run& out_run)
+    {
+        std::ifstream in{ file, std::ios::binary };
+        if (!in)
+        {
+            std::cerr << "The run wrote no startup trace to " << file << '\n';
+            return false;
+        }
+        std::ostringstream contents;
+        contents << in.rdbuf();
+        const std::string json = contents.str();
+        if (!TraceReader{ json }.Read(launched, out_run))
+        {
+            std::cerr << file << " isn't a complete startup trace\n";
+            return false;
+        }
+        return true;
+    }
+
+    double percentile_of(std::vector<double> values, double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        const double position = fraction * static_cast<double>(values.size() - 1);
+        const auto   below    = static_cast<std::size_t>(position);
+        const auto   above    = std::min(below + 1, values.size() - 1);
+        return values[below] + (values[above] - values[below]) * (position - static_cast<double>(below));
+    }
+
+    std::vector<double> column_of(const std::vector<Run>& runs, double Run::*ms)
+    {
+        std::vector<double> values;
+        for (const Run& run : runs)
+        {
+            if (run.*ms >= 0.0)
+                values.push_back(run.*ms);
+        }
+        return values;
+    }
+
+    void print_distribution(std::string_view name, const std::vector<double>& values)
+    {
+        std::cout << "  " << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(1);
+        if (values.empty())
+        {
+            std::cout << std::setw(10) << "-" << '\n';
+            return;
+        }
+        const double mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+        std::cout << std::setw(10) << percentile_of(values, 0.0) << std::setw(10) << percentile_of(values, 0.5) << std::setw(10) << percentile_of(values, 0.9) << std::setw(10)
+                  << percentile_of(values, 1.0) << std::setw(10) << mean << '\n';
+    }
+
+    void print_runs(std::string_view title, const std::vector<Run>& runs)
+    {
+        if (runs.empty())
+            return;
+        std::cout << '\n' << title << ", " << runs.size() << " run(s), ms from launch\n";
+        std::cout << "  " << std::left << std::setw(26) << "milestone" << std::right << std::setw(10) << "min" << std::setw(10) << "median" << std::setw(10) << "p90" << std::setw(10)
+                  << "max" << std::setw(10) << "mean" << '\n';
+        for (const Milestone& milestone : MILESTONES)
+            print_distribution(milestone.name, column_of(runs, milestone.ms));
+    }
+
+    // The main thread's steps, slowest warm median first, side by side so a regression shows where it came from
+    void print_steps(const std::vector<Run>& cold, const std::vector<Run>& warm)
+    {
+        std::map<std::string, std::pair<std::vector<double>, std::vector<double>>> steps;
+        for (const Run& run : cold)
+        {
+            for (const auto& [name, ms] : run.main_thread_ms)
+                steps[name].first.push_back(ms);
+        }
+        for (const Run& run : warm)
+        {
+            for (const auto& [name, ms] : run.main_thread_ms)
+                steps[name].second.push_back(ms);
+        }
+        struct Step
+        {
+            std::string name;
+            double      cold = -1.0;
+            double      warm = -1.0;
+        };
+        std::vector<Step> rows;
+        for (const auto& [name, samples] : steps)
+        {
+            rows.push_back(Step{ name, samples.first.empty() ? -1.0 : percentile_of(samples.first, 0.5), samples.second.empty() ? -1.0 : percentile_of(samples.second, 0.5) });
+        }
+        std::sort(rows.begin(), rows.end(), [](const Step& a, const Step& b) { return std::max(a.warm, a.cold) > std::max(b.warm, b.cold); });
+
+        std::cout << "\nmain thread steps, median ms\n";
+        std::cout << "  " << std::left << std::setw(26) << "step" << std::right << std::setw(10) << "cold" << std::setw(10) << "warm" << '\n';
+        for (const Step& row : rows)
+        {
+            std::cout << "  " << std::left << std::setw(26) << row.name << std::right << std::fixed << std::setprecision(1);
+            for (const double ms : { row.cold, row.warm })
+            {
+                if (ms < 0.0)
+                    std::cout << std::setw(10) << "-";
+                else
+                    std::cout << std::setw(10) << ms;
+            }
+            std::cout << '\n';
+        }
+    }
+
+    // Every run's milestones, for benchmark-compare's kind of tooling or a spreadsheet
+    bool write_report(const fs::path& file, const std::vector<Run>& cold, const std::vector<Run>& warm)
+    {
+        std::ofstream out{ file };
+        if (!out)
+        {
+            std::cerr << "Failed to write " << file << '\n';
+            return false;
+        }
+        static constexpr const char* KEYS[] = { "process_to_main_ms", "window_ms", "first_frame_ms", "assets_loaded_ms" };
+        out << "{\n";
+        for (const auto& [side, runs] : { std::pair{ "cold", &cold }, std::pair{ "warm", &warm } })
+        {
+            out << "  \"" << side << "\": {";
+            for (std::size_t k = 0; k < std::size(MILESTONES); ++k)
+            {
+                const std::vector<double> values = column_of(*runs, MILESTONES[k].ms);
+                out << (k == 0 ? "\n" : ",\n") << "    \"" << KEYS[k] << "\": [";
+                for (std::size_t i = 0; i < values.size(); ++i)
+                    out << (i == 0 ? "" : ", ") << values[i];
+                out << ']';
+            }
+            out << (side == std::string_view{ "cold" } ? "\n  },\n" : "\n  }\n");
+        }
+        out << "}\n";
+        return static_cast<bool>(out);
+    }
+}
+
+int main(int argc, char* argv[])
+try
+{
+    if (argc < 2 || std::string_view{ argv[1] } == "--help")
+    {
+        print_usage();
+        return argc < 2 ? 1 : 0;
+    }
+    Options options;
+    if (const char* cold = find_option(argc, argv, "--cold"); cold != nullptr && !parse_count(cold, options.cold_runs))
+    {
+        print_usage();
+        return 1;
+    }
+    if (const char* warm = find_option(argc, argv, "--warm"); warm != nullptr && !parse_count(warm, options.warm_runs))
+    {
+        print_usage();
+        return 1;
+    }
+    if (const char* timeout = find_option(argc, argv, "--timeout"); timeout != nullptr && (!parse_count(timeout, options.timeout_s) || options.timeout_s == 0))
+    {
+        print_usage();
+        return 1;
+    }
+    if (const char* report = find_option(argc, argv, "--report"); report != nullptr)
+        options.report = report;
+    if (!parse_arguments(argc, argv, options) || options.cold_runs + options.warm_runs == 0)
+    {
+        print_usage();
+        return 1;
+    }
+    if (!fs::is_regular_file(options.executable))
+    {
+        std::cerr << "No executable at " << options.executable << '\n';
+        return 1;
+    }
+
+    // the decoded cache sits beside the executable's directory; see decoded_cache
+    const fs::path game_directory = fs::absolute(options.executable).parent_path();
+    const fs::path cache          = game_directory.parent_path() / "decoded_cache";
+    const fs::path trace          = fs::temp_directory_path() / "startup-benchmark-trace.json";
+    std::vector<Run> cold;
+    std::vector<Run> warm;
+    int              failed = 0;
+    for (int i = 0; i < options.cold_runs + options.warm_runs; ++i)
+    {
+        const bool is_cold = i < options.cold_runs;
+        std::cout << (is_cold ? "cold" : "warm") << " run " << (is_cold ? i + 1 : i - options.cold_runs + 1) << "..." << std::flush;
+        if (is_cold)
+        {
+            int evicted = 0;
+            int missed  = 0;
+            evict_directory(game_directory, evicted, missed);
+            evict_directory(cache, evicted, missed);
+            std::cout << " dropped " << evicted << " file(s) from the cache";
+            if (missed > 0)
+                std::cout << ", " << missed << " couldn't be";
+            std::cout << "..." << std::flush;
+        }
+        std::error_code error;
+        fs::remove(trace, error);
+        Run                                run;
+        const std::optional<std::uint64_t> launched = launch(options, trace);
+        if (!launched || !read_trace(trace, *launched, run))
+        {
+            ++failed;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(1) << " first frame " << run.first_frame_ms << " ms, assets " << run.assets_ms << " ms\n";
+        (is_cold ? cold : warm).push_back(std::move(run));
+    }
+    std::error_code error;
+    fs::remove(trace, error);
+
+    print_runs("cold", cold);
+    print_runs("warm", warm);
+    if (!cold.empty() || !warm.empty())
+        print_steps(cold, warm);
+    if (!options.report.empty() && write_report(options.report, cold, warm))
+        std::cout << "\nReport written to " << options.report << '\n';
+    if (failed > 0)
+    {
+        std::cout << failed << " run(s) failed and were left out\n";
+        return 1;
+    }
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cerr << e.what() << '\n';
+    return -1;
+}
@@ -0,0 +1,227 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "telemetry_protocol.h"
+#include "udp_socket.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    namespace fs    = std::filesystem;
+    using Clock     = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    // an instance this long without a datagram is shown as quiet, and this much longer is forgotten
+    constexpr std::chrono::seconds QUIET_AFTER{ 3 };
+    constexpr std::chrono::seconds FORGET_AFTER{ 60 };
+
+    struct Options
+    {
+        std::uint16_t port    = telemetry::DEFAULT_PORT;
+        double        seconds = 0.0; // 0 to run until killed
+        fs::path      csv;
+    };
+
+    struct Instance
+    {
+        std::string        from;
+        telemetry::Summary latest;
+        TimePoint          last_heard{};
+        std::uint64_t      received      = 0;
+        std::uint64_t      lost          = 0; // sequence numbers skipped over
+        std::uint64_t      frames_period = 0; // since the last table
+        float              worst_period  = 0.0f;
+    };
+
+    void print_usage()
+    {
+        std::cout << "usage: telemetry-aggregator [--port N] [--csv out.csv] [--seconds N]\n"
+                     "Listens for the datagrams programming-fun sends with --telemetry host:port and prints one row per\n"
+                     "running instance every second: frame rate, mean and worst frame, CPU and GPU time, memory, draws and loads,\n"
+                     "with the perf counters it publishes on a line under it. With --csv every datagram is also appended as a row,\n"
+                     "the counters as name=value pairs in the last column. The port defaults to "
+                  << telemetry::DEFAULT_PORT << ".\n";
+    }
+
+    const char* find_option(int argc, char* argv[], std::string_view name)
+    {
+        for (int i = 1; i + 1 < argc; ++i)
+        {
+            if (argv[i] == name)
+                return argv[i + 1];
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    bool parse_number(const char* text, T& out_value)
+    {
+        const auto end          = text + std::strlen(text);
+        const auto [ptr, error] = std::from_chars(text, end, out_value);
+        return error == std::errc{} && ptr == end;
+    }
+
+    void record(Instance& instance, const telemetry::Summary& summary, std::string_view from, TimePoint now)
+    {
+        // a restarted instance picks a new id, so a sequence going backwards is only ever reordering
+        if (instance.received > 0 && summary.sequence > instance.latest.sequence + 1)
+            instance.lost += summary.sequence - instance.latest.sequence - 1;
+        if (instance.received == 0 || summary.sequence > instance.latest.sequence)
+            instance.latest = summary;
+        // the dual stack socket reports IPv4 senders as mapped IPv6 addresses
+        if (from.starts_with("::ffff:"))
+            from.remove_prefix(7);
+        instance.from       = from;
+        instance.last_heard = now;
+        ++instance.received;
+        instance.frames_period += summary.frames;
+        instance.worst_period = std::max(instance.worst_period, summary.frame_max_ms);
+    }
+
+    void print_table(std::map<std::uint32_t, Instance>& instances, double period_seconds, TimePoint now)
+    {
+        std::cout << '\n'
+                  << std::left << std::setw(10) << "instance" << std::setw(24) << "from" << std::right << std::setw(8) << "fps" << std::setw(9) << "frame" << std::setw(9) << "worst"
+                  << std::setw(9) << "cpu" << std::setw(9) << "gpu" << std::setw(10) << "MB" << std::setw(7) << "draws" << std::setw(8) << "loads" << std::setw(7) << "lost" << '\n';
+        for (auto it = instances.begin(); it != instances.end();)
+        {
+            Instance& instance = it->second;
+            if (now - instance.last_heard > FORGET_AFTER)
+            {
+                it = instances.erase(it);
+                continue;
+            }
+            const telemetry::Summary& latest = instance.latest;
+            std::cout << std::left << std::hex << std::setw(10) << it->first << std::dec << std::setw(24) << instance.from << std::right << std::fixed << std::setprecision(1);
+            if (now - instance.last_heard > QUIET_AFTER)
+                std::cout << std::setw(8) << "quiet";
+            else
+                std::cout << std::setw(8) << static_cast<double>(instance.frames_period) / period_seconds;
+            std::cout << std::setprecision(2) << std::setw(9) << latest.frame_ms << std::setw(9) << instance.worst_period << std::setw(9) << latest.cpu_ms;
+            if (latest.gpu_ms >= 0.0f)
+                std::cout << std::setw(9) << latest.gpu_ms;
+            else
+                std::cout << std::setw(9) << "-";
+            std::cout << std::setprecision(1) << std::setw(10) << static_cast<double>(latest.memory_bytes) / (1024.0 * 1024.0) << std::setw(7) << latest.draw_calls << std::setw(8)
+                      << (std::to_string(latest.loads_active) + "/" + std::to_string(latest.loads_queued)) << std::setw(7) << instance.lost << '\n';
+            if (latest.counter_count > 0)
+            {
+                std::cout << std::left << std::setw(10) << "";
+                for (int c = 0; c < latest.counter_count; ++c)
+                {
+                    const telemetry::Counter& counter = latest.counters[static_cast<std::size_t>(c)];
+                    std::cout << (c == 0 ? "" : ", ") << counter.name.data() << ' ' << counter.value;
+                }
+                std::cout << std::right << '\n';
+            }
+            instance.frames_period = 0;
+            instance.worst_period  = 0.0f;
+            ++it;
+        }
+        if (instances.empty())
+            std::cout << "(nothing heard yet)\n";
+    }
+}
+
+int main(int argc, char* argv[])
+try
+{
+    if (find_option(argc, argv, "--help") != nullptr || (argc > 1 && std::string_view{ argv[1] } == "--help"))
+    {
+        print_usage();
+        return 0;
+    }
+    Options options;
+    if (const char* port = find_option(argc, argv, "--port"); port != nullptr && (!parse_number(port, options.port) || options.port == 0))
+    {
+        print_usage();
+        return 1;
+    }
+    if (const char* seconds = find_option(argc, argv, "--seconds"); seconds != nullptr && (!parse_number(seconds, options.seconds) || options.seconds < 0.0))
+    {
+        print_usage();
+        return 1;
+    }
+    if (const char* csv = find_option(argc, argv, "--csv"); csv != nullptr)
+        options.csv = csv;
+
+    UdpSocket socket;
+    if (!socket.Bind(options.port))
+    {
+        std::cerr << "Failed to listen on UDP port " << options.port << '\n';
+        return 1;
+    }
+    std::ofstream csv;
+    if (!options.csv.empty())
+    {
+        csv.open(options.csv);
+        if (!csv)
+        {
+            std::cerr << "Failed to open " << options.csv << '\n';
+            return 1;
+        }
+        csv << "seconds,instance,from,sequence,last_frame,frames,frame_ms,frame_max_ms,cpu_ms,cpu_max_ms,gpu_ms,gpu_max_ms,memory_bytes,draw_calls,loads_queued,loads_active,counters\n";
+    }
+    std::cout << "Listening for telemetry on UDP port " << options.port << '\n';
+
+    std::map<std::uint32_t, Instance>                         instances;
+    std::array<unsigned char, telemetry::MAX_PACKET_SIZE + 1> buffer{}; // one more so a longer datagram doesn't pass for ours
+    std::uint64_t                                             ignored    = 0;
+    const TimePoint                                           started    = Clock::now();
+    TimePoint                                                 last_table = started;
+    while (options.seconds <= 0.0 || std::chrono::duration<double>(Clock::now() - started).count() < options.seconds)
+    {
+        std::string from;
+        const int   size = socket.Receive(buffer, 100, &from);
+        const auto  now  = Clock::now();
+        if (telemetry::Summary summary; size >= 0 && telemetry::Decode(std::span{ buffer.data(), static_cast<std::size_t>(size) }, summary))
+        {
+            record(instances[summary.instance], summary, from, now);
+            if (csv)
+                csv << std::chrono::duration<double>(now - started).count() << ',' << std::hex << summary.instance << std::dec << ',' << from << ',' << summary.sequence << ','
+                    << summary.last_frame << ',' << summary.frames << ',' << summary.frame_ms << ',' << summary.frame_max_ms << ',' << summary.cpu_ms << ',' << summary.cpu_max_ms
+                    << ',' << summary.gpu_ms << ',' << summary.gpu_max_ms << ',' << summary.memory_bytes << ',' << summary.draw_calls << ',' << summary.loads_queued << ','
+                    << summary.loads_active << ',';
+            for (int c = 0; c < summary.counter_count; ++c)
+            {
+                const telemetry::Counter& counter = summary.counters[static_cast<std::size_t>(c)];
+                csv << (c == 0 ? "" : ";") << counter.name.data() << '=' << counter.value;
+            }
+            csv << '\n';
+        }
+        else if (size >= 0)
+        {
+            ++ignored;
+        }
+        if (const double period = std::chrono::duration<double>(now - last_table).count(); period >= 1.0)
+        {
+            print_table(instances, period, now);
+            if (ignored > 0)
+                std::cout << ignored << " datagrams that weren't telemetry ignored\n";
+            last_table = now;
+        }
+    }
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cerr << e.what() << '\n';
+    return -1;
+}
@@ -0,0 +1,423 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "block_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace
+{
+    // 16 RGBA texels in raster order
+    using Block = std::array<std::array<int, 4>, 16>;
+
+    Block fetch_block(const unsigned char* rgba, int width, int height, int block_x, int block_y)
+    {
+        Block block{};
+        for (int y = 0; y < 4; ++y)
+        {
+            for (int x = 0; x < 4; ++x)
+            {
+                // partial edge blocks repeat the last row/column
+                const int   source_x = std::min(block_x * 4 + x, width - 1);
+                const int   source_y = std::min(block_y * 4 + y, height - 1);
+                const auto* texel    = rgba + (static_cast<std::size_t>(source_y) * static_cast<std::size_t>(width) + static_cast<std::size_t>(source_x)) * 4;
+                for (int c = 0; c < 4; ++c)
+                    block[static_cast<std::size_t>(y * 4 + x)][static_cast<std::size_t>(c)] = texel[c];
+            }
+        }
+        return block;
+    }
+
+    template <typename EncodeBlock>
+    std::vector<unsigned char> encode_image(const unsigned char* rgba, int width, int height, EncodeBlock encode_block)
+    {
+        const int                  blocks_x = (width + 3) / 4;
+        const int                  blocks_y = (height + 3) / 4;
+        std::vector<unsigned char> result(static_cast<std::size_t>(blocks_x) * static_cast<std::size_t>(blocks_y) * 16);
+        unsigned char*             out = result.data();
+        for (int by = 0; by < blocks_y; ++by)
+        {
+            for (int bx = 0; bx < blocks_x; ++bx)
+            {
+                encode_block(fetch_block(rgba, width, height, bx, by), out);
+                out += 16;
+            }
+        }
+        return result;
+    }
+
+    int clamp_byte(int value) noexcept
+    {
+        return std::clamp(value, 0, 255);
+    }
+
+    int squared(int value) noexcept
+    {
+        return value * value;
+    }
+
+    void store_big_endian(std::uint64_t bits, unsigned char* out) noexcept
+    {
+        for (int i = 0; i < 8; ++i)
+            out[i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+    }
+
+    void store_little_endian(std::uint64_t bits, unsigned char* out, int byte_count) noexcept
+    {
+        for (int i = 0; i < byte_count; ++i)
+            out[i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+
+    // --- BC3 ----------------------------------------------------------------------------------
+
+    void encode_bc3_alpha(const Block& block, unsigned char* out)
+    {
+        int lowest  = 255;
+        int highest = 0;
+        for (const auto& texel : block)
+        {
+            lowest  = std::min(lowest, texel[3]);
+            highest = std::max(highest, texel[3]);
+        }
+
+        // a0 > a1 selects the 8 value mode: both endpoints plus 6 interpolated steps
+        int palette[8] = { highest, lowest };
+        for (int i = 2; i < 8; ++i)
+            palette[i] = ((8 - i) * highest + (i - 1) * lowest + 3) / 7;
+
+        std::uint64_t bits = static_cast<std::uint64_t>(highest) | (static_cast<std::uint64_t>(lowest) << 8);
+        for (std::size_t p = 0; p < block.size() && highest != lowest; ++p)
+        {
+            int best = 0;
+            for (int i = 1; i < 8; ++i)
+            {
+                if (std::abs(palette[i] - block[p][3]) < std::abs(palette[best] - block[p][3]))
+                    best = i;
+            }
+            bits |= static_cast<std::uint64_t>(best) << (16 + 3 * p);
+        }
+        store_little_endian(bits, out, 8);
+    }
+
+    std::uint16_t to_565(const float color[3]) noexcept
+    {
+        const auto r = static_cast<std::uint16_t>(std::lround(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f));
+        const auto g = static_cast<std::uint16_t>(std::lround(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f));
+        const auto b = static_cast<std::uint16_t>(std::lround(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f));
+        return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    std::array<int, 3> from_565(std::uint16_t color) noexcept
+    {
+        const int r = (color >> 11) & 31;
+        const int g = (color >> 5) & 63;
+        const int b = color & 31;
+        return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+    }
+
+    void encode_bc3_color(const Block& block, unsigned char* out)
+    {
+        float mean[3] = { 0.0f, 0.0f, 0.0f };
+        for (const auto& texel : block)
+        {
+            for (int c = 0; c < 3; ++c)
+                mean[c] += static_cast<float>(texel[static_cast<std::size_t>(c)]) / 16.0f;
+        }
+
+        float covariance[3][3] = {};
+        for (const auto& texel : block)
+        {
+            const float d[3] = { static_cast<float>(texel[0]) - mean[0], static_cast<float>(texel[1]) - mean[1], static_cast<float>(texel[2]) - mean[2] };
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                    covariance[i][j] += d[i] * d[j];
+            }
+        }
+
+        // power iteration for the principal axis, the endpoints are the extreme projections on it
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[3] = {};
+            for (int i = 0; i < 3; ++i)
+                next[i] = covariance[i][0] * axis[0] + covariance[i][1] * axis[1] + covariance[i][2] * axis[2];
+            const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+            if (length < 1e-6f)
+                break;
+            for (int i = 0; i < 3; ++i)
+                axis[i] = next[i] / length;
+        }
+
+        float lowest  = std::numeric_limits<float>::max();
+        float highest = std::numeric_limits<float>::lowest();
+        for (const auto& texel : block)
+        {
+            const float t = (static_cast<float>(texel[0]) - mean[0]) * axis[0] + (static_cast<float>(texel[1]) - mean[1]) * axis[1] + (static_cast<float>(texel[2]) - mean[2]) * axis[2];
+            lowest        = std::min(lowest, t);
+            highest       = std::max(highest, t);
+        }
+        const float   end0[3] = { mean[0] + axis[0] * highest, mean[1] + axis[1] * highest, mean[2] + axis[2] * highest };
+        const float   end1[3] = { mean[0] + axis[0] * lowest, mean[1] + axis[1] * lowest, mean[2] + axis[2] * lowest };
+        std::uint16_t color0  = to_565(end0);
+        std::uint16_t color1  = to_565(end1);
+        if (color0 < color1)
+            std::swap(color0, color1);
+
+        const auto         c0         = from_565(color0);
+        const auto         c1         = from_565(color1);
+        std::array<int, 3> palette[4] = { c0, c1, {}, {} };
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * c0[c] + c1[c] + 1) / 3;
+            palette[3][c] = (c0[c] + 2 * c1[c] + 1) / 3;
+        }
+
+        std::uint64_t bits = static_cast<std::uint64_t>(color0) | (static_cast<std::uint64_t>(color1) << 16);
+        for (std::size_t p = 0; p < block.size() && color0 != color1; ++p)
+        {
+            int best       = 0;
+            int best_error = std::numeric_limits<int>::max();
+            for (int i = 0; i < 4; ++i)
+            {
+                const auto& entry = palette[i];
+                const int   error = squared(entry[0] - block[p][0]) + squared(entry[1] - block[p][1]) + squared(entry[2] - block[p][2]);
+                if (error < best_error)
+                {
+                    best       = i;
+                    best_error = error;
+                }
+            }
+            bits |= static_cast<std::uint64_t>(best) << (32 + 2 * p);
+        }
+        store_little_endian(bits, out, 8);
+    }
+
+    // --- ETC2 RGBA8 EAC ------------------------------------------------------------------------
+
+    constexpr int ETC1_MODIFIERS[8][4] = {
+        { 2, 8, -2, -8 },     { 5, 17, -5, -17 },   { 9, 29, -9, -29 },   { 13, 42, -13, -42 },
+        { 18, 60, -18, -60 }, { 24, 80, -24, -80 }, { 33, 106, -33, -106 }, { 47, 183, -47, -183 },
+    };
+
+    constexpr int EAC_MODIFIERS[16][8] = {
+        { -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 }, { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+        { -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 },  { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+        { -2, -6, -8, -10, 1, 5, 7, 9 },  { -2, -5, -8, -10, 1, 4, 7, 9 },   { -2, -4, -8, -10, 1, 3, 7, 9 },  { -2, -5, -7, -10, 1, 4, 6, 9 },
+        { -3, -4, -7, -10, 2, 3, 6, 9 },  { -1, -2, -3, -10, 0, 1, 2, 9 },   { -4, -6, -8, -9, 3, 5, 7, 8 },   { -3, -5, -7, -9, 2, 4, 6, 8 },
+    };
+
+    // ETC and EAC index pixels column by column
+    constexpr std::size_t column_major(std::size_t raster) noexcept
+    {
+        return (raster % 4) * 4 + raster / 4;
+    }
+
+    void encode_eac_alpha(const Block& block, unsigned char* out)
+    {
+        int lowest  = 255;
+        int highest = 0;
+        for (const auto& texel : block)
+        {
+            lowest  = std::min(lowest, texel[3]);
+            highest = std::max(highest, texel[3]);
+        }
+
+        int best_error      = std::numeric_limits<int>::max();
+        int best_base       = highest;
+        int best_multiplier = 1;
+        int best_table      = 13; // has a 0 modifier, so a flat block is exact
+        for (int table = 0; table < 16 && lowest != highest; ++table)
+        {
+            const int span  = EAC_MODIFIERS[table][7] - EAC_MODIFIERS[table][3];
+            const int guess = std::clamp((highest - lowest + span / 2) / span, 1, 15);
+            for (int multiplier = std::max(1, guess - 1); multiplier <= std::min(15, guess + 1); ++multiplier)
+            {
+                const int centre = lowest - EAC_MODIFIERS[table][3] * multiplier;
+                for (int base = clamp_byte(centre - 2); base <= clamp_byte(centre + 2); ++base)
+                {
+                    int error = 0;
+                    for (const auto& texel : block)
+                    {
+                        int texel_error = std::numeric_limits<int>::max();
+                        for (int modifier : EAC_MODIFIERS[table])
+                            texel_error = std::min(texel_error, squared(clamp_byte(base + modifier * multiplier) - texel[3]));
+                        error += texel_error;
+                    }
+                    if (error < best_error)
+                    {
+                        best_error      = error;
+                        best_base       = base;
+                        best_multiplier = multiplier;
+                        best_table      = table;
+                    }
+                }
+            }
+        }
+
+        std::uint64_t bits = (static_cast<std::uint64_t>(best_base) << 56) | (static_cast<std::uint64_t>(best_multiplier) << 52) | (static_cast<std::uint64_t>(best_table) << 48);
+        for (std::size_t p = 0; p < block.size(); ++p)
+        {
+            int best       = 0;
+            int best_delta = std::numeric_limits<int>::max();
+            for (int i = 0; i < 8; ++i)
+            {
+                const int delta = std::abs(clamp_byte(best_base + EAC_MODIFIERS[best_table][i] * best_multiplier) - block[p][3]);
+                if (delta < best_delta)
+                {
+                    best       = i;
+                    best_delta = delta;
+                }
+            }
+            bits |= static_cast<std::uint64_t>(best) << (45 - 3 * column_major(p));
+        }
+        store_big_endian(bits, out);
+    }
+
+    struct SubBlockFit
+    {
+        int           error = std::numeric_limits<int>::max();
+        int           table = 0;
+        std::uint32_t msb   = 0;
+        std::uint32_t lsb   = 0;
+    };
+
+    bool in_sub_block(std::size_t raster, bool flip, int sub_block) noexcept
+    {
+        const auto x = raster % 4;
+        const auto y = raster / 4;
+        return ((flip ? y : x) >= 2) == (sub_block == 1);
+    }
+
+    SubBlockFit fit_sub_block(const Block& block, bool flip, int sub_block, const std::array<int, 3>& base)
+    {
+        SubBlockFit best;
+        for (int table = 0; table < 8; ++table)
+        {
+            SubBlockFit fit;
+            fit.error = 0;
+            fit.table = table;
+            for (std::size_t p = 0; p < block.size(); ++p)
+            {
+                if (!in_sub_block(p, flip, sub_block))
+                    continue;
+                int best_index = 0;
+                int best_error = std::numeric_limits<int>::max();
+                for (int i = 0; i < 4; ++i)
+                {
+                    const int modifier = ETC1_MODIFIERS[table][i];
+                    const int error    = squared(clamp_byte(base[0] + modifier) - block[p][0]) + squared(clamp_byte(base[1] + modifier) - block[p][1]) + squared(clamp_byte(base[2] + modifier) - block[p][2]);
+                    if (error < best_error)
+                    {
+                        best_index = i;
+                        best_error = error;
+                    }
+                }
+                fit.error += best_error;
+                fit.msb |= static_cast<std::uint32_t>(best_index >> 1) << column_major(p);
+                fit.lsb |= static_cast<std::uint32_t>(best_index & 1) << column_major(p);
+            }
+            if (fit.error < best.error)
+                best = fit;
+        }
+        return best;
+    }
+
+    // Individual and differential modes only; they decode identically on ETC1 and ETC2 hardware
+    void encode_etc2_color(const Block& block, unsigned char* out)
+    {
+        int           best_error = std::numeric_limits<int>::max();
+        std::uint64_t best_bits  = 0;
+        for (const bool flip : { false, true })
+        {
+            float average[2][3] = {};
+            for (std::size_t p = 0; p < block.size(); ++p)
+            {
+                const int sub_block = in_sub_block(p, flip, 1) ? 1 : 0;
+                for (std::size_t c = 0; c < 3; ++c)
+                    average[sub_block][c] += static_cast<float>(block[p][c]) / 8.0f;
+            }
+
+            for (const bool differential : { true, false })
+            {
+                const float        levels = differential ? 31.0f : 15.0f;
+                std::array<int, 3> quantized[2];
+                std::array<int, 3> base[2];
+                bool               representable = true;
+                for (int s = 0; s < 2; ++s)
+                {
+                    for (std::size_t c = 0; c < 3; ++c)
+                    {
+                        const int q     = static_cast<int>(std::lround(average[s][c] * levels / 255.0f));
+                        quantized[s][c] = q;
+                        base[s][c]      = differential ? (q << 3) | (q >> 2) : q * 17;
+                    }
+                }
+                for (std::size_t c = 0; c < 3 && differential; ++c)
+                {
+                    const int delta = quantized[1][c] - quantized[0][c];
+                    representable   = representable && delta >= -4 && delta <= 3;
+                }
+                if (!representable)
+                    continue;
+
+                const SubBlockFit first  = fit_sub_block(block, flip, 0, base[0]);
+                const SubBlockFit second = fit_sub_block(block, flip, 1, base[1]);
+                if (first.error + second.error >= best_error)
+                    continue;
+
+                std::uint64_t bits = 0;
+                for (std::size_t c = 0; c < 3; ++c)
+                {
+                    const int shift = 59 - 8 * static_cast<int>(c);
+                    if (differential)
+                    {
+                        const auto delta = static_cast<std::uint64_t>((quantized[1][c] - quantized[0][c]) & 7);
+                        bits |= (static_cast<std::uint64_t>(quantized[0][c]) << shift) | (delta << (shift - 3));
+                    }
+                    else
+                    {
+                        bits |= (static_cast<std::uint64_t>(quantized[0][c]) << (shift + 1)) | (static_cast<std::uint64_t>(quantized[1][c]) << (shift - 3));
+                    }
+                }
+                bits |= static_cast<std::uint64_t>(first.table) << 37 | static_cast<std::uint64_t>(second.table) << 34;
+                bits |= static_cast<std::uint64_t>(differential ? 1 : 0) << 33 | static_cast<std::uint64_t>(flip ? 1 : 0) << 32;
+                bits |= static_cast<std::uint64_t>(first.msb | second.msb) << 16 | static_cast<std::uint64_t>(first.lsb | second.lsb);
+                best_error = first.error + second.error;
+                best_bits  = bits;
+            }
+        }
+        store_big_endian(best_bits, out);
+    }
+}
+
+namespace block_compression
+{
+    std::vector<unsigned char> EncodeBC3(const unsigned char* rgba, int width, int height)
+    {
+        return encode_image(rgba, width, height,
+                            [](const Block& block, unsigned char* out)
+                            {
+                                encode_bc3_alpha(block, out);
+                                encode_bc3_color(block, out + 8);
+                            });
+    }
+
+    std::vector<unsigned char> EncodeETC2(const unsigned char* rgba, int width, int height)
+    {
+        return encode_image(rgba, width, height,
+                            [](const Block& block, unsigned char* out)
+                            {
+                                encode_eac_alpha(block, out);
+                                encode_etc2_color(block, out + 8);
+                            });
+    }
+}
@@ -0,0 +1,24 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#pragma once
+
+#include <vector>
+
+/**
+ * Offline 4x4 block encoders for RGBA8 images.
+ *
+ * BC3 (desktop) uses a principal axis fit for color and min/max for alpha.
+ * ETC2 RGBA8 EAC (WebGL2) uses the ETC1-compatible individual/differential modes plus an exhaustive EAC alpha search.
+ * Both favour simplicity over quality; BC7 and ASTC are better produced with external tools and dropped in with
+ * the same file naming.
+ */
+namespace block_compression
+{
+    std::vector<unsigned char> EncodeBC3(const unsigned char* rgba, int width, int height);
+    std::vector<unsigned char> EncodeETC2(const unsigned char* rgba, int width, int height);
+}
@@ -0,0 +1,286 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Fall
+ * \copyright DigiPen Institute of Technology
+ */
+
+#include "block_compression.h"
+#include "ktx2.h"
+#include "mip_chain.h"
+#include "qoi_strips.h"
+#include "tiled_image.h"
+#include "video_clip.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <stb_image.h>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        bool                               bc3              = true;
+        bool                               etc2             = true;
+        bool                               mipmaps          = true;
+        bool                               tiles            = false; // a streaming tile pyramid instead of the KTX2 files
+        bool                               qoi              = false; // and <name>.qois for the RGBA8 path
+        std::uint32_t                      rate_numerator   = 0;     // --clip: frames per second, each directory a clip of its PNGs
+        std::uint32_t                      rate_denominator = 1;
+        std::vector<std::filesystem::path> inputs;
+    };
+
+    void print_usage()
+    {
+        std::cout << "usage: texture-converter [--format bc3|etc2|all] [--no-mips] [--qoi] [--tiles] <image.png | directory>...\n"
+                     "       texture-converter --clip <fps> <directory>...\n"
+                     "Writes <name>.bc3.ktx2 and/or <name>.etc2.ktx2 next to every PNG.\n"
+                     "The game prefers these over the PNG when the GPU supports the format.\n"
+                     "With --qoi, also writes <name>.qois, which the game decodes in parallel strips instead of the PNG where it needs RGBA8.\n"
+                     "With --tiles, writes <name>.tiles instead: the tile pyramid the Virtual Texture demo streams.\n"
+                     "With --clip, writes <directory>.clip from the PNG frames in it, in name order, at <fps> (24, or 30000/1001):\n"
+                     "the video the Video demo plays. <directory>.ogg next to it, when there is one, is its soundtrack.\n";
+    }
+
+    // "24", or "30000/1001" for the rates that aren't whole
+    bool parse_rate(std::string_view text, std::uint32_t& out_numerator, std::uint32_t& out_denominator)
+    {
+        const std::size_t slash       = text.find('/');
+        const auto        numerator   = text.substr(0, slash);
+        const auto        denominator = slash == std::string_view::npos ? std::string_view{ "1" } : text.substr(slash + 1);
+        const auto        parse       = [](std::string_view digits, std::uint32_t& out_value)
+        {
+            const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), out_value);
+            return error == std::errc{} && end == digits.data() + digits.size() && out_value > 0;
+        };
+        return parse(numerator, out_numerator) && parse(denominator, out_denominator);
+    }
+
+    bool parse_arguments(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+            if (argument == "--no-mips")
+            {
+                options.mipmaps = false;
+            }
+            else if (argument == "--qoi")
+            {
+                options.qoi = true;
+            }
+            else if (argument == "--tiles")
+            {
+                options.tiles = true;
+            }
+            else if (argument == "--clip" && i + 1 < argc)
+            {
+                if (!parse_rate(argv[++i], options.rate_numerator, options.rate_denominator))
+                    return false;
+            }
+            else if (argument == "--format" && i + 1 < argc)
+            {
+                const std::string_view format = argv[++i];
+                options.bc3                   = format == "bc3" || format == "all";
+                options.etc2                  = format == "etc2" || format == "all";
+                if (!options.bc3 && !options.etc2)
+                    return false;
+            }
+            else if (argument.starts_with("--"))
+            {
+                return false;
+            }
+            else
+            {
+                options.inputs.emplace_back(argument);
+            }
+        }
+        return !options.inputs.empty();
+    }
+
+    using Encoder = std::vector<unsigned char> (*)(const unsigned char*, int, int);
+
+    bool write_variant(const std::filesystem::path& output, std::uint32_t vk_format, Encoder encode, const unsigned char* pixels, int width, int height,
+                       const std::vector<std::vector<unsigned char>>& mips)
+    {
+        ktx2::Image image;
+        image.vk_format = vk_format;
+        image.width     = width;
+        image.height    = height;
+
+        int    level_width  = width;
+        int    level_height = height;
+        double rgba_bytes   = 0.0;
+        for (std::size_t level = 0; level <= mips.size(); ++level)
+        {
+            const auto blocks = encode(level == 0 ? pixels : mips[level - 1].data(), level_width, level_height);
+            image.levels.push_back(ktx2::Level{ level_width, level_height, image.data.size(), blocks.size() });
+            image.data.insert(image.data.end(), blocks.begin(), blocks.end());
+            rgba_bytes += static_cast<double>(level_width) * level_height * 4.0;
+            level_width  = std::max(1, level_width / 2);
+            level_height = std::max(1, level_height / 2);
+        }
+
+        if (!ktx2::Save(output, image))
+        {
+            std::cerr << "Failed to write " << output << '\n';
+            return false;
+        }
+        std::cout << "  " << output.filename().string() << ": " << image.data.size() / 1024 << " KB, " << rgba_bytes / static_cast<double>(image.data.size()) << "x smaller than RGBA8\n";
+        return true;
+    }
+
+    bool convert(const std::filesystem::path& input, const Options& options)
+    {
+        int            width  = 0;
+        int            height = 0;
+        unsigned char* pixels = stbi_load(input.string().c_str(), &width, &height, nullptr, 4);
+        if (pixels == nullptr)
+        {
+            std::cerr << "Failed to load " << input << ": " << stbi_failure_reason() << '\n';
+            return false;
+        }
+
+        std::cout << input.string() << " (" << width << " x " << height << ")\n";
+        if (options.tiles)
+        {
+            auto output = input;
+            output.replace_extension(".tiles");
+            const tiled_image::Info info = tiled_image::Describe(width, height);
+            const bool              ok   = tiled_image::Write(output, pixels, width, height);
+            stbi_image_free(pixels);
+            if (!ok)
+            {
+                std::cerr << "Failed to write " << output << '\n';
+                return false;
+            }
+            std::cout << "  " << output.filename().string() << ": " << info.levels.size() << " levels, " << std::filesystem::file_size(output) / (1024 * 1024) << " MB\n";
+            return true;
+        }
+        const auto mips = options.mipmaps ? build_mip_chain(pixels, width, height) : std::vector<std::vector<unsigned char>>{};
+        auto       path = [&input](const char* suffix)
+        {
+            auto output = input;
+            output.replace_extension(std::string{ "." } + suffix + ".ktx2");
+            return output;
+        };
+
+        bool ok = true;
+        if (options.qoi)
+        {
+            auto output = input;
+            output.replace_extension(".qois");
+            if (qoi_strips::Write(output, pixels, width, height))
+            {
+                std::cout << "  " << output.filename().string() << ": " << std::filesystem::file_size(output) / 1024 << " KB\n";
+            }
+            else
+            {
+                std::cerr << "Failed to write " << output << '\n';
+                ok = false;
+            }
+        }
+        if (options.bc3)
+            ok = write_variant(path("bc3"), ktx2::FORMAT_BC3_UNORM, block_compression::EncodeBC3, pixels, width, height, mips) && ok;
+        if (options.etc2)
+            ok = write_variant(path("etc2"), ktx2::FORMAT_ETC2_R8G8B8A8_UNORM, block_compression::EncodeETC2, pixels, width, height, mips) && ok;
+        stbi_image_free(pixels);
+        return ok;
+    }
+
+    // every PNG in `directory`, in name order, into <directory>.clip; they all have to be the first one's size
+    bool convert_clip(const std::filesystem::path& directory, const Options& options)
+    {
+        std::vector<std::filesystem::path> frames;
+        for (const auto& entry : std::filesystem::directory_iterator{ directory })
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".png")
+                frames.push_back(entry.path());
+        }
+        std::sort(frames.begin(), frames.end());
+        if (frames.empty())
+        {
+            std::cerr << "No PNG frames in " << directory << '\n';
+            return false;
+        }
+
+        auto output = directory;
+        if (!output.has_filename())
+            output = output.parent_path();
+        output.replace_extension(".clip");
+        video_clip::Writer writer;
+        for (std::size_t i = 0; i < frames.size(); ++i)
+        {
+            int            width  = 0;
+            int            height = 0;
+            unsigned char* pixels = stbi_load(frames[i].string().c_str(), &width, &height, nullptr, 4);
+            if (pixels == nullptr)
+            {
+                std::cerr << "Failed to load " << frames[i] << ": " << stbi_failure_reason() << '\n';
+                return false;
+            }
+            bool ok = true;
+            if (i == 0)
+            {
+                std::cout << directory.string() << " (" << frames.size() << " frames, " << width << " x " << height << ")\n";
+                ok = writer.Open(output, width, height, options.rate_numerator, options.rate_denominator);
+            }
+            else if ((width + 1) / 2 * 2 != writer.GetInfo().width || (height + 1) / 2 * 2 != writer.GetInfo().height)
+            {
+                std::cerr << frames[i] << " isn't the size of the first frame\n";
+                ok = false;
+            }
+            ok = ok && writer.Add(pixels);
+            stbi_image_free(pixels);
+            if (!ok)
+                return false;
+        }
+        if (!writer.Finish())
+        {
+            std::cerr << "Failed to write " << output << '\n';
+            return false;
+        }
+        const double raw = static_cast<double>(video_clip::FrameBytes(writer.GetInfo())) * static_cast<double>(frames.size());
+        std::cout << "  " << output.filename().string() << ": " << std::filesystem::file_size(output) / 1024 << " KB, " << raw / static_cast<double>(std::filesystem::file_size(output))
+                  << "x smaller than the raw frames\n";
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse_arguments(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    int failures = 0;
+    for (const auto& input : options.inputs)
+    {
+        std::error_code error;
+        if (options.rate_numerator != 0)
+        {
+            failures += std::filesystem::is_directory(input, error) && convert_clip(input, options) ? 0 : 1;
+        }
+        else if (std::filesystem::is_directory(input, error))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator{ input })
+            {
+                if (entry.is_regular_file() && entry.path().extension() == ".png")
+                    failures += convert(entry.path(), options) ? 0 : 1;
+            }
+        }
+        else
+        {
+            failures += convert(input, options) ? 0 : 1;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}